@@ -28,6 +28,7 @@
 #include <stdio.h>
 #include "utilities.h"
 #include "board.h"
+#include "lpm-board.h"
 #include "gpio.h"
 #include "LoRaMac.h"
 #include "Commissioning.h"
@@ -1240,6 +1241,11 @@ int main( void )
                 }
                 else
                 {
+                    // The RAM content is lost in OFF mode, store the deferred contexts changes first
+                    if( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) == LPM_OFF_MODE )
+                    {
+                        NvmCtxMgmtFlush( );
+                    }
                     // The MCU wakes up through events
                     BoardLowPowerHandler( );
                 }
@@ -27,6 +27,7 @@
 #include "utilities.h"
 #include "board-config.h"
 #include "board.h"
+#include "lpm-board.h"
 #include "gpio.h"
 #include "gps.h"
 #include "mpl3115.h"
@@ -1677,6 +1678,11 @@ int main( void )
                 }
                 else
                 {
+                    // The RAM content is lost in OFF mode, store the deferred contexts changes first
+                    if( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) == LPM_OFF_MODE )
+                    {
+                        NvmCtxMgmtFlush( );
+                    }
                     // The MCU wakes up through events
                     BoardLowPowerHandler( );
                 }
@@ -0,0 +1,392 @@
+/*!
+ * \file      CompactLpp.c
+ *
+ * \brief     Implements a compact, delta encoded, sensor payload with a
+ *            Cayenne Low Power Protocol fallback
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utilities.h"
+#include "CompactLpp.h"
+
+/*!
+ * Number of bits of the delta fields length
+ */
+#define COMPACT_LPP_DELTA_LENGTH_BITS               5
+
+/*!
+ * Type description
+ */
+typedef struct sCompactLppType
+{
+    uint8_t Type;
+    uint8_t Axes;
+    uint8_t Width;
+    bool Signed;
+}CompactLppType_t;
+
+/*!
+ * Supported types. The width is the Cayenne LPP data size per axis.
+ */
+static const CompactLppType_t Types[] =
+{
+    { LPP_DIGITAL_INPUT,       1,  8, false },
+    { LPP_DIGITAL_OUTPUT,      1,  8, false },
+    { LPP_ANALOG_INPUT,        1, 16, true  },
+    { LPP_ANALOG_OUTPUT,       1, 16, true  },
+    { LPP_LUMINOSITY,          1, 16, false },
+    { LPP_PRESENCE,            1,  8, false },
+    { LPP_TEMPERATURE,         1, 16, true  },
+    { LPP_RELATIVE_HUMIDITY,   1,  8, false },
+    { LPP_ACCELEROMETER,       3, 16, true  },
+    { LPP_BAROMETRIC_PRESSURE, 1, 16, false },
+    { LPP_GYROMETER,           3, 16, true  },
+    { LPP_GPS,                 3, 24, true  },
+};
+
+/*!
+ * Bit writer
+ */
+typedef struct sBitWriter
+{
+    uint8_t* Buffer;
+    uint16_t Size;
+    uint16_t Pos;
+}BitWriter_t;
+
+/*!
+ * Declared channels and their types
+ */
+static const CompactLppChannel_t* Channels;
+static const CompactLppType_t* ChannelTypes[COMPACT_LPP_MAX_CHANNELS];
+static uint8_t NbChannels = 0;
+
+/*!
+ * Readings added since the last built frame
+ */
+static int32_t Values[COMPACT_LPP_MAX_CHANNELS][3];
+static uint16_t Present = 0;
+
+/*!
+ * Values of the last key frame
+ */
+static int32_t KeyValues[COMPACT_LPP_MAX_CHANNELS][3];
+static uint16_t KeyPresent = 0;
+static bool KeyValid = false;
+static uint8_t KeySequence = 0;
+static uint8_t FramesSinceKey = 0;
+
+static const CompactLppType_t* GetType( uint8_t type )
+{
+    for( uint8_t i = 0; i < ( sizeof( Types ) / sizeof( Types[0] ) ); i++ )
+    {
+        if( Types[i].Type == type )
+        {
+            return &Types[i];
+        }
+    }
+    return NULL;
+}
+
+/*!
+ * \brief Brings a value to the type range, sign extended for signed types
+ */
+static int32_t Normalize( const CompactLppType_t* type, int32_t value )
+{
+    uint32_t mask = ( 1UL << type->Width ) - 1;
+    uint32_t v = ( uint32_t )value & mask;
+
+    if( ( type->Signed == true ) && ( ( v >> ( type->Width - 1 ) ) != 0 ) )
+    {
+        v |= ~mask;
+    }
+    return ( int32_t )v;
+}
+
+static uint8_t Add( uint8_t channel, uint8_t type, int32_t x, int32_t y, int32_t z )
+{
+    for( uint8_t i = 0; i < NbChannels; i++ )
+    {
+        if( ( Channels[i].Channel == channel ) && ( Channels[i].Type == type ) )
+        {
+            Values[i][0] = Normalize( ChannelTypes[i], x );
+            Values[i][1] = Normalize( ChannelTypes[i], y );
+            Values[i][2] = Normalize( ChannelTypes[i], z );
+            Present |= ( 1 << i );
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void BitWrite( BitWriter_t* writer, uint32_t value, uint8_t bits )
+{
+    while( bits > 0 )
+    {
+        bits--;
+        if( writer->Buffer != NULL )
+        {
+            uint16_t byte = writer->Pos >> 3;
+            uint8_t mask = 0x80 >> ( writer->Pos & 0x07 );
+
+            if( byte < writer->Size )
+            {
+                if( ( writer->Pos & 0x07 ) == 0 )
+                {
+                    writer->Buffer[byte] = 0;
+                }
+                if( ( ( value >> bits ) & 0x01 ) != 0 )
+                {
+                    writer->Buffer[byte] |= mask;
+                }
+            }
+        }
+        writer->Pos++;
+    }
+}
+
+/*!
+ * \brief Number of bits needed by a zigzag encoded difference
+ */
+static uint8_t DeltaLength( uint32_t zigzag )
+{
+    uint8_t length = 0;
+
+    while( zigzag != 0 )
+    {
+        zigzag >>= 1;
+        length++;
+    }
+    return length;
+}
+
+/*!
+ * \brief Writes a frame
+ *
+ * \param [IN] writer Bit writer, a NULL buffer only computes the size
+ * \param [IN] delta  Delta or key frame
+ * \retval size Frame size in bits
+ */
+static uint16_t WriteFrame( BitWriter_t* writer, bool delta )
+{
+    BitWrite( writer, ( delta == true ) ? 1 : 0, 1 );
+    BitWrite( writer, KeySequence, 7 );
+    for( uint8_t i = 0; i < NbChannels; i++ )
+    {
+        BitWrite( writer, ( Present >> i ) & 0x01, 1 );
+    }
+
+    for( uint8_t i = 0; i < NbChannels; i++ )
+    {
+        if( ( Present & ( 1 << i ) ) == 0 )
+        {
+            continue;
+        }
+        for( uint8_t axis = 0; axis < ChannelTypes[i]->Axes; axis++ )
+        {
+            if( delta == false )
+            {
+                BitWrite( writer, ( uint32_t )Values[i][axis], ChannelTypes[i]->Width );
+            }
+            else
+            {
+                int32_t diff = Values[i][axis] - KeyValues[i][axis];
+                uint32_t zigzag = ( ( uint32_t )diff << 1 ) ^ ( uint32_t )( diff >> 31 );
+                uint8_t length = DeltaLength( zigzag );
+
+                BitWrite( writer, length, COMPACT_LPP_DELTA_LENGTH_BITS );
+                BitWrite( writer, zigzag, length );
+            }
+        }
+    }
+    return writer->Pos;
+}
+
+uint8_t CompactLppInit( const CompactLppChannel_t* channels, uint8_t nbChannels )
+{
+    NbChannels = 0;
+    Present = 0;
+    KeyValid = false;
+    KeySequence = 0;
+    FramesSinceKey = 0;
+
+    if( ( channels == NULL ) || ( nbChannels == 0 ) || ( nbChannels > COMPACT_LPP_MAX_CHANNELS ) )
+    {
+        return 0;
+    }
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        ChannelTypes[i] = GetType( channels[i].Type );
+        if( ChannelTypes[i] == NULL )
+        {
+            return 0;
+        }
+    }
+    Channels = channels;
+    NbChannels = nbChannels;
+    return 1;
+}
+
+void CompactLppReset( void )
+{
+    Present = 0;
+}
+
+void CompactLppForceKeyFrame( void )
+{
+    KeyValid = false;
+}
+
+uint8_t CompactLppBuild( uint8_t* buffer, uint8_t size )
+{
+    BitWriter_t writer = { .Buffer = NULL, .Size = 0, .Pos = 0 };
+    bool delta = false;
+    uint16_t bits;
+
+    if( NbChannels == 0 )
+    {
+        return 0;
+    }
+
+    if( ( KeyValid == true ) && ( FramesSinceKey < COMPACT_LPP_KEY_FRAME_PERIOD ) &&
+        ( ( Present & ~KeyPresent ) == 0 ) )
+    {
+        // Delta frame only when it is smaller than the key frame
+        uint16_t deltaBits = WriteFrame( &writer, true );
+
+        writer.Pos = 0;
+        delta = deltaBits < WriteFrame( &writer, false );
+    }
+
+    writer.Pos = 0;
+    bits = WriteFrame( &writer, delta );
+    if( ( ( bits + 7 ) >> 3 ) > size )
+    {
+        return 0;
+    }
+
+    if( delta == false )
+    {
+        KeySequence = ( KeySequence + 1 ) & 0x7F;
+    }
+    writer.Buffer = buffer;
+    writer.Size = size;
+    writer.Pos = 0;
+    WriteFrame( &writer, delta );
+
+    if( delta == false )
+    {
+        memcpy1( ( uint8_t* )KeyValues, ( uint8_t* )Values, sizeof( KeyValues ) );
+        KeyPresent = Present;
+        KeyValid = true;
+        FramesSinceKey = 0;
+    }
+    FramesSinceKey++;
+    Present = 0;
+
+    return ( bits + 7 ) >> 3;
+}
+
+uint8_t CompactLppBuildCayenne( uint8_t* buffer, uint8_t size )
+{
+    uint8_t cursor = 0;
+
+    for( uint8_t i = 0; i < NbChannels; i++ )
+    {
+        uint8_t bytes = ChannelTypes[i]->Width >> 3;
+
+        if( ( Present & ( 1 << i ) ) == 0 )
+        {
+            continue;
+        }
+        if( ( cursor + 2 + ( ChannelTypes[i]->Axes * bytes ) ) > size )
+        {
+            return 0;
+        }
+        buffer[cursor++] = Channels[i].Channel;
+        buffer[cursor++] = Channels[i].Type;
+        for( uint8_t axis = 0; axis < ChannelTypes[i]->Axes; axis++ )
+        {
+            for( int8_t b = bytes - 1; b >= 0; b-- )
+            {
+                buffer[cursor++] = ( uint8_t )( Values[i][axis] >> ( b * 8 ) );
+            }
+        }
+    }
+    return cursor;
+}
+
+uint8_t CompactLppAddDigitalInput( uint8_t channel, uint8_t value )
+{
+    return Add( channel, LPP_DIGITAL_INPUT, value, 0, 0 );
+}
+
+uint8_t CompactLppAddDigitalOutput( uint8_t channel, uint8_t value )
+{
+    return Add( channel, LPP_DIGITAL_OUTPUT, value, 0, 0 );
+}
+
+uint8_t CompactLppAddAnalogInput( uint8_t channel, int16_t value )
+{
+    return Add( channel, LPP_ANALOG_INPUT, value, 0, 0 );
+}
+
+uint8_t CompactLppAddAnalogOutput( uint8_t channel, int16_t value )
+{
+    return Add( channel, LPP_ANALOG_OUTPUT, value, 0, 0 );
+}
+
+uint8_t CompactLppAddLuminosity( uint8_t channel, uint16_t lux )
+{
+    return Add( channel, LPP_LUMINOSITY, lux, 0, 0 );
+}
+
+uint8_t CompactLppAddPresence( uint8_t channel, uint8_t value )
+{
+    return Add( channel, LPP_PRESENCE, value, 0, 0 );
+}
+
+uint8_t CompactLppAddTemperature( uint8_t channel, int16_t celsius )
+{
+    return Add( channel, LPP_TEMPERATURE, celsius, 0, 0 );
+}
+
+uint8_t CompactLppAddRelativeHumidity( uint8_t channel, uint8_t rh )
+{
+    return Add( channel, LPP_RELATIVE_HUMIDITY, rh, 0, 0 );
+}
+
+uint8_t CompactLppAddAccelerometer( uint8_t channel, int16_t x, int16_t y, int16_t z )
+{
+    return Add( channel, LPP_ACCELEROMETER, x, y, z );
+}
+
+uint8_t CompactLppAddBarometricPressure( uint8_t channel, uint16_t hpa )
+{
+    return Add( channel, LPP_BAROMETRIC_PRESSURE, hpa, 0, 0 );
+}
+
+uint8_t CompactLppAddGyrometer( uint8_t channel, int16_t x, int16_t y, int16_t z )
+{
+    return Add( channel, LPP_GYROMETER, x, y, z );
+}
+
+uint8_t CompactLppAddGps( uint8_t channel, int32_t latitude, int32_t longitude, int32_t meters )
+{
+    return Add( channel, LPP_GPS, latitude, longitude, meters );
+}
@@ -0,0 +1,179 @@
+/*!
+ * \file      CompactLpp.h
+ *
+ * \brief     Implements a compact, delta encoded, sensor payload with a
+ *            Cayenne Low Power Protocol fallback
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \details The channels and their Cayenne LPP types are declared once with
+ *          CompactLppInit, the frames don't carry them. The readings are
+ *          fixed point integers in the Cayenne LPP units.
+ *
+ *          Frame format, bit packed MSB first:
+ *
+ *          | Delta | Key sequence | Present bitmap | Fields |
+ *          |:-----:|:------------:|:--------------:|:------:|
+ *          | 1 bit | 7 bits       | 1 bit/channel  | ...    |
+ *
+ *          The present bitmap has one bit per declared channel, in the
+ *          declaration order. Each present channel is followed by one field
+ *          per axis:
+ *
+ *          - Key frames ( Delta = 0 ) carry the values on the type width.
+ *          - Delta frames ( Delta = 1 ) carry the difference against the
+ *            values of the key frame with the given key sequence. Each
+ *            field is a 5 bits length followed by the zigzag encoded
+ *            difference on length bits.
+ *
+ *          A lost delta frame doesn't prevent the decoding of the next ones.
+ *          Key frames are sent every COMPACT_LPP_KEY_FRAME_PERIOD frames,
+ *          when a delta frame would be larger and when a channel missing
+ *          from the reference becomes present.
+ */
+#ifndef __COMPACT_LPP_H__
+#define __COMPACT_LPP_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "CayenneLpp.h"
+
+/*!
+ * Maximum number of declared channels
+ */
+#define COMPACT_LPP_MAX_CHANNELS                    16
+
+/*!
+ * Maximum number of frames between two key frames
+ */
+#ifndef COMPACT_LPP_KEY_FRAME_PERIOD
+#define COMPACT_LPP_KEY_FRAME_PERIOD                8
+#endif
+
+/*!
+ * Channel declaration
+ */
+typedef struct sCompactLppChannel
+{
+    /*!
+     * Cayenne LPP channel, used by the fallback encoding
+     */
+    uint8_t Channel;
+    /*!
+     * Cayenne LPP type ( LPP_TEMPERATURE, ... )
+     */
+    uint8_t Type;
+}CompactLppChannel_t;
+
+/*!
+ * \brief Declares the channels and forgets the reference values
+ *
+ * \param [IN] channels   Channels declaration, must remain valid
+ * \param [IN] nbChannels Number of channels [1..COMPACT_LPP_MAX_CHANNELS]
+ * \retval status 1 on success, 0 when a type isn't supported or there are
+ *                too many channels
+ */
+uint8_t CompactLppInit( const CompactLppChannel_t* channels, uint8_t nbChannels );
+
+/*!
+ * \brief Discards the readings added since the last built frame
+ */
+void CompactLppReset( void );
+
+/*!
+ * \brief Forces the next built frame to be a key frame
+ *
+ * \remark To be called when the previous frames may not have reached the
+ *         application server, e.g. after a new join.
+ */
+void CompactLppForceKeyFrame( void );
+
+/*!
+ * \brief Builds the compact frame from the readings and discards them
+ *
+ * \param [OUT] buffer Frame buffer
+ * \param [IN]  size   Frame buffer size
+ * \retval size Size of the frame, 0 when the buffer is too small
+ */
+uint8_t CompactLppBuild( uint8_t* buffer, uint8_t size );
+
+/*!
+ * \brief Builds a Cayenne LPP frame from the readings, they are kept and the
+ *        reference values aren't updated
+ *
+ * \param [OUT] buffer Frame buffer
+ * \param [IN]  size   Frame buffer size
+ * \retval size Size of the frame, 0 when the buffer is too small
+ */
+uint8_t CompactLppBuildCayenne( uint8_t* buffer, uint8_t size );
+
+/*!
+ * The reading functions return 1 on success, 0 when the channel isn't
+ * declared with the matching type. The values are truncated to the type
+ * width.
+ */
+uint8_t CompactLppAddDigitalInput( uint8_t channel, uint8_t value );
+uint8_t CompactLppAddDigitalOutput( uint8_t channel, uint8_t value );
+
+/*!
+ * \param [IN] value 0.01 signed
+ */
+uint8_t CompactLppAddAnalogInput( uint8_t channel, int16_t value );
+uint8_t CompactLppAddAnalogOutput( uint8_t channel, int16_t value );
+
+uint8_t CompactLppAddLuminosity( uint8_t channel, uint16_t lux );
+uint8_t CompactLppAddPresence( uint8_t channel, uint8_t value );
+
+/*!
+ * \param [IN] celsius 0.1 C signed
+ */
+uint8_t CompactLppAddTemperature( uint8_t channel, int16_t celsius );
+
+/*!
+ * \param [IN] rh 0.5 % unsigned
+ */
+uint8_t CompactLppAddRelativeHumidity( uint8_t channel, uint8_t rh );
+
+/*!
+ * \param [IN] x, y, z 0.001 G signed
+ */
+uint8_t CompactLppAddAccelerometer( uint8_t channel, int16_t x, int16_t y, int16_t z );
+
+/*!
+ * \param [IN] hpa 0.1 hPa unsigned
+ */
+uint8_t CompactLppAddBarometricPressure( uint8_t channel, uint16_t hpa );
+
+/*!
+ * \param [IN] x, y, z 0.01 /s signed
+ */
+uint8_t CompactLppAddGyrometer( uint8_t channel, int16_t x, int16_t y, int16_t z );
+
+/*!
+ * \param [IN] latitude  0.0001  signed, 24 bits
+ * \param [IN] longitude 0.0001  signed, 24 bits
+ * \param [IN] meters    0.01 m signed, 24 bits
+ */
+uint8_t CompactLppAddGps( uint8_t channel, int32_t latitude, int32_t longitude, int32_t meters );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __COMPACT_LPP_H__
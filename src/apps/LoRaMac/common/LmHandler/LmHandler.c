@@ -26,7 +26,12 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "utilities.h"
+#include "board.h"
 #include "timer.h"
+#include "eeprom.h"
+#include "trace.h"
+#include "log.h"
+#include "energy.h"
 #include "Commissioning.h"
 #include "NvmCtxMgmt.h"
 #include "LmHandler.h"
@@ -35,6 +40,8 @@
 #include "LmhpClockSync.h"
 #include "LmhpRemoteMcastSetup.h"
 #include "LmhpFragmentation.h"
+#include "LmhpFragUplink.h"
+#include "LmhpPerfStats.h"
 
 #ifndef ACTIVE_REGION
 
@@ -151,6 +158,222 @@ static LoRaMAcHandlerBeaconParams_t BeaconParams =
  */
 static bool IsClassBSwitchPending = false;
 
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+/*!
+ * Accounted charge at the previous uplink confirmation [uC]
+ */
+static uint64_t UplinkChargeUc = 0;
+#endif
+
+/*!
+ * Application payload aggregation context
+ */
+typedef struct LmHandlerAggregation_s
+{
+    uint8_t Port;
+    uint8_t BufferSize;
+    uint8_t Buffer[LMHANDLER_AGGREGATION_BUFFER_SIZE];
+    LmHandlerMsgTypes_t MsgType;
+    /*!
+     * Time at which the buffer must be flushed
+     */
+    TimerTime_t Deadline;
+    /*!
+     * Set by the timer or on a failed flush. Handled by LmHandlerProcess
+     */
+    volatile bool IsFlushPending;
+}LmHandlerAggregation_t;
+
+static LmHandlerAggregation_t Aggregation =
+{
+    .Port = 0,
+    .BufferSize = 0,
+    .MsgType = LORAMAC_HANDLER_UNCONFIRMED_MSG,
+    .Deadline = 0,
+    .IsFlushPending = false,
+};
+
+/*!
+ * Timer used to flush the aggregation buffer at its deadline
+ */
+static TimerEvent_t AggregationTimer;
+
+/*!
+ * \brief Function executed on AggregationTimer Timeout event
+ */
+static void OnAggregationTimerEvent( void* context );
+
+/*!
+ * Context of the ACKs and MAC requests carried by the next uplink
+ */
+typedef struct LmHandlerPiggyback_s
+{
+    /*!
+     * Class B and C confirmed downlinks acknowledgement policy
+     */
+    LmHandlerAckPolicies_t AckPolicy;
+    TimerTime_t AckDelay;
+    /*!
+     * Set on a confirmed downlink or a MAC request, cleared by the next
+     * uplink request
+     */
+    bool IsPending;
+    /*!
+     * Time at which an empty uplink is sent if no other uplink was
+     */
+    TimerTime_t Deadline;
+}LmHandlerPiggyback_t;
+
+static LmHandlerPiggyback_t Piggyback =
+{
+    .AckPolicy = LORAMAC_HANDLER_ACK_POLICY_NEXT_UPLINK,
+    .AckDelay = LMHANDLER_ACK_DEADLINE,
+    .IsPending = false,
+    .Deadline = 0,
+};
+
+/*!
+ * Timer used to send the empty uplink at the piggyback deadline
+ */
+static TimerEvent_t PiggybackTimer;
+
+/*!
+ * \brief Function executed on PiggybackTimer Timeout event
+ */
+static void OnPiggybackTimerEvent( void* context );
+
+/*!
+ * Waits for the next uplink to carry the ACK or the MAC commands, at most
+ * the given delay. The earliest deadline is kept.
+ *
+ * \param [IN] delay Time in ms after which an empty uplink is sent
+ */
+static void LmHandlerPiggybackStart( TimerTime_t delay );
+
+/*!
+ * Sends an empty uplink once the piggyback deadline is reached
+ *
+ * \retval delay Time in ms until the deadline, 0 when the uplink waits for
+ *               the MAC or \ref LMH_PACKAGE_NO_DEADLINE when none is pending
+ */
+static TimerTime_t LmHandlerPiggybackProcess( void );
+
+#if( LMHANDLER_SENSOR_CACHE_PERIOD > 0 )
+/*!
+ * Battery and temperature readings returned to the MAC
+ */
+typedef struct LmHandlerSensorCache_s
+{
+    uint8_t BatteryLevel;
+    float Temperature;
+    /*!
+     * Time of the last readings
+     */
+    TimerTime_t Time;
+    /*!
+     * Set by the refresh timer. Handled by LmHandlerProcess
+     */
+    volatile bool IsRefreshDue;
+}LmHandlerSensorCache_t;
+
+static LmHandlerSensorCache_t SensorCache;
+
+#if( LMHANDLER_SENSOR_CACHE_WAKEUP == 1 )
+/*!
+ * Timer used to wake the application up for the readings refresh
+ */
+static TimerEvent_t SensorCacheTimer;
+
+/*!
+ * \brief Function executed on SensorCacheTimer Timeout event
+ */
+static void OnSensorCacheTimerEvent( void* context );
+#endif
+
+/*!
+ * Reads the battery level and the temperature from the application
+ */
+static void LmHandlerSensorCacheRefresh( void );
+
+/*!
+ * Refreshes the readings once older than LMHANDLER_SENSOR_CACHE_PERIOD,
+ * while the MAC is idle
+ */
+static void LmHandlerSensorCacheProcess( void );
+
+/*!
+ * \brief MAC callbacks returning the cached readings
+ */
+static uint8_t LmHandlerSensorCacheGetBatteryLevel( void );
+static float LmHandlerSensorCacheGetTemperature( void );
+#endif
+
+/*!
+ * Scheduled uplink
+ */
+typedef struct LmHandlerUplink_s
+{
+    bool IsPending;
+    LmHandlerUplinkPriorities_t Priority;
+    LmHandlerMsgTypes_t MsgType;
+    /*!
+     * Queuing order, used to send the uplinks of a class first in first out
+     */
+    uint16_t Order;
+    TimerTime_t QueueTime;
+    uint8_t Port;
+    uint8_t BufferSize;
+    uint8_t Buffer[LMHANDLER_UPLINK_BUFFER_SIZE];
+}LmHandlerUplink_t;
+
+static LmHandlerUplink_t UplinkQueue[LMHANDLER_UPLINK_QUEUE_SIZE];
+
+static uint16_t UplinkQueueOrder = 0;
+
+/*!
+ * Scheduled uplinks maximum age per class
+ */
+static const TimerTime_t UplinkMaxAge[LORAMAC_HANDLER_UPLINK_PRIORITY_NB] =
+{
+    LMHANDLER_UPLINK_ALARM_MAX_AGE,
+    LMHANDLER_UPLINK_MAC_ANSWER_MAX_AGE,
+    LMHANDLER_UPLINK_SYNC_MAX_AGE,
+    LMHANDLER_UPLINK_TELEMETRY_MAX_AGE,
+};
+
+/*!
+ * Timer used to wake up the application when the duty-cycle allows the
+ * next scheduled uplink
+ */
+static TimerEvent_t UplinkTimer;
+
+/*!
+ * \brief Function executed on UplinkTimer Timeout event
+ */
+static void OnUplinkTimerEvent( void* context );
+
+/*!
+ * Sends the next scheduled uplink when the MAC and the duty-cycle allow it
+ *
+ * \retval delay Time in ms until the duty-cycle allows the next scheduled
+ *               uplink, 0 when waiting for a MAC event or
+ *               \ref LMH_PACKAGE_NO_DEADLINE when the queue is empty
+ */
+static TimerTime_t LmHandlerUplinkProcess( void );
+
+/*!
+ * Instructs the MAC layer to send a ClassA uplink at the given datarate
+ *
+ * \param [IN] appData Data to be sent
+ * \param [IN] isTxConfirmed Indicates if the uplink requires an acknowledgement
+ * \param [IN] datarate Datarate used when ADR is disabled
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if request has been
+ *                processed else \ref LORAMAC_HANDLER_ERROR
+ */
+static LmHandlerErrorStatus_t LmHandlerSendAtDatarate( LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed,
+                                                       int8_t datarate );
+
 /*!
  * \brief   MCPS-Confirm event function
  *
@@ -190,6 +413,16 @@ static void MlmeIndication( MlmeIndication_t *mlmeIndication );
  */
 static LmHandlerErrorStatus_t LmHandlerDeviceTimeReq( void );
 
+/*!
+ * Requests a MAC command sent by the next uplink
+ *
+ * \param [IN] mlmeReq MLME request adding the MAC command
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if request has been
+ *                processed else \ref LORAMAC_HANDLER_ERROR
+ */
+static LmHandlerErrorStatus_t LmHandlerMacCommandReq( MlmeReq_t *mlmeReq );
+
 /*!
  * Starts the beacon search
  *
@@ -222,13 +455,30 @@ typedef enum PackageNotifyTypes_e
  */
 static void LmHandlerPackagesNotify( PackageNotifyTypes_t notifyType, void *params );
 
-static void LmHandlerPackagesProcess( void );
+/*!
+ * Calls the Process function of the packages having pending work.
+ *
+ * \retval deadline Time in ms until the earliest package deadline or
+ *                  \ref LMH_PACKAGE_NO_DEADLINE when no package is waiting
+ */
+static TimerTime_t LmHandlerPackagesProcess( void );
+
+/*!
+ * Timer used to wake up the application at the earliest package deadline
+ */
+static TimerEvent_t PackagesProcessTimer;
+
+/*!
+ * \brief Function executed on PackagesProcessTimer Timeout event
+ */
+static void OnPackagesProcessTimerEvent( void* context );
 
 LmHandlerErrorStatus_t LmHandlerInit( LmHandlerCallbacks_t *handlerCallbacks,
                                       LmHandlerParams_t *handlerParams )
 {
     //
     MibRequestConfirm_t mibReq;
+    NvmCtxMgmtStatus_t nvmStatus;
     LmHandlerParams = handlerParams;
     LmHandlerCallbacks = handlerCallbacks;
 
@@ -236,20 +486,50 @@ LmHandlerErrorStatus_t LmHandlerInit( LmHandlerCallbacks_t *handlerCallbacks,
     LoRaMacPrimitives.MacMcpsIndication = McpsIndication;
     LoRaMacPrimitives.MacMlmeConfirm = MlmeConfirm;
     LoRaMacPrimitives.MacMlmeIndication = MlmeIndication;
+#if( LMHANDLER_SENSOR_CACHE_PERIOD > 0 )
+    // The MAC gets the cached readings, the sensors are read while it is idle
+    LoRaMacCallbacks.GetBatteryLevel = NULL;
+    LoRaMacCallbacks.GetTemperatureLevel = NULL;
+    if( LmHandlerCallbacks->GetBatteryLevel != NULL )
+    {
+        LoRaMacCallbacks.GetBatteryLevel = LmHandlerSensorCacheGetBatteryLevel;
+    }
+    if( LmHandlerCallbacks->GetTemperature != NULL )
+    {
+        LoRaMacCallbacks.GetTemperatureLevel = LmHandlerSensorCacheGetTemperature;
+    }
+#if( LMHANDLER_SENSOR_CACHE_WAKEUP == 1 )
+    TimerInit( &SensorCacheTimer, OnSensorCacheTimerEvent );
+#endif
+    LmHandlerSensorCacheRefresh( );
+#else
     LoRaMacCallbacks.GetBatteryLevel = LmHandlerCallbacks->GetBatteryLevel;
     LoRaMacCallbacks.GetTemperatureLevel = LmHandlerCallbacks->GetTemperature;
+#endif
     LoRaMacCallbacks.NvmContextChange = NvmCtxMgmtEvent;
     LoRaMacCallbacks.MacProcessNotify = LmHandlerCallbacks->OnMacProcess;
 
+    // The deferred timer callbacks run from LmHandlerProcess
+    TimerSetProcessNotify( LmHandlerCallbacks->OnMacProcess );
+
     IsClassBSwitchPending = false;
 
+    TimerInit( &PackagesProcessTimer, OnPackagesProcessTimerEvent );
+    TimerInit( &AggregationTimer, OnAggregationTimerEvent );
+    TimerInit( &UplinkTimer, OnUplinkTimerEvent );
+    TimerInit( &PiggybackTimer, OnPiggybackTimerEvent );
+
     if( LoRaMacInitialization( &LoRaMacPrimitives, &LoRaMacCallbacks, LmHandlerParams->Region ) != LORAMAC_STATUS_OK )
     {
         return LORAMAC_HANDLER_ERROR;
     }
 
     // Try to restore from NVM and query the mac if possible.
-    if( NvmCtxMgmtRestore( ) == NVMCTXMGMT_STATUS_SUCCESS )
+    // The contexts checksums are verified at full speed
+    BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_HIGH );
+    nvmStatus = NvmCtxMgmtRestore( );
+    BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_LOW );
+    if( nvmStatus == NVMCTXMGMT_STATUS_SUCCESS )
     {
         LmHandlerCallbacks->OnNvmContextChange( LORAMAC_HANDLER_NVM_RESTORE );
     }
@@ -369,24 +649,86 @@ bool LmHandlerIsBusy( void )
     return false;
 }
 
-void LmHandlerProcess( void )
+TimerTime_t LmHandlerProcess( void )
 {
+    TimerTime_t nextDeadline;
+
     // Process Radio IRQ
     if( Radio.IrqProcess != NULL )
     {
         Radio.IrqProcess( );
     }
 
-    // Processes the LoRaMac events
-    LoRaMacProcess( );
+    // The radio IRQs are serviced on the wake up clock, the MAC processing
+    // needs the full speed one
+    if( LoRaMacIsBusy( ) == true )
+    {
+        BoardSystemClockRequest( );
+
+        // The received frames are decrypted and authenticated at full speed
+        BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_HIGH );
+        LoRaMacProcess( );
+        BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_LOW );
+    }
+    else
+    {
+        // Processes the LoRaMac events
+        LoRaMacProcess( );
+    }
+
+    // Run the timer callbacks deferred out of the timer IRQ
+    TimerProcess( );
 
-    // Call all packages process functions
-    LmHandlerPackagesProcess( );
+    // Call the process functions of the ready packages
+    nextDeadline = LmHandlerPackagesProcess( );
+
+    if( Aggregation.IsFlushPending == true )
+    {
+        LmHandlerAggregationFlush( );
+    }
+    TimerTime_t uplinkDelay = LmHandlerUplinkProcess( );
+    if( ( uplinkDelay != 0 ) && ( uplinkDelay < nextDeadline ) )
+    {
+        nextDeadline = uplinkDelay;
+    }
+    // After the other uplinks, which carry the ACK and MAC commands when sent
+    TimerTime_t piggybackDelay = LmHandlerPiggybackProcess( );
+    if( ( piggybackDelay != 0 ) && ( piggybackDelay < nextDeadline ) )
+    {
+        nextDeadline = piggybackDelay;
+    }
+
+    if( Aggregation.BufferSize != 0 )
+    {
+        int32_t remaining = ( int32_t )( Aggregation.Deadline - TimerGetCurrentTime( ) );
+
+        if( remaining < 0 )
+        {
+            remaining = 0;
+        }
+        if( ( TimerTime_t )remaining < nextDeadline )
+        {
+            nextDeadline = remaining;
+        }
+    }
+
+#if( LMHANDLER_SENSOR_CACHE_PERIOD > 0 )
+    LmHandlerSensorCacheProcess( );
+#endif
+
+    // Postpone the NVM erase operations while the MAC waits for the reception windows
+    EepromSetEraseAllowed( LoRaMacIsBusy( ) == false );
 
     if( NvmCtxMgmtStore( ) == NVMCTXMGMT_STATUS_SUCCESS )
     {
         LmHandlerCallbacks->OnNvmContextChange( LORAMAC_HANDLER_NVM_STORE );
     }
+
+    // Drain the event trace and the buffered log in the background
+    TraceProcess( );
+    LogProcess( );
+
+    return nextDeadline;
 }
 
 /*!
@@ -462,6 +804,12 @@ LmHandlerFlagStatus_t LmHandlerJoinStatus( void )
 }
 
 LmHandlerErrorStatus_t LmHandlerSend( LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed )
+{
+    return LmHandlerSendAtDatarate( appData, isTxConfirmed, LmHandlerParams->TxDatarate );
+}
+
+static LmHandlerErrorStatus_t LmHandlerSendAtDatarate( LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed,
+                                                       int8_t datarate )
 {
     LoRaMacStatus_t status;
     McpsReq_t mcpsReq;
@@ -479,7 +827,7 @@ LmHandlerErrorStatus_t LmHandlerSend( LmHandlerAppData_t *appData, LmHandlerMsgT
         return LORAMAC_HANDLER_ERROR;
     }
 
-    mcpsReq.Req.Unconfirmed.Datarate = LmHandlerParams->TxDatarate;
+    mcpsReq.Req.Unconfirmed.Datarate = datarate;
     if( LoRaMacQueryTxPossible( appData->BufferSize, &txInfo ) != LORAMAC_STATUS_OK )
     {
         // Send empty frame in order to flush MAC commands
@@ -506,15 +854,21 @@ LmHandlerErrorStatus_t LmHandlerSend( LmHandlerAppData_t *appData, LmHandlerMsgT
     }
 
     TxParams.AppData = *appData;
-    TxParams.Datarate = LmHandlerParams->TxDatarate;
+    TxParams.Datarate = datarate;
 
     TimerTime_t nextTxIn = 0;
     LoRaMacQueryNextTxDelay( TxParams.Datarate, &nextTxIn );
+    // The frame is encrypted and signed at full speed
+    BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_HIGH );
     status = LoRaMacMcpsRequest( &mcpsReq );
+    BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_LOW );
     LmHandlerCallbacks->OnMacMcpsRequest( status, &mcpsReq, nextTxIn );
 
     if( status == LORAMAC_STATUS_OK )
     {
+        // The MAC adds the ACK bit and the MAC commands to the prepared frame
+        Piggyback.IsPending = false;
+        TimerStop( &PiggybackTimer );
         return LORAMAC_HANDLER_SUCCESS;
     }
     else
@@ -523,26 +877,424 @@ LmHandlerErrorStatus_t LmHandlerSend( LmHandlerAppData_t *appData, LmHandlerMsgT
     }
 }
 
-static LmHandlerErrorStatus_t LmHandlerDeviceTimeReq( void )
+LmHandlerErrorStatus_t LmHandlerAggregate( uint8_t port, uint8_t *record, uint8_t recordSize,
+                                           LmHandlerMsgTypes_t isTxConfirmed, TimerTime_t maxDelay )
 {
-    LoRaMacStatus_t status;
-    MlmeReq_t mlmeReq;
+    LoRaMacTxInfo_t txInfo;
+    uint8_t maxSize = LMHANDLER_AGGREGATION_BUFFER_SIZE;
 
-    mlmeReq.Type = MLME_DEVICE_TIME;
+    if( ( record == NULL ) || ( recordSize == 0 ) )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
 
-    TimerTime_t nextTxIn = 0;
-    LoRaMacQueryNextTxDelay( TxParams.Datarate, &nextTxIn );
-    status = LoRaMacMlmeRequest( &mlmeReq );
-    LmHandlerCallbacks->OnMacMlmeRequest( status, &mlmeReq, nextTxIn );
+    LoRaMacQueryTxPossible( 0, &txInfo );
+    if( ( txInfo.MaxPossibleApplicationDataSize != 0 ) && ( txInfo.MaxPossibleApplicationDataSize < maxSize ) )
+    {
+        maxSize = txInfo.MaxPossibleApplicationDataSize;
+    }
+    if( recordSize > maxSize )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
 
-    if( status == LORAMAC_STATUS_OK )
+    if( ( Aggregation.BufferSize != 0 ) &&
+        ( ( Aggregation.Port != port ) || ( ( Aggregation.BufferSize + recordSize ) > maxSize ) ) )
+    {
+        if( LmHandlerAggregationFlush( ) != LORAMAC_HANDLER_SUCCESS )
+        {
+            return LORAMAC_HANDLER_ERROR;
+        }
+    }
+
+    TimerTime_t now = TimerGetCurrentTime( );
+    if( ( Aggregation.BufferSize == 0 ) ||
+        ( ( int32_t )( ( now + maxDelay ) - Aggregation.Deadline ) < 0 ) )
     {
+        Aggregation.Deadline = now + maxDelay;
+        TimerStop( &AggregationTimer );
+        TimerSetValue( &AggregationTimer, maxDelay );
+        TimerStart( &AggregationTimer );
+    }
+    Aggregation.Port = port;
+    memcpy1( Aggregation.Buffer + Aggregation.BufferSize, record, recordSize );
+    Aggregation.BufferSize += recordSize;
+    if( isTxConfirmed == LORAMAC_HANDLER_CONFIRMED_MSG )
+    {
+        Aggregation.MsgType = LORAMAC_HANDLER_CONFIRMED_MSG;
+    }
+
+    if( Aggregation.BufferSize == maxSize )
+    {
+        // Full. A failed flush is retried by LmHandlerProcess
+        LmHandlerAggregationFlush( );
+    }
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+LmHandlerErrorStatus_t LmHandlerAggregationFlush( void )
+{
+    LoRaMacTxInfo_t txInfo;
+    bool payloadFits;
+
+    if( Aggregation.BufferSize == 0 )
+    {
+        Aggregation.IsFlushPending = false;
         return LORAMAC_HANDLER_SUCCESS;
     }
+
+    // Retried on the next LmHandlerProcess call
+    Aggregation.IsFlushPending = true;
+
+    if( LmHandlerIsBusy( ) == true )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+
+    // When the pending MAC commands leave no room LmHandlerSend only sends
+    // them. The records are then kept for the next uplink.
+    payloadFits = LoRaMacQueryTxPossible( Aggregation.BufferSize, &txInfo ) == LORAMAC_STATUS_OK;
+
+    LmHandlerAppData_t appData =
+    {
+        .Buffer = Aggregation.Buffer,
+        .BufferSize = Aggregation.BufferSize,
+        .Port = Aggregation.Port
+    };
+    if( LmHandlerSend( &appData, Aggregation.MsgType ) != LORAMAC_HANDLER_SUCCESS )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+    if( payloadFits == false )
+    {
+        if( Aggregation.BufferSize > txInfo.CurrentPossiblePayloadSize )
+        {
+            // The datarate has been lowered since the records were appended.
+            // Stop retrying, the application has to flush again.
+            Aggregation.IsFlushPending = false;
+        }
+        return LORAMAC_HANDLER_ERROR;
+    }
+
+    // The MAC copied the payload, the buffer may be reused
+    TimerStop( &AggregationTimer );
+    Aggregation.BufferSize = 0;
+    Aggregation.MsgType = LORAMAC_HANDLER_UNCONFIRMED_MSG;
+    Aggregation.IsFlushPending = false;
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+static void OnAggregationTimerEvent( void* context )
+{
+    Aggregation.IsFlushPending = true;
+    if( LmHandlerCallbacks->OnMacProcess != NULL )
+    {
+        LmHandlerCallbacks->OnMacProcess( );
+    }
+}
+
+LmHandlerErrorStatus_t LmHandlerUplinkSchedule( LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed,
+                                                LmHandlerUplinkPriorities_t priority )
+{
+    LmHandlerUplink_t *uplink = NULL;
+
+    if( ( appData == NULL ) || ( appData->BufferSize > LMHANDLER_UPLINK_BUFFER_SIZE ) ||
+        ( priority >= LORAMAC_HANDLER_UPLINK_PRIORITY_NB ) )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+
+    for( uint8_t i = 0; i < LMHANDLER_UPLINK_QUEUE_SIZE; i++ )
+    {
+        if( UplinkQueue[i].IsPending == false )
+        {
+            if( uplink == NULL )
+            {
+                uplink = &UplinkQueue[i];
+            }
+        }
+        else if( ( priority == LORAMAC_HANDLER_UPLINK_PRIORITY_TELEMETRY ) &&
+                 ( UplinkQueue[i].Priority == LORAMAC_HANDLER_UPLINK_PRIORITY_TELEMETRY ) &&
+                 ( UplinkQueue[i].Port == appData->Port ) )
+        {
+            // Superseded telemetry. Keep the queue position.
+            uplink = &UplinkQueue[i];
+            break;
+        }
+    }
+
+    if( uplink == NULL )
+    {
+        // Queue full. Drop the newest lowest priority uplink if it has a
+        // lower priority than the new one.
+        LmHandlerUplink_t *victim = &UplinkQueue[0];
+        for( uint8_t i = 1; i < LMHANDLER_UPLINK_QUEUE_SIZE; i++ )
+        {
+            if( ( UplinkQueue[i].Priority > victim->Priority ) ||
+                ( ( UplinkQueue[i].Priority == victim->Priority ) &&
+                  ( ( int16_t )( UplinkQueue[i].Order - victim->Order ) > 0 ) ) )
+            {
+                victim = &UplinkQueue[i];
+            }
+        }
+        if( victim->Priority <= priority )
+        {
+            return LORAMAC_HANDLER_ERROR;
+        }
+        uplink = victim;
+        uplink->IsPending = false;
+    }
+
+    if( uplink->IsPending == false )
+    {
+        uplink->Order = UplinkQueueOrder++;
+    }
+    uplink->Priority = priority;
+    uplink->MsgType = isTxConfirmed;
+    uplink->QueueTime = TimerGetCurrentTime( );
+    uplink->Port = appData->Port;
+    uplink->BufferSize = appData->BufferSize;
+    memcpy1( uplink->Buffer, appData->Buffer, appData->BufferSize );
+    uplink->IsPending = true;
+
+    // Let the main loop send it
+    if( LmHandlerCallbacks->OnMacProcess != NULL )
+    {
+        LmHandlerCallbacks->OnMacProcess( );
+    }
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+bool LmHandlerUplinkIsPending( uint8_t port )
+{
+    for( uint8_t i = 0; i < LMHANDLER_UPLINK_QUEUE_SIZE; i++ )
+    {
+        if( ( UplinkQueue[i].IsPending == true ) && ( UplinkQueue[i].Port == port ) )
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+TimerTime_t LmHandlerGetNextTxDelay( uint8_t size )
+{
+    LoRaMacTxPlan_t plan;
+    int8_t datarate = LmHandlerGetCurrentDatarate( );
+
+    if( ( datarate < 0 ) || ( datarate >= LORAMAC_TX_PLAN_NB_DATARATES ) ||
+        ( LoRaMacQueryTxPlan( size, &plan ) != LORAMAC_STATUS_OK ) ||
+        ( plan.Datarates[datarate].Delay == TIMERTIME_T_MAX ) )
+    {
+        // Let the MAC decide
+        return 0;
+    }
+    return plan.Datarates[datarate].Delay;
+}
+
+LmHandlerErrorStatus_t LmHandlerSetAckPolicy( LmHandlerAckPolicies_t policy, TimerTime_t deadline )
+{
+    if( ( policy != LORAMAC_HANDLER_ACK_POLICY_NEXT_UPLINK ) && ( policy != LORAMAC_HANDLER_ACK_POLICY_DEADLINE ) )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+    Piggyback.AckPolicy = policy;
+    Piggyback.AckDelay = ( deadline == 0 ) ? LMHANDLER_ACK_DEADLINE : deadline;
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+static void LmHandlerPiggybackStart( TimerTime_t delay )
+{
+    TimerTime_t deadline = TimerGetCurrentTime( ) + delay;
+
+    if( ( Piggyback.IsPending == true ) && ( ( int32_t )( deadline - Piggyback.Deadline ) >= 0 ) )
+    {
+        return;
+    }
+    Piggyback.IsPending = true;
+    Piggyback.Deadline = deadline;
+    TimerStop( &PiggybackTimer );
+    TimerSetValue( &PiggybackTimer, delay );
+    TimerStart( &PiggybackTimer );
+}
+
+static TimerTime_t LmHandlerPiggybackProcess( void )
+{
+    if( Piggyback.IsPending == false )
+    {
+        return LMH_PACKAGE_NO_DEADLINE;
+    }
+
+    int32_t remaining = ( int32_t )( Piggyback.Deadline - TimerGetCurrentTime( ) );
+    if( remaining > 0 )
+    {
+        return ( TimerTime_t )remaining;
+    }
+
+    // The MAC events wake up the application once the MAC is free
+    if( ( LoRaMacIsBusy( ) == true ) || ( LmHandlerPackages[PACKAGE_ID_COMPLIANCE]->IsRunning( ) == true ) )
+    {
+        return 0;
+    }
+
+    if( Aggregation.BufferSize != 0 )
+    {
+        // The buffered records carry the ACK and MAC commands
+        LmHandlerAggregationFlush( );
+    }
     else
+    {
+        // Send an empty message
+        LmHandlerAppData_t appData =
+        {
+            .Buffer = NULL,
+            .BufferSize = 0,
+            .Port = 0
+        };
+        LmHandlerSend( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
+    }
+    // A failed send is retried on the next LmHandlerProcess call
+    return 0;
+}
+
+static void OnPiggybackTimerEvent( void* context )
+{
+    if( LmHandlerCallbacks->OnMacProcess != NULL )
+    {
+        LmHandlerCallbacks->OnMacProcess( );
+    }
+}
+
+static TimerTime_t LmHandlerUplinkProcess( void )
+{
+    LmHandlerUplink_t *uplink = NULL;
+    MibRequestConfirm_t mibReq;
+    LoRaMacTxInfo_t txInfo;
+    TimerTime_t nextTxIn = 0;
+    int8_t datarate = LmHandlerParams->TxDatarate;
+    bool payloadFits;
+
+    for( uint8_t i = 0; i < LMHANDLER_UPLINK_QUEUE_SIZE; i++ )
+    {
+        if( UplinkQueue[i].IsPending == false )
+        {
+            continue;
+        }
+        if( ( UplinkMaxAge[UplinkQueue[i].Priority] != 0 ) &&
+            ( TimerGetElapsedTime( UplinkQueue[i].QueueTime ) > UplinkMaxAge[UplinkQueue[i].Priority] ) )
+        {
+            // Expired
+            UplinkQueue[i].IsPending = false;
+            continue;
+        }
+        if( ( uplink == NULL ) || ( UplinkQueue[i].Priority < uplink->Priority ) ||
+            ( ( UplinkQueue[i].Priority == uplink->Priority ) &&
+              ( ( int16_t )( UplinkQueue[i].Order - uplink->Order ) < 0 ) ) )
+        {
+            uplink = &UplinkQueue[i];
+        }
+    }
+
+    if( uplink == NULL )
+    {
+        TimerStop( &UplinkTimer );
+        return LMH_PACKAGE_NO_DEADLINE;
+    }
+
+    // The MAC events wake up the application once the MAC is free.
+    // The network join is left to the application.
+    if( ( LoRaMacIsBusy( ) == true ) || ( LmHandlerJoinStatus( ) != LORAMAC_HANDLER_SET ) ||
+        ( LmHandlerPackages[PACKAGE_ID_COMPLIANCE]->IsRunning( ) == true ) )
+    {
+        return 0;
+    }
+
+    mibReq.Type = MIB_ADR;
+    LoRaMacMibGetRequestConfirm( &mibReq );
+    if( ( mibReq.Param.AdrEnable == false ) &&
+        ( LoRaMacQueryTxDatarate( uplink->BufferSize, &datarate ) == LORAMAC_STATUS_OK ) )
+    {
+        // Raise the datarate when the payload doesn't fit. Applied beforehand
+        // so that the MAC payload checks use it, the MCPS request sets it anyway.
+        mibReq.Type = MIB_CHANNELS_DATARATE;
+        mibReq.Param.ChannelsDatarate = datarate;
+        LoRaMacMibSetRequestConfirm( &mibReq );
+    }
+
+    // Hold the uplink until the duty-cycle allows it. Otherwise the MAC
+    // delays it and a higher priority uplink would have to wait behind it.
+    LoRaMacQueryNextTxDelay( datarate, &nextTxIn );
+    if( nextTxIn != 0 )
+    {
+        TimerStop( &UplinkTimer );
+        TimerSetValue( &UplinkTimer, nextTxIn );
+        TimerStart( &UplinkTimer );
+        return nextTxIn;
+    }
+
+    // When the pending MAC commands leave no room LmHandlerSend only sends
+    // them. The uplink is then kept for the next opportunity.
+    payloadFits = LoRaMacQueryTxPossible( uplink->BufferSize, &txInfo ) == LORAMAC_STATUS_OK;
+
+    LmHandlerAppData_t appData =
+    {
+        .Buffer = uplink->Buffer,
+        .BufferSize = uplink->BufferSize,
+        .Port = uplink->Port
+    };
+    if( ( LmHandlerSendAtDatarate( &appData, uplink->MsgType, datarate ) == LORAMAC_HANDLER_SUCCESS ) &&
+        ( payloadFits == true ) )
+    {
+        uplink->IsPending = false;
+    }
+    return 0;
+}
+
+static void OnUplinkTimerEvent( void* context )
+{
+    if( LmHandlerCallbacks->OnMacProcess != NULL )
+    {
+        LmHandlerCallbacks->OnMacProcess( );
+    }
+}
+
+static LmHandlerErrorStatus_t LmHandlerMacCommandReq( MlmeReq_t *mlmeReq )
+{
+    LoRaMacStatus_t status;
+
+    TimerTime_t nextTxIn = 0;
+    LoRaMacQueryNextTxDelay( TxParams.Datarate, &nextTxIn );
+    status = LoRaMacMlmeRequest( mlmeReq );
+    LmHandlerCallbacks->OnMacMlmeRequest( status, mlmeReq, nextTxIn );
+
+    if( status != LORAMAC_STATUS_OK )
     {
         return LORAMAC_HANDLER_ERROR;
     }
+    if( LMHANDLER_MAC_REQUEST_DEADLINE != 0 )
+    {
+        // The MAC command is carried by the next uplink
+        LmHandlerPiggybackStart( LMHANDLER_MAC_REQUEST_DEADLINE );
+    }
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+static LmHandlerErrorStatus_t LmHandlerDeviceTimeReq( void )
+{
+    MlmeReq_t mlmeReq;
+
+    mlmeReq.Type = MLME_DEVICE_TIME;
+
+    return LmHandlerMacCommandReq( &mlmeReq );
+}
+
+LmHandlerErrorStatus_t LmHandlerLinkCheckReq( void )
+{
+    MlmeReq_t mlmeReq;
+
+    mlmeReq.Type = MLME_LINK_CHECK;
+
+    return LmHandlerMacCommandReq( &mlmeReq );
 }
 
 static LmHandlerErrorStatus_t LmHandlerBeaconReq( void )
@@ -569,19 +1321,17 @@ static LmHandlerErrorStatus_t LmHandlerBeaconReq( void )
 
 LmHandlerErrorStatus_t LmHandlerPingSlotReq( uint8_t periodicity )
 {
-    LoRaMacStatus_t status;
     MlmeReq_t mlmeReq;
 
     mlmeReq.Type = MLME_PING_SLOT_INFO;
     mlmeReq.Req.PingSlotInfo.PingSlot.Fields.Periodicity = periodicity;
     mlmeReq.Req.PingSlotInfo.PingSlot.Fields.RFU = 0;
 
-    TimerTime_t nextTxIn = 0;
-    LoRaMacQueryNextTxDelay( TxParams.Datarate, &nextTxIn );
-    status = LoRaMacMlmeRequest( &mlmeReq );
-    LmHandlerCallbacks->OnMacMlmeRequest( status, &mlmeReq, nextTxIn );
-
-    if( status == LORAMAC_STATUS_OK )
+    if( LmHandlerMacCommandReq( &mlmeReq ) != LORAMAC_HANDLER_SUCCESS )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+    if( LMHANDLER_MAC_REQUEST_DEADLINE == 0 )
     {
         // Send an empty message
         LmHandlerAppData_t appData =
@@ -592,10 +1342,7 @@ LmHandlerErrorStatus_t LmHandlerPingSlotReq( uint8_t periodicity )
         };
         return LmHandlerSend( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
     }
-    else
-    {
-        return LORAMAC_HANDLER_ERROR;
-    }
+    return LORAMAC_HANDLER_SUCCESS;
 }
 
 LmHandlerErrorStatus_t LmHandlerRequestClass( DeviceClass_t newClass )
@@ -706,6 +1453,12 @@ static void McpsConfirm( McpsConfirm_t *mcpsConfirm )
     TxParams.TxPower = mcpsConfirm->TxPower;
     TxParams.Channel = mcpsConfirm->Channel;
     TxParams.AckReceived = mcpsConfirm->AckReceived;
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+    uint64_t charge = EnergyGetChargeUc( );
+
+    TxParams.ChargeUc = ( uint32_t )( charge - UplinkChargeUc );
+    UplinkChargeUc = charge;
+#endif
 
     LmHandlerCallbacks->OnTxData( &TxParams );
 
@@ -734,6 +1487,14 @@ static void McpsIndication( McpsIndication_t *mcpsIndication )
     appData.BufferSize = mcpsIndication->BufferSize;
     appData.Buffer = mcpsIndication->Buffer;
 
+    if( ( mcpsIndication->McpsIndication == MCPS_CONFIRMED ) && ( LmHandlerGetCurrentClass( ) != CLASS_A ) &&
+        ( Piggyback.AckPolicy == LORAMAC_HANDLER_ACK_POLICY_DEADLINE ) )
+    {
+        // The application, the packages and the flushes may send the ACK
+        // before the deadline. A repeated downlink keeps the first deadline.
+        LmHandlerPiggybackStart( Piggyback.AckDelay );
+    }
+
     LmHandlerCallbacks->OnRxData( &appData, &RxParams );
 
     if( mcpsIndication->DeviceTimeAnsReceived == true )
@@ -954,6 +1715,16 @@ LmHandlerErrorStatus_t LmHandlerPackageRegister( uint8_t id, void *params )
             package = LmhpFragmentationPackageFactory( );
             break;
         }
+        case PACKAGE_ID_FRAG_UPLINK:
+        {
+            package = LmhpFragUplinkPackageFactory( );
+            break;
+        }
+        case PACKAGE_ID_PERF_STATS:
+        {
+            package = LmhpPerfStatsPackageFactory( );
+            break;
+        }
     }
     if( package != NULL )
     {
@@ -1044,15 +1815,106 @@ static void LmHandlerPackagesNotify( PackageNotifyTypes_t notifyType, void *para
     }
 }
 
-static void LmHandlerPackagesProcess( void )
+static TimerTime_t LmHandlerPackagesProcess( void )
 {
+    TimerTime_t nextDeadline = LMH_PACKAGE_NO_DEADLINE;
+
     for( int8_t i = 0; i < PKG_MAX_NUMBER; i++ )
     {
         if( ( LmHandlerPackages[i] != NULL ) &&
             ( LmHandlerPackages[i]->Process != NULL ) &&
             ( LmHandlerPackageIsInitialized( i ) != false ) )
         {
-            LmHandlerPackages[i]->Process( );
+            if( LmHandlerPackages[i]->GetNextDeadline == NULL )
+            {
+                // Legacy package. Called on every pass.
+                LmHandlerPackages[i]->Process( );
+                continue;
+            }
+            if( LmHandlerPackages[i]->GetNextDeadline( ) == 0 )
+            {
+                LmHandlerPackages[i]->Process( );
+            }
+            // Pending work waiting for a MAC event (e.g. LmHandlerIsBusy)
+            // is resumed by the event itself and doesn't arm the timer.
+            TimerTime_t deadline = LmHandlerPackages[i]->GetNextDeadline( );
+            if( ( deadline != 0 ) && ( deadline < nextDeadline ) )
+            {
+                nextDeadline = deadline;
+            }
         }
     }
+
+    TimerStop( &PackagesProcessTimer );
+    if( nextDeadline != LMH_PACKAGE_NO_DEADLINE )
+    {
+        TimerSetValue( &PackagesProcessTimer, nextDeadline );
+        TimerStart( &PackagesProcessTimer );
+    }
+    return nextDeadline;
+}
+
+static void OnPackagesProcessTimerEvent( void* context )
+{
+    if( LmHandlerCallbacks->OnMacProcess != NULL )
+    {
+        LmHandlerCallbacks->OnMacProcess( );
+    }
+}
+
+#if( LMHANDLER_SENSOR_CACHE_PERIOD > 0 )
+static void LmHandlerSensorCacheRefresh( void )
+{
+    if( LmHandlerCallbacks->GetBatteryLevel != NULL )
+    {
+        SensorCache.BatteryLevel = LmHandlerCallbacks->GetBatteryLevel( );
+    }
+    if( LmHandlerCallbacks->GetTemperature != NULL )
+    {
+        SensorCache.Temperature = LmHandlerCallbacks->GetTemperature( );
+    }
+    SensorCache.Time = TimerGetCurrentTime( );
+    SensorCache.IsRefreshDue = false;
+#if( LMHANDLER_SENSOR_CACHE_WAKEUP == 1 )
+    TimerStop( &SensorCacheTimer );
+    TimerSetValue( &SensorCacheTimer, LMHANDLER_SENSOR_CACHE_PERIOD );
+    TimerStart( &SensorCacheTimer );
+#endif
+}
+
+static void LmHandlerSensorCacheProcess( void )
+{
+    if( ( SensorCache.IsRefreshDue == false ) &&
+        ( ( TimerGetCurrentTime( ) - SensorCache.Time ) < LMHANDLER_SENSOR_CACHE_PERIOD ) )
+    {
+        return;
+    }
+    if( LoRaMacIsBusy( ) == true )
+    {
+        // Done on the next call, the MAC events wake up the application
+        return;
+    }
+    LmHandlerSensorCacheRefresh( );
 }
+
+static uint8_t LmHandlerSensorCacheGetBatteryLevel( void )
+{
+    return SensorCache.BatteryLevel;
+}
+
+static float LmHandlerSensorCacheGetTemperature( void )
+{
+    return SensorCache.Temperature;
+}
+
+#if( LMHANDLER_SENSOR_CACHE_WAKEUP == 1 )
+static void OnSensorCacheTimerEvent( void* context )
+{
+    SensorCache.IsRefreshDue = true;
+    if( LmHandlerCallbacks->OnMacProcess != NULL )
+    {
+        LmHandlerCallbacks->OnMacProcess( );
+    }
+}
+#endif
+#endif
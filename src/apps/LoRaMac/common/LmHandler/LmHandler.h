@@ -33,6 +33,85 @@ extern "C"
 #include "LmHandlerTypes.h"
 #include "LmhpCompliance.h"
 
+/*!
+ * Size of the application payload aggregation buffer.
+ * 242 is the largest LoRaWAN application payload.
+ */
+#ifndef LMHANDLER_AGGREGATION_BUFFER_SIZE
+#define LMHANDLER_AGGREGATION_BUFFER_SIZE           242
+#endif
+
+/*!
+ * Number of uplinks the scheduler may hold
+ */
+#ifndef LMHANDLER_UPLINK_QUEUE_SIZE
+#define LMHANDLER_UPLINK_QUEUE_SIZE                 4
+#endif
+
+/*!
+ * Maximum payload size of a scheduled uplink
+ */
+#ifndef LMHANDLER_UPLINK_BUFFER_SIZE
+#define LMHANDLER_UPLINK_BUFFER_SIZE                51
+#endif
+
+/*!
+ * Time in ms after which a scheduled uplink of the class is dropped.
+ * 0 means the uplink never expires.
+ */
+#ifndef LMHANDLER_UPLINK_ALARM_MAX_AGE
+#define LMHANDLER_UPLINK_ALARM_MAX_AGE              0
+#endif
+
+#ifndef LMHANDLER_UPLINK_MAC_ANSWER_MAX_AGE
+#define LMHANDLER_UPLINK_MAC_ANSWER_MAX_AGE         60000
+#endif
+
+#ifndef LMHANDLER_UPLINK_SYNC_MAX_AGE
+#define LMHANDLER_UPLINK_SYNC_MAX_AGE               10000
+#endif
+
+#ifndef LMHANDLER_UPLINK_TELEMETRY_MAX_AGE
+#define LMHANDLER_UPLINK_TELEMETRY_MAX_AGE          0
+#endif
+
+/*!
+ * Default time in ms after a class B or C confirmed downlink within which
+ * the \ref LORAMAC_HANDLER_ACK_POLICY_DEADLINE policy sends the ACK
+ */
+#ifndef LMHANDLER_ACK_DEADLINE
+#define LMHANDLER_ACK_DEADLINE                      2000
+#endif
+
+/*!
+ * Time in ms within which the next uplink carries the DeviceTimeReq,
+ * LinkCheckReq and PingSlotInfoReq MAC commands, an empty uplink is sent
+ * otherwise. 0 leaves them to the next application uplink, except the
+ * PingSlotInfoReq which is sent right away.
+ */
+#ifndef LMHANDLER_MAC_REQUEST_DEADLINE
+#define LMHANDLER_MAC_REQUEST_DEADLINE              0
+#endif
+
+/*!
+ * Maximum age in ms of the battery and temperature readings returned to the
+ * MAC ( DevStatusAns, Class B beacon temperature ). The readings are taken
+ * by LmHandlerProcess while the MAC is idle, so that the ADC conversions
+ * never delay the downlink processing. 0 reads the sensors from the MAC
+ * callbacks.
+ */
+#ifndef LMHANDLER_SENSOR_CACHE_PERIOD
+#define LMHANDLER_SENSOR_CACHE_PERIOD               60000
+#endif
+
+/*!
+ * When 1 a timer wakes the application up for each readings refresh. When
+ * 0 the readings are refreshed by the first LmHandlerProcess call past their
+ * maximum age, on the wake ups of the application and MAC events.
+ */
+#ifndef LMHANDLER_SENSOR_CACHE_WAKEUP
+#define LMHANDLER_SENSOR_CACHE_WAKEUP               0
+#endif
 
 typedef struct LmHandlerJoinParams_s
 {
@@ -53,6 +132,11 @@ typedef struct LmHandlerTxParams_s
     LmHandlerAppData_t AppData;
     int8_t TxPower;
     uint8_t Channel;
+    /*!
+     * Charge drawn since the previous uplink [uC]. 0 unless
+     * ENERGY_ACCOUNTING_ENABLED is defined.
+     */
+    uint32_t ChargeUc;
 }LmHandlerTxParams_t;
 
 typedef struct LmHandlerRxParams_s
@@ -240,8 +324,16 @@ bool LmHandlerIsBusy( void );
  * When no pendig operation asks to go in low power mode.
  *
  * \remark This function must be called in the main loop.
+ *
+ * \remark The packages are only processed when they have pending work. A
+ *         timer wakes up the application through
+ *         \ref LmHandlerCallbacks_t.OnMacProcess at the earliest package
+ *         deadline so that the main loop may sleep until then.
+ *
+ * \retval deadline Time in ms until the earliest package deadline or
+ *                  \ref LMH_PACKAGE_NO_DEADLINE when no package is waiting
  */
-void LmHandlerProcess( void );
+TimerTime_t LmHandlerProcess( void );
 
 /*!
  * Instructs the MAC layer to send a ClassA uplink
@@ -254,6 +346,103 @@ void LmHandlerProcess( void );
  */
 LmHandlerErrorStatus_t LmHandlerSend( LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed );
 
+/*!
+ * Appends an application record to the aggregation buffer. The records are
+ * sent together in a single uplink which saves the LoRaWAN overhead and
+ * the duty-cycle of an uplink per record.
+ *
+ * The buffer is flushed when:
+ *   - the next record doesn't fit the maximum payload of the current datarate
+ *   - a record with another port is appended
+ *   - the earliest record maxDelay expires
+ *   - \ref LmHandlerAggregationFlush is called
+ *
+ * \remark Records are concatenated as is. The application payload format
+ *         must allow the receiver to split them (e.g. Cayenne LPP).
+ *
+ * \param [IN] port          Application port of the record
+ * \param [IN] record        Record data
+ * \param [IN] recordSize    Record size
+ * \param [IN] isTxConfirmed The uplink is confirmed when at least one
+ *                           record requires an acknowledgement
+ * \param [IN] maxDelay      Maximum time in ms the record may wait in the
+ *                           buffer
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if the record has been
+ *                appended else \ref LORAMAC_HANDLER_ERROR. The record is not
+ *                appended when the buffer couldn't be flushed to make room.
+ */
+LmHandlerErrorStatus_t LmHandlerAggregate( uint8_t port, uint8_t *record, uint8_t recordSize,
+                                           LmHandlerMsgTypes_t isTxConfirmed, TimerTime_t maxDelay );
+
+/*!
+ * Sends the records of the aggregation buffer
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if the buffer has been
+ *                sent or is empty else \ref LORAMAC_HANDLER_ERROR. On error
+ *                the flush is retried by \ref LmHandlerProcess.
+ */
+LmHandlerErrorStatus_t LmHandlerAggregationFlush( void );
+
+/*!
+ * Queues an uplink in the LmHandler scheduler. The payload is copied.
+ *
+ * The scheduler sends the highest priority uplink, first queued first, at
+ * the first duty-cycle opportunity. Uplinks older than the class maximum
+ * age are dropped. A telemetry uplink replaces the queued telemetry of the
+ * same port. When ADR is disabled the datarate is raised, if needed, to the
+ * lowest one whose payload holds the uplink.
+ *
+ * \param [IN] appData       Data to be sent
+ * \param [IN] isTxConfirmed Indicates if the uplink requires an acknowledgement
+ * \param [IN] priority      Uplink priority class
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if the uplink has been
+ *                queued else \ref LORAMAC_HANDLER_ERROR. When the queue is
+ *                full the newest lowest priority uplink is dropped to make
+ *                room for a higher priority one.
+ */
+LmHandlerErrorStatus_t LmHandlerUplinkSchedule( LmHandlerAppData_t *appData, LmHandlerMsgTypes_t isTxConfirmed,
+                                                LmHandlerUplinkPriorities_t priority );
+
+/*!
+ * Indicates if the LmHandler scheduler holds an uplink of the given port
+ *
+ * \param [IN] port Application port
+ *
+ * \retval pending [true] An uplink of the port waits to be sent, [false] none
+ */
+bool LmHandlerUplinkIsPending( uint8_t port );
+
+/*!
+ * Gets the time until the MAC planner allows an uplink at the current
+ * datarate. Lets the application sample its sensors right before the uplink
+ * opportunity rather than for a frame the duty-cycle would reject.
+ *
+ * \param [IN] size Application payload size
+ *
+ * \retval delay Time in ms until the uplink opportunity. 0 when an uplink is
+ *               possible now or when the planner can't tell.
+ */
+TimerTime_t LmHandlerGetNextTxDelay( uint8_t size );
+
+/*!
+ * Sets how the class B and C confirmed downlinks are acknowledged. Class A
+ * downlinks are always acknowledged by the next uplink.
+ *
+ * With \ref LORAMAC_HANDLER_ACK_POLICY_DEADLINE any uplink sent before the
+ * deadline carries the ACK, an aggregation buffer holding records is
+ * flushed at the deadline and an empty uplink is sent otherwise.
+ *
+ * \param [IN] policy   Acknowledgement policy
+ * \param [IN] deadline Time in ms after the downlink reception within which
+ *                      the ACK is sent, \ref LMHANDLER_ACK_DEADLINE if 0
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if the policy is
+ *                valid else \ref LORAMAC_HANDLER_ERROR
+ */
+LmHandlerErrorStatus_t LmHandlerSetAckPolicy( LmHandlerAckPolicies_t policy, TimerTime_t deadline );
+
 /*!
  * Join a LoRa Network in classA
  *
@@ -270,6 +459,15 @@ void LmHandlerJoin( void );
  */
 LmHandlerFlagStatus_t LmHandlerJoinStatus( void );
 
+/*!
+ * Requests the link margin and the number of gateways which received the
+ * uplink carrying the request
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if request has been
+ *                processed else \ref LORAMAC_HANDLER_ERROR
+ */
+LmHandlerErrorStatus_t LmHandlerLinkCheckReq( void );
+
 /*!
  * Informs the server on the ping-slot periodicity to use
  *
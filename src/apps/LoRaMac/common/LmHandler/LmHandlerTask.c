@@ -0,0 +1,194 @@
+/*!
+ * \file      LmHandlerTask.c
+ *
+ * \brief     Runs the LoRaMac handler in its own task.
+ *            Application tasks defer their work to the MAC task.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "utilities.h"
+#include "board.h"
+#include "timer.h"
+#include "rtc-board.h"
+#include "LmHandler.h"
+#include "LmHandlerTask.h"
+
+/*!
+ * Work item queue entry
+ */
+typedef struct sLmHandlerTaskItem
+{
+    LmHandlerTaskWork_t Work;
+    void* Param;
+}LmHandlerTaskItem_t;
+
+/*!
+ * Operating system services. NULL when running bare metal
+ */
+static const LmHandlerTaskOs_t* TaskOs = NULL;
+
+/*!
+ * Set when the MAC task has been notified since its last processing
+ */
+static volatile uint32_t IsProcessPending = 0;
+
+/*!
+ * Work items posted to the MAC task. Accessed in critical sections.
+ */
+static LmHandlerTaskItem_t TaskQueue[LMHANDLER_TASK_QUEUE_SIZE];
+
+/*!
+ * Index of the oldest work item
+ */
+static uint8_t TaskQueueHead = 0;
+
+/*!
+ * Number of work items in the queue
+ */
+static uint8_t TaskQueueCount = 0;
+
+void LmHandlerTaskInit( const LmHandlerTaskOs_t* os )
+{
+    TaskOs = os;
+    IsProcessPending = 1;
+    TaskQueueHead = 0;
+    TaskQueueCount = 0;
+}
+
+void LmHandlerTaskNotify( void )
+{
+    IsProcessPending = 1;
+
+    if( TaskOs != NULL )
+    {
+        TaskOs->Notify( );
+    }
+}
+
+bool LmHandlerTaskPost( LmHandlerTaskWork_t work, void* param )
+{
+    bool posted = false;
+
+    if( work == NULL )
+    {
+        return false;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    if( TaskQueueCount < LMHANDLER_TASK_QUEUE_SIZE )
+    {
+        LmHandlerTaskItem_t* item = &TaskQueue[( TaskQueueHead + TaskQueueCount ) % LMHANDLER_TASK_QUEUE_SIZE];
+
+        item->Work = work;
+        item->Param = param;
+        TaskQueueCount++;
+        posted = true;
+    }
+    CRITICAL_SECTION_END( );
+
+    if( posted == true )
+    {
+        LmHandlerTaskNotify( );
+    }
+    return posted;
+}
+
+/*!
+ * \brief Removes the oldest work item from the queue
+ *
+ * \param [OUT] item Removed work item
+ *
+ * \retval status [true: an item has been removed, false: the queue is empty]
+ */
+static bool TaskQueuePop( LmHandlerTaskItem_t* item )
+{
+    bool popped = false;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( TaskQueueCount > 0 )
+    {
+        *item = TaskQueue[TaskQueueHead];
+        TaskQueueHead = ( TaskQueueHead + 1 ) % LMHANDLER_TASK_QUEUE_SIZE;
+        TaskQueueCount--;
+        popped = true;
+    }
+    CRITICAL_SECTION_END( );
+    return popped;
+}
+
+bool LmHandlerTaskProcess( void )
+{
+    LmHandlerTaskItem_t item;
+
+    AtomicExchange( &IsProcessPending, 0 );
+
+    // Runs the work posted so far. Work posted meanwhile notifies the task
+    // again and is run by the next processing.
+    for( uint8_t count = TaskQueueCount; count > 0; count-- )
+    {
+        if( TaskQueuePop( &item ) == false )
+        {
+            break;
+        }
+        item.Work( item.Param );
+    }
+
+    // The package deadlines are notified through a timer
+    LmHandlerProcess( );
+
+    return IsProcessPending != 0;
+}
+
+void LmHandlerTaskRun( void )
+{
+    while( 1 )
+    {
+        if( LmHandlerTaskProcess( ) == true )
+        {
+            continue;
+        }
+        if( TaskOs != NULL )
+        {
+            // A notification received since the processing start makes Wait
+            // return at once
+            TaskOs->Wait( );
+        }
+        else
+        {
+            CRITICAL_SECTION_BEGIN( );
+            if( IsProcessPending == 0 )
+            {
+                // The MCU wakes up through events
+                BoardLowPowerHandler( );
+            }
+            CRITICAL_SECTION_END( );
+        }
+    }
+}
+
+uint32_t LmHandlerTaskGetIdleTime( void )
+{
+    uint32_t ticks = TimerGetTicksToNextEvent( );
+
+    if( ticks == UINT32_MAX )
+    {
+        return UINT32_MAX;
+    }
+    return ( uint32_t )RtcTick2Ms( ticks );
+}
@@ -0,0 +1,140 @@
+/*!
+ * \file      LmHandlerTask.h
+ *
+ * \brief     Runs the LoRaMac handler in its own task.
+ *            Application tasks defer their work to the MAC task.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __LORAMAC_HANDLER_TASK_H__
+#define __LORAMAC_HANDLER_TASK_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * Number of work items the MAC task queue may hold
+ */
+#ifndef LMHANDLER_TASK_QUEUE_SIZE
+#define LMHANDLER_TASK_QUEUE_SIZE                   8
+#endif
+
+/*!
+ * Work item executed by the MAC task
+ *
+ * \param [IN] param Parameter given to \ref LmHandlerTaskPost
+ */
+typedef void ( *LmHandlerTaskWork_t )( void* param );
+
+/*!
+ * Operating system services used by the MAC task
+ *
+ * \remark With FreeRTOS Notify gives the MAC task notification
+ *         ( vTaskNotifyGiveFromISR / xTaskNotifyGive ) and Wait takes it
+ *         ( ulTaskNotifyTake( pdTRUE, portMAX_DELAY ) ).
+ */
+typedef struct sLmHandlerTaskOs
+{
+    /*!
+     * Wakes up the MAC task
+     *
+     * \warning Called from IRQ and task contexts.
+     */
+    void ( *Notify )( void );
+    /*!
+     * Blocks the MAC task until Notify is called. Returns at once when
+     * Notify has been called since the previous Wait.
+     */
+    void ( *Wait )( void );
+}LmHandlerTaskOs_t;
+
+/*!
+ * \brief Initializes the MAC task
+ *
+ * \remark Must be called before \ref LmHandlerInit. The application sets
+ *         \ref LmHandlerCallbacks_t.OnMacProcess to \ref LmHandlerTaskNotify.
+ *
+ * \param [IN] os Operating system services. NULL runs the MAC task as the
+ *                bare metal main loop, sleeping through
+ *                \ref BoardLowPowerHandler.
+ */
+void LmHandlerTaskInit( const LmHandlerTaskOs_t* os );
+
+/*!
+ * \brief Wakes up the MAC task
+ *
+ * \remark To be used as \ref LmHandlerCallbacks_t.OnMacProcess. The stack
+ *         calls it from the timer and radio interrupts, deferred radio IRQs
+ *         included.
+ */
+void LmHandlerTaskNotify( void );
+
+/*!
+ * \brief Defers a work item to the MAC task
+ *
+ * \remark The LoRaMac and LmHandler APIs are not reentrant. Other tasks and
+ *         IRQs post their requests ( LmHandlerSend, LmHandlerJoin, ... ) to
+ *         the MAC task instead of calling them.
+ *
+ * \remark The stack calls the LmHandler callbacks from the MAC task. The
+ *         application forwards them to its own tasks through OS queues.
+ *
+ * \param [IN] work  Function executed by the MAC task
+ * \param [IN] param Parameter given to the work function. Must stay valid
+ *                   until the work function has run.
+ *
+ * \retval status [true: posted, false: the queue is full]
+ */
+bool LmHandlerTaskPost( LmHandlerTaskWork_t work, void* param );
+
+/*!
+ * \brief Runs the pending work items and processes the LoRaMac handler
+ *
+ * \remark Called by \ref LmHandlerTaskRun. May be called instead by a main
+ *         loop having other work to do.
+ *
+ * \retval pending [true: work is pending, the caller must not sleep,
+ *                  false: the caller may sleep until notified]
+ */
+bool LmHandlerTaskProcess( void );
+
+/*!
+ * \brief Body of the MAC task. Never returns.
+ */
+void LmHandlerTaskRun( void );
+
+/*!
+ * \brief Gets the time before the next LoRaMac timer event
+ *
+ * \remark Used by a tickless idle hook ( e.g. FreeRTOS
+ *         configPRE_SLEEP_PROCESSING ) to bound the sleep duration and to
+ *         select the low power mode depth. The timer alarm wakes up the MCU
+ *         anyway.
+ *
+ * \retval time Time in ms, UINT32_MAX when no timer is running
+ */
+uint32_t LmHandlerTaskGetIdleTime( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LORAMAC_HANDLER_TASK_H__
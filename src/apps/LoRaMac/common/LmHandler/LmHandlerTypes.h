@@ -64,6 +64,34 @@ typedef enum
     LORAMAC_HANDLER_CONFIRMED_MSG = !LORAMAC_HANDLER_UNCONFIRMED_MSG
 }LmHandlerMsgTypes_t;
 
+/*!
+ * Scheduled uplinks priority classes. Lower values are sent first.
+ */
+typedef enum
+{
+    LORAMAC_HANDLER_UPLINK_PRIORITY_ALARM = 0,
+    LORAMAC_HANDLER_UPLINK_PRIORITY_MAC_ANSWER,
+    LORAMAC_HANDLER_UPLINK_PRIORITY_SYNC,
+    LORAMAC_HANDLER_UPLINK_PRIORITY_TELEMETRY,
+    LORAMAC_HANDLER_UPLINK_PRIORITY_NB
+}LmHandlerUplinkPriorities_t;
+
+/*!
+ * Acknowledgement policies of the class B and C confirmed downlinks
+ */
+typedef enum
+{
+    /*!
+     * The ACK is sent by the next application uplink
+     */
+    LORAMAC_HANDLER_ACK_POLICY_NEXT_UPLINK = 0,
+    /*!
+     * The ACK is sent by the next uplink if any is sent before the deadline,
+     * else by an empty uplink at the deadline
+     */
+    LORAMAC_HANDLER_ACK_POLICY_DEADLINE,
+}LmHandlerAckPolicies_t;
+
 /*!
  *
  */
@@ -0,0 +1,309 @@
+/*!
+ * \file      DeltaPatch.c
+ *
+ * \brief     Streaming delta patch applier for the firmware updates received
+ *            through the fragmentation package
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include "utilities.h"
+#include "crc.h"
+#include "DeltaPatch.h"
+
+/*!
+ * Buffered reader of the patch or the old image
+ */
+typedef struct sDeltaPatchReader
+{
+    uint8_t ( *Read )( uint32_t addr, uint8_t *data, uint32_t size );
+    uint32_t Size;
+    /*!
+     * Address of the next byte and of the buffered data
+     */
+    uint32_t Addr;
+    uint32_t BufferAddr;
+    uint16_t BufferSize;
+    uint8_t Buffer[DELTA_PATCH_BUFFER_SIZE];
+}DeltaPatchReader_t;
+
+/*!
+ * Applier context
+ */
+typedef struct sDeltaPatchCtx
+{
+    DeltaPatchReader_t Patch;
+    DeltaPatchReader_t Old;
+    uint8_t ( *NewWrite )( uint32_t addr, uint8_t *data, uint32_t size );
+    uint32_t NewSize;
+    uint32_t NewAddr;
+    uint32_t NewCrc;
+    uint16_t NewBufferSize;
+    uint8_t NewBuffer[DELTA_PATCH_BUFFER_SIZE];
+    int32_t Status;
+}DeltaPatchCtx_t;
+
+static DeltaPatchCtx_t Ctx;
+
+/*!
+ * \brief Reads the next byte
+ *
+ * \param [IN]  reader Patch or old image reader
+ * \param [OUT] data   Read byte
+ * \retval status      false at the end of the data or on a read error.
+ *                     Sets Ctx.Status.
+ */
+static bool ReaderGet( DeltaPatchReader_t *reader, uint8_t *data )
+{
+    uint32_t offset = reader->Addr - reader->BufferAddr;
+
+    if( reader->Addr >= reader->Size )
+    {
+        Ctx.Status = DELTA_PATCH_ERROR_FORMAT;
+        return false;
+    }
+    if( ( reader->Addr < reader->BufferAddr ) || ( offset >= reader->BufferSize ) )
+    {
+        reader->BufferAddr = reader->Addr;
+        reader->BufferSize = MIN( reader->Size - reader->Addr, DELTA_PATCH_BUFFER_SIZE );
+        if( reader->Read( reader->BufferAddr, reader->Buffer, reader->BufferSize ) != 0 )
+        {
+            reader->BufferSize = 0;
+            Ctx.Status = DELTA_PATCH_ERROR_READ;
+            return false;
+        }
+        offset = 0;
+    }
+    *data = reader->Buffer[offset];
+    reader->Addr++;
+    return true;
+}
+
+/*!
+ * \brief Reads a LEB128 varint from the patch
+ */
+static bool PatchGetVarint( uint32_t *value )
+{
+    uint8_t data;
+
+    *value = 0;
+    for( uint8_t shift = 0; shift < 35; shift += 7 )
+    {
+        if( ReaderGet( &Ctx.Patch, &data ) == false )
+        {
+            return false;
+        }
+        *value |= ( uint32_t )( data & 0x7F ) << shift;
+        if( ( data & 0x80 ) == 0 )
+        {
+            return true;
+        }
+    }
+    Ctx.Status = DELTA_PATCH_ERROR_FORMAT;
+    return false;
+}
+
+/*!
+ * \brief Appends a byte to the new image
+ */
+static bool NewPut( uint8_t data )
+{
+    if( Ctx.NewAddr + Ctx.NewBufferSize >= Ctx.NewSize )
+    {
+        Ctx.Status = DELTA_PATCH_ERROR_FORMAT;
+        return false;
+    }
+    Ctx.NewBuffer[Ctx.NewBufferSize++] = data;
+    if( Ctx.NewBufferSize == DELTA_PATCH_BUFFER_SIZE )
+    {
+        if( Ctx.NewWrite( Ctx.NewAddr, Ctx.NewBuffer, Ctx.NewBufferSize ) != 0 )
+        {
+            Ctx.Status = DELTA_PATCH_ERROR_WRITE;
+            return false;
+        }
+        Ctx.NewCrc = Crc32Update( Ctx.NewCrc, Ctx.NewBuffer, Ctx.NewBufferSize );
+        Ctx.NewAddr += Ctx.NewBufferSize;
+        Ctx.NewBufferSize = 0;
+    }
+    return true;
+}
+
+/*!
+ * \brief Writes the buffered end of the new image
+ */
+static bool NewFlush( void )
+{
+    if( Ctx.NewBufferSize == 0 )
+    {
+        return true;
+    }
+    if( Ctx.NewWrite( Ctx.NewAddr, Ctx.NewBuffer, Ctx.NewBufferSize ) != 0 )
+    {
+        Ctx.Status = DELTA_PATCH_ERROR_WRITE;
+        return false;
+    }
+    Ctx.NewCrc = Crc32Update( Ctx.NewCrc, Ctx.NewBuffer, Ctx.NewBufferSize );
+    Ctx.NewAddr += Ctx.NewBufferSize;
+    Ctx.NewBufferSize = 0;
+    return true;
+}
+
+/*!
+ * \brief Applies the diff part of a record
+ *
+ * \param [IN] size Number of bytes produced by the diff
+ */
+static bool ApplyDiff( uint32_t size )
+{
+    while( size > 0 )
+    {
+        uint32_t token;
+        uint32_t count;
+        bool delta;
+
+        if( PatchGetVarint( &token ) == false )
+        {
+            return false;
+        }
+        delta = ( token & 0x01 ) != 0;
+        count = token >> 1;
+        if( ( count == 0 ) || ( count > size ) )
+        {
+            Ctx.Status = DELTA_PATCH_ERROR_FORMAT;
+            return false;
+        }
+        size -= count;
+        while( count-- > 0 )
+        {
+            uint8_t old;
+            uint8_t add = 0;
+
+            if( ReaderGet( &Ctx.Old, &old ) == false )
+            {
+                return false;
+            }
+            if( ( delta == true ) && ( ReaderGet( &Ctx.Patch, &add ) == false ) )
+            {
+                return false;
+            }
+            if( NewPut( old + add ) == false )
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+int32_t DeltaPatchApply( const DeltaPatchParams_t *params )
+{
+    uint8_t header[DELTA_PATCH_HEADER_SIZE];
+    uint32_t crc;
+
+    if( ( params == NULL ) || ( params->PatchRead == NULL ) || ( params->OldRead == NULL ) ||
+        ( params->NewWrite == NULL ) || ( params->PatchSize < DELTA_PATCH_HEADER_SIZE ) )
+    {
+        return DELTA_PATCH_ERROR_HEADER;
+    }
+
+    memset1( ( uint8_t* )&Ctx, 0, sizeof( Ctx ) );
+    Ctx.Status = 0;
+    Ctx.Patch.Read = params->PatchRead;
+    Ctx.Patch.Size = params->PatchSize;
+    Ctx.Old.Read = params->OldRead;
+    Ctx.Old.Size = params->OldSize;
+    Ctx.NewWrite = params->NewWrite;
+    Ctx.NewCrc = 0xFFFFFFFF;
+
+    for( uint8_t i = 0; i < DELTA_PATCH_HEADER_SIZE; i++ )
+    {
+        if( ReaderGet( &Ctx.Patch, &header[i] ) == false )
+        {
+            return DELTA_PATCH_ERROR_READ;
+        }
+    }
+    for( uint8_t i = 0; i < 4; i++ )
+    {
+        if( header[i] != ( uint8_t )DELTA_PATCH_MAGIC[i] )
+        {
+            return DELTA_PATCH_ERROR_HEADER;
+        }
+    }
+    Ctx.NewSize = ( uint32_t )header[4] | ( ( uint32_t )header[5] << 8 ) |
+                  ( ( uint32_t )header[6] << 16 ) | ( ( uint32_t )header[7] << 24 );
+    crc = ( uint32_t )header[8] | ( ( uint32_t )header[9] << 8 ) |
+          ( ( uint32_t )header[10] << 16 ) | ( ( uint32_t )header[11] << 24 );
+    if( ( Ctx.NewSize > params->NewMaxSize ) || ( Ctx.NewSize > INT32_MAX ) )
+    {
+        return DELTA_PATCH_ERROR_HEADER;
+    }
+
+    while( ( Ctx.NewAddr + Ctx.NewBufferSize ) < Ctx.NewSize )
+    {
+        uint32_t size;
+        uint32_t adjust;
+        uint8_t data;
+
+        // Diff
+        if( ( PatchGetVarint( &size ) == false ) || ( ApplyDiff( size ) == false ) )
+        {
+            return Ctx.Status;
+        }
+
+        // Extra
+        if( PatchGetVarint( &size ) == false )
+        {
+            return Ctx.Status;
+        }
+        while( size-- > 0 )
+        {
+            if( ( ReaderGet( &Ctx.Patch, &data ) == false ) || ( NewPut( data ) == false ) )
+            {
+                return Ctx.Status;
+            }
+        }
+
+        // Old image position adjustment
+        if( PatchGetVarint( &adjust ) == false )
+        {
+            return Ctx.Status;
+        }
+        if( ( adjust & 0x01 ) != 0 )
+        {
+            adjust = ( adjust >> 1 ) + 1;
+            if( adjust > Ctx.Old.Addr )
+            {
+                return DELTA_PATCH_ERROR_FORMAT;
+            }
+            Ctx.Old.Addr -= adjust;
+        }
+        else
+        {
+            Ctx.Old.Addr += adjust >> 1;
+        }
+    }
+
+    if( NewFlush( ) == false )
+    {
+        return Ctx.Status;
+    }
+    if( ( Ctx.NewCrc ^ 0xFFFFFFFF ) != crc )
+    {
+        return DELTA_PATCH_ERROR_CRC;
+    }
+    return ( int32_t )Ctx.NewSize;
+}
@@ -0,0 +1,135 @@
+/*!
+ * \file      DeltaPatch.h
+ *
+ * \brief     Streaming delta patch applier for the firmware updates received
+ *            through the fragmentation package
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __DELTA_PATCH_H__
+#define __DELTA_PATCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * Size of each of the patch, old image and new image buffers. The RAM used
+ * by the applier is about 3 times this size, whatever the image size.
+ */
+#ifndef DELTA_PATCH_BUFFER_SIZE
+#define DELTA_PATCH_BUFFER_SIZE                     64
+#endif
+
+/*!
+ * Patch file format, little endian, created by tools/delta-patch.py
+ *
+ * Header: "LDP1" magic, new image size ( uint32 ), new image CRC32 ( uint32 )
+ *
+ * Records, until the new image size is reached:
+ *   - diff length ( varint ), then tokens until diff length bytes are
+ *     produced. Token ( varint ) bit 0 cleared: token >> 1 bytes copied from
+ *     the old image. Bit 0 set: token >> 1 delta bytes follow, each added to
+ *     the old image byte. The old image position advances with the diff.
+ *   - extra length ( varint ), then the extra bytes copied as they are
+ *   - old image position adjustment ( zigzag varint )
+ *
+ * The varints are LEB128, 7 bits per byte, least significant first.
+ */
+#define DELTA_PATCH_MAGIC                           "LDP1"
+#define DELTA_PATCH_HEADER_SIZE                     12
+
+/*!
+ * Applier status, the new image size is returned on success
+ */
+#define DELTA_PATCH_ERROR_HEADER                    ( int32_t )-1
+#define DELTA_PATCH_ERROR_FORMAT                    ( int32_t )-2
+#define DELTA_PATCH_ERROR_READ                      ( int32_t )-3
+#define DELTA_PATCH_ERROR_WRITE                     ( int32_t )-4
+#define DELTA_PATCH_ERROR_CRC                       ( int32_t )-5
+
+/*!
+ * Delta patch applier parameters
+ */
+typedef struct sDeltaPatchParams
+{
+    /*!
+     * Reads the patch file, typically the FragDecoderRead callback of the
+     * session which received it
+     *
+     * \param [IN] addr Address start index to read from.
+     * \param [IN] data Data buffer to be read.
+     * \param [IN] size Size of data buffer to be read.
+     *
+     * \retval status Read operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *PatchRead )( uint32_t addr, uint8_t *data, uint32_t size );
+    /*!
+     * Patch file size
+     */
+    uint32_t PatchSize;
+    /*!
+     * Reads the running image
+     *
+     * \param [IN] addr Address start index to read from.
+     * \param [IN] data Data buffer to be read.
+     * \param [IN] size Size of data buffer to be read.
+     *
+     * \retval status Read operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *OldRead )( uint32_t addr, uint8_t *data, uint32_t size );
+    /*!
+     * Running image size
+     */
+    uint32_t OldSize;
+    /*!
+     * Writes the new image, to the second flash bank or an external flash.
+     * Called with increasing addresses, the area must be erased beforehand.
+     *
+     * \param [IN] addr Address start index to write to.
+     * \param [IN] data Data buffer to be written.
+     * \param [IN] size Size of data buffer to be written.
+     *
+     * \retval status Write operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *NewWrite )( uint32_t addr, uint8_t *data, uint32_t size );
+    /*!
+     * Size of the new image area
+     */
+    uint32_t NewMaxSize;
+}DeltaPatchParams_t;
+
+/*!
+ * \brief Applies a delta patch to the running image
+ *
+ * \remark The patch, the old image and the new image are streamed through
+ *         DELTA_PATCH_BUFFER_SIZE byte buffers. The new image CRC32 given by
+ *         the header is checked once the image is written.
+ *
+ * \param [IN] params Applier parameters
+ *
+ * \retval status New image size, or a negative DELTA_PATCH_ERROR_XXX
+ */
+int32_t DeltaPatchApply( const DeltaPatchParams_t *params );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __DELTA_PATCH_H__
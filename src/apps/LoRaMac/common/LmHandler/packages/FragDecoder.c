@@ -23,6 +23,9 @@
 #include <stddef.h>
 #include <stdbool.h>
 #include "utilities.h"
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+#include "crc.h"
+#endif
 #include "FragDecoder.h"
 
 #define DBG_TRACE                                   0
@@ -41,6 +44,22 @@
     #define DBG( fmt, ... )
 #endif
 
+/*!
+ * Decoding work buffers, shared by the decoder instances instead of being
+ * allocated on the stack by each FragDecoderProcess call
+ */
+static struct
+{
+    /*!
+     * Data row. Holds the erased rows during FragDecoderInit.
+     */
+    uint8_t Row[FRAG_MAX_SIZE];
+    /*!
+     * Parity bit arrays of the missing fragments
+     */
+    uint8_t Vector[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+    uint8_t Vector2[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+}FragWork;
 
 /*
  *=============================================================================
@@ -48,35 +67,16 @@
  *=============================================================================
  */
 
-typedef struct
-{
-#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-    FragDecoderCallbacks_t *Callbacks;
-#else
-    uint8_t *File;
-    uint32_t FileSize;
-#endif
-    uint16_t FragNb;
-    uint8_t FragSize;
-
-    uint32_t M2BLine;
-    uint8_t MatrixM2B[( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY];
-    uint16_t FragNbMissingIndex[FRAG_MAX_NB];
-
-    uint8_t S[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
-
-    FragDecoderStatus_t Status;
-}FragDecoder_t;
-
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
  * \brief Sets a row from source into file destination
  *
+ * \param [IN] decoder Decoder context
  * \param [IN] src  Source buffer pointer
  * \param [IN] row  Destination index of the row to be copied
  * \param [IN] size Source number of bytes to be copied
  */
-static void SetRow( uint8_t *src, uint16_t row, uint16_t size );
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size );
 #else
 /*!
  * \brief Sets a row from source into destination
@@ -89,15 +89,46 @@ static void SetRow( uint8_t *src, uint16_t row, uint16_t size );
 static void SetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size );
 #endif
 
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 ) && ( FRAG_DECODER_PAGE_CACHE_NB > 0 )
+/*!
+ * \brief Gets the cached page holding a file address, loads it on a miss
+ *
+ * \param [IN] decoder Decoder context
+ * \param [IN] addr File address
+ *
+ * \retval page Cached page
+ */
+static FragDecoderPage_t* FragCacheGetPage( FragDecoder_t *decoder, uint32_t addr );
+
+/*!
+ * \brief Writes all the dirty cached pages back to the file
+ *
+ * \param [IN] decoder Decoder context
+ */
+static void FragCacheFlush( FragDecoder_t *decoder );
+#endif
+
+/*!
+ * \brief Decodes a received frame, see \ref FragDecoderProcess
+ *
+ * \param [IN] decoder     Decoder context
+ * \param [IN] fragCounter Fragment counter
+ * \param [IN] rawData     Pointer to the fragment to be processed
+ *
+ * \retval status          Process status
+ */
+static int32_t FragDecoderProcessFrame( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData );
+
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
  * \brief Gets a row from source and stores it into file destination
  *
+ * \param [IN] decoder Decoder context
  * \param [IN] src  Source buffer pointer
  * \param [IN] row  Source index of the row to be copied
  * \param [IN] size Source number of bytes to be copied
  */
-static void GetRow( uint8_t *src, uint16_t row, uint16_t size );
+static void GetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size );
 #else
 /*!
  * \brief Gets a row from source and stores it into destination
@@ -172,11 +203,22 @@ static int32_t FragPrbs23( int32_t value );
 /*!
  * \brief Gets and fills the parity matrix
  *
+ * \param [IN] decoder   Decoder context
  * \param [IN]  n         Fragment N
  * \param [IN]  m         Fragment number
  * \param [OUT] matrixRow Parity matrix
  */
-static void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t *matrixRow );
+static void FragGetParityMatrixRow( FragDecoder_t *decoder, int32_t n, int32_t m, uint8_t *matrixRow );
+
+/*!
+ * \brief Computes a PRBS23 value modulo the parity matrix rows modulus
+ *
+ * \param [IN] decoder Decoder context
+ * \param [IN] x PRBS23 value
+ *
+ * \retval r    x modulo decoder->RowModulus
+ */
+static uint32_t FragRowModulo( FragDecoder_t *decoder, int32_t x );
 
 /*!
  * \brief Finds the index of the first one in a bit array
@@ -199,37 +241,59 @@ static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size );
 /*!
  * \brief Finds & marks missing fragments
  *
+ * \param [IN] decoder Decoder context
  * \param [IN]  counter Current fragment counter
- * \param [OUT] FragDecoder.FragNbMissingIndex[] array is updated in place
+ * \param [OUT] decoder->FragMissingList[] array is updated in place
+ */
+static void FragFindMissingFrags( FragDecoder_t *decoder, uint16_t counter );
+
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+/*!
+ * \brief Adds the next row of the file to the file CRC
+ *
+ * \param [IN] decoder Decoder context
+ * \param [IN] row     Row index, ignored unless it is the next row to hash
+ * \param [IN] data    Row data. NULL for a missing row, hashed as zeros
+ */
+static void FragFileCrcAddRow( FragDecoder_t *decoder, uint16_t row, uint8_t *data );
+
+/*!
+ * \brief Adds the recovered rows to the file CRC once the decoding ends
+ *
+ * \param [IN] decoder Decoder context
  */
-static void FragFindMissingFrags( uint16_t counter );
+static void FragFileCrcFinalize( FragDecoder_t *decoder );
+#endif
 
 /*!
  * \brief Finds the index (frag counter) of the x th missing frag
  *
+ * \param [IN] decoder Decoder context
  * \param [IN] x   x th missing frag
  *
  * \retval counter The counter value associated to the x th missing frag
  */
-static uint16_t FragFindMissingIndex( uint16_t x );
+static uint16_t FragFindMissingIndex( FragDecoder_t *decoder, uint16_t x );
 
 /*!
  * \brief Extacts a row from the binary matrix and expands it to a bitArray
  *
+ * \param [IN] decoder   Decoder context
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*!
  * \brief Collapses and Pushs a row of a bit array to the matrix
  *
+ * \param [IN] decoder   Decoder context
  * \param [IN] bitArray  Pointer to the bit array
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow );
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow );
 
 /*
  *=============================================================================
@@ -237,57 +301,84 @@ static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, ui
  *=============================================================================
  */
 
-static FragDecoder_t FragDecoder;
-
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks )
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks )
 #else
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize )
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize )
 #endif
 {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-    FragDecoder.Callbacks = callbacks;
+    decoder->Callbacks = callbacks;
+#if( FRAG_DECODER_PAGE_CACHE_NB > 0 )
+    for( uint8_t i = 0; i < FRAG_DECODER_PAGE_CACHE_NB; i++ )
+    {
+        decoder->Pages[i].Valid = false;
+        decoder->Pages[i].Dirty = false;
+    }
+    decoder->PageUseCounter = 0;
+#endif
 #else
-    FragDecoder.File = file;
-    FragDecoder.FileSize = fileSize;
+    decoder->File = file;
+    decoder->FileSize = fileSize;
 #endif
-    FragDecoder.FragNb = fragNb;                                // FragNb = FRAG_MAX_SIZE
-    FragDecoder.FragSize = fragSize;                            // number of byte on a row
-    FragDecoder.Status.FragNbLastRx = 0;
-    FragDecoder.Status.FragNbLost = 0;
-    FragDecoder.M2BLine = 0;
-
-    // Initialize missing fragments index array
-    for( uint16_t i = 0; i < FRAG_MAX_NB; i++ )
+    decoder->FragNb = fragNb;                                // FragNb = FRAG_MAX_SIZE
+    decoder->FragSize = fragSize;                            // number of byte on a row
+    decoder->Status.FragNbLastRx = 0;
+    decoder->Status.FragNbLost = 0;
+    decoder->M2BLine = 0;
+    // The rows modulus is computed by the first coded fragment
+    decoder->RowModulusFragNb = 0;
+
+    // Initialize missing fragments list
+    for( uint16_t i = 0; i < FRAG_MAX_REDUNDANCY; i++ )
     {
-        FragDecoder.FragNbMissingIndex[i] = 1;
+        decoder->FragMissingList[i] = 0;
     }
 
     // Initialize parity matrix
     for( uint32_t i = 0; i < ( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ); i++ )
     {
-        FragDecoder.S[i] = 0;
+        decoder->S[i] = 0;
     }
 
-    for( uint32_t i = 0; i < ( ( ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 ) * FRAG_MAX_REDUNDANCY ); i++ )
+    for( uint32_t i = 0; i < FRAG_MATRIX_M2B_SIZE; i++ )
     {
-       FragDecoder.MatrixM2B[i] = 0xFF;
+       decoder->MatrixM2B[i] = 0xFF;
     }
     
     // Initialize final uncoded data buffer ( FRAG_MAX_NB * FRAG_MAX_SIZE )
-    for( uint32_t i = 0; i < ( fragNb * fragSize ); i++ )
-    {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-        if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderWrite != NULL ) )
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderErase != NULL ) )
+    {
+        // Let the flash driver erase whole sectors
+        decoder->Callbacks->FragDecoderErase( 0, ( uint32_t )fragNb * fragSize );
+    }
+    else if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderWrite != NULL ) )
+    {
+        uint32_t fileSize = ( uint32_t )fragNb * fragSize;
+
+        // Erase up to FRAG_MAX_SIZE bytes per write, large files have
+        // thousands of fragments
+        memset1( FragWork.Row, 0xFF, FRAG_MAX_SIZE );
+        for( uint32_t i = 0; i < fileSize; i += FRAG_MAX_SIZE )
         {
-            FragDecoder.Callbacks->FragDecoderWrite( i, ( uint8_t[] ){ 0xFF }, 1 );
+            decoder->Callbacks->FragDecoderWrite( i, FragWork.Row, MIN( fileSize - i, FRAG_MAX_SIZE ) );
         }
+    }
 #else
-        FragDecoder.File[i] = 0xFF;
-#endif
+    for( uint32_t i = 0; i < ( fragNb * fragSize ); i++ )
+    {
+        decoder->File[i] = 0xFF;
     }
-    FragDecoder.Status.FragNbLost = 0;
-    FragDecoder.Status.FragNbLastRx = 0;
+#endif
+    decoder->Status.FragNbLost = 0;
+    decoder->Status.FragNbLastRx = 0;
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+    decoder->FileCrc = 0xFFFFFFFF;
+    decoder->FileCrcSize = ( uint32_t )fragNb * fragSize;
+    decoder->FileCrcRows = 0;
+    decoder->FileCrcDone = false;
+#endif
 }
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -297,86 +388,124 @@ uint32_t FragDecoderGetMaxFileSize( void )
 }
 #endif
 
-int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
+int32_t FragDecoderProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData )
+{
+    int32_t status = FragDecoderProcessFrame( decoder, fragCounter, rawData );
+
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+    if( status >= 0 )
+    {
+        FragFileCrcFinalize( decoder );
+    }
+#endif
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 ) && ( FRAG_DECODER_PAGE_CACHE_NB > 0 )
+    if( status != FRAG_SESSION_ONGOING )
+    {
+        // The application reads the file once the session ends
+        FragCacheFlush( decoder );
+    }
+#endif
+    return status;
+}
+
+static int32_t FragDecoderProcessFrame( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData )
 {
     uint16_t firstOneInRow = 0;
     int32_t first = 0;
     int32_t noInfo = 0;
+    uint16_t missing = 0;
 
-    uint8_t matrixRow[(FRAG_MAX_NB >> 3 ) + 1];
-    uint8_t matrixDataTemp[FRAG_MAX_SIZE];
-    uint8_t dataTempVector[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
-    uint8_t dataTempVector2[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+    uint8_t *matrixDataTemp = FragWork.Row;
+    uint8_t *dataTempVector = FragWork.Vector;
+    uint8_t *dataTempVector2 = FragWork.Vector2;
 
-    memset1( matrixRow, 0, ( FRAG_MAX_NB >> 3 ) + 1 );
     memset1( matrixDataTemp, 0, FRAG_MAX_SIZE );
     memset1( dataTempVector, 0, ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 );
     memset1( dataTempVector2, 0, ( FRAG_MAX_REDUNDANCY >> 3 ) + 1 );
 
-    FragDecoder.Status.FragNbRx = fragCounter;
+    decoder->Status.FragNbRx = fragCounter;
 
-    if( fragCounter < FragDecoder.Status.FragNbLastRx )
+    if( fragCounter < decoder->Status.FragNbLastRx )
     {
         return FRAG_SESSION_ONGOING;  // Drop frame out of order
     }
 
     // The M (FragNb) first packets aren't encoded or in other words they are
     // encoded with the unitary matrix
-    if( fragCounter < ( FragDecoder.FragNb + 1 ) )
+    if( fragCounter < ( decoder->FragNb + 1 ) )
     {
         // The M first frame are not encoded store them
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-        SetRow( rawData, fragCounter - 1, FragDecoder.FragSize );
+        SetRow( decoder, rawData, fragCounter - 1, decoder->FragSize );
 #else
-        SetRow( FragDecoder.File, rawData, fragCounter - 1, FragDecoder.FragSize );
+        SetRow( decoder->File, rawData, fragCounter - 1, decoder->FragSize );
 #endif
 
-        FragDecoder.FragNbMissingIndex[fragCounter - 1] = 0;
-
-        // Update the FragDecoder.FragNbMissingIndex with the loosing frame
-        FragFindMissingFrags( fragCounter );
+        // Update the decoder->FragMissingList with the loosing frame
+        FragFindMissingFrags( decoder, fragCounter );
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+        // Hashed from RAM, the row is never read back
+        FragFileCrcAddRow( decoder, fragCounter - 1, rawData );
+#endif
     }
     else
     {
-        if( FragDecoder.Status.FragNbLost > FRAG_MAX_REDUNDANCY )
-        {
-           FragDecoder.Status.MatrixError = 1;
-           return FRAG_SESSION_FINISHED;
-        }
         // At this point we receive encoded frames and the number of loosing frames
-        // is well known: FragDecoder.FragNbLost - 1;
+        // is well known: decoder->FragNbLost - 1;
 
         // In case of the end of true data is missing
-        FragFindMissingFrags( fragCounter );
+        FragFindMissingFrags( decoder, fragCounter );
 
-        if( FragDecoder.Status.FragNbLost == 0 )
+        if( decoder->Status.FragNbLost > FRAG_MAX_REDUNDANCY )
+        {
+           decoder->Status.MatrixError = 1;
+           return FRAG_SESSION_FINISHED;
+        }
+
+        if( decoder->Status.FragNbLost == 0 )
         { 
             // the case : all the M(FragNb) first rows have been transmitted with no error
-            return FragDecoder.Status.FragNbLost;
+            return decoder->Status.FragNbLost;
         }
 
-        // fragCounter - FragDecoder.FragNb
-        FragGetParityMatrixRow( fragCounter - FragDecoder.FragNb, FragDecoder.FragNb, matrixRow );
+        // fragCounter - decoder->FragNb
+        FragGetParityMatrixRow( decoder, fragCounter - decoder->FragNb, decoder->FragNb, decoder->MatrixRow );
 
-        for( int32_t i = 0; i < FragDecoder.FragNb; i++ )
+        for( int32_t i = 0; i < decoder->FragNb; i++ )
         {
-            if( GetParity( i , matrixRow ) == 1 )
+            if( ( i & 0x07 ) == 0 )
             {
-                if( FragDecoder.FragNbMissingIndex[i] == 0 )
+                // Skip the packed parity bytes without coefficients
+                while( ( i < decoder->FragNb ) && ( decoder->MatrixRow[i >> 3] == 0 ) )
+                {
+                    i += 8;
+                }
+                if( i >= decoder->FragNb )
+                {
+                    break;
+                }
+            }
+            if( GetParity( i , decoder->MatrixRow ) == 1 )
+            {
+                // The missing fragments list is sorted, walk it along the row
+                while( ( missing < decoder->Status.FragNbLost ) && ( decoder->FragMissingList[missing] < i ) )
+                {
+                    missing++;
+                }
+                if( ( missing >= decoder->Status.FragNbLost ) || ( decoder->FragMissingList[missing] != i ) )
                 {
                     // XOR with already receive frag
-                    SetParity( i, matrixRow, 0 );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                    GetRow( matrixDataTemp, i, FragDecoder.FragSize );
+                    GetRow( decoder, matrixDataTemp, i, decoder->FragSize );
 #else
-                    GetRow( matrixDataTemp, FragDecoder.File, i, FragDecoder.FragSize );
+                    GetRow( matrixDataTemp, decoder->File, i, decoder->FragSize );
 #endif
-                    XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
+                    XorDataLine( rawData, matrixDataTemp, decoder->FragSize );
                 }
                 else
                 {
                     // Fill the "little" boolean matrix m2b
-                    SetParity( FragDecoder.FragNbMissingIndex[i] - 1, dataTempVector, 1 );
+                    SetParity( missing, dataTempVector, 1 );
                     if( first == 0 )
                     {
                         first = 1;
@@ -385,7 +514,7 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
             }
         }
 
-        firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+        firstOneInRow = BitArrayFindFirstOne( dataTempVector, decoder->Status.FragNbLost );
 
         if( first > 0 )
         {
@@ -393,85 +522,85 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
             int32_t lj;
 
             // Manage a new line in MatrixM2B
-            while( GetParity( firstOneInRow, FragDecoder.S ) == 1 )
+            while( GetParity( firstOneInRow, decoder->S ) == 1 )
             { 
-                // Row already diagonalized exist & ( FragDecoder.MatrixM2B[firstOneInRow][0] )
-                FragExtractLineFromBinaryMatrix( dataTempVector2, firstOneInRow, FragDecoder.Status.FragNbLost );
-                XorParityLine( dataTempVector, dataTempVector2, FragDecoder.Status.FragNbLost );
+                // Row already diagonalized exist & ( decoder->MatrixM2B[firstOneInRow][0] )
+                FragExtractLineFromBinaryMatrix( decoder, dataTempVector2, firstOneInRow, decoder->Status.FragNbLost );
+                XorParityLine( dataTempVector, dataTempVector2, decoder->Status.FragNbLost );
                 // Have to store it in the mi th position of the missing frag
-                li = FragFindMissingIndex( firstOneInRow );
+                li = FragFindMissingIndex( decoder, firstOneInRow );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                GetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                GetRow( decoder, matrixDataTemp, li, decoder->FragSize );
 #else
-                GetRow( matrixDataTemp, FragDecoder.File, li, FragDecoder.FragSize );
+                GetRow( matrixDataTemp, decoder->File, li, decoder->FragSize );
 #endif
-                XorDataLine( rawData, matrixDataTemp, FragDecoder.FragSize );
-                if( BitArrayIsAllZeros( dataTempVector, FragDecoder.Status.FragNbLost ) )
+                XorDataLine( rawData, matrixDataTemp, decoder->FragSize );
+                if( BitArrayIsAllZeros( dataTempVector, decoder->Status.FragNbLost ) )
                 {
                     noInfo = 1;
                     break;
                 }
-                firstOneInRow = BitArrayFindFirstOne( dataTempVector, FragDecoder.Status.FragNbLost );
+                firstOneInRow = BitArrayFindFirstOne( dataTempVector, decoder->Status.FragNbLost );
             }
 
             if( noInfo == 0 )
             {
-                FragPushLineToBinaryMatrix( dataTempVector, firstOneInRow, FragDecoder.Status.FragNbLost );
-                li = FragFindMissingIndex( firstOneInRow );
+                FragPushLineToBinaryMatrix( decoder, dataTempVector, firstOneInRow, decoder->Status.FragNbLost );
+                li = FragFindMissingIndex( decoder, firstOneInRow );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                SetRow( rawData, li, FragDecoder.FragSize );
+                SetRow( decoder, rawData, li, decoder->FragSize );
 #else
-                SetRow( FragDecoder.File, rawData, li, FragDecoder.FragSize );
+                SetRow( decoder->File, rawData, li, decoder->FragSize );
 #endif
-                SetParity( firstOneInRow, FragDecoder.S, 1 );
-                FragDecoder.M2BLine++;
+                SetParity( firstOneInRow, decoder->S, 1 );
+                decoder->M2BLine++;
             }
 
-            if( FragDecoder.M2BLine == FragDecoder.Status.FragNbLost )
+            if( decoder->M2BLine == decoder->Status.FragNbLost )
             { 
                 // Then last step diagonalized
-                if( FragDecoder.Status.FragNbLost > 1 )
+                if( decoder->Status.FragNbLost > 1 )
                 {
                     int32_t i, j;
 
-                    for( i = ( FragDecoder.Status.FragNbLost - 2 ); i >= 0 ; i-- )
+                    for( i = ( decoder->Status.FragNbLost - 2 ); i >= 0 ; i-- )
                     {
-                        li = FragFindMissingIndex( i );
+                        li = FragFindMissingIndex( decoder, i );
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                        GetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                        GetRow( decoder, matrixDataTemp, li, decoder->FragSize );
 #else
-                        GetRow( matrixDataTemp, FragDecoder.File, li, FragDecoder.FragSize );
+                        GetRow( matrixDataTemp, decoder->File, li, decoder->FragSize );
 #endif
-                        for( j = ( FragDecoder.Status.FragNbLost - 1 ); j > i; j--)
+                        for( j = ( decoder->Status.FragNbLost - 1 ); j > i; j--)
                         {
-                            FragExtractLineFromBinaryMatrix( dataTempVector2, i, FragDecoder.Status.FragNbLost );
-                            FragExtractLineFromBinaryMatrix( dataTempVector, j, FragDecoder.Status.FragNbLost );
+                            FragExtractLineFromBinaryMatrix( decoder, dataTempVector2, i, decoder->Status.FragNbLost );
+                            FragExtractLineFromBinaryMatrix( decoder, dataTempVector, j, decoder->Status.FragNbLost );
                             if( GetParity( j, dataTempVector2 ) == 1 )
                             {
-                                XorParityLine( dataTempVector2, dataTempVector, FragDecoder.Status.FragNbLost );
+                                XorParityLine( dataTempVector2, dataTempVector, decoder->Status.FragNbLost );
 
-                                lj = FragFindMissingIndex( j );
+                                lj = FragFindMissingIndex( decoder, j );
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                                GetRow( rawData, lj, FragDecoder.FragSize );
+                                GetRow( decoder, rawData, lj, decoder->FragSize );
 #else
-                                GetRow( rawData, FragDecoder.File, lj, FragDecoder.FragSize );
+                                GetRow( rawData, decoder->File, lj, decoder->FragSize );
 #endif
-                                XorDataLine( matrixDataTemp , rawData , FragDecoder.FragSize );
+                                XorDataLine( matrixDataTemp , rawData , decoder->FragSize );
                             }
                         }
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                        SetRow( matrixDataTemp, li, FragDecoder.FragSize );
+                        SetRow( decoder, matrixDataTemp, li, decoder->FragSize );
 #else
-                        SetRow( FragDecoder.File, matrixDataTemp, li, FragDecoder.FragSize );
+                        SetRow( decoder->File, matrixDataTemp, li, decoder->FragSize );
 #endif
                     }
-                    return FragDecoder.Status.FragNbLost;
+                    return decoder->Status.FragNbLost;
                 }
                 else
                 { 
-                    //If not ( FragDecoder.FragNbLost > 1 )
-                    return FragDecoder.Status.FragNbLost;
+                    //If not ( decoder->FragNbLost > 1 )
+                    return decoder->Status.FragNbLost;
                 }
             }
         }
@@ -479,9 +608,9 @@ int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData )
     return FRAG_SESSION_ONGOING;
 }
 
-FragDecoderStatus_t FragDecoderGetStatus( void )
+FragDecoderStatus_t FragDecoderGetStatus( FragDecoder_t *decoder )
 { 
-    return FragDecoder.Status;
+    return decoder->Status;
 }
 
 /*
@@ -491,21 +620,116 @@ FragDecoderStatus_t FragDecoderGetStatus( void )
  */
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-static void SetRow( uint8_t *src, uint16_t row, uint16_t size )
+#if( FRAG_DECODER_PAGE_CACHE_NB > 0 )
+static void FragCacheWritePage( FragDecoder_t *decoder, FragDecoderPage_t* page )
 {
-    if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderWrite != NULL ) )
+    uint32_t fileSize = ( uint32_t )decoder->FragNb * decoder->FragSize;
+
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderWrite != NULL ) )
     {
-        FragDecoder.Callbacks->FragDecoderWrite( row * size, src, size );
+        decoder->Callbacks->FragDecoderWrite( page->Addr, page->Data, MIN( fileSize - page->Addr, FRAG_DECODER_PAGE_SIZE ) );
     }
+    page->Dirty = false;
 }
 
-static void GetRow( uint8_t *dst, uint16_t row, uint16_t size )
+static FragDecoderPage_t* FragCacheGetPage( FragDecoder_t *decoder, uint32_t addr )
 {
-    if( ( FragDecoder.Callbacks != NULL ) && ( FragDecoder.Callbacks->FragDecoderRead != NULL ) )
+    uint32_t fileSize = ( uint32_t )decoder->FragNb * decoder->FragSize;
+    FragDecoderPage_t* page = &decoder->Pages[0];
+
+    addr -= addr % FRAG_DECODER_PAGE_SIZE;
+
+    for( uint8_t i = 0; i < FRAG_DECODER_PAGE_CACHE_NB; i++ )
     {
-        FragDecoder.Callbacks->FragDecoderRead( row * size, dst, size );
+        if( ( decoder->Pages[i].Valid == true ) && ( decoder->Pages[i].Addr == addr ) )
+        {
+            decoder->Pages[i].LastUse = ++decoder->PageUseCounter;
+            return &decoder->Pages[i];
+        }
+        // Evict a free page first, the least recently used one otherwise
+        if( ( page->Valid == true ) &&
+            ( ( decoder->Pages[i].Valid == false ) || ( decoder->Pages[i].LastUse < page->LastUse ) ) )
+        {
+            page = &decoder->Pages[i];
+        }
     }
+
+    if( page->Dirty == true )
+    {
+        FragCacheWritePage( decoder, page );
+    }
+    page->Addr = addr;
+    page->Valid = true;
+    page->LastUse = ++decoder->PageUseCounter;
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderRead != NULL ) )
+    {
+        decoder->Callbacks->FragDecoderRead( addr, page->Data, MIN( fileSize - addr, FRAG_DECODER_PAGE_SIZE ) );
+    }
+    return page;
 }
+
+static void FragCacheFlush( FragDecoder_t *decoder )
+{
+    for( uint8_t i = 0; i < FRAG_DECODER_PAGE_CACHE_NB; i++ )
+    {
+        if( decoder->Pages[i].Dirty == true )
+        {
+            FragCacheWritePage( decoder, &decoder->Pages[i] );
+        }
+    }
+}
+
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size )
+{
+    uint32_t addr = ( uint32_t )row * size;
+
+    while( size > 0 )
+    {
+        FragDecoderPage_t* page = FragCacheGetPage( decoder, addr );
+        uint16_t offset = addr - page->Addr;
+        uint16_t len = MIN( size, FRAG_DECODER_PAGE_SIZE - offset );
+
+        memcpy1( &page->Data[offset], src, len );
+        page->Dirty = true;
+        src += len;
+        addr += len;
+        size -= len;
+    }
+}
+
+static void GetRow( FragDecoder_t *decoder, uint8_t *dst, uint16_t row, uint16_t size )
+{
+    uint32_t addr = ( uint32_t )row * size;
+
+    while( size > 0 )
+    {
+        FragDecoderPage_t* page = FragCacheGetPage( decoder, addr );
+        uint16_t offset = addr - page->Addr;
+        uint16_t len = MIN( size, FRAG_DECODER_PAGE_SIZE - offset );
+
+        memcpy1( dst, &page->Data[offset], len );
+        dst += len;
+        addr += len;
+        size -= len;
+    }
+}
+#else
+static void SetRow( FragDecoder_t *decoder, uint8_t *src, uint16_t row, uint16_t size )
+{
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderWrite != NULL ) )
+    {
+        decoder->Callbacks->FragDecoderWrite( row * size, src, size );
+    }
+}
+
+static void GetRow( FragDecoder_t *decoder, uint8_t *dst, uint16_t row, uint16_t size )
+{
+    if( ( decoder->Callbacks != NULL ) && ( decoder->Callbacks->FragDecoderRead != NULL ) )
+    {
+        decoder->Callbacks->FragDecoderRead( row * size, dst, size );
+    }
+}
+#endif
 #else
 static void SetRow( uint8_t *dst, uint8_t *src, uint16_t row, uint16_t size )
 {
@@ -535,32 +759,44 @@ static void SetParity( uint16_t index, uint8_t *matrixRow, uint8_t parity )
 
 static bool IsPowerOfTwo( uint32_t x )
 {
-    uint8_t sumBit = 0;
-
-    for( uint8_t i = 0; i < 32; i++ )
-    {
-        sumBit += ( x & ( 1 << i ) ) >> i;
-    }
-    if( sumBit == 1 )
-    {
-        return true;
-    }
-    return false;
+    return ( x != 0 ) && ( ( x & ( x - 1 ) ) == 0 );
 }
 
 static void XorDataLine( uint8_t *line1, uint8_t *line2, int32_t size )
 {
-    for( int32_t i = 0; i < size; i++ )
+    int32_t i = 0;
+
+    // Words can only be used when both lines share the same alignment
+    if( ( ( ( uintptr_t )line1 ^ ( uintptr_t )line2 ) & ( sizeof( uint32_t ) - 1 ) ) == 0 )
     {
-        line1[i] = line1[i] ^ line2[i];
+        // Head bytes up to the first word boundary
+        for( ; ( i < size ) && ( ( ( uintptr_t )&line1[i] & ( sizeof( uint32_t ) - 1 ) ) != 0 ); i++ )
+        {
+            line1[i] ^= line2[i];
+        }
+        for( ; ( i + ( int32_t )sizeof( uint32_t ) ) <= size; i += sizeof( uint32_t ) )
+        {
+            *( uint32_t* )&line1[i] ^= *( uint32_t* )&line2[i];
+        }
+    }
+    // Tail bytes
+    for( ; i < size; i++ )
+    {
+        line1[i] ^= line2[i];
     }
 }
 
 static void XorParityLine( uint8_t* line1, uint8_t* line2, int32_t size )
 {
-    for( int32_t i = 0; i < size; i++ )
+    // Whole bytes hold 8 parity bits each
+    XorDataLine( line1, line2, size >> 3 );
+
+    if( ( size & 0x07 ) != 0 )
     {
-        SetParity( i, line1, ( GetParity( i, line1 ) ^ GetParity( i, line2 ) ) );
+        // Remaining bits are the most significant ones of the last byte
+        uint8_t mask = ( uint8_t )( 0xFF << ( 8 - ( size & 0x07 ) ) );
+
+        line1[size >> 3] ^= line2[size >> 3] & mask;
     }
 }
 
@@ -571,24 +807,36 @@ static int32_t FragPrbs23( int32_t value )
     return ( value >> 1 ) + ( ( b0 ^ b1 ) << 22 );;
 }
 
-static void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t *matrixRow )
+static uint32_t FragRowModulo( FragDecoder_t *decoder, int32_t x )
+{
+    // x = q * d + r, ( x * ceil( 2^40 / d ) ) >> 40 is exactly q as long as
+    // x * d < 2^40
+    if( x < ( 1 << 24 ) )
+    {
+        uint32_t q = ( uint32_t )( ( ( uint64_t )x * decoder->RowModulusInv ) >> 40 );
+
+        return ( uint32_t )x - ( q * decoder->RowModulus );
+    }
+    return ( uint32_t )x % decoder->RowModulus;
+}
+
+static void FragGetParityMatrixRow( FragDecoder_t *decoder, int32_t n, int32_t m, uint8_t *matrixRow )
 {
-    int32_t mTemp;
     int32_t x;
     int32_t nbCoeff = 0;
     int32_t r;
 
-    if( IsPowerOfTwo( m ) != false )
+    if( ( decoder->RowModulusFragNb != m ) && ( m > 0 ) )
     {
-        mTemp = 1;
-    }
-    else 
-    {
-        mTemp = 0;
+        // Same modulus for all the rows of a session, avoid a division per
+        // PRBS23 step
+        decoder->RowModulus = m + ( ( IsPowerOfTwo( m ) != false ) ? 1 : 0 );
+        decoder->RowModulusInv = ( ( ( uint64_t )1 << 40 ) + decoder->RowModulus - 1 ) / decoder->RowModulus;
+        decoder->RowModulusFragNb = m;
     }
 
     x = 1 + ( 1001 * n );
-    for( uint8_t i = 0; i < ( ( m >> 3 ) + 1 ); i++ )
+    for( uint16_t i = 0; i < ( ( m >> 3 ) + 1 ); i++ )
     {
         matrixRow[i] = 0;
     }
@@ -598,67 +846,199 @@ static void FragGetParityMatrixRow( int32_t n, int32_t m, uint8_t *matrixRow )
         while( r >= m )
         {
             x = FragPrbs23( x );
-            r = x % ( m + mTemp );
+            r = FragRowModulo( decoder, x );
         }
         SetParity( r, matrixRow, 1 );
         nbCoeff += 1;
     }
 }
 
+/*!
+ * \brief Returns the index of the most significant one of a non zero byte,
+ *        0 being the most significant bit
+ */
+static uint8_t ByteFindFirstOne( uint8_t byte )
+{
+#if defined( __GNUC__ )
+    return ( uint8_t )( __builtin_clz( byte ) - 24 );
+#else
+    uint8_t index = 0;
+
+    while( ( byte & 0x80 ) == 0 )
+    {
+        byte <<= 1;
+        index++;
+    }
+    return index;
+#endif
+}
+
+/*!
+ * \brief Returns the last byte of a bit array with the bits beyond size
+ *        cleared
+ */
+static uint8_t BitArrayLastByte( uint8_t *bitArray, uint16_t size )
+{
+    if( ( size & 0x07 ) == 0 )
+    {
+        return 0;
+    }
+    return bitArray[size >> 3] & ( uint8_t )( 0xFF << ( 8 - ( size & 0x07 ) ) );
+}
+
 static uint16_t BitArrayFindFirstOne( uint8_t *bitArray, uint16_t size )
 {
-    for( uint16_t i = 0; i < size; i++)
+    uint16_t nbBytes = size >> 3;
+    uint8_t last;
+
+    // Whole bytes are scanned at once, the first one is found by a bit scan
+    for( uint16_t i = 0; i < nbBytes; i++ )
     {
-        if ( GetParity( i, bitArray ) == 1 )
+        if( bitArray[i] != 0 )
         {
-            return i;
+            return ( i << 3 ) + ByteFindFirstOne( bitArray[i] );
         }
     }
+    last = BitArrayLastByte( bitArray, size );
+    if( last != 0 )
+    {
+        return ( nbBytes << 3 ) + ByteFindFirstOne( last );
+    }
     return 0;
 }
 
 static uint8_t BitArrayIsAllZeros( uint8_t *bitArray, uint16_t  size )
 {
-    for( uint16_t i = 0; i < size; i++ )
+    uint16_t nbBytes = size >> 3;
+
+    for( uint16_t i = 0; i < nbBytes; i++ )
     {
-        if( GetParity( i, bitArray ) == 1 )
+        if( bitArray[i] != 0 )
         {
             return 0;
         }
     }
-    return 1;
+    return ( BitArrayLastByte( bitArray, size ) == 0 ) ? 1 : 0;
 }
 
 /*!
  * \brief Finds & marks missing fragments
  *
  * \param [IN]  counter Current fragment counter
- * \param [OUT] FragDecoder.FragNbMissingIndex[] array is updated in place
+ * \param [OUT] decoder->FragMissingList[] array is updated in place
  */
-static void FragFindMissingFrags( uint16_t counter )
+static void FragFindMissingFrags( FragDecoder_t *decoder, uint16_t counter )
 {
     int32_t i;
-    for( i = FragDecoder.Status.FragNbLastRx; i < ( counter - 1 ); i++ )
+    for( i = decoder->Status.FragNbLastRx; i < ( counter - 1 ); i++ )
     {
-        if( i < FragDecoder.FragNb )
+        if( i < decoder->FragNb )
         {
-            FragDecoder.Status.FragNbLost++;
-            FragDecoder.FragNbMissingIndex[i] = FragDecoder.Status.FragNbLost;
+            if( decoder->Status.FragNbLost < FRAG_MAX_REDUNDANCY )
+            {
+                decoder->FragMissingList[decoder->Status.FragNbLost] = i;
+            }
+            // Beyond FRAG_MAX_REDUNDANCY the file cannot be recovered, only
+            // count the losses
+            decoder->Status.FragNbLost++;
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+            FragFileCrcAddRow( decoder, i, NULL );
+#endif
         }
     }
-    if( i < FragDecoder.FragNb )
+    if( i < decoder->FragNb )
     {
-        FragDecoder.Status.FragNbLastRx = counter;
+        decoder->Status.FragNbLastRx = counter;
     }
     else
     {
-        FragDecoder.Status.FragNbLastRx = FragDecoder.FragNb + 1;
+        decoder->Status.FragNbLastRx = decoder->FragNb + 1;
     }
-    DBG( "RECEIVED    : %5d / %5d Fragments\r\n", FragDecoder.Status.FragNbRx, FragDecoder.FragNb );
-    DBG( "              %5d / %5d Bytes\r\n", FragDecoder.Status.FragNbRx * FragDecoder.FragSize, FragDecoder.FragNb * FragDecoder.FragSize );
-    DBG( "LOST        :       %7d Fragments\r\n\r\n", FragDecoder.Status.FragNbLost );
+    DBG( "RECEIVED    : %5d / %5d Fragments\r\n", decoder->Status.FragNbRx, decoder->FragNb );
+    DBG( "              %5d / %5d Bytes\r\n", decoder->Status.FragNbRx * decoder->FragSize, decoder->FragNb * decoder->FragSize );
+    DBG( "LOST        :       %7d Fragments\r\n\r\n", decoder->Status.FragNbLost );
 }
 
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+/*!
+ * \brief Returns the number of bytes of a row covered by the file CRC
+ */
+static uint32_t FragFileCrcRowSize( FragDecoder_t *decoder, uint16_t row )
+{
+    uint32_t start = ( uint32_t )row * decoder->FragSize;
+
+    if( start >= decoder->FileCrcSize )
+    {
+        return 0;
+    }
+    return MIN( decoder->FileCrcSize - start, decoder->FragSize );
+}
+
+static void FragFileCrcAddRow( FragDecoder_t *decoder, uint16_t row, uint8_t *data )
+{
+    uint32_t size;
+
+    // Duplicated fragments are hashed once
+    if( ( decoder->FileCrcDone == true ) || ( row != decoder->FileCrcRows ) )
+    {
+        return;
+    }
+    size = FragFileCrcRowSize( decoder, row );
+    if( data == NULL )
+    {
+        decoder->FileCrc = Crc32ShiftZeros( decoder->FileCrc, size );
+    }
+    else
+    {
+        decoder->FileCrc = Crc32Update( decoder->FileCrc, data, size );
+    }
+    decoder->FileCrcRows++;
+}
+
+static void FragFileCrcFinalize( FragDecoder_t *decoder )
+{
+    uint8_t row[FRAG_MAX_SIZE];
+
+    if( ( decoder->FileCrcDone == true ) || ( decoder->Status.MatrixError != 0 ) ||
+        ( decoder->FileCrcRows != decoder->FragNb ) )
+    {
+        return;
+    }
+
+    // The CRC is linear, a recovered row replaces its zeros by adding its own
+    // CRC shifted by the bytes following it
+    for( uint16_t i = 0; i < MIN( decoder->Status.FragNbLost, FRAG_MAX_REDUNDANCY ); i++ )
+    {
+        uint16_t index = decoder->FragMissingList[i];
+        uint32_t size = FragFileCrcRowSize( decoder, index );
+        uint32_t crc;
+
+        if( size == 0 )
+        {
+            continue;
+        }
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+        GetRow( decoder, row, index, decoder->FragSize );
+#else
+        GetRow( row, decoder->File, index, decoder->FragSize );
+#endif
+        crc = Crc32Update( 0, row, size );
+        decoder->FileCrc ^= Crc32ShiftZeros( crc, decoder->FileCrcSize - ( ( uint32_t )index * decoder->FragSize ) - size );
+    }
+    decoder->FileCrcDone = true;
+}
+
+void FragDecoderSetFileCrcSize( FragDecoder_t *decoder, uint32_t size )
+{
+    decoder->FileCrcSize = MIN( size, ( uint32_t )decoder->FragNb * decoder->FragSize );
+}
+
+uint32_t FragDecoderGetFileCrc32( FragDecoder_t *decoder )
+{
+    return decoder->FileCrc ^ 0xFFFFFFFF;
+}
+#endif
+
 /*!
  * \brief Finds the index (frag counter) of the x th missing frag
  *
@@ -666,14 +1046,11 @@ static void FragFindMissingFrags( uint16_t counter )
  *
  * \retval counter The counter value associated to the x th missing frag
  */
-static uint16_t FragFindMissingIndex( uint16_t x )
+static uint16_t FragFindMissingIndex( FragDecoder_t *decoder, uint16_t x )
 {
-    for( uint16_t i = 0; i < FragDecoder.FragNb; i++ )
+    if( x < FRAG_MAX_REDUNDANCY )
     {
-        if( FragDecoder.FragNbMissingIndex[i] == ( x + 1 ) )
-        {
-            return i;
-        }
+        return decoder->FragMissingList[x];
     }
     return 0;
 }
@@ -685,7 +1062,7 @@ static uint16_t FragFindMissingIndex( uint16_t x )
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+static void FragExtractLineFromBinaryMatrix( FragDecoder_t *decoder, uint8_t* bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
     uint32_t findByte = 0;
     uint32_t findBitInByte = 0;
@@ -706,7 +1083,7 @@ static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
     {
         SetParity( i,
                    bitArray, 
-                   ( FragDecoder.MatrixM2B[findByte] >> ( 7 - findBitInByte ) ) & 0x01 );
+                   ( decoder->MatrixM2B[findByte] >> ( 7 - findBitInByte ) ) & 0x01 );
 
         findBitInByte++;
         if( findBitInByte == 8 )
@@ -724,7 +1101,7 @@ static void FragExtractLineFromBinaryMatrix( uint8_t* bitArray, uint16_t rowInde
  * \param [IN] rowIndex  Matrix row index
  * \param [IN] bitsInRow Number of bits in one row
  */
-static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
+static void FragPushLineToBinaryMatrix( FragDecoder_t *decoder, uint8_t *bitArray, uint16_t rowIndex, uint16_t bitsInRow )
 {
     uint32_t findByte = 0;
     uint32_t findBitInByte = 0;
@@ -738,7 +1115,7 @@ static void FragPushLineToBinaryMatrix( uint8_t *bitArray, uint16_t rowIndex, ui
     {
         if( GetParity( i, bitArray ) == 0 )
         {
-            FragDecoder.MatrixM2B[findByte] = FragDecoder.MatrixM2B[findByte] & ( 0xFF - ( 1 << ( 7 - findBitInByte ) ) );
+            decoder->MatrixM2B[findByte] = decoder->MatrixM2B[findByte] & ( 0xFF - ( 1 << ( 7 - findBitInByte ) ) );
         }
         findBitInByte++;
         if( findBitInByte == 8 )
@@ -24,6 +24,7 @@
 #define __FRAG_DECODER_H__
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*!
  * If set to 1 the new API defining \ref FragDecoderWrite and
@@ -31,26 +32,62 @@
  */
 #define FRAG_DECODER_FILE_HANDLING_NEW_API          1
 
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+/*!
+ * Number of file pages cached between the decoder and the
+ * \ref FragDecoderWrite and \ref FragDecoderRead callbacks. 0: no cache
+ *
+ * \remark The rows are then written and read by whole pages. This parameter
+ *         has an impact on the memory footprint.
+ */
+#ifndef FRAG_DECODER_PAGE_CACHE_NB
+#define FRAG_DECODER_PAGE_CACHE_NB                  0
+#endif
+
+/*!
+ * Size of a cached file page. Should match the flash program page size.
+ */
+#ifndef FRAG_DECODER_PAGE_SIZE
+#define FRAG_DECODER_PAGE_SIZE                      256
+#endif
+#endif
+
 /*!
  * Maximum number of fragment that can be handled.
  *
- * \remark This parameter has an impact on the memory footprint.
+ * \remark This parameter has an impact on the memory footprint. The decoder
+ *         only keeps one bit per fragment, the parity matrix row.
  */
+#ifndef FRAG_MAX_NB
 #define FRAG_MAX_NB                                 21
+#endif
 
 /*!
  * Maximum fragment size that can be handled.
  *
  * \remark This parameter has an impact on the memory footprint.
  */
+#ifndef FRAG_MAX_SIZE
 #define FRAG_MAX_SIZE                               50
+#endif
 
 /*!
  * Maximum number of extra frames that can be handled.
  *
- * \remark This parameter has an impact on the memory footprint.
+ * \remark This parameter has an impact on the memory footprint. The missing
+ *         fragments list and the triangular parity matrix are sized by it.
  */
+#ifndef FRAG_MAX_REDUNDANCY
 #define FRAG_MAX_REDUNDANCY                         5
+#endif
+
+/*!
+ * If set to 1 the CRC32 of the file is computed while the fragments are
+ * received, see \ref FragDecoderGetFileCrc32
+ */
+#ifndef FRAG_DECODER_FILE_CRC32
+#define FRAG_DECODER_FILE_CRC32                     0
+#endif
 
 #define FRAG_SESSION_FINISHED                       ( int32_t )0
 #define FRAG_SESSION_NOT_STARTED                    ( int32_t )-2
@@ -87,28 +124,117 @@ typedef struct sFragDecoderCallbacks
      * \retval status Read operation status [0: Success, -1 Fail]
      */
     uint8_t ( *FragDecoderRead )( uint32_t addr, uint8_t *data, uint32_t size );
+    /*!
+     * Erases the file area of `size` starting at address `addr` to 0xFF.
+     * Optional, the file is filled with 0xFF writes when NULL.
+     *
+     * \param [IN] addr Address start index to erase from.
+     * \param [IN] size Size of the area to be erased.
+     *
+     * \retval status Erase operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *FragDecoderErase )( uint32_t addr, uint32_t size );
 }FragDecoderCallbacks_t;
 #endif
 
+/*!
+ * Size in bytes of the packed triangular matrix of FRAG_MAX_REDUNDANCY rows
+ */
+#define FRAG_MATRIX_M2B_SIZE                        ( ( ( FRAG_MAX_REDUNDANCY * ( FRAG_MAX_REDUNDANCY + 1 ) ) >> 4 ) + 1 )
+
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 ) && ( FRAG_DECODER_PAGE_CACHE_NB > 0 )
+/*!
+ * Cached file page
+ */
+typedef struct sFragDecoderPage
+{
+    /*!
+     * File address of the page start
+     */
+    uint32_t Addr;
+    /*!
+     * Value of the use counter at the last access. Used to evict the least
+     * recently used page.
+     */
+    uint32_t LastUse;
+    bool Valid;
+    /*!
+     * The page holds data not yet written back to the file
+     */
+    bool Dirty;
+    uint8_t Data[FRAG_DECODER_PAGE_SIZE];
+}FragDecoderPage_t;
+#endif
+
+/*!
+ * Fragmentation decoder context. Each fragmentation session decodes into its
+ * own context.
+ *
+ * \remark The fields are private to the decoder.
+ */
+typedef struct sFragDecoder
+{
+#if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
+    FragDecoderCallbacks_t *Callbacks;
+#if( FRAG_DECODER_PAGE_CACHE_NB > 0 )
+    FragDecoderPage_t Pages[FRAG_DECODER_PAGE_CACHE_NB];
+    uint32_t PageUseCounter;
+#endif
+#else
+    uint8_t *File;
+    uint32_t FileSize;
+#endif
+    uint16_t FragNb;
+    uint8_t FragSize;
+
+    uint32_t M2BLine;
+    // Upper triangular matrix, the rows are packed one after the other
+    uint8_t MatrixM2B[FRAG_MATRIX_M2B_SIZE];
+    // Ascending fragment indexes of the missing fragments
+    uint16_t FragMissingList[FRAG_MAX_REDUNDANCY];
+    // Parity matrix row of the coded fragment being processed
+    uint8_t MatrixRow[( FRAG_MAX_NB >> 3 ) + 1];
+    // Parity matrix rows modulus of the session fragments number and its
+    // reciprocal, see FragRowModulo
+    uint16_t RowModulusFragNb;
+    uint32_t RowModulus;
+    uint64_t RowModulusInv;
+
+    uint8_t S[( FRAG_MAX_REDUNDANCY >> 3 ) + 1];
+
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+    // CRC32 register of the rows hashed in order, the missing rows counting
+    // as zeros until they are recovered
+    uint32_t FileCrc;
+    uint32_t FileCrcSize;
+    uint16_t FileCrcRows;
+    bool FileCrcDone;
+#endif
+
+    FragDecoderStatus_t Status;
+}FragDecoder_t;
+
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 /*!
  * \brief Initializes the fragmentation decoder
  *
+ * \param [IN] decoder    Decoder context
  * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
  * \param [IN] fragSize   Size of a fragment
  * \param [IN] callbacks  Pointer to the Write/Read functions.
  */
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks );
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, FragDecoderCallbacks_t *callbacks );
 #else
 /*!
  * \brief Initializes the fragmentation decoder
  *
+ * \param [IN] decoder    Decoder context
  * \param [IN] fragNb     Number of expected fragments (without redundancy packets)
  * \param [IN] fragSize   Size of a fragment
  * \param [IN] file       Pointer to file buffer size
  * \param [IN] fileSize   File buffer size
  */
-void FragDecoderInit( uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize );
+void FragDecoderInit( FragDecoder_t *decoder, uint16_t fragNb, uint8_t fragSize, uint8_t *file, uint32_t fileSize );
 #endif
 
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -124,6 +250,7 @@ uint32_t FragDecoderGetMaxFileSize( void );
  * \brief Function to decode and reconstruct the binary file
  *        Called for each receive frame
  * 
+ * \param [IN] decoder     Decoder context
  * \param [IN] fragCounter Fragment counter [1..(FragDecoder.FragNb + FragDecoder.Redundancy)]
  * \param [IN] rawData     Pointer to the fragment to be processed (length = FragDecoder.FragSize)
  *
@@ -131,13 +258,40 @@ uint32_t FragDecoderGetMaxFileSize( void );
  *                                          FRAG_SESSION_FINISHED or
  *                                          FragDecoder.Status.FragNbLost]
  */
-int32_t FragDecoderProcess( uint16_t fragCounter, uint8_t *rawData );
+int32_t FragDecoderProcess( FragDecoder_t *decoder, uint16_t fragCounter, uint8_t *rawData );
 
 /*!
  * \brief Gets the current fragmentation status
  * 
+ * \param [IN] decoder Decoder context
+ *
  * \retval status Fragmentation decoder status
  */
-FragDecoderStatus_t FragDecoderGetStatus( void );
+FragDecoderStatus_t FragDecoderGetStatus( FragDecoder_t *decoder );
+
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+/*!
+ * \brief Sets the number of file bytes covered by the CRC32, the padding of
+ *        the last fragment excluded. The whole FragNb * FragSize bytes are
+ *        covered by default.
+ *
+ * \param [IN] decoder Decoder context
+ * \param [IN] size    File size
+ */
+void FragDecoderSetFileCrcSize( FragDecoder_t *decoder, uint32_t size );
+
+/*!
+ * \brief Gets the IEEE 802.3 CRC32 of the reconstructed file
+ *
+ * \remark The received fragments are hashed as they are placed, only the
+ *         recovered fragments are read back when the decoding ends. The
+ *         value is valid once \ref FragDecoderProcess returned a status >= 0.
+ *
+ * \param [IN] decoder Decoder context
+ *
+ * \retval crc          File CRC32, same as Crc32Compute over the file
+ */
+uint32_t FragDecoderGetFileCrc32( FragDecoder_t *decoder );
+#endif
 
 #endif // __FRAG_DECODER_H__
@@ -0,0 +1,150 @@
+/*!
+ * \file      FragEncoder.c
+ *
+ * \brief     Implements the fragmentation encoder matching \ref FragDecoder.h
+ *            coding scheme. Used to send large files uplink.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#include <stddef.h>
+#include <stdbool.h>
+#include "utilities.h"
+#include "FragEncoder.h"
+
+/*!
+ * \brief Reads an uncoded fragment, the bytes past the end of the file are
+ *        zeros
+ *
+ * \param [IN]  encoder Encoder context
+ * \param [IN]  row     Fragment index [0..FragNb - 1]
+ * \param [OUT] data    Fragment buffer
+ *
+ * \retval status FRAG_ENCODER_SUCCESS or FRAG_ENCODER_ERROR_READ
+ */
+static int32_t FragEncoderReadRow( FragEncoder_t *encoder, uint16_t row, uint8_t *data );
+
+/*!
+ * \brief Computes the parity matrix row of a coded fragment, same as the
+ *        decoder FragGetParityMatrixRow
+ *
+ * \param [IN]  encoder   Encoder context
+ * \param [IN]  n         Coded fragment index, starting at 1
+ * \param [OUT] matrixRow Parity matrix row, FragNb bits
+ */
+static void FragEncoderGetParityMatrixRow( FragEncoder_t *encoder, int32_t n, uint8_t *matrixRow );
+
+int32_t FragEncoderInit( FragEncoder_t *encoder, uint32_t fileSize, uint8_t fragSize, FragEncoderCallbacks_t *callbacks )
+{
+    uint32_t fragNb;
+
+    if( ( encoder == NULL ) || ( callbacks == NULL ) || ( callbacks->FragEncoderRead == NULL ) ||
+        ( fragSize == 0 ) || ( fragSize > FRAG_ENCODER_MAX_SIZE ) || ( fileSize == 0 ) )
+    {
+        return FRAG_ENCODER_ERROR_PARAM;
+    }
+    fragNb = ( fileSize + fragSize - 1 ) / fragSize;
+    if( fragNb > FRAG_ENCODER_MAX_NB )
+    {
+        return FRAG_ENCODER_ERROR_PARAM;
+    }
+    encoder->Callbacks = callbacks;
+    encoder->FileSize = fileSize;
+    encoder->FragNb = ( uint16_t )fragNb;
+    encoder->FragSize = fragSize;
+    // Power of two fragments numbers use the next modulus, see the decoder
+    encoder->RowModulus = fragNb + ( ( ( fragNb & ( fragNb - 1 ) ) == 0 ) ? 1 : 0 );
+    return FRAG_ENCODER_SUCCESS;
+}
+
+uint16_t FragEncoderGetFragNb( FragEncoder_t *encoder )
+{
+    return encoder->FragNb;
+}
+
+uint8_t FragEncoderGetPadding( FragEncoder_t *encoder )
+{
+    return ( uint8_t )( ( ( uint32_t )encoder->FragNb * encoder->FragSize ) - encoder->FileSize );
+}
+
+int32_t FragEncoderGetFragment( FragEncoder_t *encoder, uint16_t fragCounter, uint8_t *data )
+{
+    if( ( fragCounter == 0 ) || ( fragCounter > 0x3FFF ) || ( data == NULL ) )
+    {
+        return FRAG_ENCODER_ERROR_PARAM;
+    }
+    if( fragCounter <= encoder->FragNb )
+    {
+        return FragEncoderReadRow( encoder, fragCounter - 1, data );
+    }
+
+    FragEncoderGetParityMatrixRow( encoder, fragCounter - encoder->FragNb, encoder->MatrixRow );
+    memset1( data, 0, encoder->FragSize );
+    for( uint16_t i = 0; i < encoder->FragNb; i++ )
+    {
+        if( ( ( encoder->MatrixRow[i >> 3] >> ( 7 - ( i & 0x07 ) ) ) & 0x01 ) == 0 )
+        {
+            continue;
+        }
+        if( FragEncoderReadRow( encoder, i, encoder->Fragment ) != FRAG_ENCODER_SUCCESS )
+        {
+            return FRAG_ENCODER_ERROR_READ;
+        }
+        for( uint8_t j = 0; j < encoder->FragSize; j++ )
+        {
+            data[j] ^= encoder->Fragment[j];
+        }
+    }
+    return FRAG_ENCODER_SUCCESS;
+}
+
+static int32_t FragEncoderReadRow( FragEncoder_t *encoder, uint16_t row, uint8_t *data )
+{
+    uint32_t addr = ( uint32_t )row * encoder->FragSize;
+    uint32_t size = MIN( encoder->FileSize - addr, encoder->FragSize );
+
+    if( encoder->Callbacks->FragEncoderRead( addr, data, size ) != 0 )
+    {
+        return FRAG_ENCODER_ERROR_READ;
+    }
+    memset1( data + size, 0, encoder->FragSize - size );
+    return FRAG_ENCODER_SUCCESS;
+}
+
+static int32_t FragEncoderPrbs23( int32_t value )
+{
+    int32_t b0 = value & 0x01;
+    int32_t b1 = ( value & 0x20 ) >> 5;
+    return ( value >> 1 ) + ( ( b0 ^ b1 ) << 22 );
+}
+
+static void FragEncoderGetParityMatrixRow( FragEncoder_t *encoder, int32_t n, uint8_t *matrixRow )
+{
+    int32_t m = encoder->FragNb;
+    int32_t x = 1 + ( 1001 * n );
+    int32_t nbCoeff = 0;
+    int32_t r;
+
+    memset1( matrixRow, 0, ( m >> 3 ) + 1 );
+    while( nbCoeff < ( m >> 1 ) )
+    {
+        r = 1 << 16;
+        while( r >= m )
+        {
+            x = FragEncoderPrbs23( x );
+            r = ( uint32_t )x % encoder->RowModulus;
+        }
+        matrixRow[r >> 3] |= 1 << ( 7 - ( r & 0x07 ) );
+        nbCoeff += 1;
+    }
+}
@@ -0,0 +1,130 @@
+/*!
+ * \file      FragEncoder.h
+ *
+ * \brief     Implements the fragmentation encoder matching \ref FragDecoder.h
+ *            coding scheme. Used to send large files uplink.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#ifndef __FRAG_ENCODER_H__
+#define __FRAG_ENCODER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * Maximum number of uncoded fragments of a file.
+ *
+ * \remark This parameter has an impact on the memory footprint. The encoder
+ *         keeps one bit per fragment, the parity matrix row.
+ */
+#ifndef FRAG_ENCODER_MAX_NB
+#define FRAG_ENCODER_MAX_NB                         1024
+#endif
+
+/*!
+ * Maximum fragment size that can be handled.
+ *
+ * \remark This parameter has an impact on the memory footprint.
+ */
+#ifndef FRAG_ENCODER_MAX_SIZE
+#define FRAG_ENCODER_MAX_SIZE                       48
+#endif
+
+#define FRAG_ENCODER_SUCCESS                        ( int32_t )0
+#define FRAG_ENCODER_ERROR_PARAM                    ( int32_t )-1
+#define FRAG_ENCODER_ERROR_READ                     ( int32_t )-2
+
+typedef struct sFragEncoderCallbacks
+{
+    /*!
+     * Reads `data` buffer of `size` starting at address `addr` of the file
+     * to be sent
+     *
+     * \param [IN] addr Address start index to read from.
+     * \param [IN] data Data buffer to be read.
+     * \param [IN] size Size of data buffer to be read.
+     *
+     * \retval status Read operation status [0: Success, -1 Fail]
+     */
+    uint8_t ( *FragEncoderRead )( uint32_t addr, uint8_t *data, uint32_t size );
+}FragEncoderCallbacks_t;
+
+/*!
+ * Fragmentation encoder context
+ *
+ * \remark The fields are private to the encoder.
+ */
+typedef struct sFragEncoder
+{
+    FragEncoderCallbacks_t *Callbacks;
+    uint32_t FileSize;
+    uint16_t FragNb;
+    uint8_t FragSize;
+    // Parity matrix rows modulus of the session
+    uint32_t RowModulus;
+    // Parity matrix row of the coded fragment being built
+    uint8_t MatrixRow[( FRAG_ENCODER_MAX_NB >> 3 ) + 1];
+    // Uncoded fragment being added to a coded fragment
+    uint8_t Fragment[FRAG_ENCODER_MAX_SIZE];
+}FragEncoder_t;
+
+/*!
+ * \brief Initializes the fragmentation encoder
+ *
+ * \param [IN] encoder   Encoder context
+ * \param [IN] fileSize  Size of the file to be sent
+ * \param [IN] fragSize  Size of a fragment
+ * \param [IN] callbacks Pointer to the file Read function
+ *
+ * \retval status FRAG_ENCODER_SUCCESS or FRAG_ENCODER_ERROR_PARAM when the
+ *                file needs more than FRAG_ENCODER_MAX_NB fragments
+ */
+int32_t FragEncoderInit( FragEncoder_t *encoder, uint32_t fileSize, uint8_t fragSize, FragEncoderCallbacks_t *callbacks );
+
+/*!
+ * \brief Gets the number of uncoded fragments of the file
+ *
+ * \param [IN] encoder Encoder context
+ *
+ * \retval fragNb Number of fragments, the last one is padded
+ */
+uint16_t FragEncoderGetFragNb( FragEncoder_t *encoder );
+
+/*!
+ * \brief Gets the number of padding bytes of the last fragment
+ *
+ * \param [IN] encoder Encoder context
+ *
+ * \retval padding Padding size
+ */
+uint8_t FragEncoderGetPadding( FragEncoder_t *encoder );
+
+/*!
+ * \brief Builds a fragment. The fragments [1..FragNb] are the uncoded file
+ *        rows, the padding being zeros. The next ones are the XOR of the rows
+ *        selected by the parity matrix row of \ref FragDecoderProcess.
+ *
+ * \remark A coded fragment reads about FragNb / 2 rows of the file.
+ *
+ * \param [IN]  encoder     Encoder context
+ * \param [IN]  fragCounter Fragment counter [1..0x3FFF]
+ * \param [OUT] data        Fragment buffer of FragSize bytes
+ *
+ * \retval status FRAG_ENCODER_SUCCESS, FRAG_ENCODER_ERROR_PARAM or
+ *                FRAG_ENCODER_ERROR_READ
+ */
+int32_t FragEncoderGetFragment( FragEncoder_t *encoder, uint16_t fragCounter, uint8_t *data );
+
+#endif // __FRAG_ENCODER_H__
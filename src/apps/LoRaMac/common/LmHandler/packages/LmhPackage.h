@@ -28,7 +28,13 @@
 /*!
  * Maximum number of packages
  */
-#define PKG_MAX_NUMBER                              4
+#define PKG_MAX_NUMBER                              6
+
+/*!
+ * Value returned by \ref LmhPackage_t.GetNextDeadline when the package has
+ * no pending work
+ */
+#define LMH_PACKAGE_NO_DEADLINE                     0xFFFFFFFF
 
 typedef struct LmhPackage_s
 {
@@ -65,6 +71,16 @@ typedef struct LmhPackage_s
      * Processes the internal package events.
      */
     void ( *Process )( void );
+    /*!
+     * Returns the time until the package Process function must be called.
+     *
+     * \remark When NULL the Process function is called on every
+     *         \ref LmHandlerProcess call.
+     *
+     * \retval deadline 0 when work is pending, the time in ms until the next
+     *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+     */
+    TimerTime_t ( *GetNextDeadline )( void );
     /*!
      * Processes the MCSP Confirm
      *
@@ -19,6 +19,7 @@
  *
  * \author    Miguel Luis ( Semtech )
  */
+#include "utilities.h"
 #include "systime.h"
 #include "LmHandler.h"
 #include "LmhpClockSync.h"
@@ -31,6 +32,52 @@
 #define CLOCK_SYNC_ID                               1
 #define CLOCK_SYNC_VERSION                          1
 
+/*!
+ * Enables the automatic resynchronization once the clock has been synchronized
+ * at least once.
+ */
+#ifndef CLOCK_SYNC_AUTO_RESYNC
+#define CLOCK_SYNC_AUTO_RESYNC                      1
+#endif
+
+/*!
+ * Resynchronization periodicity bounds. The period is 128 * 2^periodicity
+ * seconds as defined by the AppTimePeriodicityReq command.
+ */
+#ifndef CLOCK_SYNC_PERIODICITY_MIN
+#define CLOCK_SYNC_PERIODICITY_MIN                  5
+#endif
+
+#ifndef CLOCK_SYNC_PERIODICITY_MAX
+#define CLOCK_SYNC_PERIODICITY_MAX                  12
+#endif
+
+/*!
+ * Maximum random jitter in seconds applied to the resynchronization period
+ */
+#define CLOCK_SYNC_PERIOD_JITTER                    30
+
+/*!
+ * Number of drift samples required before the estimate is applied
+ */
+#ifndef CLOCK_SYNC_DRIFT_MIN_SAMPLES
+#define CLOCK_SYNC_DRIFT_MIN_SAMPLES                2
+#endif
+
+/*!
+ * Maximum accepted drift in ppm. Larger corrections are considered as a time
+ * jump and restart the drift estimation.
+ */
+#ifndef CLOCK_SYNC_DRIFT_MAX_PPM
+#define CLOCK_SYNC_DRIFT_MAX_PPM                    500
+#endif
+
+/*!
+ * Accumulated observation window in ms after which the drift sums are halved
+ * in order to track slow drift changes (e.g. temperature). ~30 days
+ */
+#define CLOCK_SYNC_DRIFT_WINDOW                     ( 30 * 86400000LL )
+
 /*!
  * Package current context
  */
@@ -55,6 +102,38 @@ typedef struct LmhpClockSyncState_s
     uint8_t NbTransPrev;
     uint8_t DataratePrev;
     uint8_t NbTransmissions;
+    /*!
+     * MCU time at the last synchronization. Not affected by \ref SysTimeSet
+     */
+    SysTime_t LastSyncMcuTime;
+    bool LastSyncValid;
+    /*!
+     * Accumulated clock error and observation interval used for the drift
+     * estimation
+     */
+    int64_t DriftErrorMs;
+    int64_t DriftIntervalMs;
+    uint8_t NbDriftSamples;
+    /*!
+     * Estimated clock drift in parts per billion. Positive when the local
+     * clock is late.
+     */
+    int32_t DriftPpb;
+    /*!
+     * Drift compensation applied since the last synchronization
+     */
+    int32_t DriftAppliedMs;
+    /*!
+     * Current resynchronization periodicity and whether it has been imposed
+     * by the network through AppTimePeriodicityReq
+     */
+    uint8_t Periodicity;
+    bool PeriodicityForced;
+    /*!
+     * Elapsed time since the last synchronization after which the next
+     * automatic resynchronization is started
+     */
+    uint32_t ResyncPeriodMs;
 }LmhpClockSyncState_t;
 
 typedef enum LmhpClockSyncMoteCmd_e
@@ -103,6 +182,14 @@ static bool LmhpClockSyncIsRunning( void );
  */
 static void LmhpClockSyncProcess( void );
 
+/*!
+ * Returns the time until the package Process function must be called.
+ *
+ * \retval deadline 0 when work is pending, the time in ms until the next
+ *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+ */
+static TimerTime_t LmhpClockSyncGetNextDeadline( void );
+
 /*!
  * Processes the MCSP Confirm
  *
@@ -117,6 +204,31 @@ static void LmhpClockSyncOnMcpsConfirm( McpsConfirm_t *mcpsConfirm );
  */
 static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication );
 
+/*!
+ * Updates the drift model with the correction received by AppTimeAns and
+ * restarts the observation interval.
+ *
+ * \param [IN] timeCorrection Applied time correction in seconds
+ */
+static void ClockSyncUpdateDrift( int32_t timeCorrection );
+
+/*!
+ * Restarts the drift observation interval without taking a sample.
+ * Used when the time has been corrected by other means (DeviceTimeAns).
+ */
+static void ClockSyncRestartInterval( void );
+
+/*!
+ * Applies the drift compensation accumulated since the last synchronization
+ */
+static void ClockSyncCompensateDrift( void );
+
+/*!
+ * Computes the time in ms elapsed on the MCU clock since the last
+ * synchronization
+ */
+static uint32_t ClockSyncGetElapsedMs( void );
+
 static LmhpClockSyncState_t LmhpClockSyncState =
 {
     .Initialized = false,
@@ -126,6 +238,15 @@ static LmhpClockSyncState_t LmhpClockSyncState =
     .AdrEnabledPrev = false,
     .NbTransPrev = 0,
     .NbTransmissions = 0,
+    .LastSyncValid = false,
+    .DriftErrorMs = 0,
+    .DriftIntervalMs = 0,
+    .NbDriftSamples = 0,
+    .DriftPpb = 0,
+    .DriftAppliedMs = 0,
+    .Periodicity = CLOCK_SYNC_PERIODICITY_MIN,
+    .PeriodicityForced = false,
+    .ResyncPeriodMs = 0,
 };
 
 static LmhPackage_t LmhpClockSyncPackage =
@@ -135,6 +256,7 @@ static LmhPackage_t LmhpClockSyncPackage =
     .IsInitialized = LmhpClockSyncIsInitialized,
     .IsRunning = LmhpClockSyncIsRunning,
     .Process = LmhpClockSyncProcess,
+    .GetNextDeadline = LmhpClockSyncGetNextDeadline,
     .OnMcpsConfirmProcess = LmhpClockSyncOnMcpsConfirm,
     .OnMcpsIndicationProcess = LmhpClockSyncOnMcpsIndication,
     .OnMlmeConfirmProcess = NULL,                              // Not used in this package
@@ -185,6 +307,20 @@ static bool LmhpClockSyncIsRunning( void )
 
 static void LmhpClockSyncProcess( void )
 {
+    if( LmhpClockSyncState.LastSyncValid == true )
+    {
+        ClockSyncCompensateDrift( );
+#if( CLOCK_SYNC_AUTO_RESYNC == 1 )
+        if( ( LmhpClockSyncState.NbTransmissions == 0 ) &&
+            ( ClockSyncGetElapsedMs( ) >= LmhpClockSyncState.ResyncPeriodMs ) )
+        {
+            LmhpClockSyncState.NbTransmissions = 1;
+            // Retry on next period if no answer is received
+            LmhpClockSyncState.ResyncPeriodMs += ( 128000UL << LmhpClockSyncState.Periodicity );
+        }
+#endif
+    }
+
     if( LmhpClockSyncState.NbTransmissions > 0 )
     {
         if( LmhpClockSyncAppTimeReq( ) == LORAMAC_HANDLER_SUCCESS )
@@ -194,6 +330,41 @@ static void LmhpClockSyncProcess( void )
     }
 }
 
+static TimerTime_t LmhpClockSyncGetNextDeadline( void )
+{
+    TimerTime_t deadline = LMH_PACKAGE_NO_DEADLINE;
+
+    if( LmhpClockSyncState.NbTransmissions > 0 )
+    {
+        return 0;
+    }
+    if( LmhpClockSyncState.LastSyncValid == false )
+    {
+        return deadline;
+    }
+#if( CLOCK_SYNC_AUTO_RESYNC == 1 )
+    uint32_t elapsedMs = ClockSyncGetElapsedMs( );
+
+    if( elapsedMs >= LmhpClockSyncState.ResyncPeriodMs )
+    {
+        return 0;
+    }
+    deadline = LmhpClockSyncState.ResyncPeriodMs - elapsedMs;
+#endif
+    if( LmhpClockSyncState.DriftPpb != 0 )
+    {
+        // Time for the drift compensation to reach the next ms
+        uint32_t absDriftPpb = ( LmhpClockSyncState.DriftPpb > 0 ) ? LmhpClockSyncState.DriftPpb : -LmhpClockSyncState.DriftPpb;
+        uint32_t stepMs = ( 1000000000UL / absDriftPpb ) + 1;
+
+        if( stepMs < deadline )
+        {
+            deadline = stepMs;
+        }
+    }
+    return deadline;
+}
+
 static void LmhpClockSyncOnMcpsConfirm( McpsConfirm_t *mcpsConfirm )
 {
     MibRequestConfirm_t mibReq;
@@ -243,6 +414,7 @@ static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication )
                 // If yes then don't process and ignore this answer.
                 if( mcpsIndication->DeviceTimeAnsReceived == true )
                 {
+                    ClockSyncRestartInterval( );
                     cmdIndex += 5;
                     break;
                 }
@@ -257,6 +429,7 @@ static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication )
                     curTime = SysTimeGet( );
                     curTime.Seconds += timeCorrection;
                     SysTimeSet( curTime );
+                    ClockSyncUpdateDrift( timeCorrection );
                     LmhpClockSyncState.TimeReqParam.Fields.TokenReq = ( LmhpClockSyncState.TimeReqParam.Fields.TokenReq + 1 ) & 0x0F;
                     if( LmhpClockSyncPackage.OnSysTimeUpdate != NULL )
                     {
@@ -276,16 +449,21 @@ static void LmhpClockSyncOnMcpsIndication( McpsIndication_t *mcpsIndication )
             }
             case CLOCK_SYNC_APP_TIME_PERIOD_REQ:
             {
-                // Increment index
-                cmdIndex++;
-                // TODO implement command prosessing and handling
+                LmhpClockSyncState.Periodicity = mcpsIndication->Buffer[cmdIndex++] & 0x0F;
+                LmhpClockSyncState.PeriodicityForced = true;
+                if( LmhpClockSyncState.LastSyncValid == true )
+                {
+                    LmhpClockSyncState.ResyncPeriodMs = ClockSyncGetElapsedMs( ) +
+                        ( 128000UL << LmhpClockSyncState.Periodicity ) +
+                        randr( -CLOCK_SYNC_PERIOD_JITTER * 1000, CLOCK_SYNC_PERIOD_JITTER * 1000 );
+                }
                 LmhpClockSyncState.DataBuffer[dataBufferIndex++] = CLOCK_SYNC_APP_TIME_PERIOD_ANS;
-                // Answer status not supported.
-                LmhpClockSyncState.DataBuffer[dataBufferIndex++] = 0x01;
+                // Answer status supported.
+                LmhpClockSyncState.DataBuffer[dataBufferIndex++] = 0x00;
 
                 SysTime_t curTime = SysTimeGet( );
-                // Substract Unix to Gps epcoh offset. The system time is based on Unix time.
-                curTime.Seconds -= UNIX_GPS_EPOCH_OFFSET;
+                // The system time is based on Unix time.
+                curTime.Seconds = SysTimeToGps( curTime, NULL );
                 LmhpClockSyncState.DataBuffer[dataBufferIndex++] = ( curTime.Seconds >> 0  ) & 0xFF;
                 LmhpClockSyncState.DataBuffer[dataBufferIndex++] = ( curTime.Seconds >> 8  ) & 0xFF;
                 LmhpClockSyncState.DataBuffer[dataBufferIndex++] = ( curTime.Seconds >> 16 ) & 0xFF;
@@ -353,8 +531,8 @@ LmHandlerErrorStatus_t LmhpClockSyncAppTimeReq( void )
     SysTime_t curTime = SysTimeGet( );
     uint8_t dataBufferIndex = 0;
 
-    // Substract Unix to Gps epcoh offset. The system time is based on Unix time.
-    curTime.Seconds -= UNIX_GPS_EPOCH_OFFSET;
+    // The system time is based on Unix time.
+    curTime.Seconds = SysTimeToGps( curTime, NULL );
 
     LmhpClockSyncState.DataBuffer[dataBufferIndex++] = CLOCK_SYNC_APP_TIME_REQ;
     LmhpClockSyncState.DataBuffer[dataBufferIndex++] = ( curTime.Seconds >> 0  ) & 0xFF;
@@ -373,3 +551,108 @@ LmHandlerErrorStatus_t LmhpClockSyncAppTimeReq( void )
     LmhpClockSyncState.AppTimeReqPending = true;
     return LmhpClockSyncPackage.OnSendRequest( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
 }
+
+static uint32_t ClockSyncGetElapsedMs( void )
+{
+    SysTime_t elapsed = SysTimeSub( SysTimeGetMcuTime( ), LmhpClockSyncState.LastSyncMcuTime );
+
+    return elapsed.Seconds * 1000 + elapsed.SubSeconds;
+}
+
+static void ClockSyncRestartInterval( void )
+{
+    LmhpClockSyncState.LastSyncMcuTime = SysTimeGetMcuTime( );
+    LmhpClockSyncState.DriftAppliedMs = 0;
+}
+
+static void ClockSyncUpdateDrift( int32_t timeCorrection )
+{
+    if( LmhpClockSyncState.LastSyncValid == true )
+    {
+        int64_t intervalMs = ClockSyncGetElapsedMs( );
+        // Total clock error over the interval, including the compensation
+        // already applied by ClockSyncCompensateDrift
+        int64_t errorMs = ( int64_t )timeCorrection * 1000 + LmhpClockSyncState.DriftAppliedMs;
+        // AppTimeReq carries whole seconds, hence the +/- 2 s allowance
+        int64_t maxErrorMs = ( ( intervalMs * CLOCK_SYNC_DRIFT_MAX_PPM ) / 1000000 ) + 2000;
+
+        if( ( errorMs > maxErrorMs ) || ( errorMs < -maxErrorMs ) )
+        {
+            // Time jump. Restart the drift estimation
+            LmhpClockSyncState.DriftErrorMs = 0;
+            LmhpClockSyncState.DriftIntervalMs = 0;
+            LmhpClockSyncState.NbDriftSamples = 0;
+            LmhpClockSyncState.DriftPpb = 0;
+        }
+        else
+        {
+            LmhpClockSyncState.DriftErrorMs += errorMs;
+            LmhpClockSyncState.DriftIntervalMs += intervalMs;
+            if( LmhpClockSyncState.NbDriftSamples < CLOCK_SYNC_DRIFT_MIN_SAMPLES )
+            {
+                LmhpClockSyncState.NbDriftSamples++;
+            }
+            if( LmhpClockSyncState.DriftIntervalMs > CLOCK_SYNC_DRIFT_WINDOW )
+            {
+                LmhpClockSyncState.DriftErrorMs /= 2;
+                LmhpClockSyncState.DriftIntervalMs /= 2;
+            }
+            if( ( LmhpClockSyncState.NbDriftSamples >= CLOCK_SYNC_DRIFT_MIN_SAMPLES ) &&
+                ( LmhpClockSyncState.DriftIntervalMs > 0 ) )
+            {
+                LmhpClockSyncState.DriftPpb = ( int32_t )( ( LmhpClockSyncState.DriftErrorMs * 1000000000LL ) /
+                                                            LmhpClockSyncState.DriftIntervalMs );
+            }
+
+            // Adapt the resynchronization period to the residual error
+            if( LmhpClockSyncState.PeriodicityForced == false )
+            {
+                if( ( timeCorrection == 0 ) &&
+                    ( LmhpClockSyncState.Periodicity < CLOCK_SYNC_PERIODICITY_MAX ) )
+                {
+                    LmhpClockSyncState.Periodicity++;
+                }
+                else if( ( ( timeCorrection >= 2 ) || ( timeCorrection <= -2 ) ) &&
+                         ( LmhpClockSyncState.Periodicity > CLOCK_SYNC_PERIODICITY_MIN ) )
+                {
+                    LmhpClockSyncState.Periodicity--;
+                }
+            }
+        }
+    }
+
+    ClockSyncRestartInterval( );
+    LmhpClockSyncState.LastSyncValid = true;
+    LmhpClockSyncState.ResyncPeriodMs = ( 128000UL << LmhpClockSyncState.Periodicity ) +
+        randr( -CLOCK_SYNC_PERIOD_JITTER * 1000, CLOCK_SYNC_PERIOD_JITTER * 1000 );
+}
+
+static void ClockSyncCompensateDrift( void )
+{
+    if( LmhpClockSyncState.DriftPpb == 0 )
+    {
+        return;
+    }
+
+    int32_t targetMs = ( int32_t )( ( ( int64_t )ClockSyncGetElapsedMs( ) * LmhpClockSyncState.DriftPpb ) / 1000000000LL );
+    int32_t deltaMs = targetMs - LmhpClockSyncState.DriftAppliedMs;
+
+    if( deltaMs == 0 )
+    {
+        return;
+    }
+
+    uint32_t absDeltaMs = ( deltaMs > 0 ) ? deltaMs : -deltaMs;
+    SysTime_t delta = { .Seconds = absDeltaMs / 1000, .SubSeconds = absDeltaMs % 1000 };
+    SysTime_t curTime = SysTimeGet( );
+    if( deltaMs > 0 )
+    {
+        curTime = SysTimeAdd( curTime, delta );
+    }
+    else
+    {
+        curTime = SysTimeSub( curTime, delta );
+    }
+    SysTimeSet( curTime );
+    LmhpClockSyncState.DriftAppliedMs = targetMs;
+}
@@ -42,6 +42,21 @@
  */
 #define COMPLIANCE_TX_DUTYCYCLE                     5000
 
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+/*!
+ * Uplink period of the fast certification mode [ms]. The answers to the
+ * test downlinks are sent as soon as the MAC is free, the period only paces
+ * the uplinks of the tests which don't have downlinks.
+ */
+#ifndef COMPLIANCE_FAST_TX_DUTYCYCLE
+#define COMPLIANCE_FAST_TX_DUTYCYCLE                1000
+#endif
+
+#define COMPLIANCE_TX_PERIOD                        COMPLIANCE_FAST_TX_DUTYCYCLE
+#else
+#define COMPLIANCE_TX_PERIOD                        COMPLIANCE_TX_DUTYCYCLE
+#endif
+
 /*!
  * LoRaWAN compliance tests support data
  */
@@ -60,6 +75,15 @@ typedef struct ComplianceTestState_s
     bool LinkCheck;
     uint8_t DemodMargin;
     uint8_t NbGateways;
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+    /*!
+     * Test being run, its command identifier. COMPLIANCE_TEST_NB until the
+     * first test command.
+     */
+    uint8_t Test;
+    TimerTime_t TestStartTime;
+    TimerTime_t SessionStartTime;
+#endif
 }ComplianceTestState_t;
 
 /*!
@@ -92,6 +116,21 @@ static ComplianceTestState_t ComplianceTestState =
  */
 static LmhpComplianceParams_t* LmhpComplianceParams;
 
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+/*!
+ * Duration of the tests of the current or latest session
+ */
+static LmhpComplianceTimings_t ComplianceTimings;
+
+/*!
+ * Accounts the time of the test being run, a test lasting until the next
+ * test command
+ *
+ * \param [IN] nextTest Command identifier of the next test
+ */
+static void LmhpComplianceTimingsUpdate( uint8_t nextTest );
+#endif
+
 /*!
  * Initializes the compliance tests with provided parameters
  *
@@ -123,6 +162,14 @@ static bool LmhpComplianceIsRunning( void );
  */
 static void LmhpComplianceProcess( void );
 
+/*!
+ * Returns the time until the package Process function must be called.
+ *
+ * \retval deadline 0 when work is pending, the time in ms until the next
+ *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+ */
+static TimerTime_t LmhpComplianceGetNextDeadline( void );
+
 /*!
  * Processes the MCPS Indication
  *
@@ -158,6 +205,7 @@ LmhPackage_t LmhpCompliancePackage =
     .IsInitialized = LmhpComplianceIsInitialized,
     .IsRunning = LmhpComplianceIsRunning,
     .Process = LmhpComplianceProcess,
+    .GetNextDeadline = LmhpComplianceGetNextDeadline,
     .OnMcpsConfirmProcess = NULL,                              // Not used in this package
     .OnMcpsIndicationProcess = LmhpComplianceOnMcpsIndication,
     .OnMlmeConfirmProcess = LmhpComplianceOnMlmeConfirm,
@@ -320,7 +368,14 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
             }
             // Initialize compliance protocol transmission timer
             TimerInit( &ComplianceTxNextPacketTimer, OnComplianceTxNextPacketTimerEvent );
-            TimerSetValue( &ComplianceTxNextPacketTimer, COMPLIANCE_TX_DUTYCYCLE );
+            TimerSetDeferred( &ComplianceTxNextPacketTimer, true );
+            TimerSetValue( &ComplianceTxNextPacketTimer, COMPLIANCE_TX_PERIOD );
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+            memset1( ( uint8_t* )&ComplianceTimings, 0, sizeof( ComplianceTimings ) );
+            ComplianceTestState.Test = COMPLIANCE_TEST_NB;
+            ComplianceTestState.SessionStartTime = TimerGetCurrentTime( );
+            ComplianceTestState.TestStartTime = ComplianceTestState.SessionStartTime;
+#endif
 
             // Confirm compliance test protocol activation
             CRITICAL_SECTION_BEGIN( );
@@ -335,6 +390,9 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
 
         // Parse compliance test protocol
         ComplianceTestState.State = mcpsIndication->Buffer[0];
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+        LmhpComplianceTimingsUpdate( ComplianceTestState.State );
+#endif
         switch( ComplianceTestState.State )
         {
         case 0: // Check compliance test disable command (ii)
@@ -405,8 +463,13 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
                 mibReq.Param.AdrEnable = LmhpComplianceParams->AdrEnabled;
                 LoRaMacMibSetRequestConfirm( &mibReq );
 
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+                // The test tool reactivates the test mode after the join,
+                // the duty cycle is left disabled for it
+#else
                 // Enable duty cycle enforcement
                 LoRaMacTestSetDutyCycleOn( LmhpComplianceParams->DutyCycleEnabled );
+#endif
 
                 // Restart peripherals
                 if( LmhpComplianceParams->StartPeripherals != NULL )
@@ -468,6 +531,13 @@ static void LmhpComplianceOnMcpsIndication( McpsIndication_t* mcpsIndication )
         default:
             break;
         }
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+        if( ComplianceTestState.IsRunning == true )
+        {
+            // Answer right away instead of on the next period
+            ComplianceTestState.TxPending = true;
+        }
+#endif
     }
 }
 
@@ -481,11 +551,61 @@ static void LmhpComplianceProcess( void )
     CRITICAL_SECTION_END( );
     if( isPending == true )
     {
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+        if( ( LmhpComplianceTxProcess( ) != LORAMAC_HANDLER_SUCCESS ) && ( LoRaMacIsBusy( ) == true ) )
+        {
+            // Still in the RX windows of the previous uplink. Resumed by the
+            // MAC event ending them.
+            ComplianceTestState.TxPending = true;
+        }
+#else
         LmhpComplianceTxProcess( );
+#endif
     }
 }
 
+static TimerTime_t LmhpComplianceGetNextDeadline( void )
+{
+    if( ComplianceTestState.TxPending == true )
+    {
+        return 0;
+    }
+    return LMH_PACKAGE_NO_DEADLINE;
+}
+
 static void OnComplianceTxNextPacketTimerEvent( void* context )
 {
     ComplianceTestState.TxPending = true;
 }
+
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+static void LmhpComplianceTimingsUpdate( uint8_t nextTest )
+{
+    TimerTime_t now = TimerGetCurrentTime( );
+    uint8_t test = ComplianceTestState.Test;
+
+    if( test < COMPLIANCE_TEST_NB )
+    {
+        TimerTime_t duration = now - ComplianceTestState.TestStartTime;
+
+        ComplianceTimings.Tests[test].Count++;
+        ComplianceTimings.Tests[test].TotalTime += duration;
+        if( duration > ComplianceTimings.Tests[test].MaxTime )
+        {
+            ComplianceTimings.Tests[test].MaxTime = duration;
+        }
+    }
+    ComplianceTestState.Test = nextTest;
+    ComplianceTestState.TestStartTime = now;
+    ComplianceTimings.SessionTime = now - ComplianceTestState.SessionStartTime;
+}
+
+const LmhpComplianceTimings_t* LmhpComplianceGetTimings( void )
+{
+    if( ComplianceTestState.IsRunning == true )
+    {
+        ComplianceTimings.SessionTime = TimerGetElapsedTime( ComplianceTestState.SessionStartTime );
+    }
+    return &ComplianceTimings;
+}
+#endif
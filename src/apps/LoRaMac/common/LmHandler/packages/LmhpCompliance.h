@@ -65,4 +65,43 @@ typedef struct LmhpComplianceParams_s
 
 LmhPackage_t *LmphCompliancePackageFactory( void );
 
+#if defined( COMPLIANCE_FAST_MODE_ENABLED )
+/*!
+ * Number of compliance test commands, identifiers [0..10]
+ */
+#define COMPLIANCE_TEST_NB                          11
+
+/*!
+ * Duration of a compliance test, from its command downlink to the next one
+ */
+typedef struct LmhpComplianceTestTiming_s
+{
+    uint16_t Count;
+    TimerTime_t TotalTime;
+    TimerTime_t MaxTime;
+}LmhpComplianceTestTiming_t;
+
+/*!
+ * Compliance session timings, fast certification mode only
+ */
+typedef struct LmhpComplianceTimings_s
+{
+    /*!
+     * Time since the test mode activation [ms]
+     */
+    TimerTime_t SessionTime;
+    /*!
+     * Timing of each test command identifier
+     */
+    LmhpComplianceTestTiming_t Tests[COMPLIANCE_TEST_NB];
+}LmhpComplianceTimings_t;
+
+/*!
+ * \brief Gets the timings of the current or latest compliance session
+ *
+ * \retval timings Session timings, reset by the test mode activation
+ */
+const LmhpComplianceTimings_t* LmhpComplianceGetTimings( void );
+#endif
+
 #endif // __LMHP_COMPLIANCE__
@@ -0,0 +1,299 @@
+/*!
+ * \file      LmhpFragUplink.c
+ *
+ * \brief     Sends large files uplink as fragments protected by the
+ *            fragmentation package forward error correction
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#include "LmHandler.h"
+#include "LmhpFragUplink.h"
+#include "FragEncoder.h"
+
+/*!
+ * Frames of the uplink session, same identifiers as the fragmented data
+ * block transport package requests
+ */
+#define FRAG_UPLINK_SESSION_SETUP                   0x02
+#define FRAG_UPLINK_DATA_FRAGMENT                   0x08
+
+#define FRAG_UPLINK_SESSION_SETUP_SIZE              11
+#define FRAG_UPLINK_DATA_FRAGMENT_HEADER_SIZE       3
+
+/*!
+ * Package current context
+ */
+typedef struct LmhpFragUplinkState_s
+{
+    bool Initialized;
+    bool IsSending;
+    uint8_t DataBufferMaxSize;
+    uint8_t *DataBuffer;
+    /*!
+     * Session index, 2 bits, incremented by each session
+     */
+    uint8_t FragIndex;
+    uint32_t Descriptor;
+    /*!
+     * Next fragment to be queued, 0 being the session setup
+     */
+    uint16_t FragCounter;
+    uint16_t FragTotal;
+    uint8_t FragSize;
+}LmhpFragUplinkState_t;
+
+/*!
+ * Uplink fragmentation package parameters
+ */
+static LmhpFragUplinkParams_t* LmhpFragUplinkParams;
+
+/*!
+ * Initializes the package with provided parameters
+ *
+ * \param [IN] params            Pointer to the package parameters
+ * \param [IN] dataBuffer        Pointer to main application buffer
+ * \param [IN] dataBufferMaxSize Main application buffer maximum size
+ */
+static void LmhpFragUplinkInit( void *params, uint8_t *dataBuffer, uint8_t dataBufferMaxSize );
+
+/*!
+ * Returns the current package initialization status.
+ *
+ * \retval status Package initialization status
+ *                [true: Initialized, false: Not initialized]
+ */
+static bool LmhpFragUplinkIsInitialized( void );
+
+/*!
+ * Returns the package operation status.
+ *
+ * \retval status Package operation status
+ *                [true: Running, false: Not running]
+ */
+static bool LmhpFragUplinkIsRunning( void );
+
+/*!
+ * Processes the internal package events.
+ */
+static void LmhpFragUplinkProcess( void );
+
+/*!
+ * Returns the time until the package Process function must be called.
+ *
+ * \retval deadline 0 when work is pending, the time in ms until the next
+ *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+ */
+static TimerTime_t LmhpFragUplinkGetNextDeadline( void );
+
+/*!
+ * Ends the session and notifies the application
+ *
+ * \param [IN] status Session status
+ */
+static void LmhpFragUplinkDone( int32_t status );
+
+static LmhpFragUplinkState_t LmhpFragUplinkState =
+{
+    .Initialized = false,
+    .IsSending = false,
+    .FragIndex = 0,
+};
+
+/*!
+ * Encoder context of the session
+ */
+static FragEncoder_t FragEncoder;
+
+static LmhPackage_t LmhpFragUplinkPackage =
+{
+    .Port = FRAG_UPLINK_PORT,
+    .Init = LmhpFragUplinkInit,
+    .IsInitialized = LmhpFragUplinkIsInitialized,
+    .IsRunning = LmhpFragUplinkIsRunning,
+    .Process = LmhpFragUplinkProcess,
+    .GetNextDeadline = LmhpFragUplinkGetNextDeadline,
+    .OnMcpsConfirmProcess = NULL,                              // Not used in this package
+    .OnMcpsIndicationProcess = NULL,                           // Not used in this package
+    .OnMlmeConfirmProcess = NULL,                              // Not used in this package
+    .OnMlmeIndicationProcess = NULL,                           // Not used in this package
+    .OnMacMcpsRequest = NULL,                                  // To be initialized by LmHandler
+    .OnMacMlmeRequest = NULL,                                  // To be initialized by LmHandler
+    .OnJoinRequest = NULL,                                     // To be initialized by LmHandler
+    .OnSendRequest = NULL,                                     // To be initialized by LmHandler
+    .OnDeviceTimeRequest = NULL,                               // To be initialized by LmHandler
+    .OnSysTimeUpdate = NULL,                                   // To be initialized by LmHandler
+};
+
+LmhPackage_t *LmhpFragUplinkPackageFactory( void )
+{
+    return &LmhpFragUplinkPackage;
+}
+
+static void LmhpFragUplinkInit( void *params, uint8_t *dataBuffer, uint8_t dataBufferMaxSize )
+{
+    if( ( params != NULL ) && ( dataBuffer != NULL ) )
+    {
+        LmhpFragUplinkParams = ( LmhpFragUplinkParams_t* )params;
+        LmhpFragUplinkState.DataBuffer = dataBuffer;
+        LmhpFragUplinkState.DataBufferMaxSize = dataBufferMaxSize;
+        LmhpFragUplinkState.Initialized = true;
+    }
+    else
+    {
+        LmhpFragUplinkParams = NULL;
+        LmhpFragUplinkState.Initialized = false;
+    }
+    LmhpFragUplinkState.IsSending = false;
+}
+
+static bool LmhpFragUplinkIsInitialized( void )
+{
+    return LmhpFragUplinkState.Initialized;
+}
+
+static bool LmhpFragUplinkIsRunning( void )
+{
+    if( LmhpFragUplinkState.Initialized == false )
+    {
+        return false;
+    }
+
+    return LmhpFragUplinkState.IsSending;
+}
+
+LmHandlerErrorStatus_t LmhpFragUplinkStart( uint32_t fileSize, uint8_t fragSize, uint16_t redundancy, uint32_t descriptor )
+{
+    if( ( LmhpFragUplinkState.Initialized == false ) || ( LmhpFragUplinkState.IsSending == true ) ||
+        ( ( fragSize + FRAG_UPLINK_DATA_FRAGMENT_HEADER_SIZE ) > LMHANDLER_UPLINK_BUFFER_SIZE ) ||
+        ( ( fragSize + FRAG_UPLINK_DATA_FRAGMENT_HEADER_SIZE ) > LmhpFragUplinkState.DataBufferMaxSize ) )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+    if( FragEncoderInit( &FragEncoder, fileSize, fragSize, &LmhpFragUplinkParams->EncoderCallbacks ) != FRAG_ENCODER_SUCCESS )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+    if( ( ( uint32_t )FragEncoderGetFragNb( &FragEncoder ) + redundancy ) > 0x3FFF )
+    {
+        // Fragment counters are 14 bits
+        return LORAMAC_HANDLER_ERROR;
+    }
+    LmhpFragUplinkState.FragIndex = ( LmhpFragUplinkState.FragIndex + 1 ) & 0x03;
+    LmhpFragUplinkState.Descriptor = descriptor;
+    LmhpFragUplinkState.FragSize = fragSize;
+    LmhpFragUplinkState.FragCounter = 0;
+    LmhpFragUplinkState.FragTotal = FragEncoderGetFragNb( &FragEncoder ) + redundancy;
+    LmhpFragUplinkState.IsSending = true;
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+void LmhpFragUplinkStop( void )
+{
+    if( LmhpFragUplinkState.IsSending == true )
+    {
+        LmhpFragUplinkDone( FRAG_UPLINK_STOPPED );
+    }
+}
+
+bool LmhpFragUplinkIsSending( void )
+{
+    return LmhpFragUplinkState.IsSending;
+}
+
+static void LmhpFragUplinkProcess( void )
+{
+    uint8_t *buffer = LmhpFragUplinkState.DataBuffer;
+    LmHandlerAppData_t appData;
+    LmHandlerMsgTypes_t msgType = LORAMAC_HANDLER_UNCONFIRMED_MSG;
+    uint8_t dataBufferIndex = 0;
+
+    if( ( LmhpFragUplinkState.IsSending == false ) || ( LmHandlerUplinkIsPending( FRAG_UPLINK_PORT ) == true ) )
+    {
+        // The scheduler holds a single fragment, the next one is built once
+        // the duty-cycle let it go
+        return;
+    }
+    if( LmhpFragUplinkState.FragCounter > LmhpFragUplinkState.FragTotal )
+    {
+        LmhpFragUplinkDone( FRAG_UPLINK_DONE );
+        return;
+    }
+
+    if( LmhpFragUplinkState.FragCounter == 0 )
+    {
+        uint16_t fragNb = FragEncoderGetFragNb( &FragEncoder );
+
+        // The server can't decode anything without it
+        msgType = LORAMAC_HANDLER_CONFIRMED_MSG;
+        buffer[dataBufferIndex++] = FRAG_UPLINK_SESSION_SETUP;
+        buffer[dataBufferIndex++] = ( LmhpFragUplinkState.FragIndex << 4 ) & 0x30;
+        buffer[dataBufferIndex++] = ( fragNb >> 0 ) & 0xFF;
+        buffer[dataBufferIndex++] = ( fragNb >> 8 ) & 0xFF;
+        buffer[dataBufferIndex++] = LmhpFragUplinkState.FragSize;
+        // FragAlgo 0, BlockAckDelay 0
+        buffer[dataBufferIndex++] = 0x00;
+        buffer[dataBufferIndex++] = FragEncoderGetPadding( &FragEncoder );
+        buffer[dataBufferIndex++] = ( LmhpFragUplinkState.Descriptor >> 0  ) & 0xFF;
+        buffer[dataBufferIndex++] = ( LmhpFragUplinkState.Descriptor >> 8  ) & 0xFF;
+        buffer[dataBufferIndex++] = ( LmhpFragUplinkState.Descriptor >> 16 ) & 0xFF;
+        buffer[dataBufferIndex++] = ( LmhpFragUplinkState.Descriptor >> 24 ) & 0xFF;
+    }
+    else
+    {
+        uint16_t indexAndN = ( ( uint16_t )LmhpFragUplinkState.FragIndex << 14 ) | LmhpFragUplinkState.FragCounter;
+
+        buffer[dataBufferIndex++] = FRAG_UPLINK_DATA_FRAGMENT;
+        buffer[dataBufferIndex++] = ( indexAndN >> 0 ) & 0xFF;
+        buffer[dataBufferIndex++] = ( indexAndN >> 8 ) & 0xFF;
+        if( FragEncoderGetFragment( &FragEncoder, LmhpFragUplinkState.FragCounter, &buffer[dataBufferIndex] ) != FRAG_ENCODER_SUCCESS )
+        {
+            LmhpFragUplinkDone( FRAG_UPLINK_ERROR_READ );
+            return;
+        }
+        dataBufferIndex += LmhpFragUplinkState.FragSize;
+    }
+
+    appData.Buffer = buffer;
+    appData.BufferSize = dataBufferIndex;
+    appData.Port = FRAG_UPLINK_PORT;
+    // Bulk data, the other uplinks go first. Queue full: retried on the next
+    // LmHandler event.
+    if( LmHandlerUplinkSchedule( &appData, msgType, LORAMAC_HANDLER_UPLINK_PRIORITY_TELEMETRY ) == LORAMAC_HANDLER_SUCCESS )
+    {
+        if( ( LmhpFragUplinkState.FragCounter != 0 ) && ( LmhpFragUplinkParams->OnProgress != NULL ) )
+        {
+            LmhpFragUplinkParams->OnProgress( LmhpFragUplinkState.FragCounter, FragEncoderGetFragNb( &FragEncoder ),
+                                              LmhpFragUplinkState.FragTotal );
+        }
+        LmhpFragUplinkState.FragCounter++;
+    }
+}
+
+static TimerTime_t LmhpFragUplinkGetNextDeadline( void )
+{
+    if( ( LmhpFragUplinkState.IsSending == true ) && ( LmHandlerUplinkIsPending( FRAG_UPLINK_PORT ) == false ) )
+    {
+        return 0;
+    }
+    return LMH_PACKAGE_NO_DEADLINE;
+}
+
+static void LmhpFragUplinkDone( int32_t status )
+{
+    LmhpFragUplinkState.IsSending = false;
+    if( LmhpFragUplinkParams->OnDone != NULL )
+    {
+        LmhpFragUplinkParams->OnDone( status );
+    }
+}
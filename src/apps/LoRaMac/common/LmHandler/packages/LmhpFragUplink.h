@@ -0,0 +1,111 @@
+/*!
+ * \file      LmhpFragUplink.h
+ *
+ * \brief     Sends large files uplink as fragments protected by the
+ *            fragmentation package forward error correction
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#ifndef __LMHP_FRAG_UPLINK_H__
+#define __LMHP_FRAG_UPLINK_H__
+
+#include "LoRaMac.h"
+#include "LmHandlerTypes.h"
+#include "LmhPackage.h"
+#include "FragEncoder.h"
+
+/*!
+ * Uplink fragmentation package identifier.
+ *
+ * \remark This value must be unique amongst the packages
+ */
+#define PACKAGE_ID_FRAG_UPLINK                      4
+
+/*!
+ * Application port of the uplink fragmentation session frames
+ */
+#ifndef FRAG_UPLINK_PORT
+#define FRAG_UPLINK_PORT                            202
+#endif
+
+#define FRAG_UPLINK_DONE                            ( int32_t )0
+#define FRAG_UPLINK_STOPPED                         ( int32_t )-1
+#define FRAG_UPLINK_ERROR_READ                      ( int32_t )-2
+
+/*!
+ * Uplink fragmentation package parameters
+ */
+typedef struct LmhpFragUplinkParams_s
+{
+    /*!
+     * FragEncoder Read function callback
+     */
+    FragEncoderCallbacks_t EncoderCallbacks;
+    /*!
+     * Notifies the progress of the current session
+     *
+     * \param [IN] fragCounter Counter of the fragment handed to the scheduler
+     * \param [IN] fragNb      Number of uncoded fragments
+     * \param [IN] fragTotal   Number of fragments, coded ones included
+     */
+    void ( *OnProgress )( uint16_t fragCounter, uint16_t fragNb, uint16_t fragTotal );
+    /*!
+     * Notifies that the session is finished, the last fragment being sent
+     *
+     * \param [IN] status Session status [FRAG_UPLINK_DONE, FRAG_UPLINK_STOPPED
+     *                    or FRAG_UPLINK_ERROR_READ]
+     */
+    void ( *OnDone )( int32_t status );
+}LmhpFragUplinkParams_t;
+
+LmhPackage_t *LmhpFragUplinkPackageFactory( void );
+
+/*!
+ * \brief Starts sending a file. The session setup is sent first, confirmed,
+ *        then the FragNb uncoded fragments and the coded ones, unconfirmed.
+ *
+ * \remark The frames use the fragmentation package FragSessionSetupReq and
+ *         DataFragment formats on \ref FRAG_UPLINK_PORT. The server
+ *         reconstructs the file like \ref FragDecoderProcess does once any
+ *         FragNb fragments, plus a few, are received.
+ *
+ * \remark One fragment at a time is queued in the LmHandler scheduler with
+ *         the telemetry priority. It is sent at the first duty-cycle
+ *         opportunity left by the higher priority uplinks.
+ *
+ * \param [IN] fileSize   File size, read through the EncoderCallbacks
+ * \param [IN] fragSize   Fragment size [1..FRAG_ENCODER_MAX_SIZE], the frame
+ *                        being fragSize + 3 bytes
+ * \param [IN] redundancy Number of coded fragments sent after the uncoded ones
+ * \param [IN] descriptor File descriptor copied to the session setup
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if the session is
+ *                started else \ref LORAMAC_HANDLER_ERROR
+ */
+LmHandlerErrorStatus_t LmhpFragUplinkStart( uint32_t fileSize, uint8_t fragSize, uint16_t redundancy, uint32_t descriptor );
+
+/*!
+ * \brief Stops the current session. The fragment already queued is still
+ *        sent.
+ */
+void LmhpFragUplinkStop( void );
+
+/*!
+ * \brief Indicates if a session is ongoing
+ *
+ * \retval status [true] Sending, [false] idle
+ */
+bool LmhpFragUplinkIsSending( void );
+
+#endif // __LMHP_FRAG_UPLINK_H__
@@ -19,6 +19,7 @@
  *
  * \author    Miguel Luis ( Semtech )
  */
+#include "board.h"
 #include "LmHandler.h"
 #include "LmhpFragmentation.h"
 #include "FragDecoder.h"
@@ -31,8 +32,6 @@
 #define FRAGMENTATION_ID                            3
 #define FRAGMENTATION_VERSION                       1
 
-#define FRAGMENTATION_MAX_SESSIONS                  4
-
 // Fragmentation Tx delay state
 typedef enum LmhpFragmentationTxDelayStates_e
 {
@@ -109,6 +108,14 @@ static bool LmhpFragmentationIsRunning( void );
  */
 static void LmhpFragmentationProcess( void );
 
+/*!
+ * Returns the time until the package Process function must be called.
+ *
+ * \retval deadline 0 when work is pending, the time in ms until the next
+ *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+ */
+static TimerTime_t LmhpFragmentationGetNextDeadline( void );
+
 /*!
  * Processes the MCPS Indication
  *
@@ -161,6 +168,18 @@ typedef struct FragSessionData_s
 
 FragSessionData_t FragSessionData[FRAGMENTATION_MAX_SESSIONS];
 
+/*!
+ * Decoder context of each session, sessions decode concurrently
+ */
+static FragDecoder_t FragDecoders[FRAGMENTATION_MAX_SESSIONS];
+
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+/*!
+ * CRC32 of the file of the latest finished session
+ */
+static uint32_t FileCrc32 = 0;
+#endif
+
 // Answer struct for the commands.
 LmHandlerAppData_t DelayedReplyAppData;
 
@@ -171,6 +190,7 @@ static LmhPackage_t LmhpFragmentationPackage =
     .IsInitialized = LmhpFragmentationIsInitialized,
     .IsRunning = LmhpFragmentationIsRunning,
     .Process = LmhpFragmentationProcess,
+    .GetNextDeadline = LmhpFragmentationGetNextDeadline,
     .OnMcpsConfirmProcess = NULL,                              // Not used in this package
     .OnMcpsIndicationProcess = LmhpFragmentationOnMcpsIndication,
     .OnMlmeConfirmProcess = NULL,                              // Not used in this package
@@ -218,6 +238,7 @@ static void LmhpFragmentationInit( void *params, uint8_t *dataBuffer, uint8_t da
         TxDelayTime = 0;
         // Initialize Fragmentation delay timer.
         TimerInit( &FragmentTxDelayTimer, OnFragmentTxDelay );
+        TimerSetDeferred( &FragmentTxDelayTimer, true );
     }
     else
     {
@@ -273,6 +294,15 @@ static void LmhpFragmentationProcess( void )
     }
 }
 
+static TimerTime_t LmhpFragmentationGetNextDeadline( void )
+{
+    if( LmhpFragmentationState.TxDelayState != FRAGMENTATION_TX_DELAY_STATE_IDLE )
+    {
+        return 0;
+    }
+    return LMH_PACKAGE_NO_DEADLINE;
+}
+
 static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication )
 {
     uint8_t cmdIndex = 0;
@@ -304,8 +334,8 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                 uint8_t fragIndex = mcpsIndication->Buffer[cmdIndex++];
                 uint8_t participants = fragIndex & 0x01;
 
-                fragIndex >>= 1;
-                FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( );
+                fragIndex = ( fragIndex >> 1 ) & 0x03;
+                FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( &FragDecoders[fragIndex] );
 
                 if( ( participants == 1 ) ||
                     ( ( participants == 0 ) && ( FragSessionData[fragIndex].FragDecoderStatus.FragNbLost > 0 ) ) )
@@ -383,17 +413,31 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                 {
                     // The FragSessionSetup is accepted
                     fragSessionData.FragGroupData.IsActive = true;
+                    uint8_t fragIndex = fragSessionData.FragGroupData.FragSession.Fields.FragIndex;
+
                     fragSessionData.FragDecoderPorcessStatus = FRAG_SESSION_ONGOING;
-                    FragSessionData[fragSessionData.FragGroupData.FragSession.Fields.FragIndex] = fragSessionData;
+                    FragSessionData[fragIndex] = fragSessionData;
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
-                    FragDecoderInit( fragSessionData.FragGroupData.FragNb,
+                    FragDecoderCallbacks_t *callbacks = LmhpFragmentationParams->SessionDecoderCallbacks[fragIndex];
+
+                    if( callbacks == NULL )
+                    {
+                        callbacks = &LmhpFragmentationParams->DecoderCallbacks;
+                    }
+                    FragDecoderInit( &FragDecoders[fragIndex],
+                                     fragSessionData.FragGroupData.FragNb,
                                      fragSessionData.FragGroupData.FragSize,
-                                     &LmhpFragmentationParams->DecoderCallbacks );
+                                     callbacks );
 #else
-                    FragDecoderInit( fragSessionData.FragGroupData.FragNb,
+                    FragDecoderInit( &FragDecoders[fragIndex],
+                                     fragSessionData.FragGroupData.FragNb,
                                      fragSessionData.FragGroupData.FragSize,
                                      LmhpFragmentationParams->Buffer,
                                      LmhpFragmentationParams->BufferSize );
+#endif
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+                    FragDecoderSetFileCrcSize( &FragDecoders[fragIndex],
+                                               ( ( uint32_t )fragSessionData.FragGroupData.FragNb * fragSessionData.FragGroupData.FragSize ) - fragSessionData.FragGroupData.Padding );
 #endif
                 }
                 LmhpFragmentationState.DataBuffer[dataBufferIndex++] = FRAGMENTATION_FRAG_SESSION_SETUP_ANS;
@@ -455,8 +499,11 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
 
                 if( FragSessionData[fragIndex].FragDecoderPorcessStatus == FRAG_SESSION_ONGOING )
                 {
-                    FragSessionData[fragIndex].FragDecoderPorcessStatus = FragDecoderProcess( fragCounter, &mcpsIndication->Buffer[cmdIndex] );
-                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( );
+                    // The fragments reconstruction runs at full speed
+                    BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_HIGH );
+                    FragSessionData[fragIndex].FragDecoderPorcessStatus = FragDecoderProcess( &FragDecoders[fragIndex], fragCounter, &mcpsIndication->Buffer[cmdIndex] );
+                    BoardSetPerformanceLevel( BOARD_PERFORMANCE_LEVEL_LOW );
+                    FragSessionData[fragIndex].FragDecoderStatus = FragDecoderGetStatus( &FragDecoders[fragIndex] );
                     if( LmhpFragmentationParams->OnProgress != NULL )
                     {
                         LmhpFragmentationParams->OnProgress( FragSessionData[fragIndex].FragDecoderStatus.FragNbRx,
@@ -471,6 +518,9 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
                     {
                         // Fragmentation successfully done
                         FragSessionData[fragIndex].FragDecoderPorcessStatus = FRAG_SESSION_NOT_STARTED;
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+                        FileCrc32 = FragDecoderGetFileCrc32( &FragDecoders[fragIndex] );
+#endif
                         if( LmhpFragmentationParams->OnDone != NULL )
                         {
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
@@ -525,3 +575,10 @@ static void LmhpFragmentationOnMcpsIndication( McpsIndication_t *mcpsIndication
         }
     }
 }
+
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+uint32_t LmhpFragmentationGetFileCrc32( void )
+{
+    return FileCrc32;
+}
+#endif
@@ -34,6 +34,11 @@
  */
 #define PACKAGE_ID_FRAGMENTATION                    3
 
+/*!
+ * Maximum number of concurrent fragmentation sessions
+ */
+#define FRAGMENTATION_MAX_SESSIONS                  4
+
 /*!
  * Fragmentation package parameters
  */
@@ -44,6 +49,14 @@ typedef struct LmhpFragmentationParams_s
      * FragDecoder Write/Read function callbacks
      */
     FragDecoderCallbacks_t DecoderCallbacks;
+    /*!
+     * Optional per session FragDecoder callbacks, indexed by the session
+     * FragIndex. Sessions without their own callbacks use DecoderCallbacks.
+     *
+     * \remark Concurrent sessions sharing DecoderCallbacks write to the same
+     *         file addresses.
+     */
+    FragDecoderCallbacks_t *SessionDecoderCallbacks[FRAGMENTATION_MAX_SESSIONS];
 #else
     /*!
      * Pointer to the un-fragmented received buffer.
@@ -89,4 +102,14 @@ typedef struct LmhpFragmentationParams_s
 
 LmhPackage_t *LmhpFragmentationPackageFactory( void );
 
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+/*!
+ * \brief Gets the CRC32 of the file of the latest finished session, padding
+ *        excluded. Already available when OnDone is called.
+ *
+ * \retval crc File CRC32
+ */
+uint32_t LmhpFragmentationGetFileCrc32( void );
+#endif
+
 #endif // __LMHP_FRAGMENTATION_H__
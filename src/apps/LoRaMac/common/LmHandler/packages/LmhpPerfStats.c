@@ -0,0 +1,468 @@
+/*!
+ * \file      LmhpPerfStats.c
+ *
+ * \brief     Reports the device performance counters to the server
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#include "utilities.h"
+#include "timer.h"
+#include "eeprom.h"
+#include "energy.h"
+#include "LmHandler.h"
+#include "LmhpPerfStats.h"
+
+/*!
+ * Package current version
+ */
+#define PERF_STATS_ID                               5
+#define PERF_STATS_VERSION                          1
+
+/*!
+ * Package commands and frames
+ */
+#define PERF_STATS_PKG_VERSION_REQ                  0x00
+#define PERF_STATS_PKG_VERSION_ANS                  0x00
+#define PERF_STATS_PERIOD_REQ                       0x01
+#define PERF_STATS_PERIOD_ANS                       0x01
+#define PERF_STATS_REPORT_REQ                       0x02
+#define PERF_STATS_REPORT                           0x02
+
+#define PERF_STATS_REPORT_SIZE                      22
+
+/*!
+ * Delay before trying to queue the report again when the LmHandler
+ * scheduler is full [ms]
+ */
+#define PERF_STATS_RETRY_DELAY                      10000
+
+/*!
+ * Package current context
+ */
+typedef struct LmhpPerfStatsState_s
+{
+    bool Initialized;
+    uint8_t DataBufferMaxSize;
+    uint8_t *DataBuffer;
+    /*!
+     * Reporting period [minutes], 0 when disabled
+     */
+    uint16_t Period;
+    bool ReportPending;
+    /*!
+     * Time of the next try to queue the pending report
+     */
+    TimerTime_t RetryTime;
+    /*!
+     * Counters accumulated since the last report
+     */
+    uint32_t Uplinks;
+    uint32_t RxMisses;
+    uint32_t Retries;
+    /*!
+     * Values of the free running counters at the last report
+     */
+    TimerTime_t StartTime;
+    uint32_t NvmWrites;
+    uint32_t Wakeups;
+    uint64_t ChargeUc;
+}LmhpPerfStatsState_t;
+
+/*!
+ * Initializes the package with provided parameters
+ *
+ * \param [IN] params            Pointer to the package parameters
+ * \param [IN] dataBuffer        Pointer to main application buffer
+ * \param [IN] dataBufferMaxSize Main application buffer maximum size
+ */
+static void LmhpPerfStatsInit( void *params, uint8_t *dataBuffer, uint8_t dataBufferMaxSize );
+
+/*!
+ * Returns the current package initialization status.
+ *
+ * \retval status Package initialization status
+ *                [true: Initialized, false: Not initialized]
+ */
+static bool LmhpPerfStatsIsInitialized( void );
+
+/*!
+ * Returns the package operation status.
+ *
+ * \retval status Package operation status
+ *                [true: Running, false: Not running]
+ */
+static bool LmhpPerfStatsIsRunning( void );
+
+/*!
+ * Processes the internal package events.
+ */
+static void LmhpPerfStatsProcess( void );
+
+/*!
+ * Returns the time until the package Process function must be called.
+ *
+ * \retval deadline 0 when work is pending, the time in ms until the next
+ *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+ */
+static TimerTime_t LmhpPerfStatsGetNextDeadline( void );
+
+/*!
+ * Processes the MCPS Confirm
+ *
+ * \param [IN] mcpsConfirm MCPS confirmation primitive data
+ */
+static void LmhpPerfStatsOnMcpsConfirm( McpsConfirm_t *mcpsConfirm );
+
+/*!
+ * Processes the MCPS Indication
+ *
+ * \param [IN] mcpsIndication     MCPS indication primitive data
+ */
+static void LmhpPerfStatsOnMcpsIndication( McpsIndication_t *mcpsIndication );
+
+/*!
+ * Restarts the counters and the reporting period
+ */
+static void PerfStatsRestart( void );
+
+/*!
+ * Builds the report in the package buffer
+ *
+ * \retval size Report size
+ */
+static uint8_t PerfStatsBuildReport( void );
+
+static LmhpPerfStatsState_t LmhpPerfStatsState =
+{
+    .Initialized = false,
+    .Period = PERF_STATS_DEFAULT_PERIOD,
+    .ReportPending = false,
+};
+
+static LmhPackage_t LmhpPerfStatsPackage =
+{
+    .Port = PERF_STATS_PORT,
+    .Init = LmhpPerfStatsInit,
+    .IsInitialized = LmhpPerfStatsIsInitialized,
+    .IsRunning = LmhpPerfStatsIsRunning,
+    .Process = LmhpPerfStatsProcess,
+    .GetNextDeadline = LmhpPerfStatsGetNextDeadline,
+    .OnMcpsConfirmProcess = LmhpPerfStatsOnMcpsConfirm,
+    .OnMcpsIndicationProcess = LmhpPerfStatsOnMcpsIndication,
+    .OnMlmeConfirmProcess = NULL,                              // Not used in this package
+    .OnMlmeIndicationProcess = NULL,                           // Not used in this package
+    .OnMacMcpsRequest = NULL,                                  // To be initialized by LmHandler
+    .OnMacMlmeRequest = NULL,                                  // To be initialized by LmHandler
+    .OnJoinRequest = NULL,                                     // To be initialized by LmHandler
+    .OnSendRequest = NULL,                                     // To be initialized by LmHandler
+    .OnDeviceTimeRequest = NULL,                               // To be initialized by LmHandler
+    .OnSysTimeUpdate = NULL,                                   // To be initialized by LmHandler
+};
+
+LmhPackage_t *LmhpPerfStatsPackageFactory( void )
+{
+    return &LmhpPerfStatsPackage;
+}
+
+static void LmhpPerfStatsInit( void *params, uint8_t *dataBuffer, uint8_t dataBufferMaxSize )
+{
+    if( ( dataBuffer != NULL ) && ( dataBufferMaxSize >= PERF_STATS_REPORT_SIZE ) )
+    {
+        LmhpPerfStatsState.DataBuffer = dataBuffer;
+        LmhpPerfStatsState.DataBufferMaxSize = dataBufferMaxSize;
+        LmhpPerfStatsState.Initialized = true;
+        PerfStatsRestart( );
+    }
+    else
+    {
+        LmhpPerfStatsState.Initialized = false;
+    }
+    LmhpPerfStatsState.ReportPending = false;
+}
+
+static bool LmhpPerfStatsIsInitialized( void )
+{
+    return LmhpPerfStatsState.Initialized;
+}
+
+static bool LmhpPerfStatsIsRunning( void )
+{
+    return LmhpPerfStatsState.Initialized;
+}
+
+LmHandlerErrorStatus_t LmhpPerfStatsReportReq( void )
+{
+    if( LmhpPerfStatsState.Initialized == false )
+    {
+        return LORAMAC_HANDLER_ERROR;
+    }
+    LmhpPerfStatsState.ReportPending = true;
+    LmhpPerfStatsState.RetryTime = TimerGetCurrentTime( );
+    return LORAMAC_HANDLER_SUCCESS;
+}
+
+static void LmhpPerfStatsProcess( void )
+{
+    LmHandlerAppData_t appData;
+
+    if( LmhpPerfStatsState.Initialized == false )
+    {
+        return;
+    }
+    if( ( LmhpPerfStatsState.ReportPending == false ) && ( LmhpPerfStatsState.Period != 0 ) &&
+        ( ( TimerGetCurrentTime( ) - LmhpPerfStatsState.StartTime ) >= ( LmhpPerfStatsState.Period * 60000UL ) ) )
+    {
+        LmhpPerfStatsState.ReportPending = true;
+        LmhpPerfStatsState.RetryTime = TimerGetCurrentTime( );
+    }
+    if( ( LmhpPerfStatsState.ReportPending == false ) ||
+        ( ( int32_t )( TimerGetCurrentTime( ) - LmhpPerfStatsState.RetryTime ) < 0 ) ||
+        ( LmHandlerJoinStatus( ) != LORAMAC_HANDLER_SET ) || ( LmHandlerUplinkIsPending( PERF_STATS_PORT ) == true ) )
+    {
+        return;
+    }
+
+    appData.Buffer = LmhpPerfStatsState.DataBuffer;
+    appData.BufferSize = PerfStatsBuildReport( );
+    appData.Port = PERF_STATS_PORT;
+    // Diagnostics, the application uplinks go first
+    if( LmHandlerUplinkSchedule( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG, LORAMAC_HANDLER_UPLINK_PRIORITY_TELEMETRY ) == LORAMAC_HANDLER_SUCCESS )
+    {
+        LmhpPerfStatsState.ReportPending = false;
+        PerfStatsRestart( );
+    }
+    else
+    {
+        LmhpPerfStatsState.RetryTime = TimerGetCurrentTime( ) + PERF_STATS_RETRY_DELAY;
+    }
+}
+
+static TimerTime_t LmhpPerfStatsGetNextDeadline( void )
+{
+    TimerTime_t now = TimerGetCurrentTime( );
+    TimerTime_t elapsed;
+
+    if( LmhpPerfStatsState.Initialized == false )
+    {
+        return LMH_PACKAGE_NO_DEADLINE;
+    }
+    if( LmhpPerfStatsState.ReportPending == true )
+    {
+        if( ( LmHandlerJoinStatus( ) != LORAMAC_HANDLER_SET ) || ( LmHandlerUplinkIsPending( PERF_STATS_PORT ) == true ) )
+        {
+            // Processed again by the join or the uplink completion events
+            return LMH_PACKAGE_NO_DEADLINE;
+        }
+        if( ( int32_t )( LmhpPerfStatsState.RetryTime - now ) > 0 )
+        {
+            return LmhpPerfStatsState.RetryTime - now;
+        }
+        return 0;
+    }
+    if( LmhpPerfStatsState.Period == 0 )
+    {
+        return LMH_PACKAGE_NO_DEADLINE;
+    }
+    elapsed = now - LmhpPerfStatsState.StartTime;
+    if( elapsed >= ( LmhpPerfStatsState.Period * 60000UL ) )
+    {
+        return 0;
+    }
+    return ( LmhpPerfStatsState.Period * 60000UL ) - elapsed;
+}
+
+static void LmhpPerfStatsOnMcpsConfirm( McpsConfirm_t *mcpsConfirm )
+{
+    if( LmhpPerfStatsState.Initialized == false )
+    {
+        return;
+    }
+    LmhpPerfStatsState.Uplinks++;
+    if( mcpsConfirm->NbRetries > 1 )
+    {
+        LmhpPerfStatsState.Retries += mcpsConfirm->NbRetries - 1;
+    }
+    if( ( mcpsConfirm->McpsRequest == MCPS_CONFIRMED ) && ( mcpsConfirm->AckReceived == false ) )
+    {
+        LmhpPerfStatsState.RxMisses++;
+    }
+}
+
+static void LmhpPerfStatsOnMcpsIndication( McpsIndication_t *mcpsIndication )
+{
+    uint8_t cmdIndex = 0;
+    uint8_t dataBufferIndex = 0;
+
+    while( cmdIndex < mcpsIndication->BufferSize )
+    {
+        switch( mcpsIndication->Buffer[cmdIndex++] )
+        {
+            case PERF_STATS_PKG_VERSION_REQ:
+            {
+                LmhpPerfStatsState.DataBuffer[dataBufferIndex++] = PERF_STATS_PKG_VERSION_ANS;
+                LmhpPerfStatsState.DataBuffer[dataBufferIndex++] = PERF_STATS_ID;
+                LmhpPerfStatsState.DataBuffer[dataBufferIndex++] = PERF_STATS_VERSION;
+                break;
+            }
+            case PERF_STATS_PERIOD_REQ:
+            {
+                if( ( cmdIndex + 2 ) > mcpsIndication->BufferSize )
+                {
+                    // Truncated command, ignore the remaining bytes
+                    cmdIndex = mcpsIndication->BufferSize;
+                    break;
+                }
+                LmhpPerfStatsState.Period  = ( mcpsIndication->Buffer[cmdIndex++] << 0 ) & 0x00FF;
+                LmhpPerfStatsState.Period |= ( mcpsIndication->Buffer[cmdIndex++] << 8 ) & 0xFF00;
+                // The new period starts now, the counters are kept
+                LmhpPerfStatsState.StartTime = TimerGetCurrentTime( );
+                LmhpPerfStatsState.DataBuffer[dataBufferIndex++] = PERF_STATS_PERIOD_ANS;
+                // Answer status supported.
+                LmhpPerfStatsState.DataBuffer[dataBufferIndex++] = 0x00;
+                break;
+            }
+            case PERF_STATS_REPORT_REQ:
+            {
+                LmhpPerfStatsReportReq( );
+                break;
+            }
+            default:
+            {
+                // Unknown command, the remaining bytes can't be parsed
+                cmdIndex = mcpsIndication->BufferSize;
+                break;
+            }
+        }
+    }
+
+    if( dataBufferIndex != 0 )
+    {
+        // Answer commands
+        LmHandlerAppData_t appData =
+        {
+            .Buffer = LmhpPerfStatsState.DataBuffer,
+            .BufferSize = dataBufferIndex,
+            .Port = PERF_STATS_PORT
+        };
+        LmhpPerfStatsPackage.OnSendRequest( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
+    }
+}
+
+static void PerfStatsRestart( void )
+{
+    MibRequestConfirm_t mibReq;
+
+    LmhpPerfStatsState.Uplinks = 0;
+    LmhpPerfStatsState.RxMisses = 0;
+    LmhpPerfStatsState.Retries = 0;
+    LmhpPerfStatsState.StartTime = TimerGetCurrentTime( );
+    LmhpPerfStatsState.NvmWrites = EepromGetWriteCount( );
+    LmhpPerfStatsState.Wakeups = EnergyGetMcuWakeups( );
+    LmhpPerfStatsState.ChargeUc = EnergyGetChargeUc( );
+
+    // Restarts the MAC latency statistics, if built in
+    mibReq.Type = MIB_LATENCY_STATS;
+    if( LoRaMacMibGetRequestConfirm( &mibReq ) == LORAMAC_STATUS_OK )
+    {
+        LoRaMacMibSetRequestConfirm( &mibReq );
+    }
+}
+
+/*!
+ * Clamps a counter to the 16 bits field of the report
+ */
+static uint16_t PerfStatsClamp16( uint64_t value )
+{
+    return ( value > 0xFFFF ) ? 0xFFFF : ( uint16_t )value;
+}
+
+static uint8_t PerfStatsBuildReport( void )
+{
+    uint8_t *buffer = LmhpPerfStatsState.DataBuffer;
+    uint8_t dataBufferIndex = 0;
+    TimerTime_t elapsedMs = TimerGetCurrentTime( ) - LmhpPerfStatsState.StartTime;
+    uint16_t value;
+    uint32_t charge = 0xFFFFFF;
+    uint16_t txCrypto = 0xFFFF;
+    uint16_t rxCrypto = 0xFFFF;
+    int16_t rx1OffsetMax = 0x7FFF;
+    MibRequestConfirm_t mibReq;
+
+    if( elapsedMs == 0 )
+    {
+        elapsedMs = 1;
+    }
+
+    buffer[dataBufferIndex++] = PERF_STATS_REPORT;
+
+    value = PerfStatsClamp16( elapsedMs / 60000 );
+    buffer[dataBufferIndex++] = ( value >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( value >> 8 ) & 0xFF;
+
+    value = PerfStatsClamp16( LmhpPerfStatsState.Uplinks );
+    buffer[dataBufferIndex++] = ( value >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( value >> 8 ) & 0xFF;
+
+    value = PerfStatsClamp16( LmhpPerfStatsState.RxMisses );
+    buffer[dataBufferIndex++] = ( value >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( value >> 8 ) & 0xFF;
+
+    value = PerfStatsClamp16( LmhpPerfStatsState.Retries );
+    buffer[dataBufferIndex++] = ( value >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( value >> 8 ) & 0xFF;
+
+    value = PerfStatsClamp16( EepromGetWriteCount( ) - LmhpPerfStatsState.NvmWrites );
+    buffer[dataBufferIndex++] = ( value >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( value >> 8 ) & 0xFF;
+
+    value = 0xFFFF;
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+    value = PerfStatsClamp16( ( ( uint64_t )( EnergyGetMcuWakeups( ) - LmhpPerfStatsState.Wakeups ) * 3600000 ) / elapsedMs );
+    // uC per elapsed ms to uAh per day: / 3600 * 86400000
+    charge = ( ( EnergyGetChargeUc( ) - LmhpPerfStatsState.ChargeUc ) * 24000 ) / elapsedMs;
+    charge = MIN( charge, 0xFFFFFE );
+#endif
+    buffer[dataBufferIndex++] = ( value >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( value >> 8 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( charge >> 0  ) & 0xFF;
+    buffer[dataBufferIndex++] = ( charge >> 8  ) & 0xFF;
+    buffer[dataBufferIndex++] = ( charge >> 16 ) & 0xFF;
+
+    mibReq.Type = MIB_LATENCY_STATS;
+    if( LoRaMacMibGetRequestConfirm( &mibReq ) == LORAMAC_STATUS_OK )
+    {
+        const LoRaMacLatencyStats_t *stats = mibReq.Param.LatencyStats;
+
+        if( stats->TxCrypto.Count != 0 )
+        {
+            txCrypto = PerfStatsClamp16( MAX( stats->TxCrypto.Avg, 0 ) );
+        }
+        if( stats->RxCrypto.Count != 0 )
+        {
+            rxCrypto = PerfStatsClamp16( MAX( stats->RxCrypto.Avg, 0 ) );
+        }
+        if( stats->Rx1Offset.Count != 0 )
+        {
+            rx1OffsetMax = MIN( MAX( stats->Rx1Offset.Max, -32768 ), 32766 );
+        }
+    }
+    buffer[dataBufferIndex++] = ( txCrypto >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( txCrypto >> 8 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( rxCrypto >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( rxCrypto >> 8 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( ( uint16_t )rx1OffsetMax >> 0 ) & 0xFF;
+    buffer[dataBufferIndex++] = ( ( uint16_t )rx1OffsetMax >> 8 ) & 0xFF;
+
+    return dataBufferIndex;
+}
@@ -0,0 +1,96 @@
+/*!
+ * \file      LmhpPerfStats.h
+ *
+ * \brief     Reports the device performance counters to the server
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ */
+#ifndef __LMHP_PERF_STATS_H__
+#define __LMHP_PERF_STATS_H__
+
+#include "LoRaMac.h"
+#include "LmHandlerTypes.h"
+#include "LmhPackage.h"
+
+/*!
+ * Performance statistics package identifier.
+ *
+ * \remark This value must be unique amongst the packages
+ */
+#define PACKAGE_ID_PERF_STATS                       5
+
+/*!
+ * Application port of the performance statistics frames
+ */
+#ifndef PERF_STATS_PORT
+#define PERF_STATS_PORT                             203
+#endif
+
+/*!
+ * Default reporting period [minutes]. 0 reports on the server request only.
+ */
+#ifndef PERF_STATS_DEFAULT_PERIOD
+#define PERF_STATS_DEFAULT_PERIOD                   1440
+#endif
+
+/*!
+ * Performance statistics package parameters
+ *
+ * This package doesn't require parameters
+ */
+//typedef struct LmhpPerfStatsParams_s
+//{
+//}LmhpPerfStatsParams_t;
+
+/*!
+ * \brief Performance statistics package.
+ *
+ * Accumulates the MAC, NVM and energy counters and reports them on
+ * \ref PERF_STATS_PORT every reporting period. Downlink commands:
+ *
+ * Command           | Id   | Payload
+ * ----------------- | ---- | -----------------------------------------------
+ * PackageVersionReq | 0x00 | -
+ * PeriodReq         | 0x01 | Period [minutes], 2 bytes, 0 disables the timer
+ * ReportReq         | 0x02 | -
+ *
+ * The report, 0x02 followed by 21 bytes, little endian:
+ *
+ * Field         | Size | Content
+ * ------------- | ---- | --------------------------------------------------
+ * Elapsed       | 2    | Time covered by the report [minutes]
+ * Uplinks       | 2    | Uplinks completed by the MAC ( MCPS-Confirm )
+ * RxMisses      | 2    | Confirmed uplinks not acknowledged in Rx1 or Rx2
+ * Retries       | 2    | Retransmissions, the first try excluded
+ * NvmWrites     | 2    | Writes handed to the EEPROM driver
+ * Wakeups       | 2    | MCU wake ups per hour, 0xFFFF when not accounted
+ * Charge        | 3    | Charge per day [uAh], 0xFFFFFF when not accounted
+ * TxCrypto      | 2    | Average uplink crypto time, 0xFFFF when not measured
+ * RxCrypto      | 2    | Average downlink crypto time, 0xFFFF when not measured
+ * Rx1OffsetMax  | 2    | Worst Rx1 window opening error, signed, 0x7FFF when
+ *               |      | not measured
+ *
+ * The counters restart after each report.
+ */
+LmhPackage_t *LmhpPerfStatsPackageFactory( void );
+
+/*!
+ * \brief Queues a report with the counters accumulated so far
+ *
+ * \retval status Returns \ref LORAMAC_HANDLER_SUCCESS if the package is
+ *                initialized else \ref LORAMAC_HANDLER_ERROR
+ */
+LmHandlerErrorStatus_t LmhpPerfStatsReportReq( void );
+
+#endif // __LMHP_PERF_STATS_H__
@@ -26,6 +26,7 @@
 
 #if DBG_TRACE == 1
     #include <stdio.h>
+    #include <inttypes.h>
     /*!
      * Works in the same way as the printf function does.
      */
@@ -46,9 +47,25 @@
 #define REMOTE_MCAST_SETUP_ID                       2
 #define REMOTE_MCAST_SETUP_VERSION                  1
 
+/*!
+ * Minimum time ahead of a class C session start at which the radio is woken
+ * up with the multicast reception settings [ms]
+ */
+#ifndef REMOTE_MCAST_SETUP_SESSION_LEAD_TIME
+#define REMOTE_MCAST_SETUP_SESSION_LEAD_TIME        50
+#endif
+
+/*!
+ * Margin added to the measured preparation latency [ms]
+ */
+#ifndef REMOTE_MCAST_SETUP_SESSION_LEAD_MARGIN
+#define REMOTE_MCAST_SETUP_SESSION_LEAD_MARGIN      20
+#endif
+
 typedef enum LmhpRemoteMcastSetupSessionStates_e
 {
     REMOTE_MCAST_SETUP_SESSION_STATE_IDLE,
+    REMOTE_MCAST_SETUP_SESSION_STATE_PREPARE,
     REMOTE_MCAST_SETUP_SESSION_STATE_START,
     REMOTE_MCAST_SETUP_SESSION_STATE_STOP,
 }LmhpRemoteMcastSetupSessionStates_t;
@@ -115,6 +132,14 @@ static bool LmhpRemoteMcastSetupIsRunning( void );
  */
 static void LmhpRemoteMcastSetupProcess( void );
 
+/*!
+ * Returns the time until the package Process function must be called.
+ *
+ * \retval deadline 0 when work is pending, the time in ms until the next
+ *                  deadline or \ref LMH_PACKAGE_NO_DEADLINE when idle
+ */
+static TimerTime_t LmhpRemoteMcastSetupGetNextDeadline( void );
+
 /*!
  * Processes the MCPS Indication
  *
@@ -126,6 +151,16 @@ static void OnSessionStartTimer( void *context );
 
 static void OnSessionStopTimer( void *context );
 
+/*!
+ * Sets up the multicast groups of consecutive McGroupSetupReq commands in one
+ * batch and fills in their McGroupSetupAns status.
+ *
+ * \param [IN] channels   Multicast channels to set up
+ * \param [IN] ansIndexes Data buffer indexes of the McGroupSetupAns status
+ * \param [IN] nbChannels Number of multicast channels
+ */
+static void McGroupsSetup( McChannelParams_t *channels, uint8_t *ansIndexes, uint8_t nbChannels );
+
 static LmhpRemoteMcastSetupState_t LmhpRemoteMcastSetupState =
 {
     .Initialized = false,
@@ -165,7 +200,7 @@ typedef struct McSessionData_s
     McRxParams_t RxParams;
 }McSessionData_t;
 
-McSessionData_t McSessionData[LORAMAC_MAX_MC_CTX];
+McSessionData_t McSessionData[4]; // Indexed by the 2 bits McGroupID
 
 /*!
  * Session start timer
@@ -177,6 +212,28 @@ static TimerEvent_t SessionStartTimer;
  */
 static TimerEvent_t SessionStopTimer;
 
+/*!
+ * Set while SessionStartTimer runs to the session preparation instant
+ */
+static bool SessionPreparePending = false;
+
+/*!
+ * Session start instant, in the TimerGetCurrentTime time base
+ */
+static TimerTime_t SessionStartTime;
+
+/*!
+ * Time ahead of the session start at which it is prepared. Calibrated by the
+ * latency measured at each preparation.
+ */
+static TimerTime_t SessionLeadTime = REMOTE_MCAST_SETUP_SESSION_LEAD_TIME;
+
+/*!
+ * Starts SessionStartTimer for the session start, or for its preparation
+ * when the start is far enough
+ */
+static void SessionStartTimerArm( void );
+
 static LmhPackage_t LmhpRemoteMcastSetupPackage =
 {
     .Port = REMOTE_MCAST_SETUP_PORT,
@@ -184,6 +241,7 @@ static LmhPackage_t LmhpRemoteMcastSetupPackage =
     .IsInitialized = LmhpRemoteMcastSetupIsInitialized,
     .IsRunning = LmhpRemoteMcastSetupIsRunning,
     .Process = LmhpRemoteMcastSetupProcess,
+    .GetNextDeadline = LmhpRemoteMcastSetupGetNextDeadline,
     .OnMcpsConfirmProcess = NULL,                              // Not used in this package
     .OnMcpsIndicationProcess = LmhpRemoteMcastSetupOnMcpsIndication,
     .OnMlmeConfirmProcess = NULL,                              // Not used in this package
@@ -245,6 +303,21 @@ static void LmhpRemoteMcastSetupProcess( void )
 
     switch( state )
     {
+        case REMOTE_MCAST_SETUP_SESSION_STATE_PREPARE:
+        {
+            TimerTime_t prepareTime = SessionStartTime - SessionLeadTime;
+
+            // Wake the radio up with the multicast settings, the class C
+            // switch then only starts the reception. When the MAC is busy
+            // the switch is done in full.
+            LoRaMacClassCPrepare( );
+
+            // Timer and main loop latency plus the radio wake up
+            SessionLeadTime = MAX( REMOTE_MCAST_SETUP_SESSION_LEAD_TIME,
+                                   TimerGetElapsedTime( prepareTime ) + REMOTE_MCAST_SETUP_SESSION_LEAD_MARGIN );
+            SessionStartTimerArm( );
+            break;
+        }
         case REMOTE_MCAST_SETUP_SESSION_STATE_START:
             // Switch to Class C
             LmHandlerRequestClass( CLASS_C );
@@ -264,13 +337,49 @@ static void LmhpRemoteMcastSetupProcess( void )
     }
 }
 
+static TimerTime_t LmhpRemoteMcastSetupGetNextDeadline( void )
+{
+    if( LmhpRemoteMcastSetupState.SessionState != REMOTE_MCAST_SETUP_SESSION_STATE_IDLE )
+    {
+        return 0;
+    }
+    return LMH_PACKAGE_NO_DEADLINE;
+}
+
+static void McGroupsSetup( McChannelParams_t *channels, uint8_t *ansIndexes, uint8_t nbChannels )
+{
+    bool batchDone = LoRaMacMcChannelsSetup( channels, nbChannels ) == LORAMAC_STATUS_OK;
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        uint8_t idError = 0x01; // One bit value
+        // Set up the groups one by one to report the failing ones
+        if( ( batchDone == true ) || ( LoRaMacMcChannelSetup( &channels[i] ) == LORAMAC_STATUS_OK ) )
+        {
+            idError = 0x00;
+        }
+        LmhpRemoteMcastSetupState.DataBuffer[ansIndexes[i]] = ( idError << 2 ) | channels[i].GroupID;
+    }
+}
+
 static void LmhpRemoteMcastSetupOnMcpsIndication( McpsIndication_t *mcpsIndication )
 {
     uint8_t cmdIndex = 0;
     uint8_t dataBufferIndex = 0;
+    McChannelParams_t mcChannels[LORAMAC_MAX_MC_CTX];
+    uint8_t mcChannelsAnsIndexes[LORAMAC_MAX_MC_CTX];
+    uint8_t nbMcChannels = 0;
 
     while( cmdIndex < mcpsIndication->BufferSize )
     {
+        if( ( nbMcChannels > 0 ) &&
+            ( ( mcpsIndication->Buffer[cmdIndex] != REMOTE_MCAST_SETUP_MC_GROUP_SETUP_REQ ) || ( nbMcChannels == LORAMAC_MAX_MC_CTX ) ) )
+        {
+            // The following commands may use the pending groups
+            McGroupsSetup( mcChannels, mcChannelsAnsIndexes, nbMcChannels );
+            nbMcChannels = 0;
+        }
+
         switch( mcpsIndication->Buffer[cmdIndex++] )
         {
             case REMOTE_MCAST_SETUP_PKG_VERSION_REQ:
@@ -287,7 +396,7 @@ static void LmhpRemoteMcastSetupOnMcpsIndication( McpsIndication_t *mcpsIndicati
             }
             case REMOTE_MCAST_SETUP_MC_GROUP_SETUP_REQ:
             {
-                uint8_t id = mcpsIndication->Buffer[cmdIndex++];
+                uint8_t id = mcpsIndication->Buffer[cmdIndex++] & 0x03;
                 McSessionData[id].McGroupData.IdHeader.Value = id;
 
                 McSessionData[id].McGroupData.McAddr =  ( mcpsIndication->Buffer[cmdIndex++] << 0  ) & 0x000000FF;
@@ -326,13 +435,10 @@ static void LmhpRemoteMcastSetupOnMcpsIndication( McpsIndication_t *mcpsIndicati
                         .Datarate = 0
                     }
                 };
-                uint8_t idError = 0x01; // One bit value
-                if( LoRaMacMcChannelSetup( &channel ) == LORAMAC_STATUS_OK )
-                {
-                    idError = 0x00;
-                }
+                // Set up with the following McGroupSetupReq commands
+                mcChannels[nbMcChannels] = channel;
                 LmhpRemoteMcastSetupState.DataBuffer[dataBufferIndex++] = REMOTE_MCAST_SETUP_MC_GROUP_SETUP_ANS;
-                LmhpRemoteMcastSetupState.DataBuffer[dataBufferIndex++] = ( idError << 2 ) | McSessionData[id].McGroupData.IdHeader.Fields.McGroupId;
+                mcChannelsAnsIndexes[nbMcChannels++] = dataBufferIndex++;
                 break;
             }
             case REMOTE_MCAST_SETUP_MC_GROUP_DELETE_REQ:
@@ -382,11 +488,13 @@ static void LmhpRemoteMcastSetupOnMcpsIndication( McpsIndication_t *mcpsIndicati
                     int32_t timeToSessionStart = McSessionData[id].SessionTime - curTime.Seconds;
                     if( timeToSessionStart > 0 )
                     {
-                        // Start session start timer
-                        TimerSetValue( &SessionStartTimer, timeToSessionStart * 1000 );
-                        TimerStart( &SessionStartTimer );
+                        // Start session start timer, the sub-second part of
+                        // the device time included
+                        SessionStartTime = TimerGetCurrentTime( ) + ( ( TimerTime_t )timeToSessionStart * 1000 ) - curTime.SubSeconds;
+                        SessionPreparePending = true;
+                        SessionStartTimerArm( );
 
-                        DBG( "Time2SessionStart: %ld ms\r\n", timeToSessionStart * 1000 );
+                        DBG( "Time2SessionStart: %" PRId32 " ms\r\n", timeToSessionStart * 1000 );
 
                         LmhpRemoteMcastSetupState.DataBuffer[dataBufferIndex++] = status;
                         LmhpRemoteMcastSetupState.DataBuffer[dataBufferIndex++] = ( timeToSessionStart >> 0  ) & 0xFF;
@@ -415,6 +523,11 @@ static void LmhpRemoteMcastSetupOnMcpsIndication( McpsIndication_t *mcpsIndicati
         }
     }
 
+    if( nbMcChannels > 0 )
+    {
+        McGroupsSetup( mcChannels, mcChannelsAnsIndexes, nbMcChannels );
+    }
+
     if( dataBufferIndex != 0 )
     {
         // Answer commands
@@ -427,28 +540,53 @@ static void LmhpRemoteMcastSetupOnMcpsIndication( McpsIndication_t *mcpsIndicati
         LmhpRemoteMcastSetupPackage.OnSendRequest( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
 
         DBG( "ID          : %d\r\n", McSessionData[0].McGroupData.IdHeader.Fields.McGroupId );
-        DBG( "McAddr      : %08lX\r\n", McSessionData[0].McGroupData.McAddr );
+        DBG( "McAddr      : %08" PRIX32 "\r\n", McSessionData[0].McGroupData.McAddr );
         DBG( "McKey       : %02X", McSessionData[0].McGroupData.McKeyEncrypted[0] );
         for( int i = 1; i < 16; i++ )
         {
             DBG( "-%02X",  McSessionData[0].McGroupData.McKeyEncrypted[i] );
         }
         DBG( "\r\n" );
-        DBG( "McFCountMin : %lu\r\n",  McSessionData[0].McGroupData.McFCountMin );
-        DBG( "McFCountMax : %lu\r\n",  McSessionData[0].McGroupData.McFCountMax );
-        DBG( "SessionTime : %lu\r\n",  McSessionData[0].SessionTime );
+        DBG( "McFCountMin : %" PRIu32 "\r\n",  McSessionData[0].McGroupData.McFCountMin );
+        DBG( "McFCountMax : %" PRIu32 "\r\n",  McSessionData[0].McGroupData.McFCountMax );
+        DBG( "SessionTime : %" PRIu32 "\r\n",  McSessionData[0].SessionTime );
         DBG( "SessionTimeT: %d\r\n",  McSessionData[0].SessionTimeout );
-        DBG( "Rx Freq     : %lu\r\n", McSessionData[0].RxParams.ClassC.Frequency );
+        DBG( "Rx Freq     : %" PRIu32 "\r\n", McSessionData[0].RxParams.ClassC.Frequency );
         DBG( "Rx DR       : DR_%d\r\n", McSessionData[0].RxParams.ClassC.Datarate );
 
     }
 }
 
+static void SessionStartTimerArm( void )
+{
+    int32_t timeToStart = ( int32_t )( SessionStartTime - TimerGetCurrentTime( ) );
+
+    TimerStop( &SessionStartTimer );
+    if( ( SessionPreparePending == true ) && ( timeToStart > ( int32_t )SessionLeadTime ) )
+    {
+        TimerSetValue( &SessionStartTimer, timeToStart - SessionLeadTime );
+    }
+    else
+    {
+        SessionPreparePending = false;
+        TimerSetValue( &SessionStartTimer, MAX( timeToStart, 1 ) );
+    }
+    TimerStart( &SessionStartTimer );
+}
+
 static void OnSessionStartTimer( void *context )
 {
     TimerStop( &SessionStartTimer );
 
-    LmhpRemoteMcastSetupState.SessionState = REMOTE_MCAST_SETUP_SESSION_STATE_START;
+    if( SessionPreparePending == true )
+    {
+        SessionPreparePending = false;
+        LmhpRemoteMcastSetupState.SessionState = REMOTE_MCAST_SETUP_SESSION_STATE_PREPARE;
+    }
+    else
+    {
+        LmhpRemoteMcastSetupState.SessionState = REMOTE_MCAST_SETUP_SESSION_STATE_START;
+    }
 }
 
 static void OnSessionStopTimer( void *context )
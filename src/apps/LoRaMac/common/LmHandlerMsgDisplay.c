@@ -21,10 +21,13 @@
  */
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include "utilities.h"
 #include "timer.h"
+#include "energy.h"
+#include "log.h"
 
 #include "LmHandlerMsgDisplay.h"
 
@@ -97,53 +100,53 @@ void PrintHexBuffer( uint8_t *buffer, uint8_t size )
     {
         if( newline != 0 )
         {
-            printf( "\r\n" );
+            LOG_INFO( "\r\n" );
             newline = 0;
         }
 
-        printf( "%02X ", buffer[i] );
+        LOG_INFO( "%02X ", buffer[i] );
 
         if( ( ( i + 1 ) % 16 ) == 0 )
         {
             newline = 1;
         }
     }
-    printf( "\r\n" );
+    LOG_INFO( "\r\n" );
 }
 
 void DisplayNvmContextChange( LmHandlerNvmContextStates_t state )
 {
     if( state == LORAMAC_HANDLER_NVM_STORE )
     {
-        printf( "\r\n###### ============ CTXS STORED ============ ######\r\n\r\n" );
+        LOG_INFO( "\r\n###### ============ CTXS STORED ============ ######\r\n\r\n" );
     }
     else
     {
-        printf( "\r\n###### =========== CTXS RESTORED =========== ######\r\n\r\n" );
+        LOG_INFO( "\r\n###### =========== CTXS RESTORED =========== ######\r\n\r\n" );
     }
 }
 
 void DisplayNetworkParametersUpdate( CommissioningParams_t *commissioningParams )
 {
-    printf( "DevEui      : %02X", commissioningParams->DevEui[0] );
+    LOG_INFO( "DevEui      : %02X", commissioningParams->DevEui[0] );
     for( int i = 1; i < 8; i++ )
     {
-        printf( "-%02X", commissioningParams->DevEui[i] );
+        LOG_INFO( "-%02X", commissioningParams->DevEui[i] );
     }
-    printf( "\r\n" );
-    printf( "AppEui      : %02X", commissioningParams->JoinEui[0] );
+    LOG_INFO( "\r\n" );
+    LOG_INFO( "AppEui      : %02X", commissioningParams->JoinEui[0] );
     for( int i = 1; i < 8; i++ )
     {
-        printf( "-%02X", commissioningParams->JoinEui[i] );
+        LOG_INFO( "-%02X", commissioningParams->JoinEui[i] );
     }
-    printf( "\r\n" );
+    LOG_INFO( "\r\n" );
     // For 1.0.x devices the AppKey corresponds to NwkKey
-    printf( "AppKey      : %02X", commissioningParams->NwkKey[0] );
+    LOG_INFO( "AppKey      : %02X", commissioningParams->NwkKey[0] );
     for( int i = 1; i < 16; i++ )
     {
-        printf( " %02X", commissioningParams->NwkKey[i] );
+        LOG_INFO( " %02X", commissioningParams->NwkKey[i] );
     }
-    printf( "\n\r\n" );
+    LOG_INFO( "\n\r\n" );
 }
 
 void DisplayMacMcpsRequestUpdate( LoRaMacStatus_t status, McpsReq_t *mcpsReq, TimerTime_t nextTxIn )
@@ -152,37 +155,37 @@ void DisplayMacMcpsRequestUpdate( LoRaMacStatus_t status, McpsReq_t *mcpsReq, Ti
     {
         case MCPS_CONFIRMED:
         {
-            printf( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
-            printf( "######            MCPS_CONFIRMED             ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
+            LOG_INFO( "######            MCPS_CONFIRMED             ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         case MCPS_UNCONFIRMED:
         {
-            printf( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
-            printf( "######           MCPS_UNCONFIRMED            ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
+            LOG_INFO( "######           MCPS_UNCONFIRMED            ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         case MCPS_PROPRIETARY:
         {
-            printf( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
-            printf( "######           MCPS_PROPRIETARY            ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
+            LOG_INFO( "######           MCPS_PROPRIETARY            ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         default:
         {
-            printf( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
-            printf( "######                MCPS_ERROR             ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MCPS-Request ============ ######\r\n" );
+            LOG_INFO( "######                MCPS_ERROR             ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
     }
-    printf( "STATUS      : %s\r\n", MacStatusStrings[status] );
+    LOG_INFO( "STATUS      : %s\r\n", MacStatusStrings[status] );
     if( status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED )
     {
-        printf( "Next Tx in  : ~%lu second(s)\r\n", ( nextTxIn / 1000 ) );
+        LOG_INFO( "Next Tx in  : ~%" PRIu32 " second(s)\r\n", ( nextTxIn / 1000 ) );
     }
 }
 
@@ -192,51 +195,51 @@ void DisplayMacMlmeRequestUpdate( LoRaMacStatus_t status, MlmeReq_t *mlmeReq, Ti
     {
         case MLME_JOIN:
         {
-            printf( "\r\n###### =========== MLME-Request ============ ######\r\n" );
-            printf( "######               MLME_JOIN               ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MLME-Request ============ ######\r\n" );
+            LOG_INFO( "######               MLME_JOIN               ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         case MLME_LINK_CHECK:
         {
-            printf( "\r\n###### =========== MLME-Request ============ ######\r\n" );
-            printf( "######            MLME_LINK_CHECK            ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MLME-Request ============ ######\r\n" );
+            LOG_INFO( "######            MLME_LINK_CHECK            ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         case MLME_DEVICE_TIME:
         {
-            printf( "\r\n###### =========== MLME-Request ============ ######\r\n" );
-            printf( "######            MLME_DEVICE_TIME           ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MLME-Request ============ ######\r\n" );
+            LOG_INFO( "######            MLME_DEVICE_TIME           ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         case MLME_TXCW:
         {
-            printf( "\r\n###### =========== MLME-Request ============ ######\r\n" );
-            printf( "######               MLME_TXCW               ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MLME-Request ============ ######\r\n" );
+            LOG_INFO( "######               MLME_TXCW               ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         case MLME_TXCW_1:
         {
-            printf( "\r\n###### =========== MLME-Request ============ ######\r\n" );
-            printf( "######               MLME_TXCW_1             ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MLME-Request ============ ######\r\n" );
+            LOG_INFO( "######               MLME_TXCW_1             ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
         default:
         {
-            printf( "\r\n###### =========== MLME-Request ============ ######\r\n" );
-            printf( "######              MLME_UNKNOWN             ######\r\n");
-            printf( "###### ===================================== ######\r\n");
+            LOG_INFO( "\r\n###### =========== MLME-Request ============ ######\r\n" );
+            LOG_INFO( "######              MLME_UNKNOWN             ######\r\n");
+            LOG_INFO( "###### ===================================== ######\r\n");
             break;
         }
     }
-    printf( "STATUS      : %s\r\n", MacStatusStrings[status] );
+    LOG_INFO( "STATUS      : %s\r\n", MacStatusStrings[status] );
     if( status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED )
     {
-        printf( "Next Tx in  : ~%lu second(s)\r\n", ( nextTxIn / 1000 ) );
+        LOG_INFO( "Next Tx in  : ~%" PRIu32 " second(s)\r\n", ( nextTxIn / 1000 ) );
     }
 }
 
@@ -246,31 +249,31 @@ void DisplayJoinRequestUpdate( LmHandlerJoinParams_t *params )
     {
         if( params->Status == LORAMAC_HANDLER_SUCCESS )
         {
-            printf( "###### ===========   JOINED     ============ ######\r\n" );
-            printf( "\r\nOTAA\r\n\r\n" );
-            printf( "DevAddr     :  %08lX\r\n", params->CommissioningParams->DevAddr );
-            printf( "\r\n\r\n" );
-            printf( "DATA RATE   : DR_%d\r\n\r\n", params->Datarate );
+            LOG_INFO( "###### ===========   JOINED     ============ ######\r\n" );
+            LOG_INFO( "\r\nOTAA\r\n\r\n" );
+            LOG_INFO( "DevAddr     :  %08" PRIX32 "\r\n", params->CommissioningParams->DevAddr );
+            LOG_INFO( "\r\n\r\n" );
+            LOG_INFO( "DATA RATE   : DR_%d\r\n\r\n", params->Datarate );
         }
     }
 #if ( OVER_THE_AIR_ACTIVATION == 0 )
     else
     {
-        printf( "###### ===========   JOINED     ============ ######\r\n" );
-        printf( "\r\nABP\r\n\r\n" );
-        printf( "DevAddr     : %08lX\r\n", params->CommissioningParams->DevAddr );
-        printf( "NwkSKey     : %02X", params->CommissioningParams->FNwkSIntKey[0] );
+        LOG_INFO( "###### ===========   JOINED     ============ ######\r\n" );
+        LOG_INFO( "\r\nABP\r\n\r\n" );
+        LOG_INFO( "DevAddr     : %08" PRIX32 "\r\n", params->CommissioningParams->DevAddr );
+        LOG_INFO( "NwkSKey     : %02X", params->CommissioningParams->FNwkSIntKey[0] );
         for( int i = 1; i < 16; i++ )
         {
-            printf( " %02X", params->CommissioningParams->FNwkSIntKey[i] );
+            LOG_INFO( " %02X", params->CommissioningParams->FNwkSIntKey[i] );
         }
-        printf( "\r\n" );
-        printf( "AppSKey     : %02X", params->CommissioningParams->AppSKey[0] );
+        LOG_INFO( "\r\n" );
+        LOG_INFO( "AppSKey     : %02X", params->CommissioningParams->AppSKey[0] );
         for( int i = 1; i < 16; i++ )
         {
-            printf( " %02X", params->CommissioningParams->AppSKey[i] );
+            LOG_INFO( " %02X", params->CommissioningParams->AppSKey[i] );
         }
-        printf( "\n\r\n" );
+        LOG_INFO( "\n\r\n" );
     }
 #endif
 }
@@ -281,50 +284,56 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
 
     if( params->IsMcpsConfirm == 0 )
     {
-        printf( "\r\n###### =========== MLME-Confirm ============ ######\r\n" );
-        printf( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
+        LOG_INFO( "\r\n###### =========== MLME-Confirm ============ ######\r\n" );
+        LOG_INFO( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
         return;
     }
 
-    printf( "\r\n###### =========== MCPS-Confirm ============ ######\r\n" );
-    printf( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
+    LOG_INFO( "\r\n###### =========== MCPS-Confirm ============ ######\r\n" );
+    LOG_INFO( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
 
-    printf( "\r\n###### =====   UPLINK FRAME %8lu   ===== ######\r\n", params->UplinkCounter );
-    printf( "\r\n" );
+    LOG_INFO( "\r\n###### =====   UPLINK FRAME %8" PRIu32 "   ===== ######\r\n", params->UplinkCounter );
+    LOG_INFO( "\r\n" );
 
-    printf( "CLASS       : %c\r\n", "ABC"[LmHandlerGetCurrentClass( )] );
-    printf( "\r\n" );
-    printf( "TX PORT     : %d\r\n", params->AppData.Port );
+    LOG_INFO( "CLASS       : %c\r\n", "ABC"[LmHandlerGetCurrentClass( )] );
+    LOG_INFO( "\r\n" );
+    LOG_INFO( "TX PORT     : %d\r\n", params->AppData.Port );
 
     if( params->AppData.BufferSize != 0 )
     {
-        printf( "TX DATA     : " );
+        LOG_INFO( "TX DATA     : " );
         if( params->MsgType == LORAMAC_HANDLER_CONFIRMED_MSG )
         {
-            printf( "CONFIRMED - %s\r\n", ( params->AckReceived != 0 ) ? "ACK" : "NACK" );
+            LOG_INFO( "CONFIRMED - %s\r\n", ( params->AckReceived != 0 ) ? "ACK" : "NACK" );
         }
         else
         {
-            printf( "UNCONFIRMED\r\n" );
+            LOG_INFO( "UNCONFIRMED\r\n" );
         }
         PrintHexBuffer( params->AppData.Buffer, params->AppData.BufferSize );
     }
 
-    printf( "\r\n" );
-    printf( "DATA RATE   : DR_%d\r\n", params->Datarate );
+    LOG_INFO( "\r\n" );
+    LOG_INFO( "DATA RATE   : DR_%d\r\n", params->Datarate );
 
     mibGet.Type  = MIB_CHANNELS;
     if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
     {
-        printf( "U/L FREQ    : %lu\r\n", mibGet.Param.ChannelList[params->Channel].Frequency );
+        LOG_INFO( "U/L FREQ    : %" PRIu32 "\r\n", mibGet.Param.ChannelList[params->Channel].Frequency );
     }
 
-    printf( "TX POWER    : %d\r\n", params->TxPower );
+    LOG_INFO( "TX POWER    : %d\r\n", params->TxPower );
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+    EnergyStats_t stats;
+
+    EnergyGetStats( &stats );
+    LOG_INFO( "CHARGE      : %lu uC, %lu uAh/day\r\n", params->ChargeUc, stats.DailyChargeUah );
+#endif
 
     mibGet.Type  = MIB_CHANNELS_MASK;
     if( LoRaMacMibGetRequestConfirm( &mibGet ) == LORAMAC_STATUS_OK )
     {
-        printf("CHANNEL MASK: ");
+        LOG_INFO("CHANNEL MASK: ");
         switch( LmHandlerGetActiveRegion( ) )
         {
             case LORAMAC_REGION_AS923:
@@ -335,7 +344,7 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
             case LORAMAC_REGION_EU433:
             case LORAMAC_REGION_RU864:
             {
-                printf( "%04X ", mibGet.Param.ChannelsMask[0] );
+                LOG_INFO( "%04X ", mibGet.Param.ChannelsMask[0] );
                 break;
             }
             case LORAMAC_REGION_AU915:
@@ -344,20 +353,20 @@ void DisplayTxUpdate( LmHandlerTxParams_t *params )
             {
                 for( uint8_t i = 0; i < 5; i++)
                 {
-                    printf( "%04X ", mibGet.Param.ChannelsMask[i] );
+                    LOG_INFO( "%04X ", mibGet.Param.ChannelsMask[i] );
                 }
                 break;
             }
             default:
             {
-                printf( "\r\n###### ========= Unknown Region ============ ######" );
+                LOG_INFO( "\r\n###### ========= Unknown Region ============ ######" );
                 break;
             }
         }
-        printf("\r\n");
+        LOG_INFO("\r\n");
     }
 
-    printf( "\r\n" );
+    LOG_INFO( "\r\n" );
 }
 
 void DisplayRxUpdate( LmHandlerAppData_t *appData, LmHandlerRxParams_t *params )
@@ -366,32 +375,32 @@ void DisplayRxUpdate( LmHandlerAppData_t *appData, LmHandlerRxParams_t *params )
 
     if( params->IsMcpsIndication == 0 )
     {
-        printf( "\r\n###### ========== MLME-Indication ========== ######\r\n" );
-        printf( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
+        LOG_INFO( "\r\n###### ========== MLME-Indication ========== ######\r\n" );
+        LOG_INFO( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
         return;
     }
 
-    printf( "\r\n###### ========== MCPS-Indication ========== ######\r\n" );
-    printf( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
+    LOG_INFO( "\r\n###### ========== MCPS-Indication ========== ######\r\n" );
+    LOG_INFO( "STATUS      : %s\r\n", EventInfoStatusStrings[params->Status] );
 
-    printf( "\r\n###### =====  DOWNLINK FRAME %8lu  ===== ######\r\n", params->DownlinkCounter );
+    LOG_INFO( "\r\n###### =====  DOWNLINK FRAME %8" PRIu32 "  ===== ######\r\n", params->DownlinkCounter );
 
-    printf( "RX WINDOW   : %s\r\n", slotStrings[params->RxSlot] );
+    LOG_INFO( "RX WINDOW   : %s\r\n", slotStrings[params->RxSlot] );
     
-    printf( "RX PORT     : %d\r\n", appData->Port );
+    LOG_INFO( "RX PORT     : %d\r\n", appData->Port );
 
     if( appData->BufferSize != 0 )
     {
-        printf( "RX DATA     : \r\n" );
+        LOG_INFO( "RX DATA     : \r\n" );
         PrintHexBuffer( appData->Buffer, appData->BufferSize );
     }
 
-    printf( "\r\n" );
-    printf( "DATA RATE   : DR_%d\r\n", params->Datarate );
-    printf( "RX RSSI     : %d\r\n", params->Rssi );
-    printf( "RX SNR      : %d\r\n", params->Snr );
+    LOG_INFO( "\r\n" );
+    LOG_INFO( "DATA RATE   : DR_%d\r\n", params->Datarate );
+    LOG_INFO( "RX RSSI     : %d\r\n", params->Rssi );
+    LOG_INFO( "RX SNR      : %d\r\n", params->Snr );
 
-    printf( "\r\n" );
+    LOG_INFO( "\r\n" );
 }
 
 void DisplayBeaconUpdate( LoRaMAcHandlerBeaconParams_t *params )
@@ -401,31 +410,31 @@ void DisplayBeaconUpdate( LoRaMAcHandlerBeaconParams_t *params )
         default:
         case LORAMAC_HANDLER_BEACON_ACQUIRING:
         {
-            printf( "\r\n###### ========= BEACON ACQUIRING ========== ######\r\n" );
+            LOG_INFO( "\r\n###### ========= BEACON ACQUIRING ========== ######\r\n" );
             break;
         }
         case LORAMAC_HANDLER_BEACON_LOST:
         {
-            printf( "\r\n###### ============ BEACON LOST ============ ######\r\n" );
+            LOG_INFO( "\r\n###### ============ BEACON LOST ============ ######\r\n" );
             break;
         }
         case LORAMAC_HANDLER_BEACON_RX:
         {
-            printf( "\r\n###### ===== BEACON %8lu ==== ######\r\n", params->Info.Time.Seconds );
-            printf( "GW DESC     : %d\r\n", params->Info.GwSpecific.InfoDesc );
-            printf( "GW INFO     : " );
+            LOG_INFO( "\r\n###### ===== BEACON %8" PRIu32 " ==== ######\r\n", params->Info.Time.Seconds );
+            LOG_INFO( "GW DESC     : %d\r\n", params->Info.GwSpecific.InfoDesc );
+            LOG_INFO( "GW INFO     : " );
             PrintHexBuffer( params->Info.GwSpecific.Info, 6 );
-            printf( "\r\n" );
-            printf( "FREQ        : %lu\r\n", params->Info.Frequency );
-            printf( "DATA RATE   : DR_%d\r\n", params->Info.Datarate );
-            printf( "RX RSSI     : %d\r\n", params->Info.Rssi );
-            printf( "RX SNR      : %d\r\n", params->Info.Snr );
-            printf( "\r\n" );
+            LOG_INFO( "\r\n" );
+            LOG_INFO( "FREQ        : %" PRIu32 "\r\n", params->Info.Frequency );
+            LOG_INFO( "DATA RATE   : DR_%d\r\n", params->Info.Datarate );
+            LOG_INFO( "RX RSSI     : %d\r\n", params->Info.Rssi );
+            LOG_INFO( "RX SNR      : %d\r\n", params->Info.Snr );
+            LOG_INFO( "\r\n" );
             break;
         }
         case LORAMAC_HANDLER_BEACON_NRX:
         {
-            printf( "\r\n###### ======== BEACON NOT RECEIVED ======== ######\r\n" );
+            LOG_INFO( "\r\n###### ======== BEACON NOT RECEIVED ======== ######\r\n" );
             break;
         }
     }
@@ -433,14 +442,14 @@ void DisplayBeaconUpdate( LoRaMAcHandlerBeaconParams_t *params )
 
 void DisplayClassUpdate( DeviceClass_t deviceClass )
 {
-    printf( "\r\n\r\n###### ===== Switch to Class %c done.  ===== ######\r\n\r\n", "ABC"[deviceClass] );
+    LOG_INFO( "\r\n\r\n###### ===== Switch to Class %c done.  ===== ######\r\n\r\n", "ABC"[deviceClass] );
 }
 
 void DisplayAppInfo( const char* appName, const Version_t* appVersion, const Version_t* gitHubVersion )
 {
-    printf( "\r\n###### ===================================== ######\r\n\r\n" );
-    printf( "Application name   : %s\r\n", appName );
-    printf( "Application version: %d.%d.%d\r\n", appVersion->Fields.Major, appVersion->Fields.Minor, appVersion->Fields.Revision );
-    printf( "GitHub base version: %d.%d.%d\r\n", gitHubVersion->Fields.Major, gitHubVersion->Fields.Minor, gitHubVersion->Fields.Revision );
-    printf( "\r\n###### ===================================== ######\r\n\r\n" );
+    LOG_INFO( "\r\n###### ===================================== ######\r\n\r\n" );
+    LOG_INFO( "Application name   : %s\r\n", appName );
+    LOG_INFO( "Application version: %d.%d.%d\r\n", appVersion->Fields.Major, appVersion->Fields.Minor, appVersion->Fields.Revision );
+    LOG_INFO( "GitHub base version: %d.%d.%d\r\n", gitHubVersion->Fields.Major, gitHubVersion->Fields.Minor, gitHubVersion->Fields.Revision );
+    LOG_INFO( "\r\n###### ===================================== ######\r\n\r\n" );
 }
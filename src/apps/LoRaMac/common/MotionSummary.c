@@ -0,0 +1,117 @@
+/*!
+ * \file      MotionSummary.c
+ *
+ * \brief     Implements a compact summary of accelerometer sample batches
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "utilities.h"
+#include "MotionSummary.h"
+
+/*!
+ * Accumulated batches state
+ */
+typedef struct sMotionSummaryState
+{
+    uint32_t Count;
+    int32_t Sum[3];
+    int16_t Min[3];
+    int16_t Max[3];
+    int16_t Last[3];
+    uint32_t Activity;
+}MotionSummaryState_t;
+
+static MotionSummaryState_t Summary;
+
+/*!
+ * \brief Writes a 16 bits value MSB first
+ *
+ * \param [OUT] buffer Destination
+ * \param [IN]  value  Value to write
+ */
+static void MotionSummaryWrite16( uint8_t* buffer, uint16_t value );
+
+void MotionSummaryReset( void )
+{
+    memset1( ( uint8_t* )&Summary, 0, sizeof( Summary ) );
+}
+
+void MotionSummaryAdd( const int16_t* samples, uint16_t count )
+{
+    for( uint16_t i = 0; i < count; i++ )
+    {
+        const int16_t* xyz = samples + 3 * i;
+
+        for( uint8_t axis = 0; axis < 3; axis++ )
+        {
+            if( Summary.Count == 0 )
+            {
+                Summary.Min[axis] = xyz[axis];
+                Summary.Max[axis] = xyz[axis];
+            }
+            else
+            {
+                int32_t delta = ( int32_t )xyz[axis] - Summary.Last[axis];
+
+                Summary.Activity += ( delta < 0 ) ? -delta : delta;
+                Summary.Min[axis] = MIN( Summary.Min[axis], xyz[axis] );
+                Summary.Max[axis] = MAX( Summary.Max[axis], xyz[axis] );
+            }
+            Summary.Sum[axis] += xyz[axis];
+            Summary.Last[axis] = xyz[axis];
+        }
+        Summary.Count++;
+    }
+}
+
+uint16_t MotionSummaryGetCount( void )
+{
+    return ( uint16_t )MIN( Summary.Count, 0xFFFF );
+}
+
+uint8_t MotionSummaryBuild( uint8_t* buffer, uint8_t size )
+{
+    uint32_t activity = 0;
+
+    if( ( size < MOTION_SUMMARY_RECORD_SIZE ) || ( Summary.Count == 0 ) )
+    {
+        return 0;
+    }
+
+    MotionSummaryWrite16( buffer, MotionSummaryGetCount( ) );
+    for( uint8_t axis = 0; axis < 3; axis++ )
+    {
+        uint32_t range = ( ( uint32_t )( ( int32_t )Summary.Max[axis] - Summary.Min[axis] ) ) / 16;
+
+        MotionSummaryWrite16( buffer + 2 + 2 * axis, ( uint16_t )( int16_t )( Summary.Sum[axis] / ( int32_t )Summary.Count ) );
+        buffer[8 + axis] = ( uint8_t )MIN( range, 0xFF );
+    }
+    if( Summary.Count > 1 )
+    {
+        activity = Summary.Activity / ( Summary.Count - 1 );
+    }
+    MotionSummaryWrite16( buffer + 11, ( uint16_t )MIN( activity, 0xFFFF ) );
+
+    MotionSummaryReset( );
+    return MOTION_SUMMARY_RECORD_SIZE;
+}
+
+static void MotionSummaryWrite16( uint8_t* buffer, uint16_t value )
+{
+    buffer[0] = ( uint8_t )( value >> 8 );
+    buffer[1] = ( uint8_t )value;
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file      MotionSummary.h
+ *
+ * \brief     Implements a compact summary of accelerometer sample batches
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \details The samples drained from an accelerometer FIFO are accumulated
+ *          and summarized in a fixed size record, suited to
+ *          LmHandlerAggregate.
+ *
+ *          Record format, MSB first:
+ *
+ *          | Count   | Mean X  | Mean Y  | Mean Z  | Range X | Range Y | Range Z | Activity |
+ *          |:-------:|:-------:|:-------:|:-------:|:-------:|:-------:|:-------:|:--------:|
+ *          | 2 bytes | 2 bytes | 2 bytes | 2 bytes | 1 byte  | 1 byte  | 1 byte  | 2 bytes  |
+ *
+ *          - Count: number of summarized samples
+ *          - Mean: mean acceleration per axis, mg signed
+ *          - Range: maximum minus minimum per axis, 16 mg unsigned
+ *          - Activity: mean of |dX| + |dY| + |dZ| between consecutive
+ *            samples, mg unsigned
+ *
+ *          The values saturate to their field width.
+ */
+#ifndef __MOTION_SUMMARY_H__
+#define __MOTION_SUMMARY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * Size of the summary record
+ */
+#define MOTION_SUMMARY_RECORD_SIZE                  13
+
+/*!
+ * \brief Discards the accumulated samples
+ */
+void MotionSummaryReset( void );
+
+/*!
+ * \brief Accumulates a batch of samples
+ *
+ * \param [IN] samples Samples in mg, X, Y and Z interleaved
+ * \param [IN] count   Number of samples
+ */
+void MotionSummaryAdd( const int16_t* samples, uint16_t count );
+
+/*!
+ * \brief Gets the number of accumulated samples
+ *
+ * \retval count Number of samples
+ */
+uint16_t MotionSummaryGetCount( void );
+
+/*!
+ * \brief Builds the summary record and discards the accumulated samples
+ *
+ * \param [OUT] buffer Record buffer
+ * \param [IN]  size   Record buffer size
+ * \retval size Size of the record, 0 when the buffer is too small or no
+ *              sample was accumulated
+ */
+uint8_t MotionSummaryBuild( uint8_t* buffer, uint8_t size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __MOTION_SUMMARY_H__
@@ -36,12 +36,14 @@
 #include "utilities.h"
 #include "eeprom.h"
 #include "nvmm.h"
+#include "timer.h"
+#include "LoRaMacNvmCodec.h"
 
 /*!
  * Enables/Disables the context storage management storage at all. Must be enabled for LoRaWAN 1.1.x.
  * WARNING: Still under development and not tested yet.
  */
-#define CONTEXT_MANAGEMENT_ENABLED         0
+#define CONTEXT_MANAGEMENT_ENABLED         1
 
 /*!
  * Enables/Disables maximum persistent context storage management. All module contexts will be saved on a non-volatile memory.
@@ -55,6 +57,54 @@
 #define NVM_CTX_STORAGE_MASK               0x8C
 #endif
 
+/*!
+ * Enables/Disables the snapshot storage. The stored contexts are kept back to
+ * back in one image, each image is restored with one read and one checksum.
+ * The images are written alternately into two slots with a generation number,
+ * an interrupted write leaves the previous snapshot in the other slot.
+ */
+#define NVM_CTX_SNAPSHOT_ENABLED           1
+
+/*!
+ * Number of snapshot slots
+ */
+#define NVM_CTX_SNAPSHOT_SLOTS             2
+
+/*!
+ * Number of MAC contexts, in LoRaMacCtxUpdateStatus_t bits order
+ */
+#define NVM_CTX_NB_MODULES                 7
+
+/*!
+ * Contexts stored on the next NvmCtxMgmtStore call. They hold the frame
+ * counters and the keys, deferring them would allow frame counters reuse.
+ */
+#define NVM_CTX_WRITE_THROUGH_MASK         0x0C
+
+/*!
+ * Maximum time in ms the other contexts changes are kept in RAM before being stored.
+ */
+#define NVM_CTX_STORE_DEFER_INTERVAL       60000
+
+/*!
+ * Maximum number of frames the other contexts changes are kept in RAM before being stored.
+ */
+#define NVM_CTX_STORE_DEFER_FRAMES         16
+
+/*!
+ * Size of the buffer holding the stored contexts image. On restore it also
+ * holds the unpacked contexts, which follow the image.
+ *
+ * \remark The store and the restore fail when the contexts do not fit.
+ */
+#ifndef NVM_CTX_BUFFER_SIZE
+#if ( MAX_PERSISTENT_CTX_MGMT_ENABLED == 1 )
+#define NVM_CTX_BUFFER_SIZE                6144
+#else
+#define NVM_CTX_BUFFER_SIZE                1024
+#endif
+#endif
+
 #if ( CONTEXT_MANAGEMENT_ENABLED == 1 )
 /*!
  * LoRaMAC Structure holding contexts changed status
@@ -109,23 +159,56 @@ typedef union uLoRaMacCtxsUpdateInfo
 
 LoRaMacCtxUpdateStatus_t CtxUpdateStatus = { .Value = 0 };
 
+/*!
+ * Time at which the first deferred context change occurred
+ */
+static TimerTime_t DeferStartTime = 0;
+
+/*!
+ * Number of frames since the first deferred context change
+ */
+static uint8_t DeferFrameCnt = 0;
+
+/*!
+ * Contexts image buffer. Statically allocated, the contexts are too large
+ * for the stack of the targeted MCUs.
+ */
+static uint8_t CtxBuffer[NVM_CTX_BUFFER_SIZE];
+
 /*
  * Nvmm handles
  */
-static NvmmDataBlock_t SecureElementNvmCtxDataBlock;
-static NvmmDataBlock_t CryptoNvmCtxDataBlock;
-#if ( MAX_PERSISTENT_CTX_MGMT_ENABLED == 1 )
-static NvmmDataBlock_t MacNvmCtxDataBlock;
-static NvmmDataBlock_t RegionNvmCtxDataBlock;
-static NvmmDataBlock_t CommandsNvmCtxDataBlock;
-static NvmmDataBlock_t ConfirmQueueNvmCtxDataBlock;
-static NvmmDataBlock_t ClassBNvmCtxDataBlock;
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+static NvmmDataBlock_t SnapshotDataBlocks[NVM_CTX_SNAPSHOT_SLOTS];
+
+/*!
+ * Generation number of the most recent snapshot
+ */
+static uint32_t SnapshotGeneration = 0;
+
+/*!
+ * Slot holding the most recent snapshot
+ */
+static uint8_t SnapshotSlot = 0;
+
+/*!
+ * Set when the buffer holds the most recent snapshot image, the next store
+ * then only packs the changed contexts into it
+ */
+static bool SnapshotImageValid = false;
+#else
+/*
+ * Data blocks indexed as the LoRaMacCtxUpdateStatus_t bits
+ */
+static NvmmDataBlock_t CtxDataBlocks[NVM_CTX_NB_MODULES];
 #endif
 #endif
 
 void NvmCtxMgmtEvent( LoRaMacNvmCtxModule_t module )
 {
 #if ( CONTEXT_MANAGEMENT_ENABLED == 1 )
+    bool isDeferredPending = ( CtxUpdateStatus.Value & NVM_CTX_STORAGE_MASK & ~NVM_CTX_WRITE_THROUGH_MASK ) != 0;
+
     switch( module )
     {
         case LORAMAC_NVMCTXMODULE_MAC:
@@ -141,6 +224,11 @@ void NvmCtxMgmtEvent( LoRaMacNvmCtxModule_t module )
         case LORAMAC_NVMCTXMODULE_CRYPTO:
         {
             CtxUpdateStatus.Elements.Crypto = 1;
+            // The frame counters are updated once per frame
+            if( ( isDeferredPending == true ) && ( DeferFrameCnt < 0xFF ) )
+            {
+                DeferFrameCnt++;
+            }
             break;
         }
         case LORAMAC_NVMCTXMODULE_SECURE_ELEMENT:
@@ -168,12 +256,76 @@ void NvmCtxMgmtEvent( LoRaMacNvmCtxModule_t module )
             break;
         }
     }
+
+    if( ( isDeferredPending == false ) &&
+        ( ( CtxUpdateStatus.Value & NVM_CTX_STORAGE_MASK & ~NVM_CTX_WRITE_THROUGH_MASK ) != 0 ) )
+    {
+        DeferStartTime = TimerGetCurrentTime( );
+        DeferFrameCnt = 0;
+    }
 #endif
 }
 
-NvmCtxMgmtStatus_t NvmCtxMgmtStore( void )
-{
 #if ( CONTEXT_MANAGEMENT_ENABLED == 1 )
+/*!
+ * \brief Gets the contexts references, indexed as the LoRaMacCtxUpdateStatus_t
+ *        bits
+ *
+ * \param [IN]  contexts MAC contexts
+ * \param [IN]  modules  Bit mask of the contexts to be accounted
+ * \param [OUT] ctxs     Contexts pointers references
+ * \param [OUT] sizes    Contexts sizes references
+ * \retval size          Sum of the maximum serialized sizes of the accounted
+ *                       contexts, see \ref LoRaMacNvmCtxPack
+ */
+static size_t GetCtxsLayout( LoRaMacCtxs_t* contexts, uint8_t modules, void*** ctxs, size_t** sizes )
+{
+    size_t size = 0;
+
+    ctxs[0] = &contexts->MacNvmCtx;
+    sizes[0] = &contexts->MacNvmCtxSize;
+    ctxs[1] = &contexts->RegionNvmCtx;
+    sizes[1] = &contexts->RegionNvmCtxSize;
+    ctxs[2] = &contexts->CryptoNvmCtx;
+    sizes[2] = &contexts->CryptoNvmCtxSize;
+    ctxs[3] = &contexts->SecureElementNvmCtx;
+    sizes[3] = &contexts->SecureElementNvmCtxSize;
+    ctxs[4] = &contexts->CommandsNvmCtx;
+    sizes[4] = &contexts->CommandsNvmCtxSize;
+    ctxs[5] = &contexts->ClassBNvmCtx;
+    sizes[5] = &contexts->ClassBNvmCtxSize;
+    ctxs[6] = &contexts->ConfirmQueueNvmCtx;
+    sizes[6] = &contexts->ConfirmQueueNvmCtxSize;
+
+    for( uint8_t i = 0; i < NVM_CTX_NB_MODULES; i++ )
+    {
+        if( ( modules & ( 1 << i ) ) != 0 )
+        {
+            size += LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] );
+        }
+    }
+    return size;
+}
+
+/*!
+ * \brief Stores the given contexts if they changed
+ *
+ * \remark The contexts are serialized within a critical section and written
+ *         from the copy, the MAC keeps running meanwhile.
+ *
+ * \param [IN] modules Bit mask of the contexts to be stored, same layout as
+ *                     LoRaMacCtxUpdateStatus_t
+ * \retval status      Status of the operation
+ */
+static NvmCtxMgmtStatus_t NvmCtxMgmtStoreModules( uint8_t modules )
+{
+    uint8_t storeModules = CtxUpdateStatus.Value & modules & NVM_CTX_STORAGE_MASK;
+    NvmCtxMgmtStatus_t status = NVMCTXMGMT_STATUS_SUCCESS;
+    void** ctxs[NVM_CTX_NB_MODULES];
+    size_t* sizes[NVM_CTX_NB_MODULES];
+    uint8_t* image = CtxBuffer;
+    size_t offset = 0;
+
     // Read out the contexts lengths and pointers
     MibRequestConfirm_t mibReq;
     mibReq.Type = MIB_NVM_CTXS;
@@ -181,191 +333,277 @@ NvmCtxMgmtStatus_t NvmCtxMgmtStore( void )
     LoRaMacCtxs_t* MacContexts = mibReq.Param.Contexts;
 
     // Input checks
-    if( ( CtxUpdateStatus.Value & NVM_CTX_STORAGE_MASK ) == 0 )
+    if( storeModules == 0 )
     {
         return NVMCTXMGMT_STATUS_FAIL;
     }
-    if( LoRaMacStop( ) != LORAMAC_STATUS_OK )
+
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    // The image holds the generation number followed by all the stored contexts,
+    // each one at a fixed offset. The unchanged contexts are kept from the
+    // previous snapshot image
+    uint8_t layoutModules = NVM_CTX_STORAGE_MASK;
+    uint8_t copyModules = ( SnapshotImageValid == true ) ? storeModules : NVM_CTX_STORAGE_MASK;
+    size_t imageSize = GetCtxsLayout( MacContexts, layoutModules, ctxs, sizes ) + sizeof( uint32_t );
+    uint32_t generation = SnapshotGeneration + 1;
+    uint8_t slot = SnapshotSlot ^ 1;
+#else
+    uint8_t layoutModules = storeModules;
+    uint8_t copyModules = storeModules;
+    size_t imageSize = GetCtxsLayout( MacContexts, layoutModules, ctxs, sizes );
+#endif
+
+    if( imageSize > NVM_CTX_BUFFER_SIZE )
     {
         return NVMCTXMGMT_STATUS_FAIL;
     }
 
-    // Write
-    if( CtxUpdateStatus.Elements.Crypto == 1 )
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    memcpy1( image, ( uint8_t* ) &generation, sizeof( uint32_t ) );
+    offset = sizeof( uint32_t );
+#endif
+
+    // Copy-on-write, the copy is consistent as the MAC cannot change the
+    // contexts meanwhile. Changes made during the NVM writes are stored next
+    CRITICAL_SECTION_BEGIN( );
+    for( uint8_t i = 0; i < NVM_CTX_NB_MODULES; i++ )
     {
-        if( NvmmWrite( &CryptoNvmCtxDataBlock, MacContexts->CryptoNvmCtx, MacContexts->CryptoNvmCtxSize ) != NVMM_SUCCESS )
+        if( ( layoutModules & ( 1 << i ) ) == 0 )
         {
-            return NVMCTXMGMT_STATUS_FAIL;
+            continue;
         }
-    }
-
-    if( CtxUpdateStatus.Elements.SecureElement == 1 )
-    {
-        if( NvmmWrite( &SecureElementNvmCtxDataBlock, MacContexts->SecureElementNvmCtx, MacContexts->SecureElementNvmCtxSize ) != NVMM_SUCCESS )
+        if( ( copyModules & ( 1 << i ) ) != 0 )
         {
-            return NVMCTXMGMT_STATUS_FAIL;
+            // The unused end of the context stays zero, the EEPROM only gets
+            // the changed bytes and the journal drops the trailing zeros
+            memset1( image + offset, 0, LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] ) );
+            if( LoRaMacNvmCtxPack( ( LoRaMacNvmCtxModule_t ) i, *ctxs[i], *sizes[i], image + offset, LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] ) ) == 0 )
+            {
+                status = NVMCTXMGMT_STATUS_FAIL;
+            }
         }
+        // Each context has its own space, in the image or in its data block
+        offset += LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] );
     }
+    CtxUpdateStatus.Value &= ~storeModules;
+    CRITICAL_SECTION_END( );
 
-#if ( MAX_PERSISTENT_CTX_MGMT_ENABLED == 1 )
-    if( CtxUpdateStatus.Elements.Mac == 1 )
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    // The image holds all the contexts once packed, even when its write fails
+    SnapshotImageValid = ( status == NVMCTXMGMT_STATUS_SUCCESS );
+#endif
+
+    // Write
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    // The other slot keeps the previous snapshot until this one is complete
+    if( ( status == NVMCTXMGMT_STATUS_SUCCESS ) &&
+        ( NvmmWrite( &SnapshotDataBlocks[slot], image, imageSize ) == NVMM_SUCCESS ) )
     {
-        if( NvmmWrite( &MacNvmCtxDataBlock, MacContexts->MacNvmCtx, MacContexts->MacNvmCtxSize ) != NVMM_SUCCESS )
-        {
-            return NVMCTXMGMT_STATUS_FAIL;
-        }
+        SnapshotGeneration = generation;
+        SnapshotSlot = slot;
     }
-
-    if( CtxUpdateStatus.Elements.Region == 1 )
+    else
     {
-        if( NvmmWrite( &RegionNvmCtxDataBlock, MacContexts->RegionNvmCtx, MacContexts->RegionNvmCtxSize ) != NVMM_SUCCESS )
-        {
-            return NVMCTXMGMT_STATUS_FAIL;
-        }
+        status = NVMCTXMGMT_STATUS_FAIL;
     }
-
-    if( CtxUpdateStatus.Elements.Commands == 1 )
+#else
+    // All the contexts of this store or none of them, the journal backend
+    // appends them as one record
+    offset = 0;
+    NvmmTransactionBegin( );
+    for( uint8_t i = 0; ( i < NVM_CTX_NB_MODULES ) && ( status == NVMCTXMGMT_STATUS_SUCCESS ); i++ )
     {
-        if( NvmmWrite( &CommandsNvmCtxDataBlock, MacContexts->CommandsNvmCtx, MacContexts->CommandsNvmCtxSize ) != NVMM_SUCCESS )
+        if( ( copyModules & ( 1 << i ) ) == 0 )
         {
-            return NVMCTXMGMT_STATUS_FAIL;
+            continue;
         }
+        if( NvmmTransactionWrite( &CtxDataBlocks[i], image + offset, LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] ) ) != NVMM_SUCCESS )
+        {
+            status = NVMCTXMGMT_STATUS_FAIL;
+        }
+        offset += LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] );
+    }
+    if( status != NVMCTXMGMT_STATUS_SUCCESS )
+    {
+        NvmmTransactionAbort( );
+    }
+    else if( NvmmTransactionCommit( ) != NVMM_SUCCESS )
+    {
+        status = NVMCTXMGMT_STATUS_FAIL;
     }
+#endif
 
-    if( CtxUpdateStatus.Elements.ClassB == 1 )
+    // Write back the EEPROM RAM mirror changes in one go
+    if( ( status == NVMCTXMGMT_STATUS_SUCCESS ) && ( EepromFlush( ) != SUCCESS ) )
     {
-        if( NvmmWrite( &ClassBNvmCtxDataBlock, MacContexts->ClassBNvmCtx, MacContexts->ClassBNvmCtxSize ) != NVMM_SUCCESS )
-        {
-            return NVMCTXMGMT_STATUS_FAIL;
-        }
+        status = NVMCTXMGMT_STATUS_FAIL;
     }
 
-    if( CtxUpdateStatus.Elements.ConfirmQueue == 1 )
+    if( status != NVMCTXMGMT_STATUS_SUCCESS )
     {
-        if( NvmmWrite( &ConfirmQueueNvmCtxDataBlock, MacContexts->ConfirmQueueNvmCtx, MacContexts->ConfirmQueueNvmCtxSize ) != NVMM_SUCCESS )
-        {
-            return NVMCTXMGMT_STATUS_FAIL;
-        }
+        // Store the contexts again on the next call
+        CRITICAL_SECTION_BEGIN( );
+        CtxUpdateStatus.Value |= storeModules;
+        CRITICAL_SECTION_END( );
     }
+    return status;
+}
 #endif
 
-    CtxUpdateStatus.Value = 0x00;
+NvmCtxMgmtStatus_t NvmCtxMgmtStore( void )
+{
+#if ( CONTEXT_MANAGEMENT_ENABLED == 1 )
+    NvmCtxMgmtStatus_t status;
+    uint8_t modules = NVM_CTX_WRITE_THROUGH_MASK;
 
-    // Resume LoRaMac
-    LoRaMacStart( );
+    // Store the deferred contexts changes once enough of them accumulated
+    if( ( ( CtxUpdateStatus.Value & NVM_CTX_STORAGE_MASK & ~NVM_CTX_WRITE_THROUGH_MASK ) != 0 ) &&
+        ( ( DeferFrameCnt >= NVM_CTX_STORE_DEFER_FRAMES ) ||
+          ( TimerGetElapsedTime( DeferStartTime ) >= NVM_CTX_STORE_DEFER_INTERVAL ) ) )
+    {
+        modules = 0xFF;
+    }
+    status = NvmCtxMgmtStoreModules( modules );
 
-    return NVMCTXMGMT_STATUS_SUCCESS;
+    // Reclaim the journal stale records while the MAC is idle, the next
+    // stores then do not have to
+    if( ( LoRaMacIsBusy( ) == false ) && ( NvmmCollect( ) == true ) )
+    {
+        EepromFlush( );
+    }
+    return status;
 #else
     return NVMCTXMGMT_STATUS_FAIL;
 #endif
 }
 
+NvmCtxMgmtStatus_t NvmCtxMgmtFlush( void )
+{
+#if ( CONTEXT_MANAGEMENT_ENABLED == 1 )
+    return NvmCtxMgmtStoreModules( 0xFF );
+#else
+    return NVMCTXMGMT_STATUS_FAIL;
+#endif
+}
+
+
 NvmCtxMgmtStatus_t NvmCtxMgmtRestore( void )
 {
 #if ( CONTEXT_MANAGEMENT_ENABLED == 1 )
     MibRequestConfirm_t mibReq;
     LoRaMacCtxs_t contexts = { 0 };
     NvmCtxMgmtStatus_t status = NVMCTXMGMT_STATUS_SUCCESS;
+    void** ctxs[NVM_CTX_NB_MODULES];
+    size_t* sizes[NVM_CTX_NB_MODULES];
+    void** restoreCtxs[NVM_CTX_NB_MODULES];
+    size_t* restoreSizes[NVM_CTX_NB_MODULES];
+    size_t offset = 0;
+    size_t ctxsOffset = 0;
+    size_t ctxsSize = 0;
 
     // Read out the contexts lengths
     mibReq.Type = MIB_NVM_CTXS;
     LoRaMacMibGetRequestConfirm( &mibReq );
 
+    GetCtxsLayout( &contexts, NVM_CTX_STORAGE_MASK, restoreCtxs, restoreSizes );
 
-    uint8_t NvmCryptoCtxRestore[mibReq.Param.Contexts->CryptoNvmCtxSize];
-    uint8_t NvmSecureElementCtxRestore[mibReq.Param.Contexts->SecureElementNvmCtxSize];
-#if ( MAX_PERSISTENT_CTX_MGMT_ENABLED == 1 )
-    uint8_t NvmMacCtxRestore[mibReq.Param.Contexts->MacNvmCtxSize];
-    uint8_t NvmRegionCtxRestore[mibReq.Param.Contexts->RegionNvmCtxSize];
-    uint8_t NvmCommandsCtxRestore[mibReq.Param.Contexts->CommandsNvmCtxSize];
-    uint8_t NvmClassBCtxRestore[mibReq.Param.Contexts->ClassBNvmCtxSize];
-    uint8_t NvmConfirmQueueCtxRestore[mibReq.Param.Contexts->ConfirmQueueNvmCtxSize];
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    size_t imageSize = GetCtxsLayout( mibReq.Param.Contexts, NVM_CTX_STORAGE_MASK, ctxs, sizes ) + sizeof( uint32_t );
+#else
+    size_t imageSize = GetCtxsLayout( mibReq.Param.Contexts, NVM_CTX_STORAGE_MASK, ctxs, sizes );
 #endif
-
-    if ( NvmmDeclare( &CryptoNvmCtxDataBlock, mibReq.Param.Contexts->CryptoNvmCtxSize ) == NVMM_SUCCESS )
-    {
-        NvmmRead( &CryptoNvmCtxDataBlock, NvmCryptoCtxRestore, mibReq.Param.Contexts->CryptoNvmCtxSize );
-        contexts.CryptoNvmCtx = &NvmCryptoCtxRestore;
-        contexts.CryptoNvmCtxSize = mibReq.Param.Contexts->CryptoNvmCtxSize;
-    }
-    else
+    for( uint8_t i = 0; i < NVM_CTX_NB_MODULES; i++ )
     {
-        status = NVMCTXMGMT_STATUS_FAIL;
+        if( ( NVM_CTX_STORAGE_MASK & ( 1 << i ) ) != 0 )
+        {
+            ctxsSize += *sizes[i];
+        }
     }
+    // The unpacked contexts follow the stored image
+    uint8_t* image = CtxBuffer;
+    uint8_t* ctxsData = CtxBuffer + imageSize;
 
-    if ( NvmmDeclare( &SecureElementNvmCtxDataBlock, mibReq.Param.Contexts->SecureElementNvmCtxSize ) == NVMM_SUCCESS )
+    if( ( imageSize + ctxsSize ) > NVM_CTX_BUFFER_SIZE )
     {
-        NvmmRead( &SecureElementNvmCtxDataBlock, NvmSecureElementCtxRestore, mibReq.Param.Contexts->SecureElementNvmCtxSize );
-        contexts.SecureElementNvmCtx = &NvmSecureElementCtxRestore;
-        contexts.SecureElementNvmCtxSize = mibReq.Param.Contexts->SecureElementNvmCtxSize;
-    }
-    else
-    {
-        status = NVMCTXMGMT_STATUS_FAIL;
+        return NVMCTXMGMT_STATUS_FAIL;
     }
 
-#if ( MAX_PERSISTENT_CTX_MGMT_ENABLED == 1 )
-    if( NvmmDeclare( &MacNvmCtxDataBlock, mibReq.Param.Contexts->MacNvmCtxSize ) == NVMM_SUCCESS )
-    {
-        NvmmRead( &MacNvmCtxDataBlock, NvmMacCtxRestore, mibReq.Param.Contexts->MacNvmCtxSize );
-        contexts.MacNvmCtx = &NvmMacCtxRestore;
-        contexts.MacNvmCtxSize = mibReq.Param.Contexts->MacNvmCtxSize;
-    }
-    else
-    {
-        status = NVMCTXMGMT_STATUS_FAIL;
-    }
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    int8_t slot = -1;
+    uint32_t generation = 0;
 
-    if ( NvmmDeclare( &RegionNvmCtxDataBlock, mibReq.Param.Contexts->RegionNvmCtxSize ) == NVMM_SUCCESS )
+    // One read and one checksum per slot, the valid slot with the most recent
+    // generation holds the contexts
+    for( uint8_t i = 0; i < NVM_CTX_SNAPSHOT_SLOTS; i++ )
     {
-        NvmmRead( &RegionNvmCtxDataBlock, NvmRegionCtxRestore, mibReq.Param.Contexts->RegionNvmCtxSize );
-        contexts.RegionNvmCtx = &NvmRegionCtxRestore;
-        contexts.RegionNvmCtxSize = mibReq.Param.Contexts->RegionNvmCtxSize;
+        if( NvmmRestore( &SnapshotDataBlocks[i], image, imageSize ) == NVMM_SUCCESS )
+        {
+            memcpy1( ( uint8_t* ) &generation, image, sizeof( uint32_t ) );
+            if( ( slot < 0 ) || ( ( int32_t )( generation - SnapshotGeneration ) > 0 ) )
+            {
+                slot = i;
+                SnapshotGeneration = generation;
+            }
+        }
     }
-    else
+    if( ( slot >= 0 ) && ( slot != ( NVM_CTX_SNAPSHOT_SLOTS - 1 ) ) &&
+        ( NvmmRead( &SnapshotDataBlocks[slot], image, imageSize ) != NVMM_SUCCESS ) )
     {
-        status = NVMCTXMGMT_STATUS_FAIL;
+        slot = -1;
     }
+    offset = sizeof( uint32_t );
 
-    if ( NvmmDeclare( &CommandsNvmCtxDataBlock, mibReq.Param.Contexts->CommandsNvmCtxSize ) == NVMM_SUCCESS )
+    if( slot >= 0 )
     {
-        NvmmRead( &CommandsNvmCtxDataBlock, NvmCommandsCtxRestore, mibReq.Param.Contexts->CommandsNvmCtxSize );
-        contexts.CommandsNvmCtx = &NvmCommandsCtxRestore;
-        contexts.CommandsNvmCtxSize = mibReq.Param.Contexts->CommandsNvmCtxSize;
+        SnapshotSlot = slot;
     }
     else
     {
         status = NVMCTXMGMT_STATUS_FAIL;
     }
+#endif
 
-    if ( NvmmDeclare( &ClassBNvmCtxDataBlock, mibReq.Param.Contexts->ClassBNvmCtxSize ) == NVMM_SUCCESS )
+    for( uint8_t i = 0; i < NVM_CTX_NB_MODULES; i++ )
     {
-        NvmmRead( &ClassBNvmCtxDataBlock, NvmClassBCtxRestore, mibReq.Param.Contexts->ClassBNvmCtxSize );
-        contexts.ClassBNvmCtx = &NvmClassBCtxRestore;
-        contexts.ClassBNvmCtxSize = mibReq.Param.Contexts->ClassBNvmCtxSize;
-    }
-    else
-    {
-        status = NVMCTXMGMT_STATUS_FAIL;
-    }
+        size_t size = 0;
 
-    if ( NvmmDeclare( &ConfirmQueueNvmCtxDataBlock, mibReq.Param.Contexts->ConfirmQueueNvmCtxSize ) == NVMM_SUCCESS )
-    {
-        NvmmRead( &ConfirmQueueNvmCtxDataBlock, NvmConfirmQueueCtxRestore, mibReq.Param.Contexts->ConfirmQueueNvmCtxSize );
-        contexts.ConfirmQueueNvmCtx = &NvmConfirmQueueCtxRestore;
-        contexts.ConfirmQueueNvmCtxSize = mibReq.Param.Contexts->ConfirmQueueNvmCtxSize;
-    }
-    else
-    {
-        status = NVMCTXMGMT_STATUS_FAIL;
+        if( ( NVM_CTX_STORAGE_MASK & ( 1 << i ) ) == 0 )
+        {
+            continue;
+        }
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+        if( status == NVMCTXMGMT_STATUS_SUCCESS )
+        {
+            size = LoRaMacNvmCtxUnpack( ( LoRaMacNvmCtxModule_t ) i, image + offset, LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] ), ctxsData + ctxsOffset, *sizes[i] );
+        }
+        offset += LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] );
+#else
+        // Each data block is read once, its checksum is verified on the copy
+        if( NvmmRestore( &CtxDataBlocks[i], image + offset, LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] ) ) == NVMM_SUCCESS )
+        {
+            size = LoRaMacNvmCtxUnpack( ( LoRaMacNvmCtxModule_t ) i, image + offset, LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] ), ctxsData + ctxsOffset, *sizes[i] );
+        }
+        offset += LORAMAC_NVM_CODEC_MAX_SIZE( *sizes[i] );
+#endif
+        if( size == 0 )
+        {
+            status = NVMCTXMGMT_STATUS_FAIL;
+        }
+        *restoreCtxs[i] = ctxsData + ctxsOffset;
+        *restoreSizes[i] = *sizes[i];
+        ctxsOffset += *sizes[i];
     }
+
+#if ( NVM_CTX_SNAPSHOT_ENABLED == 1 )
+    // The restored snapshot image is kept for the next stores
+    SnapshotImageValid = ( status == NVMCTXMGMT_STATUS_SUCCESS );
 #endif
 
     // Enforce storing all contexts
     if( status == NVMCTXMGMT_STATUS_FAIL )
     {
         CtxUpdateStatus.Value = 0xFF;
-        NvmCtxMgmtStore( );
+        NvmCtxMgmtFlush( );
     }
     else
     {  // If successful query the mac to restore contexts
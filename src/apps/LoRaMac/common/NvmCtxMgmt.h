@@ -62,8 +62,35 @@ typedef enum NvmCtxMgmtStatus_e
  */
 void NvmCtxMgmtEvent( LoRaMacNvmCtxModule_t module );
 
+/*!
+ * \brief Stores the changed contexts.
+ *
+ * \remark The frame counters and keys contexts are stored right away. The
+ *         other contexts changes are deferred and stored in one batch after a
+ *         given time or number of frames.
+ *
+ * \retval status Status of the operation
+ */
 NvmCtxMgmtStatus_t NvmCtxMgmtStore( void );
 
+/*!
+ * \brief Stores all the changed contexts, including the deferred ones.
+ *
+ * \remark Must be called before the MCU is powered off or enters a low power
+ *         mode losing the RAM content, e.g. LPM_OFF_MODE.
+ *
+ * \retval status Status of the operation
+ */
+NvmCtxMgmtStatus_t NvmCtxMgmtFlush( void );
+
+/*!
+ * \brief Restores the stored contexts into the MAC.
+ *
+ * \remark Each data block is read once, its checksum is verified on the read
+ *         copy. With the snapshot storage all the contexts are one data block.
+ *
+ * \retval status Status of the operation
+ */
 NvmCtxMgmtStatus_t NvmCtxMgmtRestore(void );
 
 #endif // __NVMCTXMGMT_H__
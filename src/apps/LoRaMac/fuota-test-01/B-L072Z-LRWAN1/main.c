@@ -23,11 +23,14 @@
 
 #include <stdio.h>
 #include "utilities.h"
+#include "crc.h"
 #include "board.h"
+#include "lpm-board.h"
 #include "gpio.h"
 
 #include "Commissioning.h"
 #include "LmHandler.h"
+#include "NvmCtxMgmt.h"
 #include "LmhpCompliance.h"
 #include "LmhpClockSync.h"
 #include "LmhpRemoteMcastSetup.h"
@@ -156,16 +159,6 @@ static void OnFragDone( int32_t status, uint8_t *file, uint32_t size );
 static void StartTxProcess( LmHandlerTxEvents_t txEvent );
 static void UplinkProcess( void );
 
-/*!
- * Computes a CCITT 32 bits CRC
- *
- * \param [IN] buffer   Data buffer used to compute the CRC
- * \param [IN] length   Data buffer length
- * 
- * \retval crc          The computed buffer of length CRC
- */
-static uint32_t Crc32( uint8_t *buffer, uint16_t length );
-
 /*!
  * Function executed on TxTimer event
  */
@@ -366,6 +359,11 @@ int main( void )
         }
         else
         {
+            // The RAM content is lost in OFF mode, store the deferred contexts changes first
+            if( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) == LPM_OFF_MODE )
+            {
+                NvmCtxMgmtFlush( );
+            }
             // The MCU wakes up through events
             BoardLowPowerHandler( );
         }
@@ -537,7 +535,12 @@ static void OnFragProgress( uint16_t fragCounter, uint16_t fragNb, uint8_t fragS
 #if( FRAG_DECODER_FILE_HANDLING_NEW_API == 1 )
 static void OnFragDone( int32_t status, uint32_t size )
 {
-    FileRxCrc = Crc32( UnfragmentedData, size );
+#if( FRAG_DECODER_FILE_CRC32 == 1 )
+    // Hashed while the fragments were received
+    FileRxCrc = LmhpFragmentationGetFileCrc32( );
+#else
+    FileRxCrc = Crc32Compute( UnfragmentedData, size );
+#endif
     IsFileTransferDone = true;
     // Switch LED 3 OFF
     GpioWrite( &Led3, 0 );
@@ -551,7 +554,7 @@ static void OnFragDone( int32_t status, uint32_t size )
 #else
 static void OnFragDone( int32_t status, uint8_t *file, uint32_t size )
 {
-    FileRxCrc = Crc32( file, size );
+    FileRxCrc = Crc32Compute( file, size );
     IsFileTransferDone = true;
     // Switch LED 3 OFF
     GpioWrite( &Led3, 0 );
@@ -574,6 +577,7 @@ static void StartTxProcess( LmHandlerTxEvents_t txEvent )
         {
             // Schedule 1st packet transmission
             TimerInit( &TxTimer, OnTxTimerEvent );
+            TimerSetDeferred( &TxTimer, true );
             TimerSetValue( &TxTimer, APP_TX_DUTYCYCLE  + randr( -APP_TX_DUTYCYCLE_RND, APP_TX_DUTYCYCLE_RND ) );
             OnTxTimerEvent( NULL );
         }
@@ -703,28 +707,3 @@ static void OnLedBeaconTimerEvent( void* context )
 
     TimerStart( &LedBeaconTimer );
 }
-
-static uint32_t Crc32( uint8_t *buffer, uint16_t length )
-{
-    // The CRC calculation follows CCITT - 0x04C11DB7
-    const uint32_t reversedPolynom = 0xEDB88320;
-
-    // CRC initial value
-    uint32_t crc = 0xFFFFFFFF;
-
-    if( buffer == NULL )
-    {
-        return 0;
-    }
-
-    for( uint16_t i = 0; i < length; ++i )
-    {
-        crc ^= ( uint32_t )buffer[i];
-        for( uint16_t i = 0; i < 8; i++ )
-        {
-            crc = ( crc >> 1 ) ^ ( reversedPolynom & ~( ( crc & 0x01 ) - 1 ) );
-        }
-    }
-
-    return ~crc;
-}
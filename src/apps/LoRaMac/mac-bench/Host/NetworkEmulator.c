@@ -0,0 +1,584 @@
+/*!
+ * \file      NetworkEmulator.c
+ *
+ * \brief     LoRaWAN 1.0.x network server emulator running on the simulated
+ *            radio air interface
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <time.h>
+#include "utilities.h"
+#include "timer.h"
+#include "aes.h"
+#include "cmac.h"
+#include "sim-radio.h"
+#include "NetworkEmulator.h"
+
+/*!
+ * Join accept delay from the end of the join request [ms]
+ */
+#define JOIN_ACCEPT_DELAY                           5000
+
+/*!
+ * RX1 delay sent in the join accepts [s]
+ */
+#define RX1_DELAY                                   1
+
+/*!
+ * Beacon period [ms]
+ */
+#define BEACON_INTERVAL                             128000
+
+/*!
+ * EU868 beacon channel and format
+ */
+#define BEACON_FREQUENCY                            869525000
+#define BEACON_SF                                   9
+#define BEACON_SIZE                                 17
+#define BEACON_RFU1_SIZE                            2
+#define BEACON_PREAMBLE_LEN                         10
+
+/*!
+ * Frame sizes. The data frames header is the MHDR and the FHDR without FOpts.
+ */
+#define JOIN_REQUEST_SIZE                           23
+#define JOIN_ACCEPT_SIZE                            17
+#define DATA_HEADER_SIZE                            8
+#define MIC_SIZE                                    4
+#define FOPTS_MAX_SIZE                              15
+
+/*!
+ * MAC header frame types
+ */
+#define FRAME_TYPE_JOIN_REQ                         0x00
+#define FRAME_TYPE_JOIN_ACCEPT                      0x01
+#define FRAME_TYPE_DATA_UNCONFIRMED_UP              0x02
+#define FRAME_TYPE_DATA_UNCONFIRMED_DOWN            0x03
+#define FRAME_TYPE_DATA_CONFIRMED_UP                0x04
+
+/*!
+ * MAC commands handled by the emulator
+ */
+#define MAC_LINK_CHECK                              0x02
+#define MAC_RX_PARAM_SETUP                          0x05
+#define MAC_RX_TIMING_SETUP                         0x08
+#define MAC_DL_CHANNEL                              0x0A
+#define MAC_DEVICE_TIME                             0x0D
+#define MAC_PING_SLOT_INFO                          0x10
+
+/*!
+ * Emulated network server context
+ */
+typedef struct sNetworkEmulatorCtx
+{
+    uint8_t NwkKey[16];
+    uint8_t NwkSKey[16];
+    uint8_t AppSKey[16];
+    uint32_t NetId;
+    uint32_t DevAddr;
+    uint32_t JoinNonce;
+    uint32_t FCntDown;
+    bool IsJoined;
+    /*!
+     * Downlink queued by the application
+     */
+    bool IsDownlinkPending;
+    uint8_t DownlinkPort;
+    uint8_t DownlinkSize;
+    uint8_t DownlinkPayload[NETWORK_EMULATOR_DOWNLINK_MAX_SIZE];
+    /*!
+     * MAC command answers of the current uplink
+     */
+    uint8_t Answers[FOPTS_MAX_SIZE];
+    uint8_t AnswersSize;
+    /*!
+     * The end-device repeats some answers until it receives a downlink
+     */
+    bool IsAnswerAckRequired;
+    NetworkEmulatorStats_t Stats;
+}NetworkEmulatorCtx_t;
+
+static NetworkEmulatorCtx_t Ctx;
+
+/*!
+ * Buffer of the frames sent by the emulator
+ */
+static uint8_t TxBuffer[255];
+
+/*!
+ * Timer sending the beacons
+ */
+static TimerEvent_t BeaconTimer;
+
+static void OnAirTx( SimRadioFrame_t *frame );
+
+static SimRadioAirEvents_t AirEvents =
+{
+    .OnTx = OnAirTx,
+};
+
+/*!
+ * \brief Reads the host monotonic clock
+ *
+ * \retval time Host time [ns]
+ */
+static uint64_t HostTimeGet( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( ( uint64_t )now.tv_sec * 1000000000 ) + now.tv_nsec;
+}
+
+/*!
+ * \brief Gets the current GPS time
+ *
+ * \retval time GPS time [ms]
+ */
+static uint64_t GpsTimeGet( void )
+{
+    return ( ( uint64_t )NETWORK_EMULATOR_GPS_TIME_START * 1000 ) + TimerGetCurrentTime( );
+}
+
+/*!
+ * \brief Computes the 4 bytes MIC of a frame and writes it after the frame
+ *
+ * \param [IN] key    AES-CMAC key
+ * \param [IN] b0     Optional first block, NULL for the join accepts
+ * \param [IN] buffer Frame, followed by room for the MIC
+ * \param [IN] size   Frame size without MIC
+ */
+static void MicAppend( const uint8_t *key, const uint8_t *b0, uint8_t *buffer, uint8_t size )
+{
+    AES_CMAC_CTX ctx;
+    uint8_t digest[AES_CMAC_DIGEST_LENGTH];
+
+    AES_CMAC_Init( &ctx );
+    AES_CMAC_SetKey( &ctx, key );
+    if( b0 != NULL )
+    {
+        AES_CMAC_Update( &ctx, b0, 16 );
+    }
+    AES_CMAC_Update( &ctx, buffer, size );
+    AES_CMAC_Final( digest, &ctx );
+    memcpy1( buffer + size, digest, MIC_SIZE );
+}
+
+/*!
+ * \brief Encrypts or decrypts a FRMPayload in place
+ *
+ * \param [IN] key    AES key
+ * \param [IN] dir    Frame direction [0: uplink, 1: downlink]
+ * \param [IN] fCnt   Frame counter
+ * \param [IN] buffer Payload
+ * \param [IN] size   Payload size
+ */
+static void PayloadCrypt( const uint8_t *key, uint8_t dir, uint32_t fCnt, uint8_t *buffer, uint8_t size )
+{
+    aes_context ctx;
+    uint8_t aBlock[16] = { 0x01, 0x00, 0x00, 0x00, 0x00, dir,
+                           Ctx.DevAddr & 0xFF, ( Ctx.DevAddr >> 8 ) & 0xFF, ( Ctx.DevAddr >> 16 ) & 0xFF, ( Ctx.DevAddr >> 24 ) & 0xFF,
+                           fCnt & 0xFF, ( fCnt >> 8 ) & 0xFF, ( fCnt >> 16 ) & 0xFF, ( fCnt >> 24 ) & 0xFF,
+                           0x00, 0x00 };
+    uint8_t sBlock[16];
+
+    aes_set_key( key, 16, &ctx );
+    for( uint8_t i = 0; i < size; i++ )
+    {
+        if( ( i & 0x0F ) == 0 )
+        {
+            aBlock[15] = ( i >> 4 ) + 1;
+            aes_encrypt( aBlock, sBlock, &ctx );
+        }
+        buffer[i] ^= sBlock[i & 0x0F];
+    }
+}
+
+/*!
+ * \brief Puts a frame on the air, answering the frame just received
+ *
+ * \param [IN] uplink Received frame
+ * \param [IN] size   Frame size
+ * \param [IN] delay  Delay from the end of the received frame [ms]
+ */
+static void DownlinkSend( SimRadioFrame_t *uplink, uint8_t size, uint32_t delay )
+{
+    SimRadioFrame_t frame = *uplink;
+
+    frame.IqInverted = true;
+    frame.Payload = TxBuffer;
+    frame.Size = size;
+    if( SimRadioAirTx( &frame, delay ) == true )
+    {
+        Ctx.Stats.NbDownlinks++;
+    }
+    else
+    {
+        Ctx.Stats.NbDropped++;
+    }
+}
+
+static void JoinRequestProcess( SimRadioFrame_t *frame )
+{
+    aes_context ctx;
+    uint8_t keyBlock[16];
+    uint16_t devNonce;
+
+    if( frame->Size != JOIN_REQUEST_SIZE )
+    {
+        return;
+    }
+    Ctx.Stats.NbJoinRequests++;
+    devNonce = frame->Payload[17] | ( frame->Payload[18] << 8 );
+
+    // MHDR | JoinNonce | NetID | DevAddr | DLSettings | RxDelay | MIC
+    Ctx.JoinNonce = ( Ctx.JoinNonce + 1 ) & 0x00FFFFFF;
+    TxBuffer[0] = FRAME_TYPE_JOIN_ACCEPT << 5;
+    TxBuffer[1] = Ctx.JoinNonce & 0xFF;
+    TxBuffer[2] = ( Ctx.JoinNonce >> 8 ) & 0xFF;
+    TxBuffer[3] = ( Ctx.JoinNonce >> 16 ) & 0xFF;
+    TxBuffer[4] = Ctx.NetId & 0xFF;
+    TxBuffer[5] = ( Ctx.NetId >> 8 ) & 0xFF;
+    TxBuffer[6] = ( Ctx.NetId >> 16 ) & 0xFF;
+    TxBuffer[7] = Ctx.DevAddr & 0xFF;
+    TxBuffer[8] = ( Ctx.DevAddr >> 8 ) & 0xFF;
+    TxBuffer[9] = ( Ctx.DevAddr >> 16 ) & 0xFF;
+    TxBuffer[10] = ( Ctx.DevAddr >> 24 ) & 0xFF;
+    TxBuffer[11] = 0x00;
+    TxBuffer[12] = RX1_DELAY;
+    MicAppend( Ctx.NwkKey, NULL, TxBuffer, JOIN_ACCEPT_SIZE - MIC_SIZE );
+
+    // LoRaWAN 1.0.x session keys
+    aes_set_key( Ctx.NwkKey, 16, &ctx );
+    memset1( keyBlock, 0, sizeof( keyBlock ) );
+    memcpy1( &keyBlock[1], &TxBuffer[1], 6 );
+    keyBlock[7] = devNonce & 0xFF;
+    keyBlock[8] = ( devNonce >> 8 ) & 0xFF;
+    keyBlock[0] = 0x01;
+    aes_encrypt( keyBlock, Ctx.NwkSKey, &ctx );
+    keyBlock[0] = 0x02;
+    aes_encrypt( keyBlock, Ctx.AppSKey, &ctx );
+
+    // The network server encrypts with aes128_decrypt(NwkKey, ...)
+    aes_decrypt( &TxBuffer[1], &TxBuffer[1], &ctx );
+
+    Ctx.FCntDown = 0;
+    Ctx.IsJoined = true;
+    DownlinkSend( frame, JOIN_ACCEPT_SIZE, JOIN_ACCEPT_DELAY );
+}
+
+/*!
+ * \brief Parses the MAC commands of an uplink and prepares the answers
+ *
+ * \param [IN] commands MAC commands
+ * \param [IN] size     MAC commands size
+ */
+static void MacCommandsProcess( uint8_t *commands, uint8_t size )
+{
+    // Payload size of the end-device commands, indexed by CID. 0xFF for
+    // the commands unknown to the emulator.
+    static const uint8_t cmdSizes[] =
+    {
+        0xFF, 0xFF, 0, 1, 0, 1, 2, 1, 0, 0, 1, 0xFF, 0xFF, 0, 0xFF, 0xFF, 1, 1, 0xFF, 1
+    };
+    uint8_t i = 0;
+
+    while( i < size )
+    {
+        uint8_t cid = commands[i++];
+
+        if( ( cid >= sizeof( cmdSizes ) ) || ( cmdSizes[cid] == 0xFF ) || ( ( i + cmdSizes[cid] ) > size ) )
+        {
+            break;
+        }
+        i += cmdSizes[cid];
+        Ctx.Stats.NbMacCommands++;
+
+        switch( cid )
+        {
+            case MAC_LINK_CHECK:
+            {
+                if( ( Ctx.AnswersSize + 3 ) <= FOPTS_MAX_SIZE )
+                {
+                    Ctx.Answers[Ctx.AnswersSize++] = MAC_LINK_CHECK;
+                    Ctx.Answers[Ctx.AnswersSize++] = 20;
+                    Ctx.Answers[Ctx.AnswersSize++] = 1;
+                }
+                break;
+            }
+            case MAC_DEVICE_TIME:
+            {
+                // GPS time of the end of the uplink, fractional part in 1/256 s
+                uint64_t gpsTime = GpsTimeGet( );
+                uint32_t seconds = gpsTime / 1000;
+                uint8_t fraction = ( ( gpsTime % 1000 ) * 256 ) / 1000;
+
+                if( ( Ctx.AnswersSize + 6 ) <= FOPTS_MAX_SIZE )
+                {
+                    Ctx.Answers[Ctx.AnswersSize++] = MAC_DEVICE_TIME;
+                    Ctx.Answers[Ctx.AnswersSize++] = seconds & 0xFF;
+                    Ctx.Answers[Ctx.AnswersSize++] = ( seconds >> 8 ) & 0xFF;
+                    Ctx.Answers[Ctx.AnswersSize++] = ( seconds >> 16 ) & 0xFF;
+                    Ctx.Answers[Ctx.AnswersSize++] = ( seconds >> 24 ) & 0xFF;
+                    Ctx.Answers[Ctx.AnswersSize++] = fraction;
+                }
+                break;
+            }
+            case MAC_PING_SLOT_INFO:
+            {
+                if( ( Ctx.AnswersSize + 1 ) <= FOPTS_MAX_SIZE )
+                {
+                    Ctx.Answers[Ctx.AnswersSize++] = MAC_PING_SLOT_INFO;
+                }
+                break;
+            }
+            case MAC_RX_PARAM_SETUP:
+            case MAC_RX_TIMING_SETUP:
+            case MAC_DL_CHANNEL:
+            {
+                Ctx.IsAnswerAckRequired = true;
+                break;
+            }
+            default:
+            {
+                // Answers to the network requests
+                break;
+            }
+        }
+    }
+}
+
+static void UplinkProcess( SimRadioFrame_t *frame, bool isConfirmed )
+{
+    uint8_t *payload = frame->Payload;
+    uint32_t devAddr;
+    uint8_t fOptsLen;
+    uint16_t fCnt;
+    uint8_t index;
+    uint8_t b0[16];
+
+    if( ( Ctx.IsJoined == false ) || ( frame->Size < ( DATA_HEADER_SIZE + 1 + MIC_SIZE ) ) )
+    {
+        return;
+    }
+    devAddr = payload[1] | ( payload[2] << 8 ) | ( payload[3] << 16 ) | ( ( uint32_t )payload[4] << 24 );
+    if( devAddr != Ctx.DevAddr )
+    {
+        return;
+    }
+    Ctx.Stats.NbUplinks++;
+
+    // The uplink MIC isn't verified, the end-device is trusted
+    fOptsLen = payload[5] & 0x0F;
+    fCnt = payload[6] | ( payload[7] << 8 );
+    index = DATA_HEADER_SIZE + fOptsLen;
+
+    Ctx.AnswersSize = 0;
+    Ctx.IsAnswerAckRequired = false;
+    MacCommandsProcess( &payload[DATA_HEADER_SIZE], fOptsLen );
+    if( ( ( index + 1 + MIC_SIZE ) < frame->Size ) && ( payload[index] == 0 ) )
+    {
+        uint8_t size = frame->Size - index - 1 - MIC_SIZE;
+
+        // MAC commands carried by the FRMPayload
+        PayloadCrypt( Ctx.NwkSKey, 0, fCnt, &payload[index + 1], size );
+        MacCommandsProcess( &payload[index + 1], size );
+    }
+
+    if( ( isConfirmed == false ) && ( Ctx.AnswersSize == 0 ) && ( Ctx.IsAnswerAckRequired == false ) &&
+        ( Ctx.IsDownlinkPending == false ) )
+    {
+        return;
+    }
+
+    // MHDR | DevAddr | FCtrl | FCnt | FOpts | FPort | FRMPayload | MIC
+    TxBuffer[0] = FRAME_TYPE_DATA_UNCONFIRMED_DOWN << 5;
+    memcpy1( &TxBuffer[1], &payload[1], 4 );
+    TxBuffer[5] = ( isConfirmed == true ) ? 0x20 : 0x00;
+    TxBuffer[6] = Ctx.FCntDown & 0xFF;
+    TxBuffer[7] = ( Ctx.FCntDown >> 8 ) & 0xFF;
+    index = DATA_HEADER_SIZE;
+    if( ( Ctx.IsDownlinkPending == true ) && ( Ctx.DownlinkPort == 0 ) )
+    {
+        // Port 0 doesn't allow FOpts, the answers lead the MAC commands
+        TxBuffer[index++] = 0;
+        memcpy1( &TxBuffer[index], Ctx.Answers, Ctx.AnswersSize );
+        memcpy1( &TxBuffer[index + Ctx.AnswersSize], Ctx.DownlinkPayload, Ctx.DownlinkSize );
+        PayloadCrypt( Ctx.NwkSKey, 1, Ctx.FCntDown, &TxBuffer[index], Ctx.AnswersSize + Ctx.DownlinkSize );
+        index += Ctx.AnswersSize + Ctx.DownlinkSize;
+    }
+    else
+    {
+        TxBuffer[5] |= Ctx.AnswersSize;
+        memcpy1( &TxBuffer[index], Ctx.Answers, Ctx.AnswersSize );
+        index += Ctx.AnswersSize;
+        if( Ctx.IsDownlinkPending == true )
+        {
+            TxBuffer[index++] = Ctx.DownlinkPort;
+            memcpy1( &TxBuffer[index], Ctx.DownlinkPayload, Ctx.DownlinkSize );
+            PayloadCrypt( Ctx.AppSKey, 1, Ctx.FCntDown, &TxBuffer[index], Ctx.DownlinkSize );
+            index += Ctx.DownlinkSize;
+        }
+    }
+    Ctx.IsDownlinkPending = false;
+
+    memset1( b0, 0, sizeof( b0 ) );
+    b0[0] = 0x49;
+    b0[5] = 0x01;
+    memcpy1( &b0[6], &TxBuffer[1], 4 );
+    b0[10] = Ctx.FCntDown & 0xFF;
+    b0[11] = ( Ctx.FCntDown >> 8 ) & 0xFF;
+    b0[12] = ( Ctx.FCntDown >> 16 ) & 0xFF;
+    b0[13] = ( Ctx.FCntDown >> 24 ) & 0xFF;
+    b0[15] = index;
+    MicAppend( Ctx.NwkSKey, b0, TxBuffer, index );
+    Ctx.FCntDown++;
+
+    DownlinkSend( frame, index + MIC_SIZE, RX1_DELAY * 1000 );
+}
+
+static void OnAirTx( SimRadioFrame_t *frame )
+{
+    uint64_t start = HostTimeGet( );
+
+    if( ( frame->Modem == MODEM_LORA ) && ( frame->Size > 0 ) )
+    {
+        switch( frame->Payload[0] >> 5 )
+        {
+            case FRAME_TYPE_JOIN_REQ:
+                JoinRequestProcess( frame );
+                break;
+            case FRAME_TYPE_DATA_UNCONFIRMED_UP:
+                UplinkProcess( frame, false );
+                break;
+            case FRAME_TYPE_DATA_CONFIRMED_UP:
+                UplinkProcess( frame, true );
+                break;
+            default:
+                break;
+        }
+    }
+    Ctx.Stats.ProcessingTime += HostTimeGet( ) - start;
+}
+
+/*!
+ * \brief Computes the beacon CRC, CCITT polynomial with a 0 initial value
+ */
+static uint16_t BeaconCrc( const uint8_t *buffer, uint8_t size )
+{
+    uint16_t crc = 0x0000;
+
+    for( uint8_t i = 0; i < size; i++ )
+    {
+        crc ^= ( uint16_t )buffer[i] << 8;
+        for( uint8_t j = 0; j < 8; j++ )
+        {
+            crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ 0x1021 : ( crc << 1 );
+        }
+    }
+    return crc;
+}
+
+static void OnBeaconTimerEvent( void* context )
+{
+    uint64_t start = HostTimeGet( );
+    uint64_t gpsTime = GpsTimeGet( );
+    // The timer wakes up 1 ms ahead of the beacon period start
+    uint64_t beaconTime = ( ( gpsTime + ( BEACON_INTERVAL / 2 ) ) / BEACON_INTERVAL ) * BEACON_INTERVAL;
+    uint32_t seconds = beaconTime / 1000;
+    uint8_t beacon[BEACON_SIZE];
+    uint16_t crc;
+    SimRadioFrame_t frame =
+    {
+        .Modem = MODEM_LORA,
+        .Frequency = BEACON_FREQUENCY,
+        .Bandwidth = 0,
+        .Datarate = BEACON_SF,
+        .Coderate = 1,
+        .IqInverted = false,
+        .PreambleLen = BEACON_PREAMBLE_LEN,
+        .Payload = beacon,
+        .Size = BEACON_SIZE
+    };
+
+    // RFU1 | Time | CRC1 | GwSpecific | CRC2
+    memset1( beacon, 0, sizeof( beacon ) );
+    beacon[BEACON_RFU1_SIZE] = seconds & 0xFF;
+    beacon[BEACON_RFU1_SIZE + 1] = ( seconds >> 8 ) & 0xFF;
+    beacon[BEACON_RFU1_SIZE + 2] = ( seconds >> 16 ) & 0xFF;
+    beacon[BEACON_RFU1_SIZE + 3] = ( seconds >> 24 ) & 0xFF;
+    crc = BeaconCrc( beacon, BEACON_RFU1_SIZE + 4 );
+    beacon[BEACON_RFU1_SIZE + 4] = crc & 0xFF;
+    beacon[BEACON_RFU1_SIZE + 5] = ( crc >> 8 ) & 0xFF;
+    crc = BeaconCrc( &beacon[BEACON_RFU1_SIZE + 6], 7 );
+    beacon[BEACON_RFU1_SIZE + 13] = crc & 0xFF;
+    beacon[BEACON_RFU1_SIZE + 14] = ( crc >> 8 ) & 0xFF;
+
+    if( SimRadioAirTx( &frame, ( beaconTime > gpsTime ) ? ( beaconTime - gpsTime ) : 0 ) == true )
+    {
+        Ctx.Stats.NbBeacons++;
+    }
+    else
+    {
+        Ctx.Stats.NbDropped++;
+    }
+
+    TimerSetValue( &BeaconTimer, beaconTime + BEACON_INTERVAL - 1 - gpsTime );
+    TimerStart( &BeaconTimer );
+    Ctx.Stats.ProcessingTime += HostTimeGet( ) - start;
+}
+
+void NetworkEmulatorInit( const uint8_t *nwkKey, uint32_t netId, uint32_t devAddr )
+{
+    memset1( ( uint8_t* )&Ctx, 0, sizeof( Ctx ) );
+    memcpy1( Ctx.NwkKey, nwkKey, 16 );
+    Ctx.NetId = netId;
+    Ctx.DevAddr = devAddr;
+
+    TimerInit( &BeaconTimer, OnBeaconTimerEvent );
+    SimRadioAirInit( &AirEvents );
+}
+
+bool NetworkEmulatorSetDownlink( uint8_t port, const uint8_t *payload, uint8_t size )
+{
+    if( ( Ctx.IsDownlinkPending == true ) || ( size > ( NETWORK_EMULATOR_DOWNLINK_MAX_SIZE - FOPTS_MAX_SIZE ) ) )
+    {
+        return false;
+    }
+    Ctx.DownlinkPort = port;
+    Ctx.DownlinkSize = size;
+    memcpy1( Ctx.DownlinkPayload, payload, size );
+    Ctx.IsDownlinkPending = true;
+    return true;
+}
+
+void NetworkEmulatorBeaconStart( void )
+{
+    uint32_t delay = ( ( 2 * BEACON_INTERVAL ) - ( GpsTimeGet( ) % BEACON_INTERVAL ) - 1 ) % BEACON_INTERVAL;
+
+    TimerSetValue( &BeaconTimer, ( delay == 0 ) ? BEACON_INTERVAL : delay );
+    TimerStart( &BeaconTimer );
+}
+
+void NetworkEmulatorBeaconStop( void )
+{
+    TimerStop( &BeaconTimer );
+}
+
+void NetworkEmulatorGetStats( NetworkEmulatorStats_t *stats )
+{
+    *stats = Ctx.Stats;
+}
@@ -0,0 +1,128 @@
+/*!
+ * \file      NetworkEmulator.h
+ *
+ * \brief     LoRaWAN 1.0.x network server emulator running on the simulated
+ *            radio air interface
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __NETWORK_EMULATOR_H__
+#define __NETWORK_EMULATOR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * GPS time of the RTC origin [s]
+ */
+#ifndef NETWORK_EMULATOR_GPS_TIME_START
+#define NETWORK_EMULATOR_GPS_TIME_START             1300000000
+#endif
+
+/*!
+ * Maximum size of a queued downlink payload
+ */
+#define NETWORK_EMULATOR_DOWNLINK_MAX_SIZE          242
+
+/*!
+ * Network emulator counters
+ */
+typedef struct sNetworkEmulatorStats
+{
+    /*!
+     * Number of received join requests
+     */
+    uint32_t NbJoinRequests;
+    /*!
+     * Number of received data uplinks
+     */
+    uint32_t NbUplinks;
+    /*!
+     * Number of MAC commands received in the uplinks
+     */
+    uint32_t NbMacCommands;
+    /*!
+     * Number of join accepts and data downlinks sent
+     */
+    uint32_t NbDownlinks;
+    /*!
+     * Number of beacons sent
+     */
+    uint32_t NbBeacons;
+    /*!
+     * Number of frames which could not be put on the air
+     */
+    uint32_t NbDropped;
+    /*!
+     * Host time spent in the emulator [ns]
+     */
+    uint64_t ProcessingTime;
+}NetworkEmulatorStats_t;
+
+/*!
+ * \brief Initializes the emulator and registers it on the air interface
+ *
+ * \remark The emulator implements the EU868 default channel plan. It
+ *         answers the join requests with a RX1 join accept and every
+ *         confirmed uplink, uplink with MAC command requests or queued
+ *         downlink with a RX1 downlink.
+ *
+ * \param [IN] nwkKey  Root key shared with the end-device
+ * \param [IN] netId   Network identifier sent in the join accepts
+ * \param [IN] devAddr Device address assigned by the join accepts
+ */
+void NetworkEmulatorInit( const uint8_t *nwkKey, uint32_t netId, uint32_t devAddr );
+
+/*!
+ * \brief Queues a downlink sent in the RX1 window of the next data uplink
+ *
+ * \remark The MAC command answers of the emulator are added to the FOpts
+ *         field, or in front of the payload for port 0.
+ *
+ * \param [IN] port    Downlink FPort. Port 0 payloads hold MAC commands
+ * \param [IN] payload Downlink payload, copied
+ * \param [IN] size    Downlink payload size
+ * \retval status      [true: queued, false: a downlink is already queued]
+ */
+bool NetworkEmulatorSetDownlink( uint8_t port, const uint8_t *payload, uint8_t size );
+
+/*!
+ * \brief Starts sending a beacon at the start of every beacon period
+ */
+void NetworkEmulatorBeaconStart( void );
+
+/*!
+ * \brief Stops sending the beacons
+ */
+void NetworkEmulatorBeaconStop( void );
+
+/*!
+ * \brief Gets the emulator counters
+ *
+ * \param [OUT] stats Emulator counters
+ */
+void NetworkEmulatorGetStats( NetworkEmulatorStats_t *stats );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __NETWORK_EMULATOR_H__
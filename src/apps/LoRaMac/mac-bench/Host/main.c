@@ -0,0 +1,901 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Benchmarks the MAC stack against an emulated network server
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+
+/*! \file mac-bench/Host/main.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utilities.h"
+#include "board.h"
+#include "board-config.h"
+
+#include "Commissioning.h"
+#include "LmHandler.h"
+#include "LmhpCompliance.h"
+#include "LmhpFragmentation.h"
+#include "FragDecoder.h"
+#include "NetworkEmulator.h"
+
+#ifndef ACTIVE_REGION
+
+#warning "No active region defined, LORAMAC_REGION_EU868 will be used as default."
+
+#define ACTIVE_REGION LORAMAC_REGION_EU868
+
+#endif
+
+/*!
+ * Number of operations measured per benchmark
+ */
+#ifndef MAC_BENCH_ITERATIONS
+#define MAC_BENCH_ITERATIONS                        100
+#endif
+
+/*!
+ * Number of Class B beacon periods measured
+ */
+#ifndef MAC_BENCH_BEACON_PERIODS
+#define MAC_BENCH_BEACON_PERIODS                    10
+#endif
+
+/*!
+ * Virtual time after which an operation is reported as failed [ms]
+ */
+#define MAC_BENCH_OP_TIMEOUT                        600000
+
+/*!
+ * Device address and network identifier assigned by the emulated network
+ */
+#define MAC_BENCH_DEV_ADDR                          0x26011F2A
+#define MAC_BENCH_NET_ID                            0x000013
+
+/*!
+ * Uplinks and downlinks application port and payload size
+ */
+#define MAC_BENCH_APP_PORT                          2
+#define MAC_BENCH_APP_DATA_SIZE                     16
+
+/*!
+ * Fragmented file transported by the FUOTA benchmark. 1 uncoded fragment
+ * out of MAC_BENCH_FRAG_LOSS_PERIOD is not sent, the coded fragments
+ * recover them.
+ */
+#define MAC_BENCH_FRAG_NB                           100
+#define MAC_BENCH_FRAG_SIZE                         48
+#define MAC_BENCH_FRAG_PER_DOWNLINK                 4
+#define MAC_BENCH_FRAG_LOSS_PERIOD                  10
+
+#if( MAC_BENCH_FRAG_NB > FRAG_MAX_NB ) || ( MAC_BENCH_FRAG_SIZE > FRAG_MAX_SIZE ) || \
+   ( ( MAC_BENCH_FRAG_NB / MAC_BENCH_FRAG_LOSS_PERIOD ) > FRAG_MAX_REDUNDANCY )
+#error "The FragDecoder limits are too small for the FUOTA benchmark"
+#endif
+
+/*!
+ * LoRaWAN application data buffer size
+ */
+#define LORAWAN_APP_DATA_BUFFER_MAX_SIZE            242
+
+/*!
+ * Benchmarked operations
+ */
+typedef enum eMacBenchPhases
+{
+    /*!
+     * Join request and join accept
+     */
+    MAC_BENCH_PHASE_JOIN,
+    /*!
+     * Unconfirmed uplink without downlink
+     */
+    MAC_BENCH_PHASE_UPLINK,
+    /*!
+     * Confirmed uplink and its acknowledge carrying application data
+     */
+    MAC_BENCH_PHASE_DOWNLINK,
+    /*!
+     * Uplink and a port 0 downlink full of MAC commands, then the uplink
+     * carrying the answers
+     */
+    MAC_BENCH_PHASE_MAC_COMMANDS,
+    /*!
+     * Uplink and a downlink carrying MAC_BENCH_FRAG_PER_DOWNLINK fragments
+     */
+    MAC_BENCH_PHASE_FUOTA,
+    /*!
+     * Switch to Class B, device time, beacon acquisition and ping slot setup
+     */
+    MAC_BENCH_PHASE_CLASS_B_SWITCH,
+    /*!
+     * Class B beacon period with the ping slots opened
+     */
+    MAC_BENCH_PHASE_CLASS_B,
+    MAC_BENCH_PHASE_NB,
+}MacBenchPhases_t;
+
+/*!
+ * Measurements of a benchmarked operation
+ */
+typedef struct sMacBenchResult
+{
+    /*!
+     * Operation name
+     */
+    const char* Name;
+    /*!
+     * Application payload bytes transported by an operation
+     */
+    uint16_t Size;
+    /*!
+     * Number of operations to measure
+     */
+    uint32_t Iterations;
+    /*!
+     * Number of measured operations
+     */
+    uint32_t Count;
+    /*!
+     * Number of failed operations
+     */
+    uint32_t Errors;
+    /*!
+     * Operation processing times [ns]
+     */
+    uint64_t Min;
+    uint64_t Max;
+    uint64_t Sum;
+}MacBenchResult_t;
+
+static MacBenchResult_t Results[MAC_BENCH_PHASE_NB] =
+{
+    [MAC_BENCH_PHASE_JOIN]           = { .Name = "join",                  .Size = 0,                       .Iterations = MAC_BENCH_ITERATIONS },
+    [MAC_BENCH_PHASE_UPLINK]         = { .Name = "uplink",                .Size = MAC_BENCH_APP_DATA_SIZE, .Iterations = MAC_BENCH_ITERATIONS },
+    [MAC_BENCH_PHASE_DOWNLINK]       = { .Name = "confirmed_downlink",    .Size = MAC_BENCH_APP_DATA_SIZE, .Iterations = MAC_BENCH_ITERATIONS },
+    [MAC_BENCH_PHASE_MAC_COMMANDS]   = { .Name = "mac_commands",          .Size = 0,                       .Iterations = MAC_BENCH_ITERATIONS },
+    [MAC_BENCH_PHASE_FUOTA]          = { .Name = "fuota_fragments",       .Size = MAC_BENCH_FRAG_PER_DOWNLINK * MAC_BENCH_FRAG_SIZE,
+                                         .Iterations = MAC_BENCH_FRAG_NB },
+    [MAC_BENCH_PHASE_CLASS_B_SWITCH] = { .Name = "class_b_switch",        .Size = 0,                       .Iterations = 1 },
+    [MAC_BENCH_PHASE_CLASS_B]        = { .Name = "class_b_beacon_period", .Size = 0,                       .Iterations = MAC_BENCH_BEACON_PERIODS },
+};
+
+/*!
+ * MAC commands sent by the MAC commands benchmark. The channels, datarate
+ * and receive windows settings are kept so that every iteration runs the
+ * same way.
+ */
+static const uint8_t MacCommandsStorm[] =
+{
+    // NewChannelReq 3 to 7, 867.1 to 867.9 MHz, DR0 to DR5
+    0x07, 0x03, 0x18, 0x4E, 0x84, 0x50,
+    0x07, 0x04, 0xE8, 0x56, 0x84, 0x50,
+    0x07, 0x05, 0xB8, 0x5E, 0x84, 0x50,
+    0x07, 0x06, 0x88, 0x66, 0x84, 0x50,
+    0x07, 0x07, 0x58, 0x6E, 0x84, 0x50,
+    // LinkADRReq DR5, max power, channels 0 to 7, 1 transmission
+    0x03, 0x50, 0xFF, 0x00, 0x01,
+    // DutyCycleReq no limit
+    0x04, 0x00,
+    // RXParamSetupReq default RX1 offset and RX2 869.525 MHz DR0
+    0x05, 0x00, 0xD2, 0xAD, 0x84,
+    // DevStatusReq
+    0x06, 0x06, 0x06, 0x06,
+    // RXTimingSetupReq 1 s
+    0x08, 0x01,
+    // DlChannelReq channel 3 downlinks on the uplink frequency
+    0x0A, 0x03, 0x18, 0x4E, 0x84,
+};
+
+/*!
+ * FragSessionSetupReq, session 0 in multicast group 0, no block ack delay
+ */
+static const uint8_t FragSessionSetupReq[] =
+{
+    0x02, 0x01, MAC_BENCH_FRAG_NB & 0xFF, MAC_BENCH_FRAG_NB >> 8, MAC_BENCH_FRAG_SIZE, 0x00, 0x00, 0x04, 0x03, 0x02, 0x01
+};
+
+/*!
+ * User application data
+ */
+static uint8_t AppDataBuffer[LORAWAN_APP_DATA_BUFFER_MAX_SIZE];
+
+/*!
+ * Uplinks content
+ */
+static uint8_t UplinkData[MAC_BENCH_APP_DATA_SIZE];
+
+/*!
+ * File sent by the FUOTA benchmark and file rebuilt by the fragmentation package
+ */
+static uint8_t FuotaFile[MAC_BENCH_FRAG_NB * MAC_BENCH_FRAG_SIZE];
+static uint8_t FuotaRxFile[MAC_BENCH_FRAG_NB * MAC_BENCH_FRAG_SIZE];
+
+static void OnMacProcessNotify( void );
+static void OnNvmContextChange( LmHandlerNvmContextStates_t state );
+static void OnNetworkParametersChange( CommissioningParams_t* params );
+static void OnMacMcpsRequest( LoRaMacStatus_t status, McpsReq_t *mcpsReq, TimerTime_t nextTxIn );
+static void OnMacMlmeRequest( LoRaMacStatus_t status, MlmeReq_t *mlmeReq, TimerTime_t nextTxIn );
+static void OnJoinRequest( LmHandlerJoinParams_t* params );
+static void OnTxData( LmHandlerTxParams_t* params );
+static void OnRxData( LmHandlerAppData_t* appData, LmHandlerRxParams_t* params );
+static void OnClassChange( DeviceClass_t deviceClass );
+static void OnBeaconStatusChange( LoRaMAcHandlerBeaconParams_t* params );
+static void OnSysTimeUpdate( bool isSynchronized, int32_t timeCorrection );
+
+static uint8_t FragDecoderWrite( uint32_t addr, uint8_t *data, uint32_t size );
+static uint8_t FragDecoderRead( uint32_t addr, uint8_t *data, uint32_t size );
+static void OnFragProgress( uint16_t fragCounter, uint16_t fragNb, uint8_t fragSize, uint16_t fragNbLost );
+static void OnFragDone( int32_t status, uint32_t size );
+
+/*!
+ * Function executed on OpTimer event
+ */
+static void OnOpTimerEvent( void* context );
+
+static LmHandlerCallbacks_t LmHandlerCallbacks =
+{
+    .GetBatteryLevel = BoardGetBatteryLevel,
+    .GetTemperature = NULL,
+    .GetUniqueId = BoardGetUniqueId,
+    .GetRandomSeed = BoardGetRandomSeed,
+    .OnMacProcess = OnMacProcessNotify,
+    .OnNvmContextChange = OnNvmContextChange,
+    .OnNetworkParametersChange = OnNetworkParametersChange,
+    .OnMacMcpsRequest = OnMacMcpsRequest,
+    .OnMacMlmeRequest = OnMacMlmeRequest,
+    .OnJoinRequest = OnJoinRequest,
+    .OnTxData = OnTxData,
+    .OnRxData = OnRxData,
+    .OnClassChange= OnClassChange,
+    .OnBeaconStatusChange = OnBeaconStatusChange,
+    .OnSysTimeUpdate = OnSysTimeUpdate
+};
+
+static LmHandlerParams_t LmHandlerParams =
+{
+    .Region = ACTIVE_REGION,
+    .AdrEnable = LORAMAC_HANDLER_ADR_OFF,
+    .TxDatarate = DR_5,
+    .PublicNetworkEnable = LORAWAN_PUBLIC_NETWORK,
+    .DutyCycleEnabled = false,
+    .DataBufferMaxSize = LORAWAN_APP_DATA_BUFFER_MAX_SIZE,
+    .DataBuffer = AppDataBuffer
+};
+
+static LmhpComplianceParams_t LmhpComplianceParams =
+{
+    .AdrEnabled = LORAMAC_HANDLER_ADR_OFF,
+    .DutyCycleEnabled = false,
+    .StopPeripherals = NULL,
+    .StartPeripherals = NULL,
+};
+
+static LmhpFragmentationParams_t FragmentationParams =
+{
+    .DecoderCallbacks =
+    {
+        .FragDecoderWrite = FragDecoderWrite,
+        .FragDecoderRead = FragDecoderRead,
+    },
+    .OnProgress = OnFragProgress,
+    .OnDone = OnFragDone
+};
+
+/*!
+ * Indicates if LoRaMacProcess call is pending.
+ *
+ * \warning If variable is equal to 0 then the MCU can be set in low power mode
+ */
+static volatile uint8_t IsMacProcessPending = 0;
+
+/*!
+ * Benchmark in progress
+ */
+static MacBenchPhases_t Phase = MAC_BENCH_PHASE_JOIN;
+
+/*!
+ * Operation in progress state
+ */
+static bool IsOpRunning = false;
+static bool IsOpDone = false;
+static bool IsOpOk = false;
+static uint8_t OpDownlinks = 0;
+
+/*!
+ * Host and emulator times at the start of the operation [ns]
+ */
+static uint64_t OpStartTime;
+static uint64_t OpStartEmulatorTime;
+
+/*!
+ * Timer reporting the operations which don't complete
+ */
+static TimerEvent_t OpTimer;
+
+/*!
+ * Next uncoded, then coded, fragment sent by the FUOTA benchmark
+ */
+static uint16_t FragCounter = 1;
+
+/*!
+ * FUOTA session state
+ */
+static bool IsFuotaSetupSent = false;
+static bool IsFuotaDone = false;
+
+/*!
+ * Virtual and host times at the start of the run
+ */
+static SysTime_t RunStartTime;
+static uint64_t RunStartHostTime;
+
+/*!
+ * \brief Reads the host monotonic clock
+ *
+ * \retval time Host time [ns]
+ */
+static uint64_t HostTimeGet( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( ( uint64_t )now.tv_sec * 1000000000 ) + now.tv_nsec;
+}
+
+/*!
+ * \brief Gets the host time spent in the network emulator
+ *
+ * \retval time Emulator processing time [ns]
+ */
+static uint64_t EmulatorTimeGet( void )
+{
+    NetworkEmulatorStats_t stats;
+
+    NetworkEmulatorGetStats( &stats );
+    return stats.ProcessingTime;
+}
+
+static void OpStart( void )
+{
+    IsOpRunning = true;
+    IsOpDone = false;
+    IsOpOk = true;
+    OpDownlinks = 0;
+    TimerStart( &OpTimer );
+    OpStartEmulatorTime = EmulatorTimeGet( );
+    OpStartTime = HostTimeGet( );
+}
+
+static void OpStop( void )
+{
+    uint64_t elapsed = HostTimeGet( ) - OpStartTime;
+    MacBenchResult_t *result = &Results[Phase];
+
+    // The network side doesn't belong to the end-device processing
+    elapsed -= EmulatorTimeGet( ) - OpStartEmulatorTime;
+    TimerStop( &OpTimer );
+    IsOpRunning = false;
+
+    if( IsOpOk == false )
+    {
+        result->Errors++;
+        return;
+    }
+    if( ( result->Count == 0 ) || ( elapsed < result->Min ) )
+    {
+        result->Min = elapsed;
+    }
+    if( elapsed > result->Max )
+    {
+        result->Max = elapsed;
+    }
+    result->Sum += elapsed;
+    result->Count++;
+}
+
+/*!
+ * \brief Moves to the next benchmark once enough operations are measured
+ *
+ * \remark Stops the whole run when the failures outnumber the operations
+ */
+static void PhaseUpdate( void )
+{
+    MacBenchResult_t *result = &Results[Phase];
+
+    if( result->Errors > result->Iterations )
+    {
+        Phase = MAC_BENCH_PHASE_NB;
+    }
+    else if( ( result->Count >= result->Iterations ) ||
+             ( ( Phase == MAC_BENCH_PHASE_FUOTA ) && ( IsFuotaDone == true ) ) )
+    {
+        Phase++;
+    }
+}
+
+/*!
+ * \brief Sends the next uplink of the benchmark
+ *
+ * \param [IN] isTxConfirmed Uplink type
+ * \param [IN] port          Downlink port
+ * \param [IN] downlink      Downlink answering the uplink, NULL when none
+ * \param [IN] size          Downlink size
+ */
+static void UplinkSend( LmHandlerMsgTypes_t isTxConfirmed, uint8_t port, const uint8_t *downlink, uint8_t size )
+{
+    LmHandlerAppData_t appData =
+    {
+        .Buffer = UplinkData,
+        .BufferSize = sizeof( UplinkData ),
+        .Port = MAC_BENCH_APP_PORT
+    };
+
+    OpStart( );
+    if( LmHandlerSend( &appData, isTxConfirmed ) != LORAMAC_HANDLER_SUCCESS )
+    {
+        IsOpOk = false;
+        OpStop( );
+        return;
+    }
+    UplinkData[0]++;
+
+    // The uplink is on its way, the downlink answers it
+    if( downlink != NULL )
+    {
+        NetworkEmulatorSetDownlink( port, downlink, size );
+    }
+}
+
+/*!
+ * \brief Builds the fragments of a FUOTA downlink
+ *
+ * \remark The coded fragments follow the LoRaWAN fragmented data block
+ *         transport parity matrix
+ *
+ * \param [OUT] buffer Downlink payload
+ * \retval size        Downlink payload size
+ */
+static uint8_t FuotaDownlinkBuild( uint8_t *buffer )
+{
+    uint8_t size = 0;
+
+    while( size < ( MAC_BENCH_FRAG_PER_DOWNLINK * ( MAC_BENCH_FRAG_SIZE + 3 ) ) )
+    {
+        uint16_t counter = FragCounter++;
+        uint8_t *data = &buffer[size + 3];
+
+        if( ( counter <= MAC_BENCH_FRAG_NB ) && ( ( counter % MAC_BENCH_FRAG_LOSS_PERIOD ) == 0 ) )
+        {
+            // Lost on the air
+            continue;
+        }
+
+        buffer[size] = 0x08;
+        buffer[size + 1] = counter & 0xFF;
+        buffer[size + 2] = ( counter >> 8 ) & 0x3F;
+        if( counter <= MAC_BENCH_FRAG_NB )
+        {
+            memcpy1( data, &FuotaFile[( counter - 1 ) * MAC_BENCH_FRAG_SIZE], MAC_BENCH_FRAG_SIZE );
+        }
+        else
+        {
+            uint32_t modulus = MAC_BENCH_FRAG_NB + ( ( ( MAC_BENCH_FRAG_NB & ( MAC_BENCH_FRAG_NB - 1 ) ) == 0 ) ? 1 : 0 );
+            int32_t x = 1 + ( 1001 * ( counter - MAC_BENCH_FRAG_NB ) );
+            bool row[MAC_BENCH_FRAG_NB] = { false };
+
+            for( uint16_t i = 0; i < ( MAC_BENCH_FRAG_NB >> 1 ); i++ )
+            {
+                uint32_t r;
+
+                do
+                {
+                    x = ( x >> 1 ) + ( ( ( x & 0x01 ) ^ ( ( x & 0x20 ) >> 5 ) ) << 22 );
+                    r = ( uint32_t )x % modulus;
+                } while( r >= MAC_BENCH_FRAG_NB );
+                row[r] = true;
+            }
+            memset1( data, 0, MAC_BENCH_FRAG_SIZE );
+            for( uint16_t i = 0; i < MAC_BENCH_FRAG_NB; i++ )
+            {
+                if( row[i] == true )
+                {
+                    for( uint8_t j = 0; j < MAC_BENCH_FRAG_SIZE; j++ )
+                    {
+                        data[j] ^= FuotaFile[( i * MAC_BENCH_FRAG_SIZE ) + j];
+                    }
+                }
+            }
+        }
+        size += MAC_BENCH_FRAG_SIZE + 3;
+    }
+    return size;
+}
+
+/*!
+ * \brief Starts the next operation once the previous one is over
+ */
+static void MacBenchProcess( void )
+{
+    static uint8_t downlink[NETWORK_EMULATOR_DOWNLINK_MAX_SIZE];
+
+    if( IsOpRunning == true )
+    {
+        // Let the MAC close the receive windows before measuring
+        if( ( Phase == MAC_BENCH_PHASE_CLASS_B ) || ( IsOpDone == false ) || ( LoRaMacIsBusy( ) == true ) )
+        {
+            return;
+        }
+        if( ( ( Phase == MAC_BENCH_PHASE_MAC_COMMANDS ) || ( Phase == MAC_BENCH_PHASE_FUOTA ) ) && ( OpDownlinks == 0 ) )
+        {
+            IsOpOk = false;
+        }
+        OpStop( );
+        PhaseUpdate( );
+    }
+    if( LoRaMacIsBusy( ) == true )
+    {
+        return;
+    }
+
+    switch( Phase )
+    {
+        case MAC_BENCH_PHASE_JOIN:
+        {
+            OpStart( );
+            LmHandlerJoin( );
+            break;
+        }
+        case MAC_BENCH_PHASE_UPLINK:
+        {
+            UplinkSend( LORAMAC_HANDLER_UNCONFIRMED_MSG, 0, NULL, 0 );
+            break;
+        }
+        case MAC_BENCH_PHASE_DOWNLINK:
+        {
+            UplinkSend( LORAMAC_HANDLER_CONFIRMED_MSG, MAC_BENCH_APP_PORT, UplinkData, sizeof( UplinkData ) );
+            break;
+        }
+        case MAC_BENCH_PHASE_MAC_COMMANDS:
+        {
+            UplinkSend( LORAMAC_HANDLER_UNCONFIRMED_MSG, 0, MacCommandsStorm, sizeof( MacCommandsStorm ) );
+            break;
+        }
+        case MAC_BENCH_PHASE_FUOTA:
+        {
+            if( LmhpFragmentationPackageFactory( )->IsRunning( ) == false )
+            {
+                Phase = MAC_BENCH_PHASE_NB;
+            }
+            else if( IsFuotaSetupSent == false )
+            {
+                // The fragments follow the session setup. Its answer is
+                // part of the first operation.
+                UplinkSend( LORAMAC_HANDLER_UNCONFIRMED_MSG, LmhpFragmentationPackageFactory( )->Port, FragSessionSetupReq, sizeof( FragSessionSetupReq ) );
+                IsFuotaSetupSent = true;
+            }
+            else
+            {
+                uint8_t size = FuotaDownlinkBuild( downlink );
+                UplinkSend( LORAMAC_HANDLER_UNCONFIRMED_MSG, LmhpFragmentationPackageFactory( )->Port, downlink, size );
+            }
+            break;
+        }
+        case MAC_BENCH_PHASE_CLASS_B_SWITCH:
+        {
+            LmHandlerAppData_t appData =
+            {
+                .Buffer = NULL,
+                .BufferSize = 0,
+                .Port = 0
+            };
+
+            NetworkEmulatorBeaconStart( );
+            OpStart( );
+            LmHandlerRequestClass( CLASS_B );
+            // The DeviceTimeReq goes with the next uplink
+            LmHandlerSend( &appData, LORAMAC_HANDLER_UNCONFIRMED_MSG );
+            break;
+        }
+        case MAC_BENCH_PHASE_CLASS_B:
+        default:
+        {
+            // Measured from beacon to beacon
+            break;
+        }
+    }
+}
+
+static void ResultsPrint( void )
+{
+    NetworkEmulatorStats_t stats;
+    int status = EXIT_SUCCESS;
+
+    for( uint8_t i = 0; i < MAC_BENCH_PHASE_NB; i++ )
+    {
+        MacBenchResult_t *result = &Results[i];
+
+        if( result->Count > 0 )
+        {
+            uint64_t avg = result->Sum / result->Count;
+
+            printf( "bench,ns,%s,%u,%lu,%llu,%llu,%llu,%llu\r\n", result->Name, result->Size, ( unsigned long )result->Count,
+                    ( unsigned long long )result->Min, ( unsigned long long )avg, ( unsigned long long )result->Max,
+                    ( unsigned long long )( ( avg > 0 ) ? ( 1000000000ULL / avg ) : 0 ) );
+        }
+        // The FUOTA benchmark ends with the file transfer
+        bool isComplete = ( result->Count >= result->Iterations ) || ( ( i == MAC_BENCH_PHASE_FUOTA ) && ( IsFuotaDone == true ) );
+        if( ( result->Errors > 0 ) || ( isComplete == false ) )
+        {
+            printf( "bench,ns,%s,%u,error,%lu\r\n", result->Name, result->Size, ( unsigned long )result->Errors );
+            status = EXIT_FAILURE;
+        }
+    }
+
+    // Virtual time simulated and host time spent by the whole run
+    SysTime_t runTime = SysTimeSub( SysTimeGetMcuTime( ), RunStartTime );
+    uint64_t runVirtualTime = ( ( uint64_t )runTime.Seconds * 1000 ) + runTime.SubSeconds;
+    uint64_t runHostTime = ( HostTimeGet( ) - RunStartHostTime ) / 1000000;
+    printf( "bench,time,%llu,%llu,%llu\r\n", ( unsigned long long )runVirtualTime, ( unsigned long long )runHostTime,
+            ( unsigned long long )( runVirtualTime / MAX( runHostTime, 1 ) ) );
+
+    NetworkEmulatorGetStats( &stats );
+    printf( "bench,network,%lu,%lu,%lu,%lu,%lu,%lu\r\n", ( unsigned long )stats.NbJoinRequests, ( unsigned long )stats.NbUplinks,
+            ( unsigned long )stats.NbMacCommands, ( unsigned long )stats.NbDownlinks, ( unsigned long )stats.NbBeacons,
+            ( unsigned long )stats.NbDropped );
+    printf( "bench,end\r\n" );
+    exit( status );
+}
+
+/*!
+ * Main application entry point.
+ */
+int main( void )
+{
+    const uint8_t nwkKey[] = LORAWAN_NWK_KEY;
+
+    // Every run starts from a blank end-device
+    remove( HOST_EEPROM_FILE );
+
+    BoardInitMcu( );
+    BoardInitPeriph( );
+
+    for( uint16_t i = 0; i < sizeof( FuotaFile ); i++ )
+    {
+        FuotaFile[i] = randr( 0, 255 );
+    }
+
+    TimerInit( &OpTimer, OnOpTimerEvent );
+    TimerSetValue( &OpTimer, MAC_BENCH_OP_TIMEOUT );
+
+    NetworkEmulatorInit( nwkKey, MAC_BENCH_NET_ID, MAC_BENCH_DEV_ADDR );
+
+    RunStartTime = SysTimeGetMcuTime( );
+    RunStartHostTime = HostTimeGet( );
+
+    if ( LmHandlerInit( &LmHandlerCallbacks, &LmHandlerParams ) != LORAMAC_HANDLER_SUCCESS )
+    {
+        printf( "LoRaMac wasn't properly initialized\r\n" );
+        return EXIT_FAILURE;
+    }
+
+    LmHandlerPackageRegister( PACKAGE_ID_COMPLIANCE, &LmhpComplianceParams );
+    LmHandlerPackageRegister( PACKAGE_ID_FRAGMENTATION, &FragmentationParams );
+
+    while( Phase < MAC_BENCH_PHASE_NB )
+    {
+        // Processes the LoRaMac events
+        LmHandlerProcess( );
+
+        MacBenchProcess( );
+
+        // Tick the RTC to execute callback in context of the main loop (in stead of the IRQ)
+        TimerProcess( );
+
+        CRITICAL_SECTION_BEGIN( );
+        if( IsMacProcessPending == 1 )
+        {
+            // Clear flag and prevent MCU to go into low power modes.
+            IsMacProcessPending = 0;
+        }
+        else
+        {
+            // The MCU wakes up through events
+            BoardLowPowerHandler( );
+        }
+        CRITICAL_SECTION_END( );
+    }
+
+    ResultsPrint( );
+    return EXIT_SUCCESS;
+}
+
+static void OnMacProcessNotify( void )
+{
+    IsMacProcessPending = 1;
+}
+
+static void OnNvmContextChange( LmHandlerNvmContextStates_t state )
+{
+}
+
+static void OnNetworkParametersChange( CommissioningParams_t* params )
+{
+}
+
+static void OnMacMcpsRequest( LoRaMacStatus_t status, McpsReq_t *mcpsReq, TimerTime_t nextTxIn )
+{
+}
+
+static void OnMacMlmeRequest( LoRaMacStatus_t status, MlmeReq_t *mlmeReq, TimerTime_t nextTxIn )
+{
+}
+
+static void OnJoinRequest( LmHandlerJoinParams_t* params )
+{
+    if( ( Phase != MAC_BENCH_PHASE_JOIN ) || ( IsOpRunning == false ) )
+    {
+        return;
+    }
+    if( params->Status == LORAMAC_HANDLER_ERROR )
+    {
+        IsOpOk = false;
+    }
+    IsOpDone = true;
+}
+
+static void OnTxData( LmHandlerTxParams_t* params )
+{
+    if( ( params->IsMcpsConfirm == 0 ) || ( IsOpRunning == false ) || ( IsOpDone == true ) )
+    {
+        return;
+    }
+    switch( Phase )
+    {
+        case MAC_BENCH_PHASE_DOWNLINK:
+        {
+            if( params->AckReceived == 0 )
+            {
+                IsOpOk = false;
+            }
+            IsOpDone = true;
+            break;
+        }
+        case MAC_BENCH_PHASE_UPLINK:
+        case MAC_BENCH_PHASE_MAC_COMMANDS:
+        case MAC_BENCH_PHASE_FUOTA:
+        {
+            IsOpDone = true;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+static void OnRxData( LmHandlerAppData_t* appData, LmHandlerRxParams_t* params )
+{
+    if( ( appData != NULL ) && ( params->IsMcpsIndication == 1 ) && ( params->Status == LORAMAC_EVENT_INFO_STATUS_OK ) )
+    {
+        OpDownlinks++;
+    }
+}
+
+static void OnClassChange( DeviceClass_t deviceClass )
+{
+    if( ( deviceClass == CLASS_B ) && ( Phase == MAC_BENCH_PHASE_CLASS_B_SWITCH ) )
+    {
+        IsOpDone = true;
+    }
+}
+
+static void OnBeaconStatusChange( LoRaMAcHandlerBeaconParams_t* params )
+{
+    if( Phase != MAC_BENCH_PHASE_CLASS_B )
+    {
+        return;
+    }
+    switch( params->State )
+    {
+        case LORAMAC_HANDLER_BEACON_RX:
+        {
+            if( IsOpRunning == true )
+            {
+                OpStop( );
+                PhaseUpdate( );
+            }
+            if( Phase == MAC_BENCH_PHASE_CLASS_B )
+            {
+                OpStart( );
+            }
+            break;
+        }
+        case LORAMAC_HANDLER_BEACON_LOST:
+        case LORAMAC_HANDLER_BEACON_NRX:
+        {
+            IsOpOk = false;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+}
+
+static void OnSysTimeUpdate( bool isSynchronized, int32_t timeCorrection )
+{
+}
+
+static uint8_t FragDecoderWrite( uint32_t addr, uint8_t *data, uint32_t size )
+{
+    if( ( addr + size ) > sizeof( FuotaRxFile ) )
+    {
+        return -1; // Fail
+    }
+    memcpy1( &FuotaRxFile[addr], data, size );
+    return 0; // Success
+}
+
+static uint8_t FragDecoderRead( uint32_t addr, uint8_t *data, uint32_t size )
+{
+    if( ( addr + size ) > sizeof( FuotaRxFile ) )
+    {
+        return -1; // Fail
+    }
+    memcpy1( data, &FuotaRxFile[addr], size );
+    return 0; // Success
+}
+
+static void OnFragProgress( uint16_t fragCounter, uint16_t fragNb, uint8_t fragSize, uint16_t fragNbLost )
+{
+}
+
+static void OnFragDone( int32_t status, uint32_t size )
+{
+    IsFuotaDone = true;
+    if( ( size != sizeof( FuotaFile ) ) || ( memcmp( FuotaRxFile, FuotaFile, sizeof( FuotaFile ) ) != 0 ) )
+    {
+        Results[MAC_BENCH_PHASE_FUOTA].Errors++;
+    }
+}
+
+static void OnOpTimerEvent( void* context )
+{
+    TimerStop( &OpTimer );
+
+    // The operation never completed
+    IsOpOk = false;
+    if( Phase == MAC_BENCH_PHASE_CLASS_B )
+    {
+        OpStop( );
+        PhaseUpdate( );
+        if( Phase == MAC_BENCH_PHASE_CLASS_B )
+        {
+            OpStart( );
+        }
+    }
+    else
+    {
+        IsOpDone = true;
+    }
+}
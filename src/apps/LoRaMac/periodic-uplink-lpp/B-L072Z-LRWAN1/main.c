@@ -24,10 +24,12 @@
 #include <stdio.h>
 #include "utilities.h"
 #include "board.h"
+#include "lpm-board.h"
 #include "gpio.h"
 
 #include "Commissioning.h"
 #include "LmHandler.h"
+#include "NvmCtxMgmt.h"
 #include "LmhpCompliance.h"
 #include "CayenneLpp.h"
 #include "LmHandlerMsgDisplay.h"
@@ -300,6 +302,11 @@ int main( void )
         }
         else
         {
+            // The RAM content is lost in OFF mode, store the deferred contexts changes first
+            if( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) == LPM_OFF_MODE )
+            {
+                NvmCtxMgmtFlush( );
+            }
             // The MCU wakes up through events
             BoardLowPowerHandler( );
         }
@@ -420,6 +427,18 @@ static void PrepareTxFrame( void )
         return;
     }
 
+    // Read the sensors at the uplink opportunity only. Until the duty-cycle
+    // allows it they would be read again for a frame the MAC rejects.
+    TimerTime_t nextTxIn = LmHandlerGetNextTxDelay( AppData.BufferSize );
+    if( nextTxIn != 0 )
+    {
+        // Wake up at the opportunity, the period restarts from there
+        TimerStop( &TxTimer );
+        TimerSetValue( &TxTimer, nextTxIn );
+        TimerStart( &TxTimer );
+        return;
+    }
+
     uint8_t channel = 0;
 
     AppData.Port = LORAWAN_APP_PORT;
@@ -449,6 +468,9 @@ static void StartTxProcess( LmHandlerTxEvents_t txEvent )
         {
             // Schedule 1st packet transmission
             TimerInit( &TxTimer, OnTxTimerEvent );
+            TimerSetDeferred( &TxTimer, true );
+            // The uplink period is already randomized. Let it share wake ups.
+            TimerSetSlack( &TxTimer, APP_TX_DUTYCYCLE_RND );
             TimerSetValue( &TxTimer, APP_TX_DUTYCYCLE  + randr( -APP_TX_DUTYCYCLE_RND, APP_TX_DUTYCYCLE_RND ) );
             OnTxTimerEvent( NULL );
         }
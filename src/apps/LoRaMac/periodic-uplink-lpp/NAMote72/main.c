@@ -25,12 +25,14 @@
 #include "utilities.h"
 #include "board-config.h"
 #include "board.h"
+#include "lpm-board.h"
 #include "gpio.h"
 #include "gps.h"
 #include "mpl3115.h"
 
 #include "Commissioning.h"
 #include "LmHandler.h"
+#include "NvmCtxMgmt.h"
 #include "LmhpCompliance.h"
 #include "CayenneLpp.h"
 #include "LmHandlerMsgDisplay.h"
@@ -180,6 +182,12 @@ static void OnLed2TimerEvent( void* context );
  */
 static void OnLedBeaconTimerEvent( void* context );
 
+/*!
+ * Function executed when the MPL3115 conversion started after each uplink
+ * is done
+ */
+static void OnMpl3115ConversionDone( float pressure, float temperature );
+
 static LmHandlerCallbacks_t LmHandlerCallbacks =
 {
     .GetBatteryLevel = BoardGetBatteryLevel,
@@ -226,6 +234,12 @@ static volatile uint8_t IsMacProcessPending = 0;
 
 static volatile uint8_t IsTxFramePending = 0;
 
+/*!
+ * Latest MPL3115 measurements, sent by the next uplink
+ */
+static float AppTemperature = 0;
+static float AppPressure = 0;
+
 /*!
  * LED GPIO pins objects
  */
@@ -273,6 +287,9 @@ int main( void )
 
     StartTxProcess( LORAMAC_HANDLER_TX_ON_TIMER );
 
+    // The sensor conversion runs while the MCU sleeps
+    MPL3115StartConversion( MPL3115_CONVERSION_PRESSURE, OnMpl3115ConversionDone );
+
     while( 1 )
     {
         // Processes the LoRaMac events
@@ -281,6 +298,9 @@ int main( void )
         // Process application uplinks management
         UplinkProcess( );
 
+        // Process the sensor completed conversions
+        MPL3115Process( );
+
         CRITICAL_SECTION_BEGIN( );
         if( IsMacProcessPending == 1 )
         {
@@ -289,6 +309,11 @@ int main( void )
         }
         else
         {
+            // The RAM content is lost in OFF mode, store the deferred contexts changes first
+            if( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) == LPM_OFF_MODE )
+            {
+                NvmCtxMgmtFlush( );
+            }
             // The MCU wakes up through events
             BoardLowPowerHandler( );
         }
@@ -409,6 +434,18 @@ static void PrepareTxFrame( void )
         return;
     }
 
+    // Read the sensors at the uplink opportunity only. Until the duty-cycle
+    // allows it they would be read again for a frame the MAC rejects.
+    TimerTime_t nextTxIn = LmHandlerGetNextTxDelay( AppData.BufferSize );
+    if( nextTxIn != 0 )
+    {
+        // Wake up at the opportunity, the period restarts from there
+        TimerStop( &TxTimer );
+        TimerSetValue( &TxTimer, nextTxIn );
+        TimerStart( &TxTimer );
+        return;
+    }
+
 #if defined( REGION_US915 )
     MibRequestConfirm_t mibReq;
 
@@ -435,20 +472,22 @@ static void PrepareTxFrame( void )
     {
         CayenneLppAddDigitalInput( 0, AppLedStateOn );
         CayenneLppAddAnalogInput( 1, BoardGetBatteryLevel( ) * 100 / 254 );
-        CayenneLppAddTemperature( 2, MPL3115ReadTemperature( ) );
-        CayenneLppAddBarometricPressure( 3, MPL3115ReadPressure( ) / 100 );
+        CayenneLppAddTemperature( 2, AppTemperature );
+        CayenneLppAddBarometricPressure( 3, AppPressure / 100 );
+
+        // Measure for the next uplink
+        MPL3115StartConversion( MPL3115_CONVERSION_PRESSURE, OnMpl3115ConversionDone );
     }
     else
     {
         if( GpsHasFix( ) == true )
         {
-            double latitude = 0, longitude = 0;
-            uint16_t altitudeGps = 0xFFFF;
+            int32_t latitude = 0, longitude = 0;                          // in 1e-7 degree
+            int32_t altitudeGps = 0;                                      // in cm
 
-            GpsGetLatestGpsPositionDouble( &latitude, &longitude );
-            altitudeGps = GpsGetLatestGpsAltitude( );                     // in m
+            GpsGetLatestGpsPositionFixed( &latitude, &longitude, &altitudeGps );
 
-            CayenneLppAddGps( 4, latitude, longitude, altitudeGps );
+            CayenneLppAddGps( 4, latitude / 10000000.0f, longitude / 10000000.0f, altitudeGps / 100.0f );
         }
         else
         {
@@ -478,6 +517,9 @@ static void StartTxProcess( LmHandlerTxEvents_t txEvent )
         {
             // Schedule 1st packet transmission
             TimerInit( &TxTimer, OnTxTimerEvent );
+            TimerSetDeferred( &TxTimer, true );
+            // The uplink period is already randomized. Let it share wake ups.
+            TimerSetSlack( &TxTimer, APP_TX_DUTYCYCLE_RND );
             TimerSetValue( &TxTimer, APP_TX_DUTYCYCLE  + randr( -APP_TX_DUTYCYCLE_RND, APP_TX_DUTYCYCLE_RND ) );
             OnTxTimerEvent( NULL );
         }
@@ -546,3 +588,9 @@ static void OnLedBeaconTimerEvent( void* context )
 
     TimerStart( &LedBeaconTimer );
 }
+
+static void OnMpl3115ConversionDone( float pressure, float temperature )
+{
+    AppPressure = pressure;
+    AppTemperature = temperature;
+}
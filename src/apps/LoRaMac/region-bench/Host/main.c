@@ -0,0 +1,179 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Benchmarks the region modules and checks their traces against
+ *            the reference ones
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+
+/*! \file region-bench/Host/main.c */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "utilities.h"
+#include "board.h"
+#include "radio.h"
+
+#include "RegionBench.h"
+
+/*!
+ * Full trace output, NULL when not requested
+ */
+static FILE* TraceFile = NULL;
+
+static RadioEvents_t RadioEvents;
+
+/*!
+ * \brief Reads the host monotonic clock
+ *
+ * \retval time Host time [ns], wraps around
+ */
+static uint32_t HostTimeGet( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint32_t )( ( ( uint64_t )now.tv_sec * 1000000000 ) + now.tv_nsec );
+}
+
+static void OnTraceLine( const char* line )
+{
+    if( TraceFile != NULL )
+    {
+        fputs( line, TraceFile );
+    }
+}
+
+static RegionBenchCallbacks_t RegionBenchCallbacks =
+{
+    .GetCounter = HostTimeGet,
+    .OnTraceLine = OnTraceLine,
+};
+
+/*!
+ * \brief Prints the measurements of a region and checks its trace
+ *
+ * \param [IN] result Region measurements
+ * \retval status     false when the trace doesn't match the reference
+ */
+static bool ResultPrint( RegionBenchResult_t* result )
+{
+    const char* name = RegionBenchRegionName( result->Region );
+    uint32_t golden;
+    bool ok = true;
+
+    for( uint8_t i = 0; i < REGION_BENCH_OP_NB; i++ )
+    {
+        RegionBenchOpStats_t* stats = &result->Ops[i];
+
+        if( stats->Calls > 0 )
+        {
+            printf( "region-bench,ns,%s,%s,%lu,%lu,%llu,%lu\r\n", name, RegionBenchOpName( i ), ( unsigned long )stats->Calls,
+                    ( unsigned long )stats->Min, ( unsigned long long )( stats->Sum / stats->Calls ), ( unsigned long )stats->Max );
+        }
+    }
+
+    printf( "region-bench,trace,%s,%lu,%08lX,", name, ( unsigned long )result->TraceLines, ( unsigned long )result->Digest );
+    if( result->IsNonDeterministic == true )
+    {
+        printf( "non-deterministic\r\n" );
+        ok = false;
+    }
+    else if( RegionBenchGetGoldenDigest( result->Region, &golden ) == false )
+    {
+        printf( "no-reference\r\n" );
+    }
+    else if( golden != result->Digest )
+    {
+        printf( "mismatch,%08lX\r\n", ( unsigned long )golden );
+        ok = false;
+    }
+    else
+    {
+        printf( "ok\r\n" );
+    }
+    return ok;
+}
+
+/*!
+ * Main application entry point.
+ *
+ * \remark region-bench [--trace <file>] writes the full traces of the built
+ *         in regions to the given file. The CRC32 of the trace of a region is
+ *         its digest.
+ */
+int main( int argc, char* argv[] )
+{
+    RegionBenchResult_t result;
+    uint32_t nbCases;
+    uint32_t mismatches;
+    int status = EXIT_SUCCESS;
+
+    if( ( argc == 3 ) && ( strcmp( argv[1], "--trace" ) == 0 ) )
+    {
+        TraceFile = fopen( argv[2], "w" );
+        if( TraceFile == NULL )
+        {
+            printf( "Can't open %s\r\n", argv[2] );
+            return EXIT_FAILURE;
+        }
+    }
+    else if( argc != 1 )
+    {
+        printf( "Usage: %s [--trace <file>]\r\n", argv[0] );
+        return EXIT_FAILURE;
+    }
+
+    BoardInitMcu( );
+    BoardInitPeriph( );
+    Radio.Init( &RadioEvents );
+    Radio.Sleep( );
+
+    for( uint8_t region = 0; region < REGION_BENCH_NB_REGIONS; region++ )
+    {
+        if( RegionBenchRun( region, &RegionBenchCallbacks, &result ) == false )
+        {
+            printf( "region-bench,skip,%s\r\n", RegionBenchRegionName( region ) );
+            continue;
+        }
+        if( ResultPrint( &result ) == false )
+        {
+            status = EXIT_FAILURE;
+        }
+    }
+
+    mismatches = RegionBenchRxWindowCheck( &nbCases );
+    printf( "region-bench,rx_window,%lu,", ( unsigned long )nbCases );
+    if( mismatches == 0 )
+    {
+        printf( "ok\r\n" );
+    }
+    else
+    {
+        printf( "mismatch,%lu\r\n", ( unsigned long )mismatches );
+        status = EXIT_FAILURE;
+    }
+    printf( "region-bench,end\r\n" );
+
+    if( TraceFile != NULL )
+    {
+        fclose( TraceFile );
+    }
+    return status;
+}
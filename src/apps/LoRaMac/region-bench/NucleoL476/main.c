@@ -0,0 +1,150 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Benchmarks the region modules and checks their traces against
+ *            the reference ones
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+
+/*! \file region-bench/NucleoL476/main.c */
+
+#include <stdio.h>
+#include "stm32l4xx.h"
+#include "utilities.h"
+#include "board.h"
+#include "radio.h"
+
+#include "RegionBench.h"
+
+/*!
+ * Prints the full traces on the UART when set to 1. The traces of all the
+ * regions are several hundred kilobytes long.
+ */
+#ifndef REGION_BENCH_TRACE_OUTPUT
+#define REGION_BENCH_TRACE_OUTPUT                   0
+#endif
+
+static RadioEvents_t RadioEvents;
+
+/*!
+ * \brief Reads the Cortex-M4 cycle counter
+ *
+ * \retval cycles Elapsed CPU cycles, wraps around
+ */
+static uint32_t CyclesGet( void )
+{
+    return DWT->CYCCNT;
+}
+
+static void OnTraceLine( const char* line )
+{
+#if( REGION_BENCH_TRACE_OUTPUT == 1 )
+    printf( "%s", line );
+#endif
+}
+
+static RegionBenchCallbacks_t RegionBenchCallbacks =
+{
+    .GetCounter = CyclesGet,
+    .OnTraceLine = OnTraceLine,
+};
+
+static void ResultPrint( RegionBenchResult_t* result )
+{
+    const char* name = RegionBenchRegionName( result->Region );
+    uint32_t golden;
+
+    for( uint8_t i = 0; i < REGION_BENCH_OP_NB; i++ )
+    {
+        RegionBenchOpStats_t* stats = &result->Ops[i];
+
+        if( stats->Calls > 0 )
+        {
+            printf( "region-bench,cycles,%s,%s,%lu,%lu,%lu,%lu\r\n", name, RegionBenchOpName( i ), stats->Calls,
+                    stats->Min, ( uint32_t )( stats->Sum / stats->Calls ), stats->Max );
+        }
+    }
+
+    printf( "region-bench,trace,%s,%lu,%08lX,", name, result->TraceLines, result->Digest );
+    if( result->IsNonDeterministic == true )
+    {
+        printf( "non-deterministic\r\n" );
+    }
+    else if( RegionBenchGetGoldenDigest( result->Region, &golden ) == false )
+    {
+        printf( "no-reference\r\n" );
+    }
+    else if( golden != result->Digest )
+    {
+        // The listen before talk regions follow the carrier senses of the
+        // actual radio
+        printf( "mismatch,%08lX\r\n", golden );
+    }
+    else
+    {
+        printf( "ok\r\n" );
+    }
+}
+
+/*!
+ * Main application entry point.
+ */
+int main( void )
+{
+    RegionBenchResult_t result;
+    uint32_t nbCases;
+    uint32_t mismatches;
+
+    BoardInitMcu( );
+    BoardInitPeriph( );
+    Radio.Init( &RadioEvents );
+    Radio.Sleep( );
+
+    // Cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    for( uint8_t region = 0; region < REGION_BENCH_NB_REGIONS; region++ )
+    {
+        if( RegionBenchRun( region, &RegionBenchCallbacks, &result ) == true )
+        {
+            ResultPrint( &result );
+        }
+        else
+        {
+            printf( "region-bench,skip,%s\r\n", RegionBenchRegionName( region ) );
+        }
+    }
+
+    mismatches = RegionBenchRxWindowCheck( &nbCases );
+    printf( "region-bench,rx_window,%lu,", nbCases );
+    if( mismatches == 0 )
+    {
+        printf( "ok\r\n" );
+    }
+    else
+    {
+        printf( "mismatch,%lu\r\n", mismatches );
+    }
+    printf( "region-bench,end\r\n" );
+
+    while( 1 )
+    {
+        BoardLowPowerHandler( );
+    }
+}
@@ -0,0 +1,777 @@
+/*!
+ * \file      RegionBench.c
+ *
+ * \brief     Region modules micro-benchmark and equivalence trace
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdio.h>
+#include <stdarg.h>
+#include "utilities.h"
+#include "crc.h"
+#include "Region.h"
+#include "RegionCommon.h"
+#include "RegionBench.h"
+
+/*!
+ * Seed of the random generators, the region index is added
+ */
+#define REGION_BENCH_SEED                           0x5EED1234
+
+/*!
+ * Maximum number of LinkADRReq commands of a sequence
+ */
+#define REGION_BENCH_LINK_ADR_MAX_BLOCKS            6
+
+/*!
+ * LinkADRReq command identifier and size
+ */
+#define REGION_BENCH_LINK_ADR_REQ                   0x03
+#define REGION_BENCH_LINK_ADR_REQ_SIZE              5
+
+/*!
+ * Sequences between two restorations of the default channels
+ */
+#define REGION_BENCH_RESTORE_PERIOD                 64
+
+/*!
+ * Receive windows settings of the RxConfig calls
+ */
+#define REGION_BENCH_MIN_RX_SYMBOLS                 6
+#define REGION_BENCH_RX_ERROR                       10
+
+/*!
+ * Receive windows computation case and its expected results
+ */
+typedef struct sRegionBenchRxWindowCase
+{
+    uint8_t PhyDr;
+    /*!
+     * LoRa bandwidth [Hz], 0 for FSK
+     */
+    uint32_t Bandwidth;
+    uint8_t MinRxSymbols;
+    uint32_t RxError;
+    uint32_t WakeUpTime;
+    uint32_t WindowTimeout;
+    /*!
+     * Window offset [ms], result of the former implementation
+     */
+    int32_t WindowOffsetMs;
+    /*!
+     * Window offset [us], former implementation formula in microseconds
+     */
+    int32_t WindowOffset;
+}RegionBenchRxWindowCase_t;
+
+/*!
+ * Receive windows timeouts and offsets computed by the former floating point
+ * implementation of RegionCommonComputeRxWindowParameters, over the LoRaWAN
+ * datarates. The offsets are now computed in microseconds, rounded up they
+ * must still give the former milliseconds offsets.
+ */
+static const RegionBenchRxWindowCase_t RxWindowCases[] =
+{
+    // SF12, 125 kHz
+    { 12, 125000,  6,   10,  1,     6,    32,    31768 },
+    { 12, 125000,  8,    0,  0,     8,     0,        0 },
+    { 12, 125000,  6,   20,  5,     6,    28,    27768 },
+    { 12, 125000, 12,  100,  3,    23,  -248,  -248760 },
+    { 12, 125000,  4, 1000, 20,    62,  -904,  -904736 },
+    // SF11, 125 kHz
+    { 11, 125000,  6,   10,  1,     6,    16,    15384 },
+    { 11, 125000,  8,    0,  0,     8,     0,        0 },
+    { 11, 125000,  6,   20,  5,     7,     4,     3192 },
+    { 11, 125000, 12,  100,  3,    29,  -175,  -175032 },
+    { 11, 125000,  4, 1000, 20,   123,  -962,  -962080 },
+    // SF10, 125 kHz
+    { 10, 125000,  6,   10,  1,     7,     4,     3096 },
+    { 10, 125000,  8,    0,  0,     8,     0,        0 },
+    { 10, 125000,  6,   20,  5,     9,    -9,    -9096 },
+    { 10, 125000, 12,  100,  3,    41,  -138,  -138168 },
+    { 10, 125000,  4, 1000, 20,   245,  -990,  -990752 },
+    // SF9, 125 kHz
+    {  9, 125000,  6,   10,  1,     9,    -3,    -3048 },
+    {  9, 125000,  8,    0,  0,     8,     0,        0 },
+    {  9, 125000,  6,   20,  5,    14,   -17,   -17288 },
+    {  9, 125000, 12,  100,  3,    65,  -119,  -119736 },
+    {  9, 125000,  4, 1000, 20,   489, -1005, -1005088 },
+    // SF8, 125 kHz
+    {  8, 125000,  6,   10,  1,    14,    -7,    -7144 },
+    {  8, 125000,  8,    0,  0,     8,     0,        0 },
+    {  8, 125000,  6,   20,  5,    24,   -21,   -21384 },
+    {  8, 125000, 12,  100,  3,   114,  -111,  -111544 },
+    {  8, 125000,  4, 1000, 20,   977, -1012, -1012256 },
+    // SF7, 125 kHz
+    {  7, 125000,  6,   10,  1,    24,    -9,    -9192 },
+    {  7, 125000,  8,    0,  0,     8,     0,        0 },
+    {  7, 125000,  6,   20,  5,    44,   -23,   -23432 },
+    {  7, 125000, 12,  100,  3,   212,  -107,  -107448 },
+    {  7, 125000,  4, 1000, 20,  1954, -1016, -1016352 },
+    // SF7, 250 kHz
+    {  7, 250000,  6,   10,  1,    44,   -10,   -10216 },
+    {  7, 250000,  8,    0,  0,     8,     0,        0 },
+    {  7, 250000,  6,   20,  5,    83,   -24,   -24200 },
+    {  7, 250000, 12,  100,  3,   407,  -105,  -105144 },
+    {  7, 250000,  4, 1000, 20,  3907, -1018, -1018144 },
+    // SF12, 500 kHz
+    { 12, 500000,  6,   10,  1,     7,     4,     3096 },
+    { 12, 500000,  8,    0,  0,     8,     0,        0 },
+    { 12, 500000,  6,   20,  5,     9,    -9,    -9096 },
+    { 12, 500000, 12,  100,  3,    41,  -138,  -138168 },
+    { 12, 500000,  4, 1000, 20,   245,  -990,  -990752 },
+    // SF11, 500 kHz
+    { 11, 500000,  6,   10,  1,     9,    -3,    -3048 },
+    { 11, 500000,  8,    0,  0,     8,     0,        0 },
+    { 11, 500000,  6,   20,  5,    14,   -17,   -17288 },
+    { 11, 500000, 12,  100,  3,    65,  -119,  -119736 },
+    { 11, 500000,  4, 1000, 20,   489, -1005, -1005088 },
+    // SF10, 500 kHz
+    { 10, 500000,  6,   10,  1,    14,    -7,    -7144 },
+    { 10, 500000,  8,    0,  0,     8,     0,        0 },
+    { 10, 500000,  6,   20,  5,    24,   -21,   -21384 },
+    { 10, 500000, 12,  100,  3,   114,  -111,  -111544 },
+    { 10, 500000,  4, 1000, 20,   977, -1012, -1012256 },
+    // SF9, 500 kHz
+    {  9, 500000,  6,   10,  1,    24,    -9,    -9192 },
+    {  9, 500000,  8,    0,  0,     8,     0,        0 },
+    {  9, 500000,  6,   20,  5,    44,   -23,   -23432 },
+    {  9, 500000, 12,  100,  3,   212,  -107,  -107448 },
+    {  9, 500000,  4, 1000, 20,  1954, -1016, -1016352 },
+    // SF8, 500 kHz
+    {  8, 500000,  6,   10,  1,    44,   -10,   -10216 },
+    {  8, 500000,  8,    0,  0,     8,     0,        0 },
+    {  8, 500000,  6,   20,  5,    83,   -24,   -24200 },
+    {  8, 500000, 12,  100,  3,   407,  -105,  -105144 },
+    {  8, 500000,  4, 1000, 20,  3907, -1018, -1018144 },
+    // SF7, 500 kHz
+    {  7, 500000,  6,   10,  1,    83,   -10,   -10600 },
+    {  7, 500000,  8,    0,  0,     8,     0,        0 },
+    {  7, 500000,  6,   20,  5,   161,   -24,   -24584 },
+    {  7, 500000, 12,  100,  3,   798,  -104,  -104120 },
+    {  7, 500000,  4, 1000, 20,  7813, -1019, -1019040 },
+    // FSK, 50 kbps, bandwidth 0
+    { 50,      0,  6,   10,  1,   129,   -10,   -10680 },
+    { 50,      0,  8,    0,  0,     8,     0,        0 },
+    { 50,      0,  6,   20,  5,   254,   -24,   -24680 },
+    { 50,      0, 12,  100,  3,  1266,  -103,  -103640 },
+    { 50,      0,  4, 1000, 20, 12500, -1019, -1019360 }
+};
+
+/*!
+ * LinkADRReq commands sent by network servers
+ */
+typedef struct sRegionBenchRecordedSequence
+{
+    uint8_t NbBlocks;
+    uint8_t Payload[REGION_BENCH_LINK_ADR_MAX_BLOCKS * REGION_BENCH_LINK_ADR_REQ_SIZE];
+}RegionBenchRecordedSequence_t;
+
+static const RegionBenchRecordedSequence_t RecordedSequences[] =
+{
+    // Default channels, DR5, max power, 1 transmission
+    { 1, { 0x03, 0x50, 0x07, 0x00, 0x01 } },
+    // All channels on ( ChMaskCntl 6 ), power and datarate kept
+    { 1, { 0x03, 0xFF, 0xFF, 0x00, 0x61 } },
+    // US915 / AU915 sub-band 2: 125 kHz channels off and 500 kHz channel 65 on
+    // ( ChMaskCntl 7 ), then channels 8 to 15 on ( ChMaskCntl 0 )
+    { 2, { 0x03, 0x30, 0x02, 0x00, 0x70,
+           0x03, 0x30, 0x00, 0xFF, 0x01 } },
+    // US915 / AU915 all 125 kHz channels on, 500 kHz channels 64 to 67
+    // ( ChMaskCntl 6 ), DR0, 3 transmissions
+    { 1, { 0x03, 0x02, 0x0F, 0x00, 0x63 } },
+    // US915 / AU915 blocks 0 to 4, 16 channels each ( ChMaskCntl 0 to 4 )
+    { 5, { 0x03, 0x12, 0xFF, 0x00, 0x01,
+           0x03, 0x12, 0x00, 0x00, 0x11,
+           0x03, 0x12, 0x00, 0x00, 0x21,
+           0x03, 0x12, 0x00, 0x00, 0x31,
+           0x03, 0x12, 0x01, 0x00, 0x41 } },
+    // CN470 blocks 0 to 5 ( ChMaskCntl 0 to 5 ), channels 0 to 7 only
+    { 6, { 0x03, 0x24, 0xFF, 0x00, 0x01,
+           0x03, 0x24, 0x00, 0x00, 0x11,
+           0x03, 0x24, 0x00, 0x00, 0x21,
+           0x03, 0x24, 0x00, 0x00, 0x31,
+           0x03, 0x24, 0x00, 0x00, 0x41,
+           0x03, 0x24, 0x00, 0x00, 0x51 } },
+    // CN470 all 96 channels on ( ChMaskCntl 6 )
+    { 1, { 0x03, 0x30, 0x00, 0x00, 0x61 } },
+    // All channels off, must be rejected
+    { 1, { 0x03, 0x30, 0x00, 0x00, 0x01 } },
+};
+
+/*!
+ * Traced scalar physical parameters
+ */
+static const PhyAttribute_t TracedAttributes[] =
+{
+    PHY_MIN_RX_DR, PHY_MIN_TX_DR, PHY_MAX_RX_DR, PHY_MAX_TX_DR, PHY_DEF_TX_DR, PHY_MAX_TX_POWER,
+    PHY_DEF_TX_POWER, PHY_DEF_ADR_ACK_LIMIT, PHY_DEF_ADR_ACK_DELAY, PHY_MAX_PAYLOAD, PHY_MAX_PAYLOAD_REPEATER,
+    PHY_DUTY_CYCLE, PHY_MAX_RX_WINDOW, PHY_RECEIVE_DELAY1, PHY_RECEIVE_DELAY2, PHY_JOIN_ACCEPT_DELAY1,
+    PHY_JOIN_ACCEPT_DELAY2, PHY_MAX_FCNT_GAP, PHY_ACK_TIMEOUT, PHY_DEF_DR1_OFFSET, PHY_DEF_RX2_FREQUENCY,
+    PHY_DEF_RX2_DR, PHY_MAX_NB_CHANNELS, PHY_DEF_UPLINK_DWELL_TIME, PHY_DEF_DOWNLINK_DWELL_TIME,
+    PHY_DEF_MAX_EIRP, PHY_DEF_ANTENNA_GAIN, PHY_NEXT_LOWER_TX_DR, PHY_BEACON_CHANNEL_FREQ,
+    PHY_BEACON_CHANNEL_DR, PHY_BEACON_CHANNEL_STEPWIDTH, PHY_BEACON_NB_CHANNELS, PHY_PING_SLOT_CHANNEL_DR,
+    PHY_MAX_NB_BANDS,
+};
+
+static const char* RegionNames[REGION_BENCH_NB_REGIONS] =
+{
+    [LORAMAC_REGION_AS923] = "AS923",
+    [LORAMAC_REGION_AU915] = "AU915",
+    [LORAMAC_REGION_CN470] = "CN470",
+    [LORAMAC_REGION_CN779] = "CN779",
+    [LORAMAC_REGION_EU433] = "EU433",
+    [LORAMAC_REGION_EU868] = "EU868",
+    [LORAMAC_REGION_KR920] = "KR920",
+    [LORAMAC_REGION_IN865] = "IN865",
+    [LORAMAC_REGION_US915] = "US915",
+    [LORAMAC_REGION_RU864] = "RU864",
+};
+
+static const char* OpNames[REGION_BENCH_OP_NB] =
+{
+    [REGION_BENCH_OP_GET_PHY_PARAM] = "get_phy_param",
+    [REGION_BENCH_OP_LINK_ADR_REQ]  = "link_adr_req",
+    [REGION_BENCH_OP_NEXT_CHANNEL]  = "next_channel",
+    [REGION_BENCH_OP_RX_CONFIG]     = "rx_config",
+    [REGION_BENCH_OP_CALC_BACK_OFF] = "calc_back_off",
+};
+
+/*!
+ * Reference trace digests, recorded with the Host build of the original
+ * region modules. 0 when not recorded.
+ */
+static const uint32_t GoldenDigests[REGION_BENCH_NB_REGIONS] =
+{
+    [LORAMAC_REGION_AS923] = 0x3E6B3C7A,
+    [LORAMAC_REGION_AU915] = 0x5A0BA5C8,
+    [LORAMAC_REGION_CN470] = 0x42F8A954,
+    [LORAMAC_REGION_CN779] = 0x43D78087,
+    [LORAMAC_REGION_EU433] = 0x4F56AAB0,
+    [LORAMAC_REGION_EU868] = 0x9A14EA95,
+    [LORAMAC_REGION_KR920] = 0xEBECE135,
+    [LORAMAC_REGION_IN865] = 0xF57A26A9,
+    [LORAMAC_REGION_US915] = 0xFB682C48,
+    [LORAMAC_REGION_RU864] = 0x0DFF7190,
+};
+
+/*!
+ * Run in progress
+ */
+static RegionBenchCallbacks_t* Callbacks;
+static RegionBenchResult_t* Result;
+static LoRaMacRegion_t Region;
+
+/*!
+ * Trace of the pass in progress
+ */
+static uint32_t TraceCrc;
+static uint32_t TraceLines;
+static bool IsTraceOutput;
+
+/*!
+ * Synthetic sequences generator state. Kept apart from the random generator
+ * used by the regions so that the sequences don't depend on the region
+ * behaviour.
+ */
+static uint32_t SequenceSeed;
+
+/*!
+ * End-device state driven by the LinkADRReq commands
+ */
+static int8_t Datarate;
+static int8_t TxPower;
+static uint8_t NbRep;
+
+/*!
+ * \brief Adds a line to the trace of the pass
+ *
+ * \param [IN] format printf format of the line, without the new line
+ */
+static void Trace( const char* format, ... )
+{
+    char line[REGION_BENCH_TRACE_LINE_MAX];
+    va_list args;
+    int size;
+
+    va_start( args, format );
+    size = vsnprintf( line, sizeof( line ) - 1, format, args );
+    va_end( args );
+
+    if( size < 0 )
+    {
+        size = 0;
+    }
+    else if( size > ( int )( sizeof( line ) - 2 ) )
+    {
+        size = sizeof( line ) - 2;
+    }
+    line[size++] = '\n';
+    line[size] = '\0';
+
+    TraceCrc = Crc32Update( TraceCrc, ( uint8_t* )line, size );
+    TraceLines++;
+    if( ( IsTraceOutput == true ) && ( Callbacks->OnTraceLine != NULL ) )
+    {
+        Callbacks->OnTraceLine( line );
+    }
+}
+
+static uint32_t OpStart( void )
+{
+    return Callbacks->GetCounter( );
+}
+
+static void OpStop( RegionBenchOps_t op, uint32_t start )
+{
+    uint32_t elapsed = Callbacks->GetCounter( ) - start;
+    RegionBenchOpStats_t* stats = &Result->Ops[op];
+
+    if( ( stats->Calls == 0 ) || ( elapsed < stats->Min ) )
+    {
+        stats->Min = elapsed;
+    }
+    if( elapsed > stats->Max )
+    {
+        stats->Max = elapsed;
+    }
+    stats->Sum += elapsed;
+    stats->Calls++;
+}
+
+/*!
+ * \brief xorshift32 generator of the synthetic sequences
+ *
+ * \retval value Next random value
+ */
+static uint32_t SequenceRand( void )
+{
+    SequenceSeed ^= SequenceSeed << 13;
+    SequenceSeed ^= SequenceSeed >> 17;
+    SequenceSeed ^= SequenceSeed << 5;
+    return SequenceSeed;
+}
+
+static PhyParam_t GetPhyParam( PhyAttribute_t attribute, int8_t datarate, uint8_t dwellTime )
+{
+    GetPhyParams_t getPhy =
+    {
+        .Attribute = attribute,
+        .Datarate = datarate,
+        .UplinkDwellTime = dwellTime,
+        .DownlinkDwellTime = dwellTime
+    };
+
+    return RegionGetPhyParam( Region, &getPhy );
+}
+
+/*!
+ * \brief Gets the highest uplink datarate of the region
+ *
+ * \remark The regions don't serve PHY_MAX_TX_DR, the datarates are verified
+ *
+ * \param [IN] minDr Lowest uplink datarate
+ * \retval maxDr     Highest uplink datarate
+ */
+static int8_t GetMaxTxDr( int8_t minDr )
+{
+    VerifyParams_t verify = { 0 };
+    int8_t maxDr = minDr;
+
+    for( int8_t dr = minDr + 1; dr <= DR_15; dr++ )
+    {
+        verify.DatarateParams.Datarate = dr;
+        if( RegionVerify( Region, &verify, PHY_TX_DR ) == true )
+        {
+            maxDr = dr;
+        }
+    }
+    return maxDr;
+}
+
+static void TraceChannels( void )
+{
+    uint8_t nbChannels = GetPhyParam( PHY_MAX_NB_CHANNELS, 0, 0 ).Value;
+    ChannelParams_t* channels = GetPhyParam( PHY_CHANNELS, 0, 0 ).Channels;
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        if( channels[i].Frequency != 0 )
+        {
+            Trace( "ch,%u,%lu,%lu,%d,%d,%u", i, ( unsigned long )channels[i].Frequency,
+                   ( unsigned long )channels[i].Rx1Frequency, channels[i].DrRange.Fields.Min,
+                   channels[i].DrRange.Fields.Max, channels[i].Band );
+        }
+    }
+}
+
+static void TraceChannelsMask( uint16_t sequence )
+{
+    uint8_t nbChannels = GetPhyParam( PHY_MAX_NB_CHANNELS, 0, 0 ).Value;
+    uint16_t* mask = GetPhyParam( PHY_CHANNELS_MASK, 0, 0 ).ChannelsMask;
+    char words[REGION_BENCH_TRACE_LINE_MAX - 16];
+    int size = 0;
+
+    for( uint8_t i = 0; ( i < ( ( nbChannels + 15 ) / 16 ) ) && ( size < ( int )( sizeof( words ) - 6 ) ); i++ )
+    {
+        size += snprintf( &words[size], sizeof( words ) - size, ",%04X", mask[i] );
+    }
+    words[size] = '\0';
+    Trace( "mask,%u%s", sequence, words );
+}
+
+/*!
+ * \brief Sweeps the scalar physical parameters over the uplink datarates and
+ *        dwell times
+ */
+static void GetPhyParamSweep( void )
+{
+    int8_t minDr = GetPhyParam( PHY_MIN_TX_DR, 0, 0 ).Value;
+    int8_t maxDr = GetMaxTxDr( minDr );
+
+    for( uint8_t i = 0; i < ( sizeof( TracedAttributes ) / sizeof( TracedAttributes[0] ) ); i++ )
+    {
+        for( uint8_t dwellTime = 0; dwellTime < 2; dwellTime++ )
+        {
+            for( int8_t dr = minDr; dr <= maxDr; dr++ )
+            {
+                uint32_t start = OpStart( );
+                PhyParam_t phyParam = GetPhyParam( TracedAttributes[i], dr, dwellTime );
+
+                OpStop( REGION_BENCH_OP_GET_PHY_PARAM, start );
+                Trace( "phy,%u,%u,%d,%08lX", TracedAttributes[i], dwellTime, dr, ( unsigned long )phyParam.Value );
+            }
+        }
+    }
+}
+
+/*!
+ * \brief Builds the LinkADRReq commands of a sequence
+ *
+ * \remark The recorded sequences come first, then regularly between the
+ *         synthetic ones. The synthetic channel masks are narrowed at random
+ *         so that the regions with few channels accept some of them.
+ *
+ * \param [IN]  sequence Sequence number
+ * \param [OUT] payload  LinkADRReq commands
+ * \retval size          Commands size
+ */
+static uint8_t LinkAdrSequenceBuild( uint16_t sequence, uint8_t* payload )
+{
+    static const uint16_t masks[] = { 0xFFFF, 0x00FF, 0x0007 };
+    uint8_t nbRecorded = sizeof( RecordedSequences ) / sizeof( RecordedSequences[0] );
+    uint8_t nbBlocks;
+
+    if( ( sequence % ( 2 * nbRecorded ) ) < nbRecorded )
+    {
+        const RegionBenchRecordedSequence_t* recorded = &RecordedSequences[sequence % nbRecorded];
+
+        memcpy1( payload, recorded->Payload, recorded->NbBlocks * REGION_BENCH_LINK_ADR_REQ_SIZE );
+        return recorded->NbBlocks * REGION_BENCH_LINK_ADR_REQ_SIZE;
+    }
+
+    nbBlocks = 1 + ( SequenceRand( ) % ( REGION_BENCH_LINK_ADR_MAX_BLOCKS - 2 ) );
+    for( uint8_t i = 0; i < nbBlocks; i++ )
+    {
+        uint8_t* block = &payload[i * REGION_BENCH_LINK_ADR_REQ_SIZE];
+        uint32_t draw = SequenceRand( );
+        uint16_t mask = ( draw >> 16 ) & masks[( draw >> 8 ) % ( sizeof( masks ) / sizeof( masks[0] ) )];
+
+        block[0] = REGION_BENCH_LINK_ADR_REQ;
+        // Datarate and TX power
+        block[1] = draw & 0xFF;
+        block[2] = mask & 0xFF;
+        block[3] = mask >> 8;
+        // ChMaskCntl and NbTrans
+        block[4] = SequenceRand( ) & 0x7F;
+    }
+    return nbBlocks * REGION_BENCH_LINK_ADR_REQ_SIZE;
+}
+
+static uint8_t LinkAdrReq( uint16_t sequence )
+{
+    uint8_t payload[REGION_BENCH_LINK_ADR_MAX_BLOCKS * REGION_BENCH_LINK_ADR_REQ_SIZE];
+    LinkAdrReqParams_t linkAdrReq;
+    int8_t drOut = Datarate;
+    int8_t txPowOut = TxPower;
+    uint8_t nbRepOut = NbRep;
+    uint8_t nbBytesParsed = 0;
+    uint8_t status;
+    uint32_t start;
+
+    linkAdrReq.Version.Value = ( ( sequence & 0x01 ) == 0 ) ? 0x01000400 : 0x01010000;
+    linkAdrReq.Payload = payload;
+    linkAdrReq.PayloadSize = LinkAdrSequenceBuild( sequence, payload );
+    linkAdrReq.UplinkDwellTime = 0;
+    linkAdrReq.AdrEnabled = ( sequence % 8 ) != 7;
+    linkAdrReq.CurrentDatarate = Datarate;
+    linkAdrReq.CurrentTxPower = TxPower;
+    linkAdrReq.CurrentNbRep = NbRep;
+
+    start = OpStart( );
+    status = RegionLinkAdrReq( Region, &linkAdrReq, &drOut, &txPowOut, &nbRepOut, &nbBytesParsed );
+    OpStop( REGION_BENCH_OP_LINK_ADR_REQ, start );
+
+    Trace( "adr,%u,%02X,%d,%d,%u,%u", sequence, status, drOut, txPowOut, nbRepOut, nbBytesParsed );
+    TraceChannelsMask( sequence );
+
+    // Channel mask, datarate and TX power ACKs
+    if( ( status & 0x07 ) == 0x07 )
+    {
+        Datarate = drOut;
+        TxPower = txPowOut;
+        NbRep = nbRepOut;
+    }
+    return status;
+}
+
+static LoRaMacStatus_t NextChannel( uint16_t sequence, uint8_t* channel )
+{
+    NextChanParams_t nextChan;
+    TimerTime_t time = 0;
+    TimerTime_t aggregatedTimeOff = 0;
+    LoRaMacStatus_t status;
+    uint32_t start;
+
+    // The duty cycle is off and no uplink is recorded, which keeps the
+    // channels selection independent of the time
+    nextChan.AggrTimeOff = 0;
+    nextChan.LastAggrTx = 0;
+    nextChan.Datarate = Datarate;
+    nextChan.Joined = true;
+    nextChan.DutyCycleEnabled = false;
+    nextChan.QueryNextTxDelayOnly = false;
+    nextChan.ChannelStats = NULL;
+    nextChan.NbChannelStats = 0;
+    nextChan.AvoidChannel = ( ( sequence % 4 ) == 3 ) ? *channel : REGION_CHANNEL_NONE;
+
+    *channel = REGION_CHANNEL_NONE;
+    start = OpStart( );
+    status = RegionNextChannel( Region, &nextChan, channel, &time, &aggregatedTimeOff );
+    OpStop( REGION_BENCH_OP_NEXT_CHANNEL, start );
+
+    Trace( "nc,%u,%d,%u,%lu,%lu", sequence, status, *channel, ( unsigned long )time, ( unsigned long )aggregatedTimeOff );
+    return status;
+}
+
+/*!
+ * \brief Configures the RX1 and RX2 windows of the uplink
+ *
+ * \remark The windows timeout and offset depend on the radio wake up time,
+ *         they aren't traced so that the trace is the same on all platforms
+ */
+static void RxConfig( uint16_t sequence, uint8_t channel )
+{
+    for( LoRaMacRxSlot_t slot = RX_SLOT_WIN_1; slot <= RX_SLOT_WIN_2; slot++ )
+    {
+        RxConfigParams_t rxConfig = { 0 };
+        int8_t datarate = -1;
+        int8_t rxDr;
+        bool ok;
+        uint32_t start;
+
+        if( slot == RX_SLOT_WIN_1 )
+        {
+            rxDr = RegionApplyDrOffset( Region, 0, Datarate, sequence % 4 );
+            rxConfig.Frequency = 0;
+        }
+        else
+        {
+            rxDr = GetPhyParam( PHY_DEF_RX2_DR, 0, 0 ).Value;
+            rxConfig.Frequency = GetPhyParam( PHY_DEF_RX2_FREQUENCY, 0, 0 ).Value;
+        }
+        RegionComputeRxWindowParameters( Region, rxDr, REGION_BENCH_MIN_RX_SYMBOLS, REGION_BENCH_RX_ERROR, &rxConfig );
+        rxConfig.Channel = channel;
+        rxConfig.DrOffset = sequence % 4;
+        rxConfig.DownlinkDwellTime = 0;
+        rxConfig.RepeaterSupport = ( sequence % 16 ) == 15;
+        rxConfig.RxContinuous = false;
+        rxConfig.RxSlot = slot;
+
+        start = OpStart( );
+        ok = RegionRxConfig( Region, &rxConfig, &datarate );
+        OpStop( REGION_BENCH_OP_RX_CONFIG, start );
+
+        Trace( "rx,%u,%d,%d,%d,%d,%u", sequence, slot, ok, rxConfig.Datarate, datarate, rxConfig.Bandwidth );
+    }
+}
+
+static void CalcBackOff( uint16_t sequence, uint8_t channel )
+{
+    CalcBackOffParams_t calcBackOff;
+    ChannelParams_t* channels = GetPhyParam( PHY_CHANNELS, 0, 0 ).Channels;
+    Band_t* bands = GetPhyParam( PHY_BANDS, 0, 0 ).Bands;
+    uint8_t band = channels[channel].Band;
+    uint32_t start;
+
+    // The elapsed time since the start up walks through the 3 join duty
+    // cycle steps
+    calcBackOff.Joined = ( sequence & 0x01 ) != 0;
+    calcBackOff.LastTxIsJoinRequest = calcBackOff.Joined == false;
+    calcBackOff.DutyCycleEnabled = ( sequence & 0x02 ) != 0;
+    calcBackOff.Channel = channel;
+    calcBackOff.ElapsedTime.Seconds = sequence * 173;
+    calcBackOff.ElapsedTime.SubSeconds = 0;
+    calcBackOff.TxTimeOnAir = RegionGetTxTimeOnAir( Region, Datarate, 13 + ( sequence % 51 ) );
+
+    start = OpStart( );
+    RegionCalcBackOff( Region, &calcBackOff );
+    OpStop( REGION_BENCH_OP_CALC_BACK_OFF, start );
+
+    Trace( "bo,%u,%lu,%u,%lu", sequence, ( unsigned long )calcBackOff.TxTimeOnAir, band,
+           ( unsigned long )bands[band].TimeOff );
+}
+
+/*!
+ * \brief Runs the MAC commands sequences once
+ */
+static void Pass( void )
+{
+    InitDefaultsParams_t params = { .RestoreCtx = NULL };
+    uint8_t channel = 0;
+
+    srand1( REGION_BENCH_SEED + Region );
+    SequenceSeed = REGION_BENCH_SEED + Region;
+    TraceCrc = 0xFFFFFFFF;
+    TraceLines = 0;
+
+    params.Type = INIT_TYPE_BANDS;
+    RegionInitDefaults( Region, &params );
+    params.Type = INIT_TYPE_INIT;
+    RegionInitDefaults( Region, &params );
+
+    Datarate = GetPhyParam( PHY_DEF_TX_DR, 0, 0 ).Value;
+    TxPower = GetPhyParam( PHY_DEF_TX_POWER, 0, 0 ).Value;
+    NbRep = 1;
+
+    Trace( "region,%s", RegionNames[Region] );
+    TraceChannels( );
+    GetPhyParamSweep( );
+
+    for( uint16_t sequence = 0; sequence < REGION_BENCH_SEQUENCES; sequence++ )
+    {
+        if( ( sequence > 0 ) && ( ( sequence % REGION_BENCH_RESTORE_PERIOD ) == 0 ) )
+        {
+            params.Type = INIT_TYPE_RESTORE_DEFAULT_CHANNELS;
+            RegionInitDefaults( Region, &params );
+            TraceChannelsMask( sequence );
+        }
+
+        LinkAdrReq( sequence );
+        if( NextChannel( sequence, &channel ) == LORAMAC_STATUS_OK )
+        {
+            RxConfig( sequence, channel );
+            CalcBackOff( sequence, channel );
+        }
+        else
+        {
+            channel = 0;
+        }
+    }
+    TraceCrc = ~TraceCrc;
+}
+
+bool RegionBenchRun( LoRaMacRegion_t region, RegionBenchCallbacks_t* callbacks, RegionBenchResult_t* result )
+{
+    if( ( region >= REGION_BENCH_NB_REGIONS ) || ( RegionIsActive( region ) == false ) )
+    {
+        return false;
+    }
+
+    Callbacks = callbacks;
+    Result = result;
+    Region = region;
+    memset1( ( uint8_t* )result, 0, sizeof( RegionBenchResult_t ) );
+    result->Region = region;
+
+    for( uint8_t i = 0; i < REGION_BENCH_PASSES; i++ )
+    {
+        IsTraceOutput = i == 0;
+        Pass( );
+        if( i == 0 )
+        {
+            result->Digest = TraceCrc;
+            result->TraceLines = TraceLines;
+        }
+        else if( ( TraceCrc != result->Digest ) || ( TraceLines != result->TraceLines ) )
+        {
+            result->IsNonDeterministic = true;
+        }
+    }
+    return true;
+}
+
+uint32_t RegionBenchRxWindowCheck( uint32_t* nbCases )
+{
+    uint32_t mismatches = 0;
+
+    *nbCases = sizeof( RxWindowCases ) / sizeof( RxWindowCases[0] );
+    for( uint32_t i = 0; i < *nbCases; i++ )
+    {
+        const RegionBenchRxWindowCase_t* rxWindow = &RxWindowCases[i];
+        uint32_t tSymbolUs;
+        uint32_t windowTimeout = 0;
+        int32_t windowOffset = 0;
+        int32_t windowOffsetMs;
+
+        if( rxWindow->Bandwidth == 0 )
+        {
+            tSymbolUs = RegionCommonComputeSymbolTimeFsk( rxWindow->PhyDr );
+        }
+        else
+        {
+            tSymbolUs = RegionCommonComputeSymbolTimeLoRa( rxWindow->PhyDr, rxWindow->Bandwidth );
+        }
+        RegionCommonComputeRxWindowParameters( tSymbolUs, rxWindow->MinRxSymbols, rxWindow->RxError, rxWindow->WakeUpTime,
+                                               &windowTimeout, &windowOffset );
+        // Rounded up to milliseconds, the division truncates towards zero
+        windowOffsetMs = ( windowOffset > 0 ) ? ( ( windowOffset + 999 ) / 1000 ) : ( windowOffset / 1000 );
+        if( ( windowTimeout != rxWindow->WindowTimeout ) || ( windowOffset != rxWindow->WindowOffset ) ||
+            ( windowOffsetMs != rxWindow->WindowOffsetMs ) )
+        {
+            mismatches++;
+        }
+    }
+    return mismatches;
+}
+
+bool RegionBenchGetGoldenDigest( LoRaMacRegion_t region, uint32_t* digest )
+{
+    if( ( region >= REGION_BENCH_NB_REGIONS ) || ( GoldenDigests[region] == 0 ) )
+    {
+        return false;
+    }
+    *digest = GoldenDigests[region];
+    return true;
+}
+
+const char* RegionBenchRegionName( LoRaMacRegion_t region )
+{
+    if( region >= REGION_BENCH_NB_REGIONS )
+    {
+        return "unknown";
+    }
+    return RegionNames[region];
+}
+
+const char* RegionBenchOpName( RegionBenchOps_t op )
+{
+    if( op >= REGION_BENCH_OP_NB )
+    {
+        return "unknown";
+    }
+    return OpNames[op];
+}
@@ -0,0 +1,178 @@
+/*!
+ * \file      RegionBench.h
+ *
+ * \brief     Region modules micro-benchmark and equivalence trace
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2018 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __REGION_BENCH_H__
+#define __REGION_BENCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "LoRaMac.h"
+
+/*!
+ * Number of MAC command sequences applied to each region. The golden
+ * digests are only valid for the default value.
+ */
+#define REGION_BENCH_SEQUENCES                      256
+
+/*!
+ * Number of times the whole run is repeated to average the measurements.
+ * Every pass must produce the same trace.
+ */
+#ifndef REGION_BENCH_PASSES
+#define REGION_BENCH_PASSES                         4
+#endif
+
+/*!
+ * Maximum length of a trace line, ending zero included
+ */
+#define REGION_BENCH_TRACE_LINE_MAX                 128
+
+/*!
+ * Number of LoRaWAN regions
+ */
+#define REGION_BENCH_NB_REGIONS                     ( LORAMAC_REGION_RU864 + 1 )
+
+/*!
+ * Measured region operations
+ */
+typedef enum eRegionBenchOps
+{
+    REGION_BENCH_OP_GET_PHY_PARAM,
+    REGION_BENCH_OP_LINK_ADR_REQ,
+    REGION_BENCH_OP_NEXT_CHANNEL,
+    REGION_BENCH_OP_RX_CONFIG,
+    REGION_BENCH_OP_CALC_BACK_OFF,
+    REGION_BENCH_OP_NB,
+}RegionBenchOps_t;
+
+/*!
+ * Measurements of a region operation, in counter units
+ */
+typedef struct sRegionBenchOpStats
+{
+    uint32_t Calls;
+    uint32_t Min;
+    uint32_t Max;
+    uint64_t Sum;
+}RegionBenchOpStats_t;
+
+/*!
+ * Results of a region run
+ */
+typedef struct sRegionBenchResult
+{
+    /*!
+     * Benchmarked region
+     */
+    LoRaMacRegion_t Region;
+    /*!
+     * Measurements per operation, all passes included
+     */
+    RegionBenchOpStats_t Ops[REGION_BENCH_OP_NB];
+    /*!
+     * Number of lines of the trace of a pass
+     */
+    uint32_t TraceLines;
+    /*!
+     * IEEE 802.3 CRC32 of the trace text of the first pass
+     */
+    uint32_t Digest;
+    /*!
+     * Set when a pass produced a different trace than the first one
+     */
+    bool IsNonDeterministic;
+}RegionBenchResult_t;
+
+/*!
+ * Platform services used by the benchmark
+ */
+typedef struct sRegionBenchCallbacks
+{
+    /*!
+     * \brief Reads a free running counter, CPU cycles or nanoseconds
+     *
+     * \retval counter Current counter value
+     */
+    uint32_t ( *GetCounter )( void );
+    /*!
+     * \brief Receives the trace lines of the first pass. May be NULL
+     *
+     * \param [IN] line Trace line, ended by a new line
+     */
+    void ( *OnTraceLine )( const char* line );
+}RegionBenchCallbacks_t;
+
+/*!
+ * \brief Runs the benchmark of a region
+ *
+ * \remark The region state is initialized again by the run. The radio
+ *         driver must be initialized and idle.
+ *
+ * \param [IN]  region    Region to benchmark
+ * \param [IN]  callbacks Platform services
+ * \param [OUT] result    Measurements and trace digest
+ * \retval status         false when the region isn't built in
+ */
+bool RegionBenchRun( LoRaMacRegion_t region, RegionBenchCallbacks_t* callbacks, RegionBenchResult_t* result );
+
+/*!
+ * \brief Checks RegionCommonComputeRxWindowParameters against the results of
+ *        its former floating point implementation
+ *
+ * \param [OUT] nbCases Number of checked cases
+ * \retval mismatches   Number of cases not matching the reference
+ */
+uint32_t RegionBenchRxWindowCheck( uint32_t* nbCases );
+
+/*!
+ * \brief Gets the digest of the reference trace of a region
+ *
+ * \param [IN]  region Region
+ * \param [OUT] digest Reference digest
+ * \retval status      false when no reference is recorded
+ */
+bool RegionBenchGetGoldenDigest( LoRaMacRegion_t region, uint32_t* digest );
+
+/*!
+ * \brief Gets the name of a region
+ *
+ * \param [IN] region Region
+ * \retval name       Region name
+ */
+const char* RegionBenchRegionName( LoRaMacRegion_t region );
+
+/*!
+ * \brief Gets the name of a measured operation
+ *
+ * \param [IN] op Operation
+ * \retval name   Operation name
+ */
+const char* RegionBenchOpName( RegionBenchOps_t op );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __REGION_BENCH_H__
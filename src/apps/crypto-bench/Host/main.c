@@ -0,0 +1,59 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Crypto micro-benchmark implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdlib.h>
+#include <time.h>
+#include "board.h"
+#include "CryptoBench.h"
+
+/*!
+ * Host monotonic clock value at the start of the measurement
+ */
+static struct timespec CounterStart;
+
+void CryptoBenchCounterInit( void )
+{
+}
+
+void CryptoBenchCounterStart( void )
+{
+    clock_gettime( CLOCK_MONOTONIC, &CounterStart );
+}
+
+uint32_t CryptoBenchCounterStop( void )
+{
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( uint32_t )( ( ( int64_t )( now.tv_sec - CounterStart.tv_sec ) * 1000000000 ) + ( now.tv_nsec - CounterStart.tv_nsec ) );
+}
+
+/*!
+ * Main application entry point.
+ */
+int main( void )
+{
+    BoardInitMcu( );
+    BoardInitPeriph( );
+
+    CryptoBenchRun( "ns" );
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,60 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Crypto micro-benchmark implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "stm32l4xx.h"
+#include "board.h"
+#include "CryptoBench.h"
+
+/*!
+ * DWT cycle counter value at the start of the measurement
+ */
+static uint32_t CounterStart;
+
+void CryptoBenchCounterInit( void )
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+void CryptoBenchCounterStart( void )
+{
+    CounterStart = DWT->CYCCNT;
+}
+
+uint32_t CryptoBenchCounterStop( void )
+{
+    return DWT->CYCCNT - CounterStart;
+}
+
+/*!
+ * Main application entry point.
+ */
+int main( void )
+{
+    BoardInitMcu( );
+    BoardInitPeriph( );
+
+    CryptoBenchRun( "cycles" );
+
+    while( 1 )
+    {
+    }
+}
@@ -0,0 +1,68 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Crypto micro-benchmark implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <hal_delay.h>
+#include "board.h"
+#include "CryptoBench.h"
+
+/*!
+ * Maximum value of the 24 bits SysTick counter
+ */
+#define SYSTICK_MAX                                 0x00FFFFFF
+
+/*!
+ * SysTick value at the start of the measurement
+ */
+static uint32_t CounterStart;
+
+void CryptoBenchCounterInit( void )
+{
+    // The Cortex-M0+ has no DWT cycle counter, SysTick free runs on the core
+    // clock. Measurements must be shorter than 2^24 cycles.
+    SysTick->LOAD = SYSTICK_MAX;
+    SysTick->VAL = 0;
+    SysTick->CTRL = SysTick_CTRL_ENABLE_Msk | SysTick_CTRL_CLKSOURCE_Msk;
+}
+
+void CryptoBenchCounterStart( void )
+{
+    CounterStart = SysTick->VAL;
+}
+
+uint32_t CryptoBenchCounterStop( void )
+{
+    // SysTick counts down
+    return ( CounterStart - SysTick->VAL ) & SYSTICK_MAX;
+}
+
+/*!
+ * Main application entry point.
+ */
+int main( void )
+{
+    BoardInitMcu( );
+    BoardInitPeriph( );
+
+    CryptoBenchRun( "cycles" );
+
+    while( 1 )
+    {
+    }
+}
@@ -0,0 +1,80 @@
+/*!
+ * \file      main.c
+ *
+ * \brief     Crypto micro-benchmark implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "stm32l0xx.h"
+#include "board.h"
+#include "CryptoBench.h"
+
+/*!
+ * Counter value at the start of the measurement
+ */
+static uint32_t CounterStart;
+
+/*!
+ * \brief Reads the core clock cycles elapsed since the HAL tick started
+ *
+ * \remark The Cortex-M0+ has no DWT cycle counter. SysTick drives the 1 ms
+ *         HAL tick, the milliseconds are extended with the SysTick down
+ *         counter value.
+ *
+ * \retval cycles Core clock cycles, wraps around
+ */
+static uint32_t CounterRead( void )
+{
+    uint32_t ms;
+    uint32_t val;
+
+    do
+    {
+        ms = HAL_GetTick( );
+        val = SysTick->VAL;
+    }while( ms != HAL_GetTick( ) );
+
+    return ( uint32_t )( ( ( uint64_t )ms * ( SysTick->LOAD + 1 ) ) + ( SysTick->LOAD - val ) );
+}
+
+void CryptoBenchCounterInit( void )
+{
+}
+
+void CryptoBenchCounterStart( void )
+{
+    CounterStart = CounterRead( );
+}
+
+uint32_t CryptoBenchCounterStop( void )
+{
+    return CounterRead( ) - CounterStart;
+}
+
+/*!
+ * Main application entry point.
+ */
+int main( void )
+{
+    BoardInitMcu( );
+    BoardInitPeriph( );
+
+    CryptoBenchRun( "cycles" );
+
+    while( 1 )
+    {
+    }
+}
@@ -0,0 +1,520 @@
+/*!
+ * \file      CryptoBench.c
+ *
+ * \brief     LoRaMac crypto stack micro-benchmarks
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdio.h>
+#include "utilities.h"
+#include "aes.h"
+#include "cmac.h"
+#include "secure-element.h"
+#include "LoRaMacCrypto.h"
+#include "CryptoBench.h"
+
+/*!
+ * Device address of the benchmarked frames
+ */
+#define BENCH_DEV_ADDR                              0x26011234
+
+/*!
+ * Frame port of the benchmarked frames
+ */
+#define BENCH_FPORT                                 1
+
+/*!
+ * Maximum size of the benchmarked frames
+ */
+#define BENCH_FRAME_MAX_SIZE                        255
+
+/*!
+ * Position of FRMPayload in the benchmarked frames, there are no FOpts
+ */
+#define BENCH_FRMPAYLOAD_OFFSET                     ( LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE + \
+                                                      LORAMAC_FHDR_F_CTRL_FIELD_SIZE + LORAMAC_FHDR_F_CNT_FIELD_SIZE + \
+                                                      LORAMAC_F_PORT_FIELD_SIZE )
+
+/*!
+ * Join accept size without CFList
+ */
+#define BENCH_JOIN_ACCEPT_SIZE                      17
+
+/*!
+ * Measurements of a benchmark
+ */
+typedef struct sBenchResult
+{
+    uint32_t Min;
+    uint32_t Max;
+    uint64_t Sum;
+}BenchResult_t;
+
+/*!
+ * Key used for all the key identifiers ( FIPS-197 appendix A.1 )
+ */
+static uint8_t BenchKey[16] = { 0x2B, 0x7E, 0x15, 0x16, 0x28, 0xAE, 0xD2, 0xA6, 0xAB, 0xF7, 0x15, 0x88, 0x09, 0xCF, 0x4F, 0x3C };
+
+/*!
+ * Benchmarked data
+ */
+static uint8_t BenchData[BENCH_FRAME_MAX_SIZE];
+
+/*!
+ * Benchmarked frame
+ */
+static uint8_t BenchFrame[BENCH_FRAME_MAX_SIZE];
+
+/*!
+ * Word aligned buffers of the memory functions benchmarks, with room for a
+ * misaligned destination
+ */
+static uint32_t BenchMemSrc[( BENCH_FRAME_MAX_SIZE + 4 ) / 4];
+static uint32_t BenchMemDst[( BENCH_FRAME_MAX_SIZE + 4 ) / 4];
+
+/*!
+ * Benchmarked memory function
+ */
+typedef void ( *BenchMemFunc_t )( uint8_t *dst, const uint8_t *src, uint16_t size );
+
+/*!
+ * Counter unit printed with the results
+ */
+static const char* CounterUnit;
+
+/*!
+ * Frame counters of the benchmarked frames
+ */
+static uint32_t FCntUp = 0;
+static uint32_t FCntDown = 0;
+
+static void ResultInit( BenchResult_t* result )
+{
+    result->Min = UINT32_MAX;
+    result->Max = 0;
+    result->Sum = 0;
+}
+
+static void ResultAdd( BenchResult_t* result, uint32_t ticks )
+{
+    result->Min = MIN( result->Min, ticks );
+    result->Max = MAX( result->Max, ticks );
+    result->Sum += ticks;
+}
+
+static void ResultPrint( const char* name, uint16_t size, BenchResult_t* result )
+{
+    printf( "bench,%s,%s,%u,%u,%lu,%lu,%lu\r\n", CounterUnit, name, size, CRYPTO_BENCH_ITERATIONS,
+            ( unsigned long )result->Min, ( unsigned long )( result->Sum / CRYPTO_BENCH_ITERATIONS ), ( unsigned long )result->Max );
+}
+
+static void ErrorPrint( const char* name, uint16_t size, int status )
+{
+    printf( "bench,%s,%s,%u,error,%d\r\n", CounterUnit, name, size, status );
+}
+
+static void BenchOverhead( void )
+{
+    BenchResult_t result;
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        CryptoBenchCounterStart( );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+    }
+    ResultPrint( "overhead", 0, &result );
+}
+
+/*!
+ * Byte per byte implementations of memcpy1, memset1 and memcpyr, the
+ * references of the word aligned ones
+ */
+static void MemcpyBytes( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+    while( size-- )
+    {
+        *dst++ = *src++;
+    }
+}
+
+static void MemsetBytes( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+    while( size-- )
+    {
+        *dst++ = src[0];
+    }
+}
+
+static void MemcpyrBytes( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+    dst = dst + ( size - 1 );
+    while( size-- )
+    {
+        *dst-- = *src++;
+    }
+}
+
+static void Memset1( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+    memset1( dst, src[0], size );
+}
+
+static void Memcpy16( uint8_t *dst, const uint8_t *src, uint16_t size )
+{
+    memcpy16( dst, src );
+}
+
+static void BenchMem( const char* name, BenchMemFunc_t func, uint8_t dstOffset, uint16_t size )
+{
+    BenchResult_t result;
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        CryptoBenchCounterStart( );
+        func( ( uint8_t* )BenchMemDst + dstOffset, ( uint8_t* )BenchMemSrc, size );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+    }
+    ResultPrint( name, size, &result );
+}
+
+static void BenchAesSetKey( void )
+{
+    BenchResult_t result;
+    aes_context ctx;
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        CryptoBenchCounterStart( );
+        aes_set_key( BenchKey, 16, &ctx );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+    }
+    ResultPrint( "aes_set_key", 16, &result );
+}
+
+static void BenchAesEncrypt( void )
+{
+    BenchResult_t result;
+    aes_context ctx;
+    uint8_t block[16];
+
+    aes_set_key( BenchKey, 16, &ctx );
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        CryptoBenchCounterStart( );
+        aes_encrypt( BenchData, block, &ctx );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+    }
+    ResultPrint( "aes_encrypt", 16, &result );
+}
+
+static void BenchCmac( uint16_t size )
+{
+    BenchResult_t result;
+    AES_CMAC_CTX ctx;
+    uint8_t cmac[16];
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        // Includes the key expansion, as done without the secure element key cache
+        CryptoBenchCounterStart( );
+        AES_CMAC_Init( &ctx );
+        AES_CMAC_SetKey( &ctx, BenchKey );
+        AES_CMAC_Update( &ctx, BenchData, size );
+        AES_CMAC_Final( cmac, &ctx );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+    }
+    ResultPrint( "cmac", size, &result );
+}
+
+static void BenchSeCmac( uint16_t size )
+{
+    BenchResult_t result;
+    uint32_t cmac;
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        CryptoBenchCounterStart( );
+        SecureElementStatus_t status = SecureElementComputeAesCmac( NULL, BenchData, size, NWK_KEY, &cmac );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+        if( status != SECURE_ELEMENT_SUCCESS )
+        {
+            ErrorPrint( "se_cmac", size, status );
+            return;
+        }
+    }
+    ResultPrint( "se_cmac", size, &result );
+}
+
+static void BenchSeAesEncrypt( void )
+{
+    BenchResult_t result;
+    uint8_t block[16];
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        CryptoBenchCounterStart( );
+        SecureElementStatus_t status = SecureElementAesEncrypt( BenchData, 16, APP_S_KEY, block );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+        if( status != SECURE_ELEMENT_SUCCESS )
+        {
+            ErrorPrint( "se_aes_encrypt", 16, status );
+            return;
+        }
+    }
+    ResultPrint( "se_aes_encrypt", 16, &result );
+}
+
+static void BenchSecureMessage( uint8_t size )
+{
+    BenchResult_t result;
+    LoRaMacMessageData_t macMsg;
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        // An uplink as prepared by LoRaMac, the payload is in the frame buffer
+        memset1( ( uint8_t* )&macMsg, 0, sizeof( macMsg ) );
+        macMsg.Buffer = BenchFrame;
+        macMsg.BufSize = BENCH_FRAME_MAX_SIZE;
+        macMsg.MHDR.Bits.MType = FRAME_TYPE_DATA_UNCONFIRMED_UP;
+        macMsg.FHDR.DevAddr = BENCH_DEV_ADDR;
+        macMsg.FHDR.FCnt = ( uint16_t )++FCntUp;
+        macMsg.FPort = BENCH_FPORT;
+        macMsg.FRMPayload = &BenchFrame[BENCH_FRMPAYLOAD_OFFSET];
+        macMsg.FRMPayloadSize = size;
+        memcpy1( macMsg.FRMPayload, BenchData, size );
+
+        CryptoBenchCounterStart( );
+        LoRaMacCryptoStatus_t status = LoRaMacCryptoSecureMessage( FCntUp, 0, 0, &macMsg );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+        if( status != LORAMAC_CRYPTO_SUCCESS )
+        {
+            ErrorPrint( "secure_message", size, status );
+            return;
+        }
+    }
+    ResultPrint( "secure_message", size, &result );
+}
+
+/*!
+ * Builds a downlink as sent by the network server
+ *
+ * \param [IN]  size      FRMPayload size
+ * \param [IN]  fCnt      Downlink frame counter
+ * \retval      frameSize Size of the frame, 0 on failure
+ */
+static uint8_t BuildDownlink( uint8_t size, uint32_t fCnt )
+{
+    uint8_t aBlock[16] = { 0 };
+    uint8_t sBlock[16];
+    uint8_t b0[16] = { 0 };
+    uint8_t len = BENCH_FRMPAYLOAD_OFFSET + size;
+    uint32_t mic;
+
+    BenchFrame[0] = FRAME_TYPE_DATA_UNCONFIRMED_DOWN << 5;
+    BenchFrame[1] = BENCH_DEV_ADDR & 0xFF;
+    BenchFrame[2] = ( BENCH_DEV_ADDR >> 8 ) & 0xFF;
+    BenchFrame[3] = ( BENCH_DEV_ADDR >> 16 ) & 0xFF;
+    BenchFrame[4] = ( BENCH_DEV_ADDR >> 24 ) & 0xFF;
+    BenchFrame[5] = 0;
+    BenchFrame[6] = fCnt & 0xFF;
+    BenchFrame[7] = ( fCnt >> 8 ) & 0xFF;
+    BenchFrame[8] = BENCH_FPORT;
+
+    // FRMPayload = aes128_encrypt(AppSKey, Ai) xor payload
+    aBlock[0] = 0x01;
+    aBlock[5] = 0x01;
+    memcpy1( &aBlock[6], &BenchFrame[1], 4 );
+    aBlock[10] = fCnt & 0xFF;
+    aBlock[11] = ( fCnt >> 8 ) & 0xFF;
+    aBlock[12] = ( fCnt >> 16 ) & 0xFF;
+    aBlock[13] = ( fCnt >> 24 ) & 0xFF;
+    for( uint8_t i = 0; i < size; i++ )
+    {
+        if( ( i % 16 ) == 0 )
+        {
+            aBlock[15] = ( i >> 4 ) + 1;
+            if( SecureElementAesEncrypt( aBlock, 16, APP_S_KEY, sBlock ) != SECURE_ELEMENT_SUCCESS )
+            {
+                return 0;
+            }
+        }
+        BenchFrame[BENCH_FRMPAYLOAD_OFFSET + i] = BenchData[i] ^ sBlock[i % 16];
+    }
+
+    // MIC = aes128_cmac(SNwkSIntKey, B0 | msg)
+    b0[0] = 0x49;
+    memcpy1( &b0[5], &aBlock[5], 9 );
+    b0[15] = len;
+    if( SecureElementComputeAesCmac( b0, BenchFrame, len, S_NWK_S_INT_KEY, &mic ) != SECURE_ELEMENT_SUCCESS )
+    {
+        return 0;
+    }
+    BenchFrame[len++] = mic & 0xFF;
+    BenchFrame[len++] = ( mic >> 8 ) & 0xFF;
+    BenchFrame[len++] = ( mic >> 16 ) & 0xFF;
+    BenchFrame[len++] = ( mic >> 24 ) & 0xFF;
+    return len;
+}
+
+static void BenchUnsecureMessage( uint8_t size )
+{
+    BenchResult_t result;
+    LoRaMacMessageData_t macMsg;
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        // A downlink as received by LoRaMac, it is decrypted in place
+        memset1( ( uint8_t* )&macMsg, 0, sizeof( macMsg ) );
+        macMsg.BufSize = BuildDownlink( size, ++FCntDown );
+        macMsg.Buffer = BenchFrame;
+        macMsg.FRMPayload = &BenchFrame[BENCH_FRMPAYLOAD_OFFSET];
+        macMsg.FRMPayloadSize = size;
+
+        CryptoBenchCounterStart( );
+        LoRaMacCryptoStatus_t status = LoRaMacCryptoUnsecureMessage( UNICAST_DEV_ADDR, BENCH_DEV_ADDR, FCNT_DOWN, FCntDown, &macMsg );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+        if( ( macMsg.BufSize == 0 ) || ( status != LORAMAC_CRYPTO_SUCCESS ) )
+        {
+            ErrorPrint( "unsecure_message", size, status );
+            return;
+        }
+    }
+    ResultPrint( "unsecure_message", size, &result );
+}
+
+static void BenchJoinAccept( void )
+{
+    BenchResult_t result;
+    LoRaMacMessageJoinAccept_t macMsg;
+    uint8_t joinAccept[BENCH_JOIN_ACCEPT_SIZE];
+    uint8_t joinEui[8] = { 0 };
+    aes_context ctx;
+    uint32_t mic;
+
+    // MHDR | JoinNonce | NetID | DevAddr | DLSettings | RxDelay | MIC, LoRaWAN 1.0.x
+    memset1( joinAccept, 0, sizeof( joinAccept ) );
+    joinAccept[0] = FRAME_TYPE_JOIN_ACCEPT << 5;
+    joinAccept[1] = 0x01;
+    joinAccept[4] = 0x13;
+    joinAccept[7] = BENCH_DEV_ADDR & 0xFF;
+    joinAccept[8] = ( BENCH_DEV_ADDR >> 8 ) & 0xFF;
+    joinAccept[9] = ( BENCH_DEV_ADDR >> 16 ) & 0xFF;
+    joinAccept[10] = ( BENCH_DEV_ADDR >> 24 ) & 0xFF;
+    joinAccept[12] = 0x01;
+    if( SecureElementComputeAesCmac( NULL, joinAccept, BENCH_JOIN_ACCEPT_SIZE - LORAMAC_MIC_FIELD_SIZE, NWK_KEY, &mic ) != SECURE_ELEMENT_SUCCESS )
+    {
+        ErrorPrint( "join_accept", BENCH_JOIN_ACCEPT_SIZE, LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC );
+        return;
+    }
+    joinAccept[13] = mic & 0xFF;
+    joinAccept[14] = ( mic >> 8 ) & 0xFF;
+    joinAccept[15] = ( mic >> 16 ) & 0xFF;
+    joinAccept[16] = ( mic >> 24 ) & 0xFF;
+
+    // The network server encrypts with aes128_decrypt(NwkKey, ...)
+    aes_set_key( BenchKey, 16, &ctx );
+    aes_decrypt( &joinAccept[1], &joinAccept[1], &ctx );
+
+    ResultInit( &result );
+    for( uint16_t i = 0; i < CRYPTO_BENCH_ITERATIONS; i++ )
+    {
+        // The join accept is decrypted in place
+        memcpy1( BenchFrame, joinAccept, BENCH_JOIN_ACCEPT_SIZE );
+        memset1( ( uint8_t* )&macMsg, 0, sizeof( macMsg ) );
+        macMsg.Buffer = BenchFrame;
+        macMsg.BufSize = BENCH_JOIN_ACCEPT_SIZE;
+
+        CryptoBenchCounterStart( );
+        LoRaMacCryptoStatus_t status = LoRaMacCryptoHandleJoinAccept( JOIN_REQ, joinEui, &macMsg );
+        ResultAdd( &result, CryptoBenchCounterStop( ) );
+        if( status != LORAMAC_CRYPTO_SUCCESS )
+        {
+            ErrorPrint( "join_accept", BENCH_JOIN_ACCEPT_SIZE, status );
+            return;
+        }
+    }
+    ResultPrint( "join_accept", BENCH_JOIN_ACCEPT_SIZE, &result );
+}
+
+void CryptoBenchRun( const char* unit )
+{
+    const KeyIdentifier_t keys[] = { NWK_KEY, APP_S_KEY, NWK_S_ENC_KEY, S_NWK_S_INT_KEY, F_NWK_S_INT_KEY };
+    const uint8_t sizes[] = { 16, 64, 242 };
+    Version_t version = { .Fields = { .Major = 1, .Minor = 0, .Revision = 3 } };
+
+    CounterUnit = unit;
+
+    for( uint16_t i = 0; i < BENCH_FRAME_MAX_SIZE; i++ )
+    {
+        BenchData[i] = ( uint8_t )i;
+    }
+
+    SecureElementInit( NULL );
+    LoRaMacCryptoInit( NULL );
+    for( uint8_t i = 0; i < sizeof( keys ) / sizeof( keys[0] ); i++ )
+    {
+        LoRaMacCryptoSetKey( keys[i], BenchKey );
+    }
+    LoRaMacCryptoSetLrWanVersion( version );
+
+    CryptoBenchCounterInit( );
+
+    printf( "bench,unit,name,size,iterations,min,avg,max\r\n" );
+
+    BenchOverhead( );
+    BenchMem( "memcpy16", Memcpy16, 0, 16 );
+    for( uint8_t i = 0; i < sizeof( sizes ); i++ )
+    {
+        BenchMem( "memcpy_bytes", MemcpyBytes, 0, sizes[i] );
+        BenchMem( "memcpy1", memcpy1, 0, sizes[i] );
+        BenchMem( "memcpy1_unaligned", memcpy1, 1, sizes[i] );
+        BenchMem( "memset_bytes", MemsetBytes, 0, sizes[i] );
+        BenchMem( "memset1", Memset1, 0, sizes[i] );
+        BenchMem( "memcpyr_bytes", MemcpyrBytes, 0, sizes[i] );
+        BenchMem( "memcpyr", memcpyr, 0, sizes[i] );
+    }
+    BenchAesSetKey( );
+    BenchAesEncrypt( );
+    BenchSeAesEncrypt( );
+    for( uint8_t i = 0; i < sizeof( sizes ); i++ )
+    {
+        BenchCmac( sizes[i] );
+    }
+    for( uint8_t i = 0; i < sizeof( sizes ); i++ )
+    {
+        BenchSeCmac( sizes[i] );
+    }
+    for( uint8_t i = 0; i < sizeof( sizes ); i++ )
+    {
+        BenchSecureMessage( sizes[i] );
+    }
+    for( uint8_t i = 0; i < sizeof( sizes ); i++ )
+    {
+        BenchUnsecureMessage( sizes[i] );
+    }
+    // Derives new session keys, runs last
+    BenchJoinAccept( );
+
+    printf( "bench,end\r\n" );
+}
@@ -0,0 +1,78 @@
+/*!
+ * \file      CryptoBench.h
+ *
+ * \brief     LoRaMac crypto stack micro-benchmarks
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __CRYPTO_BENCH_H__
+#define __CRYPTO_BENCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * Number of timed runs of each benchmark
+ */
+#ifndef CRYPTO_BENCH_ITERATIONS
+#define CRYPTO_BENCH_ITERATIONS                     100
+#endif
+
+/*!
+ * \brief Runs all the benchmarks and prints the results
+ *
+ * \details The results are printed as comma separated lines:
+ *
+ *          bench,<unit>,<name>,<size>,<iterations>,<min>,<avg>,<max>
+ *
+ *          The first line is the column header, the results end with the
+ *          line "bench,end". The "overhead" benchmark gives the cost of the
+ *          counter reads, it is not subtracted from the other results.
+ *
+ * \param [IN] unit Unit of the counter, printed with each result
+ */
+void CryptoBenchRun( const char* unit );
+
+/*!
+ * \brief Initializes the counter used to time the benchmarks
+ *
+ * \remark Implemented by the board specific application.
+ */
+void CryptoBenchCounterInit( void );
+
+/*!
+ * \brief Starts a measurement
+ *
+ * \remark Implemented by the board specific application.
+ */
+void CryptoBenchCounterStart( void );
+
+/*!
+ * \brief Stops a measurement
+ *
+ * \remark Implemented by the board specific application.
+ *
+ * \retval elapsed Counter ticks since CryptoBenchCounterStart
+ */
+uint32_t CryptoBenchCounterStop( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CRYPTO_BENCH_H__
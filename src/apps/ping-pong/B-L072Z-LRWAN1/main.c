@@ -21,12 +21,19 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <string.h>
+#if defined( PING_PONG_BENCH_ENABLED )
+#include "stm32l0xx.h"
+#endif
 #include "board.h"
 #include "gpio.h"
 #include "delay.h"
 #include "timer.h"
 #include "radio.h"
 
+#if defined( PING_PONG_BENCH_ENABLED )
+#include "PingPongBench.h"
+#endif
+
 #if defined( REGION_AS923 )
 
 #define RF_FREQUENCY                                923000000 // Hz
@@ -75,15 +82,21 @@
 
 #if defined( USE_MODEM_LORA )
 
+#ifndef LORA_BANDWIDTH
 #define LORA_BANDWIDTH                              0         // [0: 125 kHz,
                                                               //  1: 250 kHz,
                                                               //  2: 500 kHz,
                                                               //  3: Reserved]
+#endif
+#ifndef LORA_SPREADING_FACTOR
 #define LORA_SPREADING_FACTOR                       7         // [SF7..SF12]
+#endif
+#ifndef LORA_CODINGRATE
 #define LORA_CODINGRATE                             1         // [1: 4/5,
                                                               //  2: 4/6,
                                                               //  3: 4/7,
                                                               //  4: 4/8]
+#endif
 #define LORA_PREAMBLE_LENGTH                        8         // Same for Tx and Rx
 #define LORA_SYMBOL_TIMEOUT                         5         // Symbols
 #define LORA_FIX_LENGTH_PAYLOAD_ON                  false
@@ -92,7 +105,9 @@
 #elif defined( USE_MODEM_FSK )
 
 #define FSK_FDEV                                    25000     // Hz
+#ifndef FSK_DATARATE
 #define FSK_DATARATE                                50000     // bps
+#endif
 #define FSK_BANDWIDTH                               50000     // Hz
 #define FSK_AFC_BANDWIDTH                           83333     // Hz
 #define FSK_PREAMBLE_LENGTH                         5         // Same for Tx and Rx
@@ -162,6 +177,38 @@ void OnRxTimeout( void );
  */
 void OnRxError( void );
 
+#if defined( PING_PONG_BENCH_ENABLED )
+
+void PingPongBenchCounterInit( void )
+{
+}
+
+/*!
+ * \remark The Cortex-M0+ has no DWT cycle counter. SysTick drives the 1 ms
+ *         HAL tick, the milliseconds are extended with the SysTick down
+ *         counter value.
+ */
+uint32_t PingPongBenchCounterRead( void )
+{
+    uint32_t ms;
+    uint32_t val;
+
+    do
+    {
+        ms = HAL_GetTick( );
+        val = SysTick->VAL;
+    }while( ms != HAL_GetTick( ) );
+
+    return ( uint32_t )( ( ( uint64_t )ms * ( SysTick->LOAD + 1 ) ) + ( SysTick->LOAD - val ) );
+}
+
+uint32_t PingPongBenchCounterElapsed( uint32_t start )
+{
+    return PingPongBenchCounterRead( ) - start;
+}
+
+#endif
+
 /**
  * Main application entry point.
  */
@@ -181,6 +228,10 @@ int main( void )
     RadioEvents.RxTimeout = OnRxTimeout;
     RadioEvents.RxError = OnRxError;
 
+#if defined( PING_PONG_BENCH_ENABLED )
+    PingPongBenchInit( &RadioEvents );
+#endif
+
     Radio.Init( &RadioEvents );
 
     Radio.SetChannel( RF_FREQUENCY );
@@ -213,10 +264,22 @@ int main( void )
     #error "Please define a frequency band in the compiler options."
 #endif
 
+#if defined( PING_PONG_BENCH_ENABLED )
+#if defined( USE_MODEM_LORA )
+    PingPongBenchStart( MODEM_LORA, "cycles" );
+#else
+    PingPongBenchStart( MODEM_FSK, "cycles" );
+#endif
+#else
     Radio.Rx( RX_TIMEOUT_VALUE );
+#endif
 
     while( 1 )
     {
+#if defined( PING_PONG_BENCH_ENABLED )
+        PingPongBenchProcess( );
+#endif
+
         switch( State )
         {
         case RX:
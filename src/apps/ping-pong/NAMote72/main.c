@@ -21,6 +21,9 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <string.h>
+#if defined( PING_PONG_BENCH_ENABLED )
+#include "stm32l1xx.h"
+#endif
 #include "board-config.h"
 #include "board.h"
 #include "gpio.h"
@@ -28,6 +31,10 @@
 #include "timer.h"
 #include "radio.h"
 
+#if defined( PING_PONG_BENCH_ENABLED )
+#include "PingPongBench.h"
+#endif
+
 #if defined( REGION_AS923 )
 
 #define RF_FREQUENCY                                923000000 // Hz
@@ -68,15 +75,21 @@
 
 #if defined( USE_MODEM_LORA )
 
+#ifndef LORA_BANDWIDTH
 #define LORA_BANDWIDTH                              0         // [0: 125 kHz,
                                                               //  1: 250 kHz,
                                                               //  2: 500 kHz,
                                                               //  3: Reserved]
+#endif
+#ifndef LORA_SPREADING_FACTOR
 #define LORA_SPREADING_FACTOR                       7         // [SF7..SF12]
+#endif
+#ifndef LORA_CODINGRATE
 #define LORA_CODINGRATE                             1         // [1: 4/5,
                                                               //  2: 4/6,
                                                               //  3: 4/7,
                                                               //  4: 4/8]
+#endif
 #define LORA_PREAMBLE_LENGTH                        8         // Same for Tx and Rx
 #define LORA_SYMBOL_TIMEOUT                         5         // Symbols
 #define LORA_FIX_LENGTH_PAYLOAD_ON                  false
@@ -85,7 +98,9 @@
 #elif defined( USE_MODEM_FSK )
 
 #define FSK_FDEV                                    25000     // Hz
+#ifndef FSK_DATARATE
 #define FSK_DATARATE                                50000     // bps
+#endif
 #define FSK_BANDWIDTH                               50000     // Hz
 #define FSK_AFC_BANDWIDTH                           83333     // Hz
 #define FSK_PREAMBLE_LENGTH                         5         // Same for Tx and Rx
@@ -155,6 +170,27 @@ void OnRxTimeout( void );
  */
 void OnRxError( void );
 
+#if defined( PING_PONG_BENCH_ENABLED )
+
+void PingPongBenchCounterInit( void )
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+uint32_t PingPongBenchCounterRead( void )
+{
+    return DWT->CYCCNT;
+}
+
+uint32_t PingPongBenchCounterElapsed( uint32_t start )
+{
+    return DWT->CYCCNT - start;
+}
+
+#endif
+
 /**
  * Main application entry point.
  */
@@ -174,6 +210,10 @@ int main( void )
     RadioEvents.RxTimeout = OnRxTimeout;
     RadioEvents.RxError = OnRxError;
 
+#if defined( PING_PONG_BENCH_ENABLED )
+    PingPongBenchInit( &RadioEvents );
+#endif
+
     Radio.Init( &RadioEvents );
 
     Radio.SetChannel( RF_FREQUENCY );
@@ -206,10 +246,22 @@ int main( void )
     #error "Please define a frequency band in the compiler options."
 #endif
 
+#if defined( PING_PONG_BENCH_ENABLED )
+#if defined( USE_MODEM_LORA )
+    PingPongBenchStart( MODEM_LORA, "cycles" );
+#else
+    PingPongBenchStart( MODEM_FSK, "cycles" );
+#endif
+#else
     Radio.Rx( RX_TIMEOUT_VALUE );
+#endif
 
     while( 1 )
     {
+#if defined( PING_PONG_BENCH_ENABLED )
+        PingPongBenchProcess( );
+#endif
+
         switch( State )
         {
         case RX:
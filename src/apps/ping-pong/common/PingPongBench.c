@@ -0,0 +1,333 @@
+/*!
+ * \file      PingPongBench.c
+ *
+ * \brief     Ping-Pong maximum throughput benchmark
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdio.h>
+#include <string.h>
+#include "utilities.h"
+#include "timer.h"
+#include "spi.h"
+#include "PingPongBench.h"
+
+#if ( PING_PONG_BENCH_PAYLOAD_SIZE < 6 ) || ( PING_PONG_BENCH_PAYLOAD_SIZE > 255 )
+    #error "PING_PONG_BENCH_PAYLOAD_SIZE must be in the [6..255] range"
+#endif
+
+/*!
+ * Benchmark statistics type definition
+ */
+typedef struct sPingPongBenchStats
+{
+    /*!
+     * Number of frames received as expected
+     */
+    uint32_t Frames;
+    /*!
+     * Number of reception timeouts, errors and out of sequence frames
+     */
+    uint32_t Lost;
+    /*!
+     * Number of measured turnarounds
+     */
+    uint32_t Turnarounds;
+    /*!
+     * Turnaround minimum, sum and maximum
+     */
+    uint32_t TurnaroundMin;
+    uint64_t TurnaroundSum;
+    uint32_t TurnaroundMax;
+    /*!
+     * Turnaround histogram
+     */
+    uint32_t Histogram[PING_PONG_BENCH_HISTOGRAM_SIZE];
+    /*!
+     * Counter ticks spent in SPI transfers
+     */
+    uint64_t SpiTime;
+}PingPongBenchStats_t;
+
+static const uint8_t PingMsg[] = "PING";
+static const uint8_t PongMsg[] = "PONG";
+
+/*!
+ * Frame being sent
+ */
+static uint8_t Buffer[PING_PONG_BENCH_PAYLOAD_SIZE];
+
+/*!
+ * Statistics of the ongoing report period
+ */
+static PingPongBenchStats_t Stats;
+
+/*!
+ * Start of the ongoing report period
+ */
+static TimerTime_t PeriodStart;
+
+/*!
+ * Master reception timeout [ms]
+ */
+static uint32_t RxTimeout;
+
+/*!
+ * Sequence number of the last sent PING
+ */
+static uint16_t Sequence;
+
+static bool IsMaster;
+static bool IsStarted;
+static const char* CounterUnit;
+
+#if defined( SPI_STATS_ENABLED )
+/*!
+ * SPI transfers nesting depth and start of the outermost one
+ */
+static uint8_t SpiDepth;
+static uint32_t SpiStart;
+#endif
+
+/*!
+ * \brief Resets the statistics of the report period
+ */
+static void StatsReset( void )
+{
+    memset1( ( uint8_t* )&Stats, 0, sizeof( Stats ) );
+    Stats.TurnaroundMin = UINT32_MAX;
+}
+
+/*!
+ * \brief Builds the frame to send and sends it
+ *
+ * \param [IN] msg      PING or PONG message
+ * \param [IN] sequence Sequence number of the frame
+ */
+static void Send( const uint8_t* msg, uint16_t sequence )
+{
+    memcpy1( Buffer, msg, 4 );
+    Buffer[4] = ( uint8_t )( sequence >> 8 );
+    Buffer[5] = ( uint8_t )sequence;
+    for( uint16_t i = 6; i < PING_PONG_BENCH_PAYLOAD_SIZE; i++ )
+    {
+        Buffer[i] = ( uint8_t )i;
+    }
+    Radio.Send( Buffer, PING_PONG_BENCH_PAYLOAD_SIZE );
+}
+
+/*!
+ * \brief Enters reception, the master with a timeout, the slave until a
+ *        frame is received
+ */
+static void Rx( void )
+{
+    Radio.Rx( ( IsMaster == true ) ? RxTimeout : 0 );
+}
+
+/*!
+ * \brief Handles a lost frame, the master sends the next PING
+ */
+static void Lost( void )
+{
+    if( IsMaster == true )
+    {
+        Stats.Lost++;
+        Send( PingMsg, ++Sequence );
+    }
+    else
+    {
+        Rx( );
+    }
+}
+
+static void OnTxDone( void )
+{
+    uint32_t start = PingPongBenchCounterRead( );
+    uint32_t elapsed;
+    uint8_t bucket = 0;
+
+    Rx( );
+
+    elapsed = PingPongBenchCounterElapsed( start );
+    Stats.Turnarounds++;
+    Stats.TurnaroundSum += elapsed;
+    if( elapsed < Stats.TurnaroundMin )
+    {
+        Stats.TurnaroundMin = elapsed;
+    }
+    if( elapsed > Stats.TurnaroundMax )
+    {
+        Stats.TurnaroundMax = elapsed;
+    }
+    while( ( elapsed > 1 ) && ( bucket < ( PING_PONG_BENCH_HISTOGRAM_SIZE - 1 ) ) )
+    {
+        elapsed >>= 1;
+        bucket++;
+    }
+    Stats.Histogram[bucket]++;
+}
+
+static void OnRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    uint16_t sequence;
+
+    if( size < 6 )
+    {
+        Lost( );
+        return;
+    }
+    sequence = ( ( uint16_t )payload[4] << 8 ) | payload[5];
+
+    if( memcmp( payload, PingMsg, 4 ) == 0 )
+    {
+        // A master already exists or the slave got the next PING
+        IsMaster = false;
+        Stats.Frames++;
+        Send( PongMsg, sequence );
+    }
+    else if( ( IsMaster == true ) && ( memcmp( payload, PongMsg, 4 ) == 0 ) )
+    {
+        if( sequence == Sequence )
+        {
+            Stats.Frames++;
+        }
+        else
+        {
+            Stats.Lost++;
+        }
+        Send( PingMsg, ++Sequence );
+    }
+    else
+    {
+        // Neither a PING nor an expected PONG, start again as a master
+        IsMaster = true;
+        Rx( );
+    }
+}
+
+static void OnTxTimeout( void )
+{
+    Lost( );
+}
+
+static void OnRxTimeout( void )
+{
+    Lost( );
+}
+
+static void OnRxError( void )
+{
+    Lost( );
+}
+
+void PingPongBenchInit( RadioEvents_t* events )
+{
+    events->TxDone = OnTxDone;
+    events->RxDone = OnRxDone;
+    events->TxTimeout = OnTxTimeout;
+    events->RxTimeout = OnRxTimeout;
+    events->RxError = OnRxError;
+}
+
+void PingPongBenchStart( RadioModems_t modem, const char* unit )
+{
+    CounterUnit = unit;
+    RxTimeout = Radio.TimeOnAir( modem, PING_PONG_BENCH_PAYLOAD_SIZE ) + PING_PONG_BENCH_RX_MARGIN;
+    IsMaster = true;
+    Sequence = 0;
+
+    PingPongBenchCounterInit( );
+    StatsReset( );
+
+    printf( "bench,unit,role,frames,lost,frames/s,turnaround_min,turnaround_avg,turnaround_max,spi_per_frame\r\n" );
+
+    PeriodStart = TimerGetCurrentTime( );
+    IsStarted = true;
+    Rx( );
+}
+
+void PingPongBenchProcess( void )
+{
+    PingPongBenchStats_t stats;
+    TimerTime_t period;
+    uint32_t rate;
+    uint32_t avg = 0;
+    uint32_t spi = 0;
+
+    if( IsStarted == false )
+    {
+        return;
+    }
+    period = TimerGetElapsedTime( PeriodStart );
+    if( period < PING_PONG_BENCH_REPORT_PERIOD )
+    {
+        return;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    stats = Stats;
+    StatsReset( );
+    PeriodStart = TimerGetCurrentTime( );
+    CRITICAL_SECTION_END( );
+
+    if( stats.Turnarounds == 0 )
+    {
+        stats.TurnaroundMin = 0;
+    }
+    else
+    {
+        avg = ( uint32_t )( stats.TurnaroundSum / stats.Turnarounds );
+    }
+    if( stats.Frames != 0 )
+    {
+        spi = ( uint32_t )( stats.SpiTime / stats.Frames );
+    }
+    // Frames per second x 100
+    rate = ( uint32_t )( ( ( uint64_t )stats.Frames * 100000 ) / period );
+
+    printf( "bench,%s,%s,%lu,%lu,%lu.%02lu,%lu,%lu,%lu,%lu\r\n", CounterUnit,
+            ( IsMaster == true ) ? "master" : "slave",
+            ( unsigned long )stats.Frames, ( unsigned long )stats.Lost,
+            ( unsigned long )( rate / 100 ), ( unsigned long )( rate % 100 ),
+            ( unsigned long )stats.TurnaroundMin, ( unsigned long )avg,
+            ( unsigned long )stats.TurnaroundMax, ( unsigned long )spi );
+
+    printf( "hist,%s", CounterUnit );
+    for( uint8_t i = 0; i < PING_PONG_BENCH_HISTOGRAM_SIZE; i++ )
+    {
+        printf( ",%lu", ( unsigned long )stats.Histogram[i] );
+    }
+    printf( "\r\n" );
+}
+
+#if defined( SPI_STATS_ENABLED )
+
+void SpiStatsBegin( void )
+{
+    if( SpiDepth++ == 0 )
+    {
+        SpiStart = PingPongBenchCounterRead( );
+    }
+}
+
+void SpiStatsEnd( void )
+{
+    if( ( SpiDepth > 0 ) && ( --SpiDepth == 0 ) )
+    {
+        Stats.SpiTime += PingPongBenchCounterElapsed( SpiStart );
+    }
+}
+
+#endif
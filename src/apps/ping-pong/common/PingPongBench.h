@@ -0,0 +1,132 @@
+/*!
+ * \file      PingPongBench.h
+ *
+ * \brief     Ping-Pong maximum throughput benchmark
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __PING_PONG_BENCH_H__
+#define __PING_PONG_BENCH_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "radio.h"
+
+/*!
+ * Size of the PING and PONG frames. 4 bytes of message plus a 2 bytes
+ * sequence number at least.
+ */
+#ifndef PING_PONG_BENCH_PAYLOAD_SIZE
+#define PING_PONG_BENCH_PAYLOAD_SIZE                16
+#endif
+
+/*!
+ * Period of the results reports [ms]
+ */
+#ifndef PING_PONG_BENCH_REPORT_PERIOD
+#define PING_PONG_BENCH_REPORT_PERIOD               10000
+#endif
+
+/*!
+ * Time added to the time on air of the PONG frame to get the master
+ * reception timeout [ms]
+ */
+#ifndef PING_PONG_BENCH_RX_MARGIN
+#define PING_PONG_BENCH_RX_MARGIN                   10
+#endif
+
+/*!
+ * Number of buckets of the turnaround histogram. Bucket n counts the
+ * turnarounds in [2^n, 2^(n+1)[ counter ticks, the last one also counts
+ * the longer ones.
+ */
+#define PING_PONG_BENCH_HISTOGRAM_SIZE              24
+
+/*!
+ * \brief Installs the benchmark radio event handlers
+ *
+ * \remark Must be called before Radio.Init, it overrides the application
+ *         handlers.
+ *
+ * \param [IN] events Radio events given to Radio.Init
+ */
+void PingPongBenchInit( RadioEvents_t* events );
+
+/*!
+ * \brief Starts the back to back exchanges
+ *
+ * \details The radio must be configured. The device starts as a master, it
+ *          becomes a slave when it receives a PING.
+ *
+ *          The master sends the next PING as soon as it receives the PONG,
+ *          the slave replies as soon as it receives the PING. Both enter
+ *          reception as soon as their transmission is done.
+ *
+ * \param [IN] modem Modem configured by the application
+ * \param [IN] unit  Unit of the counter, printed with the results
+ */
+void PingPongBenchStart( RadioModems_t modem, const char* unit );
+
+/*!
+ * \brief Prints the results of the elapsed report period
+ *
+ * \details Called from the application main loop. The results are printed
+ *          as comma separated lines:
+ *
+ *          bench,<unit>,<role>,<frames>,<lost>,<frames/s>,<turnaround min>,
+ *          <turnaround avg>,<turnaround max>,<spi per frame>
+ *          hist,<unit>,<bucket 0>,...,<bucket PING_PONG_BENCH_HISTOGRAM_SIZE - 1>
+ *
+ *          The turnaround goes from the TX done event to the return of
+ *          Radio.Rx. The SPI time per frame is 0 when SPI_STATS_ENABLED isn't
+ *          defined. The counters are reset after each report.
+ */
+void PingPongBenchProcess( void );
+
+/*!
+ * \brief Initializes the counter used to time the turnarounds and the SPI
+ *        transfers
+ *
+ * \remark Implemented by the board specific application.
+ */
+void PingPongBenchCounterInit( void );
+
+/*!
+ * \brief Reads the counter
+ *
+ * \remark Implemented by the board specific application.
+ *
+ * \retval value Free running counter value
+ */
+uint32_t PingPongBenchCounterRead( void );
+
+/*!
+ * \brief Computes the ticks elapsed since a counter value
+ *
+ * \remark Implemented by the board specific application.
+ *
+ * \param [IN] start Value returned by PingPongBenchCounterRead
+ * \retval elapsed Counter ticks since start
+ */
+uint32_t PingPongBenchCounterElapsed( uint32_t start );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __PING_PONG_BENCH_H__
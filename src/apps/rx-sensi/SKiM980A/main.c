@@ -29,6 +29,8 @@
 #include "gpio.h"
 #include "timer.h"
 #include "radio.h"
+#include "uart.h"
+#include "SensiStats.h"
 
 #if defined( REGION_AS923 )
 
@@ -94,6 +96,48 @@
     #error "Please define a modem in the compiler options."
 #endif
 
+#if defined( RX_SENSI_STATS_ENABLED )
+
+/*!
+ * Listening time of each step of the sensitivity campaign [ms]
+ */
+#ifndef SENSI_STEP_DURATION
+#define SENSI_STEP_DURATION                         10000
+#endif
+
+/*!
+ * Channel spacing of the sensitivity campaign frequency sweep [Hz]
+ */
+#define SENSI_CHANNEL_SPACING                       200000
+
+/*!
+ * Sensitivity campaign. The steps run in turn, forever.
+ */
+static const SensiSweepStep_t SensiSteps[] =
+{
+#if defined( USE_MODEM_LORA )
+    { RF_FREQUENCY, 7, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY, 8, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY, 9, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY, 10, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY, 11, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY, 12, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY - SENSI_CHANNEL_SPACING, LORA_SPREADING_FACTOR, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY + SENSI_CHANNEL_SPACING, LORA_SPREADING_FACTOR, LORA_BANDWIDTH, SENSI_STEP_DURATION },
+#elif defined( USE_MODEM_FSK )
+    { RF_FREQUENCY, FSK_DATARATE, FSK_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY - SENSI_CHANNEL_SPACING, FSK_DATARATE, FSK_BANDWIDTH, SENSI_STEP_DURATION },
+    { RF_FREQUENCY + SENSI_CHANNEL_SPACING, FSK_DATARATE, FSK_BANDWIDTH, SENSI_STEP_DURATION },
+#endif
+};
+
+/*!
+ * UART streaming the statistics summaries
+ */
+extern Uart_t Uart1;
+
+#endif
+
 /*!
  * Radio events function pointer
  */
@@ -109,6 +153,28 @@ extern Gpio_t Led4;
  */
 void OnRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr );
 
+#if defined( RX_SENSI_STATS_ENABLED )
+/*!
+ * \brief Function to be executed on Radio Rx Error event
+ */
+void OnRxError( void );
+
+/*!
+ * \brief Sets the radio in continuous reception for a sensitivity campaign step
+ *
+ * \param [IN] step Step to be run
+ */
+static void SensiRxConfig( const SensiSweepStep_t *step );
+
+/*!
+ * \brief Writes a statistics summary frame to the UART
+ *
+ * \param [IN] buffer Frame to be written
+ * \param [IN] size   Frame size
+ */
+static void SensiWrite( const uint8_t *buffer, uint16_t size );
+#endif
+
 /*!
  * Main application entry point.
  */
@@ -120,6 +186,9 @@ int main( void )
 
     // Radio initialization
     RadioEvents.RxDone = OnRxDone;
+#if defined( RX_SENSI_STATS_ENABLED )
+    RadioEvents.RxError = OnRxError;
+#endif
 
     Radio.Init( &RadioEvents );
 
@@ -145,8 +214,15 @@ int main( void )
 
     Radio.Rx( 0 ); // Continuous Rx
 
+#if defined( RX_SENSI_STATS_ENABLED )
+    SensiStatsStart( SensiSteps, sizeof( SensiSteps ) / sizeof( SensiSweepStep_t ), SensiRxConfig, SensiWrite );
+#endif
+
     while( 1 )
     {
+#if defined( RX_SENSI_STATS_ENABLED )
+        SensiStatsProcess( );
+#endif
         BoardLowPowerHandler( );
     }
 }
@@ -157,4 +233,46 @@ void OnRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
     // Toggle LED 4
     ledState ^= 1;
     GpioWrite( &Led4, ledState );
+
+#if defined( RX_SENSI_STATS_ENABLED )
+    SensiStatsRxDone( payload, size, rssi, snr, ( Radio.GetFreqError != NULL ) ? Radio.GetFreqError( ) : 0 );
+#endif
+}
+
+#if defined( RX_SENSI_STATS_ENABLED )
+
+void OnRxError( void )
+{
+    SensiStatsRxError( );
 }
+
+static void SensiRxConfig( const SensiSweepStep_t *step )
+{
+    Radio.Sleep( );
+    Radio.SetChannel( step->Frequency );
+
+#if defined( USE_MODEM_LORA )
+
+    Radio.SetRxConfig( MODEM_LORA, step->Bandwidth, step->Datarate,
+                                   LORA_CODINGRATE, 0, LORA_PREAMBLE_LENGTH,
+                                   LORA_SYMBOL_TIMEOUT, LORA_FIX_LENGTH_PAYLOAD_ON,
+                                   0, true, 0, 0, LORA_IQ_INVERSION_ON, true );
+
+#elif defined( USE_MODEM_FSK )
+
+    Radio.SetRxConfig( MODEM_FSK, step->Bandwidth, step->Datarate,
+                                  0, FSK_AFC_BANDWIDTH, FSK_PREAMBLE_LENGTH,
+                                  0, FSK_FIX_LENGTH_PAYLOAD_ON, 0, true,
+                                  0, 0, false, true );
+
+#endif
+
+    Radio.Rx( 0 ); // Continuous Rx
+}
+
+static void SensiWrite( const uint8_t *buffer, uint16_t size )
+{
+    while( UartPutBuffer( &Uart1, ( uint8_t* )buffer, size ) != 0 ){ };
+}
+
+#endif
@@ -0,0 +1,270 @@
+/*!
+ * \file      SensiStats.c
+ *
+ * \brief     Radio sensitivity test reception statistics
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "utilities.h"
+#include "timer.h"
+#include "SensiStats.h"
+
+#if ( SENSI_STATS_SUMMARY_SIZE > 255 )
+    #error "The summary frame length doesn't fit in its length field. Reduce the number of histogram bins."
+#endif
+
+/*!
+ * Campaign steps
+ */
+static const SensiSweepStep_t *Steps;
+static uint8_t NbSteps;
+static uint8_t StepIndex;
+
+static SensiStatsRxConfig_t RxConfig;
+static SensiStatsWrite_t Write;
+
+/*!
+ * Statistics of the running step. Updated from the radio IRQ.
+ */
+static SensiStats_t Stats;
+
+/*!
+ * Set by the step timer when the running step is over
+ */
+static volatile bool IsStepDone = false;
+
+static TimerEvent_t StepTimer;
+
+/*!
+ * Summary frame buffer
+ */
+static uint8_t Frame[SENSI_STATS_FRAME_SIZE];
+
+/*!
+ * \brief Function executed on StepTimer event
+ */
+static void OnStepTimerEvent( void* context );
+
+/*!
+ * \brief Resets the statistics and starts the step
+ *
+ * \param [IN] index Step index
+ */
+static void StepStart( uint8_t index );
+
+/*!
+ * \brief Returns the histogram bin of a value
+ *
+ * \param [IN] value  Value
+ * \param [IN] min    First bin start
+ * \param [IN] step   Bins width
+ * \param [IN] nbBins Number of bins
+ * \retval     bin    Bin index, out of range values go to the first or last bin
+ */
+static uint8_t HistogramBin( int32_t value, int32_t min, int32_t step, uint8_t nbBins );
+
+/*!
+ * \brief Writes a little endian value to the frame
+ *
+ * \param [IN] p     Frame write position
+ * \param [IN] value Value to be written
+ * \retval     p     Next frame write position
+ */
+static uint8_t* WriteLe16( uint8_t *p, uint16_t value );
+static uint8_t* WriteLe32( uint8_t *p, uint32_t value );
+
+void SensiStatsStart( const SensiSweepStep_t *steps, uint8_t nbSteps, SensiStatsRxConfig_t rxConfig, SensiStatsWrite_t write )
+{
+    Steps = steps;
+    NbSteps = nbSteps;
+    RxConfig = rxConfig;
+    Write = write;
+
+    TimerInit( &StepTimer, OnStepTimerEvent );
+    StepStart( 0 );
+}
+
+void SensiStatsRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr, int32_t freqError )
+{
+    uint32_t now = TimerGetCurrentTime( );
+
+    if( Stats.NbRx == 0 )
+    {
+        Stats.FirstRxTime = now;
+        Stats.RssiMin = rssi;
+        Stats.RssiMax = rssi;
+        Stats.SnrMin = snr;
+        Stats.SnrMax = snr;
+        Stats.FreqErrorMin = freqError;
+        Stats.FreqErrorMax = freqError;
+    }
+    Stats.LastRxTime = now;
+
+    if( size >= 2 )
+    {
+        uint16_t counter = ( ( uint16_t )payload[0] << 8 ) | payload[1];
+
+        if( Stats.NbRx != 0 )
+        {
+            // Modulo 2^16 difference, repeated packets don't count as lost
+            uint16_t gap = counter - Stats.LastCounter;
+
+            if( gap != 0 )
+            {
+                Stats.NbLost += gap - 1;
+            }
+        }
+        Stats.LastCounter = counter;
+    }
+    Stats.NbRx++;
+
+    Stats.RssiMin = MIN( Stats.RssiMin, rssi );
+    Stats.RssiMax = MAX( Stats.RssiMax, rssi );
+    Stats.RssiSum += rssi;
+    Stats.SnrMin = MIN( Stats.SnrMin, snr );
+    Stats.SnrMax = MAX( Stats.SnrMax, snr );
+    Stats.SnrSum += snr;
+    Stats.FreqErrorMin = MIN( Stats.FreqErrorMin, freqError );
+    Stats.FreqErrorMax = MAX( Stats.FreqErrorMax, freqError );
+    Stats.FreqErrorSum += freqError;
+
+    Stats.RssiHistogram[HistogramBin( rssi, SENSI_STATS_RSSI_MIN, SENSI_STATS_RSSI_STEP, SENSI_STATS_RSSI_BINS )]++;
+    Stats.SnrHistogram[HistogramBin( snr, SENSI_STATS_SNR_MIN, SENSI_STATS_SNR_STEP, SENSI_STATS_SNR_BINS )]++;
+}
+
+void SensiStatsRxError( void )
+{
+    Stats.NbCrcErrors++;
+}
+
+void SensiStatsProcess( void )
+{
+    SensiStats_t stats;
+    uint16_t size;
+
+    if( IsStepDone == false )
+    {
+        return;
+    }
+    IsStepDone = false;
+
+    CRITICAL_SECTION_BEGIN( );
+    stats = Stats;
+    CRITICAL_SECTION_END( );
+
+    size = SensiStatsFrameBuild( &stats, Frame );
+    if( Write != NULL )
+    {
+        Write( Frame, size );
+    }
+
+    StepStart( ( StepIndex + 1 ) % NbSteps );
+}
+
+uint16_t SensiStatsFrameBuild( const SensiStats_t *stats, uint8_t *buffer )
+{
+    uint8_t *p = buffer + 3;
+    int32_t nbRx = ( stats->NbRx != 0 ) ? ( int32_t )stats->NbRx : 1;
+    int16_t rssiAvg = stats->RssiSum / nbRx;
+    int8_t snrAvg = stats->SnrSum / nbRx;
+    int32_t freqErrorAvg = stats->FreqErrorSum / nbRx;
+    uint8_t checksum = 0;
+
+    buffer[0] = SENSI_STATS_FRAME_SYNC0;
+    buffer[1] = SENSI_STATS_FRAME_SYNC1;
+    buffer[2] = SENSI_STATS_SUMMARY_SIZE;
+
+    *p++ = stats->Step;
+    p = WriteLe32( p, stats->Frequency );
+    p = WriteLe32( p, stats->Datarate );
+    p = WriteLe32( p, stats->LastRxTime - stats->FirstRxTime );
+    p = WriteLe32( p, stats->NbRx );
+    p = WriteLe32( p, stats->NbLost );
+    p = WriteLe32( p, stats->NbCrcErrors );
+    p = WriteLe16( p, stats->RssiMin );
+    p = WriteLe16( p, rssiAvg );
+    p = WriteLe16( p, stats->RssiMax );
+    *p++ = stats->SnrMin;
+    *p++ = snrAvg;
+    *p++ = stats->SnrMax;
+    p = WriteLe32( p, stats->FreqErrorMin );
+    p = WriteLe32( p, freqErrorAvg );
+    p = WriteLe32( p, stats->FreqErrorMax );
+    *p++ = SENSI_STATS_RSSI_BINS;
+    for( uint8_t i = 0; i < SENSI_STATS_RSSI_BINS; i++ )
+    {
+        p = WriteLe16( p, stats->RssiHistogram[i] );
+    }
+    *p++ = SENSI_STATS_SNR_BINS;
+    for( uint8_t i = 0; i < SENSI_STATS_SNR_BINS; i++ )
+    {
+        p = WriteLe16( p, stats->SnrHistogram[i] );
+    }
+
+    for( uint16_t i = 3; i < ( 3 + SENSI_STATS_SUMMARY_SIZE ); i++ )
+    {
+        checksum += buffer[i];
+    }
+    *p++ = checksum;
+
+    return p - buffer;
+}
+
+static void OnStepTimerEvent( void* context )
+{
+    IsStepDone = true;
+}
+
+static void StepStart( uint8_t index )
+{
+    const SensiSweepStep_t *step = &Steps[index];
+
+    StepIndex = index;
+
+    CRITICAL_SECTION_BEGIN( );
+    memset1( ( uint8_t* )&Stats, 0, sizeof( SensiStats_t ) );
+    Stats.Step = index;
+    Stats.Frequency = step->Frequency;
+    Stats.Datarate = step->Datarate;
+    CRITICAL_SECTION_END( );
+
+    RxConfig( step );
+
+    TimerSetValue( &StepTimer, step->Duration );
+    TimerStart( &StepTimer );
+}
+
+static uint8_t* WriteLe16( uint8_t *p, uint16_t value )
+{
+    *p++ = value & 0xFF;
+    *p++ = ( value >> 8 ) & 0xFF;
+    return p;
+}
+
+static uint8_t* WriteLe32( uint8_t *p, uint32_t value )
+{
+    p = WriteLe16( p, value & 0xFFFF );
+    return WriteLe16( p, ( value >> 16 ) & 0xFFFF );
+}
+
+static uint8_t HistogramBin( int32_t value, int32_t min, int32_t step, uint8_t nbBins )
+{
+    if( value < min )
+    {
+        return 0;
+    }
+    return MIN( ( value - min ) / step, nbBins - 1 );
+}
@@ -0,0 +1,205 @@
+/*!
+ * \file      SensiStats.h
+ *
+ * \brief     Radio sensitivity test reception statistics
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __SENSI_STATS_H__
+#define __SENSI_STATS_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * RSSI histogram. The first bin starts at SENSI_STATS_RSSI_MIN [dBm], the
+ * values out of range are counted in the first or last bin.
+ */
+#ifndef SENSI_STATS_RSSI_MIN
+#define SENSI_STATS_RSSI_MIN                        -148
+#endif
+#ifndef SENSI_STATS_RSSI_STEP
+#define SENSI_STATS_RSSI_STEP                       2
+#endif
+#ifndef SENSI_STATS_RSSI_BINS
+#define SENSI_STATS_RSSI_BINS                       32
+#endif
+
+/*!
+ * SNR histogram. The first bin starts at SENSI_STATS_SNR_MIN [dB], the values
+ * out of range are counted in the first or last bin.
+ */
+#ifndef SENSI_STATS_SNR_MIN
+#define SENSI_STATS_SNR_MIN                         -20
+#endif
+#ifndef SENSI_STATS_SNR_STEP
+#define SENSI_STATS_SNR_STEP                        1
+#endif
+#ifndef SENSI_STATS_SNR_BINS
+#define SENSI_STATS_SNR_BINS                        32
+#endif
+
+/*!
+ * Summary frame synchronization bytes. Decoded by tools/sensi-decoder.py
+ *
+ * Frame: 0xA5 0xC3 | Length (1) | Summary (Length) | Checksum (1)
+ *
+ * Summary: Step (1) | Frequency (4) | Datarate (4) | Duration (4) |
+ *          NbRx (4) | NbLost (4) | NbCrcErrors (4) |
+ *          RssiMin (2) | RssiAvg (2) | RssiMax (2) |
+ *          SnrMin (1) | SnrAvg (1) | SnrMax (1) |
+ *          FreqErrorMin (4) | FreqErrorAvg (4) | FreqErrorMax (4) |
+ *          NbRssiBins (1) | RssiBins (2 each) | NbSnrBins (1) | SnrBins (2 each)
+ *
+ * The fields are little endian and the signed ones two's complement. The
+ * checksum is the 8-bit sum of the summary bytes.
+ */
+#define SENSI_STATS_FRAME_SYNC0                     0xA5
+#define SENSI_STATS_FRAME_SYNC1                     0xC3
+#define SENSI_STATS_SUMMARY_SIZE                    ( 48 + ( 2 * SENSI_STATS_RSSI_BINS ) + ( 2 * SENSI_STATS_SNR_BINS ) )
+#define SENSI_STATS_FRAME_SIZE                      ( 4 + SENSI_STATS_SUMMARY_SIZE )
+
+/*!
+ * Sensitivity campaign step
+ */
+typedef struct sSensiSweepStep
+{
+    /*!
+     * RF frequency [Hz]
+     */
+    uint32_t Frequency;
+    /*!
+     * Datarate. Same encoding as Radio.SetRxConfig
+     */
+    uint32_t Datarate;
+    /*!
+     * Bandwidth. Same encoding as Radio.SetRxConfig
+     */
+    uint32_t Bandwidth;
+    /*!
+     * Listening time [ms]
+     */
+    uint32_t Duration;
+}SensiSweepStep_t;
+
+/*!
+ * Statistics of a step
+ */
+typedef struct sSensiStats
+{
+    uint8_t Step;
+    uint32_t Frequency;
+    uint32_t Datarate;
+    /*!
+     * Time between the first and the last received packet [ms]
+     */
+    uint32_t FirstRxTime;
+    uint32_t LastRxTime;
+    uint32_t NbRx;
+    /*!
+     * Packets missing from the counter sequence
+     */
+    uint32_t NbLost;
+    uint32_t NbCrcErrors;
+    int16_t RssiMin;
+    int16_t RssiMax;
+    int32_t RssiSum;
+    int8_t SnrMin;
+    int8_t SnrMax;
+    int32_t SnrSum;
+    int32_t FreqErrorMin;
+    int32_t FreqErrorMax;
+    int64_t FreqErrorSum;
+    uint16_t LastCounter;
+    uint16_t RssiHistogram[SENSI_STATS_RSSI_BINS];
+    uint16_t SnrHistogram[SENSI_STATS_SNR_BINS];
+}SensiStats_t;
+
+/*!
+ * Summary frame output function. Typically writes to the board UART.
+ *
+ * \param [IN] buffer Frame to be written
+ * \param [IN] size   Frame size
+ */
+typedef void ( *SensiStatsWrite_t )( const uint8_t *buffer, uint16_t size );
+
+/*!
+ * Radio configuration function, sets the radio in continuous reception with
+ * the step parameters.
+ *
+ * \param [IN] step Step to be run
+ */
+typedef void ( *SensiStatsRxConfig_t )( const SensiSweepStep_t *step );
+
+/*!
+ * \brief Starts the sensitivity campaign
+ *
+ * \details The steps run in turn, forever. A summary frame is written at the
+ *          end of each step.
+ *
+ * \param [IN] steps    Steps of the campaign
+ * \param [IN] nbSteps  Number of steps
+ * \param [IN] rxConfig Radio configuration function
+ * \param [IN] write    Summary frame output function
+ */
+void SensiStatsStart( const SensiSweepStep_t *steps, uint8_t nbSteps, SensiStatsRxConfig_t rxConfig, SensiStatsWrite_t write );
+
+/*!
+ * \brief Records a received packet. Can be called from the radio IRQ.
+ *
+ * \remark The packets start with a 16 bits counter, MSB first, incremented by
+ *         the transmitter. The holes in the sequence are counted as lost
+ *         packets.
+ *
+ * \param [IN] payload   Received payload
+ * \param [IN] size      Received payload size
+ * \param [IN] rssi      Packet RSSI [dBm]
+ * \param [IN] snr       Packet SNR [dB]
+ * \param [IN] freqError Packet frequency error [Hz]
+ */
+void SensiStatsRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr, int32_t freqError );
+
+/*!
+ * \brief Records a packet received with a wrong CRC. Can be called from the
+ *        radio IRQ.
+ */
+void SensiStatsRxError( void );
+
+/*!
+ * \brief Writes the summary of a finished step and starts the next one. To be
+ *        called from the main loop.
+ */
+void SensiStatsProcess( void );
+
+/*!
+ * \brief Builds the summary frame of the given statistics
+ *
+ * \param [IN]  stats  Step statistics
+ * \param [OUT] buffer Frame buffer of SENSI_STATS_FRAME_SIZE bytes
+ * \retval      size   Frame size
+ */
+uint16_t SensiStatsFrameBuild( const SensiStats_t *stats, uint8_t *buffer );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SENSI_STATS_H__
@@ -23,6 +23,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "stm32l0xx.h"
+#include "utilities.h"
 #include "board-config.h"
 #include "adc-board.h"
 
@@ -126,3 +127,121 @@ uint16_t AdcMcuReadChannel( Adc_t *obj, uint32_t channel )
 
     return adcData;
 }
+
+uint8_t AdcMcuReadChannels( Adc_t *obj, const uint32_t *channels, uint16_t *values, uint8_t nbChannels, bool oversampling )
+{
+    ADC_InitTypeDef init = AdcHandle.Init;
+    ADC_ChannelConfTypeDef adcConf = { 0 };
+    uint8_t order[ADC_MAX_SCAN_CHANNELS];
+    uint8_t status = FAIL;
+    uint32_t tickStart = 0;
+    bool isAdcReady = true;
+    bool isInternal = false;
+
+    // The sequencer converts the selected channels by increasing channel
+    // number. Compute the sequence position of each requested channel.
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        uint8_t rank = 0;
+
+        for( uint8_t j = 0; j < nbChannels; j++ )
+        {
+            if( ( channels[j] & ADC_CHANNEL_MASK ) < ( channels[i] & ADC_CHANNEL_MASK ) )
+            {
+                rank++;
+            }
+        }
+        order[rank] = i;
+    }
+
+    // Enable HSI
+    __HAL_RCC_HSI_ENABLE( );
+
+    // Wait till HSI is ready
+    while( __HAL_RCC_GET_FLAG( RCC_FLAG_HSIRDY ) == RESET )
+    {
+    }
+
+    __HAL_RCC_ADC1_CLK_ENABLE( );
+
+    // The next conversion of the sequence waits for the previous data to be read
+    AdcHandle.Init.ScanConvMode     = ADC_SCAN_DIRECTION_FORWARD;
+    AdcHandle.Init.LowPowerAutoWait = ENABLE;
+    AdcHandle.Init.EOCSelection     = ADC_EOC_SINGLE_CONV;
+    if( oversampling == true )
+    {
+        // 16x oversampling shifted back to 12 bits
+        AdcHandle.Init.OversamplingMode           = ENABLE;
+        AdcHandle.Init.Oversample.Ratio           = ADC_OVERSAMPLING_RATIO_16;
+        AdcHandle.Init.Oversample.RightBitShift   = ADC_RIGHTBITSHIFT_4;
+        AdcHandle.Init.Oversample.TriggeredMode   = ADC_TRIGGEREDMODE_SINGLE_TRIGGER;
+    }
+    HAL_ADC_Init( &AdcHandle );
+
+    // Deselects all channels
+    adcConf.Channel = ADC_CHANNEL_MASK;
+    adcConf.Rank = ADC_RANK_NONE;
+    HAL_ADC_ConfigChannel( &AdcHandle, &adcConf );
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        adcConf.Channel = channels[i];
+        adcConf.Rank = ADC_RANK_CHANNEL_NUMBER;
+        HAL_ADC_ConfigChannel( &AdcHandle, &adcConf );
+
+        if( ( channels[i] == ADC_CHANNEL_TEMPSENSOR ) || ( channels[i] == ADC_CHANNEL_VREFINT ) )
+        {
+            isInternal = true;
+        }
+    }
+
+    // Enable ADC1
+    __HAL_ADC_ENABLE( &AdcHandle );
+
+    // Wait for ADC to effectively be enabled
+    tickStart = HAL_GetTick( );
+    while( __HAL_ADC_GET_FLAG( &AdcHandle, ADC_FLAG_RDY ) == RESET )
+    {
+        if( ( HAL_GetTick( ) - tickStart ) > ADC_ENABLE_TIMEOUT )
+        {
+            isAdcReady = false;
+            break;
+        }
+    }
+
+    if( isAdcReady != false )
+    {
+        // Start ADC Software Conversion
+        HAL_ADC_Start( &AdcHandle );
+
+        status = SUCCESS;
+        for( uint8_t i = 0; i < nbChannels; i++ )
+        {
+            if( HAL_ADC_PollForConversion( &AdcHandle, HAL_MAX_DELAY ) != HAL_OK )
+            {
+                status = FAIL;
+                break;
+            }
+            values[order[i]] = HAL_ADC_GetValue( &AdcHandle );
+        }
+    }
+
+    __HAL_ADC_DISABLE( &AdcHandle );
+
+    // Restore the single channel configuration
+    AdcHandle.Init = init;
+    if( isInternal == true )
+    {
+        HAL_ADC_DeInit( &AdcHandle );
+    }
+    else
+    {
+        HAL_ADC_Init( &AdcHandle );
+    }
+    __HAL_RCC_ADC1_CLK_DISABLE( );
+
+    // Disable HSI
+    __HAL_RCC_HSI_DISABLE( );
+
+    return status;
+}
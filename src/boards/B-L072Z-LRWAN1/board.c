@@ -28,6 +28,7 @@
 #include "i2c.h"
 #include "uart.h"
 #include "timer.h"
+#include "stack.h"
 #include "board-config.h"
 #include "lpm-board.h"
 #include "rtc-board.h"
@@ -74,6 +75,26 @@ static void CalibrateSystemWakeupTime( void );
  */
 static void SystemClockReConfig( void );
 
+#if defined( USE_LPM_FAST_STOP_EXIT )
+/*!
+ * Set when the MCU left the Stop mode on HSI16 and the PLL is not restored yet
+ */
+static volatile bool SystemClockRestorePending = false;
+#endif
+
+#if defined( USE_BOARD_PERF_LEVEL )
+/*!
+ * Number of pending BOARD_PERFORMANCE_LEVEL_HIGH requests
+ */
+static uint8_t PerformanceLevelRequests = 0;
+
+/*!
+ * \brief Switches the system clock to the current performance level and
+ *        updates the peripherals clocked by it
+ */
+static void SystemClockLevelApply( void );
+#endif
+
 /*!
  * Timer used at first boot to calibrate the SystemWakeupTime
  */
@@ -132,6 +153,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackInit( );
+
         HAL_Init( );
 
         // LEDs
@@ -166,7 +189,12 @@ void BoardInitMcu( void )
     }
     else
     {
+#if defined( USE_LPM_FAST_STOP_EXIT )
+        // Keeps running on HSI16 until BoardSystemClockRequest restores the PLL
+        SystemClockRestorePending = true;
+#else
         SystemClockReConfig( );
+#endif
     }
 
     SpiInit( &SX1276.Spi, SPI_1, RADIO_MOSI, RADIO_MISO, RADIO_SCLK, NC );
@@ -181,6 +209,10 @@ void BoardInitMcu( void )
         {
             CalibrateSystemWakeupTime( );
         }
+#if defined( USE_BOARD_PERF_LEVEL )
+        // Starts at the low performance level
+        SystemClockLevelApply( );
+#endif
     }
 }
 
@@ -283,7 +315,7 @@ void SystemClockConfig( void )
     HAL_SYSTICK_CLKSourceConfig( SYSTICK_CLKSOURCE_HCLK );
 
     // SysTick_IRQn interrupt configuration
-    HAL_NVIC_SetPriority( SysTick_IRQn, 0, 0 );
+    HAL_NVIC_SetPriority( SysTick_IRQn, IRQ_PRIORITY_SYSTICK, 0 );
 }
 
 void CalibrateSystemWakeupTime( void )
@@ -303,8 +335,44 @@ void CalibrateSystemWakeupTime( void )
 void SystemClockReConfig( void )
 {
     __HAL_RCC_PWR_CLK_ENABLE( );
+
+#if defined( USE_BOARD_PERF_LEVEL )
+    if( PerformanceLevelRequests == 0 )
+    {
+        // Enable HSI
+        __HAL_RCC_HSI_CONFIG( RCC_HSI_ON );
+
+        // Wait till HSI is ready
+        while( __HAL_RCC_GET_FLAG( RCC_FLAG_HSIRDY ) == RESET )
+        {
+        }
+
+        // Select HSI as system clock source
+        __HAL_RCC_SYSCLK_CONFIG ( RCC_SYSCLKSOURCE_HSI );
+
+        // Wait till HSI is used as system clock source
+        while( __HAL_RCC_GET_SYSCLK_SOURCE( ) != RCC_SYSCLKSOURCE_STATUS_HSI )
+        {
+        }
+
+        // Disable PLL, its configuration is kept for the high performance level
+        __HAL_RCC_PLL_DISABLE( );
+
+        // 16 MHz is within the voltage range 2
+        __HAL_PWR_VOLTAGESCALING_CONFIG( PWR_REGULATOR_VOLTAGE_SCALE2 );
+        return;
+    }
+#endif
+
     __HAL_PWR_VOLTAGESCALING_CONFIG( PWR_REGULATOR_VOLTAGE_SCALE1 );
 
+#if defined( USE_BOARD_PERF_LEVEL )
+    // Wait till the voltage range 1 is reached
+    while( __HAL_PWR_GET_FLAG( PWR_FLAG_VOS ) != RESET )
+    {
+    }
+#endif
+
     // Enable HSI
     __HAL_RCC_HSI_CONFIG( RCC_HSI_ON );
 
@@ -371,6 +439,11 @@ void LpmEnterStopMode( void)
     // Enable the fast wake up from Ultra low power mode
     HAL_PWREx_EnableFastWakeUp( );
 
+#if defined( USE_LPM_FAST_STOP_EXIT )
+    // Wake up on HSI16, the PLL source, which needs no start up time
+    __HAL_RCC_WAKEUPSTOP_CLK_CONFIG( RCC_STOP_WAKEUPCLOCK_HSI );
+#endif
+
     CRITICAL_SECTION_END( );
 
     // Enter Stop Mode
@@ -414,6 +487,79 @@ void BoardLowPowerHandler( void )
     __enable_irq( );
 }
 
+void BoardSystemClockRequest( void )
+{
+#if defined( USE_LPM_FAST_STOP_EXIT )
+    CRITICAL_SECTION_BEGIN( );
+    if( SystemClockRestorePending == true )
+    {
+        SystemClockRestorePending = false;
+        SystemClockReConfig( );
+    }
+    CRITICAL_SECTION_END( );
+#endif
+}
+
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level )
+{
+#if defined( USE_BOARD_PERF_LEVEL )
+    bool levelChanged = false;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( level == BOARD_PERFORMANCE_LEVEL_HIGH )
+    {
+        levelChanged = ( PerformanceLevelRequests == 0 );
+        PerformanceLevelRequests++;
+    }
+    else if( PerformanceLevelRequests > 0 )
+    {
+        PerformanceLevelRequests--;
+        levelChanged = ( PerformanceLevelRequests == 0 );
+    }
+    CRITICAL_SECTION_END( );
+
+    if( levelChanged == true )
+    {
+        SystemClockLevelApply( );
+    }
+#endif
+}
+
+#if defined( USE_BOARD_PERF_LEVEL )
+static void SystemClockLevelApply( void )
+{
+    if( Uart2.IsInitialized == true )
+    {
+        // Let the on going transmission complete before the baud rate changes
+        while( IsFifoEmpty( &Uart2.FifoTx ) == false )
+        {
+        }
+        while( ( USART2->ISR & USART_ISR_TC ) == 0 )
+        {
+        }
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+#if defined( USE_LPM_FAST_STOP_EXIT )
+    SystemClockRestorePending = false;
+#endif
+    SystemClockReConfig( );
+    SystemCoreClockUpdate( );
+
+    HAL_SYSTICK_Config( HAL_RCC_GetHCLKFreq( ) / 1000 );
+    HAL_NVIC_SetPriority( SysTick_IRQn, IRQ_PRIORITY_SYSTICK, 0 );
+    CRITICAL_SECTION_END( );
+
+    // The UART baud rate is derived from the system clock. The SPI is set up
+    // again against SystemCoreClock on each Stop mode exit and its prescaler
+    // keeps it below 10 MHz on both levels.
+    if( Uart2.IsInitialized == true )
+    {
+        UartConfig( &Uart2, RX_TX, 921600, UART_8_BIT, UART_1_STOP_BIT, NO_PARITY, NO_FLOW_CTRL );
+    }
+}
+#endif
+
 #if !defined ( __CC_ARM )
 
 /*
@@ -28,6 +28,7 @@
 #include "utilities.h"
 #include "delay.h"
 #include "board.h"
+#include "board-config.h"
 #include "timer.h"
 #include "systime.h"
 #include "gpio.h"
@@ -146,6 +147,16 @@ static RTC_AlarmTypeDef RtcAlarm;
  */
 static RtcTimerContext_t RtcTimerContext;
 
+/*!
+ * RTC date register value of the day held by RtcCalendarDaySeconds
+ */
+static uint32_t RtcCalendarDate = UINT32_MAX;
+
+/*!
+ * Number of seconds elapsed from 01/01/2000 to the start of RtcCalendarDate
+ */
+static uint32_t RtcCalendarDaySeconds = 0;
+
 /*!
  * \brief Get the current time from calendar in ticks
  *
@@ -155,6 +166,16 @@ static RtcTimerContext_t RtcTimerContext;
  */
 static uint64_t RtcGetCalendarValue( RTC_DateTypeDef* date, RTC_TimeTypeDef* time );
 
+/*!
+ * \brief Get the current time from the RTC registers in ticks
+ *
+ * \remark Cheaper than RtcGetCalendarValue, the date is only converted
+ *         to seconds once per day
+ *
+ * \retval calendarValue Time in ticks
+ */
+static uint64_t RtcGetCalendarTicks( void );
+
 void RtcInit( void )
 {
     RTC_DateTypeDef date;
@@ -192,7 +213,7 @@ void RtcInit( void )
         // Enable Direct Read of the calendar registers (not through Shadow registers)
         HAL_RTCEx_EnableBypassShadow( &RtcHandle );
 
-        HAL_NVIC_SetPriority( RTC_IRQn, 1, 0 );
+        HAL_NVIC_SetPriority( RTC_IRQn, IRQ_PRIORITY_RTC, 0 );
         HAL_NVIC_EnableIRQ( RTC_IRQn );
 
         // Init alarm.
@@ -425,20 +446,14 @@ void RtcStartAlarm( uint32_t timeout )
 
 uint32_t RtcGetTimerValue( void )
 {
-    RTC_TimeTypeDef time;
-    RTC_DateTypeDef date;
-
-    uint32_t calendarValue = ( uint32_t )RtcGetCalendarValue( &date, &time );
+    uint32_t calendarValue = ( uint32_t )RtcGetCalendarTicks( );
 
     return( calendarValue );
 }
 
 uint32_t RtcGetTimerElapsedTime( void )
 {
-  RTC_TimeTypeDef time;
-  RTC_DateTypeDef date;
-  
-  uint32_t calendarValue = ( uint32_t )RtcGetCalendarValue( &date, &time );
+  uint32_t calendarValue = ( uint32_t )RtcGetCalendarTicks( );
 
   return( ( uint32_t )( calendarValue - RtcTimerContext.Time ) );
 }
@@ -514,13 +529,56 @@ static uint64_t RtcGetCalendarValue( RTC_DateTypeDef* date, RTC_TimeTypeDef* tim
     return( calendarValue );
 }
 
+static uint32_t RtcBcd2Bin( uint32_t bcd )
+{
+    return ( ( bcd >> 4 ) * 10 ) + ( bcd & 0x0F );
+}
+
+static uint64_t RtcGetCalendarTicks( void )
+{
+    uint32_t ssr;
+    uint32_t tr;
+    uint32_t dr;
+    uint32_t seconds;
+
+    // The shadow registers are bypassed, read them again if a tick occurred meanwhile
+    do
+    {
+        ssr = RTC->SSR;
+        tr = RTC->TR;
+        dr = RTC->DR;
+    }while( ssr != RTC->SSR );
+
+    CRITICAL_SECTION_BEGIN( );
+    if( dr != RtcCalendarDate )
+    {
+        uint32_t year = RtcBcd2Bin( ( dr >> 16 ) & 0xFF );
+        uint32_t month = RtcBcd2Bin( ( dr >> 8 ) & 0x1F );
+        uint32_t correction = ( ( year % 4 ) == 0 ) ? DAYS_IN_MONTH_CORRECTION_LEAP : DAYS_IN_MONTH_CORRECTION_NORM;
+
+        // Same conversion as RtcGetCalendarValue
+        seconds = DIVC( ( DAYS_IN_YEAR * 3 + DAYS_IN_LEAP_YEAR ) * year , 4 );
+        seconds += ( DIVC( ( month - 1 ) * ( 30 + 31 ), 2 ) - ( ( ( correction >> ( ( month - 1 ) * 2 ) ) & 0x03 ) ) );
+        seconds += ( RtcBcd2Bin( dr & 0x3F ) - 1 );
+
+        RtcCalendarDaySeconds = seconds * SECONDS_IN_1DAY;
+        RtcCalendarDate = dr;
+    }
+    seconds = RtcCalendarDaySeconds;
+    CRITICAL_SECTION_END( );
+
+    seconds += ( RtcBcd2Bin( tr & 0x7F ) +
+                 ( RtcBcd2Bin( ( tr >> 8 ) & 0x7F ) * SECONDS_IN_1MINUTE ) +
+                 ( RtcBcd2Bin( ( tr >> 16 ) & 0x3F ) * SECONDS_IN_1HOUR ) );
+
+    return( ( ( ( uint64_t )seconds ) << N_PREDIV_S ) + ( PREDIV_S - ( ssr & RTC_SSR_SS ) ) );
+}
+
 uint32_t RtcGetCalendarTime( uint16_t *milliseconds )
 {
-    RTC_TimeTypeDef time ;
-    RTC_DateTypeDef date;
     uint32_t ticks;
 
-    uint64_t calendarValue = RtcGetCalendarValue( &date, &time );
+    uint64_t calendarValue = RtcGetCalendarTicks( );
 
     uint32_t seconds = ( uint32_t )( calendarValue >> N_PREDIV_S );
 
@@ -619,3 +677,28 @@ TimerTime_t RtcTempCompensation( TimerTime_t period, float temperature )
     // Calculate the resulting period
     return ( TimerTime_t ) interim;
 }
+
+int32_t RtcSetCalibration( int32_t ppb )
+{
+    // The 32 s smooth calibration cycle masks CALM of the 2^20 RTCCLK pulses
+    // and CALP adds 512 of them. One step is 1e9 / 2^20 = 953.67 ppb.
+    int64_t steps = ( int64_t )ppb * 1048576;
+    uint32_t plusPulses = RTC_SMOOTHCALIB_PLUSPULSES_RESET;
+    uint32_t minusPulses;
+
+    steps = ( steps + ( ( steps < 0 ) ? -500000000 : 500000000 ) ) / 1000000000;
+    steps = MIN( MAX( steps, -511 ), 512 );
+
+    if( steps > 0 )
+    {
+        plusPulses = RTC_SMOOTHCALIB_PLUSPULSES_SET;
+        minusPulses = 512 - ( uint32_t )steps;
+    }
+    else
+    {
+        minusPulses = ( uint32_t )( -steps );
+    }
+    HAL_RTCEx_SetSmoothCalib( &RtcHandle, RTC_SMOOTHCALIB_PERIOD_32SEC, plusPulses, minusPulses );
+
+    return ( int32_t )( ( steps * 1000000000 ) / 1048576 );
+}
@@ -0,0 +1,82 @@
+/*!
+ * \file      board-config.h
+ *
+ * \brief     Board (module) specific pins and host environment configuration
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __BOARD_CONFIG_H__
+#define __BOARD_CONFIG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * Defines the time required for the TCXO to wakeup [ms].
+ */
+#define BOARD_TCXO_WAKEUP_TIME                      0
+
+/*!
+ * Board MCU pins definitions
+ */
+#define LED_1                                       NC
+#define LED_2                                       NC
+
+/*!
+ * File backing the emulated EEPROM
+ */
+#ifndef HOST_EEPROM_FILE
+#define HOST_EEPROM_FILE                            "eeprom.bin"
+#endif
+
+/*!
+ * Emulated EEPROM size [bytes]
+ */
+#ifndef HOST_EEPROM_SIZE
+#define HOST_EEPROM_SIZE                            8192
+#endif
+
+/*!
+ * Board unique identifier, 8 bytes
+ */
+#ifndef HOST_UNIQUE_ID
+#define HOST_UNIQUE_ID                              { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01 }
+#endif
+
+/*!
+ * Board random seed
+ *
+ * \remark A fixed seed keeps the simulation runs reproducible.
+ */
+#ifndef HOST_RANDOM_SEED
+#define HOST_RANDOM_SEED                            0x12345678
+#endif
+
+/*!
+ * Virtual time at the board initialization [ms]
+ *
+ * \remark A value close to 0xFFFFFFFF checks that the stack survives the
+ *         timer ticks wrap around.
+ */
+#ifndef HOST_VIRTUAL_TIME_START
+#define HOST_VIRTUAL_TIME_START                     0
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __BOARD_CONFIG_H__
@@ -0,0 +1,134 @@
+/*!
+ * \file      board.c
+ *
+ * \brief     Target board general functions implementation, running on the host
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include "board-config.h"
+#include "utilities.h"
+#include "gpio.h"
+#include "timer.h"
+#include "rtc-board.h"
+#include "energy.h"
+#include "board.h"
+
+/*!
+ * LED GPIO pins objects
+ */
+Gpio_t Led1;
+Gpio_t Led2;
+
+/*!
+ * Flag to indicate if the MCU is Initialized
+ */
+static bool McuInitialized = false;
+
+void BoardCriticalSectionBegin( uint32_t *mask )
+{
+    // The host board runs every event from the main loop
+    *mask = 0;
+}
+
+void BoardCriticalSectionEnd( uint32_t *mask )
+{
+}
+
+void BoardInitPeriph( void )
+{
+
+}
+
+void BoardInitMcu( void )
+{
+    if( McuInitialized == false )
+    {
+        // Do not buffer the traces, they must show up even when the process gets killed
+        setvbuf( stdout, NULL, _IONBF, 0 );
+
+        RtcInit( );
+
+        GpioInit( &Led1, LED_1, PIN_OUTPUT, PIN_PUSH_PULL, PIN_NO_PULL, 0 );
+        GpioInit( &Led2, LED_2, PIN_OUTPUT, PIN_PUSH_PULL, PIN_NO_PULL, 0 );
+
+        McuInitialized = true;
+    }
+}
+
+void BoardResetMcu( void )
+{
+    exit( EXIT_SUCCESS );
+}
+
+void BoardDeInitMcu( void )
+{
+}
+
+uint32_t BoardGetRandomSeed( void )
+{
+    return HOST_RANDOM_SEED;
+}
+
+void BoardGetUniqueId( uint8_t *id )
+{
+    const uint8_t uniqueId[] = HOST_UNIQUE_ID;
+
+    memcpy1( id, uniqueId, sizeof( uniqueId ) );
+}
+
+uint32_t BoardGetBatteryVoltage( void )
+{
+    return 0;
+}
+
+uint8_t BoardGetBatteryLevel( void )
+{
+    return 0; //  Battery level [0: node is connected to an external power source ...
+}
+
+uint8_t GetBoardPowerSource( void )
+{
+    return USB_POWER;
+}
+
+void BoardLowPowerHandler( void )
+{
+    uint32_t ticks = TimerGetTicksToNextEvent( );
+
+    // Wait for the next timer event, RtcProcess fires it from the main loop
+    EnergySetMcuState( ENERGY_MCU_SLEEP );
+    if( ticks != UINT32_MAX )
+    {
+        RtcDelayMs( RtcTick2Ms( ticks ) );
+    }
+#if defined( HOST_REAL_TIME )
+    else
+    {
+        RtcDelayMs( 1 );
+    }
+#endif
+    EnergySetMcuState( ENERGY_MCU_RUN );
+}
+
+void BoardSystemClockRequest( void )
+{
+    // The system clock is always restored at the low power mode exit
+}
+
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level )
+{
+    // The MCU always runs on its full speed system clock
+}
@@ -0,0 +1,31 @@
+/*!
+ * \file      delay-board.c
+ *
+ * \brief     Target board delay implementation, running on the host
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include "rtc-board.h"
+#include "delay-board.h"
+
+void DelayMsMcu( uint32_t ms )
+{
+    RtcDelayMs( ms );
+}
+
+bool DelayMcuIsSleepAllowed( void )
+{
+    // The delays already advance the virtual time
+    return false;
+}
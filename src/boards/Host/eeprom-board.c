@@ -0,0 +1,127 @@
+/*!
+ * \file      eeprom-board.c
+ *
+ * \brief     Target board EEPROM driver implementation, backed by a host file
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdio.h>
+#include "utilities.h"
+#include "board-config.h"
+#include "eeprom-board.h"
+
+/*!
+ * \remark The EEPROM content is mirrored in RAM and written through to
+ *         HOST_EEPROM_FILE, which keeps the non volatile context across runs.
+ */
+
+/*!
+ * EEPROM RAM mirror
+ */
+static uint8_t EepromImage[HOST_EEPROM_SIZE];
+
+/*!
+ * EEPROM backing file
+ */
+static FILE *EepromFile = NULL;
+
+/*!
+ * \brief Opens the backing file and loads its content, once
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+static uint8_t EepromMcuOpen( void )
+{
+    if( EepromFile != NULL )
+    {
+        return SUCCESS;
+    }
+
+    EepromFile = fopen( HOST_EEPROM_FILE, "r+b" );
+    if( EepromFile == NULL )
+    {
+        // First run. An erased EEPROM reads as zeros.
+        EepromFile = fopen( HOST_EEPROM_FILE, "w+b" );
+        if( EepromFile == NULL )
+        {
+            return FAIL;
+        }
+        memset1( EepromImage, 0, HOST_EEPROM_SIZE );
+        fwrite( EepromImage, 1, HOST_EEPROM_SIZE, EepromFile );
+        fflush( EepromFile );
+    }
+    else if( fread( EepromImage, 1, HOST_EEPROM_SIZE, EepromFile ) != HOST_EEPROM_SIZE )
+    {
+        fclose( EepromFile );
+        EepromFile = NULL;
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
+{
+    if( ( ( uint32_t )addr + size ) > HOST_EEPROM_SIZE )
+    {
+        return FAIL;
+    }
+    if( EepromMcuOpen( ) != SUCCESS )
+    {
+        return FAIL;
+    }
+
+    memcpy1( EepromImage + addr, buffer, size );
+
+    if( ( fseek( EepromFile, addr, SEEK_SET ) != 0 ) ||
+        ( fwrite( buffer, 1, size, EepromFile ) != size ) ||
+        ( fflush( EepromFile ) != 0 ) )
+    {
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
+{
+    if( ( ( uint32_t )addr + size ) > HOST_EEPROM_SIZE )
+    {
+        return FAIL;
+    }
+    if( EepromMcuOpen( ) != SUCCESS )
+    {
+        return FAIL;
+    }
+
+    memcpy1( buffer, EepromImage + addr, size );
+    return SUCCESS;
+}
+
+void EepromMcuSetEraseAllowed( bool allowed )
+{
+    // The emulated EEPROM is programmed without erase operations
+}
+
+bool EepromMcuIsWritePending( void )
+{
+    return false;
+}
+
+void EepromMcuSetDeviceAddr( uint8_t addr )
+{
+}
+
+uint8_t EepromMcuGetDeviceAddr( void )
+{
+    return 0;
+}
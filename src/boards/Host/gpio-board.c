@@ -0,0 +1,62 @@
+/*!
+ * \file      gpio-board.c
+ *
+ * \brief     Target board GPIO driver implementation, running on the host
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stddef.h>
+#include "gpio-board.h"
+
+/*!
+ * \remark The host board has no GPIO. The pins only keep their output value,
+ *         stored in the otherwise unused pinIndex field.
+ */
+
+void GpioMcuInit( Gpio_t *obj, PinNames pin, PinModes mode, PinConfigs config, PinTypes type, uint32_t value )
+{
+    obj->pin = pin;
+    obj->pull = type;
+    obj->pinIndex = value;
+}
+
+void GpioMcuSetContext( Gpio_t *obj, void* context )
+{
+    obj->Context = context;
+}
+
+void GpioMcuSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriority, GpioIrqHandler *irqHandler )
+{
+    obj->IrqHandler = irqHandler;
+}
+
+void GpioMcuRemoveInterrupt( Gpio_t *obj )
+{
+    obj->IrqHandler = NULL;
+}
+
+void GpioMcuWrite( Gpio_t *obj, uint32_t value )
+{
+    obj->pinIndex = value;
+}
+
+void GpioMcuToggle( Gpio_t *obj )
+{
+    obj->pinIndex = ( obj->pinIndex == 0 ) ? 1 : 0;
+}
+
+uint32_t GpioMcuRead( Gpio_t *obj )
+{
+    return obj->pinIndex;
+}
@@ -0,0 +1,244 @@
+/*!
+ * \file      rtc-board.c
+ *
+ * \brief     Target board RTC timer, running on the host clock
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <time.h>
+#include "utilities.h"
+#include "board-config.h"
+#include "timer.h"
+#include "systime.h"
+#include "rtc-board.h"
+
+/*!
+ * \remark The timer tick is 1 ms.
+ *
+ *         By default the time is virtual: it only moves forward when the
+ *         board waits for the next timer event or for a delay, which runs
+ *         the stack as fast as the host allows.
+ *         With HOST_REAL_TIME defined the time follows the host monotonic
+ *         clock and the board sleeps while waiting.
+ *
+ *         The time is counted on 64 bits. The timer ticks wrap around every
+ *         49.7 days like on the MCU boards, the calendar time doesn't, which
+ *         keeps SysTime and the Class B beacon timing valid over simulations
+ *         of months.
+ */
+
+#define MIN_ALARM_DELAY                             1 // in ticks
+
+/*!
+ * RTC timer context
+ */
+typedef struct
+{
+    uint32_t Time;  // Reference time
+    uint32_t Delay; // Reference timeout delay
+    bool     AlarmRunning;
+}RtcTimerContext_t;
+
+/*!
+ * \brief Indicates if the RTC is already Initialized or not
+ */
+static bool RtcInitialized = false;
+
+/*!
+ * Keep the value of the RTC timer when the RTC alarm is set
+ * Set with the \ref RtcSetTimerContext function
+ * Value is kept as a Reference to calculate alarm
+ */
+static RtcTimerContext_t RtcTimerContext;
+
+/*!
+ * Backup registers
+ */
+static uint32_t RtcBkupRegs[2];
+
+#if defined( HOST_REAL_TIME )
+/*!
+ * Host monotonic clock value when the RTC got initialized
+ */
+static struct timespec RtcStartTime;
+#else
+/*!
+ * Virtual time [ms]
+ */
+static uint64_t RtcVirtualTime = HOST_VIRTUAL_TIME_START;
+#endif
+
+/*!
+ * \brief Returns the time elapsed since the RTC initialization
+ *
+ * \retval time Time [ms]
+ */
+static uint64_t RtcGetTime( void )
+{
+#if defined( HOST_REAL_TIME )
+    struct timespec now;
+
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return ( ( uint64_t )( now.tv_sec - RtcStartTime.tv_sec ) * 1000 ) +
+           ( ( int64_t )( now.tv_nsec - RtcStartTime.tv_nsec ) / 1000000 );
+#else
+    return RtcVirtualTime;
+#endif
+}
+
+void RtcInit( void )
+{
+    if( RtcInitialized == false )
+    {
+#if defined( HOST_REAL_TIME )
+        clock_gettime( CLOCK_MONOTONIC, &RtcStartTime );
+#endif
+        RtcTimerContext.AlarmRunning = false;
+        RtcSetTimerContext( );
+        RtcInitialized = true;
+    }
+}
+
+uint32_t RtcSetTimerContext( void )
+{
+    RtcTimerContext.Time = RtcGetTimerValue( );
+    return RtcTimerContext.Time;
+}
+
+uint32_t RtcGetTimerContext( void )
+{
+    return RtcTimerContext.Time;
+}
+
+uint32_t RtcGetMinimumTimeout( void )
+{
+    return( MIN_ALARM_DELAY );
+}
+
+uint32_t RtcMs2Tick( TimerTime_t milliseconds )
+{
+    return ( uint32_t )milliseconds;
+}
+
+TimerTime_t RtcTick2Ms( uint32_t tick )
+{
+    return ( TimerTime_t )tick;
+}
+
+void RtcDelayMs( TimerTime_t milliseconds )
+{
+#if defined( HOST_REAL_TIME )
+    struct timespec delay =
+    {
+        .tv_sec = milliseconds / 1000,
+        .tv_nsec = ( milliseconds % 1000 ) * 1000000,
+    };
+
+    while( nanosleep( &delay, &delay ) != 0 )
+    {
+    }
+#else
+    RtcVirtualTime += milliseconds;
+#endif
+}
+
+void RtcSetMcuWakeUpTime( void )
+{
+    // The host has no wake up time
+}
+
+int16_t RtcGetMcuWakeUpTime( void )
+{
+    return 0;
+}
+
+void RtcSetAlarm( uint32_t timeout )
+{
+    RtcStartAlarm( timeout );
+}
+
+void RtcStopAlarm( void )
+{
+    RtcTimerContext.AlarmRunning = false;
+}
+
+void RtcStartAlarm( uint32_t timeout )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    RtcTimerContext.Delay = timeout;
+    RtcTimerContext.AlarmRunning = true;
+
+    CRITICAL_SECTION_END( );
+}
+
+uint32_t RtcGetTimerValue( void )
+{
+    return ( uint32_t )RtcGetTime( );
+}
+
+uint32_t RtcGetTimerElapsedTime( void )
+{
+    return RtcGetTimerValue( ) - RtcTimerContext.Time;
+}
+
+uint32_t RtcGetCalendarTime( uint16_t *milliseconds )
+{
+    uint64_t time = RtcGetTime( );
+
+    *milliseconds = time % 1000;
+    return ( uint32_t )( time / 1000 );
+}
+
+void RtcBkupWrite( uint32_t data0, uint32_t data1 )
+{
+    RtcBkupRegs[0] = data0;
+    RtcBkupRegs[1] = data1;
+}
+
+void RtcBkupRead( uint32_t *data0, uint32_t *data1 )
+{
+    *data0 = RtcBkupRegs[0];
+    *data1 = RtcBkupRegs[1];
+}
+
+void RtcProcess( void )
+{
+    bool expired = false;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( ( RtcTimerContext.AlarmRunning == true ) && ( RtcGetTimerElapsedTime( ) >= RtcTimerContext.Delay ) )
+    {
+        RtcTimerContext.AlarmRunning = false;
+        expired = true;
+    }
+    CRITICAL_SECTION_END( );
+
+    if( expired == true )
+    {
+        TimerIrqHandler( );
+    }
+}
+
+TimerTime_t RtcTempCompensation( TimerTime_t period, float temperature )
+{
+    // The host clock does not drift with the temperature
+    return period;
+}
+
+int32_t RtcSetCalibration( int32_t ppb )
+{
+    // The host clock is not adjustable
+    return 0;
+}
@@ -29,6 +29,7 @@
 #include "i2c.h"
 #include "uart.h"
 #include "timer.h"
+#include "stack.h"
 #include "gps.h"
 #include "mpl3115.h"
 #include "mag3110.h"
@@ -60,6 +61,11 @@ Gpio_t LedUsr;    // Active High
  */
 Gpio_t PushButton;
 
+/*!
+ * MPL3115 INT1 pin object, signals the end of the conversions
+ */
+Gpio_t Mpl3115Int;
+
 /*
  * MCU objects
  */
@@ -156,7 +162,9 @@ void BoardInitPeriph( void )
 
     GpioInit( &ioPin, IRQ_1_MMA8451, PIN_INPUT, PIN_PUSH_PULL, PIN_NO_PULL, 1 );
     GpioInit( &ioPin, IRQ_2_MMA8451, PIN_INPUT, PIN_PUSH_PULL, PIN_NO_PULL, 1 );
-    GpioInit( &ioPin, IRQ_MPL3115, PIN_INPUT, PIN_PUSH_PULL, PIN_NO_PULL, 1 );
+    // Open drain active low, see MPL3115StartConversion
+    GpioInit( &Mpl3115Int, IRQ_MPL3115, PIN_INPUT, PIN_PUSH_PULL, PIN_PULL_UP, 1 );
+    GpioSetInterrupt( &Mpl3115Int, IRQ_FALLING_EDGE, IRQ_VERY_LOW_PRIORITY, MPL3115OnInterrupt );
 
     // Init temperature, pressure and altitude sensor
     MPL3115Init( );
@@ -183,6 +191,8 @@ void BoardInitMcu( void )
 
     if( McuInitialized == false )
     {
+        StackInit( );
+
         HAL_Init( );
 
         SystemClockConfig( );
@@ -488,7 +498,7 @@ void SystemClockConfig( void )
     HAL_SYSTICK_CLKSourceConfig( SYSTICK_CLKSOURCE_HCLK );
 
     // SysTick_IRQn interrupt configuration
-    HAL_NVIC_SetPriority( SysTick_IRQn, 0, 0 );
+    HAL_NVIC_SetPriority( SysTick_IRQn, IRQ_PRIORITY_SYSTICK, 0 );
 }
 
 void CalibrateSystemWakeupTime( void )
@@ -634,6 +644,16 @@ void BoardLowPowerHandler( void )
     __enable_irq( );
 }
 
+void BoardSystemClockRequest( void )
+{
+    // The system clock is always restored at the low power mode exit
+}
+
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level )
+{
+    // The MCU always runs on its full speed system clock
+}
+
 #if !defined ( __CC_ARM )
 
 /*
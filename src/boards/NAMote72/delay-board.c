@@ -29,3 +29,9 @@ void DelayMsMcu( uint32_t ms )
 {
     HAL_Delay( ms );
 }
+
+bool DelayMcuIsSleepAllowed( void )
+{
+    // The timer interrupt ending the delay must be able to run
+    return ( __get_IPSR( ) == 0 ) && ( __get_PRIMASK( ) == 0 );
+}
@@ -39,20 +39,26 @@
 static uint8_t RxBuffer[FIFO_RX_SIZE];
 
 /*!
- * \brief Buffer holding the  raw data received from the gps
+ * \brief Maximum number of sentences received before giving up on a valid
+ *        GGA or RMC sentence
  */
-static uint8_t NmeaString[128];
+#define GPS_MCU_MAX_SENTENCES                       16
 
 /*!
- * \brief Maximum number of data byte that we will accept from the GPS
+ * \brief Number of sentences received since the UART was started
  */
-static volatile uint8_t NmeaStringSize = 0;
+static volatile uint8_t NmeaSentenceCnt = 0;
 
 static Gpio_t GpsPowerEn;
 static Gpio_t GpsPps;
 
 static volatile bool GpsPowerEnInverted = false;
 
+/*!
+ * \brief Indicates if the UART is started to receive the sentences
+ */
+static volatile bool GpsUartStarted = false;
+
 extern Uart_t Uart1;
 
 void GpsMcuOnPpsSignal( void* context )
@@ -66,6 +72,8 @@ void GpsMcuOnPpsSignal( void* context )
         // Disables lowest power modes
         LpmSetStopMode( LPM_GPS_ID , LPM_DISABLE );
 
+        NmeaSentenceCnt = 0;
+        GpsUartStarted = true;
         UartInit( &Uart1, UART_1, GPS_UART_TX, GPS_UART_RX );
         UartConfig( &Uart1, RX_ONLY, 9600, UART_8_BIT, UART_1_STOP_BIT, NO_PARITY, NO_FLOW_CTRL );
     }
@@ -78,7 +86,7 @@ void GpsMcuInvertPpsTrigger( void )
 
 void GpsMcuInit( void )
 {
-    NmeaStringSize = 0;
+    NmeaSentenceCnt = 0;
 
     switch( BoardGetVersion( ).Fields.Major )
     {
@@ -116,6 +124,14 @@ void GpsMcuStart( void )
 
 void GpsMcuStop( void )
 {
+    // The backup supply keeps the ephemeris, the UART has nothing to receive
+    if( GpsUartStarted == true )
+    {
+        GpsUartStarted = false;
+        UartDeInit( &Uart1 );
+        LpmSetStopMode( LPM_GPS_ID , LPM_ENABLE );
+    }
+
     if( GpsPowerEnInverted == true )
     {
         GpioWrite( &GpsPowerEn, 1 );    // power down the GPS
@@ -136,22 +152,28 @@ void GpsMcuIrqNotify( UartNotifyId_t id )
     uint8_t data;
     if( id == UART_NOTIFY_RX )
     {
-        if( UartGetChar( &Uart1, &data ) == 0 )
+        // A notification may carry several bytes when the UART uses DMA
+        while( UartGetChar( &Uart1, &data ) == 0 )
         {
-            if( ( data == '$' ) || ( NmeaStringSize >= 127 ) )
+            // The sentences are parsed as they are received, the UART is
+            // stopped once a position is updated
+            if( data == '\n' )
             {
-                NmeaStringSize = 0;
+                NmeaSentenceCnt++;
             }
 
-            NmeaString[NmeaStringSize++] = ( int8_t )data;
-
-            if( data == '\n' )
+            if( ( GpsParseGpsChar( data ) == SUCCESS ) || ( NmeaSentenceCnt >= GPS_MCU_MAX_SENTENCES ) )
             {
-                NmeaString[NmeaStringSize++] = '\0';
-                GpsParseGpsData( ( int8_t* )NmeaString, NmeaStringSize );
+                if( GpsUartStarted == false )
+                {
+                    // Already stopped by the power manager on the fix
+                    break;
+                }
+                GpsUartStarted = false;
                 UartDeInit( &Uart1 );
                 // Enables lowest power modes
                 LpmSetStopMode( LPM_GPS_ID , LPM_ENABLE );
+                break;
             }
         }
     }
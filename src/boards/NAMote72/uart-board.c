@@ -23,6 +23,7 @@
 #include "stm32l1xx.h"
 #include "utilities.h"
 #include "board.h"
+#include "board-config.h"
 #include "uart-board.h"
 
 /*!
@@ -31,11 +32,35 @@
  */
 #define TX_BUFFER_RETRY_COUNT                       10
 
+#if defined( UART_DMA_ENABLED )
+/*!
+ * Size of the circular DMA reception buffer
+ *
+ * \remark Half of the buffer must hold the bytes received while the UART and
+ *         DMA interrupts are masked.
+ */
+#ifndef UART_DMA_RX_BUFFER_SIZE
+#define UART_DMA_RX_BUFFER_SIZE                     64
+#endif
+#endif
+
 typedef struct
 {
     UART_HandleTypeDef UartHandle;
     uint8_t RxData;
     uint8_t TxData;
+#if defined( UART_DMA_ENABLED )
+    DMA_HandleTypeDef DmaRxHandle;
+    DMA_HandleTypeDef DmaTxHandle;
+    /*!
+     * Circular buffer written by the reception DMA channel
+     */
+    uint8_t DmaRxBuffer[UART_DMA_RX_BUFFER_SIZE];
+    /*!
+     * Index of the next DmaRxBuffer byte to be moved to the Rx FIFO
+     */
+    uint16_t DmaRxTail;
+#endif
 }UartContext_t;
 
 UartContext_t UartContext[2];
@@ -43,6 +68,52 @@ UartContext_t UartContext[2];
 extern Uart_t Uart1;
 extern Uart_t Uart2;
 
+#if defined( UART_DMA_ENABLED )
+/*!
+ * \brief Configures the DMA channels and starts the circular reception
+ *
+ * \param [IN] uartId UART identifier
+ */
+static void UartMcuDmaInit( UartId_t uartId );
+
+/*!
+ * \brief Stops the DMA channels
+ *
+ * \param [IN] uartId UART identifier
+ */
+static void UartMcuDmaDeInit( UartId_t uartId );
+
+/*!
+ * \brief Moves the bytes received since the last call to the Rx FIFO and
+ *        notifies the upper layer
+ *
+ * \param [IN] uartId UART identifier
+ */
+static void UartMcuDmaRxProcess( UartId_t uartId );
+
+/*!
+ * \brief Sends the buffer with the transmission DMA channel
+ *
+ * \remark Blocks until the DMA has fetched the last byte as the buffer
+ *         belongs to the caller.
+ *
+ * \param [IN] obj    UART object
+ * \param [IN] buffer Buffer to be sent
+ * \param [IN] size   Buffer size
+ * \retval status     [true: sent, false: DMA or UART busy, use the FIFO]
+ */
+static bool UartMcuDmaPutBuffer( Uart_t *obj, uint8_t *buffer, uint16_t size );
+
+/*!
+ * \brief Gets the UART identifier owning the HAL handle
+ *
+ * \param [IN]  handle HAL UART handle
+ * \param [OUT] uartId UART identifier
+ * \retval status      [true: found, false: unknown UART peripheral]
+ */
+static bool UartMcuGetId( UART_HandleTypeDef *handle, UartId_t *uartId );
+#endif
+
 void UartMcuInit( Uart_t *obj, UartId_t uartId, PinNames tx, PinNames rx )
 {
     if( uartId == UART_USB_CDC )
@@ -184,17 +255,21 @@ void UartMcuConfig( Uart_t *obj, UartMode_t mode, uint32_t baudrate, WordLength_
 
         if( obj->UartId == UART_1 )
         {
-            HAL_NVIC_SetPriority( USART1_IRQn, 1, 0 );
+            HAL_NVIC_SetPriority( USART1_IRQn, IRQ_PRIORITY_UART, 0 );
             HAL_NVIC_EnableIRQ( USART1_IRQn );
         }
         else if( obj->UartId == UART_2 )
         {
-            HAL_NVIC_SetPriority( USART2_IRQn, 1, 0 );
+            HAL_NVIC_SetPriority( USART2_IRQn, IRQ_PRIORITY_UART, 0 );
             HAL_NVIC_EnableIRQ( USART2_IRQn );
         }
 
+#if defined( UART_DMA_ENABLED )
+        UartMcuDmaInit( obj->UartId );
+#else
         /* Enable the UART Data Register not empty Interrupt */
         HAL_UART_Receive_IT( &UartContext[obj->UartId].UartHandle, &UartContext[obj->UartId].RxData, 1 );
+#endif
     }
 }
 
@@ -208,6 +283,9 @@ void UartMcuDeInit( Uart_t *obj )
     }
     else
     {
+#if defined( UART_DMA_ENABLED )
+        UartMcuDmaDeInit( obj->UartId );
+#endif
         if( obj->UartId == UART_1 )
         {
             __HAL_RCC_USART1_FORCE_RESET( );
@@ -268,15 +346,12 @@ uint8_t UartMcuGetChar( Uart_t *obj, uint8_t *data )
     }
     else
     {
-        CRITICAL_SECTION_BEGIN( );
-
+        // The Rx IRQ is the only FIFO producer, no critical section is needed
         if( IsFifoEmpty( &obj->FifoRx ) == false )
         {
             *data = FifoPop( &obj->FifoRx );
-            CRITICAL_SECTION_END( );
             return 0;
         }
-        CRITICAL_SECTION_END( );
         return 1;
     }
 }
@@ -293,13 +368,30 @@ uint8_t UartMcuPutBuffer( Uart_t *obj, uint8_t *buffer, uint16_t size )
     }
     else
     {
-        uint8_t retryCount;
-        uint16_t i;
+        uint8_t retryCount = 0;
+        uint16_t count;
 
-        for( i = 0; i < size; i++ )
+#if defined( UART_DMA_ENABLED )
+        if( UartMcuDmaPutBuffer( obj, buffer, size ) == true )
         {
-            retryCount = 0;
-            while( UartPutChar( obj, buffer[i] ) != 0 )
+            return 0; // OK
+        }
+#endif
+        while( size > 0 )
+        {
+            count = FifoPushBuffer( &obj->FifoTx, buffer, size );
+            if( count > 0 )
+            {
+                buffer += count;
+                size -= count;
+                retryCount = 0;
+
+                // Trig UART Tx interrupt to start sending the FIFO contents.
+                CRITICAL_SECTION_BEGIN( );
+                __HAL_UART_ENABLE_IT( &UartContext[obj->UartId].UartHandle, UART_IT_TC );
+                CRITICAL_SECTION_END( );
+            }
+            else
             {
                 retryCount++;
 
@@ -318,15 +410,22 @@ uint8_t UartMcuGetBuffer( Uart_t *obj, uint8_t *buffer, uint16_t size, uint16_t
 {
     uint16_t localSize = 0;
 
-    while( localSize < size )
+    if( obj->UartId != UART_USB_CDC )
     {
-        if( UartGetChar( obj, buffer + localSize ) == 0 )
-        {
-            localSize++;
-        }
-        else
+        localSize = FifoPopBuffer( &obj->FifoRx, buffer, size );
+    }
+    else
+    {
+        while( localSize < size )
         {
-            break;
+            if( UartGetChar( obj, buffer + localSize ) == 0 )
+            {
+                localSize++;
+            }
+            else
+            {
+                break;
+            }
         }
     }
 
@@ -372,6 +471,43 @@ void HAL_UART_TxCpltCallback( UART_HandleTypeDef *handle )
     }
 }
 
+#if defined( UART_DMA_ENABLED )
+void HAL_UART_RxHalfCpltCallback( UART_HandleTypeDef *handle )
+{
+    UartId_t uartId;
+
+    if( UartMcuGetId( handle, &uartId ) == true )
+    {
+        UartMcuDmaRxProcess( uartId );
+    }
+}
+
+void HAL_UART_RxCpltCallback( UART_HandleTypeDef *handle )
+{
+    UartId_t uartId;
+
+    if( UartMcuGetId( handle, &uartId ) == true )
+    {
+        UartMcuDmaRxProcess( uartId );
+    }
+}
+
+void HAL_UART_ErrorCallback( UART_HandleTypeDef *handle )
+{
+    UartId_t uartId;
+
+    if( UartMcuGetId( handle, &uartId ) == false )
+    {
+        // Unknown UART peripheral skip processing
+        return;
+    }
+    // Save the bytes received before the error and restart the reception
+    UartMcuDmaRxProcess( uartId );
+    HAL_DMA_Abort( &UartContext[uartId].DmaRxHandle );
+    UartContext[uartId].DmaRxTail = 0;
+    HAL_UART_Receive_DMA( &UartContext[uartId].UartHandle, UartContext[uartId].DmaRxBuffer, UART_DMA_RX_BUFFER_SIZE );
+}
+#else
 void HAL_UART_RxCpltCallback( UART_HandleTypeDef *handle )
 {
     Uart_t *uart = &Uart1;
@@ -425,9 +561,19 @@ void HAL_UART_ErrorCallback( UART_HandleTypeDef *handle )
     }
     HAL_UART_Receive_IT( &UartContext[uartId].UartHandle, &UartContext[uartId].RxData, 1 );
 }
+#endif
 
 void USART1_IRQHandler( void )
 {
+#if defined( UART_DMA_ENABLED )
+    // Idle line detected, flush the partially filled DMA buffer
+    if( ( __HAL_UART_GET_FLAG( &UartContext[UART_1].UartHandle, UART_FLAG_IDLE ) != RESET ) &&
+        ( __HAL_UART_GET_IT_SOURCE( &UartContext[UART_1].UartHandle, UART_IT_IDLE ) != RESET ) )
+    {
+        __HAL_UART_CLEAR_IDLEFLAG( &UartContext[UART_1].UartHandle );
+        UartMcuDmaRxProcess( UART_1 );
+    }
+#endif
     // [BEGIN] Workaround to solve an issue with the HAL drivers not managing the uart state correctly.
     uint32_t tmpFlag = 0, tmpItSource = 0;
 
@@ -448,6 +594,15 @@ void USART1_IRQHandler( void )
 
 void USART2_IRQHandler( void )
 {
+#if defined( UART_DMA_ENABLED )
+    // Idle line detected, flush the partially filled DMA buffer
+    if( ( __HAL_UART_GET_FLAG( &UartContext[UART_2].UartHandle, UART_FLAG_IDLE ) != RESET ) &&
+        ( __HAL_UART_GET_IT_SOURCE( &UartContext[UART_2].UartHandle, UART_IT_IDLE ) != RESET ) )
+    {
+        __HAL_UART_CLEAR_IDLEFLAG( &UartContext[UART_2].UartHandle );
+        UartMcuDmaRxProcess( UART_2 );
+    }
+#endif
     // [BEGIN] Workaround to solve an issue with the HAL drivers not managing the uart state correctly.
     uint32_t tmpFlag = 0, tmpItSource = 0;
 
@@ -465,3 +620,171 @@ void USART2_IRQHandler( void )
 
     HAL_UART_IRQHandler( &UartContext[UART_2].UartHandle );
 }
+
+#if defined( UART_DMA_ENABLED )
+static void UartMcuDmaInit( UartId_t uartId )
+{
+    UartContext_t *ctx = &UartContext[uartId];
+
+    UartMcuDmaDeInit( uartId );
+
+    __HAL_RCC_DMA1_CLK_ENABLE( );
+
+    if( uartId == UART_1 )
+    {
+        ctx->DmaRxHandle.Instance = DMA1_Channel5;
+        ctx->DmaTxHandle.Instance = DMA1_Channel4;
+    }
+    else
+    {
+        ctx->DmaRxHandle.Instance = DMA1_Channel6;
+        ctx->DmaTxHandle.Instance = DMA1_Channel7;
+    }
+
+    ctx->DmaRxHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    ctx->DmaRxHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    ctx->DmaRxHandle.Init.MemInc = DMA_MINC_ENABLE;
+    ctx->DmaRxHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    ctx->DmaRxHandle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    ctx->DmaRxHandle.Init.Mode = DMA_CIRCULAR;
+    ctx->DmaRxHandle.Init.Priority = DMA_PRIORITY_HIGH;
+    if( HAL_DMA_Init( &ctx->DmaRxHandle ) != HAL_OK )
+    {
+        assert_param( FAIL );
+    }
+    __HAL_LINKDMA( &ctx->UartHandle, hdmarx, ctx->DmaRxHandle );
+
+    ctx->DmaTxHandle.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    ctx->DmaTxHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    ctx->DmaTxHandle.Init.MemInc = DMA_MINC_ENABLE;
+    ctx->DmaTxHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    ctx->DmaTxHandle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    ctx->DmaTxHandle.Init.Mode = DMA_NORMAL;
+    ctx->DmaTxHandle.Init.Priority = DMA_PRIORITY_LOW;
+    if( HAL_DMA_Init( &ctx->DmaTxHandle ) != HAL_OK )
+    {
+        assert_param( FAIL );
+    }
+    __HAL_LINKDMA( &ctx->UartHandle, hdmatx, ctx->DmaTxHandle );
+
+    // Same priority as the UART IRQ, UartMcuDmaRxProcess is never preempted by itself
+    if( uartId == UART_1 )
+    {
+        HAL_NVIC_SetPriority( DMA1_Channel5_IRQn, IRQ_PRIORITY_UART, 0 );
+        HAL_NVIC_EnableIRQ( DMA1_Channel5_IRQn );
+        HAL_NVIC_SetPriority( DMA1_Channel4_IRQn, IRQ_PRIORITY_UART, 0 );
+        HAL_NVIC_EnableIRQ( DMA1_Channel4_IRQn );
+    }
+    else
+    {
+        HAL_NVIC_SetPriority( DMA1_Channel6_IRQn, IRQ_PRIORITY_UART, 0 );
+        HAL_NVIC_EnableIRQ( DMA1_Channel6_IRQn );
+        HAL_NVIC_SetPriority( DMA1_Channel7_IRQn, IRQ_PRIORITY_UART, 0 );
+        HAL_NVIC_EnableIRQ( DMA1_Channel7_IRQn );
+    }
+
+    ctx->DmaRxTail = 0;
+    if( HAL_UART_Receive_DMA( &ctx->UartHandle, ctx->DmaRxBuffer, UART_DMA_RX_BUFFER_SIZE ) != HAL_OK )
+    {
+        assert_param( FAIL );
+    }
+    __HAL_UART_ENABLE_IT( &ctx->UartHandle, UART_IT_IDLE );
+}
+
+static void UartMcuDmaDeInit( UartId_t uartId )
+{
+    if( UartContext[uartId].DmaRxHandle.Instance != NULL )
+    {
+        HAL_DMA_DeInit( &UartContext[uartId].DmaRxHandle );
+    }
+    if( UartContext[uartId].DmaTxHandle.Instance != NULL )
+    {
+        HAL_DMA_DeInit( &UartContext[uartId].DmaTxHandle );
+    }
+}
+
+static void UartMcuDmaRxProcess( UartId_t uartId )
+{
+    UartContext_t *ctx = &UartContext[uartId];
+    Uart_t *uart = ( uartId == UART_1 ) ? &Uart1 : &Uart2;
+    uint16_t head = ( UART_DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER( &ctx->DmaRxHandle ) ) % UART_DMA_RX_BUFFER_SIZE;
+
+    if( head == ctx->DmaRxTail )
+    {
+        return;
+    }
+    if( head < ctx->DmaRxTail )
+    {
+        // The DMA wrapped around, flush the end of the buffer first
+        FifoPushBuffer( &uart->FifoRx, ctx->DmaRxBuffer + ctx->DmaRxTail, UART_DMA_RX_BUFFER_SIZE - ctx->DmaRxTail );
+        ctx->DmaRxTail = 0;
+    }
+    FifoPushBuffer( &uart->FifoRx, ctx->DmaRxBuffer + ctx->DmaRxTail, head - ctx->DmaRxTail );
+    ctx->DmaRxTail = head;
+
+    if( uart->IrqNotify != NULL )
+    {
+        uart->IrqNotify( UART_NOTIFY_RX );
+    }
+}
+
+static bool UartMcuDmaPutBuffer( Uart_t *obj, uint8_t *buffer, uint16_t size )
+{
+    UartContext_t *ctx = &UartContext[obj->UartId];
+    HAL_StatusTypeDef status = HAL_BUSY;
+
+    CRITICAL_SECTION_BEGIN( );
+    // Keep the ordering with the bytes already queued in the Tx FIFO
+    if( IsFifoEmpty( &obj->FifoTx ) == true )
+    {
+        status = HAL_UART_Transmit_DMA( &ctx->UartHandle, buffer, size );
+    }
+    CRITICAL_SECTION_END( );
+
+    if( status != HAL_OK )
+    {
+        return false;
+    }
+    while( __HAL_DMA_GET_COUNTER( &ctx->DmaTxHandle ) != 0 )
+    {
+    }
+    return true;
+}
+
+static bool UartMcuGetId( UART_HandleTypeDef *handle, UartId_t *uartId )
+{
+    if( handle == &UartContext[UART_1].UartHandle )
+    {
+        *uartId = UART_1;
+    }
+    else if( handle == &UartContext[UART_2].UartHandle )
+    {
+        *uartId = UART_2;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+void DMA1_Channel4_IRQHandler( void )
+{
+    HAL_DMA_IRQHandler( &UartContext[UART_1].DmaTxHandle );
+}
+
+void DMA1_Channel5_IRQHandler( void )
+{
+    HAL_DMA_IRQHandler( &UartContext[UART_1].DmaRxHandle );
+}
+
+void DMA1_Channel6_IRQHandler( void )
+{
+    HAL_DMA_IRQHandler( &UartContext[UART_2].DmaRxHandle );
+}
+
+void DMA1_Channel7_IRQHandler( void )
+{
+    HAL_DMA_IRQHandler( &UartContext[UART_2].DmaTxHandle );
+}
+#endif
@@ -62,6 +62,10 @@ extern "C"
 #define RADIO_BUSY                                  PB_3
 #define RADIO_DIO_1                                 PB_4
 
+// Radio lines driven through the GPIO direct register accessors, see gpio-fast.h
+#define RADIO_NSS_FAST
+#define RADIO_BUSY_FAST
+
 #define RADIO_ANT_SWITCH_POWER                      PA_9
 #define RADIO_FREQ_SEL                              PA_1
 #define RADIO_XTAL_SEL                              PB_0
@@ -96,6 +100,22 @@ extern "C"
 
 #endif
 
+#if defined( SX126X_SECOND_INSTANCE )
+// Second SX126x transceiver ( Radio1 ) pins definitions.
+#define RADIO1_RESET                                PC_4
+
+#define RADIO1_MOSI                                 PB_15
+#define RADIO1_MISO                                 PB_14
+#define RADIO1_SCLK                                 PB_13
+
+#define RADIO1_NSS                                  PB_12
+#define RADIO1_BUSY                                 PC_9
+#define RADIO1_DIO_1                                PC_8
+
+#define RADIO1_ANT_SWITCH_POWER                     PC_5
+#define RADIO1_DEVICE_SEL                           PC_6
+#endif
+
 #define OSC_LSE_IN                                  PC_14
 #define OSC_LSE_OUT                                 PC_15
 
@@ -111,6 +131,27 @@ extern "C"
 #define UART_TX                                     PA_2
 #define UART_RX                                     PA_3
 
+/*!
+ * \brief NVIC priority map, 0 is the most urgent
+ *
+ * The radio DIO lines and the RTC alarm come first: the DIO edge timestamps
+ * the RX done and the RTC alarm opens the RX windows. The UART and I2C
+ * handlers cannot delay them. Their worst case latency is the longest timer
+ * IRQ run ( TimerGetIrqDurationMax ) plus the longest critical section.
+ *
+ * \remark The GPIO IRQ_HIGH_PRIORITY and IRQ_VERY_HIGH_PRIORITY levels are
+ *         reserved to the radio DIO lines. A radio DIO must not share the
+ *         EXTI 9_5 or 15_10 interrupt with a lower priority pin.
+ */
+#define IRQ_PRIORITY_RADIO_DIO                      0
+#define IRQ_PRIORITY_RTC                            0
+#define IRQ_PRIORITY_SYSTICK                        0
+#define IRQ_PRIORITY_SYSTEM                         1
+#define IRQ_PRIORITY_GPIO_MEDIUM                    2
+#define IRQ_PRIORITY_UART                           2
+#define IRQ_PRIORITY_GPIO_LOW                       3
+#define IRQ_PRIORITY_I2C                            3
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,57 @@
+/*!
+ * \file      sx126x-board1.c
+ *
+ * \brief     Second SX126x transceiver board radio file
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#if defined( SX126X_SECOND_INSTANCE )
+
+#define SX126X_INSTANCE                             1
+#include "sx126x-instance.h"
+
+#include "board-config.h"
+
+/*
+ * Routes the board radio file to the second transceiver pins
+ */
+#undef RADIO_RESET
+#undef RADIO_NSS
+#undef RADIO_BUSY
+#undef RADIO_DIO_1
+#undef RADIO_ANT_SWITCH_POWER
+#undef RADIO_DEVICE_SEL
+#undef RADIO_DBG_PIN_TX
+#undef RADIO_DBG_PIN_RX
+
+#define RADIO_RESET                                 RADIO1_RESET
+#define RADIO_NSS                                   RADIO1_NSS
+#define RADIO_BUSY                                  RADIO1_BUSY
+#define RADIO_DIO_1                                 RADIO1_DIO_1
+#define RADIO_ANT_SWITCH_POWER                      RADIO1_ANT_SWITCH_POWER
+#define RADIO_DEVICE_SEL                            RADIO1_DEVICE_SEL
+#define RADIO_DBG_PIN_TX                            NC
+#define RADIO_DBG_PIN_RX                            NC
+
+#if defined( SX1261MBXBAS )
+#include "sx1261mbxbas-board.c"
+#elif defined( SX1262MBXCAS )
+#include "sx1262mbxcas-board.c"
+#elif defined( SX1262MBXDAS )
+#include "sx1262mbxdas-board.c"
+#else
+#error "The second SX126x transceiver requires an SX126x radio shield."
+#endif
+
+#endif // SX126X_SECOND_INSTANCE
@@ -21,11 +21,20 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include "stm32l1xx.h"
+#include "utilities.h"
 #include "board-config.h"
 #include "adc-board.h"
 
 ADC_HandleTypeDef AdcHandle;
 
+/*!
+ * Regular sequence ranks used by AdcMcuReadChannels
+ */
+static const uint32_t AdcScanRanks[ADC_MAX_SCAN_CHANNELS] =
+{
+    ADC_REGULAR_RANK_1, ADC_REGULAR_RANK_2, ADC_REGULAR_RANK_3, ADC_REGULAR_RANK_4
+};
+
 void AdcMcuInit( Adc_t *obj, PinNames adcInput )
 {
     AdcHandle.Instance = ( ADC_TypeDef* )ADC1_BASE;
@@ -102,3 +111,81 @@ uint16_t AdcMcuReadChannel( Adc_t *obj, uint32_t channel )
 
     return adcData;
 }
+
+uint8_t AdcMcuReadChannels( Adc_t *obj, const uint32_t *channels, uint16_t *values, uint8_t nbChannels, bool oversampling )
+{
+    ADC_InitTypeDef init = AdcHandle.Init;
+    ADC_ChannelConfTypeDef adcConf = { 0 };
+    uint8_t status = FAIL;
+    bool isInternal = false;
+
+    // The STM32L1 ADC has no hardware oversampling
+    ( void )oversampling;
+
+    // Enable HSI
+    __HAL_RCC_HSI_ENABLE( );
+
+    // Wait till HSI is ready
+    while( __HAL_RCC_GET_FLAG( RCC_FLAG_HSIRDY ) == RESET )
+    {
+    }
+
+    __HAL_RCC_ADC1_CLK_ENABLE( );
+
+    // The next conversion of the sequence waits for the previous data to be read
+    AdcHandle.Init.ScanConvMode     = ADC_SCAN_ENABLE;
+    AdcHandle.Init.NbrOfConversion  = nbChannels;
+    AdcHandle.Init.LowPowerAutoWait = ADC_AUTOWAIT_UNTIL_DATA_READ;
+    AdcHandle.Init.EOCSelection     = ADC_EOC_SINGLE_CONV;
+    HAL_ADC_Init( &AdcHandle );
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        adcConf.Channel = channels[i];
+        adcConf.Rank = AdcScanRanks[i];
+        adcConf.SamplingTime = ADC_SAMPLETIME_192CYCLES;
+        HAL_ADC_ConfigChannel( &AdcHandle, &adcConf );
+
+        if( ( channels[i] == ADC_CHANNEL_TEMPSENSOR ) || ( channels[i] == ADC_CHANNEL_VREFINT ) )
+        {
+            isInternal = true;
+        }
+    }
+
+    // Enable ADC1
+    if( ADC_Enable( &AdcHandle ) == HAL_OK )
+    {
+        // Start ADC Software Conversion
+        HAL_ADC_Start( &AdcHandle );
+
+        status = SUCCESS;
+        for( uint8_t i = 0; i < nbChannels; i++ )
+        {
+            if( HAL_ADC_PollForConversion( &AdcHandle, HAL_MAX_DELAY ) != HAL_OK )
+            {
+                status = FAIL;
+                break;
+            }
+            values[i] = HAL_ADC_GetValue( &AdcHandle );
+        }
+    }
+
+    ADC_ConversionStop_Disable( &AdcHandle );
+
+    // Restore the single channel configuration
+    AdcHandle.Init = init;
+    if( isInternal == true )
+    {
+        HAL_ADC_DeInit( &AdcHandle );
+    }
+    else
+    {
+        HAL_ADC_Init( &AdcHandle );
+    }
+    __HAL_RCC_ADC1_CLK_DISABLE( );
+
+    // Disable HSI
+    __HAL_RCC_HSI_DISABLE( );
+
+    return status;
+}
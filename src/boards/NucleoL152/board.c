@@ -28,6 +28,7 @@
 #include "i2c.h"
 #include "uart.h"
 #include "timer.h"
+#include "stack.h"
 #include "board-config.h"
 #include "lpm-board.h"
 #include "rtc-board.h"
@@ -137,6 +138,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackInit( );
+
         HAL_Init( );
 
         // LEDs
@@ -305,7 +308,7 @@ void SystemClockConfig( void )
     HAL_SYSTICK_CLKSourceConfig( SYSTICK_CLKSOURCE_HCLK );
 
     // SysTick_IRQn interrupt configuration
-    HAL_NVIC_SetPriority( SysTick_IRQn, 0, 0 );
+    HAL_NVIC_SetPriority( SysTick_IRQn, IRQ_PRIORITY_SYSTICK, 0 );
 }
 
 void CalibrateSystemWakeupTime( void )
@@ -436,6 +439,16 @@ void BoardLowPowerHandler( void )
     __enable_irq( );
 }
 
+void BoardSystemClockRequest( void )
+{
+    // The system clock is always restored at the low power mode exit
+}
+
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level )
+{
+    // The MCU always runs on its full speed system clock
+}
+
 #if !defined ( __CC_ARM )
 
 /*
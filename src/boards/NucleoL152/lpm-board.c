@@ -25,11 +25,19 @@
 #include <stdint.h>
 #include "stm32l1xx.h"
 #include "utilities.h"
+#include "timer.h"
+#include "rtc-board.h"
+#include "energy.h"
 #include "lpm-board.h"
 
 static uint32_t StopModeDisable = 0;
 static uint32_t OffModeDisable = 0;
 
+/*!
+ * Maximum measured duration of LpmExitStopMode in RTC ticks
+ */
+static uint32_t StopModeExitTime = 0;
+
 void LpmSetOffMode( LpmId_t id, LpmSetMode_t mode )
 {
     CRITICAL_SECTION_BEGIN( );
@@ -84,36 +92,83 @@ void LpmSetStopMode( LpmId_t id, LpmSetMode_t mode )
 
 void LpmEnterLowPower( void )
 {
-    if( StopModeDisable != 0 )
+    uint32_t exitStart = 0;
+    uint32_t exitTime = 0;
+
+    switch( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) )
     {
-        /*!
-        * SLEEP mode is required
-        */
-        LpmEnterSleepMode( );
-        LpmExitSleepMode( );
-    }
-    else
-    { 
-        if( OffModeDisable != 0 )
+        case LPM_SLEEP_MODE:
+        {
+            /*!
+            * SLEEP mode is required
+            */
+            EnergySetMcuState( ENERGY_MCU_SLEEP );
+            LpmEnterSleepMode( );
+            LpmExitSleepMode( );
+            EnergySetMcuState( ENERGY_MCU_RUN );
+            break;
+        }
+        case LPM_STOP_MODE:
         {
             /*!
             * STOP mode is required
             */
+            EnergySetMcuState( ENERGY_MCU_STOP );
             LpmEnterStopMode( );
+            exitStart = RtcGetTimerValue( );
             LpmExitStopMode( );
+            exitTime = RtcGetTimerValue( ) - exitStart;
+            EnergySetMcuState( ENERGY_MCU_RUN );
+            if( exitTime > StopModeExitTime )
+            {
+                StopModeExitTime = exitTime;
+            }
+            break;
         }
-        else
+        case LPM_OFF_MODE:
+        default:
         {
             /*!
             * OFF mode is required
             */
+            EnergySetMcuState( ENERGY_MCU_OFF );
             LpmEnterOffMode( );
             LpmExitOffMode( );
+            EnergySetMcuState( ENERGY_MCU_RUN );
+            break;
         }
     }
     return;
 }
 
+LpmGetMode_t LpmGetModeForNextEvent( LpmGetMode_t mode, uint32_t ticks )
+{
+    int16_t mcuWakeUpTime = RtcGetMcuWakeUpTime( );
+    uint32_t wakeUpLatency = StopModeExitTime;
+
+    if( mcuWakeUpTime > 0 )
+    {
+        wakeUpLatency += ( uint32_t )mcuWakeUpTime;
+    }
+
+    if( ( mode == LPM_OFF_MODE ) &&
+        ( ticks <= ( wakeUpLatency + RtcMs2Tick( LPM_OFF_MODE_MIN_RESIDENCY ) ) ) )
+    {
+        mode = LPM_STOP_MODE;
+    }
+    if( ( mode == LPM_STOP_MODE ) &&
+        ( ticks <= ( wakeUpLatency + RtcMs2Tick( LPM_STOP_MODE_MIN_RESIDENCY ) ) ) )
+    {
+        mode = LPM_SLEEP_MODE;
+    }
+    return mode;
+}
+
+uint32_t LpmGetStopModeExitTime( void )
+{
+    return StopModeExitTime;
+}
+
 LpmGetMode_t LpmGetMode(void)
 {
     LpmGetMode_t mode;
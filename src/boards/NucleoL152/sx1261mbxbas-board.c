@@ -21,12 +21,48 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdlib.h>
+#include "stm32l1xx.h"
 #include "utilities.h"
 #include "board-config.h"
 #include "board.h"
 #include "delay.h"
+#include "timer.h"
+#include "lpm-board.h"
 #include "radio.h"
 #include "sx126x-board.h"
+#if defined( RADIO_NSS_FAST ) || defined( RADIO_BUSY_FAST )
+#include "gpio-fast.h"
+#endif
+
+/*!
+ * Radio NSS and BUSY lines accessors. The lines declared fast in
+ * board-config.h bypass the generic GPIO driver.
+ */
+#if defined( RADIO_NSS_FAST )
+#define RADIO_NSS_WRITE( value )                    GpioFastWrite( &SX126x.Spi.Nss, value )
+#else
+#define RADIO_NSS_WRITE( value )                    GpioWrite( &SX126x.Spi.Nss, value )
+#endif
+
+#if defined( RADIO_BUSY_FAST )
+#define RADIO_BUSY_READ( )                          GpioFastRead( &SX126x.BUSY )
+#else
+#define RADIO_BUSY_READ( )                          GpioRead( &SX126x.BUSY )
+#endif
+
+#if defined( USE_RADIO_BUSY_IRQ )
+/*!
+ * Maximum time in ms the radio is expected to stay busy. Covers a stuck BUSY pin.
+ */
+#define RADIO_BUSY_TIMEOUT                          20
+
+/*!
+ * \brief BUSY pin falling edge IRQ callback. Only used to wake up the MCU.
+ */
+static void SX126xOnBusyIrq( void* context )
+{
+}
+#endif
 
 /*!
  * Antenna switch GPIO pins objects
@@ -53,6 +89,9 @@ void SX126xIoInit( void )
 void SX126xIoIrqInit( DioIrqHandler dioIrq )
 {
     GpioSetInterrupt( &SX126x.DIO1, IRQ_RISING_EDGE, IRQ_HIGH_PRIORITY, dioIrq );
+#if defined( USE_RADIO_BUSY_IRQ )
+    GpioSetInterrupt( &SX126x.BUSY, IRQ_FALLING_EDGE, IRQ_HIGH_PRIORITY, SX126xOnBusyIrq );
+#endif
 }
 
 void SX126xIoDeInit( void )
@@ -91,19 +130,46 @@ void SX126xReset( void )
 
 void SX126xWaitOnBusy( void )
 {
-    while( GpioRead( &SX126x.BUSY ) == 1 );
+#if defined( USE_RADIO_BUSY_IRQ )
+    TimerTime_t startTime = 0;
+
+    if( RADIO_BUSY_READ( ) == 0 )
+    {
+        return;
+    }
+
+    startTime = TimerGetCurrentTime( );
+    while( RADIO_BUSY_READ( ) == 1 )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        // The BUSY falling edge IRQ wakes the MCU up, checked with IRQs masked
+        // so that it can't be missed
+        if( RADIO_BUSY_READ( ) == 1 )
+        {
+            LpmEnterSleepMode( );
+        }
+        CRITICAL_SECTION_END( );
+
+        if( TimerGetElapsedTime( startTime ) > RADIO_BUSY_TIMEOUT )
+        {
+            break;
+        }
+    }
+#else
+    while( RADIO_BUSY_READ( ) == 1 );
+#endif
 }
 
 void SX126xWakeup( void )
 {
     CRITICAL_SECTION_BEGIN( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
 
     SpiInOut( &SX126x.Spi, RADIO_GET_STATUS );
     SpiInOut( &SX126x.Spi, 0x00 );
 
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    RADIO_NSS_WRITE( 1 );
 
     // Wait for chip to be ready.
     SX126xWaitOnBusy( );
@@ -115,16 +181,13 @@ void SX126xWriteCommand( RadioCommands_t command, uint8_t *buffer, uint16_t size
 {
     SX126xCheckDeviceReady( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
 
     SpiInOut( &SX126x.Spi, ( uint8_t )command );
 
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX126x.Spi, buffer[i] );
-    }
+    SpiTransfer( &SX126x.Spi, buffer, NULL, size );
 
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    RADIO_NSS_WRITE( 1 );
 
     if( command != RADIO_SET_SLEEP )
     {
@@ -138,16 +201,13 @@ uint8_t SX126xReadCommand( RadioCommands_t command, uint8_t *buffer, uint16_t si
 
     SX126xCheckDeviceReady( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
 
     SpiInOut( &SX126x.Spi, ( uint8_t )command );
     status = SpiInOut( &SX126x.Spi, 0x00 );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        buffer[i] = SpiInOut( &SX126x.Spi, 0 );
-    }
+    SpiTransfer( &SX126x.Spi, NULL, buffer, size );
 
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    RADIO_NSS_WRITE( 1 );
 
     SX126xWaitOnBusy( );
 
@@ -158,18 +218,15 @@ void SX126xWriteRegisters( uint16_t address, uint8_t *buffer, uint16_t size )
 {
     SX126xCheckDeviceReady( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
     
     SpiInOut( &SX126x.Spi, RADIO_WRITE_REGISTER );
     SpiInOut( &SX126x.Spi, ( address & 0xFF00 ) >> 8 );
     SpiInOut( &SX126x.Spi, address & 0x00FF );
     
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX126x.Spi, buffer[i] );
-    }
+    SpiTransfer( &SX126x.Spi, buffer, NULL, size );
 
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    RADIO_NSS_WRITE( 1 );
 
     SX126xWaitOnBusy( );
 }
@@ -183,17 +240,14 @@ void SX126xReadRegisters( uint16_t address, uint8_t *buffer, uint16_t size )
 {
     SX126xCheckDeviceReady( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
 
     SpiInOut( &SX126x.Spi, RADIO_READ_REGISTER );
     SpiInOut( &SX126x.Spi, ( address & 0xFF00 ) >> 8 );
     SpiInOut( &SX126x.Spi, address & 0x00FF );
     SpiInOut( &SX126x.Spi, 0 );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        buffer[i] = SpiInOut( &SX126x.Spi, 0 );
-    }
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    SpiTransfer( &SX126x.Spi, NULL, buffer, size );
+    RADIO_NSS_WRITE( 1 );
 
     SX126xWaitOnBusy( );
 }
@@ -209,15 +263,12 @@ void SX126xWriteBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
 {
     SX126xCheckDeviceReady( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
 
     SpiInOut( &SX126x.Spi, RADIO_WRITE_BUFFER );
     SpiInOut( &SX126x.Spi, offset );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        SpiInOut( &SX126x.Spi, buffer[i] );
-    }
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    SpiTransfer( &SX126x.Spi, buffer, NULL, size );
+    RADIO_NSS_WRITE( 1 );
 
     SX126xWaitOnBusy( );
 }
@@ -226,16 +277,13 @@ void SX126xReadBuffer( uint8_t offset, uint8_t *buffer, uint8_t size )
 {
     SX126xCheckDeviceReady( );
 
-    GpioWrite( &SX126x.Spi.Nss, 0 );
+    RADIO_NSS_WRITE( 0 );
 
     SpiInOut( &SX126x.Spi, RADIO_READ_BUFFER );
     SpiInOut( &SX126x.Spi, offset );
     SpiInOut( &SX126x.Spi, 0 );
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        buffer[i] = SpiInOut( &SX126x.Spi, 0 );
-    }
-    GpioWrite( &SX126x.Spi.Nss, 1 );
+    SpiTransfer( &SX126x.Spi, NULL, buffer, size );
+    RADIO_NSS_WRITE( 1 );
 
     SX126xWaitOnBusy( );
 }
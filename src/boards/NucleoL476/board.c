@@ -28,6 +28,7 @@
 #include "i2c.h"
 #include "uart.h"
 #include "timer.h"
+#include "stack.h"
 #include "board-config.h"
 #include "lpm-board.h"
 #include "rtc-board.h"
@@ -142,6 +143,8 @@ void BoardInitMcu( void )
 {
     if( McuInitialized == false )
     {
+        StackInit( );
+
         HAL_Init( );
 
         InitFlashMemoryOperations( );
@@ -316,7 +319,7 @@ void SystemClockConfig( void )
     HAL_SYSTICK_CLKSourceConfig( SYSTICK_CLKSOURCE_HCLK );
 
     // SysTick_IRQn interrupt configuration
-    HAL_NVIC_SetPriority( SysTick_IRQn, 0, 0 );
+    HAL_NVIC_SetPriority( SysTick_IRQn, IRQ_PRIORITY_SYSTICK, 0 );
 }
 
 void CalibrateSystemWakeupTime( void )
@@ -353,7 +356,7 @@ static void PVD_Config( void )
     HAL_PWR_EnablePVD( );
 
     // Enable and set PVD Interrupt priority
-    HAL_NVIC_SetPriority( PVD_PVM_IRQn, 0, 0 );
+    HAL_NVIC_SetPriority( PVD_PVM_IRQn, IRQ_PRIORITY_SYSTEM, 0 );
     HAL_NVIC_EnableIRQ( PVD_PVM_IRQn );
 }
 
@@ -368,7 +371,7 @@ static void InitFlashMemoryOperations( void )
 {
     // Enable and set FLASH Interrupt priority
     // FLASH interrupt is used for the purpose of pages clean up under interrupt
-    HAL_NVIC_SetPriority( FLASH_IRQn, 0, 0 );
+    HAL_NVIC_SetPriority( FLASH_IRQn, IRQ_PRIORITY_SYSTEM, 0 );
     HAL_NVIC_EnableIRQ( FLASH_IRQn );
 
     // Unlock the Flash Program Erase controller
@@ -536,6 +539,16 @@ void BoardLowPowerHandler( void )
     __enable_irq( );
 }
 
+void BoardSystemClockRequest( void )
+{
+    // The system clock is always restored at the low power mode exit
+}
+
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level )
+{
+    // The MCU always runs on its full speed system clock
+}
+
 #if !defined ( __CC_ARM )
 
 /*
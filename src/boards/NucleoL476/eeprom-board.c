@@ -27,9 +27,36 @@
 #include "eeprom-board.h"
 #include "utilities.h"
 
+/*!
+ * Maximum number of bytes waiting to be programmed while a clean up is on going
+ */
+#define EEPROM_WRITE_QUEUE_SIZE                     128
+
+/*!
+ * Byte waiting to be programmed
+ */
+typedef struct sEepromPendingWrite
+{
+    uint16_t Addr;
+    uint8_t Data;
+}EepromPendingWrite_t;
+
 uint16_t EepromVirtualAddress[NB_OF_VARIABLES];
 __IO uint32_t ErasingOnGoing = 0;
 
+/*!
+ * Bytes written while the emulation pages were being cleaned up
+ */
+static EepromPendingWrite_t WriteQueue[EEPROM_WRITE_QUEUE_SIZE];
+static volatile uint16_t WriteQueueBegin = 0;
+static volatile uint16_t WriteQueueCnt = 0;
+
+/*!
+ * Erase operations veto, and clean up postponed by it
+ */
+static volatile bool IsEraseAllowed = true;
+static volatile bool IsCleanUpPending = false;
+
 /*!
  * \brief Initializes the EEPROM emulation module.
  */
@@ -93,36 +120,134 @@ bool EepromMcuIsErasingOnGoing( void )
     return ErasingOnGoing;
 }
 
-uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
+/*!
+ * \brief Starts the pages clean up under interrupt unless it is vetoed.
+ *
+ * \remark The Flash Program Erase controller must be unlocked.
+ */
+static void EepromMcuStartCleanUp( void )
+{
+    if( IsEraseAllowed == true )
+    {
+        IsCleanUpPending = false;
+        ErasingOnGoing = 1;
+        if( EE_CleanUp_IT( ) != EE_OK )
+        {
+            // Fall back to the blocking clean up
+            ErasingOnGoing = 0;
+            EE_CleanUp( );
+        }
+    }
+    else
+    {
+        IsCleanUpPending = true;
+    }
+}
+
+/*!
+ * \brief Locks the Flash Program Erase controller unless it is still needed
+ *        by the clean up under interrupt.
+ */
+static void EepromMcuLockFlash( void )
+{
+    if( ErasingOnGoing == 0 )
+    {
+        HAL_FLASH_Lock( );
+    }
+}
+
+/*!
+ * \brief Programs the queued bytes until the queue is empty or a new clean
+ *        up is required.
+ */
+static void EepromMcuProcessWriteQueue( void )
 {
-    uint8_t status = SUCCESS;
     EE_Status eeStatus = EE_OK;
-    
-    // Unlock the Flash Program Erase controller
-    HAL_FLASH_Unlock( );
 
-    for( uint32_t i = 0; i < size; i++ )
+    HAL_FLASH_Unlock( );
+    while( ( WriteQueueCnt > 0 ) && ( ErasingOnGoing == 0 ) && ( IsCleanUpPending == false ) )
     {
-        eeStatus |= EE_WriteVariable8bits( EepromVirtualAddress[addr + i], buffer[i] );
+        eeStatus = EE_WriteVariable8bits( EepromVirtualAddress[WriteQueue[WriteQueueBegin].Addr], WriteQueue[WriteQueueBegin].Data );
+        WriteQueueBegin = ( WriteQueueBegin + 1 ) % EEPROM_WRITE_QUEUE_SIZE;
+        WriteQueueCnt--;
+
+        if( ( eeStatus & EE_STATUSMASK_CLEANUP ) == EE_STATUSMASK_CLEANUP )
+        {
+            EepromMcuStartCleanUp( );
+        }
     }
+    EepromMcuLockFlash( );
+}
 
-    if( eeStatus != EE_OK )
+/*!
+ * \brief Queues the given bytes to be programmed once the clean up is done.
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+static uint8_t EepromMcuQueueWrite( uint16_t addr, uint8_t *buffer, uint16_t size )
+{
+    if( size > ( EEPROM_WRITE_QUEUE_SIZE - WriteQueueCnt ) )
     {
-        status = FAIL;
+        return FAIL;
     }
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        uint16_t index = ( WriteQueueBegin + WriteQueueCnt ) % EEPROM_WRITE_QUEUE_SIZE;
+
+        WriteQueue[index].Addr = addr + i;
+        WriteQueue[index].Data = buffer[i];
+        WriteQueueCnt++;
+    }
+    return SUCCESS;
+}
+
+uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
+{
+    uint8_t status = SUCCESS;
+    EE_Status eeStatus = EE_OK;
+    uint16_t i = 0;
 
-    if( ( eeStatus & EE_STATUSMASK_CLEANUP ) == EE_STATUSMASK_CLEANUP )
+    // Programming is not possible while the pages are cleaned up, queue the data instead
+    CRITICAL_SECTION_BEGIN( );
+    if( ( ErasingOnGoing == 0 ) && ( IsCleanUpPending == false ) && ( WriteQueueCnt > 0 ) )
     {
-        ErasingOnGoing = 0;
-        eeStatus |= EE_CleanUp( );
+        EepromMcuProcessWriteQueue( );
     }
-    if( ( eeStatus & EE_STATUSMASK_ERROR ) == EE_STATUSMASK_ERROR )
+    if( ( ErasingOnGoing != 0 ) || ( IsCleanUpPending == true ) || ( WriteQueueCnt > 0 ) )
     {
-        status = FAIL;
+        status = EepromMcuQueueWrite( addr, buffer, size );
+        CRITICAL_SECTION_END( );
+        return status;
+    }
+    CRITICAL_SECTION_END( );
+
+    // Unlock the Flash Program Erase controller
+    HAL_FLASH_Unlock( );
+
+    for( i = 0; i < size; i++ )
+    {
+        eeStatus = EE_WriteVariable8bits( EepromVirtualAddress[addr + i], buffer[i] );
+
+        if( ( eeStatus & EE_STATUSMASK_ERROR ) == EE_STATUSMASK_ERROR )
+        {
+            status = FAIL;
+        }
+        if( ( eeStatus & EE_STATUSMASK_CLEANUP ) == EE_STATUSMASK_CLEANUP )
+        {
+            // Erase the pages in the background and queue the remaining data
+            CRITICAL_SECTION_BEGIN( );
+            if( EepromMcuQueueWrite( addr + i + 1, buffer + i + 1, size - i - 1 ) != SUCCESS )
+            {
+                status = FAIL;
+            }
+            EepromMcuStartCleanUp( );
+            CRITICAL_SECTION_END( );
+            break;
+        }
     }
 
     // Lock the Flash Program Erase controller
-    HAL_FLASH_Lock( );
+    EepromMcuLockFlash( );
     return status;
 }
 
@@ -142,11 +267,43 @@ uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
         }
     }
 
+    // The queued data is more recent than the programmed one
+    CRITICAL_SECTION_BEGIN( );
+    for( uint16_t i = 0; i < WriteQueueCnt; i++ )
+    {
+        EepromPendingWrite_t* pending = &WriteQueue[( WriteQueueBegin + i ) % EEPROM_WRITE_QUEUE_SIZE];
+
+        if( ( pending->Addr >= addr ) && ( pending->Addr < ( addr + size ) ) )
+        {
+            buffer[pending->Addr - addr] = pending->Data;
+        }
+    }
+    CRITICAL_SECTION_END( );
+
     // Lock the Flash Program Erase controller
-    HAL_FLASH_Lock( );
+    EepromMcuLockFlash( );
     return status;
 }
 
+void EepromMcuSetEraseAllowed( bool allowed )
+{
+    IsEraseAllowed = allowed;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( ( allowed == true ) && ( IsCleanUpPending == true ) )
+    {
+        HAL_FLASH_Unlock( );
+        EepromMcuStartCleanUp( );
+        EepromMcuLockFlash( );
+    }
+    CRITICAL_SECTION_END( );
+}
+
+bool EepromMcuIsWritePending( void )
+{
+    return ( ErasingOnGoing != 0 ) || ( IsCleanUpPending == true ) || ( WriteQueueCnt > 0 );
+}
+
 void EepromMcuSetDeviceAddr( uint8_t addr )
 {
     assert_param( FAIL );
@@ -184,4 +341,7 @@ void HAL_FLASH_EndOfOperationCallback( uint32_t ReturnValue )
 void EE_EndOfCleanup_UserCallback( void )
 {
     ErasingOnGoing = 0;
+
+    // Program the data written in the meantime
+    EepromMcuProcessWriteQueue( );
 }
\ No newline at end of file
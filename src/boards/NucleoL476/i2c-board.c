@@ -34,6 +34,18 @@ static I2C_HandleTypeDef I2cHandle = { 0 };
 
 static I2cAddrSize I2cInternalAddrSize = I2C_ADDR_SIZE_8;
 
+/*!
+ * Completion callback of the interrupt driven transaction on the bus
+ */
+static I2cMcuXferDone_t I2cXferDone = NULL;
+
+/*!
+ * \brief Calls and clears the interrupt driven transaction completion callback
+ *
+ * \param [IN] status Transaction status [SUCCESS, FAIL]
+ */
+static void I2cMcuXferNotify( uint8_t status );
+
 void I2cMcuInit( I2c_t *obj, I2cId_t i2cId, PinNames scl, PinNames sda )
 {
     __HAL_RCC_I2C1_CLK_DISABLE( );
@@ -72,6 +84,11 @@ void I2cMcuFormat( I2c_t *obj, I2cMode mode, I2cDutyCycle dutyCycle, bool I2cAck
     I2cHandle.Init.NoStretchMode = I2C_NOSTRETCH_DISABLED;
 
     HAL_I2C_Init( &I2cHandle );
+
+    HAL_NVIC_SetPriority( I2C1_EV_IRQn, IRQ_PRIORITY_I2C, 0 );
+    HAL_NVIC_EnableIRQ( I2C1_EV_IRQn );
+    HAL_NVIC_SetPriority( I2C1_ER_IRQn, IRQ_PRIORITY_I2C, 0 );
+    HAL_NVIC_EnableIRQ( I2C1_ER_IRQn );
 }
 
 void I2cMcuResetBus( I2c_t *obj )
@@ -90,6 +107,8 @@ void I2cMcuResetBus( I2c_t *obj )
 void I2cMcuDeInit( I2c_t *obj )
 {
 
+    HAL_NVIC_DisableIRQ( I2C1_EV_IRQn );
+    HAL_NVIC_DisableIRQ( I2C1_ER_IRQn );
     HAL_I2C_DeInit( &I2cHandle );
 
     __HAL_RCC_I2C1_FORCE_RESET();
@@ -141,6 +160,84 @@ uint8_t I2cMcuReadBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t
     return status;
 }
 
+uint8_t I2cMcuWriteBufferIt( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size, I2cMcuXferDone_t onDone )
+{
+    uint16_t memAddSize = 0;
+
+    if( I2cInternalAddrSize == I2C_ADDR_SIZE_8 )
+    {
+        memAddSize = I2C_MEMADD_SIZE_8BIT;
+    }
+    else
+    {
+        memAddSize = I2C_MEMADD_SIZE_16BIT;
+    }
+    I2cXferDone = onDone;
+    if( HAL_I2C_Mem_Write_IT( &I2cHandle, deviceAddr, addr, memAddSize, buffer, size ) != HAL_OK )
+    {
+        I2cXferDone = NULL;
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+uint8_t I2cMcuReadBufferIt( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size, I2cMcuXferDone_t onDone )
+{
+    uint16_t memAddSize = 0;
+
+    if( I2cInternalAddrSize == I2C_ADDR_SIZE_8 )
+    {
+        memAddSize = I2C_MEMADD_SIZE_8BIT;
+    }
+    else
+    {
+        memAddSize = I2C_MEMADD_SIZE_16BIT;
+    }
+    I2cXferDone = onDone;
+    if( HAL_I2C_Mem_Read_IT( &I2cHandle, deviceAddr, addr, memAddSize, buffer, size ) != HAL_OK )
+    {
+        I2cXferDone = NULL;
+        return FAIL;
+    }
+    return SUCCESS;
+}
+
+static void I2cMcuXferNotify( uint8_t status )
+{
+    I2cMcuXferDone_t onDone = I2cXferDone;
+
+    I2cXferDone = NULL;
+    if( onDone != NULL )
+    {
+        onDone( status );
+    }
+}
+
+void HAL_I2C_MemTxCpltCallback( I2C_HandleTypeDef *handle )
+{
+    I2cMcuXferNotify( SUCCESS );
+}
+
+void HAL_I2C_MemRxCpltCallback( I2C_HandleTypeDef *handle )
+{
+    I2cMcuXferNotify( SUCCESS );
+}
+
+void HAL_I2C_ErrorCallback( I2C_HandleTypeDef *handle )
+{
+    I2cMcuXferNotify( FAIL );
+}
+
+void I2C1_EV_IRQHandler( void )
+{
+    HAL_I2C_EV_IRQHandler( &I2cHandle );
+}
+
+void I2C1_ER_IRQHandler( void )
+{
+    HAL_I2C_ER_IRQHandler( &I2cHandle );
+}
+
 uint8_t I2cMcuWaitStandbyState( I2c_t *obj, uint8_t deviceAddr )
 {
     uint8_t status = FAIL;
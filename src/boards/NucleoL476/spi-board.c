@@ -151,11 +151,48 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
     __HAL_SPI_ENABLE( &SpiHandle[obj->SpiId] );
 
     CRITICAL_SECTION_BEGIN( );
+    SPI_STATS_BEGIN( );
 
     HAL_SPI_TransmitReceive( &SpiHandle[obj->SpiId], ( uint8_t* )&outData, &rxData, 1, HAL_MAX_DELAY );
 
+    SPI_STATS_END( );
     CRITICAL_SECTION_END( );
 
     return( rxData );
 }
 
+void SpiTransfer( Spi_t *obj, const uint8_t *tx, uint8_t *rx, uint16_t len )
+{
+    if( ( obj == NULL ) || ( SpiHandle[obj->SpiId].Instance ) == NULL )
+    {
+        assert_param( FAIL );
+    }
+
+    if( len == 0 )
+    {
+        return;
+    }
+
+    __HAL_SPI_ENABLE( &SpiHandle[obj->SpiId] );
+
+    CRITICAL_SECTION_BEGIN( );
+    SPI_STATS_BEGIN( );
+
+    if( rx == NULL )
+    {
+        HAL_SPI_Transmit( &SpiHandle[obj->SpiId], ( uint8_t* )tx, len, HAL_MAX_DELAY );
+    }
+    else
+    {
+        if( tx == NULL )
+        {
+            // Sent bytes are read ahead of the received ones, the buffer can be shared
+            memset1( rx, 0x00, len );
+            tx = rx;
+        }
+        HAL_SPI_TransmitReceive( &SpiHandle[obj->SpiId], ( uint8_t* )tx, rx, len, HAL_MAX_DELAY );
+    }
+
+    SPI_STATS_END( );
+    CRITICAL_SECTION_END( );
+}
@@ -23,6 +23,7 @@
 #include "stm32l4xx.h"
 #include "utilities.h"
 #include "board.h"
+#include "board-config.h"
 #include "uart-board.h"
 
 /*!
@@ -37,6 +38,59 @@ uint8_t TxData = 0;
 
 extern Uart_t Uart2;
 
+#if defined( UART_DMA_ENABLED )
+/*!
+ * Size of the circular DMA reception buffer
+ *
+ * \remark Half of the buffer must hold the bytes received while the UART and
+ *         DMA interrupts are masked.
+ */
+#ifndef UART_DMA_RX_BUFFER_SIZE
+#define UART_DMA_RX_BUFFER_SIZE                     64
+#endif
+
+static DMA_HandleTypeDef DmaRxHandle;
+static DMA_HandleTypeDef DmaTxHandle;
+
+/*!
+ * Circular buffer written by the reception DMA channel
+ */
+static uint8_t DmaRxBuffer[UART_DMA_RX_BUFFER_SIZE];
+
+/*!
+ * Index of the next DmaRxBuffer byte to be moved to the Rx FIFO
+ */
+static uint16_t DmaRxTail = 0;
+
+/*!
+ * \brief Configures the DMA channels and starts the circular reception
+ */
+static void UartMcuDmaInit( void );
+
+/*!
+ * \brief Stops the DMA channels
+ */
+static void UartMcuDmaDeInit( void );
+
+/*!
+ * \brief Moves the bytes received since the last call to the Rx FIFO and
+ *        notifies the upper layer
+ */
+static void UartMcuDmaRxProcess( void );
+
+/*!
+ * \brief Sends the buffer with the transmission DMA channel
+ *
+ * \remark Blocks until the DMA has fetched the last byte as the buffer
+ *         belongs to the caller.
+ *
+ * \param [IN] buffer Buffer to be sent
+ * \param [IN] size   Buffer size
+ * \retval status     [true: sent, false: DMA or UART busy, use the FIFO]
+ */
+static bool UartMcuDmaPutBuffer( uint8_t *buffer, uint16_t size );
+#endif
+
 void UartMcuInit( Uart_t *obj, UartId_t uartId, PinNames tx, PinNames rx )
 {
     obj->UartId = uartId;
@@ -157,11 +211,15 @@ void UartMcuConfig( Uart_t *obj, UartMode_t mode, uint32_t baudrate, WordLength_
             assert_param( FAIL );
         }
 
-        HAL_NVIC_SetPriority( USART2_IRQn, 1, 0 );
+        HAL_NVIC_SetPriority( USART2_IRQn, IRQ_PRIORITY_UART, 0 );
         HAL_NVIC_EnableIRQ( USART2_IRQn );
 
+#if defined( UART_DMA_ENABLED )
+        UartMcuDmaInit( );
+#else
         /* Enable the UART Data Register not empty Interrupt */
         HAL_UART_Receive_IT( &UartHandle, &RxData, 1 );
+#endif
     }
 }
 
@@ -175,6 +233,9 @@ void UartMcuDeInit( Uart_t *obj )
     }
     else
     {
+#if defined( UART_DMA_ENABLED )
+        UartMcuDmaDeInit( );
+#endif
         __HAL_RCC_USART2_FORCE_RESET( );
         __HAL_RCC_USART2_RELEASE_RESET( );
         __HAL_RCC_USART2_CLK_DISABLE( );
@@ -226,15 +287,12 @@ uint8_t UartMcuGetChar( Uart_t *obj, uint8_t *data )
     }
     else
     {
-        CRITICAL_SECTION_BEGIN( );
-
+        // The Rx IRQ is the only FIFO producer, no critical section is needed
         if( IsFifoEmpty( &obj->FifoRx ) == false )
         {
             *data = FifoPop( &obj->FifoRx );
-            CRITICAL_SECTION_END( );
             return 0;
         }
-        CRITICAL_SECTION_END( );
         return 1;
     }
 }
@@ -251,13 +309,30 @@ uint8_t UartMcuPutBuffer( Uart_t *obj, uint8_t *buffer, uint16_t size )
     }
     else
     {
-        uint8_t retryCount;
-        uint16_t i;
+        uint8_t retryCount = 0;
+        uint16_t count;
 
-        for( i = 0; i < size; i++ )
+#if defined( UART_DMA_ENABLED )
+        if( UartMcuDmaPutBuffer( buffer, size ) == true )
         {
-            retryCount = 0;
-            while( UartPutChar( obj, buffer[i] ) != 0 )
+            return 0; // OK
+        }
+#endif
+        while( size > 0 )
+        {
+            count = FifoPushBuffer( &obj->FifoTx, buffer, size );
+            if( count > 0 )
+            {
+                buffer += count;
+                size -= count;
+                retryCount = 0;
+
+                // Trig UART Tx interrupt to start sending the FIFO contents.
+                CRITICAL_SECTION_BEGIN( );
+                __HAL_UART_ENABLE_IT( &UartHandle, UART_IT_TC );
+                CRITICAL_SECTION_END( );
+            }
+            else
             {
                 retryCount++;
 
@@ -276,15 +351,22 @@ uint8_t UartMcuGetBuffer( Uart_t *obj, uint8_t *buffer, uint16_t size, uint16_t
 {
     uint16_t localSize = 0;
 
-    while( localSize < size )
+    if( obj->UartId != UART_USB_CDC )
     {
-        if( UartGetChar( obj, buffer + localSize ) == 0 )
-        {
-            localSize++;
-        }
-        else
+        localSize = FifoPopBuffer( &obj->FifoRx, buffer, size );
+    }
+    else
+    {
+        while( localSize < size )
         {
-            break;
+            if( UartGetChar( obj, buffer + localSize ) == 0 )
+            {
+                localSize++;
+            }
+            else
+            {
+                break;
+            }
         }
     }
 
@@ -312,6 +394,26 @@ void HAL_UART_TxCpltCallback( UART_HandleTypeDef *handle )
     }
 }
 
+#if defined( UART_DMA_ENABLED )
+void HAL_UART_RxHalfCpltCallback( UART_HandleTypeDef *handle )
+{
+    UartMcuDmaRxProcess( );
+}
+
+void HAL_UART_RxCpltCallback( UART_HandleTypeDef *handle )
+{
+    UartMcuDmaRxProcess( );
+}
+
+void HAL_UART_ErrorCallback( UART_HandleTypeDef *handle )
+{
+    // Save the bytes received before the error and restart the reception
+    UartMcuDmaRxProcess( );
+    HAL_DMA_Abort( &DmaRxHandle );
+    DmaRxTail = 0;
+    HAL_UART_Receive_DMA( &UartHandle, DmaRxBuffer, UART_DMA_RX_BUFFER_SIZE );
+}
+#else
 void HAL_UART_RxCpltCallback( UART_HandleTypeDef *handle )
 {
     if( IsFifoFull( &Uart2.FifoRx ) == false )
@@ -332,8 +434,137 @@ void HAL_UART_ErrorCallback( UART_HandleTypeDef *handle )
 {
     HAL_UART_Receive_IT( &UartHandle, &RxData, 1 );
 }
+#endif
 
 void USART2_IRQHandler( void )
 {
+#if defined( UART_DMA_ENABLED )
+    // Idle line detected, flush the partially filled DMA buffer
+    if( ( __HAL_UART_GET_FLAG( &UartHandle, UART_FLAG_IDLE ) != RESET ) &&
+        ( __HAL_UART_GET_IT_SOURCE( &UartHandle, UART_IT_IDLE ) != RESET ) )
+    {
+        __HAL_UART_CLEAR_IDLEFLAG( &UartHandle );
+        UartMcuDmaRxProcess( );
+    }
+#endif
     HAL_UART_IRQHandler( &UartHandle );
 }
+
+#if defined( UART_DMA_ENABLED )
+static void UartMcuDmaInit( void )
+{
+    UartMcuDmaDeInit( );
+
+    __HAL_RCC_DMA1_CLK_ENABLE( );
+
+    DmaRxHandle.Instance = DMA1_Channel6;
+    DmaRxHandle.Init.Request = DMA_REQUEST_2;
+    DmaRxHandle.Init.Direction = DMA_PERIPH_TO_MEMORY;
+    DmaRxHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    DmaRxHandle.Init.MemInc = DMA_MINC_ENABLE;
+    DmaRxHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    DmaRxHandle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    DmaRxHandle.Init.Mode = DMA_CIRCULAR;
+    DmaRxHandle.Init.Priority = DMA_PRIORITY_HIGH;
+    if( HAL_DMA_Init( &DmaRxHandle ) != HAL_OK )
+    {
+        assert_param( FAIL );
+    }
+    __HAL_LINKDMA( &UartHandle, hdmarx, DmaRxHandle );
+
+    DmaTxHandle.Instance = DMA1_Channel7;
+    DmaTxHandle.Init.Request = DMA_REQUEST_2;
+    DmaTxHandle.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    DmaTxHandle.Init.PeriphInc = DMA_PINC_DISABLE;
+    DmaTxHandle.Init.MemInc = DMA_MINC_ENABLE;
+    DmaTxHandle.Init.PeriphDataAlignment = DMA_PDATAALIGN_BYTE;
+    DmaTxHandle.Init.MemDataAlignment = DMA_MDATAALIGN_BYTE;
+    DmaTxHandle.Init.Mode = DMA_NORMAL;
+    DmaTxHandle.Init.Priority = DMA_PRIORITY_LOW;
+    if( HAL_DMA_Init( &DmaTxHandle ) != HAL_OK )
+    {
+        assert_param( FAIL );
+    }
+    __HAL_LINKDMA( &UartHandle, hdmatx, DmaTxHandle );
+
+    // Same priority as the UART IRQ, UartMcuDmaRxProcess is never preempted by itself
+    HAL_NVIC_SetPriority( DMA1_Channel6_IRQn, IRQ_PRIORITY_UART, 0 );
+    HAL_NVIC_EnableIRQ( DMA1_Channel6_IRQn );
+    HAL_NVIC_SetPriority( DMA1_Channel7_IRQn, IRQ_PRIORITY_UART, 0 );
+    HAL_NVIC_EnableIRQ( DMA1_Channel7_IRQn );
+
+    DmaRxTail = 0;
+    if( HAL_UART_Receive_DMA( &UartHandle, DmaRxBuffer, UART_DMA_RX_BUFFER_SIZE ) != HAL_OK )
+    {
+        assert_param( FAIL );
+    }
+    __HAL_UART_ENABLE_IT( &UartHandle, UART_IT_IDLE );
+}
+
+static void UartMcuDmaDeInit( void )
+{
+    if( DmaRxHandle.Instance != NULL )
+    {
+        HAL_DMA_DeInit( &DmaRxHandle );
+    }
+    if( DmaTxHandle.Instance != NULL )
+    {
+        HAL_DMA_DeInit( &DmaTxHandle );
+    }
+}
+
+static void UartMcuDmaRxProcess( void )
+{
+    uint16_t head = ( UART_DMA_RX_BUFFER_SIZE - __HAL_DMA_GET_COUNTER( &DmaRxHandle ) ) % UART_DMA_RX_BUFFER_SIZE;
+
+    if( head == DmaRxTail )
+    {
+        return;
+    }
+    if( head < DmaRxTail )
+    {
+        // The DMA wrapped around, flush the end of the buffer first
+        FifoPushBuffer( &Uart2.FifoRx, DmaRxBuffer + DmaRxTail, UART_DMA_RX_BUFFER_SIZE - DmaRxTail );
+        DmaRxTail = 0;
+    }
+    FifoPushBuffer( &Uart2.FifoRx, DmaRxBuffer + DmaRxTail, head - DmaRxTail );
+    DmaRxTail = head;
+
+    if( Uart2.IrqNotify != NULL )
+    {
+        Uart2.IrqNotify( UART_NOTIFY_RX );
+    }
+}
+
+static bool UartMcuDmaPutBuffer( uint8_t *buffer, uint16_t size )
+{
+    HAL_StatusTypeDef status = HAL_BUSY;
+
+    CRITICAL_SECTION_BEGIN( );
+    // Keep the ordering with the bytes already queued in the Tx FIFO
+    if( IsFifoEmpty( &Uart2.FifoTx ) == true )
+    {
+        status = HAL_UART_Transmit_DMA( &UartHandle, buffer, size );
+    }
+    CRITICAL_SECTION_END( );
+
+    if( status != HAL_OK )
+    {
+        return false;
+    }
+    while( __HAL_DMA_GET_COUNTER( &DmaTxHandle ) != 0 )
+    {
+    }
+    return true;
+}
+
+void DMA1_Channel6_IRQHandler( void )
+{
+    HAL_DMA_IRQHandler( &DmaRxHandle );
+}
+
+void DMA1_Channel7_IRQHandler( void )
+{
+    HAL_DMA_IRQHandler( &DmaTxHandle );
+}
+#endif
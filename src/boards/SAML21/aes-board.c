@@ -0,0 +1,93 @@
+/*!
+ * \file      aes-board.c
+ *
+ * \brief     Target board AES hardware accelerator driver implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <utils.h>
+#include <hal_atomic.h>
+#include "utilities.h"
+#include "aes-board.h"
+
+/*!
+ * Maximum number of status polls per block before giving up
+ */
+#define AES_MCU_ENCCMP_TIMEOUT                      1000
+
+/*!
+ * Packs 4 bytes into a word, first byte being the least significant one as
+ * expected by the AES KEYWORD and INDATA registers
+ */
+#define AES_MCU_WORD( p )                          ( ( uint32_t )( p )[0] | ( ( uint32_t )( p )[1] << 8 ) | \
+                                                     ( ( uint32_t )( p )[2] << 16 ) | ( ( uint32_t )( p )[3] << 24 ) )
+
+static void AesMcuStoreWord( uint8_t *p, uint32_t word )
+{
+    p[0] = ( uint8_t )word;
+    p[1] = ( uint8_t )( word >> 8 );
+    p[2] = ( uint8_t )( word >> 16 );
+    p[3] = ( uint8_t )( word >> 24 );
+}
+
+uint8_t AesMcuEncrypt( const uint8_t key[16], const uint8_t *in, uint8_t *out, uint16_t nbBlocks )
+{
+    uint8_t status = SUCCESS;
+    uint32_t timeout;
+
+    hri_mclk_set_APBCMASK_AES_bit( MCLK );
+
+    // ECB mode, 128 bits key, encryption, manual start
+    hri_aes_write_CTRLA_reg( AES, 0 );
+    hri_aes_write_CTRLA_reg( AES, AES_CTRLA_AESMODE( 0 ) | AES_CTRLA_KEYSIZE( 0 ) | AES_CTRLA_CIPHER );
+    hri_aes_write_CTRLA_ENABLE_bit( AES, true );
+    for( uint8_t i = 0; i < 4; i++ )
+    {
+        hri_aes_write_KEYWORD_reg( AES, i, AES_MCU_WORD( key + ( i << 2 ) ) );
+    }
+
+    while( nbBlocks-- > 0 )
+    {
+        hri_aes_write_DATABUFPTR_reg( AES, 0 );
+        for( uint8_t i = 0; i < 16; i += 4 )
+        {
+            hri_aes_write_INDATA_reg( AES, AES_MCU_WORD( in + i ) );
+        }
+        hri_aes_set_CTRLB_START_bit( AES );
+
+        timeout = AES_MCU_ENCCMP_TIMEOUT;
+        while( ( hri_aes_get_INTFLAG_ENCCMP_bit( AES ) == false ) && ( --timeout > 0 ) )
+        {
+        }
+        if( timeout == 0 )
+        {
+            status = FAIL;
+            break;
+        }
+
+        // Reading the output clears ENCCMP
+        hri_aes_write_DATABUFPTR_reg( AES, 0 );
+        for( uint8_t i = 0; i < 16; i += 4 )
+        {
+            AesMcuStoreWord( out + i, hri_aes_read_INDATA_reg( AES ) );
+        }
+
+        in += 16;
+        out += 16;
+    }
+
+    hri_aes_write_CTRLA_ENABLE_bit( AES, false );
+    hri_mclk_clear_APBCMASK_AES_bit( MCLK );
+    return status;
+}
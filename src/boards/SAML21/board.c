@@ -28,6 +28,7 @@
 #include <hal_timer.h>
 #include <hal_spi_m_sync.h>
 #include <hal_usart_sync.h>
+#include <hal_sleep.h>
 #include <hpl_rtc_base.h>
 #include "board-config.h"
 #include "utilities.h"
@@ -38,8 +39,10 @@
 #include "i2c.h"
 #include "uart.h"
 #include "timer.h"
+#include "stack.h"
 #include "gps.h"
 #include "rtc-board.h"
+#include "lpm-board.h"
 #include "sx1276-board.h"
 #include "board.h"
 
@@ -72,6 +75,8 @@ void BoardInitPeriph( void )
 
 void BoardInitMcu( void )
 {
+    StackInit( );
+
     init_mcu( );
     delay_init( SysTick );
 
@@ -86,6 +91,9 @@ void BoardInitMcu( void )
     SpiInit( &SX1276.Spi, SPI_1, RADIO_MOSI, RADIO_MISO, RADIO_SCLK, NC );
     SX1276IoInit( );
 
+    // The BACKUP mode loses the RAM contents, STANDBY is the deepest mode used
+    LpmSetOffMode( LPM_APPLI_ID, LPM_DISABLE );
+
     McuInitialized = true;
     SX1276IoDbgInit( );
     SX1276IoTcxoInit( );
@@ -132,11 +140,54 @@ void BoardLowPowerHandler( void )
      * and cortex will not enter low power anyway
      */
 
-    // Call low power handling function.
+    LpmEnterLowPower( );
 
     __enable_irq( );
 }
 
+/*!
+ * \brief Enters Low Power Stop Mode
+ *
+ * \note ARM exits the function when waking up
+ *
+ * \remark The STANDBY mode keeps the RAM and the registers. The SERCOM SPI
+ *         and USART keep their configuration and are not initialized again
+ *         on exit. The RTC runs from the XOSC32K and the radio DIO lines use
+ *         asynchronous EIC edge detection, both wake the MCU up.
+ */
+void LpmEnterStopMode( void )
+{
+    sleep( PM_SLEEPCFG_SLEEPMODE_STANDBY_Val );
+}
+
+/*!
+ * \brief Exits Low Power Stop Mode
+ */
+void LpmExitStopMode( void )
+{
+    // The on demand oscillators and the clock generators restart by themselves
+}
+
+/*!
+ * \brief Enters Low Power Sleep Mode
+ *
+ * \note ARM exits the function when waking up
+ */
+void LpmEnterSleepMode( void )
+{
+    sleep( PM_SLEEPCFG_SLEEPMODE_IDLE_Val );
+}
+
+void BoardSystemClockRequest( void )
+{
+    // The system clock is always restored at the low power mode exit
+}
+
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level )
+{
+    // The MCU always runs on its full speed system clock
+}
+
 #if !defined ( __CC_ARM )
 
 /*
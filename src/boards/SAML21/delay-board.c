@@ -31,3 +31,9 @@ void DelayMsMcu( uint32_t ms )
 {
     delay_ms( ms );
 }
+
+bool DelayMcuIsSleepAllowed( void )
+{
+    // The timer interrupt ending the delay must be able to run
+    return ( __get_IPSR( ) == 0 ) && ( __get_PRIMASK( ) == 0 );
+}
@@ -35,6 +35,16 @@ uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
     return FAIL;
 }
 
+void EepromMcuSetEraseAllowed( bool allowed )
+{
+    // No erase operations to postpone
+}
+
+bool EepromMcuIsWritePending( void )
+{
+    return false;
+}
+
 void EepromMcuSetDeviceAddr( uint8_t addr )
 {
     while( 1 )
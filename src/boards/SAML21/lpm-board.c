@@ -0,0 +1,221 @@
+/*!
+ * \file      lpm-board.c
+ *
+ * \brief     Target board low power modes management
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \author    Gregory Cristian ( Semtech )
+ *
+ * \author    Marten Lootsma(TWTG) on behalf of Microchip/Atmel (c)2017
+ */
+#include <stdint.h>
+#include <utils.h>
+#include "board-config.h"
+#include "utilities.h"
+#include "timer.h"
+#include "rtc-board.h"
+#include "energy.h"
+#include "lpm-board.h"
+
+static uint32_t StopModeDisable = 0;
+static uint32_t OffModeDisable = 0;
+
+/*!
+ * Maximum measured duration of LpmExitStopMode in RTC ticks
+ */
+static uint32_t StopModeExitTime = 0;
+
+void LpmSetOffMode( LpmId_t id, LpmSetMode_t mode )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    switch( mode )
+    {
+        case LPM_DISABLE:
+        {
+            OffModeDisable |= ( uint32_t )id;
+            break;
+        }
+        case LPM_ENABLE:
+        {
+            OffModeDisable &= ~( uint32_t )id;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    CRITICAL_SECTION_END( );
+    return;
+}
+
+void LpmSetStopMode( LpmId_t id, LpmSetMode_t mode )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    switch( mode )
+    {
+        case LPM_DISABLE:
+        {
+            StopModeDisable |= ( uint32_t )id;
+            break;
+        }
+        case LPM_ENABLE:
+        {
+            StopModeDisable &= ~( uint32_t )id;
+            break;
+        }
+        default:
+        {
+            break;
+        }
+    }
+
+    CRITICAL_SECTION_END( );
+    return;
+}
+
+void LpmEnterLowPower( void )
+{
+    uint32_t exitStart = 0;
+    uint32_t exitTime = 0;
+
+    switch( LpmGetModeForNextEvent( LpmGetMode( ), TimerGetTicksToNextEvent( ) ) )
+    {
+        case LPM_SLEEP_MODE:
+        {
+            /*!
+            * SLEEP mode is required
+            */
+            EnergySetMcuState( ENERGY_MCU_SLEEP );
+            LpmEnterSleepMode( );
+            LpmExitSleepMode( );
+            EnergySetMcuState( ENERGY_MCU_RUN );
+            break;
+        }
+        case LPM_STOP_MODE:
+        {
+            /*!
+            * STOP mode is required
+            */
+            EnergySetMcuState( ENERGY_MCU_STOP );
+            LpmEnterStopMode( );
+            exitStart = RtcGetTimerValue( );
+            LpmExitStopMode( );
+            exitTime = RtcGetTimerValue( ) - exitStart;
+            EnergySetMcuState( ENERGY_MCU_RUN );
+            if( exitTime > StopModeExitTime )
+            {
+                StopModeExitTime = exitTime;
+            }
+            break;
+        }
+        case LPM_OFF_MODE:
+        default:
+        {
+            /*!
+            * OFF mode is required
+            */
+            EnergySetMcuState( ENERGY_MCU_OFF );
+            LpmEnterOffMode( );
+            LpmExitOffMode( );
+            EnergySetMcuState( ENERGY_MCU_RUN );
+            break;
+        }
+    }
+    return;
+}
+
+LpmGetMode_t LpmGetModeForNextEvent( LpmGetMode_t mode, uint32_t ticks )
+{
+    int16_t mcuWakeUpTime = RtcGetMcuWakeUpTime( );
+    uint32_t wakeUpLatency = StopModeExitTime;
+
+    if( mcuWakeUpTime > 0 )
+    {
+        wakeUpLatency += ( uint32_t )mcuWakeUpTime;
+    }
+
+    if( ( mode == LPM_OFF_MODE ) &&
+        ( ticks <= ( wakeUpLatency + RtcMs2Tick( LPM_OFF_MODE_MIN_RESIDENCY ) ) ) )
+    {
+        mode = LPM_STOP_MODE;
+    }
+    if( ( mode == LPM_STOP_MODE ) &&
+        ( ticks <= ( wakeUpLatency + RtcMs2Tick( LPM_STOP_MODE_MIN_RESIDENCY ) ) ) )
+    {
+        mode = LPM_SLEEP_MODE;
+    }
+    return mode;
+}
+
+uint32_t LpmGetStopModeExitTime( void )
+{
+    return StopModeExitTime;
+}
+
+LpmGetMode_t LpmGetMode(void)
+{
+    LpmGetMode_t mode;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( StopModeDisable != 0 )
+    {
+        mode = LPM_SLEEP_MODE;
+    }
+    else
+    {
+        if( OffModeDisable != 0 )
+        {
+            mode = LPM_STOP_MODE;
+        }
+        else
+        {
+            mode = LPM_OFF_MODE;
+        }
+    }
+
+    CRITICAL_SECTION_END( );
+    return mode;
+}
+
+WEAK void LpmEnterSleepMode( void )
+{
+}
+
+WEAK void LpmExitSleepMode( void )
+{
+}
+
+WEAK void LpmEnterStopMode( void )
+{
+}
+
+WEAK void LpmExitStopMode( void )
+{
+}
+
+WEAK void LpmEnterOffMode( void )
+{
+}
+
+WEAK void LpmExitOffMode( void )
+{
+}
@@ -30,6 +30,7 @@
 #include "systime.h"
 #include "gpio.h"
 
+#include "lpm-board.h"
 #include "rtc-board.h"
 
 #define RTC_DEBUG_ENABLE                            1
@@ -70,6 +71,16 @@ typedef struct
  */
 static RtcTimerContext_t RtcTimerContext;
 
+/*!
+ * Flag used to indicates a the MCU has waken-up from an external IRQ
+ */
+static bool McuWakeUpTimeInitialized = false;
+
+/*!
+ * Compensates MCU wakeup time
+ */
+static int16_t McuWakeUpTimeCal = 0;
+
 #if( RTC_DEBUG_GPIO_STATE == RTC_DEBUG_ENABLE )
 Gpio_t DbgRtcPin0;
 Gpio_t DbgRtcPin1;
@@ -157,6 +168,22 @@ void RtcDelayMs( TimerTime_t milliseconds )
 
 void RtcSetAlarm( uint32_t timeout )
 {
+    // We don't go in Low Power mode for timeout below MIN_ALARM_DELAY
+    if( ( int64_t )( MIN_ALARM_DELAY + McuWakeUpTimeCal ) < ( int64_t )( timeout - RtcGetTimerElapsedTime( ) ) )
+    {
+        LpmSetStopMode( LPM_RTC_ID, LPM_ENABLE );
+    }
+    else
+    {
+        LpmSetStopMode( LPM_RTC_ID, LPM_DISABLE );
+    }
+
+    // In case stop mode is required
+    if( LpmGetMode( ) == LPM_STOP_MODE )
+    {
+        timeout = timeout - McuWakeUpTimeCal;
+    }
+
     RtcStartAlarm( timeout );
 }
 
@@ -242,6 +269,27 @@ void RtcBkupRead( uint32_t* data0, uint32_t* data1 )
     CRITICAL_SECTION_END( );
 }
 
+void RtcSetMcuWakeUpTime( void )
+{
+    uint32_t now, hit;
+
+    if( ( McuWakeUpTimeInitialized == false ) &&
+        ( RtcTimerContext.AlarmState == ALARM_RUNNING ) )
+    {
+        // Measured once, at the first alarm wake up
+        McuWakeUpTimeInitialized = true;
+        now = RtcGetTimerValue( );
+        hit = RtcTimerContext.Time + RtcTimerContext.Delay;
+
+        McuWakeUpTimeCal += ( int16_t )( now - hit );
+    }
+}
+
+int16_t RtcGetMcuWakeUpTime( void )
+{
+    return McuWakeUpTimeCal;
+}
+
 void RtcProcess( void )
 {
     CRITICAL_SECTION_BEGIN( );
@@ -275,6 +323,11 @@ TimerTime_t RtcTempCompensation( TimerTime_t period, float temperature )
 
 static void RtcAlarmIrq( void )
 {
+    // Enable low power at irq
+    LpmSetStopMode( LPM_RTC_ID, LPM_ENABLE );
+
+    RtcSetMcuWakeUpTime( );
+
     RtcTimerContext.AlarmState = ALARM_STOPPED;
     // Because of one shot the task will be removed after the callback
     RtcTimeoutPendingInterrupt = false;
@@ -292,3 +345,26 @@ static void RtcOverflowIrq( void )
 {
     //RtcTimerContext.Time += ( uint64_t )( 1 << 32 );
 }
+
+int32_t RtcSetCalibration( int32_t ppb )
+{
+    // FREQCORR adds or removes VALUE pulses every 4096 * 240 prescaler clock
+    // cycles. One step is 1e9 / 983040 = 1017.25 ppb.
+    int64_t steps = ( int64_t )ppb * 983040;
+    uint8_t freqCorr;
+
+    steps = ( steps + ( ( steps < 0 ) ? -500000000 : 500000000 ) ) / 1000000000;
+    steps = MIN( MAX( steps, -127 ), 127 );
+
+    if( steps < 0 )
+    {
+        freqCorr = RTC_FREQCORR_SIGN | RTC_FREQCORR_VALUE( -steps );
+    }
+    else
+    {
+        freqCorr = RTC_FREQCORR_VALUE( steps );
+    }
+    hri_rtcmode0_write_FREQCORR_reg( RTC, freqCorr );
+
+    return ( int32_t )( ( steps * 1000000000 ) / 983040 );
+}
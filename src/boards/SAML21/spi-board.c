@@ -25,8 +25,18 @@
 #include <peripheral_clk_config.h>
 #include <hal_spi_m_sync.h>
 #include <hal_gpio.h>
+#include "utilities.h"
 #include "spi-board.h"
 
+/*!
+ * SPI clock frequency. The SERCOM divides its core clock by 2 * ( BAUD + 1 ),
+ * 8 MHz is the fastest clock of the 16 MHz core and is within the SX1276
+ * 10 MHz limit
+ */
+#ifndef SPI_FREQUENCY
+#define SPI_FREQUENCY                               8000000
+#endif
+
 struct spi_m_sync_descriptor Spi0;
 
 void SpiInit( Spi_t *obj, SpiId_t spiId, PinNames mosi, PinNames miso, PinNames sclk, PinNames nss )
@@ -45,7 +55,7 @@ void SpiInit( Spi_t *obj, SpiId_t spiId, PinNames mosi, PinNames miso, PinNames
     hri_sercomspi_write_CTRLA_reg( SERCOM5, SERCOM_SPI_CTRLA_MODE( 3 ) | SERCOM_SPI_CTRLA_DOPO( 1 ) );
     // 0x00020000 RXEN
     hri_sercomspi_write_CTRLB_reg( SERCOM5, SERCOM_SPI_CTRLB_RXEN );
-    hri_sercomspi_write_BAUD_reg( SERCOM5, ( ( float )CONF_GCLK_SERCOM5_CORE_FREQUENCY / ( float )( 2 * 1000000 ) ) - 1 );
+    hri_sercomspi_write_BAUD_reg( SERCOM5, ( CONF_GCLK_SERCOM5_CORE_FREQUENCY / ( 2 * SPI_FREQUENCY ) ) - 1 );
     hri_sercomspi_write_DBGCTRL_reg( SERCOM5, 0 );
 
     // Set pin direction to input. MISO
@@ -76,6 +86,8 @@ void SpiDeInit( Spi_t *obj )
 
 uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
 {
+    SPI_STATS_BEGIN( );
+
     // Wait for bus idle (ready to write)
     while( ( SERCOM_SPI_INTFLAG_DRE & hri_sercomspi_read_INTFLAG_reg( SERCOM5 ) ) == 0 )
     {
@@ -96,5 +108,49 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
     // Read byte
     outData = ( uint16_t )hri_sercomspi_read_DATA_reg( SERCOM5 );
 
+    SPI_STATS_END( );
+
     return outData;
 }
+
+void SpiTransfer( Spi_t *obj, const uint8_t *tx, uint8_t *rx, uint16_t len )
+{
+    uint8_t rxData = 0;
+
+    if( len == 0 )
+    {
+        return;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    SPI_STATS_BEGIN( );
+
+    // Keep the next byte in the transmit buffer while the current one is shifted
+    while( ( SERCOM_SPI_INTFLAG_DRE & hri_sercomspi_read_INTFLAG_reg( SERCOM5 ) ) == 0 )
+    {
+    }
+    hri_sercomspi_write_DATA_reg( SERCOM5, ( tx != NULL ) ? tx[0] : 0x00 );
+
+    for( uint16_t i = 0; i < len; i++ )
+    {
+        if( ( i + 1 ) < len )
+        {
+            while( ( SERCOM_SPI_INTFLAG_DRE & hri_sercomspi_read_INTFLAG_reg( SERCOM5 ) ) == 0 )
+            {
+            }
+            hri_sercomspi_write_DATA_reg( SERCOM5, ( tx != NULL ) ? tx[i + 1] : 0x00 );
+        }
+
+        while( ( SERCOM_SPI_INTFLAG_RXC & hri_sercomspi_read_INTFLAG_reg( SERCOM5 ) ) == 0 )
+        {
+        }
+        rxData = ( uint8_t )hri_sercomspi_read_DATA_reg( SERCOM5 );
+        if( rx != NULL )
+        {
+            rx[i] = rxData;
+        }
+    }
+
+    SPI_STATS_END( );
+    CRITICAL_SECTION_END( );
+}
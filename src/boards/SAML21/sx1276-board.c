@@ -43,6 +43,7 @@ static uint8_t SX1276GetPaSelect( uint32_t channel );
  */
 static bool RadioIsActive = false;
 
+#if !defined( USE_RADIO_STATIC_BINDING )
 /*!
  * Radio driver structure initialization
  */
@@ -58,6 +59,7 @@ const struct Radio_s Radio =
     SX1276SetTxConfig,
     SX1276CheckRfFrequency,
     SX1276GetTimeOnAir,
+    SX1276PrepareTx,
     SX1276Send,
     SX1276SetSleep,
     SX1276SetStby,
@@ -75,7 +77,12 @@ const struct Radio_s Radio =
     NULL, // void ( *IrqProcess )( void )
     NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
     NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    SX1276GetFreqError,
+    SX1276StartCarrierSense,
+    NULL, // uint32_t ( *CalibrateWakeupTime )( void ) - SX126x Only
+    NULL, // void ( *SetWakeupTime )( uint32_t time ) - SX126x Only
 };
+#endif
 
 /*!
  * Debug GPIO pins objects
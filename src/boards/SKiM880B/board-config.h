@@ -110,6 +110,27 @@ extern "C"
 #define RADIO_DBG_PIN_TX                            NC
 #define RADIO_DBG_PIN_RX                            NC
 
+/*!
+ * \brief NVIC priority map, 0 is the most urgent
+ *
+ * The radio DIO lines and the RTC alarm come first: the DIO edge timestamps
+ * the RX done and the RTC alarm opens the RX windows. The UART and I2C
+ * handlers cannot delay them. Their worst case latency is the longest timer
+ * IRQ run ( TimerGetIrqDurationMax ) plus the longest critical section.
+ *
+ * \remark The GPIO IRQ_HIGH_PRIORITY and IRQ_VERY_HIGH_PRIORITY levels are
+ *         reserved to the radio DIO lines. A radio DIO must not share the
+ *         EXTI 9_5 or 15_10 interrupt with a lower priority pin.
+ */
+#define IRQ_PRIORITY_RADIO_DIO                      0
+#define IRQ_PRIORITY_RTC                            0
+#define IRQ_PRIORITY_SYSTICK                        0
+#define IRQ_PRIORITY_SYSTEM                         1
+#define IRQ_PRIORITY_GPIO_MEDIUM                    2
+#define IRQ_PRIORITY_UART                           2
+#define IRQ_PRIORITY_GPIO_LOW                       3
+#define IRQ_PRIORITY_I2C                            3
+
 #ifdef __cplusplus
 }
 #endif
@@ -170,17 +170,17 @@ void GpioMcuSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriori
         {
         case IRQ_VERY_LOW_PRIORITY:
         case IRQ_LOW_PRIORITY:
-            priority = 3;
+            priority = IRQ_PRIORITY_GPIO_LOW;
             break;
         case IRQ_MEDIUM_PRIORITY:
-            priority = 2;
+            priority = IRQ_PRIORITY_GPIO_MEDIUM;
             break;
         case IRQ_HIGH_PRIORITY:
-            priority = 1;
+            priority = IRQ_PRIORITY_RADIO_DIO;
             break;
         case IRQ_VERY_HIGH_PRIORITY:
         default:
-            priority = 0;
+            priority = IRQ_PRIORITY_RADIO_DIO;
             break;
         }
 
@@ -151,6 +151,7 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
     __HAL_SPI_ENABLE( &SpiHandle[obj->SpiId] );
 
     CRITICAL_SECTION_BEGIN( );
+    SPI_STATS_BEGIN( );
 
     while( __HAL_SPI_GET_FLAG( &SpiHandle[obj->SpiId], SPI_FLAG_TXE ) == RESET );
     SpiHandle[obj->SpiId].Instance->DR = ( uint16_t ) ( outData & 0xFF );
@@ -158,8 +159,53 @@ uint16_t SpiInOut( Spi_t *obj, uint16_t outData )
     while( __HAL_SPI_GET_FLAG( &SpiHandle[obj->SpiId], SPI_FLAG_RXNE ) == RESET );
     rxData = ( uint16_t ) SpiHandle[obj->SpiId].Instance->DR;
 
+    SPI_STATS_END( );
     CRITICAL_SECTION_END( );
 
     return( rxData );
 }
 
+void SpiTransfer( Spi_t *obj, const uint8_t *tx, uint8_t *rx, uint16_t len )
+{
+    SPI_TypeDef *spi = NULL;
+    uint8_t rxData = 0;
+
+    if( ( obj == NULL ) || ( SpiHandle[obj->SpiId].Instance ) == NULL )
+    {
+        assert_param( FAIL );
+    }
+
+    if( len == 0 )
+    {
+        return;
+    }
+    spi = SpiHandle[obj->SpiId].Instance;
+
+    __HAL_SPI_ENABLE( &SpiHandle[obj->SpiId] );
+
+    CRITICAL_SECTION_BEGIN( );
+    SPI_STATS_BEGIN( );
+
+    // Keep the next byte in the transmit register while the current one is shifted
+    while( __HAL_SPI_GET_FLAG( &SpiHandle[obj->SpiId], SPI_FLAG_TXE ) == RESET );
+    spi->DR = ( tx != NULL ) ? tx[0] : 0x00;
+
+    for( uint16_t i = 0; i < len; i++ )
+    {
+        if( ( i + 1 ) < len )
+        {
+            while( __HAL_SPI_GET_FLAG( &SpiHandle[obj->SpiId], SPI_FLAG_TXE ) == RESET );
+            spi->DR = ( tx != NULL ) ? tx[i + 1] : 0x00;
+        }
+
+        while( __HAL_SPI_GET_FLAG( &SpiHandle[obj->SpiId], SPI_FLAG_RXNE ) == RESET );
+        rxData = ( uint8_t )spi->DR;
+        if( rx != NULL )
+        {
+            rx[i] = rxData;
+        }
+    }
+
+    SPI_STATS_END( );
+    CRITICAL_SECTION_END( );
+}
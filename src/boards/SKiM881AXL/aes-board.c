@@ -0,0 +1,89 @@
+/*!
+ * \file      aes-board.c
+ *
+ * \brief     Target board AES hardware accelerator driver implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include "stm32l0xx.h"
+#include "utilities.h"
+#include "aes-board.h"
+
+/*!
+ * Maximum number of status polls per block before giving up
+ */
+#define AES_MCU_CCF_TIMEOUT                         1000
+
+/*!
+ * Packs 4 bytes into a word, first byte being the most significant one as
+ * expected by the AES peripheral when no data swapping is selected
+ */
+#define AES_MCU_WORD( p )                          ( ( ( uint32_t )( p )[0] << 24 ) | ( ( uint32_t )( p )[1] << 16 ) | \
+                                                     ( ( uint32_t )( p )[2] << 8 ) | ( uint32_t )( p )[3] )
+
+static void AesMcuStoreWord( uint8_t *p, uint32_t word )
+{
+    p[0] = ( uint8_t )( word >> 24 );
+    p[1] = ( uint8_t )( word >> 16 );
+    p[2] = ( uint8_t )( word >> 8 );
+    p[3] = ( uint8_t )word;
+}
+
+uint8_t AesMcuEncrypt( const uint8_t key[16], const uint8_t *in, uint8_t *out, uint16_t nbBlocks )
+{
+    uint8_t status = SUCCESS;
+    uint32_t timeout;
+
+    RCC->AHBENR |= RCC_AHBENR_CRYPEN;
+
+    // Mode 1 ( encryption ), ECB chaining, no data swapping
+    AES->CR = 0;
+    AES->KEYR3 = AES_MCU_WORD( key );
+    AES->KEYR2 = AES_MCU_WORD( key + 4 );
+    AES->KEYR1 = AES_MCU_WORD( key + 8 );
+    AES->KEYR0 = AES_MCU_WORD( key + 12 );
+    AES->CR |= AES_CR_EN;
+
+    while( nbBlocks-- > 0 )
+    {
+        AES->DINR = AES_MCU_WORD( in );
+        AES->DINR = AES_MCU_WORD( in + 4 );
+        AES->DINR = AES_MCU_WORD( in + 8 );
+        AES->DINR = AES_MCU_WORD( in + 12 );
+
+        timeout = AES_MCU_CCF_TIMEOUT;
+        while( ( ( AES->SR & AES_SR_CCF ) == 0 ) && ( --timeout > 0 ) )
+        {
+        }
+        if( ( timeout == 0 ) || ( ( AES->SR & ( AES_SR_RDERR | AES_SR_WRERR ) ) != 0 ) )
+        {
+            status = FAIL;
+            break;
+        }
+
+        AesMcuStoreWord( out, AES->DOUTR );
+        AesMcuStoreWord( out + 4, AES->DOUTR );
+        AesMcuStoreWord( out + 8, AES->DOUTR );
+        AesMcuStoreWord( out + 12, AES->DOUTR );
+        AES->CR |= AES_CR_CCFC;
+
+        in += 16;
+        out += 16;
+    }
+
+    // Disabling the peripheral also clears the error flags
+    AES->CR = 0;
+    RCC->AHBENR &= ~RCC_AHBENR_CRYPEN;
+    return status;
+}
@@ -0,0 +1,86 @@
+/*!
+ * \file      crc-board.c
+ *
+ * \brief     Target board CRC hardware unit driver implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include "stm32l0xx.h"
+#include "crc-board.h"
+
+/*!
+ * CRC-CCITT polynomial
+ */
+#define CRC_MCU_CCITT_POLYNOM                       0x1021
+
+/*!
+ * CRC32 ( IEEE 802.3 ) polynomial, not reflected
+ */
+#define CRC_MCU_CRC32_POLYNOM                       0x04C11DB7
+
+/*!
+ * Packs 4 bytes into a word, first byte being the most significant one as
+ * the CRC unit processes the data register words most significant byte first
+ */
+#define CRC_MCU_WORD( p )                          ( ( ( uint32_t )( p )[0] << 24 ) | ( ( uint32_t )( p )[1] << 16 ) | \
+                                                     ( ( uint32_t )( p )[2] << 8 ) | ( uint32_t )( p )[3] )
+
+static void CrcMcuFeed( const uint8_t *buffer, uint32_t size )
+{
+    while( size >= 4 )
+    {
+        CRC->DR = CRC_MCU_WORD( buffer );
+        buffer += 4;
+        size -= 4;
+    }
+    while( size-- > 0 )
+    {
+        *( __IO uint8_t* )&CRC->DR = *buffer++;
+    }
+}
+
+uint16_t CrcMcuCcittUpdate( uint16_t crc, const uint8_t *buffer, uint32_t size )
+{
+    __HAL_RCC_CRC_CLK_ENABLE( );
+
+    // 16 bits polynomial, no bit reversal
+    CRC->CR = CRC_CR_POLYSIZE_0;
+    CRC->POL = CRC_MCU_CCITT_POLYNOM;
+    CRC->INIT = crc;
+    CRC->CR |= CRC_CR_RESET;
+
+    CrcMcuFeed( buffer, size );
+    crc = ( uint16_t )CRC->DR;
+
+    __HAL_RCC_CRC_CLK_DISABLE( );
+    return crc;
+}
+
+uint32_t CrcMcu32Update( uint32_t crc, const uint8_t *buffer, uint32_t size )
+{
+    __HAL_RCC_CRC_CLK_ENABLE( );
+
+    // 32 bits polynomial, input bytes and output word bit reversed. The
+    // computation register holds the bit reversed value of the CRC.
+    CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_OUT;
+    CRC->POL = CRC_MCU_CRC32_POLYNOM;
+    CRC->INIT = __RBIT( crc );
+    CRC->CR |= CRC_CR_RESET;
+
+    CrcMcuFeed( buffer, size );
+    crc = CRC->DR;
+
+    __HAL_RCC_CRC_CLK_DISABLE( );
+    return crc;
+}
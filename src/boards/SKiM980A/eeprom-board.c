@@ -24,9 +24,50 @@
 #include "utilities.h"
 #include "eeprom-board.h"
 
+/*!
+ * Data EEPROM word and byte programming operations. Without fixed time
+ * programming the erase phase is skipped when the target is already erased.
+ */
+#define EEPROM_PROGRAM_WORD                         FLASH_TYPEPROGRAMDATA_FASTWORD
+#define EEPROM_PROGRAM_BYTE                         FLASH_TYPEPROGRAMDATA_FASTBYTE
+
+/*!
+ * \brief Programs a byte unless the EEPROM already holds it
+ *
+ * \param [IN] address Data EEPROM address
+ * \param [IN] data    Byte to be programmed
+ * \retval status      HAL status
+ */
+static HAL_StatusTypeDef EepromMcuProgramByte( uint32_t address, uint8_t data )
+{
+    if( *( volatile uint8_t* )address == data )
+    {
+        return HAL_OK;
+    }
+    return HAL_FLASHEx_DATAEEPROM_Program( EEPROM_PROGRAM_BYTE, address, data );
+}
+
+/*!
+ * \brief Programs an aligned word unless the EEPROM already holds it
+ *
+ * \param [IN] address Word aligned data EEPROM address
+ * \param [IN] data    Word to be programmed
+ * \retval status      HAL status
+ */
+static HAL_StatusTypeDef EepromMcuProgramWord( uint32_t address, uint32_t data )
+{
+    if( *( volatile uint32_t* )address == data )
+    {
+        return HAL_OK;
+    }
+    return HAL_FLASHEx_DATAEEPROM_Program( EEPROM_PROGRAM_WORD, address, data );
+}
+
 uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 {
     uint8_t status = FAIL;
+    uint32_t address = FLASH_EEPROM_BASE + addr;
+    uint32_t end = address + size;
 
     assert_param( ( FLASH_EEPROM_BASE + addr ) >= FLASH_EEPROM_BASE );
     assert_param( buffer != NULL );
@@ -34,17 +75,33 @@ uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 
     if( HAL_FLASHEx_DATAEEPROM_Unlock( ) == HAL_OK )
     {
-        for( uint16_t i = 0; i < size; i++ )
+        HAL_StatusTypeDef halStatus = HAL_OK;
+
+        // Bytes up to the first word boundary
+        while( ( halStatus == HAL_OK ) && ( address < end ) && ( ( address & 0x03 ) != 0 ) )
         {
-            if( HAL_FLASHEx_DATAEEPROM_Program( FLASH_TYPEPROGRAMDATA_BYTE,
-                                                ( FLASH_EEPROM_BASE + addr + i ),
-                                                  buffer[i] ) != HAL_OK )
-            {
-                // Failed to write EEPROM
-                break;
-            }
+            halStatus = EepromMcuProgramByte( address++, *buffer++ );
+        }
+        // Whole words, one program cycle for 4 bytes
+        while( ( halStatus == HAL_OK ) && ( ( end - address ) >= 4 ) )
+        {
+            uint32_t data = ( uint32_t )buffer[0] | ( ( uint32_t )buffer[1] << 8 ) |
+                            ( ( uint32_t )buffer[2] << 16 ) | ( ( uint32_t )buffer[3] << 24 );
+
+            halStatus = EepromMcuProgramWord( address, data );
+            address += 4;
+            buffer += 4;
+        }
+        // Remaining bytes
+        while( ( halStatus == HAL_OK ) && ( address < end ) )
+        {
+            halStatus = EepromMcuProgramByte( address++, *buffer++ );
+        }
+
+        if( halStatus == HAL_OK )
+        {
+            status = SUCCESS;
         }
-        status = SUCCESS;
     }
 
     HAL_FLASHEx_DATAEEPROM_Lock( );
@@ -61,6 +118,16 @@ uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
     return SUCCESS;
 }
 
+void EepromMcuSetEraseAllowed( bool allowed )
+{
+    // The data EEPROM is programmed without erase operations
+}
+
+bool EepromMcuIsWritePending( void )
+{
+    return false;
+}
+
 void EepromMcuSetDeviceAddr( uint8_t addr )
 {
     assert_param( FAIL );
@@ -40,6 +40,7 @@ static uint8_t SX1272GetPaSelect( uint32_t channel );
  */
 static bool RadioIsActive = false;
 
+#if !defined( USE_RADIO_STATIC_BINDING )
 /*!
  * Radio driver structure initialization
  */
@@ -55,6 +56,7 @@ const struct Radio_s Radio =
     SX1272SetTxConfig,
     SX1272CheckRfFrequency,
     SX1272GetTimeOnAir,
+    SX1272PrepareTx,
     SX1272Send,
     SX1272SetSleep,
     SX1272SetStby,
@@ -72,7 +74,12 @@ const struct Radio_s Radio =
     NULL, // void ( *IrqProcess )( void )
     NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
     NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    SX1272GetFreqError,
+    SX1272StartCarrierSense,
+    NULL, // uint32_t ( *CalibrateWakeupTime )( void ) - SX126x Only
+    NULL, // void ( *SetWakeupTime )( uint32_t time ) - SX126x Only
 };
+#endif
 
 /*!
  * Antenna switch GPIO pins objects
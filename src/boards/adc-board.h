@@ -51,6 +51,18 @@ void AdcMcuConfig( void );
  */
 uint16_t AdcMcuReadChannel( Adc_t *obj, uint32_t channel );
 
+/*!
+ * \brief Reads the given channels within a single conversion sequence
+ *
+ * \param [IN]  obj          ADC object
+ * \param [IN]  channels     ADC input channels
+ * \param [OUT] values       Channels values, given in the channels order
+ * \param [IN]  nbChannels   Number of channels [1..ADC_MAX_SCAN_CHANNELS]
+ * \param [IN]  oversampling Enables the hardware oversampling when supported
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t AdcMcuReadChannels( Adc_t *obj, const uint32_t *channels, uint16_t *values, uint8_t nbChannels, bool oversampling );
+
 #ifdef __cplusplus
 }
 #endif
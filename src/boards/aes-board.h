@@ -0,0 +1,47 @@
+/*!
+ * \file      aes-board.h
+ *
+ * \brief     Target board AES hardware accelerator driver implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __AES_BOARD_H__
+#define __AES_BOARD_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * Encrypts the given blocks in ECB mode with the MCU AES accelerator.
+ *
+ * \remark Only 128 bits keys are supported. in and out may be the same buffer.
+ *
+ * \param[IN]  key      128 bits AES key
+ * \param[IN]  in       Pointer to the blocks to be encrypted
+ * \param[OUT] out      Pointer to the buffer receiving the encrypted blocks
+ * \param[IN]  nbBlocks Number of 16 bytes blocks
+ * \retval status [SUCCESS, FAIL]. FAIL when the accelerator is not available,
+ *                the caller then falls back to the software implementation.
+ */
+uint8_t AesMcuEncrypt( const uint8_t key[16], const uint8_t *in, uint8_t *out, uint16_t nbBlocks );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __AES_BOARD_H__
@@ -39,6 +39,21 @@ enum BoardPowerSources
     BATTERY_POWER,
 };
 
+/*!
+ * MCU performance levels
+ */
+typedef enum eBoardPerformanceLevel
+{
+    /*!
+     * Lowest run mode current, enough to wait for the radio and timer events
+     */
+    BOARD_PERFORMANCE_LEVEL_LOW = 0,
+    /*!
+     * Full speed system clock, for the compute bursts
+     */
+    BOARD_PERFORMANCE_LEVEL_HIGH,
+}BoardPerformanceLevel_t;
+
 /*!
  * \brief Initializes the mcu.
  */
@@ -104,6 +119,31 @@ void BoardGetUniqueId( uint8_t *id );
  */
 void BoardLowPowerHandler( void );
 
+/*!
+ * \brief Makes sure the MCU runs on the system clock of its performance level
+ *
+ * \remark With USE_LPM_FAST_STOP_EXIT the MCU leaves the Stop mode on its
+ *         wake up clock and the interrupts are serviced right away. The full
+ *         speed clock is only restored by this function, called before the
+ *         processing which needs it. Does nothing otherwise.
+ */
+void BoardSystemClockRequest( void );
+
+/*!
+ * \brief Requests or releases the high performance level
+ *
+ * \remark The requests are counted, each BOARD_PERFORMANCE_LEVEL_HIGH request
+ *         is balanced by a BOARD_PERFORMANCE_LEVEL_LOW one. The MCU runs at
+ *         the low level when no request is left. The peripherals clocked by
+ *         the system clock are updated accordingly.
+ *
+ * \remark Only switches the clock with USE_BOARD_PERF_LEVEL, the MCU keeps
+ *         its full speed system clock otherwise.
+ *
+ * \param [IN] level Requested performance level
+ */
+void BoardSetPerformanceLevel( BoardPerformanceLevel_t level );
+
 /*!
  * \brief Get the board power source
  *
@@ -0,0 +1,55 @@
+/*!
+ * \file      crc-board.h
+ *
+ * \brief     Target board CRC hardware unit driver implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __CRC_BOARD_H__
+#define __CRC_BOARD_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * \brief Updates a CRC-CCITT ( polynomial 0x1021, no bit reversal ) with the
+ *        MCU CRC unit
+ *
+ * \param [IN] crc    Current CRC value or initial value
+ * \param [IN] buffer Data buffer
+ * \param [IN] size   Data buffer size
+ * \retval crc        Updated CRC value
+ */
+uint16_t CrcMcuCcittUpdate( uint16_t crc, const uint8_t *buffer, uint32_t size );
+
+/*!
+ * \brief Updates a CRC32 ( IEEE 802.3, reflected ) with the MCU CRC unit.
+ *        No final complement is applied.
+ *
+ * \param [IN] crc    Current CRC value or initial value
+ * \param [IN] buffer Data buffer
+ * \param [IN] size   Data buffer size
+ * \retval crc        Updated CRC value
+ */
+uint32_t CrcMcu32Update( uint32_t crc, const uint8_t *buffer, uint32_t size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CRC_BOARD_H__
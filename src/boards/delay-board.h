@@ -31,6 +31,7 @@ extern "C"
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*!
  * \brief Blocking delay of "ms" milliseconds
@@ -39,6 +40,14 @@ extern "C"
  */
 void DelayMsMcu( uint32_t ms );
 
+/*!
+ * \brief Checks if the delay can be spent in the low power modes
+ *
+ * \retval allowed [true: not called from an interrupt handler nor with the
+ *                  interrupts masked, false: the delay must busy wait]
+ */
+bool DelayMcuIsSleepAllowed( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,7 @@ extern "C"
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*!
  * Writes the given buffer to the EEPROM at the specified address.
@@ -50,6 +51,23 @@ uint8_t EepromMcuWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size );
  */
 uint8_t EepromMcuReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size );
 
+/*!
+ * Allows or vetoes the start of the erase operations required by the driver.
+ *
+ * \remark Useful for flash based EEPROM emulations, the erase operations
+ *         being postponed while vetoed.
+ *
+ * \param[IN] allowed true if the erase operations are allowed
+ */
+void EepromMcuSetEraseAllowed( bool allowed );
+
+/*!
+ * Indicates if some write operations are still pending.
+ *
+ * \retval isPending true if the written data is not yet programmed
+ */
+bool EepromMcuIsWritePending( void );
+
 /*!
  * Sets the device address.
  *
@@ -69,6 +69,13 @@ typedef enum
     I2C_ADDR_SIZE_16,
 }I2cAddrSize;
 
+/*!
+ * \brief Interrupt driven transaction completion callback
+ *
+ * \param [IN] status           [SUCCESS, FAIL]
+ */
+typedef void ( *I2cMcuXferDone_t )( uint8_t status );
+
 /*!
  * \brief Initializes the I2C object and MCU peripheral
  *
@@ -126,6 +133,32 @@ uint8_t I2cMcuWriteBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_
  */
 uint8_t I2cMcuReadBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size );
 
+/*!
+ * \brief Starts an interrupt driven data buffer write to the I2C device
+ *
+ * \param [IN] obj              I2C object
+ * \param [IN] deviceAddr       device address
+ * \param [IN] addr             data address
+ * \param [IN] buffer           data buffer to write
+ * \param [IN] size             number of data bytes to write
+ * \param [IN] onDone           completion callback, called in interrupt context
+ * \retval status               [SUCCESS: started, FAIL: bus busy or error]
+ */
+uint8_t I2cMcuWriteBufferIt( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size, I2cMcuXferDone_t onDone );
+
+/*!
+ * \brief Starts an interrupt driven data buffer read from the I2C device
+ *
+ * \param [IN] obj              I2C object
+ * \param [IN] deviceAddr       device address
+ * \param [IN] addr             data address
+ * \param [IN] buffer           data buffer to read
+ * \param [IN] size             number of data bytes to read
+ * \param [IN] onDone           completion callback, called in interrupt context
+ * \retval status               [SUCCESS: started, FAIL: bus busy or error]
+ */
+uint8_t I2cMcuReadBufferIt( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size, I2cMcuXferDone_t onDone );
+
 /*!
  * \brief Waits until the given device is in standby mode
  *
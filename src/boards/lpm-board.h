@@ -33,6 +33,22 @@ extern "C"
 
 #include "board-config.h"
 
+/*!
+ * Minimum time to be spent in Stop mode for it to save more energy than Sleep
+ * mode, on top of the MCU wake up and clock restore latencies. Value in [ms]
+ */
+#ifndef LPM_STOP_MODE_MIN_RESIDENCY
+#define LPM_STOP_MODE_MIN_RESIDENCY                 2
+#endif
+
+/*!
+ * Minimum time to be spent in Off mode for it to save more energy than Stop
+ * mode, on top of the MCU wake up and clock restore latencies. Value in [ms]
+ */
+#ifndef LPM_OFF_MODE_MIN_RESIDENCY
+#define LPM_OFF_MODE_MIN_RESIDENCY                  1000
+#endif
+
 /*!
  * Low power manager configuration
  */
@@ -97,10 +113,30 @@ void LpmSetOffMode(LpmId_t id, LpmSetMode_t mode );
  * \brief  This API shall be used by the application when there is no more code to execute so that the system may
  *         enter low-power mode. The mode selected depends on the information received from LpmOffModeSelection( ) and
  *         LpmSysclockRequest( )
+ *         The selected mode is then downgraded to a lighter one when the next timer event is too close for the
+ *         deeper mode wake up latency to pay off ( see \ref LpmGetModeForNextEvent )
  *         This function shall be called in critical section
  */
 void LpmEnterLowPower( void );
 
+/*!
+ * \brief  This API returns the Low Power Mode that would be applied given the time remaining before the next timer
+ *         event, the deepest mode allowed by the users and the measured wake up latency of each mode.
+ *
+ * \param [IN] mode  Deepest mode allowed by the users ( see \ref LpmGetMode )
+ * \param [IN] ticks Number of RTC ticks before the next timer event
+ *
+ * \retval mode Low power mode to be entered
+ */
+LpmGetMode_t LpmGetModeForNextEvent( LpmGetMode_t mode, uint32_t ticks );
+
+/*!
+ * \brief  This API returns the measured time needed to restore the MCU after a Stop mode wake up
+ *
+ * \retval ticks Maximum measured Stop mode exit duration in RTC ticks
+ */
+uint32_t LpmGetStopModeExitTime( void );
+
 /*!
  * \brief  This API is called by the low power manager in a critical section (PRIMASK bit set) to allow the
  *         application to implement dedicated code before entering Sleep Mode
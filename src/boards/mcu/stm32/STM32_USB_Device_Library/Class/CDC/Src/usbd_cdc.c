@@ -664,9 +664,19 @@ static uint8_t  USBD_CDC_Setup (USBD_HandleTypeDef *pdev,
 static uint8_t  USBD_CDC_DataIn (USBD_HandleTypeDef *pdev, uint8_t epnum)
 {
   USBD_CDC_HandleTypeDef   *hcdc = (USBD_CDC_HandleTypeDef*) pdev->pClassData;
+  uint32_t maxPacket = (pdev->dev_speed == USBD_SPEED_HIGH) ? CDC_DATA_HS_IN_PACKET_SIZE : CDC_DATA_FS_IN_PACKET_SIZE;
   
   if(pdev->pClassData != NULL)
   {
+    /* A bulk transfer made of full packets is terminated by a zero length
+       packet, otherwise the host keeps waiting for more data */
+    if((pdev->ep_in[epnum & 0xF].total_length > 0) &&
+       ((pdev->ep_in[epnum & 0xF].total_length % maxPacket) == 0))
+    {
+      pdev->ep_in[epnum & 0xF].total_length = 0;
+      USBD_LL_Transmit(pdev, epnum, NULL, 0);
+      return USBD_OK;
+    }
     
     hcdc->TxState = 0;
 
@@ -854,6 +864,9 @@ uint8_t  USBD_CDC_TransmitPacket(USBD_HandleTypeDef *pdev)
       /* Tx Transfer in progress */
       hcdc->TxState = 1;
       
+      /* The whole buffer is sent as one multi packet bulk transfer */
+      pdev->ep_in[CDC_IN_EP & 0xF].total_length = hcdc->TxLength;
+      
       /* Transmit next packet */
       USBD_LL_Transmit(pdev,
                        CDC_IN_EP,
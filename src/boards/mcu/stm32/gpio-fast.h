@@ -0,0 +1,77 @@
+/*!
+ * \file      gpio-fast.h
+ *
+ * \brief     STM32 GPIO direct register accessors
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ */
+#ifndef __GPIO_FAST_H__
+#define __GPIO_FAST_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include "gpio.h"
+
+/*!
+ * The accessors below drive the port registers directly instead of going
+ * through GpioWrite/GpioRead, the MCU GPIO driver and the HAL. They are meant
+ * for the lines toggled on every radio SPI access which board-config.h
+ * declares fast, e.g. RADIO_NSS_FAST.
+ *
+ * \remark The GPIO object must have been initialized by GpioInit with a
+ *         connected MCU pin. No check is done.
+ *
+ * \remark As for the other board files, the MCU device header ( e.g.
+ *         stm32l0xx.h ) must be included first.
+ */
+
+/*!
+ * \brief Writes the given value to the GPIO output through the port bit
+ *        set/reset register
+ *
+ * \param [IN] obj   Pointer to the GPIO object
+ * \param [IN] value New GPIO output value
+ */
+static inline void GpioFastWrite( Gpio_t *obj, uint32_t value )
+{
+    if( value != 0 )
+    {
+        ( ( GPIO_TypeDef* )obj->port )->BSRR = obj->pinIndex;
+    }
+    else
+    {
+        ( ( GPIO_TypeDef* )obj->port )->BSRR = ( uint32_t )obj->pinIndex << 16;
+    }
+}
+
+/*!
+ * \brief Reads the current GPIO input value from the port input data register
+ *
+ * \param [IN] obj Pointer to the GPIO object
+ * \retval value   Current GPIO input value
+ */
+static inline uint32_t GpioFastRead( Gpio_t *obj )
+{
+    return ( ( ( GPIO_TypeDef* )obj->port )->IDR & obj->pinIndex ) != 0 ? 1 : 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __GPIO_FAST_H__
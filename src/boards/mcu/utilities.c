@@ -24,6 +24,84 @@
 #include <stdio.h>
 #include "utilities.h"
 
+/*!
+ * \brief Computes the next value of a splitmix32 sequence, spreads a seed
+ *        over the generator state
+ */
+static uint32_t SplitMix32( uint32_t* x )
+{
+    uint32_t z = ( *x += 0x9E3779B9 );
+
+    z = ( z ^ ( z >> 16 ) ) * 0x85EBCA6B;
+    z = ( z ^ ( z >> 13 ) ) * 0xC2B2AE35;
+    return z ^ ( z >> 16 );
+}
+
+static uint32_t Rotl( uint32_t x, uint8_t k )
+{
+    return ( x << k ) | ( x >> ( 32 - k ) );
+}
+
+void RandStateSeed( RandState_t* state, uint32_t seed )
+{
+    memset1( ( uint8_t* )state, 0, sizeof( RandState_t ) );
+    RandStateMix( state, seed );
+}
+
+void RandStateMix( RandState_t* state, uint32_t entropy )
+{
+    for( uint8_t i = 0; i < 4; i++ )
+    {
+        state->S[i] ^= SplitMix32( &entropy );
+    }
+    // The all zero state is the only one the generator cannot leave
+    if( ( state->S[0] | state->S[1] | state->S[2] | state->S[3] ) == 0 )
+    {
+        state->S[0] = 1;
+    }
+}
+
+uint32_t RandStateNext( RandState_t* state )
+{
+    uint32_t* s = state->S;
+    uint32_t result = Rotl( s[1] * 5, 7 ) * 9;
+    uint32_t t = s[1] << 9;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = Rotl( s[3], 11 );
+
+    return result;
+}
+
+uint32_t RandStateRange( RandState_t* state, uint32_t range )
+{
+    uint32_t mask = range - 1;
+    uint32_t value;
+
+    if( range == 0 )
+    {
+        return RandStateNext( state );
+    }
+
+    // Smallest all ones mask covering range - 1, the values above are drawn
+    // again. Less than 2 draws are needed on average.
+    mask |= mask >> 1;
+    mask |= mask >> 2;
+    mask |= mask >> 4;
+    mask |= mask >> 8;
+    mask |= mask >> 16;
+    do
+    {
+        value = RandStateNext( state ) & mask;
+    } while( value >= range );
+
+    return value;
+}
+
 /*!
  * Redefinition of rand() and srand() standard C functions.
  * These functions are redefined in order to get the same behavior across
@@ -32,43 +110,160 @@
 // Standard random functions redefinition start
 #define RAND_LOCAL_MAX 2147483647L
 
-static uint32_t next = 1;
+static RandState_t RandState = { .S = { 1 } };
 
 int32_t rand1( void )
 {
-    return ( ( next = next * 1103515245L + 12345L ) % RAND_LOCAL_MAX );
+    return ( int32_t )( RandStateNext( &RandState ) & RAND_LOCAL_MAX );
 }
 
 void srand1( uint32_t seed )
 {
-    next = seed;
+    RandStateSeed( &RandState, seed );
 }
 // Standard random functions redefinition end
 
 int32_t randr( int32_t min, int32_t max )
 {
-    return ( int32_t )rand1( ) % ( max - min + 1 ) + min;
+    return ( int32_t )( ( uint32_t )min + RandStateRange( &RandState, ( uint32_t )max - ( uint32_t )min + 1 ) );
 }
 
-void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size )
+/*!
+ * Word accesses of the byte arrays
+ */
+#if defined( __GNUC__ )
+typedef uint32_t __attribute__( ( __may_alias__ ) ) Word_t;
+#else
+typedef uint32_t Word_t;
+#endif
+
+/*!
+ * \brief Checks if an address is word aligned
+ */
+#define IS_WORD_ALIGNED( ptr )                      ( ( ( uintptr_t )( ptr ) & ( sizeof( Word_t ) - 1 ) ) == 0 )
+
+/*!
+ * \brief Reverses the byte order of a word
+ */
+#define WORD_REVERSE( x )                           ( ( ( x ) >> 24 ) | ( ( ( x ) >> 8 ) & 0x0000FF00 ) | \
+                                                      ( ( ( x ) << 8 ) & 0x00FF0000 ) | ( ( x ) << 24 ) )
+
+RAM_FUNC void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size )
 {
+    // The word copies need both arrays at the same alignment, the M0+ cores
+    // don't support unaligned accesses
+    if( ( size >= 8 ) && ( ( ( ( uintptr_t )dst ^ ( uintptr_t )src ) & ( sizeof( Word_t ) - 1 ) ) == 0 ) )
+    {
+        while( IS_WORD_ALIGNED( dst ) == false )
+        {
+            *dst++ = *src++;
+            size--;
+        }
+
+        Word_t *dstWord = ( Word_t* )dst;
+        const Word_t *srcWord = ( const Word_t* )src;
+
+        // Words are copied in ascending order, as the bytes
+        for( ; size >= 16; size -= 16 )
+        {
+            dstWord[0] = srcWord[0];
+            dstWord[1] = srcWord[1];
+            dstWord[2] = srcWord[2];
+            dstWord[3] = srcWord[3];
+            dstWord += 4;
+            srcWord += 4;
+        }
+        for( ; size >= 4; size -= 4 )
+        {
+            *dstWord++ = *srcWord++;
+        }
+        dst = ( uint8_t* )dstWord;
+        src = ( const uint8_t* )srcWord;
+    }
+
     while( size-- )
     {
         *dst++ = *src++;
     }
 }
 
+void memcpy16( uint8_t *dst, const uint8_t *src )
+{
+    if( IS_WORD_ALIGNED( dst ) && IS_WORD_ALIGNED( src ) )
+    {
+        ( ( Word_t* )dst )[0] = ( ( const Word_t* )src )[0];
+        ( ( Word_t* )dst )[1] = ( ( const Word_t* )src )[1];
+        ( ( Word_t* )dst )[2] = ( ( const Word_t* )src )[2];
+        ( ( Word_t* )dst )[3] = ( ( const Word_t* )src )[3];
+        return;
+    }
+    for( uint8_t i = 0; i < 16; i += 4 )
+    {
+        dst[i] = src[i];
+        dst[i + 1] = src[i + 1];
+        dst[i + 2] = src[i + 2];
+        dst[i + 3] = src[i + 3];
+    }
+}
+
 void memcpyr( uint8_t *dst, const uint8_t *src, uint16_t size )
 {
     dst = dst + ( size - 1 );
+
+    // The source is read by ascending words, the destination written by
+    // descending words, both must be aligned at the same time
+    if( ( size >= 8 ) && ( ( ( ( uintptr_t )( dst + 1 ) + ( uintptr_t )src ) & ( sizeof( Word_t ) - 1 ) ) == 0 ) )
+    {
+        while( IS_WORD_ALIGNED( src ) == false )
+        {
+            *dst-- = *src++;
+            size--;
+        }
+        for( ; size >= 4; size -= 4 )
+        {
+            Word_t word = *( const Word_t* )src;
+
+            dst -= 3;
+            *( Word_t* )dst = WORD_REVERSE( word );
+            dst--;
+            src += 4;
+        }
+    }
+
     while( size-- )
     {
         *dst-- = *src++;
     }
 }
 
-void memset1( uint8_t *dst, uint8_t value, uint16_t size )
+RAM_FUNC void memset1( uint8_t *dst, uint8_t value, uint16_t size )
 {
+    if( size >= 8 )
+    {
+        while( IS_WORD_ALIGNED( dst ) == false )
+        {
+            *dst++ = value;
+            size--;
+        }
+
+        Word_t *dstWord = ( Word_t* )dst;
+        Word_t word = value * 0x01010101UL;
+
+        for( ; size >= 16; size -= 16 )
+        {
+            dstWord[0] = word;
+            dstWord[1] = word;
+            dstWord[2] = word;
+            dstWord[3] = word;
+            dstWord += 4;
+        }
+        for( ; size >= 4; size -= 4 )
+        {
+            *dstWord++ = word;
+        }
+        dst = ( uint8_t* )dstWord;
+    }
+
     while( size-- )
     {
         *dst++ = value;
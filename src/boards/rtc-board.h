@@ -194,6 +194,19 @@ void RtcProcess( void );
  */
 TimerTime_t RtcTempCompensation( TimerTime_t period, float temperature );
 
+/*!
+ * \brief Sets the RTC frequency correction
+ *
+ * \remark The correction replaces the previous one and is rounded to the
+ *         resolution of the hardware, about 1 ppm. It is saturated to the
+ *         supported range.
+ *
+ * \param [IN] ppb Frequency correction in parts per billion. A positive value
+ *                 speeds the RTC up.
+ * \retval ppb     Correction actually applied
+ */
+int32_t RtcSetCalibration( int32_t ppb );
+
 #ifdef __cplusplus
 }
 #endif
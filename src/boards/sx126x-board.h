@@ -173,6 +173,23 @@ void SX126xDbgPinRxWrite( uint8_t state );
  */
 extern SX126x_t SX126x;
 
+#if defined( SX126X_SECOND_INSTANCE )
+/*!
+ * Second radio hardware and global parameters
+ */
+extern SX126x_t SX126x1;
+
+/*!
+ * \brief Initializes the second radio I/Os pins interface
+ */
+void SX126xIoInit1( void );
+
+/*!
+ * \brief De-initializes the second radio I/Os pins interface.
+ */
+void SX126xIoDeInit1( void );
+#endif
+
 #ifdef __cplusplus
 }
 #endif
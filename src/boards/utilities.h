@@ -29,6 +29,7 @@ extern "C"
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*!
  * Generic definition
@@ -86,6 +87,48 @@ typedef union Version_u
     uint32_t Value;
 }Version_t;
 
+/*!
+ * Pseudo random generator state ( xoshiro128** )
+ */
+typedef struct sRandState
+{
+    uint32_t S[4];
+}RandState_t;
+
+/*!
+ * \brief Initializes a pseudo random generator state
+ *
+ * \param [OUT] state Pseudo random generator state
+ * \param [IN]  seed  Pseudo random generator initial value
+ */
+void RandStateSeed( RandState_t* state, uint32_t seed );
+
+/*!
+ * \brief Mixes entropy into a pseudo random generator state, the previous
+ *        state is kept
+ *
+ * \param [IN] state   Pseudo random generator state
+ * \param [IN] entropy Random bits
+ */
+void RandStateMix( RandState_t* state, uint32_t entropy );
+
+/*!
+ * \brief Computes the next 32 random bits of a pseudo random generator state
+ *
+ * \param [IN] state Pseudo random generator state
+ * \retval random Random value
+ */
+uint32_t RandStateNext( RandState_t* state );
+
+/*!
+ * \brief Computes an unbiased random number below range, without division
+ *
+ * \param [IN] state Pseudo random generator state
+ * \param [IN] range Number of possible values, 0 for all the 32 bit values
+ * \retval random Random value in range 0..range - 1
+ */
+uint32_t RandStateRange( RandState_t* state, uint32_t range );
+
 /*!
  * \brief Initializes the pseudo random generator initial value
  *
@@ -113,6 +156,15 @@ int32_t randr( int32_t min, int32_t max );
  */
 void memcpy1( uint8_t *dst, const uint8_t *src, uint16_t size );
 
+/*!
+ * \brief Copies a 16 bytes block, e.g. an AES block or key, of src array to
+ *        dst array
+ *
+ * \param [OUT] dst  Destination array
+ * \param [IN]  src  Source array
+ */
+void memcpy16( uint8_t *dst, const uint8_t *src );
+
 /*!
  * \brief Copies size elements of src array to dst array reversing the byte order
  *
@@ -151,6 +203,21 @@ int8_t Nibble2HexChar( uint8_t a );
  */
 #define CRITICAL_SECTION_END( ) BoardCriticalSectionEnd( &mask )
 
+/*!
+ * Places a function in the .ramfunc section. The linker scripts copy it to
+ * SRAM with the initialized data at start up, where it runs without the flash
+ * wait states. The flash to SRAM calls go through linker veneers.
+ *
+ * \remark Only enabled by RAM_FUNCTIONS_ENABLED on the ARM targets
+ */
+#ifndef RAM_FUNC
+#if defined( RAM_FUNCTIONS_ENABLED ) && defined( __GNUC__ ) && defined( __arm__ )
+#define RAM_FUNC                                    __attribute__( ( section( ".ramfunc" ) ) )
+#else
+#define RAM_FUNC
+#endif
+#endif
+
 /*
  * ============================================================================
  * Following functions must be implemented inside the specific platform 
@@ -171,6 +238,162 @@ void BoardCriticalSectionBegin( uint32_t *mask );
  */
 void BoardCriticalSectionEnd( uint32_t *mask );
 
+/*
+ * ============================================================================
+ * Atomic operations on 32 bits words shared between the main loop and the
+ * IRQ handlers.
+ *
+ * The Cortex-M3/M4 cores ( and the host ) use the compiler builtins which
+ * compile to LDREX/STREX loops and never mask the interrupts. The Cortex-M0+
+ * cores have no exclusive accesses, the operations mask the interrupts for a
+ * couple of instructions only instead of a full critical section.
+ * ============================================================================
+ */
+/*!
+ * Set to 1 when the operations never mask the interrupts
+ */
+#ifndef ATOMIC_LOCK_FREE
+#if defined( __GNUC__ ) && !defined( __ARM_ARCH_6M__ )
+#define ATOMIC_LOCK_FREE                            1
+#else
+#define ATOMIC_LOCK_FREE                            0
+#endif
+#endif
+
+/*!
+ * Prevents the compiler from moving the memory accesses across it
+ */
+#if defined( __GNUC__ )
+#define ATOMIC_COMPILER_BARRIER( )                  __asm volatile( "" ::: "memory" )
+#else
+#define ATOMIC_COMPILER_BARRIER( )
+#endif
+
+#if ( ATOMIC_LOCK_FREE == 0 )
+#if defined( __GNUC__ ) && defined( __ARM_ARCH_6M__ )
+#define ATOMIC_SECTION_BEGIN( )                     uint32_t primask; \
+                                                    __asm volatile( "mrs %0, primask\n cpsid i" : "=r" ( primask ) :: "memory" )
+#define ATOMIC_SECTION_END( )                       __asm volatile( "msr primask, %0" :: "r" ( primask ) : "memory" )
+#else
+#define ATOMIC_SECTION_BEGIN( )                     CRITICAL_SECTION_BEGIN( )
+#define ATOMIC_SECTION_END( )                       CRITICAL_SECTION_END( )
+#endif
+#endif
+
+/*!
+ * \brief Atomically sets bits of a word
+ *
+ * \param [IN] ptr   Pointer to the word
+ * \param [IN] value Bits to be set
+ * \retval value     Value of the word before the operation
+ */
+static inline uint32_t AtomicFetchOr( volatile uint32_t *ptr, uint32_t value )
+{
+#if ( ATOMIC_LOCK_FREE == 1 )
+    return __atomic_fetch_or( ptr, value, __ATOMIC_SEQ_CST );
+#else
+    uint32_t old;
+
+    ATOMIC_SECTION_BEGIN( );
+    old = *ptr;
+    *ptr = old | value;
+    ATOMIC_SECTION_END( );
+    return old;
+#endif
+}
+
+/*!
+ * \brief Atomically clears the bits of a word which are not set in value
+ *
+ * \param [IN] ptr   Pointer to the word
+ * \param [IN] value Bits to be kept
+ * \retval value     Value of the word before the operation
+ */
+static inline uint32_t AtomicFetchAnd( volatile uint32_t *ptr, uint32_t value )
+{
+#if ( ATOMIC_LOCK_FREE == 1 )
+    return __atomic_fetch_and( ptr, value, __ATOMIC_SEQ_CST );
+#else
+    uint32_t old;
+
+    ATOMIC_SECTION_BEGIN( );
+    old = *ptr;
+    *ptr = old & value;
+    ATOMIC_SECTION_END( );
+    return old;
+#endif
+}
+
+/*!
+ * \brief Atomically adds a value to a word
+ *
+ * \param [IN] ptr   Pointer to the word
+ * \param [IN] value Value to be added
+ * \retval value     Value of the word before the operation
+ */
+static inline uint32_t AtomicFetchAdd( volatile uint32_t *ptr, uint32_t value )
+{
+#if ( ATOMIC_LOCK_FREE == 1 )
+    return __atomic_fetch_add( ptr, value, __ATOMIC_SEQ_CST );
+#else
+    uint32_t old;
+
+    ATOMIC_SECTION_BEGIN( );
+    old = *ptr;
+    *ptr = old + value;
+    ATOMIC_SECTION_END( );
+    return old;
+#endif
+}
+
+/*!
+ * \brief Atomically replaces a word
+ *
+ * \param [IN] ptr   Pointer to the word
+ * \param [IN] value New value of the word
+ * \retval value     Value of the word before the operation
+ */
+static inline uint32_t AtomicExchange( volatile uint32_t *ptr, uint32_t value )
+{
+#if ( ATOMIC_LOCK_FREE == 1 )
+    return __atomic_exchange_n( ptr, value, __ATOMIC_SEQ_CST );
+#else
+    uint32_t old;
+
+    ATOMIC_SECTION_BEGIN( );
+    old = *ptr;
+    *ptr = value;
+    ATOMIC_SECTION_END( );
+    return old;
+#endif
+}
+
+/*!
+ * \brief Atomically replaces a word when it still holds the expected value
+ *
+ * \param [IN] ptr      Pointer to the word
+ * \param [IN] expected Value the word must hold
+ * \param [IN] value    New value of the word
+ * \retval status       [true: replaced, false: the word changed meanwhile]
+ */
+static inline bool AtomicCompareExchange( volatile uint32_t *ptr, uint32_t expected, uint32_t value )
+{
+#if ( ATOMIC_LOCK_FREE == 1 )
+    return __atomic_compare_exchange_n( ptr, &expected, value, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST );
+#else
+    bool status = false;
+
+    ATOMIC_SECTION_BEGIN( );
+    if( *ptr == expected )
+    {
+        *ptr = value;
+        status = true;
+    }
+    ATOMIC_SECTION_END( );
+    return status;
+#endif
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -30,6 +30,8 @@
  *
  * \author    Johannes Bruder ( STACKFORCE )
  */
+#include <stddef.h>
+#include <string.h>
 #include "utilities.h"
 #include "region/Region.h"
 #include "LoRaMacClassB.h"
@@ -38,29 +40,82 @@
 #include "LoRaMacTest.h"
 #include "LoRaMacTypes.h"
 #include "LoRaMacConfirmQueue.h"
+#include "LoRaMacTxQueue.h"
 #include "LoRaMacHeaderTypes.h"
 #include "LoRaMacMessageTypes.h"
 #include "LoRaMacParser.h"
 #include "LoRaMacCommands.h"
 #include "LoRaMacAdr.h"
+#include "LoRaMacNvmCodec.h"
+#include "trace.h"
 
 #include "LoRaMac.h"
 
 /*!
- * Maximum PHY layer payload size
+ * Maximum PHY layer payload size. May be reduced to save RAM, the longer
+ * uplinks are then rejected and the radio drops the longer downlinks.
  */
+#ifndef LORAMAC_PHY_MAXPAYLOAD
 #define LORAMAC_PHY_MAXPAYLOAD                      255
+#endif
 
 /*!
- * Maximum MAC commands buffer size
+ * Offset of the frame payload in the transmit buffer when the FOpts field is empty
  */
+#define LORAMAC_FRAME_PAYLOAD_OFFSET                ( LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE + \
+                                                      LORAMAC_FHDR_F_CTRL_FIELD_SIZE + LORAMAC_FHDR_F_CNT_FIELD_SIZE + \
+                                                      LORAMAC_F_PORT_FIELD_SIZE )
+
+/*!
+ * Maximum frame payload size which fits the transmit buffer
+ */
+#define LORAMAC_FRAME_PAYLOAD_MAX_SIZE              ( LORAMAC_PHY_MAXPAYLOAD - LORAMAC_FRAME_PAYLOAD_OFFSET - LORAMAC_MIC_FIELD_SIZE )
+
+/*!
+ * Maximum MAC commands buffer size. The MAC commands are sent in the frame
+ * payload at most.
+ */
+#ifndef LORA_MAC_COMMAND_MAX_LENGTH
+#if ( LORAMAC_FRAME_PAYLOAD_MAX_SIZE < 128 )
+#define LORA_MAC_COMMAND_MAX_LENGTH                 LORAMAC_FRAME_PAYLOAD_MAX_SIZE
+#else
 #define LORA_MAC_COMMAND_MAX_LENGTH                 128
+#endif
+#endif
 
 /*!
  * Maximum length of the fOpts field
  */
 #define LORA_MAC_COMMAND_MAX_FOPTS_LENGTH           15
 
+/*!
+ * Number of consecutive uplinks which may leave the MAC command answers
+ * behind, see \ref MIB_MAC_COMMANDS_DEFER
+ */
+#ifndef LORAMAC_MAC_COMMANDS_MAX_DEFER
+#define LORAMAC_MAC_COMMANDS_MAX_DEFER              1
+#endif
+
+/*!
+ * Link margin in dB below which LORAMAC_RX_BOOSTED_AUTO boosts the reception
+ */
+#ifndef LORAMAC_RX_BOOSTED_MARGIN
+#define LORAMAC_RX_BOOSTED_MARGIN                   5
+#endif
+
+/*!
+ * Number of downlink SNRs LORAMAC_RX_BOOSTED_AUTO averages
+ */
+#ifndef LORAMAC_RX_BOOSTED_HISTORY_SIZE
+#define LORAMAC_RX_BOOSTED_HISTORY_SIZE             4
+#endif
+
+/*!
+ * Maximum continuous reception window radio duty cycle period in us.
+ * Radio periods are 24 bits wide in steps of 15.625 us
+ */
+#define RXC_DUTY_CYCLE_MAX_PERIOD                   262143999
+
 /*!
  * LoRaMac duty cycle for the back-off procedure during the first hour.
  */
@@ -76,6 +131,20 @@
  */
 #define BACKOFF_DC_24_HOURS                         10000
 
+/*!
+ * Timing error margin kept on top of the learned drift when the adaptive
+ * reception window error is enabled, in ms.
+ */
+#ifndef LORAMAC_ADAPTIVE_RX_ERROR_MARGIN
+#define LORAMAC_ADAPTIVE_RX_ERROR_MARGIN            3
+#endif
+
+/*!
+ * Minimum time between two network time synchronizations to estimate the
+ * clock drift from the second one, in ms.
+ */
+#define LORAMAC_ADAPTIVE_RX_ERROR_SYNC_PERIOD       600000
+
 /*!
  * LoRaMac internal states
  */
@@ -100,6 +169,53 @@ typedef enum eLoRaMacRequestHandling
     LORAMAC_REQUEST_HANDLING_ON = !LORAMAC_REQUEST_HANDLING_OFF
 }LoRaMacRequestHandling_t;
 
+/*!
+ * Continuous reception window preamble sniffing states
+ */
+typedef enum eLoRaMacRxCSniffState
+{
+    /*!
+     * No sniffing cycle running
+     */
+    RXC_SNIFF_STATE_IDLE,
+    /*!
+     * Channel activity detection running
+     */
+    RXC_SNIFF_STATE_CAD,
+    /*!
+     * Radio sleeping until the next channel activity detection
+     */
+    RXC_SNIFF_STATE_SLEEP,
+    /*!
+     * Preamble detected, reception running
+     */
+    RXC_SNIFF_STATE_RX,
+}LoRaMacRxCSniffState_t;
+
+/*!
+ * RxC window parameters computed for a given set of inputs
+ */
+typedef struct sLoRaMacRxCWindowCache
+{
+    /*!
+     * Set to true when the fields below hold a computation
+     */
+    bool IsValid;
+    /*!
+     * Inputs of the computation
+     */
+    int8_t RxCDatarate;
+    uint8_t MinRxSymbols;
+    uint32_t SystemMaxRxError;
+    /*!
+     * Results of the computation
+     */
+    int8_t Datarate;
+    uint8_t Bandwidth;
+    uint32_t WindowTimeout;
+    int32_t WindowOffset;
+}LoRaMacRxCWindowCache_t;
+
 typedef struct sLoRaMacNvmCtx
 {
     /*
@@ -197,8 +313,27 @@ typedef struct sLoRaMacNvmCtx
      * Last received Message integrity Code (MIC)
      */
     uint32_t LastRxMic;
+    /*!
+     * Measured radio wakeup time [ms], 0 when not calibrated
+     */
+    uint32_t RadioWakeupTime;
 }LoRaMacNvmCtx_t;
 
+/*!
+ * Multicast address index entry
+ */
+typedef struct sMcAddrIndex
+{
+    /*!
+     * Multicast group address
+     */
+    uint32_t Address;
+    /*!
+     * Multicast context of the group
+     */
+    MulticastCtx_t* McCtx;
+}McAddrIndex_t;
+
 typedef struct sLoRaMacCtx
 {
     /*
@@ -213,18 +348,10 @@ typedef struct sLoRaMacCtx
     * Current processed transmit message
     */
     LoRaMacMessage_t TxMsg;
-    /*!
-    * Buffer containing the data received by the application.
-    */
-    uint8_t AppData[LORAMAC_PHY_MAXPAYLOAD];
     /*
-    * Size of buffer containing the application data.
+    * Size of the application data. The data itself is placed in PktBuffer.
     */
     uint8_t AppDataSize;
-    /*
-    * Buffer containing the upper layer data.
-    */
-    uint8_t RxPayload[LORAMAC_PHY_MAXPAYLOAD];
     SysTime_t LastTxSysTime;
     /*
     * LoRaMac internal state
@@ -247,23 +374,52 @@ typedef struct sLoRaMacCtx
     */
     TimerEvent_t TxDelayedTimer;
     /*
+    * LoRaMac transmit queue duty cycle retry timer
+    */
+    TimerEvent_t TxQueueTimer;
+    /*
+    * Duty cycle wait time reported by the last channel selection
+    */
+    TimerTime_t DutyCycleWaitTime;
+    /*
     * LoRaMac reception windows timers
     */
     TimerEvent_t RxWindowTimer1;
     TimerEvent_t RxWindowTimer2;
     /*
-    * LoRaMac reception windows delay
-    * \remark normal frame: RxWindowXDelay = ReceiveDelayX - RADIO_WAKEUP_TIME
-    *         join frame  : RxWindowXDelay = JoinAcceptDelayX - RADIO_WAKEUP_TIME
+    * LoRaMac reception windows delay in microseconds
+    * \remark normal frame: RxWindowXDelayUs = ReceiveDelayX + WindowOffset
+    *         join frame  : RxWindowXDelayUs = JoinAcceptDelayX + WindowOffset
     */
-    uint32_t RxWindow1Delay;
-    uint32_t RxWindow2Delay;
+    uint32_t RxWindow1DelayUs;
+    uint32_t RxWindow2DelayUs;
     /*
     * LoRaMac Rx windows configuration
     */
     RxConfigParams_t RxWindow1Config;
     RxConfigParams_t RxWindow2Config;
     RxConfigParams_t RxWindowCConfig;
+    /*
+    * Continuous reception window preamble sniffing timer and state. Used when
+    * the radio has no hardware RX duty cycle support.
+    */
+    TimerEvent_t RxCSniffTimer;
+    LoRaMacRxCSniffState_t RxCSniffState;
+    /*
+    * Set by LoRaMacClassCPrepare when the radio holds the RxC window
+    * settings. Cleared by any other use of the radio.
+    */
+    bool RxCPrepared;
+    /*
+    * Last computed RxC window parameters, the class A and C switches
+    * reuse them as long as the RxC datarate and the timing errors are
+    * unchanged
+    */
+    LoRaMacRxCWindowCache_t RxCWindowCache;
+    /*
+    * Result of the last channel activity detection
+    */
+    bool ChannelActivityDetected;
     /*
      * Limit of uplinks without any donwlink response before the ADRACKReq bit will be set.
      */
@@ -335,48 +491,238 @@ typedef struct sLoRaMacCtx
     */
     LoRaMacRequestHandling_t AllowRequests;
     /*
+    * Number of received data frames dropped by CheckRxFrameAddress
+    */
+    uint32_t RxFilteredFrames;
+    /*
+    * Set to true while the NVM context change events are collected instead of raised
+    */
+    bool NvmCtxEventsDeferred;
+    /*
+    * Bit mask of the LoRaMacNvmCtxModule_t modules changed while the events are deferred
+    */
+    uint8_t NvmCtxPendingEvents;
+    /*
+    * Set to true to narrow the reception windows timing error to the observed one
+    */
+    bool AdaptiveRxError;
+    /*!
+     * Set to true when the uplink channels are drawn according to their
+     * delivery scores
+     */
+    bool ChannelsWeighting;
+    /*!
+     * Set to true when the repetitions of an unconfirmed uplink follow each
+     * other without Rx windows
+     */
+    bool NbTransSkipRx;
+    /*!
+     * Set to true when the MAC command answers may wait for the next uplink
+     * instead of holding back the application payload
+     */
+    bool MacCommandsDefer;
+    /*!
+     * Set to true when the frame being sent leaves the MAC command answers
+     * for a later uplink
+     */
+    bool MacCommandsDeferred;
+    /*!
+     * Number of consecutive uplinks which left the MAC command answers behind
+     */
+    uint8_t MacCommandsDeferCounter;
+    /*!
+     * Time of the last radio interrupt, reported by the driver
+     */
+    volatile TimerTime_t RadioIrqTime;
+    /*!
+     * Set to true when RadioIrqTime belongs to the radio event being handled
+     */
+    volatile bool RadioIrqTimeValid;
+    /*!
+     * Boosted reception selection of the Rx windows
+     */
+    LoRaMacRxBoosted_t RxBoosted;
+    /*!
+     * SNR of the last downlinks, see LORAMAC_RX_BOOSTED_AUTO
+     */
+    int8_t RxBoostedSnrs[LORAMAC_RX_BOOSTED_HISTORY_SIZE];
+    /*!
+     * Number of valid entries of RxBoostedSnrs
+     */
+    uint8_t NbRxBoostedSnrs;
+    /*!
+     * Entry of RxBoostedSnrs the next downlink replaces
+     */
+    uint8_t RxBoostedSnrsIndex;
+    /*!
+     * Set to true when an expected downlink was missed since the last received one
+     */
+    bool RxBoostedMiss;
+    /*
+    * Current reception windows timing error in ms. 0 until learning starts
+    */
+    uint32_t RxErrorEstimate;
+    /*
+    * Clock drift measured between the last two network time synchronizations in ppm
+    */
+    uint32_t RxErrorDriftPpm;
+    /*
+    * Time of the last network time synchronization
+    */
+    TimerTime_t LastTimeSyncTime;
+    /*
+    * Enabled multicast groups sorted by ascending address
+    */
+    McAddrIndex_t McAddrIndex[LORAMAC_MAX_MC_CTX];
+    /*
+    * Number of entries of McAddrIndex
+    */
+    uint8_t McAddrIndexSize;
+    /*
     * Non-volatile module context structure
     */
     LoRaMacNvmCtx_t* NvmCtx;
 }LoRaMacCtx_t;
 
+#if !defined( LORAMAC_INSTANCES_ENABLED )
 /*
  * Module context.
  */
 static LoRaMacCtx_t MacCtx;
+#endif
+
+#if defined( TRACE_ENABLED )
+/*!
+ * Last MAC state recorded in the trace
+ */
+static uint32_t TraceMacState = 0;
+#endif
+
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+/*!
+ * Latency timestamps source. May be overridden by a cycle counter.
+ */
+#ifndef LORAMAC_LATENCY_TIMESTAMP
+#define LORAMAC_LATENCY_TIMESTAMP( )                TimerGetCurrentTime( )
+#endif
+
+static LoRaMacLatencyStats_t LatencyStats;
+
+/*!
+ * Timestamps of the current frame
+ */
+static uint32_t LatencyTxStart;
+static uint32_t LatencyTxDone;
+static uint32_t LatencyRxDone;
+static bool LatencyRxDonePending = false;
+
+/*!
+ * Adds a sample to a latency statistic
+ *
+ * \param [IN] stat  Statistic to be updated
+ * \param [IN] value Sample
+ */
+static void LatencyStatUpdate( LoRaMacLatencyStat_t* stat, int32_t value )
+{
+    if( ( stat->Count == 0 ) || ( value < stat->Min ) )
+    {
+        stat->Min = value;
+    }
+    if( ( stat->Count == 0 ) || ( value > stat->Max ) )
+    {
+        stat->Max = value;
+    }
+    stat->Last = value;
+    stat->Count++;
+    stat->Sum += value;
+    stat->Avg = ( int32_t )( stat->Sum / ( int64_t )stat->Count );
+}
 
+#define LATENCY_MARK( timestamp )                   ( timestamp ) = LORAMAC_LATENCY_TIMESTAMP( )
+#define LATENCY_UPDATE( stat, value )               LatencyStatUpdate( &LatencyStats.stat, ( int32_t )( value ) )
+#else
+#define LATENCY_MARK( timestamp )
+#define LATENCY_UPDATE( stat, value )
+#endif
+
+#if !defined( LORAMAC_INSTANCES_ENABLED )
 /*
  * Non-volatile module context.
  */
 static LoRaMacNvmCtx_t NvmMacCtx;
 
-
-
 /*
  * List of module contexts.
  */
-LoRaMacCtxs_t Contexts;
+static LoRaMacCtxs_t ModuleCtxs;
+#endif
+
+/*!
+ * Maximum number of radio events waiting for LoRaMacProcess. Must be a power of 2.
+ */
+#define LORAMAC_RADIO_EVENT_QUEUE_SIZE              8
 
 /*!
- * Defines the LoRaMac radio events status
+ * LoRaMac radio events
  */
-typedef union uLoRaMacRadioEvents
+typedef enum eLoRaMacRadioEvent
 {
-    uint32_t Value;
-    struct sEvents
-    {
-        uint32_t RxTimeout : 1;
-        uint32_t RxError   : 1;
-        uint32_t TxTimeout : 1;
-        uint32_t RxDone    : 1;
-        uint32_t TxDone    : 1;
-    }Events;
-}LoRaMacRadioEvents_t;
+    LORAMAC_RADIO_EVENT_TX_DONE,
+    LORAMAC_RADIO_EVENT_RX_DONE,
+    LORAMAC_RADIO_EVENT_TX_TIMEOUT,
+    LORAMAC_RADIO_EVENT_RX_ERROR,
+    LORAMAC_RADIO_EVENT_RX_TIMEOUT,
+    LORAMAC_RADIO_EVENT_CAD_DONE,
+}LoRaMacRadioEvent_t;
+
+/*!
+ * LoRaMac radio events queue
+ *
+ * \remark The radio IRQ handlers post the events with atomic operations, they
+ *         may preempt each other. A producer reserves a slot, fills it and
+ *         publishes every filled slot when its own is the oldest unpublished
+ *         one, the producers it preempted publish theirs when they resume.
+ *         LoRaMacProcess is the only consumer. It processes them in the order
+ *         they occurred and never masks the interrupts.
+ */
+typedef struct sLoRaMacRadioEventQueue
+{
+    /*!
+     * Pending events
+     */
+    LoRaMacRadioEvent_t Events[LORAMAC_RADIO_EVENT_QUEUE_SIZE];
+    /*!
+     * Free running index of the next slot to reserve. Written by the producers.
+     */
+    uint32_t Reserved;
+    /*!
+     * Free running index of the next event to post. Written by the producers.
+     */
+    uint32_t In;
+    /*!
+     * Free running index of the next event to process. Written by the consumer.
+     */
+    uint32_t Out;
+}LoRaMacRadioEventQueue_t;
+
+#if !defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * LoRaMac radio events queue
+ */
+static volatile LoRaMacRadioEventQueue_t LoRaMacRadioEvents;
+#endif
 
 /*!
- * LoRaMac radio events status
+ * \brief Posts a radio event and notifies the application that
+ *        LoRaMacProcess has to be called.
+ *
+ * \remark The event is discarded when the queue is full. The radio only
+ *         reports a few events per operation which are processed by the
+ *         next LoRaMacProcess call.
+ *
+ * \param [IN] event Radio event
  */
-LoRaMacRadioEvents_t LoRaMacRadioEvents = { .Value = 0 };
+static void LoRaMacPostRadioEvent( LoRaMacRadioEvent_t event );
 
 /*!
  * \brief Function to be executed on Radio Tx Done event
@@ -389,6 +735,83 @@ static void OnRadioTxDone( void );
  */
 static void PrepareRxDoneAbort( void );
 
+/*!
+ * \brief Checks the raw data frame header before the frame is parsed and
+ *        authenticated.
+ *
+ * \param [IN] payload Received frame
+ * \param [IN] size    Received frame size
+ *
+ * \retval [true: the frame is processed, false: the frame is too short or
+ *          its DevAddr is neither the device one nor an enabled multicast one]
+ */
+static bool CheckRxFrameAddress( uint8_t* payload, uint16_t size );
+
+/*!
+ * \brief Rebuilds the address index of the enabled multicast groups. Must be
+ *        called each time the multicast channel list changes.
+ */
+static void UpdateMcAddrIndex( void );
+
+/*!
+ * \brief Looks up an enabled multicast group by address.
+ *
+ * \param [IN] address Multicast address
+ *
+ * \retval [Multicast context of the group, NULL if no enabled group uses
+ *          the address]
+ */
+static MulticastCtx_t* FindMcGroup( uint32_t address );
+
+/*!
+ * \brief Returns the timing error used to compute the Rx1 and Rx2 windows
+ *
+ * \retval rxError Learned error when \ref MIB_ADAPTIVE_RX_ERROR is enabled,
+ *                 the system maximum otherwise [ms]
+ */
+static uint32_t GetRxWindowRxError( void );
+
+/*!
+ * \brief Narrows or widens the learned reception windows timing error
+ *
+ * \param [IN] downlinkReceived true when a valid downlink was received in
+ *                              Rx1 or Rx2, false when an expected one was missed
+ */
+static void UpdateRxErrorEstimate( bool downlinkReceived );
+
+/*!
+ * \brief Updates the downlink history of the boosted reception selection
+ *
+ * \param [IN] downlinkReceived true when a valid downlink was received in
+ *                              Rx1 or Rx2, false when an expected one was missed
+ * \param [IN] snr              SNR of the received downlink
+ */
+static void UpdateRxBoostedHistory( bool downlinkReceived, int8_t snr );
+
+/*!
+ * \brief Checks if a Rx window uses the boosted reception, see \ref MIB_RX_BOOSTED
+ *
+ * \param [IN] datarate Datarate of the window
+ *
+ * \retval Returns true if the reception is boosted
+ */
+static bool IsRxBoosted( int8_t datarate );
+
+/*!
+ * \brief Starts the reception of a Rx window, boosted or not
+ *
+ * \param [IN] timeout  Reception timeout, 0 for a continuous reception
+ * \param [IN] datarate Datarate of the window
+ */
+static void StartRxWindow( uint32_t timeout, int8_t datarate );
+
+/*!
+ * \brief Measures the clock drift from a network time correction
+ *
+ * \param [IN] correction Network time minus local time
+ */
+static void UpdateRxErrorDrift( SysTime_t correction );
+
 /*!
  * \brief Function to be executed on Radio Rx Done event
  */
@@ -409,11 +832,42 @@ static void OnRadioRxError( void );
  */
 static void OnRadioRxTimeout( void );
 
+/*!
+ * \brief Function to be executed on Radio CAD Done event
+ */
+static void OnRadioCadDone( bool channelActivityDetected );
+
+/*!
+ * \brief Function executed when the radio has a deferred IRQ to process
+ */
+static void OnRadioIrqNotify( void );
+
+/*!
+ * \brief Function executed from the radio interrupt flagging the end of a packet
+ *
+ * \param [IN] timestamp Time of the interrupt
+ */
+static void OnRadioIrqTimestamp( uint32_t timestamp );
+
+/*!
+ * \brief Gets the time of the radio event being handled. The time of the
+ *        radio interrupt when the driver reports it, the current time if not.
+ *
+ * \retval Time of the event
+ */
+static TimerTime_t GetRadioEventTime( void );
+
 /*!
  * \brief Function executed on duty cycle delayed Tx  timer event
  */
 static void OnTxDelayedTimerEvent( void* context );
 
+/*!
+ * \brief Function executed when the duty cycle allows to send the next
+ *        queued MCPS-Request
+ */
+static void OnTxQueueTimerEvent( void* context );
+
 /*!
  * \brief Function executed on first Rx window timer event
  */
@@ -429,6 +883,11 @@ static void OnRxWindow2TimerEvent( void* context );
  */
 static void OnAckTimeoutTimerEvent( void* context );
 
+/*!
+ * \brief Function executed on continuous reception window sniff timer event
+ */
+static void OnRxCSniffTimerEvent( void* context );
+
 /*!
  * \brief Configures the events to trigger an MLME-Indication with
  *        a MLME type of MLME_SCHEDULE_UPLINK.
@@ -467,6 +926,24 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass );
  */
 static uint8_t GetMaxAppPayloadWithoutFOptsLength( int8_t datarate );
 
+/*!
+ * \brief Gets the maximum payload length of a datarate from the region constants.
+ *
+ * \param [IN] dwellTime       Dwell time setting of the link direction
+ *
+ * \param [IN] datarate        Datarate
+ *
+ * \retval                    Max length
+ */
+static uint8_t GetMaxPayloadOfDatarate( uint8_t dwellTime, int8_t datarate );
+
+/*!
+ * \brief Gets the minimum Tx datarate for the current uplink dwell time.
+ *
+ * \retval                    Minimum Tx datarate
+ */
+static int8_t GetMinTxDatarate( void );
+
 /*!
  * \brief Validates if the payload fits into the frame, taking the datarate
  *        into account.
@@ -595,6 +1072,11 @@ LoRaMacStatus_t SetTxContinuousWave( uint16_t timeout );
  */
 LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint8_t power );
 
+/*!
+ * \brief Initializes the MAC parameters defaults of the active region
+ */
+static void InitRegionDefaults( void );
+
 /*!
  * \brief Resets MAC specific parameters to default
  */
@@ -614,6 +1096,32 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig );
  */
 static void OpenContinuousRxCWindow( void );
 
+/*!
+ * \brief Indicates if the RxC window preamble is sniffed by channel activity
+ *        detections
+ *
+ * \retval sniffing Set to true when the radio can't duty cycle the reception
+ */
+static bool IsRxCSniffing( void );
+
+/*!
+ * \brief Sets the RxC channel and window to the enabled multicast channel, if
+ *        any, when switching to class C
+ */
+static void SetupRxCWindowChannel( void );
+
+/*!
+ * \brief Computes the RxC window parameters and loads them into the radio
+ *
+ * \retval configured Set to true when the radio is configured
+ */
+static bool ConfigureContinuousRxCWindow( void );
+
+/*!
+ * \brief Starts the reception of a configured RxC window
+ */
+static void StartContinuousRxCWindow( void );
+
 /*!
  * \brief   Returns a pointer to the internal contexts structure.
  *
@@ -634,6 +1142,18 @@ LoRaMacCtxs_t* GetCtxs( void );
  */
 LoRaMacStatus_t RestoreCtxs( LoRaMacCtxs_t* contexts );
 
+/*!
+ * \brief   Restores the internal module contexts
+ *
+ * \param [IN] contexts Pointer to the contexts to restore
+ *
+ * \param [IN] session Set to true to restore a session saved earlier in another
+ *                     region, the join nonces of the running context are kept.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation.
+ */
+static LoRaMacStatus_t RestoreModuleCtxs( LoRaMacCtxs_t* contexts, bool session );
+
 /*!
  * \brief   Determines the frame type
  *
@@ -656,16 +1176,31 @@ LoRaMacStatus_t DetermineFrameType( LoRaMacMessageData_t* macMsg, FType_t* fType
 static bool CheckRetransUnconfirmedUplink( void );
 
 /*!
- * \brief Checks if the retransmission should be stopped in case of a confirmed uplink
+ * \brief Checks if the frame being sent is a repetition of an unconfirmed uplink
  *
- * \retval Returns true it should be stopped.
+ * \retval Returns true if it is a repetition.
  */
-static bool CheckRetransConfirmedUplink( void );
+static bool IsUnconfirmedRepetition( void );
 
 /*!
- * \brief Stops the uplink retransmission
+ * \brief Checks if the Rx windows of the uplink just sent can be skipped, see
+ *        \ref MIB_NB_TRANS_SKIP_RX.
  *
- * \retval Returns true if successful.
+ * \retval Returns true if the next repetition follows without Rx windows.
+ */
+static bool SkipRxWindows( void );
+
+/*!
+ * \brief Checks if the retransmission should be stopped in case of a confirmed uplink
+ *
+ * \retval Returns true it should be stopped.
+ */
+static bool CheckRetransConfirmedUplink( void );
+
+/*!
+ * \brief Stops the uplink retransmission
+ *
+ * \retval Returns true if successful.
  */
 static bool StopRetransmission( void );
 
@@ -688,6 +1223,11 @@ static void AckTimeoutRetriesFinalize( void );
  */
 static void CallNvmCtxCallback( LoRaMacNvmCtxModule_t module );
 
+/*!
+ * \brief Raises the NVM context change events collected while they were deferred
+ */
+static void FlushNvmCtxEvents( void );
+
 /*!
  * \brief MAC NVM Context has been changed
  */
@@ -770,32 +1310,172 @@ static void LoRaMacHandleRequestEvents( void );
  */
 static void LoRaMacHandleIndicationEvents( void );
 
+/*!
+ * \brief This function sends the next queued MCPS-Request once the MAC is idle
+ */
+static void LoRaMacHandleTxQueue( void );
+
 /*!
  * Structure used to store the radio Tx event data
  */
-struct
+typedef struct sLoRaMacTxDoneParams
 {
     TimerTime_t CurTime;
-}TxDoneParams;
+}LoRaMacTxDoneParams_t;
 
 /*!
  * Structure used to store the radio Rx event data
  */
-struct
+typedef struct sLoRaMacRxDoneParams
 {
     TimerTime_t LastRxDone;
     uint8_t *Payload;
     uint16_t Size;
     int16_t Rssi;
     int8_t Snr;
-}RxDoneParams;
+}LoRaMacRxDoneParams_t;
 
-static void OnRadioTxDone( void )
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Instance hooks of a module which keeps a context per instance
+ */
+typedef struct sLoRaMacInstanceModule
+{
+    /*!
+     * Returns the size of the module instance block
+     */
+    size_t ( *GetInstanceSize )( void );
+    /*!
+     * Selects the module instance block, NULL selects the default one
+     */
+    void ( *SelectInstance )( void* instance );
+}LoRaMacInstanceModule_t;
+
+/*!
+ * Modules which keep a context per instance
+ */
+static const LoRaMacInstanceModule_t LoRaMacInstanceModules[] =
+{
+    { LoRaMacCryptoGetInstanceSize,         LoRaMacCryptoSelectInstance },
+    { SecureElementGetInstanceSize,         SecureElementSelectInstance },
+    { RegionGetInstanceSize,                RegionSelectInstance },
+    { LoRaMacCommandsGetInstanceSize,       LoRaMacCommandsSelectInstance },
+    { LoRaMacClassBGetInstanceSize,         LoRaMacClassBSelectInstance },
+    { LoRaMacConfirmQueueGetInstanceSize,   LoRaMacConfirmQueueSelectInstance },
+    { LoRaMacTxQueueGetInstanceSize,        LoRaMacTxQueueSelectInstance },
+    { LoRaMacAdrGetInstanceSize,            LoRaMacAdrSelectInstance },
+};
+
+#define LORAMAC_INSTANCE_NB_MODULES                 ( sizeof( LoRaMacInstanceModules ) / sizeof( LoRaMacInstanceModules[0] ) )
+
+/*!
+ * LoRaMac stack instance. The latency statistics and the trace state are
+ * shared by the instances.
+ */
+struct sLoRaMacInstance
+{
+    /*!
+     * Module context
+     */
+    LoRaMacCtx_t MacCtx;
+    /*!
+     * Non-volatile module context
+     */
+    LoRaMacNvmCtx_t NvmMacCtx;
+    /*!
+     * List of module contexts
+     */
+    LoRaMacCtxs_t ModuleCtxs;
+    /*!
+     * Radio events queue
+     */
+    volatile LoRaMacRadioEventQueue_t LoRaMacRadioEvents;
+    /*!
+     * Radio Tx event data
+     */
+    LoRaMacTxDoneParams_t TxDoneParams;
+    /*!
+     * Radio Rx event data
+     */
+    LoRaMacRxDoneParams_t RxDoneParams;
+    /*!
+     * Instance blocks of the LoRaMacInstanceModules, NULL for the default
+     * instance
+     */
+    void* Modules[LORAMAC_INSTANCE_NB_MODULES];
+};
+
+/*!
+ * Instance used when the application doesn't create any
+ */
+static LoRaMacInstance_t DefaultInstance;
+
+/*!
+ * Instance the LoRaMac API acts on
+ */
+static LoRaMacInstance_t* SelectedInstance = &DefaultInstance;
+
+/*!
+ * Instance which started the last radio operation
+ */
+static LoRaMacInstance_t* RadioOwner = &DefaultInstance;
+
+/*!
+ * Radio events shared by the instances, set by the first initialization
+ */
+static RadioEvents_t InstanceRadioEvents;
+
+#define MacCtx                                      ( SelectedInstance->MacCtx )
+#define NvmMacCtx                                   ( SelectedInstance->NvmMacCtx )
+#define ModuleCtxs                                  ( SelectedInstance->ModuleCtxs )
+#define LoRaMacRadioEvents                          ( SelectedInstance->LoRaMacRadioEvents )
+#define TxDoneParams                                ( SelectedInstance->TxDoneParams )
+#define RxDoneParams                                ( SelectedInstance->RxDoneParams )
+#else
+/*!
+ * Radio Tx event data
+ */
+static LoRaMacTxDoneParams_t TxDoneParams;
+
+/*!
+ * Radio Rx event data
+ */
+static LoRaMacRxDoneParams_t RxDoneParams;
+#endif
+
+static void LoRaMacPostRadioEvent( LoRaMacRadioEvent_t event )
 {
-    TxDoneParams.CurTime = TimerGetCurrentTime( );
-    MacCtx.LastTxSysTime = SysTimeGet( );
+    uint32_t slot;
+
+    do
+    {
+        slot = LoRaMacRadioEvents.Reserved;
+        if( ( slot - LoRaMacRadioEvents.Out ) >= LORAMAC_RADIO_EVENT_QUEUE_SIZE )
+        {
+            slot = UINT32_MAX;
+            break;
+        }
+    }while( AtomicCompareExchange( &LoRaMacRadioEvents.Reserved, slot, slot + 1 ) == false );
+
+    if( slot != UINT32_MAX )
+    {
+        LoRaMacRadioEvents.Events[slot & ( LORAMAC_RADIO_EVENT_QUEUE_SIZE - 1 )] = event;
+        ATOMIC_COMPILER_BARRIER( );
+
+        // The producers which preempted this one are done, their slots are
+        // filled. An older unpublished slot belongs to a preempted producer
+        // which publishes this one when it resumes.
+        if( LoRaMacRadioEvents.In == slot )
+        {
+            uint32_t reserved;
 
-    LoRaMacRadioEvents.Events.TxDone = 1;
+            do
+            {
+                reserved = LoRaMacRadioEvents.Reserved;
+                LoRaMacRadioEvents.In = reserved;
+            }while( LoRaMacRadioEvents.Reserved != reserved );
+        }
+    }
 
     if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
     {
@@ -803,50 +1483,90 @@ static void OnRadioTxDone( void )
     }
 }
 
+static void OnRadioTxDone( void )
+{
+    TimerTime_t elapsed;
+
+    LATENCY_MARK( LatencyTxDone );
+    LATENCY_UPDATE( TxAir, LatencyTxDone - LatencyTxStart );
+    TRACE( TRACE_ID_RADIO_IRQ, TRACE_RADIO_IRQ_TX_DONE, 0, 0 );
+    TxDoneParams.CurTime = GetRadioEventTime( );
+    // System time at the end of the uplink, the DeviceTimeAns refers to it
+    elapsed = TimerGetElapsedTime( TxDoneParams.CurTime );
+    MacCtx.LastTxSysTime = SysTimeSub( SysTimeGet( ), ( SysTime_t ){ .Seconds = elapsed / 1000, .SubSeconds = elapsed % 1000 } );
+
+    LoRaMacPostRadioEvent( LORAMAC_RADIO_EVENT_TX_DONE );
+}
+
 static void OnRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
 {
-    RxDoneParams.LastRxDone = TimerGetCurrentTime( );
+    LATENCY_MARK( LatencyRxDone );
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+    LatencyRxDonePending = true;
+#endif
+    TRACE( TRACE_ID_RADIO_IRQ, TRACE_RADIO_IRQ_RX_DONE, size, ( ( uint32_t )( uint16_t )rssi << 16 ) | ( uint8_t )snr );
+    RxDoneParams.LastRxDone = GetRadioEventTime( );
     RxDoneParams.Payload = payload;
     RxDoneParams.Size = size;
     RxDoneParams.Rssi = rssi;
     RxDoneParams.Snr = snr;
 
-    LoRaMacRadioEvents.Events.RxDone = 1;
-
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
-    {
-        MacCtx.MacCallbacks->MacProcessNotify( );
-    }
+    LoRaMacPostRadioEvent( LORAMAC_RADIO_EVENT_RX_DONE );
 }
 
 static void OnRadioTxTimeout( void )
 {
-    LoRaMacRadioEvents.Events.TxTimeout = 1;
-
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
-    {
-        MacCtx.MacCallbacks->MacProcessNotify( );
-    }
+    MacCtx.RadioIrqTimeValid = false;
+    TRACE( TRACE_ID_RADIO_IRQ, TRACE_RADIO_IRQ_TX_TIMEOUT, 0, 0 );
+    LoRaMacPostRadioEvent( LORAMAC_RADIO_EVENT_TX_TIMEOUT );
 }
 
 static void OnRadioRxError( void )
 {
-    LoRaMacRadioEvents.Events.RxError = 1;
+    MacCtx.RadioIrqTimeValid = false;
+    TRACE( TRACE_ID_RADIO_IRQ, TRACE_RADIO_IRQ_RX_ERROR, 0, 0 );
+    LoRaMacPostRadioEvent( LORAMAC_RADIO_EVENT_RX_ERROR );
+}
+
+static void OnRadioRxTimeout( void )
+{
+    MacCtx.RadioIrqTimeValid = false;
+    TRACE( TRACE_ID_RADIO_IRQ, TRACE_RADIO_IRQ_RX_TIMEOUT, 0, 0 );
+    LoRaMacPostRadioEvent( LORAMAC_RADIO_EVENT_RX_TIMEOUT );
+}
+
+static void OnRadioCadDone( bool channelActivityDetected )
+{
+    MacCtx.RadioIrqTimeValid = false;
+    TRACE( TRACE_ID_RADIO_IRQ, TRACE_RADIO_IRQ_CAD_DONE, channelActivityDetected, 0 );
+    MacCtx.ChannelActivityDetected = channelActivityDetected;
+
+    LoRaMacPostRadioEvent( LORAMAC_RADIO_EVENT_CAD_DONE );
+}
 
+static void OnRadioIrqNotify( void )
+{
+    // Radio.IrqProcess is called by the LoRaMacProcess caller
     if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
     {
         MacCtx.MacCallbacks->MacProcessNotify( );
     }
 }
 
-static void OnRadioRxTimeout( void )
+static void OnRadioIrqTimestamp( uint32_t timestamp )
 {
-    LoRaMacRadioEvents.Events.RxTimeout = 1;
+    MacCtx.RadioIrqTime = timestamp;
+    MacCtx.RadioIrqTimeValid = true;
+}
 
-    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+static TimerTime_t GetRadioEventTime( void )
+{
+    if( MacCtx.RadioIrqTimeValid == true )
     {
-        MacCtx.MacCallbacks->MacProcessNotify( );
+        MacCtx.RadioIrqTimeValid = false;
+        return MacCtx.RadioIrqTime;
     }
+    return TimerGetCurrentTime( );
 }
 
 static void UpdateRxSlotIdleState( void )
@@ -867,24 +1587,40 @@ static void ProcessRadioTxDone( void )
     PhyParam_t phyParam;
     SetBandTxDoneParams_t txDone;
 
+    bool skipRx = SkipRxWindows( );
+
     if( MacCtx.NvmCtx->DeviceClass != CLASS_C )
     {
         Radio.Sleep( );
     }
-    // Setup timers
-    TimerSetValue( &MacCtx.RxWindowTimer1, MacCtx.RxWindow1Delay );
-    TimerStart( &MacCtx.RxWindowTimer1 );
-    TimerSetValue( &MacCtx.RxWindowTimer2, MacCtx.RxWindow2Delay );
-    TimerStart( &MacCtx.RxWindowTimer2 );
+    if( skipRx == true )
+    {
+        // The next repetition is scheduled at once
+        MacCtx.MacFlags.Bits.MacDone = 1;
+    }
+    else
+    {
+        // Setup timers
+        TimerSetValueUs( &MacCtx.RxWindowTimer1, MacCtx.RxWindow1DelayUs );
+        TimerStart( &MacCtx.RxWindowTimer1 );
+        TimerSetValueUs( &MacCtx.RxWindowTimer2, MacCtx.RxWindow2DelayUs );
+        TimerStart( &MacCtx.RxWindowTimer2 );
+    }
 
     if( ( MacCtx.NvmCtx->DeviceClass == CLASS_C ) || ( MacCtx.NodeAckRequested == true ) )
     {
         getPhy.Attribute = PHY_ACK_TIMEOUT;
         phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-        TimerSetValue( &MacCtx.AckTimeoutTimer, MacCtx.RxWindow2Delay + phyParam.Value );
+        TimerSetValueUs( &MacCtx.AckTimeoutTimer, MacCtx.RxWindow2DelayUs + ( phyParam.Value * 1000 ) );
         TimerStart( &MacCtx.AckTimeoutTimer );
     }
 
+    if( ( MacCtx.NvmCtx->NetworkActivation != ACTIVATION_TYPE_NONE ) && ( skipRx == false ) )
+    {
+        // Prepare the downlink decryption while waiting for the receive windows
+        LoRaMacCryptoPrepareDownlinkKeystreams( MacCtx.NvmCtx->DevAddr );
+    }
+
     // Store last Tx channel
     MacCtx.NvmCtx->LastTxChannel = MacCtx.Channel;
     // Update last tx done time for the current channel
@@ -923,12 +1659,242 @@ static void PrepareRxDoneAbort( void )
     UpdateRxSlotIdleState( );
 }
 
+static bool CheckRxFrameAddress( uint8_t* payload, uint16_t size )
+{
+    LoRaMacHeader_t macHdr;
+    uint32_t devAddr;
+
+    macHdr.Value = payload[0];
+    if( ( macHdr.Bits.MType != FRAME_TYPE_DATA_UNCONFIRMED_DOWN ) &&
+        ( macHdr.Bits.MType != FRAME_TYPE_DATA_CONFIRMED_DOWN ) )
+    {
+        return true;
+    }
+
+    if( size < ( LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE + LORAMAC_FHDR_F_CTRL_FIELD_SIZE +
+                 LORAMAC_FHDR_F_CNT_FIELD_SIZE + LORAMAC_MIC_FIELD_SIZE ) )
+    {
+        return false;
+    }
+
+    devAddr = ( uint32_t )payload[1];
+    devAddr |= ( ( uint32_t )payload[2] << 8 );
+    devAddr |= ( ( uint32_t )payload[3] << 16 );
+    devAddr |= ( ( uint32_t )payload[4] << 24 );
+
+    if( devAddr == MacCtx.NvmCtx->DevAddr )
+    {
+        return true;
+    }
+    return FindMcGroup( devAddr ) != NULL;
+}
+
+static void UpdateMcAddrIndex( void )
+{
+    MacCtx.McAddrIndexSize = 0;
+
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        MulticastCtx_t* mcCtx = &MacCtx.NvmCtx->MulticastChannelList[i];
+
+        if( mcCtx->ChannelParams.IsEnabled == false )
+        {
+            continue;
+        }
+        // Insertion sort, the first group set up with an address wins
+        uint8_t j = MacCtx.McAddrIndexSize;
+        while( ( j > 0 ) && ( MacCtx.McAddrIndex[j - 1].Address > mcCtx->ChannelParams.Address ) )
+        {
+            MacCtx.McAddrIndex[j] = MacCtx.McAddrIndex[j - 1];
+            j--;
+        }
+        MacCtx.McAddrIndex[j].Address = mcCtx->ChannelParams.Address;
+        MacCtx.McAddrIndex[j].McCtx = mcCtx;
+        MacCtx.McAddrIndexSize++;
+    }
+}
+
+static MulticastCtx_t* FindMcGroup( uint32_t address )
+{
+    uint8_t low = 0;
+    uint8_t high = MacCtx.McAddrIndexSize;
+
+    // Early reject of the addresses outside of the indexed range
+    if( ( high == 0 ) || ( address < MacCtx.McAddrIndex[0].Address ) ||
+        ( address > MacCtx.McAddrIndex[high - 1].Address ) )
+    {
+        return NULL;
+    }
+
+    while( low < high )
+    {
+        uint8_t mid = ( low + high ) >> 1;
+
+        if( MacCtx.McAddrIndex[mid].Address < address )
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
+        }
+    }
+
+    if( ( low < MacCtx.McAddrIndexSize ) && ( MacCtx.McAddrIndex[low].Address == address ) )
+    {
+        return MacCtx.McAddrIndex[low].McCtx;
+    }
+    return NULL;
+}
+
+static uint32_t GetRxWindowRxError( void )
+{
+    if( ( MacCtx.AdaptiveRxError == false ) || ( MacCtx.RxErrorEstimate == 0 ) )
+    {
+        return MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+    }
+    return MIN( MacCtx.RxErrorEstimate, MacCtx.NvmCtx->MacParams.SystemMaxRxError );
+}
+
+static void UpdateRxErrorEstimate( bool downlinkReceived )
+{
+    uint32_t maxRxError = MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+    uint32_t minRxError;
+    uint32_t rxError;
+
+    if( MacCtx.AdaptiveRxError == false )
+    {
+        return;
+    }
+
+    // The windows are timed from the Tx done event, only the drift accumulated
+    // over the longest receive delay adds to the fixed latency margin.
+    minRxError = LORAMAC_ADAPTIVE_RX_ERROR_MARGIN +
+                 ( ( MacCtx.RxErrorDriftPpm * MacCtx.NvmCtx->MacParams.ReceiveDelay2 ) + 999999 ) / 1000000;
+    minRxError = MIN( minRxError, maxRxError );
+
+    rxError = GetRxWindowRxError( );
+    if( downlinkReceived == true )
+    {
+        // Shrink by a quarter, the frame was caught with the current error
+        rxError -= MAX( rxError >> 2, 1 );
+    }
+    else
+    {
+        // Back off quickly after a miss
+        rxError <<= 1;
+    }
+    MacCtx.RxErrorEstimate = MIN( MAX( rxError, minRxError ), maxRxError );
+}
+
+static void UpdateRxBoostedHistory( bool downlinkReceived, int8_t snr )
+{
+    if( downlinkReceived == false )
+    {
+        MacCtx.RxBoostedMiss = true;
+        return;
+    }
+    MacCtx.RxBoostedMiss = false;
+    MacCtx.RxBoostedSnrs[MacCtx.RxBoostedSnrsIndex] = snr;
+    MacCtx.RxBoostedSnrsIndex = ( MacCtx.RxBoostedSnrsIndex + 1 ) % LORAMAC_RX_BOOSTED_HISTORY_SIZE;
+    if( MacCtx.NbRxBoostedSnrs < LORAMAC_RX_BOOSTED_HISTORY_SIZE )
+    {
+        MacCtx.NbRxBoostedSnrs++;
+    }
+}
+
+static bool IsRxBoosted( int8_t datarate )
+{
+    const RegionPhyConsts_t* phyConsts;
+    int16_t snrSum = 0;
+    int16_t floor;
+    uint8_t sf;
+
+    if( ( Radio.RxBoosted == NULL ) || ( MacCtx.RxBoosted == LORAMAC_RX_BOOSTED_OFF ) )
+    {
+        return false;
+    }
+    if( MacCtx.RxBoosted == LORAMAC_RX_BOOSTED_ON )
+    {
+        return true;
+    }
+    // Unknown or failing link
+    if( ( MacCtx.NbRxBoostedSnrs == 0 ) || ( MacCtx.RxBoostedMiss == true ) )
+    {
+        return true;
+    }
+
+    phyConsts = RegionGetPhyConsts( MacCtx.NvmCtx->Region );
+    if( ( phyConsts == NULL ) || ( datarate < 0 ) || ( datarate >= phyConsts->NbDatarates ) )
+    {
+        return false;
+    }
+    sf = phyConsts->Datarates[datarate];
+    if( ( sf < 6 ) || ( sf > 12 ) )
+    {
+        // Not a LoRa datarate
+        return false;
+    }
+
+    for( uint8_t i = 0; i < MacCtx.NbRxBoostedSnrs; i++ )
+    {
+        snrSum += MacCtx.RxBoostedSnrs[i];
+    }
+    // Demodulation floor in 0.5 dB steps, -7.5 dB at SF7 down to -20 dB at SF12
+    floor = -( ( 5 * sf ) - 20 );
+
+    return ( ( ( 2 * snrSum ) / MacCtx.NbRxBoostedSnrs ) - floor ) < ( 2 * LORAMAC_RX_BOOSTED_MARGIN );
+}
+
+static void StartRxWindow( uint32_t timeout, int8_t datarate )
+{
+    if( IsRxBoosted( datarate ) == true )
+    {
+        Radio.RxBoosted( timeout );
+    }
+    else
+    {
+        Radio.Rx( timeout );
+    }
+}
+
+static void UpdateRxErrorDrift( SysTime_t correction )
+{
+    int64_t correctionMs = ( ( int64_t )( int32_t )correction.Seconds * 1000 ) + correction.SubSeconds;
+    TimerTime_t elapsed = TimerGetElapsedTime( MacCtx.LastTimeSyncTime );
+
+    if( ( MacCtx.LastTimeSyncTime != 0 ) && ( elapsed >= LORAMAC_ADAPTIVE_RX_ERROR_SYNC_PERIOD ) )
+    {
+        if( correctionMs < 0 )
+        {
+            correctionMs = -correctionMs;
+        }
+        MacCtx.RxErrorDriftPpm = ( uint32_t )( ( correctionMs * 1000000 ) / elapsed );
+    }
+    MacCtx.LastTimeSyncTime = TimerGetCurrentTime( );
+}
+
+/*!
+ * \brief Ends a reception. The radio sleeps, unless the reception was a class
+ *        B slot closely followed by another one.
+ */
+static void EndRadioRx( void )
+{
+    if( ( MacCtx.NvmCtx->DeviceClass == CLASS_B ) &&
+        ( ( LoRaMacClassBIsPingExpected( ) == true ) || ( LoRaMacClassBIsMulticastExpected( ) == true ) ) )
+    {
+        LoRaMacClassBRadioEndSlot( );
+    }
+    else
+    {
+        Radio.Sleep( );
+    }
+}
+
 static void ProcessRadioRxDone( void )
 {
     LoRaMacHeader_t macHdr;
     ApplyCFListParams_t applyCFList;
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
     LoRaMacCryptoStatus_t macCryptoStatus = LORAMAC_CRYPTO_ERROR;
 
     LoRaMacMessageData_t macMsgData;
@@ -962,11 +1928,11 @@ static void ProcessRadioRxDone( void )
     MacCtx.McpsIndication.DevAddress = 0;
     MacCtx.McpsIndication.DeviceTimeAnsReceived = false;
 
-    Radio.Sleep( );
+    EndRadioRx( );
     TimerStop( &MacCtx.RxWindowTimer2 );
 
     // This function must be called even if we are not in class b mode yet.
-    if( LoRaMacClassBRxBeacon( payload, size ) == true )
+    if( LoRaMacClassBRxBeacon( payload, size, RxDoneParams.LastRxDone ) == true )
     {
         MacCtx.MlmeIndication.BeaconInfo.Rssi = rssi;
         MacCtx.MlmeIndication.BeaconInfo.Snr = snr;
@@ -989,6 +1955,15 @@ static void ProcessRadioRxDone( void )
         }
     }
 
+    // Drop the frames addressed to other devices before any parsing or cryptographic work
+    if( ( size == 0 ) || ( CheckRxFrameAddress( payload, size ) == false ) )
+    {
+        MacCtx.RxFilteredFrames++;
+        MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ADDRESS_FAIL;
+        PrepareRxDoneAbort( );
+        return;
+    }
+
     macHdr.Value = payload[pktHeaderLen++];
 
     switch( macHdr.Bits.MType )
@@ -1040,6 +2015,9 @@ static void ProcessRadioRxDone( void )
                 RegionApplyCFList( MacCtx.NvmCtx->Region, &applyCFList );
 
                 MacCtx.NvmCtx->NetworkActivation = ACTIVATION_TYPE_OTAA;
+                LoRaMacAdrResetLinkHistory( );
+                UpdateRxErrorEstimate( true );
+                UpdateRxBoostedHistory( true, snr );
 
                 // MLME handling
                 if( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true )
@@ -1061,26 +2039,19 @@ static void ProcessRadioRxDone( void )
             // Intentional fall through
         case FRAME_TYPE_DATA_UNCONFIRMED_DOWN:
             // Check if the received payload size is valid
-            getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
-            getPhy.Datarate = MacCtx.McpsIndication.RxDatarate;
-            getPhy.Attribute = PHY_MAX_PAYLOAD;
-
-            // Get the maximum payload length
-            if( MacCtx.NvmCtx->RepeaterSupport == true )
-            {
-                getPhy.Attribute = PHY_MAX_PAYLOAD_REPEATER;
-            }
-            phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-            if( MAX( 0, ( int16_t )( ( int16_t ) size - ( int16_t ) LORA_MAC_FRMPAYLOAD_OVERHEAD ) ) > ( int16_t )phyParam.Value )
+            if( MAX( 0, ( int16_t )( ( int16_t ) size - ( int16_t ) LORA_MAC_FRMPAYLOAD_OVERHEAD ) ) >
+                ( int16_t )GetMaxPayloadOfDatarate( MacCtx.NvmCtx->MacParams.DownlinkDwellTime, MacCtx.McpsIndication.RxDatarate ) )
             {
                 MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
                 PrepareRxDoneAbort( );
                 return;
             }
+            // The frame is parsed and decrypted in place, in the radio
+            // reception buffer. The parser points FRMPayload to its location
+            // in the frame.
             macMsgData.Buffer = payload;
             macMsgData.BufSize = size;
-            macMsgData.FRMPayload = MacCtx.RxPayload;
-            macMsgData.FRMPayloadSize = LORAMAC_PHY_MAXPAYLOAD;
+            macMsgData.FRMPayload = NULL;
 
             if( LORAMAC_PARSER_SUCCESS != LoRaMacParserData( &macMsgData ) )
             {
@@ -1103,29 +2074,22 @@ static void ProcessRadioRxDone( void )
             //Check if it is a multicast message
             multicast = 0;
             downLinkCounter = 0;
-            for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
-            {
-                if( ( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address == macMsgData.FHDR.DevAddr ) &&
-                    ( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.IsEnabled == true ) )
+            MulticastCtx_t* mcCtx = FindMcGroup( macMsgData.FHDR.DevAddr );
+            if( mcCtx != NULL )
+            {
+                multicast = 1;
+                addrID = mcCtx->ChannelParams.GroupID;
+                downLinkCounter = *( mcCtx->DownLinkCounter );
+                address = mcCtx->ChannelParams.Address;
+                if( MacCtx.NvmCtx->DeviceClass == CLASS_C )
                 {
-                    multicast = 1;
-                    addrID = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.GroupID;
-                    downLinkCounter = *( MacCtx.NvmCtx->MulticastChannelList[i].DownLinkCounter );
-                    address = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address;
-                    if( MacCtx.NvmCtx->DeviceClass == CLASS_C )
-                    {
-                        MacCtx.McpsIndication.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
-                    }
-                    break;
+                    MacCtx.McpsIndication.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
                 }
             }
 
-            // Get maximum allowed counter difference
-            getPhy.Attribute = PHY_MAX_FCNT_GAP;
-            phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-
-            // Get downlink frame counter value
-            macCryptoStatus = GetFCntDown( addrID, fType, &macMsgData, MacCtx.NvmCtx->Version, phyParam.Value, &fCntID, &downLinkCounter );
+            // Get downlink frame counter value, within the maximum allowed counter difference
+            macCryptoStatus = GetFCntDown( addrID, fType, &macMsgData, MacCtx.NvmCtx->Version,
+                                           RegionGetPhyConsts( MacCtx.NvmCtx->Region )->MaxFCntGap, &fCntID, &downLinkCounter );
             if( macCryptoStatus != LORAMAC_CRYPTO_SUCCESS )
             {
                 if( macCryptoStatus == LORAMAC_CRYPTO_FAIL_FCNT_DUPLICATED )
@@ -1152,7 +2116,11 @@ static void ProcessRadioRxDone( void )
                 return;
             }
 
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+            uint32_t cryptoStart = LORAMAC_LATENCY_TIMESTAMP( );
+#endif
             macCryptoStatus = LoRaMacCryptoUnsecureMessage( addrID, address, fCntID, downLinkCounter, &macMsgData );
+            LATENCY_UPDATE( RxCrypto, LORAMAC_LATENCY_TIMESTAMP( ) - cryptoStart );
             if( macCryptoStatus != LORAMAC_CRYPTO_SUCCESS )
             {
                 if( macCryptoStatus == LORAMAC_CRYPTO_FAIL_ADDRESS )
@@ -1178,6 +2146,13 @@ static void ProcessRadioRxDone( void )
             MacCtx.McpsIndication.DownLinkCounter = downLinkCounter;
             MacCtx.McpsIndication.AckReceived = macMsgData.FHDR.FCtrl.Bits.Ack;
 
+            if( ( multicast == 0 ) && ( ( MacCtx.McpsIndication.RxSlot == RX_SLOT_WIN_1 ) ||
+                                        ( MacCtx.McpsIndication.RxSlot == RX_SLOT_WIN_2 ) ) )
+            {
+                // Downlink answering the last uplink
+                LoRaMacAdrAddDownlink( MacCtx.Channel, rssi, snr );
+            }
+
             MacCtx.McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_OK;
             MacCtx.McpsConfirm.AckReceived = macMsgData.FHDR.FCtrl.Bits.Ack;
 
@@ -1186,6 +2161,8 @@ static void ProcessRadioRxDone( void )
                 ( MacCtx.McpsIndication.RxSlot == RX_SLOT_WIN_2 ) )
             {
                 MacCtx.NvmCtx->AdrAckCounter = 0;
+                UpdateRxErrorEstimate( true );
+                UpdateRxBoostedHistory( true, snr );
             }
 
             // MCPS Indication and ack requested handling
@@ -1284,11 +2261,9 @@ static void ProcessRadioRxDone( void )
 
             break;
         case FRAME_TYPE_PROPRIETARY:
-            memcpy1( MacCtx.RxPayload, &payload[pktHeaderLen], size - pktHeaderLen );
-
             MacCtx.McpsIndication.McpsIndication = MCPS_PROPRIETARY;
             MacCtx.McpsIndication.Status = LORAMAC_EVENT_INFO_STATUS_OK;
-            MacCtx.McpsIndication.Buffer = MacCtx.RxPayload;
+            MacCtx.McpsIndication.Buffer = &payload[pktHeaderLen];
             MacCtx.McpsIndication.BufferSize = size - pktHeaderLen;
 
             MacCtx.MacFlags.Bits.McpsInd = 1;
@@ -1342,7 +2317,7 @@ static void HandleRadioRxErrorTimeout( LoRaMacEventInfoStatus_t rx1EventInfoStat
 
     if( MacCtx.NvmCtx->DeviceClass != CLASS_C )
     {
-        Radio.Sleep( );
+        EndRadioRx( );
     }
 
     if( LoRaMacClassBIsBeaconExpected( ) == true )
@@ -1377,7 +2352,7 @@ static void HandleRadioRxErrorTimeout( LoRaMacEventInfoStatus_t rx1EventInfoStat
             }
             LoRaMacConfirmQueueSetStatusCmn( rx1EventInfoStatus );
 
-            if( TimerGetElapsedTime( MacCtx.NvmCtx->LastTxDoneTime ) >= MacCtx.RxWindow2Delay )
+            if( TimerGetElapsedTime( MacCtx.NvmCtx->LastTxDoneTime ) >= ( MacCtx.RxWindow2DelayUs / 1000 ) )
             {
                 TimerStop( &MacCtx.RxWindowTimer2 );
                 MacCtx.MacFlags.Bits.MacDone = 1;
@@ -1389,6 +2364,12 @@ static void HandleRadioRxErrorTimeout( LoRaMacEventInfoStatus_t rx1EventInfoStat
             {
                 MacCtx.McpsConfirm.Status = rx2EventInfoStatus;
             }
+            if( ( MacCtx.NodeAckRequested == true ) || ( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true ) )
+            {
+                // An expected downlink was missed in both windows
+                UpdateRxErrorEstimate( false );
+                UpdateRxBoostedHistory( false, 0 );
+            }
             LoRaMacConfirmQueueSetStatusCmn( rx2EventInfoStatus );
 
             if( MacCtx.NvmCtx->DeviceClass != CLASS_C )
@@ -1411,36 +2392,92 @@ static void ProcessRadioRxTimeout( void )
     HandleRadioRxErrorTimeout( LORAMAC_EVENT_INFO_STATUS_RX1_TIMEOUT, LORAMAC_EVENT_INFO_STATUS_RX2_TIMEOUT );
 }
 
-static void LoRaMacHandleIrqEvents( void )
+static void ProcessRadioCadDone( void )
 {
-    LoRaMacRadioEvents_t events;
+    if( MacCtx.RxCSniffState != RXC_SNIFF_STATE_CAD )
+    {
+        return;
+    }
 
-    CRITICAL_SECTION_BEGIN( );
-    events = LoRaMacRadioEvents;
-    LoRaMacRadioEvents.Value = 0;
-    CRITICAL_SECTION_END( );
+    if( MacCtx.ChannelActivityDetected == true )
+    {
+        // A preamble is on air. The radio is configured for a single
+        // reception, the symbol timeout ends it if nothing locks.
+        Radio.Rx( 0 );
+        MacCtx.RxCSniffState = RXC_SNIFF_STATE_RX;
+    }
+    else
+    {
+        Radio.Sleep( );
+        MacCtx.RxCSniffState = RXC_SNIFF_STATE_SLEEP;
+        TimerSetValue( &MacCtx.RxCSniffTimer, MAX( MacCtx.NvmCtx->MacParams.RxCDutyCycle.SleepTime / 1000, 1 ) );
+        TimerStart( &MacCtx.RxCSniffTimer );
+    }
+}
 
-    if( events.Value != 0 )
+/*!
+ * \brief Ends the reception started by a preamble detection
+ *
+ * \retval true if the event ended a sniffing reception and must not be
+ *         processed further
+ */
+static bool EndRxCSniffReception( LoRaMacRadioEvent_t event )
+{
+    if( MacCtx.RxCSniffState != RXC_SNIFF_STATE_RX )
     {
-        if( events.Events.TxDone == 1 )
-        {
-            ProcessRadioTxDone( );
-        }
-        if( events.Events.RxDone == 1 )
-        {
-            ProcessRadioRxDone( );
-        }
-        if( events.Events.TxTimeout == 1 )
-        {
-            ProcessRadioTxTimeout( );
-        }
-        if( events.Events.RxError == 1 )
+        return false;
+    }
+    // LoRaMacProcess restarts the sniffing cycle
+    MacCtx.RxCSniffState = RXC_SNIFF_STATE_IDLE;
+
+    // A false detection is not a missed RX2 window
+    return ( event != LORAMAC_RADIO_EVENT_RX_DONE ) && ( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C );
+}
+
+static void StopRxCSniff( void )
+{
+    TimerStop( &MacCtx.RxCSniffTimer );
+    MacCtx.RxCSniffState = RXC_SNIFF_STATE_IDLE;
+}
+
+static void LoRaMacHandleIrqEvents( void )
+{
+    // Only the producers write the In index, a word read is atomic
+    while( LoRaMacRadioEvents.In != LoRaMacRadioEvents.Out )
+    {
+        LoRaMacRadioEvent_t event = LoRaMacRadioEvents.Events[LoRaMacRadioEvents.Out & ( LORAMAC_RADIO_EVENT_QUEUE_SIZE - 1 )];
+
+        ATOMIC_COMPILER_BARRIER( );
+        LoRaMacRadioEvents.Out++;
+
+        if( EndRxCSniffReception( event ) == true )
         {
-            ProcessRadioRxError( );
+            Radio.Sleep( );
+            continue;
         }
-        if( events.Events.RxTimeout == 1 )
+
+        switch( event )
         {
-            ProcessRadioRxTimeout( );
+            case LORAMAC_RADIO_EVENT_TX_DONE:
+                ProcessRadioTxDone( );
+                break;
+            case LORAMAC_RADIO_EVENT_RX_DONE:
+                ProcessRadioRxDone( );
+                break;
+            case LORAMAC_RADIO_EVENT_TX_TIMEOUT:
+                ProcessRadioTxTimeout( );
+                break;
+            case LORAMAC_RADIO_EVENT_RX_ERROR:
+                ProcessRadioRxError( );
+                break;
+            case LORAMAC_RADIO_EVENT_RX_TIMEOUT:
+                ProcessRadioRxTimeout( );
+                break;
+            case LORAMAC_RADIO_EVENT_CAD_DONE:
+                ProcessRadioCadDone( );
+                break;
+            default:
+                break;
         }
     }
 }
@@ -1455,6 +2492,17 @@ bool LoRaMacIsBusy( void )
     return true;
 }
 
+uint32_t LoRaMacGetRxCPreambleTime( void )
+{
+    if( MacCtx.NvmCtx->MacParams.RxCDutyCycle.SleepTime == 0 )
+    {
+        return 0;
+    }
+    // The preamble has to span a full sleep period and overlap the listening
+    // periods around it
+    return MacCtx.NvmCtx->MacParams.RxCDutyCycle.SleepTime + ( 2 * MacCtx.NvmCtx->MacParams.RxCDutyCycle.RxTime );
+}
+
 
 static void LoRaMacEnableRequests( LoRaMacRequestHandling_t requestState )
 {
@@ -1543,10 +2591,69 @@ static void LoRaMacHandleIndicationEvents( void )
     if( MacCtx.MacFlags.Bits.McpsInd == 1 )
     {
         MacCtx.MacFlags.Bits.McpsInd = 0;
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+        if( LatencyRxDonePending == true )
+        {
+            LatencyRxDonePending = false;
+            LATENCY_UPDATE( RxDoneToIndication, LORAMAC_LATENCY_TIMESTAMP( ) - LatencyRxDone );
+        }
+#endif
         MacCtx.MacPrimitives->MacMcpsIndication( &MacCtx.McpsIndication );
     }
 }
 
+static void LoRaMacHandleTxQueue( void )
+{
+    McpsReq_t mcpsReq;
+    LoRaMacStatus_t status;
+
+    if( ( LoRaMacIsBusy( ) == true ) || ( TimerIsStarted( &MacCtx.TxQueueTimer ) == true ) ||
+        ( LoRaMacTxQueuePeek( &mcpsReq ) == false ) )
+    {
+        return;
+    }
+
+    status = LoRaMacMcpsRequest( &mcpsReq );
+    if( ( status == LORAMAC_STATUS_DUTYCYCLE_RESTRICTED ) && ( MacCtx.DutyCycleWaitTime != 0 ) )
+    {
+        // Keep the request, it is sent as soon as the duty cycle allows it
+        TimerSetValue( &MacCtx.TxQueueTimer, MacCtx.DutyCycleWaitTime );
+        TimerStart( &MacCtx.TxQueueTimer );
+        return;
+    }
+    LoRaMacTxQueueRemoveNext( );
+
+    if( status != LORAMAC_STATUS_OK )
+    {
+        // Every queued request ends with an MCPS-Confirm. The request may have
+        // failed after the MCPS-Confirm got partially filled, rebuild it from
+        // the failed request: nothing was sent, no retries, no time on air.
+        memset1( ( uint8_t* ) &MacCtx.McpsConfirm, 0, sizeof( MacCtx.McpsConfirm ) );
+        MacCtx.McpsConfirm.McpsRequest = mcpsReq.Type;
+        MacCtx.McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
+        MacCtx.McpsConfirm.Datarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
+        if( MacCtx.NvmCtx->AdrCtrlOn == false )
+        {
+            switch( mcpsReq.Type )
+            {
+                case MCPS_UNCONFIRMED:
+                    MacCtx.McpsConfirm.Datarate = mcpsReq.Req.Unconfirmed.Datarate;
+                    break;
+                case MCPS_CONFIRMED:
+                    MacCtx.McpsConfirm.Datarate = mcpsReq.Req.Confirmed.Datarate;
+                    break;
+                case MCPS_PROPRIETARY:
+                    MacCtx.McpsConfirm.Datarate = mcpsReq.Req.Proprietary.Datarate;
+                    break;
+                default:
+                    break;
+            }
+        }
+        MacCtx.McpsConfirm.TxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
+        MacCtx.MacPrimitives->MacMcpsConfirm( &MacCtx.McpsConfirm );
+    }
+}
+
 static void LoRaMacHandleMcpsRequest( void )
 {
     // Handle MCPS uplinks
@@ -1676,9 +2783,45 @@ void LoRaMacProcess( void )
         LoRaMacEnableRequests( LORAMAC_REQUEST_HANDLING_ON );
     }
     LoRaMacHandleIndicationEvents( );
-    if( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C )
+    LoRaMacHandleTxQueue( );
+    if( ( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C ) && ( MacCtx.RxCSniffState == RXC_SNIFF_STATE_IDLE ) )
     {
         OpenContinuousRxCWindow( );
+        // Prepare the decryption of the next downlink while idle
+        LoRaMacCryptoPrepareDownlinkKeystreams( MacCtx.NvmCtx->DevAddr );
+    }
+#if defined( TRACE_ENABLED )
+    if( MacCtx.MacState != TraceMacState )
+    {
+        TraceMacState = MacCtx.MacState;
+        TRACE( TRACE_ID_MAC_STATE, 0, 0, TraceMacState );
+    }
+#endif
+}
+
+static void OnRxCSniffTimerEvent( void* context )
+{
+    TimerStop( &MacCtx.RxCSniffTimer );
+
+    if( MacCtx.RxCSniffState == RXC_SNIFF_STATE_SLEEP )
+    {
+        // LoRaMacProcess starts the next channel activity detection
+        MacCtx.RxCSniffState = RXC_SNIFF_STATE_IDLE;
+    }
+
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    {
+        MacCtx.MacCallbacks->MacProcessNotify( );
+    }
+}
+
+static void OnTxQueueTimerEvent( void* context )
+{
+    TimerStop( &MacCtx.TxQueueTimer );
+
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->MacProcessNotify != NULL ) )
+    {
+        MacCtx.MacCallbacks->MacProcessNotify( );
     }
 }
 
@@ -1822,6 +2965,8 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
                 status = LoRaMacClassBSwitchClass( deviceClass );
                 if( status == LORAMAC_STATUS_OK )
                 {
+                    // The ping slots reconfigure the radio
+                    MacCtx.RxCPrepared = false;
                     MacCtx.NvmCtx->DeviceClass = deviceClass;
                 }
             }
@@ -1830,33 +2975,28 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
             {
                 MacCtx.NvmCtx->DeviceClass = deviceClass;
 
-                MacCtx.RxWindowCConfig = MacCtx.RxWindow2Config;
-                MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
+                // Set the NodeAckRequested indicator to default
+                MacCtx.NodeAckRequested = false;
 
-                for( int8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+                if( MacCtx.RxCPrepared == true )
                 {
-                    if( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.IsEnabled == true )
-                    // TODO: Check multicast channel device class.
-                    {
-                        MacCtx.NvmCtx->MacParams.RxCChannel.Frequency = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.RxParams.ClassC.Frequency;
-                        MacCtx.NvmCtx->MacParams.RxCChannel.Datarate = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.RxParams.ClassC.Datarate;
-
-                        MacCtx.RxWindowCConfig.Channel = MacCtx.Channel;
-                        MacCtx.RxWindowCConfig.Frequency = MacCtx.NvmCtx->MacParams.RxCChannel.Frequency;
-                        MacCtx.RxWindowCConfig.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
-                        MacCtx.RxWindowCConfig.RepeaterSupport = MacCtx.NvmCtx->RepeaterSupport;
-                        MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
-                        MacCtx.RxWindowCConfig.RxContinuous = true;
-                        break;
-                    }
+                    // LoRaMacClassCPrepare already woke the radio up with
+                    // the RxC window settings
+                    MacCtx.RxCPrepared = false;
+                    StartContinuousRxCWindow( );
                 }
+                else
+                {
+                    SetupRxCWindowChannel( );
 
-                // Set the NodeAckRequested indicator to default
-                MacCtx.NodeAckRequested = false;
-                // Set the radio into sleep mode in case we are still in RX mode
-                Radio.Sleep( );
+                    // Set the radio into sleep mode in case we are still in RX mode
+                    if( Radio.GetStatus( ) != RF_IDLE )
+                    {
+                        Radio.Sleep( );
+                    }
 
-                OpenContinuousRxCWindow( );
+                    OpenContinuousRxCWindow( );
+                }
 
                 status = LORAMAC_STATUS_OK;
             }
@@ -1878,6 +3018,7 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
                 MacCtx.NvmCtx->DeviceClass = deviceClass;
 
                 // Set the radio into sleep to setup a defined state
+                StopRxCSniff( );
                 Radio.Sleep( );
 
                 status = LORAMAC_STATUS_OK;
@@ -1889,24 +3030,29 @@ static LoRaMacStatus_t SwitchClass( DeviceClass_t deviceClass )
     return status;
 }
 
-static uint8_t GetMaxAppPayloadWithoutFOptsLength( int8_t datarate )
+static uint8_t GetMaxPayloadOfDatarate( uint8_t dwellTime, int8_t datarate )
 {
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
-
-    // Setup PHY request
-    getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-    getPhy.Datarate = datarate;
-    getPhy.Attribute = PHY_MAX_PAYLOAD;
+    const RegionPhyConsts_t* phyConsts = RegionGetPhyConsts( MacCtx.NvmCtx->Region );
+    uint8_t dwellIndex = ( dwellTime == 0 ) ? 0 : 1;
 
     // Get the maximum payload length
     if( MacCtx.NvmCtx->RepeaterSupport == true )
     {
-        getPhy.Attribute = PHY_MAX_PAYLOAD_REPEATER;
+        return phyConsts->MaxPayloadRepeater[dwellIndex][datarate];
     }
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    return phyConsts->MaxPayload[dwellIndex][datarate];
+}
+
+static int8_t GetMinTxDatarate( void )
+{
+    uint8_t dwellIndex = ( MacCtx.NvmCtx->MacParams.UplinkDwellTime == 0 ) ? 0 : 1;
+
+    return RegionGetPhyConsts( MacCtx.NvmCtx->Region )->MinTxDr[dwellIndex];
+}
 
-    return phyParam.Value;
+static uint8_t GetMaxAppPayloadWithoutFOptsLength( int8_t datarate )
+{
+    return GetMaxPayloadOfDatarate( MacCtx.NvmCtx->MacParams.UplinkDwellTime, datarate );
 }
 
 static bool ValidatePayloadLength( uint8_t lenN, int8_t datarate, uint8_t fOptsLen )
@@ -1932,314 +3078,374 @@ static void SetMlmeScheduleUplinkIndication( void )
     MacCtx.MacFlags.Bits.MlmeSchedUplinkInd = 1;
 }
 
-static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t commandsSize, int8_t snr, LoRaMacRxSlot_t rxSlot )
+/*!
+ * State shared by the MAC command handlers while a frame is processed
+ */
+typedef struct sMacCommandsRxCtx
 {
-    uint8_t status = 0;
-    bool adrBlockFound = false;
-    uint8_t macCmdPayload[2] = { 0x00, 0x00 };
+    /*!
+     * Buffer holding the MAC commands
+     */
+    uint8_t* Payload;
+    /*!
+     * Index of the next byte to parse, right after the CID of the command being processed
+     */
+    uint8_t Index;
+    /*!
+     * Size of the MAC commands
+     */
+    uint8_t Size;
+    /*!
+     * SNR of the received frame
+     */
+    int8_t Snr;
+    /*!
+     * Set to true once the first block of LinkAdrReq was processed
+     */
+    bool AdrBlockFound;
+    /*!
+     * Set to true when an answer requires an uplink to be scheduled
+     */
+    bool ScheduleUplink;
+}MacCommandsRxCtx_t;
+
+/*!
+ * MAC command handler, parses the command payload and queues its answer
+ */
+typedef void ( *MacCommandHandler_t )( MacCommandsRxCtx_t* ctx );
+
+/*!
+ * \brief Reads a 24 bits frequency field in steps of 100 Hz
+ */
+static uint32_t GetMacCommandFrequency( MacCommandsRxCtx_t* ctx )
+{
+    uint32_t frequency;
+
+    frequency = ( uint32_t )ctx->Payload[ctx->Index++];
+    frequency |= ( uint32_t )ctx->Payload[ctx->Index++] << 8;
+    frequency |= ( uint32_t )ctx->Payload[ctx->Index++] << 16;
+    return frequency * 100;
+}
 
-    while( macIndex < commandsSize )
+static void ProcessLinkCheckAns( MacCommandsRxCtx_t* ctx )
+{
+    LoRaMacAdrAddLinkMargin( ctx->Payload[ctx->Index] );
+    if( LoRaMacConfirmQueueIsCmdActive( MLME_LINK_CHECK ) == true )
     {
-        // Make sure to parse only complete MAC commands
-        if( ( LoRaMacCommandsGetCmdSize( payload[macIndex] ) + macIndex ) > commandsSize )
-        {
-            return;
-        }
+        LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_LINK_CHECK );
+        MacCtx.MlmeConfirm.DemodMargin = ctx->Payload[ctx->Index];
+        MacCtx.MlmeConfirm.NbGateways = ctx->Payload[ctx->Index + 1];
+    }
+    ctx->Index += 2;
+}
 
-        // Decode Frame MAC commands
-        switch( payload[macIndex++] )
-        {
-            case SRV_MAC_LINK_CHECK_ANS:
-            {
-                if( LoRaMacConfirmQueueIsCmdActive( MLME_LINK_CHECK ) == true )
-                {
-                    LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_LINK_CHECK );
-                    MacCtx.MlmeConfirm.DemodMargin = payload[macIndex++];
-                    MacCtx.MlmeConfirm.NbGateways = payload[macIndex++];
-                }
-                break;
-            }
-            case SRV_MAC_LINK_ADR_REQ:
-            {
-                LinkAdrReqParams_t linkAdrReq;
-                int8_t linkAdrDatarate = DR_0;
-                int8_t linkAdrTxPower = TX_POWER_0;
-                uint8_t linkAdrNbRep = 0;
-                uint8_t linkAdrNbBytesParsed = 0;
+static void ProcessLinkAdrReq( MacCommandsRxCtx_t* ctx )
+{
+    LinkAdrReqParams_t linkAdrReq;
+    int8_t linkAdrDatarate = DR_0;
+    int8_t linkAdrTxPower = TX_POWER_0;
+    uint8_t linkAdrNbRep = 0;
+    uint8_t linkAdrNbBytesParsed = 0;
+    uint8_t status;
 
-                if( adrBlockFound == false )
-                {
-                    adrBlockFound = true;
-
-                    // Fill parameter structure
-                    linkAdrReq.Payload = &payload[macIndex - 1];
-                    linkAdrReq.PayloadSize = commandsSize - ( macIndex - 1 );
-                    linkAdrReq.AdrEnabled = MacCtx.NvmCtx->AdrCtrlOn;
-                    linkAdrReq.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-                    linkAdrReq.CurrentDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
-                    linkAdrReq.CurrentTxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
-                    linkAdrReq.CurrentNbRep = MacCtx.NvmCtx->MacParams.ChannelsNbTrans;
-                    linkAdrReq.Version = MacCtx.NvmCtx->Version;
-
-                    // Process the ADR requests
-                    status = RegionLinkAdrReq( MacCtx.NvmCtx->Region, &linkAdrReq, &linkAdrDatarate,
-                                               &linkAdrTxPower, &linkAdrNbRep, &linkAdrNbBytesParsed );
-
-                    if( ( status & 0x07 ) == 0x07 )
-                    {
-                        MacCtx.NvmCtx->MacParams.ChannelsDatarate = linkAdrDatarate;
-                        MacCtx.NvmCtx->MacParams.ChannelsTxPower = linkAdrTxPower;
-                        MacCtx.NvmCtx->MacParams.ChannelsNbTrans = linkAdrNbRep;
-                    }
+    if( ctx->AdrBlockFound == true )
+    {
+        // Only the first contiguous block is processed
+        ctx->Index += LoRaMacCommandsGetCmdSize( SRV_MAC_LINK_ADR_REQ ) - 1;
+        return;
+    }
+    ctx->AdrBlockFound = true;
 
-                    // Add the answers to the buffer
-                    for( uint8_t i = 0; i < ( linkAdrNbBytesParsed / 5 ); i++ )
-                    {
-                        LoRaMacCommandsAddCmd( MOTE_MAC_LINK_ADR_ANS, &status, 1 );
-                    }
-                    // Update MAC index
-                    macIndex += linkAdrNbBytesParsed - 1;
-                }
-                break;
-            }
-            case SRV_MAC_DUTY_CYCLE_REQ:
-            {
-                MacCtx.NvmCtx->MaxDCycle = payload[macIndex++] & 0x0F;
-                MacCtx.NvmCtx->AggregatedDCycle = 1 << MacCtx.NvmCtx->MaxDCycle;
-                LoRaMacCommandsAddCmd( MOTE_MAC_DUTY_CYCLE_ANS, macCmdPayload, 0 );
-                break;
-            }
-            case SRV_MAC_RX_PARAM_SETUP_REQ:
-            {
-                RxParamSetupReqParams_t rxParamSetupReq;
-                status = 0x07;
+    // Fill parameter structure
+    linkAdrReq.Payload = &ctx->Payload[ctx->Index - 1];
+    linkAdrReq.PayloadSize = ctx->Size - ( ctx->Index - 1 );
+    linkAdrReq.AdrEnabled = MacCtx.NvmCtx->AdrCtrlOn;
+    linkAdrReq.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+    linkAdrReq.CurrentDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
+    linkAdrReq.CurrentTxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
+    linkAdrReq.CurrentNbRep = MacCtx.NvmCtx->MacParams.ChannelsNbTrans;
+    linkAdrReq.Version = MacCtx.NvmCtx->Version;
 
-                rxParamSetupReq.DrOffset = ( payload[macIndex] >> 4 ) & 0x07;
-                rxParamSetupReq.Datarate = payload[macIndex] & 0x0F;
-                macIndex++;
+    // Process the ADR requests
+    status = RegionLinkAdrReq( MacCtx.NvmCtx->Region, &linkAdrReq, &linkAdrDatarate,
+                               &linkAdrTxPower, &linkAdrNbRep, &linkAdrNbBytesParsed );
 
-                rxParamSetupReq.Frequency = ( uint32_t ) payload[macIndex++];
-                rxParamSetupReq.Frequency |= ( uint32_t ) payload[macIndex++] << 8;
-                rxParamSetupReq.Frequency |= ( uint32_t ) payload[macIndex++] << 16;
-                rxParamSetupReq.Frequency *= 100;
+    if( ( status & 0x07 ) == 0x07 )
+    {
+        MacCtx.NvmCtx->MacParams.ChannelsDatarate = linkAdrDatarate;
+        MacCtx.NvmCtx->MacParams.ChannelsTxPower = linkAdrTxPower;
+        MacCtx.NvmCtx->MacParams.ChannelsNbTrans = linkAdrNbRep;
+    }
 
-                // Perform request on region
-                status = RegionRxParamSetupReq( MacCtx.NvmCtx->Region, &rxParamSetupReq );
+    // Add the answers to the buffer
+    for( uint8_t i = 0; i < ( linkAdrNbBytesParsed / 5 ); i++ )
+    {
+        LoRaMacCommandsAddCmd( MOTE_MAC_LINK_ADR_ANS, &status, 1 );
+    }
+    // Update MAC index
+    ctx->Index += linkAdrNbBytesParsed - 1;
+}
 
-                if( ( status & 0x07 ) == 0x07 )
-                {
-                    MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate = rxParamSetupReq.Datarate;
-                    MacCtx.NvmCtx->MacParams.RxCChannel.Datarate = rxParamSetupReq.Datarate;
-                    MacCtx.NvmCtx->MacParams.Rx2Channel.Frequency = rxParamSetupReq.Frequency;
-                    MacCtx.NvmCtx->MacParams.RxCChannel.Frequency = rxParamSetupReq.Frequency;
-                    MacCtx.NvmCtx->MacParams.Rx1DrOffset = rxParamSetupReq.DrOffset;
-                }
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_RX_PARAM_SETUP_ANS, macCmdPayload, 1 );
-                // Setup indication to inform the application
-                SetMlmeScheduleUplinkIndication( );
-                break;
-            }
-            case SRV_MAC_DEV_STATUS_REQ:
-            {
-                uint8_t batteryLevel = BAT_LEVEL_NO_MEASURE;
-                if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->GetBatteryLevel != NULL ) )
-                {
-                    batteryLevel = MacCtx.MacCallbacks->GetBatteryLevel( );
-                }
-                macCmdPayload[0] = batteryLevel;
-                macCmdPayload[1] = ( uint8_t )( snr & 0x3F );
-                LoRaMacCommandsAddCmd( MOTE_MAC_DEV_STATUS_ANS, macCmdPayload, 2 );
-                break;
-            }
-            case SRV_MAC_NEW_CHANNEL_REQ:
-            {
-                NewChannelReqParams_t newChannelReq;
-                ChannelParams_t chParam;
-                status = 0x03;
+static void ProcessDutyCycleReq( MacCommandsRxCtx_t* ctx )
+{
+    uint8_t macCmdPayload[1] = { 0x00 };
 
-                newChannelReq.ChannelId = payload[macIndex++];
-                newChannelReq.NewChannel = &chParam;
+    MacCtx.NvmCtx->MaxDCycle = ctx->Payload[ctx->Index++] & 0x0F;
+    MacCtx.NvmCtx->AggregatedDCycle = 1 << MacCtx.NvmCtx->MaxDCycle;
+    LoRaMacCommandsAddCmd( MOTE_MAC_DUTY_CYCLE_ANS, macCmdPayload, 0 );
+}
 
-                chParam.Frequency = ( uint32_t ) payload[macIndex++];
-                chParam.Frequency |= ( uint32_t ) payload[macIndex++] << 8;
-                chParam.Frequency |= ( uint32_t ) payload[macIndex++] << 16;
-                chParam.Frequency *= 100;
-                chParam.Rx1Frequency = 0;
-                chParam.DrRange.Value = payload[macIndex++];
+static void ProcessRxParamSetupReq( MacCommandsRxCtx_t* ctx )
+{
+    RxParamSetupReqParams_t rxParamSetupReq;
+    uint8_t status;
 
-                status = RegionNewChannelReq( MacCtx.NvmCtx->Region, &newChannelReq );
+    rxParamSetupReq.DrOffset = ( ctx->Payload[ctx->Index] >> 4 ) & 0x07;
+    rxParamSetupReq.Datarate = ctx->Payload[ctx->Index] & 0x0F;
+    ctx->Index++;
+    rxParamSetupReq.Frequency = GetMacCommandFrequency( ctx );
 
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_NEW_CHANNEL_ANS, macCmdPayload, 1 );
-                break;
-            }
-            case SRV_MAC_RX_TIMING_SETUP_REQ:
-            {
-                uint8_t delay = payload[macIndex++] & 0x0F;
+    // Perform request on region
+    status = RegionRxParamSetupReq( MacCtx.NvmCtx->Region, &rxParamSetupReq );
 
-                if( delay == 0 )
-                {
-                    delay++;
-                }
-                MacCtx.NvmCtx->MacParams.ReceiveDelay1 = delay * 1000;
-                MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay1 + 1000;
-                LoRaMacCommandsAddCmd( MOTE_MAC_RX_TIMING_SETUP_ANS, macCmdPayload, 0 );
-                // Setup indication to inform the application
-                SetMlmeScheduleUplinkIndication( );
-                break;
-            }
-            case SRV_MAC_TX_PARAM_SETUP_REQ:
-            {
-                TxParamSetupReqParams_t txParamSetupReq;
-                GetPhyParams_t getPhy;
-                PhyParam_t phyParam;
-                uint8_t eirpDwellTime = payload[macIndex++];
+    if( ( status & 0x07 ) == 0x07 )
+    {
+        MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate = rxParamSetupReq.Datarate;
+        MacCtx.NvmCtx->MacParams.RxCChannel.Datarate = rxParamSetupReq.Datarate;
+        MacCtx.NvmCtx->MacParams.Rx2Channel.Frequency = rxParamSetupReq.Frequency;
+        MacCtx.NvmCtx->MacParams.RxCChannel.Frequency = rxParamSetupReq.Frequency;
+        MacCtx.NvmCtx->MacParams.Rx1DrOffset = rxParamSetupReq.DrOffset;
+    }
+    LoRaMacCommandsAddCmd( MOTE_MAC_RX_PARAM_SETUP_ANS, &status, 1 );
+    ctx->ScheduleUplink = true;
+}
 
-                txParamSetupReq.UplinkDwellTime = 0;
-                txParamSetupReq.DownlinkDwellTime = 0;
+static void ProcessDevStatusReq( MacCommandsRxCtx_t* ctx )
+{
+    uint8_t macCmdPayload[2];
+    uint8_t batteryLevel = BAT_LEVEL_NO_MEASURE;
 
-                if( ( eirpDwellTime & 0x20 ) == 0x20 )
-                {
-                    txParamSetupReq.DownlinkDwellTime = 1;
-                }
-                if( ( eirpDwellTime & 0x10 ) == 0x10 )
-                {
-                    txParamSetupReq.UplinkDwellTime = 1;
-                }
-                txParamSetupReq.MaxEirp = eirpDwellTime & 0x0F;
+    if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->GetBatteryLevel != NULL ) )
+    {
+        batteryLevel = MacCtx.MacCallbacks->GetBatteryLevel( );
+    }
+    macCmdPayload[0] = batteryLevel;
+    macCmdPayload[1] = ( uint8_t )( ctx->Snr & 0x3F );
+    LoRaMacCommandsAddCmd( MOTE_MAC_DEV_STATUS_ANS, macCmdPayload, 2 );
+}
 
-                // Check the status for correctness
-                if( RegionTxParamSetupReq( MacCtx.NvmCtx->Region, &txParamSetupReq ) != -1 )
-                {
-                    // Accept command
-                    MacCtx.NvmCtx->MacParams.UplinkDwellTime = txParamSetupReq.UplinkDwellTime;
-                    MacCtx.NvmCtx->MacParams.DownlinkDwellTime = txParamSetupReq.DownlinkDwellTime;
-                    MacCtx.NvmCtx->MacParams.MaxEirp = LoRaMacMaxEirpTable[txParamSetupReq.MaxEirp];
-                    // Update the datarate in case of the new configuration limits it
-                    getPhy.Attribute = PHY_MIN_TX_DR;
-                    getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-                    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-                    MacCtx.NvmCtx->MacParams.ChannelsDatarate = MAX( MacCtx.NvmCtx->MacParams.ChannelsDatarate, ( int8_t )phyParam.Value );
-
-                    // Add command response
-                    LoRaMacCommandsAddCmd( MOTE_MAC_TX_PARAM_SETUP_ANS, macCmdPayload, 0 );
-                }
-                break;
-            }
-            case SRV_MAC_DL_CHANNEL_REQ:
-            {
-                DlChannelReqParams_t dlChannelReq;
-                status = 0x03;
-
-                dlChannelReq.ChannelId = payload[macIndex++];
-                dlChannelReq.Rx1Frequency = ( uint32_t ) payload[macIndex++];
-                dlChannelReq.Rx1Frequency |= ( uint32_t ) payload[macIndex++] << 8;
-                dlChannelReq.Rx1Frequency |= ( uint32_t ) payload[macIndex++] << 16;
-                dlChannelReq.Rx1Frequency *= 100;
-
-                status = RegionDlChannelReq( MacCtx.NvmCtx->Region, &dlChannelReq );
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_DL_CHANNEL_ANS, macCmdPayload, 1 );
-                // Setup indication to inform the application
-                SetMlmeScheduleUplinkIndication( );
-                break;
-            }
-            case SRV_MAC_DEVICE_TIME_ANS:
-            {
-                SysTime_t gpsEpochTime = { 0 };
-                SysTime_t sysTime = { 0 };
-                SysTime_t sysTimeCurrent = { 0 };
-
-                gpsEpochTime.Seconds = ( uint32_t )payload[macIndex++];
-                gpsEpochTime.Seconds |= ( uint32_t )payload[macIndex++] << 8;
-                gpsEpochTime.Seconds |= ( uint32_t )payload[macIndex++] << 16;
-                gpsEpochTime.Seconds |= ( uint32_t )payload[macIndex++] << 24;
-                gpsEpochTime.SubSeconds = payload[macIndex++];
-
-                // Convert the fractional second received in ms
-                // round( pow( 0.5, 8.0 ) * 1000 ) = 3.90625
-                gpsEpochTime.SubSeconds = ( int16_t )( ( ( int32_t )gpsEpochTime.SubSeconds * 1000 ) >> 8 );
-
-                // Copy received GPS Epoch time into system time
-                sysTime = gpsEpochTime;
-                // Add Unix to Gps epcoh offset. The system time is based on Unix time.
-                sysTime.Seconds += UNIX_GPS_EPOCH_OFFSET;
-
-                // Compensate time difference between Tx Done time and now
-                sysTimeCurrent = SysTimeGet( );
-                sysTime = SysTimeAdd( sysTimeCurrent, SysTimeSub( sysTime, MacCtx.LastTxSysTime ) );
-
-                // Apply the new system time.
-                SysTimeSet( sysTime );
-                LoRaMacClassBDeviceTimeAns( );
-                MacCtx.McpsIndication.DeviceTimeAnsReceived = true;
-                break;
-            }
-            case SRV_MAC_PING_SLOT_INFO_ANS:
-            {
-                // According to the specification, it is not allowed to process this answer in
-                // a ping or multicast slot
-                if( ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_PING_SLOT ) && ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT ) )
-                {
-                    LoRaMacClassBPingSlotInfoAns( );
-                }
-                break;
-            }
-            case SRV_MAC_PING_SLOT_CHANNEL_REQ:
-            {
-                uint8_t status = 0x03;
-                uint32_t frequency = 0;
-                uint8_t datarate;
-
-                frequency = ( uint32_t )payload[macIndex++];
-                frequency |= ( uint32_t )payload[macIndex++] << 8;
-                frequency |= ( uint32_t )payload[macIndex++] << 16;
-                frequency *= 100;
-                datarate = payload[macIndex++] & 0x0F;
-
-                status = LoRaMacClassBPingSlotChannelReq( datarate, frequency );
-                macCmdPayload[0] = status;
-                LoRaMacCommandsAddCmd( MOTE_MAC_PING_SLOT_FREQ_ANS, macCmdPayload, 1 );
-                break;
-            }
-            case SRV_MAC_BEACON_TIMING_ANS:
-            {
-                uint16_t beaconTimingDelay = 0;
-                uint8_t beaconTimingChannel = 0;
+static void ProcessNewChannelReq( MacCommandsRxCtx_t* ctx )
+{
+    NewChannelReqParams_t newChannelReq;
+    ChannelParams_t chParam;
+    uint8_t status;
 
-                beaconTimingDelay = ( uint16_t )payload[macIndex++];
-                beaconTimingDelay |= ( uint16_t )payload[macIndex++] << 8;
-                beaconTimingChannel = payload[macIndex++];
+    newChannelReq.ChannelId = ctx->Payload[ctx->Index++];
+    newChannelReq.NewChannel = &chParam;
 
-                LoRaMacClassBBeaconTimingAns( beaconTimingDelay, beaconTimingChannel, RxDoneParams.LastRxDone );
-                break;
-            }
-            case SRV_MAC_BEACON_FREQ_REQ:
-                {
-                    uint32_t frequency = 0;
+    chParam.Frequency = GetMacCommandFrequency( ctx );
+    chParam.Rx1Frequency = 0;
+    chParam.DrRange.Value = ctx->Payload[ctx->Index++];
 
-                    frequency = ( uint32_t )payload[macIndex++];
-                    frequency |= ( uint32_t )payload[macIndex++] << 8;
-                    frequency |= ( uint32_t )payload[macIndex++] << 16;
-                    frequency *= 100;
+    status = RegionNewChannelReq( MacCtx.NvmCtx->Region, &newChannelReq );
+    LoRaMacCommandsAddCmd( MOTE_MAC_NEW_CHANNEL_ANS, &status, 1 );
+}
 
-                    if( LoRaMacClassBBeaconFreqReq( frequency ) == true )
-                    {
-                        macCmdPayload[0] = 1;
-                    }
-                    else
-                    {
-                        macCmdPayload[0] = 0;
-                    }
-                    LoRaMacCommandsAddCmd( MOTE_MAC_BEACON_FREQ_ANS, macCmdPayload, 1 );
-                }
-                break;
-            default:
-                // Unknown command. ABORT MAC commands processing
-                return;
+static void ProcessRxTimingSetupReq( MacCommandsRxCtx_t* ctx )
+{
+    uint8_t macCmdPayload[1] = { 0x00 };
+    uint8_t delay = ctx->Payload[ctx->Index++] & 0x0F;
+
+    if( delay == 0 )
+    {
+        delay++;
+    }
+    MacCtx.NvmCtx->MacParams.ReceiveDelay1 = delay * 1000;
+    MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay1 + 1000;
+    LoRaMacCommandsAddCmd( MOTE_MAC_RX_TIMING_SETUP_ANS, macCmdPayload, 0 );
+    ctx->ScheduleUplink = true;
+}
+
+static void ProcessTxParamSetupReq( MacCommandsRxCtx_t* ctx )
+{
+    TxParamSetupReqParams_t txParamSetupReq;
+    uint8_t macCmdPayload[1] = { 0x00 };
+    uint8_t eirpDwellTime = ctx->Payload[ctx->Index++];
+
+    txParamSetupReq.UplinkDwellTime = 0;
+    txParamSetupReq.DownlinkDwellTime = 0;
+
+    if( ( eirpDwellTime & 0x20 ) == 0x20 )
+    {
+        txParamSetupReq.DownlinkDwellTime = 1;
+    }
+    if( ( eirpDwellTime & 0x10 ) == 0x10 )
+    {
+        txParamSetupReq.UplinkDwellTime = 1;
+    }
+    txParamSetupReq.MaxEirp = eirpDwellTime & 0x0F;
+
+    // Check the status for correctness
+    if( RegionTxParamSetupReq( MacCtx.NvmCtx->Region, &txParamSetupReq ) != -1 )
+    {
+        // Accept command
+        MacCtx.NvmCtx->MacParams.UplinkDwellTime = txParamSetupReq.UplinkDwellTime;
+        MacCtx.NvmCtx->MacParams.DownlinkDwellTime = txParamSetupReq.DownlinkDwellTime;
+        MacCtx.NvmCtx->MacParams.MaxEirp = LoRaMacMaxEirpTable[txParamSetupReq.MaxEirp];
+        // Update the datarate in case of the new configuration limits it
+        MacCtx.NvmCtx->MacParams.ChannelsDatarate = MAX( MacCtx.NvmCtx->MacParams.ChannelsDatarate, GetMinTxDatarate( ) );
+
+        // Add command response
+        LoRaMacCommandsAddCmd( MOTE_MAC_TX_PARAM_SETUP_ANS, macCmdPayload, 0 );
+    }
+}
+
+static void ProcessDlChannelReq( MacCommandsRxCtx_t* ctx )
+{
+    DlChannelReqParams_t dlChannelReq;
+    uint8_t status;
+
+    dlChannelReq.ChannelId = ctx->Payload[ctx->Index++];
+    dlChannelReq.Rx1Frequency = GetMacCommandFrequency( ctx );
+
+    status = RegionDlChannelReq( MacCtx.NvmCtx->Region, &dlChannelReq );
+    LoRaMacCommandsAddCmd( MOTE_MAC_DL_CHANNEL_ANS, &status, 1 );
+    ctx->ScheduleUplink = true;
+}
+
+static void ProcessDeviceTimeAns( MacCommandsRxCtx_t* ctx )
+{
+    SysTime_t gpsEpochTime = { 0 };
+    SysTime_t sysTime = { 0 };
+    SysTime_t sysTimeCurrent = { 0 };
+
+    gpsEpochTime.Seconds = ( uint32_t )ctx->Payload[ctx->Index++];
+    gpsEpochTime.Seconds |= ( uint32_t )ctx->Payload[ctx->Index++] << 8;
+    gpsEpochTime.Seconds |= ( uint32_t )ctx->Payload[ctx->Index++] << 16;
+    gpsEpochTime.Seconds |= ( uint32_t )ctx->Payload[ctx->Index++] << 24;
+    gpsEpochTime.SubSeconds = ctx->Payload[ctx->Index++];
+
+    // The system time is based on Unix time, the fractional second is received in 1/256 s
+    sysTime = SysTimeFromGps( gpsEpochTime.Seconds, ( uint8_t )gpsEpochTime.SubSeconds );
+
+    // Compensate time difference between Tx Done time and now
+    sysTimeCurrent = SysTimeGet( );
+    sysTime = SysTimeAdd( sysTimeCurrent, SysTimeSub( sysTime, MacCtx.LastTxSysTime ) );
+    UpdateRxErrorDrift( SysTimeSub( sysTime, sysTimeCurrent ) );
+
+    // Apply the new system time.
+    SysTimeSet( sysTime );
+    LoRaMacClassBDeviceTimeAns( );
+    MacCtx.McpsIndication.DeviceTimeAnsReceived = true;
+}
+
+static void ProcessPingSlotInfoAns( MacCommandsRxCtx_t* ctx )
+{
+    // According to the specification, it is not allowed to process this answer in
+    // a ping or multicast slot
+    if( ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_PING_SLOT ) && ( MacCtx.RxSlot != RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT ) )
+    {
+        LoRaMacClassBPingSlotInfoAns( );
+    }
+}
+
+static void ProcessPingSlotChannelReq( MacCommandsRxCtx_t* ctx )
+{
+    uint8_t status;
+    uint32_t frequency;
+    uint8_t datarate;
+
+    frequency = GetMacCommandFrequency( ctx );
+    datarate = ctx->Payload[ctx->Index++] & 0x0F;
+
+    status = LoRaMacClassBPingSlotChannelReq( datarate, frequency );
+    LoRaMacCommandsAddCmd( MOTE_MAC_PING_SLOT_FREQ_ANS, &status, 1 );
+}
+
+static void ProcessBeaconTimingAns( MacCommandsRxCtx_t* ctx )
+{
+    uint16_t beaconTimingDelay = 0;
+    uint8_t beaconTimingChannel = 0;
+
+    beaconTimingDelay = ( uint16_t )ctx->Payload[ctx->Index++];
+    beaconTimingDelay |= ( uint16_t )ctx->Payload[ctx->Index++] << 8;
+    beaconTimingChannel = ctx->Payload[ctx->Index++];
+
+    LoRaMacClassBBeaconTimingAns( beaconTimingDelay, beaconTimingChannel, RxDoneParams.LastRxDone );
+}
+
+static void ProcessBeaconFreqReq( MacCommandsRxCtx_t* ctx )
+{
+    uint8_t macCmdPayload[1] = { 0x00 };
+
+    if( LoRaMacClassBBeaconFreqReq( GetMacCommandFrequency( ctx ) ) == true )
+    {
+        macCmdPayload[0] = 1;
+    }
+    LoRaMacCommandsAddCmd( MOTE_MAC_BEACON_FREQ_ANS, macCmdPayload, 1 );
+}
+
+/*!
+ * Downlink MAC command handlers indexed by CID. The command lengths are
+ * given by \ref LoRaMacCommandsGetCmdSize
+ */
+static const MacCommandHandler_t MacCommandHandlers[] =
+{
+    [SRV_MAC_LINK_CHECK_ANS]        = ProcessLinkCheckAns,
+    [SRV_MAC_LINK_ADR_REQ]          = ProcessLinkAdrReq,
+    [SRV_MAC_DUTY_CYCLE_REQ]        = ProcessDutyCycleReq,
+    [SRV_MAC_RX_PARAM_SETUP_REQ]    = ProcessRxParamSetupReq,
+    [SRV_MAC_DEV_STATUS_REQ]        = ProcessDevStatusReq,
+    [SRV_MAC_NEW_CHANNEL_REQ]       = ProcessNewChannelReq,
+    [SRV_MAC_RX_TIMING_SETUP_REQ]   = ProcessRxTimingSetupReq,
+    [SRV_MAC_TX_PARAM_SETUP_REQ]    = ProcessTxParamSetupReq,
+    [SRV_MAC_DL_CHANNEL_REQ]        = ProcessDlChannelReq,
+    [SRV_MAC_DEVICE_TIME_ANS]       = ProcessDeviceTimeAns,
+    [SRV_MAC_PING_SLOT_INFO_ANS]    = ProcessPingSlotInfoAns,
+    [SRV_MAC_PING_SLOT_CHANNEL_REQ] = ProcessPingSlotChannelReq,
+    [SRV_MAC_BEACON_TIMING_ANS]     = ProcessBeaconTimingAns,
+    [SRV_MAC_BEACON_FREQ_REQ]       = ProcessBeaconFreqReq,
+};
+
+static void ProcessMacCommands( uint8_t *payload, uint8_t macIndex, uint8_t commandsSize, int8_t snr, LoRaMacRxSlot_t rxSlot )
+{
+    MacCommandsRxCtx_t ctx = { .Payload = payload, .Index = macIndex, .Size = commandsSize, .Snr = snr, .AdrBlockFound = false, .ScheduleUplink = false };
+    MacCommandHandler_t handler;
+    uint8_t cid;
+
+    // Collect the NVM context changes of the whole frame
+    MacCtx.NvmCtxEventsDeferred = true;
+
+    while( ctx.Index < commandsSize )
+    {
+        cid = payload[ctx.Index];
+
+        // Make sure to parse only complete MAC commands
+        if( ( LoRaMacCommandsGetCmdSize( cid ) + ctx.Index ) > commandsSize )
+        {
+            break;
+        }
+
+        handler = NULL;
+        if( cid < ( sizeof( MacCommandHandlers ) / sizeof( MacCommandHandlers[0] ) ) )
+        {
+            handler = MacCommandHandlers[cid];
+        }
+        if( handler == NULL )
+        {
+            // Unknown command. ABORT MAC commands processing
+            break;
         }
+        ctx.Index++;
+        handler( &ctx );
     }
+
+    if( ctx.ScheduleUplink == true )
+    {
+        // Setup indication to inform the application
+        SetMlmeScheduleUplinkIndication( );
+    }
+    FlushNvmCtxEvents( );
 }
 
 LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uint16_t fBufferSize )
@@ -2319,10 +3525,19 @@ LoRaMacStatus_t Send( LoRaMacHeader_t* macHdr, uint8_t fPort, void* fBuffer, uin
         // Good case
         MacCtx.NvmCtx->SrvAckRequested = false;
         MacCtx.NvmCtx->AdrAckCounter = adrAckCounter;
-        // Remove all none sticky MAC commands
-        if( LoRaMacCommandsRemoveNoneStickyCmds( ) != LORAMAC_COMMANDS_SUCCESS )
+        if( MacCtx.MacCommandsDeferred == true )
         {
-            return LORAMAC_STATUS_MAC_COMMAD_ERROR;
+            // The MAC commands were not sent, they wait for the next uplink
+            MacCtx.MacCommandsDeferCounter++;
+        }
+        else
+        {
+            MacCtx.MacCommandsDeferCounter = 0;
+            // Remove all none sticky MAC commands
+            if( LoRaMacCommandsRemoveNoneStickyCmds( ) != LORAMAC_COMMANDS_SUCCESS )
+            {
+                return LORAMAC_STATUS_MAC_COMMAD_ERROR;
+            }
         }
     }
     return status;
@@ -2418,9 +3633,29 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
         nextChan.Joined = true;
     }
     nextChan.LastAggrTx = MacCtx.NvmCtx->LastTxDoneTime;
+    nextChan.ChannelStats = NULL;
+    nextChan.NbChannelStats = 0;
+    nextChan.AvoidChannel = REGION_CHANNEL_NONE;
+    if( ( MacCtx.ChannelsWeighting == true ) || ( LoRaMacAdrGetRetryDiversity( ) == true ) )
+    {
+        nextChan.ChannelStats = LoRaMacAdrGetChannelStats( );
+        nextChan.NbChannelStats = LORAMAC_CHANNELS_STATS_SIZE;
+    }
+    if( ( LoRaMacAdrGetRetryDiversity( ) == true ) && ( MacCtx.NodeAckRequested == true ) &&
+        ( MacCtx.AckTimeoutRetriesCounter > 1 ) )
+    {
+        // Retries of a confirmed uplink change the channel
+        nextChan.AvoidChannel = MacCtx.Channel;
+    }
+    if( IsUnconfirmedRepetition( ) == true )
+    {
+        // Repetitions of an unconfirmed uplink change the channel
+        nextChan.AvoidChannel = MacCtx.Channel;
+    }
 
     // Select channel
     status = RegionNextChannel( MacCtx.NvmCtx->Region, &nextChan, &MacCtx.Channel, &dutyCycleTimeOff, &MacCtx.NvmCtx->AggregatedTimeOff );
+    MacCtx.DutyCycleWaitTime = dutyCycleTimeOff;
 
     if( status != LORAMAC_STATUS_OK )
     {
@@ -2447,19 +3682,19 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
     RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
                                      RegionApplyDrOffset( MacCtx.NvmCtx->Region, MacCtx.NvmCtx->MacParams.DownlinkDwellTime, MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.NvmCtx->MacParams.Rx1DrOffset ),
                                      MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                     GetRxWindowRxError( ),
                                      &MacCtx.RxWindow1Config );
     // Compute Rx2 windows parameters
     RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
                                      MacCtx.NvmCtx->MacParams.Rx2Channel.Datarate,
                                      MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                     GetRxWindowRxError( ),
                                      &MacCtx.RxWindow2Config );
 
     if( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE )
     {
-        MacCtx.RxWindow1Delay = MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 + MacCtx.RxWindow1Config.WindowOffset;
-        MacCtx.RxWindow2Delay = MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 + MacCtx.RxWindow2Config.WindowOffset;
+        MacCtx.RxWindow1DelayUs = ( MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 * 1000 ) + MacCtx.RxWindow1Config.WindowOffset;
+        MacCtx.RxWindow2DelayUs = ( MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 * 1000 ) + MacCtx.RxWindow2Config.WindowOffset;
     }
     else
     {
@@ -2468,19 +3703,27 @@ static LoRaMacStatus_t ScheduleTx( bool allowDelayedTx )
             return LORAMAC_STATUS_MAC_COMMAD_ERROR;
         }
 
+        if( MacCtx.MacCommandsDeferred == true )
+        {
+            macCmdsSize = 0;
+        }
         if( ValidatePayloadLength( MacCtx.AppDataSize, MacCtx.NvmCtx->MacParams.ChannelsDatarate, macCmdsSize ) == false )
         {
             return LORAMAC_STATUS_LENGTH_ERROR;
         }
-        MacCtx.RxWindow1Delay = MacCtx.NvmCtx->MacParams.ReceiveDelay1 + MacCtx.RxWindow1Config.WindowOffset;
-        MacCtx.RxWindow2Delay = MacCtx.NvmCtx->MacParams.ReceiveDelay2 + MacCtx.RxWindow2Config.WindowOffset;
+        MacCtx.RxWindow1DelayUs = ( MacCtx.NvmCtx->MacParams.ReceiveDelay1 * 1000 ) + MacCtx.RxWindow1Config.WindowOffset;
+        MacCtx.RxWindow2DelayUs = ( MacCtx.NvmCtx->MacParams.ReceiveDelay2 * 1000 ) + MacCtx.RxWindow2Config.WindowOffset;
     }
 
-    // Secure frame
-    LoRaMacStatus_t retval = SecureFrame( MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.Channel );
-    if( retval != LORAMAC_STATUS_OK )
+    // Secure frame. The repetitions of a LoRaWAN 1.0.x frame reuse it, its
+    // MIC does not depend on the channel and datarate.
+    if( ( IsUnconfirmedRepetition( ) == false ) || ( MacCtx.NvmCtx->Version.Fields.Minor != 0 ) )
     {
-        return retval;
+        LoRaMacStatus_t retval = SecureFrame( MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.Channel );
+        if( retval != LORAMAC_STATUS_OK )
+        {
+            return retval;
+        }
     }
 
     // Try to send now
@@ -2514,7 +3757,11 @@ static LoRaMacStatus_t SecureFrame( uint8_t txDr, uint8_t txCh )
                 fCntUp -= 1;
             }
 
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+            uint32_t cryptoStart = LORAMAC_LATENCY_TIMESTAMP( );
+#endif
             macCryptoStatus = LoRaMacCryptoSecureMessage( fCntUp, txDr, txCh, &MacCtx.TxMsg.Message.Data );
+            LATENCY_UPDATE( TxCrypto, LORAMAC_LATENCY_TIMESTAMP( ) - cryptoStart );
             if( LORAMAC_CRYPTO_SUCCESS != macCryptoStatus )
             {
                 return LORAMAC_STATUS_CRYPTO_ERROR;
@@ -2580,6 +3827,100 @@ static void RemoveMacCommands( LoRaMacRxSlot_t rxSlot, LoRaMacFrameCtrl_t fCtrl,
 }
 
 
+static void InitRegionDefaults( void )
+{
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+
+    // Reset to defaults
+    getPhy.Attribute = PHY_DUTY_CYCLE;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->DutyCycleOn = ( bool ) phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_TX_POWER;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_TX_DR;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate = phyParam.Value;
+
+    getPhy.Attribute = PHY_MAX_RX_WINDOW;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow = phyParam.Value;
+
+    getPhy.Attribute = PHY_RECEIVE_DELAY1;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1 = phyParam.Value;
+
+    getPhy.Attribute = PHY_RECEIVE_DELAY2;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2 = phyParam.Value;
+
+    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY1;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1 = phyParam.Value;
+
+    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY2;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2 = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_DR1_OFFSET;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.Rx1DrOffset = phyParam.Value;
+
+    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Frequency = RegionGetPhyConsts( MacCtx.NvmCtx->Region )->DefRx2Frequency;
+    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Frequency = RegionGetPhyConsts( MacCtx.NvmCtx->Region )->DefRx2Frequency;
+    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Datarate = RegionGetPhyConsts( MacCtx.NvmCtx->Region )->DefRx2Dr;
+    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Datarate = RegionGetPhyConsts( MacCtx.NvmCtx->Region )->DefRx2Dr;
+
+    getPhy.Attribute = PHY_DEF_UPLINK_DWELL_TIME;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.UplinkDwellTime = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_DOWNLINK_DWELL_TIME;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.DownlinkDwellTime = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_MAX_EIRP;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.MaxEirp = phyParam.fValue;
+
+    getPhy.Attribute = PHY_DEF_ANTENNA_GAIN;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.NvmCtx->MacParamsDefaults.AntennaGain = phyParam.fValue;
+
+    getPhy.Attribute = PHY_DEF_ADR_ACK_LIMIT;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.AdrAckLimit = phyParam.Value;
+
+    getPhy.Attribute = PHY_DEF_ADR_ACK_DELAY;
+    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+    MacCtx.AdrAckDelay = phyParam.Value;
+
+    // Init parameters which are not set in function ResetMacParameters
+    MacCtx.NvmCtx->MacParamsDefaults.ChannelsNbTrans = 1;
+    MacCtx.NvmCtx->MacParamsDefaults.SystemMaxRxError = 10;
+    MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols = 6;
+    MacCtx.NvmCtx->MacParamsDefaults.RxCDutyCycle.RxTime = 0;
+    MacCtx.NvmCtx->MacParamsDefaults.RxCDutyCycle.SleepTime = 0;
+
+    MacCtx.NvmCtx->MacParams.SystemMaxRxError = MacCtx.NvmCtx->MacParamsDefaults.SystemMaxRxError;
+    MacCtx.NvmCtx->MacParams.MinRxSymbols = MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols;
+    MacCtx.NvmCtx->MacParams.RxCDutyCycle = MacCtx.NvmCtx->MacParamsDefaults.RxCDutyCycle;
+    MacCtx.NvmCtx->MacParams.MaxRxWindow = MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow;
+    MacCtx.NvmCtx->MacParams.ReceiveDelay1 = MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1;
+    MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2;
+    MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 = MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1;
+    MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 = MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2;
+    MacCtx.NvmCtx->MacParams.ChannelsNbTrans = MacCtx.NvmCtx->MacParamsDefaults.ChannelsNbTrans;
+
+    InitDefaultsParams_t params;
+    params.Type = INIT_TYPE_BANDS;
+    params.RestoreCtx = NULL;
+    RegionInitDefaults( MacCtx.NvmCtx->Region, &params );
+}
+
 static void ResetMacParameters( void )
 {
     MacCtx.NvmCtx->NetworkActivation = ACTIVATION_TYPE_NONE;
@@ -2611,7 +3952,7 @@ static void ResetMacParameters( void )
     // Reset to application defaults
     InitDefaultsParams_t params;
     params.Type = INIT_TYPE_INIT;
-    params.NvmCtx = NULL;
+    params.RestoreCtx = NULL;
     RegionInitDefaults( MacCtx.NvmCtx->Region, &params );
 
     // Initialize channel index.
@@ -2644,51 +3985,155 @@ static void RxWindowSetup( TimerEvent_t* rxTimer, RxConfigParams_t* rxConfig )
     TimerStop( rxTimer );
 
     // Ensure the radio is Idle
+    // The window preempts any sniffing cycle. LoRaMacProcess restarts it.
+    StopRxCSniff( );
     Radio.Standby( );
+    LORAMAC_INSTANCE_CLAIM_RADIO( );
+    LoRaMacClassBRadioReconfigured( );
 
     if( RegionRxConfig( MacCtx.NvmCtx->Region, rxConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
     {
-        Radio.Rx( MacCtx.NvmCtx->MacParams.MaxRxWindow );
+        StartRxWindow( MacCtx.NvmCtx->MacParams.MaxRxWindow, MacCtx.McpsIndication.RxDatarate );
         MacCtx.RxSlot = rxConfig->RxSlot;
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+        if( rxConfig->RxSlot == RX_SLOT_WIN_1 )
+        {
+            LATENCY_UPDATE( Rx1Offset, ( LORAMAC_LATENCY_TIMESTAMP( ) - LatencyTxDone ) - ( MacCtx.RxWindow1DelayUs / 1000 ) );
+        }
+        else if( rxConfig->RxSlot == RX_SLOT_WIN_2 )
+        {
+            LATENCY_UPDATE( Rx2Offset, ( LORAMAC_LATENCY_TIMESTAMP( ) - LatencyTxDone ) - ( MacCtx.RxWindow2DelayUs / 1000 ) );
+        }
+#endif
+        TRACE( TRACE_ID_MAC_RX_WINDOW, rxConfig->RxSlot, MacCtx.McpsIndication.RxDatarate, MacCtx.NvmCtx->MacParams.MaxRxWindow );
     }
 }
 
 static void OpenContinuousRxCWindow( void )
 {
-    // Compute RxC windows parameters
-    RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
-                                     MacCtx.NvmCtx->MacParams.RxCChannel.Datarate,
-                                     MacCtx.NvmCtx->MacParams.MinRxSymbols,
-                                     MacCtx.NvmCtx->MacParams.SystemMaxRxError,
-                                     &MacCtx.RxWindowCConfig );
+    StopRxCSniff( );
+
+    if( ConfigureContinuousRxCWindow( ) == true )
+    {
+        StartContinuousRxCWindow( );
+    }
+}
+
+static bool IsRxCSniffing( void )
+{
+    // Channel activity detection is used when the radio cannot duty cycle
+    // the reception by itself
+    return ( MacCtx.NvmCtx->MacParams.RxCDutyCycle.SleepTime != 0 ) &&
+           ( Radio.SetRxDutyCycle == NULL ) && ( Radio.StartCad != NULL );
+}
 
+static void SetupRxCWindowChannel( void )
+{
+    MacCtx.RxWindowCConfig = MacCtx.RxWindow2Config;
     MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
-    // Setup continuous listening
-    MacCtx.RxWindowCConfig.RxContinuous = true;
+
+    for( int8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        if( MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.IsEnabled == true )
+        // TODO: Check multicast channel device class.
+        {
+            MacCtx.NvmCtx->MacParams.RxCChannel.Frequency = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.RxParams.ClassC.Frequency;
+            MacCtx.NvmCtx->MacParams.RxCChannel.Datarate = MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.RxParams.ClassC.Datarate;
+
+            MacCtx.RxWindowCConfig.Channel = MacCtx.Channel;
+            MacCtx.RxWindowCConfig.Frequency = MacCtx.NvmCtx->MacParams.RxCChannel.Frequency;
+            MacCtx.RxWindowCConfig.DownlinkDwellTime = MacCtx.NvmCtx->MacParams.DownlinkDwellTime;
+            MacCtx.RxWindowCConfig.RepeaterSupport = MacCtx.NvmCtx->RepeaterSupport;
+            MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C_MULTICAST;
+            MacCtx.RxWindowCConfig.RxContinuous = true;
+            break;
+        }
+    }
+}
+
+static bool ConfigureContinuousRxCWindow( void )
+{
+    LoRaMacRxCWindowCache_t* cache = &MacCtx.RxCWindowCache;
+
+    if( ( cache->IsValid == false ) ||
+        ( cache->RxCDatarate != MacCtx.NvmCtx->MacParams.RxCChannel.Datarate ) ||
+        ( cache->MinRxSymbols != MacCtx.NvmCtx->MacParams.MinRxSymbols ) ||
+        ( cache->SystemMaxRxError != MacCtx.NvmCtx->MacParams.SystemMaxRxError ) )
+    {
+        // Compute RxC windows parameters
+        RegionComputeRxWindowParameters( MacCtx.NvmCtx->Region,
+                                         MacCtx.NvmCtx->MacParams.RxCChannel.Datarate,
+                                         MacCtx.NvmCtx->MacParams.MinRxSymbols,
+                                         MacCtx.NvmCtx->MacParams.SystemMaxRxError,
+                                         &MacCtx.RxWindowCConfig );
+
+        cache->IsValid = true;
+        cache->RxCDatarate = MacCtx.NvmCtx->MacParams.RxCChannel.Datarate;
+        cache->MinRxSymbols = MacCtx.NvmCtx->MacParams.MinRxSymbols;
+        cache->SystemMaxRxError = MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+        cache->Datarate = MacCtx.RxWindowCConfig.Datarate;
+        cache->Bandwidth = MacCtx.RxWindowCConfig.Bandwidth;
+        cache->WindowTimeout = MacCtx.RxWindowCConfig.WindowTimeout;
+        cache->WindowOffset = MacCtx.RxWindowCConfig.WindowOffset;
+    }
+    else
+    {
+        MacCtx.RxWindowCConfig.Datarate = cache->Datarate;
+        MacCtx.RxWindowCConfig.Bandwidth = cache->Bandwidth;
+        MacCtx.RxWindowCConfig.WindowTimeout = cache->WindowTimeout;
+        MacCtx.RxWindowCConfig.WindowOffset = cache->WindowOffset;
+    }
+
+    MacCtx.RxWindowCConfig.RxSlot = RX_SLOT_WIN_CLASS_C;
+    // Setup continuous listening, a detected preamble is received once
+    MacCtx.RxWindowCConfig.RxContinuous = !IsRxCSniffing( );
 
     // At this point the Radio should be idle.
     // Thus, there is no need to set the radio in standby mode.
-    if( RegionRxConfig( MacCtx.NvmCtx->Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate ) == true )
+    LORAMAC_INSTANCE_CLAIM_RADIO( );
+    LoRaMacClassBRadioReconfigured( );
+    return RegionRxConfig( MacCtx.NvmCtx->Region, &MacCtx.RxWindowCConfig, ( int8_t* )&MacCtx.McpsIndication.RxDatarate );
+}
+
+static void StartContinuousRxCWindow( void )
+{
+    if( ( MacCtx.NvmCtx->MacParams.RxCDutyCycle.SleepTime != 0 ) && ( Radio.SetRxDutyCycle != NULL ) )
     {
-        Radio.Rx( 0 ); // Continuous mode
-        MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
+        // Radio periods are expressed in steps of 15.625 us
+        Radio.SetRxDutyCycle( ( MacCtx.NvmCtx->MacParams.RxCDutyCycle.RxTime * 8 ) / 125,
+                              ( MacCtx.NvmCtx->MacParams.RxCDutyCycle.SleepTime * 8 ) / 125 );
     }
+    else if( IsRxCSniffing( ) == true )
+    {
+        Radio.StartCad( );
+        MacCtx.RxCSniffState = RXC_SNIFF_STATE_CAD;
+    }
+    else
+    {
+        StartRxWindow( 0, MacCtx.McpsIndication.RxDatarate ); // Continuous mode
+    }
+    MacCtx.RxSlot = MacCtx.RxWindowCConfig.RxSlot;
 }
 
 LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl, uint8_t fPort, void* fBuffer, uint16_t fBufferSize )
 {
     MacCtx.PktBufferLen = 0;
     MacCtx.NodeAckRequested = false;
+    MacCtx.MacCommandsDeferred = false;
     uint32_t fCntUp = 0;
     size_t macCmdsSize = 0;
     uint8_t availableSize = 0;
+    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
 
     if( fBuffer == NULL )
     {
         fBufferSize = 0;
     }
+    if( fBufferSize > LORAMAC_FRAME_PAYLOAD_MAX_SIZE )
+    {
+        return LORAMAC_STATUS_LENGTH_ERROR;
+    }
 
-    memcpy1( MacCtx.AppData, ( uint8_t* ) fBuffer, fBufferSize );
     MacCtx.AppDataSize = fBufferSize;
     MacCtx.PktBuffer[0] = macHdr->Value;
 
@@ -2706,7 +4151,7 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
             MacCtx.TxMsg.Message.Data.FHDR.DevAddr = MacCtx.NvmCtx->DevAddr;
             MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Value = fCtrl->Value;
             MacCtx.TxMsg.Message.Data.FRMPayloadSize = MacCtx.AppDataSize;
-            MacCtx.TxMsg.Message.Data.FRMPayload = MacCtx.AppData;
+            MacCtx.TxMsg.Message.Data.FRMPayload = NULL;
 
             if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoGetFCntUp( &fCntUp ) )
             {
@@ -2730,7 +4175,9 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
                 availableSize = GetMaxAppPayloadWithoutFOptsLength( MacCtx.NvmCtx->MacParams.ChannelsDatarate );
 
                 // There is application payload available and the MAC commands fit into FOpts field.
-                if( ( MacCtx.AppDataSize > 0 ) && ( macCmdsSize <= LORA_MAC_COMMAND_MAX_FOPTS_LENGTH ) )
+                // When deferring is enabled, they also have to fit in the frame together with the payload.
+                if( ( MacCtx.AppDataSize > 0 ) && ( macCmdsSize <= LORA_MAC_COMMAND_MAX_FOPTS_LENGTH ) &&
+                    ( ( MacCtx.MacCommandsDefer == false ) || ( ( macCmdsSize + MacCtx.AppDataSize ) <= availableSize ) ) )
                 {
                     if( LoRaMacCommandsSerializeCmds( LORA_MAC_COMMAND_MAX_FOPTS_LENGTH, &macCmdsSize, MacCtx.TxMsg.Message.Data.FHDR.FOpts ) != LORAMAC_COMMANDS_SUCCESS )
                     {
@@ -2740,15 +4187,23 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
                     // Update FCtrl field with new value of FOptionsLength
                     MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Value = fCtrl->Value;
                 }
+                // The application payload is sent alone and the MAC commands wait for the next uplink.
+                // Consecutive uplinks may only leave them behind LORAMAC_MAC_COMMANDS_MAX_DEFER times.
+                else if( ( MacCtx.AppDataSize > 0 ) && ( MacCtx.MacCommandsDefer == true ) &&
+                         ( MacCtx.AppDataSize <= availableSize ) &&
+                         ( MacCtx.MacCommandsDeferCounter < LORAMAC_MAC_COMMANDS_MAX_DEFER ) )
+                {
+                    MacCtx.MacCommandsDeferred = true;
+                }
                 // There is application payload available but the MAC commands does NOT fit into FOpts field.
-                else if( ( MacCtx.AppDataSize > 0 ) && ( macCmdsSize > LORA_MAC_COMMAND_MAX_FOPTS_LENGTH ) )
+                else if( MacCtx.AppDataSize > 0 )
                 {
 
                     if( LoRaMacCommandsSerializeCmds( availableSize, &macCmdsSize, MacCtx.NvmCtx->MacCommandsBuffer ) != LORAMAC_COMMANDS_SUCCESS )
                     {
                         return LORAMAC_STATUS_MAC_COMMAD_ERROR;
                     }
-                    return LORAMAC_STATUS_SKIPPED_APP_DATA;
+                    status = LORAMAC_STATUS_SKIPPED_APP_DATA;
                 }
                 // No application payload available therefore add all mac commands to the FRMPayload.
                 else
@@ -2765,11 +4220,28 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
                 }
             }
 
+            if( MacCtx.TxMsg.Message.Data.FRMPayload == NULL )
+            {
+                // Place the application data at its final position, behind the FOpts field.
+                // The payload is encrypted in place and the serializer does not copy it again.
+                uint8_t* payload = MacCtx.PktBuffer + LORAMAC_FRAME_PAYLOAD_OFFSET + fCtrl->Bits.FOptsLen;
+
+                if( ( fCtrl->Bits.FOptsLen + MacCtx.AppDataSize ) > LORAMAC_FRAME_PAYLOAD_MAX_SIZE )
+                {
+                    return LORAMAC_STATUS_LENGTH_ERROR;
+                }
+                if( ( MacCtx.AppDataSize > 0 ) && ( fBuffer != payload ) )
+                {
+                    // The buffer may be the LoRaMacGetTxPayloadBuffer window
+                    memmove( payload, fBuffer, MacCtx.AppDataSize );
+                }
+                MacCtx.TxMsg.Message.Data.FRMPayload = payload;
+            }
             break;
         case FRAME_TYPE_PROPRIETARY:
             if( ( fBuffer != NULL ) && ( MacCtx.AppDataSize > 0 ) )
             {
-                memcpy1( MacCtx.PktBuffer + LORAMAC_MHDR_FIELD_SIZE, ( uint8_t* ) fBuffer, MacCtx.AppDataSize );
+                memmove( MacCtx.PktBuffer + LORAMAC_MHDR_FIELD_SIZE, fBuffer, MacCtx.AppDataSize );
                 MacCtx.PktBufferLen = LORAMAC_MHDR_FIELD_SIZE + MacCtx.AppDataSize;
             }
             break;
@@ -2777,7 +4249,7 @@ LoRaMacStatus_t PrepareFrame( LoRaMacHeader_t* macHdr, LoRaMacFrameCtrl_t* fCtrl
             return LORAMAC_STATUS_SERVICE_UNKNOWN;
     }
 
-    return LORAMAC_STATUS_OK;
+    return status;
 }
 
 LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
@@ -2792,8 +4264,13 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
     txConfig.AntennaGain = MacCtx.NvmCtx->MacParams.AntennaGain;
     txConfig.PktLen = MacCtx.PktBufferLen;
 
+    LoRaMacClassBRadioReconfigured( );
     RegionTxConfig( MacCtx.NvmCtx->Region, &txConfig, &txPower, &MacCtx.TxTimeOnAir );
 
+    // Load the frame in the radio while the remaining transmission setup is
+    // processed. Radio.Send then only has to start the transmission.
+    Radio.PrepareTx( MacCtx.PktBuffer, MacCtx.PktBufferLen );
+
     MacCtx.McpsConfirm.Status = LORAMAC_EVENT_INFO_STATUS_ERROR;
     MacCtx.McpsConfirm.Datarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
     MacCtx.McpsConfirm.TxPower = txPower;
@@ -2829,7 +4306,13 @@ LoRaMacStatus_t SendFrameOnChannel( uint8_t channel )
         MacCtx.ChannelsNbTransCounter++;
     }
 
+    // The transmission ends any sniffing cycle
+    StopRxCSniff( );
+
     // Send now
+    TRACE( TRACE_ID_MAC_TX, channel, MacCtx.NvmCtx->MacParams.ChannelsDatarate, MacCtx.TxTimeOnAir );
+    LATENCY_MARK( LatencyTxStart );
+    LORAMAC_INSTANCE_CLAIM_RADIO( );
     Radio.Send( MacCtx.PktBuffer, MacCtx.PktBufferLen );
 
     return LORAMAC_STATUS_OK;
@@ -2846,6 +4329,8 @@ LoRaMacStatus_t SetTxContinuousWave( uint16_t timeout )
     continuousWave.AntennaGain = MacCtx.NvmCtx->MacParams.AntennaGain;
     continuousWave.Timeout = timeout;
 
+    LORAMAC_INSTANCE_CLAIM_RADIO( );
+    LoRaMacClassBRadioReconfigured( );
     RegionSetContinuousWave( MacCtx.NvmCtx->Region, &continuousWave );
 
     MacCtx.MacState |= LORAMAC_TX_RUNNING;
@@ -2855,6 +4340,8 @@ LoRaMacStatus_t SetTxContinuousWave( uint16_t timeout )
 
 LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint8_t power )
 {
+    LORAMAC_INSTANCE_CLAIM_RADIO( );
+    LoRaMacClassBRadioReconfigured( );
     Radio.SetTxContinuousWave( frequency, power, timeout );
 
     MacCtx.MacState |= LORAMAC_TX_RUNNING;
@@ -2864,17 +4351,17 @@ LoRaMacStatus_t SetTxContinuousWave1( uint16_t timeout, uint32_t frequency, uint
 
 LoRaMacCtxs_t* GetCtxs( void )
 {
-    Contexts.MacNvmCtx = &NvmMacCtx;
-    Contexts.MacNvmCtxSize = sizeof( NvmMacCtx );
-    Contexts.CryptoNvmCtx = LoRaMacCryptoGetNvmCtx( &Contexts.CryptoNvmCtxSize );
+    ModuleCtxs.MacNvmCtx = &NvmMacCtx;
+    ModuleCtxs.MacNvmCtxSize = sizeof( NvmMacCtx );
+    ModuleCtxs.CryptoNvmCtx = LoRaMacCryptoGetNvmCtx( &ModuleCtxs.CryptoNvmCtxSize );
     GetNvmCtxParams_t params ={ 0 };
-    Contexts.RegionNvmCtx = RegionGetNvmCtx( MacCtx.NvmCtx->Region, &params );
-    Contexts.RegionNvmCtxSize = params.nvmCtxSize;
-    Contexts.SecureElementNvmCtx = SecureElementGetNvmCtx( &Contexts.SecureElementNvmCtxSize );
-    Contexts.CommandsNvmCtx = LoRaMacCommandsGetNvmCtx( &Contexts.CommandsNvmCtxSize );
-    Contexts.ClassBNvmCtx = LoRaMacClassBGetNvmCtx( &Contexts.ClassBNvmCtxSize );
-    Contexts.ConfirmQueueNvmCtx = LoRaMacConfirmQueueGetNvmCtx( &Contexts.ConfirmQueueNvmCtxSize );
-    return &Contexts;
+    ModuleCtxs.RegionNvmCtx = RegionGetNvmCtx( MacCtx.NvmCtx->Region, &params );
+    ModuleCtxs.RegionNvmCtxSize = params.nvmCtxSize;
+    ModuleCtxs.SecureElementNvmCtx = SecureElementGetNvmCtx( &ModuleCtxs.SecureElementNvmCtxSize );
+    ModuleCtxs.CommandsNvmCtx = LoRaMacCommandsGetNvmCtx( &ModuleCtxs.CommandsNvmCtxSize );
+    ModuleCtxs.ClassBNvmCtx = LoRaMacClassBGetNvmCtx( &ModuleCtxs.ClassBNvmCtxSize );
+    ModuleCtxs.ConfirmQueueNvmCtx = LoRaMacConfirmQueueGetNvmCtx( &ModuleCtxs.ConfirmQueueNvmCtxSize );
+    return &ModuleCtxs;
 }
 
 LoRaMacStatus_t RestoreCtxs( LoRaMacCtxs_t* contexts )
@@ -2887,15 +4374,26 @@ LoRaMacStatus_t RestoreCtxs( LoRaMacCtxs_t* contexts )
     {
         return LORAMAC_STATUS_BUSY;
     }
+    return RestoreModuleCtxs( contexts, false );
+}
+
+static LoRaMacStatus_t RestoreModuleCtxs( LoRaMacCtxs_t* contexts, bool session )
+{
+    LoRaMacCryptoStatus_t cryptoStatus;
 
     if( contexts->MacNvmCtx != NULL )
     {
         memcpy1( ( uint8_t* ) &NvmMacCtx, ( uint8_t* ) contexts->MacNvmCtx, contexts->MacNvmCtxSize );
     }
+    UpdateMcAddrIndex( );
+    if( Radio.SetWakeupTime != NULL )
+    {
+        Radio.SetWakeupTime( MacCtx.NvmCtx->RadioWakeupTime );
+    }
 
     InitDefaultsParams_t params;
     params.Type = INIT_TYPE_RESTORE_CTX;
-    params.NvmCtx = contexts->RegionNvmCtx;
+    params.RestoreCtx = contexts->RegionNvmCtx;
     RegionInitDefaults( MacCtx.NvmCtx->Region, &params );
 
     // Initialize RxC config parameters.
@@ -2911,7 +4409,15 @@ LoRaMacStatus_t RestoreCtxs( LoRaMacCtxs_t* contexts )
         return LORAMAC_STATUS_CRYPTO_ERROR;
     }
 
-    if( LoRaMacCryptoRestoreNvmCtx( contexts->CryptoNvmCtx ) != LORAMAC_CRYPTO_SUCCESS )
+    if( session == true )
+    {
+        cryptoStatus = LoRaMacCryptoRestoreSessionNvmCtx( contexts->CryptoNvmCtx );
+    }
+    else
+    {
+        cryptoStatus = LoRaMacCryptoRestoreNvmCtx( contexts->CryptoNvmCtx );
+    }
+    if( cryptoStatus != LORAMAC_CRYPTO_SUCCESS )
     {
         return LORAMAC_STATUS_CRYPTO_ERROR;
     }
@@ -2986,13 +4492,34 @@ LoRaMacStatus_t DetermineFrameType( LoRaMacMessageData_t* macMsg, FType_t* fType
     return LORAMAC_STATUS_OK;
 }
 
-static bool CheckRetransUnconfirmedUplink( void )
+static bool IsUnconfirmedRepetition( void )
 {
-    // Unconfirmed uplink, when all retransmissions are done.
-    if( MacCtx.ChannelsNbTransCounter >=
-        MacCtx.NvmCtx->MacParams.ChannelsNbTrans )
+    return ( MacCtx.TxMsg.Type == LORAMAC_MSG_TYPE_DATA ) && ( MacCtx.NodeAckRequested == false ) &&
+           ( MacCtx.ChannelsNbTransCounter >= 1 );
+}
+
+static bool SkipRxWindows( void )
+{
+    if( ( MacCtx.NbTransSkipRx == false ) || ( IsUnconfirmedRepetition( ) == false ) ||
+        ( MacCtx.NvmCtx->DeviceClass != CLASS_A ) ||
+        ( MacCtx.ChannelsNbTransCounter >= MacCtx.NvmCtx->MacParams.ChannelsNbTrans ) )
     {
-        return true;
+        return false;
+    }
+    // No downlink is expected when the frame neither carries MAC commands nor
+    // asks for an ADR acknowledgement
+    return ( MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Bits.FOptsLen == 0 ) &&
+           ( MacCtx.TxMsg.Message.Data.FHDR.FCtrl.Bits.AdrAckReq == 0 ) &&
+           ( MacCtx.TxMsg.Message.Data.FPort != 0 );
+}
+
+static bool CheckRetransUnconfirmedUplink( void )
+{
+    // Unconfirmed uplink, when all retransmissions are done.
+    if( MacCtx.ChannelsNbTransCounter >=
+        MacCtx.NvmCtx->MacParams.ChannelsNbTrans )
+    {
+        return true;
     }
     else if( MacCtx.MacFlags.Bits.McpsInd == 1 )
     {
@@ -3055,8 +4582,11 @@ static void AckTimeoutRetriesProcess( void )
 {
     if( MacCtx.AckTimeoutRetriesCounter < MacCtx.AckTimeoutRetries )
     {
+        LoRaMacAdrAddChannelResult( MacCtx.Channel, MacCtx.NvmCtx->MacParams.ChannelsDatarate, false, 0 );
+
         MacCtx.AckTimeoutRetriesCounter++;
-        if( ( MacCtx.AckTimeoutRetriesCounter % 2 ) == 1 )
+        if( ( ( MacCtx.AckTimeoutRetriesCounter % 2 ) == 1 ) &&
+            ( LoRaMacAdrRetryKeepsDatarate( MacCtx.NvmCtx->MacParams.ChannelsDatarate ) == false ) )
         {
             GetPhyParams_t getPhy;
             PhyParam_t phyParam;
@@ -3072,11 +4602,14 @@ static void AckTimeoutRetriesProcess( void )
 
 static void AckTimeoutRetriesFinalize( void )
 {
+    LoRaMacAdrAddAckResult( MacCtx.McpsConfirm.AckReceived );
+    LoRaMacAdrAddChannelResult( MacCtx.Channel, MacCtx.McpsConfirm.Datarate, MacCtx.McpsConfirm.AckReceived,
+                                MacCtx.McpsIndication.Snr );
     if( MacCtx.McpsConfirm.AckReceived == false )
     {
         InitDefaultsParams_t params;
         params.Type = INIT_TYPE_RESTORE_DEFAULT_CHANNELS;
-        params.NvmCtx = Contexts.RegionNvmCtx;
+        params.RestoreCtx = ModuleCtxs.RegionNvmCtx;
         RegionInitDefaults( MacCtx.NvmCtx->Region, &params );
 
         MacCtx.NodeAckRequested = false;
@@ -3087,12 +4620,32 @@ static void AckTimeoutRetriesFinalize( void )
 
 static void CallNvmCtxCallback( LoRaMacNvmCtxModule_t module )
 {
+    if( MacCtx.NvmCtxEventsDeferred == true )
+    {
+        MacCtx.NvmCtxPendingEvents |= 1 << module;
+        return;
+    }
     if( ( MacCtx.MacCallbacks != NULL ) && ( MacCtx.MacCallbacks->NvmContextChange != NULL ) )
     {
         MacCtx.MacCallbacks->NvmContextChange( module );
     }
 }
 
+static void FlushNvmCtxEvents( void )
+{
+    uint8_t pendingEvents = MacCtx.NvmCtxPendingEvents;
+
+    MacCtx.NvmCtxEventsDeferred = false;
+    MacCtx.NvmCtxPendingEvents = 0;
+    for( uint8_t module = 0; pendingEvents != 0; module++, pendingEvents >>= 1 )
+    {
+        if( ( pendingEvents & 0x01 ) != 0 )
+        {
+            CallNvmCtxCallback( ( LoRaMacNvmCtxModule_t )module );
+        }
+    }
+}
+
 static void EventMacNvmCtxChanged( void )
 {
     CallNvmCtxCallback( LORAMAC_NVMCTXMODULE_MAC );
@@ -3138,11 +4691,92 @@ static uint8_t IsRequestPending( void )
     return 0;
 }
 
+LORAMAC_INSTANCE_TIMER_EVENT( OnTxDelayedTimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( OnTxQueueTimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( OnRxWindow1TimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( OnRxWindow2TimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( OnAckTimeoutTimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( OnRxCSniffTimerEvent )
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Radio events handlers of the instances, they select the radio owner
+ */
+static void OnInstanceRadioTxDone( void )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioTxDone( );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioRxDone( uint8_t *payload, uint16_t size, int16_t rssi, int8_t snr )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioRxDone( payload, size, rssi, snr );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioTxTimeout( void )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioTxTimeout( );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioRxError( void )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioRxError( );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioRxTimeout( void )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioRxTimeout( );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioCadDone( bool channelActivityDetected )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioCadDone( channelActivityDetected );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioIrqNotify( void )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioIrqNotify( );
+    LoRaMacInstanceSelect( selected );
+}
+
+static void OnInstanceRadioIrqTimestamp( uint32_t timestamp )
+{
+    LoRaMacInstance_t* selected = SelectedInstance;
+
+    LoRaMacInstanceSelect( RadioOwner );
+    OnRadioIrqTimestamp( timestamp );
+    LoRaMacInstanceSelect( selected );
+}
+#endif
 
 LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacCallback_t* callbacks, LoRaMacRegion_t region )
 {
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
     LoRaMacClassBCallback_t classBCallbacks;
     LoRaMacClassBParams_t classBParams;
 
@@ -3168,6 +4802,9 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     // Confirm queue reset
     LoRaMacConfirmQueueInit( primitives, EventConfirmQueueNvmCtxChanged );
 
+    // Transmit queue reset
+    LoRaMacTxQueueInit( );
+
     // Initialize the module context with zeros
     memset1( ( uint8_t* ) &NvmMacCtx, 0x00, sizeof( LoRaMacNvmCtx_t ) );
     memset1( ( uint8_t* ) &MacCtx, 0x00, sizeof( LoRaMacCtx_t ) );
@@ -3187,95 +4824,7 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     lrWanVersion.Fields.Rfu      = 0;
     MacCtx.NvmCtx->Version = lrWanVersion;
 
-    // Reset to defaults
-    getPhy.Attribute = PHY_DUTY_CYCLE;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->DutyCycleOn = ( bool ) phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_TX_POWER;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_TX_DR;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate = phyParam.Value;
-
-    getPhy.Attribute = PHY_MAX_RX_WINDOW;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow = phyParam.Value;
-
-    getPhy.Attribute = PHY_RECEIVE_DELAY1;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1 = phyParam.Value;
-
-    getPhy.Attribute = PHY_RECEIVE_DELAY2;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2 = phyParam.Value;
-
-    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY1;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1 = phyParam.Value;
-
-    getPhy.Attribute = PHY_JOIN_ACCEPT_DELAY2;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2 = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_DR1_OFFSET;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.Rx1DrOffset = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_RX2_FREQUENCY;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Frequency = phyParam.Value;
-    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Frequency = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_RX2_DR;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel.Datarate = phyParam.Value;
-    MacCtx.NvmCtx->MacParamsDefaults.RxCChannel.Datarate = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_UPLINK_DWELL_TIME;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.UplinkDwellTime = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_DOWNLINK_DWELL_TIME;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.DownlinkDwellTime = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_MAX_EIRP;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.MaxEirp = phyParam.fValue;
-
-    getPhy.Attribute = PHY_DEF_ANTENNA_GAIN;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.NvmCtx->MacParamsDefaults.AntennaGain = phyParam.fValue;
-
-    getPhy.Attribute = PHY_DEF_ADR_ACK_LIMIT;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.AdrAckLimit = phyParam.Value;
-
-    getPhy.Attribute = PHY_DEF_ADR_ACK_DELAY;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
-    MacCtx.AdrAckDelay = phyParam.Value;
-
-    // Init parameters which are not set in function ResetMacParameters
-    MacCtx.NvmCtx->MacParamsDefaults.ChannelsNbTrans = 1;
-    MacCtx.NvmCtx->MacParamsDefaults.SystemMaxRxError = 10;
-    MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols = 6;
-
-    MacCtx.NvmCtx->MacParams.SystemMaxRxError = MacCtx.NvmCtx->MacParamsDefaults.SystemMaxRxError;
-    MacCtx.NvmCtx->MacParams.MinRxSymbols = MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols;
-    MacCtx.NvmCtx->MacParams.MaxRxWindow = MacCtx.NvmCtx->MacParamsDefaults.MaxRxWindow;
-    MacCtx.NvmCtx->MacParams.ReceiveDelay1 = MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay1;
-    MacCtx.NvmCtx->MacParams.ReceiveDelay2 = MacCtx.NvmCtx->MacParamsDefaults.ReceiveDelay2;
-    MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 = MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay1;
-    MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 = MacCtx.NvmCtx->MacParamsDefaults.JoinAcceptDelay2;
-    MacCtx.NvmCtx->MacParams.ChannelsNbTrans = MacCtx.NvmCtx->MacParamsDefaults.ChannelsNbTrans;
-
-    InitDefaultsParams_t params;
-    params.Type = INIT_TYPE_BANDS;
-    params.NvmCtx = NULL;
-    RegionInitDefaults( MacCtx.NvmCtx->Region, &params );
+    InitRegionDefaults( );
 
     ResetMacParameters( );
 
@@ -3285,16 +4834,20 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.MacCallbacks = callbacks;
     MacCtx.MacFlags.Value = 0;
     MacCtx.MacState = LORAMAC_STOPPED;
+    MacCtx.RxCPrepared = false;
+    MacCtx.RxCWindowCache.IsValid = false;
 
     // Reset duty cycle times
     MacCtx.NvmCtx->LastTxDoneTime = 0;
     MacCtx.NvmCtx->AggregatedTimeOff = 0;
 
     // Initialize timers
-    TimerInit( &MacCtx.TxDelayedTimer, OnTxDelayedTimerEvent );
-    TimerInit( &MacCtx.RxWindowTimer1, OnRxWindow1TimerEvent );
-    TimerInit( &MacCtx.RxWindowTimer2, OnRxWindow2TimerEvent );
-    TimerInit( &MacCtx.AckTimeoutTimer, OnAckTimeoutTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &MacCtx.TxDelayedTimer, OnTxDelayedTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &MacCtx.TxQueueTimer, OnTxQueueTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &MacCtx.RxWindowTimer1, OnRxWindow1TimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &MacCtx.RxWindowTimer2, OnRxWindow2TimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &MacCtx.AckTimeoutTimer, OnAckTimeoutTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &MacCtx.RxCSniffTimer, OnRxCSniffTimerEvent );
 
     // Store the current initialization time
     MacCtx.NvmCtx->InitializationTime = SysTimeGetMcuTime( );
@@ -3305,7 +4858,26 @@ LoRaMacStatus_t LoRaMacInitialization( LoRaMacPrimitives_t* primitives, LoRaMacC
     MacCtx.RadioEvents.RxError = OnRadioRxError;
     MacCtx.RadioEvents.TxTimeout = OnRadioTxTimeout;
     MacCtx.RadioEvents.RxTimeout = OnRadioRxTimeout;
+    MacCtx.RadioEvents.CadDone = OnRadioCadDone;
+    MacCtx.RadioEvents.IrqNotify = OnRadioIrqNotify;
+    MacCtx.RadioEvents.IrqTimestamp = OnRadioIrqTimestamp;
+#if defined( LORAMAC_INSTANCES_ENABLED )
+    // The instances share the radio, its events are routed to the owner
+    if( InstanceRadioEvents.TxDone == NULL )
+    {
+        InstanceRadioEvents.TxDone = OnInstanceRadioTxDone;
+        InstanceRadioEvents.RxDone = OnInstanceRadioRxDone;
+        InstanceRadioEvents.RxError = OnInstanceRadioRxError;
+        InstanceRadioEvents.TxTimeout = OnInstanceRadioTxTimeout;
+        InstanceRadioEvents.RxTimeout = OnInstanceRadioRxTimeout;
+        InstanceRadioEvents.CadDone = OnInstanceRadioCadDone;
+        InstanceRadioEvents.IrqNotify = OnInstanceRadioIrqNotify;
+        InstanceRadioEvents.IrqTimestamp = OnInstanceRadioIrqTimestamp;
+        Radio.Init( &InstanceRadioEvents );
+    }
+#else
     Radio.Init( &MacCtx.RadioEvents );
+#endif
 
     // Initialize the Secure Element driver
     if( SecureElementInit( EventSecureElementNvmCtxChanged ) != SECURE_ELEMENT_SUCCESS )
@@ -3384,6 +4956,63 @@ LoRaMacStatus_t LoRaMacStop( void )
     return LORAMAC_STATUS_BUSY;
 }
 
+LoRaMacStatus_t LoRaMacCalibrateRadioWakeupTime( void )
+{
+    if( Radio.CalibrateWakeupTime == NULL )
+    {
+        return LORAMAC_STATUS_SERVICE_UNKNOWN;
+    }
+    // The radio must not be receiving, Class B and C windows are only opened in Class A
+    if( ( LoRaMacIsBusy( ) == true ) || ( MacCtx.NvmCtx->DeviceClass != CLASS_A ) )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+
+    MacCtx.NvmCtx->RadioWakeupTime = Radio.CalibrateWakeupTime( );
+    EventMacNvmCtxChanged( );
+    return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacSwitchRegion( LoRaMacRegion_t region, LoRaMacCtxs_t* regionCtxs )
+{
+    LoRaMacNvmCtx_t* savedMacCtx = NULL;
+
+    if( MacCtx.MacState != LORAMAC_STOPPED )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+    if( RegionIsActive( region ) == false )
+    {
+        return LORAMAC_STATUS_REGION_NOT_SUPPORTED;
+    }
+
+    if( ( regionCtxs != NULL ) && ( regionCtxs->MacNvmCtxSize == sizeof( LoRaMacNvmCtx_t ) ) )
+    {
+        savedMacCtx = ( LoRaMacNvmCtx_t* )regionCtxs->MacNvmCtx;
+    }
+
+    MacCtx.NvmCtx->Region = region;
+    InitRegionDefaults( );
+
+    if( ( savedMacCtx != NULL ) && ( savedMacCtx->Region == region ) &&
+        ( savedMacCtx->NetworkActivation != ACTIVATION_TYPE_NONE ) &&
+        ( regionCtxs->RegionNvmCtx != NULL ) )
+    {
+        // Resume the session of the region
+        return RestoreModuleCtxs( regionCtxs, true );
+    }
+
+    // No session, the device has to join in the new region
+    ResetMacParameters( );
+    LoRaMacCommandsInit( EventCommandsNvmCtxChanged );
+    MacCtx.NvmCtx->LastTxDoneTime = 0;
+    MacCtx.NvmCtx->AggregatedTimeOff = 0;
+
+    CallNvmCtxCallback( LORAMAC_NVMCTXMODULE_MAC );
+    CallNvmCtxCallback( LORAMAC_NVMCTXMODULE_REGION );
+    return LORAMAC_STATUS_OK;
+}
+
 LoRaMacStatus_t LoRaMacQueryNextTxDelay( int8_t datarate, TimerTime_t* time )
 {
     NextChanParams_t nextChan;
@@ -3408,6 +5037,9 @@ LoRaMacStatus_t LoRaMacQueryNextTxDelay( int8_t datarate, TimerTime_t* time )
     nextChan.QueryNextTxDelayOnly = true;
     nextChan.Joined = true;
     nextChan.LastAggrTx = MacCtx.NvmCtx->LastTxDoneTime;
+    nextChan.ChannelStats = NULL;
+    nextChan.NbChannelStats = 0;
+    nextChan.AvoidChannel = REGION_CHANNEL_NONE;
 
     if( MacCtx.NvmCtx->NetworkActivation == ACTIVATION_TYPE_NONE )
     {
@@ -3435,6 +5067,22 @@ LoRaMacStatus_t LoRaMacQueryNextTxDelay( int8_t datarate, TimerTime_t* time )
     return RegionNextChannel( MacCtx.NvmCtx->Region, &nextChan, &channel, time, &MacCtx.NvmCtx->AggregatedTimeOff );
 }
 
+LoRaMacStatus_t LoRaMacGetTxPayloadBuffer( uint8_t** buffer, uint8_t* size )
+{
+    if( ( buffer == NULL ) || ( size == NULL ) )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    // The transmit buffer holds the current frame until the MAC is idle
+    if( LoRaMacIsBusy( ) == true )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+    *buffer = MacCtx.PktBuffer + LORAMAC_FRAME_PAYLOAD_OFFSET;
+    *size = LORAMAC_FRAME_PAYLOAD_MAX_SIZE;
+    return LORAMAC_STATUS_OK;
+}
+
 LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
 {
     CalcNextAdrParams_t adrNext;
@@ -3442,6 +5090,7 @@ LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
     int8_t datarate = MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate;
     int8_t txPower = MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower;
     size_t macCmdsSize = 0;
+    bool macCmdsFit;
 
     if( txInfo == NULL )
     {
@@ -3472,51 +5121,250 @@ LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo )
     }
 
     // Verify if the MAC commands fit into the FOpts and into the maximum payload.
-    if( ( LORA_MAC_COMMAND_MAX_FOPTS_LENGTH >= macCmdsSize ) && ( txInfo->CurrentPossiblePayloadSize >= macCmdsSize ) )
+    macCmdsFit = ( LORA_MAC_COMMAND_MAX_FOPTS_LENGTH >= macCmdsSize ) && ( txInfo->CurrentPossiblePayloadSize >= macCmdsSize );
+    if( macCmdsFit == true )
     {
         txInfo->MaxPossibleApplicationDataSize = txInfo->CurrentPossiblePayloadSize - macCmdsSize;
-
-        // Verify if the application data together with MAC command fit into the maximum payload.
-        if( txInfo->CurrentPossiblePayloadSize >= ( macCmdsSize + size ) )
-        {
-            return LORAMAC_STATUS_OK;
-        }
-        else
-        {
-           return LORAMAC_STATUS_LENGTH_ERROR;
-        }
     }
     else
     {
         txInfo->MaxPossibleApplicationDataSize = 0;
-        return LORAMAC_STATUS_LENGTH_ERROR;
     }
+
+    txInfo->TxTimeOnAir = RegionGetTxTimeOnAir( MacCtx.NvmCtx->Region, datarate,
+                                                MIN( LORA_MAC_FRMPAYLOAD_OVERHEAD + macCmdsSize + size, LORAMAC_PHY_MAXPAYLOAD ) );
+    txInfo->NextTxDelay = 0;
+    LoRaMacQueryNextTxDelay( datarate, &txInfo->NextTxDelay );
+
+    // Verify if the application data together with MAC command fit into the maximum payload.
+    if( ( macCmdsFit == true ) && ( txInfo->CurrentPossiblePayloadSize >= ( macCmdsSize + size ) ) )
+    {
+        return LORAMAC_STATUS_OK;
+    }
+    return LORAMAC_STATUS_LENGTH_ERROR;
 }
 
-LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
+LoRaMacStatus_t LoRaMacQueryTxPlan( uint8_t size, LoRaMacTxPlan_t* plan )
 {
-    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
+    CalcBackOffParams_t calcBackOff;
+    TxDelays_t txDelays;
+    size_t macCmdsSize = 0;
+    TimerTime_t elapsed;
 
-    if( mibGet == NULL )
+    if( plan == NULL )
     {
         return LORAMAC_STATUS_PARAMETER_INVALID;
     }
+    if( LoRaMacCommandsGetSizeSerializedCmds( &macCmdsSize ) != LORAMAC_COMMANDS_SUCCESS )
+    {
+        return LORAMAC_STATUS_MAC_COMMAD_ERROR;
+    }
+    memset1( ( uint8_t* )plan, 0, sizeof( LoRaMacTxPlan_t ) );
 
-    switch( mibGet->Type )
+    // Same parameters as CalculateBackOff for the last uplink
+    calcBackOff.Joined = ( MacCtx.NvmCtx->NetworkActivation != ACTIVATION_TYPE_NONE );
+    calcBackOff.DutyCycleEnabled = MacCtx.NvmCtx->DutyCycleOn;
+    calcBackOff.Channel = ( MacCtx.NvmCtx->LastTxDoneTime == 0 ) ? REGION_CHANNEL_NONE : MacCtx.NvmCtx->LastTxChannel;
+    calcBackOff.ElapsedTime = SysTimeSub( SysTimeGetMcuTime( ), MacCtx.NvmCtx->InitializationTime );
+    calcBackOff.TxTimeOnAir = MacCtx.TxTimeOnAir;
+    calcBackOff.LastTxIsJoinRequest = ( MacCtx.MacFlags.Bits.MlmeReq == 1 ) && ( LoRaMacConfirmQueueIsCmdActive( MLME_JOIN ) == true );
+
+    RegionQueryTxDelays( MacCtx.NvmCtx->Region, &calcBackOff, &txDelays );
+
+    if( MacCtx.NvmCtx->LastTxDoneTime != 0 )
     {
-        case MIB_DEVICE_CLASS:
+        TimerTime_t aggrTimeOff = ( MacCtx.TxTimeOnAir * MacCtx.NvmCtx->AggregatedDCycle - MacCtx.TxTimeOnAir );
+
+        elapsed = TimerGetElapsedTime( MacCtx.NvmCtx->LastTxDoneTime );
+        plan->AggregatedDelay = ( aggrTimeOff > elapsed ) ? ( aggrTimeOff - elapsed ) : 0;
+    }
+
+    plan->NbBands = MIN( txDelays.NbBands, LORAMAC_TX_PLAN_MAX_BANDS );
+    for( uint8_t i = 0; i < plan->NbBands; i++ )
+    {
+        plan->Bands[i].DCycle = txDelays.BandsDCycle[i];
+        plan->Bands[i].Delay = txDelays.BandsDelay[i];
+        plan->Bands[i].HourlyBudget = ( txDelays.BandsDCycle[i] == 0 ) ? 3600000 : 3600000 / txDelays.BandsDCycle[i];
+    }
+    plan->JoinDCycle = txDelays.JoinDCycle;
+    plan->JoinDCycleChange = txDelays.JoinDCycleChange;
+
+    for( int8_t dr = 0; dr < MIN( LORAMAC_TX_PLAN_NB_DATARATES, REGION_NB_DATARATES ); dr++ )
+    {
+        LoRaMacTxPlanDatarate_t* drPlan = &plan->Datarates[dr];
+
+        drPlan->Delay = txDelays.DatarateDelay[dr];
+        if( drPlan->Delay == TIMERTIME_T_MAX )
         {
-            mibGet->Param.Class = MacCtx.NvmCtx->DeviceClass;
-            break;
+            continue;
         }
-        case MIB_NETWORK_ACTIVATION:
+        drPlan->Delay = MAX( drPlan->Delay, plan->AggregatedDelay );
+        drPlan->TimeOnAir = RegionGetTxTimeOnAir( MacCtx.NvmCtx->Region, dr,
+                                                  MIN( LORA_MAC_FRMPAYLOAD_OVERHEAD + macCmdsSize + size, LORAMAC_PHY_MAXPAYLOAD ) );
+        drPlan->PayloadFits = ( LORA_MAC_COMMAND_MAX_FOPTS_LENGTH >= macCmdsSize ) &&
+                              ( GetMaxAppPayloadWithoutFOptsLength( dr ) >= ( macCmdsSize + size ) );
+    }
+    return LORAMAC_STATUS_OK;
+}
+
+LoRaMacStatus_t LoRaMacQueryTxDatarate( uint8_t size, int8_t* datarate )
+{
+    VerifyParams_t verify;
+    size_t macCmdsSize = 0;
+
+    if( datarate == NULL )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    if( LoRaMacCommandsGetSizeSerializedCmds( &macCmdsSize ) != LORAMAC_COMMANDS_SUCCESS )
+    {
+        return LORAMAC_STATUS_MAC_COMMAD_ERROR;
+    }
+    if( macCmdsSize > LORA_MAC_COMMAND_MAX_FOPTS_LENGTH )
+    {
+        // The MAC commands are sent alone on port 0
+        macCmdsSize = 0;
+    }
+
+    for( int8_t dr = MAX( *datarate, GetMinTxDatarate( ) ); dr <= DR_15; dr++ )
+    {
+        verify.DatarateParams.Datarate = dr;
+        verify.DatarateParams.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
+
+        if( ( RegionVerify( MacCtx.NvmCtx->Region, &verify, PHY_TX_DR ) == true ) &&
+            ( GetMaxAppPayloadWithoutFOptsLength( dr ) >= ( macCmdsSize + size ) ) )
         {
-            mibGet->Param.NetworkActivation = MacCtx.NvmCtx->NetworkActivation;
-            break;
+            *datarate = dr;
+            return LORAMAC_STATUS_OK;
         }
-        case MIB_DEV_EUI:
+    }
+    return LORAMAC_STATUS_LENGTH_ERROR;
+}
+
+/*!
+ * MIB attribute plain NVM field access rights
+ */
+#define MIB_NVM_FIELD_GET                           0x01
+#define MIB_NVM_FIELD_SET                           0x02
+
+/*!
+ * Size of a MIB parameter, fails to compile when it differs from the size of
+ * the NVM context field it is copied from or to.
+ */
+#define MIB_NVM_FIELD_SIZE( field, param )          sizeof( char[( sizeof( ( ( LoRaMacNvmCtx_t* )0 )->field ) == \
+                                                                   sizeof( ( ( MibParam_t* )0 )->param ) ) ? \
+                                                                 sizeof( ( ( MibParam_t* )0 )->param ) : -1] )
+
+#define MIB_NVM_FIELD( field, param, access )       { offsetof( LoRaMacNvmCtx_t, field ), MIB_NVM_FIELD_SIZE( field, param ), access }
+
+/*!
+ * MIB attribute stored as a plain MAC NVM context field
+ */
+typedef struct sMibNvmField
+{
+    /*!
+     * Field offset in \ref LoRaMacNvmCtx_t
+     */
+    uint16_t Offset;
+    /*!
+     * Field size. 0 when the attribute is not a plain field
+     */
+    uint8_t Size;
+    /*!
+     * Allowed accesses, \ref MIB_NVM_FIELD_GET and \ref MIB_NVM_FIELD_SET
+     */
+    uint8_t Access;
+}MibNvmField_t;
+
+/*!
+ * MIB attributes read or written without any verification or side effect,
+ * indexed by \ref Mib_t. The other attributes are handled by the switch
+ * statements of \ref LoRaMacMibGetRequestConfirm and \ref LoRaMacMibSetRequestConfirm
+ */
+static const MibNvmField_t MibNvmFields[] =
+{
+    [MIB_DEVICE_CLASS]              = MIB_NVM_FIELD( DeviceClass, Class, MIB_NVM_FIELD_GET ),
+    [MIB_NETWORK_ACTIVATION]        = MIB_NVM_FIELD( NetworkActivation, NetworkActivation, MIB_NVM_FIELD_GET ),
+    [MIB_ADR]                       = MIB_NVM_FIELD( AdrCtrlOn, AdrEnable, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_NET_ID]                    = MIB_NVM_FIELD( NetID, NetID, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_DEV_ADDR]                  = MIB_NVM_FIELD( DevAddr, DevAddr, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_PUBLIC_NETWORK]            = MIB_NVM_FIELD( PublicNetwork, EnablePublicNetwork, MIB_NVM_FIELD_GET ),
+    [MIB_REPEATER_SUPPORT]          = MIB_NVM_FIELD( RepeaterSupport, EnableRepeaterSupport, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_RX2_CHANNEL]               = MIB_NVM_FIELD( MacParams.Rx2Channel, Rx2Channel, MIB_NVM_FIELD_GET ),
+    [MIB_RX2_DEFAULT_CHANNEL]       = MIB_NVM_FIELD( MacParamsDefaults.Rx2Channel, Rx2DefaultChannel, MIB_NVM_FIELD_GET ),
+    [MIB_RXC_CHANNEL]               = MIB_NVM_FIELD( MacParams.RxCChannel, RxCChannel, MIB_NVM_FIELD_GET ),
+    [MIB_RXC_DEFAULT_CHANNEL]       = MIB_NVM_FIELD( MacParamsDefaults.RxCChannel, RxCDefaultChannel, MIB_NVM_FIELD_GET ),
+    [MIB_CHANNELS_NB_TRANS]         = MIB_NVM_FIELD( MacParams.ChannelsNbTrans, ChannelsNbTrans, MIB_NVM_FIELD_GET ),
+    [MIB_MAX_RX_WINDOW_DURATION]    = MIB_NVM_FIELD( MacParams.MaxRxWindow, MaxRxWindow, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_RECEIVE_DELAY_1]           = MIB_NVM_FIELD( MacParams.ReceiveDelay1, ReceiveDelay1, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_RECEIVE_DELAY_2]           = MIB_NVM_FIELD( MacParams.ReceiveDelay2, ReceiveDelay2, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_JOIN_ACCEPT_DELAY_1]       = MIB_NVM_FIELD( MacParams.JoinAcceptDelay1, JoinAcceptDelay1, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_JOIN_ACCEPT_DELAY_2]       = MIB_NVM_FIELD( MacParams.JoinAcceptDelay2, JoinAcceptDelay2, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_CHANNELS_DEFAULT_DATARATE] = MIB_NVM_FIELD( MacParamsDefaults.ChannelsDatarate, ChannelsDefaultDatarate, MIB_NVM_FIELD_GET ),
+    [MIB_CHANNELS_DATARATE]         = MIB_NVM_FIELD( MacParams.ChannelsDatarate, ChannelsDatarate, MIB_NVM_FIELD_GET ),
+    [MIB_CHANNELS_TX_POWER]         = MIB_NVM_FIELD( MacParams.ChannelsTxPower, ChannelsTxPower, MIB_NVM_FIELD_GET ),
+    [MIB_CHANNELS_DEFAULT_TX_POWER] = MIB_NVM_FIELD( MacParamsDefaults.ChannelsTxPower, ChannelsDefaultTxPower, MIB_NVM_FIELD_GET ),
+    [MIB_SYSTEM_MAX_RX_ERROR]       = MIB_NVM_FIELD( MacParams.SystemMaxRxError, SystemMaxRxError, MIB_NVM_FIELD_GET ),
+    [MIB_MIN_RX_SYMBOLS]            = MIB_NVM_FIELD( MacParams.MinRxSymbols, MinRxSymbols, MIB_NVM_FIELD_GET ),
+    [MIB_ANTENNA_GAIN]              = MIB_NVM_FIELD( MacParams.AntennaGain, AntennaGain, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_DEFAULT_ANTENNA_GAIN]      = MIB_NVM_FIELD( MacParamsDefaults.AntennaGain, DefaultAntennaGain, MIB_NVM_FIELD_GET | MIB_NVM_FIELD_SET ),
+    [MIB_RXC_DUTY_CYCLE]            = MIB_NVM_FIELD( MacParams.RxCDutyCycle, RxCDutyCycle, MIB_NVM_FIELD_GET ),
+};
+
+/*!
+ * Key identifiers of the MIB key attributes, indexed by \ref Mib_t starting
+ * from \ref MIB_GEN_APP_KEY
+ */
+static const KeyIdentifier_t MibKeyIds[] =
+{
+    GEN_APP_KEY, APP_KEY, NWK_KEY, J_S_INT_KEY, J_S_ENC_KEY, F_NWK_S_INT_KEY, S_NWK_S_INT_KEY, NWK_S_ENC_KEY, APP_S_KEY,
+    MC_KE_KEY,
+    MC_KEY_0, MC_APP_S_KEY_0, MC_NWK_S_KEY_0,
+    MC_KEY_1, MC_APP_S_KEY_1, MC_NWK_S_KEY_1,
+    MC_KEY_2, MC_APP_S_KEY_2, MC_NWK_S_KEY_2,
+    MC_KEY_3, MC_APP_S_KEY_3, MC_NWK_S_KEY_3,
+};
+
+/*!
+ * \brief Returns the plain NVM field descriptor of a MIB attribute
+ *
+ * \param [IN] type   MIB attribute
+ * \param [IN] access Requested access
+ *
+ * \retval field Descriptor, NULL when the attribute needs a dedicated handling
+ */
+static const MibNvmField_t* GetMibNvmField( Mib_t type, uint8_t access )
+{
+    if( ( ( size_t )type < ( sizeof( MibNvmFields ) / sizeof( MibNvmFields[0] ) ) ) &&
+        ( MibNvmFields[type].Size != 0 ) && ( ( MibNvmFields[type].Access & access ) != 0 ) )
+    {
+        return &MibNvmFields[type];
+    }
+    return NULL;
+}
+
+LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
+{
+    const MibNvmField_t* field;
+    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
+    GetPhyParams_t getPhy;
+    PhyParam_t phyParam;
+
+    if( mibGet == NULL )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+
+    field = GetMibNvmField( mibGet->Type, MIB_NVM_FIELD_GET );
+    if( field != NULL )
+    {
+        memcpy1( ( uint8_t* )&mibGet->Param, ( uint8_t* )MacCtx.NvmCtx + field->Offset, field->Size );
+        return LORAMAC_STATUS_OK;
+    }
+
+    switch( mibGet->Type )
+    {
+        case MIB_DEV_EUI:
         {
             mibGet->Param.DevEui = SecureElementGetDevEui( );
             break;
@@ -3526,31 +5374,6 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.JoinEui = SecureElementGetJoinEui( );
             break;
         }
-        case MIB_ADR:
-        {
-            mibGet->Param.AdrEnable = MacCtx.NvmCtx->AdrCtrlOn;
-            break;
-        }
-        case MIB_NET_ID:
-        {
-            mibGet->Param.NetID = MacCtx.NvmCtx->NetID;
-            break;
-        }
-        case MIB_DEV_ADDR:
-        {
-            mibGet->Param.DevAddr = MacCtx.NvmCtx->DevAddr;
-            break;
-        }
-        case MIB_PUBLIC_NETWORK:
-        {
-            mibGet->Param.EnablePublicNetwork = MacCtx.NvmCtx->PublicNetwork;
-            break;
-        }
-        case MIB_REPEATER_SUPPORT:
-        {
-            mibGet->Param.EnableRepeaterSupport = MacCtx.NvmCtx->RepeaterSupport;
-            break;
-        }
         case MIB_CHANNELS:
         {
             getPhy.Attribute = PHY_CHANNELS;
@@ -3559,26 +5382,6 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.ChannelList = phyParam.Channels;
             break;
         }
-        case MIB_RX2_CHANNEL:
-        {
-            mibGet->Param.Rx2Channel = MacCtx.NvmCtx->MacParams.Rx2Channel;
-            break;
-        }
-        case MIB_RX2_DEFAULT_CHANNEL:
-        {
-            mibGet->Param.Rx2Channel = MacCtx.NvmCtx->MacParamsDefaults.Rx2Channel;
-            break;
-        }
-        case MIB_RXC_CHANNEL:
-        {
-            mibGet->Param.RxCChannel = MacCtx.NvmCtx->MacParams.RxCChannel;
-            break;
-        }
-        case MIB_RXC_DEFAULT_CHANNEL:
-        {
-            mibGet->Param.RxCChannel = MacCtx.NvmCtx->MacParamsDefaults.RxCChannel;
-            break;
-        }
         case MIB_CHANNELS_DEFAULT_MASK:
         {
             getPhy.Attribute = PHY_CHANNELS_DEFAULT_MASK;
@@ -3595,81 +5398,79 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
             mibGet->Param.ChannelsMask = phyParam.ChannelsMask;
             break;
         }
-        case MIB_CHANNELS_NB_TRANS:
-        {
-            mibGet->Param.ChannelsNbTrans = MacCtx.NvmCtx->MacParams.ChannelsNbTrans;
-            break;
-        }
-        case MIB_MAX_RX_WINDOW_DURATION:
-        {
-            mibGet->Param.MaxRxWindow = MacCtx.NvmCtx->MacParams.MaxRxWindow;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_1:
-        {
-            mibGet->Param.ReceiveDelay1 = MacCtx.NvmCtx->MacParams.ReceiveDelay1;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_2:
-        {
-            mibGet->Param.ReceiveDelay2 = MacCtx.NvmCtx->MacParams.ReceiveDelay2;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_1:
-        {
-            mibGet->Param.JoinAcceptDelay1 = MacCtx.NvmCtx->MacParams.JoinAcceptDelay1;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_2:
+        case MIB_NVM_CTXS:
         {
-            mibGet->Param.JoinAcceptDelay2 = MacCtx.NvmCtx->MacParams.JoinAcceptDelay2;
+            mibGet->Param.Contexts = GetCtxs( );
             break;
         }
-        case MIB_CHANNELS_DEFAULT_DATARATE:
+        case MIB_RX_FILTERED_FRAMES:
         {
-            mibGet->Param.ChannelsDefaultDatarate = MacCtx.NvmCtx->MacParamsDefaults.ChannelsDatarate;
+            mibGet->Param.RxFilteredFrames = MacCtx.RxFilteredFrames;
             break;
         }
-        case MIB_CHANNELS_DATARATE:
+        case MIB_ADAPTIVE_RX_ERROR:
         {
-            mibGet->Param.ChannelsDatarate = MacCtx.NvmCtx->MacParams.ChannelsDatarate;
+            mibGet->Param.AdaptiveRxError = MacCtx.AdaptiveRxError;
             break;
         }
-        case MIB_CHANNELS_DEFAULT_TX_POWER:
+        case MIB_RX_ERROR_ESTIMATE:
         {
-            mibGet->Param.ChannelsDefaultTxPower = MacCtx.NvmCtx->MacParamsDefaults.ChannelsTxPower;
+            mibGet->Param.RxErrorEstimate = GetRxWindowRxError( );
             break;
         }
-        case MIB_CHANNELS_TX_POWER:
+        case MIB_CHANNELS_WEIGHTING:
         {
-            mibGet->Param.ChannelsTxPower = MacCtx.NvmCtx->MacParams.ChannelsTxPower;
+            mibGet->Param.ChannelsWeighting = MacCtx.ChannelsWeighting;
             break;
         }
-        case MIB_SYSTEM_MAX_RX_ERROR:
+        case MIB_NB_TRANS_SKIP_RX:
         {
-            mibGet->Param.SystemMaxRxError = MacCtx.NvmCtx->MacParams.SystemMaxRxError;
+            mibGet->Param.NbTransSkipRx = MacCtx.NbTransSkipRx;
             break;
         }
-        case MIB_MIN_RX_SYMBOLS:
+        case MIB_MAC_COMMANDS_DEFER:
         {
-            mibGet->Param.MinRxSymbols = MacCtx.NvmCtx->MacParams.MinRxSymbols;
+            mibGet->Param.MacCommandsDefer = MacCtx.MacCommandsDefer;
             break;
         }
-        case MIB_ANTENNA_GAIN:
+        case MIB_RX_BOOSTED:
         {
-            mibGet->Param.AntennaGain = MacCtx.NvmCtx->MacParams.AntennaGain;
+            mibGet->Param.RxBoosted = MacCtx.RxBoosted;
             break;
         }
-        case MIB_NVM_CTXS:
+        case MIB_CHANNELS_STATS:
         {
-            mibGet->Param.Contexts = GetCtxs( );
+            LoRaMacChannelStats_t* stats = LoRaMacAdrGetChannelStats( );
+            uint32_t nbChannels;
+
+            getPhy.Attribute = PHY_MAX_NB_CHANNELS;
+            phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+            nbChannels = MIN( phyParam.Value, LORAMAC_CHANNELS_STATS_SIZE );
+
+            getPhy.Attribute = PHY_LBT_BUSY_HISTORY;
+            phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
+
+            // The busy history of the listen before talk is kept by the region
+            for( uint8_t i = 0; ( phyParam.BusyHistory != NULL ) && ( i < nbChannels ); i++ )
+            {
+                uint8_t nbBusy = 0;
+
+                for( uint8_t busy = phyParam.BusyHistory[i]; busy != 0; busy &= busy - 1 )
+                {
+                    nbBusy++;
+                }
+                stats[i].NbLbtBusy = nbBusy;
+            }
+            mibGet->Param.ChannelsStats = stats;
             break;
         }
-        case MIB_DEFAULT_ANTENNA_GAIN:
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+        case MIB_LATENCY_STATS:
         {
-            mibGet->Param.DefaultAntennaGain = MacCtx.NvmCtx->MacParamsDefaults.AntennaGain;
+            mibGet->Param.LatencyStats = &LatencyStats;
             break;
         }
+#endif
         default:
         {
             status = LoRaMacClassBMibGetRequestConfirm( mibGet );
@@ -3681,6 +5482,7 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet )
 
 LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
 {
+    const MibNvmField_t* field;
     LoRaMacStatus_t status = LORAMAC_STATUS_OK;
     ChanMaskSetParams_t chanMaskSet;
     VerifyParams_t verify;
@@ -3694,381 +5496,72 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
         return LORAMAC_STATUS_BUSY;
     }
 
-    switch( mibSet->Type )
+    field = GetMibNvmField( mibSet->Type, MIB_NVM_FIELD_SET );
+    if( field != NULL )
     {
-        case MIB_DEVICE_CLASS:
-        {
-            status = SwitchClass( mibSet->Param.Class );
-            break;
-        }
-        case MIB_NETWORK_ACTIVATION:
-        {
-            if( mibSet->Param.NetworkActivation != ACTIVATION_TYPE_OTAA  )
-            {
-                MacCtx.NvmCtx->NetworkActivation = mibSet->Param.NetworkActivation;
-            }
-            else
-            {   // Do not allow to set ACTIVATION_TYPE_OTAA since the MAC will set it automatically after a successful join process.
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_DEV_EUI:
-        {
-            if( SecureElementSetDevEui( mibSet->Param.DevEui ) != SECURE_ELEMENT_SUCCESS )
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_JOIN_EUI:
-        {
-            if( SecureElementSetJoinEui( mibSet->Param.JoinEui ) != SECURE_ELEMENT_SUCCESS )
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_ADR:
-        {
-            MacCtx.NvmCtx->AdrCtrlOn = mibSet->Param.AdrEnable;
-            break;
-        }
-        case MIB_NET_ID:
-        {
-            MacCtx.NvmCtx->NetID = mibSet->Param.NetID;
-            break;
-        }
-        case MIB_DEV_ADDR:
-        {
-            MacCtx.NvmCtx->DevAddr = mibSet->Param.DevAddr;
-            break;
-        }
-        case MIB_GEN_APP_KEY:
-        {
-            if( mibSet->Param.GenAppKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( GEN_APP_KEY, mibSet->Param.GenAppKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_APP_KEY:
-        {
-            if( mibSet->Param.AppKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( APP_KEY, mibSet->Param.AppKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_NWK_KEY:
-        {
-            if( mibSet->Param.NwkKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( NWK_KEY, mibSet->Param.NwkKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_J_S_INT_KEY:
-        {
-            if( mibSet->Param.JSIntKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( J_S_INT_KEY, mibSet->Param.JSIntKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_J_S_ENC_KEY:
-        {
-            if( mibSet->Param.JSEncKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( J_S_ENC_KEY, mibSet->Param.JSEncKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_F_NWK_S_INT_KEY:
-        {
-            if( mibSet->Param.FNwkSIntKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( F_NWK_S_INT_KEY, mibSet->Param.FNwkSIntKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_S_NWK_S_INT_KEY:
-        {
-            if( mibSet->Param.SNwkSIntKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( S_NWK_S_INT_KEY, mibSet->Param.SNwkSIntKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_NWK_S_ENC_KEY:
-        {
-            if( mibSet->Param.NwkSEncKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( NWK_S_ENC_KEY, mibSet->Param.NwkSEncKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_APP_S_KEY:
-        {
-            if( mibSet->Param.AppSKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( APP_S_KEY, mibSet->Param.AppSKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_KE_KEY:
-        {
-            if( mibSet->Param.McKEKey != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_KE_KEY, mibSet->Param.McKEKey ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_KEY_0:
-        {
-            if( mibSet->Param.McKey0 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_KEY_0, mibSet->Param.McKey0 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_APP_S_KEY_0:
-        {
-            if( mibSet->Param.McAppSKey0 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_APP_S_KEY_0, mibSet->Param.McAppSKey0 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_NWK_S_KEY_0:
-        {
-            if( mibSet->Param.McNwkSKey0 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_NWK_S_KEY_0, mibSet->Param.McNwkSKey0 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_KEY_1:
-        {
-            if( mibSet->Param.McKey1 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_KEY_1, mibSet->Param.McKey1 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_APP_S_KEY_1:
-        {
-            if( mibSet->Param.McAppSKey1 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_APP_S_KEY_1, mibSet->Param.McAppSKey1 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_NWK_S_KEY_1:
-        {
-            if( mibSet->Param.McNwkSKey1 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_NWK_S_KEY_1, mibSet->Param.McNwkSKey1 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_KEY_2:
-        {
-            if( mibSet->Param.McKey2 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_KEY_2, mibSet->Param.McKey2 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
-        }
-        case MIB_MC_APP_S_KEY_2:
-        {
-            if( mibSet->Param.McAppSKey2 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_APP_S_KEY_2, mibSet->Param.McAppSKey2 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
-            {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
-            }
-            break;
+        memcpy1( ( uint8_t* )MacCtx.NvmCtx + field->Offset, ( uint8_t* )&mibSet->Param, field->Size );
+        EventMacNvmCtxChanged( );
+        return LORAMAC_STATUS_OK;
+    }
+
+    if( ( mibSet->Type >= MIB_GEN_APP_KEY ) && ( mibSet->Type <= MIB_MC_NWK_S_KEY_3 ) )
+    {
+        // All the key attributes share the same pointer layout in MibParam_t
+        if( mibSet->Param.GenAppKey == NULL )
+        {
+            return LORAMAC_STATUS_PARAMETER_INVALID;
         }
-        case MIB_MC_NWK_S_KEY_2:
+        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MibKeyIds[mibSet->Type - MIB_GEN_APP_KEY], mibSet->Param.GenAppKey ) )
         {
-            if( mibSet->Param.McNwkSKey2 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_NWK_S_KEY_2, mibSet->Param.McNwkSKey2 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
+            return LORAMAC_STATUS_CRYPTO_ERROR;
+        }
+        EventMacNvmCtxChanged( );
+        return LORAMAC_STATUS_OK;
+    }
+
+    switch( mibSet->Type )
+    {
+        case MIB_DEVICE_CLASS:
+        {
+            DeviceClass_t deviceClass = MacCtx.NvmCtx->DeviceClass;
+            RxChannelParams_t rxCChannel = MacCtx.NvmCtx->MacParams.RxCChannel;
+
+            status = SwitchClass( mibSet->Param.Class );
+
+            // A class switch only touches the MAC context, and is notified
+            // only when it changes the stored fields. The deferred stores of
+            // NvmCtxMgmt then coalesce back and forth switches.
+            if( ( MacCtx.NvmCtx->DeviceClass != deviceClass ) ||
+                ( MacCtx.NvmCtx->MacParams.RxCChannel.Frequency != rxCChannel.Frequency ) ||
+                ( MacCtx.NvmCtx->MacParams.RxCChannel.Datarate != rxCChannel.Datarate ) )
             {
-                status = LORAMAC_STATUS_PARAMETER_INVALID;
+                EventMacNvmCtxChanged( );
             }
-            break;
+            return status;
         }
-        case MIB_MC_KEY_3:
+        case MIB_NETWORK_ACTIVATION:
         {
-            if( mibSet->Param.McKey3 != NULL )
+            if( mibSet->Param.NetworkActivation != ACTIVATION_TYPE_OTAA  )
             {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_KEY_3, mibSet->Param.McKey3 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
+                MacCtx.NvmCtx->NetworkActivation = mibSet->Param.NetworkActivation;
             }
             else
-            {
+            {   // Do not allow to set ACTIVATION_TYPE_OTAA since the MAC will set it automatically after a successful join process.
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
             break;
         }
-        case MIB_MC_APP_S_KEY_3:
+        case MIB_DEV_EUI:
         {
-            if( mibSet->Param.McAppSKey3 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_APP_S_KEY_3, mibSet->Param.McAppSKey3 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
+            if( SecureElementSetDevEui( mibSet->Param.DevEui ) != SECURE_ELEMENT_SUCCESS )
             {
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
             break;
         }
-        case MIB_MC_NWK_S_KEY_3:
+        case MIB_JOIN_EUI:
         {
-            if( mibSet->Param.McNwkSKey3 != NULL )
-            {
-                if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( MC_NWK_S_KEY_3, mibSet->Param.McNwkSKey3 ) )
-                {
-                    return LORAMAC_STATUS_CRYPTO_ERROR;
-                }
-            }
-            else
+            if( SecureElementSetJoinEui( mibSet->Param.JoinEui ) != SECURE_ELEMENT_SUCCESS )
             {
                 status = LORAMAC_STATUS_PARAMETER_INVALID;
             }
@@ -4080,11 +5573,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             Radio.SetPublicNetwork( MacCtx.NvmCtx->PublicNetwork );
             break;
         }
-        case MIB_REPEATER_SUPPORT:
-        {
-            MacCtx.NvmCtx->RepeaterSupport = mibSet->Param.EnableRepeaterSupport;
-            break;
-        }
         case MIB_RX2_CHANNEL:
         {
             verify.DatarateParams.Datarate = mibSet->Param.Rx2Channel.Datarate;
@@ -4191,31 +5679,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
-        case MIB_MAX_RX_WINDOW_DURATION:
-        {
-            MacCtx.NvmCtx->MacParams.MaxRxWindow = mibSet->Param.MaxRxWindow;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_1:
-        {
-            MacCtx.NvmCtx->MacParams.ReceiveDelay1 = mibSet->Param.ReceiveDelay1;
-            break;
-        }
-        case MIB_RECEIVE_DELAY_2:
-        {
-            MacCtx.NvmCtx->MacParams.ReceiveDelay2 = mibSet->Param.ReceiveDelay2;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_1:
-        {
-            MacCtx.NvmCtx->MacParams.JoinAcceptDelay1 = mibSet->Param.JoinAcceptDelay1;
-            break;
-        }
-        case MIB_JOIN_ACCEPT_DELAY_2:
-        {
-            MacCtx.NvmCtx->MacParams.JoinAcceptDelay2 = mibSet->Param.JoinAcceptDelay2;
-            break;
-        }
         case MIB_CHANNELS_DEFAULT_DATARATE:
         {
             verify.DatarateParams.Datarate = mibSet->Param.ChannelsDefaultDatarate;
@@ -4283,16 +5746,6 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             MacCtx.NvmCtx->MacParams.MinRxSymbols = MacCtx.NvmCtx->MacParamsDefaults.MinRxSymbols = mibSet->Param.MinRxSymbols;
             break;
         }
-        case MIB_ANTENNA_GAIN:
-        {
-            MacCtx.NvmCtx->MacParams.AntennaGain = mibSet->Param.AntennaGain;
-            break;
-        }
-        case MIB_DEFAULT_ANTENNA_GAIN:
-        {
-            MacCtx.NvmCtx->MacParamsDefaults.AntennaGain = mibSet->Param.DefaultAntennaGain;
-            break;
-        }
         case MIB_NVM_CTXS:
         {
             if( mibSet->Param.Contexts != 0 )
@@ -4322,6 +5775,76 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
             }
             break;
         }
+        case MIB_RXC_DUTY_CYCLE:
+        {
+            // Radio periods are limited to 24 bits in steps of 15.625 us
+            if( ( mibSet->Param.RxCDutyCycle.SleepTime != 0 ) &&
+                ( ( mibSet->Param.RxCDutyCycle.RxTime == 0 ) ||
+                  ( mibSet->Param.RxCDutyCycle.RxTime > RXC_DUTY_CYCLE_MAX_PERIOD ) ||
+                  ( mibSet->Param.RxCDutyCycle.SleepTime > RXC_DUTY_CYCLE_MAX_PERIOD ) ) )
+            {
+                status = LORAMAC_STATUS_PARAMETER_INVALID;
+            }
+            else
+            {
+                MacCtx.NvmCtx->MacParams.RxCDutyCycle = mibSet->Param.RxCDutyCycle;
+                if( MacCtx.RxSlot == RX_SLOT_WIN_CLASS_C )
+                {
+                    // Apply the new settings
+                    Radio.Standby( );
+                    OpenContinuousRxCWindow( );
+                }
+            }
+            break;
+        }
+        case MIB_ADAPTIVE_RX_ERROR:
+        {
+            MacCtx.AdaptiveRxError = mibSet->Param.AdaptiveRxError;
+            // Restart learning from the system maximum
+            MacCtx.RxErrorEstimate = 0;
+            break;
+        }
+        case MIB_CHANNELS_WEIGHTING:
+        {
+            MacCtx.ChannelsWeighting = mibSet->Param.ChannelsWeighting;
+            break;
+        }
+        case MIB_NB_TRANS_SKIP_RX:
+        {
+            MacCtx.NbTransSkipRx = mibSet->Param.NbTransSkipRx;
+            break;
+        }
+        case MIB_MAC_COMMANDS_DEFER:
+        {
+            MacCtx.MacCommandsDefer = mibSet->Param.MacCommandsDefer;
+            MacCtx.MacCommandsDeferCounter = 0;
+            break;
+        }
+        case MIB_RX_BOOSTED:
+        {
+            if( ( mibSet->Param.RxBoosted > LORAMAC_RX_BOOSTED_AUTO ) ||
+                ( ( mibSet->Param.RxBoosted != LORAMAC_RX_BOOSTED_OFF ) && ( Radio.RxBoosted == NULL ) ) )
+            {
+                status = LORAMAC_STATUS_PARAMETER_INVALID;
+            }
+            else
+            {
+                MacCtx.RxBoosted = mibSet->Param.RxBoosted;
+            }
+            break;
+        }
+        case MIB_CHANNELS_STATS:
+        {
+            LoRaMacAdrResetChannelStats( );
+            break;
+        }
+#if defined( LORAMAC_LATENCY_STATS_ENABLED )
+        case MIB_LATENCY_STATS:
+        {
+            memset1( ( uint8_t* )&LatencyStats, 0, sizeof( LatencyStats ) );
+            break;
+        }
+#endif
         default:
         {
             status = LoRaMacMibClassBSetRequestConfirm( mibSet );
@@ -4333,6 +5856,36 @@ LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet )
     return status;
 }
 
+LoRaMacStatus_t LoRaMacMibGetRequestConfirmBulk( MibRequestConfirm_t* mibGet, uint8_t nbItems )
+{
+    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
+
+    if( mibGet == NULL )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    for( uint8_t i = 0; ( i < nbItems ) && ( status == LORAMAC_STATUS_OK ); i++ )
+    {
+        status = LoRaMacMibGetRequestConfirm( &mibGet[i] );
+    }
+    return status;
+}
+
+LoRaMacStatus_t LoRaMacMibSetRequestConfirmBulk( MibRequestConfirm_t* mibSet, uint8_t nbItems )
+{
+    LoRaMacStatus_t status = LORAMAC_STATUS_OK;
+
+    if( mibSet == NULL )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    for( uint8_t i = 0; ( i < nbItems ) && ( status == LORAMAC_STATUS_OK ); i++ )
+    {
+        status = LoRaMacMibSetRequestConfirm( &mibSet[i] );
+    }
+    return status;
+}
+
 LoRaMacStatus_t LoRaMacChannelAdd( uint8_t id, ChannelParams_t params )
 {
     ChannelAddParams_t channelAdd;
@@ -4378,53 +5931,81 @@ LoRaMacStatus_t LoRaMacChannelRemove( uint8_t id )
 
 LoRaMacStatus_t LoRaMacMcChannelSetup( McChannelParams_t *channel )
 {
+    return LoRaMacMcChannelsSetup( channel, 1 );
+}
+
+LoRaMacStatus_t LoRaMacMcChannelsSetup( McChannelParams_t *channels, uint8_t nbChannels )
+{
+    LoRaMacCryptoMcGroupKeys_t mcGroupKeys[LORAMAC_MAX_MC_CTX];
+    uint8_t nbMcGroupKeys = 0;
+
     if( ( MacCtx.MacState & LORAMAC_TX_RUNNING ) == LORAMAC_TX_RUNNING )
     {
         return LORAMAC_STATUS_BUSY;
     }
+    MacCtx.RxCPrepared = false;
 
-    if( channel->GroupID >= LORAMAC_MAX_MC_CTX )
+    if( ( channels == NULL ) || ( nbChannels > LORAMAC_MAX_MC_CTX ) )
     {
-        return LORAMAC_STATUS_MC_GROUP_UNDEFINED;
+        return LORAMAC_STATUS_PARAMETER_INVALID;
     }
 
-    MacCtx.NvmCtx->MulticastChannelList[channel->GroupID].ChannelParams = *channel;
-
-    if( channel->IsRemotelySetup == true )
+    for( uint8_t i = 0; i < nbChannels; i++ )
     {
-        const KeyIdentifier_t mcKeys[LORAMAC_MAX_MC_CTX] = { MC_KEY_0, MC_KEY_1, MC_KEY_2, MC_KEY_3 };
-        if( LoRaMacCryptoSetKey( mcKeys[channel->GroupID], channel->McKeys.McKeyE ) != LORAMAC_CRYPTO_SUCCESS )
+        McChannelParams_t *channel = &channels[i];
+
+        if( channel->GroupID >= LORAMAC_MAX_MC_CTX )
         {
-            return LORAMAC_STATUS_CRYPTO_ERROR;
+            return LORAMAC_STATUS_MC_GROUP_UNDEFINED;
         }
 
-        if( LoRaMacCryptoDeriveMcSessionKeyPair( channel->GroupID, channel->Address ) != LORAMAC_CRYPTO_SUCCESS )
+        MacCtx.NvmCtx->MulticastChannelList[channel->GroupID].ChannelParams = *channel;
+
+        if( channel->IsRemotelySetup == true )
         {
-            return LORAMAC_STATUS_CRYPTO_ERROR;
+            // The keys of all the remotely set up groups are derived in one batch
+            mcGroupKeys[nbMcGroupKeys].AddrID = channel->GroupID;
+            mcGroupKeys[nbMcGroupKeys].McAddr = channel->Address;
+            mcGroupKeys[nbMcGroupKeys].McKeyE = channel->McKeys.McKeyE;
+            nbMcGroupKeys++;
         }
-    }
-    else
-    {
-        const KeyIdentifier_t mcAppSKeys[LORAMAC_MAX_MC_CTX] = { MC_APP_S_KEY_0, MC_APP_S_KEY_1, MC_APP_S_KEY_2, MC_APP_S_KEY_3 };
-        const KeyIdentifier_t mcNwkSKeys[LORAMAC_MAX_MC_CTX] = { MC_NWK_S_KEY_0, MC_NWK_S_KEY_1, MC_NWK_S_KEY_2, MC_NWK_S_KEY_3 };
-        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( mcAppSKeys[channel->GroupID], channel->McKeys.McAppSKey ) )
+        else
         {
-            return LORAMAC_STATUS_CRYPTO_ERROR;
+            const KeyIdentifier_t mcAppSKeys[] = { MC_APP_S_KEY_0, MC_APP_S_KEY_1, MC_APP_S_KEY_2, MC_APP_S_KEY_3 };
+            const KeyIdentifier_t mcNwkSKeys[] = { MC_NWK_S_KEY_0, MC_NWK_S_KEY_1, MC_NWK_S_KEY_2, MC_NWK_S_KEY_3 };
+            if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( mcAppSKeys[channel->GroupID], channel->McKeys.McAppSKey ) )
+            {
+                return LORAMAC_STATUS_CRYPTO_ERROR;
+            }
+            if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( mcNwkSKeys[channel->GroupID], channel->McKeys.McNwkSKey ) )
+            {
+                return LORAMAC_STATUS_CRYPTO_ERROR;
+            }
         }
-        if( LORAMAC_CRYPTO_SUCCESS != LoRaMacCryptoSetKey( mcNwkSKeys[channel->GroupID], channel->McKeys.McNwkSKey ) )
+    }
+
+    if( nbMcGroupKeys > 0 )
+    {
+        if( LoRaMacCryptoDeriveMcSessionKeyPairs( mcGroupKeys, nbMcGroupKeys ) != LORAMAC_CRYPTO_SUCCESS )
         {
             return LORAMAC_STATUS_CRYPTO_ERROR;
         }
     }
 
-    if( channel->Class == CLASS_B )
+    for( uint8_t i = 0; i < nbChannels; i++ )
     {
-        // Calculate class b parameters
-        LoRaMacClassBSetMulticastPeriodicity( &MacCtx.NvmCtx->MulticastChannelList[channel->GroupID] );
-    }
+        MulticastCtx_t *mcCtx = &MacCtx.NvmCtx->MulticastChannelList[channels[i].GroupID];
+
+        if( channels[i].Class == CLASS_B )
+        {
+            // Calculate class b parameters
+            LoRaMacClassBSetMulticastPeriodicity( mcCtx );
+        }
 
-    // Reset multicast channel downlink counter to initial value.
-    *MacCtx.NvmCtx->MulticastChannelList[channel->GroupID].DownLinkCounter = FCNT_DOWN_INITAL_VALUE;
+        // Reset multicast channel downlink counter to initial value.
+        *mcCtx->DownLinkCounter = FCNT_DOWN_INITAL_VALUE;
+    }
+    UpdateMcAddrIndex( );
 
     EventMacNvmCtxChanged( );
     EventRegionNvmCtxChanged( );
@@ -4437,6 +6018,7 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
     {
         return LORAMAC_STATUS_BUSY;
     }
+    MacCtx.RxCPrepared = false;
 
     if( ( groupID >= LORAMAC_MAX_MC_CTX ) || 
         ( MacCtx.NvmCtx->MulticastChannelList[groupID].ChannelParams.IsEnabled == false ) )
@@ -4450,6 +6032,7 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
     memset1( ( uint8_t* )&channel, 0, sizeof( McChannelParams_t ) );
 
     MacCtx.NvmCtx->MulticastChannelList[groupID].ChannelParams = channel;
+    UpdateMcAddrIndex( );
 
     EventMacNvmCtxChanged( );
     EventRegionNvmCtxChanged( );
@@ -4458,14 +6041,38 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID )
 
 uint8_t LoRaMacMcChannelGetGroupId( uint32_t mcAddress )
 {
-    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    MulticastCtx_t* mcCtx = FindMcGroup( mcAddress );
+
+    if( mcCtx == NULL )
     {
-        if( mcAddress == MacCtx.NvmCtx->MulticastChannelList[i].ChannelParams.Address )
-        {
-            return i;
-        }
+        return 0xFF;
+    }
+    return mcCtx->ChannelParams.GroupID;
+}
+
+LoRaMacStatus_t LoRaMacClassCPrepare( void )
+{
+#if defined( LORAMAC_INSTANCES_ENABLED )
+    // The other instances share the radio
+    return LORAMAC_STATUS_SERVICE_UNKNOWN;
+#else
+    if( ( LoRaMacIsBusy( ) == true ) || ( MacCtx.NvmCtx->DeviceClass != CLASS_A ) )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+
+    SetupRxCWindowChannel( );
+    StopRxCSniff( );
+    // Wakes the radio up, the settings are loaded in standby mode
+    Radio.Standby( );
+    MacCtx.RxCPrepared = ConfigureContinuousRxCWindow( );
+    if( MacCtx.RxCPrepared == false )
+    {
+        Radio.Sleep( );
+        return LORAMAC_STATUS_PARAMETER_INVALID;
     }
-    return 0xFF;
+    return LORAMAC_STATUS_OK;
+#endif
 }
 
 LoRaMacStatus_t LoRaMacMcChannelSetupRxParams( AddressIdentifier_t groupID, McRxParams_t *rxParams, uint8_t *status )
@@ -4525,6 +6132,7 @@ LoRaMacStatus_t LoRaMacMcChannelSetupRxParams( AddressIdentifier_t groupID, McRx
     {
         // Apply parameters
         MacCtx.NvmCtx->MulticastChannelList[groupID].ChannelParams.RxParams = *rxParams;
+        MacCtx.RxCPrepared = false;
     }
 
     EventMacNvmCtxChanged( );
@@ -4546,6 +6154,8 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
     {
         return LORAMAC_STATUS_BUSY;
     }
+    // The request reconfigures the radio
+    MacCtx.RxCPrepared = false;
     if( LoRaMacConfirmQueueIsFull( ) == true )
     {
         return LORAMAC_STATUS_BUSY;
@@ -4685,8 +6295,6 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest )
 
 LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
 {
-    GetPhyParams_t getPhy;
-    PhyParam_t phyParam;
     LoRaMacStatus_t status = LORAMAC_STATUS_SERVICE_UNKNOWN;
     LoRaMacHeader_t macHdr;
     VerifyParams_t verify;
@@ -4704,6 +6312,8 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
     {
         return LORAMAC_STATUS_BUSY;
     }
+    // The uplink and its Rx windows reconfigure the radio
+    MacCtx.RxCPrepared = false;
 
     macHdr.Value = 0;
     memset1( ( uint8_t* ) &MacCtx.McpsConfirm, 0, sizeof( MacCtx.McpsConfirm ) );
@@ -4753,13 +6363,9 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
             break;
     }
 
-    // Get the minimum possible datarate
-    getPhy.Attribute = PHY_MIN_TX_DR;
-    getPhy.UplinkDwellTime = MacCtx.NvmCtx->MacParams.UplinkDwellTime;
-    phyParam = RegionGetPhyParam( MacCtx.NvmCtx->Region, &getPhy );
     // Apply the minimum possible datarate.
     // Some regions have limitations for the minimum datarate.
-    datarate = MAX( datarate, ( int8_t )phyParam.Value );
+    datarate = MAX( datarate, GetMinTxDatarate( ) );
 
     if( readyToSend == true )
     {
@@ -4794,6 +6400,37 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest )
     return status;
 }
 
+LoRaMacStatus_t LoRaMacMcpsEnqueue( McpsReq_t* mcpsRequest, uint8_t priority )
+{
+    if( mcpsRequest == NULL )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+
+    if( ( LoRaMacIsBusy( ) == false ) && ( LoRaMacTxQueueGetCnt( ) == 0 ) )
+    {
+        LoRaMacStatus_t status = LoRaMacMcpsRequest( mcpsRequest );
+
+        if( ( status != LORAMAC_STATUS_DUTYCYCLE_RESTRICTED ) || ( MacCtx.DutyCycleWaitTime == 0 ) )
+        {
+            return status;
+        }
+        // Queue the request until the duty cycle allows it
+        TimerSetValue( &MacCtx.TxQueueTimer, MacCtx.DutyCycleWaitTime );
+        TimerStart( &MacCtx.TxQueueTimer );
+    }
+
+    if( LoRaMacTxQueueGetCnt( ) >= LORAMAC_TX_QUEUE_LEN )
+    {
+        return LORAMAC_STATUS_BUSY;
+    }
+    if( LoRaMacTxQueueAdd( mcpsRequest, priority ) == false )
+    {
+        return LORAMAC_STATUS_PARAMETER_INVALID;
+    }
+    return LORAMAC_STATUS_OK;
+}
+
 void LoRaMacTestSetDutyCycleOn( bool enable )
 {
     VerifyParams_t verify;
@@ -4813,6 +6450,7 @@ LoRaMacStatus_t LoRaMacDeInitialization( void )
     {
         // Stop Timers
         TimerStop( &MacCtx.TxDelayedTimer );
+        TimerStop( &MacCtx.TxQueueTimer );
         TimerStop( &MacCtx.RxWindowTimer1 );
         TimerStop( &MacCtx.RxWindowTimer2 );
         TimerStop( &MacCtx.AckTimeoutTimer );
@@ -4834,3 +6472,97 @@ LoRaMacStatus_t LoRaMacDeInitialization( void )
         return LORAMAC_STATUS_BUSY;
     }
 }
+
+/*!
+ * \brief Gets the channels and bands layout of a module context
+ *
+ * \param [IN]  module Module of the context
+ * \param [OUT] params Layout of the context, no channels outside of the region
+ */
+static void GetNvmCtxLayout( LoRaMacNvmCtxModule_t module, GetNvmCtxParams_t* params )
+{
+    params->nvmCtxSize = 0;
+    params->nvmCtxNbChannels = 0;
+    params->nvmCtxNbBands = 0;
+    if( module == LORAMAC_NVMCTXMODULE_REGION )
+    {
+        RegionGetNvmCtx( MacCtx.NvmCtx->Region, params );
+    }
+}
+
+size_t LoRaMacNvmCtxPack( LoRaMacNvmCtxModule_t module, void* ctx, size_t ctxSize, uint8_t* buffer, size_t size )
+{
+    GetNvmCtxParams_t params;
+
+    GetNvmCtxLayout( module, &params );
+    return LoRaMacNvmCodecPack( ( uint8_t* )ctx, ctxSize, params.nvmCtxNbChannels, params.nvmCtxNbBands, buffer, size );
+}
+
+size_t LoRaMacNvmCtxUnpack( LoRaMacNvmCtxModule_t module, uint8_t* buffer, size_t size, void* ctx, size_t ctxSize )
+{
+    GetNvmCtxParams_t params;
+
+    GetNvmCtxLayout( module, &params );
+    return LoRaMacNvmCodecUnpack( buffer, size, ( uint8_t* )ctx, ctxSize, params.nvmCtxNbChannels, params.nvmCtxNbBands );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t LoRaMacInstanceGetSize( void )
+{
+    size_t size = LORAMAC_INSTANCE_BLOCK_SIZE( sizeof( LoRaMacInstance_t ) );
+
+    for( size_t i = 0; i < LORAMAC_INSTANCE_NB_MODULES; i++ )
+    {
+        size += LORAMAC_INSTANCE_BLOCK_SIZE( LoRaMacInstanceModules[i].GetInstanceSize( ) );
+    }
+    return size;
+}
+
+LoRaMacInstance_t* LoRaMacInstanceCreate( void* memory )
+{
+    LoRaMacInstance_t* instance = ( LoRaMacInstance_t* )memory;
+    uint8_t* block = ( uint8_t* )memory;
+
+    if( memory == NULL )
+    {
+        return NULL;
+    }
+    memset( memory, 0, LoRaMacInstanceGetSize( ) );
+
+    // The module blocks follow the instance
+    block += LORAMAC_INSTANCE_BLOCK_SIZE( sizeof( LoRaMacInstance_t ) );
+    for( size_t i = 0; i < LORAMAC_INSTANCE_NB_MODULES; i++ )
+    {
+        instance->Modules[i] = block;
+        block += LORAMAC_INSTANCE_BLOCK_SIZE( LoRaMacInstanceModules[i].GetInstanceSize( ) );
+    }
+    return instance;
+}
+
+void LoRaMacInstanceSelect( LoRaMacInstance_t* instance )
+{
+    if( instance == NULL )
+    {
+        instance = &DefaultInstance;
+    }
+    if( instance == SelectedInstance )
+    {
+        return;
+    }
+    SelectedInstance = instance;
+    for( size_t i = 0; i < LORAMAC_INSTANCE_NB_MODULES; i++ )
+    {
+        LoRaMacInstanceModules[i].SelectInstance( instance->Modules[i] );
+    }
+}
+
+LoRaMacInstance_t* LoRaMacInstanceGetSelected( void )
+{
+    return SelectedInstance;
+}
+
+void LoRaMacInstanceClaimRadio( void )
+{
+    RadioOwner = SelectedInstance;
+}
+#endif
@@ -158,7 +158,9 @@ extern "C"
 /*!
  * LoRaMac MLME-Confirm queue length
  */
+#ifndef LORA_MAC_MLME_CONFIRM_QUEUE_LEN
 #define LORA_MAC_MLME_CONFIRM_QUEUE_LEN             5
+#endif
 
 /*!
  * FRMPayload overhead to be used when setting the Radio.SetMaxPayloadLength
@@ -167,11 +169,6 @@ extern "C"
  */
 #define LORA_MAC_FRMPAYLOAD_OVERHEAD                13 // MHDR(1) + FHDR(7) + Port(1) + MIC(4)
 
-/*!
- * Maximum number of multicast context
- */
-#define   LORAMAC_MAX_MC_CTX       4
-
 /*!
  * Start value for multicast keys enumeration
  */
@@ -271,6 +268,29 @@ typedef struct sRxChannelParams
     uint8_t  Datarate;
 }RxChannelParams_t;
 
+/*!
+ * LoRaMAC continuous reception window radio duty cycle parameters
+ *
+ * \remark The radio listens during RxTime and sleeps during SleepTime until a
+ *         preamble is detected. The network has to send the downlinks with a
+ *         preamble lasting more than SleepTime + 2 * RxTime, see
+ *         \ref LoRaMacGetRxCPreambleTime.
+ *
+ * \remark Radios without hardware RX duty cycle support sniff the channel
+ *         with a channel activity detection every SleepTime instead.
+ */
+typedef struct sRxCDutyCycle
+{
+    /*!
+     * Listening period in us
+     */
+    uint32_t RxTime;
+    /*!
+     * Sleep period in us. 0: continuous reception
+     */
+    uint32_t SleepTime;
+}RxCDutyCycle_t;
+
 /*!
  * LoRaMAC receive window enumeration
  */
@@ -449,6 +469,10 @@ typedef struct sLoRaMacParams
      * Indicates if the node supports repeaters
      */
     bool RepeaterSupport;
+    /*!
+     * LoRaMAC continuous reception window radio duty cycle settings
+     */
+    RxCDutyCycle_t RxCDutyCycle;
 }LoRaMacParams_t;
 
 /*!
@@ -882,6 +906,9 @@ typedef struct sMcpsIndication
     uint8_t FramePending;
     /*!
      * Pointer to the received data stream
+     *
+     * \remark Points into the radio driver reception buffer. Only valid
+     *         during the \ref LoRaMacPrimitives_t.MacMcpsIndication call.
      */
     uint8_t* Buffer;
     /*!
@@ -1279,6 +1306,11 @@ typedef struct sMlmeIndication
  * \ref MIB_DEFAULT_ANTENNA_GAIN                 | YES | YES
  * \ref MIB_NVM_CTXS                             | YES | YES
  * \ref MIB_ABP_LORAWAN_VERSION                  | YES | YES
+ * \ref MIB_RXC_DUTY_CYCLE                       | YES | YES
+ * \ref MIB_RX_FILTERED_FRAMES                   | YES | NO
+ * \ref MIB_ADAPTIVE_RX_ERROR                    | YES | YES
+ * \ref MIB_RX_ERROR_ESTIMATE                    | YES | NO
+ * \ref MIB_LATENCY_STATS                        | YES | YES
  *
  * The following table provides links to the function implementations of the
  * related MIB primitives:
@@ -1635,6 +1667,12 @@ typedef enum eMib
      * LoRaWAN MAC layer operating version when activated by ABP.
      */
     MIB_ABP_LORAWAN_VERSION,
+    /*!
+     * Class C continuous reception window radio duty cycle. The radio
+     * autonomously alternates reception and sleep periods. Falls back to
+     * continuous reception on radios without this feature.
+     */
+    MIB_RXC_DUTY_CYCLE,
     /*!
      * Beacon interval in ms
      */
@@ -1693,8 +1731,173 @@ typedef enum eMib
      * The allowed ranges are region specific. Please refer to \ref DR_0 to \ref DR_15 for details.
      */
      MIB_PING_SLOT_DATARATE,
+    /*!
+     * Number of received data frames dropped because they are too short or
+     * addressed to another device. Read only.
+     */
+    MIB_RX_FILTERED_FRAMES,
+    /*!
+     * Narrows the Rx1 and Rx2 windows timing error below \ref MIB_SYSTEM_MAX_RX_ERROR
+     * after received downlinks and widens it again after missed ones.
+     * Disabled by default.
+     */
+    MIB_ADAPTIVE_RX_ERROR,
+    /*!
+     * Timing error currently used for the Rx1 and Rx2 windows in ms. Read only.
+     */
+    MIB_RX_ERROR_ESTIMATE,
+    /*!
+     * Per frame latency statistics. Setting it resets the statistics.
+     * Only available when the MAC is built with LORAMAC_LATENCY_STATS_ENABLED.
+     */
+    MIB_LATENCY_STATS,
+    /*!
+     * Draws the uplink channels according to their delivery scores instead of
+     * uniformly. Disabled by default.
+     */
+    MIB_CHANNELS_WEIGHTING,
+    /*!
+     * Statistics of the first LORAMAC_CHANNELS_STATS_SIZE channels. Setting it
+     * resets the statistics.
+     */
+    MIB_CHANNELS_STATS,
+    /*!
+     * Sends the NbTrans repetitions of a class A unconfirmed uplink without
+     * opening the Rx windows in between, when the frame neither carries MAC
+     * commands nor asks for an ADR acknowledgement. The last repetition opens
+     * them. Disabled by default.
+     */
+    MIB_NB_TRANS_SKIP_RX,
+    /*!
+     * Sends the application payload alone when it does not fit in the frame
+     * together with the pending MAC command answers. The answers wait for
+     * the next uplink, at most LORAMAC_MAC_COMMANDS_MAX_DEFER consecutive
+     * times, instead of holding back the payload. Disabled by default.
+     */
+    MIB_MAC_COMMANDS_DEFER,
+    /*!
+     * Boosted reception of the Rx windows, see \ref LoRaMacRxBoosted_t.
+     * Only available with the radios providing Radio.RxBoosted.
+     * LORAMAC_RX_BOOSTED_OFF by default.
+     */
+    MIB_RX_BOOSTED,
 }Mib_t;
 
+/*!
+ * Running statistic of a latency, in LORAMAC_LATENCY_TIMESTAMP units.
+ * ms, \ref TimerGetCurrentTime, by default.
+ */
+typedef struct sLoRaMacLatencyStat
+{
+    /*!
+     * Value of the last frame
+     */
+    int32_t Last;
+    int32_t Min;
+    int32_t Max;
+    int32_t Avg;
+    uint32_t Count;
+    int64_t Sum;
+}LoRaMacLatencyStat_t;
+
+/*!
+ * Per frame latency statistics
+ */
+typedef struct sLoRaMacLatencyStats
+{
+    /*!
+     * Radio.Send to the radio TX done IRQ
+     */
+    LoRaMacLatencyStat_t TxAir;
+    /*!
+     * Radio TX done IRQ to the actual Rx1 window opening, minus the
+     * programmed Rx1 delay
+     */
+    LoRaMacLatencyStat_t Rx1Offset;
+    /*!
+     * Radio TX done IRQ to the actual Rx2 window opening, minus the
+     * programmed Rx2 delay
+     */
+    LoRaMacLatencyStat_t Rx2Offset;
+    /*!
+     * Radio RX done IRQ to the MCPS-Indication
+     */
+    LoRaMacLatencyStat_t RxDoneToIndication;
+    /*!
+     * Uplink encryption and MIC computation
+     */
+    LoRaMacLatencyStat_t TxCrypto;
+    /*!
+     * Downlink MIC verification and decryption
+     */
+    LoRaMacLatencyStat_t RxCrypto;
+}LoRaMacLatencyStats_t;
+
+/*!
+ * Number of channels, from channel 0, having statistics
+ */
+#ifndef LORAMAC_CHANNELS_STATS_SIZE
+#define LORAMAC_CHANNELS_STATS_SIZE                 16
+#endif
+
+/*!
+ * Statistics of an uplink channel
+ */
+typedef struct sLoRaMacChannelStats
+{
+    /*!
+     * Number of confirmed uplink tries
+     */
+    uint16_t NbConfirmedTries;
+    /*!
+     * Number of acknowledged confirmed uplink tries
+     */
+    uint16_t NbAcks;
+    /*!
+     * Number of downlinks received in the Rx1 and Rx2 windows of the uplinks
+     */
+    uint16_t NbDownlinks;
+    /*!
+     * RSSI of the last downlink in dBm
+     */
+    int16_t LastRssi;
+    /*!
+     * SNR of the last downlink in dB
+     */
+    int8_t LastSnr;
+    /*!
+     * Busy carrier senses among the last 8 ones, regions with listen before
+     * talk only
+     */
+    uint8_t NbLbtBusy;
+    /*!
+     * Delivery score in [-120;96] of the weighted channel selection, 0 when
+     * unknown
+     */
+    int8_t Score;
+}LoRaMacChannelStats_t;
+
+/*!
+ * Selection of the boosted reception of the radio for the Rx windows
+ */
+typedef enum eLoRaMacRxBoosted
+{
+    /*!
+     * The Rx windows use the normal reception
+     */
+    LORAMAC_RX_BOOSTED_OFF = 0,
+    /*!
+     * The Rx windows use the boosted reception
+     */
+    LORAMAC_RX_BOOSTED_ON,
+    /*!
+     * The Rx windows use the boosted reception when the link margin of the
+     * recent downlinks at the window datarate is below LORAMAC_RX_BOOSTED_MARGIN,
+     * when no downlink was received yet and after a missed downlink
+     */
+    LORAMAC_RX_BOOSTED_AUTO,
+}LoRaMacRxBoosted_t;
+
 /*!
  * LoRaMAC MIB parameters
  */
@@ -2030,6 +2233,12 @@ typedef union uMibParam
      * Related MIB type: \ref MIB_ABP_LORAWAN_VERSION
      */
     Version_t AbpLrWanVersion;
+    /*!
+     * Class C continuous reception window radio duty cycle
+     *
+     * Related MIB type: \ref MIB_RXC_DUTY_CYCLE
+     */
+    RxCDutyCycle_t RxCDutyCycle;
     /*!
      * Beacon interval in ms
      *
@@ -2110,6 +2319,61 @@ typedef union uMibParam
      * Related MIB type: \ref MIB_PING_SLOT_DATARATE
      */
     int8_t PingSlotDatarate;
+    /*!
+     * Number of received data frames dropped before their authentication
+     *
+     * Related MIB type: \ref MIB_RX_FILTERED_FRAMES
+     */
+    uint32_t RxFilteredFrames;
+    /*!
+     * Adaptive reception windows timing error enable
+     *
+     * Related MIB type: \ref MIB_ADAPTIVE_RX_ERROR
+     */
+    bool AdaptiveRxError;
+    /*!
+     * Reception windows timing error in ms
+     *
+     * Related MIB type: \ref MIB_RX_ERROR_ESTIMATE
+     */
+    uint32_t RxErrorEstimate;
+    /*!
+     * Per frame latency statistics
+     *
+     * Related MIB type: \ref MIB_LATENCY_STATS
+     */
+    const LoRaMacLatencyStats_t* LatencyStats;
+    /*!
+     * Weighted channel selection enable
+     *
+     * Related MIB type: \ref MIB_CHANNELS_WEIGHTING
+     */
+    bool ChannelsWeighting;
+    /*!
+     * Channel statistics, LORAMAC_CHANNELS_STATS_SIZE entries indexed by the
+     * channel id
+     *
+     * Related MIB type: \ref MIB_CHANNELS_STATS
+     */
+    const LoRaMacChannelStats_t* ChannelsStats;
+    /*!
+     * Unconfirmed uplink repetitions without Rx windows enable
+     *
+     * Related MIB type: \ref MIB_NB_TRANS_SKIP_RX
+     */
+    bool NbTransSkipRx;
+    /*!
+     * MAC command answers deferring enable
+     *
+     * Related MIB type: \ref MIB_MAC_COMMANDS_DEFER
+     */
+    bool MacCommandsDefer;
+    /*!
+     * Boosted reception of the Rx windows
+     *
+     * Related MIB type: \ref MIB_RX_BOOSTED
+     */
+    LoRaMacRxBoosted_t RxBoosted;
 }MibParam_t;
 
 /*!
@@ -2142,8 +2406,103 @@ typedef struct sLoRaMacTxInfo
      * which is dependent on the current datarate.
      */
     uint8_t CurrentPossiblePayloadSize;
+    /*!
+     * Time-on-air of the queried frame, MAC commands included, in ms.
+     */
+    TimerTime_t TxTimeOnAir;
+    /*!
+     * Time to wait before the duty cycle allows the next uplink, in ms.
+     */
+    TimerTime_t NextTxDelay;
 }LoRaMacTxInfo_t;
 
+/*!
+ * Number of datarates reported by \ref LoRaMacQueryTxPlan
+ */
+#ifndef LORAMAC_TX_PLAN_NB_DATARATES
+#define LORAMAC_TX_PLAN_NB_DATARATES                16
+#endif
+
+/*!
+ * Maximum number of bands reported by \ref LoRaMacQueryTxPlan
+ */
+#ifndef LORAMAC_TX_PLAN_MAX_BANDS
+#define LORAMAC_TX_PLAN_MAX_BANDS                   6
+#endif
+
+/*!
+ * LoRaMAC tx plan of a datarate
+ */
+typedef struct sLoRaMacTxPlanDatarate
+{
+    /*!
+     * Time to wait before the duty cycle allows an uplink on the datarate,
+     * in ms. TIMERTIME_T_MAX when no enabled channel supports it.
+     */
+    TimerTime_t Delay;
+    /*!
+     * Time-on-air of the queried frame, MAC commands included, in ms.
+     */
+    TimerTime_t TimeOnAir;
+    /*!
+     * Set to true, if the application data and the MAC commands fit into
+     * the maximum payload of the datarate.
+     */
+    bool PayloadFits;
+}LoRaMacTxPlanDatarate_t;
+
+/*!
+ * LoRaMAC tx plan of a band
+ */
+typedef struct sLoRaMacTxPlanBand
+{
+    /*!
+     * Duty cycle of the band, the join duty cycle included.
+     */
+    uint16_t DCycle;
+    /*!
+     * Time to wait before the band is available, in ms.
+     */
+    TimerTime_t Delay;
+    /*!
+     * Time-on-air the duty cycle allows per hour on the band, in ms.
+     */
+    TimerTime_t HourlyBudget;
+}LoRaMacTxPlanBand_t;
+
+/*!
+ * LoRaMAC tx plan, see \ref LoRaMacQueryTxPlan
+ */
+typedef struct sLoRaMacTxPlan
+{
+    /*!
+     * Plan of each datarate.
+     */
+    LoRaMacTxPlanDatarate_t Datarates[LORAMAC_TX_PLAN_NB_DATARATES];
+    /*!
+     * Plan of each band.
+     */
+    LoRaMacTxPlanBand_t Bands[LORAMAC_TX_PLAN_MAX_BANDS];
+    /*!
+     * Number of bands of the region.
+     */
+    uint8_t NbBands;
+    /*!
+     * Time to wait before the aggregated duty cycle allows an uplink, in ms.
+     * It is included in the delay of each datarate.
+     */
+    TimerTime_t AggregatedDelay;
+    /*!
+     * Join duty cycle in force. 0 when the node is joined.
+     */
+    uint16_t JoinDCycle;
+    /*!
+     * Time until the join duty cycle changes, in s. 0 when it does not
+     * change anymore.
+     */
+    uint32_t JoinDCycleChange;
+}LoRaMacTxPlan_t;
+
 /*!
  * LoRaMAC Status
  */
@@ -2447,6 +2806,47 @@ LoRaMacStatus_t LoRaMacStart( void );
  */
 LoRaMacStatus_t LoRaMacStop( void );
 
+/*!
+ * \brief   Measures the wakeup time of the radio on the running board
+ *
+ * \details The measured time replaces the conservative board and radio
+ *          constants in the Rx windows timing. It is stored in the MAC NVM
+ *          context and applied again when the contexts are restored.
+ *          The radio is left in sleep mode, the MAC must be idle in Class A.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY,
+ *          \ref LORAMAC_STATUS_SERVICE_UNKNOWN when the radio has no calibration.
+ */
+LoRaMacStatus_t LoRaMacCalibrateRadioWakeupTime( void );
+
+/*!
+ * \brief   Switches the active region without a full MAC initialization
+ *
+ * \details The keys and the device nonce are kept. The channels plan of every
+ *          region lives in its own region context. When regionCtxs holds the
+ *          contexts saved through \ref MIB_NVM_CTXS during an activated session
+ *          in the new region, the session is resumed and no join is needed.
+ *          Otherwise the MAC parameters are reset to the region defaults and
+ *          the device has to join.
+ *
+ * \remark  The MAC layer has to be stopped. The application should save the
+ *          contexts of the current region before the switch.
+ *
+ * \param   [IN] region Region to switch to.
+ *
+ * \param   [IN] regionCtxs Contexts saved in the new region, NULL if none.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY,
+ *          \ref LORAMAC_STATUS_REGION_NOT_SUPPORTED,
+ *          \ref LORAMAC_STATUS_CRYPTO_ERROR.
+ */
+LoRaMacStatus_t LoRaMacSwitchRegion( LoRaMacRegion_t region, LoRaMacCtxs_t* regionCtxs );
+
 /*!
  * \brief Returns a value indicating if the MAC layer is busy or not.
  * 
@@ -2454,6 +2854,19 @@ LoRaMacStatus_t LoRaMacStop( void );
  */
 bool LoRaMacIsBusy( void );
 
+/*!
+ * \brief   Gets the minimum downlink preamble duration required by the
+ *          continuous reception window duty cycle
+ *
+ * \details LoRaWAN has no MAC command to negotiate the preamble length. The
+ *          application has to forward this value to the network server, which
+ *          must send the class C downlinks with a preamble lasting at least
+ *          this long.
+ *
+ * \retval  Preamble duration in us. 0 when the reception is continuous.
+ */
+uint32_t LoRaMacGetRxCPreambleTime( void );
+
 /*!
  * Processes the LoRaMac events.
  *
@@ -2497,6 +2910,8 @@ LoRaMacStatus_t LoRaMacQueryNextTxDelay( int8_t datarate, TimerTime_t* time );
  *                         ( according to the configured datarate or the next
  *                         datarate according to ADR ), and the maximum frame
  *                         size, taking the scheduled MAC commands into account.
+ *                         It also holds the time-on-air of the frame and the
+ *                         delay before the duty cycle allows it.
  *
  * \retval  LoRaMacStatus_t Status of the operation. When the parameters are
  *          not valid, the function returns \ref LORAMAC_STATUS_PARAMETER_INVALID.
@@ -2512,6 +2927,70 @@ LoRaMacStatus_t LoRaMacQueryNextTxDelay( int8_t datarate, TimerTime_t* time );
  */
 LoRaMacStatus_t LoRaMacQueryTxPossible( uint8_t size, LoRaMacTxInfo_t* txInfo );
 
+/*!
+ * \brief   Queries the LoRaMAC for the earliest uplink opportunity of each
+ *          datarate and of each band, with a given application data payload
+ *          size.
+ *
+ * \details Unlike \ref LoRaMacQueryNextTxDelay, the query has no side
+ *          effect: the time-offs are computed on a copy of the bands and the
+ *          datarate selected by the ADR is not taken into account. The time
+ *          on air of each datarate takes the scheduled MAC commands into
+ *          account.
+ *
+ * \param   [IN] size - Size of application data payload to be send next
+ *
+ * \param   [OUT] plan - The structure \ref LoRaMacTxPlan_t contains the
+ *                       delays, the duty cycle budgets and the time-on-air.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. When the parameters are
+ *          not valid, the function returns \ref LORAMAC_STATUS_PARAMETER_INVALID.
+ *          When the MAC commands cannot be serialized, it returns
+ *          \ref LORAMAC_STATUS_MAC_COMMAD_ERROR. Otherwise the function
+ *          returns \ref LORAMAC_STATUS_OK.
+ */
+LoRaMacStatus_t LoRaMacQueryTxPlan( uint8_t size, LoRaMacTxPlan_t* plan );
+
+/*!
+ * \brief   Queries the LoRaMAC for the lowest datarate, starting from the
+ *          given one, whose maximum payload holds the application data and
+ *          the scheduled MAC commands.
+ *
+ * \remark  Only meaningful when ADR is disabled. Otherwise the MAC selects
+ *          the datarate.
+ *
+ * \param   [IN] size - Size of application data payload to be send next
+ *
+ * \param   [IN/OUT] datarate - Lowest acceptable datarate as input. The
+ *                              selected datarate as output.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID,
+ *          \ref LORAMAC_STATUS_MAC_COMMAD_ERROR,
+ *          \ref LORAMAC_STATUS_LENGTH_ERROR when no datarate holds the frame.
+ */
+LoRaMacStatus_t LoRaMacQueryTxDatarate( uint8_t size, int8_t* datarate );
+
+/*!
+ * \brief   Gets the frame payload window of the LoRaMAC transmit buffer
+ *
+ * \details The application may build the payload of its next frame directly
+ *          in the window and pass it as the MCPS-Request fBuffer. The MAC then
+ *          encrypts and secures it in place instead of copying it. The window
+ *          content is lost once the MAC sends another frame.
+ *
+ * \param   [OUT] buffer - Window start
+ *
+ * \param   [OUT] size - Window size
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID.
+ */
+LoRaMacStatus_t LoRaMacGetTxPayloadBuffer( uint8_t** buffer, uint8_t* size );
+
 /*!
  * \brief   LoRaMAC channel add service
  *
@@ -2559,6 +3038,25 @@ LoRaMacStatus_t LoRaMacChannelRemove( uint8_t id );
  */
 LoRaMacStatus_t LoRaMacMcChannelSetup( McChannelParams_t *channel );
 
+/*!
+ * \brief   LoRaMAC multicast channels setup service
+ *
+ * \details Sets up several multicast channels at once. The keys of the
+ *          remotely set up channels are derived in a single batch.
+ *          When the operation fails the channels have to be set up again.
+ *
+ * \param   [IN] channels   - Multicast channels to set.
+ * \param   [IN] nbChannels - Number of multicast channels, at most LORAMAC_MAX_MC_CTX.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID,
+ *          \ref LORAMAC_STATUS_MC_GROUP_UNDEFINED,
+ *          \ref LORAMAC_STATUS_CRYPTO_ERROR.
+ */
+LoRaMacStatus_t LoRaMacMcChannelsSetup( McChannelParams_t *channels, uint8_t nbChannels );
+
 /*!
  * \brief   LoRaMAC multicast channel removal service
  *
@@ -2579,7 +3077,7 @@ LoRaMacStatus_t LoRaMacMcChannelDelete( AddressIdentifier_t groupID );
  * \param   [IN]  mcAddress - Multicast address to be checked
  *
  * \retval  groupID           Multicast channel ID associated to the address.
- *                            Returns 0xFF if the address isn't found.
+ *                            Returns 0xFF if no enabled channel uses the address.
  */
 uint8_t LoRaMacMcChannelGetGroupId( uint32_t mcAddress );
 
@@ -2600,6 +3098,28 @@ uint8_t LoRaMacMcChannelGetGroupId( uint32_t mcAddress );
  */
 LoRaMacStatus_t LoRaMacMcChannelSetupRxParams( AddressIdentifier_t groupID, McRxParams_t *rxParams, uint8_t *status );
 
+/*!
+ * \brief   Prepares the switch to class C ahead of time
+ *
+ * \details Computes the RxC window of the enabled multicast channel, wakes
+ *          the radio up and loads its reception settings. The next switch to
+ *          class C through \ref MIB_DEVICE_CLASS then only starts the
+ *          reception. Any request to the MAC or multicast channel change
+ *          made in between cancels the preparation, the switch being then
+ *          done in full.
+ *
+ * \remark  The radio stays in standby mode until the switch. To be called
+ *          shortly before a multicast session start.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY when the MAC isn't idle in class A,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID when the radio rejects
+ *          the settings,
+ *          \ref LORAMAC_STATUS_SERVICE_UNKNOWN with the LoRaMac instances.
+ */
+LoRaMacStatus_t LoRaMacClassCPrepare( void );
+
 /*!
  * \brief   LoRaMAC MIB-Get
  *
@@ -2659,6 +3179,46 @@ LoRaMacStatus_t LoRaMacMibGetRequestConfirm( MibRequestConfirm_t* mibGet );
  */
 LoRaMacStatus_t LoRaMacMibSetRequestConfirm( MibRequestConfirm_t* mibSet );
 
+/*!
+ * \brief   LoRaMAC MIB-Get of several attributes
+ *
+ * \details Performs \ref LoRaMacMibGetRequestConfirm on each element of the
+ *          array, in order, and stops at the first failing one.
+ *
+ * \code
+ * MibRequestConfirm_t mibReq[2];
+ * mibReq[0].Type = MIB_NETWORK_ACTIVATION;
+ * mibReq[1].Type = MIB_CHANNELS_DATARATE;
+ *
+ * if( LoRaMacMibGetRequestConfirmBulk( mibReq, 2 ) == LORAMAC_STATUS_OK )
+ * {
+ *   // LoRaMAC updated both parameters
+ * }
+ * \endcode
+ *
+ * \param   [IN] mibGet  - Array of MIB-GET-Requests to perform.
+ * \param   [IN] nbItems - Number of requests in the array.
+ *
+ * \retval  LoRaMacStatus_t Status of the first failing request or
+ *          \ref LORAMAC_STATUS_OK.
+ */
+LoRaMacStatus_t LoRaMacMibGetRequestConfirmBulk( MibRequestConfirm_t* mibGet, uint8_t nbItems );
+
+/*!
+ * \brief   LoRaMAC MIB-Set of several attributes
+ *
+ * \details Performs \ref LoRaMacMibSetRequestConfirm on each element of the
+ *          array, in order, and stops at the first failing one. The requests
+ *          applied before the failing one are kept.
+ *
+ * \param   [IN] mibSet  - Array of MIB-SET-Requests to perform.
+ * \param   [IN] nbItems - Number of requests in the array.
+ *
+ * \retval  LoRaMacStatus_t Status of the first failing request or
+ *          \ref LORAMAC_STATUS_OK.
+ */
+LoRaMacStatus_t LoRaMacMibSetRequestConfirmBulk( MibRequestConfirm_t* mibSet, uint8_t nbItems );
+
 /*!
  * \brief   LoRaMAC MLME-Request
  *
@@ -2726,6 +3286,29 @@ LoRaMacStatus_t LoRaMacMlmeRequest( MlmeReq_t* mlmeRequest );
  */
 LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest );
 
+/*!
+ * \brief   LoRaMAC MCPS-Request through the transmit queue
+ *
+ * \details Performs the request immediately when the MAC is idle. Otherwise,
+ *          or when the duty cycle does not allow it yet, a copy of the request
+ *          and of its payload is queued. \ref LoRaMacProcess sends the queued
+ *          requests as soon as the MAC is idle and the duty cycle allows it,
+ *          the highest priority first. Each queued request ends with an
+ *          MCPS-Confirm. The queue holds up to \ref LORAMAC_TX_QUEUE_LEN
+ *          requests of up to \ref LORAMAC_TX_QUEUE_MAX_PAYLOAD bytes.
+ *
+ * \param   [IN] mcpsRequest - MCPS-Request to perform. Refer to \ref McpsReq_t.
+ *
+ * \param   [IN] priority - Queued requests with higher values are sent first.
+ *
+ * \retval  LoRaMacStatus_t Status of the operation. Possible returns are:
+ *          \ref LORAMAC_STATUS_OK,
+ *          \ref LORAMAC_STATUS_BUSY, the queue is full,
+ *          \ref LORAMAC_STATUS_PARAMETER_INVALID,
+ *          or the \ref LoRaMacMcpsRequest status when performed immediately.
+ */
+LoRaMacStatus_t LoRaMacMcpsEnqueue( McpsReq_t* mcpsRequest, uint8_t priority );
+
 /*!
  * \brief   LoRaMAC deinitialization
  *
@@ -2738,6 +3321,138 @@ LoRaMacStatus_t LoRaMacMcpsRequest( McpsReq_t* mcpsRequest );
  */
 LoRaMacStatus_t LoRaMacDeInitialization( void );
 
+/*!
+ * \brief   Serializes a module NVM context into its compact format
+ *
+ * \details The region context channels are stored as runs of evenly spaced
+ *          channels, the other bytes of the contexts are stored only when they
+ *          are not zero. See \ref LoRaMacNvmCodecPack.
+ *
+ * \param   [IN] module - Module of the context
+ *
+ * \param   [IN] ctx - Context, see \ref MIB_NVM_CTXS
+ *
+ * \param   [IN] ctxSize - Size of the context
+ *
+ * \param   [OUT] buffer - Serialized context
+ *
+ * \param   [IN] size - Size of the buffer, ctxSize + 1 bytes are always
+ *                      sufficient
+ *
+ * \retval  Size of the serialized context, 0 if it doesn't fit
+ */
+size_t LoRaMacNvmCtxPack( LoRaMacNvmCtxModule_t module, void* ctx, size_t ctxSize, uint8_t* buffer, size_t size );
+
+/*!
+ * \brief   Restores a module NVM context serialized by \ref LoRaMacNvmCtxPack
+ *
+ * \param   [IN] module - Module of the context
+ *
+ * \param   [IN] buffer - Serialized context
+ *
+ * \param   [IN] size - Size of the buffer, may exceed the serialized context
+ *
+ * \param   [OUT] ctx - Context
+ *
+ * \param   [IN] ctxSize - Size of the context
+ *
+ * \retval  Size of the serialized context, 0 if the buffer doesn't hold a
+ *          valid context
+ */
+size_t LoRaMacNvmCtxUnpack( LoRaMacNvmCtxModule_t module, uint8_t* buffer, size_t size, void* ctx, size_t ctxSize );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * LoRaMac stack instance. Holds the contexts of the MAC, the crypto, the
+ * region and the secure element modules of one end-device.
+ *
+ * \remark The LoRaMac API acts on the selected instance. The application
+ *         selects an instance before each LoRaMac call and calls
+ *         \ref LoRaMacProcess for each instance.
+ *         The MAC timers and radio events select the instance they belong to
+ *         while they are handled. The instances share the radio in time.
+ */
+typedef struct sLoRaMacInstance LoRaMacInstance_t;
+
+/*!
+ * \brief   Returns the size of the memory needed by an instance
+ *
+ * \retval  Size of an instance in bytes
+ */
+size_t LoRaMacInstanceGetSize( void );
+
+/*!
+ * \brief   Creates an instance in the memory provided by the application
+ *
+ * \details The instance is selected by \ref LoRaMacInstanceSelect and then
+ *          initialized by \ref LoRaMacInitialization like a single LoRaMac
+ *          stack.
+ *
+ * \param   [IN] memory - Memory of \ref LoRaMacInstanceGetSize bytes, aligned
+ *                        on 8 bytes
+ *
+ * \retval  Instance, NULL if memory is NULL
+ */
+LoRaMacInstance_t* LoRaMacInstanceCreate( void* memory );
+
+/*!
+ * \brief   Selects the instance the LoRaMac API acts on
+ *
+ * \param   [IN] instance - Instance to be selected, NULL selects the default
+ *                          instance
+ */
+void LoRaMacInstanceSelect( LoRaMacInstance_t* instance );
+
+/*!
+ * \brief   Returns the selected instance
+ *
+ * \retval  Selected instance
+ */
+LoRaMacInstance_t* LoRaMacInstanceGetSelected( void );
+
+/*!
+ * \brief   Routes the next radio events to the selected instance. Called by
+ *          the MAC modules before they start a radio operation.
+ */
+void LoRaMacInstanceClaimRadio( void );
+
+/*!
+ * Size of a module instance block rounded up to keep the next block aligned
+ */
+#define LORAMAC_INSTANCE_BLOCK_SIZE( size )         ( ( ( size ) + 7 ) & ~( ( size_t )7 ) )
+
+/*!
+ * Initializes a MAC timer which selects the instance that initialized it
+ * while its callback runs. The callback wrapper is defined by
+ * \ref LORAMAC_INSTANCE_TIMER_EVENT.
+ */
+#define LORAMAC_INSTANCE_TIMER_INIT( obj, callback )                          \
+    do                                                                         \
+    {                                                                          \
+        TimerInit( ( obj ), callback##Instance );                              \
+        TimerSetContext( ( obj ), LoRaMacInstanceGetSelected( ) );             \
+    }while( 0 )
+
+/*!
+ * Defines the wrapper of a MAC timer callback
+ */
+#define LORAMAC_INSTANCE_TIMER_EVENT( callback )                              \
+static void callback##Instance( void* context )                               \
+{                                                                              \
+    LoRaMacInstance_t* selected = LoRaMacInstanceGetSelected( );               \
+                                                                               \
+    LoRaMacInstanceSelect( ( LoRaMacInstance_t* )context );                    \
+    callback( context );                                                       \
+    LoRaMacInstanceSelect( selected );                                         \
+}
+
+#define LORAMAC_INSTANCE_CLAIM_RADIO( )             LoRaMacInstanceClaimRadio( )
+#else
+#define LORAMAC_INSTANCE_TIMER_INIT( obj, callback ) TimerInit( obj, callback )
+#define LORAMAC_INSTANCE_TIMER_EVENT( callback )
+#define LORAMAC_INSTANCE_CLAIM_RADIO( )
+#endif
+
 /*!
  * Automatically add the Region.h file at the end of LoRaMac.h file.
  * This is required because Region.h uses definitions from LoRaMac.h
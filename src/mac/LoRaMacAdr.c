@@ -31,10 +31,108 @@
  * \author    Johannes Bruder ( STACKFORCE )
  */
 
+#include "utilities.h"
 #include "region/Region.h"
 #include "LoRaMacAdr.h"
 
-static bool CalcNextV10X( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter )
+/*!
+ * Link history of the margin aware policy
+ */
+typedef struct sAdrLinkHistory
+{
+    /*!
+     * Last uplink link margins in dB
+     */
+    uint8_t Margins[LORAMAC_ADR_MARGIN_HISTORY_SIZE];
+    /*!
+     * Number of valid link margins
+     */
+    uint8_t NbMargins;
+    /*!
+     * Index of the next link margin to write
+     */
+    uint8_t MarginIndex;
+    /*!
+     * Outcome of the last 8 confirmed uplinks, a set bit is an acknowledged uplink
+     */
+    uint8_t Acks;
+    /*!
+     * Number of valid outcomes
+     */
+    uint8_t NbAcks;
+    /*!
+     * Statistics of the channels
+     */
+    LoRaMacChannelStats_t ChannelStats[LORAMAC_CHANNELS_STATS_SIZE];
+    /*!
+     * SNR of the last acknowledgement per uplink datarate, lowered by the
+     * missed acknowledgements
+     */
+    int8_t AckSnrs[16];
+    /*!
+     * Datarates having an acknowledgement SNR, one bit per datarate
+     */
+    uint16_t AckSnrsValid;
+}AdrLinkHistory_t;
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sLoRaMacAdrInstance
+{
+    /*!
+     * ADR link history
+     */
+    AdrLinkHistory_t LinkHistory;
+}LoRaMacAdrInstance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static LoRaMacAdrInstance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static LoRaMacAdrInstance_t* SelectedInstance = &DefaultInstance;
+
+#define LinkHistory                                 ( SelectedInstance->LinkHistory )
+#else
+/*!
+ * ADR link history
+ */
+static AdrLinkHistory_t LinkHistory;
+#endif
+
+static bool CalcNextPolicyDefault( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter );
+
+/*!
+ * ADR policy of the LoRaWAN 1.0.x devices
+ */
+static LoRaMacAdrPolicy_t AdrPolicy = CalcNextPolicyDefault;
+
+/*!
+ * Set when the retry diversity policy is enabled
+ */
+static bool RetryDiversity = false;
+
+/*!
+ * \brief Calculates the next datarate to set with the LoRaWAN 1.0.x backoff.
+ *
+ * \param [IN] adrNext Pointer to the function parameters.
+ *
+ * \param [IN] holdOff Number of uplinks the first datarate decrease is delayed by.
+ *
+ * \param [OUT] drOut The calculated datarate for the next TX.
+ *
+ * \param [OUT] txPowOut The TX power for the next TX.
+ *
+ * \param [OUT] adrAckCounter The calculated ADR acknowledgement counter.
+ *
+ * \retval Returns true, if an ADR request should be performed.
+ */
+static bool CalcNextV10X( CalcNextAdrParams_t* adrNext, uint32_t holdOff, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter )
 {
     bool adrAckReq = false;
     int8_t datarate = adrNext->Datarate;
@@ -49,10 +147,7 @@ static bool CalcNextV10X( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* t
     if( adrNext->AdrEnabled == true )
     {
         // Query minimum TX Datarate
-        getPhy.Attribute = PHY_MIN_TX_DR;
-        getPhy.UplinkDwellTime = adrNext->UplinkDwellTime;
-        phyParam = RegionGetPhyParam( adrNext->Region, &getPhy );
-        minTxDatarate = phyParam.Value;
+        minTxDatarate = RegionGetPhyConsts( adrNext->Region )->MinTxDr[( adrNext->UplinkDwellTime == 0 ) ? 0 : 1];
         datarate = MAX( datarate, minTxDatarate );
 
         if( datarate == minTxDatarate )
@@ -77,7 +172,8 @@ static bool CalcNextV10X( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* t
                 phyParam = RegionGetPhyParam( adrNext->Region, &getPhy );
                 txPower = phyParam.Value;
 
-                if( ( adrNext->AdrAckCounter % adrNext->AdrAckDelay ) == 1 )
+                if( ( adrNext->AdrAckCounter >= ( adrNext->AdrAckLimit + adrNext->AdrAckDelay + holdOff ) ) &&
+                    ( ( ( adrNext->AdrAckCounter - holdOff ) % adrNext->AdrAckDelay ) == 1 ) )
                 {
                     // Decrease the datarate
                     getPhy.Attribute = PHY_NEXT_LOWER_TX_DR;
@@ -107,6 +203,169 @@ static bool CalcNextV10X( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* t
     return adrAckReq;
 }
 
+static bool CalcNextPolicyDefault( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter )
+{
+    return CalcNextV10X( adrNext, 0, drOut, txPowOut, adrAckCounter );
+}
+
+/*!
+ * \brief Computes the number of ADR_ACK_DELAY periods the datarate can be
+ *        held for, from the link history.
+ *
+ * \retval Number of periods.
+ */
+static uint8_t GetMarginHoldPeriods( void )
+{
+    uint16_t marginSum = 0;
+    uint8_t nbAcked = 0;
+    uint8_t periods;
+
+    if( LinkHistory.NbMargins == 0 )
+    {
+        return 0;
+    }
+
+    // Hold only while most of the confirmed uplinks were acknowledged
+    for( uint8_t i = 0; i < LinkHistory.NbAcks; i++ )
+    {
+        nbAcked += ( LinkHistory.Acks >> i ) & 0x01;
+    }
+    if( ( nbAcked * 2 ) < LinkHistory.NbAcks )
+    {
+        return 0;
+    }
+
+    for( uint8_t i = 0; i < LinkHistory.NbMargins; i++ )
+    {
+        marginSum += LinkHistory.Margins[i];
+    }
+    periods = ( marginSum / LinkHistory.NbMargins ) / LORAMAC_ADR_MARGIN_STEP;
+    return MIN( periods, LORAMAC_ADR_MARGIN_MAX_HOLD );
+}
+
+bool LoRaMacAdrCalcNextMarginAware( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter )
+{
+    uint32_t holdOff = ( uint32_t )GetMarginHoldPeriods( ) * adrNext->AdrAckDelay;
+
+    return CalcNextV10X( adrNext, holdOff, drOut, txPowOut, adrAckCounter );
+}
+
+void LoRaMacAdrSetPolicy( LoRaMacAdrPolicy_t policy )
+{
+    AdrPolicy = ( policy != NULL ) ? policy : CalcNextPolicyDefault;
+}
+
+void LoRaMacAdrAddLinkMargin( uint8_t margin )
+{
+    LinkHistory.Margins[LinkHistory.MarginIndex] = margin;
+    LinkHistory.MarginIndex = ( LinkHistory.MarginIndex + 1 ) % LORAMAC_ADR_MARGIN_HISTORY_SIZE;
+    if( LinkHistory.NbMargins < LORAMAC_ADR_MARGIN_HISTORY_SIZE )
+    {
+        LinkHistory.NbMargins++;
+    }
+}
+
+void LoRaMacAdrAddAckResult( bool ackReceived )
+{
+    LinkHistory.Acks = ( uint8_t )( LinkHistory.Acks << 1 ) | ( ( ackReceived == true ) ? 1 : 0 );
+    if( LinkHistory.NbAcks < 8 )
+    {
+        LinkHistory.NbAcks++;
+    }
+}
+
+void LoRaMacAdrResetLinkHistory( void )
+{
+    memset1( ( uint8_t* )&LinkHistory, 0, sizeof( LinkHistory ) );
+}
+
+void LoRaMacAdrSetRetryDiversity( bool enable )
+{
+    RetryDiversity = enable;
+}
+
+bool LoRaMacAdrGetRetryDiversity( void )
+{
+    return RetryDiversity;
+}
+
+void LoRaMacAdrAddChannelResult( uint8_t channel, int8_t datarate, bool ackReceived, int8_t snr )
+{
+    if( channel < LORAMAC_CHANNELS_STATS_SIZE )
+    {
+        LoRaMacChannelStats_t* stats = &LinkHistory.ChannelStats[channel];
+
+        // Scores in [-120;96], a missed try halves the distance to the floor
+        if( ackReceived == true )
+        {
+            stats->Score += ( 96 - stats->Score ) / 4;
+            if( stats->NbAcks < UINT16_MAX )
+            {
+                stats->NbAcks++;
+            }
+        }
+        else
+        {
+            stats->Score -= ( stats->Score + 120 ) / 2;
+        }
+        if( stats->NbConfirmedTries < UINT16_MAX )
+        {
+            stats->NbConfirmedTries++;
+        }
+    }
+
+    if( ( datarate < 0 ) || ( datarate > 15 ) )
+    {
+        return;
+    }
+    if( ackReceived == true )
+    {
+        LinkHistory.AckSnrs[datarate] = snr;
+        LinkHistory.AckSnrsValid |= ( uint16_t )( 1 << datarate );
+    }
+    else if( ( LinkHistory.AckSnrsValid & ( 1 << datarate ) ) != 0 )
+    {
+        int16_t lowered = LinkHistory.AckSnrs[datarate] - LORAMAC_ADR_RETRY_MISS_PENALTY;
+
+        LinkHistory.AckSnrs[datarate] = ( lowered < INT8_MIN ) ? INT8_MIN : ( int8_t )lowered;
+    }
+}
+
+void LoRaMacAdrAddDownlink( uint8_t channel, int16_t rssi, int8_t snr )
+{
+    if( channel < LORAMAC_CHANNELS_STATS_SIZE )
+    {
+        LoRaMacChannelStats_t* stats = &LinkHistory.ChannelStats[channel];
+
+        stats->LastRssi = rssi;
+        stats->LastSnr = snr;
+        if( stats->NbDownlinks < UINT16_MAX )
+        {
+            stats->NbDownlinks++;
+        }
+    }
+}
+
+LoRaMacChannelStats_t* LoRaMacAdrGetChannelStats( void )
+{
+    return LinkHistory.ChannelStats;
+}
+
+void LoRaMacAdrResetChannelStats( void )
+{
+    memset1( ( uint8_t* )LinkHistory.ChannelStats, 0, sizeof( LinkHistory.ChannelStats ) );
+}
+
+bool LoRaMacAdrRetryKeepsDatarate( int8_t datarate )
+{
+    if( ( RetryDiversity == false ) || ( datarate < 0 ) || ( datarate > 15 ) ||
+        ( ( LinkHistory.AckSnrsValid & ( 1 << datarate ) ) == 0 ) )
+    {
+        return false;
+    }
+    return LinkHistory.AckSnrs[datarate] >= LORAMAC_ADR_RETRY_SNR_MARGIN;
+}
+
 /*!
  * \brief Calculates the next datarate to set, when ADR is on or off.
  *
@@ -124,7 +383,19 @@ bool LoRaMacAdrCalcNext( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* tx
 {
     if( adrNext->Version.Fields.Minor == 0 )
     {
-        return CalcNextV10X( adrNext, drOut, txPowOut, adrAckCounter );
+        return AdrPolicy( adrNext, drOut, txPowOut, adrAckCounter );
     }
     return false;
 }
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t LoRaMacAdrGetInstanceSize( void )
+{
+    return sizeof( LoRaMacAdrInstance_t );
+}
+
+void LoRaMacAdrSelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( LoRaMacAdrInstance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -44,6 +44,42 @@ extern "C"
 
 /*! \} defgroup LORAMACADR */
 
+/*!
+ * Link margin in dB worth one additional ADR_ACK_DELAY period before the
+ * margin aware policy lowers the datarate.
+ */
+#ifndef LORAMAC_ADR_MARGIN_STEP
+#define LORAMAC_ADR_MARGIN_STEP                     5
+#endif
+
+/*!
+ * Maximum number of additional ADR_ACK_DELAY periods of the margin aware policy
+ */
+#ifndef LORAMAC_ADR_MARGIN_MAX_HOLD
+#define LORAMAC_ADR_MARGIN_MAX_HOLD                 2
+#endif
+
+/*!
+ * Number of link margin samples kept by the margin aware policy
+ */
+#define LORAMAC_ADR_MARGIN_HISTORY_SIZE             4
+
+/*!
+ * Acknowledgement SNR in dB above which the retry diversity policy attributes
+ * a missed acknowledgement to a collision and retries at the same datarate
+ */
+#ifndef LORAMAC_ADR_RETRY_SNR_MARGIN
+#define LORAMAC_ADR_RETRY_SNR_MARGIN                5
+#endif
+
+/*!
+ * Decrease in dB of the acknowledgement SNR of a datarate for every missed
+ * acknowledgement at that datarate
+ */
+#ifndef LORAMAC_ADR_RETRY_MISS_PENALTY
+#define LORAMAC_ADR_RETRY_MISS_PENALTY              3
+#endif
+
 /*
  * Parameter structure for the function CalcNextAdr.
  */
@@ -106,6 +142,139 @@ typedef struct sCalcNextAdrParams
  */
 bool LoRaMacAdrCalcNext( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter );
 
+/*!
+ * ADR policy, calculates the next datarate and TX power of a LoRaWAN 1.0.x
+ * device. Same parameters as \ref LoRaMacAdrCalcNext.
+ */
+typedef bool ( *LoRaMacAdrPolicy_t )( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter );
+
+/*!
+ * \brief Sets the ADR policy used by \ref LoRaMacAdrCalcNext.
+ *
+ * \param [IN] policy The policy, NULL selects the LoRaWAN backoff.
+ */
+void LoRaMacAdrSetPolicy( LoRaMacAdrPolicy_t policy );
+
+/*!
+ * \brief Margin aware ADR policy. Follows the LoRaWAN backoff, but holds the
+ *        datarate for up to LORAMAC_ADR_MARGIN_MAX_HOLD additional
+ *        ADR_ACK_DELAY periods while the recent link margins are high and the
+ *        confirmed uplinks were mostly acknowledged. The TX power is raised
+ *        on schedule.
+ *
+ * \param [IN] adrNext Pointer to the function parameters.
+ *
+ * \param [OUT] drOut The calculated datarate for the next TX.
+ *
+ * \param [OUT] txPowOut The TX power for the next TX.
+ *
+ * \param [OUT] adrAckCounter The calculated ADR acknowledgement counter.
+ *
+ * \retval Returns true, if an ADR request should be performed.
+ */
+bool LoRaMacAdrCalcNextMarginAware( CalcNextAdrParams_t* adrNext, int8_t* drOut, int8_t* txPowOut, uint32_t* adrAckCounter );
+
+/*!
+ * \brief Adds an uplink link margin, as reported by a LinkCheckAns, to the
+ *        link history.
+ *
+ * \param [IN] margin Demodulation margin in dB.
+ */
+void LoRaMacAdrAddLinkMargin( uint8_t margin );
+
+/*!
+ * \brief Adds the outcome of a confirmed uplink to the link history.
+ *
+ * \param [IN] ackReceived Set to true, if the uplink was acknowledged.
+ */
+void LoRaMacAdrAddAckResult( bool ackReceived );
+
+/*!
+ * \brief Clears the link history, e.g. after a new join.
+ */
+void LoRaMacAdrResetLinkHistory( void );
+
+/*!
+ * \brief Enables the retry diversity policy of the confirmed uplinks.
+ *        The channels are drawn according to their delivery scores, a retry
+ *        does not use the channel of the previous try and the datarate is only
+ *        lowered when the past acknowledgements at that datarate had a low SNR.
+ *
+ * \param [IN] enable Set to true to enable the policy. Disabled by default,
+ *                    the retries then follow the LoRaWAN 1.0.x scheme.
+ */
+void LoRaMacAdrSetRetryDiversity( bool enable );
+
+/*!
+ * \brief Returns true, if the retry diversity policy is enabled.
+ */
+bool LoRaMacAdrGetRetryDiversity( void );
+
+/*!
+ * \brief Adds the outcome of a confirmed uplink try to the channel history.
+ *
+ * \param [IN] channel Channel id of the try.
+ *
+ * \param [IN] datarate Datarate of the try.
+ *
+ * \param [IN] ackReceived Set to true, if the try was acknowledged.
+ *
+ * \param [IN] snr SNR of the acknowledgement in dB, ignored when not received.
+ */
+void LoRaMacAdrAddChannelResult( uint8_t channel, int8_t datarate, bool ackReceived, int8_t snr );
+
+/*!
+ * \brief Adds a downlink received in the Rx1 or Rx2 window of an uplink to
+ *        the channel history.
+ *
+ * \param [IN] channel Channel id of the uplink.
+ *
+ * \param [IN] rssi RSSI of the downlink in dBm.
+ *
+ * \param [IN] snr SNR of the downlink in dB.
+ */
+void LoRaMacAdrAddDownlink( uint8_t channel, int16_t rssi, int8_t snr );
+
+/*!
+ * \brief Gets the statistics of the channels, see
+ *        \ref NextChanParams_t.ChannelStats.
+ *
+ * \retval LORAMAC_CHANNELS_STATS_SIZE statistics indexed by the channel id.
+ */
+LoRaMacChannelStats_t* LoRaMacAdrGetChannelStats( void );
+
+/*!
+ * \brief Clears the channel statistics.
+ */
+void LoRaMacAdrResetChannelStats( void );
+
+/*!
+ * \brief Decides whether a confirmed uplink retry keeps its datarate.
+ *
+ * \param [IN] datarate Datarate of the missed try.
+ *
+ * \retval Returns true, if the acknowledgement was likely lost to a
+ *         collision and the retry keeps the datarate. Always false when
+ *         the retry diversity policy is disabled.
+ */
+bool LoRaMacAdrRetryKeepsDatarate( int8_t datarate );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t LoRaMacAdrGetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void LoRaMacAdrSelectInstance( void* instance );
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,6 +19,7 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 */
 #include <math.h>
 #include "utilities.h"
+#include "crc.h"
 #include "secure-element.h"
 #include "LoRaMac.h"
 #include "LoRaMacClassB.h"
@@ -155,30 +156,85 @@ typedef struct sLoRaMacClassBCtx
 } LoRaMacClassBCtx_t;
 
 /*!
- * Defines the LoRaMac radio events status
+ * LoRaMac class B events, bits of LoRaMacClassBEvents
  */
-typedef union uLoRaMacClassBEvents
+#define LORAMAC_CLASSB_EVENT_BEACON                 ( ( uint32_t )1 << 0 )
+#define LORAMAC_CLASSB_EVENT_PING_SLOT              ( ( uint32_t )1 << 1 )
+#define LORAMAC_CLASSB_EVENT_MULTICAST_SLOT         ( ( uint32_t )1 << 2 )
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sLoRaMacClassBInstance
 {
-    uint32_t Value;
-    struct sEvents
-    {
-        uint32_t Beacon        : 1;
-        uint32_t PingSlot      : 1;
-        uint32_t MulticastSlot : 1;
-    }Events;
-}LoRaMacClassBEvents_t;
+    /*!
+     * Pending class B events
+     */
+    volatile uint32_t LoRaMacClassBEvents;
+    /*!
+     * Non-volatile module context
+     */
+    LoRaMacClassBNvmCtx_t NvmClassBCtx;
+    /*!
+     * Module context
+     */
+    LoRaMacClassBCtx_t Ctx;
+}LoRaMacClassBInstance_t;
 
-LoRaMacClassBEvents_t LoRaMacClassBEvents = { .Value = 0 };
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static LoRaMacClassBInstance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static LoRaMacClassBInstance_t* SelectedInstance = &DefaultInstance;
+
+#define LoRaMacClassBEvents                         ( SelectedInstance->LoRaMacClassBEvents )
+#define NvmClassBCtx                                ( SelectedInstance->NvmClassBCtx )
+#define Ctx                                         ( SelectedInstance->Ctx )
+#else
+/*!
+ * Pending class B events. The timer IRQ handlers set them and
+ * LoRaMacClassBProcess clears them with atomic operations.
+ */
+static volatile uint32_t LoRaMacClassBEvents = 0;
 
 /*
  * Non-volatile module context.
  */
-static LoRaMacClassBNvmCtx_t NvmCtx;
+static LoRaMacClassBNvmCtx_t NvmClassBCtx;
 
 /*
  * Module context.
  */
 static LoRaMacClassBCtx_t Ctx;
+#endif
+
+/*!
+ * Radio configuration of the last class B slot. The radio is shared by the
+ * instances, it is not part of the instance context.
+ */
+static struct sSlotRadio
+{
+    /*!
+     * Set while the radio holds the configuration below
+     */
+    bool Retained;
+    uint32_t Frequency;
+    int8_t Datarate;
+    uint8_t Bandwidth;
+    uint32_t WindowTimeout;
+    uint8_t DownlinkDwellTime;
+    bool RepeaterSupport;
+    bool RxContinuous;
+    /*!
+     * Datarate returned by RegionRxConfig
+     */
+    int8_t RxDatarate;
+}SlotRadio;
 
 /*!
  * Computes the Ping Offset
@@ -282,6 +338,270 @@ static uint32_t CalcDownlinkChannelAndFrequency( uint32_t devAddr, TimerTime_t b
     return frequency;
 }
 
+/*!
+ * \brief Updates a ping slot schedule for the current beacon period. The ping
+ *        offset and the frequency are only computed again when the beacon
+ *        time, the address or the ping period changed.
+ *
+ * \param [IN] schedule The schedule to update
+ *
+ * \param [IN] address The frame address
+ *
+ * \param [IN] pingPeriod The ping period of the address
+ */
+static void UpdatePingSlotSchedule( PingSlotSchedule_t* schedule, uint32_t address, uint16_t pingPeriod )
+{
+    uint32_t beaconTime = Ctx.BeaconCtx.BeaconTime.Seconds;
+
+    if( ( schedule->Valid == true ) && ( schedule->BeaconTime == beaconTime ) &&
+        ( schedule->Address == address ) && ( schedule->PingPeriod == pingPeriod ) )
+    {
+        return;
+    }
+
+    ComputePingOffset( beaconTime, address, pingPeriod, &schedule->PingOffset );
+    schedule->Frequency = CalcDownlinkChannelAndFrequency( address, beaconTime, CLASSB_BEACON_INTERVAL );
+    schedule->BeaconTime = beaconTime;
+    schedule->Address = address;
+    schedule->PingPeriod = pingPeriod;
+    schedule->Valid = true;
+}
+
+/*!
+ * \brief Computes the unicast and the multicast ping slot schedules of the
+ *        current beacon period in one go, so that the slot events only read them.
+ */
+static void UpdatePingSlotSchedules( void )
+{
+    MulticastCtx_t *cur = Ctx.LoRaMacClassBParams.MulticastChannels;
+
+    if( Ctx.NvmCtx->PingSlotCtx.PingPeriod != 0 )
+    {
+        UpdatePingSlotSchedule( &Ctx.PingSlotCtx.Schedule, *Ctx.LoRaMacClassBParams.LoRaMacDevAddr, Ctx.NvmCtx->PingSlotCtx.PingPeriod );
+    }
+
+    if( cur == NULL )
+    {
+        return;
+    }
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        if( cur->PingPeriod != 0 )
+        {
+            UpdatePingSlotSchedule( &Ctx.PingSlotCtx.MulticastSchedules[i], cur->ChannelParams.Address, cur->PingPeriod );
+            cur->PingOffset = Ctx.PingSlotCtx.MulticastSchedules[i].PingOffset;
+        }
+        cur++;
+    }
+}
+
+/*!
+ * \brief Adds a drift sample to the beacon drift model. Compares the local
+ *        time with the time of the received beacon, before the clock is
+ *        synchronized to it again.
+ *
+ * \param [IN] beaconRx Time of the received beacon.
+ */
+static void UpdateBeaconDrift( SysTime_t beaconRx )
+{
+    BeaconDriftCtx_t* drift = &Ctx.BeaconCtx.Drift;
+    uint32_t beaconTime = Ctx.BeaconCtx.BeaconTime.Seconds;
+
+    if( ( drift->LastSyncBeaconTime != 0 ) && ( beaconTime > drift->LastSyncBeaconTime ) )
+    {
+        int32_t intervals = ( int32_t )( ( beaconTime - drift->LastSyncBeaconTime ) / ( CLASSB_BEACON_INTERVAL / 1000 ) );
+        SysTime_t diff = SysTimeSub( SysTimeGet( ), beaconRx );
+        int32_t offset = ( int32_t )( diff.Seconds * 1000 + diff.SubSeconds );
+        // Part of the drift the temperature compensation already corrects
+        int32_t compensated = ( int32_t )TimerTempCompensation( CLASSB_BEACON_INTERVAL, Ctx.BeaconCtx.Temperature ) - CLASSB_BEACON_INTERVAL;
+
+        if( intervals > 0 )
+        {
+            int32_t residual = ( offset / intervals ) - compensated;
+
+            // Discard the samples which cannot be a clock drift
+            if( ( residual > -CLASSB_WINDOW_MOVE_EXPANSION_MAX ) && ( residual < CLASSB_WINDOW_MOVE_EXPANSION_MAX ) )
+            {
+                drift->History[drift->Index] = ( int16_t )residual;
+                drift->Temperature[drift->Index] = ( int8_t )roundf( Ctx.BeaconCtx.Temperature );
+                drift->Index = ( drift->Index + 1 ) % CLASSB_DRIFT_HISTORY_SIZE;
+                if( drift->NbSamples < CLASSB_DRIFT_HISTORY_SIZE )
+                {
+                    drift->NbSamples++;
+                }
+            }
+        }
+    }
+    drift->LastSyncBeaconTime = beaconTime;
+    drift->NbSkippedBeacons = 0;
+}
+
+/*!
+ * \brief Evaluates the beacon drift model at the current temperature.
+ *
+ * \remark When the samples span at least CLASSB_DRIFT_MIN_TEMPERATURE_SPREAD,
+ *         the residual drift is fitted as a linear function of the
+ *         temperature. Otherwise the mean of the samples is used.
+ *
+ * \param [OUT] meanDrift Residual drift per beacon interval in ms predicted
+ *                        for the current temperature.
+ *
+ * \param [OUT] spread Largest deviation of a sample from the model in ms.
+ *
+ * \retval [true: the model is valid, false: not enough samples]
+ */
+static bool GetBeaconDrift( int32_t* meanDrift, uint32_t* spread )
+{
+    BeaconDriftCtx_t* drift = &Ctx.BeaconCtx.Drift;
+    float meanTemperature = 0.0;
+    float mean = 0.0;
+    float slope = 0.0;
+    float covariance = 0.0;
+    float variance = 0.0;
+    int8_t minTemperature = INT8_MAX;
+    int8_t maxTemperature = INT8_MIN;
+    uint32_t maxDeviation = 0;
+
+    if( drift->NbSamples < CLASSB_DRIFT_MIN_SAMPLES )
+    {
+        return false;
+    }
+
+    for( uint8_t i = 0; i < drift->NbSamples; i++ )
+    {
+        mean += drift->History[i];
+        meanTemperature += drift->Temperature[i];
+        minTemperature = MIN( minTemperature, drift->Temperature[i] );
+        maxTemperature = MAX( maxTemperature, drift->Temperature[i] );
+    }
+    mean /= drift->NbSamples;
+    meanTemperature /= drift->NbSamples;
+
+    // Least squares temperature coefficient of the residual drift
+    if( ( maxTemperature - minTemperature ) >= CLASSB_DRIFT_MIN_TEMPERATURE_SPREAD )
+    {
+        for( uint8_t i = 0; i < drift->NbSamples; i++ )
+        {
+            float dt = drift->Temperature[i] - meanTemperature;
+
+            covariance += dt * ( drift->History[i] - mean );
+            variance += dt * dt;
+        }
+        slope = covariance / variance;
+    }
+
+    for( uint8_t i = 0; i < drift->NbSamples; i++ )
+    {
+        float model = mean + slope * ( drift->Temperature[i] - meanTemperature );
+        int32_t deviation = drift->History[i] - ( int32_t )roundf( model );
+
+        maxDeviation = MAX( maxDeviation, ( uint32_t )( ( deviation < 0 ) ? -deviation : deviation ) );
+    }
+    *meanDrift = ( int32_t )roundf( mean + slope * ( Ctx.BeaconCtx.Temperature - meanTemperature ) );
+    *spread = maxDeviation;
+    return true;
+}
+
+/*!
+ * \brief Gets the number of beacon intervals between the last clock
+ *        synchronization and the next beacon.
+ *
+ * \retval Number of intervals
+ */
+static uint32_t GetIntervalsToNextBeacon( void )
+{
+    if( Ctx.BeaconCtx.Drift.LastSyncBeaconTime == 0 )
+    {
+        // The drift model is kept from a previous beacon lock
+        return 1;
+    }
+    return ( ( Ctx.BeaconCtx.BeaconTime.Seconds - Ctx.BeaconCtx.Drift.LastSyncBeaconTime ) / ( CLASSB_BEACON_INTERVAL / 1000 ) ) + 1;
+}
+
+/*!
+ * \brief Gets the RX timing error of the next beacon or ping slot window.
+ *
+ * \param [IN] driftCompensated Set to true, if the window is shifted by the
+ *                              mean drift, as the beacon windows are.
+ *
+ * \retval The error in ms, the system maximum RX error without a drift model.
+ */
+static uint32_t GetDriftRxError( bool driftCompensated )
+{
+    int32_t meanDrift;
+    uint32_t spread;
+    uint32_t rxError;
+
+    if( GetBeaconDrift( &meanDrift, &spread ) == false )
+    {
+        return Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError;
+    }
+
+    rxError = spread;
+    if( driftCompensated == false )
+    {
+        rxError += ( meanDrift < 0 ) ? -meanDrift : meanDrift;
+    }
+    rxError *= GetIntervalsToNextBeacon( );
+    return MAX( rxError, CLASSB_DRIFT_MIN_RX_ERROR );
+}
+
+/*!
+ * \brief Gets the timing error the clock drift adds over a delay. Uses the
+ *        beacon drift model when it is characterized.
+ *
+ * \param [IN] delay Time since the clock synchronization in ms
+ *
+ * \retval The error in ms
+ */
+static uint32_t GetClockDriftError( TimerTime_t delay )
+{
+    int32_t meanDrift;
+    uint32_t spread;
+
+    if( GetBeaconDrift( &meanDrift, &spread ) == true )
+    {
+        // The acquisition window is not shifted by the mean drift
+        return ( spread + ( ( meanDrift < 0 ) ? -meanDrift : meanDrift ) ) * ( ( delay / CLASSB_BEACON_INTERVAL ) + 1 );
+    }
+    return ( uint32_t )( ( ( uint64_t )delay * CLASSB_ACQUISITION_CLOCK_DRIFT + 999999 ) / 1000000 );
+}
+
+/*!
+ * \brief Sets the acquisition window of the beacon predicted from a time
+ *        reference.
+ *
+ * \param [IN] timeError Error of the time reference in ms
+ *
+ * \param [IN] delay Time until the predicted beacon in ms
+ */
+static void SetAcquisitionError( TimerTime_t timeError, TimerTime_t delay )
+{
+    Ctx.BeaconCtx.AcquisitionError = MIN( timeError + GetClockDriftError( delay ), CLASSB_ACQUISITION_ERROR_MAX );
+}
+
+/*!
+ * \brief Verifies if the reception of the next beacon may be skipped. The
+ *        drift model must be fitted on a full history and predict the next
+ *        beacon within CLASSB_BEACON_SKIP_MAX_RX_ERROR.
+ *
+ * \retval [true: skip the beacon, false: receive the beacon]
+ */
+static bool IsBeaconSkipAllowed( void )
+{
+#if ( CLASSB_BEACON_SKIP_PERIODS > 0 )
+    if( ( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 0 ) ||
+        ( Ctx.BeaconCtx.Drift.NbSamples < CLASSB_DRIFT_HISTORY_SIZE ) ||
+        ( Ctx.BeaconCtx.Drift.NbSkippedBeacons >= CLASSB_BEACON_SKIP_PERIODS ) )
+    {
+        return false;
+    }
+    return GetDriftRxError( false ) <= CLASSB_BEACON_SKIP_MAX_RX_ERROR;
+#else
+    return false;
+#endif
+}
+
 /*!
  * \brief Calculates the correct frequency and opens up the beacon reception window.
  *
@@ -297,6 +617,8 @@ static void RxBeaconSetup( TimerTime_t rxTime, bool activateDefaultChannel )
     GetPhyParams_t getPhy;
     PhyParam_t phyParam;
     uint16_t windowTimeout = Ctx.BeaconCtx.SymbolTimeout;
+    int32_t meanDrift;
+    uint32_t spread;
 
     if( activateDefaultChannel == true )
     {
@@ -324,27 +646,32 @@ static void RxBeaconSetup( TimerTime_t rxTime, bool activateDefaultChannel )
         frequency = CalcDownlinkFrequency( Ctx.BeaconCtx.BeaconTimingChannel );
     }
 
-    if( ( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 ) || ( Ctx.BeaconCtx.Ctrl.AcquisitionPending == 1 ) )
+    if( ( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 ) || ( Ctx.BeaconCtx.Ctrl.AcquisitionPending == 1 ) ||
+        ( GetBeaconDrift( &meanDrift, &spread ) == true ) )
     {
-        // Apply the symbol timeout only if we have acquired the beacon
+        // Apply the symbol timeout only if we have acquired the beacon or can predict it
         // Otherwise, take the window enlargement into account
         // Read beacon datarate
         getPhy.Attribute = PHY_BEACON_CHANNEL_DR;
         phyParam = RegionGetPhyParam( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &getPhy );
 
-        // Calculate downlink symbols
+        // Calculate downlink symbols. A beacon acquired by time is searched
+        // within the timing error of its time reference.
         RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
                                         ( int8_t )phyParam.Value, // datarate
                                         Ctx.LoRaMacClassBParams.LoRaMacParams->MinRxSymbols,
-                                        Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError,
+                                        ( ( Ctx.BeaconCtx.Ctrl.AcquisitionPending == 1 ) && ( Ctx.BeaconCtx.AcquisitionError != 0 ) ) ?
+                                        Ctx.BeaconCtx.AcquisitionError : GetDriftRxError( true ),
                                         &beaconRxConfig );
-        windowTimeout = beaconRxConfig.WindowTimeout;
+        windowTimeout = MIN( beaconRxConfig.WindowTimeout, CLASSB_BEACON_SYMBOL_TO_EXPANSION_MAX );
     }
 
     rxBeaconSetup.SymbolTimeout = windowTimeout;
     rxBeaconSetup.RxTime = rxTime;
     rxBeaconSetup.Frequency = frequency;
 
+    LORAMAC_INSTANCE_CLAIM_RADIO( );
+    SlotRadio.Retained = false;
     RegionRxBeaconSetup( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &rxBeaconSetup, &Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
 
     Ctx.LoRaMacClassBParams.MlmeIndication->BeaconInfo.Frequency = frequency;
@@ -398,35 +725,112 @@ static bool CalcNextSlotTime( uint16_t slotOffset, uint16_t pingPeriod, uint16_t
 }
 
 /*!
- * \brief Calculates CRC's of the beacon frame
+ * \brief Finds the multicast channel with the earliest next ping slot. On equal
+ *        slot times the channel with the lowest index has priority.
  *
- * \param [IN] buffer Pointer to the data
- * \param [IN] length Length of the data
+ * \param [OUT] slotTime Time offset of the slot, based on current time
  *
- * \retval CRC
+ * \retval The multicast channel, NULL if no class B multicast slot is ahead
  */
-static uint16_t BeaconCrc( uint8_t *buffer, uint16_t length )
+static MulticastCtx_t* GetNextMulticastSlot( TimerTime_t* slotTime )
 {
-    // The CRC calculation follows CCITT
-    const uint16_t polynom = 0x1021;
-    // CRC initial value
-    uint16_t crc = 0x0000;
+    MulticastCtx_t *cur = Ctx.LoRaMacClassBParams.MulticastChannels;
+    MulticastCtx_t *next = NULL;
+    TimerTime_t time = 0;
 
-    if( buffer == NULL )
+    if( cur == NULL )
     {
-        return 0;
+        return NULL;
     }
 
-    for( uint16_t i = 0; i < length; ++i )
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
     {
-        crc ^= ( uint16_t ) buffer[i] << 8;
-        for( uint16_t j = 0; j < 8; ++j )
+        // Only the enabled class B channels have ping slots
+        if( ( cur->ChannelParams.IsEnabled == true ) && ( cur->PingPeriod != 0 ) &&
+            ( CalcNextSlotTime( cur->PingOffset, cur->PingPeriod, cur->PingNb, &time ) == true ) )
         {
-            crc = ( crc & 0x8000 ) ? ( crc << 1 ) ^ polynom : ( crc << 1 );
+            if( ( next == NULL ) || ( *slotTime > time ) )
+            {
+                *slotTime = time;
+                next = cur;
+            }
         }
+        cur++;
+    }
+    return next;
+}
+
+/*!
+ * \brief Configures the radio for a ping or a multicast slot. The
+ *        configuration is skipped when the radio waited in standby since the
+ *        previous slot and the parameters are the same.
+ *
+ * \param [IN]  rxConfig Slot reception parameters
+ * \param [OUT] datarate Datarate of the reception
+ */
+static void SlotRxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
+{
+    if( ( SlotRadio.Retained == true ) && ( Radio.GetStatus( ) == RF_IDLE ) &&
+        ( SlotRadio.Frequency == rxConfig->Frequency ) && ( SlotRadio.Datarate == rxConfig->Datarate ) &&
+        ( SlotRadio.Bandwidth == rxConfig->Bandwidth ) && ( SlotRadio.WindowTimeout == rxConfig->WindowTimeout ) &&
+        ( SlotRadio.DownlinkDwellTime == rxConfig->DownlinkDwellTime ) &&
+        ( SlotRadio.RepeaterSupport == rxConfig->RepeaterSupport ) && ( SlotRadio.RxContinuous == rxConfig->RxContinuous ) )
+    {
+        *datarate = SlotRadio.RxDatarate;
+        return;
+    }
+
+    SlotRadio.Retained = RegionRxConfig( *Ctx.LoRaMacClassBParams.LoRaMacRegion, rxConfig, datarate );
+    SlotRadio.Frequency = rxConfig->Frequency;
+    SlotRadio.Datarate = rxConfig->Datarate;
+    SlotRadio.Bandwidth = rxConfig->Bandwidth;
+    SlotRadio.WindowTimeout = rxConfig->WindowTimeout;
+    SlotRadio.DownlinkDwellTime = rxConfig->DownlinkDwellTime;
+    SlotRadio.RepeaterSupport = rxConfig->RepeaterSupport;
+    SlotRadio.RxContinuous = rxConfig->RxContinuous;
+    SlotRadio.RxDatarate = *datarate;
+}
+
+/*!
+ * \brief Checks if the next ping or multicast slot opens within the gap
+ *        below which a standby costs less than a sleep, a wake up and a
+ *        reconfiguration
+ *
+ * \retval [true: wait in standby, false: sleep]
+ */
+static bool IsNextSlotWithinBreakEven( void )
+{
+    TimerTime_t slotTime = 0;
+    // uA x ms / uA
+    TimerTime_t breakEven = ( ( Radio.GetWakeupTime( ) + CLASSB_RADIO_CONFIG_TIME ) * CLASSB_RADIO_WAKEUP_CURRENT ) /
+                            ( CLASSB_RADIO_STANDBY_CURRENT - CLASSB_RADIO_SLEEP_CURRENT );
+
+    if( ( Ctx.NvmCtx->PingSlotCtx.Ctrl.Assigned == 1 ) && ( Ctx.NvmCtx->PingSlotCtx.PingPeriod != 0 ) &&
+        ( CalcNextSlotTime( Ctx.PingSlotCtx.PingOffset, Ctx.NvmCtx->PingSlotCtx.PingPeriod,
+                            Ctx.NvmCtx->PingSlotCtx.PingNb, &slotTime ) == true ) &&
+        ( slotTime < breakEven ) )
+    {
+        return true;
+    }
+    if( ( GetNextMulticastSlot( &slotTime ) != NULL ) && ( slotTime < breakEven ) )
+    {
+        return true;
     }
+    return false;
+}
 
-    return crc;
+/*!
+ * \brief Calculates CRC's of the beacon frame
+ *
+ * \param [IN] buffer Pointer to the data
+ * \param [IN] length Length of the data
+ *
+ * \retval CRC
+ */
+static uint16_t BeaconCrc( uint8_t *buffer, uint16_t length )
+{
+    // The CRC calculation follows CCITT with a 0x0000 initial value
+    return CrcCcittCompute( buffer, length );
 }
 
 static void GetTemperatureLevel( LoRaMacClassBCallback_t *callbacks, BeaconContext_t *beaconCtx )
@@ -444,10 +848,10 @@ static void InitClassB( void )
     PhyParam_t phyParam;
 
     // Init events
-    LoRaMacClassBEvents.Value = 0;
+    LoRaMacClassBEvents = 0;
 
     // Init variables to default
-    memset1( ( uint8_t* ) &NvmCtx, 0, sizeof( LoRaMacClassBNvmCtx_t ) );
+    memset1( ( uint8_t* ) &NvmClassBCtx, 0, sizeof( LoRaMacClassBNvmCtx_t ) );
     memset1( ( uint8_t* ) &Ctx.PingSlotCtx, 0, sizeof( PingSlotContext_t ) );
     memset1( ( uint8_t* ) &Ctx.BeaconCtx, 0, sizeof( BeaconContext_t ) );
 
@@ -472,9 +876,15 @@ static void InitClassBDefaults( void )
     // but should keep important configurations
     LoRaMacClassBBeaconNvmCtx_t beaconCtx = Ctx.NvmCtx->BeaconCtx;
     LoRaMacClassBPingSlotNvmCtx_t pingSlotCtx = Ctx.NvmCtx->PingSlotCtx;
+    BeaconDriftCtx_t drift = Ctx.BeaconCtx.Drift;
 
     InitClassB( );
 
+    // The learned clock drift sizes the next acquisition window
+    Ctx.BeaconCtx.Drift = drift;
+    Ctx.BeaconCtx.Drift.LastSyncBeaconTime = 0;
+    Ctx.BeaconCtx.Drift.NbSkippedBeacons = 0;
+
     // Parameters from BeaconFreqReq
     Ctx.NvmCtx->BeaconCtx.Frequency = beaconCtx.Frequency;
     Ctx.NvmCtx->BeaconCtx.Ctrl.CustomFreq = beaconCtx.Ctrl.CustomFreq;
@@ -487,6 +897,17 @@ static void InitClassBDefaults( void )
 
 static void EnlargeWindowTimeout( void )
 {
+    int32_t meanDrift;
+    uint32_t spread;
+
+    if( GetBeaconDrift( &meanDrift, &spread ) == true )
+    {
+        // The drift model bounds the timing error, the windows grow with it only
+        Ctx.BeaconCtx.BeaconWindowMovement = MIN( CLASSB_WINDOW_MOVE_DEFAULT + spread * GetIntervalsToNextBeacon( ),
+                                                  CLASSB_WINDOW_MOVE_EXPANSION_MAX );
+        return;
+    }
+
     // Update beacon movement
     Ctx.BeaconCtx.BeaconWindowMovement *= CLASSB_WINDOW_MOVE_EXPANSION_FACTOR;
     if( Ctx.BeaconCtx.BeaconWindowMovement > CLASSB_WINDOW_MOVE_EXPANSION_MAX )
@@ -551,6 +972,8 @@ static TimerTime_t UpdateBeaconState( LoRaMacEventInfoStatus_t status,
 
 {
     TimerTime_t beaconEventTime = 0;
+    int32_t meanDrift;
+    uint32_t spread;
 
     // Calculate the next beacon RX time
     beaconEventTime = CalcDelayForNextBeacon( currentTime, SysTimeToMs( Ctx.BeaconCtx.LastBeaconRx ) );
@@ -559,6 +982,17 @@ static TimerTime_t UpdateBeaconState( LoRaMacEventInfoStatus_t status,
     // Take temperature compensation into account
     beaconEventTime = TimerTempCompensation( beaconEventTime, Ctx.BeaconCtx.Temperature );
 
+    // Take the residual drift of the clock into account
+    if( GetBeaconDrift( &meanDrift, &spread ) == true )
+    {
+        int32_t driftCorrection = meanDrift * ( int32_t )GetIntervalsToNextBeacon( );
+
+        if( ( driftCorrection > 0 ) || ( beaconEventTime > ( TimerTime_t )( -driftCorrection ) ) )
+        {
+            beaconEventTime += driftCorrection;
+        }
+    }
+
     // Move the window
     if( beaconEventTime > windowMovement )
     {
@@ -597,6 +1031,10 @@ static void NvmContextChange( void )
     }
 }
 
+LORAMAC_INSTANCE_TIMER_EVENT( LoRaMacClassBBeaconTimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( LoRaMacClassBPingSlotTimerEvent )
+LORAMAC_INSTANCE_TIMER_EVENT( LoRaMacClassBMulticastSlotTimerEvent )
+
 #endif // LORAMAC_CLASSB_ENABLED
 
 void LoRaMacClassBInit( LoRaMacClassBParams_t *classBParams, LoRaMacClassBCallback_t *callbacks, LoRaMacClassBNvmEvent classBNvmCtxChanged )
@@ -609,15 +1047,15 @@ void LoRaMacClassBInit( LoRaMacClassBParams_t *classBParams, LoRaMacClassBCallba
     Ctx.LoRaMacClassBParams = *classBParams;
 
     // Assign non-volatile context
-    Ctx.NvmCtx = &NvmCtx;
+    Ctx.NvmCtx = &NvmClassBCtx;
 
     // Assign callback
     Ctx.LoRaMacClassBNvmEvent = classBNvmCtxChanged;
 
     // Initialize timers
-    TimerInit( &Ctx.BeaconTimer, LoRaMacClassBBeaconTimerEvent );
-    TimerInit( &Ctx.PingSlotTimer, LoRaMacClassBPingSlotTimerEvent );
-    TimerInit( &Ctx.MulticastSlotTimer, LoRaMacClassBMulticastSlotTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &Ctx.BeaconTimer, LoRaMacClassBBeaconTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &Ctx.PingSlotTimer, LoRaMacClassBPingSlotTimerEvent );
+    LORAMAC_INSTANCE_TIMER_INIT( &Ctx.MulticastSlotTimer, LoRaMacClassBMulticastSlotTimerEvent );
 
     InitClassB( );
 #endif // LORAMAC_CLASSB_ENABLED
@@ -629,7 +1067,7 @@ bool LoRaMacClassBRestoreNvmCtx( void* classBNvmCtx )
     // Restore module context
     if( classBNvmCtx != NULL )
     {
-        memcpy1( ( uint8_t* ) &NvmCtx, ( uint8_t* ) classBNvmCtx, sizeof( NvmCtx ) );
+        memcpy1( ( uint8_t* ) &NvmClassBCtx, ( uint8_t* ) classBNvmCtx, sizeof( NvmClassBCtx ) );
         return true;
     }
     else
@@ -644,14 +1082,32 @@ bool LoRaMacClassBRestoreNvmCtx( void* classBNvmCtx )
 void* LoRaMacClassBGetNvmCtx( size_t* classBNvmCtxSize )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    *classBNvmCtxSize = sizeof( NvmCtx );
-    return &NvmCtx;
+    *classBNvmCtxSize = sizeof( NvmClassBCtx );
+    return &NvmClassBCtx;
 #else
     *classBNvmCtxSize = 0;
     return NULL;
 #endif // LORAMAC_CLASSB_ENABLED
 }
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t LoRaMacClassBGetInstanceSize( void )
+{
+#ifdef LORAMAC_CLASSB_ENABLED
+    return sizeof( LoRaMacClassBInstance_t );
+#else
+    return 0;
+#endif // LORAMAC_CLASSB_ENABLED
+}
+
+void LoRaMacClassBSelectInstance( void* instance )
+{
+#ifdef LORAMAC_CLASSB_ENABLED
+    SelectedInstance = ( instance != NULL ) ? ( LoRaMacClassBInstance_t* )instance : &DefaultInstance;
+#endif // LORAMAC_CLASSB_ENABLED
+}
+#endif
+
 void LoRaMacClassBSetBeaconState( BeaconState_t beaconState )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
@@ -720,7 +1176,7 @@ void LoRaMacClassBBeaconTimerEvent( void* context )
 #ifdef LORAMAC_CLASSB_ENABLED
     Ctx.BeaconCtx.TimeStamp = TimerGetCurrentTime( );
     TimerStop( &Ctx.BeaconTimer );
-    LoRaMacClassBEvents.Events.Beacon = 1;
+    AtomicFetchOr( &LoRaMacClassBEvents, LORAMAC_CLASSB_EVENT_BEACON );
 
     if( Ctx.LoRaMacClassBCallbacks.MacProcessNotify != NULL )
     {
@@ -746,7 +1202,25 @@ static void LoRaMacClassBProcessBeacon( void )
             if( Ctx.BeaconCtx.Ctrl.AcquisitionPending == 1 )
             {
                 Radio.Sleep();
-                Ctx.BeaconState = BEACON_STATE_LOST;
+                if( ( Ctx.BeaconCtx.AcquisitionError != 0 ) &&
+                    ( Ctx.BeaconCtx.AcquisitionError < CLASSB_ACQUISITION_ERROR_MAX ) )
+                {
+                    // The beacon has been missed. Search the next one within a
+                    // wider window, the time reference remains valid.
+                    Ctx.BeaconCtx.AcquisitionError = MIN( ( Ctx.BeaconCtx.AcquisitionError * CLASSB_ACQUISITION_EXPANSION_FACTOR ) +
+                                                          GetClockDriftError( CLASSB_BEACON_INTERVAL ),
+                                                          CLASSB_ACQUISITION_ERROR_MAX );
+                    Ctx.BeaconCtx.NextBeaconRx = SysTimeAdd( Ctx.BeaconCtx.NextBeaconRx, ( SysTime_t ){ .Seconds = CLASSB_BEACON_INTERVAL / 1000, .SubSeconds = 0 } );
+                    Ctx.BeaconCtx.LastBeaconRx = SysTimeAdd( Ctx.BeaconCtx.LastBeaconRx, ( SysTime_t ){ .Seconds = CLASSB_BEACON_INTERVAL / 1000, .SubSeconds = 0 } );
+                    Ctx.BeaconCtx.BeaconTime.Seconds += ( CLASSB_BEACON_INTERVAL / 1000 );
+                    Ctx.BeaconCtx.BeaconTimingDelay = CLASSB_BEACON_INTERVAL;
+                    Ctx.BeaconCtx.Ctrl.BeaconDelaySet = 1;
+                    Ctx.BeaconCtx.Ctrl.AcquisitionPending = 0;
+                }
+                else
+                {
+                    Ctx.BeaconState = BEACON_STATE_LOST;
+                }
             }
             else
             {
@@ -757,9 +1231,14 @@ static void LoRaMacClassBProcessBeacon( void )
                 {
                     if( Ctx.BeaconCtx.BeaconTimingDelay > 0 )
                     {
-                        if( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) > currentTime )
+                        if( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) > ( currentTime + Ctx.BeaconCtx.AcquisitionError ) )
                         {
+                            // Open the window ahead of the predicted beacon by its timing error
                             beaconEventTime = TimerTempCompensation( SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) - currentTime, Ctx.BeaconCtx.Temperature );
+                            if( beaconEventTime > Ctx.BeaconCtx.AcquisitionError )
+                            {
+                                beaconEventTime -= Ctx.BeaconCtx.AcquisitionError;
+                            }
                         }
                         else
                         {
@@ -809,6 +1288,8 @@ static void LoRaMacClassBProcessBeacon( void )
                 // Default symbol timeouts
                 ResetWindowTimeout( );
 
+                // No time reference, the beacon is searched for a full interval
+                Ctx.BeaconCtx.AcquisitionError = 0;
                 Ctx.BeaconCtx.Ctrl.AcquisitionPending = 1;
                 beaconEventTime = CLASSB_BEACON_INTERVAL;
 
@@ -827,6 +1308,9 @@ static void LoRaMacClassBProcessBeacon( void )
             Ctx.BeaconCtx.BeaconTime.Seconds += ( CLASSB_BEACON_INTERVAL / 1000 );
             Ctx.BeaconCtx.BeaconTime.SubSeconds = 0;
 
+            // Don't skip beacons until the clock is synchronized again
+            Ctx.BeaconCtx.Drift.NbSkippedBeacons = CLASSB_BEACON_SKIP_PERIODS;
+
             // Enlarge window timeouts to increase the chance to receive the next beacon
             EnlargeWindowTimeout( );
 
@@ -863,6 +1347,7 @@ static void LoRaMacClassBProcessBeacon( void )
 
             // We have received a beacon. Acquisition is no longer pending.
             Ctx.BeaconCtx.Ctrl.AcquisitionPending = 0;
+            Ctx.BeaconCtx.AcquisitionError = 0;
 
             // Handle beacon reception
             beaconEventTime = UpdateBeaconState( LORAMAC_EVENT_INFO_STATUS_BEACON_LOCKED,
@@ -904,16 +1389,57 @@ static void LoRaMacClassBProcessBeacon( void )
         }
         case BEACON_STATE_GUARD:
         {
-            Ctx.BeaconState = BEACON_STATE_RX;
-
             // Stop slot timers
             LoRaMacClassBStopRxSlots( );
 
+            if( IsBeaconSkipAllowed( ) == true )
+            {
+                // Resume after the beacon reserved time
+                activateTimer = true;
+                beaconEventTime = CLASSB_BEACON_GUARD + CLASSB_BEACON_RESERVED;
+                Ctx.BeaconState = BEACON_STATE_SKIPPED;
+                break;
+            }
+
+            Ctx.BeaconState = BEACON_STATE_RX;
+
             // Don't use the default channel. We know on which
             // channel the next beacon will be transmitted
             RxBeaconSetup( CLASSB_BEACON_RESERVED, false );
             break;
         }
+        case BEACON_STATE_SKIPPED:
+        {
+            activateTimer = true;
+
+            // The beacon time advances as if the beacon was received
+            Ctx.BeaconCtx.BeaconTime.Seconds += ( CLASSB_BEACON_INTERVAL / 1000 );
+            Ctx.BeaconCtx.BeaconTime.SubSeconds = 0;
+            Ctx.BeaconCtx.Drift.NbSkippedBeacons++;
+
+            // Verify if the maximum beacon less period has been elapsed
+            if( ( currentTime - SysTimeToMs( Ctx.BeaconCtx.LastBeaconRx ) ) > CLASSB_MAX_BEACON_LESS_PERIOD )
+            {
+                Ctx.BeaconState = BEACON_STATE_LOST;
+            }
+            else
+            {
+                // The drift model sizes the window movement
+                EnlargeWindowTimeout( );
+
+                // Prepare the ping slots of the new beacon period
+                UpdatePingSlotSchedules( );
+
+                // A skipped beacon is not indicated to the upper layer
+                Ctx.BeaconCtx.Ctrl.ResumeBeaconing = 1;
+                beaconEventTime = UpdateBeaconState( LORAMAC_EVENT_INFO_STATUS_BEACON_LOCKED,
+                                                     Ctx.BeaconCtx.BeaconWindowMovement, currentTime );
+
+                // Setup next state
+                Ctx.BeaconState = BEACON_STATE_IDLE;
+            }
+            break;
+        }
         case BEACON_STATE_LOST:
         {
             // Handle events
@@ -959,7 +1485,7 @@ static void LoRaMacClassBProcessBeacon( void )
 void LoRaMacClassBPingSlotTimerEvent( void* context )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    LoRaMacClassBEvents.Events.PingSlot = 1;
+    AtomicFetchOr( &LoRaMacClassBEvents, LORAMAC_CLASSB_EVENT_PING_SLOT );
 
     if( Ctx.LoRaMacClassBCallbacks.MacProcessNotify != NULL )
     {
@@ -978,10 +1504,8 @@ static void LoRaMacClassBProcessPingSlot( void )
     {
         case PINGSLOT_STATE_CALC_PING_OFFSET:
         {
-            ComputePingOffset( Ctx.BeaconCtx.BeaconTime.Seconds,
-                               *Ctx.LoRaMacClassBParams.LoRaMacDevAddr,
-                               Ctx.NvmCtx->PingSlotCtx.PingPeriod,
-                               &( Ctx.PingSlotCtx.PingOffset ) );
+            UpdatePingSlotSchedules( );
+            Ctx.PingSlotCtx.PingOffset = Ctx.PingSlotCtx.Schedule.PingOffset;
             Ctx.PingSlotState = PINGSLOT_STATE_SET_TIMER;
         }
             // Intentional fall through
@@ -989,26 +1513,41 @@ static void LoRaMacClassBProcessPingSlot( void )
         {
             if( CalcNextSlotTime( Ctx.PingSlotCtx.PingOffset, Ctx.NvmCtx->PingSlotCtx.PingPeriod, Ctx.NvmCtx->PingSlotCtx.PingNb, &pingSlotTime ) == true )
             {
-                if( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 )
+                TimerTime_t multicastSlotTime = 0;
+                uint32_t pingSlotTimeUs = pingSlotTime * 1000;
+
+                if( ( GetNextMulticastSlot( &multicastSlotTime ) != NULL ) &&
+                    ( multicastSlotTime < ( pingSlotTime + CLASSB_PING_SLOT_WINDOW ) ) &&
+                    ( pingSlotTime < ( multicastSlotTime + CLASSB_PING_SLOT_WINDOW ) ) )
                 {
-                    // Compute the symbol timeout. Apply it only, if the beacon is acquired
+                    // The slot collides with a multicast slot, which has priority.
+                    // Wake up once, after the slot, to compute the next one
+                    Ctx.PingSlotState = PINGSLOT_STATE_CALC_PING_OFFSET;
+                    TimerSetValue( &Ctx.PingSlotTimer, pingSlotTime + CLASSB_PING_SLOT_WINDOW );
+                    TimerStart( &Ctx.PingSlotTimer );
+                    break;
+                }
+
+                if( ( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 ) || ( Ctx.BeaconCtx.Drift.NbSamples >= CLASSB_DRIFT_MIN_SAMPLES ) )
+                {
+                    // Compute the symbol timeout. Apply it only, if the beacon is acquired or predictable
                     // Otherwise, take the enlargement of the symbols into account.
                     RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
                                                      Ctx.NvmCtx->PingSlotCtx.Datarate,
                                                      Ctx.LoRaMacClassBParams.LoRaMacParams->MinRxSymbols,
-                                                     Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError,
+                                                     GetDriftRxError( false ),
                                                      &pingSlotRxConfig );
                     Ctx.PingSlotCtx.SymbolTimeout = pingSlotRxConfig.WindowTimeout;
 
-                    if( ( int32_t )pingSlotTime > pingSlotRxConfig.WindowOffset )
+                    if( ( int32_t )pingSlotTimeUs > pingSlotRxConfig.WindowOffset )
                     {// Apply the window offset
-                        pingSlotTime += pingSlotRxConfig.WindowOffset;
+                        pingSlotTimeUs += pingSlotRxConfig.WindowOffset;
                     }
                 }
 
                 // Start the timer if the ping slot time is in range
                 Ctx.PingSlotState = PINGSLOT_STATE_IDLE;
-                TimerSetValue( &Ctx.PingSlotTimer, pingSlotTime );
+                TimerSetValueUs( &Ctx.PingSlotTimer, pingSlotTimeUs );
                 TimerStart( &Ctx.PingSlotTimer );
             }
             break;
@@ -1021,7 +1560,8 @@ static void LoRaMacClassBProcessPingSlot( void )
             if( Ctx.NvmCtx->PingSlotCtx.Ctrl.CustomFreq == 0 )
             {
                 // Restore floor plan
-                frequency = CalcDownlinkChannelAndFrequency( *Ctx.LoRaMacClassBParams.LoRaMacDevAddr, Ctx.BeaconCtx.BeaconTime.Seconds, CLASSB_BEACON_INTERVAL );
+                UpdatePingSlotSchedule( &Ctx.PingSlotCtx.Schedule, *Ctx.LoRaMacClassBParams.LoRaMacDevAddr, Ctx.NvmCtx->PingSlotCtx.PingPeriod );
+                frequency = Ctx.PingSlotCtx.Schedule.Frequency;
             }
 
             // Open the ping slot window only, if there is no multicast ping slot
@@ -1037,7 +1577,8 @@ static void LoRaMacClassBProcessPingSlot( void )
                 pingSlotRxConfig.RxContinuous = false;
                 pingSlotRxConfig.RxSlot = RX_SLOT_WIN_CLASS_B_PING_SLOT;
 
-                RegionRxConfig( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &pingSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
+                LORAMAC_INSTANCE_CLAIM_RADIO( );
+                SlotRxConfig( &pingSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
 
                 if( pingSlotRxConfig.RxContinuous == false )
                 {
@@ -1069,7 +1610,7 @@ static void LoRaMacClassBProcessPingSlot( void )
 void LoRaMacClassBMulticastSlotTimerEvent( void* context )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    LoRaMacClassBEvents.Events.MulticastSlot = 1;
+    AtomicFetchOr( &LoRaMacClassBEvents, LORAMAC_CLASSB_EVENT_MULTICAST_SLOT );
 
     if( Ctx.LoRaMacClassBCallbacks.MacProcessNotify != NULL )
     {
@@ -1083,7 +1624,6 @@ static void LoRaMacClassBProcessMulticastSlot( void )
 {
     static RxConfigParams_t multicastSlotRxConfig;
     TimerTime_t multicastSlotTime = 0;
-    TimerTime_t slotTime = 0;
     MulticastCtx_t *cur = Ctx.LoRaMacClassBParams.MulticastChannels;
 
 
@@ -1103,58 +1643,37 @@ static void LoRaMacClassBProcessMulticastSlot( void )
         case PINGSLOT_STATE_CALC_PING_OFFSET:
         {
             // Compute all offsets for every multicast slots
-            for( uint8_t i = 0; i < 4; i++ )
-            {
-                ComputePingOffset( Ctx.BeaconCtx.BeaconTime.Seconds,
-                                   cur->ChannelParams.Address,
-                                   cur->PingPeriod,
-                                   &( cur->PingOffset ) );
-                cur++;
-            }
+            UpdatePingSlotSchedules( );
             Ctx.MulticastSlotState = PINGSLOT_STATE_SET_TIMER;
         }
             // Intentional fall through
         case PINGSLOT_STATE_SET_TIMER:
         {
-            cur = Ctx.LoRaMacClassBParams.MulticastChannels;
-            Ctx.PingSlotCtx.NextMulticastChannel = NULL;
-
-            for( uint8_t i = 0; i < 4; i++ )
-            {
-                // Calculate the next slot time for every multicast slot
-                if( CalcNextSlotTime( cur->PingOffset, cur->PingPeriod, cur->PingNb, &slotTime ) == true )
-                {
-                    if( ( multicastSlotTime == 0 ) || ( multicastSlotTime > slotTime ) )
-                    {
-                        // Update the slot time and the next multicast channel
-                        multicastSlotTime = slotTime;
-                        Ctx.PingSlotCtx.NextMulticastChannel = cur;
-                    }
-                }
-                cur++;
-            }
+            Ctx.PingSlotCtx.NextMulticastChannel = GetNextMulticastSlot( &multicastSlotTime );
 
             // Schedule the next multicast slot
             if( Ctx.PingSlotCtx.NextMulticastChannel != NULL )
             {
-                if( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 )
+                uint32_t multicastSlotTimeUs = multicastSlotTime * 1000;
+
+                if( ( Ctx.BeaconCtx.Ctrl.BeaconAcquired == 1 ) || ( Ctx.BeaconCtx.Drift.NbSamples >= CLASSB_DRIFT_MIN_SAMPLES ) )
                 {
                     RegionComputeRxWindowParameters( *Ctx.LoRaMacClassBParams.LoRaMacRegion,
-                                                    Ctx.NvmCtx->PingSlotCtx.Datarate,
+                                                    Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.RxParams.ClassB.Datarate,
                                                     Ctx.LoRaMacClassBParams.LoRaMacParams->MinRxSymbols,
-                                                    Ctx.LoRaMacClassBParams.LoRaMacParams->SystemMaxRxError,
+                                                    GetDriftRxError( false ),
                                                     &multicastSlotRxConfig );
                     Ctx.PingSlotCtx.SymbolTimeout = multicastSlotRxConfig.WindowTimeout;
                 }
 
-                if( ( int32_t )multicastSlotTime > multicastSlotRxConfig.WindowOffset )
+                if( ( int32_t )multicastSlotTimeUs > multicastSlotRxConfig.WindowOffset )
                 {// Apply the window offset
-                    multicastSlotTime += multicastSlotRxConfig.WindowOffset;
+                    multicastSlotTimeUs += multicastSlotRxConfig.WindowOffset;
                 }
 
                 // Start the timer if the ping slot time is in range
                 Ctx.MulticastSlotState = PINGSLOT_STATE_IDLE;
-                TimerSetValue( &Ctx.MulticastSlotTimer, multicastSlotTime );
+                TimerSetValueUs( &Ctx.MulticastSlotTimer, multicastSlotTimeUs );
                 TimerStart( &Ctx.MulticastSlotTimer );
             }
             break;
@@ -1179,7 +1698,10 @@ static void LoRaMacClassBProcessMulticastSlot( void )
             if( frequency == 0 )
             {
                 // Restore floor plan
-                frequency = CalcDownlinkChannelAndFrequency( Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.Address, Ctx.BeaconCtx.BeaconTime.Seconds, CLASSB_BEACON_INTERVAL );
+                PingSlotSchedule_t* schedule = &Ctx.PingSlotCtx.MulticastSchedules[Ctx.PingSlotCtx.NextMulticastChannel - Ctx.LoRaMacClassBParams.MulticastChannels];
+
+                UpdatePingSlotSchedule( schedule, Ctx.PingSlotCtx.NextMulticastChannel->ChannelParams.Address, Ctx.PingSlotCtx.NextMulticastChannel->PingPeriod );
+                frequency = schedule->Frequency;
             }
 
             Ctx.MulticastSlotState = PINGSLOT_STATE_RX;
@@ -1191,8 +1713,6 @@ static void LoRaMacClassBProcessMulticastSlot( void )
             multicastSlotRxConfig.RxContinuous = false;
             multicastSlotRxConfig.RxSlot = RX_SLOT_WIN_CLASS_B_MULTICAST_SLOT;
 
-            RegionRxConfig( *Ctx.LoRaMacClassBParams.LoRaMacRegion, &multicastSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
-
             if( Ctx.PingSlotState == PINGSLOT_STATE_RX )
             {
                 // Close ping slot window, if necessary. Multicast slots have priority
@@ -1202,6 +1722,9 @@ static void LoRaMacClassBProcessMulticastSlot( void )
                 TimerStart( &Ctx.PingSlotTimer );
             }
 
+            LORAMAC_INSTANCE_CLAIM_RADIO( );
+            SlotRxConfig( &multicastSlotRxConfig, ( int8_t* )&Ctx.LoRaMacClassBParams.McpsIndication->RxDatarate );
+
             if( multicastSlotRxConfig.RxContinuous == false )
             {
                 Radio.Rx( Ctx.LoRaMacClassBParams.LoRaMacParams->MaxRxWindow );
@@ -1221,7 +1744,7 @@ static void LoRaMacClassBProcessMulticastSlot( void )
 }
 #endif // LORAMAC_CLASSB_ENABLED
 
-bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
+bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size, TimerTime_t rxDone )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
     GetPhyParams_t getPhy;
@@ -1282,15 +1805,17 @@ bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
             // Reset beacon variables, if one of the crc is valid
             if( beaconProcessed == true )
             {
-                TimerTime_t time = Radio.TimeOnAir( MODEM_LORA, size );
+                // The beacon ended at rxDone, the frame processing time has elapsed since
+                TimerTime_t time = Radio.TimeOnAir( MODEM_LORA, size ) + TimerGetElapsedTime( rxDone );
                 SysTime_t timeOnAir;
                 timeOnAir.Seconds = time / 1000;
                 timeOnAir.SubSeconds = time - timeOnAir.Seconds * 1000;
 
-                Ctx.BeaconCtx.LastBeaconRx = Ctx.BeaconCtx.BeaconTime;
-                Ctx.BeaconCtx.LastBeaconRx.Seconds += UNIX_GPS_EPOCH_OFFSET;
+                Ctx.BeaconCtx.LastBeaconRx = SysTimeFromGps( Ctx.BeaconCtx.BeaconTime.Seconds, 0 );
+                Ctx.BeaconCtx.LastBeaconRx.SubSeconds = Ctx.BeaconCtx.BeaconTime.SubSeconds;
 
-                // Update system time.
+                // Update the drift model and the system time.
+                UpdateBeaconDrift( SysTimeAdd( Ctx.BeaconCtx.LastBeaconRx, timeOnAir ) );
                 SysTimeSet( SysTimeAdd( Ctx.BeaconCtx.LastBeaconRx, timeOnAir ) );
 
                 Ctx.BeaconCtx.Ctrl.BeaconAcquired = 1;
@@ -1298,6 +1823,9 @@ bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size )
                 ResetWindowTimeout( );
                 Ctx.BeaconState = BEACON_STATE_LOCKED;
 
+                // Prepare the ping slots of the new beacon period
+                UpdatePingSlotSchedules( );
+
                 LoRaMacClassBBeaconTimerEvent( NULL );
             }
         }
@@ -1404,15 +1932,14 @@ void LoRaMacClassBHaltBeaconing( void )
     if( Ctx.BeaconCtx.Ctrl.BeaconMode == 1 )
     {
         if( ( Ctx.BeaconState == BEACON_STATE_TIMEOUT ) ||
+            ( Ctx.BeaconState == BEACON_STATE_SKIPPED ) ||
             ( Ctx.BeaconState == BEACON_STATE_LOST ) )
         {
             // Update the state machine before halt
             LoRaMacClassBBeaconTimerEvent( NULL );
         }
 
-        CRITICAL_SECTION_BEGIN( );
-        LoRaMacClassBEvents.Events.Beacon = 0;
-        CRITICAL_SECTION_END( );
+        AtomicFetchAnd( &LoRaMacClassBEvents, ~LORAMAC_CLASSB_EVENT_BEACON );
 
         // Halt ping slot state machine
         TimerStop( &Ctx.BeaconTimer );
@@ -1600,6 +2127,8 @@ void LoRaMacClassBBeaconTimingAns( uint16_t beaconTimingDelay, uint8_t beaconTim
             Ctx.BeaconCtx.Ctrl.BeaconDelaySet = 1;
             Ctx.BeaconCtx.Ctrl.BeaconChannelSet = 1;
             Ctx.BeaconCtx.NextBeaconRx = SysTimeFromMs( lastRxDone + Ctx.BeaconCtx.BeaconTimingDelay );
+            // The delay is given in steps of CLASSB_BEACON_DELAY_BEACON_TIMING_ANS
+            SetAcquisitionError( CLASSB_BEACON_DELAY_BEACON_TIMING_ANS, Ctx.BeaconCtx.BeaconTimingDelay );
             LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_BEACON_TIMING );
         }
 
@@ -1637,7 +2166,8 @@ void LoRaMacClassBDeviceTimeAns( void )
         {
             Ctx.BeaconCtx.Ctrl.BeaconDelaySet = 1;
             Ctx.BeaconCtx.BeaconTimingDelay = SysTimeToMs( Ctx.BeaconCtx.NextBeaconRx ) - currentTimeMs;
-            Ctx.BeaconCtx.BeaconTime.Seconds = nextBeacon.Seconds - UNIX_GPS_EPOCH_OFFSET - 128;
+            SetAcquisitionError( CLASSB_ACQUISITION_DEVICE_TIME_ERROR, Ctx.BeaconCtx.BeaconTimingDelay );
+            Ctx.BeaconCtx.BeaconTime.Seconds = SysTimeToGps( nextBeacon, NULL ) - 128;
             Ctx.BeaconCtx.BeaconTime.SubSeconds = 0;
             LoRaMacConfirmQueueSetStatus( LORAMAC_EVENT_INFO_STATUS_OK, MLME_DEVICE_TIME );
         }
@@ -1704,10 +2234,14 @@ void LoRaMacClassBStopRxSlots( void )
     TimerStop( &Ctx.PingSlotTimer );
     TimerStop( &Ctx.MulticastSlotTimer );
 
-    CRITICAL_SECTION_BEGIN( );
-    LoRaMacClassBEvents.Events.PingSlot = 0;
-    LoRaMacClassBEvents.Events.MulticastSlot = 0;
-    CRITICAL_SECTION_END( );
+    // No slot will follow the standby
+    if( ( SlotRadio.Retained == true ) && ( Radio.GetStatus( ) == RF_IDLE ) )
+    {
+        Radio.Sleep( );
+    }
+    SlotRadio.Retained = false;
+
+    AtomicFetchAnd( &LoRaMacClassBEvents, ~( LORAMAC_CLASSB_EVENT_PING_SLOT | LORAMAC_CLASSB_EVENT_MULTICAST_SLOT ) );
 #endif // LORAMAC_CLASSB_ENABLED
 }
 
@@ -1738,27 +2272,42 @@ void LoRaMacClassBSetMulticastPeriodicity( MulticastCtx_t* multicastChannel )
 #endif // LORAMAC_CLASSB_ENABLED
 }
 
-void LoRaMacClassBProcess( void )
+void LoRaMacClassBRadioEndSlot( void )
+{
+#ifdef LORAMAC_CLASSB_ENABLED
+    if( ( SlotRadio.Retained == true ) && ( IsNextSlotWithinBreakEven( ) == true ) )
+    {
+        Radio.Standby( );
+        return;
+    }
+    SlotRadio.Retained = false;
+#endif // LORAMAC_CLASSB_ENABLED
+    Radio.Sleep( );
+}
+
+void LoRaMacClassBRadioReconfigured( void )
 {
 #ifdef LORAMAC_CLASSB_ENABLED
-    LoRaMacClassBEvents_t events;
+    SlotRadio.Retained = false;
+#endif // LORAMAC_CLASSB_ENABLED
+}
 
-    CRITICAL_SECTION_BEGIN( );
-    events = LoRaMacClassBEvents;
-    LoRaMacClassBEvents.Value = 0;
-    CRITICAL_SECTION_END( );
+void LoRaMacClassBProcess( void )
+{
+#ifdef LORAMAC_CLASSB_ENABLED
+    uint32_t events = AtomicExchange( &LoRaMacClassBEvents, 0 );
 
-    if( events.Value != 0 )
+    if( events != 0 )
     {
-        if( events.Events.Beacon == 1 )
+        if( ( events & LORAMAC_CLASSB_EVENT_BEACON ) != 0 )
         {
             LoRaMacClassBProcessBeacon( );
         }
-        if( events.Events.PingSlot == 1 )
+        if( ( events & LORAMAC_CLASSB_EVENT_PING_SLOT ) != 0 )
         {
             LoRaMacClassBProcessPingSlot( );
         }
-        if( events.Events.MulticastSlot == 1 )
+        if( ( events & LORAMAC_CLASSB_EVENT_MULTICAST_SLOT ) != 0 )
         {
             LoRaMacClassBProcessMulticastSlot( );
         }
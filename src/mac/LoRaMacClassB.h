@@ -92,6 +92,11 @@ typedef enum eBeaconState
      * The node is in receive mode to lock a beacon
      */
     BEACON_STATE_RX,
+    /*!
+     * The beacon reception is skipped, the drift model keeps the node
+     * synchronized
+     */
+    BEACON_STATE_SKIPPED,
     /*!
      * The nodes switches the device class
      */
@@ -124,6 +129,76 @@ typedef enum ePingSlotState
 /*!
  * Class B ping slot context structure
  */
+/*!
+ * Number of beacon periods the beacon drift model is fitted on
+ */
+#define CLASSB_DRIFT_HISTORY_SIZE                   8
+
+/*!
+ * Beacon drift model. Holds the clock drift measured on the beacons, which
+ * remains after the RTC temperature compensation, and the temperature it was
+ * measured at. The residual drift is fitted as a linear function of the
+ * temperature, which calibrates the temperature coefficient of the device.
+ */
+typedef struct sBeaconDriftCtx
+{
+    /*!
+     * Residual clock drift per beacon interval in ms
+     */
+    int16_t History[CLASSB_DRIFT_HISTORY_SIZE];
+    /*!
+     * Temperature of the drift samples in degree Celsius
+     */
+    int8_t Temperature[CLASSB_DRIFT_HISTORY_SIZE];
+    /*!
+     * Number of valid drift samples
+     */
+    uint8_t NbSamples;
+    /*!
+     * Index of the next drift sample to write
+     */
+    uint8_t Index;
+    /*!
+     * Beacon time of the last clock synchronization, 0 if none
+     */
+    uint32_t LastSyncBeaconTime;
+    /*!
+     * Number of beacon receptions skipped since the last clock synchronization
+     */
+    uint8_t NbSkippedBeacons;
+}BeaconDriftCtx_t;
+
+/*!
+ * Ping slot schedule of an address for one beacon period
+ */
+typedef struct sPingSlotSchedule
+{
+    /*!
+     * Set if the schedule was computed
+     */
+    bool Valid;
+    /*!
+     * Ping period the schedule was computed for
+     */
+    uint16_t PingPeriod;
+    /*!
+     * Beacon time the schedule was computed for
+     */
+    uint32_t BeaconTime;
+    /*!
+     * Address the schedule was computed for
+     */
+    uint32_t Address;
+    /*!
+     * Ping offset
+     */
+    uint16_t PingOffset;
+    /*!
+     * Floor plan frequency of the ping slots
+     */
+    uint32_t Frequency;
+}PingSlotSchedule_t;
+
 typedef struct sPingSlotContext
 {
 
@@ -144,6 +219,14 @@ typedef struct sPingSlotContext
      * The multicast channel which will be enabled next.
      */
     MulticastCtx_t *NextMulticastChannel;
+    /*!
+     * Unicast ping slot schedule of the current beacon period
+     */
+    PingSlotSchedule_t Schedule;
+    /*!
+     * Multicast ping slot schedules of the current beacon period
+     */
+    PingSlotSchedule_t MulticastSchedules[LORAMAC_MAX_MC_CTX];
 }PingSlotContext_t;
 
 
@@ -219,7 +302,16 @@ typedef struct sBeaconContext
      * Delay for next beacon in ms
      */
     TimerTime_t BeaconTimingDelay;
+    /*!
+     * Timing error in ms of the beacon acquired by time. Sizes the acquisition
+     * window, 0 when the acquisition has no time reference.
+     */
+    TimerTime_t AcquisitionError;
     TimerTime_t TimeStamp;
+    /*!
+     * Beacon drift model
+     */
+    BeaconDriftCtx_t Drift;
 }BeaconContext_t;
 
 /*!
@@ -314,6 +406,22 @@ bool LoRaMacClassBRestoreNvmCtx( void* classBNvmCtx );
  */
 void* LoRaMacClassBGetNvmCtx( size_t* classBNvmCtxSize );
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief Returns the size of the module instance block
+ *
+ * \retval Size of the block in bytes, 0 when class B is disabled
+ */
+size_t LoRaMacClassBGetInstanceSize( void );
+
+/*!
+ * \brief Selects the module instance block of a LoRaMac instance
+ *
+ * \param [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void LoRaMacClassBSelectInstance( void* instance );
+#endif
+
 /*!
  * \brief Set the state of the beacon state machine
  *
@@ -362,9 +470,10 @@ void LoRaMacClassBMulticastSlotTimerEvent( void* context );
  *
  * \param [IN] payload Pointer to the payload
  * \param [IN] size Size of the payload
+ * \param [IN] rxDone Time of the end of the reception
  * \retval [true, if the node has received a beacon; false, if not]
  */
-bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size );
+bool LoRaMacClassBRxBeacon( uint8_t *payload, uint16_t size, TimerTime_t rxDone );
 
 /*!
  * \brief The function validates, if the node expects a beacon
@@ -530,6 +639,19 @@ void LoRaMacClassBStartRxSlots( void );
  */
 void LoRaMacClassBSetMulticastPeriodicity( MulticastCtx_t* multicastChannel );
 
+/*!
+ * \brief Ends the reception of a ping or a multicast slot. The radio waits
+ *        in standby when the next slot opens within the break-even gap, see
+ *        CLASSB_RADIO_STANDBY_CURRENT, else it sleeps.
+ */
+void LoRaMacClassBRadioEndSlot( void );
+
+/*!
+ * \brief Notifies that the radio has been configured for another operation
+ *        than a class B slot. The next slot configures it in full.
+ */
+void LoRaMacClassBRadioReconfigured( void );
+
 void LoRaMacClassBProcess( void );
 
 #ifdef __cplusplus
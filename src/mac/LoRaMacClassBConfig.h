@@ -117,6 +117,93 @@ extern "C"
  */
 #define CLASSB_WINDOW_MOVE_EXPANSION_FACTOR         2
 
+/*!
+ * Minimum number of drift samples to predict the beacon arrival
+ */
+#define CLASSB_DRIFT_MIN_SAMPLES                    2
+
+/*!
+ * Minimum RX timing error in ms of the windows sized by the drift model
+ */
+#define CLASSB_DRIFT_MIN_RX_ERROR                   2
+
+/*!
+ * Minimum temperature range in degree Celsius of the drift samples to fit the
+ * temperature coefficient of the clock. Below, the mean drift is used.
+ */
+#define CLASSB_DRIFT_MIN_TEMPERATURE_SPREAD         3
+
+/*!
+ * Maximum number of consecutive beacon receptions skipped once the drift
+ * model is characterized. 0 disables the beacon skipping.
+ */
+#ifndef CLASSB_BEACON_SKIP_PERIODS
+#define CLASSB_BEACON_SKIP_PERIODS                  0
+#endif
+
+/*!
+ * Maximum predicted RX timing error in ms of the next beacon for a beacon
+ * reception to be skipped
+ */
+#define CLASSB_BEACON_SKIP_MAX_RX_ERROR             20
+
+/*!
+ * Radio currents in uA setting the break-even gap between two class B slots.
+ * Below it the radio waits in standby, keeping its configuration, rather than
+ * sleeping and paying a wake up and a full reconfiguration.
+ */
+#ifndef CLASSB_RADIO_SLEEP_CURRENT
+#define CLASSB_RADIO_SLEEP_CURRENT                  1
+#endif
+#ifndef CLASSB_RADIO_STANDBY_CURRENT
+#define CLASSB_RADIO_STANDBY_CURRENT                600
+#endif
+/*!
+ * Average current in uA drawn while waking up and reconfiguring the radio
+ */
+#ifndef CLASSB_RADIO_WAKEUP_CURRENT
+#define CLASSB_RADIO_WAKEUP_CURRENT                 1500
+#endif
+
+/*!
+ * Time in ms to reconfigure the radio for a slot, on top of
+ * Radio.GetWakeupTime
+ */
+#ifndef CLASSB_RADIO_CONFIG_TIME
+#define CLASSB_RADIO_CONFIG_TIME                    1
+#endif
+
+/*!
+ * Timing error in ms of the beacon predicted from a DeviceTimeAns. Covers the
+ * 1/256 s resolution of the answer and the timestamp of the uplink end.
+ */
+#ifndef CLASSB_ACQUISITION_DEVICE_TIME_ERROR
+#define CLASSB_ACQUISITION_DEVICE_TIME_ERROR        8
+#endif
+
+/*!
+ * Clock drift in ppm assumed by the acquisition window until the beacon drift
+ * model is characterized
+ */
+#ifndef CLASSB_ACQUISITION_CLOCK_DRIFT
+#define CLASSB_ACQUISITION_CLOCK_DRIFT              40
+#endif
+
+/*!
+ * Expansion factor of the acquisition window on a missed beacon
+ */
+#define CLASSB_ACQUISITION_EXPANSION_FACTOR         2
+
+/*!
+ * Maximum timing error in ms covered by the acquisition window. Once a beacon
+ * is missed with the maximum window the beacon is lost.
+ */
+#define CLASSB_ACQUISITION_ERROR_MAX                512
+
+#if ( CLASSB_RADIO_STANDBY_CURRENT <= CLASSB_RADIO_SLEEP_CURRENT )
+#error "CLASSB_RADIO_STANDBY_CURRENT must be greater than CLASSB_RADIO_SLEEP_CURRENT"
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -61,6 +61,10 @@ struct sMacCommand
      *  The pointer to the next MAC Command element in the list
      */
     MacCommand_t* Next;
+    /*!
+     *  The pointer to the previous MAC Command element in the list
+     */
+    MacCommand_t* Prev;
     /*!
      * MAC command identifier
      */
@@ -226,6 +230,22 @@ LoRaMacCommandStatus_t LoRaMacCommandsStickyCmdsPending( bool* cmdsPending );
  */
 uint8_t LoRaMacCommandsGetCmdSize( uint8_t cid );
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t LoRaMacCommandsGetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void LoRaMacCommandsSelectInstance( void* instance );
+#endif
+
 /*! \} addtogroup LORAMAC */
 
 #ifdef __cplusplus
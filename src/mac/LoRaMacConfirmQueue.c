@@ -26,6 +26,10 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ) and Daniel Jae
 #include "LoRaMac.h"
 #include "LoRaMacConfirmQueue.h"
 
+/*
+ * Number of Mlme_t request types
+ */
+#define LORA_MAC_MLME_NB_REQUESTS                   ( MLME_BEACON_LOST + 1 )
 
 /*
  * LoRaMac Confirm Queue Context NVM structure
@@ -63,6 +67,11 @@ typedef struct sLoRaMacConfirmQueueCtx
     * Pointer to the last element of the ring buffer
     */
     MlmeConfirmQueue_t* BufferEnd;
+    /*!
+    * Queue element of each pending request, indexed by Mlme_t. NULL when
+    * the request is not in the queue.
+    */
+    MlmeConfirmQueue_t* RequestSlots[LORA_MAC_MLME_NB_REQUESTS];
     /*
      * Callback function to notify the upper layer about context change
      */
@@ -73,15 +82,45 @@ typedef struct sLoRaMacConfirmQueueCtx
     LoRaMacConfirmQueueNvmCtx_t* ConfirmQueueNvmCtx;
 } LoRaMacConfirmQueueCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sLoRaMacConfirmQueueInstance
+{
+    /*!
+     * Non-volatile module context
+     */
+    LoRaMacConfirmQueueNvmCtx_t NvmConfirmQueueCtx;
+    /*!
+     * Module context
+     */
+    LoRaMacConfirmQueueCtx_t ConfirmQueueCtx;
+}LoRaMacConfirmQueueInstance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static LoRaMacConfirmQueueInstance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static LoRaMacConfirmQueueInstance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmConfirmQueueCtx                          ( SelectedInstance->NvmConfirmQueueCtx )
+#define ConfirmQueueCtx                             ( SelectedInstance->ConfirmQueueCtx )
+#else
 /*
  * Non-volatile module context.
  */
-static LoRaMacConfirmQueueNvmCtx_t ConfirmQueueNvmCtx;
+static LoRaMacConfirmQueueNvmCtx_t NvmConfirmQueueCtx;
 
 /*
  * Module context.
  */
 static LoRaMacConfirmQueueCtx_t ConfirmQueueCtx;
+#endif
 
 static MlmeConfirmQueue_t* IncreaseBufferPointer( MlmeConfirmQueue_t* bufferPointer )
 {
@@ -112,23 +151,44 @@ static MlmeConfirmQueue_t* DecreaseBufferPointer( MlmeConfirmQueue_t* bufferPoin
     return bufferPointer;
 }
 
-static MlmeConfirmQueue_t* GetElement( Mlme_t request, MlmeConfirmQueue_t* bufferStart, MlmeConfirmQueue_t* bufferEnd )
+static MlmeConfirmQueue_t* GetElement( Mlme_t request )
 {
-    MlmeConfirmQueue_t* element = bufferStart;
+    if( ( size_t )request >= LORA_MAC_MLME_NB_REQUESTS )
+    {
+        return NULL;
+    }
+    return ConfirmQueueCtx.RequestSlots[request];
+}
 
-    while( element != bufferEnd )
+static void SetElement( MlmeConfirmQueue_t* element )
+{
+    if( ( ( size_t )element->Request < LORA_MAC_MLME_NB_REQUESTS ) &&
+        ( ConfirmQueueCtx.RequestSlots[element->Request] == NULL ) )
     {
-        if( element->Request == request )
-        {
-            // We have found the element
-            return element;
-        }
-        else
-        {
-            element = IncreaseBufferPointer( element );
-        }
+        ConfirmQueueCtx.RequestSlots[element->Request] = element;
+    }
+}
+
+static void ClearElement( MlmeConfirmQueue_t* element )
+{
+    if( ( ( size_t )element->Request < LORA_MAC_MLME_NB_REQUESTS ) &&
+        ( ConfirmQueueCtx.RequestSlots[element->Request] == element ) )
+    {
+        ConfirmQueueCtx.RequestSlots[element->Request] = NULL;
+    }
+}
+
+static void RebuildElements( void )
+{
+    MlmeConfirmQueue_t* element = ConfirmQueueCtx.BufferStart;
+
+    memset1( ( uint8_t* )ConfirmQueueCtx.RequestSlots, 0, sizeof( ConfirmQueueCtx.RequestSlots ) );
+
+    for( uint8_t i = 0; i < ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt; i++ )
+    {
+        SetElement( element );
+        element = IncreaseBufferPointer( element );
     }
-    return NULL;
 }
 
 void LoRaMacConfirmQueueInit( LoRaMacPrimitives_t* primitives, LoRaMacConfirmQueueNvmEvent confirmQueueNvmCtxChanged )
@@ -136,7 +196,7 @@ void LoRaMacConfirmQueueInit( LoRaMacPrimitives_t* primitives, LoRaMacConfirmQue
     ConfirmQueueCtx.Primitives = primitives;
 
     // Assign nvm context
-    ConfirmQueueCtx.ConfirmQueueNvmCtx = &ConfirmQueueNvmCtx;
+    ConfirmQueueCtx.ConfirmQueueNvmCtx = &NvmConfirmQueueCtx;
 
     // Init counter
     ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt = 0;
@@ -146,6 +206,7 @@ void LoRaMacConfirmQueueInit( LoRaMacPrimitives_t* primitives, LoRaMacConfirmQue
     ConfirmQueueCtx.BufferEnd = ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueue;
 
     memset1( ( uint8_t* )ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueue, 0xFF, sizeof( ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueue ) );
+    memset1( ( uint8_t* )ConfirmQueueCtx.RequestSlots, 0, sizeof( ConfirmQueueCtx.RequestSlots ) );
 
     // Common status
     ConfirmQueueCtx.ConfirmQueueNvmCtx->CommonStatus = LORAMAC_EVENT_INFO_STATUS_ERROR;
@@ -159,7 +220,8 @@ bool LoRaMacConfirmQueueRestoreNvmCtx( void* confirmQueueNvmCtx )
     // Restore module context
     if( confirmQueueNvmCtx != NULL )
     {
-        memcpy1( ( uint8_t* )&ConfirmQueueNvmCtx, ( uint8_t* ) confirmQueueNvmCtx, sizeof( ConfirmQueueNvmCtx ) );
+        memcpy1( ( uint8_t* )&NvmConfirmQueueCtx, ( uint8_t* ) confirmQueueNvmCtx, sizeof( NvmConfirmQueueCtx ) );
+        RebuildElements( );
         return true;
     }
     else
@@ -170,8 +232,8 @@ bool LoRaMacConfirmQueueRestoreNvmCtx( void* confirmQueueNvmCtx )
 
 void* LoRaMacConfirmQueueGetNvmCtx( size_t* confirmQueueNvmCtxSize )
 {
-    *confirmQueueNvmCtxSize = sizeof( ConfirmQueueNvmCtx );
-    return &ConfirmQueueNvmCtx;
+    *confirmQueueNvmCtxSize = sizeof( NvmConfirmQueueCtx );
+    return &NvmConfirmQueueCtx;
 }
 
 bool LoRaMacConfirmQueueAdd( MlmeConfirmQueue_t* mlmeConfirm )
@@ -187,6 +249,7 @@ bool LoRaMacConfirmQueueAdd( MlmeConfirmQueue_t* mlmeConfirm )
     ConfirmQueueCtx.BufferEnd->Status = mlmeConfirm->Status;
     ConfirmQueueCtx.BufferEnd->RestrictCommonReadyToHandle = mlmeConfirm->RestrictCommonReadyToHandle;
     ConfirmQueueCtx.BufferEnd->ReadyToHandle = false;
+    SetElement( ConfirmQueueCtx.BufferEnd );
     // Increase counter
     ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt++;
     // Update end pointer
@@ -206,6 +269,7 @@ bool LoRaMacConfirmQueueRemoveLast( void )
     ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt--;
     // Update start pointer
     ConfirmQueueCtx.BufferEnd = DecreaseBufferPointer( ConfirmQueueCtx.BufferEnd );
+    ClearElement( ConfirmQueueCtx.BufferEnd );
 
     return true;
 }
@@ -219,6 +283,7 @@ bool LoRaMacConfirmQueueRemoveFirst( void )
 
     // Increase counter
     ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt--;
+    ClearElement( ConfirmQueueCtx.BufferStart );
     // Update start pointer
     ConfirmQueueCtx.BufferStart = IncreaseBufferPointer( ConfirmQueueCtx.BufferStart );
 
@@ -227,30 +292,22 @@ bool LoRaMacConfirmQueueRemoveFirst( void )
 
 void LoRaMacConfirmQueueSetStatus( LoRaMacEventInfoStatus_t status, Mlme_t request )
 {
-    MlmeConfirmQueue_t* element = NULL;
+    MlmeConfirmQueue_t* element = GetElement( request );
 
-    if( ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt > 0 )
+    if( element != NULL )
     {
-        element = GetElement( request, ConfirmQueueCtx.BufferStart, ConfirmQueueCtx.BufferEnd );
-        if( element != NULL )
-        {
-            element->Status = status;
-            element->ReadyToHandle = true;
-        }
+        element->Status = status;
+        element->ReadyToHandle = true;
     }
 }
 
 LoRaMacEventInfoStatus_t LoRaMacConfirmQueueGetStatus( Mlme_t request )
 {
-    MlmeConfirmQueue_t* element = NULL;
+    MlmeConfirmQueue_t* element = GetElement( request );
 
-    if( ConfirmQueueCtx.ConfirmQueueNvmCtx->MlmeConfirmQueueCnt > 0 )
+    if( element != NULL )
     {
-        element = GetElement( request, ConfirmQueueCtx.BufferStart, ConfirmQueueCtx.BufferEnd );
-        if( element != NULL )
-        {
-            return element->Status;
-        }
+        return element->Status;
     }
     return LORAMAC_EVENT_INFO_STATUS_ERROR;
 }
@@ -284,7 +341,7 @@ LoRaMacEventInfoStatus_t LoRaMacConfirmQueueGetStatusCmn( void )
 
 bool LoRaMacConfirmQueueIsCmdActive( Mlme_t request )
 {
-    if( GetElement( request, ConfirmQueueCtx.BufferStart, ConfirmQueueCtx.BufferEnd ) != NULL )
+    if( GetElement( request ) != NULL )
     {
         return true;
     }
@@ -342,3 +399,15 @@ bool LoRaMacConfirmQueueIsFull( void )
         return false;
     }
 }
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t LoRaMacConfirmQueueGetInstanceSize( void )
+{
+    return sizeof( LoRaMacConfirmQueueInstance_t );
+}
+
+void LoRaMacConfirmQueueSelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( LoRaMacConfirmQueueInstance_t* )instance : &DefaultInstance;
+}
+#endif
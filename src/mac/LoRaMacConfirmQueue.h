@@ -52,7 +52,9 @@ extern "C"
 /*!
  * LoRaMac MLME-Confirm queue length
  */
+#ifndef LORA_MAC_MLME_CONFIRM_QUEUE_LEN
 #define LORA_MAC_MLME_CONFIRM_QUEUE_LEN             5
+#endif
 
 /*!
  * Structure to hold multiple MLME request confirm data
@@ -197,6 +199,22 @@ uint8_t LoRaMacConfirmQueueGetCnt( void );
  */
 bool LoRaMacConfirmQueueIsFull( void );
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t LoRaMacConfirmQueueGetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void LoRaMacConfirmQueueSelectInstance( void* instance );
+#endif
+
 #ifdef __cplusplus
 }
 #endif
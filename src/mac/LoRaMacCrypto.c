@@ -106,6 +106,48 @@
  */
 #define CRYPTO_MIC_COMPUTATION_OFFSET   JOIN_REQ_TYPE_SIZE + LORAMAC_JOIN_EUI_FIELD_SIZE + DEV_NONCE_SIZE + LORAMAC_MHDR_FIELD_SIZE
 
+/*
+ * Number of keys derived on a join accept, McRootKey, McKEKey and the 4
+ * session keys
+ */
+#define JOIN_ACCEPT_DERIVATIONS_NB      6
+
+/*
+ * Number of uplink and multicast downlink frame counter values reserved ahead
+ * in the non volatile context. A frame counter change is only notified once
+ * its reserved values are used up, a restored context skips the values
+ * reserved before the reset.
+ */
+#ifndef LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW
+#define LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW         16
+#endif
+
+#if( LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW < 1 )
+#error "LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW must be at least 1"
+#endif
+
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+/*
+ * Number of precomputed downlink key streams, i.e. the number of expected
+ * downlink frame counters starting at the next one
+ */
+#ifndef LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD
+#define LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD          2
+#endif
+
+/*
+ * Size of a precomputed downlink key stream. Longer payloads get the key
+ * stream of the remaining part computed on arrival.
+ */
+#ifndef LORAMAC_CRYPTO_KEYSTREAM_SIZE
+#define LORAMAC_CRYPTO_KEYSTREAM_SIZE               64
+#endif
+
+#if( ( LORAMAC_CRYPTO_KEYSTREAM_SIZE % 16 ) != 0 )
+#error "LORAMAC_CRYPTO_KEYSTREAM_SIZE must be a multiple of 16"
+#endif
+#endif
+
 /*!
  * LoRaWAN Frame counter list.
  */
@@ -172,6 +214,11 @@ typedef struct sLoRaMacCryptoNvmCtx
      * Frame counter list
      */
     FCntList_t FCntList;
+    /*
+     * Highest uplink and multicast downlink frame counter values reserved,
+     * the frame counters are set to them when the context is restored
+     */
+    FCntList_t FCntReserved;
     /*
      * RJcount1 is a counter incremented with every Rejoin request Type 1 frame transmitted.
      */
@@ -186,6 +233,35 @@ typedef struct sLoRaMacCryptoNvmCtx
 /*
  * LoRaMac Crypto Context structure
  */
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+/*
+ * Precomputed downlink payload key stream
+ */
+typedef struct sDownlinkKeystream
+{
+    /*
+     * True if the key stream is valid
+     */
+    bool IsValid;
+    /*
+     * Payload encryption key identifier
+     */
+    KeyIdentifier_t KeyID;
+    /*
+     * Device address
+     */
+    uint32_t Address;
+    /*
+     * Downlink frame counter
+     */
+    uint32_t FCnt;
+    /*
+     * Key stream blocks A1, A2, ... encrypted
+     */
+    uint8_t Keystream[LORAMAC_CRYPTO_KEYSTREAM_SIZE];
+}DownlinkKeystream_t;
+#endif
+
 typedef struct sLoRaMacCryptoCtx
 {
     /*
@@ -200,6 +276,13 @@ typedef struct sLoRaMacCryptoCtx
      * Callback function to notify the upper layer about context change
      */
     LoRaMacCryptoNvmEvent EventCryptoNvmCtxChanged;
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+    /*
+     * Precomputed downlink key streams, indexed by frame counter modulo
+     * LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD
+     */
+    DownlinkKeystream_t DownlinkKeystreams[LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD];
+#endif
 }LoRaMacCryptoCtx_t;
 
 /*
@@ -225,6 +308,35 @@ typedef struct sKeyAddr
     KeyIdentifier_t RootKey;
 }KeyAddr_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sLoRaMacCryptoInstance
+{
+    /*!
+     * Module context
+     */
+    LoRaMacCryptoCtx_t CryptoCtx;
+    /*!
+     * Non-volatile module context
+     */
+    LoRaMacCryptoNvmCtx_t NvmCryptoCtx;
+}LoRaMacCryptoInstance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static LoRaMacCryptoInstance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static LoRaMacCryptoInstance_t* SelectedInstance = &DefaultInstance;
+
+#define CryptoCtx                                   ( SelectedInstance->CryptoCtx )
+#define NvmCryptoCtx                                ( SelectedInstance->NvmCryptoCtx )
+#else
 /*
  *Crypto module context.
  */
@@ -234,9 +346,16 @@ static LoRaMacCryptoCtx_t CryptoCtx;
  * Non volatile module context.
  */
 static LoRaMacCryptoNvmCtx_t NvmCryptoCtx;
+#endif
 
 /*
- * Key-Address list
+ * Join accept decryption and MIC work buffer, shared by the instances instead
+ * of being allocated on the stack
+ */
+static uint8_t CryptoProcBuffer[CRYPTO_MAXMESSAGE_SIZE + CRYPTO_MIC_COMPUTATION_OFFSET];
+
+/*
+ * Key-Address list, indexed by AddressIdentifier_t
  */
 static KeyAddr_t KeyAddrList[NUM_OF_SEC_CTX] =
     {
@@ -252,27 +371,17 @@ static KeyAddr_t KeyAddrList[NUM_OF_SEC_CTX] =
  */
 
 /*
- * Encrypts the payload
+ * Prepares the A block used for the payload encryption. The block counter
+ * byte A[15] is left to 0.
  *
- * \param[IN]  keyID            - Key identifier
  * \param[IN]  address          - Address
  * \param[IN]  dir              - Frame direction ( Uplink or Downlink )
  * \param[IN]  frameCounter     - Frame counter
- * \param[IN]  size             - Size of data
- * \param[IN/OUT]  buffer       - Data buffer
- * \retval                      - Status of the operation
+ * \param[OUT] aBlock           - A block
  */
-static LoRaMacCryptoStatus_t PayloadEncrypt( uint8_t* buffer, int16_t size, KeyIdentifier_t keyID, uint32_t address, uint8_t dir, uint32_t frameCounter )
+static void PreparePayloadA( uint32_t address, uint8_t dir, uint32_t frameCounter, uint8_t* aBlock )
 {
-    if( buffer == 0 )
-    {
-        return LORAMAC_CRYPTO_ERROR_NPE;
-    }
-
-    uint8_t bufferIndex = 0;
-    uint16_t ctr = 1;
-    uint8_t sBlock[16] = { 0 };
-    uint8_t aBlock[16] = { 0 };
+    memset1( aBlock, 0, 16 );
 
     aBlock[0] = 0x01;
 
@@ -287,25 +396,6 @@ static LoRaMacCryptoStatus_t PayloadEncrypt( uint8_t* buffer, int16_t size, KeyI
     aBlock[11] = ( frameCounter >> 8 ) & 0xFF;
     aBlock[12] = ( frameCounter >> 16 ) & 0xFF;
     aBlock[13] = ( frameCounter >> 24 ) & 0xFF;
-
-    while( size > 0 )
-    {
-        aBlock[15] = ctr & 0xFF;
-        ctr++;
-        if( SecureElementAesEncrypt( aBlock, 16, keyID, sBlock ) != SECURE_ELEMENT_SUCCESS )
-        {
-            return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
-        }
-
-        for( uint8_t i = 0; i < ( ( size > 16 ) ? 16 : size ); i++ )
-        {
-            buffer[bufferIndex + i] = buffer[bufferIndex + i] ^ sBlock[i];
-        }
-        size -= 16;
-        bufferIndex += 16;
-    }
-
-    return LORAMAC_CRYPTO_SUCCESS;
 }
 
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
@@ -451,90 +541,61 @@ static LoRaMacCryptoStatus_t PrepareB0( uint16_t msgLen, KeyIdentifier_t keyID,
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
-/*
- * Computes cmac with adding B0 block in front.
+/*!
+ * Ciphers the FRMPayload of a serialized message and computes the cmac of
+ * the message with adding B0 block in front, in a single pass. The cmac is
+ * computed over the encrypted payload.
  *
- *  cmac = aes128_cmac(keyID, B0 | msg)
+ *  cmac = aes128_cmac(micKeyID, B0 | msg)
  *
- * \param[IN]  msg            - Message to compute the integrity code
- * \param[IN]  len            - Length of message
- * \param[IN]  keyID          - Key identifier
+ * Uplinks are encrypted in place in the message buffer. Downlinks are
+ * decrypted into macMsg->FRMPayload.
+ *
+ * \param[IN]  macMsg         - Serialized message
+ * \param[IN]  encSize        - Number of FRMPayload bytes to be ciphered, 0 to only compute the cmac
+ * \param[IN]  encKeyID       - Payload encryption key identifier
+ * \param[IN]  keystream      - Precomputed payload key stream, may be NULL
+ * \param[IN]  keystreamSize  - Precomputed payload key stream size
+ * \param[IN]  micKeyID       - Cmac key identifier
  * \param[IN]  isAck          - True if it is a acknowledge frame ( Sets ConfFCnt in B0 block )
- * \param[IN]  devAddr        - Device address
  * \param[IN]  dir            - Frame direction ( Uplink:0, Downlink:1 )
+ * \param[IN]  devAddr        - Device address
  * \param[IN]  fCnt           - Frame counter
  * \param[OUT] cmac           - Computed cmac
  * \retval                    - Status of the operation
  */
-static LoRaMacCryptoStatus_t ComputeCmacB0( uint8_t* msg, uint16_t len, KeyIdentifier_t keyID, bool isAck, uint8_t dir, uint32_t devAddr, uint32_t fCnt, uint32_t* cmac )
+static LoRaMacCryptoStatus_t PayloadEncryptComputeCmacB0( LoRaMacMessageData_t* macMsg, uint16_t encSize, KeyIdentifier_t encKeyID,
+                                                          const uint8_t* keystream, uint16_t keystreamSize, KeyIdentifier_t micKeyID,
+                                                          bool isAck, uint8_t dir, uint32_t devAddr, uint32_t fCnt, uint32_t* cmac )
 {
-    if( ( msg == 0 ) || ( cmac == 0 ) )
-    {
-        return LORAMAC_CRYPTO_ERROR_NPE;
-    }
-    if( len > CRYPTO_MAXMESSAGE_SIZE )
-    {
-        return LORAMAC_CRYPTO_ERROR_BUF_SIZE;
-    }
-
     uint8_t micBuff[MIC_BLOCK_BX_SIZE];
+    uint8_t aBlock[16];
 
-    // Initialize the first Block
-    PrepareB0( len, keyID, isAck, dir, devAddr, fCnt, micBuff );
-
-    if( SecureElementComputeAesCmac( micBuff, msg, len, keyID, cmac ) != SECURE_ELEMENT_SUCCESS )
+    if( ( macMsg->BufSize < ( LORAMAC_MIC_FIELD_SIZE + macMsg->FRMPayloadSize ) ) ||
+        ( ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ) > CRYPTO_MAXMESSAGE_SIZE ) )
     {
-        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
+        return LORAMAC_CRYPTO_ERROR_BUF_SIZE;
     }
-    return LORAMAC_CRYPTO_SUCCESS;
-}
 
-/*!
- * Verifies cmac with adding B0 block in front.
- *
- * \param[IN]  msg            - Message to compute the integrity code
- * \param[IN]  len            - Length of message
- * \param[IN]  keyID          - Key identifier
- * \param[IN]  isAck          - True if it is a acknowledge frame ( Sets ConfFCnt in B0 block )
- * \param[IN]  devAddr        - Device address
- * \param[IN]  dir            - Frame direction ( Uplink:0, Downlink:1 )
- * \param[IN]  fCnt           - Frame counter
- * \param[in]  expectedCmac   - Expected cmac
- * \retval                    - Status of the operation
- */
-static LoRaMacCryptoStatus_t VerifyCmacB0( uint8_t* msg, uint16_t len, KeyIdentifier_t keyID, bool isAck, uint8_t dir, uint32_t devAddr, uint32_t fCnt, uint32_t expectedCmac )
-{
-    if( msg == 0 )
+    uint16_t len = macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE;
+    uint16_t encOffset = len - macMsg->FRMPayloadSize;
+    uint8_t* encBuffer = ( dir == UPLINK ) ? &macMsg->Buffer[encOffset] : macMsg->FRMPayload;
+
+    if( encBuffer == NULL )
     {
         return LORAMAC_CRYPTO_ERROR_NPE;
     }
-    if( len > CRYPTO_MAXMESSAGE_SIZE )
-    {
-        return LORAMAC_CRYPTO_ERROR_BUF_SIZE;
-    }
-
-    uint8_t micBuff[CRYPTO_BUFFER_SIZE];
-    memset1( micBuff, 0, CRYPTO_BUFFER_SIZE );
 
     // Initialize the first Block
-    PrepareB0( len, keyID, isAck, dir, devAddr, fCnt, micBuff );
+    PrepareB0( len, micKeyID, isAck, dir, devAddr, fCnt, micBuff );
+    PreparePayloadA( devAddr, dir, fCnt, aBlock );
 
-    // Copy the given data to the mic computation buffer
-    memcpy1( ( micBuff + MIC_BLOCK_BX_SIZE ), msg, len );
-
-    SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
-    retval = SecureElementVerifyAesCmac( micBuff, ( len + MIC_BLOCK_BX_SIZE ), expectedCmac, keyID );
-
-    if( retval == SECURE_ELEMENT_SUCCESS )
+    if( SecureElementAesCtrCmac( micBuff, macMsg->Buffer, len, micKeyID, aBlock, encOffset, encSize, encKeyID, keystream, keystreamSize,
+                                 ( dir == UPLINK ), encBuffer, cmac ) != SECURE_ELEMENT_SUCCESS )
     {
-        return LORAMAC_CRYPTO_SUCCESS;
-    }
-    else if( retval == SECURE_ELEMENT_FAIL_CMAC )
-    {
-        return LORAMAC_CRYPTO_FAIL_MIC;
+        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
     }
-
-    return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
+    return LORAMAC_CRYPTO_SUCCESS;
 }
 
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
@@ -643,34 +704,35 @@ static LoRaMacCryptoStatus_t ComputeCmacB1( uint8_t* msg, uint16_t len, KeyIdent
  */
 static LoRaMacCryptoStatus_t GetKeyAddrItem( AddressIdentifier_t addrID, KeyAddr_t** item )
 {
-    for( uint8_t i = 0; i < NUM_OF_SEC_CTX; i++ )
+    // KeyAddrList is indexed by the address identifier
+    if( ( ( size_t )addrID >= NUM_OF_SEC_CTX ) || ( KeyAddrList[addrID].AddrID != addrID ) )
     {
-        if( KeyAddrList[i].AddrID == addrID )
-        {
-            *item = &( KeyAddrList[i] );
-            return LORAMAC_CRYPTO_SUCCESS;
-        }
+        return LORAMAC_CRYPTO_ERROR_INVALID_ADDR_ID;
     }
-    return LORAMAC_CRYPTO_ERROR_INVALID_ADDR_ID;
+    *item = &( KeyAddrList[addrID] );
+    return LORAMAC_CRYPTO_SUCCESS;
 }
 
 /*
- * Derives a session key as of LoRaWAN versions prior to 1.1.0
+ * Prepares the derivation of a session key as of LoRaWAN versions prior to 1.1.0
  *
  * \param[IN]  keyID          - Key Identifier for the key to be calculated
  * \param[IN]  joinNonce      - Sever nonce
  * \param[IN]  netID          - Network Identifier
  * \param[IN]  deviceNonce    - Device nonce
+ * \param[OUT] compBase       - Derivation input ( 16 byte )
+ * \param[OUT] derivation     - Key derivation for SecureElementDeriveAndStoreKeys
  * \retval                    - Status of the operation
  */
-static LoRaMacCryptoStatus_t DeriveSessionKey10x( KeyIdentifier_t keyID, uint8_t* joinNonce, uint8_t* netID, uint8_t* devNonce )
+static LoRaMacCryptoStatus_t PrepareSessionKeyDerivation10x( KeyIdentifier_t keyID, uint8_t* joinNonce, uint8_t* netID, uint8_t* devNonce,
+                                                             uint8_t* compBase, SecureElementKeyDerivation_t* derivation )
 {
     if( ( joinNonce == 0 ) || ( netID == 0 ) || ( devNonce == 0 ) )
     {
         return LORAMAC_CRYPTO_ERROR_NPE;
     }
 
-    uint8_t compBase[16] = { 0 };
+    memset1( compBase, 0, 16 );
 
     switch( keyID )
     {
@@ -690,32 +752,90 @@ static LoRaMacCryptoStatus_t DeriveSessionKey10x( KeyIdentifier_t keyID, uint8_t
     memcpy1( compBase + 4, netID, 3 );
     memcpy1( compBase + 7, devNonce, 2 );
 
-    if( SecureElementDeriveAndStoreKey( CryptoCtx.NvmCtx->LrWanVersion, compBase, NWK_KEY, keyID ) != SECURE_ELEMENT_SUCCESS )
+    derivation->Input = compBase;
+    derivation->RootKeyID = NWK_KEY;
+    derivation->TargetKeyID = keyID;
+
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
+/*
+ * Prepares the derivation of the McRootKey
+ *
+ * \param[IN]  keyID          - Key identifier of the root key, GenAppKey for
+ *                              LoRaWAN 1.0.x or AppKey for LoRaWAN 1.1 or later
+ * \param[OUT] compBase       - Derivation input ( 16 byte )
+ * \param[OUT] derivation     - Key derivation for SecureElementDeriveAndStoreKeys
+ * \retval                    - Status of the operation
+ */
+static LoRaMacCryptoStatus_t PrepareMcRootKeyDerivation( KeyIdentifier_t keyID, uint8_t* compBase, SecureElementKeyDerivation_t* derivation )
+{
+    // Prevent other keys than GenAppKey for LoRaWAN 1.0.x or AppKey for LoRaWAN 1.1 or later
+    if( ( ( keyID == APP_KEY ) && ( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 0 ) ) ||
+        ( ( keyID == GEN_APP_KEY ) && ( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 ) ) )
     {
-        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
+        return LORAMAC_CRYPTO_ERROR_INVALID_KEY_ID;
+    }
+
+    memset1( compBase, 0, 16 );
+    if( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 )
+    {
+        compBase[0] = 0x20;
+    }
+
+    derivation->Input = compBase;
+    derivation->RootKeyID = keyID;
+    derivation->TargetKeyID = MC_ROOT_KEY;
+
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
+/*
+ * Prepares the derivation of the McKEKey
+ *
+ * \param[IN]  keyID          - Key identifier of the root key, McRootKey
+ * \param[OUT] compBase       - Derivation input ( 16 byte )
+ * \param[OUT] derivation     - Key derivation for SecureElementDeriveAndStoreKeys
+ * \retval                    - Status of the operation
+ */
+static LoRaMacCryptoStatus_t PrepareMcKEKeyDerivation( KeyIdentifier_t keyID, uint8_t* compBase, SecureElementKeyDerivation_t* derivation )
+{
+    // Prevent other keys than McRootKey
+    if( keyID != MC_ROOT_KEY )
+    {
+        return LORAMAC_CRYPTO_ERROR_INVALID_KEY_ID;
     }
 
+    memset1( compBase, 0, 16 );
+
+    derivation->Input = compBase;
+    derivation->RootKeyID = keyID;
+    derivation->TargetKeyID = MC_KE_KEY;
+
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
 /*
- * Derives a session key as of LoRaWAN 1.1.0
+ * Prepares the derivation of a session key as of LoRaWAN 1.1.0
  *
  * \param[IN]  keyID          - Key Identifier for the key to be calculated
  * \param[IN]  joinNonce      - Sever nonce
  * \param[IN]  joinEUI        - Join Server EUI
  * \param[IN]  deviceNonce    - Device nonce
+ * \param[OUT] compBase       - Derivation input ( 16 byte )
+ * \param[OUT] derivation     - Key derivation for SecureElementDeriveAndStoreKeys
  * \retval                    - Status of the operation
  */
-static LoRaMacCryptoStatus_t DeriveSessionKey11x( KeyIdentifier_t keyID, uint8_t* joinNonce, uint8_t* joinEUI, uint8_t* devNonce )
+static LoRaMacCryptoStatus_t PrepareSessionKeyDerivation11x( KeyIdentifier_t keyID, uint8_t* joinNonce, uint8_t* joinEUI, uint8_t* devNonce,
+                                                             uint8_t* compBase, SecureElementKeyDerivation_t* derivation )
 {
     if( ( joinNonce == 0 ) || ( joinEUI == 0 ) || ( devNonce == 0 ) )
     {
         return LORAMAC_CRYPTO_ERROR_NPE;
     }
 
-    uint8_t compBase[16] = { 0 };
+    memset1( compBase, 0, 16 );
     KeyIdentifier_t rootKeyId = NWK_KEY;
 
     switch( keyID )
@@ -741,10 +861,9 @@ static LoRaMacCryptoStatus_t DeriveSessionKey11x( KeyIdentifier_t keyID, uint8_t
     memcpyr( compBase + 4, joinEUI, 8 );
     memcpy1( compBase + 12, devNonce, 2 );
 
-    if( SecureElementDeriveAndStoreKey( CryptoCtx.NvmCtx->LrWanVersion, compBase, rootKeyId, keyID ) != SECURE_ELEMENT_SUCCESS )
-    {
-        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
-    }
+    derivation->Input = compBase;
+    derivation->RootKeyID = rootKeyId;
+    derivation->TargetKeyID = keyID;
 
     return LORAMAC_CRYPTO_SUCCESS;
 }
@@ -861,6 +980,48 @@ static bool CheckFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
     }
 }
 
+/*!
+ * Reserves frame counter values ahead of a new frame counter value
+ *
+ * \param[IN]     lastFCnt      - Previous frame counter value
+ * \param[IN]     fCnt          - New frame counter value
+ * \param[IN]     reserved      - Highest reserved frame counter value
+ *
+ * \retval                     - True if new values are reserved, the non volatile context has to be stored
+ */
+static bool ReserveFCnt( uint32_t lastFCnt, uint32_t fCnt, uint32_t* reserved )
+{
+    // A reset frame counter doesn't use the values reserved before the reset
+    if( ( lastFCnt != FCNT_DOWN_INITAL_VALUE ) && ( *reserved != FCNT_DOWN_INITAL_VALUE ) && ( fCnt < *reserved ) )
+    {
+        return false;
+    }
+    if( fCnt < ( FCNT_DOWN_INITAL_VALUE - LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW ) )
+    {
+        *reserved = fCnt + LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW;
+    }
+    else
+    {
+        *reserved = FCNT_DOWN_INITAL_VALUE - 1;
+    }
+    return true;
+}
+
+/*!
+ * Sets a restored frame counter to its highest reserved value
+ *
+ * \param[IN]     fCnt          - Restored frame counter value
+ * \param[IN]     reserved      - Highest reserved frame counter value
+ */
+static void RestoreFCnt( uint32_t* fCnt, uint32_t reserved )
+{
+    // The values up to the reserved one may have been used before the reset
+    if( ( *fCnt != FCNT_DOWN_INITAL_VALUE ) && ( reserved != FCNT_DOWN_INITAL_VALUE ) && ( *fCnt < reserved ) )
+    {
+        *fCnt = reserved;
+    }
+}
+
 /*!
  * Updates the reference downlink counter
  *
@@ -871,33 +1032,52 @@ static bool CheckFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
  */
 static void UpdateFCntDown( FCntIdentifier_t fCntID, uint32_t currentDown )
 {
+    uint32_t* fCnt;
+    uint32_t* reserved;
+
     switch( fCntID )
     {
+        // The unicast downlink counters are stored on every change, a
+        // reserved window would reject the valid downlinks following a reset
         case N_FCNT_DOWN:
             CryptoCtx.NvmCtx->FCntList.NFCntDown = currentDown;
-            break;
+            CryptoCtx.EventCryptoNvmCtxChanged( );
+            return;
         case A_FCNT_DOWN:
             CryptoCtx.NvmCtx->FCntList.AFCntDown = currentDown;
-            break;
+            CryptoCtx.EventCryptoNvmCtxChanged( );
+            return;
         case FCNT_DOWN:
             CryptoCtx.NvmCtx->FCntList.FCntDown = currentDown;
-            break;
+            CryptoCtx.EventCryptoNvmCtxChanged( );
+            return;
         case MC_FCNT_DOWN_0:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown0 = currentDown;
+            fCnt = &CryptoCtx.NvmCtx->FCntList.McFCntDown0;
+            reserved = &CryptoCtx.NvmCtx->FCntReserved.McFCntDown0;
             break;
         case MC_FCNT_DOWN_1:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown1 = currentDown;
+            fCnt = &CryptoCtx.NvmCtx->FCntList.McFCntDown1;
+            reserved = &CryptoCtx.NvmCtx->FCntReserved.McFCntDown1;
             break;
         case MC_FCNT_DOWN_2:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown2 = currentDown;
+            fCnt = &CryptoCtx.NvmCtx->FCntList.McFCntDown2;
+            reserved = &CryptoCtx.NvmCtx->FCntReserved.McFCntDown2;
             break;
         case MC_FCNT_DOWN_3:
-            CryptoCtx.NvmCtx->FCntList.McFCntDown3 = currentDown;
+            fCnt = &CryptoCtx.NvmCtx->FCntList.McFCntDown3;
+            reserved = &CryptoCtx.NvmCtx->FCntReserved.McFCntDown3;
             break;
         default:
-            break;
+            return;
+    }
+
+    uint32_t lastDown = *fCnt;
+
+    *fCnt = currentDown;
+    if( ReserveFCnt( lastDown, currentDown, reserved ) == true )
+    {
+        CryptoCtx.EventCryptoNvmCtxChanged( );
     }
-    CryptoCtx.EventCryptoNvmCtxChanged( );
 }
 
 /*!
@@ -917,9 +1097,45 @@ static void ResetFCnts( void )
     CryptoCtx.NvmCtx->FCntList.McFCntDown2 = FCNT_DOWN_INITAL_VALUE;
     CryptoCtx.NvmCtx->FCntList.McFCntDown3 = FCNT_DOWN_INITAL_VALUE;
 
+    CryptoCtx.NvmCtx->FCntReserved = CryptoCtx.NvmCtx->FCntList;
+
     CryptoCtx.EventCryptoNvmCtxChanged( );
 }
 
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+/*
+ * Invalidates the precomputed downlink key streams
+ */
+static void InvalidateDownlinkKeystreams( void )
+{
+    for( uint8_t i = 0; i < LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD; i++ )
+    {
+        CryptoCtx.DownlinkKeystreams[i].IsValid = false;
+    }
+}
+
+/*
+ * Gets the precomputed key stream of a downlink
+ *
+ * \param[IN]     keyID        - Payload encryption key identifier
+ * \param[IN]     address      - Device address
+ * \param[IN]     fCnt         - Downlink frame counter
+ *
+ * \retval                     - Key stream, NULL if it is not precomputed
+ */
+static DownlinkKeystream_t* GetDownlinkKeystream( KeyIdentifier_t keyID, uint32_t address, uint32_t fCnt )
+{
+    DownlinkKeystream_t* keystream = &CryptoCtx.DownlinkKeystreams[fCnt % LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD];
+
+    if( ( keystream->IsValid == true ) && ( keystream->KeyID == keyID ) &&
+        ( keystream->Address == address ) && ( keystream->FCnt == fCnt ) )
+    {
+        return keystream;
+    }
+    return NULL;
+}
+#endif
+
 /*
  * Dummy callback in case if the user provides NULL function pointer
  */
@@ -959,6 +1175,10 @@ LoRaMacCryptoStatus_t LoRaMacCryptoInit( LoRaMacCryptoNvmEvent cryptoNvmCtxChang
     // Reset frame counters
     ResetFCnts( );
 
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+    InvalidateDownlinkKeystreams( );
+#endif
+
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
@@ -974,6 +1194,17 @@ LoRaMacCryptoStatus_t LoRaMacCryptoRestoreNvmCtx( void* cryptoNvmCtx )
     if( cryptoNvmCtx != 0 )
     {
         memcpy1( ( uint8_t* ) &NvmCryptoCtx, ( uint8_t* ) cryptoNvmCtx, CRYPTO_NVM_CTX_SIZE );
+
+        // Skip the frame counter values reserved before the reset, the unicast
+        // downlink counters are restored as they were stored
+        RestoreFCnt( &NvmCryptoCtx.FCntList.FCntUp, NvmCryptoCtx.FCntReserved.FCntUp );
+        RestoreFCnt( &NvmCryptoCtx.FCntList.McFCntDown0, NvmCryptoCtx.FCntReserved.McFCntDown0 );
+        RestoreFCnt( &NvmCryptoCtx.FCntList.McFCntDown1, NvmCryptoCtx.FCntReserved.McFCntDown1 );
+        RestoreFCnt( &NvmCryptoCtx.FCntList.McFCntDown2, NvmCryptoCtx.FCntReserved.McFCntDown2 );
+        RestoreFCnt( &NvmCryptoCtx.FCntList.McFCntDown3, NvmCryptoCtx.FCntReserved.McFCntDown3 );
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+        InvalidateDownlinkKeystreams( );
+#endif
         return LORAMAC_CRYPTO_SUCCESS;
     }
     else
@@ -982,6 +1213,25 @@ LoRaMacCryptoStatus_t LoRaMacCryptoRestoreNvmCtx( void* cryptoNvmCtx )
     }
 }
 
+LoRaMacCryptoStatus_t LoRaMacCryptoRestoreSessionNvmCtx( void* cryptoNvmCtx )
+{
+    uint16_t devNonce = NvmCryptoCtx.DevNonce;
+    uint32_t joinNonce = NvmCryptoCtx.JoinNonce;
+    uint16_t rJcount1 = NvmCryptoCtx.RJcount1;
+    LoRaMacCryptoStatus_t retval = LoRaMacCryptoRestoreNvmCtx( cryptoNvmCtx );
+
+    if( retval != LORAMAC_CRYPTO_SUCCESS )
+    {
+        return retval;
+    }
+
+    NvmCryptoCtx.DevNonce = MAX( NvmCryptoCtx.DevNonce, devNonce );
+    NvmCryptoCtx.JoinNonce = MAX( NvmCryptoCtx.JoinNonce, joinNonce );
+    NvmCryptoCtx.RJcount1 = MAX( NvmCryptoCtx.RJcount1, rJcount1 );
+    CryptoCtx.EventCryptoNvmCtxChanged( );
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
 void* LoRaMacCryptoGetNvmCtx( size_t* cryptoNvmCtxSize )
 {
     *cryptoNvmCtxSize = CRYPTO_NVM_CTX_SIZE;
@@ -1062,16 +1312,25 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSetMulticastReference( MulticastCtx_t* multic
         return LORAMAC_CRYPTO_ERROR_NPE;
     }
 
-    multicastList[0].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown0;
-    multicastList[1].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown1;
-    multicastList[2].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown2;
-    multicastList[3].DownLinkCounter = &CryptoCtx.NvmCtx->FCntList.McFCntDown3;
+    uint32_t* mcFCntDown[] =
+    {
+        &CryptoCtx.NvmCtx->FCntList.McFCntDown0, &CryptoCtx.NvmCtx->FCntList.McFCntDown1,
+        &CryptoCtx.NvmCtx->FCntList.McFCntDown2, &CryptoCtx.NvmCtx->FCntList.McFCntDown3
+    };
+
+    for( uint8_t i = 0; i < LORAMAC_MAX_MC_CTX; i++ )
+    {
+        multicastList[i].DownLinkCounter = mcFCntDown[i];
+    }
 
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
 LoRaMacCryptoStatus_t LoRaMacCryptoSetKey( KeyIdentifier_t keyID, uint8_t* key )
 {
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+    InvalidateDownlinkKeystreams( );
+#endif
     if( SecureElementSetKey( keyID, key ) != SECURE_ELEMENT_SUCCESS )
     {
         return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
@@ -1258,7 +1517,7 @@ LoRaMacCryptoStatus_t LoRaMacCryptoHandleJoinAccept( JoinReqIdentifier_t joinReq
     }
 #endif
     // Decrypt header, skip MHDR
-    uint8_t procBuffer[CRYPTO_MAXMESSAGE_SIZE + CRYPTO_MIC_COMPUTATION_OFFSET];
+    uint8_t *procBuffer = CryptoProcBuffer;
     memset1( procBuffer, 0, ( macMsg->BufSize + micComputationOffset ) );
 
     if( SecureElementAesEncrypt( macMsg->Buffer + LORAMAC_MHDR_FIELD_SIZE, ( macMsg->BufSize - LORAMAC_MHDR_FIELD_SIZE ), encryptionKeyID, ( procBuffer + micComputationOffset ) ) != SECURE_ELEMENT_SUCCESS )
@@ -1335,87 +1594,66 @@ LoRaMacCryptoStatus_t LoRaMacCryptoHandleJoinAccept( JoinReqIdentifier_t joinReq
         }
     }
 
-    // Derive session keys
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+    InvalidateDownlinkKeystreams( );
+#endif
+
+    // Derive the session keys in a single batch. The secure element expands
+    // each root key once and notifies its NVM context change once.
+    SecureElementKeyDerivation_t derivations[JOIN_ACCEPT_DERIVATIONS_NB];
+    uint8_t compBases[JOIN_ACCEPT_DERIVATIONS_NB][16];
+    uint8_t nbDerivations = 0;
+
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
     if( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 )
     {
-        // Derive lifetime keys
-        retval = LoRaMacCryptoDeriveMcRootKey( APP_KEY );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
+        static const KeyIdentifier_t sessionKeys[] = { F_NWK_S_INT_KEY, S_NWK_S_INT_KEY, NWK_S_ENC_KEY, APP_S_KEY };
 
-        retval = LoRaMacCryptoDeriveMcKEKey( MC_ROOT_KEY );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
-
-        retval = DeriveSessionKey11x( F_NWK_S_INT_KEY, macMsg->JoinNonce, joinEUI, devNonceForKeyDerivation );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
-
-        retval = DeriveSessionKey11x( S_NWK_S_INT_KEY, macMsg->JoinNonce, joinEUI, devNonceForKeyDerivation );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
-
-        retval = DeriveSessionKey11x( NWK_S_ENC_KEY, macMsg->JoinNonce, joinEUI, devNonceForKeyDerivation );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        // Derive lifetime keys
+        retval = PrepareMcRootKeyDerivation( APP_KEY, compBases[nbDerivations], &derivations[nbDerivations] );
+        nbDerivations++;
+        if( retval == LORAMAC_CRYPTO_SUCCESS )
         {
-            return retval;
+            retval = PrepareMcKEKeyDerivation( MC_ROOT_KEY, compBases[nbDerivations], &derivations[nbDerivations] );
+            nbDerivations++;
         }
 
-        retval = DeriveSessionKey11x( APP_S_KEY, macMsg->JoinNonce, joinEUI, devNonceForKeyDerivation );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        for( uint8_t i = 0; ( i < 4 ) && ( retval == LORAMAC_CRYPTO_SUCCESS ); i++ )
         {
-            return retval;
+            retval = PrepareSessionKeyDerivation11x( sessionKeys[i], macMsg->JoinNonce, joinEUI, devNonceForKeyDerivation,
+                                                     compBases[nbDerivations], &derivations[nbDerivations] );
+            nbDerivations++;
         }
     }
     else
 #endif
     {
-        // prior LoRaWAN 1.1.0
-        retval = LoRaMacCryptoDeriveMcRootKey( GEN_APP_KEY );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
-
-        retval = LoRaMacCryptoDeriveMcKEKey( MC_ROOT_KEY );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
-
-        retval = DeriveSessionKey10x( APP_S_KEY, macMsg->JoinNonce, macMsg->NetID, ( uint8_t* ) &CryptoCtx.NvmCtx->DevNonce );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
+        static const KeyIdentifier_t sessionKeys[] = { APP_S_KEY, NWK_S_ENC_KEY, F_NWK_S_INT_KEY, S_NWK_S_INT_KEY };
 
-        retval = DeriveSessionKey10x( NWK_S_ENC_KEY, macMsg->JoinNonce, macMsg->NetID, ( uint8_t* ) &CryptoCtx.NvmCtx->DevNonce );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
-        {
-            return retval;
-        }
-
-        retval = DeriveSessionKey10x( F_NWK_S_INT_KEY, macMsg->JoinNonce, macMsg->NetID, ( uint8_t* ) &CryptoCtx.NvmCtx->DevNonce );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        // prior LoRaWAN 1.1.0
+        retval = PrepareMcRootKeyDerivation( GEN_APP_KEY, compBases[nbDerivations], &derivations[nbDerivations] );
+        nbDerivations++;
+        if( retval == LORAMAC_CRYPTO_SUCCESS )
         {
-            return retval;
+            retval = PrepareMcKEKeyDerivation( MC_ROOT_KEY, compBases[nbDerivations], &derivations[nbDerivations] );
+            nbDerivations++;
         }
 
-        retval = DeriveSessionKey10x( S_NWK_S_INT_KEY, macMsg->JoinNonce, macMsg->NetID, ( uint8_t* ) &CryptoCtx.NvmCtx->DevNonce );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        for( uint8_t i = 0; ( i < 4 ) && ( retval == LORAMAC_CRYPTO_SUCCESS ); i++ )
         {
-            return retval;
+            retval = PrepareSessionKeyDerivation10x( sessionKeys[i], macMsg->JoinNonce, macMsg->NetID, ( uint8_t* ) &CryptoCtx.NvmCtx->DevNonce,
+                                                     compBases[nbDerivations], &derivations[nbDerivations] );
+            nbDerivations++;
         }
     }
+    if( retval != LORAMAC_CRYPTO_SUCCESS )
+    {
+        return retval;
+    }
+    if( SecureElementDeriveAndStoreKeys( CryptoCtx.NvmCtx->LrWanVersion, derivations, nbDerivations ) != SECURE_ELEMENT_SUCCESS )
+    {
+        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
+    }
 
     // Join-Accept is successfully processed, reset frame counters
     CryptoCtx.RJcount0 = 0;
@@ -1423,6 +1661,7 @@ LoRaMacCryptoStatus_t LoRaMacCryptoHandleJoinAccept( JoinReqIdentifier_t joinReq
     CryptoCtx.NvmCtx->FCntList.FCntDown = FCNT_DOWN_INITAL_VALUE;
     CryptoCtx.NvmCtx->FCntList.NFCntDown = FCNT_DOWN_INITAL_VALUE;
     CryptoCtx.NvmCtx->FCntList.AFCntDown = FCNT_DOWN_INITAL_VALUE;
+    CryptoCtx.NvmCtx->FCntReserved.FCntUp = 0;
     CryptoCtx.EventCryptoNvmCtxChanged( );
 
     return LORAMAC_CRYPTO_SUCCESS;
@@ -1432,6 +1671,7 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
 {
     LoRaMacCryptoStatus_t retval = LORAMAC_CRYPTO_ERROR;
     KeyIdentifier_t payloadDecryptionKeyID = APP_S_KEY;
+    uint16_t encSize = 0;
 
     if( macMsg == NULL )
     {
@@ -1452,17 +1692,22 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
 
     if( fCntUp > CryptoCtx.NvmCtx->FCntList.FCntUp )
     {
-        retval = PayloadEncrypt( macMsg->FRMPayload, macMsg->FRMPayloadSize, payloadDecryptionKeyID, macMsg->FHDR.DevAddr, UPLINK, fCntUp );
-        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        // Lay the frame out once. The payload is then encrypted in place while
+        // the mic is computed. Retransmissions reuse the secured frame and only
+        // patch the mic.
+        if( LoRaMacSerializerData( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
         {
-            return retval;
+            return LORAMAC_CRYPTO_ERROR_SERIALIZER;
         }
+        encSize = macMsg->FRMPayloadSize;
 
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
         if( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 )
         {
-            // Encrypt FOpts
-            retval = FOptsEncrypt( macMsg->FHDR.FCtrl.Bits.FOptsLen, macMsg->FHDR.DevAddr, UPLINK, FCNT_UP, fCntUp, macMsg->FHDR.FOpts );
+            // Encrypt FOpts in place
+            retval = FOptsEncrypt( macMsg->FHDR.FCtrl.Bits.FOptsLen, macMsg->FHDR.DevAddr, UPLINK, FCNT_UP, fCntUp,
+                                   &macMsg->Buffer[LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE +
+                                                   LORAMAC_FHDR_F_CTRL_FIELD_SIZE + LORAMAC_FHDR_F_CNT_FIELD_SIZE] );
             if( retval != LORAMAC_CRYPTO_SUCCESS )
             {
                 return retval;
@@ -1470,13 +1715,12 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
         }
 #endif
     }
-    CryptoCtx.NvmCtx->FCntList.FCntUp = fCntUp;
-    CryptoCtx.EventCryptoNvmCtxChanged( );
+    uint32_t lastFCntUp = CryptoCtx.NvmCtx->FCntList.FCntUp;
 
-    // Serialize message
-    if( LoRaMacSerializerData( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
+    CryptoCtx.NvmCtx->FCntList.FCntUp = fCntUp;
+    if( ReserveFCnt( lastFCntUp, fCntUp, &CryptoCtx.NvmCtx->FCntReserved.FCntUp ) == true )
     {
-        return LORAMAC_CRYPTO_ERROR_SERIALIZER;
+        CryptoCtx.EventCryptoNvmCtxChanged( );
     }
 
     // Compute mic
@@ -1486,14 +1730,14 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
         uint32_t cmacS = 0;
         uint32_t cmacF = 0;
 
-        // cmacS  = aes128_cmac(SNwkSIntKey, B1 | msg)
-        retval = ComputeCmacB1( macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), S_NWK_S_INT_KEY, macMsg->FHDR.FCtrl.Bits.Ack, txDr, txCh, macMsg->FHDR.DevAddr, fCntUp, &cmacS );
+        //cmacF = aes128_cmac(FNwkSIntKey, B0 | msg), encrypts the payload
+        retval = PayloadEncryptComputeCmacB0( macMsg, encSize, payloadDecryptionKeyID, NULL, 0, F_NWK_S_INT_KEY, macMsg->FHDR.FCtrl.Bits.Ack, UPLINK, macMsg->FHDR.DevAddr, fCntUp, &cmacF );
         if( retval != LORAMAC_CRYPTO_SUCCESS )
         {
             return retval;
         }
-        //cmacF = aes128_cmac(FNwkSIntKey, B0 | msg)
-        retval = ComputeCmacB0( macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), F_NWK_S_INT_KEY, macMsg->FHDR.FCtrl.Bits.Ack, UPLINK, macMsg->FHDR.DevAddr, fCntUp, &cmacF );
+        // cmacS  = aes128_cmac(SNwkSIntKey, B1 | msg)
+        retval = ComputeCmacB1( macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), S_NWK_S_INT_KEY, macMsg->FHDR.FCtrl.Bits.Ack, txDr, txCh, macMsg->FHDR.DevAddr, fCntUp, &cmacS );
         if( retval != LORAMAC_CRYPTO_SUCCESS )
         {
             return retval;
@@ -1506,15 +1750,15 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
     {
         // MIC = cmacF[0..3]
         // The IsAck parameter is every time false since the ConfFCnt field is not used in legacy mode.
-        retval = ComputeCmacB0( macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), NWK_S_ENC_KEY, false, UPLINK, macMsg->FHDR.DevAddr, fCntUp, &macMsg->MIC );
+        retval = PayloadEncryptComputeCmacB0( macMsg, encSize, payloadDecryptionKeyID, NULL, 0, NWK_S_ENC_KEY, false, UPLINK, macMsg->FHDR.DevAddr, fCntUp, &macMsg->MIC );
         if( retval != LORAMAC_CRYPTO_SUCCESS )
         {
             return retval;
         }
     }
 
-    // Re-serialize message to add the MIC
-    if( LoRaMacSerializerData( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
+    // Add the MIC, the rest of the message is already serialized
+    if( LoRaMacSerializerDataMic( macMsg ) != LORAMAC_SERIALIZER_SUCCESS )
     {
         return LORAMAC_CRYPTO_ERROR_SERIALIZER;
     }
@@ -1569,24 +1813,39 @@ LoRaMacCryptoStatus_t LoRaMacCryptoUnsecureMessage( AddressIdentifier_t addrID,
         isAck = false;
     }
 
-    // Verify mic
-    retval = VerifyCmacB0( macMsg->Buffer, ( macMsg->BufSize - LORAMAC_MIC_FIELD_SIZE ), micComputationKeyID, isAck, DOWNLINK, address, fCntDown, macMsg->MIC );
-    if( retval != LORAMAC_CRYPTO_SUCCESS )
-    {
-        return retval;
-    }
-
-    // Decrypt payload
     if( macMsg->FPort == 0 )
     {
         // Use network session encryption key
         payloadDecryptionKeyID = NWK_S_ENC_KEY;
     }
-    retval = PayloadEncrypt( macMsg->FRMPayload, macMsg->FRMPayloadSize, payloadDecryptionKeyID, address, DOWNLINK, fCntDown );
+
+    const uint8_t* keystream = NULL;
+    uint16_t keystreamSize = 0;
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+    DownlinkKeystream_t* downlinkKeystream = GetDownlinkKeystream( payloadDecryptionKeyID, address, fCntDown );
+    if( downlinkKeystream != NULL )
+    {
+        keystream = downlinkKeystream->Keystream;
+        keystreamSize = LORAMAC_CRYPTO_KEYSTREAM_SIZE;
+        // A key stream is only used once
+        downlinkKeystream->IsValid = false;
+    }
+#endif
+
+    // Verify mic and decrypt payload
+    uint32_t cmac = 0;
+    retval = PayloadEncryptComputeCmacB0( macMsg, macMsg->FRMPayloadSize, payloadDecryptionKeyID, keystream, keystreamSize,
+                                          micComputationKeyID, isAck, DOWNLINK, address, fCntDown, &cmac );
     if( retval != LORAMAC_CRYPTO_SUCCESS )
     {
         return retval;
     }
+    if( cmac != macMsg->MIC )
+    {
+        // Do not leave the payload of a forged frame decrypted
+        memset1( macMsg->FRMPayload, 0, macMsg->FRMPayloadSize );
+        return LORAMAC_CRYPTO_FAIL_MIC;
+    }
 
 #if( USE_LRWAN_1_1_X_CRYPTO == 1 )
     if( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 )
@@ -1605,21 +1864,69 @@ LoRaMacCryptoStatus_t LoRaMacCryptoUnsecureMessage( AddressIdentifier_t addrID,
     return LORAMAC_CRYPTO_SUCCESS;
 }
 
-LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcRootKey( KeyIdentifier_t keyID )
+LoRaMacCryptoStatus_t LoRaMacCryptoPrepareDownlinkKeystreams( uint32_t address )
 {
-    // Prevent other keys than GenAppKey for LoRaWAN 1.0.x or AppKey for LoRaWAN 1.1 or later
-    if( ( ( keyID == APP_KEY ) && ( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 0 ) ) ||
-        ( ( keyID == GEN_APP_KEY ) && ( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 ) ) )
+#ifdef LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE
+    KeyAddr_t* curItem;
+    uint32_t fCnt = CryptoCtx.NvmCtx->FCntList.FCntDown;
+    uint8_t aBlock[16];
+
+    LoRaMacCryptoStatus_t retval = GetKeyAddrItem( UNICAST_DEV_ADDR, &curItem );
+    if( retval != LORAMAC_CRYPTO_SUCCESS )
     {
-        return LORAMAC_CRYPTO_ERROR_INVALID_KEY_ID;
+        return retval;
     }
-    uint8_t compBase[16] = { 0 };
 
+    // Only the application payloads are prepared, they are the most frequent ones
     if( CryptoCtx.NvmCtx->LrWanVersion.Fields.Minor == 1 )
     {
-        compBase[0] = 0x20;
+        fCnt = CryptoCtx.NvmCtx->FCntList.AFCntDown;
+    }
+    // Next expected downlink frame counter
+    fCnt = ( fCnt == FCNT_DOWN_INITAL_VALUE ) ? 0 : ( fCnt + 1 );
+
+    for( uint8_t i = 0; i < LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD; i++, fCnt++ )
+    {
+        DownlinkKeystream_t* keystream = &CryptoCtx.DownlinkKeystreams[fCnt % LORAMAC_CRYPTO_KEYSTREAM_LOOKAHEAD];
+
+        if( GetDownlinkKeystream( curItem->AppSkey, address, fCnt ) != NULL )
+        {
+            // Already prepared
+            continue;
+        }
+
+        keystream->IsValid = false;
+        PreparePayloadA( address, DOWNLINK, fCnt, aBlock );
+        // The counter blocks are encrypted in place with a single call
+        for( uint16_t block = 0; block < LORAMAC_CRYPTO_KEYSTREAM_SIZE; block += 16 )
+        {
+            aBlock[15] = ( uint8_t )( ( block >> 4 ) + 1 );
+            memcpy16( &keystream->Keystream[block], aBlock );
+        }
+        if( SecureElementAesEncrypt( keystream->Keystream, LORAMAC_CRYPTO_KEYSTREAM_SIZE, curItem->AppSkey, keystream->Keystream ) != SECURE_ELEMENT_SUCCESS )
+        {
+            return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
+        }
+        keystream->KeyID = curItem->AppSkey;
+        keystream->Address = address;
+        keystream->FCnt = fCnt;
+        keystream->IsValid = true;
+    }
+#endif
+    return LORAMAC_CRYPTO_SUCCESS;
+}
+
+LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcRootKey( KeyIdentifier_t keyID )
+{
+    uint8_t compBase[16];
+    SecureElementKeyDerivation_t derivation;
+    LoRaMacCryptoStatus_t retval = PrepareMcRootKeyDerivation( keyID, compBase, &derivation );
+
+    if( retval != LORAMAC_CRYPTO_SUCCESS )
+    {
+        return retval;
     }
-    if( SecureElementDeriveAndStoreKey( CryptoCtx.NvmCtx->LrWanVersion, compBase, keyID, MC_ROOT_KEY ) != SECURE_ELEMENT_SUCCESS )
+    if( SecureElementDeriveAndStoreKeys( CryptoCtx.NvmCtx->LrWanVersion, &derivation, 1 ) != SECURE_ELEMENT_SUCCESS )
     {
         return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
     }
@@ -1629,14 +1936,15 @@ LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcRootKey( KeyIdentifier_t keyID )
 
 LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcKEKey( KeyIdentifier_t keyID )
 {
-    // Prevent other keys than McRootKey
-    if( keyID != MC_ROOT_KEY )
+    uint8_t compBase[16];
+    SecureElementKeyDerivation_t derivation;
+    LoRaMacCryptoStatus_t retval = PrepareMcKEKeyDerivation( keyID, compBase, &derivation );
+
+    if( retval != LORAMAC_CRYPTO_SUCCESS )
     {
-        return LORAMAC_CRYPTO_ERROR_INVALID_KEY_ID;
+        return retval;
     }
-    uint8_t compBase[16] = { 0 };
-
-    if( SecureElementDeriveAndStoreKey( CryptoCtx.NvmCtx->LrWanVersion, compBase, keyID, MC_KE_KEY ) != SECURE_ELEMENT_SUCCESS )
+    if( SecureElementDeriveAndStoreKeys( CryptoCtx.NvmCtx->LrWanVersion, &derivation, 1 ) != SECURE_ELEMENT_SUCCESS )
     {
         return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
     }
@@ -1646,48 +1954,97 @@ LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcKEKey( KeyIdentifier_t keyID )
 
 LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcSessionKeyPair( AddressIdentifier_t addrID, uint32_t mcAddr )
 {
-    if( mcAddr == 0 )
+    LoRaMacCryptoMcGroupKeys_t group =
     {
-        return LORAMAC_CRYPTO_ERROR_NPE;
-    }
+        .AddrID = addrID,
+        .McAddr = mcAddr,
+        .McKeyE = NULL
+    };
 
-    LoRaMacCryptoStatus_t retval = LORAMAC_CRYPTO_ERROR;
+    return LoRaMacCryptoDeriveMcSessionKeyPairs( &group, 1 );
+}
 
-    // Determine current security context
-    KeyAddr_t* curItem;
-    retval = GetKeyAddrItem( addrID, &curItem );
-    if( retval != LORAMAC_CRYPTO_SUCCESS )
+LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcSessionKeyPairs( LoRaMacCryptoMcGroupKeys_t* groups, uint8_t nbGroups )
+{
+    // One McKey and two session keys per group
+    SecureElementKeyDerivation_t derivations[( NUM_OF_SEC_CTX - 1 ) * 3];
+    uint8_t compBases[NUM_OF_SEC_CTX - 1][2][16];
+    uint8_t nbDerivations = 0;
+
+    if( groups == NULL )
     {
-        return retval;
+        return LORAMAC_CRYPTO_ERROR_NPE;
+    }
+    if( nbGroups > ( NUM_OF_SEC_CTX - 1 ) )
+    {
+        return LORAMAC_CRYPTO_ERROR_BUF_SIZE;
     }
 
-    //McAppSKey = aes128_encrypt(McKey, 0x01 | McAddr | pad16)
-    //McNwkSKey = aes128_encrypt(McKey, 0x02 | McAddr | pad16)
+    memset1( ( uint8_t* )compBases, 0, sizeof( compBases ) );
 
-    uint8_t compBaseAppS[16] = { 0 };
-    uint8_t compBaseNwkS[16] = { 0 };
+    for( uint8_t i = 0; i < nbGroups; i++ )
+    {
+        uint32_t mcAddr = groups[i].McAddr;
+        KeyAddr_t* curItem;
 
-    compBaseAppS[0] = 0x01;
-    compBaseAppS[1] = mcAddr & 0xFF;
-    compBaseAppS[2] = ( mcAddr >> 8 ) & 0xFF;
-    compBaseAppS[3] = ( mcAddr >> 16 ) & 0xFF;
-    compBaseAppS[4] = ( mcAddr >> 24 ) & 0xFF;
+        if( mcAddr == 0 )
+        {
+            return LORAMAC_CRYPTO_ERROR_NPE;
+        }
 
-    compBaseNwkS[0] = 0x02;
-    compBaseNwkS[1] = mcAddr & 0xFF;
-    compBaseNwkS[2] = ( mcAddr >> 8 ) & 0xFF;
-    compBaseNwkS[3] = ( mcAddr >> 16 ) & 0xFF;
-    compBaseNwkS[4] = ( mcAddr >> 24 ) & 0xFF;
+        // Determine current security context
+        LoRaMacCryptoStatus_t retval = GetKeyAddrItem( groups[i].AddrID, &curItem );
+        if( retval != LORAMAC_CRYPTO_SUCCESS )
+        {
+            return retval;
+        }
+        if( curItem->RootKey == NO_KEY )
+        {
+            return LORAMAC_CRYPTO_ERROR_INVALID_ADDR_ID;
+        }
 
-    if( SecureElementDeriveAndStoreKey( CryptoCtx.NvmCtx->LrWanVersion, compBaseAppS, curItem->RootKey, curItem->AppSkey ) != SECURE_ELEMENT_SUCCESS )
-    {
-        return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
+        if( groups[i].McKeyE != NULL )
+        {
+            //McKey = aes128_encrypt(McKEKey, McKey_encrypted)
+            derivations[nbDerivations].Input = groups[i].McKeyE;
+            derivations[nbDerivations].RootKeyID = MC_KE_KEY;
+            derivations[nbDerivations].TargetKeyID = curItem->RootKey;
+            nbDerivations++;
+        }
+
+        //McAppSKey = aes128_encrypt(McKey, 0x01 | McAddr | pad16)
+        //McNwkSKey = aes128_encrypt(McKey, 0x02 | McAddr | pad16)
+        for( uint8_t j = 0; j < 2; j++ )
+        {
+            compBases[i][j][0] = j + 1;
+            compBases[i][j][1] = mcAddr & 0xFF;
+            compBases[i][j][2] = ( mcAddr >> 8 ) & 0xFF;
+            compBases[i][j][3] = ( mcAddr >> 16 ) & 0xFF;
+            compBases[i][j][4] = ( mcAddr >> 24 ) & 0xFF;
+
+            derivations[nbDerivations].Input = compBases[i][j];
+            derivations[nbDerivations].RootKeyID = curItem->RootKey;
+            derivations[nbDerivations].TargetKeyID = ( j == 0 ) ? curItem->AppSkey : curItem->NwkSkey;
+            nbDerivations++;
+        }
     }
 
-    if( SecureElementDeriveAndStoreKey( CryptoCtx.NvmCtx->LrWanVersion, compBaseNwkS, curItem->RootKey, curItem->NwkSkey ) != SECURE_ELEMENT_SUCCESS )
+    if( SecureElementDeriveAndStoreKeys( CryptoCtx.NvmCtx->LrWanVersion, derivations, nbDerivations ) != SECURE_ELEMENT_SUCCESS )
     {
         return LORAMAC_CRYPTO_ERROR_SECURE_ELEMENT_FUNC;
     }
 
     return LORAMAC_CRYPTO_SUCCESS;
 }
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t LoRaMacCryptoGetInstanceSize( void )
+{
+    return sizeof( LoRaMacCryptoInstance_t );
+}
+
+void LoRaMacCryptoSelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( LoRaMacCryptoInstance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -149,6 +149,25 @@ typedef enum eLoRaMacCryptoStatus
  */
 typedef void ( *LoRaMacCryptoNvmEvent )( void );
 
+/*!
+ * Multicast group keys to be set up by LoRaMacCryptoDeriveMcSessionKeyPairs
+ */
+typedef struct sLoRaMacCryptoMcGroupKeys
+{
+    /*!
+     * Address identifier of the multicast group
+     */
+    AddressIdentifier_t AddrID;
+    /*!
+     * Multicast group address
+     */
+    uint32_t McAddr;
+    /*!
+     * Encrypted McKey ( 16 byte ), NULL if the McKey is already set
+     */
+    uint8_t* McKeyE;
+}LoRaMacCryptoMcGroupKeys_t;
+
 /*!
  * Initialization of LoRaMac Crypto module
  * It sets initial values of volatile variables and assigns the non-volatile context.
@@ -173,11 +192,27 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSetLrWanVersion( Version_t version );
 /*!
  * Restores the internal nvm context from passed pointer.
  *
+ * \remark The uplink and multicast downlink frame counter changes are only
+ *         notified once every LORAMAC_CRYPTO_FCNT_RESERVED_WINDOW frames, these
+ *         frame counters of a restored context skip ahead to the values
+ *         reserved in it. The unicast downlink frame counters are restored
+ *         as stored.
+ *
  * \param[IN]     cryptoNmvCtx     - Pointer to non-volatile crypto module context to be restored.
  * \retval                         - Status of the operation
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoRestoreNvmCtx( void* cryptoNvmCtx );
 
+/*!
+ * Restores the session of a context saved earlier, while the current one
+ * keeps running. The join nonces never move backwards, so that the join
+ * requests sent since the context was saved are not replayed.
+ *
+ * \param[IN]     cryptoNmvCtx     - Pointer to non-volatile crypto module context to be restored.
+ * \retval                         - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoRestoreSessionNvmCtx( void* cryptoNvmCtx );
+
 /*!
  * Returns a pointer to the internal non-volatile context.
  *
@@ -284,6 +319,19 @@ LoRaMacCryptoStatus_t LoRaMacCryptoSecureMessage( uint32_t fCntUp, uint8_t txDr,
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoUnsecureMessage( AddressIdentifier_t addrID, uint32_t address, FCntIdentifier_t fCntID, uint32_t fCntDown, LoRaMacMessageData_t* macMsg );
 
+/*!
+ * Precomputes the payload key streams of the next expected unicast downlink
+ * frame counters, so that LoRaMacCryptoUnsecureMessage only has to XOR the
+ * payload. Prepared key streams are kept until they are used or the keys or
+ * counters are reset.
+ *
+ * Does nothing unless LORAMAC_CRYPTO_KEYSTREAM_PRECOMPUTE is defined.
+ *
+ * \param[IN]     address         - Device address
+ * \retval                        - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoPrepareDownlinkKeystreams( uint32_t address );
+
 /*!
  * Derives the McRootKey from the GenAppKey or AppKey.
  *
@@ -320,6 +368,37 @@ LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcKEKey( KeyIdentifier_t keyID );
  */
 LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcSessionKeyPair( AddressIdentifier_t addrID, uint32_t mcAddr );
 
+/*!
+ * Sets the McKeys and derives the key pairs ( McAppSKey, McNwkSKey ) of
+ * several multicast groups in a single secure element batch. The McKEKey
+ * schedule is expanded once for all the groups.
+ *
+ * McKey     = aes128_encrypt(McKEKey, McKey_encrypted)
+ * McAppSKey = aes128_encrypt(McKey, 0x01 | McAddr | pad16)
+ * McNwkSKey = aes128_encrypt(McKey, 0x02 | McAddr | pad16)
+ *
+ * \param[IN]     groups          - Multicast groups
+ * \param[IN]     nbGroups        - Number of multicast groups
+ * \retval                        - Status of the operation
+ */
+LoRaMacCryptoStatus_t LoRaMacCryptoDeriveMcSessionKeyPairs( LoRaMacCryptoMcGroupKeys_t* groups, uint8_t nbGroups );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t LoRaMacCryptoGetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void LoRaMacCryptoSelectInstance( void* instance );
+#endif
+
 /*! \} addtogroup LORAMAC */
 
 #ifdef __cplusplus
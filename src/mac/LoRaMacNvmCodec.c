@@ -0,0 +1,409 @@
+/*!
+ * \file      LoRaMacNvmCodec.c
+ *
+ * \brief     LoRa MAC NVM contexts compact format
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ *               ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ *              / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ *              \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ *              |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ *              embedded.connectivity.solutions===============
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \author    Gregory Cristian ( Semtech )
+ *
+ * \author    Daniel Jaeckle ( STACKFORCE )
+ *
+ * \author    Johannes Bruder ( STACKFORCE )
+ */
+
+#include <stdbool.h>
+
+#include "utilities.h"
+#include "LoRaMac.h"
+#include "LoRaMacNvmCodec.h"
+
+/*!
+ * Run header flag of the empty channels
+ */
+#define NVM_CODEC_RUN_EMPTY                         0x80
+
+/*!
+ * Maximum number of channels of a run
+ */
+#define NVM_CODEC_RUN_MAX_LENGTH                    128
+
+/*!
+ * Bytes sequence being written or read
+ */
+typedef struct sNvmCodecStream
+{
+    /*!
+     * Buffer
+     */
+    uint8_t* Buffer;
+    /*!
+     * Size of the buffer
+     */
+    size_t Size;
+    /*!
+     * Position of the next byte
+     */
+    size_t Index;
+    /*!
+     * Set once an access exceeded the buffer
+     */
+    bool Error;
+}NvmCodecStream_t;
+
+static void PutByte( NvmCodecStream_t* stream, uint8_t value )
+{
+    if( stream->Index >= stream->Size )
+    {
+        stream->Error = true;
+        return;
+    }
+    stream->Buffer[stream->Index++] = value;
+}
+
+static uint8_t GetByte( NvmCodecStream_t* stream )
+{
+    if( stream->Index >= stream->Size )
+    {
+        stream->Error = true;
+        return 0;
+    }
+    return stream->Buffer[stream->Index++];
+}
+
+/*!
+ * \brief Writes a variable length integer, 7 bits per byte, least
+ *        significant bits first
+ */
+static void PutVarint( NvmCodecStream_t* stream, uint32_t value )
+{
+    while( value >= 0x80 )
+    {
+        PutByte( stream, ( uint8_t )( value | 0x80 ) );
+        value >>= 7;
+    }
+    PutByte( stream, ( uint8_t )value );
+}
+
+static uint32_t GetVarint( NvmCodecStream_t* stream )
+{
+    uint32_t value = 0;
+
+    for( uint8_t shift = 0; shift < 35; shift += 7 )
+    {
+        uint8_t byte = GetByte( stream );
+
+        value |= ( uint32_t )( byte & 0x7F ) << shift;
+        if( ( byte & 0x80 ) == 0 )
+        {
+            return value;
+        }
+    }
+    stream->Error = true;
+    return 0;
+}
+
+/*!
+ * \brief Writes a signed difference, the small magnitudes of both signs are
+ *        kept short
+ */
+static void PutDelta( NvmCodecStream_t* stream, uint32_t delta )
+{
+    PutVarint( stream, ( ( int32_t )delta < 0 ) ? ~( delta << 1 ) : ( delta << 1 ) );
+}
+
+static uint32_t GetDelta( NvmCodecStream_t* stream )
+{
+    uint32_t value = GetVarint( stream );
+
+    return ( ( value & 0x01 ) != 0 ) ? ~( value >> 1 ) : ( value >> 1 );
+}
+
+/*!
+ * \brief Writes the non zero bytes of each group of 8 bytes behind a mask of
+ *        the non zero bytes
+ */
+static void PutSparse( NvmCodecStream_t* stream, uint8_t* data, size_t size )
+{
+    for( size_t i = 0; i < size; i += 8 )
+    {
+        size_t n = MIN( size - i, 8 );
+        uint8_t mask = 0;
+
+        for( size_t j = 0; j < n; j++ )
+        {
+            if( data[i + j] != 0 )
+            {
+                mask |= 1 << j;
+            }
+        }
+        PutByte( stream, mask );
+        for( size_t j = 0; j < n; j++ )
+        {
+            if( data[i + j] != 0 )
+            {
+                PutByte( stream, data[i + j] );
+            }
+        }
+    }
+}
+
+static void GetSparse( NvmCodecStream_t* stream, uint8_t* data, size_t size )
+{
+    for( size_t i = 0; i < size; i += 8 )
+    {
+        size_t n = MIN( size - i, 8 );
+        uint8_t mask = GetByte( stream );
+
+        for( size_t j = 0; j < n; j++ )
+        {
+            data[i + j] = ( ( mask & ( 1 << j ) ) != 0 ) ? GetByte( stream ) : 0;
+        }
+    }
+}
+
+static void GetChannel( uint8_t* ctx, uint8_t index, ChannelParams_t* channel )
+{
+    // The context may not be aligned
+    memcpy1( ( uint8_t* )channel, ctx + index * sizeof( ChannelParams_t ), sizeof( ChannelParams_t ) );
+}
+
+static bool IsChannelEmpty( ChannelParams_t* channel )
+{
+    return ( channel->Frequency == 0 ) && ( channel->Rx1Frequency == 0 ) &&
+           ( channel->DrRange.Value == 0 ) && ( channel->Band == 0 );
+}
+
+static bool IsChannelRunMember( ChannelParams_t* first, ChannelParams_t* channel )
+{
+    return ( IsChannelEmpty( channel ) == false ) && ( channel->Rx1Frequency == first->Rx1Frequency ) &&
+           ( channel->DrRange.Value == first->DrRange.Value ) && ( channel->Band == first->Band );
+}
+
+static void PutChannels( NvmCodecStream_t* stream, uint8_t* ctx, uint8_t nbChannels )
+{
+    ChannelParams_t first;
+    ChannelParams_t channel;
+    uint32_t frequency = 0;
+    uint8_t i = 0;
+
+    while( i < nbChannels )
+    {
+        uint8_t n = 1;
+
+        GetChannel( ctx, i, &first );
+        if( IsChannelEmpty( &first ) == true )
+        {
+            for( ; ( ( i + n ) < nbChannels ) && ( n < NVM_CODEC_RUN_MAX_LENGTH ); n++ )
+            {
+                GetChannel( ctx, i + n, &channel );
+                if( IsChannelEmpty( &channel ) == false )
+                {
+                    break;
+                }
+            }
+            PutByte( stream, NVM_CODEC_RUN_EMPTY | ( n - 1 ) );
+            i += n;
+            continue;
+        }
+
+        // Channels with the same parameters and evenly spaced frequencies
+        uint32_t step = 0;
+        uint32_t last = first.Frequency;
+        for( ; ( ( i + n ) < nbChannels ) && ( n < NVM_CODEC_RUN_MAX_LENGTH ); n++ )
+        {
+            GetChannel( ctx, i + n, &channel );
+            if( ( IsChannelRunMember( &first, &channel ) == false ) ||
+                ( ( n > 1 ) && ( ( channel.Frequency - last ) != step ) ) )
+            {
+                break;
+            }
+            step = channel.Frequency - last;
+            last = channel.Frequency;
+        }
+
+        PutByte( stream, n - 1 );
+        PutDelta( stream, first.Frequency - frequency );
+        if( n > 1 )
+        {
+            PutDelta( stream, step );
+        }
+        PutVarint( stream, first.Rx1Frequency );
+        PutByte( stream, first.DrRange.Value );
+        PutByte( stream, first.Band );
+        frequency = last;
+        i += n;
+    }
+}
+
+static void GetChannels( NvmCodecStream_t* stream, uint8_t* ctx, uint8_t nbChannels )
+{
+    ChannelParams_t channel;
+    uint32_t frequency = 0;
+    uint8_t i = 0;
+
+    while( ( i < nbChannels ) && ( stream->Error == false ) )
+    {
+        uint8_t header = GetByte( stream );
+        uint8_t n = ( header & ~NVM_CODEC_RUN_EMPTY ) + 1;
+        uint32_t step = 0;
+
+        if( n > ( nbChannels - i ) )
+        {
+            stream->Error = true;
+            return;
+        }
+
+        memset1( ( uint8_t* )&channel, 0, sizeof( ChannelParams_t ) );
+        if( ( header & NVM_CODEC_RUN_EMPTY ) == 0 )
+        {
+            channel.Frequency = frequency + GetDelta( stream );
+            if( n > 1 )
+            {
+                step = GetDelta( stream );
+            }
+            channel.Rx1Frequency = GetVarint( stream );
+            channel.DrRange.Value = GetByte( stream );
+            channel.Band = GetByte( stream );
+        }
+
+        for( uint8_t j = 0; j < n; j++ )
+        {
+            memcpy1( ctx + ( i + j ) * sizeof( ChannelParams_t ), ( uint8_t* )&channel, sizeof( ChannelParams_t ) );
+            if( ( header & NVM_CODEC_RUN_EMPTY ) == 0 )
+            {
+                // The next run starts from the last frequency of this one
+                frequency = channel.Frequency;
+                channel.Frequency += step;
+            }
+        }
+        i += n;
+    }
+}
+
+static void PutBands( NvmCodecStream_t* stream, uint8_t* ctx, uint8_t nbBands )
+{
+    Band_t band;
+
+    for( uint8_t i = 0; i < nbBands; i++ )
+    {
+        memcpy1( ( uint8_t* )&band, ctx + i * sizeof( Band_t ), sizeof( Band_t ) );
+        PutVarint( stream, band.DCycle );
+        PutByte( stream, ( uint8_t )band.TxMaxPower );
+        PutVarint( stream, band.LastJoinTxDoneTime );
+        PutVarint( stream, band.LastTxDoneTime );
+        PutVarint( stream, band.TimeOff );
+    }
+}
+
+static void GetBands( NvmCodecStream_t* stream, uint8_t* ctx, uint8_t nbBands )
+{
+    Band_t band;
+
+    memset1( ( uint8_t* )&band, 0, sizeof( Band_t ) );
+    for( uint8_t i = 0; i < nbBands; i++ )
+    {
+        band.DCycle = GetVarint( stream );
+        band.TxMaxPower = ( int8_t )GetByte( stream );
+        band.LastJoinTxDoneTime = GetVarint( stream );
+        band.LastTxDoneTime = GetVarint( stream );
+        band.TimeOff = GetVarint( stream );
+        memcpy1( ctx + i * sizeof( Band_t ), ( uint8_t* )&band, sizeof( Band_t ) );
+    }
+}
+
+size_t LoRaMacNvmCodecPack( uint8_t* ctx, size_t ctxSize, uint8_t nbChannels, uint8_t nbBands, uint8_t* buffer, size_t size )
+{
+    size_t bandsOffset = nbChannels * sizeof( ChannelParams_t );
+    size_t othersOffset = bandsOffset + nbBands * sizeof( Band_t );
+    NvmCodecStream_t stream;
+
+    if( ( ctx == NULL ) || ( buffer == NULL ) || ( size == 0 ) || ( othersOffset > ctxSize ) )
+    {
+        return 0;
+    }
+
+    // The compact format is only kept if it is smaller
+    stream.Buffer = buffer + 1;
+    stream.Size = MIN( size - 1, ctxSize );
+    stream.Index = 0;
+    stream.Error = false;
+
+    PutChannels( &stream, ctx, nbChannels );
+    PutBands( &stream, ctx + bandsOffset, nbBands );
+    PutSparse( &stream, ctx + othersOffset, ctxSize - othersOffset );
+
+    if( ( stream.Error == false ) && ( stream.Index < ctxSize ) )
+    {
+        buffer[0] = LORAMAC_NVM_CODEC_FORMAT_COMPACT;
+        return stream.Index + 1;
+    }
+
+    if( size < LORAMAC_NVM_CODEC_MAX_SIZE( ctxSize ) )
+    {
+        return 0;
+    }
+    buffer[0] = LORAMAC_NVM_CODEC_FORMAT_RAW;
+    memcpy1( buffer + 1, ctx, ctxSize );
+    return LORAMAC_NVM_CODEC_MAX_SIZE( ctxSize );
+}
+
+size_t LoRaMacNvmCodecUnpack( uint8_t* buffer, size_t size, uint8_t* ctx, size_t ctxSize, uint8_t nbChannels, uint8_t nbBands )
+{
+    size_t bandsOffset = nbChannels * sizeof( ChannelParams_t );
+    size_t othersOffset = bandsOffset + nbBands * sizeof( Band_t );
+    NvmCodecStream_t stream;
+
+    if( ( ctx == NULL ) || ( buffer == NULL ) || ( size == 0 ) || ( othersOffset > ctxSize ) )
+    {
+        return 0;
+    }
+
+    if( buffer[0] == LORAMAC_NVM_CODEC_FORMAT_RAW )
+    {
+        if( size < LORAMAC_NVM_CODEC_MAX_SIZE( ctxSize ) )
+        {
+            return 0;
+        }
+        memcpy1( ctx, buffer + 1, ctxSize );
+        return LORAMAC_NVM_CODEC_MAX_SIZE( ctxSize );
+    }
+    if( buffer[0] != LORAMAC_NVM_CODEC_FORMAT_COMPACT )
+    {
+        return 0;
+    }
+
+    stream.Buffer = buffer + 1;
+    stream.Size = size - 1;
+    stream.Index = 0;
+    stream.Error = false;
+
+    GetChannels( &stream, ctx, nbChannels );
+    GetBands( &stream, ctx + bandsOffset, nbBands );
+    GetSparse( &stream, ctx + othersOffset, ctxSize - othersOffset );
+
+    if( stream.Error == true )
+    {
+        return 0;
+    }
+    return stream.Index + 1;
+}
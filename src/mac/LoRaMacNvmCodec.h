@@ -0,0 +1,108 @@
+/*!
+ * \file      LoRaMacNvmCodec.h
+ *
+ * \brief     LoRa MAC NVM contexts compact format
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ *               ___ _____ _   ___ _  _____ ___  ___  ___ ___
+ *              / __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+ *              \__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+ *              |___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+ *              embedded.connectivity.solutions===============
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \author    Gregory Cristian ( Semtech )
+ *
+ * \author    Daniel Jaeckle ( STACKFORCE )
+ *
+ * \author    Johannes Bruder ( STACKFORCE )
+ *
+ * \defgroup  LORAMACNVMCODEC LoRa MAC NVM contexts compact format
+ *            Serialization of the NVM contexts with less persisted bytes.
+ * \{
+ */
+#ifndef __LORAMAC_NVM_CODEC_H__
+#define __LORAMAC_NVM_CODEC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*!
+ * Serialized context stored as is
+ */
+#define LORAMAC_NVM_CODEC_FORMAT_RAW                0x00
+
+/*!
+ * Serialized context in the compact format
+ */
+#define LORAMAC_NVM_CODEC_FORMAT_COMPACT            0x01
+
+/*!
+ * Maximum size of a serialized context
+ */
+#define LORAMAC_NVM_CODEC_MAX_SIZE( ctxSize )       ( ( ctxSize ) + 1 )
+
+/*!
+ * \brief Serializes a NVM context
+ *
+ * \details The context starts with nbChannels \ref ChannelParams_t followed by
+ *          nbBands \ref Band_t, as the region contexts. The channels are
+ *          stored as runs of channels with evenly spaced frequencies, the empty
+ *          channels as runs of their count only. The frequencies are delta
+ *          encoded, the bands and the run parameters are stored as variable
+ *          length integers. The rest of the context keeps its non zero bytes
+ *          behind a bit mask. The context is stored as is when the compact
+ *          format is not smaller.
+ *
+ * \param [IN]  ctx        Context
+ * \param [IN]  ctxSize    Size of the context
+ * \param [IN]  nbChannels Number of channels at the start of the context
+ * \param [IN]  nbBands    Number of bands following the channels
+ * \param [OUT] buffer     Serialized context
+ * \param [IN]  size       Size of the buffer, \ref LORAMAC_NVM_CODEC_MAX_SIZE
+ *                         bytes are always sufficient
+ *
+ * \retval                 Size of the serialized context, 0 if it doesn't fit
+ */
+size_t LoRaMacNvmCodecPack( uint8_t* ctx, size_t ctxSize, uint8_t nbChannels, uint8_t nbBands, uint8_t* buffer, size_t size );
+
+/*!
+ * \brief Restores a NVM context serialized by \ref LoRaMacNvmCodecPack
+ *
+ * \param [IN]  buffer     Serialized context
+ * \param [IN]  size       Size of the buffer, may exceed the serialized context
+ * \param [OUT] ctx        Context
+ * \param [IN]  ctxSize    Size of the context
+ * \param [IN]  nbChannels Number of channels at the start of the context
+ * \param [IN]  nbBands    Number of bands following the channels
+ *
+ * \retval                 Size of the serialized context, 0 if the buffer
+ *                         doesn't hold a valid context
+ */
+size_t LoRaMacNvmCodecUnpack( uint8_t* buffer, size_t size, uint8_t* ctx, size_t ctxSize, uint8_t nbChannels, uint8_t nbBands );
+
+/*! \} defgroup LORAMACNVMCODEC */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LORAMAC_NVM_CODEC_H__
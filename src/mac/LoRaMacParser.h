@@ -42,9 +42,16 @@ extern "C"
 {
 #endif
 
+#include <stdbool.h>
 #include <stdint.h>
 #include "LoRaMacMessageTypes.h"
 
+/*!
+ * Offset of the FOpts field in a data message
+ */
+#define LORAMAC_PARSER_F_OPTS_OFFSET        ( LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE + \
+                                              LORAMAC_FHDR_F_CTRL_FIELD_SIZE + LORAMAC_FHDR_F_CNT_FIELD_SIZE )
+
 /*!
  * LoRaMac Parser Status
  */
@@ -68,6 +75,90 @@ typedef enum eLoRaMacParserStatus
     LORAMAC_PARSER_ERROR,
 }LoRaMacParserStatus_t;
 
+/*!
+ * View of a serialized data message. The fields are read in place from the
+ * message buffer through the LoRaMacParserView accessors, nothing is copied.
+ */
+typedef struct sLoRaMacParserDataView
+{
+    /*!
+     * Serialized message buffer
+     */
+    uint8_t* Buffer;
+    /*!
+     * Size of the serialized message
+     */
+    uint8_t BufSize;
+    /*!
+     * Size of the FOpts field
+     */
+    uint8_t FOptsLen;
+    /*!
+     * Size of the frame payload, 0 if the FPort field is not present
+     */
+    uint8_t FRMPayloadSize;
+    /*!
+     * Set if the FPort field is present
+     */
+    bool HasFPort;
+}LoRaMacParserDataView_t;
+
+/*!
+ * Resolves the fields of a serialized data message without copying them.
+ *
+ * \param[IN]  buffer          - Serialized data message
+ * \param[IN]  size            - Size of the serialized data message
+ * \param[OUT] view            - Data message view
+ * \retval                     - Status of the operation
+ */
+LoRaMacParserStatus_t LoRaMacParserDataView( uint8_t* buffer, uint8_t size, LoRaMacParserDataView_t* view );
+
+static inline uint8_t LoRaMacParserViewGetMHDR( const LoRaMacParserDataView_t* view )
+{
+    return view->Buffer[0];
+}
+
+static inline uint32_t LoRaMacParserViewGetDevAddr( const LoRaMacParserDataView_t* view )
+{
+    const uint8_t* p = &view->Buffer[LORAMAC_MHDR_FIELD_SIZE];
+
+    return ( uint32_t )p[0] | ( ( uint32_t )p[1] << 8 ) | ( ( uint32_t )p[2] << 16 ) | ( ( uint32_t )p[3] << 24 );
+}
+
+static inline uint8_t LoRaMacParserViewGetFCtrl( const LoRaMacParserDataView_t* view )
+{
+    return view->Buffer[LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE];
+}
+
+static inline uint16_t LoRaMacParserViewGetFCnt( const LoRaMacParserDataView_t* view )
+{
+    const uint8_t* p = &view->Buffer[LORAMAC_MHDR_FIELD_SIZE + LORAMAC_FHDR_DEV_ADD_FIELD_SIZE + LORAMAC_FHDR_F_CTRL_FIELD_SIZE];
+
+    return ( uint16_t )p[0] | ( ( uint16_t )p[1] << 8 );
+}
+
+static inline uint8_t* LoRaMacParserViewGetFOpts( const LoRaMacParserDataView_t* view )
+{
+    return &view->Buffer[LORAMAC_PARSER_F_OPTS_OFFSET];
+}
+
+static inline uint8_t LoRaMacParserViewGetFPort( const LoRaMacParserDataView_t* view )
+{
+    return ( view->HasFPort == true ) ? view->Buffer[LORAMAC_PARSER_F_OPTS_OFFSET + view->FOptsLen] : 0;
+}
+
+static inline uint8_t* LoRaMacParserViewGetFRMPayload( const LoRaMacParserDataView_t* view )
+{
+    return &view->Buffer[LORAMAC_PARSER_F_OPTS_OFFSET + view->FOptsLen + LORAMAC_F_PORT_FIELD_SIZE];
+}
+
+static inline uint32_t LoRaMacParserViewGetMIC( const LoRaMacParserDataView_t* view )
+{
+    const uint8_t* p = &view->Buffer[view->BufSize - LORAMAC_MIC_FIELD_SIZE];
+
+    return ( uint32_t )p[0] | ( ( uint32_t )p[1] << 8 ) | ( ( uint32_t )p[2] << 16 ) | ( ( uint32_t )p[3] << 24 );
+}
+
 
 /*!
  * Parse a serialized join-accept message and fills the structured object.
@@ -80,6 +171,10 @@ LoRaMacParserStatus_t LoRaMacParserJoinAccept( LoRaMacMessageJoinAccept_t *macMs
 /*!
  * Parse a serialized data message and fills the structured object.
  *
+ * \remark When macMsg->FRMPayload is NULL or already points to the frame
+ *         payload location in macMsg->Buffer, it is set to that location and
+ *         the frame payload is not copied.
+ *
  * \param[IN/OUT] macMsg       - Data message object
  * \retval                     - Status of the operation
  */
@@ -169,15 +169,34 @@ LoRaMacSerializerStatus_t LoRaMacSerializerData( LoRaMacMessageData_t* macMsg )
         macMsg->Buffer[bufItr++] = macMsg->FPort;
     }
 
-    memcpy1( &macMsg->Buffer[bufItr], macMsg->FRMPayload, macMsg->FRMPayloadSize );
+    // The payload may already be in place
+    if( macMsg->FRMPayload != &macMsg->Buffer[bufItr] )
+    {
+        memcpy1( &macMsg->Buffer[bufItr], macMsg->FRMPayload, macMsg->FRMPayloadSize );
+    }
     bufItr = bufItr + macMsg->FRMPayloadSize;
 
-    macMsg->Buffer[bufItr++] = macMsg->MIC & 0xFF;
-    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 8 ) & 0xFF;
-    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 16 ) & 0xFF;
-    macMsg->Buffer[bufItr++] = ( macMsg->MIC >> 24 ) & 0xFF;
+    macMsg->BufSize = bufItr + LORAMAC_MIC_FIELD_SIZE;
 
-    macMsg->BufSize = bufItr;
+    return LoRaMacSerializerDataMic( macMsg );
+}
+
+LoRaMacSerializerStatus_t LoRaMacSerializerDataMic( LoRaMacMessageData_t* macMsg )
+{
+    if( ( macMsg == 0 ) || ( macMsg->Buffer == 0 ) )
+    {
+        return LORAMAC_SERIALIZER_ERROR_NPE;
+    }
+
+    if( macMsg->BufSize < LORAMAC_MIC_FIELD_SIZE )
+    {
+        return LORAMAC_SERIALIZER_ERROR_BUF_SIZE;
+    }
+
+    macMsg->Buffer[macMsg->BufSize - 4] = macMsg->MIC & 0xFF;
+    macMsg->Buffer[macMsg->BufSize - 3] = ( macMsg->MIC >> 8 ) & 0xFF;
+    macMsg->Buffer[macMsg->BufSize - 2] = ( macMsg->MIC >> 16 ) & 0xFF;
+    macMsg->Buffer[macMsg->BufSize - 1] = ( macMsg->MIC >> 24 ) & 0xFF;
 
     return LORAMAC_SERIALIZER_SUCCESS;
 }
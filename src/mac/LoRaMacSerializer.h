@@ -100,6 +100,14 @@ LoRaMacSerializerStatus_t LoRaMacSerializerReJoinType0or2( LoRaMacMessageReJoinT
  */
 LoRaMacSerializerStatus_t LoRaMacSerializerData( LoRaMacMessageData_t* macMsg );
 
+/*!
+ * Patches the MIC of a data message serialized by LoRaMacSerializerData.
+ *
+ * \param[IN/OUT] macMsg        - Data message object
+ * \retval                      - Status of the operation
+ */
+LoRaMacSerializerStatus_t LoRaMacSerializerDataMic( LoRaMacMessageData_t* macMsg );
+
 /*! \} addtogroup LORAMAC */
 
 #ifdef __cplusplus
@@ -0,0 +1,239 @@
+/*!
+ * \file      LoRaMacTxQueue.c
+ *
+ * \brief     LoRa MAC transmit queue implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "utilities.h"
+#include "LoRaMac.h"
+#include "LoRaMacTxQueue.h"
+
+/*
+ * LoRaMac transmit queue element
+ */
+typedef struct sLoRaMacTxQueueElement
+{
+    /*!
+     * Copy of the MCPS-Request. Its payload pointer is the Payload buffer.
+     */
+    McpsReq_t Request;
+    /*!
+     * Request priority
+     */
+    uint8_t Priority;
+    /*!
+     * Set to true, if the element holds a request
+     */
+    bool InUse;
+    /*!
+     * Order in which the request was added
+     */
+    uint32_t Sequence;
+    /*!
+     * Copy of the request payload
+     */
+    uint8_t Payload[LORAMAC_TX_QUEUE_MAX_PAYLOAD];
+}LoRaMacTxQueueElement_t;
+
+/*
+ * LoRaMac transmit queue context structure
+ */
+typedef struct sLoRaMacTxQueueCtx
+{
+    /*!
+     * Queue elements
+     */
+    LoRaMacTxQueueElement_t Elements[LORAMAC_TX_QUEUE_LEN];
+    /*!
+     * Number of queued requests
+     */
+    uint8_t Cnt;
+    /*!
+     * Sequence number of the next request added
+     */
+    uint32_t NextSequence;
+}LoRaMacTxQueueCtx_t;
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sLoRaMacTxQueueInstance
+{
+    /*!
+     * Module context
+     */
+    LoRaMacTxQueueCtx_t TxQueueCtx;
+}LoRaMacTxQueueInstance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static LoRaMacTxQueueInstance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static LoRaMacTxQueueInstance_t* SelectedInstance = &DefaultInstance;
+
+#define TxQueueCtx                                  ( SelectedInstance->TxQueueCtx )
+#else
+/*
+ * Module context.
+ */
+static LoRaMacTxQueueCtx_t TxQueueCtx;
+#endif
+
+/*!
+ * \brief Returns the payload fields of the request
+ *
+ * \param [IN] mcpsRequest MCPS-Request
+ * \param [OUT] fBuffer Pointer to the request payload pointer
+ * \retval Pointer to the request payload size, NULL for an unknown type
+ */
+static uint16_t* GetPayloadFields( McpsReq_t* mcpsRequest, void*** fBuffer )
+{
+    switch( mcpsRequest->Type )
+    {
+        case MCPS_UNCONFIRMED:
+            *fBuffer = &mcpsRequest->Req.Unconfirmed.fBuffer;
+            return &mcpsRequest->Req.Unconfirmed.fBufferSize;
+        case MCPS_CONFIRMED:
+            *fBuffer = &mcpsRequest->Req.Confirmed.fBuffer;
+            return &mcpsRequest->Req.Confirmed.fBufferSize;
+        case MCPS_PROPRIETARY:
+            *fBuffer = &mcpsRequest->Req.Proprietary.fBuffer;
+            return &mcpsRequest->Req.Proprietary.fBufferSize;
+        default:
+            return NULL;
+    }
+}
+
+void LoRaMacTxQueueInit( void )
+{
+    memset1( ( uint8_t* )&TxQueueCtx, 0, sizeof( TxQueueCtx ) );
+}
+
+bool LoRaMacTxQueueAdd( McpsReq_t* mcpsRequest, uint8_t priority )
+{
+    LoRaMacTxQueueElement_t* element = NULL;
+    void** fBuffer;
+    uint16_t* fBufferSize;
+
+    if( ( mcpsRequest == NULL ) || ( TxQueueCtx.Cnt >= LORAMAC_TX_QUEUE_LEN ) )
+    {
+        return false;
+    }
+
+    for( uint8_t i = 0; i < LORAMAC_TX_QUEUE_LEN; i++ )
+    {
+        if( TxQueueCtx.Elements[i].InUse == false )
+        {
+            element = &TxQueueCtx.Elements[i];
+            break;
+        }
+    }
+
+    element->Request = *mcpsRequest;
+    fBufferSize = GetPayloadFields( &element->Request, &fBuffer );
+    if( ( fBufferSize == NULL ) || ( *fBufferSize > LORAMAC_TX_QUEUE_MAX_PAYLOAD ) )
+    {
+        return false;
+    }
+    if( *fBufferSize > 0 )
+    {
+        memcpy1( element->Payload, *fBuffer, *fBufferSize );
+    }
+    *fBuffer = element->Payload;
+
+    element->Priority = priority;
+    element->Sequence = TxQueueCtx.NextSequence++;
+    element->InUse = true;
+    TxQueueCtx.Cnt++;
+    return true;
+}
+
+/*!
+ * \brief Returns the next element to send
+ *
+ * \retval Pointer to the element, NULL if the queue is empty
+ */
+static LoRaMacTxQueueElement_t* GetNextElement( void )
+{
+    LoRaMacTxQueueElement_t* next = NULL;
+
+    for( uint8_t i = 0; i < LORAMAC_TX_QUEUE_LEN; i++ )
+    {
+        LoRaMacTxQueueElement_t* element = &TxQueueCtx.Elements[i];
+
+        if( element->InUse == false )
+        {
+            continue;
+        }
+        // Highest priority first, then the oldest one
+        if( ( next == NULL ) || ( element->Priority > next->Priority ) ||
+            ( ( element->Priority == next->Priority ) &&
+              ( ( int32_t )( element->Sequence - next->Sequence ) < 0 ) ) )
+        {
+            next = element;
+        }
+    }
+
+    return next;
+}
+
+bool LoRaMacTxQueuePeek( McpsReq_t* mcpsRequest )
+{
+    LoRaMacTxQueueElement_t* next = GetNextElement( );
+
+    if( ( mcpsRequest == NULL ) || ( next == NULL ) )
+    {
+        return false;
+    }
+    *mcpsRequest = next->Request;
+    return true;
+}
+
+void LoRaMacTxQueueRemoveNext( void )
+{
+    LoRaMacTxQueueElement_t* next = GetNextElement( );
+
+    if( next != NULL )
+    {
+        next->InUse = false;
+        TxQueueCtx.Cnt--;
+    }
+}
+
+uint8_t LoRaMacTxQueueGetCnt( void )
+{
+    return TxQueueCtx.Cnt;
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t LoRaMacTxQueueGetInstanceSize( void )
+{
+    return sizeof( LoRaMacTxQueueInstance_t );
+}
+
+void LoRaMacTxQueueSelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( LoRaMacTxQueueInstance_t* )instance : &DefaultInstance;
+}
+#endif
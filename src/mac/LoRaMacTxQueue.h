@@ -0,0 +1,113 @@
+/*!
+ * \file      LoRaMacTxQueue.h
+ *
+ * \brief     LoRa MAC transmit queue implementation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+/*!
+ * \addtogroup LORAMAC
+ * \{
+ *
+ */
+#ifndef __LORAMAC_TXQUEUE_H__
+#define __LORAMAC_TXQUEUE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "LoRaMac.h"
+
+/*!
+ * LoRaMac MCPS-Request transmit queue length
+ */
+#ifndef LORAMAC_TX_QUEUE_LEN
+#define LORAMAC_TX_QUEUE_LEN                        2
+#endif
+
+/*!
+ * Maximum payload size of a queued MCPS-Request
+ */
+#ifndef LORAMAC_TX_QUEUE_MAX_PAYLOAD
+#define LORAMAC_TX_QUEUE_MAX_PAYLOAD                242
+#endif
+
+/*!
+ * \brief   Initializes the transmit queue
+ */
+void LoRaMacTxQueueInit( void );
+
+/*!
+ * \brief   Adds a copy of the MCPS-Request and of its payload to the queue.
+ *
+ * \param   [IN] mcpsRequest - MCPS-Request to add.
+ *
+ * \param   [IN] priority - Requests with higher values are sent first. Requests
+ *                          of the same priority are sent in the order they were
+ *                          added.
+ *
+ * \retval  [true - operation was successful, false - queue full or payload too large]
+ */
+bool LoRaMacTxQueueAdd( McpsReq_t* mcpsRequest, uint8_t priority );
+
+/*!
+ * \brief   Gets the next request to send. The request stays in the queue.
+ *
+ * \param   [OUT] mcpsRequest - Next request to send. Its payload pointer is
+ *                              valid until the request is removed.
+ *
+ * \retval  [true - operation was successful, false - the queue is empty]
+ */
+bool LoRaMacTxQueuePeek( McpsReq_t* mcpsRequest );
+
+/*!
+ * \brief   Removes the next request to send from the queue.
+ */
+void LoRaMacTxQueueRemoveNext( void );
+
+/*!
+ * \brief   Returns the number of queued requests.
+ *
+ * \retval  Number of queued requests
+ */
+uint8_t LoRaMacTxQueueGetCnt( void );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t LoRaMacTxQueueGetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void LoRaMacTxQueueSelectInstance( void* instance );
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LORAMAC_TXQUEUE_H__
+
+/*! \} addtogroup LORAMAC */
@@ -265,6 +265,18 @@ typedef enum eKeyIdentifier
     NO_KEY,
 }KeyIdentifier_t;
 
+/*!
+ * Maximum number of multicast context. The LoRaWAN McGroupID leaves room for
+ * at most 4 groups, fewer groups save the unused contexts.
+ */
+#ifndef LORAMAC_MAX_MC_CTX
+#define LORAMAC_MAX_MC_CTX                          4
+#endif
+
+#if ( LORAMAC_MAX_MC_CTX < 1 ) || ( LORAMAC_MAX_MC_CTX > 4 )
+#error "LORAMAC_MAX_MC_CTX must be in the range 1 to 4"
+#endif
+
 /*!
  * LoRaMac Crypto address identifier
  */
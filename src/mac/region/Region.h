@@ -68,6 +68,21 @@ extern "C"
  */
 #define LC( channelIndex )                          ( uint16_t )( 1 << ( channelIndex - 1 ) )
 
+/*!
+ * Invalid channel id
+ */
+#define REGION_CHANNEL_NONE                         0xFF
+
+/*!
+ * Maximum number of bands of a region
+ */
+#define REGION_MAX_NB_BANDS                         6
+
+/*!
+ * Number of datarate values of the LoRaWAN frames
+ */
+#define REGION_NB_DATARATES                         16
+
 /*!
  * Region       | SF
  * ------------ | :-----:
@@ -800,7 +815,20 @@ typedef enum ePhyAttribute
     /*!
      * The datarate of a ping slot channel.
      */
-    PHY_PING_SLOT_CHANNEL_DR
+    PHY_PING_SLOT_CHANNEL_DR,
+    /*!
+     * Listen before talk busy history of the channels, see
+     * \ref RegionCommonLbtSetChannelBusy. NULL in the regions without LBT.
+     */
+    PHY_LBT_BUSY_HISTORY,
+    /*!
+     * Bands of the region.
+     */
+    PHY_BANDS,
+    /*!
+     * Maximum number of bands of the region.
+     */
+    PHY_MAX_NB_BANDS
 }PhyAttribute_t;
 
 /*!
@@ -883,6 +911,14 @@ typedef union uPhyParam
      * Beacon format
      */
     BeaconFormat_t BeaconFormat;
+    /*!
+     * Pointer to the listen before talk busy history, indexed by the channel id.
+     */
+    const uint8_t* BusyHistory;
+    /*!
+     * Pointer to the bands.
+     */
+    Band_t* Bands;
 }PhyParam_t;
 
 /*!
@@ -943,7 +979,7 @@ typedef struct sInitDefaultsParams
     /*!
      * Pointer to region module context to be restored.
      */
-    void* NvmCtx;
+    void* RestoreCtx;
     /*!
      * Sets the initialization type.
      */
@@ -959,6 +995,14 @@ typedef struct sGetNvmCtxParams
      * Size of module context.
      */
      size_t nvmCtxSize;
+    /*!
+     * Number of channels at the start of the module context.
+     */
+     uint8_t nvmCtxNbChannels;
+    /*!
+     * Number of bands following the channels.
+     */
+     uint8_t nvmCtxNbBands;
 }GetNvmCtxParams_t;
 
 
@@ -1059,7 +1103,7 @@ typedef struct sRxConfigParams
      */
      uint32_t WindowTimeout;
     /*!
-     * RX window offset
+     * RX window offset in microseconds
      */
     int32_t WindowOffset;
     /*!
@@ -1264,6 +1308,39 @@ typedef struct sCalcBackOffParams
     TimerTime_t TxTimeOnAir;
 }CalcBackOffParams_t;
 
+/*!
+ * Result structure of the function RegionQueryTxDelays.
+ */
+typedef struct sTxDelays
+{
+    /*!
+     * Time to wait before each band is available, in ms.
+     */
+    TimerTime_t BandsDelay[REGION_MAX_NB_BANDS];
+    /*!
+     * Duty cycle of each band, the join duty cycle included.
+     */
+    uint16_t BandsDCycle[REGION_MAX_NB_BANDS];
+    /*!
+     * Number of bands of the region.
+     */
+    uint8_t NbBands;
+    /*!
+     * Time to wait before a channel of each datarate is available, in ms.
+     * TIMERTIME_T_MAX when no enabled channel supports the datarate.
+     */
+    TimerTime_t DatarateDelay[REGION_NB_DATARATES];
+    /*!
+     * Join duty cycle in force. 0 when the node is joined.
+     */
+    uint16_t JoinDCycle;
+    /*!
+     * Time until the join duty cycle changes, in s. 0 when it does not
+     * change anymore.
+     */
+    uint32_t JoinDCycleChange;
+}TxDelays_t;
+
 /*!
  * Parameter structure for the function RegionNextChannel.
  */
@@ -1294,6 +1371,21 @@ typedef struct sNextChanParams
      * for the next transmission.
      */
     bool QueryNextTxDelayOnly;
+    /*!
+     * Statistics of the channels, indexed by the channel id. NULL selects
+     * the channels uniformly. See \ref RegionCommonSelectChannel.
+     */
+    const LoRaMacChannelStats_t* ChannelStats;
+    /*!
+     * Number of channels having statistics.
+     */
+    uint8_t NbChannelStats;
+    /*!
+     * Channel not to select when an other one is available, e.g. the channel
+     * of the previous try of an uplink. The regions with sub-bands also avoid
+     * its sub-band. REGION_CHANNEL_NONE when none.
+     */
+    uint8_t AvoidChannel;
 }NextChanParams_t;
 
 /*!
@@ -1372,7 +1464,194 @@ typedef struct sRxBeaconSetupParams
     uint32_t Frequency;
 }RxBeaconSetup_t;
 
+/*!
+ * Constant PHY parameters of a region. These hold the values RegionGetPhyParam
+ * returns for the attributes which depend on the dwell time only. The arrays
+ * indexed by a dwell time hold the value for a dwell time of 0 first.
+ */
+typedef struct sRegionPhyConsts
+{
+    /*!
+     * Minimum Rx datarate ( PHY_MIN_RX_DR ), indexed by the downlink dwell time
+     */
+    int8_t MinRxDr[2];
+    /*!
+     * Minimum Tx datarate ( PHY_MIN_TX_DR ), indexed by the uplink dwell time
+     */
+    int8_t MinTxDr[2];
+    /*!
+     * Maximum payload per datarate ( PHY_MAX_PAYLOAD ), indexed by the dwell time
+     */
+    const uint8_t* MaxPayload[2];
+    /*!
+     * Maximum payload per datarate with repeater support ( PHY_MAX_PAYLOAD_REPEATER ),
+     * indexed by the dwell time
+     */
+    const uint8_t* MaxPayloadRepeater[2];
+    /*!
+     * Maximum frame counter gap ( PHY_MAX_FCNT_GAP )
+     */
+    uint32_t MaxFCntGap;
+    /*!
+     * Default Rx window 2 frequency ( PHY_DEF_RX2_FREQUENCY )
+     */
+    uint32_t DefRx2Frequency;
+    /*!
+     * Default Rx window 2 datarate ( PHY_DEF_RX2_DR )
+     */
+    int8_t DefRx2Dr;
+    /*!
+     * Spreading factor per datarate. 50 for the FSK datarate, 0 for the
+     * datarates the region does not define.
+     */
+    const uint8_t* Datarates;
+    /*!
+     * Number of entries of Datarates
+     */
+    uint8_t NbDatarates;
+}RegionPhyConsts_t;
 
+/*!
+ * Region operations table. Every member matches the Region function of the
+ * same name without the region argument.
+ */
+typedef struct sRegionOps
+{
+    /*!
+     * \brief See \ref RegionGetPhyConsts
+     */
+    const RegionPhyConsts_t* PhyConsts;
+    /*!
+     * \brief See \ref RegionGetPhyParam
+     */
+    PhyParam_t ( *GetPhyParam )( GetPhyParams_t* getPhy );
+    /*!
+     * \brief See \ref RegionSetBandTxDone
+     */
+    void ( *SetBandTxDone )( SetBandTxDoneParams_t* txDone );
+    /*!
+     * \brief See \ref RegionInitDefaults
+     */
+    void ( *InitDefaults )( InitDefaultsParams_t* params );
+    /*!
+     * \brief See \ref RegionGetNvmCtx
+     */
+    void* ( *GetNvmCtx )( GetNvmCtxParams_t* params );
+    /*!
+     * \brief See \ref RegionVerify
+     */
+    bool ( *Verify )( VerifyParams_t* verify, PhyAttribute_t phyAttribute );
+    /*!
+     * \brief See \ref RegionApplyCFList
+     */
+    void ( *ApplyCFList )( ApplyCFListParams_t* applyCFList );
+    /*!
+     * \brief See \ref RegionChanMaskSet
+     */
+    bool ( *ChanMaskSet )( ChanMaskSetParams_t* chanMaskSet );
+    /*!
+     * \brief See \ref RegionComputeRxWindowParameters
+     */
+    void ( *ComputeRxWindowParameters )( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams );
+    /*!
+     * \brief See \ref RegionRxConfig
+     */
+    bool ( *RxConfig )( RxConfigParams_t* rxConfig, int8_t* datarate );
+    /*!
+     * \brief See \ref RegionTxConfig
+     */
+    bool ( *TxConfig )( TxConfigParams_t* txConfig, int8_t* txPower, TimerTime_t* txTimeOnAir );
+    /*!
+     * \brief See \ref RegionLinkAdrReq
+     */
+    uint8_t ( *LinkAdrReq )( LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, int8_t* txPowOut, uint8_t* nbRepOut, uint8_t* nbBytesParsed );
+    /*!
+     * \brief See \ref RegionRxParamSetupReq
+     */
+    uint8_t ( *RxParamSetupReq )( RxParamSetupReqParams_t* rxParamSetupReq );
+    /*!
+     * \brief See \ref RegionNewChannelReq
+     */
+    uint8_t ( *NewChannelReq )( NewChannelReqParams_t* newChannelReq );
+    /*!
+     * \brief See \ref RegionTxParamSetupReq
+     */
+    int8_t ( *TxParamSetupReq )( TxParamSetupReqParams_t* txParamSetupReq );
+    /*!
+     * \brief See \ref RegionDlChannelReq
+     */
+    uint8_t ( *DlChannelReq )( DlChannelReqParams_t* dlChannelReq );
+    /*!
+     * \brief See \ref RegionAlternateDr
+     */
+    int8_t ( *AlternateDr )( int8_t currentDr, AlternateDrType_t type );
+    /*!
+     * \brief See \ref RegionCalcBackOff
+     */
+    void ( *CalcBackOff )( CalcBackOffParams_t* calcBackOff );
+    /*!
+     * \brief See \ref RegionNextChannel
+     */
+    LoRaMacStatus_t ( *NextChannel )( NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff );
+    /*!
+     * \brief See \ref RegionChannelAdd
+     */
+    LoRaMacStatus_t ( *ChannelAdd )( ChannelAddParams_t* channelAdd );
+    /*!
+     * \brief See \ref RegionChannelsRemove
+     */
+    bool ( *ChannelsRemove )( ChannelRemoveParams_t* channelRemove );
+    /*!
+     * \brief See \ref RegionSetContinuousWave
+     */
+    void ( *SetContinuousWave )( ContinuousWaveParams_t* continuousWave );
+    /*!
+     * \brief See \ref RegionApplyDrOffset
+     */
+    uint8_t ( *ApplyDrOffset )( uint8_t downlinkDwellTime, int8_t dr, int8_t drOffset );
+    /*!
+     * \brief See \ref RegionRxBeaconSetup
+     */
+    void ( *RxBeaconSetup )( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
+    /*!
+     * \brief See \ref RegionGetTxTimeOnAir
+     */
+    TimerTime_t ( *GetTxTimeOnAir )( int8_t datarate, uint8_t pktLen );
+#if defined( LORAMAC_INSTANCES_ENABLED )
+    /*!
+     * \brief Returns the size of the region instance block
+     */
+    size_t ( *GetInstanceSize )( void );
+    /*!
+     * \brief Selects the region instance block, NULL selects the default one
+     */
+    void ( *SelectInstance )( void* instance );
+#endif
+}RegionOps_t;
+
+/*!
+ * \brief Gets the operations table of a region.
+ *
+ * \remark The table is selected by indexing, the region functions below
+ *         dispatch through it without evaluating the region in a switch.
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \retval Returns the operations table, NULL if the region is not supported.
+ */
+const RegionOps_t* RegionGetOps( LoRaMacRegion_t region );
+
+/*!
+ * \brief Gets the constant PHY parameters of a region.
+ *
+ * \remark Reading these is equivalent to calling \ref RegionGetPhyParam for the
+ *         matching attributes, without going through the attribute switch.
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \retval Returns the constant parameters, NULL if the region is not supported.
+ */
+const RegionPhyConsts_t* RegionGetPhyConsts( LoRaMacRegion_t region );
 
 /*!
  * \brief The function verifies if a region is active or not. If a region
@@ -1628,6 +1907,22 @@ int8_t RegionAlternateDr( LoRaMacRegion_t region, int8_t currentDr, AlternateDrT
  */
 void RegionCalcBackOff( LoRaMacRegion_t region, CalcBackOffParams_t* calcBackOff );
 
+/*!
+ * \brief Computes the time to wait before each band and each datarate are
+ *        available, without changing the region state.
+ *
+ * \remark The band time-offs are computed on a copy of the bands, as
+ *         \ref RegionCalcBackOff would do for the last uplink.
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \param [IN] calcBackOff Parameters of the last uplink. Channel is
+ *             REGION_CHANNEL_NONE when there was no uplink.
+ *
+ * \param [OUT] txDelays Time to wait per band and per datarate.
+ */
+void RegionQueryTxDelays( LoRaMacRegion_t region, CalcBackOffParams_t* calcBackOff, TxDelays_t* txDelays );
+
 /*!
  * \brief Searches and set the next random available channel
  *
@@ -1697,6 +1992,42 @@ uint8_t RegionApplyDrOffset( LoRaMacRegion_t region, uint8_t downlinkDwellTime,
  */
 void RegionRxBeaconSetup( LoRaMacRegion_t region, RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
 
+/*!
+ * \brief Computes the time-on-air of an uplink frame without configuring the radio
+ *
+ * \param [IN] region LoRaWAN region.
+ *
+ * \param [IN] datarate Uplink datarate.
+ *
+ * \param [IN] pktLen Physical payload length.
+ *
+ * \retval Returns the time-on-air in ms, 0 if the region is not supported.
+ */
+TimerTime_t RegionGetTxTimeOnAir( LoRaMacRegion_t region, int8_t datarate, uint8_t pktLen );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief Returns the size of the instance block of the supported regions.
+ *
+ * \retval Size of the block in bytes.
+ */
+size_t RegionGetInstanceSize( void );
+
+/*!
+ * \brief Selects the instance block of the supported regions.
+ *
+ * \param [IN] instance Zero initialized block, NULL selects the default one.
+ */
+void RegionSelectInstance( void* instance );
+#endif
+
+#if defined( REGION_STATIC_BINDING )
+/*
+ * Single region builds call the region functions directly.
+ */
+#include "region/RegionBinding.h"
+#endif
+
 /*! \} defgroup REGION */
 
 #ifdef __cplusplus
@@ -59,11 +59,62 @@ typedef struct sRegionAS923NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionAS923NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionAS923Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionAS923NvmCtx_t NvmCtx;
+    /*!
+     * Busy history of the listen before talk carrier senses, per channel
+     */
+    uint8_t ChannelsBusyHistory[AS923_MAX_NB_CHANNELS];
+}RegionAS923Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionAS923Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionAS923Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#define ChannelsBusyHistory                         ( SelectedInstance->ChannelsBusyHistory )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionAS923NvmCtx_t NvmCtx;
 
+/*
+ * Busy history of the listen before talk carrier senses, per channel.
+ */
+static uint8_t ChannelsBusyHistory[AS923_MAX_NB_CHANNELS];
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionAS923PhyConsts =
+{
+    .MinRxDr = { AS923_RX_MIN_DATARATE, AS923_DWELL_LIMIT_DATARATE },
+    .MinTxDr = { AS923_TX_MIN_DATARATE, AS923_DWELL_LIMIT_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateDwell0AS923, MaxPayloadOfDatarateDwell1UpAS923 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterDwell0AS923, MaxPayloadOfDatarateDwell1UpAS923 },
+    .MaxFCntGap = AS923_MAX_FCNT_GAP,
+    .DefRx2Frequency = AS923_RX_WND_2_FREQ,
+    .DefRx2Dr = AS923_RX_WND_2_DR,
+    .Datarates = DataratesAS923,
+    .NbDatarates = sizeof( DataratesAS923 ),
+};
+
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
 {
@@ -285,6 +336,16 @@ PhyParam_t RegionAS923GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = AS923_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         {
             phyParam.Value = AS923_DEFAULT_UPLINK_DWELL_TIME;
@@ -327,6 +388,11 @@ PhyParam_t RegionAS923GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Value = AS923_PING_SLOT_CHANNEL_DR;
             break;
         }
+        case PHY_LBT_BUSY_HISTORY:
+        {
+            phyParam.BusyHistory = ChannelsBusyHistory;
+            break;
+        }
         default:
         {
             break;
@@ -371,9 +437,9 @@ void RegionAS923InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -397,6 +463,8 @@ void RegionAS923InitDefaults( InitDefaultsParams_t* params )
 void* RegionAS923GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionAS923NvmCtx_t );
+    params->nvmCtxNbChannels = AS923_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = AS923_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -530,7 +598,7 @@ bool RegionAS923ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionAS923ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, AS923_RX_MAX_DATARATE );
@@ -538,14 +606,14 @@ void RegionAS923ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols
 
     if( rxConfigParams->Datarate == DR_7 )
     { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesAS923[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeFsk( DataratesAS923[rxConfigParams->Datarate] );
     }
     else
     { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesAS923[rxConfigParams->Datarate], BandwidthsAS923[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesAS923[rxConfigParams->Datarate], BandwidthsAS923[rxConfigParams->Datarate] );
     }
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionAS923RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -916,7 +984,10 @@ LoRaMacStatus_t RegionAS923NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     if( status == LORAMAC_STATUS_OK )
     {
-        for( uint8_t  i = 0, j = randr( 0, nbEnabledChannels - 1 ); i < AS923_MAX_NB_CHANNELS; i++ )
+        // Probe the least occupied channels first
+        RegionCommonLbtSortChannels( enabledChannels, nbEnabledChannels, ChannelsBusyHistory );
+
+        for( uint8_t  i = 0, j = 0; i < AS923_MAX_NB_CHANNELS; i++ )
         {
             channelNext = enabledChannels[j];
             j = ( j + 1 ) % nbEnabledChannels;
@@ -925,10 +996,12 @@ LoRaMacStatus_t RegionAS923NextChannel( NextChanParams_t* nextChanParams, uint8_
             // If the channel is free, we can stop the LBT mechanism
             if( Radio.IsChannelFree( MODEM_LORA, NvmCtx.Channels[channelNext].Frequency, AS923_RSSI_FREE_TH, AS923_CARRIER_SENSE_TIME ) == true )
             {
+                RegionCommonLbtSetChannelBusy( ChannelsBusyHistory, channelNext, false );
                 // Free channel found
                 *channel = channelNext;
                 return LORAMAC_STATUS_OK;
             }
+            RegionCommonLbtSetChannelBusy( ChannelsBusyHistory, channelNext, true );
         }
         // Even if one or more channels are available according to the channel plan, no free channel
         // was found during the LBT procedure.
@@ -1060,3 +1133,20 @@ void RegionAS923RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = AS923_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionAS923GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesAS923[datarate], BandwidthsAS923[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionAS923GetInstanceSize( void )
+{
+    return sizeof( RegionAS923Instance_t );
+}
+
+void RegionAS923SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionAS923Instance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -325,6 +325,11 @@ static const uint8_t MaxPayloadOfDatarateDwell1DownAS923[] = { 0, 0, 11, 53, 126
  */
 static const int8_t EffectiveRx1DrOffsetAS923[] = { 0, 1, 2, 3, 4, 5, -1, -2 };
 
+/*!
+ * \brief Constant PHY parameters of the region, see \ref RegionGetPhyConsts.
+ */
+extern const RegionPhyConsts_t RegionAS923PhyConsts;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -546,6 +551,33 @@ uint8_t RegionAS923ApplyDrOffset( uint8_t downlinkDwellTime, int8_t dr, int8_t d
  */
  void RegionAS923RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
 
+/*!
+ * \brief Computes the time-on-air of an uplink frame
+ *
+ * \param [IN] datarate Uplink datarate.
+ *
+ * \param [IN] pktLen Physical payload length.
+ *
+ * \retval Returns the time-on-air in ms.
+ */
+TimerTime_t RegionAS923GetTxTimeOnAir( int8_t datarate, uint8_t pktLen );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t RegionAS923GetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void RegionAS923SelectInstance( void* instance );
+#endif
+
 /*! \} defgroup REGIONAS923 */
 
 #ifdef __cplusplus
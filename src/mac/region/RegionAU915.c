@@ -66,11 +66,62 @@ typedef struct sRegionAU915NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionAU915NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionAU915Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionAU915NvmCtx_t NvmCtx;
+    /*!
+     * Channel masks of the channel plan
+     */
+    RegionCommonChanMasks_t ChanMasks;
+}RegionAU915Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionAU915Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionAU915Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#define ChanMasks                                   ( SelectedInstance->ChanMasks )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionAU915NvmCtx_t NvmCtx;
 
+/*
+ * Channel masks of the channel plan, rebuilt when the channels change.
+ */
+static RegionCommonChanMasks_t ChanMasks;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionAU915PhyConsts =
+{
+    .MinRxDr = { AU915_RX_MIN_DATARATE, AU915_DWELL_LIMIT_DATARATE },
+    .MinTxDr = { AU915_TX_MIN_DATARATE, AU915_DWELL_LIMIT_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateDwell0AU915, MaxPayloadOfDatarateDwell1AU915 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterDwell0AU915, MaxPayloadOfDatarateRepeaterDwell1AU915 },
+    .MaxFCntGap = AU915_MAX_FCNT_GAP,
+    .DefRx2Frequency = AU915_RX_WND_2_FREQ,
+    .DefRx2Dr = AU915_RX_WND_2_DR,
+    .Datarates = DataratesAU915,
+    .NbDatarates = sizeof( DataratesAU915 ),
+};
+
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
 {
@@ -306,6 +357,16 @@ PhyParam_t RegionAU915GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = AU915_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         {
             phyParam.Value = AU915_DEFAULT_UPLINK_DWELL_TIME;
@@ -418,14 +479,17 @@ void RegionAU915InitDefaults( InitDefaultsParams_t* params )
 
             // Copy into channels mask remaining
             RegionCommonChanMaskCopy( NvmCtx.ChannelsMaskRemaining, NvmCtx.ChannelsMask, 6 );
+
+            RegionCommonChanMasksBuild( &ChanMasks, NvmCtx.Channels, AU915_MAX_NB_CHANNELS, AU915_TX_MIN_DATARATE, AU915_TX_MAX_DATARATE );
             break;
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
+            RegionCommonChanMasksBuild( &ChanMasks, NvmCtx.Channels, AU915_MAX_NB_CHANNELS, AU915_TX_MIN_DATARATE, AU915_TX_MAX_DATARATE );
             break;
         }
         case INIT_TYPE_RESTORE_DEFAULT_CHANNELS:
@@ -449,6 +513,8 @@ void RegionAU915InitDefaults( InitDefaultsParams_t* params )
 void* RegionAU915GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionAU915NvmCtx_t );
+    params->nvmCtxNbChannels = AU915_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = AU915_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -556,15 +622,15 @@ bool RegionAU915ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionAU915ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, AU915_RX_MAX_DATARATE );
     rxConfigParams->Bandwidth = GetBandwidth( rxConfigParams->Datarate );
 
-    tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesAU915[rxConfigParams->Datarate], BandwidthsAU915[rxConfigParams->Datarate] );
+    tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesAU915[rxConfigParams->Datarate], BandwidthsAU915[rxConfigParams->Datarate] );
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionAU915RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -661,20 +727,14 @@ uint8_t RegionAU915LinkAdrReq( LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, in
         if( linkAdrParams.ChMaskCtrl == 6 )
         {
             // Enable all 125 kHz channels
-            channelsMask[0] = 0xFFFF;
-            channelsMask[1] = 0xFFFF;
-            channelsMask[2] = 0xFFFF;
-            channelsMask[3] = 0xFFFF;
+            RegionCommonChanMaskFill( channelsMask, 0, 4, 0xFFFF );
             // Apply chMask to channels 64 to 71
             channelsMask[4] = linkAdrParams.ChMask & CHANNELS_MASK_500KHZ_MASK;
         }
         else if( linkAdrParams.ChMaskCtrl == 7 )
         {
             // Disable all 125 kHz channels
-            channelsMask[0] = 0x0000;
-            channelsMask[1] = 0x0000;
-            channelsMask[2] = 0x0000;
-            channelsMask[3] = 0x0000;
+            RegionCommonChanMaskFill( channelsMask, 0, 4, 0x0000 );
             // Apply chMask to channels 64 to 71
             channelsMask[4] = linkAdrParams.ChMask & CHANNELS_MASK_500KHZ_MASK;
         }
@@ -877,8 +937,7 @@ void RegionAU915CalcBackOff( CalcBackOffParams_t* calcBackOff )
 LoRaMacStatus_t RegionAU915NextChannel( NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff )
 {
     uint8_t nbEnabledChannels = 0;
-    uint8_t nbRestrictedChannels = 0;
-    uint8_t enabledChannels[AU915_MAX_NB_CHANNELS] = { 0 };
+    uint16_t enabledMask[REGION_COMMON_CHANNELS_MASK_MAX_SIZE];
     RegionCommonIdentifyChannelsParam_t identifyChannelsParam;
     RegionCommonCountNbOfEnabledChannelsParams_t countChannelsParams;
     LoRaMacStatus_t status = LORAMAC_STATUS_NO_CHANNEL_FOUND;
@@ -913,8 +972,8 @@ LoRaMacStatus_t RegionAU915NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     identifyChannelsParam.CountNbOfEnabledChannelsParam = &countChannelsParams;
 
-    status = RegionCommonIdentifyChannels( &identifyChannelsParam, aggregatedTimeOff, enabledChannels,
-                                           &nbEnabledChannels, &nbRestrictedChannels, time );
+    status = RegionCommonIdentifyChannelsMask( &identifyChannelsParam, &ChanMasks, aggregatedTimeOff, enabledMask,
+                                               &nbEnabledChannels, time );
 
     if( nextChanParams->QueryNextTxDelayOnly == true )
     {
@@ -923,8 +982,8 @@ LoRaMacStatus_t RegionAU915NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     if( status == LORAMAC_STATUS_OK )
     {
-        // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        // We found a valid channel, preferably in an other sub-band than the previous try
+        *channel = RegionCommonSelectChannelMask( nextChanParams, enabledMask, ChanMasks.Size, nbEnabledChannels, 8 );
         // Disable the channel in the mask
         RegionCommonChanDisable( NvmCtx.ChannelsMaskRemaining, *channel, AU915_MAX_NB_CHANNELS - 8 );
     }
@@ -988,3 +1047,20 @@ void RegionAU915RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = AU915_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionAU915GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesAU915[datarate], BandwidthsAU915[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionAU915GetInstanceSize( void )
+{
+    return sizeof( RegionAU915Instance_t );
+}
+
+void RegionAU915SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionAU915Instance_t* )instance : &DefaultInstance;
+}
+#endif
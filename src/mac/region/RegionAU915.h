@@ -319,6 +319,11 @@ static const uint8_t MaxPayloadOfDatarateDwell1AU915[] = { 0, 0, 11, 53, 125, 24
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterDwell1AU915[] = { 0, 0, 11, 53, 125, 242, 242, 0, 33, 109, 222, 222, 222, 222 };
 
+/*!
+ * \brief Constant PHY parameters of the region, see \ref RegionGetPhyConsts.
+ */
+extern const RegionPhyConsts_t RegionAU915PhyConsts;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -540,6 +545,33 @@ uint8_t RegionAU915ApplyDrOffset( uint8_t downlinkDwellTime, int8_t dr, int8_t d
  */
  void RegionAU915RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
 
+/*!
+ * \brief Computes the time-on-air of an uplink frame
+ *
+ * \param [IN] datarate Uplink datarate.
+ *
+ * \param [IN] pktLen Physical payload length.
+ *
+ * \retval Returns the time-on-air in ms.
+ */
+TimerTime_t RegionAU915GetTxTimeOnAir( int8_t datarate, uint8_t pktLen );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t RegionAU915GetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void RegionAU915SelectInstance( void* instance );
+#endif
+
 /*! \} defgroup REGIONAU915 */
 
 #ifdef __cplusplus
@@ -0,0 +1,133 @@
+/*!
+ * \file      RegionBinding.h
+ *
+ * \brief     Compile time binding of the region functions
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __REGION_BINDING_H__
+#define __REGION_BINDING_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/*!
+ * \brief Selects the functions of the single enabled region
+ *
+ * \remark Every RegionXXX call becomes a direct call to the region
+ *         implementation which the compiler can inline with link time
+ *         optimization. The region argument is still evaluated.
+ */
+#if defined( REGION_AS923 )
+#include "region/RegionAS923.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_AS923
+#define REGION_BINDING_CALL( fn )                   RegionAS923##fn
+#elif defined( REGION_AU915 )
+#include "region/RegionAU915.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_AU915
+#define REGION_BINDING_CALL( fn )                   RegionAU915##fn
+#elif defined( REGION_CN470 )
+#include "region/RegionCN470.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_CN470
+#define REGION_BINDING_CALL( fn )                   RegionCN470##fn
+#elif defined( REGION_CN779 )
+#include "region/RegionCN779.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_CN779
+#define REGION_BINDING_CALL( fn )                   RegionCN779##fn
+#elif defined( REGION_EU433 )
+#include "region/RegionEU433.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_EU433
+#define REGION_BINDING_CALL( fn )                   RegionEU433##fn
+#elif defined( REGION_EU868 )
+#include "region/RegionEU868.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_EU868
+#define REGION_BINDING_CALL( fn )                   RegionEU868##fn
+#elif defined( REGION_KR920 )
+#include "region/RegionKR920.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_KR920
+#define REGION_BINDING_CALL( fn )                   RegionKR920##fn
+#elif defined( REGION_IN865 )
+#include "region/RegionIN865.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_IN865
+#define REGION_BINDING_CALL( fn )                   RegionIN865##fn
+#elif defined( REGION_US915 )
+#include "region/RegionUS915.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_US915
+#define REGION_BINDING_CALL( fn )                   RegionUS915##fn
+#elif defined( REGION_RU864 )
+#include "region/RegionRU864.h"
+#define REGION_BINDING_REGION                       LORAMAC_REGION_RU864
+#define REGION_BINDING_CALL( fn )                   RegionRU864##fn
+#else
+#error "REGION_STATIC_BINDING requires exactly one enabled region"
+#endif
+
+#define RegionIsActive( region )                    ( ( region ) == REGION_BINDING_REGION )
+#define RegionGetPhyConsts( region )                ( ( void )( region ), &REGION_BINDING_CALL( PhyConsts ) )
+#define RegionGetPhyParam( region, getPhy )     \
+    ( ( void )( region ), REGION_BINDING_CALL( GetPhyParam )( getPhy ) )
+#define RegionSetBandTxDone( region, txDone )   \
+    ( ( void )( region ), REGION_BINDING_CALL( SetBandTxDone )( txDone ) )
+#define RegionInitDefaults( region, params )    \
+    ( ( void )( region ), REGION_BINDING_CALL( InitDefaults )( params ) )
+#define RegionGetNvmCtx( region, params )       \
+    ( ( void )( region ), REGION_BINDING_CALL( GetNvmCtx )( params ) )
+#define RegionVerify( region, verify, phyAttribute ) \
+    ( ( void )( region ), REGION_BINDING_CALL( Verify )( verify, phyAttribute ) )
+#define RegionApplyCFList( region, applyCFList ) \
+    ( ( void )( region ), REGION_BINDING_CALL( ApplyCFList )( applyCFList ) )
+#define RegionChanMaskSet( region, chanMaskSet ) \
+    ( ( void )( region ), REGION_BINDING_CALL( ChanMaskSet )( chanMaskSet ) )
+#define RegionComputeRxWindowParameters( region, datarate, minRxSymbols, rxError, rxConfigParams ) \
+    ( ( void )( region ), REGION_BINDING_CALL( ComputeRxWindowParameters )( datarate, minRxSymbols, rxError, rxConfigParams ) )
+#define RegionRxConfig( region, rxConfig, datarate ) \
+    ( ( void )( region ), REGION_BINDING_CALL( RxConfig )( rxConfig, datarate ) )
+#define RegionTxConfig( region, txConfig, txPower, txTimeOnAir ) \
+    ( ( void )( region ), REGION_BINDING_CALL( TxConfig )( txConfig, txPower, txTimeOnAir ) )
+#define RegionLinkAdrReq( region, linkAdrReq, drOut, txPowOut, nbRepOut, nbBytesParsed ) \
+    ( ( void )( region ), REGION_BINDING_CALL( LinkAdrReq )( linkAdrReq, drOut, txPowOut, nbRepOut, nbBytesParsed ) )
+#define RegionRxParamSetupReq( region, rxParamSetupReq ) \
+    ( ( void )( region ), REGION_BINDING_CALL( RxParamSetupReq )( rxParamSetupReq ) )
+#define RegionNewChannelReq( region, newChannelReq ) \
+    ( ( void )( region ), REGION_BINDING_CALL( NewChannelReq )( newChannelReq ) )
+#define RegionTxParamSetupReq( region, txParamSetupReq ) \
+    ( ( void )( region ), REGION_BINDING_CALL( TxParamSetupReq )( txParamSetupReq ) )
+#define RegionDlChannelReq( region, dlChannelReq ) \
+    ( ( void )( region ), REGION_BINDING_CALL( DlChannelReq )( dlChannelReq ) )
+#define RegionAlternateDr( region, currentDr, type ) \
+    ( ( void )( region ), REGION_BINDING_CALL( AlternateDr )( currentDr, type ) )
+#define RegionCalcBackOff( region, calcBackOff ) \
+    ( ( void )( region ), REGION_BINDING_CALL( CalcBackOff )( calcBackOff ) )
+#define RegionNextChannel( region, nextChanParams, channel, time, aggregatedTimeOff ) \
+    ( ( void )( region ), REGION_BINDING_CALL( NextChannel )( nextChanParams, channel, time, aggregatedTimeOff ) )
+#define RegionChannelAdd( region, channelAdd )  \
+    ( ( void )( region ), REGION_BINDING_CALL( ChannelAdd )( channelAdd ) )
+#define RegionChannelsRemove( region, channelRemove ) \
+    ( ( void )( region ), REGION_BINDING_CALL( ChannelsRemove )( channelRemove ) )
+#define RegionSetContinuousWave( region, continuousWave ) \
+    ( ( void )( region ), REGION_BINDING_CALL( SetContinuousWave )( continuousWave ) )
+#define RegionApplyDrOffset( region, downlinkDwellTime, dr, drOffset ) \
+    ( ( void )( region ), REGION_BINDING_CALL( ApplyDrOffset )( downlinkDwellTime, dr, drOffset ) )
+#define RegionRxBeaconSetup( region, rxBeaconSetup, outDr ) \
+    ( ( void )( region ), REGION_BINDING_CALL( RxBeaconSetup )( rxBeaconSetup, outDr ) )
+#define RegionGetTxTimeOnAir( region, datarate, pktLen ) \
+    ( ( void )( region ), REGION_BINDING_CALL( GetTxTimeOnAir )( datarate, pktLen ) )
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __REGION_BINDING_H__
@@ -59,11 +59,62 @@ typedef struct sRegionCN470NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionCN470NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionCN470Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionCN470NvmCtx_t NvmCtx;
+    /*!
+     * Channel masks of the channel plan
+     */
+    RegionCommonChanMasks_t ChanMasks;
+}RegionCN470Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionCN470Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionCN470Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#define ChanMasks                                   ( SelectedInstance->ChanMasks )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionCN470NvmCtx_t NvmCtx;
 
+/*
+ * Channel masks of the channel plan, rebuilt when the channels change.
+ */
+static RegionCommonChanMasks_t ChanMasks;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionCN470PhyConsts =
+{
+    .MinRxDr = { CN470_RX_MIN_DATARATE, CN470_RX_MIN_DATARATE },
+    .MinTxDr = { CN470_TX_MIN_DATARATE, CN470_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateCN470, MaxPayloadOfDatarateCN470 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterCN470, MaxPayloadOfDatarateRepeaterCN470 },
+    .MaxFCntGap = CN470_MAX_FCNT_GAP,
+    .DefRx2Frequency = CN470_RX_WND_2_FREQ,
+    .DefRx2Dr = CN470_RX_WND_2_DR,
+    .Datarates = DataratesCN470,
+    .NbDatarates = sizeof( DataratesCN470 ),
+};
+
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
 {
@@ -259,6 +310,16 @@ PhyParam_t RegionCN470GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = CN470_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -352,14 +413,17 @@ void RegionCN470InitDefaults( InitDefaultsParams_t* params )
 
             // Update the channels mask
             RegionCommonChanMaskCopy( NvmCtx.ChannelsMask, NvmCtx.ChannelsDefaultMask, 6 );
+
+            RegionCommonChanMasksBuild( &ChanMasks, NvmCtx.Channels, CN470_MAX_NB_CHANNELS, CN470_TX_MIN_DATARATE, CN470_TX_MAX_DATARATE );
             break;
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
+            RegionCommonChanMasksBuild( &ChanMasks, NvmCtx.Channels, CN470_MAX_NB_CHANNELS, CN470_TX_MIN_DATARATE, CN470_TX_MAX_DATARATE );
             break;
         }
         case INIT_TYPE_RESTORE_DEFAULT_CHANNELS:
@@ -378,6 +442,8 @@ void RegionCN470InitDefaults( InitDefaultsParams_t* params )
 void* RegionCN470GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionCN470NvmCtx_t );
+    params->nvmCtxNbChannels = CN470_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = CN470_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -457,15 +523,15 @@ bool RegionCN470ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionCN470ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, CN470_RX_MAX_DATARATE );
     rxConfigParams->Bandwidth = GetBandwidth( rxConfigParams->Datarate );
 
-    tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesCN470[rxConfigParams->Datarate], BandwidthsCN470[rxConfigParams->Datarate] );
+    tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesCN470[rxConfigParams->Datarate], BandwidthsCN470[rxConfigParams->Datarate] );
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionCN470RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -561,12 +627,7 @@ uint8_t RegionCN470LinkAdrReq( LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, in
         if( linkAdrParams.ChMaskCtrl == 6 )
         {
             // Enable all 125 kHz channels
-            channelsMask[0] = 0xFFFF;
-            channelsMask[1] = 0xFFFF;
-            channelsMask[2] = 0xFFFF;
-            channelsMask[3] = 0xFFFF;
-            channelsMask[4] = 0xFFFF;
-            channelsMask[5] = 0xFFFF;
+            RegionCommonChanMaskFill( channelsMask, 0, CHANNELS_MASK_SIZE, 0xFFFF );
         }
         else if( linkAdrParams.ChMaskCtrl == 7 )
         {
@@ -574,13 +635,9 @@ uint8_t RegionCN470LinkAdrReq( LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, in
         }
         else
         {
-            for( uint8_t i = 0; i < 16; i++ )
-            {
-                if( ( ( linkAdrParams.ChMask & ( 1 << i ) ) != 0 ) &&
-                    ( NvmCtx.Channels[linkAdrParams.ChMaskCtrl * 16 + i].Frequency == 0 ) )
-                {// Trying to enable an undefined channel
-                    status &= 0xFE; // Channel mask KO
-                }
+            if( RegionCommonChanMaskIsDefined( &ChanMasks, linkAdrParams.ChMaskCtrl, linkAdrParams.ChMask ) == false )
+            {// Trying to enable an undefined channel
+                status &= 0xFE; // Channel mask KO
             }
             channelsMask[linkAdrParams.ChMaskCtrl] = linkAdrParams.ChMask;
         }
@@ -692,8 +749,7 @@ void RegionCN470CalcBackOff( CalcBackOffParams_t* calcBackOff )
 LoRaMacStatus_t RegionCN470NextChannel( NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff )
 {
     uint8_t nbEnabledChannels = 0;
-    uint8_t nbRestrictedChannels = 0;
-    uint8_t enabledChannels[CN470_MAX_NB_CHANNELS] = { 0 };
+    uint16_t enabledMask[CHANNELS_MASK_SIZE];
     RegionCommonIdentifyChannelsParam_t identifyChannelsParam;
     RegionCommonCountNbOfEnabledChannelsParams_t countChannelsParams;
     LoRaMacStatus_t status = LORAMAC_STATUS_NO_CHANNEL_FOUND;
@@ -701,12 +757,7 @@ LoRaMacStatus_t RegionCN470NextChannel( NextChanParams_t* nextChanParams, uint8_
     // Count 125kHz channels
     if( RegionCommonCountChannels( NvmCtx.ChannelsMask, 0, 6 ) == 0 )
     { // Reactivate default channels
-        NvmCtx.ChannelsMask[0] = 0xFFFF;
-        NvmCtx.ChannelsMask[1] = 0xFFFF;
-        NvmCtx.ChannelsMask[2] = 0xFFFF;
-        NvmCtx.ChannelsMask[3] = 0xFFFF;
-        NvmCtx.ChannelsMask[4] = 0xFFFF;
-        NvmCtx.ChannelsMask[5] = 0xFFFF;
+        RegionCommonChanMaskFill( NvmCtx.ChannelsMask, 0, CHANNELS_MASK_SIZE, 0xFFFF );
     }
 
     // Search how many channels are enabled
@@ -725,8 +776,9 @@ LoRaMacStatus_t RegionCN470NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     identifyChannelsParam.CountNbOfEnabledChannelsParam = &countChannelsParams;
 
-    status = RegionCommonIdentifyChannels( &identifyChannelsParam, aggregatedTimeOff, enabledChannels,
-                                           &nbEnabledChannels, &nbRestrictedChannels, time );
+    // The 96 channels are checked one mask word at a time
+    status = RegionCommonIdentifyChannelsMask( &identifyChannelsParam, &ChanMasks, aggregatedTimeOff, enabledMask,
+                                               &nbEnabledChannels, time );
 
     if( nextChanParams->QueryNextTxDelayOnly == true )
     {
@@ -736,7 +788,7 @@ LoRaMacStatus_t RegionCN470NextChannel( NextChanParams_t* nextChanParams, uint8_
     if( status == LORAMAC_STATUS_OK )
     {
         // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        *channel = RegionCommonSelectChannelMask( nextChanParams, enabledMask, CHANNELS_MASK_SIZE, nbEnabledChannels, 0 );
     }
     return status;
 }
@@ -791,3 +843,20 @@ void RegionCN470RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = CN470_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionCN470GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesCN470[datarate], BandwidthsCN470[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionCN470GetInstanceSize( void )
+{
+    return sizeof( RegionCN470Instance_t );
+}
+
+void RegionCN470SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionCN470Instance_t* )instance : &DefaultInstance;
+}
+#endif
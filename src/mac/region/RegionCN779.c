@@ -59,10 +59,51 @@ typedef struct sRegionCN779NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionCN779NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionCN779Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionCN779NvmCtx_t NvmCtx;
+}RegionCN779Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionCN779Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionCN779Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionCN779NvmCtx_t NvmCtx;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionCN779PhyConsts =
+{
+    .MinRxDr = { CN779_RX_MIN_DATARATE, CN779_RX_MIN_DATARATE },
+    .MinTxDr = { CN779_TX_MIN_DATARATE, CN779_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateCN779, MaxPayloadOfDatarateCN779 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterCN779, MaxPayloadOfDatarateRepeaterCN779 },
+    .MaxFCntGap = CN779_MAX_FCNT_GAP,
+    .DefRx2Frequency = CN779_RX_WND_2_FREQ,
+    .DefRx2Dr = CN779_RX_WND_2_DR,
+    .Datarates = DataratesCN779,
+    .NbDatarates = sizeof( DataratesCN779 ),
+};
 
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
@@ -250,6 +291,16 @@ PhyParam_t RegionCN779GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = CN779_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -333,9 +384,9 @@ void RegionCN779InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -360,6 +411,8 @@ void RegionCN779InitDefaults( InitDefaultsParams_t* params )
 void* RegionCN779GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionCN779NvmCtx_t );
+    params->nvmCtxNbChannels = CN779_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = CN779_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -479,7 +532,7 @@ bool RegionCN779ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionCN779ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, CN779_RX_MAX_DATARATE );
@@ -487,14 +540,14 @@ void RegionCN779ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols
 
     if( rxConfigParams->Datarate == DR_7 )
     { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesCN779[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeFsk( DataratesCN779[rxConfigParams->Datarate] );
     }
     else
     { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesCN779[rxConfigParams->Datarate], BandwidthsCN779[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesCN779[rxConfigParams->Datarate], BandwidthsCN779[rxConfigParams->Datarate] );
     }
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionCN779RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -861,7 +914,7 @@ LoRaMacStatus_t RegionCN779NextChannel( NextChanParams_t* nextChanParams, uint8_
     if( status == LORAMAC_STATUS_OK )
     {
         // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        *channel = RegionCommonSelectChannel( nextChanParams, enabledChannels, nbEnabledChannels );
     }
     else if( status == LORAMAC_STATUS_NO_CHANNEL_FOUND )
     {
@@ -985,3 +1038,20 @@ void RegionCN779RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = CN779_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionCN779GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesCN779[datarate], BandwidthsCN779[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionCN779GetInstanceSize( void )
+{
+    return sizeof( RegionCN779Instance_t );
+}
+
+void RegionCN779SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionCN779Instance_t* )instance : &DefaultInstance;
+}
+#endif
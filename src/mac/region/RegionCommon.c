@@ -28,7 +28,6 @@
  *
  * \author    Daniel Jaeckle ( STACKFORCE )
  */
-#include <math.h>
 #include "radio.h"
 #include "utilities.h"
 #include "RegionCommon.h"
@@ -37,18 +36,54 @@
 #define BACKOFF_DC_10_HOURS     1000
 #define BACKOFF_DC_24_HOURS     10000
 
-static uint8_t CountChannels( uint16_t mask, uint8_t nbBits )
+/*!
+ * Bit position of the isolated lowest set bit, indexed by the de Bruijn
+ * sequence 0x077CB531 product
+ */
+static const uint8_t DeBruijnBitPosition[32] =
 {
-    uint8_t nbActiveBits = 0;
+    0, 1, 28, 2, 29, 14, 24, 3, 30, 22, 20, 15, 25, 17, 4, 8,
+    31, 27, 13, 23, 21, 19, 16, 7, 26, 12, 18, 6, 11, 5, 10, 9
+};
 
-    for( uint8_t j = 0; j < nbBits; j++ )
+static int32_t DivCeil( int32_t num, int32_t den )
+{
+    if( num > 0 )
     {
-        if( ( mask & ( 1 << j ) ) == ( 1 << j ) )
-        {
-            nbActiveBits++;
-        }
+        return ( num + den - 1 ) / den;
+    }
+    // The division truncates towards zero
+    return num / den;
+}
+
+static uint8_t CountChannels( uint16_t mask )
+{
+    uint32_t bits = mask;
+
+    // Parallel bit count
+    bits = bits - ( ( bits >> 1 ) & 0x5555 );
+    bits = ( bits & 0x3333 ) + ( ( bits >> 2 ) & 0x3333 );
+    bits = ( bits + ( bits >> 4 ) ) & 0x0F0F;
+    return ( uint8_t )( ( bits + ( bits >> 8 ) ) & 0x1F );
+}
+
+static uint8_t LowestChannel( uint16_t mask )
+{
+    uint32_t lowestBit = mask & ( ~( uint32_t )mask + 1 );
+
+    return DeBruijnBitPosition[( uint32_t )( lowestBit * 0x077CB531UL ) >> 27];
+}
+
+static uint32_t ChannelWeight( NextChanParams_t* nextChanParams, uint8_t channel )
+{
+    int32_t weight = 128;
+
+    if( channel < nextChanParams->NbChannelStats )
+    {
+        weight += nextChanParams->ChannelStats[channel].Score;
     }
-    return nbActiveBits;
+    // The hopping stays pseudo random, every channel keeps a fair chance
+    return ( weight > REGION_COMMON_CHANNEL_MIN_WEIGHT ) ? ( uint32_t )weight : REGION_COMMON_CHANNEL_MIN_WEIGHT;
 }
 
 uint16_t RegionCommonGetJoinDc( SysTime_t elapsedTime )
@@ -70,6 +105,19 @@ uint16_t RegionCommonGetJoinDc( SysTime_t elapsedTime )
     return dutyCycle;
 }
 
+uint32_t RegionCommonGetJoinDcChange( SysTime_t elapsedTime )
+{
+    if( elapsedTime.Seconds < 3600 )
+    {
+        return 3600 - elapsedTime.Seconds;
+    }
+    else if( elapsedTime.Seconds < ( 3600 + 36000 ) )
+    {
+        return ( 3600 + 36000 ) - elapsedTime.Seconds;
+    }
+    return 0;
+}
+
 bool RegionCommonChanVerifyDr( uint8_t nbChannels, uint16_t* channelsMask, int8_t dr, int8_t minDr, int8_t maxDr, ChannelParams_t* channels )
 {
     if( RegionCommonValueInRange( dr, minDr, maxDr ) == 0 )
@@ -79,7 +127,7 @@ bool RegionCommonChanVerifyDr( uint8_t nbChannels, uint16_t* channelsMask, int8_
 
     for( uint8_t i = 0, k = 0; i < nbChannels; i += 16, k++ )
     {
-        for( uint8_t j = 0; j < 16; j++ )
+        for( uint8_t j = 0; ( j < 16 ) && ( ( i + j ) < nbChannels ); j++ )
         {
             if( ( ( channelsMask[k] & ( 1 << j ) ) != 0 ) )
             {// Check datarate validity for enabled channels
@@ -130,7 +178,7 @@ uint8_t RegionCommonCountChannels( uint16_t* channelsMask, uint8_t startIdx, uin
 
     for( uint8_t i = startIdx; i < stopIdx; i++ )
     {
-        nbChannels += CountChannels( channelsMask[i], 16 );
+        nbChannels += CountChannels( channelsMask[i] );
     }
 
     return nbChannels;
@@ -160,6 +208,40 @@ void RegionCommonSetBandTxDone( bool joined, Band_t* band, TimerTime_t lastTxDon
     }
 }
 
+TimerTime_t RegionCommonGetBandNextTxDelay( bool joined, bool dutyCycle, Band_t* band )
+{
+    TimerTime_t elapsed = 0;
+
+    if( band->TimeOff == 0 )
+    {
+        return 0;
+    }
+
+    if( joined == false )
+    {
+        TimerTime_t elapsedJoin = TimerGetElapsedTime( band->LastJoinTxDoneTime );
+        TimerTime_t elapsedTx = ( dutyCycle == true ) ? TimerGetElapsedTime( band->LastTxDoneTime ) : 0;
+
+        elapsed = MAX( elapsedJoin, elapsedTx );
+    }
+    else if( dutyCycle == true )
+    {
+        elapsed = TimerGetElapsedTime( band->LastTxDoneTime );
+    }
+    else
+    {
+        band->TimeOff = 0;
+        return 0;
+    }
+
+    if( band->TimeOff <= elapsed )
+    {
+        band->TimeOff = 0;
+        return 0;
+    }
+    return band->TimeOff - elapsed;
+}
+
 TimerTime_t RegionCommonUpdateBandTimeOff( bool joined, bool dutyCycle, Band_t* bands, uint8_t nbBands )
 {
     TimerTime_t nextTxDelay = TIMERTIME_T_MAX;
@@ -167,41 +249,16 @@ TimerTime_t RegionCommonUpdateBandTimeOff( bool joined, bool dutyCycle, Band_t*
     // Update bands Time OFF
     for( uint8_t i = 0; i < nbBands; i++ )
     {
-        if( joined == false )
-        {
-            TimerTime_t elapsedJoin = TimerGetElapsedTime( bands[i].LastJoinTxDoneTime );
-            TimerTime_t elapsedTx = TimerGetElapsedTime( bands[i].LastTxDoneTime );
-            TimerTime_t txDoneTime =  MAX( elapsedJoin,
-                                        ( dutyCycle == true ) ? elapsedTx : 0 );
+        TimerTime_t bandDelay;
 
-            if( bands[i].TimeOff <= txDoneTime )
-            {
-                bands[i].TimeOff = 0;
-            }
-            if( bands[i].TimeOff != 0 )
-            {
-                nextTxDelay = MIN( bands[i].TimeOff - txDoneTime, nextTxDelay );
-            }
+        if( bands[i].TimeOff == 0 )
+        { // The band is available, no need to look at its last Tx time
+            continue;
         }
-        else
+        bandDelay = RegionCommonGetBandNextTxDelay( joined, dutyCycle, &bands[i] );
+        if( bandDelay != 0 )
         {
-            if( dutyCycle == true )
-            {
-                TimerTime_t elapsed = TimerGetElapsedTime( bands[i].LastTxDoneTime );
-                if( bands[i].TimeOff <= elapsed )
-                {
-                    bands[i].TimeOff = 0;
-                }
-                if( bands[i].TimeOff != 0 )
-                {
-                    nextTxDelay = MIN( bands[i].TimeOff - elapsed, nextTxDelay );
-                }
-            }
-            else
-            {
-                nextTxDelay = 0;
-                bands[i].TimeOff = 0;
-            }
+            nextTxDelay = MIN( bandDelay, nextTxDelay );
         }
     }
 
@@ -289,28 +346,66 @@ uint8_t RegionCommonLinkAdrReqVerifyParams( RegionCommonLinkAdrReqVerifyParams_t
     return status;
 }
 
-double RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth )
+uint32_t RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth )
 {
-    return ( ( double )( 1 << phyDr ) / ( double )bandwidth ) * 1000;
+    // Spreading factors 7 to 12 over 125, 250 or 500 kHz give integer symbol times
+    return ( uint32_t )( ( ( uint64_t )1000000 << phyDr ) / bandwidth );
 }
 
-double RegionCommonComputeSymbolTimeFsk( uint8_t phyDr )
+uint32_t RegionCommonComputeSymbolTimeFsk( uint8_t phyDr )
 {
-    return ( 8.0 / ( double )phyDr ); // 1 symbol equals 1 byte
+    return ( 8000 / ( uint32_t )phyDr ); // 1 symbol equals 1 byte
 }
 
-void RegionCommonComputeRxWindowParameters( double tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset )
+TimerTime_t RegionCommonComputeTxTimeOnAir( uint8_t phyDr, uint32_t bandwidth, uint8_t pktLen )
 {
-    *windowTimeout = MAX( ( uint32_t )ceil( ( ( 2 * minRxSymbols - 8 ) * tSymbol + 2 * rxError ) / tSymbol ), minRxSymbols ); // Computed number of symbols
-    *windowOffset = ( int32_t )ceil( ( 4.0 * tSymbol ) - ( ( *windowTimeout * tSymbol ) / 2.0 ) - wakeUpTime );
+    uint32_t tSymbolUs;
+    int32_t nbPayloadBlocks;
+    uint8_t lowDatarateOptimize = 0;
+
+    if( phyDr == 0 )
+    {
+        return 0;
+    }
+    if( bandwidth == 0 )
+    {
+        // Preamble, sync word, length and CRC around the payload, phyDr in kbps
+        return ( 8 * ( 5 + 3 + 1 + ( uint32_t )pktLen + 2 ) + phyDr - 1 ) / phyDr;
+    }
+
+    tSymbolUs = RegionCommonComputeSymbolTimeLoRa( phyDr, bandwidth );
+    if( tSymbolUs >= 16384 )
+    {
+        lowDatarateOptimize = 2;
+    }
+    nbPayloadBlocks = ( ( 8 * ( int32_t )pktLen ) - ( 4 * phyDr ) + 28 + 16 + ( 4 * ( phyDr - lowDatarateOptimize ) ) - 1 ) /
+                      ( 4 * ( phyDr - lowDatarateOptimize ) );
+    nbPayloadBlocks = MAX( nbPayloadBlocks, 0 );
+
+    // 8 symbols preamble plus 4.25 sync symbols, 8 header symbols and 5 symbols per block at 4/5
+    return ( ( ( 49 * tSymbolUs ) / 4 ) + ( ( 8 + ( 5 * nbPayloadBlocks ) ) * tSymbolUs ) + 999 ) / 1000;
 }
 
-int8_t RegionCommonComputeTxPower( int8_t txPowerIndex, float maxEirp, float antennaGain )
+void RegionCommonComputeRxWindowParameters( uint32_t tSymbolUs, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset )
 {
-    int8_t phyTxPower = 0;
+    // Computed number of symbols, ceil( ( ( 2 * minRxSymbols - 8 ) * tSymbol + 2 * rxError ) / tSymbol )
+    int32_t nbSymbols = ( ( 2 * ( int32_t )minRxSymbols ) - 8 ) + DivCeil( ( int32_t )( 2000 * rxError ), ( int32_t )tSymbolUs );
 
-    phyTxPower = ( int8_t )floor( ( maxEirp - ( txPowerIndex * 2U ) ) - antennaGain );
+    *windowTimeout = MAX( ( uint32_t )MAX( nbSymbols, 0 ), minRxSymbols );
+    // ceil( ( 4 * tSymbol ) - ( ( windowTimeout * tSymbol ) / 2 ) - wakeUpTime ) in us, computed in half us
+    *windowOffset = DivCeil( ( int32_t )( 8 * tSymbolUs ) - ( int32_t )( *windowTimeout * tSymbolUs ) - ( int32_t )( 2000 * wakeUpTime ), 2 );
+}
 
+int8_t RegionCommonComputeTxPower( int8_t txPowerIndex, float maxEirp, float antennaGain )
+{
+    float txPower = ( maxEirp - ( txPowerIndex * 2U ) ) - antennaGain;
+    int8_t phyTxPower = ( int8_t )txPower;
+
+    // Round towards minus infinity
+    if( phyTxPower > txPower )
+    {
+        phyTxPower--;
+    }
     return phyTxPower;
 }
 
@@ -394,35 +489,38 @@ void RegionCommonCountNbOfEnabledChannels( RegionCommonCountNbOfEnabledChannelsP
 
     for( uint8_t i = 0, k = 0; i < countNbOfEnabledChannelsParams->MaxNbChannels; i += 16, k++ )
     {
-        for( uint8_t j = 0; j < 16; j++ )
+        uint16_t mask = countNbOfEnabledChannelsParams->ChannelsMask[k];
+
+        if( ( countNbOfEnabledChannelsParams->Joined == false ) &&
+            ( countNbOfEnabledChannelsParams->JoinChannels > 0 ) )
+        { // Only the join channels are eligible
+            mask &= countNbOfEnabledChannelsParams->JoinChannels;
+        }
+
+        // Visit the set bits only
+        while( mask != 0 )
         {
-            if( ( countNbOfEnabledChannelsParams->ChannelsMask[k] & ( 1 << j ) ) != 0 )
-            {
-                if( countNbOfEnabledChannelsParams->Channels[i + j].Frequency == 0 )
-                { // Check if the channel is enabled
-                    continue;
-                }
-                if( ( countNbOfEnabledChannelsParams->Joined == false ) &&
-                    ( countNbOfEnabledChannelsParams->JoinChannels > 0 ) )
-                {
-                    if( ( countNbOfEnabledChannelsParams->JoinChannels & ( 1 << j ) ) == 0 )
-                    {
-                        continue;
-                    }
-                }
-                if( RegionCommonValueInRange( countNbOfEnabledChannelsParams->Datarate,
-                                              countNbOfEnabledChannelsParams->Channels[i + j].DrRange.Fields.Min,
-                                              countNbOfEnabledChannelsParams->Channels[i + j].DrRange.Fields.Max ) == false )
-                { // Check if the current channel selection supports the given datarate
-                    continue;
-                }
-                if( countNbOfEnabledChannelsParams->Bands[countNbOfEnabledChannelsParams->Channels[i + j].Band].TimeOff > 0 )
-                { // Check if the band is available for transmission
-                    nbRestrictedChannelsCount++;
-                    continue;
-                }
-                enabledChannels[nbChannelCount++] = i + j;
+            uint8_t j = LowestChannel( mask );
+            ChannelParams_t* channel = &countNbOfEnabledChannelsParams->Channels[i + j];
+
+            mask &= mask - 1;
+
+            if( channel->Frequency == 0 )
+            { // Check if the channel is enabled
+                continue;
+            }
+            if( RegionCommonValueInRange( countNbOfEnabledChannelsParams->Datarate,
+                                          channel->DrRange.Fields.Min,
+                                          channel->DrRange.Fields.Max ) == false )
+            { // Check if the current channel selection supports the given datarate
+                continue;
             }
+            if( countNbOfEnabledChannelsParams->Bands[channel->Band].TimeOff > 0 )
+            { // Check if the band is available for transmission
+                nbRestrictedChannelsCount++;
+                continue;
+            }
+            enabledChannels[nbChannelCount++] = i + j;
         }
     }
     *nbEnabledChannels = nbChannelCount;
@@ -468,3 +566,395 @@ LoRaMacStatus_t RegionCommonIdentifyChannels( RegionCommonIdentifyChannelsParam_
         return LORAMAC_STATUS_NO_CHANNEL_FOUND;
     }
 }
+
+uint8_t RegionCommonSelectChannel( NextChanParams_t* nextChanParams, uint8_t* channels, uint8_t nbChannels )
+{
+    uint32_t totalWeight = 0;
+    int32_t draw;
+
+    if( ( nextChanParams->AvoidChannel != REGION_CHANNEL_NONE ) && ( nbChannels > 1 ) )
+    {
+        for( uint8_t i = 0; i < nbChannels; i++ )
+        {
+            if( channels[i] == nextChanParams->AvoidChannel )
+            {
+                channels[i] = channels[nbChannels - 1];
+                nbChannels--;
+                break;
+            }
+        }
+    }
+
+    if( nextChanParams->ChannelStats == NULL )
+    {
+        return channels[randr( 0, nbChannels - 1 )];
+    }
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        totalWeight += ChannelWeight( nextChanParams, channels[i] );
+    }
+    draw = randr( 0, ( int32_t )totalWeight - 1 );
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        draw -= ChannelWeight( nextChanParams, channels[i] );
+        if( draw < 0 )
+        {
+            return channels[i];
+        }
+    }
+    return channels[nbChannels - 1];
+}
+
+uint8_t RegionCommonAvoidSubBand( NextChanParams_t* nextChanParams, uint8_t* channels, uint8_t nbChannels, uint8_t subBandSize )
+{
+    uint8_t subBand;
+    uint8_t nbRemaining = 0;
+
+    if( nextChanParams->AvoidChannel == REGION_CHANNEL_NONE )
+    {
+        return nbChannels;
+    }
+    subBand = nextChanParams->AvoidChannel / subBandSize;
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        if( ( channels[i] / subBandSize ) != subBand )
+        {
+            nbRemaining++;
+        }
+    }
+    if( nbRemaining == 0 )
+    {
+        return nbChannels;
+    }
+
+    // Keeps the order of the remaining channels
+    nbRemaining = 0;
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        if( ( channels[i] / subBandSize ) != subBand )
+        {
+            channels[nbRemaining++] = channels[i];
+        }
+    }
+    return nbRemaining;
+}
+
+void RegionCommonChanMasksBuild( RegionCommonChanMasks_t* chanMasks, ChannelParams_t* channels, uint8_t nbChannels,
+                                 int8_t minDr, int8_t maxDr )
+{
+    if( ( maxDr - minDr ) >= REGION_COMMON_CHANNELS_MASK_MAX_DR )
+    {
+        maxDr = minDr + REGION_COMMON_CHANNELS_MASK_MAX_DR - 1;
+    }
+    chanMasks->Size = ( nbChannels + 15 ) / 16;
+    chanMasks->MinDr = minDr;
+    chanMasks->MaxDr = maxDr;
+    memset1( ( uint8_t* )chanMasks->Defined, 0, sizeof( chanMasks->Defined ) );
+    memset1( ( uint8_t* )chanMasks->Dr, 0, sizeof( chanMasks->Dr ) );
+
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        uint16_t bit = 1 << ( i % 16 );
+
+        if( channels[i].Frequency == 0 )
+        {
+            continue;
+        }
+        chanMasks->Defined[i / 16] |= bit;
+
+        for( int8_t dr = minDr; dr <= maxDr; dr++ )
+        {
+            if( RegionCommonValueInRange( dr, channels[i].DrRange.Fields.Min, channels[i].DrRange.Fields.Max ) == 1 )
+            {
+                chanMasks->Dr[dr - minDr][i / 16] |= bit;
+            }
+        }
+    }
+}
+
+void RegionCommonChanMaskFill( uint16_t* channelsMask, uint8_t startIdx, uint8_t stopIdx, uint16_t value )
+{
+    for( uint8_t i = startIdx; i < stopIdx; i++ )
+    {
+        channelsMask[i] = value;
+    }
+}
+
+bool RegionCommonChanMaskIsDefined( RegionCommonChanMasks_t* chanMasks, uint8_t chMaskCntl, uint16_t chMask )
+{
+    if( chMaskCntl >= chanMasks->Size )
+    {
+        return chMask == 0;
+    }
+    return ( chMask & ~chanMasks->Defined[chMaskCntl] ) == 0;
+}
+
+LoRaMacStatus_t RegionCommonIdentifyChannelsMask( RegionCommonIdentifyChannelsParam_t* identifyChannelsParam,
+                                                  RegionCommonChanMasks_t* chanMasks, TimerTime_t* aggregatedTimeOff,
+                                                  uint16_t* enabledMask, uint8_t* nbEnabledChannels,
+                                                  TimerTime_t* nextTxDelay )
+{
+    RegionCommonCountNbOfEnabledChannelsParams_t* countParams = identifyChannelsParam->CountNbOfEnabledChannelsParam;
+    TimerTime_t elapsed = TimerGetElapsedTime( identifyChannelsParam->LastAggrTx );
+    uint8_t nbRestrictedChannels = 1;
+
+    *nextTxDelay = identifyChannelsParam->AggrTimeOff - elapsed;
+    *nbEnabledChannels = 0;
+    RegionCommonChanMaskFill( enabledMask, 0, chanMasks->Size, 0 );
+
+    if( ( identifyChannelsParam->LastAggrTx == 0 ) ||
+        ( identifyChannelsParam->AggrTimeOff <= elapsed ) )
+    {
+        // Reset Aggregated time off
+        *aggregatedTimeOff = 0;
+
+        // Update bands Time OFF
+        *nextTxDelay = RegionCommonUpdateBandTimeOff( countParams->Joined, identifyChannelsParam->DutyCycleEnabled,
+                                                      countParams->Bands, identifyChannelsParam->MaxBands );
+
+        nbRestrictedChannels = 0;
+        if( RegionCommonValueInRange( countParams->Datarate, chanMasks->MinDr, chanMasks->MaxDr ) == 1 )
+        {
+            uint16_t* drMask = chanMasks->Dr[countParams->Datarate - chanMasks->MinDr];
+
+            for( uint8_t k = 0; k < chanMasks->Size; k++ )
+            {
+                uint16_t mask = countParams->ChannelsMask[k] & drMask[k];
+
+                if( ( countParams->Joined == false ) && ( countParams->JoinChannels > 0 ) )
+                { // Only the join channels are eligible
+                    mask &= countParams->JoinChannels;
+                }
+
+                if( identifyChannelsParam->MaxBands == 1 )
+                { // A single band, all the channels share its time off
+                    if( countParams->Bands[0].TimeOff > 0 )
+                    {
+                        nbRestrictedChannels += CountChannels( mask );
+                        mask = 0;
+                    }
+                }
+                else
+                {
+                    uint16_t pending = mask;
+
+                    while( pending != 0 )
+                    {
+                        uint8_t j = LowestChannel( pending );
+
+                        pending &= pending - 1;
+                        if( countParams->Bands[countParams->Channels[k * 16 + j].Band].TimeOff > 0 )
+                        { // Check if the band is available for transmission
+                            nbRestrictedChannels++;
+                            mask &= ~( 1 << j );
+                        }
+                    }
+                }
+                enabledMask[k] = mask;
+                *nbEnabledChannels += CountChannels( mask );
+            }
+        }
+    }
+
+    if( *nbEnabledChannels > 0 )
+    {
+        return LORAMAC_STATUS_OK;
+    }
+    else if( nbRestrictedChannels > 0 )
+    {
+        return LORAMAC_STATUS_DUTYCYCLE_RESTRICTED;
+    }
+    else
+    {
+        return LORAMAC_STATUS_NO_CHANNEL_FOUND;
+    }
+}
+
+uint8_t RegionCommonChanMaskSelect( uint16_t* channelsMask, uint8_t size, uint8_t rank )
+{
+    for( uint8_t k = 0; k < size; k++ )
+    {
+        uint8_t count = CountChannels( channelsMask[k] );
+
+        if( rank < count )
+        {
+            uint16_t mask = channelsMask[k];
+
+            // Skip the whole low byte when the rank is above it
+            count = CountChannels( mask & 0x00FF );
+            if( rank >= count )
+            {
+                mask &= 0xFF00;
+                rank -= count;
+            }
+            while( rank-- > 0 )
+            {
+                mask &= mask - 1;
+            }
+            return ( k * 16 ) + LowestChannel( mask );
+        }
+        rank -= count;
+    }
+    return 0;
+}
+
+uint8_t RegionCommonSelectChannelMask( NextChanParams_t* nextChanParams, uint16_t* channelsMask, uint8_t size,
+                                       uint8_t nbChannels, uint8_t subBandSize )
+{
+    uint8_t avoid = nextChanParams->AvoidChannel;
+    uint8_t moved = REGION_CHANNEL_NONE;
+    uint8_t skip = REGION_CHANNEL_NONE;
+    uint8_t channel = 0;
+    uint32_t totalWeight = 0;
+    int32_t draw;
+
+    if( ( avoid != REGION_CHANNEL_NONE ) && ( avoid < ( size * 16 ) ) && ( nbChannels > 1 ) )
+    {
+        if( subBandSize > 0 )
+        {
+            uint16_t subBandMask[REGION_COMMON_CHANNELS_MASK_MAX_SIZE];
+            uint8_t start = ( avoid / subBandSize ) * subBandSize;
+            uint8_t nbSubBand = 0;
+
+            RegionCommonChanMaskFill( subBandMask, 0, size, 0 );
+            for( uint8_t i = start; ( i < ( start + subBandSize ) ) && ( i < ( size * 16 ) ); i++ )
+            {
+                subBandMask[i / 16] |= 1 << ( i % 16 );
+            }
+            for( uint8_t k = 0; k < size; k++ )
+            {
+                subBandMask[k] &= channelsMask[k];
+                nbSubBand += CountChannels( subBandMask[k] );
+            }
+            // Drop the sub-band only when an other one is available
+            if( nbSubBand < nbChannels )
+            {
+                for( uint8_t k = 0; k < size; k++ )
+                {
+                    channelsMask[k] &= ~subBandMask[k];
+                }
+                nbChannels -= nbSubBand;
+            }
+        }
+        if( ( ( channelsMask[avoid / 16] & ( 1 << ( avoid % 16 ) ) ) != 0 ) && ( nbChannels > 1 ) )
+        {
+            channelsMask[avoid / 16] &= ~( 1 << ( avoid % 16 ) );
+            nbChannels--;
+
+            // RegionCommonSelectChannel moves the last channel of the list into
+            // the slot of the avoided one. Keep its order so that a given draw
+            // selects the same channel.
+            moved = RegionCommonChanMaskSelect( channelsMask, size, nbChannels - 1 );
+            if( moved < avoid )
+            {
+                moved = REGION_CHANNEL_NONE;
+            }
+        }
+    }
+
+    if( nextChanParams->ChannelStats == NULL )
+    {
+        uint8_t rank = randr( 0, nbChannels - 1 );
+
+        if( moved != REGION_CHANNEL_NONE )
+        {
+            // Rank of the slot of the avoided channel
+            uint8_t slot = CountChannels( channelsMask[avoid / 16] & ( ( 1 << ( avoid % 16 ) ) - 1 ) );
+
+            for( uint8_t k = 0; k < ( avoid / 16 ); k++ )
+            {
+                slot += CountChannels( channelsMask[k] );
+            }
+            if( rank == slot )
+            {
+                return moved;
+            }
+            if( rank > slot )
+            {
+                rank--;
+            }
+        }
+        return RegionCommonChanMaskSelect( channelsMask, size, rank );
+    }
+
+    for( uint8_t k = 0; k < size; k++ )
+    {
+        for( uint16_t mask = channelsMask[k]; mask != 0; mask &= mask - 1 )
+        {
+            totalWeight += ChannelWeight( nextChanParams, ( k * 16 ) + LowestChannel( mask ) );
+        }
+    }
+    draw = randr( 0, ( int32_t )totalWeight - 1 );
+    for( uint8_t k = 0; k < size; k++ )
+    {
+        for( uint16_t mask = channelsMask[k]; mask != 0; mask &= mask - 1 )
+        {
+            uint8_t next = ( k * 16 ) + LowestChannel( mask );
+
+            if( ( moved != REGION_CHANNEL_NONE ) && ( next > avoid ) )
+            {
+                // The moved channel takes the slot of the avoided one
+                channel = moved;
+                draw -= ChannelWeight( nextChanParams, channel );
+                if( draw < 0 )
+                {
+                    return channel;
+                }
+                skip = moved;
+                moved = REGION_CHANNEL_NONE;
+            }
+            if( next == skip )
+            {
+                // Already visited in the slot of the avoided channel
+                continue;
+            }
+            channel = next;
+            draw -= ChannelWeight( nextChanParams, channel );
+            if( draw < 0 )
+            {
+                return channel;
+            }
+        }
+    }
+    return channel;
+}
+
+void RegionCommonLbtSortChannels( uint8_t* channels, uint8_t nbChannels, const uint8_t* busyHistory )
+{
+    uint8_t candidates[16];
+    uint8_t start;
+
+    if( ( nbChannels < 2 ) || ( nbChannels > sizeof( candidates ) ) )
+    {
+        return;
+    }
+
+    // Random rotation, so that the channels of the same occupancy are not always probed in the same order
+    start = randr( 0, nbChannels - 1 );
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        candidates[i] = channels[( start + i ) % nbChannels];
+    }
+
+    // Stable insertion sort on the number of busy carrier senses
+    for( uint8_t i = 0; i < nbChannels; i++ )
+    {
+        uint8_t channel = candidates[i];
+        uint8_t busy = CountChannels( busyHistory[channel] );
+        uint8_t j = i;
+
+        while( ( j > 0 ) && ( CountChannels( busyHistory[channels[j - 1]] ) > busy ) )
+        {
+            channels[j] = channels[j - 1];
+            j--;
+        }
+        channels[j] = channel;
+    }
+}
+
+void RegionCommonLbtSetChannelBusy( uint8_t* busyHistory, uint8_t channel, bool busy )
+{
+    busyHistory[channel] = ( uint8_t )( busyHistory[channel] << 1 ) | ( ( busy == true ) ? 1 : 0 );
+}
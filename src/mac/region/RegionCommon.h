@@ -45,6 +45,14 @@ extern "C"
 #include "LoRaMacTypes.h"
 #include "region/Region.h"
 
+/*!
+ * Minimum weight of a channel of the weighted channel selection. The best
+ * channel, weight 224, is drawn at most 7 times as often as the worst one.
+ */
+#ifndef REGION_COMMON_CHANNEL_MIN_WEIGHT
+#define REGION_COMMON_CHANNEL_MIN_WEIGHT            32
+#endif
+
 typedef struct sRegionCommonLinkAdrParams
 {
     /*!
@@ -261,6 +269,46 @@ typedef struct sRegionCommonIdentifyChannelsParam
     RegionCommonCountNbOfEnabledChannelsParams_t* CountNbOfEnabledChannelsParam;
 }RegionCommonIdentifyChannelsParam_t;
 
+/*!
+ * Maximum number of 16 bit words of a channels mask of the channel masks
+ * engine, 96 channels
+ */
+#define REGION_COMMON_CHANNELS_MASK_MAX_SIZE        6
+
+/*!
+ * Maximum number of TX datarates of the channel masks engine
+ */
+#define REGION_COMMON_CHANNELS_MASK_MAX_DR          8
+
+/*!
+ * Channel masks of a channel plan, precomputed from the channels. To be
+ * rebuilt with \ref RegionCommonChanMasksBuild whenever a channel changes.
+ */
+typedef struct sRegionCommonChanMasks
+{
+    /*!
+     * Number of 16 bit words of the masks.
+     */
+    uint8_t Size;
+    /*!
+     * Lowest datarate of the DR masks.
+     */
+    int8_t MinDr;
+    /*!
+     * Highest datarate of the DR masks.
+     */
+    int8_t MaxDr;
+    /*!
+     * Channels with a frequency.
+     */
+    uint16_t Defined[REGION_COMMON_CHANNELS_MASK_MAX_SIZE];
+    /*!
+     * Channels with a frequency supporting the datarate, indexed by
+     * datarate - MinDr.
+     */
+    uint16_t Dr[REGION_COMMON_CHANNELS_MASK_MAX_DR][REGION_COMMON_CHANNELS_MASK_MAX_SIZE];
+}RegionCommonChanMasks_t;
+
 /*!
  * \brief Calculates the join duty cycle.
  *        This is a generic function and valid for all regions.
@@ -271,6 +319,15 @@ typedef struct sRegionCommonIdentifyChannelsParam
  */
 uint16_t RegionCommonGetJoinDc( SysTime_t elapsedTime );
 
+/*!
+ * \brief Gets the time left before the join duty cycle changes.
+ *
+ * \param [IN] elapsedTime Elapsed time since the start of the device.
+ *
+ * \retval Time left in s, 0 when the duty cycle does not change anymore.
+ */
+uint32_t RegionCommonGetJoinDcChange( SysTime_t elapsedTime );
+
 /*!
  * \brief Verifies, if a value is in a given range.
  *        This is a generic function and valid for all regions.
@@ -358,10 +415,27 @@ void RegionCommonChanMaskCopy( uint16_t* channelsMaskDest, uint16_t* channelsMas
  */
 void RegionCommonSetBandTxDone( bool joined, Band_t* band, TimerTime_t lastTxDone );
 
+/*!
+ * \brief Gets the time which must be waited before the band is available
+ *        again. Clears the band time-off once it has expired.
+ *        This is a generic function and valid for all regions.
+ *
+ * \param [IN] joined Set to true, if the node has joined the network
+ *
+ * \param [IN] dutyCycle Set to true, if the duty cycle is enabled.
+ *
+ * \param [IN] band A pointer to the band.
+ *
+ * \retval Returns the time until the band is available, 0 if available now.
+ */
+TimerTime_t RegionCommonGetBandNextTxDelay( bool joined, bool dutyCycle, Band_t* band );
+
 /*!
  * \brief Updates the time-offs of the bands.
  *        This is a generic function and valid for all regions.
  *
+ * \remark Only the bands with a pending time-off query the elapsed time.
+ *
  * \param [IN] joined Set to true, if the node has joined the network
  *
  * \param [IN] dutyCycle Set to true, if the duty cycle is enabled.
@@ -411,9 +485,9 @@ uint8_t RegionCommonLinkAdrReqVerifyParams( RegionCommonLinkAdrReqVerifyParams_t
  *
  * \param [IN] bandwidth Bandwidth to use.
  *
- * \retval Returns the symbol time.
+ * \retval Returns the symbol time in us.
  */
-double RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth );
+uint32_t RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth );
 
 /*!
  * \brief Computes the symbol time for FSK modulation.
@@ -422,14 +496,34 @@ double RegionCommonComputeSymbolTimeLoRa( uint8_t phyDr, uint32_t bandwidth );
  *
  * \param [IN] bandwidth Bandwidth to use.
  *
- * \retval Returns the symbol time.
+ * \retval Returns the symbol time in us.
  */
-double RegionCommonComputeSymbolTimeFsk( uint8_t phyDr );
+uint32_t RegionCommonComputeSymbolTimeFsk( uint8_t phyDr );
+
+/*!
+ * \brief Computes the time-on-air of an uplink frame with the radio settings
+ *        used by the regions TxConfig functions. LoRa: coding rate 4/5,
+ *        8 symbols preamble, explicit header and CRC on. FSK: 5 bytes preamble,
+ *        3 bytes sync word, variable length and CRC on.
+ *
+ * \param [IN] phyDr Physical datarate, the spreading factor for LoRa or the
+ *                   bitrate in kbps for FSK.
+ *
+ * \param [IN] bandwidth Bandwidth in Hz. 0 selects FSK.
+ *
+ * \param [IN] pktLen Physical payload length.
+ *
+ * \retval Returns the time-on-air in ms, 0 for an unsupported datarate.
+ */
+TimerTime_t RegionCommonComputeTxTimeOnAir( uint8_t phyDr, uint32_t bandwidth, uint8_t pktLen );
 
 /*!
  * \brief Computes the RX window timeout and the RX window offset.
  *
- * \param [IN] tSymbol Symbol timeout.
+ * \remark Integer only. The results are exact, they match the former floating
+ *         point implementation for all the LoRa datarates.
+ *
+ * \param [IN] tSymbolUs Symbol time in us.
  *
  * \param [IN] minRxSymbols Minimum required number of symbols to detect an Rx frame.
  *
@@ -440,9 +534,9 @@ double RegionCommonComputeSymbolTimeFsk( uint8_t phyDr );
  *
  * \param [OUT] windowTimeout RX window timeout.
  *
- * \param [OUT] windowOffset RX window time offset to be applied to the RX delay.
+ * \param [OUT] windowOffset RX window time offset to be applied to the RX delay, in microseconds.
  */
-void RegionCommonComputeRxWindowParameters( double tSymbol, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset );
+void RegionCommonComputeRxWindowParameters( uint32_t tSymbolUs, uint8_t minRxSymbols, uint32_t rxError, uint32_t wakeUpTime, uint32_t* windowTimeout, int32_t* windowOffset );
 
 /*!
  * \brief Computes the txPower, based on the max EIRP and the antenna gain.
@@ -517,6 +611,178 @@ LoRaMacStatus_t RegionCommonIdentifyChannels( RegionCommonIdentifyChannelsParam_
                                               uint8_t* nbEnabledChannels, uint8_t* nbRestrictedChannels,
                                               TimerTime_t* nextTxDelay );
 
+/*!
+ * \brief Orders the candidate channels of a listen before talk procedure.
+ *        The channels with the fewest busy carrier senses in their history
+ *        come first, channels of the same occupancy keep a random order.
+ *
+ * \param [IN/OUT] channels A pointer to the candidate channels.
+ *
+ * \param [IN] nbChannels The number of candidate channels.
+ *
+ * \param [IN] busyHistory A pointer to the busy history of all channels,
+ *                         indexed by the channel id.
+ */
+void RegionCommonLbtSortChannels( uint8_t* channels, uint8_t nbChannels, const uint8_t* busyHistory );
+
+/*!
+ * \brief Selects the channel of the next transmission among the candidates.
+ *        The channel to avoid is dropped when an other one is available. The
+ *        channels are drawn with a probability proportional to
+ *        128 + delivery score, at least REGION_COMMON_CHANNEL_MIN_WEIGHT,
+ *        uniformly when no statistics are given. The candidates are the
+ *        channels allowed by the duty cycle.
+ *
+ * \param [IN] nextChanParams A pointer to the parameters of RegionNextChannel.
+ *
+ * \param [IN/OUT] channels A pointer to the candidate channels.
+ *
+ * \param [IN] nbChannels The number of candidate channels, at least one.
+ *
+ * \retval The selected channel.
+ */
+uint8_t RegionCommonSelectChannel( NextChanParams_t* nextChanParams, uint8_t* channels, uint8_t nbChannels );
+
+/*!
+ * \brief Drops from the candidate channels the sub-band of the channel to
+ *        avoid, when a channel of an other sub-band is available.
+ *
+ * \param [IN] nextChanParams A pointer to the parameters of RegionNextChannel.
+ *
+ * \param [IN/OUT] channels A pointer to the candidate channels.
+ *
+ * \param [IN] nbChannels The number of candidate channels.
+ *
+ * \param [IN] subBandSize The number of channels of a sub-band.
+ *
+ * \retval The number of remaining candidate channels.
+ */
+uint8_t RegionCommonAvoidSubBand( NextChanParams_t* nextChanParams, uint8_t* channels, uint8_t nbChannels, uint8_t subBandSize );
+
+/*!
+ * \brief Computes the defined and the per datarate channel masks of a
+ *        channel plan.
+ *
+ * \param [OUT] chanMasks A pointer to the channel masks.
+ *
+ * \param [IN] channels A pointer to the channels.
+ *
+ * \param [IN] nbChannels The number of channels, at most 16 times
+ *                        REGION_COMMON_CHANNELS_MASK_MAX_SIZE.
+ *
+ * \param [IN] minDr The lowest TX datarate.
+ *
+ * \param [IN] maxDr The highest TX datarate, at most
+ *                   minDr + REGION_COMMON_CHANNELS_MASK_MAX_DR - 1.
+ */
+void RegionCommonChanMasksBuild( RegionCommonChanMasks_t* chanMasks, ChannelParams_t* channels, uint8_t nbChannels,
+                                 int8_t minDr, int8_t maxDr );
+
+/*!
+ * \brief Sets a range of channels mask words to the same value.
+ *
+ * \param [OUT] channelsMask A pointer to the channels mask.
+ *
+ * \param [IN] startIdx The index of the first word.
+ *
+ * \param [IN] stopIdx The index after the last word.
+ *
+ * \param [IN] value The value of the words.
+ */
+void RegionCommonChanMaskFill( uint16_t* channelsMask, uint8_t startIdx, uint8_t stopIdx, uint16_t value );
+
+/*!
+ * \brief Verifies that a ChMask enables defined channels only.
+ *
+ * \param [IN] chanMasks A pointer to the channel masks.
+ *
+ * \param [IN] chMaskCntl The index of the channels mask word.
+ *
+ * \param [IN] chMask The channels mask word.
+ *
+ * \retval Returns true, if all the enabled channels have a frequency.
+ */
+bool RegionCommonChanMaskIsDefined( RegionCommonChanMasks_t* chanMasks, uint8_t chMaskCntl, uint16_t chMask );
+
+/*!
+ * \brief Identifies all channels which are available currently, as a mask.
+ *        Same as \ref RegionCommonIdentifyChannels, the datarate and band
+ *        checks are done one mask word at a time.
+ *
+ * \remark The MaxNbChannels field of the
+ *         CountNbOfEnabledChannelsParam is not used. The Channels are only
+ *         read with more than one band.
+ *
+ * \param [IN] identifyChannelsParam A pointer to the input parameters.
+ *
+ * \param [IN] chanMasks A pointer to the channel masks of the channel plan.
+ *
+ * \param [OUT] aggregatedTimeOff The new value of the aggregatedTimeOff. The function
+ *                                may resets it to 0.
+ *
+ * \param [OUT] enabledMask A pointer to a mask of chanMasks->Size words,
+ *                          the available channels.
+ *
+ * \param [OUT] nbEnabledChannels The number of available channels found.
+ *
+ * \param [OUT] nextTxDelay Holds the time which has to be waited for the next possible
+ *                          uplink transmission.
+ *
+ *\retval Status of the operation.
+ */
+LoRaMacStatus_t RegionCommonIdentifyChannelsMask( RegionCommonIdentifyChannelsParam_t* identifyChannelsParam,
+                                                  RegionCommonChanMasks_t* chanMasks, TimerTime_t* aggregatedTimeOff,
+                                                  uint16_t* enabledMask, uint8_t* nbEnabledChannels,
+                                                  TimerTime_t* nextTxDelay );
+
+/*!
+ * \brief Returns the channel of the given rank among the set bits of a
+ *        channels mask.
+ *
+ * \param [IN] channelsMask A pointer to the channels mask.
+ *
+ * \param [IN] size The number of words of the channels mask.
+ *
+ * \param [IN] rank The rank, lower than the number of set bits.
+ *
+ * \retval The channel id.
+ */
+uint8_t RegionCommonChanMaskSelect( uint16_t* channelsMask, uint8_t size, uint8_t rank );
+
+/*!
+ * \brief Selects the channel of the next transmission among the channels of
+ *        a mask. Same selection as \ref RegionCommonAvoidSubBand followed by
+ *        \ref RegionCommonSelectChannel, without a channel list. The uniform
+ *        draw picks the channel by its rank.
+ *
+ * \param [IN] nextChanParams A pointer to the parameters of RegionNextChannel.
+ *
+ * \param [IN/OUT] channelsMask A pointer to the candidate channels mask.
+ *
+ * \param [IN] size The number of words of the channels mask.
+ *
+ * \param [IN] nbChannels The number of candidate channels, at least one.
+ *
+ * \param [IN] subBandSize The number of channels of a sub-band, 0 avoids
+ *                         the channel only.
+ *
+ * \retval The selected channel.
+ */
+uint8_t RegionCommonSelectChannelMask( NextChanParams_t* nextChanParams, uint16_t* channelsMask, uint8_t size,
+                                       uint8_t nbChannels, uint8_t subBandSize );
+
+/*!
+ * \brief Records the result of a carrier sense. The history holds the
+ *        outcome of the last 8 carrier senses of the channel.
+ *
+ * \param [IN/OUT] busyHistory A pointer to the busy history of all channels.
+ *
+ * \param [IN] channel The channel id.
+ *
+ * \param [IN] busy Set to true, if the channel was found busy.
+ */
+void RegionCommonLbtSetChannelBusy( uint8_t* busyHistory, uint8_t channel, bool busy );
+
 /*! \} defgroup REGIONCOMMON */
 
 #ifdef __cplusplus
@@ -59,10 +59,51 @@ typedef struct sRegionEU433NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionEU433NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionEU433Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionEU433NvmCtx_t NvmCtx;
+}RegionEU433Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionEU433Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionEU433Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionEU433NvmCtx_t NvmCtx;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionEU433PhyConsts =
+{
+    .MinRxDr = { EU433_RX_MIN_DATARATE, EU433_RX_MIN_DATARATE },
+    .MinTxDr = { EU433_TX_MIN_DATARATE, EU433_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateEU433, MaxPayloadOfDatarateEU433 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterEU433, MaxPayloadOfDatarateRepeaterEU433 },
+    .MaxFCntGap = EU433_MAX_FCNT_GAP,
+    .DefRx2Frequency = EU433_RX_WND_2_FREQ,
+    .DefRx2Dr = EU433_RX_WND_2_DR,
+    .Datarates = DataratesEU433,
+    .NbDatarates = sizeof( DataratesEU433 ),
+};
 
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
@@ -250,6 +291,16 @@ PhyParam_t RegionEU433GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = EU433_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -333,9 +384,9 @@ void RegionEU433InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -360,6 +411,8 @@ void RegionEU433InitDefaults( InitDefaultsParams_t* params )
 void* RegionEU433GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionEU433NvmCtx_t );
+    params->nvmCtxNbChannels = EU433_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = EU433_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -479,7 +532,7 @@ bool RegionEU433ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionEU433ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, EU433_RX_MAX_DATARATE );
@@ -487,14 +540,14 @@ void RegionEU433ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols
 
     if( rxConfigParams->Datarate == DR_7 )
     { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesEU433[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeFsk( DataratesEU433[rxConfigParams->Datarate] );
     }
     else
     { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesEU433[rxConfigParams->Datarate], BandwidthsEU433[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesEU433[rxConfigParams->Datarate], BandwidthsEU433[rxConfigParams->Datarate] );
     }
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionEU433RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -861,7 +914,7 @@ LoRaMacStatus_t RegionEU433NextChannel( NextChanParams_t* nextChanParams, uint8_
     if( status == LORAMAC_STATUS_OK )
     {
         // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        *channel = RegionCommonSelectChannel( nextChanParams, enabledChannels, nbEnabledChannels );
     }
     else if( status == LORAMAC_STATUS_NO_CHANNEL_FOUND )
     {
@@ -985,3 +1038,20 @@ void RegionEU433RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = EU433_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionEU433GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesEU433[datarate], BandwidthsEU433[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionEU433GetInstanceSize( void )
+{
+    return sizeof( RegionEU433Instance_t );
+}
+
+void RegionEU433SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionEU433Instance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -288,6 +288,11 @@ static const uint8_t MaxPayloadOfDatarateEU433[] = { 51, 51, 51, 115, 242, 242,
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterEU433[] = { 51, 51, 51, 115, 222, 222, 222, 222 };
 
+/*!
+ * \brief Constant PHY parameters of the region, see \ref RegionGetPhyConsts.
+ */
+extern const RegionPhyConsts_t RegionEU433PhyConsts;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -509,6 +514,33 @@ uint8_t RegionEU433ApplyDrOffset( uint8_t downlinkDwellTime, int8_t dr, int8_t d
  */
  void RegionEU433RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
 
+/*!
+ * \brief Computes the time-on-air of an uplink frame
+ *
+ * \param [IN] datarate Uplink datarate.
+ *
+ * \param [IN] pktLen Physical payload length.
+ *
+ * \retval Returns the time-on-air in ms.
+ */
+TimerTime_t RegionEU433GetTxTimeOnAir( int8_t datarate, uint8_t pktLen );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t RegionEU433GetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void RegionEU433SelectInstance( void* instance );
+#endif
+
 /*! \} defgroup REGIONEU433 */
 
 #ifdef __cplusplus
@@ -59,10 +59,51 @@ typedef struct sRegionEU868NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionEU868NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionEU868Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionEU868NvmCtx_t NvmCtx;
+}RegionEU868Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionEU868Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionEU868Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionEU868NvmCtx_t NvmCtx;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionEU868PhyConsts =
+{
+    .MinRxDr = { EU868_RX_MIN_DATARATE, EU868_RX_MIN_DATARATE },
+    .MinTxDr = { EU868_TX_MIN_DATARATE, EU868_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateEU868, MaxPayloadOfDatarateEU868 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterEU868, MaxPayloadOfDatarateRepeaterEU868 },
+    .MaxFCntGap = EU868_MAX_FCNT_GAP,
+    .DefRx2Frequency = EU868_RX_WND_2_FREQ,
+    .DefRx2Dr = EU868_RX_WND_2_DR,
+    .Datarates = DataratesEU868,
+    .NbDatarates = sizeof( DataratesEU868 ),
+};
 
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
@@ -275,6 +316,16 @@ PhyParam_t RegionEU868GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = EU868_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -363,9 +414,9 @@ void RegionEU868InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -390,6 +441,8 @@ void RegionEU868InitDefaults( InitDefaultsParams_t* params )
 void* RegionEU868GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionEU868NvmCtx_t );
+    params->nvmCtxNbChannels = EU868_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = EU868_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -510,7 +563,7 @@ bool RegionEU868ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionEU868ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, EU868_RX_MAX_DATARATE );
@@ -518,14 +571,14 @@ void RegionEU868ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols
 
     if( rxConfigParams->Datarate == DR_7 )
     { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesEU868[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeFsk( DataratesEU868[rxConfigParams->Datarate] );
     }
     else
     { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesEU868[rxConfigParams->Datarate], BandwidthsEU868[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesEU868[rxConfigParams->Datarate], BandwidthsEU868[rxConfigParams->Datarate] );
     }
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionEU868RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -895,7 +948,7 @@ LoRaMacStatus_t RegionEU868NextChannel( NextChanParams_t* nextChanParams, uint8_
     if( status == LORAMAC_STATUS_OK )
     {
         // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        *channel = RegionCommonSelectChannel( nextChanParams, enabledChannels, nbEnabledChannels );
     }
     else if( status == LORAMAC_STATUS_NO_CHANNEL_FOUND )
     {
@@ -1020,3 +1073,20 @@ void RegionEU868RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = EU868_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionEU868GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesEU868[datarate], BandwidthsEU868[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionEU868GetInstanceSize( void )
+{
+    return sizeof( RegionEU868Instance_t );
+}
+
+void RegionEU868SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionEU868Instance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -59,10 +59,51 @@ typedef struct sRegionIN865NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionIN865NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionIN865Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionIN865NvmCtx_t NvmCtx;
+}RegionIN865Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionIN865Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionIN865Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionIN865NvmCtx_t NvmCtx;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionIN865PhyConsts =
+{
+    .MinRxDr = { IN865_RX_MIN_DATARATE, IN865_RX_MIN_DATARATE },
+    .MinTxDr = { IN865_TX_MIN_DATARATE, IN865_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateIN865, MaxPayloadOfDatarateIN865 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterIN865, MaxPayloadOfDatarateRepeaterIN865 },
+    .MaxFCntGap = IN865_MAX_FCNT_GAP,
+    .DefRx2Frequency = IN865_RX_WND_2_FREQ,
+    .DefRx2Dr = IN865_RX_WND_2_DR,
+    .Datarates = DataratesIN865,
+    .NbDatarates = sizeof( DataratesIN865 ),
+};
 
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
@@ -254,6 +295,16 @@ PhyParam_t RegionIN865GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = IN865_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -336,9 +387,9 @@ void RegionIN865InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -363,6 +414,8 @@ void RegionIN865InitDefaults( InitDefaultsParams_t* params )
 void* RegionIN865GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionIN865NvmCtx_t );
+    params->nvmCtxNbChannels = IN865_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = IN865_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -496,7 +549,7 @@ bool RegionIN865ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionIN865ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, IN865_RX_MAX_DATARATE );
@@ -504,14 +557,14 @@ void RegionIN865ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols
 
     if( rxConfigParams->Datarate == DR_7 )
     { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesIN865[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeFsk( DataratesIN865[rxConfigParams->Datarate] );
     }
     else
     { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesIN865[rxConfigParams->Datarate], BandwidthsIN865[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesIN865[rxConfigParams->Datarate], BandwidthsIN865[rxConfigParams->Datarate] );
     }
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionIN865RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -885,7 +938,7 @@ LoRaMacStatus_t RegionIN865NextChannel( NextChanParams_t* nextChanParams, uint8_
     if( status == LORAMAC_STATUS_OK )
     {
         // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        *channel = RegionCommonSelectChannel( nextChanParams, enabledChannels, nbEnabledChannels );
     }
     else if( status == LORAMAC_STATUS_NO_CHANNEL_FOUND )
     {
@@ -1004,3 +1057,20 @@ void RegionIN865RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = IN865_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionIN865GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesIN865[datarate], BandwidthsIN865[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionIN865GetInstanceSize( void )
+{
+    return sizeof( RegionIN865Instance_t );
+}
+
+void RegionIN865SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionIN865Instance_t* )instance : &DefaultInstance;
+}
+#endif
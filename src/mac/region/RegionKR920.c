@@ -59,11 +59,62 @@ typedef struct sRegionKR920NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionKR920NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionKR920Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionKR920NvmCtx_t NvmCtx;
+    /*!
+     * Busy history of the listen before talk carrier senses, per channel
+     */
+    uint8_t ChannelsBusyHistory[KR920_MAX_NB_CHANNELS];
+}RegionKR920Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionKR920Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionKR920Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#define ChannelsBusyHistory                         ( SelectedInstance->ChannelsBusyHistory )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionKR920NvmCtx_t NvmCtx;
 
+/*
+ * Busy history of the listen before talk carrier senses, per channel.
+ */
+static uint8_t ChannelsBusyHistory[KR920_MAX_NB_CHANNELS];
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionKR920PhyConsts =
+{
+    .MinRxDr = { KR920_RX_MIN_DATARATE, KR920_RX_MIN_DATARATE },
+    .MinTxDr = { KR920_TX_MIN_DATARATE, KR920_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateKR920, MaxPayloadOfDatarateKR920 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterKR920, MaxPayloadOfDatarateRepeaterKR920 },
+    .MaxFCntGap = KR920_MAX_FCNT_GAP,
+    .DefRx2Frequency = KR920_RX_WND_2_FREQ,
+    .DefRx2Dr = KR920_RX_WND_2_DR,
+    .Datarates = DataratesKR920,
+    .NbDatarates = sizeof( DataratesKR920 ),
+};
+
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
 {
@@ -269,6 +320,16 @@ PhyParam_t RegionKR920GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = KR920_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -311,6 +372,11 @@ PhyParam_t RegionKR920GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Value = KR920_PING_SLOT_CHANNEL_DR;
             break;
         }
+        case PHY_LBT_BUSY_HISTORY:
+        {
+            phyParam.BusyHistory = ChannelsBusyHistory;
+            break;
+        }
         default:
         {
             break;
@@ -356,9 +422,9 @@ void RegionKR920InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -383,6 +449,8 @@ void RegionKR920InitDefaults( InitDefaultsParams_t* params )
 void* RegionKR920GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionKR920NvmCtx_t );
+    params->nvmCtxNbChannels = KR920_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = KR920_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -502,15 +570,15 @@ bool RegionKR920ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionKR920ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, KR920_RX_MAX_DATARATE );
     rxConfigParams->Bandwidth = GetBandwidth( rxConfigParams->Datarate );
 
-    tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesKR920[rxConfigParams->Datarate], BandwidthsKR920[rxConfigParams->Datarate] );
+    tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesKR920[rxConfigParams->Datarate], BandwidthsKR920[rxConfigParams->Datarate] );
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionKR920RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -854,7 +922,10 @@ LoRaMacStatus_t RegionKR920NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     if( status == LORAMAC_STATUS_OK )
     {
-        for( uint8_t  i = 0, j = randr( 0, nbEnabledChannels - 1 ); i < KR920_MAX_NB_CHANNELS; i++ )
+        // Probe the least occupied channels first
+        RegionCommonLbtSortChannels( enabledChannels, nbEnabledChannels, ChannelsBusyHistory );
+
+        for( uint8_t  i = 0, j = 0; i < KR920_MAX_NB_CHANNELS; i++ )
         {
             channelNext = enabledChannels[j];
             j = ( j + 1 ) % nbEnabledChannels;
@@ -863,10 +934,12 @@ LoRaMacStatus_t RegionKR920NextChannel( NextChanParams_t* nextChanParams, uint8_
             // If the channel is free, we can stop the LBT mechanism
             if( Radio.IsChannelFree( MODEM_LORA, NvmCtx.Channels[channelNext].Frequency, KR920_RSSI_FREE_TH, KR920_CARRIER_SENSE_TIME ) == true )
             {
+                RegionCommonLbtSetChannelBusy( ChannelsBusyHistory, channelNext, false );
                 // Free channel found
                 *channel = channelNext;
                 return LORAMAC_STATUS_OK;
             }
+            RegionCommonLbtSetChannelBusy( ChannelsBusyHistory, channelNext, true );
         }
         // Even if one or more channels are available according to the channel plan, no free channel
         // was found during the LBT procedure.
@@ -999,3 +1072,20 @@ void RegionKR920RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = KR920_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionKR920GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesKR920[datarate], BandwidthsKR920[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionKR920GetInstanceSize( void )
+{
+    return sizeof( RegionKR920Instance_t );
+}
+
+void RegionKR920SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionKR920Instance_t* )instance : &DefaultInstance;
+}
+#endif
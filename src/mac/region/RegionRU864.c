@@ -59,10 +59,51 @@ typedef struct sRegionRU864NvmCtx
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
 }RegionRU864NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionRU864Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionRU864NvmCtx_t NvmCtx;
+}RegionRU864Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionRU864Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionRU864Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionRU864NvmCtx_t NvmCtx;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionRU864PhyConsts =
+{
+    .MinRxDr = { RU864_RX_MIN_DATARATE, RU864_RX_MIN_DATARATE },
+    .MinTxDr = { RU864_TX_MIN_DATARATE, RU864_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateRU864, MaxPayloadOfDatarateRU864 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterRU864, MaxPayloadOfDatarateRepeaterRU864 },
+    .MaxFCntGap = RU864_MAX_FCNT_GAP,
+    .DefRx2Frequency = RU864_RX_WND_2_FREQ,
+    .DefRx2Dr = RU864_RX_WND_2_DR,
+    .Datarates = DataratesRU864,
+    .NbDatarates = sizeof( DataratesRU864 ),
+};
 
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
@@ -251,6 +292,16 @@ PhyParam_t RegionRU864GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = RU864_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -327,9 +378,9 @@ void RegionRU864InitDefaults( InitDefaultsParams_t* params )
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
             break;
         }
@@ -353,6 +404,8 @@ void RegionRU864InitDefaults( InitDefaultsParams_t* params )
 void* RegionRU864GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionRU864NvmCtx_t );
+    params->nvmCtxNbChannels = RU864_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = RU864_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -472,7 +525,7 @@ bool RegionRU864ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionRU864ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, RU864_RX_MAX_DATARATE );
@@ -480,14 +533,14 @@ void RegionRU864ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols
 
     if( rxConfigParams->Datarate == DR_7 )
     { // FSK
-        tSymbol = RegionCommonComputeSymbolTimeFsk( DataratesRU864[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeFsk( DataratesRU864[rxConfigParams->Datarate] );
     }
     else
     { // LoRa
-        tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesRU864[rxConfigParams->Datarate], BandwidthsRU864[rxConfigParams->Datarate] );
+        tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesRU864[rxConfigParams->Datarate], BandwidthsRU864[rxConfigParams->Datarate] );
     }
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionRU864RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -855,7 +908,7 @@ LoRaMacStatus_t RegionRU864NextChannel( NextChanParams_t* nextChanParams, uint8_
     if( status == LORAMAC_STATUS_OK )
     {
         // We found a valid channel
-        *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+        *channel = RegionCommonSelectChannel( nextChanParams, enabledChannels, nbEnabledChannels );
     }
     else if( status == LORAMAC_STATUS_NO_CHANNEL_FOUND )
     {
@@ -979,3 +1032,20 @@ void RegionRU864RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = RU864_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionRU864GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesRU864[datarate], BandwidthsRU864[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionRU864GetInstanceSize( void )
+{
+    return sizeof( RegionRU864Instance_t );
+}
+
+void RegionRU864SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionRU864Instance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -65,20 +65,79 @@ typedef struct sRegionUS915NvmCtx
      */
     uint16_t ChannelsDefaultMask[ CHANNELS_MASK_SIZE ];
     /*!
-     * Index of current in use 8 bit group (0: bit 0 - 7, 1: bit 8 - 15, ..., 7: bit 56 - 63)
+     * Position of the next 8 bit group in the join sweep, see \ref GetJoinChannelGroup
      */
     uint8_t JoinChannelGroupsCurrentIndex;
+    /*!
+     * Sub-band of the last successful join, 0xFF if unknown
+     */
+    uint8_t JoinSubBand;
+    /*!
+     * Channel of the last join request, 0xFF once the device joined
+     */
+    uint8_t LastJoinChannel;
     /*!
      * Counter of join trials needed to alternate between DR0 and DR4, see \ref RegionUS915AlternateDr
      */
     uint8_t JoinTrialsCounter;
 }RegionUS915NvmCtx_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sRegionUS915Instance
+{
+    /*!
+     * Non-volatile module context
+     */
+    RegionUS915NvmCtx_t NvmCtx;
+    /*!
+     * Channel masks of the channel plan
+     */
+    RegionCommonChanMasks_t ChanMasks;
+}RegionUS915Instance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static RegionUS915Instance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static RegionUS915Instance_t* SelectedInstance = &DefaultInstance;
+
+#define NvmCtx                                      ( SelectedInstance->NvmCtx )
+#define ChanMasks                                   ( SelectedInstance->ChanMasks )
+#else
 /*
  * Non-volatile module context.
  */
 static RegionUS915NvmCtx_t NvmCtx;
 
+/*
+ * Channel masks of the channel plan, rebuilt when the channels change.
+ */
+static RegionCommonChanMasks_t ChanMasks;
+#endif
+
+/*
+ * Constant PHY parameters.
+ */
+const RegionPhyConsts_t RegionUS915PhyConsts =
+{
+    .MinRxDr = { US915_RX_MIN_DATARATE, US915_RX_MIN_DATARATE },
+    .MinTxDr = { US915_TX_MIN_DATARATE, US915_TX_MIN_DATARATE },
+    .MaxPayload = { MaxPayloadOfDatarateUS915, MaxPayloadOfDatarateUS915 },
+    .MaxPayloadRepeater = { MaxPayloadOfDatarateRepeaterUS915, MaxPayloadOfDatarateRepeaterUS915 },
+    .MaxFCntGap = US915_MAX_FCNT_GAP,
+    .DefRx2Frequency = US915_RX_WND_2_FREQ,
+    .DefRx2Dr = US915_RX_WND_2_DR,
+    .Datarates = DataratesUS915,
+    .NbDatarates = sizeof( DataratesUS915 ),
+};
+
 // Static functions
 static int8_t GetNextLowerTxDr( int8_t dr, int8_t minDr )
 {
@@ -131,6 +190,68 @@ static LoRaMacStatus_t FindAvailable125kHzChannels( uint8_t* findAvailableChanne
     return LORAMAC_STATUS_OK;
 }
 
+/*!
+ * \brief Gets the 8 bit channel group probed at a position of the join sweep.
+ *        The sweep starts with the sub-band of the last successful join, follows
+ *        with the US915_JOIN_PREFERRED_SUB_BANDS ones and ends with the others.
+ *
+ * \param [IN] position Position in the sweep, 0 to 7.
+ *
+ * \retval Group index (0: bit 0 - 7, 1: bit 8 - 15, ..., 7: bit 56 - 63)
+ */
+static uint8_t GetJoinChannelGroup( uint8_t position )
+{
+    uint8_t order[8];
+    uint8_t nbGroups = 0;
+
+    if( NvmCtx.JoinSubBand < 8 )
+    {
+        order[nbGroups++] = NvmCtx.JoinSubBand;
+    }
+    for( uint8_t i = 0; i < 8; i++ )
+    {
+        if( ( i != NvmCtx.JoinSubBand ) && ( ( US915_JOIN_PREFERRED_SUB_BANDS & ( 1 << i ) ) != 0 ) )
+        {
+            order[nbGroups++] = i;
+        }
+    }
+    for( uint8_t i = 0; i < 8; i++ )
+    {
+        if( ( i != NvmCtx.JoinSubBand ) && ( ( US915_JOIN_PREFERRED_SUB_BANDS & ( 1 << i ) ) == 0 ) )
+        {
+            order[nbGroups++] = i;
+        }
+    }
+    return order[position];
+}
+
+/*!
+ * \brief Learns the sub-band of the join request which got accepted.
+ *
+ * \remark Called on the first channel selection after the join.
+ */
+static void LearnJoinSubBand( void )
+{
+    uint8_t subBand;
+
+    if( NvmCtx.LastJoinChannel >= US915_MAX_NB_CHANNELS )
+    {
+        return;
+    }
+    // The 500 kHz channel 64 + i overlaps the sub-band i
+    subBand = ( NvmCtx.LastJoinChannel < 64 ) ? ( NvmCtx.LastJoinChannel / 8 ) : ( NvmCtx.LastJoinChannel - 64 );
+    NvmCtx.JoinSubBand = subBand;
+    NvmCtx.LastJoinChannel = 0xFF;
+
+#if ( US915_JOINED_SUB_BAND_ONLY == 1 )
+    // Hop on the join sub-band only, the network may still change it with a LinkAdrReq
+    memset1( ( uint8_t* )NvmCtx.ChannelsMask, 0, sizeof( NvmCtx.ChannelsMask ) );
+    NvmCtx.ChannelsMask[subBand / 2] = 0x00FF << ( 8 * ( subBand % 2 ) );
+    NvmCtx.ChannelsMask[4] = 1 << subBand;
+    RegionCommonChanMaskCopy( NvmCtx.ChannelsMaskRemaining, NvmCtx.ChannelsMask, 6 );
+#endif
+}
+
 /*!
  * \brief Computes the next 125kHz channel used for join requests.
  *
@@ -145,6 +266,7 @@ static LoRaMacStatus_t ComputeNext125kHzJoinChannel( uint8_t* newChannelIndex )
     uint8_t findAvailableChannelsIndex[8] = { 0 };
     uint8_t availableChannels = 0;
     uint8_t startIndex = NvmCtx.JoinChannelGroupsCurrentIndex;
+    uint8_t group;
 
     // Null pointer check
     if( newChannelIndex == NULL )
@@ -153,11 +275,13 @@ static LoRaMacStatus_t ComputeNext125kHzJoinChannel( uint8_t* newChannelIndex )
     }
 
     do {
+        group = GetJoinChannelGroup( startIndex );
+
         // Current ChannelMaskRemaining, two groups per channel mask. For example Group 0 and 1 (8 bit) are ChannelMaskRemaining 0 (16 bit), etc.
-        currentChannelsMaskRemainingIndex = (uint8_t) startIndex / 2;
+        currentChannelsMaskRemainingIndex = group / 2;
 
         // For even numbers we need the 8 LSBs and for uneven the 8 MSBs
-        if( ( startIndex % 2 ) == 0 )
+        if( ( group % 2 ) == 0 )
         {
             channelMaskRemaining = ( NvmCtx.ChannelsMaskRemaining[currentChannelsMaskRemainingIndex] & 0x00FF );
         }
@@ -175,7 +299,7 @@ static LoRaMacStatus_t ComputeNext125kHzJoinChannel( uint8_t* newChannelIndex )
         if ( availableChannels > 0 )
         {
             // Choose randomly a free channel 125kHz
-            *newChannelIndex = ( startIndex * 8 ) + findAvailableChannelsIndex[randr( 0, ( availableChannels - 1 ) )];
+            *newChannelIndex = ( group * 8 ) + findAvailableChannelsIndex[randr( 0, ( availableChannels - 1 ) )];
         }
 
         // Increment start index
@@ -385,6 +509,16 @@ PhyParam_t RegionUS915GetPhyParam( GetPhyParams_t* getPhy )
             phyParam.Channels = NvmCtx.Channels;
             break;
         }
+        case PHY_BANDS:
+        {
+            phyParam.Bands = NvmCtx.Bands;
+            break;
+        }
+        case PHY_MAX_NB_BANDS:
+        {
+            phyParam.Value = US915_MAX_NB_BANDS;
+            break;
+        }
         case PHY_DEF_UPLINK_DWELL_TIME:
         case PHY_DEF_DOWNLINK_DWELL_TIME:
         {
@@ -470,6 +604,10 @@ void RegionUS915InitDefaults( InitDefaultsParams_t* params )
             // Initialize the join trials counter
             NvmCtx.JoinTrialsCounter = 0;
 
+            // No join sub-band learned yet
+            NvmCtx.JoinSubBand = 0xFF;
+            NvmCtx.LastJoinChannel = 0xFF;
+
             // Channels
             // 125 kHz channels
             for( uint8_t i = 0; i < US915_MAX_NB_CHANNELS - 8; i++ )
@@ -499,14 +637,17 @@ void RegionUS915InitDefaults( InitDefaultsParams_t* params )
 
             // Copy into channels mask remaining
             RegionCommonChanMaskCopy( NvmCtx.ChannelsMaskRemaining, NvmCtx.ChannelsMask, 6 );
+
+            RegionCommonChanMasksBuild( &ChanMasks, NvmCtx.Channels, US915_MAX_NB_CHANNELS, US915_TX_MIN_DATARATE, US915_TX_MAX_DATARATE );
             break;
         }
         case INIT_TYPE_RESTORE_CTX:
         {
-            if( params->NvmCtx != 0 )
+            if( params->RestoreCtx != 0 )
             {
-                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->NvmCtx, sizeof( NvmCtx ) );
+                memcpy1( (uint8_t*) &NvmCtx, (uint8_t*) params->RestoreCtx, sizeof( NvmCtx ) );
             }
+            RegionCommonChanMasksBuild( &ChanMasks, NvmCtx.Channels, US915_MAX_NB_CHANNELS, US915_TX_MIN_DATARATE, US915_TX_MAX_DATARATE );
             break;
         }
         case INIT_TYPE_RESTORE_DEFAULT_CHANNELS:
@@ -530,6 +671,8 @@ void RegionUS915InitDefaults( InitDefaultsParams_t* params )
 void* RegionUS915GetNvmCtx( GetNvmCtxParams_t* params )
 {
     params->nvmCtxSize = sizeof( RegionUS915NvmCtx_t );
+    params->nvmCtxNbChannels = US915_MAX_NB_CHANNELS;
+    params->nvmCtxNbBands = US915_MAX_NB_BANDS;
     return &NvmCtx;
 }
 
@@ -635,15 +778,15 @@ bool RegionUS915ChanMaskSet( ChanMaskSetParams_t* chanMaskSet )
 
 void RegionUS915ComputeRxWindowParameters( int8_t datarate, uint8_t minRxSymbols, uint32_t rxError, RxConfigParams_t *rxConfigParams )
 {
-    double tSymbol = 0.0;
+    uint32_t tSymbolUs = 0;
 
     // Get the datarate, perform a boundary check
     rxConfigParams->Datarate = MIN( datarate, US915_RX_MAX_DATARATE );
     rxConfigParams->Bandwidth = GetBandwidth( rxConfigParams->Datarate );
 
-    tSymbol = RegionCommonComputeSymbolTimeLoRa( DataratesUS915[rxConfigParams->Datarate], BandwidthsUS915[rxConfigParams->Datarate] );
+    tSymbolUs = RegionCommonComputeSymbolTimeLoRa( DataratesUS915[rxConfigParams->Datarate], BandwidthsUS915[rxConfigParams->Datarate] );
 
-    RegionCommonComputeRxWindowParameters( tSymbol, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
+    RegionCommonComputeRxWindowParameters( tSymbolUs, minRxSymbols, rxError, Radio.GetWakeupTime( ), &rxConfigParams->WindowTimeout, &rxConfigParams->WindowOffset );
 }
 
 bool RegionUS915RxConfig( RxConfigParams_t* rxConfig, int8_t* datarate )
@@ -740,20 +883,14 @@ uint8_t RegionUS915LinkAdrReq( LinkAdrReqParams_t* linkAdrReq, int8_t* drOut, in
         if( linkAdrParams.ChMaskCtrl == 6 )
         {
             // Enable all 125 kHz channels
-            channelsMask[0] = 0xFFFF;
-            channelsMask[1] = 0xFFFF;
-            channelsMask[2] = 0xFFFF;
-            channelsMask[3] = 0xFFFF;
+            RegionCommonChanMaskFill( channelsMask, 0, 4, 0xFFFF );
             // Apply chMask to channels 64 to 71
             channelsMask[4] = linkAdrParams.ChMask & CHANNELS_MASK_500KHZ_MASK;
         }
         else if( linkAdrParams.ChMaskCtrl == 7 )
         {
             // Disable all 125 kHz channels
-            channelsMask[0] = 0x0000;
-            channelsMask[1] = 0x0000;
-            channelsMask[2] = 0x0000;
-            channelsMask[3] = 0x0000;
+            RegionCommonChanMaskFill( channelsMask, 0, 4, 0x0000 );
             // Apply chMask to channels 64 to 71
             channelsMask[4] = linkAdrParams.ChMask & CHANNELS_MASK_500KHZ_MASK;
         }
@@ -961,13 +1098,17 @@ void RegionUS915CalcBackOff( CalcBackOffParams_t* calcBackOff )
 LoRaMacStatus_t RegionUS915NextChannel( NextChanParams_t* nextChanParams, uint8_t* channel, TimerTime_t* time, TimerTime_t* aggregatedTimeOff )
 {
     uint8_t nbEnabledChannels = 0;
-    uint8_t nbRestrictedChannels = 0;
-    uint8_t enabledChannels[US915_MAX_NB_CHANNELS] = { 0 };
+    uint16_t enabledMask[REGION_COMMON_CHANNELS_MASK_MAX_SIZE];
     uint8_t newChannelIndex = 0;
     RegionCommonIdentifyChannelsParam_t identifyChannelsParam;
     RegionCommonCountNbOfEnabledChannelsParams_t countChannelsParams;
     LoRaMacStatus_t status = LORAMAC_STATUS_NO_CHANNEL_FOUND;
 
+    if( nextChanParams->Joined == true )
+    {
+        LearnJoinSubBand( );
+    }
+
     // Count 125kHz channels
     if( RegionCommonCountChannels( NvmCtx.ChannelsMaskRemaining, 0, 4 ) == 0 )
     { // Reactivate default channels
@@ -1000,8 +1141,8 @@ LoRaMacStatus_t RegionUS915NextChannel( NextChanParams_t* nextChanParams, uint8_
 
     identifyChannelsParam.CountNbOfEnabledChannelsParam = &countChannelsParams;
 
-    status = RegionCommonIdentifyChannels( &identifyChannelsParam, aggregatedTimeOff, enabledChannels,
-                                           &nbEnabledChannels, &nbRestrictedChannels, time );
+    status = RegionCommonIdentifyChannelsMask( &identifyChannelsParam, &ChanMasks, aggregatedTimeOff, enabledMask,
+                                               &nbEnabledChannels, time );
 
     if( nextChanParams->QueryNextTxDelayOnly == true )
     {
@@ -1012,8 +1153,9 @@ LoRaMacStatus_t RegionUS915NextChannel( NextChanParams_t* nextChanParams, uint8_
     {
         if( nextChanParams->Joined == true )
         {
-            // Choose randomly on of the remaining channels
-            *channel = enabledChannels[randr( 0, nbEnabledChannels - 1 )];
+            // Choose randomly on of the remaining channels, preferably in an
+            // other sub-band than the previous try
+            *channel = RegionCommonSelectChannelMask( nextChanParams, enabledMask, ChanMasks.Size, nbEnabledChannels, 8 );
         }
         else
         {
@@ -1034,14 +1176,19 @@ LoRaMacStatus_t RegionUS915NextChannel( NextChanParams_t* nextChanParams, uint8_
             // 500kHz Channels (64 - 71) DR4
             else
             {
-                // Choose the next available channel
+                // Choose the channel of the learned sub-band, the next available one otherwise
                 uint8_t i = 0;
+                if( ( NvmCtx.JoinSubBand < 8 ) && ( ( NvmCtx.ChannelsMaskRemaining[4] & ( 1 << NvmCtx.JoinSubBand ) ) != 0 ) )
+                {
+                    i = NvmCtx.JoinSubBand;
+                }
                 while( ( ( NvmCtx.ChannelsMaskRemaining[4] & CHANNELS_MASK_500KHZ_MASK ) & ( 1 << i ) ) == 0 )
                 {
                     i++;
                 }
                 *channel = 64 + i;
             }
+            NvmCtx.LastJoinChannel = *channel;
         }
 
         // Disable the channel in the mask
@@ -1100,3 +1247,20 @@ void RegionUS915RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr )
     // Store downlink datarate
     *outDr = US915_BEACON_CHANNEL_DR;
 }
+
+TimerTime_t RegionUS915GetTxTimeOnAir( int8_t datarate, uint8_t pktLen )
+{
+    return RegionCommonComputeTxTimeOnAir( DataratesUS915[datarate], BandwidthsUS915[datarate], pktLen );
+}
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t RegionUS915GetInstanceSize( void )
+{
+    return sizeof( RegionUS915Instance_t );
+}
+
+void RegionUS915SelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( RegionUS915Instance_t* )instance : &DefaultInstance;
+}
+#endif
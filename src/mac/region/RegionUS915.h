@@ -248,6 +248,23 @@ extern "C"
  */
 #define US915_STEPWIDTH_RX1_CHANNEL                 ( (uint32_t) 600000 )
 
+/*!
+ * Sub-bands probed first by the join requests, after the sub-band of the last
+ * successful join. Bit i selects the 125 kHz channels 8 * i to 8 * i + 7 and
+ * the 500 kHz channel 64 + i. Can be provided by the deployment build.
+ */
+#ifndef US915_JOIN_PREFERRED_SUB_BANDS
+#define US915_JOIN_PREFERRED_SUB_BANDS              0x00
+#endif
+
+/*!
+ * When set to 1 the channels mask is restricted to the sub-band of the join
+ * accept once joined, until the network changes it.
+ */
+#ifndef US915_JOINED_SUB_BAND_ONLY
+#define US915_JOINED_SUB_BAND_ONLY                  0
+#endif
+
 /*!
  * Data rates table definition
  */
@@ -280,6 +297,11 @@ static const uint8_t MaxPayloadOfDatarateUS915[] = { 11, 53, 125, 242, 242, 0, 0
  */
 static const uint8_t MaxPayloadOfDatarateRepeaterUS915[] = { 11, 53, 125, 242, 242, 0, 0, 0, 33, 109, 222, 222, 222, 222, 0, 0 };
 
+/*!
+ * \brief Constant PHY parameters of the region, see \ref RegionGetPhyConsts.
+ */
+extern const RegionPhyConsts_t RegionUS915PhyConsts;
+
 /*!
  * \brief The function gets a value of a specific phy attribute.
  *
@@ -503,6 +525,33 @@ uint8_t RegionUS915ApplyDrOffset( uint8_t downlinkDwellTime, int8_t dr, int8_t d
  */
  void RegionUS915RxBeaconSetup( RxBeaconSetup_t* rxBeaconSetup, uint8_t* outDr );
 
+/*!
+ * \brief Computes the time-on-air of an uplink frame
+ *
+ * \param [IN] datarate Uplink datarate.
+ *
+ * \param [IN] pktLen Physical payload length.
+ *
+ * \retval Returns the time-on-air in ms.
+ */
+TimerTime_t RegionUS915GetTxTimeOnAir( int8_t datarate, uint8_t pktLen );
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t RegionUS915GetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void RegionUS915SelectInstance( void* instance );
+#endif
+
 /*! \} defgroup REGIONUS915 */
 
 #ifdef __cplusplus
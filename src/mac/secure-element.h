@@ -83,6 +83,25 @@ typedef enum eSecureElementStatus
     SECURE_ELEMENT_ERROR,
 }SecureElementStatus_t;
 
+/*!
+ * Key derivation of a SecureElementDeriveAndStoreKeys batch
+ */
+typedef struct sSecureElementKeyDerivation
+{
+    /*!
+     * Input data from which the key is derived ( 16 byte )
+     */
+    uint8_t* Input;
+    /*!
+     * Key identifier of the root key to use to perform the derivation
+     */
+    KeyIdentifier_t RootKeyID;
+    /*!
+     * Key identifier of the key which will be derived
+     */
+    KeyIdentifier_t TargetKeyID;
+}SecureElementKeyDerivation_t;
+
 /*!
  * Signature of callback function to be called by the Secure Element driver when the
  * non volatile context have to be stored.
@@ -158,6 +177,36 @@ SecureElementStatus_t SecureElementVerifyAesCmac( uint8_t* buffer, uint16_t size
  */
 SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, KeyIdentifier_t keyID, uint8_t* encBuffer );
 
+/*!
+ * Encrypts or decrypts a part of a message in AES-CTR mode and computes the
+ * CMAC of the whole message in a single pass. The CMAC is always computed
+ * over the ciphered form of the message.
+ *
+ *  cmac = aes128_cmac(micKeyID, Bx | msg)
+ *
+ * \param[IN]  micBxBuffer    - Buffer containing the initial Bx block
+ * \param[IN]  buffer         - Message buffer
+ * \param[IN]  size           - Message size
+ * \param[IN]  micKeyID       - Key identifier to determine the CMAC key to be used
+ * \param[IN]  aBlock         - Initial counter block. The counter byte aBlock[15]
+ *                              is ignored, the counters start at 1
+ * \param[IN]  encOffset      - Offset of the part to be ciphered in buffer
+ * \param[IN]  encSize        - Size of the part to be ciphered, may be 0
+ * \param[IN]  encKeyID       - Key identifier to determine the AES key to be used
+ * \param[IN]  keystream      - Precomputed key stream of the ciphered part, may be NULL
+ * \param[IN]  keystreamSize  - Precomputed key stream size, multiple of 16. The
+ *                              key stream of the remaining part is computed
+ * \param[IN]  encrypt        - true: the part is plain and gets encrypted,
+ *                              false: the part is ciphered and gets decrypted
+ * \param[OUT] encBuffer      - Output of the ciphered part, may be &buffer[encOffset]
+ * \param[OUT] cmac           - Computed cmac
+ * \retval                    - Status of the operation
+ */
+SecureElementStatus_t SecureElementAesCtrCmac( uint8_t* micBxBuffer, uint8_t* buffer, uint16_t size, KeyIdentifier_t micKeyID,
+                                               uint8_t* aBlock, uint16_t encOffset, uint16_t encSize, KeyIdentifier_t encKeyID,
+                                               const uint8_t* keystream, uint16_t keystreamSize,
+                                               bool encrypt, uint8_t* encBuffer, uint32_t* cmac );
+
 /*!
  * Derives and store a key
  *
@@ -169,6 +218,21 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
  */
 SecureElementStatus_t SecureElementDeriveAndStoreKey( Version_t version, uint8_t* input, KeyIdentifier_t rootKeyID, KeyIdentifier_t targetKeyID );
 
+/*!
+ * Derives and stores several keys in the given order, a derived key may be
+ * the root key of the following derivations. The non volatile context
+ * change is notified once for the whole batch.
+ *
+ * Unlike SecureElementSetKey, a derived McKey is stored as is. It has to be
+ * derived from the McKEKey, which decrypts it.
+ *
+ * \param[IN]  version        - LoRaWAN specification version currently in use.
+ * \param[IN]  derivations    - Key derivations
+ * \param[IN]  nbDerivations  - Number of key derivations
+ * \retval                    - Status of the operation
+ */
+SecureElementStatus_t SecureElementDeriveAndStoreKeys( Version_t version, SecureElementKeyDerivation_t* derivations, uint8_t nbDerivations );
+
 /*!
  * Generates a random number
  *
@@ -207,6 +271,22 @@ SecureElementStatus_t SecureElementSetJoinEui( uint8_t* joinEui );
  */
 uint8_t* SecureElementGetJoinEui( void );
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * \brief   Returns the size of the module instance block
+ *
+ * \retval  Size of the block in bytes
+ */
+size_t SecureElementGetInstanceSize( void );
+
+/*!
+ * \brief   Selects the module instance block of a LoRaMac instance
+ *
+ * \param   [IN] instance - Zero initialized block, NULL selects the default one
+ */
+void SecureElementSelectInstance( void* instance );
+#endif
+
 /*! \} defgroup SECUREELEMENT */
 
 #ifdef __cplusplus
@@ -22,11 +22,62 @@
  */
 #include <stdlib.h>
 #include <stdbool.h>
+#include "utilities.h"
 #include "gpio-ioe.h"
 #include "sx1509.h"
 
 static Gpio_t *GpioIrq[16];
 
+/*!
+ * First and number of the expander registers kept in the RAM shadow, from
+ * RegOpenDrainB up to RegSenseLowA
+ */
+#define IOE_SHADOW_FIRST_REG                        RegOpenDrainB
+#define IOE_SHADOW_SIZE                             ( RegSenseLowA - RegOpenDrainB + 1 )
+
+/*!
+ * Shadow of the expander configuration, data and interrupt registers
+ */
+static uint8_t IoeShadow[IOE_SHADOW_SIZE];
+
+/*!
+ * Flag to indicate if the shadow has been loaded from the expander
+ */
+static bool IoeShadowLoaded = false;
+
+/*!
+ * Shadow registers changed since the last commit, one bit per register
+ */
+static uint16_t IoeShadowDirty = 0;
+
+/*!
+ * Nesting level of the GpioIoeBatchBegin calls
+ */
+static uint8_t IoeBatchDepth = 0;
+
+/*!
+ * \brief Gets the shadow value of an expander register
+ *
+ * \param [IN] regAdd Register address
+ * \retval value      Register value
+ */
+static uint8_t GpioIoeGetReg( uint8_t regAdd );
+
+/*!
+ * \brief Sets the shadow value of an expander register. The register is
+ *        written by the next commit when the value changes.
+ *
+ * \param [IN] regAdd Register address
+ * \param [IN] value  Register value
+ */
+static void GpioIoeSetReg( uint8_t regAdd, uint8_t value );
+
+/*!
+ * \brief Writes the changed shadow registers with a single I2C transfer
+ *        unless a batch is open
+ */
+static void GpioIoeCommit( void );
+
 void GpioIoeInit( Gpio_t *obj, PinNames pin, PinModes mode,  PinConfigs config, PinTypes type, uint32_t value )
 {
     uint8_t regAdd = 0;
@@ -35,6 +86,14 @@ void GpioIoeInit( Gpio_t *obj, PinNames pin, PinModes mode,  PinConfigs config,
 
     SX1509Init( );
 
+    if( IoeShadowLoaded == false )
+    {
+        if( SX1509ReadBuffer( IOE_SHADOW_FIRST_REG, IoeShadow, IOE_SHADOW_SIZE ) == SUCCESS )
+        {
+            IoeShadowLoaded = true;
+        }
+    }
+
     obj->pin = pin;
     obj->pinIndex = ( 0x01 << pin % 16 );
 
@@ -49,7 +108,7 @@ void GpioIoeInit( Gpio_t *obj, PinNames pin, PinModes mode,  PinConfigs config,
         obj->pinIndex = ( obj->pinIndex ) & 0x00FF;
     }
 
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     if( mode == PIN_OUTPUT )
     {
@@ -59,37 +118,37 @@ void GpioIoeInit( Gpio_t *obj, PinNames pin, PinModes mode,  PinConfigs config,
     {
         regVal = regVal | obj->pinIndex;
     }
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
 
 
     if( ( obj->pin % 16 ) > 0x07 )
     {
-        SX1509Read( RegOpenDrainB, &tempVal );
+        tempVal = GpioIoeGetReg( RegOpenDrainB );
         if( config == PIN_OPEN_DRAIN )
         {
-            SX1509Write( RegOpenDrainB, tempVal | obj->pinIndex );
+            GpioIoeSetReg( RegOpenDrainB, tempVal | obj->pinIndex );
         }
         else
         {
-            SX1509Write( RegOpenDrainB, tempVal & ~obj->pinIndex );
+            GpioIoeSetReg( RegOpenDrainB, tempVal & ~obj->pinIndex );
         }
         regAdd = RegDataB;
     }
     else
     {
-        SX1509Read( RegOpenDrainA, &tempVal );
+        tempVal = GpioIoeGetReg( RegOpenDrainA );
         if( config == PIN_OPEN_DRAIN )
         {
-            SX1509Write( RegOpenDrainA, tempVal | obj->pinIndex );
+            GpioIoeSetReg( RegOpenDrainA, tempVal | obj->pinIndex );
         }
         else
         {
-            SX1509Write( RegOpenDrainA, tempVal & ~obj->pinIndex );
+            GpioIoeSetReg( RegOpenDrainA, tempVal & ~obj->pinIndex );
         }
         regAdd = RegDataA;
     }
 
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     // Sets initial output value
     if( value == 0 )
@@ -100,7 +159,8 @@ void GpioIoeInit( Gpio_t *obj, PinNames pin, PinModes mode,  PinConfigs config,
     {
         regVal = regVal | obj->pinIndex;
     }
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
+    GpioIoeCommit( );
 }
 
 void GpioIoeSetContext( Gpio_t *obj, void* context )
@@ -132,10 +192,10 @@ void GpioIoeSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriori
         regAdd = RegInterruptMaskA;
     }
 
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     regVal = regVal & ~( obj->pinIndex );
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
 
     if( irqMode == IRQ_RISING_EDGE )
     {
@@ -174,7 +234,7 @@ void GpioIoeSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriori
     {
         regAdd = RegSenseHighB;
     }
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     switch( i )
     {
@@ -206,9 +266,10 @@ void GpioIoeSetInterrupt( Gpio_t *obj, IrqModes irqMode, IrqPriorities irqPriori
             regVal = ( regVal & REG_SENSE_PIN_MASK_4 ) | ( val << 6 );
             break;
     }
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
 
     GpioIrq[obj->pin & 0x0F] = obj;
+    GpioIoeCommit( );
 }
 
 void GpioIoeRemoveInterrupt( Gpio_t *obj )
@@ -230,10 +291,10 @@ void GpioIoeRemoveInterrupt( Gpio_t *obj )
         regAdd = RegInterruptMaskA;
     }
 
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     regVal = regVal | obj->pinIndex;
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
 
     tempVal = 0x0000;
     i = 0;
@@ -259,7 +320,7 @@ void GpioIoeRemoveInterrupt( Gpio_t *obj )
     {
         regAdd = RegSenseHighB;
     }
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     switch( i )
     {
@@ -291,7 +352,8 @@ void GpioIoeRemoveInterrupt( Gpio_t *obj )
             regVal = ( regVal & REG_SENSE_PIN_MASK_4 );
             break;
     }
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
+    GpioIoeCommit( );
 }
 
 void GpioIoeWrite( Gpio_t *obj, uint32_t value )
@@ -308,7 +370,7 @@ void GpioIoeWrite( Gpio_t *obj, uint32_t value )
         regAdd = RegDataA;
     }
 
-    SX1509Read( regAdd, &regVal );
+    regVal = GpioIoeGetReg( regAdd );
 
     // Sets initial output value
     if( value == 0 )
@@ -319,7 +381,8 @@ void GpioIoeWrite( Gpio_t *obj, uint32_t value )
     {
         regVal = regVal | obj->pinIndex;
     }
-    SX1509Write( regAdd, regVal );
+    GpioIoeSetReg( regAdd, regVal );
+    GpioIoeCommit( );
 }
 
 void GpioIoeToggle( Gpio_t *obj )
@@ -341,7 +404,15 @@ uint32_t GpioIoeRead( Gpio_t *obj )
         regAdd = RegDataA;
     }
 
-    SX1509Read( regAdd, &regVal );
+    // The inputs are read from the expander, the outputs from the shadow
+    if( ( GpioIoeGetReg( regAdd - RegDataB + RegDirB ) & obj->pinIndex ) != 0 )
+    {
+        SX1509Read( regAdd, &regVal );
+    }
+    else
+    {
+        regVal = GpioIoeGetReg( regAdd );
+    }
 
     if( ( regVal & obj->pinIndex ) == 0x00 )
     {
@@ -383,3 +454,59 @@ void GpioIoeInterruptHandler( void )
     SX1509Write( RegEventStatusB, 0xFF );
     SX1509Write( RegEventStatusA, 0xFF );
 }
+
+void GpioIoeBatchBegin( void )
+{
+    IoeBatchDepth++;
+}
+
+void GpioIoeBatchEnd( void )
+{
+    if( IoeBatchDepth > 0 )
+    {
+        IoeBatchDepth--;
+    }
+    GpioIoeCommit( );
+}
+
+static uint8_t GpioIoeGetReg( uint8_t regAdd )
+{
+    return IoeShadow[regAdd - IOE_SHADOW_FIRST_REG];
+}
+
+static void GpioIoeSetReg( uint8_t regAdd, uint8_t value )
+{
+    uint8_t index = regAdd - IOE_SHADOW_FIRST_REG;
+
+    if( IoeShadow[index] != value )
+    {
+        IoeShadow[index] = value;
+        IoeShadowDirty |= ( 1 << index );
+    }
+}
+
+static void GpioIoeCommit( void )
+{
+    uint8_t first = 0;
+    uint8_t last = IOE_SHADOW_SIZE - 1;
+
+    if( ( IoeBatchDepth > 0 ) || ( IoeShadowDirty == 0 ) )
+    {
+        return;
+    }
+
+    // The registers auto increment, the unchanged registers between the
+    // first and the last changed ones are written with their current value
+    while( ( IoeShadowDirty & ( 1 << first ) ) == 0 )
+    {
+        first++;
+    }
+    while( ( IoeShadowDirty & ( 1 << last ) ) == 0 )
+    {
+        last--;
+    }
+    if( SX1509WriteBuffer( IOE_SHADOW_FIRST_REG + first, IoeShadow + first, last - first + 1 ) == SUCCESS )
+    {
+        IoeShadowDirty = 0;
+    }
+}
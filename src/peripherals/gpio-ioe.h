@@ -95,6 +95,20 @@ void GpioIoeToggle( Gpio_t *obj );
  */
 uint32_t GpioIoeRead( Gpio_t *obj );
 
+/*!
+ * \brief Defers the expander register writes until \ref GpioIoeBatchEnd
+ *
+ * \remark Calls can be nested, the registers are written by the outermost
+ *         \ref GpioIoeBatchEnd.
+ */
+void GpioIoeBatchBegin( void );
+
+/*!
+ * \brief Writes the expander registers changed since \ref GpioIoeBatchBegin
+ *        with a single I2C transfer
+ */
+void GpioIoeBatchEnd( void );
+
 /*!
  * \brief GpioIoeInterruptHandler callback function.
  */
@@ -21,6 +21,7 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdbool.h>
+#include <stddef.h>
 #include "utilities.h"
 #include "i2c.h"
 #include "mag3110.h"
@@ -30,6 +31,16 @@ extern I2c_t I2c;
 static uint8_t I2cDeviceAddr = 0;
 static bool MAG3110Initialized = false;
 
+/*!
+ * Callback of the measurement in progress, NULL when none
+ */
+static Mag3110ConversionDone_t *MAG3110ConversionDone = NULL;
+
+/*!
+ * Set when the INT1 pin signals the end of the measurement
+ */
+static volatile uint32_t MAG3110DataReady = 0;
+
 uint8_t MAG3110Init( void )
 {
     uint8_t regVal = 0;
@@ -53,7 +64,7 @@ uint8_t MAG3110Init( void )
 
 uint8_t MAG3110Reset( void )
 {
-    if( MAG3110Write( 0x11, 0x10 ) == SUCCESS ) // Reset the MAG3110 with CTRL_REG2
+    if( MAG3110Write( MAG3110_CTRL_REG2, 0x10 ) == SUCCESS ) // Reset the MAG3110 with CTRL_REG2
     {
         return SUCCESS;
     }
@@ -89,3 +100,56 @@ uint8_t MAG3110GetDeviceAddr( void )
 {
     return I2cDeviceAddr;
 }
+
+uint8_t MAG3110StartConversion( Mag3110ConversionDone_t *callback )
+{
+    uint8_t ctrlReg = 0;
+
+    if( MAG3110Initialized == false )
+    {
+        return FAIL;
+    }
+
+    if( MAG3110Read( MAG3110_CTRL_REG1, &ctrlReg ) != SUCCESS )
+    {
+        return FAIL;
+    }
+
+    MAG3110ConversionDone = callback;
+    MAG3110DataReady = 0;
+
+    // Triggered measurement from standby, the sensor returns to standby
+    ctrlReg &= ~MAG3110_AC;
+    return MAG3110Write( MAG3110_CTRL_REG1, ctrlReg | MAG3110_TM );
+}
+
+void MAG3110OnInterrupt( void* context )
+{
+    MAG3110DataReady = 1;
+}
+
+void MAG3110Process( void )
+{
+    // DR_STATUS followed by the X, Y and Z axis samples
+    uint8_t data[7];
+    Mag3110ConversionDone_t *callback = MAG3110ConversionDone;
+
+    if( AtomicExchange( &MAG3110DataReady, 0 ) == 0 )
+    {
+        return;
+    }
+
+    // Reading the samples releases INT1
+    if( MAG3110ReadBuffer( MAG3110_DR_STATUS, data, 7 ) != SUCCESS )
+    {
+        return;
+    }
+
+    MAG3110ConversionDone = NULL;
+    if( ( callback != NULL ) && ( ( data[0] & MAG3110_ZYXDR ) != 0 ) )
+    {
+        callback( ( int16_t )( ( data[1] << 8 ) | data[2] ),
+                  ( int16_t )( ( data[3] << 8 ) | data[4] ),
+                  ( int16_t )( ( data[5] << 8 ) | data[6] ) );
+    }
+}
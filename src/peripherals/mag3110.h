@@ -38,7 +38,27 @@ extern "C"
 /*!
  * MAG3110 Registers
  */
+#define MAG3110_DR_STATUS                               0x00
+#define MAG3110_OUT_X_MSB                               0x01
 #define MAG3110_ID                                      0x07
+#define MAG3110_CTRL_REG1                               0x10
+#define MAG3110_CTRL_REG2                               0x11
+
+/*!
+ * MAG3110 Bit Field
+ */
+#define MAG3110_ZYXDR                                   0x08
+#define MAG3110_TM                                      0x02
+#define MAG3110_AC                                      0x01
+
+/*!
+ * \brief Conversion done callback prototype
+ *
+ * \param [IN] x Magnetic field X axis sample [0.1 uT]
+ * \param [IN] y Magnetic field Y axis sample [0.1 uT]
+ * \param [IN] z Magnetic field Z axis sample [0.1 uT]
+ */
+typedef void ( Mag3110ConversionDone_t )( int16_t x, int16_t y, int16_t z );
 
 /*!
  * \brief Initializes the device
@@ -106,6 +126,32 @@ void MAG3110SetDeviceAddr( uint8_t addr );
  */
 uint8_t MAG3110GetDeviceAddr( void );
 
+/*!
+ * \brief Triggers a single measurement signaled by the sensor INT1 pin
+ *
+ * \remark The sensor stays in standby between the measurements. The board
+ *         must route the INT1 pin rising edge to MAG3110OnInterrupt and the
+ *         application must call MAG3110Process from its main loop.
+ *
+ * \param [IN] callback Function called by MAG3110Process with the results
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t MAG3110StartConversion( Mag3110ConversionDone_t *callback );
+
+/*!
+ * \brief Sensor INT1 pin interrupt handler
+ *
+ * \param [IN] context Not used
+ */
+void MAG3110OnInterrupt( void* context );
+
+/*!
+ * \brief Reads the results of a completed measurement and calls the
+ *        conversion done callback
+ */
+void MAG3110Process( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -185,3 +185,102 @@ void MMA8451OrientDetect( void )
     MMA8451Read( MMA8451_CTRL_REG1, &ctrlReg1 );
     MMA8451Write( MMA8451_CTRL_REG1, ctrlReg1 | 0x01 );
 }
+
+uint8_t MMA8451FifoStart( Mma8451DataRate_t dataRate, uint8_t watermark )
+{
+    uint8_t ctrlReg1 = 0;
+
+    if( ( MMA8451Initialized == false ) || ( watermark == 0 ) || ( watermark > MMA8451_FIFO_SIZE ) )
+    {
+        return FAIL;
+    }
+
+    // Set device in standby mode
+    if( MMA8451Read( MMA8451_CTRL_REG1, &ctrlReg1 ) == FAIL )
+    {
+        return FAIL;
+    }
+    ctrlReg1 &= 0xFE;
+    MMA8451Write( MMA8451_CTRL_REG1, ctrlReg1 );
+
+    // The FIFO must be disabled before changing its mode. Circular mode.
+    MMA8451Write( MMA8451_F_SETUP, 0x00 );
+    MMA8451Write( MMA8451_F_SETUP, 0x40 | ( watermark & 0x3F ) );
+
+    // +/-2 g range
+    MMA8451Write( MMA8451_XYZ_DATA_CFG, 0x00 );
+
+    // Set the data rate, 14 bits samples ( F_READ cleared )
+    ctrlReg1 = ( ctrlReg1 & ~0x3A ) | ( ( ( uint8_t )dataRate & 0x07 ) << 3 );
+    MMA8451Write( MMA8451_CTRL_REG1, ctrlReg1 );
+
+    // Enable the FIFO interrupt only, on pin INT1
+    MMA8451Write( MMA8451_CTRL_REG4, 0x40 );
+    MMA8451Write( MMA8451_CTRL_REG5, 0x40 );
+
+    // Set device in active mode
+    return MMA8451Write( MMA8451_CTRL_REG1, ctrlReg1 | 0x01 );
+}
+
+uint8_t MMA8451FifoStop( void )
+{
+    uint8_t ctrlReg1 = 0;
+
+    if( MMA8451Initialized == false )
+    {
+        return FAIL;
+    }
+
+    // Set device in standby mode and clear the data rate
+    if( MMA8451Read( MMA8451_CTRL_REG1, &ctrlReg1 ) == FAIL )
+    {
+        return FAIL;
+    }
+    MMA8451Write( MMA8451_CTRL_REG1, ctrlReg1 & ~0x39 );
+
+    MMA8451Write( MMA8451_F_SETUP, 0x00 );
+
+    MMA8451OrientDetect( );
+    return SUCCESS;
+}
+
+uint8_t MMA8451FifoRead( int16_t *samples, uint8_t maxCount, uint8_t *count )
+{
+    uint8_t buffer[MMA8451_FIFO_SIZE * 6];
+    uint8_t fStatus = 0;
+    uint8_t n;
+
+    *count = 0;
+
+    if( MMA8451Initialized == false )
+    {
+        return FAIL;
+    }
+
+    // Reading F_STATUS also clears the FIFO interrupt source
+    if( MMA8451Read( MMA8451_STATUS, &fStatus ) == FAIL )
+    {
+        return FAIL;
+    }
+    n = MIN( fStatus & 0x3F, maxCount );
+    if( n == 0 )
+    {
+        return SUCCESS;
+    }
+
+    // In FIFO mode the register address wraps to OUT_X_MSB after OUT_Z_LSB
+    // and the next sample is read.
+    if( MMA8451ReadBuffer( MMA8451_OUT_X_MSB, buffer, n * 6 ) == FAIL )
+    {
+        return FAIL;
+    }
+
+    for( uint16_t i = 0; i < ( n * 3 ); i++ )
+    {
+        // 14 bits left aligned, 4096 counts per g
+        int16_t raw = ( int16_t )( ( buffer[2 * i] << 8 ) | buffer[2 * i + 1] ) >> 2;
+        samples[i] = ( int16_t )( ( ( int32_t )raw * 1000 ) / 4096 );
+    }
+    *count = n;
+    return SUCCESS;
+}
@@ -38,11 +38,13 @@ extern "C"
 /*
  * MMA8451 Registers
  */ 
-#define MMA8451_STATUS                               0x00 //
+#define MMA8451_STATUS                               0x00 // F_STATUS when the FIFO is enabled
 #define MMA8451_OUT_X_MSB                            0x01 //
+#define MMA8451_F_SETUP                              0x09 // FIFO mode and watermark
 #define MMA8451_SYSMOD                               0x0B //
 #define MMA8451_INT_SOURCE                           0x0C //
 #define MMA8451_ID                                   0x0D //
+#define MMA8451_XYZ_DATA_CFG                         0x0E // Full scale range
 #define MMA8451_PL_STATUS                            0x10 //
 #define MMA8451_PL_CFG                               0x11 //
 #define MMA8451_PL_COUNT                             0x12 // Orientation debounce
@@ -60,6 +62,26 @@ extern "C"
 #define MMA8451_CTRL_REG4                            0x2D // Interrupt enable
 #define MMA8451_CTRL_REG5                            0x2E // Interrupt pin selection
 
+/*!
+ * Number of samples held by the MMA8451 FIFO
+ */
+#define MMA8451_FIFO_SIZE                            32
+
+/*!
+ * Output data rates ( CTRL_REG1 DR field )
+ */
+typedef enum eMma8451DataRate
+{
+    MMA8451_ODR_800_HZ = 0,
+    MMA8451_ODR_400_HZ,
+    MMA8451_ODR_200_HZ,
+    MMA8451_ODR_100_HZ,
+    MMA8451_ODR_50_HZ,
+    MMA8451_ODR_12_5_HZ,
+    MMA8451_ODR_6_25_HZ,
+    MMA8451_ODR_1_56_HZ,
+}Mma8451DataRate_t;
+
 /*!
  * \brief Initializes the device
  *
@@ -88,6 +110,37 @@ void MMA8451OrientDetect( void );
  */
 uint8_t MMA8451GetOrientation( void );
 
+/*!
+ * \brief Starts the sampling into the device FIFO
+ *
+ * \remark The FIFO is circular, the oldest samples are overwritten when it
+ *         isn't drained in time. The FIFO watermark interrupt is routed to
+ *         INT1 and replaces the orientation interrupt. The range is +/-2 g.
+ *
+ * \param [IN] dataRate  Output data rate
+ * \param [IN] watermark Number of samples triggering the interrupt [1..MMA8451_FIFO_SIZE]
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t MMA8451FifoStart( Mma8451DataRate_t dataRate, uint8_t watermark );
+
+/*!
+ * \brief Stops the FIFO sampling and restores the orientation detection
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t MMA8451FifoStop( void );
+
+/*!
+ * \brief Drains the device FIFO with a single burst read
+ *
+ * \param [OUT] samples  Samples in mg, X, Y and Z interleaved. Must hold
+ *                       3 * maxCount values
+ * \param [IN]  maxCount Maximum number of samples to read
+ * \param [OUT] count    Number of samples read
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t MMA8451FifoRead( int16_t *samples, uint8_t maxCount, uint8_t *count );
+
 #ifdef __cplusplus
 }
 #endif
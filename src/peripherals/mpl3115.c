@@ -21,6 +21,7 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdbool.h>
+#include <stddef.h>
 #include "utilities.h"
 #include "delay.h"
 #include "i2c.h"
@@ -39,13 +40,19 @@ static uint8_t I2cDeviceAddr = 0;
 static bool MPL3115Initialized = false;
 
 /*!
- * Defines the barometric reading types
+ * Callback of the conversion in progress, NULL when none
  */
-typedef enum
-{
-    PRESSURE,
-    ALTITUDE,
-}BarometerReadingType_t;
+static Mpl3115ConversionDone_t *MPL3115ConversionDone = NULL;
+
+/*!
+ * Conversion type in progress
+ */
+static Mpl3115Conversion_t MPL3115ConversionType;
+
+/*!
+ * Set when the INT1 pin signals the end of the conversion
+ */
+static volatile uint32_t MPL3115DataReady = 0;
 
 /*!
  * \brief Writes a byte at specified address in the device
@@ -125,6 +132,15 @@ void MPL3115SetModeActive( void );
  */
 void MPL3115ToggleOneShot( void );
 
+/*!
+ * \brief Converts the raw pressure or altitude sample
+ *
+ * \param [IN] type Pressure or altitude conversion
+ * \param [IN] data OUT_P_MSB, OUT_P_CSB and OUT_P_LSB registers values
+ * \retval value Pressure [Pa] or altitude [m]
+ */
+static float MPL3115ConvertBarometer( Mpl3115Conversion_t type, uint8_t *data );
+
 uint8_t MPL3115Init( void )
 {
     uint8_t regVal = 0;
@@ -191,11 +207,32 @@ uint8_t MPL3115GetDeviceAddr( void )
     return I2cDeviceAddr;
 }
 
-static float MPL3115ReadBarometer( BarometerReadingType_t type )
+static float MPL3115ConvertBarometer( Mpl3115Conversion_t type, uint8_t *data )
+{
+    uint8_t msb = data[0], csb = data[1], lsb = data[2];
+
+    if( type == MPL3115_CONVERSION_ALTITUDE )
+    {
+        float altitude = 0;
+        float decimal = ( ( float )( lsb >> 4 ) ) / 16.0;
+        altitude = ( float )( ( int16_t )( ( msb << 8 ) | csb ) ) + decimal;
+        return( altitude );
+    }
+    else
+    {
+        float pressure = ( float )( ( msb << 16 | csb << 8 | lsb ) >> 6 );
+        lsb &= 0x30;                                // Bits 5/4 represent the fractional component
+        lsb >>= 4;                                  // Get it right aligned
+        float decimal = ( ( float )lsb ) / 4.0;
+        pressure = pressure + decimal;
+        return( pressure );
+    }
+}
+
+static float MPL3115ReadBarometer( Mpl3115Conversion_t type )
 {
     uint8_t counter = 0;
     uint8_t tempBuf[3];
-    uint8_t msb = 0, csb = 0, lsb = 0;
     uint8_t status = 0;
 
     if( MPL3115Initialized == false )
@@ -203,7 +240,7 @@ static float MPL3115ReadBarometer( BarometerReadingType_t type )
         return 0;
     }
 
-    if( type == ALTITUDE )
+    if( type == MPL3115_CONVERSION_ALTITUDE )
     {
         MPL3115SetModeAltimeter( );
     }
@@ -224,7 +261,7 @@ static float MPL3115ReadBarometer( BarometerReadingType_t type )
         {
             MPL3115Initialized = false;
             MPL3115Init( );
-            if( type == ALTITUDE )
+            if( type == MPL3115_CONVERSION_ALTITUDE )
             {
                 MPL3115SetModeAltimeter( );
             }
@@ -252,36 +289,17 @@ static float MPL3115ReadBarometer( BarometerReadingType_t type )
 
     MPL3115ReadBuffer( OUT_P_MSB_REG, tempBuf, 3 );       //Read altitude data
 
-    msb = tempBuf[0];
-    csb = tempBuf[1];
-    lsb = tempBuf[2];
-
-    if( type == ALTITUDE )
-    {
-        float altitude = 0;
-        float decimal = ( ( float )( lsb >> 4 ) ) / 16.0;
-        altitude = ( float )( ( int16_t )( ( msb << 8 ) | csb ) ) + decimal;
-        return( altitude );
-    }
-    else
-    {
-        float pressure = ( float )( ( msb << 16 | csb << 8 | lsb ) >> 6 );
-        lsb &= 0x30;                                // Bits 5/4 represent the fractional component
-        lsb >>= 4;                                  // Get it right aligned
-        float decimal = ( ( float )lsb ) / 4.0;
-        pressure = pressure + decimal;
-        return( pressure );
-    }
+    return MPL3115ConvertBarometer( type, tempBuf );
 }
 
 float MPL3115ReadAltitude( void )
 {
-    return MPL3115ReadBarometer( ALTITUDE );
+    return MPL3115ReadBarometer( MPL3115_CONVERSION_ALTITUDE );
 }
 
 float MPL3115ReadPressure( void )
 {
-    return MPL3115ReadBarometer( PRESSURE );
+    return MPL3115ReadBarometer( MPL3115_CONVERSION_PRESSURE );
 }
 
 float MPL3115ReadTemperature( void )
@@ -356,6 +374,77 @@ float MPL3115ReadTemperature( void )
     return( temperature );
 }
 
+uint8_t MPL3115StartConversion( Mpl3115Conversion_t type, Mpl3115ConversionDone_t *callback )
+{
+    uint8_t ctrlReg = 0;
+
+    if( MPL3115Initialized == false )
+    {
+        return FAIL;
+    }
+
+    MPL3115SetModeStandby( );
+
+    // The interrupt registers are only writable in standby. INT1 is open
+    // drain active low, it is released once the results are read.
+    if( ( MPL3115Write( CTRL_REG3, PP_OD1 ) != SUCCESS ) ||
+        ( MPL3115Write( CTRL_REG4, INT_EN_DRDY ) != SUCCESS ) ||
+        ( MPL3115Write( CTRL_REG5, INT_CFG_DRDY ) != SUCCESS ) ||
+        ( MPL3115Read( CTRL_REG1, &ctrlReg ) != SUCCESS ) )
+    {
+        return FAIL;
+    }
+
+    MPL3115ConversionType = type;
+    MPL3115ConversionDone = callback;
+    MPL3115DataReady = 0;
+
+    if( type == MPL3115_CONVERSION_ALTITUDE )
+    {
+        ctrlReg |= ALT;
+    }
+    else
+    {
+        ctrlReg &= ~ALT;
+    }
+    // A one shot conversion started in standby returns to standby when done
+    ctrlReg &= ~( OST | SBYB );
+    MPL3115Write( CTRL_REG1, ctrlReg );
+    return MPL3115Write( CTRL_REG1, ctrlReg | OST );
+}
+
+void MPL3115OnInterrupt( void* context )
+{
+    MPL3115DataReady = 1;
+}
+
+void MPL3115Process( void )
+{
+    // STATUS_REG followed by the OUT_P and OUT_T registers
+    uint8_t data[6];
+    Mpl3115ConversionDone_t *callback = MPL3115ConversionDone;
+
+    if( AtomicExchange( &MPL3115DataReady, 0 ) == 0 )
+    {
+        return;
+    }
+
+    // Reading the data registers releases INT1
+    if( MPL3115ReadBuffer( STATUS_REG, data, 6 ) != SUCCESS )
+    {
+        return;
+    }
+
+    MPL3115ConversionDone = NULL;
+    if( callback != NULL )
+    {
+        // 12 bits two's complement temperature with 4 fractional bits
+        float temperature = ( float )( ( int16_t )( ( data[4] << 8 ) | data[5] ) >> 4 ) / 16.0f;
+
+        callback( MPL3115ConvertBarometer( MPL3115ConversionType, &data[1] ), temperature );
+    }
+}
+
 void MPL3115ToggleOneShot( void )
 {
     uint8_t ctrlReg = 0;
@@ -124,6 +124,27 @@ extern "C"
 #define DREM                  0x04
 #define PDEFE                 0x02
 #define TDEFE                 0x01
+#define IPOL1                 0x20
+#define PP_OD1                0x10
+#define INT_EN_DRDY           0x80
+#define INT_CFG_DRDY          0x80
+
+/*!
+ * Conversion types of the barometer
+ */
+typedef enum eMpl3115Conversion
+{
+    MPL3115_CONVERSION_PRESSURE,
+    MPL3115_CONVERSION_ALTITUDE,
+}Mpl3115Conversion_t;
+
+/*!
+ * \brief Conversion done callback prototype
+ *
+ * \param [IN] value       Measured pressure [Pa] or altitude [m]
+ * \param [IN] temperature Measured temperature [deg C]
+ */
+typedef void ( Mpl3115ConversionDone_t )( float value, float temperature );
 
 /*!
  * \brief Initializes the device
@@ -160,6 +181,33 @@ float MPL3115ReadPressure( void );
  */
 float MPL3115ReadTemperature( void );
 
+/*!
+ * \brief Starts a one shot conversion signaled by the sensor INT1 pin
+ *
+ * \remark The sensor returns to standby once the conversion is done. The
+ *         board must route the INT1 pin falling edge to MPL3115OnInterrupt
+ *         and the application must call MPL3115Process from its main loop.
+ *
+ * \param [IN] type     Pressure or altitude conversion
+ * \param [IN] callback Function called by MPL3115Process with the results
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t MPL3115StartConversion( Mpl3115Conversion_t type, Mpl3115ConversionDone_t *callback );
+
+/*!
+ * \brief Sensor INT1 pin interrupt handler
+ *
+ * \param [IN] context Not used
+ */
+void MPL3115OnInterrupt( void* context );
+
+/*!
+ * \brief Reads the results of a completed conversion and calls the
+ *        conversion done callback
+ */
+void MPL3115Process( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,657 @@
+/*
+ / _____)             _              | |
+( (____  _____ ____ _| |_ _____  ____| |__
+ \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ _____) ) ____| | | || |_| ____( (___| | | |
+(______/|_____)_|_|_| \__)_____)\____)_| |_|
+    (C)2013-2019 Semtech
+ ___ _____ _   ___ _  _____ ___  ___  ___ ___
+/ __|_   _/_\ / __| |/ / __/ _ \| _ \/ __| __|
+\__ \ | |/ _ \ (__| ' <| _| (_) |   / (__| _|
+|___/ |_/_/ \_\___|_|\_\_| \___/|_|_\\___|___|
+embedded.connectivity.solutions===============
+
+Description: Constant time bitsliced AES implementation, selected with
+             AES_CONSTANT_TIME in place of aes.c
+
+             Two blocks are processed at once, held in 8 bit planes of 32 bits
+             where bit ( 8 * row + 4 * block + column ) of plane b is bit b of
+             the state byte ( row, column ) of the block. There are neither
+             table lookups nor branches depending on the key or the data.
+
+License: Revised BSD License, see LICENSE.TXT file include in the project
+
+Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech )
+*/
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "aes.h"
+
+#if defined( AES_CONSTANT_TIME )
+
+#if defined( AES_ENC_128_OTFK ) || defined( AES_DEC_128_OTFK ) || \
+    defined( AES_ENC_256_OTFK ) || defined( AES_DEC_256_OTFK )
+#  error "AES_CONSTANT_TIME only supports the pre-keyed AES"
+#endif
+
+#define ROR8( x )       ( ( ( x ) >> 8 ) | ( ( x ) << 24 ) )
+#define ROR16( x )      ( ( ( x ) >> 16 ) | ( ( x ) << 16 ) )
+
+/*  Swaps the bits of x selected by cl with the bits of y selected by ch */
+#define SWAPN( cl, ch, s, x, y )                                            \
+    do                                                                      \
+    {                                                                       \
+        uint32_t a = ( x );                                                 \
+        uint32_t b = ( y );                                                 \
+        ( x ) = ( a & ( uint32_t )( cl ) ) | ( ( b & ( uint32_t )( cl ) ) << ( s ) ); \
+        ( y ) = ( ( a & ( uint32_t )( ch ) ) >> ( s ) ) | ( b & ( uint32_t )( ch ) ); \
+    } while( 0 )
+
+/*  Transposes the 8x8 bit matrices held in each byte lane of q[0..7], the
+    conversion between byte columns and bit planes is its own inverse
+*/
+static void ortho( uint32_t q[8] )
+{
+    SWAPN( 0x55555555, 0xAAAAAAAA, 1, q[0], q[1] );
+    SWAPN( 0x55555555, 0xAAAAAAAA, 1, q[2], q[3] );
+    SWAPN( 0x55555555, 0xAAAAAAAA, 1, q[4], q[5] );
+    SWAPN( 0x55555555, 0xAAAAAAAA, 1, q[6], q[7] );
+
+    SWAPN( 0x33333333, 0xCCCCCCCC, 2, q[0], q[2] );
+    SWAPN( 0x33333333, 0xCCCCCCCC, 2, q[1], q[3] );
+    SWAPN( 0x33333333, 0xCCCCCCCC, 2, q[4], q[6] );
+    SWAPN( 0x33333333, 0xCCCCCCCC, 2, q[5], q[7] );
+
+    SWAPN( 0x0F0F0F0F, 0xF0F0F0F0, 4, q[0], q[4] );
+    SWAPN( 0x0F0F0F0F, 0xF0F0F0F0, 4, q[1], q[5] );
+    SWAPN( 0x0F0F0F0F, 0xF0F0F0F0, 4, q[2], q[6] );
+    SWAPN( 0x0F0F0F0F, 0xF0F0F0F0, 4, q[3], q[7] );
+}
+
+/*  SubBytes on the bit planes, circuit by Boyar and Peralta ( "A new
+    combinational logic minimization technique with applications to
+    cryptology", https://eprint.iacr.org/2009/191 ). The inputs x0..x7 and
+    outputs s0..s7 are numbered from the most significant bit.
+*/
+static void sub_bytes( uint32_t q[8] )
+{
+    uint32_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint32_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint32_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint32_t y20, y21;
+    uint32_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint32_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint32_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint32_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint32_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint32_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint32_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint32_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint32_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint32_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    /* top linear transformation */
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    /* non-linear section */
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    /* bottom linear transformation */
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/*  Rotates the columns of each row, the columns are the bits of a nibble */
+static void shift_rows( uint32_t q[8] )
+{
+    uint8_t i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        uint32_t x = q[i];
+
+        q[i] = ( x & 0x000000FF )
+             | ( ( x & 0x0000EE00 ) >> 1 ) | ( ( x & 0x00001100 ) << 3 )
+             | ( ( x & 0x00CC0000 ) >> 2 ) | ( ( x & 0x00330000 ) << 2 )
+             | ( ( x & 0x88000000 ) >> 3 ) | ( ( x & 0x77000000 ) << 1 );
+    }
+}
+
+/*  Multiplies each byte by x in GF(2^8) */
+static void xtime( uint32_t d[8], const uint32_t s[8] )
+{
+    uint32_t s7 = s[7];
+
+    d[7] = s[6];
+    d[6] = s[5];
+    d[5] = s[4];
+    d[4] = s[3] ^ s7;
+    d[3] = s[2] ^ s7;
+    d[2] = s[1];
+    d[1] = s[0] ^ s7;
+    d[0] = s7;
+}
+
+/*  The rows are the byte lanes, rotating a plane by 8 bits gives for each
+    row the byte of the next row in the same column
+*/
+static void mix_columns( uint32_t q[8] )
+{
+    uint32_t r1[8], s[8], m[8];
+    uint8_t i;
+
+    /* 2.a0 ^ 3.a1 ^ a2 ^ a3 = 2.( a0 ^ a1 ) ^ a1 ^ ( a2 ^ a3 ) */
+    for( i = 0; i < 8; i++ )
+    {
+        r1[i] = ROR8( q[i] );
+        s[i] = q[i] ^ r1[i];
+    }
+    xtime( m, s );
+    for( i = 0; i < 8; i++ )
+    {
+        q[i] = m[i] ^ r1[i] ^ ROR16( s[i] );
+    }
+}
+
+/*  Spreads a compressed round key plane to both blocks */
+static uint32_t expand_key_plane( uint16_t k )
+{
+    uint32_t x = k;
+
+    x = ( x | ( x << 8 ) ) & 0x00FF00FF;
+    x = ( x | ( x << 4 ) ) & 0x0F0F0F0F;
+    return x | ( x << 4 );
+}
+
+static void add_round_key( uint32_t q[8], const uint16_t *k )
+{
+    uint8_t i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        q[i] ^= expand_key_plane( k[i] );
+    }
+}
+
+static uint32_t get_col( const uint8_t *p )
+{
+    return ( uint32_t )p[0] | ( ( uint32_t )p[1] << 8 ) | ( ( uint32_t )p[2] << 16 ) | ( ( uint32_t )p[3] << 24 );
+}
+
+static void put_col( uint8_t *p, uint32_t x )
+{
+    p[0] = ( uint8_t )x;
+    p[1] = ( uint8_t )( x >> 8 );
+    p[2] = ( uint8_t )( x >> 16 );
+    p[3] = ( uint8_t )( x >> 24 );
+}
+
+/*  Loads two blocks into bit planes, in1 may be the same block as in0 */
+static void load_blocks( uint32_t q[8], const uint8_t in0[N_BLOCK], const uint8_t in1[N_BLOCK] )
+{
+    uint8_t i;
+
+    for( i = 0; i < 4; i++ )
+    {
+        q[i] = get_col( in0 + 4 * i );
+        q[i + 4] = get_col( in1 + 4 * i );
+    }
+    ortho( q );
+}
+
+static void store_blocks( uint8_t out0[N_BLOCK], uint8_t out1[N_BLOCK], uint32_t q[8] )
+{
+    uint8_t i;
+
+    ortho( q );
+    if( out1 != NULL )
+    {
+        for( i = 0; i < 4; i++ )
+        {
+            put_col( out1 + 4 * i, q[i + 4] );
+        }
+    }
+    for( i = 0; i < 4; i++ )
+    {
+        put_col( out0 + 4 * i, q[i] );
+    }
+}
+
+/*  SubWord of the key expansion on 4 bytes */
+static void sub_word( uint8_t t[4] )
+{
+    uint32_t q[8] = { 0 };
+    uint8_t i, b;
+
+    for( b = 0; b < 8; b++ )
+    {
+        for( i = 0; i < 4; i++ )
+        {
+            q[b] |= ( uint32_t )( ( t[i] >> b ) & 1 ) << i;
+        }
+    }
+    sub_bytes( q );
+    for( i = 0; i < 4; i++ )
+    {
+        t[i] = 0;
+        for( b = 0; b < 8; b++ )
+        {
+            t[i] |= ( uint8_t )( ( q[b] >> i ) & 1 ) << b;
+        }
+    }
+}
+
+#if defined( AES_ENC_PREKEYED ) || defined( AES_DEC_PREKEYED )
+
+/*  Set the cipher key, the round keys are stored as 8 bit planes of 16 bits
+    where bit ( 4 * row + column ) of plane b is bit b of the key byte
+    ( row, column )
+*/
+
+return_type aes_set_key( const uint8_t key[], length_type keylen, aes_context ctx[1] )
+{
+    uint8_t ksch[( N_MAX_ROUNDS + 1 ) * N_BLOCK];
+    uint8_t cc, rc, hi, i, b;
+
+    switch( keylen )
+    {
+    case 16:
+    case 24:
+    case 32:
+        break;
+    default:
+        ctx->rnd = 0;
+        return ( uint8_t )-1;
+    }
+    for( cc = 0; cc < keylen; cc++ )
+    {
+        ksch[cc] = key[cc];
+    }
+    hi = ( keylen + 28 ) << 2;
+    ctx->rnd = ( hi >> 4 ) - 1;
+    for( cc = keylen, rc = 1; cc < hi; cc += 4 )
+    {
+        uint8_t t[4];
+
+        t[0] = ksch[cc - 4];
+        t[1] = ksch[cc - 3];
+        t[2] = ksch[cc - 2];
+        t[3] = ksch[cc - 1];
+        if( cc % keylen == 0 )
+        {
+            uint8_t tt = t[0];
+
+            t[0] = t[1];
+            t[1] = t[2];
+            t[2] = t[3];
+            t[3] = tt;
+            sub_word( t );
+            t[0] ^= rc;
+            rc = ( rc << 1 ) ^ ( ( rc >> 7 ) * 0x1b );
+        }
+        else if( keylen > 24 && cc % keylen == 16 )
+        {
+            sub_word( t );
+        }
+        for( i = 0; i < 4; i++ )
+        {
+            ksch[cc + i] = ksch[cc - keylen + i] ^ t[i];
+        }
+    }
+
+    for( cc = 0; cc < hi; cc += N_BLOCK )
+    {
+        uint16_t *k = ctx->ksch + ( cc >> 4 ) * 8;
+
+        for( b = 0; b < 8; b++ )
+        {
+            k[b] = 0;
+            for( i = 0; i < N_BLOCK; i++ )
+            {
+                // Key byte i is at row i % 4 and column i / 4
+                k[b] |= ( uint16_t )( ( ksch[cc + i] >> b ) & 1 ) << ( ( ( i & 3 ) << 2 ) | ( i >> 2 ) );
+            }
+        }
+    }
+    for( cc = 0; cc < hi; cc++ )
+    {
+        ksch[cc] = 0;
+    }
+    return 0;
+}
+
+#endif
+
+#if defined( AES_ENC_PREKEYED )
+
+/*  Encrypt two blocks at once, out1 may be NULL */
+
+static void encrypt_blocks( const uint8_t in0[N_BLOCK], const uint8_t in1[N_BLOCK],
+                            uint8_t out0[N_BLOCK], uint8_t out1[N_BLOCK], const aes_context ctx[1] )
+{
+    uint32_t q[8];
+    uint8_t r;
+
+    load_blocks( q, in0, in1 );
+    add_round_key( q, ctx->ksch );
+    for( r = 1; r < ctx->rnd; r++ )
+    {
+        sub_bytes( q );
+        shift_rows( q );
+        mix_columns( q );
+        add_round_key( q, ctx->ksch + r * 8 );
+    }
+    sub_bytes( q );
+    shift_rows( q );
+    add_round_key( q, ctx->ksch + r * 8 );
+    store_blocks( out0, out1, q );
+}
+
+/*  Encrypt a single block of 16 bytes */
+
+return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
+{
+    if( ctx->rnd == 0 )
+        return ( uint8_t )-1;
+    encrypt_blocks( in, in, out, NULL, ctx );
+    return 0;
+}
+
+/* ECB encrypt a number of blocks, two at a time */
+
+return_type aes_ecb_encrypt( const uint8_t *in, uint8_t *out,
+                         int32_t n_block, const aes_context ctx[1] )
+{
+    if( ctx->rnd == 0 )
+        return EXIT_FAILURE;
+    while( n_block >= 2 )
+    {
+        encrypt_blocks( in, in + N_BLOCK, out, out + N_BLOCK, ctx );
+        in += 2 * N_BLOCK;
+        out += 2 * N_BLOCK;
+        n_block -= 2;
+    }
+    if( n_block > 0 )
+        encrypt_blocks( in, in, out, NULL, ctx );
+    return EXIT_SUCCESS;
+}
+
+/* CBC encrypt a number of blocks (input and return an IV) */
+
+return_type aes_cbc_encrypt( const uint8_t *in, uint8_t *out,
+                         int32_t n_block, uint8_t iv[N_BLOCK], const aes_context ctx[1] )
+{
+    uint8_t i;
+
+    if( ctx->rnd == 0 )
+        return EXIT_FAILURE;
+    while( n_block-- )
+    {
+        for( i = 0; i < N_BLOCK; i++ )
+            iv[i] ^= in[i];
+        encrypt_blocks( iv, iv, iv, NULL, ctx );
+        for( i = 0; i < N_BLOCK; i++ )
+            out[i] = iv[i];
+        in += N_BLOCK;
+        out += N_BLOCK;
+    }
+    return EXIT_SUCCESS;
+}
+
+#endif
+
+#if defined( AES_DEC_PREKEYED )
+
+/*  InvSubBytes as the affine transformation inverse, SubBytes and the affine
+    transformation inverse again
+*/
+static void inv_affine( uint32_t q[8] )
+{
+    uint32_t q0, q1, q2, q3, q4, q5, q6, q7;
+
+    q0 = ~q[0];
+    q1 = ~q[1];
+    q2 = q[2];
+    q3 = q[3];
+    q4 = q[4];
+    q5 = ~q[5];
+    q6 = ~q[6];
+    q7 = q[7];
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+static void inv_sub_bytes( uint32_t q[8] )
+{
+    inv_affine( q );
+    sub_bytes( q );
+    inv_affine( q );
+}
+
+static void inv_shift_rows( uint32_t q[8] )
+{
+    uint8_t i;
+
+    for( i = 0; i < 8; i++ )
+    {
+        uint32_t x = q[i];
+
+        q[i] = ( x & 0x000000FF )
+             | ( ( x & 0x00007700 ) << 1 ) | ( ( x & 0x00008800 ) >> 3 )
+             | ( ( x & 0x00CC0000 ) >> 2 ) | ( ( x & 0x00330000 ) << 2 )
+             | ( ( x & 0xEE000000 ) >> 1 ) | ( ( x & 0x11000000 ) << 3 );
+    }
+}
+
+static void inv_mix_columns( uint32_t q[8] )
+{
+    uint32_t s[8], m[8];
+    uint8_t i;
+
+    /* InvMixColumns is MixColumns after adding 4.( a0 ^ a2 ) to a0 and a2
+       and 4.( a1 ^ a3 ) to a1 and a3
+    */
+    for( i = 0; i < 8; i++ )
+    {
+        s[i] = q[i] ^ ROR16( q[i] );
+    }
+    xtime( m, s );
+    xtime( s, m );
+    for( i = 0; i < 8; i++ )
+    {
+        q[i] ^= s[i];
+    }
+    mix_columns( q );
+}
+
+/*  Decrypt a single block of 16 bytes */
+
+return_type aes_decrypt( const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK], const aes_context ctx[1] )
+{
+    uint32_t q[8];
+    uint8_t r;
+
+    if( ctx->rnd == 0 )
+        return ( uint8_t )-1;
+    load_blocks( q, in, in );
+    add_round_key( q, ctx->ksch + ctx->rnd * 8 );
+    for( r = ctx->rnd - 1; r > 0; r-- )
+    {
+        inv_shift_rows( q );
+        inv_sub_bytes( q );
+        add_round_key( q, ctx->ksch + r * 8 );
+        inv_mix_columns( q );
+    }
+    inv_shift_rows( q );
+    inv_sub_bytes( q );
+    add_round_key( q, ctx->ksch );
+    store_blocks( out, NULL, q );
+    return 0;
+}
+
+/* CBC decrypt a number of blocks (input and return an IV) */
+
+return_type aes_cbc_decrypt( const uint8_t *in, uint8_t *out,
+                         int32_t n_block, uint8_t iv[N_BLOCK], const aes_context ctx[1] )
+{
+    uint8_t tmp[N_BLOCK];
+    uint8_t i;
+
+    while( n_block-- )
+    {
+        for( i = 0; i < N_BLOCK; i++ )
+            tmp[i] = in[i];
+        if( aes_decrypt( in, out, ctx ) != 0 )
+            return EXIT_FAILURE;
+        for( i = 0; i < N_BLOCK; i++ )
+        {
+            out[i] ^= iv[i];
+            iv[i] = tmp[i];
+        }
+        in += N_BLOCK;
+        out += N_BLOCK;
+    }
+    return EXIT_SUCCESS;
+}
+
+#endif
+
+#endif
@@ -31,6 +31,12 @@
  that developed by Karl Malbrain. His contribution is acknowledged.
  */
 
+#include <stdlib.h>
+#include <stdint.h>
+
+/* the bitsliced constant time implementation in aes-ct.c is used instead */
+#if !defined( AES_CONSTANT_TIME )
+
 /* define if you have a fast memcpy function on your system */
 #if 0
 #  define HAVE_MEMCPY
@@ -41,10 +47,6 @@
 #  endif
 #endif
 
-
-#include <stdlib.h>
-#include <stdint.h>
-
 /* define if you have fast 32-bit types on your system */
 #if ( __CORTEX_M != 0 ) // if Cortex is different from M0/M0+
 #  define HAVE_UINT_32T
@@ -55,6 +57,29 @@
 #  define USE_TABLES
 #endif
 
+/* define to run the encryption rounds on 32-bit columns with a single 1 KB
+   table ( requires USE_TABLES ). It can also be set by the build system.
+*/
+#if 0
+#  define AES_T_TABLES
+#endif
+
+#if defined( AES_T_TABLES ) && !defined( USE_TABLES )
+#  error "AES_T_TABLES requires USE_TABLES"
+#endif
+
+/* the byte oriented rounds are not needed when only the T-table pre-keyed
+   encryption is built
+*/
+#if !defined( AES_T_TABLES ) || defined( AES_DEC_PREKEYED ) || \
+    defined( AES_ENC_128_OTFK ) || defined( AES_DEC_128_OTFK ) || \
+    defined( AES_ENC_256_OTFK ) || defined( AES_DEC_256_OTFK )
+#  define AES_BYTE_ROUNDS
+#endif
+#if !defined( AES_T_TABLES ) || defined( AES_ENC_128_OTFK ) || defined( AES_ENC_256_OTFK )
+#  define AES_BYTE_ENC_ROUNDS
+#endif
+
 /*  On Intel Core 2 duo VERSION_1 is faster */
 
 /* alternative versions (test for performance on your system) */
@@ -63,6 +88,14 @@
 #endif
 
 #include "aes.h"
+#include "utilities.h"
+
+/* defined when the board provides an AES accelerator, 128 bits keys encryptions
+   are then run on it, falling back to the software rounds on failure
+*/
+#if defined( SECURE_ELEMENT_HW_AES )
+#  include "aes-board.h"
+#endif
 
 //#if defined( HAVE_UINT_32T )
 //  typedef unsigned long uint32_t;
@@ -197,8 +230,20 @@ static const uint8_t sbox[256]  =  sb_data(f1);
 static const uint8_t isbox[256] = isb_data(f1);
 #endif
 
+#if defined( AES_BYTE_ENC_ROUNDS )
 static const uint8_t gfm2_sbox[256] = sb_data(f2);
 static const uint8_t gfm3_sbox[256] = sb_data(f3);
+#endif
+
+#if defined( AES_T_TABLES ) && defined( AES_ENC_PREKEYED )
+/*  Combined SubBytes and MixColumns contribution of a row 0 byte to its
+    output column, packed little endian ( row 0 in the low byte ). The other
+    rows are obtained by rotating the entry left by 8, 16 and 24 bits.
+*/
+#define t_fw(x) ( ( ( uint32_t )f3(x) << 24 ) | ( ( uint32_t )(x) << 16 ) | \
+                  ( ( uint32_t )(x) << 8 ) | ( uint32_t )f2(x) )
+static const uint32_t t_fn[256] = sb_data(t_fw);
+#endif
 
 #if defined( AES_DEC_PREKEYED )
 static const uint8_t gfmul_9[256] = mm_data(f9);
@@ -346,7 +391,7 @@ static void copy_block_nn( uint8_t * d, const uint8_t *s, uint8_t nn )
         *d++ = *s++;
 }
 
-static void xor_block( void *d, const void *s )
+static RAM_FUNC void xor_block( void *d, const void *s )
 {
 #if defined( HAVE_UINT_32T )
     ((uint32_t*)d)[ 0] ^= ((uint32_t*)s)[ 0];
@@ -373,7 +418,9 @@ static void xor_block( void *d, const void *s )
 #endif
 }
 
-static void copy_and_key( void *d, const void *s, const void *k )
+#if defined( AES_BYTE_ROUNDS )
+
+static RAM_FUNC void copy_and_key( void *d, const void *s, const void *k )
 {
 #if defined( HAVE_UINT_32T )
     ((uint32_t*)d)[ 0] = ((uint32_t*)s)[ 0] ^ ((uint32_t*)k)[ 0];
@@ -403,12 +450,14 @@ static void copy_and_key( void *d, const void *s, const void *k )
 #endif
 }
 
-static void add_round_key( uint8_t d[N_BLOCK], const uint8_t k[N_BLOCK] )
+static RAM_FUNC void add_round_key( uint8_t d[N_BLOCK], const uint8_t k[N_BLOCK] )
 {
     xor_block(d, k);
 }
 
-static void shift_sub_rows( uint8_t st[N_BLOCK] )
+#if defined( AES_BYTE_ENC_ROUNDS )
+
+static RAM_FUNC void shift_sub_rows( uint8_t st[N_BLOCK] )
 {   uint8_t tt;
 
     st[ 0] = s_box(st[ 0]); st[ 4] = s_box(st[ 4]);
@@ -424,6 +473,8 @@ static void shift_sub_rows( uint8_t st[N_BLOCK] )
     st[ 7] = s_box(st[ 3]); st[ 3] = s_box( tt );
 }
 
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
@@ -444,12 +495,14 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
 
 #endif
 
+#if defined( AES_BYTE_ENC_ROUNDS )
+
 #if defined( VERSION_1 )
-  static void mix_sub_columns( uint8_t dt[N_BLOCK] )
+  static RAM_FUNC void mix_sub_columns( uint8_t dt[N_BLOCK] )
   { uint8_t st[N_BLOCK];
     block_copy(st, dt);
 #else
-  static void mix_sub_columns( uint8_t dt[N_BLOCK], uint8_t st[N_BLOCK] )
+  static RAM_FUNC void mix_sub_columns( uint8_t dt[N_BLOCK], uint8_t st[N_BLOCK] )
   {
 #endif
     dt[ 0] = gfm2_sb(st[0]) ^ gfm3_sb(st[5]) ^ s_box(st[10]) ^ s_box(st[15]);
@@ -473,6 +526,10 @@ static void inv_shift_sub_rows( uint8_t st[N_BLOCK] )
     dt[15] = gfm3_sb(st[12]) ^ s_box(st[1]) ^ s_box(st[6]) ^ gfm2_sb(st[11]);
   }
 
+#endif
+
+#endif
+
 #if defined( AES_DEC_PREKEYED )
 
 #if defined( VERSION_1 )
@@ -565,8 +622,78 @@ return_type aes_set_key( const uint8_t key[], length_type keylen, aes_context ct
 
 /*  Encrypt a single block of 16 bytes */
 
-return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
+#if defined( AES_T_TABLES )
+
+#define rot_l8(x)       ( ( ( x ) << 8 ) | ( ( x ) >> 24 ) )
+#define rot_l16(x)      ( ( ( x ) << 16 ) | ( ( x ) >> 16 ) )
+#define rot_l24(x)      ( ( ( x ) << 24 ) | ( ( x ) >> 8 ) )
+
+#define get_col(p)      ( ( uint32_t )(p)[0] | ( ( uint32_t )(p)[1] << 8 ) | \
+                          ( ( uint32_t )(p)[2] << 16 ) | ( ( uint32_t )(p)[3] << 24 ) )
+#define row_0(c)        ( ( uint8_t )( c ) )
+#define row_1(c)        ( ( uint8_t )( ( c ) >> 8 ) )
+#define row_2(c)        ( ( uint8_t )( ( c ) >> 16 ) )
+#define row_3(c)        ( ( uint8_t )( ( c ) >> 24 ) )
+
+/*  One full round on the columns c0..c3 ( ShiftRows, SubBytes, MixColumns
+    and AddRoundKey with the round key k )
+*/
+#define t_round(c0, c1, c2, c3, k)                                          \
+    ( t_fn[row_0(c0)] ^ rot_l8(t_fn[row_1(c1)]) ^                           \
+      rot_l16(t_fn[row_2(c2)]) ^ rot_l24(t_fn[row_3(c3)]) ^ get_col(k) )
+
+/*  Last round on the columns c0..c3 ( ShiftRows, SubBytes and AddRoundKey )
+    written to the bytes d[0..3]
+*/
+#define t_last_round(d, c0, c1, c2, c3, k)                                  \
+    (d)[0] = s_box(row_0(c0)) ^ (k)[0]; (d)[1] = s_box(row_1(c1)) ^ (k)[1];  \
+    (d)[2] = s_box(row_2(c2)) ^ (k)[2]; (d)[3] = s_box(row_3(c3)) ^ (k)[3]
+
+RAM_FUNC return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
+{
+#if defined( SECURE_ELEMENT_HW_AES )
+    if( ( ctx->rnd == 10 ) && ( AesMcuEncrypt( ctx->ksch, in, out, 1 ) == SUCCESS ) )
+        return 0;
+#endif
+    if( ctx->rnd )
+    {
+        const uint8_t *k = ctx->ksch;
+        uint32_t c0, c1, c2, c3, t0, t1, t2, t3;
+        uint8_t r;
+
+        c0 = get_col(in     ) ^ get_col(k     );
+        c1 = get_col(in +  4) ^ get_col(k +  4);
+        c2 = get_col(in +  8) ^ get_col(k +  8);
+        c3 = get_col(in + 12) ^ get_col(k + 12);
+
+        for( r = 1 ; r < ctx->rnd ; ++r )
+        {
+            k += N_BLOCK;
+            t0 = t_round( c0, c1, c2, c3, k      );
+            t1 = t_round( c1, c2, c3, c0, k +  4 );
+            t2 = t_round( c2, c3, c0, c1, k +  8 );
+            t3 = t_round( c3, c0, c1, c2, k + 12 );
+            c0 = t0; c1 = t1; c2 = t2; c3 = t3;
+        }
+        k += N_BLOCK;
+        t_last_round( out     , c0, c1, c2, c3, k      );
+        t_last_round( out +  4, c1, c2, c3, c0, k +  4 );
+        t_last_round( out +  8, c2, c3, c0, c1, k +  8 );
+        t_last_round( out + 12, c3, c0, c1, c2, k + 12 );
+    }
+    else
+        return ( uint8_t )-1;
+    return 0;
+}
+
+#else
+
+RAM_FUNC return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const aes_context ctx[1] )
 {
+#if defined( SECURE_ELEMENT_HW_AES )
+    if( ( ctx->rnd == 10 ) && ( AesMcuEncrypt( ctx->ksch, in, out, 1 ) == SUCCESS ) )
+        return 0;
+#endif
     if( ctx->rnd )
     {
         uint8_t s1[N_BLOCK], r;
@@ -592,6 +719,23 @@ return_type aes_encrypt( const uint8_t in[N_BLOCK], uint8_t  out[N_BLOCK], const
     return 0;
 }
 
+#endif
+
+/* ECB encrypt a number of blocks */
+
+return_type aes_ecb_encrypt( const uint8_t *in, uint8_t *out,
+                         int32_t n_block, const aes_context ctx[1] )
+{
+    while(n_block--)
+    {
+        if(aes_encrypt(in, out, ctx) != EXIT_SUCCESS)
+            return EXIT_FAILURE;
+        in += N_BLOCK;
+        out += N_BLOCK;
+    }
+    return EXIT_SUCCESS;
+}
+
 /* CBC encrypt a number of blocks (input and return an IV) */
 
 return_type aes_cbc_encrypt( const uint8_t *in, uint8_t *out,
@@ -934,3 +1078,5 @@ void aes_decrypt_256( const uint8_t in[N_BLOCK], uint8_t out[N_BLOCK],
 }
 
 #endif
+
+#endif /* AES_CONSTANT_TIME */
@@ -69,10 +69,18 @@ typedef uint8_t return_type;
 
 typedef uint8_t length_type;
 
+#if defined( AES_CONSTANT_TIME )
+/*  Bitsliced AES ( aes-ct.c ), 8 bit planes of 16 bits per round key */
+typedef struct
+{   uint16_t ksch[(N_MAX_ROUNDS + 1) * 8];
+    uint8_t rnd;
+} aes_context;
+#else
 typedef struct
 {   uint8_t ksch[(N_MAX_ROUNDS + 1) * N_BLOCK];
     uint8_t rnd;
 } aes_context;
+#endif
 
 /*  The following calls are for a precomputed key schedule
 
@@ -95,6 +103,14 @@ return_type aes_encrypt( const uint8_t in[N_BLOCK],
                          uint8_t out[N_BLOCK],
                          const aes_context ctx[1] );
 
+/*  Encrypts n_block consecutive blocks, the bitsliced AES processes them
+    two at a time
+*/
+return_type aes_ecb_encrypt( const uint8_t *in,
+                         uint8_t *out,
+                         int32_t n_block,
+                         const aes_context ctx[1] );
+
 return_type aes_cbc_encrypt( const uint8_t *in,
                          uint8_t *out,
                          int32_t n_block,
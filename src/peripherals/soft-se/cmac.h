@@ -61,6 +61,15 @@ void     AES_CMAC_Update(AES_CMAC_CTX * ctx, const uint8_t * data, uint32_t len)
           //          __attribute__((__bounded__(__string__,2,3)));
 void     AES_CMAC_Final(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX  * ctx);
             //     __attribute__((__bounded__(__minbytes__,1,AES_CMAC_DIGEST_LENGTH)));
+
+/*  The following calls allow to keep a keyed context and its subkeys across
+    messages: AES_CMAC_Subkeys once after AES_CMAC_SetKey, then for each
+    message AES_CMAC_Restart, AES_CMAC_Update and AES_CMAC_FinalSubkeys.
+*/
+void     AES_CMAC_Restart(AES_CMAC_CTX * ctx);
+void     AES_CMAC_Subkeys(AES_CMAC_CTX * ctx, uint8_t K1[AES_CMAC_KEY_LENGTH], uint8_t K2[AES_CMAC_KEY_LENGTH]);
+void     AES_CMAC_FinalSubkeys(uint8_t digest[AES_CMAC_DIGEST_LENGTH], AES_CMAC_CTX * ctx,
+                               const uint8_t K1[AES_CMAC_KEY_LENGTH], const uint8_t K2[AES_CMAC_KEY_LENGTH]);
 //__END_DECLS
 
 #ifdef __cplusplus
@@ -28,19 +28,47 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ),
 #include "aes.h"
 #include "cmac.h"
 #include "radio.h"
+#include "trace.h"
+#if defined( SECURE_ELEMENT_HW_AES )
+#include "aes-board.h"
+#endif
 
 #define NUM_OF_KEYS      24
 #define KEY_SIZE         16
 
+/*
+ * Number of keys whose expanded AES key schedule and CMAC subkeys are kept in RAM
+ */
+#ifndef SOFT_SE_KEY_CACHE_SIZE
+#define SOFT_SE_KEY_CACHE_SIZE      4
+#endif
+
+// SecureElementAesCtrCmac holds the CMAC and the AES keys at the same time
+#if( SOFT_SE_KEY_CACHE_SIZE < 2 )
+#error "SOFT_SE_KEY_CACHE_SIZE must be at least 2"
+#endif
+
+/*
+ * Number of random numbers drawn from the entropy pool before a new radio
+ * noise sample is mixed in. Sampling the radio noise takes milliseconds.
+ */
+#ifndef SOFT_SE_RANDOM_RESEED_INTERVAL
+#define SOFT_SE_RANDOM_RESEED_INTERVAL      16
+#endif
+
+/*
+ * Layout version of the Secure Element non volatile context. Must be
+ * incremented whenever SecureElementNvCtx_t changes, the contexts stored with
+ * another layout are then rejected by SecureElementRestoreNvmCtx.
+ */
+#define SOFT_SE_NVM_CTX_VERSION     1
+
 /*!
- * Identifier value pair type for Keys
+ * Key storage type. The key identifier is given by the key position in the
+ * key list, see GetKeyByID
  */
 typedef struct sKey
 {
-    /*
-     * Key identifier
-     */
-    KeyIdentifier_t KeyID;
     /*
      * Key value
      */
@@ -48,10 +76,15 @@ typedef struct sKey
 } Key_t;
 
 /*
- * Secure Element Non Volatile Context structure
+ * Secure Element Non Volatile Context structure. Only holds the persisted
+ * data, the crypto computation state is kept in the RAM only key cache.
  */
 typedef struct sSecureElementNvCtx
 {
+    /*
+     * Layout version, SOFT_SE_NVM_CTX_VERSION
+     */
+    uint8_t Version;
     /*
      * DevEUI storage
      */
@@ -61,24 +94,103 @@ typedef struct sSecureElementNvCtx
      */
     uint8_t JoinEui[SE_EUI_SIZE];
     /*
-     * AES computation context variable
+     * Key List
      */
-    aes_context AesContext;
+    Key_t KeyList[NUM_OF_KEYS];
+}SecureElementNvCtx_t;
+
+/*
+ * Expanded key cache entry
+ */
+typedef struct sKeyCacheEntry
+{
     /*
-     * CMAC computation context variable
+     * Key identifier, only meaningful when IsValid is true
      */
-    AES_CMAC_CTX AesCmacCtx[1];
+    KeyIdentifier_t KeyID;
     /*
-     * Key List
+     * Set to true when the entry holds the expanded key of KeyID
      */
-    Key_t KeyList[NUM_OF_KEYS];
-}SecureElementNvCtx_t;
+    bool IsValid;
+    /*
+     * Set to true when K1 and K2 are computed
+     */
+    bool HasSubkeys;
+    /*
+     * Value of KeyCacheUseCnt at the last use, used to replace the least recently used entry
+     */
+    uint32_t LastUse;
+    /*
+     * CMAC context holding the expanded key schedule
+     */
+    AES_CMAC_CTX CmacCtx;
+    /*
+     * CMAC subkeys
+     */
+    uint8_t K1[16];
+    uint8_t K2[16];
+}KeyCacheEntry_t;
 
+#if defined( LORAMAC_INSTANCES_ENABLED )
+/*!
+ * Module instance
+ */
+typedef struct sSecureElementInstance
+{
+    /*!
+     * Module context
+     */
+    SecureElementNvCtx_t SeNvmCtx;
+    /*!
+     * Expanded key cache
+     */
+    KeyCacheEntry_t KeyCache[SOFT_SE_KEY_CACHE_SIZE];
+    /*!
+     * Key cache usage counter
+     */
+    uint32_t KeyCacheUseCnt;
+}SecureElementInstance_t;
+
+/*!
+ * Instance used by the default LoRaMac instance
+ */
+static SecureElementInstance_t DefaultInstance;
+
+/*!
+ * Selected instance
+ */
+static SecureElementInstance_t* SelectedInstance = &DefaultInstance;
+
+#define SeNvmCtx                                    ( SelectedInstance->SeNvmCtx )
+#define KeyCache                                    ( SelectedInstance->KeyCache )
+#define KeyCacheUseCnt                              ( SelectedInstance->KeyCacheUseCnt )
+#else
 /*
  * Module context
  */
 static SecureElementNvCtx_t SeNvmCtx;
 
+/*
+ * Expanded key cache. Not part of the non-volatile context.
+ */
+static KeyCacheEntry_t KeyCache[SOFT_SE_KEY_CACHE_SIZE];
+
+/*
+ * Key cache usage counter
+ */
+static uint32_t KeyCacheUseCnt;
+#endif
+
+/*
+ * Entropy pool of the random numbers, kept apart from the srand1 generator
+ */
+static RandState_t RandomPool;
+
+/*
+ * Random numbers left before the next radio noise sample
+ */
+static uint8_t RandomPoolDraws = 0;
+
 static SecureElementNvmEvent SeNvmCtxChanged;
 
 /*
@@ -96,15 +208,84 @@ static SecureElementNvmEvent SeNvmCtxChanged;
  */
 SecureElementStatus_t GetKeyByID( KeyIdentifier_t keyID, Key_t** keyItem )
 {
-    for( uint8_t i = 0; i < NUM_OF_KEYS; i++ )
+    uint8_t index;
+
+    // The key list holds the unicast keys APP_KEY..MC_ROOT_KEY followed by
+    // the multicast keys MC_KE_KEY..SLOT_RAND_ZERO_KEY
+    if( keyID <= MC_ROOT_KEY )
+    {
+        index = ( uint8_t )keyID;
+    }
+    else if( ( keyID >= MC_KE_KEY ) && ( keyID <= SLOT_RAND_ZERO_KEY ) )
+    {
+        index = ( uint8_t )( keyID - MC_KE_KEY + MC_ROOT_KEY + 1 );
+    }
+    else
+    {
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+
+    *keyItem = &( SeNvmCtx.KeyList[index] );
+    return SECURE_ELEMENT_SUCCESS;
+}
+
+/*
+ * Drops the cached expanded key of the given key
+ *
+ * \param[IN]  keyID          - Key identifier
+ */
+static void InvalidateCachedKey( KeyIdentifier_t keyID )
+{
+    for( uint8_t i = 0; i < SOFT_SE_KEY_CACHE_SIZE; i++ )
     {
-        if( SeNvmCtx.KeyList[i].KeyID == keyID )
+        if( ( KeyCache[i].IsValid == true ) && ( KeyCache[i].KeyID == keyID ) )
         {
-            *keyItem = &( SeNvmCtx.KeyList[i] );
-            return SECURE_ELEMENT_SUCCESS;
+            memset1( ( uint8_t* )&KeyCache[i], 0, sizeof( KeyCacheEntry_t ) );
         }
     }
-    return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+}
+
+/*
+ * Drops all the cached expanded keys
+ */
+static void InvalidateCachedKeys( void )
+{
+    memset1( ( uint8_t* )KeyCache, 0, sizeof( KeyCache ) );
+}
+
+/*
+ * Gets the cached expanded key of the given key item. Expands the key into
+ * the least recently used entry when it is not cached.
+ *
+ * \param[IN]  keyID          - Key identifier
+ * \param[IN]  keyItem        - Key item of keyID
+ * \retval                    - Cache entry holding the expanded key
+ */
+static KeyCacheEntry_t* GetCachedKey( KeyIdentifier_t keyID, Key_t* keyItem )
+{
+    KeyCacheEntry_t* entry = &KeyCache[0];
+
+    for( uint8_t i = 0; i < SOFT_SE_KEY_CACHE_SIZE; i++ )
+    {
+        if( ( KeyCache[i].IsValid == true ) && ( KeyCache[i].KeyID == keyID ) )
+        {
+            KeyCache[i].LastUse = ++KeyCacheUseCnt;
+            return &KeyCache[i];
+        }
+        if( ( KeyCache[i].IsValid == false ) ||
+            ( ( entry->IsValid == true ) && ( ( KeyCacheUseCnt - KeyCache[i].LastUse ) > ( KeyCacheUseCnt - entry->LastUse ) ) ) )
+        {
+            entry = &KeyCache[i];
+        }
+    }
+
+    AES_CMAC_Init( &entry->CmacCtx );
+    AES_CMAC_SetKey( &entry->CmacCtx, keyItem->KeyValue );
+    entry->KeyID = keyID;
+    entry->IsValid = true;
+    entry->HasSubkeys = false;
+    entry->LastUse = ++KeyCacheUseCnt;
+    return entry;
 }
 
 /*
@@ -136,23 +317,28 @@ static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer,
 
     uint8_t Cmac[16];
 
-    AES_CMAC_Init( SeNvmCtx.AesCmacCtx );
-
     Key_t* keyItem;
     SecureElementStatus_t retval = GetKeyByID( keyID, &keyItem );
 
     if( retval == SECURE_ELEMENT_SUCCESS )
     {
-        AES_CMAC_SetKey( SeNvmCtx.AesCmacCtx, keyItem->KeyValue );
+        KeyCacheEntry_t* entry = GetCachedKey( keyID, keyItem );
+
+        if( entry->HasSubkeys == false )
+        {
+            AES_CMAC_Subkeys( &entry->CmacCtx, entry->K1, entry->K2 );
+            entry->HasSubkeys = true;
+        }
+        AES_CMAC_Restart( &entry->CmacCtx );
 
         if( micBxBuffer != NULL )
         {
-            AES_CMAC_Update( SeNvmCtx.AesCmacCtx, micBxBuffer, 16 );
+            AES_CMAC_Update( &entry->CmacCtx, micBxBuffer, 16 );
         }
 
-        AES_CMAC_Update( SeNvmCtx.AesCmacCtx, buffer, size );
+        AES_CMAC_Update( &entry->CmacCtx, buffer, size );
 
-        AES_CMAC_Final( Cmac, SeNvmCtx.AesCmacCtx );
+        AES_CMAC_FinalSubkeys( Cmac, &entry->CmacCtx, entry->K1, entry->K2 );
 
         // Bring into the required format
         *cmac = ( uint32_t )( ( uint32_t ) Cmac[3] << 24 | ( uint32_t ) Cmac[2] << 16 | ( uint32_t ) Cmac[1] << 8 | ( uint32_t ) Cmac[0] );
@@ -167,41 +353,20 @@ static SecureElementStatus_t ComputeCmac( uint8_t *micBxBuffer, uint8_t *buffer,
 
 SecureElementStatus_t SecureElementInit( SecureElementNvmEvent seNvmCtxChanged )
 {
-    uint8_t itr = 0;
-    uint8_t zeroKey[16] = { 0 };
+    Key_t* keyItem;
 
     // Initialize with defaults
-    SeNvmCtx.KeyList[itr++].KeyID = APP_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = GEN_APP_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = NWK_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = J_S_INT_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = J_S_ENC_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = F_NWK_S_INT_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = S_NWK_S_INT_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = NWK_S_ENC_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = APP_S_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_ROOT_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KE_KEY;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_0;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_0;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_0;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_1;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_1;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_1;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_2;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_2;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_2;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_KEY_3;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_APP_S_KEY_3;
-    SeNvmCtx.KeyList[itr++].KeyID = MC_NWK_S_KEY_3;
-    SeNvmCtx.KeyList[itr].KeyID = SLOT_RAND_ZERO_KEY;
+    SeNvmCtx.Version = SOFT_SE_NVM_CTX_VERSION;
 
     // Set standard keys
-    memcpy1( SeNvmCtx.KeyList[itr].KeyValue, zeroKey, KEY_SIZE );
+    GetKeyByID( SLOT_RAND_ZERO_KEY, &keyItem );
+    memset1( keyItem->KeyValue, 0, KEY_SIZE );
 
     memset1( SeNvmCtx.DevEui, 0, SE_EUI_SIZE );
     memset1( SeNvmCtx.JoinEui, 0, SE_EUI_SIZE );
 
+    InvalidateCachedKeys( );
+
     // Assign callback
     if( seNvmCtxChanged != 0 )
     {
@@ -220,7 +385,13 @@ SecureElementStatus_t SecureElementRestoreNvmCtx( void* seNvmCtx )
     // Restore nvm context
     if( seNvmCtx != 0 )
     {
+        if( ( ( SecureElementNvCtx_t* )seNvmCtx )->Version != SOFT_SE_NVM_CTX_VERSION )
+        {
+            // Stored with another context layout
+            return SECURE_ELEMENT_ERROR;
+        }
         memcpy1( ( uint8_t* ) &SeNvmCtx, ( uint8_t* ) seNvmCtx, sizeof( SeNvmCtx ) );
+        InvalidateCachedKeys( );
         return SECURE_ELEMENT_SUCCESS;
     }
     else
@@ -242,32 +413,33 @@ SecureElementStatus_t SecureElementSetKey( KeyIdentifier_t keyID, uint8_t* key )
         return SECURE_ELEMENT_ERROR_NPE;
     }
 
-    for( uint8_t i = 0; i < NUM_OF_KEYS; i++ )
+    Key_t* keyItem;
+
+    if( GetKeyByID( keyID, &keyItem ) != SECURE_ELEMENT_SUCCESS )
     {
-        if( SeNvmCtx.KeyList[i].KeyID == keyID )
-        {
-            if( ( keyID == MC_KEY_0 ) || ( keyID == MC_KEY_1 ) || ( keyID == MC_KEY_2 ) || ( keyID == MC_KEY_3 ) )
-            {  // Decrypt the key if its a Mckey
-                SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
-                uint8_t decryptedKey[16] = { 0 };
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
 
-                retval = SecureElementAesEncrypt( key, 16, MC_KE_KEY, decryptedKey );
+    if( ( keyID == MC_KEY_0 ) || ( keyID == MC_KEY_1 ) || ( keyID == MC_KEY_2 ) || ( keyID == MC_KEY_3 ) )
+    {  // Decrypt the key if its a Mckey
+        SecureElementStatus_t retval = SECURE_ELEMENT_ERROR;
+        uint8_t decryptedKey[16] = { 0 };
 
-                memcpy1( SeNvmCtx.KeyList[i].KeyValue, decryptedKey, KEY_SIZE );
-                SeNvmCtxChanged( );
+        retval = SecureElementAesEncrypt( key, 16, MC_KE_KEY, decryptedKey );
 
-                return retval;
-            }
-            else
-            {
-                memcpy1( SeNvmCtx.KeyList[i].KeyValue, key, KEY_SIZE );
-                SeNvmCtxChanged( );
-                return SECURE_ELEMENT_SUCCESS;
-            }
-        }
-    }
+        memcpy16( keyItem->KeyValue, decryptedKey );
+        InvalidateCachedKey( keyID );
+        SeNvmCtxChanged( );
 
-    return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+        return retval;
+    }
+    else
+    {
+        memcpy16( keyItem->KeyValue, key );
+        InvalidateCachedKey( keyID );
+        SeNvmCtxChanged( );
+        return SECURE_ELEMENT_SUCCESS;
+    }
 }
 
 SecureElementStatus_t SecureElementComputeAesCmac( uint8_t *micBxBuffer, uint8_t *buffer, uint16_t size, KeyIdentifier_t keyID, uint32_t* cmac )
@@ -277,6 +449,7 @@ SecureElementStatus_t SecureElementComputeAesCmac( uint8_t *micBxBuffer, uint8_t
         //Never accept multicast key identifier for cmac computation
         return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
     }
+    TRACE( TRACE_ID_CRYPTO, TRACE_CRYPTO_CMAC, size, keyID );
 
     return ComputeCmac( micBxBuffer, buffer, size, keyID, cmac );
 }
@@ -316,26 +489,130 @@ SecureElementStatus_t SecureElementAesEncrypt( uint8_t* buffer, uint16_t size, K
     {
         return SECURE_ELEMENT_ERROR_BUF_SIZE;
     }
-
-    memset1( SeNvmCtx.AesContext.ksch, '\0', 240 );
+    TRACE( TRACE_ID_CRYPTO, TRACE_CRYPTO_AES_ENCRYPT, size, keyID );
 
     Key_t* pItem;
     SecureElementStatus_t retval = GetKeyByID( keyID, &pItem );
 
     if( retval == SECURE_ELEMENT_SUCCESS )
     {
-        aes_set_key( pItem->KeyValue, 16, &SeNvmCtx.AesContext );
+#if defined( SECURE_ELEMENT_HW_AES )
+        // Encrypt all the blocks at once on the accelerator when available
+        if( AesMcuEncrypt( pItem->KeyValue, buffer, encBuffer, size / 16 ) == SUCCESS )
+        {
+            return SECURE_ELEMENT_SUCCESS;
+        }
+#endif
+        aes_context* aesContext = &GetCachedKey( keyID, pItem )->CmacCtx.rijndael;
+
+        aes_ecb_encrypt( buffer, encBuffer, size / 16, aesContext );
+    }
+    return retval;
+}
+
+SecureElementStatus_t SecureElementAesCtrCmac( uint8_t* micBxBuffer, uint8_t* buffer, uint16_t size, KeyIdentifier_t micKeyID,
+                                               uint8_t* aBlock, uint16_t encOffset, uint16_t encSize, KeyIdentifier_t encKeyID,
+                                               const uint8_t* keystream, uint16_t keystreamSize,
+                                               bool encrypt, uint8_t* encBuffer, uint32_t* cmac )
+{
+    if( ( micBxBuffer == NULL ) || ( buffer == NULL ) || ( aBlock == NULL ) || ( encBuffer == NULL ) || ( cmac == NULL ) )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+    TRACE( TRACE_ID_CRYPTO, TRACE_CRYPTO_CTR_CMAC, size, encKeyID );
+    if( micKeyID >= LORAMAC_CRYPTO_MULTICAST_KEYS )
+    {
+        //Never accept multicast key identifier for cmac computation
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+    if( ( ( uint32_t )encOffset + encSize ) > size )
+    {
+        return SECURE_ELEMENT_ERROR_BUF_SIZE;
+    }
+    if( keystream == NULL )
+    {
+        keystreamSize = 0;
+    }
+    if( ( keystreamSize % 16 ) != 0 )
+    {
+        return SECURE_ELEMENT_ERROR_BUF_SIZE;
+    }
+
+    Key_t* micKeyItem;
+    Key_t* encKeyItem;
+    if( ( GetKeyByID( micKeyID, &micKeyItem ) != SECURE_ELEMENT_SUCCESS ) ||
+        ( GetKeyByID( encKeyID, &encKeyItem ) != SECURE_ELEMENT_SUCCESS ) )
+    {
+        return SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+    }
+
+    // The CMAC entry is then the most recently used one and is not replaced
+    // when the AES key is fetched
+    KeyCacheEntry_t* micEntry = GetCachedKey( micKeyID, micKeyItem );
+    aes_context* aesContext = &GetCachedKey( encKeyID, encKeyItem )->CmacCtx.rijndael;
+
+    if( micEntry->HasSubkeys == false )
+    {
+        AES_CMAC_Subkeys( &micEntry->CmacCtx, micEntry->K1, micEntry->K2 );
+        micEntry->HasSubkeys = true;
+    }
+    AES_CMAC_Restart( &micEntry->CmacCtx );
+    AES_CMAC_Update( &micEntry->CmacCtx, micBxBuffer, 16 );
 
-        uint8_t block = 0;
+    uint8_t block[16];
+    // Key stream blocks are computed two at a time, the bitsliced AES
+    // encrypts them in a single pass
+    uint8_t ctrBlocks[32];
+    uint8_t sBlocks[32];
+
+    memcpy16( ctrBlocks, aBlock );
+    memcpy16( &ctrBlocks[16], aBlock );
+
+    for( uint16_t pos = 0; pos < size; pos += 16 )
+    {
+        uint8_t blockSize = ( ( size - pos ) > 16 ) ? 16 : ( uint8_t )( size - pos );
 
-        while( size != 0 )
+        for( uint8_t i = 0; i < blockSize; i++ )
         {
-            aes_encrypt( &buffer[block], &encBuffer[block], &SeNvmCtx.AesContext );
-            block = block + 16;
-            size = size - 16;
+            uint16_t index = pos + i;
+
+            block[i] = buffer[index];
+            if( ( index >= encOffset ) && ( index < ( encOffset + encSize ) ) )
+            {
+                uint16_t encIndex = index - encOffset;
+
+                if( encIndex < keystreamSize )
+                {
+                    encBuffer[encIndex] = block[i] ^ keystream[encIndex];
+                }
+                else
+                {
+                    uint16_t sIndex = ( encIndex - keystreamSize ) % 32;
+
+                    if( sIndex == 0 )
+                    {
+                        // Next key stream blocks
+                        ctrBlocks[15] = ( uint8_t )( ( encIndex >> 4 ) + 1 );
+                        ctrBlocks[31] = ( uint8_t )( ( encIndex >> 4 ) + 2 );
+                        aes_ecb_encrypt( ctrBlocks, sBlocks, ( ( encSize - encIndex ) > 16 ) ? 2 : 1, aesContext );
+                    }
+                    encBuffer[encIndex] = block[i] ^ sBlocks[sIndex];
+                }
+                if( encrypt == true )
+                {
+                    block[i] = encBuffer[encIndex];
+                }
+            }
         }
+        AES_CMAC_Update( &micEntry->CmacCtx, block, blockSize );
     }
-    return retval;
+
+    AES_CMAC_FinalSubkeys( block, &micEntry->CmacCtx, micEntry->K1, micEntry->K2 );
+
+    // Bring into the required format
+    *cmac = ( uint32_t )( ( uint32_t ) block[3] << 24 | ( uint32_t ) block[2] << 16 | ( uint32_t ) block[1] << 8 | ( uint32_t ) block[0] );
+
+    return SECURE_ELEMENT_SUCCESS;
 }
 
 SecureElementStatus_t SecureElementDeriveAndStoreKey( Version_t version, uint8_t* input, KeyIdentifier_t rootKeyID, KeyIdentifier_t targetKeyID )
@@ -374,13 +651,81 @@ SecureElementStatus_t SecureElementDeriveAndStoreKey( Version_t version, uint8_t
     return SECURE_ELEMENT_SUCCESS;
 }
 
+SecureElementStatus_t SecureElementDeriveAndStoreKeys( Version_t version, SecureElementKeyDerivation_t* derivations, uint8_t nbDerivations )
+{
+    if( derivations == NULL )
+    {
+        return SECURE_ELEMENT_ERROR_NPE;
+    }
+
+    SecureElementStatus_t retval = SECURE_ELEMENT_SUCCESS;
+    uint8_t i = 0;
+
+    for( i = 0; i < nbDerivations; i++ )
+    {
+        KeyIdentifier_t rootKeyID = derivations[i].RootKeyID;
+        KeyIdentifier_t targetKeyID = derivations[i].TargetKeyID;
+        Key_t* targetKeyItem;
+
+        if( derivations[i].Input == NULL )
+        {
+            retval = SECURE_ELEMENT_ERROR_NPE;
+            break;
+        }
+        // In case of MC_KE_KEY, prevent other keys than NwkKey or AppKey for LoRaWAN 1.1 or later
+        if( ( targetKeyID == MC_KE_KEY ) &&
+            ( ( ( rootKeyID == APP_KEY ) && ( version.Fields.Minor == 0 ) ) || ( rootKeyID == NWK_KEY ) ) )
+        {
+            retval = SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+            break;
+        }
+        // McKeys are only stored decrypted by the McKEKey
+        if( ( ( targetKeyID == MC_KEY_0 ) || ( targetKeyID == MC_KEY_1 ) || ( targetKeyID == MC_KEY_2 ) || ( targetKeyID == MC_KEY_3 ) ) &&
+            ( rootKeyID != MC_KE_KEY ) )
+        {
+            retval = SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+            break;
+        }
+        if( GetKeyByID( targetKeyID, &targetKeyItem ) != SECURE_ELEMENT_SUCCESS )
+        {
+            retval = SECURE_ELEMENT_ERROR_INVALID_KEY_ID;
+            break;
+        }
+
+        // Derive key, the root key schedule is taken from the key cache
+        uint8_t key[16] = { 0 };
+        retval = SecureElementAesEncrypt( derivations[i].Input, 16, rootKeyID, key );
+        if( retval != SECURE_ELEMENT_SUCCESS )
+        {
+            break;
+        }
+
+        // Store key
+        memcpy16( targetKeyItem->KeyValue, key );
+        InvalidateCachedKey( targetKeyID );
+    }
+
+    if( i > 0 )
+    {
+        // Keys stored before a failure are kept
+        SeNvmCtxChanged( );
+    }
+    return retval;
+}
+
 SecureElementStatus_t SecureElementRandomNumber( uint32_t* randomNum )
 {
     if( randomNum == NULL )
     {
         return SECURE_ELEMENT_ERROR_NPE;
     }
-    *randomNum = Radio.Random( );
+    if( RandomPoolDraws == 0 )
+    {
+        RandStateMix( &RandomPool, Radio.Random( ) );
+        RandomPoolDraws = SOFT_SE_RANDOM_RESEED_INTERVAL;
+    }
+    RandomPoolDraws--;
+    *randomNum = RandStateNext( &RandomPool );
     return SECURE_ELEMENT_SUCCESS;
 }
 
@@ -415,3 +760,15 @@ uint8_t* SecureElementGetJoinEui( void )
 {
     return SeNvmCtx.JoinEui;
 }
+
+#if defined( LORAMAC_INSTANCES_ENABLED )
+size_t SecureElementGetInstanceSize( void )
+{
+    return sizeof( SecureElementInstance_t );
+}
+
+void SecureElementSelectInstance( void* instance )
+{
+    SelectedInstance = ( instance != NULL ) ? ( SecureElementInstance_t* )instance : &DefaultInstance;
+}
+#endif
@@ -67,6 +67,10 @@ typedef struct
     /*!
      * \brief Rx Done callback prototype.
      *
+     * \remark The payload points to the driver reception buffer. It is lent
+     *         to the upper layer, which may parse and modify it in place,
+     *         until the next reception is started.
+     *
      * \param [IN] payload Received buffer pointer
      * \param [IN] size    Received buffer size
      * \param [IN] rssi    RSSI value computed while receiving the frame [dBm]
@@ -96,6 +100,34 @@ typedef struct
      * \param [IN] channelDetected    Channel Activity detected during the CAD
      */
     void ( *CadDone ) ( bool channelActivityDetected );
+    /*!
+     * \brief Carrier sense done callback prototype.
+     *
+     * \param [IN] channelFree  [true: Channel is free, false: Channel is not free]
+     */
+    void ( *CarrierSenseDone )( bool channelFree );
+    /*!
+     * \brief Radio IRQ pending callback prototype.
+     *
+     * \remark Called from the radio interrupt by the drivers which defer the
+     *         IRQ handling to \ref Radio_s.IrqProcess. Lets an RTOS wake up the
+     *         task calling \ref Radio_s.IrqProcess instead of polling it.
+     *
+     * \warning Runs in a IRQ context. Should only change variables state.
+     */
+    void ( *IrqNotify )( void );
+    /*!
+     * \brief Radio IRQ timestamp callback prototype. Optional.
+     *
+     * \remark Called from the interrupt which flags the end of a packet,
+     *         before the driver accesses the radio. The TxDone or RxDone
+     *         callback the interrupt leads to follows.
+     *
+     * \warning Runs in a IRQ context. Should only change variables state.
+     *
+     * \param [IN] timestamp Time of the interrupt, see TimerGetCurrentTime
+     */
+    void ( *IrqTimestamp )( uint32_t timestamp );
 }RadioEvents_t;
 
 /*!
@@ -253,6 +285,19 @@ struct Radio_s
      * \retval airTime        Computed airTime (ms) for the given packet payload length
      */
     uint32_t  ( *TimeOnAir )( RadioModems_t modem, uint8_t pktLen );
+    /*!
+     * \brief Loads the buffer of size and the packet parameters in the radio
+     *        ahead of the transmission. A following \ref Send call with the
+     *        same buffer and size only has to start the transmission.
+     *
+     * \remark The buffer content must not change until \ref Send is called.
+     *         Any configuration, reception or sleep request in between
+     *         discards the prepared packet.
+     *
+     * \param [IN]: buffer     Buffer pointer
+     * \param [IN]: size       Buffer size
+     */
+    void    ( *PrepareTx )( uint8_t *buffer, uint8_t size );
     /*!
      * \brief Sends the buffer of size. Prepares the packet to be sent and sets
      *        the radio in transmission
@@ -369,8 +414,72 @@ struct Radio_s
      * \param [in]  sleepTime     Structure describing sleep timeout value
      */
     void ( *SetRxDutyCycle ) ( uint32_t rxTime, uint32_t sleepTime );
+    /*
+     * The next functions are available only on SX1272 and SX1276 radios.
+     */
+    /*!
+     * \brief Reads the frequency error measured on the last received packet
+     *
+     * \remark Available on SX1272 and SX1276 radios only.
+     *
+     * \retval freqError Frequency error [Hz]
+     */
+    int32_t ( *GetFreqError )( void );
+    /*
+     * The next functions are available on all radios.
+     */
+    /*!
+     * \brief Starts a carrier sense on the given channel without blocking
+     *
+     * \remark The RSSI is sampled from a timer event, the MCU may sleep in
+     *         between. The result is reported by the CarrierSenseDone
+     *         callback, the radio is then back in sleep mode.
+     *         Radio.Sleep and Radio.Standby abort the carrier sense.
+     *
+     * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
+     * \param [IN] freq       Channel RF frequency
+     * \param [IN] rssiThresh RSSI threshold
+     * \param [IN] maxCarrierSenseTime Max time while the RSSI is measured
+     */
+    void ( *StartCarrierSense )( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
+    /*!
+     * \brief Measures the time from the wakeup command to the radio ready on
+     *        its oscillator and uses it as GetWakeupTime
+     *
+     * \remark The radio is left in sleep mode. The measured time is never
+     *         above the board and radio constants.
+     *
+     * \retval time Calibrated wakeup time in ms.
+     */
+    uint32_t ( *CalibrateWakeupTime )( void );
+    /*!
+     * \brief Sets the wakeup time returned by GetWakeupTime, e.g. a
+     *        CalibrateWakeupTime result restored from the NVM
+     *
+     * \param [IN] time Wakeup time in ms, 0 restores the board and radio constants
+     */
+    void ( *SetWakeupTime )( uint32_t time );
 };
 
+#if defined( USE_RADIO_STATIC_BINDING )
+/*!
+ * \brief Radio driver
+ *
+ * \remark The driver functions are bound at compile time so that every
+ *         Radio.X() call becomes a direct call to the selected driver.
+ */
+#if defined( RADIO_SX1272 )
+#include "sx1272-binding.h"
+#elif defined( RADIO_SX1276 )
+#include "sx1276-binding.h"
+#elif defined( RADIO_SX126X )
+#include "sx126x-binding.h"
+#elif defined( RADIO_SIM )
+#include "sim-binding.h"
+#else
+#error "USE_RADIO_STATIC_BINDING requires one of RADIO_SX1272, RADIO_SX1276, RADIO_SX126X or RADIO_SIM"
+#endif
+#else
 /*!
  * \brief Radio driver
  *
@@ -378,6 +487,18 @@ struct Radio_s
  *         board implementation
  */
 extern const struct Radio_s Radio;
+#endif
+
+#if defined( SX126X_SECOND_INSTANCE )
+/*!
+ * \brief Second SX126x radio driver
+ *
+ * \remark The board provides its own SPI and GPIO set, see the board
+ *         board-config.h RADIO1_* pins definitions. It is always bound through
+ *         its function pointers table.
+ */
+extern const struct Radio_s Radio1;
+#endif
 
 #ifdef __cplusplus
 }
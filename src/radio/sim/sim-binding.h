@@ -0,0 +1,77 @@
+/*!
+ * \file      sim-binding.h
+ *
+ * \brief     Simulated radio driver compile time binding
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __SIM_BINDING_H__
+#define __SIM_BINDING_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stddef.h>
+#include "radio.h"
+#include "sim-radio.h"
+
+/*!
+ * \brief Radio driver bound at compile time
+ *
+ * \remark Every translation unit gets its own constant copy which the
+ *         compiler folds into direct calls to the driver functions.
+ */
+static const struct Radio_s Radio =
+{
+    SimRadioInit,
+    SimRadioGetStatus,
+    SimRadioSetModem,
+    SimRadioSetChannel,
+    SimRadioIsChannelFree,
+    SimRadioRandom,
+    SimRadioSetRxConfig,
+    SimRadioSetTxConfig,
+    SimRadioCheckRfFrequency,
+    SimRadioGetTimeOnAir,
+    SimRadioPrepareTx,
+    SimRadioSend,
+    SimRadioSetSleep,
+    SimRadioSetStby,
+    SimRadioSetRx,
+    SimRadioStartCad,
+    SimRadioSetTxContinuousWave,
+    SimRadioReadRssi,
+    SimRadioWrite,
+    SimRadioRead,
+    SimRadioWriteBuffer,
+    SimRadioReadBuffer,
+    SimRadioSetMaxPayloadLength,
+    SimRadioSetPublicNetwork,
+    SimRadioGetWakeupTime,
+    NULL, // void ( *IrqProcess )( void )
+    NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
+    NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    NULL, // int32_t ( *GetFreqError )( void ) - SX1272 and SX1276 Only
+    SimRadioStartCarrierSense,
+    NULL, // uint32_t ( *CalibrateWakeupTime )( void ) - SX126x Only
+    NULL, // void ( *SetWakeupTime )( uint32_t time ) - SX126x Only
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIM_BINDING_H__
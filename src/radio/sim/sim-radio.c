@@ -0,0 +1,799 @@
+/*!
+ * \file      sim-radio.c
+ *
+ * \brief     Simulated radio driver running against a virtual air interface
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <string.h>
+#include "utilities.h"
+#include "timer.h"
+#include "radio.h"
+#include "timeonair.h"
+#include "energy.h"
+#include "sim-radio.h"
+
+/*
+ * Local types definition
+ */
+
+/*!
+ * Modem settings, as given to SetRxConfig and SetTxConfig
+ */
+typedef struct
+{
+    uint32_t Bandwidth;
+    uint32_t Datarate;
+    uint8_t  Coderate;
+    uint16_t PreambleLen;
+    uint16_t SymbTimeout;
+    bool     FixLen;
+    uint8_t  PayloadLen;
+    bool     CrcOn;
+    bool     IqInverted;
+    bool     RxContinuous;
+}SimRadioModemSettings_t;
+
+/*!
+ * Radio settings
+ */
+typedef struct
+{
+    RadioState_t            State;
+    RadioModems_t           Modem;
+    uint32_t                Channel;
+    bool                    PublicNetwork;
+    uint8_t                 MaxPayloadLength;
+    SimRadioModemSettings_t Rx;
+    SimRadioModemSettings_t Tx;
+    uint32_t                TxTimeout;
+    /*!
+     * Set while a frame addressed to the radio is being received
+     */
+    bool                    RxBusy;
+}SimRadioSettings_t;
+
+/*
+ * Private functions prototypes
+ */
+
+/*!
+ * \brief Computes the time on air of a frame sent with the given settings
+ *
+ * \param [IN] modem    Radio modem
+ * \param [IN] settings Modem settings
+ * \param [IN] pktLen   Packet payload length
+ * \retval airTime      Time on air [ms]
+ */
+static uint32_t SimRadioFrameTimeOnAir( RadioModems_t modem, SimRadioModemSettings_t *settings, uint8_t pktLen );
+
+/*!
+ * \brief Checks if the radio listens to the given frame
+ *
+ * \param [IN] frame Frame on the air
+ * \retval match     [true: the frame can be received, false: it is ignored]
+ */
+static bool SimRadioRxMatch( SimRadioFrame_t *frame );
+
+/*!
+ * \brief Aborts the reception of the frame currently on the air, if any
+ */
+static void SimRadioAbortRx( void );
+
+/*!
+ * \brief Draws whether a frame gets lost on the air
+ *
+ * \retval lost [true: frame lost, false: frame delivered]
+ */
+static bool SimRadioAirIsLost( void );
+
+/*!
+ * \brief Computes the time on air of the air frame preamble
+ *
+ * \retval airTime Preamble time on air [ms]
+ */
+static uint32_t SimRadioAirPreambleTime( void );
+
+/*!
+ * \brief Locks the receiver on the air frame preamble
+ *
+ * \param [IN] elapsed Time already elapsed since the frame start [ms]
+ */
+static void SimRadioRxLock( uint32_t elapsed );
+
+/*!
+ * \brief Tx timer callback, end of the transmission
+ */
+static void OnSimRadioTxTimerEvent( void* context );
+
+/*!
+ * \brief Rx timeout timer callback
+ */
+static void OnSimRadioRxTimeoutTimerEvent( void* context );
+
+/*!
+ * \brief Air frame timer callback, the frame reaches the antenna
+ */
+static void OnSimRadioAirFrameTimerEvent( void* context );
+
+/*!
+ * \brief Rx done timer callback, end of the frame reception
+ */
+static void OnSimRadioRxDoneTimerEvent( void* context );
+
+/*!
+ * \brief CAD timer callback
+ */
+static void OnSimRadioCadTimerEvent( void* context );
+
+/*!
+ * \brief Carrier sense timer callback
+ */
+static void OnSimRadioCarrierSenseTimerEvent( void* context );
+
+#if !defined( USE_RADIO_STATIC_BINDING )
+/*!
+ * Radio driver structure initialization
+ */
+const struct Radio_s Radio =
+{
+    SimRadioInit,
+    SimRadioGetStatus,
+    SimRadioSetModem,
+    SimRadioSetChannel,
+    SimRadioIsChannelFree,
+    SimRadioRandom,
+    SimRadioSetRxConfig,
+    SimRadioSetTxConfig,
+    SimRadioCheckRfFrequency,
+    SimRadioGetTimeOnAir,
+    SimRadioPrepareTx,
+    SimRadioSend,
+    SimRadioSetSleep,
+    SimRadioSetStby,
+    SimRadioSetRx,
+    SimRadioStartCad,
+    SimRadioSetTxContinuousWave,
+    SimRadioReadRssi,
+    SimRadioWrite,
+    SimRadioRead,
+    SimRadioWriteBuffer,
+    SimRadioReadBuffer,
+    SimRadioSetMaxPayloadLength,
+    SimRadioSetPublicNetwork,
+    SimRadioGetWakeupTime,
+    NULL, // void ( *IrqProcess )( void )
+    NULL, // void ( *RxBoosted )( uint32_t timeout ) - SX126x Only
+    NULL, // void ( *SetRxDutyCycle )( uint32_t rxTime, uint32_t sleepTime ) - SX126x Only
+    NULL, // int32_t ( *GetFreqError )( void ) - SX1272 and SX1276 Only
+    SimRadioStartCarrierSense,
+    NULL, // uint32_t ( *CalibrateWakeupTime )( void ) - SX126x Only
+    NULL, // void ( *SetWakeupTime )( uint32_t time ) - SX126x Only
+};
+#endif
+
+/*
+ * Private global variables
+ */
+
+/*!
+ * Radio callbacks variable
+ */
+static RadioEvents_t *RadioEvents;
+
+/*!
+ * Air interface callbacks variable
+ */
+static SimRadioAirEvents_t *AirEvents;
+
+/*!
+ * Air interface channel model
+ */
+static SimRadioAirParams_t AirParams =
+{
+    .Latency = 0,
+    .LossRate = 0,
+    .Rssi = -60,
+    .Snr = 10,
+    .NoiseFloor = -120,
+};
+
+/*!
+ * Radio settings
+ */
+static SimRadioSettings_t Settings;
+
+/*!
+ * Simulated register file
+ */
+static uint8_t Regs[SIM_RADIO_REGS_SIZE];
+
+/*!
+ * Transmission buffer, filled by PrepareTx
+ */
+static uint8_t TxBuffer[255];
+
+/*!
+ * Transmission buffer size, 0 when no frame is prepared
+ */
+static uint8_t TxBufferSize = 0;
+
+/*!
+ * Reception buffer
+ */
+static uint8_t RxBuffer[255];
+
+/*!
+ * Frame on the air towards the radio
+ */
+static SimRadioFrame_t AirFrame;
+
+/*!
+ * Set while a frame is on the air towards the radio
+ */
+static bool AirFrameScheduled = false;
+
+/*!
+ * Set while the air frame preamble is on the air and no receiver locked on it
+ */
+static bool AirFramePreamble = false;
+
+/*!
+ * Air frame start time
+ */
+static TimerTime_t AirFrameStartTime;
+
+/*!
+ * Last modem configuration set. As on the real transceivers, the time on air
+ * is computed from it.
+ */
+static SimRadioModemSettings_t *LastConfig = &Settings.Tx;
+
+/*!
+ * Air frame payload copy
+ */
+static uint8_t AirFramePayload[255];
+
+/*!
+ * Radio timers
+ */
+static TimerEvent_t TxTimer;
+static TimerEvent_t RxTimeoutTimer;
+static TimerEvent_t AirFrameTimer;
+static TimerEvent_t RxDoneTimer;
+static TimerEvent_t CadTimer;
+static TimerEvent_t CarrierSenseTimer;
+
+/*!
+ * Carrier sense result reported at the end of the sensing time
+ */
+static bool CarrierSenseChannelFree;
+
+/*
+ * Virtual air interface
+ */
+
+void SimRadioAirInit( SimRadioAirEvents_t *events )
+{
+    AirEvents = events;
+}
+
+void SimRadioAirSetParams( SimRadioAirParams_t *params )
+{
+    AirParams = *params;
+}
+
+void SimRadioAirGetParams( SimRadioAirParams_t *params )
+{
+    *params = AirParams;
+}
+
+bool SimRadioAirTx( SimRadioFrame_t *frame, uint32_t delay )
+{
+    if( AirFrameScheduled == true )
+    {
+        return false;
+    }
+    AirFrame = *frame;
+    memcpy1( AirFramePayload, frame->Payload, frame->Size );
+    AirFrame.Payload = AirFramePayload;
+    AirFrameScheduled = true;
+    AirFramePreamble = false;
+
+    TimerSetValue( &AirFrameTimer, MAX( delay + AirParams.Latency, 1 ) );
+    TimerStart( &AirFrameTimer );
+    return true;
+}
+
+/*
+ * Radio driver functions implementation
+ */
+
+void SimRadioInit( RadioEvents_t *events )
+{
+    RadioEvents = events;
+
+    TimerInit( &TxTimer, OnSimRadioTxTimerEvent );
+    TimerInit( &RxTimeoutTimer, OnSimRadioRxTimeoutTimerEvent );
+    TimerInit( &AirFrameTimer, OnSimRadioAirFrameTimerEvent );
+    TimerInit( &RxDoneTimer, OnSimRadioRxDoneTimerEvent );
+    TimerInit( &CadTimer, OnSimRadioCadTimerEvent );
+    TimerInit( &CarrierSenseTimer, OnSimRadioCarrierSenseTimerEvent );
+
+    memset1( ( uint8_t* )&Settings, 0, sizeof( SimRadioSettings_t ) );
+    Settings.State = RF_IDLE;
+    Settings.MaxPayloadLength = 0xFF;
+    LastConfig = &Settings.Tx;
+    AirFrameScheduled = false;
+    AirFramePreamble = false;
+    TxBufferSize = 0;
+}
+
+RadioState_t SimRadioGetStatus( void )
+{
+    return Settings.State;
+}
+
+void SimRadioSetModem( RadioModems_t modem )
+{
+    Settings.Modem = modem;
+}
+
+void SimRadioSetChannel( uint32_t freq )
+{
+    Settings.Channel = freq;
+}
+
+bool SimRadioIsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
+{
+    SimRadioSetModem( modem );
+    SimRadioSetChannel( freq );
+
+    return AirParams.NoiseFloor <= rssiThresh;
+}
+
+void SimRadioStartCarrierSense( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
+{
+    SimRadioSetStby( );
+    CarrierSenseChannelFree = SimRadioIsChannelFree( modem, freq, rssiThresh, maxCarrierSenseTime );
+
+    // Only the energy of the reception is accounted, the air frames are not
+    // received while sensing
+    EnergySetRadioState( ENERGY_RADIO_RX );
+    TimerSetValue( &CarrierSenseTimer, MAX( maxCarrierSenseTime, 1 ) );
+    TimerStart( &CarrierSenseTimer );
+}
+
+uint32_t SimRadioRandom( void )
+{
+    return ( ( uint32_t )randr( 0, 0xFFFF ) << 16 ) | ( uint32_t )randr( 0, 0xFFFF );
+}
+
+void SimRadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
+                          uint32_t datarate, uint8_t coderate,
+                          uint32_t bandwidthAfc, uint16_t preambleLen,
+                          uint16_t symbTimeout, bool fixLen,
+                          uint8_t payloadLen,
+                          bool crcOn, bool freqHopOn, uint8_t hopPeriod,
+                          bool iqInverted, bool rxContinuous )
+{
+    SimRadioSetModem( modem );
+
+    Settings.Rx.Bandwidth = bandwidth;
+    Settings.Rx.Datarate = datarate;
+    Settings.Rx.Coderate = coderate;
+    Settings.Rx.PreambleLen = preambleLen;
+    Settings.Rx.SymbTimeout = symbTimeout;
+    Settings.Rx.FixLen = fixLen;
+    Settings.Rx.PayloadLen = payloadLen;
+    Settings.Rx.CrcOn = crcOn;
+    Settings.Rx.IqInverted = ( modem == MODEM_LORA ) ? iqInverted : false;
+    Settings.Rx.RxContinuous = rxContinuous;
+    LastConfig = &Settings.Rx;
+}
+
+void SimRadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
+                          uint32_t bandwidth, uint32_t datarate,
+                          uint8_t coderate, uint16_t preambleLen,
+                          bool fixLen, bool crcOn, bool freqHopOn,
+                          uint8_t hopPeriod, bool iqInverted, uint32_t timeout )
+{
+    SimRadioSetModem( modem );
+    EnergySetRadioTxPower( power );
+
+    Settings.Tx.Bandwidth = bandwidth;
+    Settings.Tx.Datarate = datarate;
+    Settings.Tx.Coderate = coderate;
+    Settings.Tx.PreambleLen = preambleLen;
+    Settings.Tx.FixLen = fixLen;
+    Settings.Tx.CrcOn = crcOn;
+    Settings.Tx.IqInverted = ( modem == MODEM_LORA ) ? iqInverted : false;
+    Settings.TxTimeout = timeout;
+    LastConfig = &Settings.Tx;
+}
+
+bool SimRadioCheckRfFrequency( uint32_t frequency )
+{
+    // Any frequency is supported by the virtual air interface
+    return true;
+}
+
+uint32_t SimRadioGetTimeOnAir( RadioModems_t modem, uint8_t pktLen )
+{
+    return SimRadioFrameTimeOnAir( modem, LastConfig, pktLen );
+}
+
+void SimRadioPrepareTx( uint8_t *buffer, uint8_t size )
+{
+    memcpy1( TxBuffer, buffer, size );
+    TxBufferSize = size;
+}
+
+void SimRadioSend( uint8_t *buffer, uint8_t size )
+{
+    if( ( TxBufferSize != size ) || ( memcmp( TxBuffer, buffer, size ) != 0 ) )
+    {
+        SimRadioPrepareTx( buffer, size );
+    }
+
+    TimerStop( &RxTimeoutTimer );
+    SimRadioAbortRx( );
+
+    Settings.State = RF_TX_RUNNING;
+    EnergySetRadioState( ENERGY_RADIO_TX );
+    TimerSetValue( &TxTimer, MAX( SimRadioFrameTimeOnAir( Settings.Modem, &Settings.Tx, size ), 1 ) );
+    TimerStart( &TxTimer );
+}
+
+void SimRadioSetSleep( void )
+{
+    SimRadioSetStby( );
+    EnergySetRadioState( ENERGY_RADIO_SLEEP );
+}
+
+void SimRadioSetStby( void )
+{
+    TimerStop( &TxTimer );
+    TimerStop( &RxTimeoutTimer );
+    TimerStop( &CadTimer );
+    TimerStop( &CarrierSenseTimer );
+    SimRadioAbortRx( );
+    Settings.State = RF_IDLE;
+    EnergySetRadioState( ENERGY_RADIO_STANDBY );
+    TxBufferSize = 0;
+}
+
+void SimRadioSetRx( uint32_t timeout )
+{
+    TimerStop( &TxTimer );
+    SimRadioAbortRx( );
+    TxBufferSize = 0;
+
+    if( ( Settings.Rx.RxContinuous == false ) && ( Settings.Modem == MODEM_LORA ) && ( Settings.Rx.SymbTimeout != 0 ) )
+    {
+        // The radio stops listening when no preamble shows up within the symbols timeout
+        uint32_t bandwidth = 125000 << Settings.Rx.Bandwidth;
+        uint32_t symbTimeout = ( ( ( ( uint32_t )Settings.Rx.SymbTimeout << Settings.Rx.Datarate ) * 1000 ) + bandwidth - 1 ) / bandwidth;
+
+        timeout = ( timeout == 0 ) ? symbTimeout : MIN( timeout, symbTimeout );
+    }
+
+    Settings.State = RF_RX_RUNNING;
+    EnergySetRadioState( ENERGY_RADIO_RX );
+    TimerStop( &RxTimeoutTimer );
+    if( timeout != 0 )
+    {
+        TimerSetValue( &RxTimeoutTimer, MAX( timeout, 1 ) );
+        TimerStart( &RxTimeoutTimer );
+    }
+
+    // A receiver started during the preamble of a frame still locks on it
+    if( ( AirFramePreamble == true ) && ( SimRadioRxMatch( &AirFrame ) == true ) )
+    {
+        SimRadioRxLock( TimerGetElapsedTime( AirFrameStartTime ) );
+    }
+}
+
+void SimRadioStartCad( void )
+{
+    Settings.State = RF_CAD;
+    EnergySetRadioState( ENERGY_RADIO_RX );
+    TimerSetValue( &CadTimer, 1 );
+    TimerStart( &CadTimer );
+}
+
+void SimRadioSetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time )
+{
+    uint32_t timeout = ( uint32_t )time * 1000;
+
+    SimRadioSetChannel( freq );
+    TxBufferSize = 0;
+
+    EnergySetRadioTxPower( power );
+    Settings.State = RF_TX_RUNNING;
+    EnergySetRadioState( ENERGY_RADIO_TX );
+    TimerSetValue( &TxTimer, MAX( timeout, 1 ) );
+    TimerStart( &TxTimer );
+}
+
+int16_t SimRadioReadRssi( RadioModems_t modem )
+{
+    return ( Settings.RxBusy == true ) ? AirParams.Rssi : AirParams.NoiseFloor;
+}
+
+void SimRadioWrite( uint16_t addr, uint8_t data )
+{
+    SimRadioWriteBuffer( addr, &data, 1 );
+}
+
+uint8_t SimRadioRead( uint16_t addr )
+{
+    uint8_t data;
+    SimRadioReadBuffer( addr, &data, 1 );
+    return data;
+}
+
+void SimRadioWriteBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
+{
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        Regs[( addr + i ) % SIM_RADIO_REGS_SIZE] = buffer[i];
+    }
+}
+
+void SimRadioReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
+{
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        buffer[i] = Regs[( addr + i ) % SIM_RADIO_REGS_SIZE];
+    }
+}
+
+void SimRadioSetMaxPayloadLength( RadioModems_t modem, uint8_t max )
+{
+    SimRadioSetModem( modem );
+    Settings.MaxPayloadLength = max;
+}
+
+void SimRadioSetPublicNetwork( bool enable )
+{
+    Settings.PublicNetwork = enable;
+}
+
+uint32_t SimRadioGetWakeupTime( void )
+{
+    return RADIO_WAKEUP_TIME;
+}
+
+/*
+ * Private functions
+ */
+
+static uint32_t SimRadioFrameTimeOnAir( RadioModems_t modem, SimRadioModemSettings_t *settings, uint8_t pktLen )
+{
+    uint32_t airTime = 0;
+
+    switch( modem )
+    {
+    case MODEM_FSK:
+        {
+            // Preamble, 3 bytes sync word, length byte, payload and CRC
+            airTime = TimeOnAirFsk( settings->Datarate,
+                                    settings->PreambleLen + 3 +
+                                    ( ( settings->FixLen == true ) ? 0 : 1 ) +
+                                    pktLen +
+                                    ( ( settings->CrcOn == true ) ? 2 : 0 ),
+                                    false );
+        }
+        break;
+    case MODEM_LORA:
+        {
+            bool lowDatarateOptimize = ( ( settings->Bandwidth == 0 ) && ( ( settings->Datarate == 11 ) || ( settings->Datarate == 12 ) ) ) ||
+                                       ( ( settings->Bandwidth == 1 ) && ( settings->Datarate == 12 ) );
+
+            airTime = TimeOnAirToMs( TimeOnAirLoRa( settings->Bandwidth, settings->Datarate, settings->Coderate,
+                                                    settings->PreambleLen, settings->FixLen, pktLen,
+                                                    settings->CrcOn, lowDatarateOptimize ) );
+        }
+        break;
+    }
+    return airTime;
+}
+
+static bool SimRadioRxMatch( SimRadioFrame_t *frame )
+{
+    if( ( Settings.State != RF_RX_RUNNING ) || ( Settings.RxBusy == true ) )
+    {
+        return false;
+    }
+    if( ( frame->Modem != Settings.Modem ) || ( frame->Frequency != Settings.Channel ) ||
+        ( frame->Datarate != Settings.Rx.Datarate ) )
+    {
+        return false;
+    }
+    if( ( frame->Modem == MODEM_LORA ) &&
+        ( ( frame->Bandwidth != Settings.Rx.Bandwidth ) || ( frame->IqInverted != Settings.Rx.IqInverted ) ) )
+    {
+        return false;
+    }
+    if( ( frame->Size > Settings.MaxPayloadLength ) ||
+        ( ( Settings.Rx.FixLen == true ) && ( frame->Size != Settings.Rx.PayloadLen ) ) )
+    {
+        return false;
+    }
+    return true;
+}
+
+static void SimRadioAbortRx( void )
+{
+    TimerStop( &RxDoneTimer );
+    if( Settings.RxBusy == true )
+    {
+        Settings.RxBusy = false;
+        AirFrameScheduled = false;
+    }
+}
+
+static bool SimRadioAirIsLost( void )
+{
+    return ( AirParams.LossRate != 0 ) && ( randr( 0, 99 ) < AirParams.LossRate );
+}
+
+static void OnSimRadioTxTimerEvent( void* context )
+{
+    SimRadioFrame_t frame;
+
+    TimerStop( &TxTimer );
+    Settings.State = RF_IDLE;
+    EnergySetRadioState( ENERGY_RADIO_STANDBY );
+
+    if( TxBufferSize != 0 )
+    {
+        frame.Modem = Settings.Modem;
+        frame.Frequency = Settings.Channel;
+        frame.Bandwidth = Settings.Tx.Bandwidth;
+        frame.Datarate = Settings.Tx.Datarate;
+        frame.Coderate = Settings.Tx.Coderate;
+        frame.IqInverted = Settings.Tx.IqInverted;
+        frame.PreambleLen = Settings.Tx.PreambleLen;
+        frame.Payload = TxBuffer;
+        frame.Size = TxBufferSize;
+        TxBufferSize = 0;
+
+        if( ( AirEvents != NULL ) && ( AirEvents->OnTx != NULL ) && ( SimRadioAirIsLost( ) == false ) )
+        {
+            AirEvents->OnTx( &frame );
+        }
+    }
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->TxDone != NULL ) )
+    {
+        RadioEvents->TxDone( );
+    }
+}
+
+static void OnSimRadioRxTimeoutTimerEvent( void* context )
+{
+    TimerStop( &RxTimeoutTimer );
+
+    if( Settings.RxBusy == true )
+    {
+        // A frame is being received, the timeout only applies to its preamble
+        return;
+    }
+    if( Settings.State == RF_RX_RUNNING )
+    {
+        Settings.State = RF_IDLE;
+        EnergySetRadioState( ENERGY_RADIO_STANDBY );
+        if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
+        {
+            RadioEvents->RxTimeout( );
+        }
+    }
+}
+
+static void OnSimRadioAirFrameTimerEvent( void* context )
+{
+    TimerStop( &AirFrameTimer );
+
+    if( AirFramePreamble == true )
+    {
+        // End of the preamble, no receiver locked on the frame
+        AirFramePreamble = false;
+        AirFrameScheduled = false;
+        return;
+    }
+    if( SimRadioAirIsLost( ) == true )
+    {
+        AirFrameScheduled = false;
+        return;
+    }
+    if( SimRadioRxMatch( &AirFrame ) == false )
+    {
+        // Keep the frame on the air while its preamble lasts
+        AirFramePreamble = true;
+        AirFrameStartTime = TimerGetCurrentTime( );
+        TimerSetValue( &AirFrameTimer, MAX( SimRadioAirPreambleTime( ), 1 ) );
+        TimerStart( &AirFrameTimer );
+        return;
+    }
+    SimRadioRxLock( 0 );
+}
+
+static uint32_t SimRadioAirPreambleTime( void )
+{
+    if( AirFrame.Modem == MODEM_LORA )
+    {
+        uint32_t bandwidth = 125000 << AirFrame.Bandwidth;
+
+        return ( ( ( uint32_t )AirFrame.PreambleLen << AirFrame.Datarate ) * 1000 ) / bandwidth;
+    }
+    return ( ( uint32_t )AirFrame.PreambleLen * 8000 ) / MAX( AirFrame.Datarate, 1 );
+}
+
+static void SimRadioRxLock( uint32_t elapsed )
+{
+    uint32_t airTime = SimRadioFrameTimeOnAir( AirFrame.Modem, &Settings.Rx, AirFrame.Size );
+
+    // Preamble detected, the reception runs until the end of the frame
+    TimerStop( &AirFrameTimer );
+    TimerStop( &RxTimeoutTimer );
+    AirFramePreamble = false;
+    Settings.RxBusy = true;
+    TimerSetValue( &RxDoneTimer, MAX( airTime - MIN( elapsed, airTime ), 1 ) );
+    TimerStart( &RxDoneTimer );
+}
+
+static void OnSimRadioRxDoneTimerEvent( void* context )
+{
+    uint8_t size = AirFrame.Size;
+
+    TimerStop( &RxDoneTimer );
+    Settings.RxBusy = false;
+    AirFrameScheduled = false;
+
+    memcpy1( RxBuffer, AirFrame.Payload, size );
+    if( Settings.Rx.RxContinuous == false )
+    {
+        Settings.State = RF_IDLE;
+        EnergySetRadioState( ENERGY_RADIO_STANDBY );
+    }
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+    {
+        RadioEvents->RxDone( RxBuffer, size, AirParams.Rssi, AirParams.Snr );
+    }
+}
+
+static void OnSimRadioCarrierSenseTimerEvent( void* context )
+{
+    SimRadioSetSleep( );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->CarrierSenseDone != NULL ) )
+    {
+        RadioEvents->CarrierSenseDone( CarrierSenseChannelFree );
+    }
+}
+
+static void OnSimRadioCadTimerEvent( void* context )
+{
+    TimerStop( &CadTimer );
+    Settings.State = RF_IDLE;
+    EnergySetRadioState( ENERGY_RADIO_STANDBY );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->CadDone != NULL ) )
+    {
+        RadioEvents->CadDone( AirFrameScheduled );
+    }
+}
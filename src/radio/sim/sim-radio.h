@@ -0,0 +1,401 @@
+/*!
+ * \file      sim-radio.h
+ *
+ * \brief     Simulated radio driver running against a virtual air interface
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+/*
+ * radio.h is included ahead of the include guard. With
+ * USE_RADIO_STATIC_BINDING, radio.h pulls in sim-binding.h, which in turn
+ * needs the complete prototypes of this file.
+ */
+#include "radio.h"
+
+#ifndef __SIM_RADIO_H__
+#define __SIM_RADIO_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * Radio wake up time from sleep
+ */
+#define RADIO_WAKEUP_TIME                           1 // [ms]
+
+/*!
+ * Size of the simulated register file
+ */
+#define SIM_RADIO_REGS_SIZE                         256
+
+/*!
+ * Radio frame travelling over the virtual air interface
+ */
+typedef struct sSimRadioFrame
+{
+    /*!
+     * Modem used to send the frame
+     */
+    RadioModems_t Modem;
+    /*!
+     * RF frequency [Hz]
+     */
+    uint32_t Frequency;
+    /*!
+     * Bandwidth. Same encoding as Radio.SetTxConfig
+     */
+    uint32_t Bandwidth;
+    /*!
+     * Datarate. Same encoding as Radio.SetTxConfig
+     */
+    uint32_t Datarate;
+    /*!
+     * Coding rate (LoRa only)
+     */
+    uint8_t Coderate;
+    /*!
+     * IQ signals inverted (LoRa only)
+     */
+    bool IqInverted;
+    /*!
+     * Preamble length [symbols (LoRa), bytes (FSK)]
+     */
+    uint16_t PreambleLen;
+    /*!
+     * Frame payload
+     */
+    uint8_t *Payload;
+    /*!
+     * Frame payload size
+     */
+    uint8_t Size;
+}SimRadioFrame_t;
+
+/*!
+ * Virtual air interface channel model
+ */
+typedef struct sSimRadioAirParams
+{
+    /*!
+     * Delay added to every frame put on the air [ms]
+     */
+    uint32_t Latency;
+    /*!
+     * Probability to lose a frame, in either direction [%]
+     */
+    uint8_t LossRate;
+    /*!
+     * RSSI reported for the received frames [dBm]
+     */
+    int16_t Rssi;
+    /*!
+     * SNR reported for the received frames [dB]
+     */
+    int8_t Snr;
+    /*!
+     * RSSI reported when no frame is on the air [dBm]
+     */
+    int16_t NoiseFloor;
+}SimRadioAirParams_t;
+
+/*!
+ * Virtual air interface callbacks, implemented by the peer simulation
+ */
+typedef struct sSimRadioAirEvents
+{
+    /*!
+     * \brief A frame sent by the radio went over the air
+     *
+     * \remark Called at the end of the transmission, before the radio
+     *         TxDone event. Lost frames are not reported.
+     *
+     * \param [IN] frame Transmitted frame
+     */
+    void ( *OnTx )( SimRadioFrame_t *frame );
+}SimRadioAirEvents_t;
+
+/*!
+ * ============================================================================
+ * Virtual air interface
+ * ============================================================================
+ */
+
+/*!
+ * \brief Registers the peer simulation callbacks
+ *
+ * \param [IN] events Structure containing the air interface callbacks
+ */
+void SimRadioAirInit( SimRadioAirEvents_t *events );
+
+/*!
+ * \brief Sets the channel model of the virtual air interface
+ *
+ * \param [IN] params Channel model parameters
+ */
+void SimRadioAirSetParams( SimRadioAirParams_t *params );
+
+/*!
+ * \brief Gets the channel model of the virtual air interface
+ *
+ * \param [OUT] params Channel model parameters
+ */
+void SimRadioAirGetParams( SimRadioAirParams_t *params );
+
+/*!
+ * \brief Puts a frame on the air towards the radio
+ *
+ * \remark The frame reaches the antenna after delay plus the air interface
+ *         latency. It is received only if the radio is then listening with
+ *         matching modem, frequency, bandwidth, datarate and IQ settings.
+ *         The payload is copied, the caller buffer may be reused.
+ *
+ * \param [IN] frame Frame to be sent
+ * \param [IN] delay Delay before the frame starts [ms]
+ * \retval status    [true: frame scheduled, false: a frame is already on the air]
+ */
+bool SimRadioAirTx( SimRadioFrame_t *frame, uint32_t delay );
+
+/*!
+ * ============================================================================
+ * Public functions prototypes
+ * ============================================================================
+ */
+
+/*!
+ * \brief Initializes the radio
+ *
+ * \param [IN] events Structure containing the driver callback functions
+ */
+void SimRadioInit( RadioEvents_t *events );
+
+/*!
+ * Return current radio status
+ *
+ * \param status Radio status.[RF_IDLE, RF_RX_RUNNING, RF_TX_RUNNING, RF_CAD]
+ */
+RadioState_t SimRadioGetStatus( void );
+
+/*!
+ * \brief Configures the radio with the given modem
+ *
+ * \param [IN] modem Modem to be used [0: FSK, 1: LoRa]
+ */
+void SimRadioSetModem( RadioModems_t modem );
+
+/*!
+ * \brief Sets the channel frequency
+ *
+ * \param [IN] freq         Channel RF frequency
+ */
+void SimRadioSetChannel( uint32_t freq );
+
+/*!
+ * \brief Checks if the channel is free for the given time
+ *
+ * \param [IN] modem                Radio modem to be used [0: FSK, 1: LoRa]
+ * \param [IN] freq                 Channel RF frequency
+ * \param [IN] rssiThresh           RSSI threshold
+ * \param [IN] maxCarrierSenseTime  Max time while the RSSI is measured
+ *
+ * \retval isFree         [true: Channel is free, false: Channel is not free]
+ */
+bool SimRadioIsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
+
+/*!
+ * \brief Starts a carrier sense on the given channel without blocking
+ *
+ * \remark The radio stays in reception for maxCarrierSenseTime, the result
+ *         is reported by the CarrierSenseDone callback
+ *
+ * \param [IN] modem                Radio modem to be used [0: FSK, 1: LoRa]
+ * \param [IN] freq                 Channel RF frequency
+ * \param [IN] rssiThresh           RSSI threshold
+ * \param [IN] maxCarrierSenseTime  Max time while the RSSI is measured
+ */
+void SimRadioStartCarrierSense( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
+
+/*!
+ * \brief Generates a 32 bits random value
+ *
+ * \retval randomValue    32 bits random value
+ */
+uint32_t SimRadioRandom( void );
+
+/*!
+ * \brief Sets the reception parameters
+ *
+ * \remark See Radio.SetRxConfig for the parameters description
+ */
+void SimRadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
+                          uint32_t datarate, uint8_t coderate,
+                          uint32_t bandwidthAfc, uint16_t preambleLen,
+                          uint16_t symbTimeout, bool fixLen,
+                          uint8_t payloadLen,
+                          bool crcOn, bool freqHopOn, uint8_t hopPeriod,
+                          bool iqInverted, bool rxContinuous );
+
+/*!
+ * \brief Sets the transmission parameters
+ *
+ * \remark See Radio.SetTxConfig for the parameters description
+ */
+void SimRadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
+                          uint32_t bandwidth, uint32_t datarate,
+                          uint8_t coderate, uint16_t preambleLen,
+                          bool fixLen, bool crcOn, bool freqHopOn,
+                          uint8_t hopPeriod, bool iqInverted, uint32_t timeout );
+
+/*!
+ * \brief Checks if the given RF frequency is supported by the hardware
+ *
+ * \param [IN] frequency RF frequency to be checked
+ * \retval isSupported [true: supported, false: unsupported]
+ */
+bool SimRadioCheckRfFrequency( uint32_t frequency );
+
+/*!
+ * \brief Computes the packet time on air in ms for the given payload
+ *
+ * \remark Can only be called once SetRxConfig or SetTxConfig have been called
+ *
+ * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
+ * \param [IN] pktLen     Packet payload length
+ *
+ * \retval airTime        Computed airTime (ms) for the given packet payload length
+ */
+uint32_t SimRadioGetTimeOnAir( RadioModems_t modem, uint8_t pktLen );
+
+/*!
+ * \brief Prepares the radio for the transmission of the given buffer
+ *
+ * \param [IN] buffer     Buffer pointer
+ * \param [IN] size       Buffer size
+ */
+void SimRadioPrepareTx( uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Sends the buffer of size. Prepares the packet to be sent and sets
+ *        the radio in transmission
+ *
+ * \param [IN] buffer     Buffer pointer
+ * \param [IN] size       Buffer size
+ */
+void SimRadioSend( uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Sets the radio in sleep mode
+ */
+void SimRadioSetSleep( void );
+
+/*!
+ * \brief Sets the radio in standby mode
+ */
+void SimRadioSetStby( void );
+
+/*!
+ * \brief Sets the radio in reception mode for the given time
+ *
+ * \param [IN] timeout Reception timeout [ms] [0: continuous, others timeout]
+ */
+void SimRadioSetRx( uint32_t timeout );
+
+/*!
+ * \brief Start a Channel Activity Detection
+ */
+void SimRadioStartCad( void );
+
+/*!
+ * \brief Sets the radio in continuous wave transmission mode
+ *
+ * \param [IN]: freq       Channel RF frequency
+ * \param [IN]: power      Sets the output power [dBm]
+ * \param [IN]: time       Transmission mode timeout [s]
+ */
+void SimRadioSetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time );
+
+/*!
+ * \brief Reads the current RSSI value
+ *
+ * \retval rssiValue Current RSSI value in [dBm]
+ */
+int16_t SimRadioReadRssi( RadioModems_t modem );
+
+/*!
+ * \brief Writes the radio register at the specified address
+ *
+ * \param [IN]: addr Register address
+ * \param [IN]: data New register value
+ */
+void SimRadioWrite( uint16_t addr, uint8_t data );
+
+/*!
+ * \brief Reads the radio register at the specified address
+ *
+ * \param [IN]: addr Register address
+ * \retval data Register value
+ */
+uint8_t SimRadioRead( uint16_t addr );
+
+/*!
+ * \brief Writes multiple radio registers starting at address
+ *
+ * \param [IN] addr   First Radio register address
+ * \param [IN] buffer Buffer containing the new register's values
+ * \param [IN] size   Number of registers to be written
+ */
+void SimRadioWriteBuffer( uint16_t addr, uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Reads multiple radio registers starting at address
+ *
+ * \param [IN] addr First Radio register address
+ * \param [OUT] buffer Buffer where to copy the registers data
+ * \param [IN] size Number of registers to be read
+ */
+void SimRadioReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Sets the maximum payload length.
+ *
+ * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
+ * \param [IN] max        Maximum payload length in bytes
+ */
+void SimRadioSetMaxPayloadLength( RadioModems_t modem, uint8_t max );
+
+/*!
+ * \brief Sets the network to public or private. Updates the sync byte.
+ *
+ * \remark Applies to LoRa modem only
+ *
+ * \param [IN] enable if true, it enables a public network
+ */
+void SimRadioSetPublicNetwork( bool enable );
+
+/*!
+ * \brief Gets the time required for the board plus radio to get out of sleep.[ms]
+ *
+ * \retval time Radio plus board wakeup time in ms.
+ */
+uint32_t SimRadioGetWakeupTime( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __SIM_RADIO_H__
@@ -26,295 +26,14 @@
 #include "timer.h"
 #include "delay.h"
 #include "radio.h"
+#include "timeonair.h"
+#include "energy.h"
 #include "sx126x.h"
 #include "sx126x-board.h"
+#include "sx126x-binding.h"
 #include "board.h"
 
-/*!
- * \brief Initializes the radio
- *
- * \param [IN] events Structure containing the driver callback functions
- */
-void RadioInit( RadioEvents_t *events );
-
-/*!
- * Return current radio status
- *
- * \param status Radio status.[RF_IDLE, RF_RX_RUNNING, RF_TX_RUNNING]
- */
-RadioState_t RadioGetStatus( void );
-
-/*!
- * \brief Configures the radio with the given modem
- *
- * \param [IN] modem Modem to be used [0: FSK, 1: LoRa]
- */
-void RadioSetModem( RadioModems_t modem );
-
-/*!
- * \brief Sets the channel frequency
- *
- * \param [IN] freq         Channel RF frequency
- */
-void RadioSetChannel( uint32_t freq );
-
-/*!
- * \brief Checks if the channel is free for the given time
- *
- * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
- * \param [IN] freq       Channel RF frequency
- * \param [IN] rssiThresh RSSI threshold
- * \param [IN] maxCarrierSenseTime Max time while the RSSI is measured
- *
- * \retval isFree         [true: Channel is free, false: Channel is not free]
- */
-bool RadioIsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
-
-/*!
- * \brief Generates a 32 bits random value based on the RSSI readings
- *
- * \remark This function sets the radio in LoRa modem mode and disables
- *         all interrupts.
- *         After calling this function either Radio.SetRxConfig or
- *         Radio.SetTxConfig functions must be called.
- *
- * \retval randomValue    32 bits random value
- */
-uint32_t RadioRandom( void );
-
-/*!
- * \brief Sets the reception parameters
- *
- * \param [IN] modem        Radio modem to be used [0: FSK, 1: LoRa]
- * \param [IN] bandwidth    Sets the bandwidth
- *                          FSK : >= 2600 and <= 250000 Hz
- *                          LoRa: [0: 125 kHz, 1: 250 kHz,
- *                                 2: 500 kHz, 3: Reserved]
- * \param [IN] datarate     Sets the Datarate
- *                          FSK : 600..300000 bits/s
- *                          LoRa: [6: 64, 7: 128, 8: 256, 9: 512,
- *                                10: 1024, 11: 2048, 12: 4096  chips]
- * \param [IN] coderate     Sets the coding rate (LoRa only)
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: [1: 4/5, 2: 4/6, 3: 4/7, 4: 4/8]
- * \param [IN] bandwidthAfc Sets the AFC Bandwidth (FSK only)
- *                          FSK : >= 2600 and <= 250000 Hz
- *                          LoRa: N/A ( set to 0 )
- * \param [IN] preambleLen  Sets the Preamble length
- *                          FSK : Number of bytes
- *                          LoRa: Length in symbols (the hardware adds 4 more symbols)
- * \param [IN] symbTimeout  Sets the RxSingle timeout value
- *                          FSK : timeout in number of bytes
- *                          LoRa: timeout in symbols
- * \param [IN] fixLen       Fixed length packets [0: variable, 1: fixed]
- * \param [IN] payloadLen   Sets payload length when fixed length is used
- * \param [IN] crcOn        Enables/Disables the CRC [0: OFF, 1: ON]
- * \param [IN] FreqHopOn    Enables disables the intra-packet frequency hopping
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: [0: OFF, 1: ON]
- * \param [IN] HopPeriod    Number of symbols between each hop
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: Number of symbols
- * \param [IN] iqInverted   Inverts IQ signals (LoRa only)
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: [0: not inverted, 1: inverted]
- * \param [IN] rxContinuous Sets the reception in continuous mode
- *                          [false: single mode, true: continuous mode]
- */
-void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
-                          uint32_t datarate, uint8_t coderate,
-                          uint32_t bandwidthAfc, uint16_t preambleLen,
-                          uint16_t symbTimeout, bool fixLen,
-                          uint8_t payloadLen,
-                          bool crcOn, bool FreqHopOn, uint8_t HopPeriod,
-                          bool iqInverted, bool rxContinuous );
-
-/*!
- * \brief Sets the transmission parameters
- *
- * \param [IN] modem        Radio modem to be used [0: FSK, 1: LoRa]
- * \param [IN] power        Sets the output power [dBm]
- * \param [IN] fdev         Sets the frequency deviation (FSK only)
- *                          FSK : [Hz]
- *                          LoRa: 0
- * \param [IN] bandwidth    Sets the bandwidth (LoRa only)
- *                          FSK : 0
- *                          LoRa: [0: 125 kHz, 1: 250 kHz,
- *                                 2: 500 kHz, 3: Reserved]
- * \param [IN] datarate     Sets the Datarate
- *                          FSK : 600..300000 bits/s
- *                          LoRa: [6: 64, 7: 128, 8: 256, 9: 512,
- *                                10: 1024, 11: 2048, 12: 4096  chips]
- * \param [IN] coderate     Sets the coding rate (LoRa only)
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: [1: 4/5, 2: 4/6, 3: 4/7, 4: 4/8]
- * \param [IN] preambleLen  Sets the preamble length
- *                          FSK : Number of bytes
- *                          LoRa: Length in symbols (the hardware adds 4 more symbols)
- * \param [IN] fixLen       Fixed length packets [0: variable, 1: fixed]
- * \param [IN] crcOn        Enables disables the CRC [0: OFF, 1: ON]
- * \param [IN] FreqHopOn    Enables disables the intra-packet frequency hopping
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: [0: OFF, 1: ON]
- * \param [IN] HopPeriod    Number of symbols between each hop
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: Number of symbols
- * \param [IN] iqInverted   Inverts IQ signals (LoRa only)
- *                          FSK : N/A ( set to 0 )
- *                          LoRa: [0: not inverted, 1: inverted]
- * \param [IN] timeout      Transmission timeout [ms]
- */
-void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
-                          uint32_t bandwidth, uint32_t datarate,
-                          uint8_t coderate, uint16_t preambleLen,
-                          bool fixLen, bool crcOn, bool FreqHopOn,
-                          uint8_t HopPeriod, bool iqInverted, uint32_t timeout );
-
-/*!
- * \brief Checks if the given RF frequency is supported by the hardware
- *
- * \param [IN] frequency RF frequency to be checked
- * \retval isSupported [true: supported, false: unsupported]
- */
-bool RadioCheckRfFrequency( uint32_t frequency );
-
-/*!
- * \brief Computes the packet time on air in ms for the given payload
- *
- * \Remark Can only be called once SetRxConfig or SetTxConfig have been called
- *
- * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
- * \param [IN] pktLen     Packet payload length
- *
- * \retval airTime        Computed airTime (ms) for the given packet payload length
- */
-uint32_t RadioTimeOnAir( RadioModems_t modem, uint8_t pktLen );
-
-/*!
- * \brief Sends the buffer of size. Prepares the packet to be sent and sets
- *        the radio in transmission
- *
- * \param [IN]: buffer     Buffer pointer
- * \param [IN]: size       Buffer size
- */
-void RadioSend( uint8_t *buffer, uint8_t size );
-
-/*!
- * \brief Sets the radio in sleep mode
- */
-void RadioSleep( void );
-
-/*!
- * \brief Sets the radio in standby mode
- */
-void RadioStandby( void );
-
-/*!
- * \brief Sets the radio in reception mode for the given time
- * \param [IN] timeout Reception timeout [ms]
- *                     [0: continuous, others timeout]
- */
-void RadioRx( uint32_t timeout );
-
-/*!
- * \brief Start a Channel Activity Detection
- */
-void RadioStartCad( void );
-
-/*!
- * \brief Sets the radio in continuous wave transmission mode
- *
- * \param [IN]: freq       Channel RF frequency
- * \param [IN]: power      Sets the output power [dBm]
- * \param [IN]: time       Transmission mode timeout [s]
- */
-void RadioSetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time );
-
-/*!
- * \brief Reads the current RSSI value
- *
- * \retval rssiValue Current RSSI value in [dBm]
- */
-int16_t RadioRssi( RadioModems_t modem );
-
-/*!
- * \brief Writes the radio register at the specified address
- *
- * \param [IN]: addr Register address
- * \param [IN]: data New register value
- */
-void RadioWrite( uint16_t addr, uint8_t data );
-
-/*!
- * \brief Reads the radio register at the specified address
- *
- * \param [IN]: addr Register address
- * \retval data Register value
- */
-uint8_t RadioRead( uint16_t addr );
-
-/*!
- * \brief Writes multiple radio registers starting at address
- *
- * \param [IN] addr   First Radio register address
- * \param [IN] buffer Buffer containing the new register's values
- * \param [IN] size   Number of registers to be written
- */
-void RadioWriteBuffer( uint16_t addr, uint8_t *buffer, uint8_t size );
-
-/*!
- * \brief Reads multiple radio registers starting at address
- *
- * \param [IN] addr First Radio register address
- * \param [OUT] buffer Buffer where to copy the registers data
- * \param [IN] size Number of registers to be read
- */
-void RadioReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size );
-
-/*!
- * \brief Sets the maximum payload length.
- *
- * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
- * \param [IN] max        Maximum payload length in bytes
- */
-void RadioSetMaxPayloadLength( RadioModems_t modem, uint8_t max );
-
-/*!
- * \brief Sets the network to public or private. Updates the sync byte.
- *
- * \remark Applies to LoRa modem only
- *
- * \param [IN] enable if true, it enables a public network
- */
-void RadioSetPublicNetwork( bool enable );
-
-/*!
- * \brief Gets the time required for the board plus radio to get out of sleep.[ms]
- *
- * \retval time Radio plus board wakeup time in ms.
- */
-uint32_t RadioGetWakeupTime( void );
-
-/*!
- * \brief Process radio irq
- */
-void RadioIrqProcess( void );
-
-/*!
- * \brief Sets the radio in reception mode with Max LNA gain for the given time
- * \param [IN] timeout Reception timeout [ms]
- *                     [0: continuous, others timeout]
- */
-void RadioRxBoosted( uint32_t timeout );
-
-/*!
- * \brief Sets the Rx duty cycle management parameters
- *
- * \param [in]  rxTime        Structure describing reception timeout value
- * \param [in]  sleepTime     Structure describing sleep timeout value
- */
-void RadioSetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime );
-
+#if !defined( USE_RADIO_STATIC_BINDING ) || defined( SX126X_INSTANCE )
 /*!
  * Radio driver structure initialization
  */
@@ -330,6 +49,7 @@ const struct Radio_s Radio =
     RadioSetTxConfig,
     RadioCheckRfFrequency,
     RadioTimeOnAir,
+    RadioPrepareTx,
     RadioSend,
     RadioSleep,
     RadioStandby,
@@ -347,8 +67,13 @@ const struct Radio_s Radio =
     RadioIrqProcess,
     // Available on SX126x only
     RadioRxBoosted,
-    RadioSetRxDutyCycle
+    RadioSetRxDutyCycle,
+    NULL, // int32_t ( *GetFreqError )( void ) - SX1272 and SX1276 Only
+    RadioStartCarrierSense,
+    RadioCalibrateWakeupTime,
+    RadioSetWakeupTime,
 };
+#endif
 
 /*
  * Local types definition
@@ -395,11 +120,6 @@ const FskBandwidth_t FskBandwidths[] =
 
 const RadioLoRaBandwidths_t Bandwidths[] = { LORA_BW_125, LORA_BW_250, LORA_BW_500 };
 
-//                                          SF12    SF11    SF10    SF9    SF8    SF7
-static double RadioLoRaSymbTime[3][6] = {{ 32.768, 16.384, 8.192, 4.096, 2.048, 1.024 },  // 125 KHz
-                                         { 16.384, 8.192,  4.096, 2.048, 1.024, 0.512 },  // 250 KHz
-                                         { 8.192,  4.096,  2.048, 1.024, 0.512, 0.256 }}; // 500 KHz
-
 uint8_t MaxPayloadLength = 0xFF;
 
 uint32_t TxTimeout = 0;
@@ -408,10 +128,57 @@ uint32_t RxTimeout = 0;
 bool RxContinuous = false;
 
 
+/*!
+ * Maximum payload size which fits the reception buffer
+ */
+#define RADIO_RX_PAYLOAD_MAX_SIZE                   MIN( RX_BUFFER_SIZE, 255 )
+
 PacketStatus_t RadioPktStatus;
-uint8_t RadioRxPayload[255];
+uint8_t RadioRxPayload[RADIO_RX_PAYLOAD_MAX_SIZE];
+
+#if defined( USE_RADIO_RX_DOUBLE_BUFFER )
+/*!
+ * Number of payloads of the continuous reception queue. A payload given to
+ * RxDone stays valid during the RADIO_RX_QUEUE_SIZE - 1 next receptions.
+ */
+#ifndef RADIO_RX_QUEUE_SIZE
+#define RADIO_RX_QUEUE_SIZE                         2
+#endif
+
+/*!
+ * Payloads received in continuous reception
+ */
+static uint8_t RadioRxQueue[RADIO_RX_QUEUE_SIZE][RADIO_RX_PAYLOAD_MAX_SIZE];
+
+/*!
+ * Queue entry of the next payload received in continuous reception
+ */
+static uint8_t RadioRxQueueIndex = 0;
+
+/*!
+ * Radio data buffer half receiving the next packet
+ */
+static uint8_t RadioRxBaseAddress = 0x00;
+
+/*!
+ * \brief Reads the packet received in continuous reception and hands the
+ *        other half of the radio data buffer to the next packet
+ *
+ * \remark The next packet can be received while this one is read out. A
+ *         packet longer than half of the buffer wraps around into the half
+ *         being read, by then the previous packet has long been read.
+ *
+ * \param [OUT] size     Size of the received packet
+ *
+ * \retval payload Queue entry holding the packet, NULL if it does not fit
+ */
+static uint8_t* RadioGetContinuousPayload( uint8_t *size );
+#endif
 
-bool IrqFired = false;
+/*!
+ * Set by the DIO IRQ handler, cleared by RadioIrqProcess
+ */
+volatile uint32_t IrqFired = 0;
 
 /*
  * SX126x DIO IRQ callback functions prototype
@@ -432,6 +199,11 @@ void RadioOnTxTimeoutIrq( void* context );
  */
 void RadioOnRxTimeoutIrq( void* context );
 
+/*!
+ * \brief Carrier sense timer callback, samples the RSSI
+ */
+static void RadioOnCarrierSenseTimerEvent( void* context );
+
 /*
  * Private global variables
  */
@@ -448,11 +220,68 @@ typedef struct
 
 static RadioPublicNetwork_t RadioPublicNetwork = { false };
 
+/*!
+ * Inverted IQ setting last applied to RegIqPolaritySetup
+ * [-1: unknown, 0: normal, 1: inverted]
+ */
+static int8_t RadioIqPolaritySetup = -1;
+
+/*!
+ * Payload loaded in the radio by RadioPrepareTx. NULL when none
+ */
+static uint8_t *TxPreparedBuffer = NULL;
+static uint8_t TxPreparedSize = 0;
+
 /*!
  * Radio callbacks variable
  */
 static RadioEvents_t* RadioEvents;
 
+/*!
+ * Carrier sense RSSI sampling period [ms]. The first sample is taken one
+ * period after the reception start to let the RSSI settle.
+ */
+#ifndef RADIO_CARRIER_SENSE_SAMPLE_PERIOD
+#define RADIO_CARRIER_SENSE_SAMPLE_PERIOD           1
+#endif
+
+/*!
+ * Regulator mode of the radio. The DC-DC converter draws less current than
+ * the LDO at every TX power; boards without the DC-DC inductor use USE_LDO.
+ */
+#ifndef SX126X_REGULATOR_MODE
+#define SX126X_REGULATOR_MODE                       USE_DCDC
+#endif
+
+/*!
+ * Number of wakeups measured by RadioCalibrateWakeupTime
+ */
+#ifndef RADIO_WAKEUP_CALIBRATION_NB
+#define RADIO_WAKEUP_CALIBRATION_NB                 4
+#endif
+
+/*!
+ * Calibrated wakeup time [ms], 0 when the board and radio constants are used
+ */
+static uint32_t RadioWakeupTime = 0;
+
+/*!
+ * Carrier sense in progress
+ */
+typedef struct sRadioCarrierSense
+{
+    RadioModems_t Modem;
+    int16_t RssiThresh;
+    /*!
+     * Sensing time including the RSSI settling time [ms]
+     */
+    uint32_t Duration;
+    TimerTime_t StartTime;
+    TimerEvent_t Timer;
+}RadioCarrierSense_t;
+
+static RadioCarrierSense_t CarrierSense;
+
 /*
  * Public global variables
  */
@@ -497,10 +326,11 @@ static uint8_t RadioGetFskBandwidthRegValue( uint32_t bandwidth )
 void RadioInit( RadioEvents_t *events )
 {
     RadioEvents = events;
+    TxPreparedBuffer = NULL;
 
     SX126xInit( RadioOnDioIrq );
     SX126xSetStandby( STDBY_RC );
-    SX126xSetRegulatorMode( USE_DCDC );
+    SX126xSetRegulatorMode( SX126X_REGULATOR_MODE );
 
     SX126xSetBufferBaseAddress( 0x00, 0x00 );
     SX126xSetTxParams( 0, RADIO_RAMP_200_US );
@@ -509,8 +339,10 @@ void RadioInit( RadioEvents_t *events )
     // Initialize driver timeout timers
     TimerInit( &TxTimeoutTimer, RadioOnTxTimeoutIrq );
     TimerInit( &RxTimeoutTimer, RadioOnRxTimeoutIrq );
+    TimerInit( &CarrierSense.Timer, RadioOnCarrierSenseTimerEvent );
 
-    IrqFired = false;
+    IrqFired = 0;
+    RadioIqPolaritySetup = -1;
 }
 
 RadioState_t RadioGetStatus( void )
@@ -530,11 +362,15 @@ RadioState_t RadioGetStatus( void )
 
 void RadioSetModem( RadioModems_t modem )
 {
+    // The packet parameters are re-configured
+    TxPreparedBuffer = NULL;
+
     switch( modem )
     {
     default:
     case MODEM_FSK:
         SX126xSetPacketType( PACKET_TYPE_GFSK );
+        RadioIqPolaritySetup = -1;
         // When switching to GFSK mode the LoRa SyncWord register value is reset
         // Thus, we also reset the RadioPublicNetwork variable
         RadioPublicNetwork.Current = false;
@@ -589,6 +425,25 @@ bool RadioIsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh,
     return status;
 }
 
+void RadioStartCarrierSense( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
+{
+    RadioSleep( );
+
+    RadioSetModem( modem );
+
+    RadioSetChannel( freq );
+
+    RadioRx( 0 );
+
+    CarrierSense.Modem = modem;
+    CarrierSense.RssiThresh = rssiThresh;
+    CarrierSense.Duration = maxCarrierSenseTime + RADIO_CARRIER_SENSE_SAMPLE_PERIOD;
+    CarrierSense.StartTime = TimerGetCurrentTime( );
+
+    TimerSetValue( &CarrierSense.Timer, RADIO_CARRIER_SENSE_SAMPLE_PERIOD );
+    TimerStart( &CarrierSense.Timer );
+}
+
 uint32_t RadioRandom( void )
 {
     uint8_t i;
@@ -635,7 +490,7 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
     }
     else
     {
-        MaxPayloadLength = 0xFF;
+        MaxPayloadLength = RADIO_RX_PAYLOAD_MAX_SIZE;
     }
 
     switch( modem )
@@ -723,15 +578,20 @@ void RadioSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
             SX126xSetPacketParams( &SX126x.PacketParams );
 
             // WORKAROUND - Optimizing the Inverted IQ Operation, see DS_SX1261-2_V1.2 datasheet chapter 15.4
-            if( SX126x.PacketParams.Params.LoRa.InvertIQ == LORA_IQ_INVERTED )
-            {
-                // RegIqPolaritySetup = @address 0x0736
-                SX126xWriteRegister( 0x0736, SX126xReadRegister( 0x0736 ) & ~( 1 << 2 ) );
-            }
-            else
+            if( RadioIqPolaritySetup != ( int8_t )( SX126x.PacketParams.Params.LoRa.InvertIQ == LORA_IQ_INVERTED ) )
             {
-                // RegIqPolaritySetup @address 0x0736
-                SX126xWriteRegister( 0x0736, SX126xReadRegister( 0x0736 ) | ( 1 << 2 ) );
+                if( SX126x.PacketParams.Params.LoRa.InvertIQ == LORA_IQ_INVERTED )
+                {
+                    // RegIqPolaritySetup = @address 0x0736
+                    SX126xWriteRegister( 0x0736, SX126xReadRegister( 0x0736 ) & ~( 1 << 2 ) );
+                    RadioIqPolaritySetup = 1;
+                }
+                else
+                {
+                    // RegIqPolaritySetup @address 0x0736
+                    SX126xWriteRegister( 0x0736, SX126xReadRegister( 0x0736 ) | ( 1 << 2 ) );
+                    RadioIqPolaritySetup = 0;
+                }
             }
             // WORKAROUND END
 
@@ -845,6 +705,7 @@ void RadioSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
     // WORKAROUND END
 
     SX126xSetRfTxPower( power );
+    EnergySetRadioTxPower( power );
     TxTimeout = timeout;
 }
 
@@ -861,39 +722,32 @@ uint32_t RadioTimeOnAir( RadioModems_t modem, uint8_t pktLen )
     {
     case MODEM_FSK:
         {
-           airTime = ( uint32_t )rint( ( 8 * ( SX126x.PacketParams.Params.Gfsk.PreambleLength +
-                                     ( SX126x.PacketParams.Params.Gfsk.SyncWordLength >> 3 ) +
-                                     ( ( SX126x.PacketParams.Params.Gfsk.HeaderType == RADIO_PACKET_FIXED_LENGTH ) ? 0.0 : 1.0 ) +
-                                     pktLen +
-                                     ( ( SX126x.PacketParams.Params.Gfsk.CrcLength == RADIO_CRC_2_BYTES ) ? 2.0 : 0 ) ) /
-                                     SX126x.ModulationParams.Params.Gfsk.BitRate ) * 1000 );
+            airTime = TimeOnAirFsk( SX126x.ModulationParams.Params.Gfsk.BitRate,
+                                    SX126x.PacketParams.Params.Gfsk.PreambleLength +
+                                    ( SX126x.PacketParams.Params.Gfsk.SyncWordLength >> 3 ) +
+                                    ( ( SX126x.PacketParams.Params.Gfsk.HeaderType == RADIO_PACKET_FIXED_LENGTH ) ? 0 : 1 ) +
+                                    pktLen +
+                                    ( ( SX126x.PacketParams.Params.Gfsk.CrcLength == RADIO_CRC_2_BYTES ) ? 2 : 0 ),
+                                    true );
         }
         break;
     case MODEM_LORA:
         {
-            double ts = RadioLoRaSymbTime[SX126x.ModulationParams.Params.LoRa.Bandwidth - 4][12 - SX126x.ModulationParams.Params.LoRa.SpreadingFactor];
-            // time of preamble
-            double tPreamble = ( SX126x.PacketParams.Params.LoRa.PreambleLength + 4.25 ) * ts;
-            // Symbol length of payload and time
-            double tmp = ceil( ( 8 * pktLen - 4 * SX126x.ModulationParams.Params.LoRa.SpreadingFactor +
-                                 28 + 16 * SX126x.PacketParams.Params.LoRa.CrcMode -
-                                 ( ( SX126x.PacketParams.Params.LoRa.HeaderType == LORA_PACKET_FIXED_LENGTH ) ? 20 : 0 ) ) /
-                                 ( double )( 4 * ( SX126x.ModulationParams.Params.LoRa.SpreadingFactor -
-                                 ( ( SX126x.ModulationParams.Params.LoRa.LowDatarateOptimize > 0 ) ? 2 : 0 ) ) ) ) *
-                                 ( ( SX126x.ModulationParams.Params.LoRa.CodingRate % 4 ) + 4 );
-            double nPayload = 8 + ( ( tmp > 0 ) ? tmp : 0 );
-            double tPayload = nPayload * ts;
-            // Time on air
-            double tOnAir = tPreamble + tPayload;
-            // return milli seconds
-            airTime = ( uint32_t )floor( tOnAir + 0.999 );
+            airTime = TimeOnAirToMs( TimeOnAirLoRa( SX126x.ModulationParams.Params.LoRa.Bandwidth - LORA_BW_125,
+                                                    SX126x.ModulationParams.Params.LoRa.SpreadingFactor,
+                                                    SX126x.ModulationParams.Params.LoRa.CodingRate % 4,
+                                                    SX126x.PacketParams.Params.LoRa.PreambleLength,
+                                                    SX126x.PacketParams.Params.LoRa.HeaderType == LORA_PACKET_FIXED_LENGTH,
+                                                    pktLen,
+                                                    SX126x.PacketParams.Params.LoRa.CrcMode == LORA_CRC_ON,
+                                                    SX126x.ModulationParams.Params.LoRa.LowDatarateOptimize > 0 ) );
         }
         break;
     }
     return airTime;
 }
 
-void RadioSend( uint8_t *buffer, uint8_t size )
+void RadioPrepareTx( uint8_t *buffer, uint8_t size )
 {
     SX126xSetDioIrqParams( IRQ_TX_DONE | IRQ_RX_TX_TIMEOUT,
                            IRQ_TX_DONE | IRQ_RX_TX_TIMEOUT,
@@ -910,7 +764,21 @@ void RadioSend( uint8_t *buffer, uint8_t size )
     }
     SX126xSetPacketParams( &SX126x.PacketParams );
 
-    SX126xSendPayload( buffer, size, 0 );
+    SX126xSetPayload( buffer, size );
+    TxPreparedBuffer = buffer;
+    TxPreparedSize = size;
+}
+
+void RadioSend( uint8_t *buffer, uint8_t size )
+{
+    if( ( TxPreparedBuffer != buffer ) || ( TxPreparedSize != size ) )
+    {
+        RadioPrepareTx( buffer, size );
+    }
+    // The data buffer is used by the transmission
+    TxPreparedBuffer = NULL;
+
+    SX126xSetTx( 0 );
     TimerSetValue( &TxTimeoutTimer, TxTimeout );
     TimerStart( &TxTimeoutTimer );
 }
@@ -919,21 +787,36 @@ void RadioSleep( void )
 {
     SleepParams_t params = { 0 };
 
+    TxPreparedBuffer = NULL;
+    TimerStop( &CarrierSense.Timer );
+
+#if defined( USE_RADIO_COLD_START_SLEEP )
+    params.Fields.WarmStart = 0;
+    // The sync word register is reset, restored by the next LoRa RadioSetModem
+    RadioPublicNetwork.Current = false;
+#else
     params.Fields.WarmStart = 1;
+#endif
     SX126xSetSleep( params );
+    // Registers outside of the retention list are not kept during sleep
+    RadioIqPolaritySetup = -1;
 
     DelayMs( 2 );
 }
 
 void RadioStandby( void )
 {
+    TimerStop( &CarrierSense.Timer );
     SX126xSetStandby( STDBY_RC );
 }
 
 void RadioRx( uint32_t timeout )
 {
+    TxPreparedBuffer = NULL;
+
+    // Only the end of the reception raises DIO1, its interrupt time stamps the packet
     SX126xSetDioIrqParams( IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
-                           IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_RX_END,
                            IRQ_RADIO_NONE,
                            IRQ_RADIO_NONE );
 
@@ -955,8 +838,11 @@ void RadioRx( uint32_t timeout )
 
 void RadioRxBoosted( uint32_t timeout )
 {
+    TxPreparedBuffer = NULL;
+
+    // Only the end of the reception raises DIO1, its interrupt time stamps the packet
     SX126xSetDioIrqParams( IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
-                           IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_RX_END,
                            IRQ_RADIO_NONE,
                            IRQ_RADIO_NONE );
 
@@ -978,19 +864,32 @@ void RadioRxBoosted( uint32_t timeout )
 
 void RadioSetRxDutyCycle( uint32_t rxTime, uint32_t sleepTime )
 {
+    TxPreparedBuffer = NULL;
+
+    // Only the end of the reception raises DIO1, its interrupt time stamps the packet
+    SX126xSetDioIrqParams( IRQ_RADIO_ALL, //IRQ_RX_DONE | IRQ_RX_TX_TIMEOUT,
+                           IRQ_RADIO_RX_END,
+                           IRQ_RADIO_NONE,
+                           IRQ_RADIO_NONE );
+
     SX126xSetRxDutyCycle( rxTime, sleepTime );
 }
 
 void RadioStartCad( void )
 {
+    TxPreparedBuffer = NULL;
+
     SX126xSetDioIrqParams( IRQ_CAD_DONE | IRQ_CAD_ACTIVITY_DETECTED, IRQ_CAD_DONE | IRQ_CAD_ACTIVITY_DETECTED, IRQ_RADIO_NONE, IRQ_RADIO_NONE );
     SX126xSetCad( );
 }
 
 void RadioSetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time )
 {
+    TxPreparedBuffer = NULL;
+
     SX126xSetRfFrequency( freq );
     SX126xSetRfTxPower( power );
+    EnergySetRadioTxPower( power );
     SX126xSetTxContinuousWave( );
 
     TimerSetValue( &TxTimeoutTimer, time  * 1000 );
@@ -1024,6 +923,9 @@ void RadioReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
 
 void RadioSetMaxPayloadLength( RadioModems_t modem, uint8_t max )
 {
+    TxPreparedBuffer = NULL;
+    max = MIN( max, RADIO_RX_PAYLOAD_MAX_SIZE );
+
     if( modem == MODEM_LORA )
     {
         SX126x.PacketParams.Params.LoRa.PayloadLength = MaxPayloadLength = max;
@@ -1058,11 +960,64 @@ void RadioSetPublicNetwork( bool enable )
     }
 }
 
+#if defined( USE_RADIO_RX_DOUBLE_BUFFER )
+static uint8_t* RadioGetContinuousPayload( uint8_t *size )
+{
+    uint8_t offset = 0;
+    uint8_t *payload = RadioRxQueue[RadioRxQueueIndex];
+
+    SX126xGetRxBufferStatus( size, &offset );
+
+    RadioRxBaseAddress ^= 0x80;
+    SX126xSetBufferBaseAddress( 0x00, RadioRxBaseAddress );
+    SX126xFlushCommands( );
+
+    if( *size > RADIO_RX_PAYLOAD_MAX_SIZE )
+    {
+        return NULL;
+    }
+    SX126xReadBuffer( offset, payload, *size );
+    RadioRxQueueIndex = ( RadioRxQueueIndex + 1 ) % RADIO_RX_QUEUE_SIZE;
+    return payload;
+}
+#endif
+
 uint32_t RadioGetWakeupTime( void )
 {
+    if( RadioWakeupTime != 0 )
+    {
+        return RadioWakeupTime;
+    }
     return SX126xGetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME;
 }
 
+uint32_t RadioCalibrateWakeupTime( void )
+{
+    TimerTime_t startTime;
+    uint32_t wakeupTime = 0;
+
+    for( uint8_t i = 0; i < RADIO_WAKEUP_CALIBRATION_NB; i++ )
+    {
+        RadioSleep( );
+        startTime = TimerGetCurrentTime( );
+        // Wakes the radio up and waits until the oscillator, TCXO included, is running
+        SX126xSetStandby( STDBY_XOSC );
+        SX126xWaitOnBusy( );
+        wakeupTime = MAX( wakeupTime, TimerGetElapsedTime( startTime ) );
+    }
+    RadioSleep( );
+
+    // Covers the timer resolution
+    RadioSetWakeupTime( wakeupTime + 1 );
+    return RadioGetWakeupTime( );
+}
+
+void RadioSetWakeupTime( uint32_t time )
+{
+    // A calibration never exceeds the constants
+    RadioWakeupTime = MIN( time, SX126xGetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME );
+}
+
 void RadioOnTxTimeoutIrq( void* context )
 {
     if( ( RadioEvents != NULL ) && ( RadioEvents->TxTimeout != NULL ) )
@@ -1079,22 +1034,56 @@ void RadioOnRxTimeoutIrq( void* context )
     }
 }
 
-void RadioOnDioIrq( void* context )
+static void RadioOnCarrierSenseTimerEvent( void* context )
 {
-    IrqFired = true;
+    bool channelFree = true;
+
+    if( RadioRssi( CarrierSense.Modem ) > CarrierSense.RssiThresh )
+    {
+        channelFree = false;
+    }
+    else if( TimerGetElapsedTime( CarrierSense.StartTime ) < CarrierSense.Duration )
+    {
+        // Keep sensing, the MCU may sleep until the next sample
+        TimerStart( &CarrierSense.Timer );
+        return;
+    }
+    RadioSleep( );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->CarrierSenseDone != NULL ) )
+    {
+        RadioEvents->CarrierSenseDone( channelFree );
+    }
 }
 
-void RadioIrqProcess( void )
+RAM_FUNC void RadioOnDioIrq( void* context )
 {
-    if( IrqFired == true )
+    if( ( RadioEvents != NULL ) && ( RadioEvents->IrqTimestamp != NULL ) )
+    {
+        RadioEvents->IrqTimestamp( TimerGetCurrentTime( ) );
+    }
+    IrqFired = 1;
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->IrqNotify != NULL ) )
     {
-        CRITICAL_SECTION_BEGIN( );
-        // Clear IRQ flag
-        IrqFired = false;
-        CRITICAL_SECTION_END( );
+        RadioEvents->IrqNotify( );
+    }
+}
 
+void RadioIrqProcess( void )
+{
+    bool irqPending = ( AtomicExchange( &IrqFired, 0 ) != 0 );
+
+    if( ( irqPending == false ) && ( SX126xIsPollingMode( ) == true ) )
+    {
+        // DIO1 stays high until the IRQs are cleared, no SPI access while idle
+        irqPending = ( GpioRead( &SX126x.DIO1 ) == 1 );
+    }
+    if( irqPending == true )
+    {
         uint16_t irqRegs = SX126xGetIrqStatus( );
-        SX126xClearIrqStatus( IRQ_RADIO_ALL );
+        // Only the IRQs read are cleared, an IRQ raised in between is kept
+        SX126xClearIrqStatus( irqRegs );
 
         if( ( irqRegs & IRQ_TX_DONE ) == IRQ_TX_DONE )
         {
@@ -1110,25 +1099,57 @@ void RadioIrqProcess( void )
         if( ( irqRegs & IRQ_RX_DONE ) == IRQ_RX_DONE )
         {
             uint8_t size;
+            uint8_t *payload = RadioRxPayload;
 
             TimerStop( &RxTimeoutTimer );
-            if( RxContinuous == false )
+#if defined( USE_RADIO_RX_DOUBLE_BUFFER )
+            if( ( RxContinuous == true ) && ( SX126xGetOperatingMode( ) == MODE_RX ) )
+            {
+                // Done first, the radio is already receiving the next packet
+                payload = RadioGetContinuousPayload( &size );
+            }
+            else
+#endif
+            if( SX126xGetOperatingMode( ) == MODE_RX_DC )
+            {
+                // The radio leaves the duty cycle mode once a packet has been received
+                SX126xSetOperatingMode( MODE_STDBY_RC );
+            }
+            else if( RxContinuous == false )
             {
                 //!< Update operating mode state to a value lower than \ref MODE_STDBY_XOSC
                 SX126xSetOperatingMode( MODE_STDBY_RC );
 
-                // WORKAROUND - Implicit Header Mode Timeout Behavior, see DS_SX1261-2_V1.2 datasheet chapter 15.3
-                // RegRtcControl = @address 0x0902
-                SX126xWriteRegister( 0x0902, 0x00 );
-                // RegEventMask = @address 0x0944
-                SX126xWriteRegister( 0x0944, SX126xReadRegister( 0x0944 ) | ( 1 << 1 ) );
-                // WORKAROUND END
+                if( ( SX126xGetPacketType( ) == PACKET_TYPE_LORA ) &&
+                    ( SX126x.PacketParams.Params.LoRa.HeaderType == LORA_PACKET_IMPLICIT ) )
+                {
+                    // WORKAROUND - Implicit Header Mode Timeout Behavior, see DS_SX1261-2_V1.2 datasheet chapter 15.3
+                    // RegRtcControl = @address 0x0902
+                    SX126xWriteRegister( 0x0902, 0x00 );
+                    // RegEventMask = @address 0x0944
+                    SX126xWriteRegister( 0x0944, SX126xReadRegister( 0x0944 ) | ( 1 << 1 ) );
+                    // WORKAROUND END
+                }
+            }
+            if( ( payload == RadioRxPayload ) && ( SX126xGetPayload( RadioRxPayload, &size , RADIO_RX_PAYLOAD_MAX_SIZE ) != 0 ) )
+            {
+                payload = NULL;
+            }
+            if( payload == NULL )
+            {
+                // The frame does not fit the reception buffer
+                if( ( RadioEvents != NULL ) && ( RadioEvents->RxError != NULL ) )
+                {
+                    RadioEvents->RxError( );
+                }
             }
-            SX126xGetPayload( RadioRxPayload, &size , 255 );
-            SX126xGetPacketStatus( &RadioPktStatus );
-            if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+            else
             {
-                RadioEvents->RxDone( RadioRxPayload, size, RadioPktStatus.Params.LoRa.RssiPkt, RadioPktStatus.Params.LoRa.SnrPkt );
+                SX126xGetPacketStatus( &RadioPktStatus );
+                if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+                {
+                    RadioEvents->RxDone( payload, size, RadioPktStatus.Params.LoRa.RssiPkt, RadioPktStatus.Params.LoRa.SnrPkt );
+                }
             }
         }
 
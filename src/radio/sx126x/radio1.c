@@ -0,0 +1,26 @@
+/*!
+ * \file      radio1.c
+ *
+ * \brief     Second SX126x radio driver instance
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#if defined( SX126X_SECOND_INSTANCE )
+
+#define SX126X_INSTANCE                             1
+#include "sx126x-instance.h"
+
+#include "radio.c"
+
+#endif // SX126X_SECOND_INSTANCE
@@ -0,0 +1,190 @@
+/*!
+ * \file      sx126x-instance.h
+ *
+ * \brief     SX126x radio driver instance symbol renaming
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __SX126X_INSTANCE_H__
+#define __SX126X_INSTANCE_H__
+
+/*!
+ * The SX126x driver keeps its state in file scope variables. Additional
+ * transceivers are supported by compiling the driver and the board radio file
+ * once more with SX126X_INSTANCE set to the instance number. This header
+ * then renames every external symbol of the driver by appending the instance
+ * number, e.g. Radio becomes Radio1 and SX126x becomes SX126x1.
+ *
+ * It must be included before any other header by the instance translation
+ * units, see radio1.c and sx126x1.c.
+ */
+#if defined( SX126X_INSTANCE ) && ( SX126X_INSTANCE != 0 )
+
+#if !defined( SX126X_SECOND_INSTANCE ) || ( SX126X_INSTANCE != 1 )
+#error "Only the second SX126x driver instance is supported. Please enable SX126X_SECOND_INSTANCE."
+#endif
+
+#define SX126X_INSTANCE_CONCAT( name, instance ) name##instance
+#define SX126X_INSTANCE_XCONCAT( name, instance ) SX126X_INSTANCE_CONCAT( name, instance )
+
+/*!
+ * \brief Appends the instance number to the given symbol name
+ */
+#define SX126X_INSTANCE_SYMBOL( name ) SX126X_INSTANCE_XCONCAT( name, SX126X_INSTANCE )
+
+/*
+ * radio.c
+ */
+#define Bandwidths                               SX126X_INSTANCE_SYMBOL( Bandwidths )
+#define FskBandwidths                            SX126X_INSTANCE_SYMBOL( FskBandwidths )
+#define IrqFired                                 SX126X_INSTANCE_SYMBOL( IrqFired )
+#define MaxPayloadLength                         SX126X_INSTANCE_SYMBOL( MaxPayloadLength )
+#define Radio                                    SX126X_INSTANCE_SYMBOL( Radio )
+#define RadioCheckRfFrequency                    SX126X_INSTANCE_SYMBOL( RadioCheckRfFrequency )
+#define RadioGetStatus                           SX126X_INSTANCE_SYMBOL( RadioGetStatus )
+#define RadioGetWakeupTime                       SX126X_INSTANCE_SYMBOL( RadioGetWakeupTime )
+#define RadioCalibrateWakeupTime                 SX126X_INSTANCE_SYMBOL( RadioCalibrateWakeupTime )
+#define RadioSetWakeupTime                       SX126X_INSTANCE_SYMBOL( RadioSetWakeupTime )
+#define RadioInit                                SX126X_INSTANCE_SYMBOL( RadioInit )
+#define RadioIrqProcess                          SX126X_INSTANCE_SYMBOL( RadioIrqProcess )
+#define RadioIsChannelFree                       SX126X_INSTANCE_SYMBOL( RadioIsChannelFree )
+#define RadioOnDioIrq                            SX126X_INSTANCE_SYMBOL( RadioOnDioIrq )
+#define RadioOnRxTimeoutIrq                      SX126X_INSTANCE_SYMBOL( RadioOnRxTimeoutIrq )
+#define RadioOnTxTimeoutIrq                      SX126X_INSTANCE_SYMBOL( RadioOnTxTimeoutIrq )
+#define RadioPktStatus                           SX126X_INSTANCE_SYMBOL( RadioPktStatus )
+#define RadioPrepareTx                           SX126X_INSTANCE_SYMBOL( RadioPrepareTx )
+#define RadioRandom                              SX126X_INSTANCE_SYMBOL( RadioRandom )
+#define RadioRead                                SX126X_INSTANCE_SYMBOL( RadioRead )
+#define RadioReadBuffer                          SX126X_INSTANCE_SYMBOL( RadioReadBuffer )
+#define RadioRssi                                SX126X_INSTANCE_SYMBOL( RadioRssi )
+#define RadioRx                                  SX126X_INSTANCE_SYMBOL( RadioRx )
+#define RadioRxBoosted                           SX126X_INSTANCE_SYMBOL( RadioRxBoosted )
+#define RadioRxPayload                           SX126X_INSTANCE_SYMBOL( RadioRxPayload )
+#define RadioSend                                SX126X_INSTANCE_SYMBOL( RadioSend )
+#define RadioSetChannel                          SX126X_INSTANCE_SYMBOL( RadioSetChannel )
+#define RadioSetMaxPayloadLength                 SX126X_INSTANCE_SYMBOL( RadioSetMaxPayloadLength )
+#define RadioSetModem                            SX126X_INSTANCE_SYMBOL( RadioSetModem )
+#define RadioSetPublicNetwork                    SX126X_INSTANCE_SYMBOL( RadioSetPublicNetwork )
+#define RadioSetRxConfig                         SX126X_INSTANCE_SYMBOL( RadioSetRxConfig )
+#define RadioSetRxDutyCycle                      SX126X_INSTANCE_SYMBOL( RadioSetRxDutyCycle )
+#define RadioSetTxConfig                         SX126X_INSTANCE_SYMBOL( RadioSetTxConfig )
+#define RadioSetTxContinuousWave                 SX126X_INSTANCE_SYMBOL( RadioSetTxContinuousWave )
+#define RadioSleep                               SX126X_INSTANCE_SYMBOL( RadioSleep )
+#define RadioStandby                             SX126X_INSTANCE_SYMBOL( RadioStandby )
+#define RadioStartCad                            SX126X_INSTANCE_SYMBOL( RadioStartCad )
+#define RadioStartCarrierSense                   SX126X_INSTANCE_SYMBOL( RadioStartCarrierSense )
+#define RadioTimeOnAir                           SX126X_INSTANCE_SYMBOL( RadioTimeOnAir )
+#define RadioWrite                               SX126X_INSTANCE_SYMBOL( RadioWrite )
+#define RadioWriteBuffer                         SX126X_INSTANCE_SYMBOL( RadioWriteBuffer )
+#define RxContinuous                             SX126X_INSTANCE_SYMBOL( RxContinuous )
+#define RxTimeout                                SX126X_INSTANCE_SYMBOL( RxTimeout )
+#define RxTimeoutTimer                           SX126X_INSTANCE_SYMBOL( RxTimeoutTimer )
+#define SX126x                                   SX126X_INSTANCE_SYMBOL( SX126x )
+#define TxTimeout                                SX126X_INSTANCE_SYMBOL( TxTimeout )
+#define TxTimeoutTimer                           SX126X_INSTANCE_SYMBOL( TxTimeoutTimer )
+
+/*
+ * sx126x.c
+ */
+#define FrequencyError                           SX126X_INSTANCE_SYMBOL( FrequencyError )
+#define SX126xCalibrate                          SX126X_INSTANCE_SYMBOL( SX126xCalibrate )
+#define SX126xCalibrateImage                     SX126X_INSTANCE_SYMBOL( SX126xCalibrateImage )
+#define SX126xCheckDeviceReady                   SX126X_INSTANCE_SYMBOL( SX126xCheckDeviceReady )
+#define SX126xClearDeviceErrors                  SX126X_INSTANCE_SYMBOL( SX126xClearDeviceErrors )
+#define SX126xClearIrqStatus                     SX126X_INSTANCE_SYMBOL( SX126xClearIrqStatus )
+#define SX126xFlushCommands                      SX126X_INSTANCE_SYMBOL( SX126xFlushCommands )
+#define SX126xGetDeviceErrors                    SX126X_INSTANCE_SYMBOL( SX126xGetDeviceErrors )
+#define SX126xGetImageCalibrationStats           SX126X_INSTANCE_SYMBOL( SX126xGetImageCalibrationStats )
+#define SX126xGetIrqStatus                       SX126X_INSTANCE_SYMBOL( SX126xGetIrqStatus )
+#define SX126xGetOperatingMode                   SX126X_INSTANCE_SYMBOL( SX126xGetOperatingMode )
+#define SX126xGetPacketStatus                    SX126X_INSTANCE_SYMBOL( SX126xGetPacketStatus )
+#define SX126xGetPacketType                      SX126X_INSTANCE_SYMBOL( SX126xGetPacketType )
+#define SX126xGetPayload                         SX126X_INSTANCE_SYMBOL( SX126xGetPayload )
+#define SX126xGetRandom                          SX126X_INSTANCE_SYMBOL( SX126xGetRandom )
+#define SX126xGetRssiInst                        SX126X_INSTANCE_SYMBOL( SX126xGetRssiInst )
+#define SX126xGetRxBufferStatus                  SX126X_INSTANCE_SYMBOL( SX126xGetRxBufferStatus )
+#define SX126xGetStatus                          SX126X_INSTANCE_SYMBOL( SX126xGetStatus )
+#define SX126xInit                               SX126X_INSTANCE_SYMBOL( SX126xInit )
+#define SX126xIsPollingMode                      SX126X_INSTANCE_SYMBOL( SX126xIsPollingMode )
+#define SX126xSendPayload                        SX126X_INSTANCE_SYMBOL( SX126xSendPayload )
+#define SX126xSetBufferBaseAddress               SX126X_INSTANCE_SYMBOL( SX126xSetBufferBaseAddress )
+#define SX126xSetCad                             SX126X_INSTANCE_SYMBOL( SX126xSetCad )
+#define SX126xSetCadParams                       SX126X_INSTANCE_SYMBOL( SX126xSetCadParams )
+#define SX126xSetCrcPolynomial                   SX126X_INSTANCE_SYMBOL( SX126xSetCrcPolynomial )
+#define SX126xSetCrcSeed                         SX126X_INSTANCE_SYMBOL( SX126xSetCrcSeed )
+#define SX126xSetDio2AsRfSwitchCtrl              SX126X_INSTANCE_SYMBOL( SX126xSetDio2AsRfSwitchCtrl )
+#define SX126xSetDio3AsTcxoCtrl                  SX126X_INSTANCE_SYMBOL( SX126xSetDio3AsTcxoCtrl )
+#define SX126xSetDioIrqParams                    SX126X_INSTANCE_SYMBOL( SX126xSetDioIrqParams )
+#define SX126xSetFs                              SX126X_INSTANCE_SYMBOL( SX126xSetFs )
+#define SX126xSetLoRaSymbNumTimeout              SX126X_INSTANCE_SYMBOL( SX126xSetLoRaSymbNumTimeout )
+#define SX126xSetModulationParams                SX126X_INSTANCE_SYMBOL( SX126xSetModulationParams )
+#define SX126xSetOperatingMode                   SX126X_INSTANCE_SYMBOL( SX126xSetOperatingMode )
+#define SX126xSetPaConfig                        SX126X_INSTANCE_SYMBOL( SX126xSetPaConfig )
+#define SX126xSetPaSettings                      SX126X_INSTANCE_SYMBOL( SX126xSetPaSettings )
+#define SX126xSetPollingMode                     SX126X_INSTANCE_SYMBOL( SX126xSetPollingMode )
+#define SX126xSetInterruptMode                   SX126X_INSTANCE_SYMBOL( SX126xSetInterruptMode )
+#define SX126xSetPacketParams                    SX126X_INSTANCE_SYMBOL( SX126xSetPacketParams )
+#define SX126xSetPacketType                      SX126X_INSTANCE_SYMBOL( SX126xSetPacketType )
+#define SX126xSetPayload                         SX126X_INSTANCE_SYMBOL( SX126xSetPayload )
+#define SX126xSetRegulatorMode                   SX126X_INSTANCE_SYMBOL( SX126xSetRegulatorMode )
+#define SX126xSetRfFrequency                     SX126X_INSTANCE_SYMBOL( SX126xSetRfFrequency )
+#define SX126xSetRx                              SX126X_INSTANCE_SYMBOL( SX126xSetRx )
+#define SX126xSetRxBoosted                       SX126X_INSTANCE_SYMBOL( SX126xSetRxBoosted )
+#define SX126xSetRxDutyCycle                     SX126X_INSTANCE_SYMBOL( SX126xSetRxDutyCycle )
+#define SX126xSetRxTxFallbackMode                SX126X_INSTANCE_SYMBOL( SX126xSetRxTxFallbackMode )
+#define SX126xSetSleep                           SX126X_INSTANCE_SYMBOL( SX126xSetSleep )
+#define SX126xSetStandby                         SX126X_INSTANCE_SYMBOL( SX126xSetStandby )
+#define SX126xSetStopRxTimerOnPreambleDetect     SX126X_INSTANCE_SYMBOL( SX126xSetStopRxTimerOnPreambleDetect )
+#define SX126xSetSyncWord                        SX126X_INSTANCE_SYMBOL( SX126xSetSyncWord )
+#define SX126xSetTx                              SX126X_INSTANCE_SYMBOL( SX126xSetTx )
+#define SX126xSetTxContinuousWave                SX126X_INSTANCE_SYMBOL( SX126xSetTxContinuousWave )
+#define SX126xSetTxInfinitePreamble              SX126X_INSTANCE_SYMBOL( SX126xSetTxInfinitePreamble )
+#define SX126xSetTxParams                        SX126X_INSTANCE_SYMBOL( SX126xSetTxParams )
+#define SX126xSetWhiteningSeed                   SX126X_INSTANCE_SYMBOL( SX126xSetWhiteningSeed )
+
+/*
+ * Board radio files ( sx126x-board.h )
+ */
+#define AntPow                                   SX126X_INSTANCE_SYMBOL( AntPow )
+#define DbgPinRx                                 SX126X_INSTANCE_SYMBOL( DbgPinRx )
+#define DbgPinTx                                 SX126X_INSTANCE_SYMBOL( DbgPinTx )
+#define DeviceSel                                SX126X_INSTANCE_SYMBOL( DeviceSel )
+#define SX126xAntSwOff                           SX126X_INSTANCE_SYMBOL( SX126xAntSwOff )
+#define SX126xAntSwOn                            SX126X_INSTANCE_SYMBOL( SX126xAntSwOn )
+#define SX126xCheckRfFrequency                   SX126X_INSTANCE_SYMBOL( SX126xCheckRfFrequency )
+#define SX126xDbgPinRxWrite                      SX126X_INSTANCE_SYMBOL( SX126xDbgPinRxWrite )
+#define SX126xDbgPinTxWrite                      SX126X_INSTANCE_SYMBOL( SX126xDbgPinTxWrite )
+#define SX126xGetBoardTcxoWakeupTime             SX126X_INSTANCE_SYMBOL( SX126xGetBoardTcxoWakeupTime )
+#define SX126xGetDeviceId                        SX126X_INSTANCE_SYMBOL( SX126xGetDeviceId )
+#define SX126xIoDbgInit                          SX126X_INSTANCE_SYMBOL( SX126xIoDbgInit )
+#define SX126xIoDeInit                           SX126X_INSTANCE_SYMBOL( SX126xIoDeInit )
+#define SX126xIoInit                             SX126X_INSTANCE_SYMBOL( SX126xIoInit )
+#define SX126xIoIrqInit                          SX126X_INSTANCE_SYMBOL( SX126xIoIrqInit )
+#define SX126xIoTcxoInit                         SX126X_INSTANCE_SYMBOL( SX126xIoTcxoInit )
+#define SX126xReadBuffer                         SX126X_INSTANCE_SYMBOL( SX126xReadBuffer )
+#define SX126xReadCommand                        SX126X_INSTANCE_SYMBOL( SX126xReadCommand )
+#define SX126xReadRegister                       SX126X_INSTANCE_SYMBOL( SX126xReadRegister )
+#define SX126xReadRegisters                      SX126X_INSTANCE_SYMBOL( SX126xReadRegisters )
+#define SX126xReset                              SX126X_INSTANCE_SYMBOL( SX126xReset )
+#define SX126xSetRfTxPower                       SX126X_INSTANCE_SYMBOL( SX126xSetRfTxPower )
+#define SX126xWaitOnBusy                         SX126X_INSTANCE_SYMBOL( SX126xWaitOnBusy )
+#define SX126xWakeup                             SX126X_INSTANCE_SYMBOL( SX126xWakeup )
+#define SX126xWriteBuffer                        SX126X_INSTANCE_SYMBOL( SX126xWriteBuffer )
+#define SX126xWriteCommand                       SX126X_INSTANCE_SYMBOL( SX126xWriteCommand )
+#define SX126xWriteRegister                      SX126X_INSTANCE_SYMBOL( SX126xWriteRegister )
+#define SX126xWriteRegisters                     SX126X_INSTANCE_SYMBOL( SX126xWriteRegisters )
+
+#endif // SX126X_INSTANCE
+
+#endif // __SX126X_INSTANCE_H__
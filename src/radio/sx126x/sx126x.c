@@ -25,6 +25,7 @@
 #include "timer.h"
 #include "radio.h"
 #include "delay.h"
+#include "energy.h"
 #include "sx126x.h"
 #include "sx126x-board.h"
 
@@ -58,39 +59,284 @@ static volatile RadioLoRaPacketLengthsMode_t LoRaHeaderType;
 volatile uint32_t FrequencyError = 0;
 
 /*!
- * \brief Hold the status of the Image calibration
+ * \brief Image calibration frequency band
  */
-static bool ImageCalibrated = false;
+typedef struct
+{
+    uint32_t      FreqMin;                          //!< Band lower bound, excluded [Hz]
+    uint8_t       CalFreq[2];                       //!< Calibration frequencies [4 MHz steps]
+}RadioImageCalibrationBand_t;
 
-/*
- * SX126x DIO IRQ callback functions prototype
+/*!
+ * \brief Image calibration frequency bands, in decreasing frequency order
  */
+static const RadioImageCalibrationBand_t ImageCalibrationBands[] =
+{
+    { 900000000, { 0xE1, 0xE9 } },                  // 902 - 928 MHz
+    { 850000000, { 0xD7, 0xDB } },                  // 863 - 870 MHz
+    { 770000000, { 0xC1, 0xC5 } },                  // 779 - 787 MHz
+    { 460000000, { 0x75, 0x81 } },                  // 470 - 510 MHz
+    { 425000000, { 0x6B, 0x6F } },                  // 430 - 440 MHz
+};
 
 /*!
- * \brief DIO 0 IRQ callback
+ * \brief No image calibration band
  */
-void SX126xOnDioIrq( void );
+#define IMAGE_CALIBRATION_BAND_NONE                 0xFF
 
 /*!
- * \brief DIO 0 IRQ callback
+ * \brief Hold the band of the last Image calibration
+ */
+static uint8_t ImageCalibratedBand = IMAGE_CALIBRATION_BAND_NONE;
+
+/*!
+ * \brief Image calibration statistics
+ */
+static ImageCalibrationStats_t ImageCalibrationStats;
+
+/*!
+ * \brief SX1261 optimal PA settings, DS_SX1261-2 datasheet table 13-21
+ */
+static const RadioPaSetting_t PaSettingsSx1261[] =
+{
+    { 10, 0x01, 0x00, 13 },
+    { 14, 0x04, 0x00, 14 },
+    { 15, 0x06, 0x00, 14 },
+};
+
+/*!
+ * \brief SX1262 optimal PA settings, DS_SX1261-2 datasheet table 13-21
+ */
+static const RadioPaSetting_t PaSettingsSx1262[] =
+{
+    { 14, 0x02, 0x02, 22 },
+    { 17, 0x02, 0x03, 22 },
+    { 20, 0x03, 0x05, 22 },
+    { 22, 0x04, 0x07, 22 },
+};
+
+/*!
+ * \brief PA settings installed by SX126xSetPaSettings, NULL for the datasheet table
+ */
+static const RadioPaSetting_t *PaSettings = NULL;
+
+/*!
+ * \brief Number of entries of PaSettings
+ */
+static uint8_t NbPaSettings = 0;
+
+/*!
+ * \brief Deferred configuration commands slots
+ *
+ * \remark The slots are flushed in this order, SetPacketType must come before
+ *         the frequency, modulation and packet parameters
+ */
+typedef enum
+{
+    RADIO_CMD_SLOT_REGULATORMODE,
+    RADIO_CMD_SLOT_RFSWITCHMODE,
+    RADIO_CMD_SLOT_BUFFERBASEADDRESS,
+    RADIO_CMD_SLOT_PACONFIG,
+    RADIO_CMD_SLOT_TXPARAMS,
+    RADIO_CMD_SLOT_PACKETTYPE,
+    RADIO_CMD_SLOT_RFFREQUENCY,
+    RADIO_CMD_SLOT_MODULATIONPARAMS,
+    RADIO_CMD_SLOT_PACKETPARAMS,
+    RADIO_CMD_SLOT_DIOIRQPARAMS,
+    RADIO_CMD_SLOT_STOPRXTIMERONPREAMBLE,
+    RADIO_CMD_SLOT_LORASYMBTIMEOUT,
+    RADIO_CMD_SLOT_COUNT
+}RadioCommandSlots_t;
+
+/*!
+ * \brief Maximum parameters size of a deferred configuration command
+ */
+#define RADIO_CMD_SLOT_MAX_SIZE                     9
+
+/*!
+ * \brief Deferred configuration command
+ */
+typedef struct
+{
+    RadioCommands_t Command;                        //!< Radio command opcode
+    bool            Pending;                        //!< Parameters waiting to be sent
+    bool            Valid;                          //!< Sent parameters match the radio state
+    uint8_t         Size;                           //!< Pending parameters size
+    uint8_t         Buffer[RADIO_CMD_SLOT_MAX_SIZE];//!< Pending parameters
+    uint8_t         SentSize;                       //!< Last sent parameters size
+    uint8_t         Sent[RADIO_CMD_SLOT_MAX_SIZE];  //!< Last sent parameters
+}RadioDeferredCommand_t;
+
+/*!
+ * \brief Configuration commands deferred until the next radio access
+ */
+static RadioDeferredCommand_t DeferredCommands[RADIO_CMD_SLOT_COUNT] =
+{
+    { .Command = RADIO_SET_REGULATORMODE },
+    { .Command = RADIO_SET_RFSWITCHMODE },
+    { .Command = RADIO_SET_BUFFERBASEADDRESS },
+    { .Command = RADIO_SET_PACONFIG },
+    { .Command = RADIO_SET_TXPARAMS },
+    { .Command = RADIO_SET_PACKETTYPE },
+    { .Command = RADIO_SET_RFFREQUENCY },
+    { .Command = RADIO_SET_MODULATIONPARAMS },
+    { .Command = RADIO_SET_PACKETPARAMS },
+    { .Command = RADIO_CFG_DIOIRQ },
+    { .Command = RADIO_SET_STOPRXTIMERONPREAMBLE },
+    { .Command = RADIO_SET_LORASYMBTIMEOUT },
+};
+
+/*!
+ * \brief Set while the deferred commands are being sent
+ */
+static bool DeferredCommandsFlushing = false;
+
+/*!
+ * \brief Set when the radio went to sleep with cold start and the configuration
+ *        has to be restored on wake up
+ */
+static bool ColdStartRestorePending = false;
+
+/*!
+ * \brief DIO1 IRQ handler given to SX126xInit
+ */
+static DioIrqHandler *DioIrq = NULL;
+
+/*!
+ * \brief Set when the radio events are polled instead of raised by the DIO1 IRQ
+ */
+static bool PollingMode = false;
+
+/*
+ * SX126x DIO IRQ callback functions prototype
  */
-void SX126xSetPollingMode( void );
 
 /*!
  * \brief DIO 0 IRQ callback
  */
-void SX126xSetInterruptMode( void );
+void SX126xOnDioIrq( void );
 
 /*
  * \brief Process the IRQ if handled by the driver
  */
 void SX126xProcessIrqs( void );
 
+/*!
+ * \brief Records a configuration command to be sent on the next radio access
+ *
+ * \remark The command is dropped when its parameters are the ones already
+ *         applied to the radio
+ *
+ * \param [IN] slot      Deferred command slot
+ * \param [IN] buffer    Command parameters
+ * \param [IN] size      Command parameters size
+ */
+static void SX126xQueueCommand( RadioCommandSlots_t slot, uint8_t *buffer, uint8_t size )
+{
+    RadioDeferredCommand_t *cmd = &DeferredCommands[slot];
+
+    if( ( cmd->Valid == true ) && ( cmd->SentSize == size ) && ( memcmp( cmd->Sent, buffer, size ) == 0 ) )
+    {
+        // Radio already holds these parameters
+        cmd->Pending = false;
+        return;
+    }
+    if( slot == RADIO_CMD_SLOT_PACKETTYPE )
+    {
+        // A new packet type requires the modulation and packet parameters to be sent again
+        DeferredCommands[RADIO_CMD_SLOT_MODULATIONPARAMS].Valid = false;
+        DeferredCommands[RADIO_CMD_SLOT_PACKETPARAMS].Valid = false;
+    }
+    memcpy1( cmd->Buffer, buffer, size );
+    cmd->Size = size;
+    cmd->Pending = true;
+}
+
+/*!
+ * \brief Forgets the parameters applied to the radio. Called when the radio
+ *        configuration is lost (reset, cold start sleep)
+ */
+static void SX126xInvalidateCommands( void )
+{
+    for( uint8_t i = 0; i < RADIO_CMD_SLOT_COUNT; i++ )
+    {
+        DeferredCommands[i].Valid = false;
+    }
+    ImageCalibratedBand = IMAGE_CALIBRATION_BAND_NONE;
+    ColdStartRestorePending = false;
+}
+
+/*!
+ * \brief Schedules the parameters applied to the radio to be sent again.
+ *        Called when the radio goes to cold start sleep
+ */
+static void SX126xReplayCommands( void )
+{
+    for( uint8_t i = 0; i < RADIO_CMD_SLOT_COUNT; i++ )
+    {
+        RadioDeferredCommand_t *cmd = &DeferredCommands[i];
+
+        if( ( cmd->Valid == true ) && ( cmd->Pending == false ) )
+        {
+            memcpy1( cmd->Buffer, cmd->Sent, cmd->SentSize );
+            cmd->Size = cmd->SentSize;
+            cmd->Pending = true;
+        }
+        cmd->Valid = false;
+    }
+    ColdStartRestorePending = true;
+}
+
+/*!
+ * \brief Restores the configuration lost during a cold start sleep, before the
+ *        deferred commands get replayed
+ */
+static void SX126xRestoreColdStart( void )
+{
+    uint8_t band = ImageCalibratedBand;
+
+    // Deferred commands are sent once the TCXO is running
+    DeferredCommandsFlushing = true;
+    SX126xIoTcxoInit( );
+    if( band != IMAGE_CALIBRATION_BAND_NONE )
+    {
+        SX126xWriteCommand( RADIO_CALIBRATEIMAGE, ( uint8_t* )ImageCalibrationBands[band].CalFreq, 2 );
+        ImageCalibrationStats.Calibrations++;
+    }
+    ImageCalibratedBand = band;
+    DeferredCommandsFlushing = false;
+}
+
+/*!
+ * \brief Gets the image calibration band of the given frequency
+ *
+ * \param [IN] freq      RF frequency [Hz]
+ *
+ * \retval band Index in ImageCalibrationBands, IMAGE_CALIBRATION_BAND_NONE if
+ *              the frequency is outside of the supported bands
+ */
+static uint8_t SX126xGetImageCalibrationBand( uint32_t freq )
+{
+    for( uint8_t i = 0; i < ( sizeof( ImageCalibrationBands ) / sizeof( RadioImageCalibrationBand_t ) ); i++ )
+    {
+        if( freq > ImageCalibrationBands[i].FreqMin )
+        {
+            return i;
+        }
+    }
+    return IMAGE_CALIBRATION_BAND_NONE;
+}
+
 void SX126xInit( DioIrqHandler dioIrq )
 {
     SX126xReset( );
+    SX126xInvalidateCommands( );
 
-    SX126xIoIrqInit( dioIrq );
+    DioIrq = dioIrq;
+    if( PollingMode == false )
+    {
+        SX126xIoIrqInit( dioIrq );
+    }
 
     SX126xWakeup( );
     SX126xSetStandby( STDBY_RC );
@@ -102,6 +348,26 @@ void SX126xInit( DioIrqHandler dioIrq )
     SX126xSetOperatingMode( MODE_STDBY_RC );
 }
 
+void SX126xSetPollingMode( void )
+{
+    PollingMode = true;
+    GpioRemoveInterrupt( &SX126x.DIO1 );
+}
+
+void SX126xSetInterruptMode( void )
+{
+    PollingMode = false;
+    if( DioIrq != NULL )
+    {
+        SX126xIoIrqInit( DioIrq );
+    }
+}
+
+bool SX126xIsPollingMode( void )
+{
+    return PollingMode;
+}
+
 RadioOperatingModes_t SX126xGetOperatingMode( void )
 {
     return OperatingMode;
@@ -128,6 +394,26 @@ void SX126xSetOperatingMode( RadioOperatingModes_t mode )
             break;
     }
 #endif
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+    switch( mode )
+    {
+        case MODE_SLEEP:
+            EnergySetRadioState( ENERGY_RADIO_SLEEP );
+            break;
+        case MODE_STDBY_RC:
+        case MODE_STDBY_XOSC:
+            EnergySetRadioState( ENERGY_RADIO_STANDBY );
+            break;
+        case MODE_TX:
+            EnergySetRadioState( ENERGY_RADIO_TX );
+            break;
+        default:
+            // Synthesizer, receiver and CAD modes. The receive duty cycle
+            // mode is accounted as a continuous reception.
+            EnergySetRadioState( ENERGY_RADIO_RX );
+            break;
+    }
+#endif
 }
 
 void SX126xCheckDeviceReady( void )
@@ -137,10 +423,44 @@ void SX126xCheckDeviceReady( void )
         SX126xWakeup( );
         // Switch is turned off when device is in sleep mode and turned on is all other modes
         SX126xAntSwOn( );
+        if( SX126xGetOperatingMode( ) == MODE_SLEEP )
+        {
+            // The radio wakes up in STDBY_RC, avoids waking it up again on the next access
+            SX126xSetOperatingMode( MODE_STDBY_RC );
+        }
+        if( ColdStartRestorePending == true )
+        {
+            ColdStartRestorePending = false;
+            SX126xRestoreColdStart( );
+        }
     }
+    SX126xFlushCommands( );
     SX126xWaitOnBusy( );
 }
 
+void SX126xFlushCommands( void )
+{
+    if( DeferredCommandsFlushing == true )
+    {
+        return;
+    }
+    DeferredCommandsFlushing = true;
+    for( uint8_t i = 0; i < RADIO_CMD_SLOT_COUNT; i++ )
+    {
+        RadioDeferredCommand_t *cmd = &DeferredCommands[i];
+
+        if( cmd->Pending == true )
+        {
+            cmd->Pending = false;
+            memcpy1( cmd->Sent, cmd->Buffer, cmd->Size );
+            cmd->SentSize = cmd->Size;
+            cmd->Valid = true;
+            SX126xWriteCommand( cmd->Command, cmd->Sent, cmd->SentSize );
+        }
+    }
+    DeferredCommandsFlushing = false;
+}
+
 void SX126xSetPayload( uint8_t *payload, uint8_t size )
 {
     SX126xWriteBuffer( 0x00, payload, size );
@@ -250,6 +570,12 @@ void SX126xSetSleep( SleepParams_t sleepConfig )
                       ( ( uint8_t )sleepConfig.Fields.WakeUpRTC ) );
     SX126xWriteCommand( RADIO_SET_SLEEP, &value, 1 );
     SX126xSetOperatingMode( MODE_SLEEP );
+
+    if( sleepConfig.Fields.WarmStart == 0 )
+    {
+        // Cold start, the radio configuration is lost and is sent again on wake up
+        SX126xReplayCommands( );
+    }
 }
 
 void SX126xSetStandby( RadioStandbyModes_t standbyConfig )
@@ -341,17 +667,17 @@ void SX126xSetTxInfinitePreamble( void )
 
 void SX126xSetStopRxTimerOnPreambleDetect( bool enable )
 {
-    SX126xWriteCommand( RADIO_SET_STOPRXTIMERONPREAMBLE, ( uint8_t* )&enable, 1 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_STOPRXTIMERONPREAMBLE, ( uint8_t* )&enable, 1 );
 }
 
 void SX126xSetLoRaSymbNumTimeout( uint8_t SymbNum )
 {
-    SX126xWriteCommand( RADIO_SET_LORASYMBTIMEOUT, &SymbNum, 1 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_LORASYMBTIMEOUT, &SymbNum, 1 );
 }
 
 void SX126xSetRegulatorMode( RadioRegulatorMode_t mode )
 {
-    SX126xWriteCommand( RADIO_SET_REGULATORMODE, ( uint8_t* )&mode, 1 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_REGULATORMODE, ( uint8_t* )&mode, 1 );
 }
 
 void SX126xCalibrate( CalibrationParams_t calibParam )
@@ -365,38 +691,30 @@ void SX126xCalibrate( CalibrationParams_t calibParam )
                       ( ( uint8_t )calibParam.Fields.RC64KEnable ) );
 
     SX126xWriteCommand( RADIO_CALIBRATE, &value, 1 );
+
+    if( calibParam.Fields.ImgEnable != 0 )
+    {
+        // Image is calibrated for the default band, not the operating one
+        ImageCalibratedBand = IMAGE_CALIBRATION_BAND_NONE;
+    }
 }
 
 void SX126xCalibrateImage( uint32_t freq )
 {
-    uint8_t calFreq[2];
+    uint8_t band = SX126xGetImageCalibrationBand( freq );
 
-    if( freq > 900000000 )
-    {
-        calFreq[0] = 0xE1;
-        calFreq[1] = 0xE9;
-    }
-    else if( freq > 850000000 )
-    {
-        calFreq[0] = 0xD7;
-        calFreq[1] = 0xDB;
-    }
-    else if( freq > 770000000 )
+    if( band == IMAGE_CALIBRATION_BAND_NONE )
     {
-        calFreq[0] = 0xC1;
-        calFreq[1] = 0xC5;
-    }
-    else if( freq > 460000000 )
-    {
-        calFreq[0] = 0x75;
-        calFreq[1] = 0x81;
-    }
-    else if( freq > 425000000 )
-    {
-        calFreq[0] = 0x6B;
-        calFreq[1] = 0x6F;
+        return;
     }
-    SX126xWriteCommand( RADIO_CALIBRATEIMAGE, calFreq, 2 );
+    SX126xWriteCommand( RADIO_CALIBRATEIMAGE, ( uint8_t* )ImageCalibrationBands[band].CalFreq, 2 );
+    ImageCalibratedBand = band;
+    ImageCalibrationStats.Calibrations++;
+}
+
+void SX126xGetImageCalibrationStats( ImageCalibrationStats_t *stats )
+{
+    *stats = ImageCalibrationStats;
 }
 
 void SX126xSetPaConfig( uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, uint8_t paLut )
@@ -407,7 +725,40 @@ void SX126xSetPaConfig( uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, u
     buf[1] = hpMax;
     buf[2] = deviceSel;
     buf[3] = paLut;
-    SX126xWriteCommand( RADIO_SET_PACONFIG, buf, 4 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_PACONFIG, buf, 4 );
+}
+
+void SX126xSetPaSettings( const RadioPaSetting_t *settings, uint8_t nbSettings )
+{
+    if( nbSettings == 0 )
+    {
+        settings = NULL;
+    }
+    PaSettings = settings;
+    NbPaSettings = ( settings != NULL ) ? nbSettings : 0;
+}
+
+/*!
+ * \brief Returns the PA setting with the lowest current reaching an output power
+ *
+ * \param [in]  settings      PA settings in increasing Power order
+ * \param [in]  nbSettings    Number of entries of settings
+ * \param [in]  power         Requested output power [dBm]
+ *
+ * \retval      setting       First setting reaching power, the last one when none does
+ */
+static const RadioPaSetting_t* SX126xGetPaSetting( const RadioPaSetting_t *settings, uint8_t nbSettings, int8_t power )
+{
+    uint8_t i;
+
+    for( i = 0; i < ( nbSettings - 1 ); i++ )
+    {
+        if( settings[i].Power >= power )
+        {
+            break;
+        }
+    }
+    return &settings[i];
 }
 
 void SX126xSetRxTxFallbackMode( uint8_t fallbackMode )
@@ -427,7 +778,7 @@ void SX126xSetDioIrqParams( uint16_t irqMask, uint16_t dio1Mask, uint16_t dio2Ma
     buf[5] = ( uint8_t )( dio2Mask & 0x00FF );
     buf[6] = ( uint8_t )( ( dio3Mask >> 8 ) & 0x00FF );
     buf[7] = ( uint8_t )( dio3Mask & 0x00FF );
-    SX126xWriteCommand( RADIO_CFG_DIOIRQ, buf, 8 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_DIOIRQPARAMS, buf, 8 );
 }
 
 uint16_t SX126xGetIrqStatus( void )
@@ -440,7 +791,7 @@ uint16_t SX126xGetIrqStatus( void )
 
 void SX126xSetDio2AsRfSwitchCtrl( uint8_t enable )
 {
-    SX126xWriteCommand( RADIO_SET_RFSWITCHMODE, &enable, 1 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_RFSWITCHMODE, &enable, 1 );
 }
 
 void SX126xSetDio3AsTcxoCtrl( RadioTcxoCtrlVoltage_t tcxoVoltage, uint32_t timeout )
@@ -460,10 +811,13 @@ void SX126xSetRfFrequency( uint32_t frequency )
     uint8_t buf[4];
     uint32_t freq = 0;
 
-    if( ImageCalibrated == false )
+    if( SX126xGetImageCalibrationBand( frequency ) != ImageCalibratedBand )
     {
         SX126xCalibrateImage( frequency );
-        ImageCalibrated = true;
+    }
+    else
+    {
+        ImageCalibrationStats.Skipped++;
     }
 
     freq = ( uint32_t )( ( double )frequency / ( double )FREQ_STEP );
@@ -471,14 +825,14 @@ void SX126xSetRfFrequency( uint32_t frequency )
     buf[1] = ( uint8_t )( ( freq >> 16 ) & 0xFF );
     buf[2] = ( uint8_t )( ( freq >> 8 ) & 0xFF );
     buf[3] = ( uint8_t )( freq & 0xFF );
-    SX126xWriteCommand( RADIO_SET_RFFREQUENCY, buf, 4 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_RFFREQUENCY, buf, 4 );
 }
 
 void SX126xSetPacketType( RadioPacketTypes_t packetType )
 {
     // Save packet type internally to avoid questioning the radio
     PacketType = packetType;
-    SX126xWriteCommand( RADIO_SET_PACKETTYPE, ( uint8_t* )&packetType, 1 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_PACKETTYPE, ( uint8_t* )&packetType, 1 );
 }
 
 RadioPacketTypes_t SX126xGetPacketType( void )
@@ -489,17 +843,22 @@ RadioPacketTypes_t SX126xGetPacketType( void )
 void SX126xSetTxParams( int8_t power, RadioRampTimes_t rampTime )
 {
     uint8_t buf[2];
+    const RadioPaSetting_t *settings = PaSettings;
+    uint8_t nbSettings = NbPaSettings;
+    const RadioPaSetting_t *setting;
 
     if( SX126xGetDeviceId( ) == SX1261 )
     {
-        if( power == 15 )
-        {
-            SX126xSetPaConfig( 0x06, 0x00, 0x01, 0x01 );
-        }
-        else
+        if( settings == NULL )
         {
-            SX126xSetPaConfig( 0x04, 0x00, 0x01, 0x01 );
+            settings = PaSettingsSx1261;
+            nbSettings = sizeof( PaSettingsSx1261 ) / sizeof( RadioPaSetting_t );
         }
+        setting = SX126xGetPaSetting( settings, nbSettings, power );
+        SX126xSetPaConfig( setting->PaDutyCycle, setting->HpMax, 0x01, 0x01 );
+
+        // The lower powers are reached by lowering the power of the selected setting
+        power = setting->TxPower - ( setting->Power - MIN( power, setting->Power ) );
         if( power >= 14 )
         {
             power = 14;
@@ -517,7 +876,16 @@ void SX126xSetTxParams( int8_t power, RadioRampTimes_t rampTime )
         SX126xWriteRegister( 0x08D8, SX126xReadRegister( 0x08D8 ) | ( 0x0F << 1 ) );
         // WORKAROUND END
 
-        SX126xSetPaConfig( 0x04, 0x07, 0x00, 0x01 );
+        if( settings == NULL )
+        {
+            settings = PaSettingsSx1262;
+            nbSettings = sizeof( PaSettingsSx1262 ) / sizeof( RadioPaSetting_t );
+        }
+        setting = SX126xGetPaSetting( settings, nbSettings, power );
+        SX126xSetPaConfig( setting->PaDutyCycle, setting->HpMax, 0x00, 0x01 );
+
+        // The lower powers are reached by lowering the power of the selected setting
+        power = setting->TxPower - ( setting->Power - MIN( power, setting->Power ) );
         if( power > 22 )
         {
             power = 22;
@@ -530,7 +898,7 @@ void SX126xSetTxParams( int8_t power, RadioRampTimes_t rampTime )
     }
     buf[0] = power;
     buf[1] = ( uint8_t )rampTime;
-    SX126xWriteCommand( RADIO_SET_TXPARAMS, buf, 2 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_TXPARAMS, buf, 2 );
 }
 
 void SX126xSetModulationParams( ModulationParams_t *modulationParams )
@@ -560,7 +928,7 @@ void SX126xSetModulationParams( ModulationParams_t *modulationParams )
         buf[5] = ( tempVal >> 16 ) & 0xFF;
         buf[6] = ( tempVal >> 8 ) & 0xFF;
         buf[7] = ( tempVal& 0xFF );
-        SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
+        SX126xQueueCommand( RADIO_CMD_SLOT_MODULATIONPARAMS, buf, n );
         break;
     case PACKET_TYPE_LORA:
         n = 4;
@@ -569,7 +937,7 @@ void SX126xSetModulationParams( ModulationParams_t *modulationParams )
         buf[2] = modulationParams->Params.LoRa.CodingRate;
         buf[3] = modulationParams->Params.LoRa.LowDatarateOptimize;
 
-        SX126xWriteCommand( RADIO_SET_MODULATIONPARAMS, buf, n );
+        SX126xQueueCommand( RADIO_CMD_SLOT_MODULATIONPARAMS, buf, n );
 
         break;
     default:
@@ -634,7 +1002,7 @@ void SX126xSetPacketParams( PacketParams_t *packetParams )
     case PACKET_TYPE_NONE:
         return;
     }
-    SX126xWriteCommand( RADIO_SET_PACKETPARAMS, buf, n );
+    SX126xQueueCommand( RADIO_CMD_SLOT_PACKETPARAMS, buf, n );
 }
 
 void SX126xSetCadParams( RadioLoRaCadSymbols_t cadSymbolNum, uint8_t cadDetPeak, uint8_t cadDetMin, RadioCadExitModes_t cadExitMode, uint32_t cadTimeout )
@@ -658,7 +1026,7 @@ void SX126xSetBufferBaseAddress( uint8_t txBaseAddress, uint8_t rxBaseAddress )
 
     buf[0] = txBaseAddress;
     buf[1] = rxBaseAddress;
-    SX126xWriteCommand( RADIO_SET_BUFFERBASEADDRESS, buf, 2 );
+    SX126xQueueCommand( RADIO_CMD_SLOT_BUFFERBASEADDRESS, buf, 2 );
 }
 
 RadioStatus_t SX126xGetStatus( void )
@@ -452,6 +452,7 @@ typedef enum
     IRQ_CAD_DONE                            = 0x0080,
     IRQ_CAD_ACTIVITY_DETECTED               = 0x0100,
     IRQ_RX_TX_TIMEOUT                       = 0x0200,
+    IRQ_RADIO_RX_END                        = 0x0262, //!< IRQs ending a reception
     IRQ_RADIO_ALL                           = 0xFFFF,
 }RadioIrqMasks_t;
 
@@ -655,6 +656,26 @@ typedef union
     uint16_t Value;
 }RadioError_t;
 
+/*!
+ * \brief Image calibration statistics
+ */
+typedef struct
+{
+    uint32_t Calibrations;                          //!< Number of image calibrations run
+    uint32_t Skipped;                               //!< Frequency changes inside the already calibrated band
+}ImageCalibrationStats_t;
+
+/*!
+ * \brief PA configuration giving the lowest current for an output power
+ */
+typedef struct
+{
+    int8_t  Power;                                  //!< Output power the configuration is optimal for [dBm]
+    uint8_t PaDutyCycle;                            //!< SetPaConfig paDutyCycle
+    uint8_t HpMax;                                  //!< SetPaConfig hpMax
+    int8_t  TxPower;                                //!< SetTxParams power giving Power [dBm]
+}RadioPaSetting_t;
+
 /*!
  * Radio hardware and global parameters
  */
@@ -689,7 +710,13 @@ typedef void ( DioIrqHandler )( void* context );
 #define FREQ_DIV                                    ( double )pow( 2.0, 25.0 )
 #define FREQ_STEP                                   ( double )( XTAL_FREQ / FREQ_DIV )
 
+/*!
+ * Size of the reception buffer, may be reduced to save RAM. The longer frames
+ * are dropped.
+ */
+#ifndef RX_BUFFER_SIZE
 #define RX_BUFFER_SIZE                              256
+#endif
 
 /*!
  * \brief The radio callbacks structure
@@ -719,6 +746,26 @@ typedef struct
  */
 void SX126xInit( DioIrqHandler dioIrq );
 
+/*!
+ * \brief Stops the DIO1 IRQ, the radio events are only detected by the
+ *        Radio.IrqProcess calls, which check the DIO1 level
+ *
+ * \remark Lets an RTOS task service the radio at fixed points
+ */
+void SX126xSetPollingMode( void );
+
+/*!
+ * \brief Restores the DIO1 IRQ, the default mode
+ */
+void SX126xSetInterruptMode( void );
+
+/*!
+ * \brief Checks if the radio events are polled
+ *
+ * \retval      polling       true when SX126xSetPollingMode is active
+ */
+bool SX126xIsPollingMode( void );
+
 /*!
  * \brief Gets the current Radio OperationMode variable
  *
@@ -738,9 +785,24 @@ void SX126xSetOperatingMode( RadioOperatingModes_t mode );
 
 /*!
  * \brief Wakeup the radio if it is in Sleep mode and check that Busy is low
+ *
+ * \remark Sends the deferred configuration commands first
  */
 void SX126xCheckDeviceReady( void );
 
+/*!
+ * \brief Sends the deferred configuration commands
+ *
+ * \remark SetRegulatorMode, SetDio2AsRfSwitchCtrl, SetBufferBaseAddress,
+ *         SetPaConfig, SetTxParams, SetPacketType, SetRfFrequency,
+ *         SetModulationParams, SetPacketParams, SetDioIrqParams,
+ *         SetStopRxTimerOnPreambleDetect and SetLoRaSymbNumTimeout are only
+ *         recorded and sent, in this order, before the next radio access.
+ *         Commands whose parameters are already applied to the radio are
+ *         dropped. After a cold start sleep they are all sent again on wake up.
+ */
+void SX126xFlushCommands( void );
+
 /*!
  * \brief Saves the payload to be send in the radio buffer
  *
@@ -812,6 +874,9 @@ uint32_t SX126xGetRandom( void );
 /*!
  * \brief Sets the radio in sleep mode
  *
+ * \remark With a cold start the driver restores the TCXO, the image
+ *         calibration and the recorded configuration commands on wake up
+ *
  * \param [in]  sleepConfig   The sleep configuration describing data
  *                            retention and RTC wake-up
  */
@@ -905,10 +970,22 @@ void SX126xCalibrate( CalibrationParams_t calibParam );
 /*!
  * \brief Calibrates the Image rejection depending of the frequency
  *
+ * \remark The calibrated band is remembered, SX126xSetRfFrequency only
+ *         calibrates again when the frequency leaves it. Calling this function
+ *         at init with the channel plan frequency avoids the calibration
+ *         delay on the first frequency change.
+ *
  * \param [in]  freq    The operating frequency
  */
 void SX126xCalibrateImage( uint32_t freq );
 
+/*!
+ * \brief Gets the image calibration statistics
+ *
+ * \param [out] stats   Image calibration statistics
+ */
+void SX126xGetImageCalibrationStats( ImageCalibrationStats_t *stats );
+
 /*!
  * \brief Activate the extention of the timeout when long preamble is used
  *
@@ -926,6 +1003,19 @@ void SX126xSetLongPreamble( uint8_t enable );
  */
 void SX126xSetPaConfig( uint8_t paDutyCycle, uint8_t hpMax, uint8_t deviceSel, uint8_t paLut );
 
+/*!
+ * \brief Sets the PA configurations SetTxParams selects from
+ *
+ * \remark The default tables are the optimal settings of the DS_SX1261-2
+ *         datasheet. A board whose matching network differs installs its own
+ *         table, for instance from SX126xIoInit.
+ *
+ * \param [in]  settings      PA configurations in increasing Power order,
+ *                            NULL restores the datasheet table of the device
+ * \param [in]  nbSettings    Number of entries of settings
+ */
+void SX126xSetPaSettings( const RadioPaSetting_t *settings, uint8_t nbSettings );
+
 /*!
  * \brief Defines into which mode the chip goes after a TX / RX done
  *
@@ -1028,7 +1118,10 @@ RadioPacketTypes_t SX126xGetPacketType( void );
 /*!
  * \brief Sets the transmission parameters
  *
- * \param [in]  power         RF output power [-18..13] dBm
+ * \remark The PA is configured with the lowest current entry of the PA
+ *         settings table reaching the requested power, see SX126xSetPaSettings
+ *
+ * \param [in]  power         RF output power [-17..15] dBm for sx1261, [-9..22] dBm for sx1262
  * \param [in]  rampTime      Transmission ramp up time
  */
 void SX126xSetTxParams( int8_t power, RadioRampTimes_t rampTime );
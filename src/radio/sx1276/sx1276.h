@@ -149,6 +149,14 @@ typedef struct SX1276_s
     RadioSettings_t Settings;
 }SX1276_t;
 
+/*!
+ * FHSS hopping table entry, FRF registers value of a channel
+ */
+typedef struct sRadioFhssChannel
+{
+    uint8_t Frf[3];                                 //!< REG_FRFMSB, REG_FRFMID and REG_FRFLSB values
+}RadioFhssChannel_t;
+
 /*!
  * Hardware IO IRQ callback function definition
  */
@@ -160,7 +168,28 @@ typedef void ( DioIrqHandler )( void* context );
 #define XTAL_FREQ                                   32000000
 #define FREQ_STEP                                   61.03515625
 
+/*!
+ * Size of the reception buffer, may be reduced to save RAM. The longer frames
+ * are filtered out or truncated.
+ */
+#ifndef RX_BUFFER_SIZE
 #define RX_BUFFER_SIZE                              256
+#endif
+
+/*!
+ * FSK packet handler FIFO size
+ */
+#define FSK_FIFO_SIZE                               64
+
+/*!
+ * FSK FIFO level threshold used to stream the received packets out of the FIFO
+ *
+ * \remark Higher values lower the interrupt rate. Lower values leave more
+ *         time to the interrupt handler before the FIFO overruns.
+ */
+#ifndef FSK_FIFO_THRESHOLD
+#define FSK_FIFO_THRESHOLD                          32
+#endif
 
 /*!
  * ============================================================================
@@ -196,6 +225,28 @@ void SX1276SetModem( RadioModems_t modem );
  */
 void SX1276SetChannel( uint32_t freq );
 
+/*!
+ * \brief Computes the FHSS hopping table entry of a channel
+ *
+ * \param [IN]  freq         Channel RF frequency
+ * \param [OUT] channel      Hopping table entry
+ */
+void SX1276FhssComputeChannel( uint32_t freq, RadioFhssChannel_t *channel );
+
+/*!
+ * \brief Sets the FHSS hopping table. The FhssChangeChannel interrupt then
+ *        writes the next entry in a single burst, the FhssChangeChannel
+ *        event isn't reported to the application.
+ *
+ * \remark Entry 0 is the channel set before the reception or transmission
+ *         start, each hop applies the next entry, wrapping around. The table
+ *         isn't copied and must stay valid while it is set.
+ *
+ * \param [IN] table         Hopping table, NULL reports the hops to the application
+ * \param [IN] size          Number of entries of table
+ */
+void SX1276SetFhssTable( const RadioFhssChannel_t *table, uint8_t size );
+
 /*!
  * \brief Checks if the channel is free for the given time
  *
@@ -208,6 +259,18 @@ void SX1276SetChannel( uint32_t freq );
  */
 bool SX1276IsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
 
+/*!
+ * \brief Starts a carrier sense on the given channel without blocking
+ *
+ * \remark The result is reported by the CarrierSenseDone callback
+ *
+ * \param [IN] modem      Radio modem to be used [0: FSK, 1: LoRa]
+ * \param [IN] freq       Channel RF frequency
+ * \param [IN] rssiThresh RSSI threshold
+ * \param [IN] maxCarrierSenseTime Max time while the RSSI is measured
+ */
+void SX1276StartCarrierSense( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime );
+
 /*!
  * \brief Generates a 32 bits random value based on the RSSI readings
  *
@@ -324,6 +387,15 @@ void SX1276SetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
  */
 uint32_t SX1276GetTimeOnAir( RadioModems_t modem, uint8_t pktLen );
 
+/*!
+ * \brief Loads the buffer of size and the packet parameters ahead of a
+ *        \ref SX1276Send call
+ *
+ * \param [IN]: buffer     Buffer pointer
+ * \param [IN]: size       Buffer size
+ */
+void SX1276PrepareTx( uint8_t *buffer, uint8_t size );
+
 /*!
  * \brief Sends the buffer of size. Prepares the packet to be sent and sets
  *        the radio in transmission
@@ -370,6 +442,13 @@ void SX1276SetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time );
  */
 int16_t SX1276ReadRssi( RadioModems_t modem );
 
+/*!
+ * \brief Reads the frequency error measured on the last received packet
+ *
+ * \retval freqError Frequency error [Hz]
+ */
+int32_t SX1276GetFreqError( void );
+
 /*!
  * \brief Writes the radio register at the specified address
  *
@@ -428,6 +507,16 @@ void SX1276SetPublicNetwork( bool enable );
  */
 uint32_t SX1276GetWakeupTime( void );
 
+/*!
+ * \brief Gets the number of Rx chain calibrations run since start-up
+ *
+ * \remark The calibration runs at init and after the radio reset done on a Tx
+ *         timeout. Each one covers the LF and HF bands.
+ *
+ * \retval count Number of Rx chain calibrations
+ */
+uint32_t SX1276GetRxChainCalibrationCount( void );
+
 #ifdef __cplusplus
 }
 #endif
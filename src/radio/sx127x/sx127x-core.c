@@ -0,0 +1,2145 @@
+/*!
+ * \file      sx127x-core.c
+ *
+ * \brief     SX1272 and SX1276 common driver implementation
+ *
+ * \remark    Not compiled on its own, included by sx1272.c and sx1276.c. See
+ *            sx127x-core.h for the chip traits the including driver defines.
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ *
+ * \author    Gregory Cristian ( Semtech )
+ *
+ * \author    Wael Guibene ( Semtech )
+ */
+#include "sx127x-core.h"
+
+
+/*
+ * Local types definition
+ */
+
+/*!
+ * Radio registers definition
+ */
+typedef struct
+{
+    RadioModems_t Modem;
+    uint8_t       Addr;
+    uint8_t       Value;
+}RadioRegisters_t;
+
+/*!
+ * FSK bandwidth definition
+ */
+typedef struct
+{
+    uint32_t bandwidth;
+    uint8_t  RegValue;
+}FskBandwidth_t;
+
+
+/*
+ * Private functions prototypes
+ */
+
+/*!
+ * \brief Sets the SX127x in transmission mode for the given time
+ * \param [IN] timeout Transmission timeout [ms] [0: continuous, others timeout]
+ */
+void SX127xSetTx( uint32_t timeout );
+
+/*!
+ * \brief Writes the buffer contents to the SX127x FIFO
+ *
+ * \param [IN] buffer Buffer containing data to be put on the FIFO.
+ * \param [IN] size Number of bytes to be written to the FIFO
+ */
+void SX127xWriteFifo( uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Reads the contents of the SX127x FIFO
+ *
+ * \param [OUT] buffer Buffer where to copy the FIFO read data.
+ * \param [IN] size Number of bytes to be read from the FIFO
+ */
+void SX127xReadFifo( uint8_t *buffer, uint8_t size );
+
+/*!
+ * \brief Sets the SX127x operating mode
+ *
+ * \param [IN] opMode New operating mode
+ */
+void SX127xSetOpMode( uint8_t opMode );
+
+/*
+ * SX127x DIO IRQ callback functions prototype
+ */
+
+/*!
+ * \brief DIO 0 IRQ callback
+ */
+void SX127xOnDio0Irq( void* context );
+
+/*!
+ * \brief DIO 1 IRQ callback
+ */
+void SX127xOnDio1Irq( void* context );
+
+/*!
+ * \brief DIO 2 IRQ callback
+ */
+void SX127xOnDio2Irq( void* context );
+
+/*!
+ * \brief DIO 3 IRQ callback
+ */
+void SX127xOnDio3Irq( void* context );
+
+/*!
+ * \brief DIO 4 IRQ callback
+ */
+void SX127xOnDio4Irq( void* context );
+
+/*!
+ * \brief DIO 5 IRQ callback
+ */
+void SX127xOnDio5Irq( void* context );
+
+/*!
+ * \brief Tx & Rx timeout timer callback
+ */
+void SX127xOnTimeoutIrq( void* context );
+
+/*!
+ * \brief Carrier sense timer callback, samples the RSSI
+ */
+static void SX127xOnCarrierSenseTimerEvent( void* context );
+
+/*
+ * Private global constants
+ */
+
+/*!
+ * Radio hardware registers initialization
+ *
+ * \remark RADIO_INIT_REGISTERS_VALUE is defined in sx127x-board.h file
+ */
+const RadioRegisters_t RadioRegsInit[] = RADIO_INIT_REGISTERS_VALUE;
+
+/*!
+ * Precomputed FSK bandwidth registers values
+ */
+const FskBandwidth_t FskBandwidths[] =
+{
+    { 2600  , 0x17 },
+    { 3100  , 0x0F },
+    { 3900  , 0x07 },
+    { 5200  , 0x16 },
+    { 6300  , 0x0E },
+    { 7800  , 0x06 },
+    { 10400 , 0x15 },
+    { 12500 , 0x0D },
+    { 15600 , 0x05 },
+    { 20800 , 0x14 },
+    { 25000 , 0x0C },
+    { 31300 , 0x04 },
+    { 41700 , 0x13 },
+    { 50000 , 0x0B },
+    { 62500 , 0x03 },
+    { 83333 , 0x12 },
+    { 100000, 0x0A },
+    { 125000, 0x02 },
+    { 166700, 0x11 },
+    { 200000, 0x09 },
+    { 250000, 0x01 },
+    { 300000, 0x00 }, // Invalid Bandwidth
+};
+
+/*
+ * Private global variables
+ */
+
+/*!
+ * Radio callbacks variable
+ */
+static RadioEvents_t *RadioEvents;
+
+/*!
+ * Carrier sense RSSI sampling period [ms]. The first sample is taken one
+ * period after the reception start to let the RSSI settle.
+ */
+#ifndef RADIO_CARRIER_SENSE_SAMPLE_PERIOD
+#define RADIO_CARRIER_SENSE_SAMPLE_PERIOD           1
+#endif
+
+/*!
+ * Carrier sense in progress
+ */
+typedef struct sRadioCarrierSense
+{
+    RadioModems_t Modem;
+    int16_t RssiThresh;
+    /*!
+     * Sensing time including the RSSI settling time [ms]
+     */
+    uint32_t Duration;
+    TimerTime_t StartTime;
+    TimerEvent_t Timer;
+}RadioCarrierSense_t;
+
+static RadioCarrierSense_t CarrierSense;
+
+/*!
+ * Maximum payload size which fits the reception buffer
+ */
+#define RX_PAYLOAD_MAX_SIZE                         MIN( RX_BUFFER_SIZE, 255 )
+
+/*!
+ * Reception buffer
+ */
+static uint8_t RxTxBuffer[RX_BUFFER_SIZE];
+
+/*!
+ * Payload loaded in the radio by SX127xPrepareTx. NULL when none
+ */
+static uint8_t *TxPreparedBuffer = NULL;
+static uint8_t TxPreparedSize = 0;
+
+/*!
+ * Number of registers covered by the configuration registers shadow
+ */
+#define SHADOW_REGS_SIZE                            0x60
+
+/*!
+ * Bit of a register in the configuration registers shadow masks
+ */
+#define SHADOW_REG_BIT( reg )                       ( ( uint32_t )1 << ( ( reg ) & 0x1F ) )
+
+/*!
+ * Registers, per modem, whose content only changes when written by the driver.
+ * Their last value is kept in RAM so that unchanged writes and read-modify-write
+ * reads do not go over SPI.
+ *
+ * \remark Registers updated by the radio (operating mode, IRQ flags, RSSI,
+ *         AFC/FEI, temperature, FIFO pointers and status) and registers holding
+ *         self-clearing trigger bits (RxConfig, AfcFei, Osc, SeqConfig1,
+ *         ImageCal) are excluded.
+ */
+static const uint32_t ShadowRegsMask[2][SHADOW_REGS_SIZE / 32] =
+{
+    // MODEM_FSK
+    {
+        SHADOW_REG_BIT( REG_BITRATEMSB ) |
+        SHADOW_REG_BIT( REG_BITRATELSB ) |
+        SHADOW_REG_BIT( REG_FDEVMSB ) |
+        SHADOW_REG_BIT( REG_FDEVLSB ) |
+        SHADOW_REG_BIT( REG_FRFMSB ) |
+        SHADOW_REG_BIT( REG_FRFMID ) |
+        SHADOW_REG_BIT( REG_FRFLSB ) |
+        SHADOW_REG_BIT( REG_PACONFIG ) |
+        SHADOW_REG_BIT( REG_PARAMP ) |
+        SHADOW_REG_BIT( REG_OCP ) |
+        SHADOW_REG_BIT( REG_RSSICONFIG ) |
+        SHADOW_REG_BIT( REG_RSSICOLLISION ) |
+        SHADOW_REG_BIT( REG_RSSITHRESH ) |
+        SHADOW_REG_BIT( REG_RXBW ) |
+        SHADOW_REG_BIT( REG_AFCBW ) |
+        SHADOW_REG_BIT( REG_OOKPEAK ) |
+        SHADOW_REG_BIT( REG_OOKFIX ) |
+        SHADOW_REG_BIT( REG_OOKAVG ) |
+        SHADOW_REG_BIT( REG_PREAMBLEDETECT ),
+        SHADOW_REG_BIT( REG_RXTIMEOUT1 ) |
+        SHADOW_REG_BIT( REG_RXTIMEOUT2 ) |
+        SHADOW_REG_BIT( REG_RXTIMEOUT3 ) |
+        SHADOW_REG_BIT( REG_RXDELAY ) |
+        SHADOW_REG_BIT( REG_PREAMBLEMSB ) |
+        SHADOW_REG_BIT( REG_PREAMBLELSB ) |
+        SHADOW_REG_BIT( REG_SYNCCONFIG ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE1 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE2 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE3 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE4 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE5 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE6 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE7 ) |
+        SHADOW_REG_BIT( REG_SYNCVALUE8 ) |
+        SHADOW_REG_BIT( REG_PACKETCONFIG1 ) |
+        SHADOW_REG_BIT( REG_PACKETCONFIG2 ) |
+        SHADOW_REG_BIT( REG_PAYLOADLENGTH ) |
+        SHADOW_REG_BIT( REG_NODEADRS ) |
+        SHADOW_REG_BIT( REG_BROADCASTADRS ) |
+        SHADOW_REG_BIT( REG_FIFOTHRESH ) |
+        SHADOW_REG_BIT( REG_SEQCONFIG2 ) |
+        SHADOW_REG_BIT( REG_TIMERRESOL ) |
+        SHADOW_REG_BIT( REG_TIMER1COEF ) |
+        SHADOW_REG_BIT( REG_TIMER2COEF ) |
+        SHADOW_REG_BIT( REG_LOWBAT ),
+        SHADOW_REG_BIT( REG_DIOMAPPING1 ) |
+        SHADOW_REG_BIT( REG_DIOMAPPING2 ) |
+        SHADOW_REG_BIT( REG_PLLHOP ) |
+        SHADOW_REG_BIT( REG_TCXO ) |
+        SHADOW_REG_BIT( REG_PADAC )
+#if defined( SX127X_CHIP_SX1276 )
+        | SHADOW_REG_BIT( REG_BITRATEFRAC )
+#endif
+    },
+    // MODEM_LORA
+    {
+        SHADOW_REG_BIT( REG_LR_FRFMSB ) |
+        SHADOW_REG_BIT( REG_LR_FRFMID ) |
+        SHADOW_REG_BIT( REG_LR_FRFLSB ) |
+        SHADOW_REG_BIT( REG_LR_PACONFIG ) |
+        SHADOW_REG_BIT( REG_LR_PARAMP ) |
+        SHADOW_REG_BIT( REG_LR_OCP ) |
+        SHADOW_REG_BIT( REG_LR_FIFOTXBASEADDR ) |
+        SHADOW_REG_BIT( REG_LR_FIFORXBASEADDR ) |
+        SHADOW_REG_BIT( REG_LR_IRQFLAGSMASK ) |
+        SHADOW_REG_BIT( REG_LR_MODEMCONFIG1 ) |
+        SHADOW_REG_BIT( REG_LR_MODEMCONFIG2 ) |
+        SHADOW_REG_BIT( REG_LR_SYMBTIMEOUTLSB ),
+        SHADOW_REG_BIT( REG_LR_PREAMBLEMSB ) |
+        SHADOW_REG_BIT( REG_LR_PREAMBLELSB ) |
+        SHADOW_REG_BIT( REG_LR_PAYLOADLENGTH ) |
+        SHADOW_REG_BIT( REG_LR_PAYLOADMAXLENGTH ) |
+        SHADOW_REG_BIT( REG_LR_HOPPERIOD ) |
+#if defined( SX127X_CHIP_SX1276 )
+        SHADOW_REG_BIT( REG_LR_MODEMCONFIG3 ) |
+#endif
+        SHADOW_REG_BIT( REG_LR_DETECTOPTIMIZE ) |
+        SHADOW_REG_BIT( REG_LR_INVERTIQ ) |
+#if defined( SX127X_CHIP_SX1276 )
+        SHADOW_REG_BIT( REG_LR_HIGHBWOPTIMIZE1 ) |
+        SHADOW_REG_BIT( REG_LR_HIGHBWOPTIMIZE2 ) |
+#endif
+        SHADOW_REG_BIT( REG_LR_DETECTIONTHRESHOLD ) |
+        SHADOW_REG_BIT( REG_LR_SYNCWORD ) |
+        SHADOW_REG_BIT( REG_LR_INVERTIQ2 ),
+        SHADOW_REG_BIT( REG_LR_DIOMAPPING1 ) |
+        SHADOW_REG_BIT( REG_LR_DIOMAPPING2 ) |
+        SHADOW_REG_BIT( REG_LR_PADAC )
+    }
+};
+
+/*!
+ * Shadowed registers values
+ */
+static uint8_t ShadowRegs[SHADOW_REGS_SIZE];
+
+/*!
+ * Shadowed registers holding a known value
+ */
+static uint32_t ShadowRegsValid[SHADOW_REGS_SIZE / 32];
+
+/*!
+ * Set while the radio modem is known and the shadow can be used
+ */
+static bool ShadowRegsActive = false;
+
+/*!
+ * Radio modem the shadowed registers values belong to
+ */
+static RadioModems_t ShadowRegsModem = MODEM_FSK;
+
+/*!
+ * Shadowed registers written while a burst is open and not sent yet
+ */
+static uint32_t ShadowRegsDirty[SHADOW_REGS_SIZE / 32];
+
+/*!
+ * Nesting level of the open bursts. The shadowed registers writes are deferred
+ * while not 0, see \ref ShadowRegsBurstBegin
+ */
+static uint8_t ShadowRegsBurst = 0;
+
+/*
+ * Public global variables
+ */
+
+/*!
+ * Radio hardware and global parameters
+ */
+SX127x_t SX127x;
+
+/*!
+ * Hardware DIO IRQ callback initialization
+ */
+DioIrqHandler *DioIrq[] = { SX127xOnDio0Irq, SX127xOnDio1Irq,
+                            SX127xOnDio2Irq, SX127xOnDio3Irq,
+                            SX127xOnDio4Irq, NULL };
+
+/*!
+ * Tx and Rx timers
+ */
+TimerEvent_t TxTimeoutTimer;
+TimerEvent_t RxTimeoutTimer;
+TimerEvent_t RxTimeoutSyncWord;
+
+/*!
+ * FHSS hopping table, NULL when the hops are reported to the application
+ */
+static const RadioFhssChannel_t *FhssTable = NULL;
+
+/*!
+ * Number of entries of FhssTable
+ */
+static uint8_t FhssTableSize = 0;
+
+/*!
+ * FhssTable entry in use
+ */
+static uint8_t FhssTableIndex = 0;
+
+/*
+ * Radio driver functions implementation
+ */
+
+/*!
+ * \brief Forgets the shadowed registers values. Called when the radio modem
+ *        changes or the radio is reset
+ *
+ * \param [IN] modem Radio modem now in use. The radio is in FSK mode after reset
+ */
+static void ShadowRegsReset( RadioModems_t modem )
+{
+    memset1( ( uint8_t* )ShadowRegsValid, 0, sizeof( ShadowRegsValid ) );
+    memset1( ( uint8_t* )ShadowRegsDirty, 0, sizeof( ShadowRegsDirty ) );
+    ShadowRegsModem = modem;
+    ShadowRegsActive = true;
+}
+
+/*!
+ * \brief Checks if the register is covered by the shadow
+ *
+ * \param [IN] addr Register address
+ * \retval shadowed [true: shadowed, false: SPI access only]
+ */
+static bool ShadowRegsIsShadowed( uint16_t addr )
+{
+    return ( ShadowRegsActive == true ) && ( addr < SHADOW_REGS_SIZE ) &&
+           ( ( ShadowRegsMask[ShadowRegsModem][addr >> 5] & SHADOW_REG_BIT( addr ) ) != 0 );
+}
+
+/*!
+ * \brief Sends the deferred shadowed registers writes. Contiguous registers
+ *        are sent in a single SPI burst. Known registers values in between are
+ *        re-written to merge the bursts.
+ */
+static void ShadowRegsFlush( void )
+{
+    uint16_t addr = 0;
+    uint16_t start;
+    uint16_t end;
+
+    while( addr < SHADOW_REGS_SIZE )
+    {
+        if( ( ShadowRegsDirty[addr >> 5] & SHADOW_REG_BIT( addr ) ) == 0 )
+        {
+            addr++;
+            continue;
+        }
+        start = addr;
+        end = addr;
+        while( ( addr < SHADOW_REGS_SIZE ) && ( ( ShadowRegsValid[addr >> 5] & SHADOW_REG_BIT( addr ) ) != 0 ) )
+        {
+            if( ( ShadowRegsDirty[addr >> 5] & SHADOW_REG_BIT( addr ) ) != 0 )
+            {
+                ShadowRegsDirty[addr >> 5] &= ~SHADOW_REG_BIT( addr );
+                end = addr + 1;
+            }
+            addr++;
+        }
+        SX127xWriteBuffer( start, &ShadowRegs[start], end - start );
+        addr = end;
+    }
+}
+
+/*!
+ * \brief Starts deferring the shadowed registers writes so that a configuration
+ *        sequence is sent in a few SPI bursts by \ref ShadowRegsBurstEnd
+ */
+static void ShadowRegsBurstBegin( void )
+{
+    ShadowRegsBurst++;
+}
+
+/*!
+ * \brief Closes a burst. The deferred writes are sent when the outermost burst
+ *        is closed
+ */
+static void ShadowRegsBurstEnd( void )
+{
+    if( --ShadowRegsBurst == 0 )
+    {
+        ShadowRegsFlush( );
+    }
+}
+
+void SX127xInit( RadioEvents_t *events )
+{
+    uint8_t i;
+
+    RadioEvents = events;
+
+    // Initialize driver timeout timers
+    TimerInit( &TxTimeoutTimer, SX127xOnTimeoutIrq );
+    TimerInit( &RxTimeoutTimer, SX127xOnTimeoutIrq );
+    TimerInit( &RxTimeoutSyncWord, SX127xOnTimeoutIrq );
+    TimerInit( &CarrierSense.Timer, SX127xOnCarrierSenseTimerEvent );
+
+    SX127xReset( );
+    ShadowRegsReset( MODEM_FSK );
+
+    RxChainCalibration( );
+
+    SX127xSetOpMode( RF_OPMODE_SLEEP );
+
+    SX127xIoIrqInit( DioIrq );
+
+    for( i = 0; i < sizeof( RadioRegsInit ) / sizeof( RadioRegisters_t ); i++ )
+    {
+        SX127xSetModem( RadioRegsInit[i].Modem );
+        SX127xWrite( RadioRegsInit[i].Addr, RadioRegsInit[i].Value );
+    }
+
+    SX127xSetModem( MODEM_FSK );
+
+    SX127x.Settings.State = RF_IDLE;
+}
+
+RadioState_t SX127xGetStatus( void )
+{
+    return SX127x.Settings.State;
+}
+
+void SX127xSetChannel( uint32_t freq )
+{
+    SX127x.Settings.Channel = freq;
+    freq = ( uint32_t )( ( double )freq / ( double )FREQ_STEP );
+    ShadowRegsBurstBegin( );
+    SX127xWrite( REG_FRFMSB, ( uint8_t )( ( freq >> 16 ) & 0xFF ) );
+    SX127xWrite( REG_FRFMID, ( uint8_t )( ( freq >> 8 ) & 0xFF ) );
+    SX127xWrite( REG_FRFLSB, ( uint8_t )( freq & 0xFF ) );
+    ShadowRegsBurstEnd( );
+}
+
+void SX127xFhssComputeChannel( uint32_t freq, RadioFhssChannel_t *channel )
+{
+    freq = ( uint32_t )( ( double )freq / ( double )FREQ_STEP );
+    channel->Frf[0] = ( uint8_t )( ( freq >> 16 ) & 0xFF );
+    channel->Frf[1] = ( uint8_t )( ( freq >> 8 ) & 0xFF );
+    channel->Frf[2] = ( uint8_t )( freq & 0xFF );
+}
+
+void SX127xSetFhssTable( const RadioFhssChannel_t *table, uint8_t size )
+{
+    FhssTable = ( size != 0 ) ? table : NULL;
+    FhssTableSize = ( table != NULL ) ? size : 0;
+    FhssTableIndex = 0;
+}
+
+/*!
+ * \brief Applies the next channel of the FHSS hopping table
+ */
+static void SX127xFhssNextChannel( void )
+{
+    const RadioFhssChannel_t *channel;
+
+    FhssTableIndex = ( FhssTableIndex + 1 ) % FhssTableSize;
+    channel = &FhssTable[FhssTableIndex];
+
+    // REG_FRFMSB to REG_FRFLSB are sent in a single SPI burst
+    ShadowRegsBurstBegin( );
+    SX127xWrite( REG_FRFMSB, channel->Frf[0] );
+    SX127xWrite( REG_FRFMID, channel->Frf[1] );
+    SX127xWrite( REG_FRFLSB, channel->Frf[2] );
+    ShadowRegsBurstEnd( );
+}
+
+bool SX127xIsChannelFree( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
+{
+    bool status = true;
+    int16_t rssi = 0;
+    uint32_t carrierSenseTime = 0;
+
+    SX127xSetSleep( );
+
+    SX127xSetModem( modem );
+
+    SX127xSetChannel( freq );
+
+    SX127xSetOpMode( RF_OPMODE_RECEIVER );
+
+    DelayMs( 1 );
+
+    carrierSenseTime = TimerGetCurrentTime( );
+
+    // Perform carrier sense for maxCarrierSenseTime
+    while( TimerGetElapsedTime( carrierSenseTime ) < maxCarrierSenseTime )
+    {
+        rssi = SX127xReadRssi( modem );
+
+        if( rssi > rssiThresh )
+        {
+            status = false;
+            break;
+        }
+    }
+    SX127xSetSleep( );
+    return status;
+}
+
+void SX127xStartCarrierSense( RadioModems_t modem, uint32_t freq, int16_t rssiThresh, uint32_t maxCarrierSenseTime )
+{
+    SX127xSetSleep( );
+
+    SX127xSetModem( modem );
+
+    SX127xSetChannel( freq );
+
+    SX127xSetOpMode( RF_OPMODE_RECEIVER );
+
+    CarrierSense.Modem = modem;
+    CarrierSense.RssiThresh = rssiThresh;
+    CarrierSense.Duration = maxCarrierSenseTime + RADIO_CARRIER_SENSE_SAMPLE_PERIOD;
+    CarrierSense.StartTime = TimerGetCurrentTime( );
+
+    TimerSetValue( &CarrierSense.Timer, RADIO_CARRIER_SENSE_SAMPLE_PERIOD );
+    TimerStart( &CarrierSense.Timer );
+}
+
+uint32_t SX127xRandom( void )
+{
+    uint8_t i;
+    uint32_t rnd = 0;
+
+    /*
+     * Radio setup for random number generation
+     */
+    // Set LoRa modem ON
+    SX127xSetModem( MODEM_LORA );
+
+    // Disable LoRa modem interrupts
+    SX127xWrite( REG_LR_IRQFLAGSMASK, RFLR_IRQFLAGS_RXTIMEOUT |
+                  RFLR_IRQFLAGS_RXDONE |
+                  RFLR_IRQFLAGS_PAYLOADCRCERROR |
+                  RFLR_IRQFLAGS_VALIDHEADER |
+                  RFLR_IRQFLAGS_TXDONE |
+                  RFLR_IRQFLAGS_CADDONE |
+                  RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL |
+                  RFLR_IRQFLAGS_CADDETECTED );
+
+    // Set radio in continuous reception
+    SX127xSetOpMode( RF_OPMODE_RECEIVER );
+
+    for( i = 0; i < 32; i++ )
+    {
+        DelayMs( 1 );
+        // Unfiltered RSSI value reading. Only takes the LSB value
+        rnd |= ( ( uint32_t )SX127xRead( REG_LR_RSSIWIDEBAND ) & 0x01 ) << i;
+    }
+
+    SX127xSetSleep( );
+
+    return rnd;
+}
+
+/*!
+ * Returns the known FSK bandwidth registers value
+ *
+ * \param [IN] bandwidth Bandwidth value in Hz
+ * \retval regValue Bandwidth register value.
+ */
+static uint8_t GetFskBandwidthRegValue( uint32_t bandwidth )
+{
+    uint8_t i;
+
+    for( i = 0; i < ( sizeof( FskBandwidths ) / sizeof( FskBandwidth_t ) ) - 1; i++ )
+    {
+        if( ( bandwidth >= FskBandwidths[i].bandwidth ) && ( bandwidth < FskBandwidths[i + 1].bandwidth ) )
+        {
+            return FskBandwidths[i].RegValue;
+        }
+    }
+    // ERROR: Value not found
+    while( 1 );
+}
+
+void SX127xSetRxConfig( RadioModems_t modem, uint32_t bandwidth,
+                         uint32_t datarate, uint8_t coderate,
+                         uint32_t bandwidthAfc, uint16_t preambleLen,
+                         uint16_t symbTimeout, bool fixLen,
+                         uint8_t payloadLen,
+                         bool crcOn, bool freqHopOn, uint8_t hopPeriod,
+                         bool iqInverted, bool rxContinuous )
+{
+    SX127xSetModem( modem );
+
+    // The configuration registers are sent in bursts
+    ShadowRegsBurstBegin( );
+
+    switch( modem )
+    {
+    case MODEM_FSK:
+        {
+            SX127x.Settings.Fsk.Bandwidth = bandwidth;
+            SX127x.Settings.Fsk.Datarate = datarate;
+            SX127x.Settings.Fsk.BandwidthAfc = bandwidthAfc;
+            SX127x.Settings.Fsk.FixLen = fixLen;
+            SX127x.Settings.Fsk.PayloadLen = payloadLen;
+            SX127x.Settings.Fsk.CrcOn = crcOn;
+            SX127x.Settings.Fsk.IqInverted = iqInverted;
+            SX127x.Settings.Fsk.RxContinuous = rxContinuous;
+            SX127x.Settings.Fsk.PreambleLen = preambleLen;
+            SX127x.Settings.Fsk.RxSingleTimeout = ( uint32_t )( symbTimeout * ( ( 1.0 / ( double )datarate ) * 8.0 ) * 1000 );
+
+            datarate = ( uint16_t )( ( double )XTAL_FREQ / ( double )datarate );
+            SX127xWrite( REG_BITRATEMSB, ( uint8_t )( datarate >> 8 ) );
+            SX127xWrite( REG_BITRATELSB, ( uint8_t )( datarate & 0xFF ) );
+
+            SX127xWrite( REG_RXBW, GetFskBandwidthRegValue( bandwidth ) );
+            SX127xWrite( REG_AFCBW, GetFskBandwidthRegValue( bandwidthAfc ) );
+
+            SX127xWrite( REG_PREAMBLEMSB, ( uint8_t )( ( preambleLen >> 8 ) & 0xFF ) );
+            SX127xWrite( REG_PREAMBLELSB, ( uint8_t )( preambleLen & 0xFF ) );
+
+            if( fixLen == 1 )
+            {
+                SX127xWrite( REG_PAYLOADLENGTH, payloadLen );
+            }
+            else
+            {
+                SX127xWrite( REG_PAYLOADLENGTH, RX_PAYLOAD_MAX_SIZE ); // Set payload length to the maximum
+            }
+
+            SX127xWrite( REG_PACKETCONFIG1,
+                         ( SX127xRead( REG_PACKETCONFIG1 ) &
+                           RF_PACKETCONFIG1_CRC_MASK &
+                           RF_PACKETCONFIG1_PACKETFORMAT_MASK ) |
+                           ( ( fixLen == 1 ) ? RF_PACKETCONFIG1_PACKETFORMAT_FIXED : RF_PACKETCONFIG1_PACKETFORMAT_VARIABLE ) |
+                           ( crcOn << 4 ) );
+            SX127xWrite( REG_PACKETCONFIG2, ( SX127xRead( REG_PACKETCONFIG2 ) | RF_PACKETCONFIG2_DATAMODE_PACKET ) );
+        }
+        break;
+    case MODEM_LORA:
+        {
+            bandwidth = GetLoRaBandwidthRegValue( bandwidth );
+            SX127x.Settings.LoRa.Bandwidth = bandwidth;
+            SX127x.Settings.LoRa.Datarate = datarate;
+            SX127x.Settings.LoRa.Coderate = coderate;
+            SX127x.Settings.LoRa.PreambleLen = preambleLen;
+            SX127x.Settings.LoRa.FixLen = fixLen;
+            SX127x.Settings.LoRa.PayloadLen = payloadLen;
+            SX127x.Settings.LoRa.CrcOn = crcOn;
+            SX127x.Settings.LoRa.FreqHopOn = freqHopOn;
+            SX127x.Settings.LoRa.HopPeriod = hopPeriod;
+            SX127x.Settings.LoRa.IqInverted = iqInverted;
+            SX127x.Settings.LoRa.RxContinuous = rxContinuous;
+
+            if( datarate > 12 )
+            {
+                datarate = 12;
+            }
+            else if( datarate < 6 )
+            {
+                datarate = 6;
+            }
+
+            if( ( ( bandwidth == SX127X_LORA_BW_125 ) && ( ( datarate == 11 ) || ( datarate == 12 ) ) ) ||
+                ( ( bandwidth == SX127X_LORA_BW_250 ) && ( datarate == 12 ) ) )
+            {
+                SX127x.Settings.LoRa.LowDatarateOptimize = 0x01;
+            }
+            else
+            {
+                SX127x.Settings.LoRa.LowDatarateOptimize = 0x00;
+            }
+
+            SetLoRaModemConfig( bandwidth, coderate, fixLen, crcOn, datarate,
+                                RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK,
+                                ( symbTimeout >> 8 ) & ~RFLR_MODEMCONFIG2_SYMBTIMEOUTMSB_MASK );
+
+            SX127xWrite( REG_LR_SYMBTIMEOUTLSB, ( uint8_t )( symbTimeout & 0xFF ) );
+
+            SX127xWrite( REG_LR_PREAMBLEMSB, ( uint8_t )( ( preambleLen >> 8 ) & 0xFF ) );
+            SX127xWrite( REG_LR_PREAMBLELSB, ( uint8_t )( preambleLen & 0xFF ) );
+
+            if( fixLen == 1 )
+            {
+                SX127xWrite( REG_LR_PAYLOADLENGTH, payloadLen );
+            }
+
+            if( SX127x.Settings.LoRa.FreqHopOn == true )
+            {
+                SX127xWrite( REG_LR_PLLHOP, ( SX127xRead( REG_LR_PLLHOP ) & RFLR_PLLHOP_FASTHOP_MASK ) | RFLR_PLLHOP_FASTHOP_ON );
+                SX127xWrite( REG_LR_HOPPERIOD, SX127x.Settings.LoRa.HopPeriod );
+            }
+
+            SetLoRaHighBwOptimize( bandwidth );
+
+            if( datarate == 6 )
+            {
+                SX127xWrite( REG_LR_DETECTOPTIMIZE,
+                             ( SX127xRead( REG_LR_DETECTOPTIMIZE ) &
+                               RFLR_DETECTIONOPTIMIZE_MASK ) |
+                               RFLR_DETECTIONOPTIMIZE_SF6 );
+                SX127xWrite( REG_LR_DETECTIONTHRESHOLD,
+                             RFLR_DETECTIONTHRESH_SF6 );
+            }
+            else
+            {
+                SX127xWrite( REG_LR_DETECTOPTIMIZE,
+                             ( SX127xRead( REG_LR_DETECTOPTIMIZE ) &
+                             RFLR_DETECTIONOPTIMIZE_MASK ) |
+                             RFLR_DETECTIONOPTIMIZE_SF7_TO_SF12 );
+                SX127xWrite( REG_LR_DETECTIONTHRESHOLD,
+                             RFLR_DETECTIONTHRESH_SF7_TO_SF12 );
+            }
+        }
+        break;
+    }
+
+    ShadowRegsBurstEnd( );
+}
+
+void SX127xSetTxConfig( RadioModems_t modem, int8_t power, uint32_t fdev,
+                        uint32_t bandwidth, uint32_t datarate,
+                        uint8_t coderate, uint16_t preambleLen,
+                        bool fixLen, bool crcOn, bool freqHopOn,
+                        uint8_t hopPeriod, bool iqInverted, uint32_t timeout )
+{
+    SX127xSetModem( modem );
+    EnergySetRadioTxPower( power );
+
+    // The configuration registers are sent in bursts
+    ShadowRegsBurstBegin( );
+
+    SX127xSetRfTxPower( power );
+
+    switch( modem )
+    {
+    case MODEM_FSK:
+        {
+            SX127x.Settings.Fsk.Power = power;
+            SX127x.Settings.Fsk.Fdev = fdev;
+            SX127x.Settings.Fsk.Bandwidth = bandwidth;
+            SX127x.Settings.Fsk.Datarate = datarate;
+            SX127x.Settings.Fsk.PreambleLen = preambleLen;
+            SX127x.Settings.Fsk.FixLen = fixLen;
+            SX127x.Settings.Fsk.CrcOn = crcOn;
+            SX127x.Settings.Fsk.IqInverted = iqInverted;
+            SX127x.Settings.Fsk.TxTimeout = timeout;
+
+            fdev = ( uint16_t )( ( double )fdev / ( double )FREQ_STEP );
+            SX127xWrite( REG_FDEVMSB, ( uint8_t )( fdev >> 8 ) );
+            SX127xWrite( REG_FDEVLSB, ( uint8_t )( fdev & 0xFF ) );
+
+            datarate = ( uint16_t )( ( double )XTAL_FREQ / ( double )datarate );
+            SX127xWrite( REG_BITRATEMSB, ( uint8_t )( datarate >> 8 ) );
+            SX127xWrite( REG_BITRATELSB, ( uint8_t )( datarate & 0xFF ) );
+
+            SX127xWrite( REG_PREAMBLEMSB, ( preambleLen >> 8 ) & 0x00FF );
+            SX127xWrite( REG_PREAMBLELSB, preambleLen & 0xFF );
+
+            SX127xWrite( REG_PACKETCONFIG1,
+                         ( SX127xRead( REG_PACKETCONFIG1 ) &
+                           RF_PACKETCONFIG1_CRC_MASK &
+                           RF_PACKETCONFIG1_PACKETFORMAT_MASK ) |
+                           ( ( fixLen == 1 ) ? RF_PACKETCONFIG1_PACKETFORMAT_FIXED : RF_PACKETCONFIG1_PACKETFORMAT_VARIABLE ) |
+                           ( crcOn << 4 ) );
+            SX127xWrite( REG_PACKETCONFIG2, ( SX127xRead( REG_PACKETCONFIG2 ) | RF_PACKETCONFIG2_DATAMODE_PACKET ) );
+        }
+        break;
+    case MODEM_LORA:
+        {
+            SX127x.Settings.LoRa.Power = power;
+            bandwidth = GetLoRaBandwidthRegValue( bandwidth );
+            SX127x.Settings.LoRa.Bandwidth = bandwidth;
+            SX127x.Settings.LoRa.Datarate = datarate;
+            SX127x.Settings.LoRa.Coderate = coderate;
+            SX127x.Settings.LoRa.PreambleLen = preambleLen;
+            SX127x.Settings.LoRa.FixLen = fixLen;
+            SX127x.Settings.LoRa.FreqHopOn = freqHopOn;
+            SX127x.Settings.LoRa.HopPeriod = hopPeriod;
+            SX127x.Settings.LoRa.CrcOn = crcOn;
+            SX127x.Settings.LoRa.IqInverted = iqInverted;
+            SX127x.Settings.LoRa.TxTimeout = timeout;
+
+            if( datarate > 12 )
+            {
+                datarate = 12;
+            }
+            else if( datarate < 6 )
+            {
+                datarate = 6;
+            }
+            if( ( ( bandwidth == SX127X_LORA_BW_125 ) && ( ( datarate == 11 ) || ( datarate == 12 ) ) ) ||
+                ( ( bandwidth == SX127X_LORA_BW_250 ) && ( datarate == 12 ) ) )
+            {
+                SX127x.Settings.LoRa.LowDatarateOptimize = 0x01;
+            }
+            else
+            {
+                SX127x.Settings.LoRa.LowDatarateOptimize = 0x00;
+            }
+
+            if( SX127x.Settings.LoRa.FreqHopOn == true )
+            {
+                SX127xWrite( REG_LR_PLLHOP, ( SX127xRead( REG_LR_PLLHOP ) & RFLR_PLLHOP_FASTHOP_MASK ) | RFLR_PLLHOP_FASTHOP_ON );
+                SX127xWrite( REG_LR_HOPPERIOD, SX127x.Settings.LoRa.HopPeriod );
+            }
+
+            SetLoRaModemConfig( bandwidth, coderate, fixLen, crcOn, datarate, 0xFF, 0 );
+
+            SX127xWrite( REG_LR_PREAMBLEMSB, ( preambleLen >> 8 ) & 0x00FF );
+            SX127xWrite( REG_LR_PREAMBLELSB, preambleLen & 0xFF );
+
+            if( datarate == 6 )
+            {
+                SX127xWrite( REG_LR_DETECTOPTIMIZE,
+                             ( SX127xRead( REG_LR_DETECTOPTIMIZE ) &
+                               RFLR_DETECTIONOPTIMIZE_MASK ) |
+                               RFLR_DETECTIONOPTIMIZE_SF6 );
+                SX127xWrite( REG_LR_DETECTIONTHRESHOLD,
+                             RFLR_DETECTIONTHRESH_SF6 );
+            }
+            else
+            {
+                SX127xWrite( REG_LR_DETECTOPTIMIZE,
+                             ( SX127xRead( REG_LR_DETECTOPTIMIZE ) &
+                             RFLR_DETECTIONOPTIMIZE_MASK ) |
+                             RFLR_DETECTIONOPTIMIZE_SF7_TO_SF12 );
+                SX127xWrite( REG_LR_DETECTIONTHRESHOLD,
+                             RFLR_DETECTIONTHRESH_SF7_TO_SF12 );
+            }
+        }
+        break;
+    }
+
+    ShadowRegsBurstEnd( );
+}
+
+uint32_t SX127xGetTimeOnAir( RadioModems_t modem, uint8_t pktLen )
+{
+    uint32_t airTime = 0;
+
+    switch( modem )
+    {
+    case MODEM_FSK:
+        {
+            airTime = TimeOnAirFsk( SX127x.Settings.Fsk.Datarate,
+                                    SX127x.Settings.Fsk.PreambleLen +
+                                    ( ( SX127xRead( REG_SYNCCONFIG ) & ~RF_SYNCCONFIG_SYNCSIZE_MASK ) + 1 ) +
+                                    ( ( SX127x.Settings.Fsk.FixLen == 0x01 ) ? 0 : 1 ) +
+                                    ( ( ( SX127xRead( REG_PACKETCONFIG1 ) & ~RF_PACKETCONFIG1_ADDRSFILTERING_MASK ) != 0x00 ) ? 1 : 0 ) +
+                                    pktLen +
+                                    ( ( SX127x.Settings.Fsk.CrcOn == 0x01 ) ? 2 : 0 ),
+                                    false );
+        }
+        break;
+    case MODEM_LORA:
+        {
+            // REMARK: When using LoRa modem only bandwidths 125, 250 and 500 kHz are supported
+            airTime = TimeOnAirToMs( TimeOnAirLoRa( SX127x.Settings.LoRa.Bandwidth - SX127X_LORA_BW_125,
+                                                    SX127x.Settings.LoRa.Datarate,
+                                                    SX127x.Settings.LoRa.Coderate,
+                                                    SX127x.Settings.LoRa.PreambleLen,
+                                                    SX127x.Settings.LoRa.FixLen,
+                                                    pktLen,
+                                                    SX127x.Settings.LoRa.CrcOn,
+                                                    SX127x.Settings.LoRa.LowDatarateOptimize > 0 ) );
+        }
+        break;
+    }
+    return airTime;
+}
+
+void SX127xPrepareTx( uint8_t *buffer, uint8_t size )
+{
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        {
+            // The packets streamed from the buffer are limited to its size
+            size = MIN( size, RX_PAYLOAD_MAX_SIZE );
+            SX127x.Settings.FskPacketHandler.NbBytes = 0;
+            SX127x.Settings.FskPacketHandler.Size = size;
+
+            uint8_t fifoFree = FSK_FIFO_SIZE;
+
+            if( SX127x.Settings.Fsk.FixLen == false )
+            {
+                SX127xWriteFifo( ( uint8_t* )&size, 1 );
+                fifoFree--;
+            }
+            else
+            {
+                SX127xWrite( REG_PAYLOADLENGTH, size );
+            }
+
+            if( ( size > 0 ) && ( size <= fifoFree ) )
+            {
+                SX127x.Settings.FskPacketHandler.ChunkSize = size;
+            }
+            else
+            {
+                // The remaining of the packet is streamed by the FifoEmpty
+                // interrupt in chunks of the FIFO size
+                memcpy1( RxTxBuffer, buffer, size );
+                SX127x.Settings.FskPacketHandler.ChunkSize = FSK_FIFO_SIZE;
+            }
+
+            // Write payload buffer, filling the FIFO
+            SX127xWriteFifo( buffer, MIN( size, fifoFree ) );
+            SX127x.Settings.FskPacketHandler.NbBytes += MIN( size, fifoFree );
+        }
+        break;
+    case MODEM_LORA:
+        {
+            if( SX127x.Settings.LoRa.IqInverted == true )
+            {
+                SX127xWrite( REG_LR_INVERTIQ, ( ( SX127xRead( REG_LR_INVERTIQ ) & RFLR_INVERTIQ_TX_MASK & RFLR_INVERTIQ_RX_MASK ) | RFLR_INVERTIQ_RX_OFF | RFLR_INVERTIQ_TX_ON ) );
+                SX127xWrite( REG_LR_INVERTIQ2, RFLR_INVERTIQ2_ON );
+            }
+            else
+            {
+                SX127xWrite( REG_LR_INVERTIQ, ( ( SX127xRead( REG_LR_INVERTIQ ) & RFLR_INVERTIQ_TX_MASK & RFLR_INVERTIQ_RX_MASK ) | RFLR_INVERTIQ_RX_OFF | RFLR_INVERTIQ_TX_OFF ) );
+                SX127xWrite( REG_LR_INVERTIQ2, RFLR_INVERTIQ2_OFF );
+            }
+
+            SX127x.Settings.LoRaPacketHandler.Size = size;
+
+            // Initializes the payload size
+            SX127xWrite( REG_LR_PAYLOADLENGTH, size );
+
+            // Full buffer used for Tx
+            SX127xWrite( REG_LR_FIFOTXBASEADDR, 0 );
+            SX127xWrite( REG_LR_FIFOADDRPTR, 0 );
+
+            // FIFO operations can not take place in Sleep mode
+            if( ( SX127xRead( REG_OPMODE ) & ~RF_OPMODE_MASK ) == RF_OPMODE_SLEEP )
+            {
+                SX127xSetStby( );
+                DelayMs( 1 );
+            }
+            // Write payload buffer
+            SX127xWriteFifo( buffer, size );
+        }
+        break;
+    }
+    TxPreparedBuffer = buffer;
+    TxPreparedSize = size;
+}
+
+void SX127xSend( uint8_t *buffer, uint8_t size )
+{
+    uint32_t txTimeout = 0;
+
+    if( ( TxPreparedBuffer != buffer ) || ( TxPreparedSize != size ) )
+    {
+        SX127xPrepareTx( buffer, size );
+    }
+    // The FIFO content is used by the transmission
+    TxPreparedBuffer = NULL;
+
+    if( SX127x.Settings.Modem == MODEM_FSK )
+    {
+        txTimeout = SX127x.Settings.Fsk.TxTimeout;
+    }
+    else
+    {
+        txTimeout = SX127x.Settings.LoRa.TxTimeout;
+    }
+    SX127xSetTx( txTimeout );
+}
+
+void SX127xSetSleep( void )
+{
+    TimerStop( &RxTimeoutTimer );
+    TimerStop( &TxTimeoutTimer );
+    TimerStop( &RxTimeoutSyncWord );
+    TimerStop( &CarrierSense.Timer );
+
+    SX127xSetOpMode( RF_OPMODE_SLEEP );
+
+    // Disable TCXO radio is in SLEEP mode
+    SX127xSetBoardTcxo( false );
+
+    SX127x.Settings.State = RF_IDLE;
+}
+
+void SX127xSetStby( void )
+{
+    TimerStop( &RxTimeoutTimer );
+    TimerStop( &TxTimeoutTimer );
+    TimerStop( &RxTimeoutSyncWord );
+    TimerStop( &CarrierSense.Timer );
+
+    SX127xSetOpMode( RF_OPMODE_STANDBY );
+    SX127x.Settings.State = RF_IDLE;
+}
+
+void SX127xSetRx( uint32_t timeout )
+{
+    bool rxContinuous = false;
+    TimerStop( &TxTimeoutTimer );
+
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        {
+            rxContinuous = SX127x.Settings.Fsk.RxContinuous;
+
+            // DIO0=PayloadReady
+            // DIO1=FifoLevel
+            // DIO2=SyncAddr
+            // DIO3=FifoEmpty
+            // DIO4=Preamble
+            // DIO5=ModeReady
+            SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RF_DIOMAPPING1_DIO0_MASK &
+                                                                            RF_DIOMAPPING1_DIO1_MASK &
+                                                                            RF_DIOMAPPING1_DIO2_MASK ) |
+                                                                            RF_DIOMAPPING1_DIO0_00 |
+                                                                            RF_DIOMAPPING1_DIO1_00 |
+                                                                            RF_DIOMAPPING1_DIO2_11 );
+
+            SX127xWrite( REG_DIOMAPPING2, ( SX127xRead( REG_DIOMAPPING2 ) & RF_DIOMAPPING2_DIO4_MASK &
+                                                                            RF_DIOMAPPING2_MAP_MASK ) |
+                                                                            RF_DIOMAPPING2_DIO4_11 |
+                                                                            RF_DIOMAPPING2_MAP_PREAMBLEDETECT );
+
+            SX127xWrite( REG_FIFOTHRESH, ( SX127xRead( REG_FIFOTHRESH ) & RF_FIFOTHRESH_FIFOTHRESHOLD_MASK ) | FSK_FIFO_THRESHOLD );
+            SX127x.Settings.FskPacketHandler.FifoThresh = FSK_FIFO_THRESHOLD;
+
+            SX127xWrite( REG_RXCONFIG, RF_RXCONFIG_AFCAUTO_ON | RF_RXCONFIG_AGCAUTO_ON | RF_RXCONFIG_RXTRIGER_PREAMBLEDETECT );
+
+            SX127x.Settings.FskPacketHandler.PreambleDetected = false;
+            SX127x.Settings.FskPacketHandler.SyncWordDetected = false;
+            SX127x.Settings.FskPacketHandler.NbBytes = 0;
+            SX127x.Settings.FskPacketHandler.Size = 0;
+        }
+        break;
+    case MODEM_LORA:
+        {
+            if( SX127x.Settings.LoRa.IqInverted == true )
+            {
+                SX127xWrite( REG_LR_INVERTIQ, ( ( SX127xRead( REG_LR_INVERTIQ ) & RFLR_INVERTIQ_TX_MASK & RFLR_INVERTIQ_RX_MASK ) | RFLR_INVERTIQ_RX_ON | RFLR_INVERTIQ_TX_OFF ) );
+                SX127xWrite( REG_LR_INVERTIQ2, RFLR_INVERTIQ2_ON );
+            }
+            else
+            {
+                SX127xWrite( REG_LR_INVERTIQ, ( ( SX127xRead( REG_LR_INVERTIQ ) & RFLR_INVERTIQ_TX_MASK & RFLR_INVERTIQ_RX_MASK ) | RFLR_INVERTIQ_RX_OFF | RFLR_INVERTIQ_TX_OFF ) );
+                SX127xWrite( REG_LR_INVERTIQ2, RFLR_INVERTIQ2_OFF );
+            }
+
+            SetLoRaSpuriousReceptionErrata( );
+
+            rxContinuous = SX127x.Settings.LoRa.RxContinuous;
+
+            if( SX127x.Settings.LoRa.FreqHopOn == true )
+            {
+                SX127xWrite( REG_LR_IRQFLAGSMASK, //RFLR_IRQFLAGS_RXTIMEOUT |
+                                                  //RFLR_IRQFLAGS_RXDONE |
+                                                  //RFLR_IRQFLAGS_PAYLOADCRCERROR |
+                                                  RFLR_IRQFLAGS_VALIDHEADER |
+                                                  RFLR_IRQFLAGS_TXDONE |
+                                                  RFLR_IRQFLAGS_CADDONE |
+                                                  //RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL |
+                                                  RFLR_IRQFLAGS_CADDETECTED );
+
+                // DIO0=RxDone, DIO2=FhssChangeChannel
+                FhssTableIndex = 0;
+                SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RFLR_DIOMAPPING1_DIO0_MASK & RFLR_DIOMAPPING1_DIO2_MASK  ) | RFLR_DIOMAPPING1_DIO0_00 | RFLR_DIOMAPPING1_DIO2_00 );
+            }
+            else
+            {
+                SX127xWrite( REG_LR_IRQFLAGSMASK, //RFLR_IRQFLAGS_RXTIMEOUT |
+                                                  //RFLR_IRQFLAGS_RXDONE |
+                                                  //RFLR_IRQFLAGS_PAYLOADCRCERROR |
+                                                  RFLR_IRQFLAGS_VALIDHEADER |
+                                                  RFLR_IRQFLAGS_TXDONE |
+                                                  RFLR_IRQFLAGS_CADDONE |
+                                                  RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL |
+                                                  RFLR_IRQFLAGS_CADDETECTED );
+
+                // DIO0=RxDone
+                SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RFLR_DIOMAPPING1_DIO0_MASK ) | RFLR_DIOMAPPING1_DIO0_00 );
+            }
+            SX127xWrite( REG_LR_FIFORXBASEADDR, 0 );
+            SX127xWrite( REG_LR_FIFOADDRPTR, 0 );
+        }
+        break;
+    }
+
+    memset( RxTxBuffer, 0, ( size_t )RX_BUFFER_SIZE );
+
+    SX127x.Settings.State = RF_RX_RUNNING;
+    if( timeout != 0 )
+    {
+        TimerSetValue( &RxTimeoutTimer, timeout );
+        TimerStart( &RxTimeoutTimer );
+    }
+
+    if( SX127x.Settings.Modem == MODEM_FSK )
+    {
+        SX127xSetOpMode( RF_OPMODE_RECEIVER );
+
+        TimerSetValue( &RxTimeoutSyncWord, SX127x.Settings.Fsk.RxSingleTimeout );
+        TimerStart( &RxTimeoutSyncWord );
+    }
+    else
+    {
+        if( rxContinuous == true )
+        {
+            SX127xSetOpMode( RFLR_OPMODE_RECEIVER );
+        }
+        else
+        {
+            SX127xSetOpMode( RFLR_OPMODE_RECEIVER_SINGLE );
+        }
+    }
+}
+
+void SX127xSetTx( uint32_t timeout )
+{
+    TimerStop( &RxTimeoutTimer );
+
+    TimerSetValue( &TxTimeoutTimer, timeout );
+
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        {
+            // DIO0=PacketSent
+            // DIO1=FifoEmpty
+            // DIO2=FifoFull
+            // DIO3=FifoEmpty
+            // DIO4=LowBat
+            // DIO5=ModeReady
+            SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RF_DIOMAPPING1_DIO0_MASK &
+                                                                            RF_DIOMAPPING1_DIO1_MASK &
+                                                                            RF_DIOMAPPING1_DIO2_MASK ) |
+                                                                            RF_DIOMAPPING1_DIO1_01 );
+
+            SX127xWrite( REG_DIOMAPPING2, ( SX127xRead( REG_DIOMAPPING2 ) & RF_DIOMAPPING2_DIO4_MASK &
+                                                                            RF_DIOMAPPING2_MAP_MASK ) );
+            SX127x.Settings.FskPacketHandler.FifoThresh = SX127xRead( REG_FIFOTHRESH ) & 0x3F;
+        }
+        break;
+    case MODEM_LORA:
+        {
+            if( SX127x.Settings.LoRa.FreqHopOn == true )
+            {
+                SX127xWrite( REG_LR_IRQFLAGSMASK, RFLR_IRQFLAGS_RXTIMEOUT |
+                                                  RFLR_IRQFLAGS_RXDONE |
+                                                  RFLR_IRQFLAGS_PAYLOADCRCERROR |
+                                                  RFLR_IRQFLAGS_VALIDHEADER |
+                                                  //RFLR_IRQFLAGS_TXDONE |
+                                                  RFLR_IRQFLAGS_CADDONE |
+                                                  //RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL |
+                                                  RFLR_IRQFLAGS_CADDETECTED );
+
+                // DIO0=TxDone, DIO2=FhssChangeChannel
+                FhssTableIndex = 0;
+                SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RFLR_DIOMAPPING1_DIO0_MASK & RFLR_DIOMAPPING1_DIO2_MASK ) | RFLR_DIOMAPPING1_DIO0_01 | RFLR_DIOMAPPING1_DIO2_00 );
+            }
+            else
+            {
+                SX127xWrite( REG_LR_IRQFLAGSMASK, RFLR_IRQFLAGS_RXTIMEOUT |
+                                                  RFLR_IRQFLAGS_RXDONE |
+                                                  RFLR_IRQFLAGS_PAYLOADCRCERROR |
+                                                  RFLR_IRQFLAGS_VALIDHEADER |
+                                                  //RFLR_IRQFLAGS_TXDONE |
+                                                  RFLR_IRQFLAGS_CADDONE |
+                                                  RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL |
+                                                  RFLR_IRQFLAGS_CADDETECTED );
+
+                // DIO0=TxDone
+                SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RFLR_DIOMAPPING1_DIO0_MASK ) | RFLR_DIOMAPPING1_DIO0_01 );
+            }
+        }
+        break;
+    }
+
+    SX127x.Settings.State = RF_TX_RUNNING;
+    TimerStart( &TxTimeoutTimer );
+    SX127xSetOpMode( RF_OPMODE_TRANSMITTER );
+}
+
+void SX127xStartCad( void )
+{
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        {
+
+        }
+        break;
+    case MODEM_LORA:
+        {
+            SX127xWrite( REG_LR_IRQFLAGSMASK, RFLR_IRQFLAGS_RXTIMEOUT |
+                                        RFLR_IRQFLAGS_RXDONE |
+                                        RFLR_IRQFLAGS_PAYLOADCRCERROR |
+                                        RFLR_IRQFLAGS_VALIDHEADER |
+                                        RFLR_IRQFLAGS_TXDONE |
+                                        //RFLR_IRQFLAGS_CADDONE |
+                                        RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL // |
+                                        //RFLR_IRQFLAGS_CADDETECTED
+                                        );
+
+            // DIO3=CADDone
+            SX127xWrite( REG_DIOMAPPING1, ( SX127xRead( REG_DIOMAPPING1 ) & RFLR_DIOMAPPING1_DIO3_MASK ) | RFLR_DIOMAPPING1_DIO3_00 );
+
+            SX127x.Settings.State = RF_CAD;
+            SX127xSetOpMode( RFLR_OPMODE_CAD );
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void SX127xSetTxContinuousWave( uint32_t freq, int8_t power, uint16_t time )
+{
+    uint32_t timeout = ( uint32_t )( time * 1000 );
+
+    SX127xSetChannel( freq );
+
+    SX127xSetTxConfig( MODEM_FSK, power, 0, 0, 4800, 0, 5, false, false, 0, 0, 0, timeout );
+
+    SX127xWrite( REG_PACKETCONFIG2, ( SX127xRead( REG_PACKETCONFIG2 ) & RF_PACKETCONFIG2_DATAMODE_MASK ) );
+    // Disable radio interrupts
+    SX127xWrite( REG_DIOMAPPING1, RF_DIOMAPPING1_DIO0_11 | RF_DIOMAPPING1_DIO1_11 );
+    SX127xWrite( REG_DIOMAPPING2, RF_DIOMAPPING2_DIO4_10 | RF_DIOMAPPING2_DIO5_10 );
+
+    TimerSetValue( &TxTimeoutTimer, timeout );
+
+    SX127x.Settings.State = RF_TX_RUNNING;
+    TimerStart( &TxTimeoutTimer );
+    SX127xSetOpMode( RF_OPMODE_TRANSMITTER );
+}
+
+int16_t SX127xReadRssi( RadioModems_t modem )
+{
+    int16_t rssi = 0;
+
+    switch( modem )
+    {
+    case MODEM_FSK:
+        rssi = -( SX127xRead( REG_RSSIVALUE ) >> 1 );
+        break;
+    case MODEM_LORA:
+        rssi = SX127X_RSSI_OFFSET( SX127x.Settings.Channel ) + SX127xRead( REG_LR_RSSIVALUE );
+        break;
+    default:
+        rssi = -1;
+        break;
+    }
+    return rssi;
+}
+
+int32_t SX127xGetFreqError( void )
+{
+    int32_t freqError = 0;
+
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        freqError = ( int16_t )( ( ( uint16_t )SX127xRead( REG_FEIMSB ) << 8 ) | SX127xRead( REG_FEILSB ) );
+        freqError = ( int32_t )( ( double )freqError * ( double )FREQ_STEP );
+        break;
+    case MODEM_LORA:
+        {
+            // 20 bits two's complement value
+            uint32_t fei = ( ( ( uint32_t )SX127xRead( REG_LR_FEIMSB ) & 0x0F ) << 16 ) |
+                           ( ( uint32_t )SX127xRead( REG_LR_FEIMID ) << 8 ) |
+                           ( uint32_t )SX127xRead( REG_LR_FEILSB );
+
+            if( ( fei & 0x00080000 ) != 0 )
+            {
+                fei |= 0xFFF00000;
+            }
+            // Ferr = FreqError * 2^24 / Fxtal * BW / 500 kHz
+            freqError = ( int32_t )( ( double )( int32_t )fei * ( double )( 1UL << 24 ) / ( double )XTAL_FREQ *
+                                     ( double )( 125000UL << ( SX127x.Settings.LoRa.Bandwidth - SX127X_LORA_BW_125 ) ) / 500000.0 );
+        }
+        break;
+    default:
+        break;
+    }
+    return freqError;
+}
+
+void SX127xSetOpMode( uint8_t opMode )
+{
+    if( opMode != RF_OPMODE_STANDBY )
+    {
+        // The FIFO is cleared in sleep mode and overwritten by the receptions
+        TxPreparedBuffer = NULL;
+    }
+#if defined( USE_RADIO_DEBUG )
+    switch( opMode )
+    {
+        case RF_OPMODE_TRANSMITTER:
+            SX127xDbgPinTxWrite( 1 );
+            SX127xDbgPinRxWrite( 0 );
+            break;
+        case RF_OPMODE_RECEIVER:
+        case RFLR_OPMODE_RECEIVER_SINGLE:
+            SX127xDbgPinTxWrite( 0 );
+            SX127xDbgPinRxWrite( 1 );
+            break;
+        default:
+            SX127xDbgPinTxWrite( 0 );
+            SX127xDbgPinRxWrite( 0 );
+            break;
+    }
+#endif
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+    switch( opMode )
+    {
+        case RF_OPMODE_SLEEP:
+            EnergySetRadioState( ENERGY_RADIO_SLEEP );
+            break;
+        case RF_OPMODE_STANDBY:
+            EnergySetRadioState( ENERGY_RADIO_STANDBY );
+            break;
+        case RF_OPMODE_TRANSMITTER:
+            EnergySetRadioState( ENERGY_RADIO_TX );
+            break;
+        default:
+            // Synthesizer, receiver and CAD modes
+            EnergySetRadioState( ENERGY_RADIO_RX );
+            break;
+    }
+#endif
+    if( opMode == RF_OPMODE_SLEEP )
+    {
+        SX127xSetAntSwLowPower( true );
+    }
+    else
+    {
+        // Enable TCXO if operating mode different from SLEEP.
+        SX127xSetBoardTcxo( true );
+        SX127xSetAntSwLowPower( false );
+        SX127xSetAntSw( opMode );
+    }
+    SX127xWrite( REG_OPMODE, ( SX127xRead( REG_OPMODE ) & RF_OPMODE_MASK ) | opMode );
+}
+
+void SX127xSetModem( RadioModems_t modem )
+{
+    // The packet parameters are re-configured
+    TxPreparedBuffer = NULL;
+
+    if( ( SX127xRead( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_ON ) != 0 )
+    {
+        SX127x.Settings.Modem = MODEM_LORA;
+    }
+    else
+    {
+        SX127x.Settings.Modem = MODEM_FSK;
+    }
+
+    if( SX127x.Settings.Modem == modem )
+    {
+        return;
+    }
+
+    SX127x.Settings.Modem = modem;
+    switch( SX127x.Settings.Modem )
+    {
+    default:
+    case MODEM_FSK:
+        SX127xSetOpMode( RF_OPMODE_SLEEP );
+        SX127xWrite( REG_OPMODE, ( SX127xRead( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_OFF );
+        ShadowRegsReset( MODEM_FSK );
+
+        SX127xWrite( REG_DIOMAPPING1, 0x00 );
+        SX127xWrite( REG_DIOMAPPING2, 0x30 ); // DIO5=ModeReady
+        break;
+    case MODEM_LORA:
+        SX127xSetOpMode( RF_OPMODE_SLEEP );
+        SX127xWrite( REG_OPMODE, ( SX127xRead( REG_OPMODE ) & RFLR_OPMODE_LONGRANGEMODE_MASK ) | RFLR_OPMODE_LONGRANGEMODE_ON );
+        ShadowRegsReset( MODEM_LORA );
+
+        SX127xWrite( REG_DIOMAPPING1, 0x00 );
+        SX127xWrite( REG_DIOMAPPING2, 0x00 );
+        break;
+    }
+}
+
+void SX127xWrite( uint16_t addr, uint8_t data )
+{
+    if( ShadowRegsIsShadowed( addr ) == true )
+    {
+        if( ( ( ShadowRegsValid[addr >> 5] & SHADOW_REG_BIT( addr ) ) != 0 ) && ( ShadowRegs[addr] == data ) )
+        {
+            // The register already holds this value
+            return;
+        }
+        if( ShadowRegsBurst != 0 )
+        {
+            ShadowRegs[addr] = data;
+            ShadowRegsValid[addr >> 5] |= SHADOW_REG_BIT( addr );
+            ShadowRegsDirty[addr >> 5] |= SHADOW_REG_BIT( addr );
+            return;
+        }
+    }
+    else if( ShadowRegsBurst != 0 )
+    {
+        // Keep the accesses order
+        ShadowRegsFlush( );
+    }
+    SX127xWriteBuffer( addr, &data, 1 );
+}
+
+uint8_t SX127xRead( uint16_t addr )
+{
+    uint8_t data;
+
+    if( ShadowRegsIsShadowed( addr ) == true )
+    {
+        if( ( ShadowRegsValid[addr >> 5] & SHADOW_REG_BIT( addr ) ) != 0 )
+        {
+            return ShadowRegs[addr];
+        }
+        SX127xReadBuffer( addr, &data, 1 );
+        ShadowRegs[addr] = data;
+        ShadowRegsValid[addr >> 5] |= SHADOW_REG_BIT( addr );
+        return data;
+    }
+    else if( ShadowRegsBurst != 0 )
+    {
+        // Keep the accesses order
+        ShadowRegsFlush( );
+    }
+    SX127xReadBuffer( addr, &data, 1 );
+    return data;
+}
+
+void SX127xWriteBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
+{
+    uint8_t i;
+
+    // Write-through update of the shadowed registers. The FIFO is never shadowed.
+    for( i = 0; ( addr != REG_FIFO ) && ( i < size ); i++ )
+    {
+        if( ShadowRegsIsShadowed( addr + i ) == true )
+        {
+            ShadowRegs[addr + i] = buffer[i];
+            ShadowRegsValid[( addr + i ) >> 5] |= SHADOW_REG_BIT( addr + i );
+        }
+    }
+
+    //NSS = 0;
+    GpioWrite( &SX127x.Spi.Nss, 0 );
+
+    SpiInOut( &SX127x.Spi, addr | 0x80 );
+    SpiTransfer( &SX127x.Spi, buffer, NULL, size );
+
+    //NSS = 1;
+    GpioWrite( &SX127x.Spi.Nss, 1 );
+}
+
+void SX127xReadBuffer( uint16_t addr, uint8_t *buffer, uint8_t size )
+{
+    //NSS = 0;
+    GpioWrite( &SX127x.Spi.Nss, 0 );
+
+    SpiInOut( &SX127x.Spi, addr & 0x7F );
+
+    SpiTransfer( &SX127x.Spi, NULL, buffer, size );
+
+    //NSS = 1;
+    GpioWrite( &SX127x.Spi.Nss, 1 );
+}
+
+void SX127xWriteFifo( uint8_t *buffer, uint8_t size )
+{
+    SX127xWriteBuffer( 0, buffer, size );
+}
+
+void SX127xReadFifo( uint8_t *buffer, uint8_t size )
+{
+    SX127xReadBuffer( 0, buffer, size );
+}
+
+void SX127xSetMaxPayloadLength( RadioModems_t modem, uint8_t max )
+{
+    SX127xSetModem( modem );
+
+    // The modem filters out the longer frames
+    max = MIN( max, RX_PAYLOAD_MAX_SIZE );
+
+    switch( modem )
+    {
+    case MODEM_FSK:
+        if( SX127x.Settings.Fsk.FixLen == false )
+        {
+            SX127xWrite( REG_PAYLOADLENGTH, max );
+        }
+        break;
+    case MODEM_LORA:
+        SX127xWrite( REG_LR_PAYLOADMAXLENGTH, max );
+        break;
+    }
+}
+
+void SX127xSetPublicNetwork( bool enable )
+{
+    SX127xSetModem( MODEM_LORA );
+    SX127x.Settings.LoRa.PublicNetwork = enable;
+    if( enable == true )
+    {
+        // Change LoRa modem SyncWord
+        SX127xWrite( REG_LR_SYNCWORD, LORA_MAC_PUBLIC_SYNCWORD );
+    }
+    else
+    {
+        // Change LoRa modem SyncWord
+        SX127xWrite( REG_LR_SYNCWORD, LORA_MAC_PRIVATE_SYNCWORD );
+    }
+}
+
+uint32_t SX127xGetWakeupTime( void )
+{
+    return SX127xGetBoardTcxoWakeupTime( ) + RADIO_WAKEUP_TIME;
+}
+
+static void SX127xOnCarrierSenseTimerEvent( void* context )
+{
+    bool channelFree = true;
+
+    if( SX127xReadRssi( CarrierSense.Modem ) > CarrierSense.RssiThresh )
+    {
+        channelFree = false;
+    }
+    else if( TimerGetElapsedTime( CarrierSense.StartTime ) < CarrierSense.Duration )
+    {
+        // Keep sensing, the MCU may sleep until the next sample
+        TimerStart( &CarrierSense.Timer );
+        return;
+    }
+    SX127xSetSleep( );
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->CarrierSenseDone != NULL ) )
+    {
+        RadioEvents->CarrierSenseDone( channelFree );
+    }
+}
+
+void SX127xOnTimeoutIrq( void* context )
+{
+    switch( SX127x.Settings.State )
+    {
+    case RF_RX_RUNNING:
+        if( SX127x.Settings.Modem == MODEM_FSK )
+        {
+            SX127x.Settings.FskPacketHandler.PreambleDetected = false;
+            SX127x.Settings.FskPacketHandler.SyncWordDetected = false;
+            SX127x.Settings.FskPacketHandler.NbBytes = 0;
+            SX127x.Settings.FskPacketHandler.Size = 0;
+
+            // Clear Irqs
+            SX127xWrite( REG_IRQFLAGS1, RF_IRQFLAGS1_RSSI |
+                                        RF_IRQFLAGS1_PREAMBLEDETECT |
+                                        RF_IRQFLAGS1_SYNCADDRESSMATCH );
+            SX127xWrite( REG_IRQFLAGS2, RF_IRQFLAGS2_FIFOOVERRUN );
+
+            if( SX127x.Settings.Fsk.RxContinuous == true )
+            {
+                // Continuous mode restart Rx chain
+                SX127xWrite( REG_RXCONFIG, SX127xRead( REG_RXCONFIG ) | RF_RXCONFIG_RESTARTRXWITHOUTPLLLOCK );
+                TimerStart( &RxTimeoutSyncWord );
+            }
+            else
+            {
+                SX127x.Settings.State = RF_IDLE;
+                TimerStop( &RxTimeoutSyncWord );
+            }
+        }
+        if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
+        {
+            RadioEvents->RxTimeout( );
+        }
+        break;
+    case RF_TX_RUNNING:
+        // Tx timeout shouldn't happen.
+        // Reported issue of SPI data corruption resulting in TX TIMEOUT 
+        // is NOT related to a bug in radio transceiver.
+        // It is mainly caused by improper PCB routing of SPI lines and/or
+        // violation of SPI specifications.
+        // To mitigate redesign, Semtech offers a workaround which resets
+        // the radio transceiver and putting it into a known state.
+
+        // BEGIN WORKAROUND
+
+        // Reset the radio
+        SX127xReset( );
+        ShadowRegsReset( MODEM_FSK );
+
+        // Calibrate Rx chain
+        RxChainCalibration( );
+
+        // Initialize radio default values
+        SX127xSetOpMode( RF_OPMODE_SLEEP );
+
+        for( uint8_t i = 0; i < sizeof( RadioRegsInit ) / sizeof( RadioRegisters_t ); i++ )
+        {
+            SX127xSetModem( RadioRegsInit[i].Modem );
+            SX127xWrite( RadioRegsInit[i].Addr, RadioRegsInit[i].Value );
+        }
+        SX127xSetModem( MODEM_FSK );
+
+        // Restore previous network type setting.
+        SX127xSetPublicNetwork( SX127x.Settings.LoRa.PublicNetwork );
+        // END WORKAROUND
+
+        SX127x.Settings.State = RF_IDLE;
+        if( ( RadioEvents != NULL ) && ( RadioEvents->TxTimeout != NULL ) )
+        {
+            RadioEvents->TxTimeout( );
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+RAM_FUNC void SX127xOnDio0Irq( void* context )
+{
+    volatile uint8_t irqFlags = 0;
+
+    if( ( RadioEvents != NULL ) && ( RadioEvents->IrqTimestamp != NULL ) )
+    {
+        RadioEvents->IrqTimestamp( TimerGetCurrentTime( ) );
+    }
+
+    switch( SX127x.Settings.State )
+    {
+        case RF_RX_RUNNING:
+            //TimerStop( &RxTimeoutTimer );
+            // RxDone interrupt
+            switch( SX127x.Settings.Modem )
+            {
+            case MODEM_FSK:
+                if( SX127x.Settings.Fsk.CrcOn == true )
+                {
+                    irqFlags = SX127xRead( REG_IRQFLAGS2 );
+                    if( ( irqFlags & RF_IRQFLAGS2_CRCOK ) != RF_IRQFLAGS2_CRCOK )
+                    {
+                        // Clear Irqs
+                        SX127xWrite( REG_IRQFLAGS1, RF_IRQFLAGS1_RSSI |
+                                                    RF_IRQFLAGS1_PREAMBLEDETECT |
+                                                    RF_IRQFLAGS1_SYNCADDRESSMATCH );
+                        SX127xWrite( REG_IRQFLAGS2, RF_IRQFLAGS2_FIFOOVERRUN );
+
+                        TimerStop( &RxTimeoutTimer );
+
+                        if( SX127x.Settings.Fsk.RxContinuous == false )
+                        {
+                            TimerStop( &RxTimeoutSyncWord );
+                            SX127x.Settings.State = RF_IDLE;
+                        }
+                        else
+                        {
+                            // Continuous mode restart Rx chain
+                            SX127xWrite( REG_RXCONFIG, SX127xRead( REG_RXCONFIG ) | RF_RXCONFIG_RESTARTRXWITHOUTPLLLOCK );
+                            TimerStart( &RxTimeoutSyncWord );
+                        }
+
+                        if( ( RadioEvents != NULL ) && ( RadioEvents->RxError != NULL ) )
+                        {
+                            RadioEvents->RxError( );
+                        }
+                        SX127x.Settings.FskPacketHandler.PreambleDetected = false;
+                        SX127x.Settings.FskPacketHandler.SyncWordDetected = false;
+                        SX127x.Settings.FskPacketHandler.NbBytes = 0;
+                        SX127x.Settings.FskPacketHandler.Size = 0;
+                        break;
+                    }
+                }
+
+                // Read received packet size
+                if( ( SX127x.Settings.FskPacketHandler.Size == 0 ) && ( SX127x.Settings.FskPacketHandler.NbBytes == 0 ) )
+                {
+                    if( SX127x.Settings.Fsk.FixLen == false )
+                    {
+                        SX127xReadFifo( ( uint8_t* )&SX127x.Settings.FskPacketHandler.Size, 1 );
+                    }
+                    else
+                    {
+                        SX127x.Settings.FskPacketHandler.Size = SX127xRead( REG_PAYLOADLENGTH );
+                    }
+                    // Frames longer than the reception buffer are truncated
+                    SX127x.Settings.FskPacketHandler.Size = MIN( SX127x.Settings.FskPacketHandler.Size, RX_PAYLOAD_MAX_SIZE );
+                    SX127xReadFifo( RxTxBuffer + SX127x.Settings.FskPacketHandler.NbBytes, SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                    SX127x.Settings.FskPacketHandler.NbBytes += ( SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                }
+                else
+                {
+                    SX127xReadFifo( RxTxBuffer + SX127x.Settings.FskPacketHandler.NbBytes, SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                    SX127x.Settings.FskPacketHandler.NbBytes += ( SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                }
+
+                TimerStop( &RxTimeoutTimer );
+
+                if( SX127x.Settings.Fsk.RxContinuous == false )
+                {
+                    SX127x.Settings.State = RF_IDLE;
+                    TimerStop( &RxTimeoutSyncWord );
+                }
+                else
+                {
+                    // Continuous mode restart Rx chain
+                    SX127xWrite( REG_RXCONFIG, SX127xRead( REG_RXCONFIG ) | RF_RXCONFIG_RESTARTRXWITHOUTPLLLOCK );
+                    TimerStart( &RxTimeoutSyncWord );
+                }
+
+                if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+                {
+                    RadioEvents->RxDone( RxTxBuffer, SX127x.Settings.FskPacketHandler.Size, SX127x.Settings.FskPacketHandler.RssiValue, 0 );
+                }
+                SX127x.Settings.FskPacketHandler.PreambleDetected = false;
+                SX127x.Settings.FskPacketHandler.SyncWordDetected = false;
+                SX127x.Settings.FskPacketHandler.NbBytes = 0;
+                SX127x.Settings.FskPacketHandler.Size = 0;
+                break;
+            case MODEM_LORA:
+                {
+                    // Clear Irq
+                    SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXDONE );
+
+                    irqFlags = SX127xRead( REG_LR_IRQFLAGS );
+                    if( ( irqFlags & RFLR_IRQFLAGS_PAYLOADCRCERROR_MASK ) == RFLR_IRQFLAGS_PAYLOADCRCERROR )
+                    {
+                        // Clear Irq
+                        SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_PAYLOADCRCERROR );
+
+                        if( SX127x.Settings.LoRa.RxContinuous == false )
+                        {
+                            SX127x.Settings.State = RF_IDLE;
+                            EnergySetRadioState( ENERGY_RADIO_STANDBY );
+                        }
+                        TimerStop( &RxTimeoutTimer );
+
+                        if( ( RadioEvents != NULL ) && ( RadioEvents->RxError != NULL ) )
+                        {
+                            RadioEvents->RxError( );
+                        }
+                        break;
+                    }
+
+                    // Returns SNR value [dB] rounded to the nearest integer value
+                    SX127x.Settings.LoRaPacketHandler.SnrValue = ( ( ( int8_t )SX127xRead( REG_LR_PKTSNRVALUE ) ) + 2 ) >> 2;
+
+                    int16_t rssi = SX127xRead( REG_LR_PKTRSSIVALUE );
+                    if( SX127x.Settings.LoRaPacketHandler.SnrValue < 0 )
+                    {
+                        SX127x.Settings.LoRaPacketHandler.RssiValue = SX127X_RSSI_OFFSET( SX127x.Settings.Channel ) + rssi + ( rssi >> 4 ) +
+                                                                      SX127x.Settings.LoRaPacketHandler.SnrValue;
+                    }
+                    else
+                    {
+                        SX127x.Settings.LoRaPacketHandler.RssiValue = SX127X_RSSI_OFFSET( SX127x.Settings.Channel ) + rssi + ( rssi >> 4 );
+                    }
+
+                    // Frames longer than the reception buffer are truncated
+                    SX127x.Settings.LoRaPacketHandler.Size = MIN( SX127xRead( REG_LR_RXNBBYTES ), RX_PAYLOAD_MAX_SIZE );
+                    SX127xWrite( REG_LR_FIFOADDRPTR, SX127xRead( REG_LR_FIFORXCURRENTADDR ) );
+                    SX127xReadFifo( RxTxBuffer, SX127x.Settings.LoRaPacketHandler.Size );
+
+                    if( SX127x.Settings.LoRa.RxContinuous == false )
+                    {
+                        SX127x.Settings.State = RF_IDLE;
+                        EnergySetRadioState( ENERGY_RADIO_STANDBY );
+                    }
+                    TimerStop( &RxTimeoutTimer );
+
+                    if( ( RadioEvents != NULL ) && ( RadioEvents->RxDone != NULL ) )
+                    {
+                        RadioEvents->RxDone( RxTxBuffer, SX127x.Settings.LoRaPacketHandler.Size, SX127x.Settings.LoRaPacketHandler.RssiValue, SX127x.Settings.LoRaPacketHandler.SnrValue );
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+            break;
+        case RF_TX_RUNNING:
+            TimerStop( &TxTimeoutTimer );
+            // TxDone interrupt
+            switch( SX127x.Settings.Modem )
+            {
+            case MODEM_LORA:
+                // Clear Irq
+                SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_TXDONE );
+                // Intentional fall through
+            case MODEM_FSK:
+            default:
+                SX127x.Settings.State = RF_IDLE;
+                EnergySetRadioState( ENERGY_RADIO_STANDBY );
+                if( ( RadioEvents != NULL ) && ( RadioEvents->TxDone != NULL ) )
+                {
+                    RadioEvents->TxDone( );
+                }
+                break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+RAM_FUNC void SX127xOnDio1Irq( void* context )
+{
+    switch( SX127x.Settings.State )
+    {
+        case RF_RX_RUNNING:
+            switch( SX127x.Settings.Modem )
+            {
+            case MODEM_FSK:
+                // Stop timer
+                TimerStop( &RxTimeoutSyncWord );
+
+                // FifoLevel interrupt
+                // Read received packet size
+                if( ( SX127x.Settings.FskPacketHandler.Size == 0 ) && ( SX127x.Settings.FskPacketHandler.NbBytes == 0 ) )
+                {
+                    if( SX127x.Settings.Fsk.FixLen == false )
+                    {
+                        SX127xReadFifo( ( uint8_t* )&SX127x.Settings.FskPacketHandler.Size, 1 );
+                    }
+                    else
+                    {
+                        SX127x.Settings.FskPacketHandler.Size = SX127xRead( REG_PAYLOADLENGTH );
+                    }
+                    // Frames longer than the reception buffer are truncated
+                    SX127x.Settings.FskPacketHandler.Size = MIN( SX127x.Settings.FskPacketHandler.Size, RX_PAYLOAD_MAX_SIZE );
+                }
+
+                // ERRATA 3.1 - PayloadReady Set for 31.25ns if FIFO is Empty
+                //
+                //              When FifoLevel interrupt is used to offload the
+                //              FIFO, the microcontroller should  monitor  both
+                //              PayloadReady  and FifoLevel interrupts, and
+                //              read only (FifoThreshold-1) bytes off the FIFO
+                //              when FifoLevel fires
+                //
+                //              The FIFO is drained until its level is back
+                //              under the threshold, otherwise no new FifoLevel
+                //              edge is generated when the handler was delayed
+                do
+                {
+                    if( ( SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes ) >= SX127x.Settings.FskPacketHandler.FifoThresh )
+                    {
+                        SX127xReadFifo( ( RxTxBuffer + SX127x.Settings.FskPacketHandler.NbBytes ), SX127x.Settings.FskPacketHandler.FifoThresh - 1 );
+                        SX127x.Settings.FskPacketHandler.NbBytes += SX127x.Settings.FskPacketHandler.FifoThresh - 1;
+                    }
+                    else
+                    {
+                        SX127xReadFifo( ( RxTxBuffer + SX127x.Settings.FskPacketHandler.NbBytes ), SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                        SX127x.Settings.FskPacketHandler.NbBytes += ( SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                    }
+                } while( ( SX127x.Settings.FskPacketHandler.NbBytes < SX127x.Settings.FskPacketHandler.Size ) &&
+                         ( ( SX127xRead( REG_IRQFLAGS2 ) & RF_IRQFLAGS2_FIFOLEVEL ) == RF_IRQFLAGS2_FIFOLEVEL ) );
+                break;
+            case MODEM_LORA:
+                // Sync time out
+                TimerStop( &RxTimeoutTimer );
+                // Clear Irq
+                SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_RXTIMEOUT );
+
+                SX127x.Settings.State = RF_IDLE;
+                EnergySetRadioState( ENERGY_RADIO_STANDBY );
+                if( ( RadioEvents != NULL ) && ( RadioEvents->RxTimeout != NULL ) )
+                {
+                    RadioEvents->RxTimeout( );
+                }
+                break;
+            default:
+                break;
+            }
+            break;
+        case RF_TX_RUNNING:
+            switch( SX127x.Settings.Modem )
+            {
+            case MODEM_FSK:
+                // FifoEmpty interrupt
+                if( ( SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes ) > SX127x.Settings.FskPacketHandler.ChunkSize )
+                {
+                    SX127xWriteFifo( ( RxTxBuffer + SX127x.Settings.FskPacketHandler.NbBytes ), SX127x.Settings.FskPacketHandler.ChunkSize );
+                    SX127x.Settings.FskPacketHandler.NbBytes += SX127x.Settings.FskPacketHandler.ChunkSize;
+                }
+                else
+                {
+                    // Write the last chunk of data
+                    SX127xWriteFifo( RxTxBuffer + SX127x.Settings.FskPacketHandler.NbBytes, SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes );
+                    SX127x.Settings.FskPacketHandler.NbBytes += SX127x.Settings.FskPacketHandler.Size - SX127x.Settings.FskPacketHandler.NbBytes;
+                }
+                break;
+            case MODEM_LORA:
+                break;
+            default:
+                break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void SX127xOnDio2Irq( void* context )
+{
+    switch( SX127x.Settings.State )
+    {
+        case RF_RX_RUNNING:
+            switch( SX127x.Settings.Modem )
+            {
+            case MODEM_FSK:
+                // Checks if DIO4 is connected. If it is not PreambleDetected is set to true.
+                if( SX127x.DIO4.port == NULL )
+                {
+                    SX127x.Settings.FskPacketHandler.PreambleDetected = true;
+                }
+
+                if( ( SX127x.Settings.FskPacketHandler.PreambleDetected == true ) && ( SX127x.Settings.FskPacketHandler.SyncWordDetected == false ) )
+                {
+                    TimerStop( &RxTimeoutSyncWord );
+
+                    SX127x.Settings.FskPacketHandler.SyncWordDetected = true;
+
+                    SX127x.Settings.FskPacketHandler.RssiValue = -( SX127xRead( REG_RSSIVALUE ) >> 1 );
+
+                    SX127x.Settings.FskPacketHandler.AfcValue = ( int32_t )( double )( ( ( uint16_t )SX127xRead( REG_AFCMSB ) << 8 ) |
+                                                                           ( uint16_t )SX127xRead( REG_AFCLSB ) ) *
+                                                                           ( double )FREQ_STEP;
+                    SX127x.Settings.FskPacketHandler.RxGain = ( SX127xRead( REG_LNA ) >> 5 ) & 0x07;
+                }
+                break;
+            case MODEM_LORA:
+                if( SX127x.Settings.LoRa.FreqHopOn == true )
+                {
+                    // Clear Irq
+                    SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL );
+
+                    if( FhssTable != NULL )
+                    {
+                        SX127xFhssNextChannel( );
+                    }
+                    else if( ( RadioEvents != NULL ) && ( RadioEvents->FhssChangeChannel != NULL ) )
+                    {
+                        RadioEvents->FhssChangeChannel( ( SX127xRead( REG_LR_HOPCHANNEL ) & RFLR_HOPCHANNEL_CHANNEL_MASK ) );
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+            break;
+        case RF_TX_RUNNING:
+            switch( SX127x.Settings.Modem )
+            {
+            case MODEM_FSK:
+                break;
+            case MODEM_LORA:
+                if( SX127x.Settings.LoRa.FreqHopOn == true )
+                {
+                    // Clear Irq
+                    SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_FHSSCHANGEDCHANNEL );
+
+                    if( FhssTable != NULL )
+                    {
+                        SX127xFhssNextChannel( );
+                    }
+                    else if( ( RadioEvents != NULL ) && ( RadioEvents->FhssChangeChannel != NULL ) )
+                    {
+                        RadioEvents->FhssChangeChannel( ( SX127xRead( REG_LR_HOPCHANNEL ) & RFLR_HOPCHANNEL_CHANNEL_MASK ) );
+                    }
+                }
+                break;
+            default:
+                break;
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+void SX127xOnDio3Irq( void* context )
+{
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        break;
+    case MODEM_LORA:
+        if( ( SX127xRead( REG_LR_IRQFLAGS ) & RFLR_IRQFLAGS_CADDETECTED ) == RFLR_IRQFLAGS_CADDETECTED )
+        {
+            // Clear Irq
+            SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_CADDETECTED | RFLR_IRQFLAGS_CADDONE );
+            if( ( RadioEvents != NULL ) && ( RadioEvents->CadDone != NULL ) )
+            {
+                RadioEvents->CadDone( true );
+            }
+        }
+        else
+        {
+            // Clear Irq
+            SX127xWrite( REG_LR_IRQFLAGS, RFLR_IRQFLAGS_CADDONE );
+            if( ( RadioEvents != NULL ) && ( RadioEvents->CadDone != NULL ) )
+            {
+                RadioEvents->CadDone( false );
+            }
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+void SX127xOnDio4Irq( void* context )
+{
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        {
+            if( SX127x.Settings.FskPacketHandler.PreambleDetected == false )
+            {
+                SX127x.Settings.FskPacketHandler.PreambleDetected = true;
+            }
+        }
+        break;
+    case MODEM_LORA:
+        break;
+    default:
+        break;
+    }
+}
+
+void SX127xOnDio5Irq( void* context )
+{
+    switch( SX127x.Settings.Modem )
+    {
+    case MODEM_FSK:
+        break;
+    case MODEM_LORA:
+        break;
+    default:
+        break;
+    }
+}
@@ -0,0 +1,118 @@
+/*!
+ * \file      sx127x-core.h
+ *
+ * \brief     SX1272 and SX1276 common driver chip specialization
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ */
+#ifndef __SX127X_CORE_H__
+#define __SX127X_CORE_H__
+
+/*!
+ * The SX1272 and SX1276 drivers share their implementation in sx127x-core.c.
+ * The core is not compiled on its own: it is included at the end of sx1272.c
+ * and sx1276.c which first include the chip headers and define the chip
+ * traits listed below. Each chip driver therefore remains a single translation
+ * unit where the traits are plain constants and static functions that the
+ * compiler folds at compile time, with no run time chip dispatch.
+ *
+ * Chip traits
+ *
+ *   - SX127X_CHIP_NAME                   Driver symbols prefix, e.g. SX1276
+ *   - SX127X_CHIP_SX1272 or SX127X_CHIP_SX1276
+ *                                        Selects the register map differences
+ *                                        of the configuration registers shadow
+ *   - SX127X_LORA_BW_125, SX127X_LORA_BW_250, SX127X_LORA_BW_500
+ *                                        LoRa bandwidth register values
+ *   - SX127X_RSSI_OFFSET( channel )      LoRa RSSI offset [dBm] at the channel
+ *   - GetLoRaBandwidthRegValue           Converts a LoRa bandwidth [0: 125 kHz,
+ *                                        1: 250 kHz, 2: 500 kHz] to its
+ *                                        register value
+ *   - SetLoRaModemConfig                 Writes the LoRa modem configuration
+ *                                        registers
+ *   - SetLoRaHighBwOptimize              Applies the 500 kHz bandwidth
+ *                                        sensitivity optimization
+ *   - SetLoRaSpuriousReceptionErrata     Applies the spurious reception
+ *                                        workaround before a LoRa reception
+ *   - RxChainCalibration                 Performs the Rx chain calibration
+ *
+ * The core is written with SX127x prefixed names which this header maps to the
+ * chip names, e.g. SX127xInit becomes SX1276Init.
+ */
+#if !defined( SX127X_CHIP_NAME )
+#error "SX127X_CHIP_NAME must be defined by the chip driver before including the SX127x core."
+#endif
+
+#define SX127X_SYMBOL_CONCAT( chip, name ) chip##name
+#define SX127X_SYMBOL_XCONCAT( chip, name ) SX127X_SYMBOL_CONCAT( chip, name )
+
+/*!
+ * \brief Prepends the chip name to the given symbol name
+ */
+#define SX127X_SYMBOL( name ) SX127X_SYMBOL_XCONCAT( SX127X_CHIP_NAME, name )
+
+#define SX127x                                   SX127X_SYMBOL( )
+#define SX127xDbgPinRxWrite                      SX127X_SYMBOL( DbgPinRxWrite )
+#define SX127xDbgPinTxWrite                      SX127X_SYMBOL( DbgPinTxWrite )
+#define SX127xFhssComputeChannel                 SX127X_SYMBOL( FhssComputeChannel )
+#define SX127xFhssNextChannel                    SX127X_SYMBOL( FhssNextChannel )
+#define SX127xGetBoardTcxoWakeupTime             SX127X_SYMBOL( GetBoardTcxoWakeupTime )
+#define SX127xGetFreqError                       SX127X_SYMBOL( GetFreqError )
+#define SX127xGetStatus                          SX127X_SYMBOL( GetStatus )
+#define SX127xGetTimeOnAir                       SX127X_SYMBOL( GetTimeOnAir )
+#define SX127xGetWakeupTime                      SX127X_SYMBOL( GetWakeupTime )
+#define SX127xInit                               SX127X_SYMBOL( Init )
+#define SX127xIoIrqInit                          SX127X_SYMBOL( IoIrqInit )
+#define SX127xIsChannelFree                      SX127X_SYMBOL( IsChannelFree )
+#define SX127xOnCarrierSenseTimerEvent           SX127X_SYMBOL( OnCarrierSenseTimerEvent )
+#define SX127xOnDio0Irq                          SX127X_SYMBOL( OnDio0Irq )
+#define SX127xOnDio1Irq                          SX127X_SYMBOL( OnDio1Irq )
+#define SX127xOnDio2Irq                          SX127X_SYMBOL( OnDio2Irq )
+#define SX127xOnDio3Irq                          SX127X_SYMBOL( OnDio3Irq )
+#define SX127xOnDio4Irq                          SX127X_SYMBOL( OnDio4Irq )
+#define SX127xOnDio5Irq                          SX127X_SYMBOL( OnDio5Irq )
+#define SX127xOnTimeoutIrq                       SX127X_SYMBOL( OnTimeoutIrq )
+#define SX127xPrepareTx                          SX127X_SYMBOL( PrepareTx )
+#define SX127xRandom                             SX127X_SYMBOL( Random )
+#define SX127xRead                               SX127X_SYMBOL( Read )
+#define SX127xReadBuffer                         SX127X_SYMBOL( ReadBuffer )
+#define SX127xReadFifo                           SX127X_SYMBOL( ReadFifo )
+#define SX127xReadRssi                           SX127X_SYMBOL( ReadRssi )
+#define SX127xReset                              SX127X_SYMBOL( Reset )
+#define SX127xSend                               SX127X_SYMBOL( Send )
+#define SX127xSetAntSw                           SX127X_SYMBOL( SetAntSw )
+#define SX127xSetAntSwLowPower                   SX127X_SYMBOL( SetAntSwLowPower )
+#define SX127xSetBoardTcxo                       SX127X_SYMBOL( SetBoardTcxo )
+#define SX127xSetChannel                         SX127X_SYMBOL( SetChannel )
+#define SX127xSetFhssTable                       SX127X_SYMBOL( SetFhssTable )
+#define SX127xSetMaxPayloadLength                SX127X_SYMBOL( SetMaxPayloadLength )
+#define SX127xSetModem                           SX127X_SYMBOL( SetModem )
+#define SX127xSetOpMode                          SX127X_SYMBOL( SetOpMode )
+#define SX127xSetPublicNetwork                   SX127X_SYMBOL( SetPublicNetwork )
+#define SX127xSetRfTxPower                       SX127X_SYMBOL( SetRfTxPower )
+#define SX127xSetRx                              SX127X_SYMBOL( SetRx )
+#define SX127xSetRxConfig                        SX127X_SYMBOL( SetRxConfig )
+#define SX127xSetSleep                           SX127X_SYMBOL( SetSleep )
+#define SX127xSetStby                            SX127X_SYMBOL( SetStby )
+#define SX127xSetTx                              SX127X_SYMBOL( SetTx )
+#define SX127xSetTxConfig                        SX127X_SYMBOL( SetTxConfig )
+#define SX127xSetTxContinuousWave                SX127X_SYMBOL( SetTxContinuousWave )
+#define SX127xStartCad                           SX127X_SYMBOL( StartCad )
+#define SX127xStartCarrierSense                  SX127X_SYMBOL( StartCarrierSense )
+#define SX127xWrite                              SX127X_SYMBOL( Write )
+#define SX127xWriteBuffer                        SX127X_SYMBOL( WriteBuffer )
+#define SX127xWriteFifo                          SX127X_SYMBOL( WriteFifo )
+#define SX127x_t                                 SX127X_SYMBOL( _t )
+
+#endif // __SX127X_CORE_H__
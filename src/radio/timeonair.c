@@ -0,0 +1,83 @@
+/*!
+ * \file      timeonair.c
+ *
+ * \brief     Radio packets time on air computation, shared by the radio drivers
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include "timeonair.h"
+
+/*
+ * Reference values, LoRaWAN uplink settings (preamble 8 symbols, explicit
+ * header, CRC on, coding rate 4/5, low datarate optimization for SF11 and
+ * SF12 at 125 kHz). Identical to the former floating point computation.
+ *
+ * | SF | BW [kHz] | 1 byte [ms] | 13 bytes [ms] | 51 bytes [ms] | 222 bytes [ms] |
+ * |----|----------|-------------|---------------|---------------|----------------|
+ * | 12 |      125 |         828 |          1156 |          2466 |           8037 |
+ * | 11 |      125 |         414 |           578 |          1315 |           4428 |
+ * | 10 |      125 |         207 |           289 |           617 |           2010 |
+ * |  9 |      125 |         104 |           165 |           329 |           1107 |
+ * |  8 |      125 |          52 |            83 |           185 |            615 |
+ * |  7 |      125 |          26 |            47 |           103 |            349 |
+ * |  7 |      250 |          13 |            24 |            52 |            175 |
+ * | 12 |      500 |         207 |           289 |           535 |           1682 |
+ * | 11 |      500 |         104 |           145 |           288 |            923 |
+ * | 10 |      500 |          52 |            73 |           155 |            503 |
+ * |  9 |      500 |          26 |            42 |            83 |            277 |
+ * |  8 |      500 |          13 |            21 |            47 |            154 |
+ * |  7 |      500 |           7 |            12 |            26 |             88 |
+ */
+
+/*!
+ * Number of LoRa preamble quarter symbols added by the modem (4.25 symbols)
+ */
+#define LORA_PREAMBLE_EXTRA_QUARTER_SYMBOLS         17
+
+uint32_t TimeOnAirLoRa( uint8_t bandwidth, uint8_t datarate, uint8_t coderate,
+                        uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                        bool crcOn, bool lowDatarateOptimize )
+{
+    int32_t payloadBits = ( 8 * ( int32_t )payloadLen ) - ( 4 * ( int32_t )datarate ) + 28 +
+                          ( ( crcOn == true ) ? 16 : 0 ) - ( ( fixLen == true ) ? 20 : 0 );
+    uint32_t bitsPerBlock = 4 * ( datarate - ( ( lowDatarateOptimize == true ) ? 2 : 0 ) );
+    uint32_t nPayload = 8;
+
+    if( payloadBits > 0 )
+    {
+        nPayload += ( ( ( uint32_t )payloadBits + bitsPerBlock - 1 ) / bitsPerBlock ) * ( coderate + 4 );
+    }
+
+    // A 125 kHz quarter symbol lasts 2^( SF + 1 ) us, halved for each bandwidth step
+    uint32_t quarterSymbols = ( 4 * ( uint32_t )preambleLen ) + LORA_PREAMBLE_EXTRA_QUARTER_SYMBOLS + ( 4 * nPayload );
+    return ( quarterSymbols << ( datarate + 1 ) ) >> bandwidth;
+}
+
+uint32_t TimeOnAirFsk( uint32_t datarate, uint32_t nBytes, bool roundHalfEven )
+{
+    uint32_t airTime = ( 8000 * nBytes ) / datarate;
+    uint32_t remainder2 = 2 * ( ( 8000 * nBytes ) % datarate );
+
+    if( ( remainder2 > datarate ) ||
+        ( ( remainder2 == datarate ) && ( ( roundHalfEven == false ) || ( ( airTime & 0x01 ) != 0 ) ) ) )
+    {
+        airTime++;
+    }
+    return airTime;
+}
+
+uint32_t TimeOnAirToMs( uint32_t airTimeUs )
+{
+    return ( airTimeUs + 999 ) / 1000;
+}
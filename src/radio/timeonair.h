@@ -0,0 +1,77 @@
+/*!
+ * \file      timeonair.h
+ *
+ * \brief     Radio packets time on air computation, shared by the radio drivers
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __TIMEONAIR_H__
+#define __TIMEONAIR_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*!
+ * \brief Computes the LoRa packet time on air
+ *
+ * \remark Integer only. For 125, 250 and 500 kHz bandwidths the symbol time
+ *         is an exact number of microseconds and so is the result.
+ *
+ * \param [IN] bandwidth           Bandwidth [0: 125 kHz, 1: 250 kHz, 2: 500 kHz]
+ * \param [IN] datarate            Spreading factor [5..12]
+ * \param [IN] coderate            Coding rate [1: 4/5, 2: 4/6, 3: 4/7, 4: 4/8]
+ * \param [IN] preambleLen         Preamble length in symbols
+ * \param [IN] fixLen              Implicit header mode
+ * \param [IN] payloadLen          Payload length in bytes
+ * \param [IN] crcOn               Payload CRC enabled
+ * \param [IN] lowDatarateOptimize Low datarate optimization enabled
+ *
+ * \retval airTime Time on air [us]
+ */
+uint32_t TimeOnAirLoRa( uint8_t bandwidth, uint8_t datarate, uint8_t coderate,
+                        uint16_t preambleLen, bool fixLen, uint8_t payloadLen,
+                        bool crcOn, bool lowDatarateOptimize );
+
+/*!
+ * \brief Computes the FSK packet time on air
+ *
+ * \param [IN] datarate       Bit rate [bps]
+ * \param [IN] nBytes         Number of bytes sent over the air, preamble,
+ *                            sync word, length, address and CRC included
+ * \param [IN] roundHalfEven  Rounds halfway cases to the even millisecond
+ *                            instead of away from zero
+ *
+ * \retval airTime Time on air rounded to the nearest millisecond [ms]
+ */
+uint32_t TimeOnAirFsk( uint32_t datarate, uint32_t nBytes, bool roundHalfEven );
+
+/*!
+ * \brief Converts a time on air to milliseconds, rounding up
+ *
+ * \param [IN] airTimeUs      Time on air [us]
+ *
+ * \retval airTime Time on air [ms]
+ */
+uint32_t TimeOnAirToMs( uint32_t airTimeUs );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TIMEONAIR_H__
@@ -21,6 +21,8 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdbool.h>
+#include <stddef.h>
+#include "utilities.h"
 #include "adc-board.h"
 
 /*!
@@ -55,3 +57,13 @@ uint16_t AdcReadChannel( Adc_t *obj, uint32_t channel )
         return 0;
     }
 }
+
+uint8_t AdcReadChannels( Adc_t *obj, const uint32_t *channels, uint16_t *values, uint8_t nbChannels, bool oversampling )
+{
+    if( ( AdcInitialized == false ) || ( channels == NULL ) || ( values == NULL ) ||
+        ( nbChannels == 0 ) || ( nbChannels > ADC_MAX_SCAN_CHANNELS ) )
+    {
+        return FAIL;
+    }
+    return AdcMcuReadChannels( obj, channels, values, nbChannels, oversampling );
+}
@@ -29,8 +29,14 @@ extern "C"
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "gpio.h"
 
+/*!
+ * Maximum number of channels converted by a single AdcReadChannels call
+ */
+#define ADC_MAX_SCAN_CHANNELS                       4
+
 /*!
  * ADC object type definition
  */
@@ -63,6 +69,22 @@ void AdcDeInit( Adc_t *obj );
  */
 uint16_t AdcReadChannel( Adc_t *obj, uint32_t channel );
 
+/*!
+ * \brief Reads several channels within a single conversion sequence
+ *
+ * \remark The channels must be distinct. When the MCU supports it the
+ *         oversampling averages 16 conversions per channel in hardware,
+ *         the result keeping the 12 bits scale.
+ *
+ * \param [IN]  obj          ADC object
+ * \param [IN]  channels     ADC channels to be converted
+ * \param [OUT] values       Channels values, given in the channels order
+ * \param [IN]  nbChannels   Number of channels [1..ADC_MAX_SCAN_CHANNELS]
+ * \param [IN]  oversampling Enables the hardware oversampling
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t AdcReadChannels( Adc_t *obj, const uint32_t *channels, uint16_t *values, uint8_t nbChannels, bool oversampling );
+
 #ifdef __cplusplus
 }
 #endif
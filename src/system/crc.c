@@ -0,0 +1,176 @@
+/*!
+ * \file      crc.c
+ *
+ * \brief     CRC-CCITT and CRC32 computation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#include <stddef.h>
+#include <stdint.h>
+#include "crc.h"
+
+#if defined( CRC_HW_ENABLED )
+
+#include "crc-board.h"
+
+uint16_t CrcCcittUpdate( uint16_t crc, const uint8_t *buffer, uint32_t size )
+{
+    return CrcMcuCcittUpdate( crc, buffer, size );
+}
+
+uint32_t Crc32Update( uint32_t crc, const uint8_t *buffer, uint32_t size )
+{
+    return CrcMcu32Update( crc, buffer, size );
+}
+
+#else
+
+/*!
+ * CRC-CCITT ( polynomial 0x1021 ) lookup table, one entry per nibble value
+ */
+static const uint16_t CrcCcittNibbleTable[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+
+/*!
+ * CRC32 ( IEEE 802.3, reflected polynomial 0xEDB88320 ) lookup table, one
+ * entry per nibble value
+ */
+static const uint32_t Crc32NibbleTable[16] =
+{
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC,
+    0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C,
+    0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint16_t CrcCcittUpdate( uint16_t crc, const uint8_t *buffer, uint32_t size )
+{
+    for( uint32_t i = 0; i < size; i++ )
+    {
+        // Most significant nibble first
+        crc = ( crc << 4 ) ^ CrcCcittNibbleTable[( crc >> 12 ) ^ ( buffer[i] >> 4 )];
+        crc = ( crc << 4 ) ^ CrcCcittNibbleTable[( crc >> 12 ) ^ ( buffer[i] & 0x0F )];
+    }
+    return crc;
+}
+
+uint32_t Crc32Update( uint32_t crc, const uint8_t *buffer, uint32_t size )
+{
+    for( uint32_t i = 0; i < size; i++ )
+    {
+        // Least significant nibble first
+        crc ^= buffer[i];
+        crc = ( crc >> 4 ) ^ Crc32NibbleTable[crc & 0x0F];
+        crc = ( crc >> 4 ) ^ Crc32NibbleTable[crc & 0x0F];
+    }
+    return crc;
+}
+
+#endif
+
+uint16_t CrcCcittCompute( const uint8_t *buffer, uint32_t size )
+{
+    if( buffer == NULL )
+    {
+        return 0;
+    }
+    return CrcCcittUpdate( 0x0000, buffer, size );
+}
+
+uint32_t Crc32Compute( const uint8_t *buffer, uint32_t size )
+{
+    if( buffer == NULL )
+    {
+        return 0;
+    }
+    return Crc32Update( 0xFFFFFFFF, buffer, size ) ^ 0xFFFFFFFF;
+}
+
+/*!
+ * \brief Multiplies a GF(2) 32x32 matrix by a vector
+ */
+static uint32_t Crc32MatrixTimes( const uint32_t *matrix, uint32_t vector )
+{
+    uint32_t sum = 0;
+
+    while( vector != 0 )
+    {
+        if( ( vector & 0x01 ) != 0 )
+        {
+            sum ^= *matrix;
+        }
+        vector >>= 1;
+        matrix++;
+    }
+    return sum;
+}
+
+/*!
+ * \brief Squares a GF(2) 32x32 matrix
+ */
+static void Crc32MatrixSquare( uint32_t *square, const uint32_t *matrix )
+{
+    for( uint8_t i = 0; i < 32; i++ )
+    {
+        square[i] = Crc32MatrixTimes( matrix, matrix[i] );
+    }
+}
+
+uint32_t Crc32ShiftZeros( uint32_t crc, uint32_t size )
+{
+    uint32_t even[32];
+    uint32_t odd[32];
+    uint32_t row = 1;
+
+    if( size == 0 )
+    {
+        return crc;
+    }
+
+    // Operator of one zero bit, then of 2 and 4 zero bits
+    odd[0] = 0xEDB88320;
+    for( uint8_t i = 1; i < 32; i++ )
+    {
+        odd[i] = row;
+        row <<= 1;
+    }
+    Crc32MatrixSquare( even, odd );
+    Crc32MatrixSquare( odd, even );
+
+    // Applies the operators of 1, 2, 4, ... zero bytes matching the size bits
+    do
+    {
+        Crc32MatrixSquare( even, odd );
+        if( ( size & 0x01 ) != 0 )
+        {
+            crc = Crc32MatrixTimes( even, crc );
+        }
+        size >>= 1;
+        if( size == 0 )
+        {
+            break;
+        }
+        Crc32MatrixSquare( odd, even );
+        if( ( size & 0x01 ) != 0 )
+        {
+            crc = Crc32MatrixTimes( odd, crc );
+        }
+        size >>= 1;
+    }while( size != 0 );
+
+    return crc;
+}
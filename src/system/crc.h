@@ -0,0 +1,89 @@
+/*!
+ * \file      crc.h
+ *
+ * \brief     CRC-CCITT and CRC32 computation
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2019 Semtech
+ *
+ * \endcode
+ */
+#ifndef __CRC_H__
+#define __CRC_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * \brief Updates a CRC-CCITT ( polynomial 0x1021, no bit reversal ) with the
+ *        given data
+ *
+ * \param [IN] crc    Current CRC value or initial value
+ * \param [IN] buffer Data buffer
+ * \param [IN] size   Data buffer size
+ * \retval crc        Updated CRC value
+ */
+uint16_t CrcCcittUpdate( uint16_t crc, const uint8_t *buffer, uint32_t size );
+
+/*!
+ * \brief Computes the CRC-CCITT of the given data with a 0x0000 initial value,
+ *        as used by the LoRaWAN Class B beacons
+ *
+ * \param [IN] buffer Data buffer
+ * \param [IN] size   Data buffer size
+ * \retval crc        Computed CRC. 0 when buffer is NULL
+ */
+uint16_t CrcCcittCompute( const uint8_t *buffer, uint32_t size );
+
+/*!
+ * \brief Updates a CRC32 ( IEEE 802.3, reflected polynomial 0xEDB88320 ) with
+ *        the given data. No final complement is applied.
+ *
+ * \param [IN] crc    Current CRC value or initial value
+ * \param [IN] buffer Data buffer
+ * \param [IN] size   Data buffer size
+ * \retval crc        Updated CRC value
+ */
+uint32_t Crc32Update( uint32_t crc, const uint8_t *buffer, uint32_t size );
+
+/*!
+ * \brief Computes the IEEE 802.3 CRC32 of the given data ( 0xFFFFFFFF initial
+ *        value and final complement )
+ *
+ * \param [IN] buffer Data buffer
+ * \param [IN] size   Data buffer size
+ * \retval crc        Computed CRC. 0 when buffer is NULL
+ */
+uint32_t Crc32Compute( const uint8_t *buffer, uint32_t size );
+
+/*!
+ * \brief Updates a CRC32 ( no final complement ) with size zero bytes in
+ *        O( log( size ) ) operations
+ *
+ * \remark The CRC is linear: the CRC of a message with a block changed is the
+ *         CRC of the block alone, shifted by the bytes following it, added to
+ *         the previous CRC. This allows hashing data out of order.
+ *
+ * \param [IN] crc  Current CRC value
+ * \param [IN] size Number of zero bytes
+ * \retval crc      Updated CRC value, same as Crc32Update over size zeros
+ */
+uint32_t Crc32ShiftZeros( uint32_t crc, uint32_t size );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __CRC_H__
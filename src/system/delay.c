@@ -20,9 +20,41 @@
  *
  * \author    Gregory Cristian ( Semtech )
  */
+#include <stdbool.h>
+#include "utilities.h"
+#include "board.h"
+#include "timer.h"
 #include "delay-board.h"
 #include "delay.h"
 
+#if defined( DELAY_LOW_POWER_ENABLED )
+/*!
+ * Shortest delay spent in the low power modes. The shorter delays busy wait
+ * as the low power modes entry and exit would take most of them.
+ */
+#ifndef DELAY_LOW_POWER_THRESHOLD_MS
+#define DELAY_LOW_POWER_THRESHOLD_MS                5
+#endif
+
+/*!
+ * Timer ending the low power delays
+ */
+static TimerEvent_t DelayTimer;
+
+/*!
+ * Flag set by the timer at the end of the delay
+ */
+static volatile bool DelayElapsed = false;
+
+/*!
+ * \brief Function executed on the delay timer event
+ */
+static void OnDelayTimerEvent( void* context )
+{
+    DelayElapsed = true;
+}
+#endif
+
 void Delay( float s )
 {
     DelayMs( s * 1000.0f );
@@ -30,5 +62,27 @@ void Delay( float s )
 
 void DelayMs( uint32_t ms )
 {
+#if defined( DELAY_LOW_POWER_ENABLED )
+    if( ( ms >= DELAY_LOW_POWER_THRESHOLD_MS ) && ( DelayMcuIsSleepAllowed( ) == true ) )
+    {
+        DelayElapsed = false;
+        TimerInit( &DelayTimer, OnDelayTimerEvent );
+        TimerSetValue( &DelayTimer, ms );
+        TimerStart( &DelayTimer );
+
+        // The other interrupts wake up the MCU too, sleep again until the
+        // delay timer event
+        while( DelayElapsed == false )
+        {
+            CRITICAL_SECTION_BEGIN( );
+            if( DelayElapsed == false )
+            {
+                BoardLowPowerHandler( );
+            }
+            CRITICAL_SECTION_END( );
+        }
+        return;
+    }
+#endif
     DelayMsMcu( ms );
 }
@@ -20,9 +20,61 @@
  *
  * \author    Gregory Cristian ( Semtech )
  */
+#include <stdbool.h>
+#include "utilities.h"
 #include "eeprom-board.h"
 #include "eeprom.h"
 
+/*!
+ * Number of write operations handed to the EEPROM driver
+ */
+static uint32_t EepromWriteCount = 0;
+
+#if defined( EEPROM_CACHE_ENABLED )
+
+/*!
+ * Size of the EEPROM region, starting at address 0, mirrored in RAM
+ */
+#ifndef EEPROM_CACHE_SIZE
+#define EEPROM_CACHE_SIZE                           2048
+#endif
+
+/*!
+ * Dirty tracking granularity. Matches the data EEPROM word size.
+ */
+#define EEPROM_CACHE_WORD_SIZE                      4
+
+#define EEPROM_CACHE_WORD_CNT                       ( ( EEPROM_CACHE_SIZE + EEPROM_CACHE_WORD_SIZE - 1 ) / EEPROM_CACHE_WORD_SIZE )
+
+/*!
+ * RAM mirror of the EEPROM region
+ */
+static uint8_t EepromCache[EEPROM_CACHE_SIZE];
+
+/*!
+ * One bit per word of the mirror which has not been written back yet
+ */
+static uint32_t EepromCacheDirty[( EEPROM_CACHE_WORD_CNT + 31 ) / 32];
+
+static bool EepromCacheIsLoaded = false;
+
+static void EepromCacheLoad( void )
+{
+    if( EepromCacheIsLoaded == false )
+    {
+        EepromMcuReadBuffer( 0, EepromCache, EEPROM_CACHE_SIZE );
+        memset1( ( uint8_t* )EepromCacheDirty, 0, sizeof( EepromCacheDirty ) );
+        EepromCacheIsLoaded = true;
+    }
+}
+
+static bool EepromCacheIsDirty( uint16_t word )
+{
+    return ( EepromCacheDirty[word >> 5] & ( 1UL << ( word & 0x1F ) ) ) != 0;
+}
+
+#endif
+
 uint8_t EepromWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
 {
     // Boundary check
@@ -30,6 +82,27 @@ uint8_t EepromWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
     {
         return 0;
     }
+#if defined( EEPROM_CACHE_ENABLED )
+    if( addr < EEPROM_CACHE_SIZE )
+    {
+        uint16_t cached = ( size > ( EEPROM_CACHE_SIZE - addr ) ) ? ( EEPROM_CACHE_SIZE - addr ) : size;
+
+        EepromCacheLoad( );
+        memcpy1( EepromCache + addr, buffer, cached );
+        for( uint16_t word = addr / EEPROM_CACHE_WORD_SIZE; word <= ( ( addr + cached - 1 ) / EEPROM_CACHE_WORD_SIZE ); word++ )
+        {
+            EepromCacheDirty[word >> 5] |= 1UL << ( word & 0x1F );
+        }
+        if( cached == size )
+        {
+            return SUCCESS;
+        }
+        addr += cached;
+        buffer += cached;
+        size -= cached;
+    }
+#endif
+    EepromWriteCount++;
     return EepromMcuWriteBuffer( addr, buffer, size );
 }
 
@@ -40,9 +113,80 @@ uint8_t EepromReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size )
     {
         return 0;
     }
+#if defined( EEPROM_CACHE_ENABLED )
+    if( addr < EEPROM_CACHE_SIZE )
+    {
+        uint16_t cached = ( size > ( EEPROM_CACHE_SIZE - addr ) ) ? ( EEPROM_CACHE_SIZE - addr ) : size;
+
+        EepromCacheLoad( );
+        memcpy1( buffer, EepromCache + addr, cached );
+        if( cached == size )
+        {
+            return SUCCESS;
+        }
+        addr += cached;
+        buffer += cached;
+        size -= cached;
+    }
+#endif
     return EepromMcuReadBuffer( addr, buffer, size );
 }
 
+uint8_t EepromFlush( void )
+{
+#if defined( EEPROM_CACHE_ENABLED )
+    uint8_t status = SUCCESS;
+    uint16_t word = 0;
+    uint16_t start = 0;
+    uint16_t end = 0;
+
+    if( EepromCacheIsLoaded == false )
+    {
+        return SUCCESS;
+    }
+
+    while( word < EEPROM_CACHE_WORD_CNT )
+    {
+        if( EepromCacheIsDirty( word ) == false )
+        {
+            word++;
+            continue;
+        }
+        // Write back the whole run of dirty words at once
+        start = word;
+        while( ( word < EEPROM_CACHE_WORD_CNT ) && ( EepromCacheIsDirty( word ) == true ) )
+        {
+            EepromCacheDirty[word >> 5] &= ~( 1UL << ( word & 0x1F ) );
+            word++;
+        }
+        end = word * EEPROM_CACHE_WORD_SIZE;
+        if( end > EEPROM_CACHE_SIZE )
+        {
+            end = EEPROM_CACHE_SIZE;
+        }
+        EepromWriteCount++;
+        if( EepromMcuWriteBuffer( start * EEPROM_CACHE_WORD_SIZE, EepromCache + start * EEPROM_CACHE_WORD_SIZE,
+                                  end - start * EEPROM_CACHE_WORD_SIZE ) != SUCCESS )
+        {
+            status = FAIL;
+        }
+    }
+    return status;
+#else
+    return SUCCESS;
+#endif
+}
+
+void EepromSetEraseAllowed( bool allowed )
+{
+    EepromMcuSetEraseAllowed( allowed );
+}
+
+bool EepromIsWritePending( void )
+{
+    return EepromMcuIsWritePending( );
+}
+
 void EepromSetDeviceAddr( uint8_t addr )
 {
     EepromMcuSetDeviceAddr( addr );
@@ -52,3 +196,8 @@ uint8_t EepromGetDeviceAddr( void )
 {
     return EepromMcuGetDeviceAddr( );
 }
+
+uint32_t EepromGetWriteCount( void )
+{
+    return EepromWriteCount;
+}
@@ -29,6 +29,7 @@ extern "C"
 #endif
 
 #include <stdint.h>
+#include <stdbool.h>
 
 /*!
  * Writes the given buffer to the EEPROM at the specified address.
@@ -50,6 +51,33 @@ uint8_t EepromWriteBuffer( uint16_t addr, uint8_t *buffer, uint16_t size );
  */
 uint8_t EepromReadBuffer( uint16_t addr, uint8_t *buffer, uint16_t size );
 
+/*!
+ * Writes back the changes held by the RAM mirror of the EEPROM.
+ *
+ * \remark Only relevant when EEPROM_CACHE_ENABLED is defined. The writes are
+ *         otherwise directly performed by EepromWriteBuffer.
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t EepromFlush( void );
+
+/*!
+ * Allows or vetoes the start of the erase operations required by the driver.
+ *
+ * \remark To be vetoed while time critical operations, such as the reception
+ *         windows, are pending.
+ *
+ * \param[IN] allowed true if the erase operations are allowed
+ */
+void EepromSetEraseAllowed( bool allowed );
+
+/*!
+ * Indicates if some write operations are still pending.
+ *
+ * \retval isPending true if the written data is not yet programmed
+ */
+bool EepromIsWritePending( void );
+
 /*!
  * Sets the device address.
  *
@@ -68,6 +96,14 @@ void EepromSetDeviceAddr( uint8_t addr );
  */
 uint8_t EepromGetDeviceAddr( void );
 
+/*!
+ * Gets the number of write operations handed to the EEPROM driver since
+ * power up. The writes kept in the RAM mirror are only counted once flushed.
+ *
+ * \retval count Number of write operations
+ */
+uint32_t EepromGetWriteCount( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,258 @@
+/*!
+ * \file      energy.c
+ *
+ * \brief     Energy accounting per subsystem state
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stddef.h>
+#include "utilities.h"
+#include "board-config.h"
+#include "rtc-board.h"
+#include "energy.h"
+
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+
+/*!
+ * Default MCU currents [uA]. Low power STM32L0 figures.
+ */
+#ifndef ENERGY_MCU_CURRENTS
+#define ENERGY_MCU_CURRENTS                         { 5000, 1500, 2, 1 }
+#endif
+
+/*!
+ * Default radio sleep, standby and RX currents [uA]. SX1276 figures.
+ */
+#ifndef ENERGY_RADIO_CURRENTS
+#define ENERGY_RADIO_CURRENTS                       { 1, 1600, 11500 }
+#endif
+
+/*!
+ * Default radio TX currents from -9 to 22 dBm [uA]. SX1276 figures, RFO up
+ * to 13 dBm and PA_BOOST above.
+ */
+#ifndef ENERGY_RADIO_TX_CURRENTS
+#define ENERGY_RADIO_TX_CURRENTS                    {  14000,  14000,  14500,  15000,  15500,  16000,  16500,  17000, \
+                                                       17500,  18000,  18500,  19000,  19500,  20000,  20500,  21000, \
+                                                       22000,  23000,  24000,  25000,  27000,  29000,  32000,  38000, \
+                                                       50000,  66000,  87000,  96000, 108000, 120000, 120000, 120000 }
+#endif
+
+/*!
+ * Default supply voltage [mV]
+ */
+#ifndef ENERGY_VOLTAGE_MV
+#define ENERGY_VOLTAGE_MV                           3300
+#endif
+
+typedef struct sEnergyCtx
+{
+    EnergyCurrents_t Currents;
+    /*!
+     * RTC timer value of the last accounting update
+     */
+    uint32_t LastTicks;
+    uint8_t McuState;
+    uint8_t RadioState;
+    /*!
+     * Index of the output power in Currents.RadioTx
+     */
+    uint8_t TxPowerIndex;
+    uint64_t ElapsedTicks;
+    uint64_t McuTicks[ENERGY_MCU_STATE_NB];
+    uint64_t RadioTicks[ENERGY_RADIO_TX];
+    uint64_t RadioTxTicks[ENERGY_TX_POWER_NB];
+    uint32_t McuWakeups;
+}EnergyCtx_t;
+
+/*!
+ * The accounting starts at power up, before any initialization, so that the
+ * boot time is accounted too.
+ */
+static EnergyCtx_t EnergyCtx =
+{
+    .Currents =
+    {
+        .Mcu = ENERGY_MCU_CURRENTS,
+        .Radio = ENERGY_RADIO_CURRENTS,
+        .RadioTx = ENERGY_RADIO_TX_CURRENTS,
+        .VoltageMv = ENERGY_VOLTAGE_MV,
+    },
+    .McuState = ENERGY_MCU_RUN,
+    .RadioState = ENERGY_RADIO_SLEEP,
+};
+
+/*!
+ * Accounts the time elapsed since the last update to the current states.
+ * Must be called under critical section.
+ */
+static void EnergyUpdate( void )
+{
+    uint32_t now = RtcGetTimerValue( );
+    uint32_t ticks = now - EnergyCtx.LastTicks;
+
+    EnergyCtx.LastTicks = now;
+    EnergyCtx.ElapsedTicks += ticks;
+    EnergyCtx.McuTicks[EnergyCtx.McuState] += ticks;
+    if( EnergyCtx.RadioState == ENERGY_RADIO_TX )
+    {
+        EnergyCtx.RadioTxTicks[EnergyCtx.TxPowerIndex] += ticks;
+    }
+    else
+    {
+        EnergyCtx.RadioTicks[EnergyCtx.RadioState] += ticks;
+    }
+}
+
+static uint64_t EnergyTicksToMs( uint64_t ticks, uint32_t ticksPerSecond )
+{
+    return ( ticks * 1000 ) / ticksPerSecond;
+}
+
+/*!
+ * Computes the charge drawn by the MCU and the radio. Must be called under
+ * critical section.
+ *
+ * \param [IN]  ticksPerSecond RTC timer ticks per second
+ * \param [OUT] radioCharge    Charge drawn by the radio [uC]
+ * \retval      mcuCharge      Charge drawn by the MCU [uC]
+ */
+static uint64_t EnergyComputeCharge( uint32_t ticksPerSecond, uint64_t *radioCharge )
+{
+    uint64_t mcu = 0;
+    uint64_t radio = 0;
+
+    // uA x ticks accumulators, converted to uC at the end to keep the
+    // resolution of the short states
+    for( uint8_t i = 0; i < ENERGY_MCU_STATE_NB; i++ )
+    {
+        mcu += EnergyCtx.McuTicks[i] * EnergyCtx.Currents.Mcu[i];
+    }
+    for( uint8_t i = 0; i < ENERGY_RADIO_TX; i++ )
+    {
+        radio += EnergyCtx.RadioTicks[i] * EnergyCtx.Currents.Radio[i];
+    }
+    for( uint8_t i = 0; i < ENERGY_TX_POWER_NB; i++ )
+    {
+        radio += EnergyCtx.RadioTxTicks[i] * EnergyCtx.Currents.RadioTx[i];
+    }
+    *radioCharge = radio / ticksPerSecond;
+    return mcu / ticksPerSecond;
+}
+
+void EnergyInit( const EnergyCurrents_t *currents )
+{
+    CRITICAL_SECTION_BEGIN( );
+    if( currents != NULL )
+    {
+        EnergyCtx.Currents = *currents;
+    }
+    EnergyCtx.LastTicks = RtcGetTimerValue( );
+    EnergyCtx.ElapsedTicks = 0;
+    memset1( ( uint8_t* )EnergyCtx.McuTicks, 0, sizeof( EnergyCtx.McuTicks ) );
+    memset1( ( uint8_t* )EnergyCtx.RadioTicks, 0, sizeof( EnergyCtx.RadioTicks ) );
+    memset1( ( uint8_t* )EnergyCtx.RadioTxTicks, 0, sizeof( EnergyCtx.RadioTxTicks ) );
+    EnergyCtx.McuWakeups = 0;
+    CRITICAL_SECTION_END( );
+}
+
+void EnergySetMcuState( EnergyMcuState_t state )
+{
+    CRITICAL_SECTION_BEGIN( );
+    EnergyUpdate( );
+    if( ( state == ENERGY_MCU_RUN ) &&
+        ( ( EnergyCtx.McuState == ENERGY_MCU_SLEEP ) || ( EnergyCtx.McuState == ENERGY_MCU_STOP ) ) )
+    {
+        EnergyCtx.McuWakeups++;
+    }
+    EnergyCtx.McuState = state;
+    CRITICAL_SECTION_END( );
+}
+
+void EnergySetRadioState( EnergyRadioState_t state )
+{
+    CRITICAL_SECTION_BEGIN( );
+    EnergyUpdate( );
+    EnergyCtx.RadioState = state;
+    CRITICAL_SECTION_END( );
+}
+
+void EnergySetRadioTxPower( int8_t power )
+{
+    power = MIN( MAX( power, ENERGY_TX_POWER_MIN ), ENERGY_TX_POWER_MAX );
+
+    CRITICAL_SECTION_BEGIN( );
+    EnergyUpdate( );
+    EnergyCtx.TxPowerIndex = power - ENERGY_TX_POWER_MIN;
+    CRITICAL_SECTION_END( );
+}
+
+uint64_t EnergyGetChargeUc( void )
+{
+    uint32_t ticksPerSecond = RtcMs2Tick( 1000 );
+    uint64_t mcu;
+    uint64_t radio;
+
+    CRITICAL_SECTION_BEGIN( );
+    EnergyUpdate( );
+    mcu = EnergyComputeCharge( ticksPerSecond, &radio );
+    CRITICAL_SECTION_END( );
+
+    return mcu + radio;
+}
+
+uint32_t EnergyGetMcuWakeups( void )
+{
+    return EnergyCtx.McuWakeups;
+}
+
+void EnergyGetStats( EnergyStats_t *stats )
+{
+    uint32_t ticksPerSecond = RtcMs2Tick( 1000 );
+    uint64_t charge;
+
+    if( stats == NULL )
+    {
+        return;
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    EnergyUpdate( );
+    stats->ElapsedMs = EnergyTicksToMs( EnergyCtx.ElapsedTicks, ticksPerSecond );
+    for( uint8_t i = 0; i < ENERGY_MCU_STATE_NB; i++ )
+    {
+        stats->McuTimeMs[i] = EnergyTicksToMs( EnergyCtx.McuTicks[i], ticksPerSecond );
+    }
+    for( uint8_t i = 0; i < ENERGY_RADIO_TX; i++ )
+    {
+        stats->RadioTimeMs[i] = EnergyTicksToMs( EnergyCtx.RadioTicks[i], ticksPerSecond );
+    }
+    stats->RadioTimeMs[ENERGY_RADIO_TX] = 0;
+    for( uint8_t i = 0; i < ENERGY_TX_POWER_NB; i++ )
+    {
+        stats->RadioTimeMs[ENERGY_RADIO_TX] += EnergyTicksToMs( EnergyCtx.RadioTxTicks[i], ticksPerSecond );
+    }
+    stats->McuChargeUc = EnergyComputeCharge( ticksPerSecond, &stats->RadioChargeUc );
+    stats->EnergyUj = ( ( stats->McuChargeUc + stats->RadioChargeUc ) * EnergyCtx.Currents.VoltageMv ) / 1000;
+    stats->McuWakeups = EnergyCtx.McuWakeups;
+    CRITICAL_SECTION_END( );
+
+    charge = stats->McuChargeUc + stats->RadioChargeUc;
+    // Average current [uA] x 24 h
+    stats->DailyChargeUah = ( stats->ElapsedMs == 0 ) ? 0 : ( uint32_t )( ( charge * 24 * 1000 ) / stats->ElapsedMs );
+}
+
+#endif // ENERGY_ACCOUNTING_ENABLED
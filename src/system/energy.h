@@ -0,0 +1,208 @@
+/*!
+ * \file      energy.h
+ *
+ * \brief     Energy accounting per subsystem state
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __ENERGY_H__
+#define __ENERGY_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * Lowest radio output power, in dBm, of \ref EnergyCurrents_t.RadioTx
+ */
+#ifndef ENERGY_TX_POWER_MIN
+#define ENERGY_TX_POWER_MIN                         -9
+#endif
+
+/*!
+ * Highest radio output power, in dBm, of \ref EnergyCurrents_t.RadioTx
+ */
+#ifndef ENERGY_TX_POWER_MAX
+#define ENERGY_TX_POWER_MAX                         22
+#endif
+
+#define ENERGY_TX_POWER_NB                          ( ENERGY_TX_POWER_MAX - ENERGY_TX_POWER_MIN + 1 )
+
+/*!
+ * MCU states
+ */
+typedef enum eEnergyMcuState
+{
+    ENERGY_MCU_RUN,
+    ENERGY_MCU_SLEEP,
+    ENERGY_MCU_STOP,
+    ENERGY_MCU_OFF,
+    ENERGY_MCU_STATE_NB,
+}EnergyMcuState_t;
+
+/*!
+ * Radio states. TX must remain the last one, see \ref EnergyCurrents_t.Radio
+ */
+typedef enum eEnergyRadioState
+{
+    ENERGY_RADIO_SLEEP,
+    ENERGY_RADIO_STANDBY,
+    ENERGY_RADIO_RX,
+    ENERGY_RADIO_TX,
+    ENERGY_RADIO_STATE_NB,
+}EnergyRadioState_t;
+
+/*!
+ * Board current consumption tables
+ */
+typedef struct sEnergyCurrents
+{
+    /*!
+     * MCU current per state [uA]
+     */
+    uint32_t Mcu[ENERGY_MCU_STATE_NB];
+    /*!
+     * Radio current per state except TX [uA]
+     */
+    uint32_t Radio[ENERGY_RADIO_TX];
+    /*!
+     * Radio TX current per output power, from ENERGY_TX_POWER_MIN to
+     * ENERGY_TX_POWER_MAX dBm [uA]
+     */
+    uint32_t RadioTx[ENERGY_TX_POWER_NB];
+    /*!
+     * Supply voltage [mV]
+     */
+    uint16_t VoltageMv;
+}EnergyCurrents_t;
+
+/*!
+ * Accumulated consumption
+ */
+typedef struct sEnergyStats
+{
+    /*!
+     * Time covered by the accounting [ms]
+     */
+    uint64_t ElapsedMs;
+    /*!
+     * Time spent in each MCU state [ms]
+     */
+    uint64_t McuTimeMs[ENERGY_MCU_STATE_NB];
+    /*!
+     * Time spent in each radio state [ms]
+     */
+    uint64_t RadioTimeMs[ENERGY_RADIO_STATE_NB];
+    /*!
+     * Charge drawn by the MCU [uC]
+     */
+    uint64_t McuChargeUc;
+    /*!
+     * Charge drawn by the radio [uC]
+     */
+    uint64_t RadioChargeUc;
+    /*!
+     * Energy drawn by the MCU and the radio [uJ]
+     */
+    uint64_t EnergyUj;
+    /*!
+     * Number of MCU wake ups from the sleep and stop modes
+     */
+    uint32_t McuWakeups;
+    /*!
+     * Charge drawn per day at the average current since the accounting
+     * start [uAh]
+     */
+    uint32_t DailyChargeUah;
+}EnergyStats_t;
+
+#if defined( ENERGY_ACCOUNTING_ENABLED )
+
+/*!
+ * Restarts the accounting
+ *
+ * The accounting runs from power up with the default tables. The defaults
+ * can be overridden by the board-config.h ENERGY_* definitions.
+ *
+ * \param [IN] currents Board current consumption tables. NULL keeps the
+ *                      current tables.
+ */
+void EnergyInit( const EnergyCurrents_t *currents );
+
+/*!
+ * Accounts the time spent in the previous MCU state. Called by the
+ * LpmEnterLowPower implementations.
+ *
+ * \param [IN] state New MCU state
+ */
+void EnergySetMcuState( EnergyMcuState_t state );
+
+/*!
+ * Accounts the time spent in the previous radio state. Called by the radio
+ * drivers.
+ *
+ * \param [IN] state New radio state
+ */
+void EnergySetRadioState( EnergyRadioState_t state );
+
+/*!
+ * Sets the output power used by the next ENERGY_RADIO_TX state. Called by
+ * the radio drivers.
+ *
+ * \param [IN] power Output power [dBm]
+ */
+void EnergySetRadioTxPower( int8_t power );
+
+/*!
+ * Gets the charge drawn since the accounting start
+ *
+ * \retval charge Charge drawn by the MCU and the radio [uC]
+ */
+uint64_t EnergyGetChargeUc( void );
+
+/*!
+ * Gets the number of MCU wake ups since the accounting start
+ *
+ * \retval wakeups Number of wake ups from the sleep and stop modes
+ */
+uint32_t EnergyGetMcuWakeups( void );
+
+/*!
+ * Gets the accumulated consumption
+ *
+ * \param [OUT] stats Accumulated consumption
+ */
+void EnergyGetStats( EnergyStats_t *stats );
+
+#else
+
+#define EnergyInit( currents )
+#define EnergySetMcuState( state )
+#define EnergySetRadioState( state )
+#define EnergySetRadioTxPower( power )
+#define EnergyGetChargeUc( )                        0
+#define EnergyGetMcuWakeups( )                      0
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __ENERGY_H__
@@ -20,11 +20,23 @@
  *
  * \author    Gregory Cristian ( Semtech )
  */
+#include "utilities.h"
 #include "fifo.h"
 
 static uint16_t FifoNext( Fifo_t *fifo, uint16_t index )
 {
-    return ( index + 1 ) % fifo->Size;
+    if( fifo->Mask != 0 )
+    {
+        return ( index + 1 ) & fifo->Mask;
+    }
+    return ( ( index + 1 ) < fifo->Size ) ? ( index + 1 ) : 0;
+}
+
+static uint16_t FifoAdvance( Fifo_t *fifo, uint16_t index, uint16_t count )
+{
+    uint32_t next = ( uint32_t )index + count;
+
+    return ( next < fifo->Size ) ? next : ( next - fifo->Size );
 }
 
 void FifoInit( Fifo_t *fifo, uint8_t *buffer, uint16_t size )
@@ -33,22 +45,97 @@ void FifoInit( Fifo_t *fifo, uint8_t *buffer, uint16_t size )
     fifo->End = 0;
     fifo->Data = buffer;
     fifo->Size = size;
+    fifo->Mask = ( ( size & ( size - 1 ) ) == 0 ) ? ( size - 1 ) : 0;
 }
 
 void FifoPush( Fifo_t *fifo, uint8_t data )
 {
-    fifo->End = FifoNext( fifo, fifo->End );
-    fifo->Data[fifo->End] = data;
+    uint16_t end = FifoNext( fifo, fifo->End );
+
+    fifo->Data[end] = data;
+    ATOMIC_COMPILER_BARRIER( );
+    fifo->End = end;
 }
 
 uint8_t FifoPop( Fifo_t *fifo )
 {
-    uint8_t data = fifo->Data[FifoNext( fifo, fifo->Begin )];
+    uint16_t begin = FifoNext( fifo, fifo->Begin );
+    uint8_t data = fifo->Data[begin];
 
-    fifo->Begin = FifoNext( fifo, fifo->Begin );
+    ATOMIC_COMPILER_BARRIER( );
+    fifo->Begin = begin;
     return data;
 }
 
+uint16_t FifoPushBuffer( Fifo_t *fifo, const uint8_t *buffer, uint16_t size )
+{
+    uint16_t begin = fifo->Begin;
+    uint16_t end = fifo->End;
+    uint16_t start = FifoNext( fifo, end );
+    uint16_t free = ( begin > end ) ? ( begin - end - 1 ) : ( fifo->Size - end + begin - 1 );
+    uint16_t chunk = 0;
+
+    if( size > free )
+    {
+        size = free;
+    }
+    if( size == 0 )
+    {
+        return 0;
+    }
+
+    // Contiguous span up to the end of the buffer, then the wrapped around one
+    chunk = fifo->Size - start;
+    if( chunk > size )
+    {
+        chunk = size;
+    }
+    memcpy1( fifo->Data + start, buffer, chunk );
+    memcpy1( fifo->Data, buffer + chunk, size - chunk );
+
+    ATOMIC_COMPILER_BARRIER( );
+    fifo->End = FifoAdvance( fifo, end, size );
+    return size;
+}
+
+uint16_t FifoPopBuffer( Fifo_t *fifo, uint8_t *buffer, uint16_t size )
+{
+    uint16_t begin = fifo->Begin;
+    uint16_t start = FifoNext( fifo, begin );
+    uint16_t count = FifoGetCount( fifo );
+    uint16_t chunk = 0;
+
+    if( size > count )
+    {
+        size = count;
+    }
+    if( size == 0 )
+    {
+        return 0;
+    }
+
+    // Contiguous span up to the end of the buffer, then the wrapped around one
+    chunk = fifo->Size - start;
+    if( chunk > size )
+    {
+        chunk = size;
+    }
+    memcpy1( buffer, fifo->Data + start, chunk );
+    memcpy1( buffer + chunk, fifo->Data, size - chunk );
+
+    ATOMIC_COMPILER_BARRIER( );
+    fifo->Begin = FifoAdvance( fifo, begin, size );
+    return size;
+}
+
+uint16_t FifoGetCount( Fifo_t *fifo )
+{
+    uint16_t begin = fifo->Begin;
+    uint16_t end = fifo->End;
+
+    return ( end >= begin ) ? ( end - begin ) : ( fifo->Size - begin + end );
+}
+
 void FifoFlush( Fifo_t *fifo )
 {
     fifo->Begin = 0;
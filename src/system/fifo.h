@@ -33,18 +33,27 @@ extern "C"
 
 /*!
  * FIFO structure
+ *
+ * \remark The FIFO is safe to be used without critical sections when a single
+ *         context pushes ( e.g. an IRQ handler ) and a single context pops
+ *         ( e.g. the main loop ). Only the producer updates End and only the
+ *         consumer updates Begin.
  */
 typedef struct Fifo_s
 {
-    uint16_t Begin;
-    uint16_t End;
+    volatile uint16_t Begin;
+    volatile uint16_t End;
     uint8_t *Data;
     uint16_t Size;
+    uint16_t Mask;  //! Index wrap around mask when Size is a power of 2, 0 otherwise
 }Fifo_t;
 
 /*!
  * Initializes the FIFO structure
  *
+ * \remark The FIFO holds up to size - 1 bytes. A power of 2 size enables a
+ *         faster index wrap around.
+ *
  * \param [IN] fifo   Pointer to the FIFO object
  * \param [IN] buffer Buffer to be used as FIFO
  * \param [IN] size   Size of the buffer
@@ -67,9 +76,39 @@ void FifoPush( Fifo_t *fifo, uint8_t data );
  */
 uint8_t FifoPop( Fifo_t *fifo );
 
+/*!
+ * Pushes as many bytes of the buffer as the FIFO can hold
+ *
+ * \param [IN] fifo   Pointer to the FIFO object
+ * \param [IN] buffer Data to be pushed into the FIFO
+ * \param [IN] size   Number of bytes to be pushed
+ * \retval count      Number of bytes pushed into the FIFO
+ */
+uint16_t FifoPushBuffer( Fifo_t *fifo, const uint8_t *buffer, uint16_t size );
+
+/*!
+ * Pops up to size bytes from the FIFO
+ *
+ * \param [IN]  fifo   Pointer to the FIFO object
+ * \param [OUT] buffer Buffer receiving the popped data
+ * \param [IN]  size   Maximum number of bytes to be popped
+ * \retval count       Number of bytes popped from the FIFO
+ */
+uint16_t FifoPopBuffer( Fifo_t *fifo, uint8_t *buffer, uint16_t size );
+
+/*!
+ * Gets the number of bytes stored in the FIFO
+ *
+ * \param [IN] fifo   Pointer to the FIFO object
+ * \retval count      Number of bytes in the FIFO
+ */
+uint16_t FifoGetCount( Fifo_t *fifo );
+
 /*!
  * Flushes the FIFO
  *
+ * \remark Not to be called while the FIFO is used by another context.
+ *
  * \param [IN] fifo   Pointer to the FIFO object
  */
 void FifoFlush( Fifo_t *fifo );
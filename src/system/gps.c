@@ -21,23 +21,74 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdint.h>
-#include <stdlib.h>
-#include <math.h>
-#include <stdio.h>
-#include <string.h>
+#include <stddef.h>
 #include "utilities.h"
 #include "board.h"
 #include "rtc-board.h"
+#include "timer.h"
 #include "gps-board.h"
 #include "gps.h"
 
 #define TRIGGER_GPS_CNT                             10
 
-/* Various type of NMEA data we can receive with the Gps */
-const char NmeaDataTypeGPGGA[] = "GPGGA";
-const char NmeaDataTypeGPGSA[] = "GPGSA";
-const char NmeaDataTypeGPGSV[] = "GPGSV";
-const char NmeaDataTypeGPRMC[] = "GPRMC";
+/*!
+ * Power manager settings. The defaults match an u-blox 7 receiver ( PAM7Q )
+ * with its backup supply kept while the main supply is OFF.
+ */
+#ifndef GPS_EPHEMERIS_VALIDITY
+#define GPS_EPHEMERIS_VALIDITY                      ( 2 * 3600 * 1000UL )   // [ms]
+#endif
+#ifndef GPS_HOT_START_TIME
+#define GPS_HOT_START_TIME                          2000                    // [ms]
+#endif
+#ifndef GPS_COLD_START_TIME
+#define GPS_COLD_START_TIME                         30000                   // [ms]
+#endif
+/*!
+ * Time added to the estimate before the uplink
+ */
+#ifndef GPS_FIX_MARGIN
+#define GPS_FIX_MARGIN                              1000                    // [ms]
+#endif
+/*!
+ * PPS pulses required after the start for a fix to be good enough. The PPS
+ * is only output once the receiver has a time solution.
+ */
+#ifndef GPS_FIX_MIN_PPS_COUNT
+#define GPS_FIX_MIN_PPS_COUNT                       2
+#endif
+/*!
+ * Receiver current while acquiring, used for the fix charge
+ */
+#ifndef GPS_ACQUISITION_CURRENT
+#define GPS_ACQUISITION_CURRENT                     25000                   // [uA]
+#endif
+
+/*!
+ * PPS pulses of a RTC calibration period. With the 1024 Hz RTC tick, one
+ * tick over 1024 s is close to the hardware correction resolution.
+ */
+#ifndef GPS_PPS_CALIBRATION_PERIOD
+#define GPS_PPS_CALIBRATION_PERIOD                  1024
+#endif
+
+/*!
+ * Maximum length of a NMEA sentence, '$' and CR LF excluded
+ */
+#define NMEA_SENTENCE_MAX_LENGTH                    80
+
+/*!
+ * Sentence types, the 3 last characters of the address field. The talker
+ * identifier ( GP, GN, ... ) isn't checked.
+ */
+#define NMEA_TYPE_GGA                               ( ( 'G' << 16 ) | ( 'G' << 8 ) | 'A' )
+#define NMEA_TYPE_RMC                               ( ( 'R' << 16 ) | ( 'M' << 8 ) | 'C' )
+
+/*!
+ * Number of fraction digits kept for the positions minutes and the altitude
+ */
+#define NMEA_MINUTES_FRACTION_DIGITS                5
+#define NMEA_ALTITUDE_FRACTION_DIGITS               2
 
 /* Value used for the conversion of the position from DMS to decimal */
 const int32_t MaxNorthPosition = 8388607;       // 2^23 - 1
@@ -45,27 +96,300 @@ const int32_t MaxSouthPosition = 8388608;       // -2^23
 const int32_t MaxEastPosition = 8388607;        // 2^23 - 1
 const int32_t MaxWestPosition = 8388608;        // -2^23
 
-NmeaGpsData_t NmeaGpsData;
+/*!
+ * NMEA parser states
+ */
+typedef enum eGpsNmeaState
+{
+    NMEA_STATE_WAIT_START,
+    NMEA_STATE_DATA,
+    NMEA_STATE_CHECKSUM_HIGH,
+    NMEA_STATE_CHECKSUM_LOW,
+}GpsNmeaState_t;
 
-static double HasFix = false;
-static double Latitude = 0;
-static double Longitude = 0;
+/*!
+ * NMEA streaming parser context
+ */
+typedef struct sGpsNmeaParser
+{
+    GpsNmeaState_t State;
+    /*!
+     * Sentence length, checksum of the received characters and checksum
+     * given by the sentence
+     */
+    uint8_t Length;
+    uint8_t Checksum;
+    uint8_t SentenceChecksum;
+    /*!
+     * Current field index and length
+     */
+    uint8_t Field;
+    uint8_t FieldLength;
+    /*!
+     * Sentence type, NMEA_TYPE_GGA or NMEA_TYPE_RMC once the address field
+     * is parsed
+     */
+    uint32_t Type;
+    /*!
+     * Current field first character and numerical value
+     */
+    char FieldChar;
+    uint32_t IntegerPart;
+    uint32_t FractionPart;
+    uint8_t FractionDigits;
+    bool InFraction;
+    bool Negative;
+    /*!
+     * Values extracted from the sentence, committed when the checksum is valid
+     */
+    bool Fix;
+    bool PositionValid;
+    bool AltitudeValid;
+    int32_t Latitude;
+    int32_t Longitude;
+    int32_t Altitude;
+}GpsNmeaParser_t;
+
+static GpsNmeaParser_t Parser;
+
+/*!
+ * Sentence types to parse
+ */
+static uint8_t NmeaSentences = GPS_NMEA_GGA | GPS_NMEA_RMC;
+
+static bool HasFix = false;
+
+/*!
+ * Latest position [1e-7 degree] and altitude [cm]
+ */
+static int32_t Latitude = 0;
+static int32_t Longitude = 0;
+static int32_t Altitude = 0;
 
 static int32_t LatitudeBinary = 0;
 static int32_t LongitudeBinary = 0;
 
-static int16_t Altitude = ( int16_t )0xFFFF;
-
 static uint32_t PpsCnt = 0;
 
 bool PpsDetected = false;
 
+/*!
+ * Power manager states
+ */
+typedef enum eGpsPowerState
+{
+    GPS_POWER_IDLE,
+    GPS_POWER_WAIT,
+    GPS_POWER_ACQUIRING,
+}GpsPowerState_t;
+
+/*!
+ * Power manager context
+ */
+typedef struct sGpsPower
+{
+    GpsPowerState_t State;
+    TimerEvent_t Timer;
+    /*!
+     * Acquisition start time and PPS pulses since then
+     */
+    TimerTime_t StartTime;
+    uint32_t PpsCnt;
+    /*!
+     * Latest fix time, valid once a fix is obtained
+     */
+    TimerTime_t FixTime;
+    bool FixTimeValid;
+    /*!
+     * Smoothed hot start time to fix [ms]
+     */
+    uint32_t HotStartTime;
+    /*!
+     * Charge of all the acquisitions [uC]
+     */
+    uint64_t Charge;
+    GpsFixStats_t Stats;
+}GpsPower_t;
+
+static GpsPower_t GpsPower;
+
+/*!
+ * RTC calibration context
+ */
+typedef struct sGpsRtcCalibration
+{
+    bool Enabled;
+    /*!
+     * RTC timer value at the period start and at the latest pulse
+     */
+    uint32_t StartTick;
+    uint32_t LastTick;
+    /*!
+     * Pulse intervals counted in the period, 0 until the first pulse
+     */
+    uint32_t Intervals;
+    bool Started;
+    /*!
+     * Latest measured error and applied correction [ppb]
+     */
+    int32_t Error;
+    int32_t Correction;
+}GpsRtcCalibration_t;
+
+static GpsRtcCalibration_t RtcCalibration;
+
+/*!
+ * \brief Timestamps a PPS pulse and updates the RTC correction at the end of
+ *        the period
+ */
+static void GpsRtcCalibrationOnPps( void )
+{
+    uint32_t now = RtcGetTimerValue( );
+    uint32_t ticksPerSecond = RtcMs2Tick( 1000 );
+
+    if( RtcCalibration.Started == true )
+    {
+        uint32_t interval = now - RtcCalibration.LastTick;
+
+        if( ( interval < ( ticksPerSecond / 2 ) ) || ( interval > ( ( 3 * ticksPerSecond ) / 2 ) ) )
+        {
+            // Missed or spurious pulse
+            RtcCalibration.Started = false;
+        }
+    }
+
+    if( RtcCalibration.Started == false )
+    {
+        RtcCalibration.Started = true;
+        RtcCalibration.StartTick = now;
+        RtcCalibration.LastTick = now;
+        RtcCalibration.Intervals = 0;
+        return;
+    }
+
+    RtcCalibration.LastTick = now;
+    RtcCalibration.Intervals++;
+
+    if( RtcCalibration.Intervals >= GPS_PPS_CALIBRATION_PERIOD )
+    {
+        int64_t expected = ( int64_t )RtcCalibration.Intervals * ticksPerSecond;
+        int64_t measured = ( int64_t )( uint32_t )( now - RtcCalibration.StartTick );
+
+        // A fast RTC counts more ticks than expected and is slowed down
+        RtcCalibration.Error = ( int32_t )( ( ( measured - expected ) * 1000000000 ) / expected );
+        RtcCalibration.Correction = RtcSetCalibration( RtcCalibration.Correction - RtcCalibration.Error );
+
+        RtcCalibration.StartTick = now;
+        RtcCalibration.Intervals = 0;
+    }
+}
+
+static void GpsPowerOnTimerEvent( void* context );
+
+/*!
+ * \brief Returns the time to fix estimate
+ */
+static uint32_t GpsPowerGetEstimate( void )
+{
+    if( ( GpsPower.FixTimeValid == true ) &&
+        ( TimerGetElapsedTime( GpsPower.FixTime ) < GPS_EPHEMERIS_VALIDITY ) )
+    {
+        return GpsPower.HotStartTime;
+    }
+    return GPS_COLD_START_TIME;
+}
+
+/*!
+ * \brief Switches the receiver back to backup mode and accounts for the
+ *        acquisition
+ *
+ * \param [IN] fix True when the acquisition ended with a fix
+ */
+static void GpsPowerStop( bool fix )
+{
+    uint32_t onTime = TimerGetElapsedTime( GpsPower.StartTime );
+
+    TimerStop( &GpsPower.Timer );
+    GpsMcuStop( );
+    GpsPower.State = GPS_POWER_IDLE;
+
+    if( fix == true )
+    {
+        GpsPower.Stats.FixCount++;
+        GpsPower.Stats.LastTimeToFix = onTime;
+        if( ( GpsPower.FixTimeValid == true ) &&
+            ( TimerGetElapsedTime( GpsPower.FixTime ) < GPS_EPHEMERIS_VALIDITY ) )
+        {
+            GpsPower.HotStartTime = ( ( 3 * GpsPower.HotStartTime ) + onTime ) / 4;
+        }
+        GpsPower.FixTime = TimerGetCurrentTime( );
+        GpsPower.FixTimeValid = true;
+    }
+    else
+    {
+        GpsPower.Stats.TimeoutCount++;
+    }
+    GpsPower.Stats.OnTime += onTime;
+    GpsPower.Stats.LastFixCharge = ( uint32_t )( ( ( uint64_t )onTime * GPS_ACQUISITION_CURRENT ) / 1000 );
+    GpsPower.Charge += GpsPower.Stats.LastFixCharge;
+}
+
+/*!
+ * \brief Switches the receiver ON for a scheduled fix
+ */
+static void GpsPowerStart( void )
+{
+    uint32_t estimate = GpsPowerGetEstimate( );
+
+    GpsPower.State = GPS_POWER_ACQUIRING;
+    GpsPower.StartTime = TimerGetCurrentTime( );
+    GpsPower.PpsCnt = 0;
+    HasFix = false;
+    GpsMcuStart( );
+
+    // Gives up once twice the estimate elapsed
+    TimerSetValue( &GpsPower.Timer, ( 2 * estimate ) + GPS_FIX_MARGIN );
+    TimerStart( &GpsPower.Timer );
+}
+
+static void GpsPowerOnTimerEvent( void* context )
+{
+    CRITICAL_SECTION_BEGIN( );
+    if( GpsPower.State == GPS_POWER_WAIT )
+    {
+        GpsPowerStart( );
+    }
+    else if( GpsPower.State == GPS_POWER_ACQUIRING )
+    {
+        GpsPowerStop( false );
+    }
+    CRITICAL_SECTION_END( );
+}
+
 void GpsPpsHandler( bool *parseData )
 {
     PpsDetected = true;
     PpsCnt++;
     *parseData = false;
 
+    if( RtcCalibration.Enabled == true )
+    {
+        GpsRtcCalibrationOnPps( );
+    }
+
+    if( GpsPower.State == GPS_POWER_ACQUIRING )
+    {
+        // Parses each PPS once the time solution is settled, the receiver
+        // is switched OFF at the first valid fix
+        GpsPower.PpsCnt++;
+        if( GpsPower.PpsCnt >= GPS_FIX_MIN_PPS_COUNT )
+        {
+            PpsCnt = 0;
+            *parseData = true;
+        }
+        return;
+    }
+
     if( PpsCnt >= TRIGGER_GPS_CNT )
     {
         PpsCnt = 0;
@@ -76,6 +400,10 @@ void GpsPpsHandler( bool *parseData )
 void GpsInit( void )
 {
     PpsDetected = false;
+    Parser.State = NMEA_STATE_WAIT_START;
+    GpsPower.State = GPS_POWER_IDLE;
+    GpsPower.HotStartTime = GPS_HOT_START_TIME;
+    TimerInit( &GpsPower.Timer, GpsPowerOnTimerEvent );
     GpsMcuInit( );
 }
 
@@ -110,83 +438,61 @@ bool GpsHasFix( void )
     return HasFix;
 }
 
-void GpsConvertPositionIntoBinary( void )
+void GpsSetNmeaSentences( uint8_t sentences )
 {
-    long double temp;
+    NmeaSentences = sentences;
+}
 
+void GpsConvertPositionIntoBinary( void )
+{
     if( Latitude >= 0 ) // North
     {
-        temp = Latitude * MaxNorthPosition;
-        LatitudeBinary = temp / 90;
+        LatitudeBinary = ( int32_t )( ( ( int64_t )Latitude * MaxNorthPosition ) / 900000000 );
     }
     else                // South
     {
-        temp = Latitude * MaxSouthPosition;
-        LatitudeBinary = temp / 90;
+        LatitudeBinary = ( int32_t )( ( ( int64_t )Latitude * MaxSouthPosition ) / 900000000 );
     }
 
     if( Longitude >= 0 ) // East
     {
-        temp = Longitude * MaxEastPosition;
-        LongitudeBinary = temp / 180;
+        LongitudeBinary = ( int32_t )( ( ( int64_t )Longitude * MaxEastPosition ) / 1800000000 );
     }
     else                // West
     {
-        temp = Longitude * MaxWestPosition;
-        LongitudeBinary = temp / 180;
+        LongitudeBinary = ( int32_t )( ( ( int64_t )Longitude * MaxWestPosition ) / 1800000000 );
     }
 }
 
-void GpsConvertPositionFromStringToNumerical( void )
+uint8_t GpsGetLatestGpsPositionDouble( double *lati, double *longi )
 {
-    int i;
-
-    double valueTmp1;
-    double valueTmp2;
-    double valueTmp3;
-    double valueTmp4;
-
-    // Convert the latitude from ASCII to uint8_t values
-    for( i = 0 ; i < 10 ; i++ )
-    {
-        NmeaGpsData.NmeaLatitude[i] = NmeaGpsData.NmeaLatitude[i] & 0xF;
-    }
-    // Convert latitude from degree/minute/second (DMS) format into decimal
-    valueTmp1 = ( double )NmeaGpsData.NmeaLatitude[0] * 10.0 + ( double )NmeaGpsData.NmeaLatitude[1];
-    valueTmp2 = ( double )NmeaGpsData.NmeaLatitude[2] * 10.0 + ( double )NmeaGpsData.NmeaLatitude[3];
-    valueTmp3 = ( double )NmeaGpsData.NmeaLatitude[5] * 1000.0 + ( double )NmeaGpsData.NmeaLatitude[6] * 100.0 +
-                ( double )NmeaGpsData.NmeaLatitude[7] * 10.0 + ( double )NmeaGpsData.NmeaLatitude[8];
-
-    Latitude = valueTmp1 + ( ( valueTmp2 + ( valueTmp3 * 0.0001 ) ) / 60.0 );
+    uint8_t status = FAIL;
+    int32_t latitude;
+    int32_t longitude;
 
-    if( NmeaGpsData.NmeaLatitudePole[0] == 'S' )
+    CRITICAL_SECTION_BEGIN( );
+    if( HasFix == true )
     {
-        Latitude *= -1;
+        status = SUCCESS;
     }
-
-    // Convert the longitude from ASCII to uint8_t values
-    for( i = 0 ; i < 10 ; i++ )
+    else
     {
-        NmeaGpsData.NmeaLongitude[i] = NmeaGpsData.NmeaLongitude[i] & 0xF;
+        GpsResetPosition( );
     }
-    // Convert longitude from degree/minute/second (DMS) format into decimal
-    valueTmp1 = ( double )NmeaGpsData.NmeaLongitude[0] * 100.0 + ( double )NmeaGpsData.NmeaLongitude[1] * 10.0 + ( double )NmeaGpsData.NmeaLongitude[2];
-    valueTmp2 = ( double )NmeaGpsData.NmeaLongitude[3] * 10.0 + ( double )NmeaGpsData.NmeaLongitude[4];
-    valueTmp3 = ( double )NmeaGpsData.NmeaLongitude[6] * 1000.0 + ( double )NmeaGpsData.NmeaLongitude[7] * 100;
-    valueTmp4 = ( double )NmeaGpsData.NmeaLongitude[8] * 10.0 + ( double )NmeaGpsData.NmeaLongitude[9];
-
-    Longitude = valueTmp1 + ( valueTmp2 / 60.0 ) + ( ( ( valueTmp3 + valueTmp4 ) * 0.0001 ) / 60.0 );
+    latitude = Latitude;
+    longitude = Longitude;
+    CRITICAL_SECTION_END( );
 
-    if( NmeaGpsData.NmeaLongitudePole[0] == 'W' )
-    {
-        Longitude *= -1;
-    }
+    *lati = latitude / 10000000.0;
+    *longi = longitude / 10000000.0;
+    return status;
 }
 
-
-uint8_t GpsGetLatestGpsPositionDouble( double *lati, double *longi )
+uint8_t GpsGetLatestGpsPositionBinary( int32_t *latiBin, int32_t *longiBin )
 {
     uint8_t status = FAIL;
+
+    CRITICAL_SECTION_BEGIN( );
     if( HasFix == true )
     {
         status = SUCCESS;
@@ -195,12 +501,13 @@ uint8_t GpsGetLatestGpsPositionDouble( double *lati, double *longi )
     {
         GpsResetPosition( );
     }
-    *lati = Latitude;
-    *longi = Longitude;
+    *latiBin = LatitudeBinary;
+    *longiBin = LongitudeBinary;
+    CRITICAL_SECTION_END( );
     return status;
 }
 
-uint8_t GpsGetLatestGpsPositionBinary( int32_t *latiBin, int32_t *longiBin )
+uint8_t GpsGetLatestGpsPositionFixed( int32_t *lati, int32_t *longi, int32_t *altitude )
 {
     uint8_t status = FAIL;
 
@@ -213,26 +520,25 @@ uint8_t GpsGetLatestGpsPositionBinary( int32_t *latiBin, int32_t *longiBin )
     {
         GpsResetPosition( );
     }
-    *latiBin = LatitudeBinary;
-    *longiBin = LongitudeBinary;
+    *lati = Latitude;
+    *longi = Longitude;
+    *altitude = Altitude;
     CRITICAL_SECTION_END( );
     return status;
 }
 
 int16_t GpsGetLatestGpsAltitude( void )
 {
+    int16_t altitude = ( int16_t )0xFFFF;
+
     CRITICAL_SECTION_BEGIN( );
     if( HasFix == true )
     {
-        Altitude = atoi( NmeaGpsData.NmeaAltitude );
-    }
-    else
-    {
-        Altitude = ( int16_t )0xFFFF;
+        altitude = ( int16_t )( Altitude / 100 );
     }
     CRITICAL_SECTION_END( );
 
-    return Altitude;
+    return altitude;
 }
 
 /*!
@@ -279,380 +585,410 @@ int32_t GpsNmeaChecksum( int8_t *nmeaStr, int32_t nmeaStrSize, int8_t * checksum
 }
 
 /*!
- * Calculate the checksum of a NMEA frame and compare it to the checksum that is
- * present at the end of it.
- * Return true if it matches
+ * \brief Converts an hexadecimal character
+ *
+ * \retval value Nibble value, -1 when the character isn't hexadecimal
+ */
+static int8_t HexCharToNibble( uint8_t c )
+{
+    if( ( c >= '0' ) && ( c <= '9' ) )
+    {
+        return c - '0';
+    }
+    if( ( c >= 'A' ) && ( c <= 'F' ) )
+    {
+        return c - 'A' + 10;
+    }
+    if( ( c >= 'a' ) && ( c <= 'f' ) )
+    {
+        return c - 'a' + 10;
+    }
+    return -1;
+}
+
+/*!
+ * \brief Converts the current field, [d]ddmm.mmmmm, into 1e-7 degree
  */
-static bool GpsNmeaValidateChecksum( int8_t *serialBuff, int32_t buffSize )
+static int32_t NmeaFieldToPosition( void )
 {
-    int32_t checksumIndex;
-    int8_t checksum[2]; // 2 characters to calculate NMEA checksum
+    uint32_t fraction = Parser.FractionPart;
+    uint32_t minutes;
+
+    for( uint8_t i = Parser.FractionDigits; i < NMEA_MINUTES_FRACTION_DIGITS; i++ )
+    {
+        fraction *= 10;
+    }
+    // 1e-5 minute
+    minutes = ( ( Parser.IntegerPart % 100 ) * 100000 ) + fraction;
+
+    // 1e-5 minute * 1e7 / ( 60 * 1e5 ) = 5 / 3
+    return ( int32_t )( ( ( Parser.IntegerPart / 100 ) * 10000000 ) + ( ( minutes * 5 ) / 3 ) );
+}
 
-    checksumIndex = GpsNmeaChecksum( serialBuff, buffSize, checksum );
+/*!
+ * \brief Converts the current field, meters with a fraction, into cm
+ */
+static int32_t NmeaFieldToAltitude( void )
+{
+    uint32_t fraction = Parser.FractionPart;
+    int32_t altitude;
 
-    // could we calculate a verification checksum ?
-    if( checksumIndex < 0 )
+    for( uint8_t i = Parser.FractionDigits; i < NMEA_ALTITUDE_FRACTION_DIGITS; i++ )
     {
-        return false;
+        fraction *= 10;
     }
+    altitude = ( int32_t )( ( Parser.IntegerPart * 100 ) + fraction );
+
+    return ( Parser.Negative == true ) ? -altitude : altitude;
+}
 
-    // check if there are enough char in the serial buffer to read checksum
-    if( checksumIndex >= ( buffSize - 2 ) )
+/*!
+ * \brief Handles the end of a field
+ *
+ * \retval status false when the sentence must be skipped
+ */
+static bool NmeaFieldEnd( void )
+{
+    bool empty = Parser.FieldLength == 0;
+
+    if( Parser.Field == 0 )
     {
+        // Address field, talker identifier followed by the sentence type
+        if( Parser.FieldLength != 5 )
+        {
+            return false;
+        }
+        if( ( Parser.Type == NMEA_TYPE_GGA ) && ( ( NmeaSentences & GPS_NMEA_GGA ) != 0 ) )
+        {
+            return true;
+        }
+        if( ( Parser.Type == NMEA_TYPE_RMC ) && ( ( NmeaSentences & GPS_NMEA_RMC ) != 0 ) )
+        {
+            return true;
+        }
         return false;
     }
 
-    // check the checksum
-    if( ( serialBuff[checksumIndex] == checksum[0] ) && ( serialBuff[checksumIndex + 1] == checksum[1] ) )
+    if( Parser.Type == NMEA_TYPE_GGA )
     {
-        return true;
+        switch( Parser.Field )
+        {
+            case 2:
+                Parser.Latitude = NmeaFieldToPosition( );
+                Parser.PositionValid = !empty;
+                break;
+            case 3:
+                if( Parser.FieldChar == 'S' )
+                {
+                    Parser.Latitude = -Parser.Latitude;
+                }
+                break;
+            case 4:
+                Parser.Longitude = NmeaFieldToPosition( );
+                Parser.PositionValid &= !empty;
+                break;
+            case 5:
+                if( Parser.FieldChar == 'W' )
+                {
+                    Parser.Longitude = -Parser.Longitude;
+                }
+                break;
+            case 6:
+                Parser.Fix = ( empty == false ) && ( Parser.IntegerPart > 0 );
+                break;
+            case 9:
+                Parser.Altitude = NmeaFieldToAltitude( );
+                Parser.AltitudeValid = !empty;
+                break;
+            default:
+                break;
+        }
     }
     else
     {
-        return false;
+        switch( Parser.Field )
+        {
+            case 2:
+                Parser.Fix = Parser.FieldChar == 'A';
+                break;
+            case 3:
+                Parser.Latitude = NmeaFieldToPosition( );
+                Parser.PositionValid = !empty;
+                break;
+            case 4:
+                if( Parser.FieldChar == 'S' )
+                {
+                    Parser.Latitude = -Parser.Latitude;
+                }
+                break;
+            case 5:
+                Parser.Longitude = NmeaFieldToPosition( );
+                Parser.PositionValid &= !empty;
+                break;
+            case 6:
+                if( Parser.FieldChar == 'W' )
+                {
+                    Parser.Longitude = -Parser.Longitude;
+                }
+                break;
+            default:
+                break;
+        }
     }
+    return true;
 }
 
-uint8_t GpsParseGpsData( int8_t *rxBuffer, int32_t rxBufferSize )
+/*!
+ * \brief Starts the parsing of a new field
+ */
+static void NmeaFieldStart( void )
 {
-    uint8_t i = 1;
-    uint8_t j = 0;
-    uint8_t fieldSize = 0;
+    Parser.FieldLength = 0;
+    Parser.FieldChar = 0;
+    Parser.IntegerPart = 0;
+    Parser.FractionPart = 0;
+    Parser.FractionDigits = 0;
+    Parser.InFraction = false;
+    Parser.Negative = false;
+}
 
-    if( rxBuffer[0] != '$' )
+/*!
+ * \brief Updates the latest fix with the values of a validated sentence
+ */
+static void NmeaCommit( void )
+{
+    CRITICAL_SECTION_BEGIN( );
+    HasFix = ( Parser.Fix == true ) && ( Parser.PositionValid == true );
+    if( Parser.PositionValid == true )
     {
-        GpsMcuInvertPpsTrigger( );
-        return FAIL;
+        Latitude = Parser.Latitude;
+        Longitude = Parser.Longitude;
+        GpsConvertPositionIntoBinary( );
     }
-
-    if( GpsNmeaValidateChecksum( rxBuffer, rxBufferSize ) == false )
+    if( Parser.AltitudeValid == true )
     {
-        return FAIL;
+        Altitude = Parser.Altitude;
     }
-
-    fieldSize = 0;
-    while( rxBuffer[i + fieldSize++] != ',' )
+    if( ( HasFix == true ) && ( GpsPower.State == GPS_POWER_ACQUIRING ) &&
+        ( GpsPower.PpsCnt >= GPS_FIX_MIN_PPS_COUNT ) )
     {
-        if( fieldSize > 6 )
-        {
-            return FAIL;
-        }
+        GpsPowerStop( true );
     }
-    for( j = 0; j < fieldSize; j++, i++ )
+    CRITICAL_SECTION_END( );
+}
+
+uint8_t GpsParseGpsChar( uint8_t data )
+{
+    if( data == '$' )
     {
-        NmeaGpsData.NmeaDataType[j] = rxBuffer[i];
+        // Start of a sentence, an unterminated previous one is dropped
+        Parser.State = NMEA_STATE_DATA;
+        Parser.Length = 0;
+        Parser.Checksum = 0;
+        Parser.Field = 0;
+        Parser.Type = 0;
+        Parser.Fix = false;
+        Parser.PositionValid = false;
+        Parser.AltitudeValid = false;
+        NmeaFieldStart( );
+        return FAIL;
     }
-    // Parse the GPGGA data
-    if( strncmp( ( const char* )NmeaGpsData.NmeaDataType, ( const char* )NmeaDataTypeGPGGA, 5 ) == 0 )
+
+    switch( Parser.State )
     {
-        // NmeaUtcTime
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 11 )
+        case NMEA_STATE_DATA:
+            if( ++Parser.Length > NMEA_SENTENCE_MAX_LENGTH )
             {
-                return FAIL;
+                Parser.State = NMEA_STATE_WAIT_START;
+                break;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaUtcTime[j] = rxBuffer[i];
-        }
-        // NmeaLatitude
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 10 )
+            if( ( data == ',' ) || ( data == '*' ) )
             {
-                return FAIL;
+                if( NmeaFieldEnd( ) == false )
+                {
+                    // Not a selected sentence type, skip it
+                    Parser.State = NMEA_STATE_WAIT_START;
+                    break;
+                }
+                if( data == '*' )
+                {
+                    Parser.State = NMEA_STATE_CHECKSUM_HIGH;
+                    break;
+                }
+                Parser.Checksum ^= data;
+                Parser.Field++;
+                NmeaFieldStart( );
+                break;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLatitude[j] = rxBuffer[i];
-        }
-        // NmeaLatitudePole
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
+            Parser.Checksum ^= data;
+            if( ( data == '\r' ) || ( data == '\n' ) )
             {
-                return FAIL;
+                // Sentence without checksum
+                Parser.State = NMEA_STATE_WAIT_START;
+                break;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLatitudePole[j] = rxBuffer[i];
-        }
-        // NmeaLongitude
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 11 )
+            if( Parser.FieldLength++ == 0 )
             {
-                return FAIL;
+                Parser.FieldChar = ( char )data;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLongitude[j] = rxBuffer[i];
-        }
-        // NmeaLongitudePole
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
+            if( Parser.Field == 0 )
             {
-                return FAIL;
+                Parser.Type = ( ( Parser.Type << 8 ) | data ) & 0x00FFFFFF;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLongitudePole[j] = rxBuffer[i];
-        }
-        // NmeaFixQuality
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
+            else if( ( data >= '0' ) && ( data <= '9' ) )
             {
-                return FAIL;
+                if( Parser.InFraction == false )
+                {
+                    Parser.IntegerPart = ( Parser.IntegerPart * 10 ) + ( data - '0' );
+                }
+                else if( Parser.FractionDigits < NMEA_MINUTES_FRACTION_DIGITS )
+                {
+                    Parser.FractionPart = ( Parser.FractionPart * 10 ) + ( data - '0' );
+                    Parser.FractionDigits++;
+                }
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaFixQuality[j] = rxBuffer[i];
-        }
-        // NmeaSatelliteTracked
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 3 )
+            else if( data == '.' )
             {
-                return FAIL;
+                Parser.InFraction = true;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaSatelliteTracked[j] = rxBuffer[i];
-        }
-        // NmeaHorizontalDilution
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 6 )
+            else if( data == '-' )
             {
-                return FAIL;
+                Parser.Negative = true;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaHorizontalDilution[j] = rxBuffer[i];
-        }
-        // NmeaAltitude
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 8 )
+            break;
+        case NMEA_STATE_CHECKSUM_HIGH:
+            if( HexCharToNibble( data ) < 0 )
             {
-                return FAIL;
+                Parser.State = NMEA_STATE_WAIT_START;
+                break;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaAltitude[j] = rxBuffer[i];
-        }
-        // NmeaAltitudeUnit
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaAltitudeUnit[j] = rxBuffer[i];
-        }
-        // NmeaHeightGeoid
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 8 )
+            Parser.SentenceChecksum = ( uint8_t )( HexCharToNibble( data ) << 4 );
+            Parser.State = NMEA_STATE_CHECKSUM_LOW;
+            break;
+        case NMEA_STATE_CHECKSUM_LOW:
+            Parser.State = NMEA_STATE_WAIT_START;
+            if( HexCharToNibble( data ) < 0 )
             {
-                return FAIL;
+                break;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaHeightGeoid[j] = rxBuffer[i];
-        }
-        // NmeaHeightGeoidUnit
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
+            Parser.SentenceChecksum |= ( uint8_t )HexCharToNibble( data );
+            if( Parser.SentenceChecksum == Parser.Checksum )
             {
-                return FAIL;
+                NmeaCommit( );
+                return SUCCESS;
             }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaHeightGeoidUnit[j] = rxBuffer[i];
-        }
+            break;
+        case NMEA_STATE_WAIT_START:
+        default:
+            break;
+    }
+    return FAIL;
+}
 
-        GpsFormatGpsData( );
-        return SUCCESS;
+uint8_t GpsParseGpsData( int8_t *rxBuffer, int32_t rxBufferSize )
+{
+    uint8_t status = FAIL;
+
+    if( rxBuffer[0] != '$' )
+    {
+        GpsMcuInvertPpsTrigger( );
+        return FAIL;
     }
-    else if ( strncmp( ( const char* )NmeaGpsData.NmeaDataType, ( const char* )NmeaDataTypeGPRMC, 5 ) == 0 )
+
+    for( int32_t i = 0; i < rxBufferSize; i++ )
     {
-        // NmeaUtcTime
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 11 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
+        if( GpsParseGpsChar( ( uint8_t )rxBuffer[i] ) == SUCCESS )
         {
-            NmeaGpsData.NmeaUtcTime[j] = rxBuffer[i];
+            status = SUCCESS;
         }
-        // NmeaDataStatus
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaDataStatus[j] = rxBuffer[i];
-        }
-        // NmeaLatitude
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 10 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLatitude[j] = rxBuffer[i];
-        }
-        // NmeaLatitudePole
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLatitudePole[j] = rxBuffer[i];
-        }
-        // NmeaLongitude
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 11 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLongitude[j] = rxBuffer[i];
-        }
-        // NmeaLongitudePole
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 2 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaLongitudePole[j] = rxBuffer[i];
-        }
-        // NmeaSpeed
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 8 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaSpeed[j] = rxBuffer[i];
-        }
-        // NmeaDetectionAngle
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
-        {
-            if( fieldSize > 8 )
-            {
-                return FAIL;
-            }
-        }
-        for( j = 0; j < fieldSize; j++, i++ )
-        {
-            NmeaGpsData.NmeaDetectionAngle[j] = rxBuffer[i];
-        }
-        // NmeaDate
-        fieldSize = 0;
-        while( rxBuffer[i + fieldSize++] != ',' )
+    }
+    return status;
+}
+
+void GpsResetPosition( void )
+{
+    Altitude = 0;
+    Latitude = 0;
+    Longitude = 0;
+    LatitudeBinary = 0;
+    LongitudeBinary = 0;
+}
+
+void GpsScheduleFix( uint32_t uplinkDelay )
+{
+    uint32_t lead = GpsPowerGetEstimate( ) + GPS_FIX_MARGIN;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( GpsPower.State != GPS_POWER_ACQUIRING )
+    {
+        if( uplinkDelay > lead )
         {
-            if( fieldSize > 8 )
-            {
-                return FAIL;
-            }
+            // Backup mode until the acquisition
+            GpsMcuStop( );
+            GpsPower.State = GPS_POWER_WAIT;
+            TimerSetValue( &GpsPower.Timer, uplinkDelay - lead );
+            TimerStart( &GpsPower.Timer );
         }
-        for( j = 0; j < fieldSize; j++, i++ )
+        else
         {
-            NmeaGpsData.NmeaDate[j] = rxBuffer[i];
+            TimerStop( &GpsPower.Timer );
+            GpsPowerStart( );
         }
-
-        GpsFormatGpsData( );
-        return SUCCESS;
-    }
-    else
-    {
-        return FAIL;
     }
+    CRITICAL_SECTION_END( );
 }
 
-void GpsFormatGpsData( void )
+void GpsCancelFix( void )
 {
-    if( strncmp( ( const char* )NmeaGpsData.NmeaDataType, ( const char* )NmeaDataTypeGPGGA, 5 ) == 0 )
+    CRITICAL_SECTION_BEGIN( );
+    if( GpsPower.State == GPS_POWER_ACQUIRING )
     {
-        HasFix = ( NmeaGpsData.NmeaFixQuality[0] > 0x30 ) ? true : false;
+        GpsPowerStop( false );
     }
-    else if ( strncmp( ( const char* )NmeaGpsData.NmeaDataType, ( const char* )NmeaDataTypeGPRMC, 5 ) == 0 )
+    else
     {
-        HasFix = ( NmeaGpsData.NmeaDataStatus[0] == 0x41 ) ? true : false;
+        TimerStop( &GpsPower.Timer );
+        GpsMcuStop( );
+        GpsPower.State = GPS_POWER_IDLE;
     }
-    GpsConvertPositionFromStringToNumerical( );
-    GpsConvertPositionIntoBinary( );
+    CRITICAL_SECTION_END( );
 }
 
-void GpsResetPosition( void )
+bool GpsIsFixPending( void )
 {
-    Altitude = ( int16_t )0xFFFF;
-    Latitude = 0;
-    Longitude = 0;
-    LatitudeBinary = 0;
-    LongitudeBinary = 0;
+    return GpsPower.State == GPS_POWER_ACQUIRING;
+}
+
+void GpsGetFixStats( GpsFixStats_t *stats )
+{
+    uint32_t acquisitions;
+
+    CRITICAL_SECTION_BEGIN( );
+    *stats = GpsPower.Stats;
+    acquisitions = GpsPower.Stats.FixCount;
+    stats->ChargePerFix = ( acquisitions > 0 ) ? ( uint32_t )( GpsPower.Charge / acquisitions ) : 0;
+    CRITICAL_SECTION_END( );
+    stats->TimeToFixEstimate = GpsPowerGetEstimate( );
+}
+
+void GpsSetRtcCalibration( bool enable )
+{
+    CRITICAL_SECTION_BEGIN( );
+    RtcCalibration.Enabled = enable;
+    RtcCalibration.Started = false;
+    CRITICAL_SECTION_END( );
+}
+
+int32_t GpsGetRtcCalibration( int32_t *errorPpb )
+{
+    int32_t correction;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( errorPpb != NULL )
+    {
+        *errorPpb = RtcCalibration.Error;
+    }
+    correction = RtcCalibration.Correction;
+    CRITICAL_SECTION_END( );
+    return correction;
 }
@@ -31,27 +31,41 @@ extern "C"
 #include <stdint.h>
 #include <stdbool.h>
 
-/* Structure to handle the GPS parsed data in ASCII */
-typedef struct
+/*!
+ * NMEA sentence types parsed, see GpsSetNmeaSentences
+ */
+#define GPS_NMEA_GGA                                0x01
+#define GPS_NMEA_RMC                                0x02
+
+/*!
+ * GPS fix statistics of the power manager, see GpsScheduleFix
+ */
+typedef struct sGpsFixStats
 {
-    char NmeaDataType[6];
-    char NmeaUtcTime[11];
-    char NmeaDataStatus[2];
-    char NmeaLatitude[10];
-    char NmeaLatitudePole[2];
-    char NmeaLongitude[11];
-    char NmeaLongitudePole[2];
-    char NmeaFixQuality[2];
-    char NmeaSatelliteTracked[3];
-    char NmeaHorizontalDilution[6];
-    char NmeaAltitude[8];
-    char NmeaAltitudeUnit[2];
-    char NmeaHeightGeoid[8];
-    char NmeaHeightGeoidUnit[2];
-    char NmeaSpeed[8];
-    char NmeaDetectionAngle[8];
-    char NmeaDate[8];
-}NmeaGpsData_t;
+    /*!
+     * Fixes obtained and acquisitions given up
+     */
+    uint32_t FixCount;
+    uint32_t TimeoutCount;
+    /*!
+     * Time to fix of the latest fix [ms]
+     */
+    uint32_t LastTimeToFix;
+    /*!
+     * Current time to fix estimate [ms]
+     */
+    uint32_t TimeToFixEstimate;
+    /*!
+     * Receiver ON time accumulated by the acquisitions [ms]
+     */
+    uint32_t OnTime;
+    /*!
+     * Charge consumed by the latest acquisition and average charge per fix,
+     * timeouts included [uC]
+     */
+    uint32_t LastFixCharge;
+    uint32_t ChargePerFix;
+}GpsFixStats_t;
 
 /*!
  * \brief Initializes the handling of the GPS receiver
@@ -98,12 +112,6 @@ bool GpsHasFix( void );
  */
 void GpsConvertPositionIntoBinary( void );
 
-/*!
- * \brief Converts the latest Position (latitude and Longitude) from ASCII into
- *        DMS numerical format
- */
-void GpsConvertPositionFromStringToNumerical( void );
-
 /*!
  * \brief Gets the latest Position (latitude and Longitude) as two double values
  *        if available
@@ -126,10 +134,47 @@ uint8_t GpsGetLatestGpsPositionDouble ( double *lati, double *longi );
  */
 uint8_t GpsGetLatestGpsPositionBinary ( int32_t *latiBin, int32_t *longiBin );
 
+/*!
+ * \brief Gets the latest Position (latitude and Longitude) and altitude as
+ *        fixed point values if available
+ *
+ * \param [OUT] lati     Latitude value [1e-7 degree]
+ * \param [OUT] longi    Longitude value [1e-7 degree]
+ * \param [OUT] altitude Altitude value [cm]
+ *
+ * \retval status [SUCCESS, FAIL]
+ */
+uint8_t GpsGetLatestGpsPositionFixed( int32_t *lati, int32_t *longi, int32_t *altitude );
+
+/*!
+ * \brief Selects the NMEA sentence types to parse
+ *
+ * \remark The other sentences are skipped at the end of their address field.
+ *         GGA and RMC are parsed by default.
+ *
+ * \param [IN] sentences Sentence types mask [GPS_NMEA_GGA, GPS_NMEA_RMC]
+ */
+void GpsSetNmeaSentences( uint8_t sentences );
+
+/*!
+ * \brief Feeds a character received from the GPS to the NMEA parser
+ *
+ * \remark The sentences are parsed as the characters are received, the
+ *         checksum is computed on the fly and the positions are extracted as
+ *         fixed point integers. The latest fix is updated when the checksum
+ *         of a selected sentence is valid. Any talker identifier is accepted.
+ *
+ * \param [IN] data Received character
+ *
+ * \retval status SUCCESS when the character ends a valid selected sentence,
+ *                FAIL otherwise
+ */
+uint8_t GpsParseGpsChar( uint8_t data );
+
 /*!
  * \brief Parses the NMEA sentence.
  *
- * \remark Only parses GPGGA and GPRMC sentences
+ * \remark Feeds the buffer to GpsParseGpsChar
  *
  * \param [IN] rxBuffer Data buffer to be parsed
  * \param [IN] rxBufferSize Size of data buffer
@@ -146,14 +191,65 @@ uint8_t GpsParseGpsData( int8_t *rxBuffer, int32_t rxBufferSize );
 int16_t GpsGetLatestGpsAltitude( void );
 
 /*!
- * \brief Format GPS data into numeric and binary formats
+ * \brief Resets the GPS position variables
  */
-void GpsFormatGpsData( void );
+void GpsResetPosition( void );
 
 /*!
- * \brief Resets the GPS position variables
+ * \brief Schedules a fix to be available at the next uplink
+ *
+ * \remark The receiver is kept in backup mode, retaining the ephemeris, and
+ *         switched ON the estimated time to fix before the uplink. It is
+ *         switched back OFF as soon as the fix is good enough, or when the
+ *         acquisition times out.
+ *         The estimate is the measured hot start time while the latest fix
+ *         is younger than GPS_EPHEMERIS_VALIDITY, the cold start time
+ *         otherwise.
+ *
+ * \param [IN] uplinkDelay Time until the next uplink [ms]
  */
-void GpsResetPosition( void );
+void GpsScheduleFix( uint32_t uplinkDelay );
+
+/*!
+ * \brief Cancels the scheduled or on going fix and switches the receiver OFF
+ */
+void GpsCancelFix( void );
+
+/*!
+ * \brief Indicates if the power manager acquires a fix
+ *
+ * \retval busy True while the receiver is ON for a scheduled fix
+ */
+bool GpsIsFixPending( void );
+
+/*!
+ * \brief Gets the power manager statistics
+ *
+ * \param [OUT] stats Fix statistics
+ */
+void GpsGetFixStats( GpsFixStats_t *stats );
+
+/*!
+ * \brief Enables the RTC calibration against the PPS signal
+ *
+ * \remark The RTC ticks are counted over GPS_PPS_CALIBRATION_PERIOD
+ *         consecutive PPS pulses. At the end of each period the measured
+ *         error is removed from the RTC frequency through RtcSetCalibration.
+ *         A missing or misplaced pulse restarts the period. The receiver
+ *         must be kept ON, the PPS is only output with a time solution.
+ *
+ * \param [IN] enable True to calibrate the RTC at each period
+ */
+void GpsSetRtcCalibration( bool enable );
+
+/*!
+ * \brief Gets the RTC calibration state
+ *
+ * \param [OUT] errorPpb RTC frequency error measured over the latest period,
+ *                       before its correction [ppb]
+ * \retval correctionPpb RTC frequency correction applied [ppb]
+ */
+int32_t GpsGetRtcCalibration( int32_t *errorPpb );
 
 #ifdef __cplusplus
 }
@@ -21,6 +21,7 @@
  * \author    Gregory Cristian ( Semtech )
  */
 #include <stdbool.h>
+#include <stddef.h>
 #include "utilities.h"
 #include "i2c-board.h"
 
@@ -29,6 +30,49 @@
  */
 static bool I2cInitialized = false;
 
+/*!
+ * Asynchronous transactions queue, the head is the transaction on the bus
+ */
+static I2cXfer_t *I2cXferHead = NULL;
+static I2cXfer_t *I2cXferTail = NULL;
+
+/*!
+ * Flag to indicate if the asynchronous transactions are being processed
+ */
+static volatile bool I2cXferBusy = false;
+
+/*!
+ * \brief Waits until the asynchronous transactions queue is empty
+ */
+static void I2cWaitIdle( void );
+
+/*!
+ * \brief Queues the transaction and starts the queue processing if idle
+ *
+ * \param [IN] xfer Filled transaction descriptor
+ */
+static void I2cXferQueue( I2cXfer_t *xfer );
+
+/*!
+ * \brief Starts the transaction at the queue head. The transactions failing
+ *        to start are completed right away.
+ */
+static void I2cXferProcess( void );
+
+/*!
+ * \brief Removes the queue head and calls its callback
+ *
+ * \param [IN] status Transaction status [SUCCESS, FAIL]
+ */
+static void I2cXferComplete( uint8_t status );
+
+/*!
+ * \brief MCU transaction completion callback
+ *
+ * \param [IN] status Transaction status [SUCCESS, FAIL]
+ */
+static void I2cOnXferDone( uint8_t status );
+
 void I2cInit( I2c_t *obj, I2cId_t i2cId, PinNames scl, PinNames sda )
 {
     if( I2cInitialized == false )
@@ -55,6 +99,7 @@ uint8_t I2cWrite( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t data )
 {
     if( I2cInitialized == true )
     {
+        I2cWaitIdle( );
         if( I2cMcuWriteBuffer( obj, deviceAddr, addr, &data, 1 ) == FAIL )
         {
             // if first attempt fails due to an IRQ, try a second time
@@ -82,6 +127,7 @@ uint8_t I2cWriteBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *
 {
     if( I2cInitialized == true )
     {
+        I2cWaitIdle( );
         if( I2cMcuWriteBuffer( obj, deviceAddr, addr, buffer, size ) == FAIL )
         {
             // if first attempt fails due to an IRQ, try a second time
@@ -109,6 +155,7 @@ uint8_t I2cRead( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *data )
 {
     if( I2cInitialized == true )
     {
+        I2cWaitIdle( );
         return( I2cMcuReadBuffer( obj, deviceAddr, addr, data, 1 ) );
     }
     else
@@ -121,6 +168,7 @@ uint8_t I2cReadBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *b
 {
     if( I2cInitialized == true )
     {
+        I2cWaitIdle( );
         return( I2cMcuReadBuffer( obj, deviceAddr, addr, buffer, size ) );
     }
     else
@@ -128,3 +176,145 @@ uint8_t I2cReadBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *b
         return FAIL;
     }
 }
+
+uint8_t I2cWriteBufferAsync( I2cXfer_t *xfer, I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size,
+                             I2cXferCallback_t callback, void *context )
+{
+    if( I2cInitialized == false )
+    {
+        return FAIL;
+    }
+    xfer->Obj = obj;
+    xfer->DeviceAddr = deviceAddr;
+    xfer->Addr = addr;
+    xfer->Buffer = buffer;
+    xfer->Size = size;
+    xfer->IsRead = false;
+    xfer->Callback = callback;
+    xfer->Context = context;
+    I2cXferQueue( xfer );
+    return SUCCESS;
+}
+
+uint8_t I2cReadBufferAsync( I2cXfer_t *xfer, I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size,
+                            I2cXferCallback_t callback, void *context )
+{
+    if( I2cInitialized == false )
+    {
+        return FAIL;
+    }
+    xfer->Obj = obj;
+    xfer->DeviceAddr = deviceAddr;
+    xfer->Addr = addr;
+    xfer->Buffer = buffer;
+    xfer->Size = size;
+    xfer->IsRead = true;
+    xfer->Callback = callback;
+    xfer->Context = context;
+    I2cXferQueue( xfer );
+    return SUCCESS;
+}
+
+bool I2cIsBusy( void )
+{
+    return I2cXferBusy;
+}
+
+static void I2cWaitIdle( void )
+{
+    while( I2cXferBusy == true )
+    {
+    }
+}
+
+static void I2cXferQueue( I2cXfer_t *xfer )
+{
+    bool start = false;
+
+    xfer->Next = NULL;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( I2cXferHead == NULL )
+    {
+        I2cXferHead = xfer;
+    }
+    else
+    {
+        I2cXferTail->Next = xfer;
+    }
+    I2cXferTail = xfer;
+
+    // When busy the transaction is started by the completion of the previous ones
+    if( I2cXferBusy == false )
+    {
+        I2cXferBusy = true;
+        start = true;
+    }
+    CRITICAL_SECTION_END( );
+
+    if( start == true )
+    {
+        I2cXferProcess( );
+    }
+}
+
+static void I2cXferProcess( void )
+{
+    while( 1 )
+    {
+        I2cXfer_t *xfer;
+        uint8_t status;
+
+        CRITICAL_SECTION_BEGIN( );
+        xfer = I2cXferHead;
+        if( xfer == NULL )
+        {
+            I2cXferBusy = false;
+        }
+        CRITICAL_SECTION_END( );
+
+        if( xfer == NULL )
+        {
+            return;
+        }
+
+        if( xfer->IsRead == true )
+        {
+            status = I2cMcuReadBufferIt( xfer->Obj, xfer->DeviceAddr, xfer->Addr, xfer->Buffer, xfer->Size, I2cOnXferDone );
+        }
+        else
+        {
+            status = I2cMcuWriteBufferIt( xfer->Obj, xfer->DeviceAddr, xfer->Addr, xfer->Buffer, xfer->Size, I2cOnXferDone );
+        }
+        if( status == SUCCESS )
+        {
+            return;
+        }
+        I2cXferComplete( FAIL );
+    }
+}
+
+static void I2cXferComplete( uint8_t status )
+{
+    I2cXfer_t *xfer;
+
+    CRITICAL_SECTION_BEGIN( );
+    xfer = I2cXferHead;
+    I2cXferHead = xfer->Next;
+    if( I2cXferHead == NULL )
+    {
+        I2cXferTail = NULL;
+    }
+    CRITICAL_SECTION_END( );
+
+    if( xfer->Callback != NULL )
+    {
+        xfer->Callback( xfer->Context, status );
+    }
+}
+
+static void I2cOnXferDone( uint8_t status )
+{
+    I2cXferComplete( status );
+    I2cXferProcess( );
+}
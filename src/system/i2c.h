@@ -28,6 +28,7 @@ extern "C"
 {
 #endif
 
+#include <stdbool.h>
 #include "gpio.h"
 
 /*!
@@ -49,6 +50,35 @@ typedef struct
     Gpio_t Sda;
 }I2c_t;
 
+/*!
+ * \brief Asynchronous transaction completion callback
+ *
+ * \remark Called in interrupt context. It may queue new asynchronous
+ *         transactions but must not call the blocking functions.
+ *
+ * \param [IN] context Context given when the transaction was queued
+ * \param [IN] status  Transaction status [SUCCESS, FAIL]
+ */
+typedef void ( *I2cXferCallback_t )( void *context, uint8_t status );
+
+/*!
+ * Asynchronous transaction descriptor
+ *
+ * \remark Owned by the caller, it must stay valid until the callback is called.
+ */
+typedef struct sI2cXfer
+{
+    struct sI2cXfer *Next;
+    I2c_t *Obj;
+    uint8_t DeviceAddr;
+    uint16_t Addr;
+    uint8_t *Buffer;
+    uint16_t Size;
+    bool IsRead;
+    I2cXferCallback_t Callback;
+    void *Context;
+}I2cXfer_t;
+
 /*!
  * \brief Initializes the I2C object and MCU peripheral
  *
@@ -114,6 +144,51 @@ uint8_t I2cRead( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *data );
  */
 uint8_t I2cReadBuffer( I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size );
 
+/*!
+ * \brief Queues a data buffer write to the I2C device
+ *
+ * \remark The transactions are run in order on the bus interrupts, the
+ *         blocking functions wait until the queue is empty.
+ *
+ * \param [IN] xfer             Transaction descriptor
+ * \param [IN] obj              I2C object
+ * \param [IN] deviceAddr       device address
+ * \param [IN] addr             data address
+ * \param [IN] buffer           data buffer to write
+ * \param [IN] size             number of bytes to write
+ * \param [IN] callback         completion callback
+ * \param [IN] context          callback context
+ * \retval status               [SUCCESS: queued, FAIL: I2C not initialized]
+ */
+uint8_t I2cWriteBufferAsync( I2cXfer_t *xfer, I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size,
+                             I2cXferCallback_t callback, void *context );
+
+/*!
+ * \brief Queues a data buffer read from the I2C device
+ *
+ * \remark The transactions are run in order on the bus interrupts, the
+ *         blocking functions wait until the queue is empty.
+ *
+ * \param [IN] xfer             Transaction descriptor
+ * \param [IN] obj              I2C object
+ * \param [IN] deviceAddr       device address
+ * \param [IN] addr             data address
+ * \param [OUT] buffer          data buffer to read
+ * \param [IN] size             number of data bytes to read
+ * \param [IN] callback         completion callback
+ * \param [IN] context          callback context
+ * \retval status               [SUCCESS: queued, FAIL: I2C not initialized]
+ */
+uint8_t I2cReadBufferAsync( I2cXfer_t *xfer, I2c_t *obj, uint8_t deviceAddr, uint16_t addr, uint8_t *buffer, uint16_t size,
+                            I2cXferCallback_t callback, void *context );
+
+/*!
+ * \brief Checks if asynchronous transactions are pending
+ *
+ * \retval busy                 [true: transactions pending, false: idle]
+ */
+bool I2cIsBusy( void );
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,178 @@
+/*!
+ * \file      log.c
+ *
+ * \brief     Leveled text log, optionally buffered and drained in the background
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdarg.h>
+#include "utilities.h"
+#include "fifo.h"
+#include "log.h"
+
+#if defined( LOG_BUFFERED_ENABLED )
+
+#if( ( LOG_BUFFER_SIZE & ( LOG_BUFFER_SIZE - 1 ) ) != 0 )
+#error "LOG_BUFFER_SIZE must be a power of 2"
+#endif
+
+static uint8_t LogBuffer[LOG_BUFFER_SIZE];
+
+static Fifo_t LogFifo;
+
+/*!
+ * Messages dropped since the last drop notice and since the initialization
+ */
+static volatile uint16_t LogLost = 0;
+static volatile uint32_t LogDropped = 0;
+
+static LogWrite_t LogWrite = NULL;
+
+/*!
+ * \brief Standard output, used when no output function is given
+ */
+static uint16_t LogWriteStdout( const uint8_t *buffer, uint16_t size )
+{
+    size = ( uint16_t )fwrite( buffer, 1, size, stdout );
+    fflush( stdout );
+    return size;
+}
+
+/*!
+ * \brief Pushes a whole message into the ring buffer
+ *
+ * \retval status true when the message fits
+ */
+static bool LogPush( const uint8_t *buffer, uint16_t size )
+{
+    bool status = false;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( ( LogFifo.Size - 1 - FifoGetCount( &LogFifo ) ) >= size )
+    {
+        FifoPushBuffer( &LogFifo, buffer, size );
+        status = true;
+    }
+    CRITICAL_SECTION_END( );
+    return status;
+}
+
+void LogInit( LogWrite_t write )
+{
+    LogWrite = ( write != NULL ) ? write : LogWriteStdout;
+    FifoInit( &LogFifo, LogBuffer, LOG_BUFFER_SIZE );
+    LogLost = 0;
+    LogDropped = 0;
+}
+
+void LogPrintf( const char *format, ... )
+{
+    char line[LOG_LINE_SIZE];
+    va_list args;
+    int size;
+
+    if( LogWrite == NULL )
+    {
+        LogInit( NULL );
+    }
+
+    va_start( args, format );
+    size = vsnprintf( line, sizeof( line ), format, args );
+    va_end( args );
+
+    if( size <= 0 )
+    {
+        return;
+    }
+    if( size >= ( int )sizeof( line ) )
+    {
+        size = sizeof( line ) - 1;
+    }
+
+    if( LogPush( ( uint8_t* )line, ( uint16_t )size ) == false )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        if( LogLost < UINT16_MAX )
+        {
+            LogLost++;
+        }
+        LogDropped++;
+        CRITICAL_SECTION_END( );
+    }
+}
+
+void LogProcess( void )
+{
+    uint8_t chunk[LOG_DRAIN_SIZE];
+    uint16_t size;
+    uint16_t count;
+
+    if( LogWrite == NULL )
+    {
+        return;
+    }
+
+    if( LogLost != 0 )
+    {
+        char notice[32];
+        uint16_t lost;
+
+        CRITICAL_SECTION_BEGIN( );
+        lost = LogLost;
+        CRITICAL_SECTION_END( );
+
+        size = ( uint16_t )snprintf( notice, sizeof( notice ), "\r\n### %u log messages lost\r\n", lost );
+        if( LogPush( ( uint8_t* )notice, size ) == true )
+        {
+            CRITICAL_SECTION_BEGIN( );
+            LogLost -= lost;
+            CRITICAL_SECTION_END( );
+        }
+    }
+
+    CRITICAL_SECTION_BEGIN( );
+    size = FifoGetCount( &LogFifo );
+    if( size > sizeof( chunk ) )
+    {
+        size = sizeof( chunk );
+    }
+    // Peek only, the bytes are released once the output accepted them
+    for( uint16_t i = 0; i < size; i++ )
+    {
+        chunk[i] = LogFifo.Data[( LogFifo.Begin + 1 + i ) & LogFifo.Mask];
+    }
+    CRITICAL_SECTION_END( );
+
+    if( size == 0 )
+    {
+        return;
+    }
+
+    count = LogWrite( chunk, size );
+    if( count > 0 )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        LogFifo.Begin = ( LogFifo.Begin + count ) & LogFifo.Mask;
+        CRITICAL_SECTION_END( );
+    }
+}
+
+uint32_t LogGetDroppedCount( void )
+{
+    return LogDropped;
+}
+
+#endif
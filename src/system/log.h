@@ -0,0 +1,145 @@
+/*!
+ * \file      log.h
+ *
+ * \brief     Leveled text log, optionally buffered and drained in the background
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+#include <stdio.h>
+
+/*!
+ * Log levels. The messages above LOG_LEVEL are compiled out, formatting
+ * included.
+ */
+#define LOG_LEVEL_NONE                              0
+#define LOG_LEVEL_ERROR                             1
+#define LOG_LEVEL_WARNING                           2
+#define LOG_LEVEL_INFO                              3
+#define LOG_LEVEL_DEBUG                             4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL                                   LOG_LEVEL_DEBUG
+#endif
+
+/*!
+ * Size of the buffered log ring buffer in bytes. Must be a power of 2.
+ */
+#ifndef LOG_BUFFER_SIZE
+#define LOG_BUFFER_SIZE                             1024
+#endif
+
+/*!
+ * Longest formatted message, the longer ones are truncated
+ */
+#ifndef LOG_LINE_SIZE
+#define LOG_LINE_SIZE                               128
+#endif
+
+/*!
+ * Maximum number of bytes handed to the output by one \ref LogProcess call
+ */
+#ifndef LOG_DRAIN_SIZE
+#define LOG_DRAIN_SIZE                              64
+#endif
+
+/*!
+ * Log output function
+ *
+ * \param [IN] buffer Data to be written
+ * \param [IN] size   Number of bytes to be written
+ * \retval count      Number of bytes accepted, 0 to retry later
+ */
+typedef uint16_t ( *LogWrite_t )( const uint8_t *buffer, uint16_t size );
+
+#if defined( LOG_BUFFERED_ENABLED )
+
+/*!
+ * Initializes the buffered log
+ *
+ * \param [IN] write Output function used by \ref LogProcess. NULL selects
+ *                   the standard output.
+ */
+void LogInit( LogWrite_t write );
+
+/*!
+ * Formats a message into the ring buffer. Never blocks, the message is
+ * dropped and counted when the buffer is full.
+ *
+ * \param [IN] format printf format
+ */
+void LogPrintf( const char *format, ... ) __attribute__( ( format( printf, 1, 2 ) ) );
+
+/*!
+ * Writes the buffered messages to the output. To be called from the main loop.
+ */
+void LogProcess( void );
+
+/*!
+ * Returns the number of messages dropped since the initialization
+ *
+ * \retval count Dropped messages
+ */
+uint32_t LogGetDroppedCount( void );
+
+#define LOG_PRINTF( ... )                           LogPrintf( __VA_ARGS__ )
+
+#else
+
+#define LogInit( write )
+#define LogProcess( )
+#define LogGetDroppedCount( )                       0
+#define LOG_PRINTF( ... )                           printf( __VA_ARGS__ )
+
+#endif
+
+#if ( LOG_LEVEL >= LOG_LEVEL_ERROR )
+#define LOG_ERROR( ... )                            LOG_PRINTF( __VA_ARGS__ )
+#else
+#define LOG_ERROR( ... )                            do{ }while( 0 )
+#endif
+
+#if ( LOG_LEVEL >= LOG_LEVEL_WARNING )
+#define LOG_WARNING( ... )                          LOG_PRINTF( __VA_ARGS__ )
+#else
+#define LOG_WARNING( ... )                          do{ }while( 0 )
+#endif
+
+#if ( LOG_LEVEL >= LOG_LEVEL_INFO )
+#define LOG_INFO( ... )                             LOG_PRINTF( __VA_ARGS__ )
+#else
+#define LOG_INFO( ... )                             do{ }while( 0 )
+#endif
+
+#if ( LOG_LEVEL >= LOG_LEVEL_DEBUG )
+#define LOG_DEBUG( ... )                            LOG_PRINTF( __VA_ARGS__ )
+#else
+#define LOG_DEBUG( ... )                            do{ }while( 0 )
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __LOG_H__
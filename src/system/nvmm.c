@@ -19,13 +19,694 @@ Maintainer: Miguel Luis ( Semtech ), Gregory Cristian ( Semtech ),
             Daniel Jaeckle ( STACKFORCE ),  Johannes Bruder ( STACKFORCE )
 */
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #include "utilities.h"
+#include "crc.h"
 #include "eeprom.h"
 #include "nvmm.h"
 
-#define NVMM_MAGIC_NUMBER                   0xA23
+/*!
+ * Size of the stack buffer used to read back the data blocks
+ */
+#define NVMM_READ_CHUNK_SIZE                32
+
+/*!
+ * Maximum number of data blocks staged by a transaction
+ */
+#ifndef NVMM_TRANSACTION_MAX_BLOCKS
+#define NVMM_TRANSACTION_MAX_BLOCKS         8
+#endif
+
+typedef struct sTransactionEntry
+{
+    /*
+     * Staged data block
+     */
+    NvmmDataBlock_t* DataB;
+    /*
+     * Data to be stored, referenced until the commit
+     */
+    uint8_t* Src;
+    size_t Num;
+} TransactionEntry_t;
+
+static TransactionEntry_t TransactionEntries[NVMM_TRANSACTION_MAX_BLOCKS];
+
+static uint8_t TransactionEntryCnt = 0;
+
+static bool TransactionIsStarted = false;
+
+/*!
+ * Ends the current transaction
+ */
+static void TransactionEnd( void )
+{
+    TransactionEntryCnt = 0;
+    TransactionIsStarted = false;
+}
+
+static uint32_t ComputeCrc32UpdateNvm( uint32_t crc, uint16_t addr, uint16_t size )
+{
+    uint8_t data[NVMM_READ_CHUNK_SIZE];
+    uint16_t chunk = 0;
+
+    // Read the data block back in chunks instead of byte by byte
+    while( size > 0 )
+    {
+        chunk = ( size > NVMM_READ_CHUNK_SIZE ) ? NVMM_READ_CHUNK_SIZE : size;
+        EepromReadBuffer( addr, data, chunk );
+        crc = Crc32Update( crc, data, chunk );
+        addr += chunk;
+        size -= chunk;
+    }
+    return crc;
+}
+
+#if defined( NVMM_JOURNAL_ENABLED )
+
+/*
+ * Journal backend
+ *
+ * The journal region is split in two halves. The data blocks are appended as
+ * records into the active half, the record with the highest sequence number
+ * of a data block holds its current content. When the active half is full, the
+ * current records are copied into the other half, which becomes active.
+ *
+ * The trailing zero bytes of the data are not appended, a record shorter than
+ * its data block reads back with zeros at its end.
+ *
+ * A transaction is appended as a single group record. Its data holds an entry
+ * header followed by the data of each changed data block, the record CRC
+ * covers them all: either all the data blocks or none are updated.
+ */
+
+/*!
+ * Start address of the journal region
+ */
+#ifndef NVMM_JOURNAL_START
+#define NVMM_JOURNAL_START                  0
+#endif
+
+/*!
+ * Size of the journal region. Each half must be able to hold one record of
+ * every declared data block.
+ */
+#ifndef NVMM_JOURNAL_SIZE
+#define NVMM_JOURNAL_SIZE                   2048
+#endif
+
+/*!
+ * Maximum number of data blocks which can be declared, up to 32
+ */
+#ifndef NVMM_JOURNAL_MAX_BLOCKS
+#define NVMM_JOURNAL_MAX_BLOCKS             8
+#endif
+
+/*!
+ * Size of a journal half
+ */
+#define NVMM_JOURNAL_HALF_SIZE              ( NVMM_JOURNAL_SIZE / 2 )
+
+/*!
+ * Records alignment
+ */
+#define NVMM_JOURNAL_ALIGN                  4
+
+/*!
+ * Journal record magic number
+ */
+#define NVMM_JOURNAL_MAGIC                  0x4E56
+
+/*!
+ * Data block without a valid record
+ */
+#define NVMM_JOURNAL_NO_RECORD              0xFFFF
+
+/*!
+ * Identifier of the group records, written by NvmmTransactionCommit
+ */
+#define NVMM_JOURNAL_GROUP_ID               0xFF
+
+typedef struct sJournalRecordHeader
+{
+    /*
+     * Magic number
+     */
+    uint16_t Magic;
+    /*
+     * Size of the record data
+     */
+    uint16_t Size;
+    /*
+     * Record sequence number
+     */
+    uint32_t Seq;
+    /*
+     * Data block identifier
+     */
+    uint8_t Id;
+    uint8_t Reserved[3];
+    /*
+     * CRC32 of the header fields above and of the record data
+     */
+    uint32_t Crc;
+} JournalRecordHeader_t;
+
+typedef struct sJournalGroupEntry
+{
+    /*
+     * Data block identifier
+     */
+    uint8_t Id;
+    uint8_t Reserved;
+    /*
+     * Size of the data block data following the entry
+     */
+    uint16_t Size;
+} JournalGroupEntry_t;
+
+typedef struct sJournalBlock
+{
+    /*
+     * Address of the current data relative to the journal start
+     */
+    uint16_t Addr;
+    /*
+     * Size of the current record data
+     */
+    uint16_t Size;
+    /*
+     * Sequence number of the current record
+     */
+    uint32_t Seq;
+    /*
+     * Declared data block size
+     */
+    uint16_t MaxSize;
+} JournalBlock_t;
+
+static JournalBlock_t JournalBlocks[NVMM_JOURNAL_MAX_BLOCKS];
+
+static uint8_t JournalBlockCnt = 0;
+
+static bool JournalIsScanned = false;
+
+/*!
+ * Write head relative to the journal start
+ */
+static uint16_t JournalHead = 0;
+
+/*!
+ * End of the active half relative to the journal start
+ */
+static uint16_t JournalHalfEnd = NVMM_JOURNAL_HALF_SIZE;
+
+/*!
+ * Sequence number of the next record
+ */
+static uint32_t JournalSeq = 0;
+
+static uint16_t JournalRecordLength( uint16_t size )
+{
+    return ( sizeof( JournalRecordHeader_t ) + size + NVMM_JOURNAL_ALIGN - 1 ) & ~( NVMM_JOURNAL_ALIGN - 1 );
+}
+
+static uint32_t JournalHeaderCrc( JournalRecordHeader_t* hdr )
+{
+    return Crc32Update( 0xFFFFFFFF, ( uint8_t* ) hdr, offsetof( JournalRecordHeader_t, Crc ) );
+}
+
+static bool JournalIsInActiveHalf( uint16_t addr )
+{
+    return ( addr < JournalHalfEnd ) && ( addr >= ( JournalHalfEnd - NVMM_JOURNAL_HALF_SIZE ) );
+}
+
+/*!
+ * Gets the data size without its trailing zero bytes
+ */
+static uint16_t JournalTrimSize( uint8_t* src, size_t num )
+{
+    while( ( num > 0 ) && ( src[num - 1] == 0 ) )
+    {
+        num--;
+    }
+    return num;
+}
+
+/*!
+ * Checks if the current data of the given data block already is src
+ */
+static bool JournalIsUnchanged( JournalBlock_t* block, uint8_t* src, uint16_t num )
+{
+    uint8_t data[NVMM_READ_CHUNK_SIZE];
+    uint16_t chunk = 0;
+    uint16_t offset = 0;
+
+    if( ( block->Addr == NVMM_JOURNAL_NO_RECORD ) || ( block->Size != num ) )
+    {
+        return false;
+    }
+    while( offset < num )
+    {
+        chunk = ( ( num - offset ) > NVMM_READ_CHUNK_SIZE ) ? NVMM_READ_CHUNK_SIZE : ( num - offset );
+        EepromReadBuffer( NVMM_JOURNAL_START + block->Addr + offset, data, chunk );
+        for( uint16_t i = 0; i < chunk; i++ )
+        {
+            if( data[i] != src[offset + i] )
+            {
+                return false;
+            }
+        }
+        offset += chunk;
+    }
+    return true;
+}
+
+/*!
+ * Makes the given data the current one of a data block, if more recent
+ */
+static void JournalIndexData( uint8_t id, uint16_t addr, uint16_t size, uint32_t seq )
+{
+    if( ( JournalBlocks[id].Addr == NVMM_JOURNAL_NO_RECORD ) ||
+        ( ( int32_t )( seq - JournalBlocks[id].Seq ) > 0 ) )
+    {
+        JournalBlocks[id].Addr = addr;
+        JournalBlocks[id].Size = size;
+        JournalBlocks[id].Seq = seq;
+    }
+}
+
+/*!
+ * Copies the current record of the given data block at the write head
+ */
+static void JournalCopyRecord( uint8_t id )
+{
+    JournalBlock_t* block = &JournalBlocks[id];
+    JournalRecordHeader_t hdr;
+    uint8_t data[NVMM_READ_CHUNK_SIZE];
+    uint16_t chunk = 0;
+    uint16_t offset = 0;
+
+    memset1( ( uint8_t* ) &hdr, 0, sizeof( JournalRecordHeader_t ) );
+    hdr.Magic = NVMM_JOURNAL_MAGIC;
+    hdr.Size = block->Size;
+    hdr.Seq = JournalSeq;
+    hdr.Id = id;
+    hdr.Crc = JournalHeaderCrc( &hdr );
+
+    // Copy the data first, the header validates the record once complete
+    while( offset < block->Size )
+    {
+        chunk = ( ( block->Size - offset ) > NVMM_READ_CHUNK_SIZE ) ? NVMM_READ_CHUNK_SIZE : ( block->Size - offset );
+        EepromReadBuffer( NVMM_JOURNAL_START + block->Addr + offset, data, chunk );
+        EepromWriteBuffer( NVMM_JOURNAL_START + JournalHead + sizeof( JournalRecordHeader_t ) + offset, data, chunk );
+        hdr.Crc = Crc32Update( hdr.Crc, data, chunk );
+        offset += chunk;
+    }
+    hdr.Crc ^= 0xFFFFFFFF;
+    EepromWriteBuffer( NVMM_JOURNAL_START + JournalHead, ( uint8_t* ) &hdr, sizeof( JournalRecordHeader_t ) );
+
+    block->Addr = JournalHead + sizeof( JournalRecordHeader_t );
+    block->Seq = JournalSeq;
+    JournalSeq++;
+    JournalHead += JournalRecordLength( block->Size );
+}
+
+/*!
+ * Copies the current records into the other half and makes it active
+ *
+ * \param [IN] skipMask Bit mask of the data blocks which are about to be
+ *                      written, not copied
+ */
+static void JournalCollect( uint32_t skipMask )
+{
+    JournalHalfEnd = ( JournalHalfEnd == NVMM_JOURNAL_HALF_SIZE ) ? NVMM_JOURNAL_SIZE : NVMM_JOURNAL_HALF_SIZE;
+    JournalHead = JournalHalfEnd - NVMM_JOURNAL_HALF_SIZE;
+
+    for( uint8_t i = 0; i < NVMM_JOURNAL_MAX_BLOCKS; i++ )
+    {
+        if( ( ( skipMask & ( 1UL << i ) ) == 0 ) && ( JournalBlocks[i].Addr != NVMM_JOURNAL_NO_RECORD ) )
+        {
+            JournalCopyRecord( i );
+        }
+    }
+}
+
+/*!
+ * Rebuilds the data blocks index and the write head from the journal content
+ */
+static void JournalScan( void )
+{
+    JournalRecordHeader_t hdr;
+    JournalGroupEntry_t entry;
+    uint16_t addr = 0;
+    uint16_t entryAddr = 0;
+    uint16_t halfEnd = NVMM_JOURNAL_HALF_SIZE;
+    uint32_t crc = 0;
+    bool found = false;
+
+    for( uint8_t i = 0; i < NVMM_JOURNAL_MAX_BLOCKS; i++ )
+    {
+        JournalBlocks[i].Addr = NVMM_JOURNAL_NO_RECORD;
+    }
+
+    while( addr < NVMM_JOURNAL_SIZE )
+    {
+        halfEnd = ( addr < NVMM_JOURNAL_HALF_SIZE ) ? NVMM_JOURNAL_HALF_SIZE : NVMM_JOURNAL_SIZE;
+        if( ( addr + sizeof( JournalRecordHeader_t ) ) > halfEnd )
+        {
+            addr = halfEnd;
+            continue;
+        }
+
+        EepromReadBuffer( NVMM_JOURNAL_START + addr, ( uint8_t* ) &hdr, sizeof( JournalRecordHeader_t ) );
+
+        if( ( hdr.Magic != NVMM_JOURNAL_MAGIC ) ||
+            ( ( hdr.Id >= NVMM_JOURNAL_MAX_BLOCKS ) && ( hdr.Id != NVMM_JOURNAL_GROUP_ID ) ) ||
+            ( JournalRecordLength( hdr.Size ) > ( halfEnd - addr ) ) )
+        {
+            addr += NVMM_JOURNAL_ALIGN;
+            continue;
+        }
+
+        crc = ComputeCrc32UpdateNvm( JournalHeaderCrc( &hdr ), NVMM_JOURNAL_START + addr + sizeof( JournalRecordHeader_t ), hdr.Size ) ^ 0xFFFFFFFF;
+        if( crc != hdr.Crc )
+        {
+            addr += NVMM_JOURNAL_ALIGN;
+            continue;
+        }
+
+        if( hdr.Id != NVMM_JOURNAL_GROUP_ID )
+        {
+            JournalIndexData( hdr.Id, addr + sizeof( JournalRecordHeader_t ), hdr.Size, hdr.Seq );
+        }
+        else
+        {
+            // All the entries share the record sequence number
+            entryAddr = addr + sizeof( JournalRecordHeader_t );
+            while( ( entryAddr + sizeof( JournalGroupEntry_t ) ) <= ( addr + sizeof( JournalRecordHeader_t ) + hdr.Size ) )
+            {
+                EepromReadBuffer( NVMM_JOURNAL_START + entryAddr, ( uint8_t* ) &entry, sizeof( JournalGroupEntry_t ) );
+                entryAddr += sizeof( JournalGroupEntry_t );
+                if( ( entry.Id >= NVMM_JOURNAL_MAX_BLOCKS ) ||
+                    ( ( entryAddr + entry.Size ) > ( addr + sizeof( JournalRecordHeader_t ) + hdr.Size ) ) )
+                {
+                    break;
+                }
+                JournalIndexData( entry.Id, entryAddr, entry.Size, hdr.Seq );
+                entryAddr += entry.Size;
+            }
+        }
+
+        // The most recent record tells where the journal continues
+        if( ( found == false ) || ( ( int32_t )( hdr.Seq - JournalSeq ) >= 0 ) )
+        {
+            found = true;
+            JournalSeq = hdr.Seq + 1;
+            JournalHead = addr + JournalRecordLength( hdr.Size );
+            JournalHalfEnd = halfEnd;
+        }
+        addr += JournalRecordLength( hdr.Size );
+    }
+
+    // Complete an interrupted collection before the other half gets reused
+    for( uint8_t i = 0; i < NVMM_JOURNAL_MAX_BLOCKS; i++ )
+    {
+        if( ( JournalBlocks[i].Addr != NVMM_JOURNAL_NO_RECORD ) &&
+            ( JournalIsInActiveHalf( JournalBlocks[i].Addr ) == false ) )
+        {
+            JournalCopyRecord( i );
+        }
+    }
+    JournalIsScanned = true;
+}
+
+/*
+ * API functions
+ */
+
+NvmmStatus_t NvmmDeclare( NvmmDataBlock_t* dataB, size_t num )
+{
+    uint32_t length = 0;
+
+    if( JournalIsScanned == false )
+    {
+        JournalScan( );
+    }
+
+    if( ( JournalBlockCnt >= NVMM_JOURNAL_MAX_BLOCKS ) || ( num > NVMM_JOURNAL_HALF_SIZE ) )
+    {
+        return NVMM_ERROR_SIZE;
+    }
+
+    // A half must be able to hold the current records of all data blocks
+    length = JournalRecordLength( num );
+    for( uint8_t i = 0; i < JournalBlockCnt; i++ )
+    {
+        length += JournalRecordLength( JournalBlocks[i].MaxSize );
+    }
+    if( length > NVMM_JOURNAL_HALF_SIZE )
+    {
+        return NVMM_ERROR_SIZE;
+    }
+
+    dataB->virtualAddr = JournalBlockCnt;
+    JournalBlocks[JournalBlockCnt].MaxSize = num;
+    JournalBlockCnt++;
+
+    return NvmmVerify( dataB, num );
+}
+
+NvmmStatus_t NvmmVerify( NvmmDataBlock_t* dataB, size_t num )
+{
+    JournalBlock_t* block = &JournalBlocks[dataB->virtualAddr];
+
+    // Records are only indexed once their CRC has been checked
+    if( ( block->Addr == NVMM_JOURNAL_NO_RECORD ) || ( block->Size > num ) )
+    {
+        return NVMM_FAIL_CHECKSUM;
+    }
+    return NVMM_SUCCESS;
+}
+
+NvmmStatus_t NvmmWrite( NvmmDataBlock_t* dataB, void* src, size_t num )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    JournalBlock_t* block = &JournalBlocks[dataB->virtualAddr];
+    JournalRecordHeader_t hdr;
+
+    if( num > block->MaxSize )
+    {
+        CRITICAL_SECTION_END( );
+        return NVMM_ERROR_SIZE;
+    }
+
+    // The trailing zero bytes are read back without being stored
+    num = JournalTrimSize( ( uint8_t* ) src, num );
+
+    // Nothing to append if the current record already holds this content
+    if( JournalIsUnchanged( block, ( uint8_t* ) src, num ) == true )
+    {
+        CRITICAL_SECTION_END( );
+        return NVMM_SUCCESS;
+    }
+
+    if( ( JournalHead + JournalRecordLength( num ) ) > JournalHalfEnd )
+    {
+        JournalCollect( 1UL << dataB->virtualAddr );
+    }
+
+    memset1( ( uint8_t* ) &hdr, 0, sizeof( JournalRecordHeader_t ) );
+    hdr.Magic = NVMM_JOURNAL_MAGIC;
+    hdr.Size = num;
+    hdr.Seq = JournalSeq;
+    hdr.Id = dataB->virtualAddr;
+    hdr.Crc = Crc32Update( JournalHeaderCrc( &hdr ), ( uint8_t* ) src, num ) ^ 0xFFFFFFFF;
+
+    // The previous record stays current until the new one is complete
+    EepromWriteBuffer( NVMM_JOURNAL_START + JournalHead + sizeof( JournalRecordHeader_t ), ( uint8_t* ) src, num );
+    EepromWriteBuffer( NVMM_JOURNAL_START + JournalHead, ( uint8_t* ) &hdr, sizeof( JournalRecordHeader_t ) );
+
+    block->Addr = JournalHead + sizeof( JournalRecordHeader_t );
+    block->Size = num;
+    block->Seq = JournalSeq;
+    JournalSeq++;
+    JournalHead += JournalRecordLength( num );
+
+    CRITICAL_SECTION_END( );
+
+    return NVMM_SUCCESS;
+}
+
+NvmmStatus_t NvmmWriteRange( NvmmDataBlock_t* dataB, void* src, size_t num, size_t offset, size_t size )
+{
+    if( ( offset > num ) || ( size > ( num - offset ) ) )
+    {
+        return NVMM_ERROR_SIZE;
+    }
+    // Records are always appended as a whole
+    return NvmmWrite( dataB, src, num );
+}
+
+NvmmStatus_t NvmmRead( NvmmDataBlock_t* dataB, void* dst, size_t num )
+{
+    CRITICAL_SECTION_BEGIN( );
+
+    JournalBlock_t* block = &JournalBlocks[dataB->virtualAddr];
+
+    if( ( block->Addr == NVMM_JOURNAL_NO_RECORD ) || ( num > block->MaxSize ) )
+    {
+        CRITICAL_SECTION_END( );
+        return NVMM_ERROR_SIZE;
+    }
+
+    EepromReadBuffer( NVMM_JOURNAL_START + block->Addr, ( uint8_t* ) dst, MIN( num, block->Size ) );
+    if( num > block->Size )
+    {
+        memset1( ( uint8_t* ) dst + block->Size, 0, num - block->Size );
+    }
+
+    CRITICAL_SECTION_END( );
+
+    return NVMM_SUCCESS;
+}
+
+NvmmStatus_t NvmmRestore( NvmmDataBlock_t* dataB, void* dst, size_t num )
+{
+    // The journal scan already checked the records CRC
+    if( NvmmDeclare( dataB, num ) != NVMM_SUCCESS )
+    {
+        return NVMM_FAIL_CHECKSUM;
+    }
+    return NvmmRead( dataB, dst, num );
+}
+
+bool NvmmCollect( void )
+{
+    bool collected = false;
+    uint16_t length = 0;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    for( uint8_t i = 0; i < JournalBlockCnt; i++ )
+    {
+        length += JournalRecordLength( JournalBlocks[i].MaxSize );
+    }
+    // Collect ahead of time when the next writes could run out of space
+    if( ( JournalIsScanned == true ) && ( ( JournalHalfEnd - JournalHead ) < length ) )
+    {
+        JournalCollect( 0 );
+        collected = true;
+    }
+
+    CRITICAL_SECTION_END( );
+
+    return collected;
+}
+
+NvmmStatus_t NvmmTransactionCommit( void )
+{
+    JournalRecordHeader_t hdr;
+    JournalGroupEntry_t entry;
+    uint16_t nums[NVMM_TRANSACTION_MAX_BLOCKS];
+    uint32_t changedMask = 0;
+    uint16_t size = 0;
+    uint16_t addr = 0;
+    uint8_t id = 0;
+
+    CRITICAL_SECTION_BEGIN( );
+
+    if( TransactionIsStarted == false )
+    {
+        CRITICAL_SECTION_END( );
+        return NVMM_ERROR;
+    }
+
+    // Only the changed data blocks are part of the record
+    for( uint8_t i = 0; i < TransactionEntryCnt; i++ )
+    {
+        id = TransactionEntries[i].DataB->virtualAddr;
+        if( TransactionEntries[i].Num > JournalBlocks[id].MaxSize )
+        {
+            TransactionEnd( );
+            CRITICAL_SECTION_END( );
+            return NVMM_ERROR_SIZE;
+        }
+        nums[i] = JournalTrimSize( TransactionEntries[i].Src, TransactionEntries[i].Num );
+        if( JournalIsUnchanged( &JournalBlocks[id], TransactionEntries[i].Src, nums[i] ) == false )
+        {
+            changedMask |= 1UL << id;
+            size += sizeof( JournalGroupEntry_t ) + nums[i];
+        }
+    }
+    if( changedMask == 0 )
+    {
+        TransactionEnd( );
+        CRITICAL_SECTION_END( );
+        return NVMM_SUCCESS;
+    }
+
+    if( ( JournalHead + JournalRecordLength( size ) ) > JournalHalfEnd )
+    {
+        JournalCollect( changedMask );
+    }
+
+    memset1( ( uint8_t* ) &hdr, 0, sizeof( JournalRecordHeader_t ) );
+    hdr.Magic = NVMM_JOURNAL_MAGIC;
+    hdr.Size = size;
+    hdr.Seq = JournalSeq;
+    hdr.Id = NVMM_JOURNAL_GROUP_ID;
+    hdr.Crc = JournalHeaderCrc( &hdr );
+
+    // One pass over the entries for the data and the CRC. The previous records
+    // stay current until the header validates the whole group.
+    addr = JournalHead + sizeof( JournalRecordHeader_t );
+    for( uint8_t i = 0; i < TransactionEntryCnt; i++ )
+    {
+        id = TransactionEntries[i].DataB->virtualAddr;
+        if( ( changedMask & ( 1UL << id ) ) == 0 )
+        {
+            continue;
+        }
+        entry.Id = id;
+        entry.Reserved = 0;
+        entry.Size = nums[i];
+        EepromWriteBuffer( NVMM_JOURNAL_START + addr, ( uint8_t* ) &entry, sizeof( JournalGroupEntry_t ) );
+        EepromWriteBuffer( NVMM_JOURNAL_START + addr + sizeof( JournalGroupEntry_t ), TransactionEntries[i].Src, nums[i] );
+        hdr.Crc = Crc32Update( hdr.Crc, ( uint8_t* ) &entry, sizeof( JournalGroupEntry_t ) );
+        hdr.Crc = Crc32Update( hdr.Crc, TransactionEntries[i].Src, nums[i] );
+        addr += sizeof( JournalGroupEntry_t ) + nums[i];
+    }
+    hdr.Crc ^= 0xFFFFFFFF;
+    EepromWriteBuffer( NVMM_JOURNAL_START + JournalHead, ( uint8_t* ) &hdr, sizeof( JournalRecordHeader_t ) );
+
+    addr = JournalHead + sizeof( JournalRecordHeader_t );
+    for( uint8_t i = 0; i < TransactionEntryCnt; i++ )
+    {
+        id = TransactionEntries[i].DataB->virtualAddr;
+        if( ( changedMask & ( 1UL << id ) ) == 0 )
+        {
+            continue;
+        }
+        JournalBlocks[id].Addr = addr + sizeof( JournalGroupEntry_t );
+        JournalBlocks[id].Size = nums[i];
+        JournalBlocks[id].Seq = JournalSeq;
+        addr += sizeof( JournalGroupEntry_t ) + nums[i];
+    }
+    JournalSeq++;
+    JournalHead += JournalRecordLength( size );
+
+    TransactionEnd( );
+    CRITICAL_SECTION_END( );
+
+    return NVMM_SUCCESS;
+}
+
+#else
 
 typedef struct sDataBlockHeader
 {
@@ -43,26 +724,49 @@ static uint16_t DataBlockAdrCnt = sizeof( DataBlockHeader_t );
 
 static uint32_t ComputeChecksum( uint8_t* data, uint16_t size )
 {
-    uint32_t checksum = NVMM_MAGIC_NUMBER; // Start with a magic number
-
-    for( uint16_t i = 0; i < size; i++ )
-    {
-        checksum += data[i];
-    }
-    return checksum;
+    return Crc32Update( 0xFFFFFFFF, data, size ) ^ 0xFFFFFFFF;
 }
 
 static uint32_t ComputeChecksumNvm( uint16_t addr, uint16_t size )
 {
-    uint32_t checksum = NVMM_MAGIC_NUMBER; // Start with a magic number
-    uint8_t data = 0;
+    return ComputeCrc32UpdateNvm( 0xFFFFFFFF, addr, size ) ^ 0xFFFFFFFF;
+}
 
-    for( uint16_t i = 0; i < size; i++ )
+/*!
+ * Programs only the bytes of the given buffer which differ from the stored ones
+ */
+static void WriteDifferences( uint16_t addr, uint8_t* src, uint16_t size )
+{
+    uint8_t data[NVMM_READ_CHUNK_SIZE];
+    uint16_t chunk = 0;
+    uint16_t i = 0;
+    uint16_t start = 0;
+
+    while( size > 0 )
     {
-        EepromReadBuffer( addr + i, &data, 1 );
-        checksum += data;
+        chunk = ( size > NVMM_READ_CHUNK_SIZE ) ? NVMM_READ_CHUNK_SIZE : size;
+        EepromReadBuffer( addr, data, chunk );
+
+        i = 0;
+        while( i < chunk )
+        {
+            if( data[i] == src[i] )
+            {
+                i++;
+                continue;
+            }
+            // Program the whole run of differing bytes at once
+            start = i;
+            while( ( i < chunk ) && ( data[i] != src[i] ) )
+            {
+                i++;
+            }
+            EepromWriteBuffer( addr + start, src + start, i - start );
+        }
+        addr += chunk;
+        src += chunk;
+        size -= chunk;
     }
-    return checksum;
 }
 
 /*
@@ -122,27 +826,37 @@ NvmmStatus_t NvmmVerify( NvmmDataBlock_t* dataB, size_t num )
 
 
 NvmmStatus_t NvmmWrite( NvmmDataBlock_t* dataB, void* src, size_t num )
+{
+    return NvmmWriteRange( dataB, src, num, 0, num );
+}
+
+NvmmStatus_t NvmmWriteRange( NvmmDataBlock_t* dataB, void* src, size_t num, size_t offset, size_t size )
 {
     CRITICAL_SECTION_BEGIN( );
 
     DataBlockHeader_t dataBHdr;
+    size_t cSum = 0;
 
     // Read the data block header to obtain the maximum allowed size to write
     EepromReadBuffer( ( dataB->virtualAddr - sizeof( DataBlockHeader_t ) ), ( uint8_t* ) &dataBHdr, sizeof( dataBHdr ) );
 
-    if( num > dataBHdr.Num )
+    if( ( num > dataBHdr.Num ) || ( offset > num ) || ( size > ( num - offset ) ) )
     {
         CRITICAL_SECTION_END( );
         return NVMM_ERROR_SIZE;
     }
 
-    dataBHdr.CSum = ComputeChecksum( ( uint8_t* ) src, num );
+    cSum = ComputeChecksum( ( uint8_t* ) src, num );
 
-    // Update data block header
-    EepromWriteBuffer( ( dataB->virtualAddr - sizeof( DataBlockHeader_t ) ), ( uint8_t* ) &dataBHdr, sizeof( DataBlockHeader_t ) );
+    // Update data block header only when the content changed
+    if( dataBHdr.CSum != cSum )
+    {
+        dataBHdr.CSum = cSum;
+        EepromWriteBuffer( ( dataB->virtualAddr - sizeof( DataBlockHeader_t ) ), ( uint8_t* ) &dataBHdr, sizeof( DataBlockHeader_t ) );
+    }
 
-    // Write data block
-    EepromWriteBuffer( dataB->virtualAddr, ( uint8_t* ) src, num );
+    // Write the changed bytes of the dirty range
+    WriteDifferences( dataB->virtualAddr + offset, ( uint8_t* ) src + offset, size );
 
     CRITICAL_SECTION_END( );
 
@@ -171,3 +885,109 @@ NvmmStatus_t NvmmRead( NvmmDataBlock_t* dataB, void* dst, size_t num )
 
     return NVMM_SUCCESS;
 }
+
+NvmmStatus_t NvmmRestore( NvmmDataBlock_t* dataB, void* dst, size_t num )
+{
+    NvmmStatus_t retval = NVMM_FAIL_CHECKSUM;
+    DataBlockHeader_t dataBHdr;
+
+    dataB->virtualAddr = DataBlockAdrCnt;
+
+    EepromReadBuffer( ( dataB->virtualAddr - sizeof( DataBlockHeader_t ) ), ( uint8_t* ) &dataBHdr, sizeof( DataBlockHeader_t ) );
+
+    if( num == dataBHdr.Num )
+    {
+        // Single pass, the checksum is computed on the read copy
+        EepromReadBuffer( dataB->virtualAddr, ( uint8_t* ) dst, num );
+        if( ComputeChecksum( ( uint8_t* ) dst, num ) == dataBHdr.CSum )
+        {
+            retval = NVMM_SUCCESS;
+        }
+    }
+
+    // If it is the first time or memory was corrupted
+    if( retval != NVMM_SUCCESS )
+    {
+        dataBHdr.CSum = 0;
+        dataBHdr.Num = num;
+        EepromWriteBuffer( ( dataB->virtualAddr - sizeof( DataBlockHeader_t ) ), ( uint8_t* ) &dataBHdr, sizeof( DataBlockHeader_t ) );
+    }
+
+    DataBlockAdrCnt = DataBlockAdrCnt + num + sizeof( DataBlockHeader_t );
+
+    return retval;
+}
+
+bool NvmmCollect( void )
+{
+    // Data blocks are rewritten in place, nothing to collect
+    return false;
+}
+
+NvmmStatus_t NvmmTransactionCommit( void )
+{
+    NvmmStatus_t status = NVMM_SUCCESS;
+
+    if( TransactionIsStarted == false )
+    {
+        return NVMM_ERROR;
+    }
+
+    // There is no room for a second copy of the data blocks, they are
+    // rewritten one after another
+    for( uint8_t i = 0; i < TransactionEntryCnt; i++ )
+    {
+        if( NvmmWrite( TransactionEntries[i].DataB, TransactionEntries[i].Src, TransactionEntries[i].Num ) != NVMM_SUCCESS )
+        {
+            status = NVMM_ERROR;
+        }
+    }
+    TransactionEnd( );
+
+    return status;
+}
+
+#endif // NVMM_JOURNAL_ENABLED
+
+void NvmmTransactionBegin( void )
+{
+    TransactionEntryCnt = 0;
+    TransactionIsStarted = true;
+}
+
+NvmmStatus_t NvmmTransactionWrite( NvmmDataBlock_t* dataB, void* src, size_t num )
+{
+    uint8_t i = 0;
+
+    if( ( dataB == NULL ) || ( src == NULL ) )
+    {
+        return NVMM_ERROR_NPE;
+    }
+    if( TransactionIsStarted == false )
+    {
+        return NVMM_ERROR;
+    }
+
+    // Staging a data block again replaces its entry
+    while( ( i < TransactionEntryCnt ) && ( TransactionEntries[i].DataB->virtualAddr != dataB->virtualAddr ) )
+    {
+        i++;
+    }
+    if( i >= NVMM_TRANSACTION_MAX_BLOCKS )
+    {
+        return NVMM_ERROR_SIZE;
+    }
+    TransactionEntries[i].DataB = dataB;
+    TransactionEntries[i].Src = ( uint8_t* ) src;
+    TransactionEntries[i].Num = num;
+    if( i == TransactionEntryCnt )
+    {
+        TransactionEntryCnt++;
+    }
+    return NVMM_SUCCESS;
+}
+
+void NvmmTransactionAbort( void )
+{
+    TransactionEnd( );
+}
@@ -40,6 +40,7 @@ extern "C"
 
 #include <stdlib.h>
 #include <stdint.h>
+#include <stdbool.h>
 
 /*!
  * Nvmm Status
@@ -75,6 +76,7 @@ typedef struct
 {
   /*
    * Unique internal used virtual address for the data block.
+   * Data block index for the journal backend.
    */
   uint16_t virtualAddr;
 }NvmmDataBlock_t;
@@ -100,6 +102,8 @@ NvmmStatus_t NvmmVerify( NvmmDataBlock_t* dataB, size_t num );
 /*!
  *  Writes data to given data block.
  *
+ * \remark Only the bytes which differ from the stored ones are programmed.
+ *
  * \param[IN] dataB  Pointer to the data block.
  * \param[IN] src    Pointer to the source of data to be copied.
  * \param[IN] num    Number of bytes to copy.
@@ -107,6 +111,21 @@ NvmmStatus_t NvmmVerify( NvmmDataBlock_t* dataB, size_t num );
  */
 NvmmStatus_t NvmmWrite( NvmmDataBlock_t* dataB, void* src, size_t num );
 
+/*!
+ *  Writes the dirty range of the given data block.
+ *
+ * \remark src holds the whole data block image, which is used to compute the
+ *         checksum. Only the differing bytes within the range are programmed.
+ *
+ * \param[IN] dataB  Pointer to the data block.
+ * \param[IN] src    Pointer to the data block image.
+ * \param[IN] num    Size of the data block image.
+ * \param[IN] offset Offset of the changed range within the data block.
+ * \param[IN] size   Size of the changed range.
+ * \retval           Status of the operation
+ */
+NvmmStatus_t NvmmWriteRange( NvmmDataBlock_t* dataB, void* src, size_t num, size_t offset, size_t size );
+
 /*!
  * Reads from data block to destination pointer.
  *
@@ -117,6 +136,72 @@ NvmmStatus_t NvmmWrite( NvmmDataBlock_t* dataB, void* src, size_t num );
  */
 NvmmStatus_t NvmmRead( NvmmDataBlock_t* dataB, void* dst, size_t num );
 
+/*!
+ * Declares a data block and reads its content, verifying the checksum on the
+ * read copy. Replaces a NvmmDeclare and NvmmRead sequence, the data block is
+ * read once instead of twice.
+ *
+ * \param[IN] dataB  Pointer to the data block.
+ * \param[IN] dst    Pointer to the destination array, num bytes long.
+ * \param[IN] num    Size as number of bytes.
+ * \retval           Status of the operation, dst content is only valid on
+ *                   NVMM_SUCCESS
+ */
+NvmmStatus_t NvmmRestore( NvmmDataBlock_t* dataB, void* dst, size_t num );
+
+/*!
+ * Reclaims the stale records space ahead of time.
+ *
+ * \remark Only relevant for the journal backend ( NVMM_JOURNAL_ENABLED ). To be
+ *         called from an idle context so that NvmmWrite does not have to.
+ *
+ * \retval           true if the stale records space has been reclaimed
+ */
+bool NvmmCollect( void );
+
+/*!
+ * Starts a transaction. The data blocks staged by \ref NvmmTransactionWrite
+ * are stored together by \ref NvmmTransactionCommit.
+ *
+ * \remark A transaction already started is dropped.
+ */
+void NvmmTransactionBegin( void );
+
+/*!
+ * Stages a data block write in the current transaction. Nothing is written
+ * until \ref NvmmTransactionCommit.
+ *
+ * \remark src is referenced, not copied. It must stay unchanged until the
+ *         transaction is committed or aborted. Staging a data block again
+ *         replaces its previous staged content.
+ *
+ * \param[IN] dataB  Pointer to the data block.
+ * \param[IN] src    Pointer to the source of data to be stored.
+ * \param[IN] num    Number of bytes to store.
+ * \retval           Status of the operation
+ */
+NvmmStatus_t NvmmTransactionWrite( NvmmDataBlock_t* dataB, void* src, size_t num );
+
+/*!
+ * Stores the data blocks staged since \ref NvmmTransactionBegin and ends the
+ * transaction.
+ *
+ * \remark With the journal backend ( NVMM_JOURNAL_ENABLED ) the changed data
+ *         blocks are appended as a single record, with one header, one
+ *         sequence number and one CRC. An interrupted commit leaves all of
+ *         them with their previous content. The in place backend writes them
+ *         one after another.
+ *
+ * \retval           Status of the operation
+ */
+NvmmStatus_t NvmmTransactionCommit( void );
+
+/*!
+ * Drops the data blocks staged since \ref NvmmTransactionBegin and ends the
+ * transaction.
+ */
+void NvmmTransactionAbort( void );
+
 #ifdef __cplusplus
 }
 #endif
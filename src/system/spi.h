@@ -102,6 +102,47 @@ void SpiFrequency( Spi_t *obj, uint32_t hz );
  */
 uint16_t SpiInOut( Spi_t *obj, uint16_t outData );
 
+/*!
+ * \brief Sends and receives a buffer in a single burst
+ *
+ * \remark The peripheral must be configured for 8 bits transfers
+ *
+ * \param [IN]  obj  SPI object
+ * \param [IN]  tx   Data to be sent. When NULL 0x00 bytes are sent
+ * \param [OUT] rx   Buffer receiving the data. When NULL the received data is discarded
+ * \param [IN]  len  Number of bytes to be transferred
+ */
+void SpiTransfer( Spi_t *obj, const uint8_t *tx, uint8_t *rx, uint16_t len );
+
+#if defined( SPI_STATS_ENABLED )
+
+/*!
+ * \brief Called by the SpiInOut and SpiTransfer implementations when a
+ *        transfer starts, inside their critical section
+ *
+ * \remark Implemented by the application measuring the SPI bus time. The
+ *         calls may be nested.
+ */
+void SpiStatsBegin( void );
+
+/*!
+ * \brief Called by the SpiInOut and SpiTransfer implementations when a
+ *        transfer ends, inside their critical section
+ *
+ * \remark Implemented by the application measuring the SPI bus time.
+ */
+void SpiStatsEnd( void );
+
+#define SPI_STATS_BEGIN( )                          SpiStatsBegin( )
+#define SPI_STATS_END( )                            SpiStatsEnd( )
+
+#else
+
+#define SPI_STATS_BEGIN( )
+#define SPI_STATS_END( )
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,166 @@
+/*!
+ * \file      stack.c
+ *
+ * \brief     Stack usage measurement per execution context
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include <stdbool.h>
+#include <stddef.h>
+#include "utilities.h"
+#include "board-config.h"
+#include "stack.h"
+
+#if defined( STACK_STATS_ENABLED )
+
+/*!
+ * Value of the never used stack words
+ */
+#define STACK_PAINT_PATTERN                         0xA5A5A5A5
+
+/*!
+ * Top of RAM, initial main stack pointer. Provided by the linker scripts.
+ */
+extern uint32_t _estack;
+
+/*!
+ * End of the zero initialized data. Provided by the linker scripts.
+ */
+extern uint32_t _ebss;
+
+/*!
+ * Main context stack
+ */
+static uint32_t StackMain[STACK_MAIN_SIZE >> 2];
+
+/*!
+ * Lowest word of each context stack
+ */
+static uint32_t *StackLimit[STACK_CONTEXT_NB];
+
+/*!
+ * Top of each context stack
+ */
+static uint32_t *StackTop[STACK_CONTEXT_NB];
+
+static void StackPaint( uint32_t *limit, uint32_t *top )
+{
+    while( limit < top )
+    {
+        *limit++ = STACK_PAINT_PATTERN;
+    }
+}
+
+static uint32_t *StackGetPointer( void )
+{
+    uint32_t *sp;
+
+    __asm volatile( "mov %0, sp" : "=r" ( sp ) );
+    return sp;
+}
+
+/*!
+ * \brief Copies the used part of the main stack, from the stack pointer to
+ *        oldTop, below top and makes the thread mode run on the process
+ *        stack from there.
+ *
+ * \remark The frames are copied word for word. Nothing takes the address of
+ *         a stack variable before BoardInitMcu, the frame pointer is omitted.
+ *
+ * \param [IN] top    Top of the process stack
+ * \param [IN] oldTop Top of the main stack
+ */
+__attribute__( ( naked, noinline ) ) static void StackSwitchToProcessStack( uint32_t *top, uint32_t *oldTop )
+{
+    __asm volatile(
+        ".syntax unified            \n"
+        "    mov   r2, sp           \n"
+        "1:  cmp   r1, r2           \n"
+        "    beq   2f               \n"
+        "    subs  r1, #4           \n"
+        "    subs  r0, #4           \n"
+        "    ldr   r3, [r1]         \n"
+        "    str   r3, [r0]         \n"
+        "    b     1b               \n"
+        "2:  msr   psp, r0          \n"
+        "    mrs   r3, control      \n"
+        "    movs  r2, #2           \n"
+        "    orrs  r3, r2           \n"
+        "    msr   control, r3      \n"
+        "    isb                    \n"
+        "    bx    lr               \n" );
+}
+
+void StackInit( void )
+{
+    uint32_t *top = &StackMain[STACK_MAIN_SIZE >> 2];
+    uint32_t *isrLimit = &_estack - ( STACK_ISR_SIZE >> 2 );
+    uint32_t used = ( uint32_t )( &_estack - StackGetPointer( ) ) << 2;
+
+    if( ( StackTop[STACK_CONTEXT_MAIN] != NULL ) || ( used >= sizeof( StackMain ) ) )
+    {
+        return;
+    }
+
+    StackPaint( StackMain, top - ( used >> 2 ) );
+    StackSwitchToProcessStack( top, &_estack );
+
+    // Nothing is left on the main stack, the interrupt handlers start from
+    // the top of RAM again
+    if( isrLimit < &_ebss )
+    {
+        isrLimit = &_ebss;
+    }
+    CRITICAL_SECTION_BEGIN( );
+    __asm volatile( "msr msp, %0" : : "r" ( &_estack ) : "memory" );
+    StackPaint( isrLimit, &_estack );
+    CRITICAL_SECTION_END( );
+
+    StackLimit[STACK_CONTEXT_MAIN] = StackMain;
+    StackTop[STACK_CONTEXT_MAIN] = top;
+    StackLimit[STACK_CONTEXT_ISR] = isrLimit;
+    StackTop[STACK_CONTEXT_ISR] = &_estack;
+}
+
+uint32_t StackGetSize( StackContext_t context )
+{
+    if( ( context >= STACK_CONTEXT_NB ) || ( StackTop[context] == NULL ) )
+    {
+        return 0;
+    }
+    return ( uint32_t )( StackTop[context] - StackLimit[context] ) << 2;
+}
+
+uint32_t StackGetHighWater( StackContext_t context )
+{
+    uint32_t *word;
+
+    if( ( context >= STACK_CONTEXT_NB ) || ( StackTop[context] == NULL ) )
+    {
+        return 0;
+    }
+
+    // The stacks grow down, the first overwritten word from the limit up is
+    // the deepest one
+    word = StackLimit[context];
+    while( ( word < StackTop[context] ) && ( *word == STACK_PAINT_PATTERN ) )
+    {
+        word++;
+    }
+    return ( uint32_t )( StackTop[context] - word ) << 2;
+}
+
+#endif
@@ -0,0 +1,104 @@
+/*!
+ * \file      stack.h
+ *
+ * \brief     Stack usage measurement per execution context
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __STACK_H__
+#define __STACK_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdint.h>
+
+/*!
+ * Size of the main context stack [bytes]. The main program runs on it from
+ * \ref StackInit on.
+ */
+#ifndef STACK_MAIN_SIZE
+#define STACK_MAIN_SIZE                             2048
+#endif
+
+/*!
+ * Size of the interrupts stack measured at the top of RAM [bytes]
+ */
+#ifndef STACK_ISR_SIZE
+#define STACK_ISR_SIZE                              512
+#endif
+
+/*!
+ * Execution contexts
+ */
+typedef enum eStackContext
+{
+    /*!
+     * Main program, thread mode
+     */
+    STACK_CONTEXT_MAIN,
+    /*!
+     * Interrupt handlers, handler mode
+     */
+    STACK_CONTEXT_ISR,
+    STACK_CONTEXT_NB,
+}StackContext_t;
+
+#if defined( STACK_STATS_ENABLED )
+
+/*!
+ * Moves the main program to its own stack and paints both stacks.
+ *
+ * The main program runs on the process stack ( PSP ) of STACK_MAIN_SIZE bytes
+ * and the interrupt handlers alone use the main stack ( MSP ) at the top of
+ * RAM, so that each context is measured separately. Called first by
+ * BoardInitMcu.
+ */
+void StackInit( void );
+
+/*!
+ * Gets the size of a context stack
+ *
+ * \param [IN] context Execution context
+ * \retval size Stack size [bytes]
+ */
+uint32_t StackGetSize( StackContext_t context );
+
+/*!
+ * Gets the deepest stack use of a context since \ref StackInit
+ *
+ * \remark A value equal to the stack size means the stack overflowed.
+ *
+ * \param [IN] context Execution context
+ * \retval highWater Deepest stack use [bytes]
+ */
+uint32_t StackGetHighWater( StackContext_t context );
+
+#else
+
+#define StackInit( )
+#define StackGetSize( context )                     0
+#define StackGetHighWater( context )                0
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __STACK_H__
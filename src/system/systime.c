@@ -23,6 +23,7 @@
  * \author    MCD Application Team ( STMicroelectronics International )
  */
 #include <stdio.h>
+#include <stdbool.h>
 #include "rtc-board.h"
 #include "systime.h"
 
@@ -66,6 +67,42 @@
 
 #define DIVC_BY_2( X )                              ( ( ( X ) + 1 ) >> 1 )
 
+/*!
+ * \brief Day of the last calendar conversion
+ */
+typedef struct sSysTimeDayCache
+{
+    /*!
+     * Set once the cache holds a day
+     */
+    bool Valid;
+    /*!
+     * First second of the day, counted from 01/01/1968
+     */
+    uint32_t Start;
+    /*!
+     * Date of the day. The time fields are not used.
+     */
+    struct tm Date;
+}SysTimeDayCache_t;
+
+/*!
+ * Days of the last SysTimeLocalTime and SysTimeMkTime conversions.
+ *
+ * \remark The callers converting timestamps of the same day, only compute
+ *         the time of the day.
+ */
+static SysTimeDayCache_t LocalTimeDay = { .Valid = false };
+static SysTimeDayCache_t MkTimeDay = { .Valid = false };
+
+/*!
+ * \brief Computes the date fields of a calendar time
+ *
+ * \param [IN]  days      Number of days elapsed since 01/01/1968
+ * \param [OUT] localtime Calendar time, the time of the day is not set
+ */
+static void SysTimeLocalDate( uint32_t days, struct tm *localtime );
+
 static uint32_t CalendarGetMonth( uint32_t days, uint32_t year );
 static void CalendarDiv86400( uint32_t in, uint32_t* out, uint32_t* remainder );
 static uint32_t CalendarDiv61( uint32_t in );
@@ -157,6 +194,24 @@ SysTime_t SysTimeFromMs( uint32_t timeMs )
     return SysTimeAdd( sysTime, deltaTime );
 }
 
+SysTime_t SysTimeFromGps( uint32_t gpsSeconds, uint8_t fraction )
+{
+    // round( pow( 0.5, 8.0 ) * 1000 ) = 3.90625
+    SysTime_t sysTime = { .Seconds = gpsSeconds + UNIX_GPS_EPOCH_OFFSET,
+                          .SubSeconds = ( int16_t )( ( ( uint32_t )fraction * 1000 ) >> 8 ) };
+
+    return sysTime;
+}
+
+uint32_t SysTimeToGps( SysTime_t sysTime, uint8_t *fraction )
+{
+    if( fraction != NULL )
+    {
+        *fraction = ( uint8_t )( ( ( uint32_t )sysTime.SubSeconds << 8 ) / 1000 );
+    }
+    return sysTime.Seconds - UNIX_GPS_EPOCH_OFFSET;
+}
+
 uint32_t SysTimeMkTime( const struct tm* localtime )
 {
     uint32_t nbdays;
@@ -170,15 +225,29 @@ uint32_t SysTimeMkTime( const struct tm* localtime )
         DAYS_IN_MONTH_CORRECTION_NORM
     };
 
-    nbdays = DIVC( ( TM_DAYS_IN_YEAR * 3 + TM_DAYS_IN_LEAP_YEAR ) * year, 4 );
+    if( ( MkTimeDay.Valid == true ) && ( MkTimeDay.Date.tm_year == localtime->tm_year ) &&
+        ( MkTimeDay.Date.tm_mon == localtime->tm_mon ) && ( MkTimeDay.Date.tm_mday == localtime->tm_mday ) )
+    {
+        nbsecs = MkTimeDay.Start;
+    }
+    else
+    {
+        nbdays = DIVC( ( TM_DAYS_IN_YEAR * 3 + TM_DAYS_IN_LEAP_YEAR ) * year, 4 );
+
+        nbdays += ( DIVC_BY_2( ( localtime->tm_mon ) * ( 30 + 31 ) ) -
+                    ( ( ( correctionMonth[year % 4] >> ( ( localtime->tm_mon ) * 2 ) ) & 0x03 ) ) );
 
-    nbdays += ( DIVC_BY_2( ( localtime->tm_mon ) * ( 30 + 31 ) ) -
-                ( ( ( correctionMonth[year % 4] >> ( ( localtime->tm_mon ) * 2 ) ) & 0x03 ) ) );
+        nbdays += ( localtime->tm_mday - 1 );
 
-    nbdays += ( localtime->tm_mday - 1 );
+        // Convert from days to seconds
+        nbsecs = nbdays * TM_SECONDS_IN_1DAY;
 
-    // Convert from days to seconds
-    nbsecs = nbdays * TM_SECONDS_IN_1DAY;
+        MkTimeDay.Start = nbsecs;
+        MkTimeDay.Date.tm_year = localtime->tm_year;
+        MkTimeDay.Date.tm_mon = localtime->tm_mon;
+        MkTimeDay.Date.tm_mday = localtime->tm_mday;
+        MkTimeDay.Valid = true;
+    }
 
     nbsecs += ( ( uint32_t )localtime->tm_sec + 
                 ( ( uint32_t )localtime->tm_min * TM_SECONDS_IN_1MINUTE ) +
@@ -190,21 +259,26 @@ uint32_t SysTimeMkTime( const struct tm* localtime )
 
 void SysTimeLocalTime( const uint32_t timestamp, struct tm *localtime )
 {
-    uint32_t correctionMonth[4] =
-    {
-        DAYS_IN_MONTH_CORRECTION_LEAP,
-        DAYS_IN_MONTH_CORRECTION_NORM,
-        DAYS_IN_MONTH_CORRECTION_NORM,
-        DAYS_IN_MONTH_CORRECTION_NORM
-    };
-    uint32_t weekDays = 1; // Monday 1st January 1968
     uint32_t seconds;
     uint32_t minutes;
     uint32_t days;
     uint32_t divOut;
     uint32_t divReminder;
 
-    CalendarDiv86400( timestamp + UNIX_HOUR_OFFSET, &days, &seconds );
+    if( ( LocalTimeDay.Valid == true ) && ( ( timestamp + UNIX_HOUR_OFFSET - LocalTimeDay.Start ) < TM_SECONDS_IN_1DAY ) )
+    {
+        // Same day as the last conversion, only the time of the day changes
+        seconds = timestamp + UNIX_HOUR_OFFSET - LocalTimeDay.Start;
+        *localtime = LocalTimeDay.Date;
+    }
+    else
+    {
+        CalendarDiv86400( timestamp + UNIX_HOUR_OFFSET, &days, &seconds );
+        LocalTimeDay.Start = timestamp + UNIX_HOUR_OFFSET - seconds;
+        SysTimeLocalDate( days, localtime );
+        LocalTimeDay.Date = *localtime;
+        LocalTimeDay.Valid = true;
+    }
 
     // Calculates seconds
     CalendarDiv60( seconds, &minutes, &divReminder );
@@ -214,6 +288,18 @@ void SysTimeLocalTime( const uint32_t timestamp, struct tm *localtime )
     CalendarDiv60( minutes, &divOut, &divReminder);
     localtime->tm_min = ( uint8_t )divReminder;
     localtime->tm_hour = ( uint8_t )divOut;
+}
+
+static void SysTimeLocalDate( uint32_t days, struct tm *localtime )
+{
+    uint32_t correctionMonth[4] =
+    {
+        DAYS_IN_MONTH_CORRECTION_LEAP,
+        DAYS_IN_MONTH_CORRECTION_NORM,
+        DAYS_IN_MONTH_CORRECTION_NORM,
+        DAYS_IN_MONTH_CORRECTION_NORM
+    };
+    uint32_t weekDays = 1; // Monday 1st January 1968
 
     // Calculates year
     localtime->tm_year = DIV_365_25( days );
@@ -145,9 +145,30 @@ uint32_t SysTimeToMs( SysTime_t sysTime );
  */
 SysTime_t SysTimeFromMs( uint32_t timeMs );
 
+/*!
+ * \brief Converts a GPS epoch time to a system time
+ *
+ * \param [IN] gpsSeconds Number of seconds since the GPS epoch
+ * \param [IN] fraction   Fractional second in 1/256 s steps
+ * \retval sysTime        Seconds/milliseconds since UNIX epoch origin
+ */
+SysTime_t SysTimeFromGps( uint32_t gpsSeconds, uint8_t fraction );
+
+/*!
+ * \brief Converts a system time to a GPS epoch time
+ *
+ * \param [IN]  sysTime    Seconds/milliseconds since UNIX epoch origin
+ * \param [OUT] fraction   Fractional second in 1/256 s steps, may be NULL
+ * \retval gpsSeconds      Number of seconds since the GPS epoch
+ */
+uint32_t SysTimeToGps( SysTime_t sysTime, uint8_t *fraction );
+
 /*!
  * \brief Convert a calendar time into time since UNIX epoch as a uint32_t.
  *
+ * \remark The seconds of the start of the day are kept from the previous call
+ *         when the date is the same.
+ *
  * \param [IN] localtime Pointer to the object containing the calendar time
  * \retval     timestamp The calendar time as seconds since UNIX epoch.
  */
@@ -156,6 +177,9 @@ uint32_t SysTimeMkTime( const struct tm* localtime );
 /*!
  * \brief Converts a given time in seconds since UNIX epoch into calendar time.
  *
+ * \remark The date is kept from the previous call when the timestamp falls
+ *         in the same day, only the time of the day is computed.
+ *
  * \param [IN]  timestamp The time since UNIX epoch to convert into calendar time.
  * \param [OUT] localtime Pointer to the calendar time object which will contain
                           the result of the conversion.
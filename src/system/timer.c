@@ -24,6 +24,7 @@
 #include "board.h"
 #include "rtc-board.h"
 #include "timer.h"
+#include "trace.h"
 
 /*!
  * Safely execute call back
@@ -43,9 +44,43 @@
 
 /*!
  * Timers list head pointer
+ *
+ * \remark The list is delta-encoded. The head Timestamp is relative to the
+ *         RTC timer context and every following Timestamp is relative to its
+ *         predecessor expiry.
  */
 static TimerEvent_t *TimerListHead = NULL;
 
+/*!
+ * Timestamp of the currently programmed alarm relative to the RTC timer
+ * context
+ */
+static uint32_t TimerAlarmTimestamp = 0;
+
+/*!
+ * Last RTC timer value and number of wrap arounds of the 64 bits timebase
+ */
+static uint32_t TimerTicksLast = 0;
+static uint32_t TimerTicksHigh = 0;
+
+/*!
+ * Deferred timers whose callback waits for TimerProcess, in expiry order
+ */
+static TimerEvent_t *TimerPendingHead = NULL;
+static TimerEvent_t *TimerPendingTail = NULL;
+
+/*!
+ * Called when a deferred callback is queued
+ */
+static void ( *TimerProcessNotify )( void ) = NULL;
+
+#if defined( TIMER_STATS_ENABLED )
+/*!
+ * Longest timer IRQ handler run in ticks
+ */
+static uint32_t TimerIrqDurationMax = 0;
+#endif
+
 /*!
  * \brief Adds or replace the head timer of the list.
  *
@@ -53,7 +88,6 @@ static TimerEvent_t *TimerListHead = NULL;
  *         next timer to expire.
  *
  * \param [IN]  obj Timer object to be become the new head
- * \param [IN]  remainingTime Remaining time of the previous head to be replaced
  */
 static void TimerInsertNewHeadTimer( TimerEvent_t *obj );
 
@@ -64,10 +98,73 @@ static void TimerInsertNewHeadTimer( TimerEvent_t *obj );
  *         next timer to expire.
  *
  * \param [IN]  obj Timer object to be added to the list
- * \param [IN]  remainingTime Remaining time of the running head after which the object may be added
  */
 static void TimerInsertTimer( TimerEvent_t *obj );
 
+/*!
+ * \brief Removes the list head and hands its delta over to the new head
+ *
+ * \retval head Removed timer object
+ */
+static TimerEvent_t* TimerRemoveHeadTimer( void );
+
+/*!
+ * \brief Moves the expiry of the objects following the given one earlier by
+ *        the given amount of ticks
+ *
+ * \remark Objects which would expire before the given one are clamped to its
+ *         expiry and the remaining amount is carried to the next ones.
+ *
+ * \param [IN] obj   Timer object after which the expiries must be moved
+ * \param [IN] ticks Amount of ticks to remove
+ */
+static void TimerAdvanceNextTimers( TimerEvent_t *obj, uint32_t ticks );
+
+/*!
+ * \brief Computes the latest timestamp at which the alarm may fire while
+ *        still honoring every timer allowed slack
+ *
+ * \remark Only the timers that expire in the same batch as the head are
+ *         walked.
+ *
+ * \param [IN] obj Timer object at the head of the list
+ * \retval timestamp Alarm timestamp relative to the RTC timer context
+ */
+static uint32_t TimerGetBatchTimestamp( TimerEvent_t *obj );
+
+/*!
+ * \brief Executes the timer object callback
+ *
+ * \param [IN] obj Expired timer object
+ */
+static void TimerExecuteCallBack( TimerEvent_t *obj );
+
+/*!
+ * \brief Runs the expired timer callback or queues it for TimerProcess
+ *
+ * \param [IN] obj Expired timer object
+ */
+static void TimerExpire( TimerEvent_t *obj );
+
+/*!
+ * \brief Drops the queued deferred callback of the timer, if any
+ *
+ * \param [IN] obj Timer object
+ */
+static void TimerRemovePending( TimerEvent_t *obj );
+
+#if defined( TIMER_STATS_ENABLED )
+/*!
+ * \brief Updates the timer object statistics after a callback execution
+ *
+ * \param [IN] obj       Expired timer object
+ * \param [IN] scheduled Requested expiry tick
+ * \param [IN] fired     Callback start tick
+ * \param [IN] done      Callback end tick
+ */
+static void TimerStatsUpdate( TimerEvent_t *obj, uint32_t scheduled, uint32_t fired, uint32_t done );
+#endif
+
 /*!
  * \brief Sets a timeout with the duration "timestamp"
  *
@@ -92,6 +189,15 @@ void TimerInit( TimerEvent_t *obj, void ( *callback )( void *context ) )
     obj->Callback = callback;
     obj->Context = NULL;
     obj->Next = NULL;
+    obj->Prev = NULL;
+    obj->Slack = 0;
+    obj->IsDeferred = false;
+    obj->IsPending = false;
+    obj->NextPending = NULL;
+#if defined( TIMER_STATS_ENABLED )
+    obj->Deadline = 0;
+    TimerResetStats( obj );
+#endif
 }
 
 void TimerSetContext( TimerEvent_t *obj, void* context )
@@ -118,6 +224,9 @@ void TimerStart( TimerEvent_t *obj )
     if( TimerListHead == NULL )
     {
         RtcSetTimerContext( );
+#if defined( TIMER_STATS_ENABLED )
+        obj->Deadline = RtcGetTimerContext( ) + obj->Timestamp;
+#endif
         // Inserts a timer at time now + obj->Timestamp
         TimerInsertNewHeadTimer( obj );
     }
@@ -125,6 +234,9 @@ void TimerStart( TimerEvent_t *obj )
     {
         elapsedTime = RtcGetTimerElapsedTime( );
         obj->Timestamp += elapsedTime;
+#if defined( TIMER_STATS_ENABLED )
+        obj->Deadline = RtcGetTimerContext( ) + obj->Timestamp;
+#endif
 
         if( obj->Timestamp < TimerListHead->Timestamp )
         {
@@ -142,23 +254,33 @@ static void TimerInsertTimer( TimerEvent_t *obj )
 {
     TimerEvent_t* cur = TimerListHead;
     TimerEvent_t* next = TimerListHead->Next;
+    uint32_t deadline = obj->Timestamp;
+    // Expiry of obj relative to the cur expiry
+    uint32_t remaining = obj->Timestamp - TimerListHead->Timestamp;
 
-    while( cur->Next != NULL )
+    while( ( next != NULL ) && ( remaining > next->Timestamp ) )
     {
-        if( obj->Timestamp > next->Timestamp )
-        {
-            cur = next;
-            next = next->Next;
-        }
-        else
-        {
-            cur->Next = obj;
-            obj->Next = next;
-            return;
-        }
+        remaining -= next->Timestamp;
+        cur = next;
+        next = next->Next;
+    }
+
+    obj->Timestamp = remaining;
+    if( next != NULL )
+    {
+        next->Timestamp -= remaining;
+        next->Prev = obj;
     }
     cur->Next = obj;
-    obj->Next = NULL;
+    obj->Prev = cur;
+    obj->Next = next;
+
+    // The running alarm may be batched later than the new object allows
+    if( ( TimerListHead->IsNext2Expire == true ) && ( deadline < TimerAlarmTimestamp ) &&
+        ( ( TimerAlarmTimestamp - deadline ) > obj->Slack ) )
+    {
+        TimerSetTimeout( TimerListHead );
+    }
 }
 
 static void TimerInsertNewHeadTimer( TimerEvent_t *obj )
@@ -168,61 +290,103 @@ static void TimerInsertNewHeadTimer( TimerEvent_t *obj )
     if( cur != NULL )
     {
         cur->IsNext2Expire = false;
+        // The previous head becomes relative to the new one
+        cur->Timestamp -= obj->Timestamp;
+        cur->Prev = obj;
     }
 
+    obj->Prev = NULL;
     obj->Next = cur;
     TimerListHead = obj;
     TimerSetTimeout( TimerListHead );
 }
 
+static TimerEvent_t* TimerRemoveHeadTimer( void )
+{
+    TimerEvent_t* cur = TimerListHead;
+
+    TimerListHead = cur->Next;
+    if( TimerListHead != NULL )
+    {
+        // Intentional wrap around. Absolute expiries never exceed 2^32
+        TimerListHead->Timestamp += cur->Timestamp;
+        TimerListHead->Prev = NULL;
+    }
+    cur->Next = NULL;
+    cur->Prev = NULL;
+    return cur;
+}
+
+static void TimerAdvanceNextTimers( TimerEvent_t *obj, uint32_t ticks )
+{
+    TimerEvent_t* cur = obj->Next;
+
+    // Only objects that are already expired are walked by this loop
+    while( ( cur != NULL ) && ( ticks > 0 ) )
+    {
+        if( cur->Timestamp >= ticks )
+        {
+            cur->Timestamp -= ticks;
+            ticks = 0;
+        }
+        else
+        {
+            ticks -= cur->Timestamp;
+            cur->Timestamp = 0;
+            cur = cur->Next;
+        }
+    }
+}
+
 bool TimerIsStarted( TimerEvent_t *obj )
 {
     return obj->IsStarted;
 }
 
-void TimerIrqHandler( void )
+RAM_FUNC void TimerIrqHandler( void )
 {
     TimerEvent_t* cur;
-    TimerEvent_t* next;
+#if defined( TIMER_STATS_ENABLED )
+    uint32_t start = RtcGetTimerValue( );
+#endif
 
     uint32_t old =  RtcGetTimerContext( );
     uint32_t now =  RtcSetTimerContext( );
     uint32_t deltaContext = now - old; // intentional wrap around
 
-    // Update timeStamp based upon new Time Reference
-    // because delta context should never exceed 2^32
-    if( TimerListHead != NULL )
+    // Keeps track of the RTC timer wrap arounds
+    TimerGetCurrentTicks( );
+
+    // Execute immediately the alarm callback
+    if ( TimerListHead != NULL )
     {
-        for( cur = TimerListHead; cur->Next != NULL; cur = cur->Next )
+        cur = TimerRemoveHeadTimer( );
+
+        // Update the new head timeStamp based upon new Time Reference
+        // because delta context should never exceed 2^32
+        if( TimerListHead != NULL )
         {
-            next = cur->Next;
-            if( next->Timestamp > deltaContext )
+            if( TimerListHead->Timestamp > deltaContext )
             {
-                next->Timestamp -= deltaContext;
+                TimerListHead->Timestamp -= deltaContext;
             }
             else
             {
-                next->Timestamp = 0;
+                // Keep the following objects expiries unchanged
+                TimerAdvanceNextTimers( TimerListHead, deltaContext - TimerListHead->Timestamp );
+                TimerListHead->Timestamp = 0;
             }
         }
-    }
-
-    // Execute immediately the alarm callback
-    if ( TimerListHead != NULL )
-    {
-        cur = TimerListHead;
-        TimerListHead = TimerListHead->Next;
         cur->IsStarted = false;
-        ExecuteCallBack( cur->Callback, cur->Context );
+        TimerExpire( cur );
     }
 
     // Remove all the expired object from the list
-    while( ( TimerListHead != NULL ) && ( TimerListHead->Timestamp < RtcGetTimerElapsedTime( ) ) )
+    while( ( TimerListHead != NULL ) && ( TimerListHead->Timestamp <= RtcGetTimerElapsedTime( ) ) )
     {
-        cur = TimerListHead;
-        TimerListHead = TimerListHead->Next;
+        cur = TimerRemoveHeadTimer( );
         cur->IsStarted = false;
-        ExecuteCallBack( cur->Callback, cur->Context );
+        TimerExpire( cur );
     }
 
     // Start the next TimerListHead if it exists AND NOT running
@@ -230,14 +394,99 @@ void TimerIrqHandler( void )
     {
         TimerSetTimeout( TimerListHead );
     }
+#if defined( TIMER_STATS_ENABLED )
+    uint32_t duration = RtcGetTimerValue( ) - start;
+
+    if( duration > TimerIrqDurationMax )
+    {
+        TimerIrqDurationMax = duration;
+    }
+#endif
+}
+
+static void TimerExpire( TimerEvent_t *obj )
+{
+    if( obj->IsDeferred == false )
+    {
+        TimerExecuteCallBack( obj );
+        return;
+    }
+    if( obj->IsPending == false )
+    {
+        obj->IsPending = true;
+        obj->NextPending = NULL;
+        if( TimerPendingTail != NULL )
+        {
+            TimerPendingTail->NextPending = obj;
+        }
+        else
+        {
+            TimerPendingHead = obj;
+        }
+        TimerPendingTail = obj;
+    }
+    if( TimerProcessNotify != NULL )
+    {
+        TimerProcessNotify( );
+    }
+}
+
+static void TimerRemovePending( TimerEvent_t *obj )
+{
+    TimerEvent_t* prev = NULL;
+    TimerEvent_t* cur = TimerPendingHead;
+
+    if( obj->IsPending == false )
+    {
+        return;
+    }
+    while( ( cur != NULL ) && ( cur != obj ) )
+    {
+        prev = cur;
+        cur = cur->NextPending;
+    }
+    if( cur != NULL )
+    {
+        if( prev != NULL )
+        {
+            prev->NextPending = obj->NextPending;
+        }
+        else
+        {
+            TimerPendingHead = obj->NextPending;
+        }
+        if( TimerPendingTail == obj )
+        {
+            TimerPendingTail = prev;
+        }
+    }
+    obj->IsPending = false;
+    obj->NextPending = NULL;
+}
+
+static void TimerExecuteCallBack( TimerEvent_t *obj )
+{
+    TRACE( TRACE_ID_TIMER_EVENT, 0, 0, ( uint32_t )( uintptr_t )obj->Callback );
+#if defined( TIMER_STATS_ENABLED )
+    // The callback may restart the timer object
+    uint32_t scheduled = obj->Deadline;
+    uint32_t fired = RtcGetTimerValue( );
+
+    ExecuteCallBack( obj->Callback, obj->Context );
+    TimerStatsUpdate( obj, scheduled, fired, RtcGetTimerValue( ) );
+#else
+    ExecuteCallBack( obj->Callback, obj->Context );
+#endif
 }
 
 void TimerStop( TimerEvent_t *obj )
 {
     CRITICAL_SECTION_BEGIN( );
 
-    TimerEvent_t* prev = TimerListHead;
-    TimerEvent_t* cur = TimerListHead;
+    if( obj != NULL )
+    {
+        TimerRemovePending( obj );
+    }
 
     // List is empty or the obj to stop does not exist
     if( ( TimerListHead == NULL ) || ( obj == NULL ) )
@@ -253,70 +502,40 @@ void TimerStop( TimerEvent_t *obj )
         if( TimerListHead->IsNext2Expire == true ) // The head is already running
         {
             TimerListHead->IsNext2Expire = false;
-            if( TimerListHead->Next != NULL )
+            TimerRemoveHeadTimer( );
+            if( TimerListHead != NULL )
             {
-                TimerListHead = TimerListHead->Next;
                 TimerSetTimeout( TimerListHead );
             }
             else
             {
                 RtcStopAlarm( );
-                TimerListHead = NULL;
             }
         }
         else // Stop the head before it is started
         {
-            if( TimerListHead->Next != NULL )
-            {
-                TimerListHead = TimerListHead->Next;
-            }
-            else
-            {
-                TimerListHead = NULL;
-            }
+            TimerRemoveHeadTimer( );
         }
     }
-    else // Stop an object within the list
+    else if( obj->Prev != NULL ) // Stop an object within the list
     {
-        while( cur != NULL )
+        if( obj->Next != NULL )
         {
-            if( cur == obj )
-            {
-                if( cur->Next != NULL )
-                {
-                    cur = cur->Next;
-                    prev->Next = cur;
-                }
-                else
-                {
-                    cur = NULL;
-                    prev->Next = cur;
-                }
-                break;
-            }
-            else
-            {
-                prev = cur;
-                cur = cur->Next;
-            }
+            // The next object inherits the removed object delta
+            obj->Next->Timestamp += obj->Timestamp;
+            obj->Next->Prev = obj->Prev;
         }
+        obj->Prev->Next = obj->Next;
+        obj->Next = NULL;
+        obj->Prev = NULL;
     }
     CRITICAL_SECTION_END( );
 }
 
 static bool TimerExists( TimerEvent_t *obj )
 {
-    TimerEvent_t* cur = TimerListHead;
-
-    while( cur != NULL )
-    {
-        if( cur == obj )
-        {
-            return true;
-        }
-        cur = cur->Next;
-    }
-    return false;
+    // Only the list head has no previous object
+    return ( obj->Prev != NULL ) || ( obj == TimerListHead );
 }
 
 void TimerReset( TimerEvent_t *obj )
@@ -325,10 +544,9 @@ void TimerReset( TimerEvent_t *obj )
     TimerStart( obj );
 }
 
-void TimerSetValue( TimerEvent_t *obj, uint32_t value )
+static void TimerSetTicks( TimerEvent_t *obj, uint32_t ticks )
 {
     uint32_t minValue = 0;
-    uint32_t ticks = RtcMs2Tick( value );
 
     TimerStop( obj );
 
@@ -343,10 +561,27 @@ void TimerSetValue( TimerEvent_t *obj, uint32_t value )
     obj->ReloadValue = ticks;
 }
 
+void TimerSetValue( TimerEvent_t *obj, uint32_t value )
+{
+    TimerSetTicks( obj, RtcMs2Tick( value ) );
+}
+
+void TimerSetValueUs( TimerEvent_t *obj, uint32_t value )
+{
+    TimerSetTicks( obj, ( uint32_t )TimerUs2Ticks( value ) );
+}
+
+void TimerSetSlack( TimerEvent_t *obj, uint32_t value )
+{
+    CRITICAL_SECTION_BEGIN( );
+    obj->Slack = RtcMs2Tick( value );
+    CRITICAL_SECTION_END( );
+}
+
 TimerTime_t TimerGetCurrentTime( void )
 {
-    uint32_t now = RtcGetTimerValue( );
-    return  RtcTick2Ms( now );
+    // Wraps around at 2^32 ms whatever the RTC tick duration
+    return ( TimerTime_t )( TimerTicks2Us( TimerGetCurrentTicks( ) ) / 1000 );
 }
 
 TimerTime_t TimerGetElapsedTime( TimerTime_t past )
@@ -355,24 +590,85 @@ TimerTime_t TimerGetElapsedTime( TimerTime_t past )
     {
         return 0;
     }
-    uint32_t nowInTicks = RtcGetTimerValue( );
-    uint32_t pastInTicks = RtcMs2Tick( past );
+    // Intentional wrap around
+    return TimerGetCurrentTime( ) - past;
+}
 
-    // Intentional wrap around. Works Ok if tick duration below 1ms
-    return RtcTick2Ms( nowInTicks - pastInTicks );
+uint64_t TimerGetCurrentTicks( void )
+{
+    uint64_t ticks = 0;
+
+    CRITICAL_SECTION_BEGIN( );
+    uint32_t now = RtcGetTimerValue( );
+
+    if( now < TimerTicksLast )
+    {
+        TimerTicksHigh++;
+    }
+    TimerTicksLast = now;
+    ticks = ( ( uint64_t )TimerTicksHigh << 32 ) | now;
+    CRITICAL_SECTION_END( );
+    return ticks;
+}
+
+uint64_t TimerUs2Ticks( uint64_t microseconds )
+{
+    uint32_t ticksPerSecond = RtcMs2Tick( 1000 );
+
+    return ( ( microseconds * ticksPerSecond ) + 500000 ) / 1000000;
+}
+
+uint64_t TimerTicks2Us( uint64_t ticks )
+{
+    uint32_t ticksPerSecond = RtcMs2Tick( 1000 );
+
+    return ( ticks * 1000000 ) / ticksPerSecond;
 }
 
 static void TimerSetTimeout( TimerEvent_t *obj )
 {
     int32_t minTicks= RtcGetMinimumTimeout( );
+    uint32_t minTimestamp = minTicks + RtcGetTimerElapsedTime( );
     obj->IsNext2Expire = true;
 
+    // The slack windows are computed from the requested deadlines
+    TimerAlarmTimestamp = TimerGetBatchTimestamp( obj );
+
     // In case deadline too soon
-    if( obj->Timestamp  < ( RtcGetTimerElapsedTime( ) + minTicks ) )
+    if( obj->Timestamp < minTimestamp )
+    {
+        // obj is the list head. Its successors must keep their expiry.
+        TimerAdvanceNextTimers( obj, minTimestamp - obj->Timestamp );
+        obj->Timestamp = minTimestamp;
+    }
+    if( TimerAlarmTimestamp < minTimestamp )
+    {
+        TimerAlarmTimestamp = minTimestamp;
+    }
+    RtcSetAlarm( TimerAlarmTimestamp );
+}
+
+static uint32_t TimerGetBatchTimestamp( TimerEvent_t *obj )
+{
+    TimerEvent_t* cur = obj;
+    uint32_t deadline = 0;
+    uint32_t batch = UINT32_MAX;
+
+    while( cur != NULL )
     {
-        obj->Timestamp = RtcGetTimerElapsedTime( ) + minTicks;
+        deadline += cur->Timestamp;
+        if( deadline > batch )
+        {
+            // cur and its successors expire after the batch
+            break;
+        }
+        if( cur->Slack < ( batch - deadline ) )
+        {
+            batch = deadline + cur->Slack;
+        }
+        cur = cur->Next;
     }
-    RtcSetAlarm( obj->Timestamp );
+    return batch;
 }
 
 TimerTime_t TimerTempCompensation( TimerTime_t period, float temperature )
@@ -380,7 +676,154 @@ TimerTime_t TimerTempCompensation( TimerTime_t period, float temperature )
     return RtcTempCompensation( period, temperature );
 }
 
+void TimerSetDeferred( TimerEvent_t *obj, bool deferred )
+{
+    CRITICAL_SECTION_BEGIN( );
+    obj->IsDeferred = deferred;
+    if( deferred == false )
+    {
+        TimerRemovePending( obj );
+    }
+    CRITICAL_SECTION_END( );
+}
+
+void TimerSetProcessNotify( void ( *notify )( void ) )
+{
+    TimerProcessNotify = notify;
+}
+
 void TimerProcess( void )
 {
+    TimerEvent_t* cur;
+
     RtcProcess( );
+
+    // Callbacks queued while running the previous ones are run as well
+    while( 1 )
+    {
+        CRITICAL_SECTION_BEGIN( );
+        cur = TimerPendingHead;
+        if( cur != NULL )
+        {
+            TimerPendingHead = cur->NextPending;
+            if( TimerPendingHead == NULL )
+            {
+                TimerPendingTail = NULL;
+            }
+            cur->IsPending = false;
+            cur->NextPending = NULL;
+        }
+        CRITICAL_SECTION_END( );
+
+        if( cur == NULL )
+        {
+            break;
+        }
+        TimerExecuteCallBack( cur );
+    }
+}
+
+uint32_t TimerGetTicksToNextEvent( void )
+{
+    uint32_t ticks = UINT32_MAX;
+    uint32_t elapsedTime = 0;
+
+    CRITICAL_SECTION_BEGIN( );
+    if( ( TimerListHead != NULL ) && ( TimerListHead->IsNext2Expire == true ) )
+    {
+        elapsedTime = RtcGetTimerElapsedTime( );
+        ticks = ( TimerAlarmTimestamp > elapsedTime ) ? ( TimerAlarmTimestamp - elapsedTime ) : 0;
+    }
+    CRITICAL_SECTION_END( );
+    return ticks;
+}
+
+#if defined( TIMER_STATS_ENABLED )
+/*!
+ * \brief Computes the histogram bucket of a tick value
+ *
+ * \param [IN] ticks Value in ticks
+ * \retval bucket Histogram bucket index
+ */
+static uint8_t TimerStatsGetBucket( uint32_t ticks )
+{
+    uint8_t bucket = 0;
+
+    while( ( ticks != 0 ) && ( bucket < ( TIMER_STATS_HISTOGRAM_SIZE - 1 ) ) )
+    {
+        ticks >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+static void TimerStatsUpdate( TimerEvent_t *obj, uint32_t scheduled, uint32_t fired, uint32_t done )
+{
+    TimerStats_t* stats = &obj->Stats;
+    // Intentional wrap around
+    int32_t latency = ( int32_t )( fired - scheduled );
+    uint32_t duration = done - fired;
+    uint8_t bucket = 0;
+
+    if( latency < 0 )
+    {
+        latency = 0;
+    }
+
+    stats->Expiries++;
+    stats->Scheduled = scheduled;
+    stats->Fired = fired;
+    if( ( uint32_t )latency > stats->LatencyMax )
+    {
+        stats->LatencyMax = latency;
+    }
+    if( duration > stats->DurationMax )
+    {
+        stats->DurationMax = duration;
+    }
+
+    // Histogram counters saturate
+    bucket = TimerStatsGetBucket( latency );
+    if( stats->LatencyHistogram[bucket] < UINT16_MAX )
+    {
+        stats->LatencyHistogram[bucket]++;
+    }
+    bucket = TimerStatsGetBucket( duration );
+    if( stats->DurationHistogram[bucket] < UINT16_MAX )
+    {
+        stats->DurationHistogram[bucket]++;
+    }
+}
+
+void TimerGetStats( TimerEvent_t *obj, TimerStats_t *stats )
+{
+    if( ( obj == NULL ) || ( stats == NULL ) )
+    {
+        return;
+    }
+    CRITICAL_SECTION_BEGIN( );
+    memcpy1( ( uint8_t* )stats, ( uint8_t* )&obj->Stats, sizeof( TimerStats_t ) );
+    CRITICAL_SECTION_END( );
+}
+
+void TimerResetStats( TimerEvent_t *obj )
+{
+    if( obj == NULL )
+    {
+        return;
+    }
+    CRITICAL_SECTION_BEGIN( );
+    memset1( ( uint8_t* )&obj->Stats, 0, sizeof( TimerStats_t ) );
+    CRITICAL_SECTION_END( );
+}
+
+uint32_t TimerGetIrqDurationMax( void )
+{
+    return TimerIrqDurationMax;
+}
+
+void TimerResetIrqDurationMax( void )
+{
+    TimerIrqDurationMax = 0;
 }
+#endif
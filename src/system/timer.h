@@ -32,18 +32,54 @@ extern "C"
 #include <stdbool.h>
 #include <stdint.h>
 
+#if defined( TIMER_STATS_ENABLED )
+/*!
+ * \brief Number of buckets of the timer statistics histograms
+ *
+ * \remark Bucket 0 counts the 0 tick values, bucket n counts the values in
+ *         [2^(n-1), 2^n - 1] ticks and the last bucket counts all the values
+ *         above.
+ */
+#define TIMER_STATS_HISTOGRAM_SIZE                  8
+
+/*!
+ * \brief Timer object expiry statistics
+ *
+ * \remark All values are in RTC ticks.
+ */
+typedef struct TimerStats_s
+{
+    uint32_t Expiries;                   //! Number of callback executions
+    uint32_t Scheduled;                  //! Requested expiry tick of the last execution
+    uint32_t Fired;                      //! Actual callback start tick of the last execution
+    uint32_t LatencyMax;                 //! Maximum delay between requested expiry and callback start
+    uint32_t DurationMax;                //! Maximum callback duration
+    uint16_t LatencyHistogram[TIMER_STATS_HISTOGRAM_SIZE];  //! Callback start delays histogram
+    uint16_t DurationHistogram[TIMER_STATS_HISTOGRAM_SIZE]; //! Callback durations histogram
+}TimerStats_t;
+#endif
+
 /*!
  * \brief Timer object description
  */
 typedef struct TimerEvent_s
 {
-    uint32_t Timestamp;                  //! Current timer value
+    uint32_t Timestamp;                  //! Expiry relative to the previous timer in the list
     uint32_t ReloadValue;                //! Timer delay value
     bool IsStarted;                      //! Is the timer currently running
     bool IsNext2Expire;                  //! Is the next timer to expire
     void ( *Callback )( void* context ); //! Timer IRQ callback function
     void *Context;                       //! User defined data object pointer to pass back
     struct TimerEvent_s *Next;           //! Pointer to the next Timer object.
+    struct TimerEvent_s *Prev;           //! Pointer to the previous Timer object.
+    uint32_t Slack;                      //! Allowed expiry delay used to batch alarms
+    bool IsDeferred;                     //! Is the callback run by TimerProcess instead of the IRQ
+    bool IsPending;                      //! Is the deferred callback waiting for TimerProcess
+    struct TimerEvent_s *NextPending;    //! Pointer to the next pending deferred Timer object.
+#if defined( TIMER_STATS_ENABLED )
+    uint32_t Deadline;                   //! Requested expiry tick of the running timer
+    TimerStats_t Stats;                  //! Expiry statistics
+#endif
 }TimerEvent_t;
 
 /*!
@@ -117,6 +153,52 @@ void TimerReset( TimerEvent_t *obj );
  */
 void TimerSetValue( TimerEvent_t *obj, uint32_t value );
 
+/*!
+ * \brief Set timer new timeout value in microseconds
+ *
+ * \remark The value is rounded to the nearest RTC tick instead of being
+ *         truncated to milliseconds first.
+ *
+ * \param [IN] obj   Structure containing the timer object parameters
+ * \param [IN] value New timer timeout value in microseconds
+ */
+void TimerSetValueUs( TimerEvent_t *obj, uint32_t value );
+
+/*!
+ * \brief Sets the timer allowed slack
+ *
+ * \remark The timer callback may be called up to slack milliseconds after
+ *         the timeout in order to share a single MCU wake up with other timers.
+ *         A slack of 0 (default) gives an exact expiry.
+ *
+ * \param [IN] obj   Structure containing the timer object parameters
+ * \param [IN] value Allowed slack value in milliseconds
+ */
+void TimerSetSlack( TimerEvent_t *obj, uint32_t value );
+
+/*!
+ * \brief Moves the timer callback out of the interrupt context
+ *
+ * \remark On expiry the timer IRQ handler only queues a deferred timer. Its
+ *         callback is then run by \ref TimerProcess, from the main loop.
+ *         Reserved to the non time critical callbacks, the radio and MAC
+ *         timers stay in the IRQ. A \ref TimerStop drops a queued callback.
+ *
+ * \param [IN] obj      Structure containing the timer object parameters
+ * \param [IN] deferred Set to true to run the callback from TimerProcess
+ */
+void TimerSetDeferred( TimerEvent_t *obj, bool deferred );
+
+/*!
+ * \brief Sets the function called when a deferred callback is queued
+ *
+ * \remark Called from the timer IRQ. It must keep the main loop from
+ *         sleeping until \ref TimerProcess has run.
+ *
+ * \param [IN] notify Function to call, NULL for none
+ */
+void TimerSetProcessNotify( void ( *notify )( void ) );
+
 /*!
  * \brief Read the current time
  *
@@ -134,6 +216,33 @@ TimerTime_t TimerGetCurrentTime( void );
  */
 TimerTime_t TimerGetElapsedTime( TimerTime_t past );
 
+/*!
+ * \brief Read the current time in RTC ticks on 64 bits
+ *
+ * \remark The RTC timer value is extended in software. It must be read at
+ *         least once per RTC timer wrap around, which the timer IRQ handler
+ *         and TimerGetCurrentTime do.
+ *
+ * \retval ticks Number of RTC ticks elapsed since the start
+ */
+uint64_t TimerGetCurrentTicks( void );
+
+/*!
+ * \brief Converts a number of microseconds to RTC ticks
+ *
+ * \param [IN] microseconds Time in microseconds
+ * \retval ticks            Time in RTC ticks, rounded to the nearest one
+ */
+uint64_t TimerUs2Ticks( uint64_t microseconds );
+
+/*!
+ * \brief Converts a number of RTC ticks to microseconds
+ *
+ * \param [IN] ticks        Time in RTC ticks
+ * \retval microseconds     Time in microseconds, rounded down
+ */
+uint64_t TimerTicks2Us( uint64_t ticks );
+
 /*!
  * \brief Computes the temperature compensation for a period of time on a
  *        specific temperature.
@@ -147,9 +256,53 @@ TimerTime_t TimerTempCompensation( TimerTime_t period, float temperature );
 
 /*!
  * \brief Processes pending timer events
+ *
+ * \remark Runs the queued deferred callbacks. To be called from the main loop.
  */
 void TimerProcess( void );
 
+/*!
+ * \brief Gets the time remaining before the next timer event
+ *
+ * \remark Used by the low power manager to select the low power mode depth.
+ *
+ * \retval ticks Number of RTC ticks before the programmed alarm, UINT32_MAX
+ *               when no timer is running
+ */
+uint32_t TimerGetTicksToNextEvent( void );
+
+#if defined( TIMER_STATS_ENABLED )
+/*!
+ * \brief Reads the timer object expiry statistics
+ *
+ * \param [IN]  obj   Structure containing the timer object parameters
+ * \param [OUT] stats Copy of the timer object statistics
+ */
+void TimerGetStats( TimerEvent_t *obj, TimerStats_t *stats );
+
+/*!
+ * \brief Clears the timer object expiry statistics
+ *
+ * \param [IN] obj Structure containing the timer object parameters
+ */
+void TimerResetStats( TimerEvent_t *obj );
+
+/*!
+ * \brief Reads the longest timer IRQ handler run
+ *
+ * \remark The radio DIO and the RTC share the highest interrupt priority, so
+ *         this bounds the time a radio interrupt waits for the timer IRQ.
+ *
+ * \retval ticks Longest run in RTC ticks since the last reset
+ */
+uint32_t TimerGetIrqDurationMax( void );
+
+/*!
+ * \brief Clears the longest timer IRQ handler run
+ */
+void TimerResetIrqDurationMax( void );
+#endif
+
 #ifdef __cplusplus
 }
 #endif
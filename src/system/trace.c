@@ -0,0 +1,139 @@
+/*!
+ * \file      trace.c
+ *
+ * \brief     Binary event trace ring buffer
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#include "utilities.h"
+#include "rtc-board.h"
+#include "trace.h"
+
+#if defined( TRACE_ENABLED )
+
+#if( ( TRACE_BUFFER_SIZE & ( TRACE_BUFFER_SIZE - 1 ) ) != 0 )
+#error "TRACE_BUFFER_SIZE must be a power of 2"
+#endif
+
+static TraceRecord_t TraceBuffer[TRACE_BUFFER_SIZE];
+
+/*!
+ * Free running indexes. Head is updated by the producers under critical
+ * section, Tail only by \ref TraceProcess.
+ */
+static volatile uint16_t TraceHead = 0;
+static volatile uint16_t TraceTail = 0;
+
+/*!
+ * Number of records dropped since the last TRACE_ID_LOST record
+ */
+static volatile uint16_t TraceLost = 0;
+
+static TraceWrite_t TraceWrite = NULL;
+
+void TraceInit( TraceWrite_t write )
+{
+    TraceWrite = write;
+}
+
+void TraceEvent( uint8_t id, uint8_t arg0, uint16_t arg1, uint32_t arg2 )
+{
+    uint32_t timestamp = RtcGetTimerValue( );
+
+    CRITICAL_SECTION_BEGIN( );
+    if( ( uint16_t )( TraceHead - TraceTail ) >= TRACE_BUFFER_SIZE )
+    {
+        if( TraceLost < UINT16_MAX )
+        {
+            TraceLost++;
+        }
+    }
+    else
+    {
+        TraceRecord_t *record = &TraceBuffer[TraceHead & ( TRACE_BUFFER_SIZE - 1 )];
+
+        record->Timestamp = timestamp;
+        record->Id = id;
+        record->Arg0 = arg0;
+        record->Arg1 = arg1;
+        record->Arg2 = arg2;
+        TraceHead++;
+    }
+    CRITICAL_SECTION_END( );
+}
+
+static bool TraceWriteRecord( const TraceRecord_t *record )
+{
+    uint8_t frame[TRACE_FRAME_SIZE];
+    uint8_t checksum = 0;
+
+    frame[0] = TRACE_FRAME_SYNC0;
+    frame[1] = TRACE_FRAME_SYNC1;
+    frame[2] = record->Timestamp & 0xFF;
+    frame[3] = ( record->Timestamp >> 8 ) & 0xFF;
+    frame[4] = ( record->Timestamp >> 16 ) & 0xFF;
+    frame[5] = ( record->Timestamp >> 24 ) & 0xFF;
+    frame[6] = record->Id;
+    frame[7] = record->Arg0;
+    frame[8] = record->Arg1 & 0xFF;
+    frame[9] = ( record->Arg1 >> 8 ) & 0xFF;
+    frame[10] = record->Arg2 & 0xFF;
+    frame[11] = ( record->Arg2 >> 8 ) & 0xFF;
+    frame[12] = ( record->Arg2 >> 16 ) & 0xFF;
+    frame[13] = ( record->Arg2 >> 24 ) & 0xFF;
+    for( uint8_t i = 2; i < ( TRACE_FRAME_SIZE - 1 ); i++ )
+    {
+        checksum += frame[i];
+    }
+    frame[TRACE_FRAME_SIZE - 1] = checksum;
+
+    return TraceWrite( frame, TRACE_FRAME_SIZE );
+}
+
+void TraceProcess( void )
+{
+    if( TraceWrite == NULL )
+    {
+        return;
+    }
+
+    while( TraceTail != TraceHead )
+    {
+        if( TraceWriteRecord( &TraceBuffer[TraceTail & ( TRACE_BUFFER_SIZE - 1 )] ) == false )
+        {
+            // Output busy, retry on next call
+            return;
+        }
+        TraceTail++;
+    }
+
+    if( TraceLost != 0 )
+    {
+        TraceRecord_t lost = { .Timestamp = RtcGetTimerValue( ), .Id = TRACE_ID_LOST, .Arg0 = 0, .Arg1 = 0, .Arg2 = 0 };
+
+        CRITICAL_SECTION_BEGIN( );
+        lost.Arg1 = TraceLost;
+        CRITICAL_SECTION_END( );
+        if( TraceWriteRecord( &lost ) == true )
+        {
+            CRITICAL_SECTION_BEGIN( );
+            TraceLost -= lost.Arg1;
+            CRITICAL_SECTION_END( );
+        }
+    }
+}
+
+#endif // TRACE_ENABLED
@@ -0,0 +1,175 @@
+/*!
+ * \file      trace.h
+ *
+ * \brief     Binary event trace ring buffer
+ *
+ * \copyright Revised BSD License, see section \ref LICENSE.
+ *
+ * \code
+ *                ______                              _
+ *               / _____)             _              | |
+ *              ( (____  _____ ____ _| |_ _____  ____| |__
+ *               \____ \| ___ |    (_   _) ___ |/ ___)  _ \
+ *               _____) ) ____| | | || |_| ____( (___| | | |
+ *              (______/|_____)_|_|_| \__)_____)\____)_| |_|
+ *              (C)2013-2017 Semtech
+ *
+ * \endcode
+ *
+ * \author    Miguel Luis ( Semtech )
+ */
+#ifndef __TRACE_H__
+#define __TRACE_H__
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*!
+ * Number of trace records held in RAM. Must be a power of 2.
+ */
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE                           64
+#endif
+
+/*!
+ * Trace frame synchronization bytes. Decoded by tools/trace-decoder.py
+ *
+ * Frame: 0xA5 0x5A | Timestamp (4) | Id (1) | Arg0 (1) | Arg1 (2) | Arg2 (4) | Checksum (1)
+ *
+ * The fields are little endian. The checksum is the 8-bit sum of the 12
+ * record bytes.
+ */
+#define TRACE_FRAME_SYNC0                           0xA5
+#define TRACE_FRAME_SYNC1                           0x5A
+#define TRACE_FRAME_SIZE                            15
+
+/*!
+ * Trace event identifiers
+ */
+typedef enum eTraceId
+{
+    /*!
+     * Records dropped because the buffer was full. Arg1: count
+     */
+    TRACE_ID_LOST                                   = 0x00,
+    /*!
+     * MAC state change. Arg2: new MacState
+     */
+    TRACE_ID_MAC_STATE                              = 0x01,
+    /*!
+     * MAC transmission started. Arg0: channel, Arg1: datarate, Arg2: time on air ms
+     */
+    TRACE_ID_MAC_TX                                 = 0x02,
+    /*!
+     * MAC reception window opened. Arg0: slot, Arg1: datarate, Arg2: window ms
+     */
+    TRACE_ID_MAC_RX_WINDOW                          = 0x03,
+    /*!
+     * Radio IRQ. Arg0: \ref TraceRadioIrq_t, Arg1: size, Arg2: rssi and snr
+     */
+    TRACE_ID_RADIO_IRQ                              = 0x04,
+    /*!
+     * Timer expired. Arg2: callback address
+     */
+    TRACE_ID_TIMER_EVENT                            = 0x05,
+    /*!
+     * Secure element operation. Arg0: \ref TraceCryptoOp_t, Arg1: size, Arg2: key id
+     */
+    TRACE_ID_CRYPTO                                 = 0x06,
+    /*!
+     * First identifier available to the application
+     */
+    TRACE_ID_USER                                   = 0x80,
+}TraceId_t;
+
+/*!
+ * TRACE_ID_RADIO_IRQ events
+ */
+typedef enum eTraceRadioIrq
+{
+    TRACE_RADIO_IRQ_TX_DONE,
+    TRACE_RADIO_IRQ_RX_DONE,
+    TRACE_RADIO_IRQ_TX_TIMEOUT,
+    TRACE_RADIO_IRQ_RX_TIMEOUT,
+    TRACE_RADIO_IRQ_RX_ERROR,
+    TRACE_RADIO_IRQ_CAD_DONE,
+}TraceRadioIrq_t;
+
+/*!
+ * TRACE_ID_CRYPTO operations
+ */
+typedef enum eTraceCryptoOp
+{
+    TRACE_CRYPTO_AES_ENCRYPT,
+    TRACE_CRYPTO_CMAC,
+    TRACE_CRYPTO_CTR_CMAC,
+}TraceCryptoOp_t;
+
+/*!
+ * Trace record
+ */
+typedef struct sTraceRecord
+{
+    /*!
+     * RTC timer value, see \ref RtcGetTimerValue
+     */
+    uint32_t Timestamp;
+    uint8_t Id;
+    uint8_t Arg0;
+    uint16_t Arg1;
+    uint32_t Arg2;
+}TraceRecord_t;
+
+/*!
+ * Trace output function. Typically writes to the board UART or USB CDC.
+ *
+ * \param [IN] buffer Frame to be written
+ * \param [IN] size   Frame size
+ * \retval status     true when the frame has been accepted, false to retry later
+ */
+typedef bool ( *TraceWrite_t )( const uint8_t *buffer, uint16_t size );
+
+#if defined( TRACE_ENABLED )
+
+/*!
+ * Initializes the trace
+ *
+ * \param [IN] write Output function used by \ref TraceProcess
+ */
+void TraceInit( TraceWrite_t write );
+
+/*!
+ * Records an event. Can be called from any context including IRQs.
+ *
+ * \param [IN] id   Event identifier
+ * \param [IN] arg0 Event argument
+ * \param [IN] arg1 Event argument
+ * \param [IN] arg2 Event argument
+ */
+void TraceEvent( uint8_t id, uint8_t arg0, uint16_t arg1, uint32_t arg2 );
+
+/*!
+ * Writes the recorded events to the output. To be called from the main loop.
+ */
+void TraceProcess( void );
+
+#define TRACE( id, arg0, arg1, arg2 )               TraceEvent( ( id ), ( arg0 ), ( arg1 ), ( arg2 ) )
+
+#else
+
+#define TraceInit( write )
+#define TraceProcess( )
+#define TRACE( id, arg0, arg1, arg2 )
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // __TRACE_H__
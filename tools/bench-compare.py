@@ -0,0 +1,60 @@
+#!/usr/bin/env python3
+#
+# Compares the results printed by the Host mac-bench application
+#
+# The lines not starting with "bench," are ignored. A benchmark regresses when
+# its average time per operation grows by more than the threshold, or when it
+# reports errors.
+#
+# Usage: bench-compare.py [--threshold PERCENT] <reference log> <new log>
+#
+import argparse
+import sys
+
+def parse( path ):
+    results = {}
+    with open( path, 'r' ) as log:
+        for line in log:
+            fields = line.strip( ).split( ',' )
+            if ( len( fields ) < 5 ) or ( fields[0] != 'bench' ) or ( fields[1] != 'ns' ):
+                continue
+            if fields[4] == 'error':
+                results[fields[2]] = None
+            else:
+                results[fields[2]] = int( fields[6] )
+    return results
+
+def main( ):
+    parser = argparse.ArgumentParser( description = 'LoRaMac-node mac-bench results comparison' )
+    parser.add_argument( 'reference', help = 'Reference mac-bench output' )
+    parser.add_argument( 'new', help = 'New mac-bench output' )
+    parser.add_argument( '--threshold', type = float, default = 10.0,
+                         help = 'Allowed average time increase [%%]' )
+    args = parser.parse_args( )
+
+    reference = parse( args.reference )
+    new = parse( args.new )
+    regressions = 0
+
+    for name, avg in new.items( ):
+        ref = reference.get( name )
+        if avg is None:
+            print( '%-24s error' % name )
+            regressions += 1
+        elif ref is None:
+            print( '%-24s %10d ns' % ( name, avg ) )
+        else:
+            delta = ( ( avg - ref ) * 100.0 ) / ref
+            status = 'REGRESSION' if delta > args.threshold else ''
+            print( '%-24s %10d ns %10d ns %+7.1f%% %s' % ( name, ref, avg, delta, status ) )
+            if delta > args.threshold:
+                regressions += 1
+    for name in reference:
+        if name not in new:
+            print( '%-24s missing' % name )
+            regressions += 1
+
+    sys.exit( 1 if regressions != 0 else 0 )
+
+if __name__ == '__main__':
+    main( )
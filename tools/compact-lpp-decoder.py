@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+#
+# Decodes the frames built by src/apps/LoRaMac/common/CompactLpp.c
+#
+# The channels declaration given to CompactLppInit is passed as a comma
+# separated list of <channel>:<Cayenne LPP type> pairs. The frames are read
+# as hexadecimal strings, one per line, in the order they were received.
+#
+# One comma separated line is printed per reading:
+#
+#   frame,channel,type,value[,value,value]
+#
+# The values are the fixed point integers given to the encoder. Delta frames
+# whose key frame wasn't received are reported as "frame,missing_key".
+#
+# Usage: compact-lpp-decoder.py <channels> [frames file]
+#
+import argparse
+import sys
+
+# Cayenne LPP type: ( axes, width, signed )
+TYPES = {
+    0:   ( 1,  8, False ),
+    1:   ( 1,  8, False ),
+    2:   ( 1, 16, True ),
+    3:   ( 1, 16, True ),
+    101: ( 1, 16, False ),
+    102: ( 1,  8, False ),
+    103: ( 1, 16, True ),
+    104: ( 1,  8, False ),
+    113: ( 3, 16, True ),
+    115: ( 1, 16, False ),
+    134: ( 3, 16, True ),
+    136: ( 3, 24, True ),
+}
+
+DELTA_LENGTH_BITS = 5
+
+class BitReader:
+    def __init__( self, data ):
+        self.data = data
+        self.pos = 0
+
+    def read( self, bits ):
+        value = 0
+        for _ in range( bits ):
+            byte = self.data[self.pos >> 3]
+            value = ( value << 1 ) | ( ( byte >> ( 7 - ( self.pos & 7 ) ) ) & 1 )
+            self.pos += 1
+        return value
+
+def sign_extend( value, width ):
+    if value & ( 1 << ( width - 1 ) ):
+        value -= 1 << width
+    return value
+
+def decode( channels, frames ):
+    keys = {}
+    for index, frame in enumerate( frames ):
+        reader = BitReader( frame )
+        delta = reader.read( 1 )
+        sequence = reader.read( 7 )
+        present = reader.read( len( channels ) )
+        if delta and sequence not in keys:
+            print( '%d,missing_key' % index )
+            continue
+        values = dict( keys[sequence] ) if delta else {}
+        for i, ( channel, lpp_type ) in enumerate( channels ):
+            if not ( present >> ( len( channels ) - 1 - i ) ) & 1:
+                continue
+            axes, width, signed = TYPES[lpp_type]
+            reading = []
+            for axis in range( axes ):
+                if delta:
+                    length = reader.read( DELTA_LENGTH_BITS )
+                    zigzag = reader.read( length )
+                    diff = ( zigzag >> 1 ) ^ -( zigzag & 1 )
+                    reading.append( keys[sequence][i][axis] + diff )
+                else:
+                    value = reader.read( width )
+                    reading.append( sign_extend( value, width ) if signed else value )
+            values[i] = reading
+            print( '%d,%d,%d,%s' % ( index, channel, lpp_type, ','.join( str( v ) for v in reading ) ) )
+        if not delta:
+            keys[sequence] = values
+
+def main( ):
+    parser = argparse.ArgumentParser( description = 'LoRaMac-node compact LPP decoder' )
+    parser.add_argument( 'channels', help = 'Channels declaration, e.g. 0:103,1:136' )
+    parser.add_argument( 'input', nargs = '?', help = 'Frames file, one hexadecimal frame per line' )
+    args = parser.parse_args( )
+
+    channels = []
+    for item in args.channels.split( ',' ):
+        channel, lpp_type = ( int( v ) for v in item.split( ':' ) )
+        if lpp_type not in TYPES:
+            sys.exit( 'Unsupported type %d' % lpp_type )
+        channels.append( ( channel, lpp_type ) )
+
+    stream = open( args.input ) if args.input else sys.stdin
+    frames = [bytes.fromhex( line.strip( ) ) for line in stream if line.strip( )]
+    decode( channels, frames )
+
+if __name__ == '__main__':
+    main( )
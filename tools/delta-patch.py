@@ -0,0 +1,195 @@
+#!/usr/bin/env python3
+#
+# Creates and applies the delta patches consumed by
+# src/apps/LoRaMac/common/LmHandler/packages/DeltaPatch.c
+#
+# The new image is described as old image regions with a few changed bytes
+# ( diff ) and new bytes ( extra ). The diff bytes are the differences with
+# the old image, mostly zeros, which are run length encoded. The patch file
+# is then sent as a regular file by the fragmentation package.
+#
+# Usage: delta-patch.py create <old image> <new image> <patch>
+#        delta-patch.py apply <old image> <patch> <new image>
+#
+import argparse
+import struct
+import sys
+import zlib
+
+MAGIC = b'LDP1'
+
+# Length of the blocks indexed to find the matches
+BLOCK_SIZE = 8
+
+# A match is extended while less than MISMATCH_MAX of the last MISMATCH_WINDOW
+# bytes differ
+MISMATCH_WINDOW = 16
+MISMATCH_MAX = 8
+
+# Candidate old positions kept per block
+CANDIDATES_MAX = 8
+
+def pack_varint( value ):
+    out = bytearray( )
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append( byte | 0x80 )
+        else:
+            out.append( byte )
+            return bytes( out )
+
+def pack_zigzag( value ):
+    return pack_varint( ( value << 1 ) if value >= 0 else ( ( -value << 1 ) - 1 ) )
+
+def read_varint( data, pos ):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= ( byte & 0x7f ) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+def extend_match( old, new, o, n ):
+    '''Returns the length of the approximate match of new[n:] at old[o:]'''
+    length = 0
+    last_good = 0
+    window = []
+    mismatches = 0
+    while o + length < len( old ) and n + length < len( new ):
+        differ = old[o + length] != new[n + length]
+        window.append( differ )
+        mismatches += differ
+        if len( window ) > MISMATCH_WINDOW:
+            mismatches -= window.pop( 0 )
+        length += 1
+        if not differ:
+            last_good = length
+        if mismatches >= MISMATCH_MAX:
+            break
+    return last_good
+
+def find_matches( old, new ):
+    '''Yields ( new position, old position, length ) of the matches'''
+    index = {}
+    for o in range( len( old ) - BLOCK_SIZE + 1 ):
+        candidates = index.setdefault( old[o:o + BLOCK_SIZE], [] )
+        if len( candidates ) < CANDIDATES_MAX:
+            candidates.append( o )
+    n = 0
+    expected = 0
+    while n <= len( new ) - BLOCK_SIZE:
+        candidates = index.get( new[n:n + BLOCK_SIZE], [] )
+        best = ( 0, 0 )
+        # The continuation of the previous match is tried first, it costs no
+        # adjustment
+        for o in [ expected ] + candidates:
+            if o < len( old ):
+                length = extend_match( old, new, o, n )
+                if length > best[0]:
+                    best = ( length, o )
+        if best[0] >= BLOCK_SIZE:
+            yield n, best[1], best[0]
+            n += best[0]
+            expected = best[1] + best[0]
+        else:
+            n += 1
+
+def encode_diff( old, new ):
+    '''Encodes the diff bytes as runs of unchanged bytes and of delta bytes'''
+    out = bytearray( )
+    delta = bytes( ( b - a ) & 0xff for a, b in zip( old, new ) )
+    i = 0
+    while i < len( delta ):
+        j = i
+        if delta[i] == 0:
+            while j < len( delta ) and delta[j] == 0:
+                j += 1
+            out += pack_varint( ( j - i ) << 1 )
+        else:
+            # Isolated zeros are cheaper kept in the delta run
+            while j < len( delta ) and ( delta[j] != 0 or delta[j:j + 3] != b'\x00\x00\x00' ):
+                j += 1
+            out += pack_varint( ( ( j - i ) << 1 ) | 1 ) + delta[i:j]
+        i = j
+    return bytes( out )
+
+def create( old, new ):
+    patch = bytearray( MAGIC + struct.pack( '<II', len( new ), zlib.crc32( new ) & 0xffffffff ) )
+    records = list( find_matches( old, new ) )
+    if not records or records[0][0] != 0:
+        # New bytes ahead of the first match
+        records.insert( 0, ( 0, 0, 0 ) )
+    for i, ( n, o, length ) in enumerate( records ):
+        end = records[i + 1][0] if i + 1 < len( records ) else len( new )
+        extra = new[n + length:end]
+        next_old = records[i + 1][1] if i + 1 < len( records ) else o + length
+        patch += pack_varint( length ) + encode_diff( old[o:o + length], new[n:n + length] )
+        patch += pack_varint( len( extra ) ) + extra
+        patch += pack_zigzag( next_old - ( o + length ) )
+    return bytes( patch )
+
+def apply( old, patch ):
+    if patch[:4] != MAGIC:
+        raise ValueError( 'not a delta patch' )
+    size, crc = struct.unpack( '<II', patch[4:12] )
+    pos = 12
+    o = 0
+    new = bytearray( )
+    while len( new ) < size:
+        length, pos = read_varint( patch, pos )
+        while length > 0:
+            token, pos = read_varint( patch, pos )
+            count = token >> 1
+            if token & 1:
+                new += bytes( ( a + b ) & 0xff for a, b in zip( old[o:o + count], patch[pos:pos + count] ) )
+                pos += count
+            else:
+                new += old[o:o + count]
+            o += count
+            length -= count
+        length, pos = read_varint( patch, pos )
+        new += patch[pos:pos + length]
+        pos += length
+        adjust, pos = read_varint( patch, pos )
+        o += ( adjust >> 1 ) if not adjust & 1 else -( ( adjust >> 1 ) + 1 )
+    if zlib.crc32( new ) & 0xffffffff != crc:
+        raise ValueError( 'CRC mismatch' )
+    return bytes( new )
+
+def main( ):
+    parser = argparse.ArgumentParser( description='Firmware delta patches' )
+    sub = parser.add_subparsers( dest='command', required=True )
+    p = sub.add_parser( 'create', help='creates a patch from the old to the new image' )
+    p.add_argument( 'old' )
+    p.add_argument( 'new' )
+    p.add_argument( 'patch' )
+    p = sub.add_parser( 'apply', help='applies a patch to the old image' )
+    p.add_argument( 'old' )
+    p.add_argument( 'patch' )
+    p.add_argument( 'new' )
+    args = parser.parse_args( )
+
+    with open( args.old, 'rb' ) as f:
+        old = f.read( )
+    if args.command == 'create':
+        with open( args.new, 'rb' ) as f:
+            new = f.read( )
+        patch = create( old, new )
+        with open( args.patch, 'wb' ) as f:
+            f.write( patch )
+        print( 'patch: %d bytes, new image: %d bytes ( %.1f%% )' %
+               ( len( patch ), len( new ), 100.0 * len( patch ) / max( len( new ), 1 ) ) )
+    else:
+        with open( args.patch, 'rb' ) as f:
+            patch = f.read( )
+        with open( args.new, 'wb' ) as f:
+            f.write( apply( old, patch ) )
+    return 0
+
+if __name__ == '__main__':
+    sys.exit( main( ) )
@@ -0,0 +1,101 @@
+#!/usr/bin/env python3
+#
+# Reports the RAM used by each module of a firmware from the GNU ld map file
+# ( -Wl,-Map ) written at link time.
+#
+# The .data and .bss input sections are summed per CMake target ( mac, radio,
+# board, ... ) or per library. With --budget the script fails when the total
+# exceeds the given number of bytes.
+#
+# Usage: ram-budget.py [--symbols N] [--budget BYTES] <map file>
+#
+import argparse
+import re
+import sys
+
+MEMORY_MAP_START = 'Linker script and memory map'
+
+RAM_SECTIONS = re.compile( r'^\.(data|bss|noinit)$' )
+
+INPUT_SECTION = re.compile( r'^ (\S+)(?:\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(.+))?$' )
+
+INPUT_SECTION_CONT = re.compile( r'^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(.+)$' )
+
+CMAKE_OBJECT = re.compile( r'CMakeFiles/([^/]+)\.dir/' )
+
+LIBRARY_OBJECT = re.compile( r'([^/]+)\.a\(' )
+
+def module_name( obj ):
+    m = CMAKE_OBJECT.search( obj )
+    if m:
+        return m.group( 1 )
+    m = LIBRARY_OBJECT.search( obj )
+    if m:
+        return m.group( 1 )
+    return 'other'
+
+def parse_map( lines ):
+    '''Yields ( section, size, object ) of the input sections placed in RAM'''
+    in_map = False
+    in_ram = False
+    pending = None
+    for line in lines:
+        line = line.rstrip( '\r\n' )
+        if not in_map:
+            in_map = line.startswith( MEMORY_MAP_START )
+            continue
+        if line and not line[0].isspace( ):
+            # Output section
+            in_ram = RAM_SECTIONS.match( line.split( )[0] ) is not None
+            pending = None
+            continue
+        if not in_ram:
+            continue
+        if pending is not None:
+            m = INPUT_SECTION_CONT.match( line )
+            if m:
+                yield pending, int( m.group( 2 ), 16 ), m.group( 3 )
+            pending = None
+            continue
+        m = INPUT_SECTION.match( line )
+        if not m or m.group( 1 ).startswith( '*' ):
+            continue
+        if m.group( 2 ) is None:
+            # Long section names are followed by the address on the next line
+            pending = m.group( 1 )
+        else:
+            yield m.group( 1 ), int( m.group( 3 ), 16 ), m.group( 4 )
+
+def main( ):
+    parser = argparse.ArgumentParser( description='Link time RAM use per module' )
+    parser.add_argument( '--symbols', type=int, default=0, metavar='N',
+                         help='also lists the N largest sections of each module' )
+    parser.add_argument( '--budget', type=int, default=0, metavar='BYTES',
+                         help='fails when the total RAM use exceeds BYTES' )
+    parser.add_argument( 'map', help='GNU ld map file' )
+    args = parser.parse_args( )
+
+    modules = {}
+    with open( args.map, 'r', errors='replace' ) as f:
+        for section, size, obj in parse_map( f ):
+            if size == 0:
+                continue
+            modules.setdefault( module_name( obj ), [] ).append( ( size, section ) )
+
+    total = 0
+    print( '%-24s %8s' % ( 'module', 'bytes' ) )
+    for name, sections in sorted( modules.items( ), key=lambda m: -sum( s for s, _ in m[1] ) ):
+        size = sum( s for s, _ in sections )
+        total += size
+        print( '%-24s %8d' % ( name, size ) )
+        for s, section in sorted( sections, reverse=True )[:args.symbols]:
+            print( '    %-36s %8d' % ( section, s ) )
+    print( '%-24s %8d' % ( 'total', total ) )
+
+    if args.budget and total > args.budget:
+        print( 'RAM budget exceeded: %d > %d bytes' % ( total, args.budget ), file=sys.stderr )
+        return 1
+    return 0
+
+if __name__ == '__main__':
+    sys.exit( main( ) )
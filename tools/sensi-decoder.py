@@ -0,0 +1,77 @@
+#!/usr/bin/env python3
+#
+# Decodes the statistics summaries written by src/apps/rx-sensi when built
+# with RX_SENSI_STATS_ENABLED
+#
+# One comma separated line is printed per summary:
+#
+#   step,frequency,datarate,duration_ms,rx,lost,crc_errors,per_percent,
+#   rssi_min,rssi_avg,rssi_max,snr_min,snr_avg,snr_max,
+#   freq_error_min,freq_error_avg,freq_error_max
+#
+# The --histograms option adds the RSSI and SNR histograms as two more lines,
+# prefixed by "rssi," and "snr," and holding the bins counts.
+#
+# Usage: sensi-decoder.py [--histograms] <capture file | serial device>
+#
+import argparse
+import struct
+import sys
+
+FRAME_SYNC = b'\xa5\xc3'
+SUMMARY_HEADER = '<BIIIIIIhhhbbbiii'
+SUMMARY_HEADER_SIZE = struct.calcsize( SUMMARY_HEADER )
+
+def parse_summary( summary, histograms ):
+    fields = struct.unpack( SUMMARY_HEADER, summary[:SUMMARY_HEADER_SIZE] )
+    step, frequency, datarate, duration, rx, lost, crc_errors = fields[:7]
+    total = rx + lost
+    per = ( lost * 100.0 / total ) if total != 0 else 100.0
+    print( '%d,%d,%d,%d,%d,%d,%d,%.2f,%s' % ( step, frequency, datarate, duration, rx, lost, crc_errors, per,
+                                              ','.join( str( f ) for f in fields[7:] ) ) )
+    if histograms:
+        pos = SUMMARY_HEADER_SIZE
+        for name in ( 'rssi', 'snr' ):
+            nb_bins = summary[pos]
+            bins = struct.unpack( '<%dH' % nb_bins, summary[pos + 1:pos + 1 + 2 * nb_bins] )
+            pos += 1 + 2 * nb_bins
+            print( '%s,%s' % ( name, ','.join( str( b ) for b in bins ) ) )
+    sys.stdout.flush( )
+
+def decode( stream, histograms ):
+    data = b''
+    while True:
+        chunk = stream.read( 256 )
+        if not chunk:
+            break
+        data += chunk
+        while True:
+            start = data.find( FRAME_SYNC )
+            if start < 0:
+                data = data[-1:]
+                break
+            data = data[start:]
+            if len( data ) < 3:
+                break
+            size = data[2]
+            if len( data ) < ( 4 + size ):
+                break
+            summary = data[3:3 + size]
+            if ( size < SUMMARY_HEADER_SIZE ) or ( ( sum( summary ) & 0xFF ) != data[3 + size] ):
+                # Not a frame, resynchronize on the next byte
+                data = data[1:]
+                continue
+            data = data[4 + size:]
+            parse_summary( summary, histograms )
+
+def main( ):
+    parser = argparse.ArgumentParser( description = 'LoRaMac-node rx-sensi statistics decoder' )
+    parser.add_argument( 'input', help = 'Capture file or serial device' )
+    parser.add_argument( '--histograms', action = 'store_true', help = 'Print the RSSI and SNR histograms' )
+    args = parser.parse_args( )
+
+    with open( args.input, 'rb', buffering = 0 ) as stream:
+        decode( stream, args.histograms )
+
+if __name__ == '__main__':
+    main( )
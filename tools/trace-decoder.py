@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+#
+# Decodes the binary event trace written by src/system/trace.c
+#
+# The trace frames may be interleaved with the text printed on the same
+# UART. Bytes which don't form a valid frame are skipped.
+#
+# Usage: trace-decoder.py [--tick-hz HZ] [--text] <capture file | serial device>
+#
+import argparse
+import struct
+import sys
+
+FRAME_SYNC = b'\xa5\x5a'
+FRAME_SIZE = 15
+
+TRACE_IDS = {
+    0x00: 'LOST',
+    0x01: 'MAC_STATE',
+    0x02: 'MAC_TX',
+    0x03: 'MAC_RX_WINDOW',
+    0x04: 'RADIO_IRQ',
+    0x05: 'TIMER_EVENT',
+    0x06: 'CRYPTO',
+}
+
+RADIO_IRQS = [ 'TX_DONE', 'RX_DONE', 'TX_TIMEOUT', 'RX_TIMEOUT', 'RX_ERROR', 'CAD_DONE' ]
+
+CRYPTO_OPS = [ 'AES_ENCRYPT', 'CMAC', 'CTR_CMAC' ]
+
+MAC_STATES = [ 'STOPPED', 'TX_RUNNING', 'RX', None, 'ACK_RETRY', 'TX_DELAYED', 'TX_CONFIG', 'RX_ABORT' ]
+
+def format_args( id, arg0, arg1, arg2 ):
+    if id == 0x00:
+        return 'count=%d' % arg1
+    if id == 0x01:
+        states = [ s for i, s in enumerate( MAC_STATES ) if s and ( arg2 & ( 1 << i ) ) ]
+        return 'state=0x%08X %s' % ( arg2, '|'.join( states ) if states else 'IDLE' )
+    if id == 0x02:
+        return 'channel=%d dr=%d toa=%dms' % ( arg0, arg1, arg2 )
+    if id == 0x03:
+        return 'slot=%d dr=%d window=%dms' % ( arg0, arg1, arg2 )
+    if id == 0x04:
+        irq = RADIO_IRQS[arg0] if arg0 < len( RADIO_IRQS ) else str( arg0 )
+        if arg0 == 1:
+            rssi = struct.unpack( '<h', struct.pack( '<H', arg2 >> 16 ) )[0]
+            snr = struct.unpack( '<b', struct.pack( '<B', arg2 & 0xFF ) )[0]
+            return '%s size=%d rssi=%d snr=%d' % ( irq, arg1, rssi, snr )
+        if arg0 == 5:
+            return '%s detected=%d' % ( irq, arg1 )
+        return irq
+    if id == 0x05:
+        return 'callback=0x%08X' % arg2
+    if id == 0x06:
+        op = CRYPTO_OPS[arg0] if arg0 < len( CRYPTO_OPS ) else str( arg0 )
+        return '%s size=%d key=%d' % ( op, arg1, arg2 )
+    return 'arg0=%d arg1=%d arg2=0x%08X' % ( arg0, arg1, arg2 )
+
+def decode( stream, tick_hz, text ):
+    data = b''
+    prev = None
+    while True:
+        chunk = stream.read( 256 )
+        if not chunk:
+            break
+        data += chunk
+        while True:
+            start = data.find( FRAME_SYNC )
+            if start < 0:
+                if text:
+                    sys.stderr.write( data[:-1].decode( 'latin-1' ) )
+                data = data[-1:]
+                break
+            if text and start > 0:
+                sys.stderr.write( data[:start].decode( 'latin-1' ) )
+            data = data[start:]
+            if len( data ) < FRAME_SIZE:
+                break
+            record = data[2:FRAME_SIZE - 1]
+            if ( sum( record ) & 0xFF ) != data[FRAME_SIZE - 1]:
+                # Not a frame, resynchronize on the next byte
+                data = data[1:]
+                continue
+            data = data[FRAME_SIZE:]
+            timestamp, id, arg0, arg1, arg2 = struct.unpack( '<IBBHI', record )
+            delta = 0 if prev is None else ( timestamp - prev ) & 0xFFFFFFFF
+            prev = timestamp
+            print( '%12.3f ms %+10.3f ms  %-14s %s' % ( timestamp * 1000.0 / tick_hz, delta * 1000.0 / tick_hz,
+                                                     TRACE_IDS.get( id, 'USER_0x%02X' % id ),
+                                                     format_args( id, arg0, arg1, arg2 ) ) )
+            sys.stdout.flush( )
+
+def main( ):
+    parser = argparse.ArgumentParser( description = 'LoRaMac-node binary trace decoder' )
+    parser.add_argument( 'input', help = 'Capture file or serial device' )
+    parser.add_argument( '--tick-hz', type = float, default = 1000.0,
+                         help = 'RTC timer frequency of the board ( RtcGetTimerValue ticks per second )' )
+    parser.add_argument( '--text', action = 'store_true', help = 'Copy the non trace bytes to stderr' )
+    args = parser.parse_args( )
+
+    with open( args.input, 'rb', buffering = 0 ) as stream:
+        decode( stream, args.tick_hz, args.text )
+
+if __name__ == '__main__':
+    main( )